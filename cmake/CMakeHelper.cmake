@@ -189,3 +189,14 @@ macro(COLMAP_ADD_CUDA_TEST TARGET_NAME)
         endif()
     endif()
 endmacro(COLMAP_ADD_CUDA_TEST)
+
+# Wrapper for benchmark executables using Google Benchmark.
+macro(COLMAP_ADD_BENCHMARK TARGET_NAME)
+    if(BENCHMARKS_ENABLED)
+        # ${ARGN} will store the list of source files passed to this function.
+        add_executable(${TARGET_NAME} ${ARGN})
+        set_target_properties(${TARGET_NAME} PROPERTIES FOLDER
+            ${COLMAP_TARGETS_ROOT_FOLDER}/${FOLDER_NAME})
+        target_link_libraries(${TARGET_NAME} colmap benchmark::benchmark_main)
+    endif()
+endmacro(COLMAP_ADD_BENCHMARK)
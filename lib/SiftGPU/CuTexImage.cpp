@@ -159,6 +159,12 @@ void CuTexImage::CopyFromHost(const void * buf)
 	cudaMemcpy( _cuData, buf, _imgWidth * _imgHeight * _numChannel * sizeof(float), cudaMemcpyHostToDevice);
 }
 
+void CuTexImage::CopyFromDevice(const CuTexImage& tex)
+{
+	if(_cuData == NULL || tex._cuData == NULL) return;
+	cudaMemcpy(_cuData, tex._cuData, _imgWidth * _imgHeight * _numChannel * sizeof(float), cudaMemcpyDeviceToDevice);
+}
+
 void CuTexImage::CopyToHost(void * buf)
 {
 	if(_cuData == NULL) return;
@@ -54,6 +54,7 @@ public:
 	void CopyToHost(void* buf);
 	void CopyToHost(void* buf, int stream);
 	void CopyFromHost(const void* buf);
+	void CopyFromDevice(const CuTexImage& tex);
 	int  CopyToPBO(GLuint pbo);
 	void CopyFromPBO(int width, int height, GLuint pbo);
 	static int DebugCopyToTexture2D();
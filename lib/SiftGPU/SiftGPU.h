@@ -64,6 +64,8 @@ typedef unsigned __int64 uint64_t;
 #include <stdint.h>
 #endif
 
+#include <stddef.h>
+
 ///////////////////////////////////////////////////////////////////
 //clss SiftParam
 //description: SIFT parameters
@@ -326,6 +328,16 @@ public:
 	//Option 2 unsigned char descriptors. They must be already normalized to 512
 	SIFTGPU_EXPORT virtual void SetDescriptors(int index, int num, const unsigned char * descriptors, int id = -1);
 
+	//Keep uploaded descriptors with a non-negative id in a device-side cache of the given size in bytes.
+	//The least recently used descriptors are evicted first, a size of 0 disables the cache (default).
+	//The cache is only supported by the CUDA version and otherwise this is a no-op.
+	SIFTGPU_EXPORT virtual void SetDescriptorCacheSize(size_t num_bytes);
+	//Set the descriptors with the given id from the device-side cache, index = [0/1].
+	//The function RETURNS false, if the descriptors are not cached.
+	SIFTGPU_EXPORT virtual bool SetCachedDescriptors(int index, int id);
+	//Remove the descriptors with the given id from the device-side cache, if they are cached.
+	SIFTGPU_EXPORT virtual void EvictCachedDescriptors(int id);
+
 	//match two sets of features, the function RETURNS the number of matches.
 	//Given two normalized descriptor d1,d2, the distance here is acos(d1 *d2);
 	SIFTGPU_EXPORT virtual int  GetSiftMatch(
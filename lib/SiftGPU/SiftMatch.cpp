@@ -679,6 +679,21 @@ void SiftMatchGPU::SetDescriptors(int index, int num, const float* descriptors,
 	__matcher->SetDescriptors(index, num, descriptors, id);
 }
 
+void SiftMatchGPU::SetDescriptorCacheSize(size_t num_bytes)
+{
+	if(__matcher) __matcher->SetDescriptorCacheSize(num_bytes);
+}
+
+bool SiftMatchGPU::SetCachedDescriptors(int index, int id)
+{
+	return __matcher ? __matcher->SetCachedDescriptors(index, id) : false;
+}
+
+void SiftMatchGPU::EvictCachedDescriptors(int id)
+{
+	if(__matcher) __matcher->EvictCachedDescriptors(id);
+}
+
 void SiftMatchGPU::SetFeautreLocation(int index, const float* locations, int gap)
 {
 	__matcher->SetFeautreLocation(index, locations, gap);
@@ -46,12 +46,16 @@ using namespace std;
 
 SiftMatchCU::SiftMatchCU(int max_sift) : SiftMatchGPU() {
   _num_sift[0] = _num_sift[1] = 0;
-  _id_sift[0] = _id_sift[1] = 0;
+  _id_sift[0] = _id_sift[1] = -1;
   _have_loc[0] = _have_loc[1] = 0;
   __max_sift = max_sift <= 0 ? 4096 : ((max_sift + 31) / 32 * 32);
   _initialized = 0;
+  _cache_max_bytes = 0;
+  _cache_num_bytes = 0;
 }
 
+SiftMatchCU::~SiftMatchCU() { SetDescriptorCacheSize(0); }
+
 bool SiftMatchCU::Allocate(int max_sift, int mbm) {
   SetMaxSift(max_sift);
 
@@ -109,6 +113,7 @@ void SiftMatchCU::SetDescriptors(int index, int num,
   _num_sift[index] = num;
   _texDes[index].InitTexture(8 * num, 1, 4);
   _texDes[index].CopyFromHost((void*)descriptors);
+  if (id >= 0 && _cache_max_bytes > 0) AddCachedDescriptors(index);
 }
 
 void SiftMatchCU::SetDescriptors(int index, int num, const float* descriptors,
@@ -126,6 +131,66 @@ void SiftMatchCU::SetDescriptors(int index, int num, const float* descriptors,
   SetDescriptors(index, num, pub, id);
 }
 
+void SiftMatchCU::SetDescriptorCacheSize(size_t num_bytes) {
+  _cache_max_bytes = num_bytes;
+  while (_cache_num_bytes > _cache_max_bytes && !_cache_lru.empty()) {
+    RemoveCachedDescriptors(_cache_lru.back());
+  }
+}
+
+bool SiftMatchCU::SetCachedDescriptors(int index, int id) {
+  if (_initialized == 0) return false;
+  if (index > 1) index = 1;
+  if (index < 0) index = 0;
+  std::map<int, CachedDescriptors>::iterator it = _cache.find(id);
+  if (it == _cache.end()) return false;
+  const int num = it->second.num;
+  if (!_texDes[index].InitTexture(8 * num, 1, 4)) return false;
+  _texDes[index].CopyFromDevice(*it->second.tex);
+  _cache_lru.splice(_cache_lru.begin(), _cache_lru, it->second.lru);
+  _have_loc[index] = 0;
+  _id_sift[index] = id;
+  _num_sift[index] = num;
+  return true;
+}
+
+void SiftMatchCU::EvictCachedDescriptors(int id) {
+  RemoveCachedDescriptors(id);
+}
+
+void SiftMatchCU::AddCachedDescriptors(int index) {
+  const int id = _id_sift[index];
+  const int num = _num_sift[index];
+  const size_t num_bytes = 128 * static_cast<size_t>(num);
+  RemoveCachedDescriptors(id);
+  if (num <= 0 || num_bytes > _cache_max_bytes) return;
+  while (_cache_num_bytes + num_bytes > _cache_max_bytes) {
+    RemoveCachedDescriptors(_cache_lru.back());
+  }
+  CachedDescriptors cached;
+  cached.tex = new CuTexImage();
+  // Skip the caching, if there is not enough device memory left.
+  if (!cached.tex->InitTexture(8 * num, 1, 4)) {
+    delete cached.tex;
+    return;
+  }
+  cached.tex->CopyFromDevice(_texDes[index]);
+  cached.num = num;
+  _cache_lru.push_front(id);
+  cached.lru = _cache_lru.begin();
+  _cache.insert(std::make_pair(id, cached));
+  _cache_num_bytes += num_bytes;
+}
+
+void SiftMatchCU::RemoveCachedDescriptors(int id) {
+  std::map<int, CachedDescriptors>::iterator it = _cache.find(id);
+  if (it == _cache.end()) return;
+  _cache_num_bytes -= 128 * static_cast<size_t>(it->second.num);
+  _cache_lru.erase(it->second.lru);
+  delete it->second.tex;
+  _cache.erase(it);
+}
+
 void SiftMatchCU::SetFeautreLocation(int index, const float* locations,
                                      int gap) {
   if (_num_sift[index] <= 0) return;
@@ -25,6 +25,9 @@
 #define CU_SIFT_MATCH_H
 #if defined(CUDA_SIFTGPU_ENABLED)
 
+#include <list>
+#include <map>
+
 class CuTexImage;
 class SiftMatchCU:public SiftMatchGPU
 {
@@ -45,16 +48,33 @@ private:
 	//gpu parameter
 	int _initialized;
 	vector<int> sift_buffer;
+
+	//device-side descriptor cache
+	struct CachedDescriptors
+	{
+		CuTexImage* tex;
+		int num;
+		std::list<int>::iterator lru;
+	};
+	size_t _cache_max_bytes;
+	size_t _cache_num_bytes;
+	std::list<int> _cache_lru;
+	std::map<int, CachedDescriptors> _cache;
 private:
 	int  GetBestMatch(int max_match, uint32_t match_buffer[][2], float distmax, float ratiomax, int mbm);
+	void AddCachedDescriptors(int index);
+	void RemoveCachedDescriptors(int id);
 public:
 	SiftMatchCU(int max_sift);
-	virtual ~SiftMatchCU(){};
+	virtual ~SiftMatchCU();
 	void InitSiftMatch();
   bool Allocate(int max_sift, int mbm) override;
 	void SetMaxSift(int max_sift) override;
 	void SetDescriptors(int index, int num, const unsigned char * descriptor, int id = -1);
 	void SetDescriptors(int index, int num, const float * descriptor, int id = -1);
+	void SetDescriptorCacheSize(size_t num_bytes) override;
+	bool SetCachedDescriptors(int index, int id) override;
+	void EvictCachedDescriptors(int id) override;
 	void SetFeautreLocation(int index, const float* locatoins, int gap);
 	int  GetSiftMatch(int max_match, uint32_t match_buffer[][2], float distmax, float ratiomax, int mbm);
 	int  GetGuidedSiftMatch(int max_match, uint32_t match_buffer[][2], float* H, float* F,
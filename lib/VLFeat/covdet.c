@@ -1635,6 +1635,42 @@ vl_covdet_delete (VlCovDet * self)
   vl_free(self) ;
 }
 
+/** @brief Create a worker sharing the data of an object
+ ** @param self object.
+ ** @return new worker.
+ **
+ ** The worker shares the scale spaces and the features of @a self,
+ ** but owns its scratch buffers. Hence, the per-frame functions, e.g.,
+ ** ::vl_covdet_extract_affine_shape_for_frame,
+ ** ::vl_covdet_extract_orientations_for_frame, and
+ ** ::vl_covdet_extract_patch_for_frame, can be called concurrently on
+ ** different workers of the same object. The worker must not modify
+ ** the shared data and must be deleted with ::vl_covdet_delete_worker
+ ** before @a self is reset or deleted.
+ **/
+
+VlCovDet *
+vl_covdet_new_worker (VlCovDet const * self)
+{
+  VlCovDet * worker = vl_malloc(sizeof(VlCovDet)) ;
+  if (worker == NULL) return NULL ;
+  memcpy(worker, self, sizeof(VlCovDet)) ;
+  worker->patch = NULL ;
+  worker->patchBufferSize = 0 ;
+  return worker ;
+}
+
+/** @brief Delete a worker
+ ** @param self worker created by ::vl_covdet_new_worker.
+ **/
+
+void
+vl_covdet_delete_worker (VlCovDet * self)
+{
+  if (self->patch) vl_free (self->patch) ;
+  vl_free(self) ;
+}
+
 /** @brief Append a feature to the internal buffer.
  ** @param self object.
  ** @param feature a pointer to the feature to append.
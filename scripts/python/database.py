@@ -32,6 +32,7 @@
 # This script is based on an original implementation by True Price.
 
 import sys
+import zlib
 import sqlite3
 import numpy as np
 
@@ -87,6 +88,7 @@ CREATE_KEYPOINTS_TABLE = """CREATE TABLE IF NOT EXISTS keypoints (
     rows INTEGER NOT NULL,
     cols INTEGER NOT NULL,
     data BLOB,
+    format INTEGER NOT NULL DEFAULT 0,
     FOREIGN KEY(image_id) REFERENCES images(image_id) ON DELETE CASCADE)
 """
 
@@ -130,10 +132,44 @@ def array_to_blob(array):
 
 
 def blob_to_array(blob, dtype, shape=(-1,)):
-    if IS_PYTHON3:
-        return np.fromstring(blob, dtype=dtype).reshape(*shape)
-    else:
-        return np.frombuffer(blob, dtype=dtype).reshape(*shape)
+    # The returned read-only array aliases the memory of the blob.
+    return np.frombuffer(blob, dtype=dtype).reshape(*shape)
+
+
+# Formats of the keypoints and matches, see src/base/database.h.
+KEYPOINTS_FORMAT_FLOAT32 = 0
+KEYPOINTS_FORMAT_FLOAT16 = 1
+MATCHES_FORMAT_UINT32 = 0
+MATCHES_FORMAT_VARINT = 1
+MATCHES_FORMAT_VARINT_ZLIB = 2
+
+
+def decode_varints(data):
+    """Decode a sequence of unsigned variable-length integers, where each byte
+    stores 7 bits and the highest bit marks all but the last byte of a number.
+    """
+    data = np.frombuffer(data, dtype=np.uint8)
+    if data.size == 0:
+        return np.zeros(0, dtype=np.uint64)
+    ends = np.flatnonzero(data < 0x80)
+    starts = np.concatenate(([0], ends[:-1] + 1))
+    shifts = 7 * (np.arange(data.size) -
+                  np.repeat(starts, ends - starts + 1))
+    values = (data & 0x7F).astype(np.uint64) << shifts.astype(np.uint64)
+    return np.add.reduceat(values, starts)
+
+
+def decode_varint_matches(data, num_matches):
+    """Decode the matches from the sorted differences of their point indices,
+    see FeatureMatchesBlobToVarint in src/base/database.cc.
+    """
+    values = decode_varints(data)
+    assert values.size == 2 * num_matches
+    diffs1 = values[0::2].astype(np.int64)
+    diffs2 = (values[1::2] >> np.uint64(1)).astype(np.int64) ^ \
+        -(values[1::2] & np.uint64(1)).astype(np.int64)
+    return np.column_stack((np.cumsum(diffs1),
+                            np.cumsum(diffs2))).astype(np.uint32)
 
 
 class COLMAPDatabase(sqlite3.Connection):
@@ -184,7 +220,8 @@ class COLMAPDatabase(sqlite3.Connection):
 
         keypoints = np.asarray(keypoints, np.float32)
         self.execute(
-            "INSERT INTO keypoints VALUES (?, ?, ?, ?)",
+            "INSERT INTO keypoints(image_id, rows, cols, data) "
+            "VALUES (?, ?, ?, ?)",
             (image_id,) + keypoints.shape + (array_to_blob(keypoints),))
 
     def add_descriptors(self, image_id, descriptors):
@@ -224,6 +261,90 @@ class COLMAPDatabase(sqlite3.Connection):
             (pair_id,) + matches.shape + (array_to_blob(matches), config,
              array_to_blob(F), array_to_blob(E), array_to_blob(H)))
 
+    def has_column(self, table, column):
+        return any(row[1] == column for row in
+                   self.execute("PRAGMA table_info({})".format(table)))
+
+    def read_keypoints(self, image_id):
+        """Read the keypoints of an image as a (N, cols) float32 array, which
+        aliases the blob in the single precision format without a copy.
+        """
+        if self.has_column("keypoints", "format"):
+            row = self.execute(
+                "SELECT rows, cols, data, format FROM keypoints "
+                "WHERE image_id=?", (image_id,)).fetchone()
+        else:
+            row = self.execute(
+                "SELECT rows, cols, data, 0 FROM keypoints "
+                "WHERE image_id=?", (image_id,)).fetchone()
+        if row is None:
+            return np.zeros((0, 2), dtype=np.float32)
+        rows, cols, data, data_format = row
+        if data_format == KEYPOINTS_FORMAT_FLOAT16:
+            # The locations in single precision followed by the shapes in half
+            # precision, see FeatureKeypointsBlobToHalf in database.cc.
+            locations = np.frombuffer(
+                data, dtype=np.float32, count=2 * rows).reshape(rows, 2)
+            shapes = np.frombuffer(
+                data, dtype=np.float16, offset=8 * rows).reshape(rows, -1)
+            return np.hstack((locations, shapes.astype(np.float32)))
+        return blob_to_array(data, np.float32, (rows, cols))
+
+    def read_descriptors(self, image_id):
+        """Read the descriptors of an image as a (N, 128) uint8 array, which
+        aliases the blob without a copy.
+        """
+        row = self.execute(
+            "SELECT rows, cols, data FROM descriptors WHERE image_id=?",
+            (image_id,)).fetchone()
+        if row is None:
+            return np.zeros((0, 128), dtype=np.uint8)
+        rows, cols, data = row
+        if data is None and rows > 0:
+            raise ValueError("Descriptors are stored in the feature store")
+        return blob_to_array(data or b"", np.uint8, (rows, cols))
+
+    def read_matches(self, image_id1, image_id2):
+        """Read the matches of an image pair as a (N, 2) uint32 array, whose
+        columns are in the order of the given images.
+        """
+        return self._read_matches("matches", image_id1, image_id2)
+
+    def read_inlier_matches(self, image_id1, image_id2):
+        """Read the inlier matches of the two-view geometry of an image pair.
+        """
+        return self._read_matches("two_view_geometries", image_id1, image_id2)
+
+    def _read_matches(self, table, image_id1, image_id2):
+        pair_id = image_ids_to_pair_id(image_id1, image_id2)
+        if self.has_column(table, "format"):
+            row = self.execute(
+                "SELECT rows, cols, data, format FROM {} "
+                "WHERE pair_id=?".format(table), (pair_id,)).fetchone()
+        else:
+            row = self.execute(
+                "SELECT rows, cols, data, 0 FROM {} "
+                "WHERE pair_id=?".format(table), (pair_id,)).fetchone()
+        if row is None or row[0] == 0:
+            return np.zeros((0, 2), dtype=np.uint32)
+        rows, cols, data, data_format = row
+        if data_format == MATCHES_FORMAT_UINT32:
+            matches = blob_to_array(data, np.uint32, (rows, cols))
+        elif data_format == MATCHES_FORMAT_VARINT:
+            matches = decode_varint_matches(data, rows)
+        elif data_format == MATCHES_FORMAT_VARINT_ZLIB:
+            # The compressed data is prefixed with its uncompressed size.
+            header_size = int(np.flatnonzero(
+                np.frombuffer(data, dtype=np.uint8) < 0x80)[0]) + 1
+            matches = decode_varint_matches(
+                zlib.decompress(data[header_size:]), rows)
+        else:
+            raise ValueError(
+                "Matches format {} not supported".format(data_format))
+        if image_id1 > image_id2:
+            matches = matches[:, ::-1]
+        return matches
+
 
 def example_usage():
     import os
@@ -266,7 +387,7 @@ def example_usage():
     #
     # Note that COLMAP supports:
     #      - 2D keypoints: (x, y)
-    #      - 4D keypoints: (x, y, theta, scale)
+    #      - 4D keypoints: (x, y, scale, orientation)
     #      - 6D affine keypoints: (x, y, a_11, a_12, a_21, a_22)
 
     num_keypoints = 1000
@@ -340,6 +461,12 @@ def example_usage():
     assert np.all(matches[(image_id2, image_id3)] == matches23)
     assert np.all(matches[(image_id3, image_id4)] == matches34)
 
+    # Read and check the features and matches of single images and pairs.
+
+    assert np.allclose(db.read_keypoints(image_id1), keypoints1)
+    assert np.all(db.read_matches(image_id1, image_id2) == matches12)
+    assert np.all(db.read_matches(image_id2, image_id1) == matches12[:, ::-1])
+
     # Clean up.
 
     db.close()
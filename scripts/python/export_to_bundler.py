@@ -95,14 +95,15 @@ def main():
         if os.path.exists(key_file_name_gz):
             continue
 
-        cursor.execute("SELECT data FROM keypoints WHERE image_id=?;",
+        cursor.execute("SELECT cols, data FROM keypoints WHERE image_id=?;",
                        (image_id,))
         row = next(cursor)
-        if row[0] is None:
+        if row[1] is None:
             keypoints = np.zeros((0, 6), dtype=np.float32)
             descriptors = np.zeros((0, 128), dtype=np.uint8)
         else:
-            keypoints = np.fromstring(row[0], dtype=np.float32).reshape(-1, 6)
+            keypoints = np.fromstring(row[1], dtype=np.float32).reshape(
+                -1, row[0])
             cursor.execute("SELECT data FROM descriptors WHERE image_id=?;",
                         (image_id,))
             row = next(cursor)
@@ -30,7 +30,9 @@
 # Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
 
 import numpy as np
-from read_write_model import read_model, write_model
+import os
+from read_write_model import read_model, write_model, \
+    read_points3d_binary_arrays
 from tempfile import mkdtemp
 
 
@@ -71,6 +73,19 @@ def compare_points(points3D1, points3D2):
         assert np.array_equal(point3D1.point2D_idxs, point3D2.point2D_idxs)
 
 
+def compare_points_arrays(points3D, points3D_arrays):
+    points, tracks, track_offsets = points3D_arrays
+    assert len(points) == len(points3D)
+    for i, point in enumerate(points):
+        point3D = points3D[int(point["id"])]
+        assert np.allclose(point3D.xyz, point["xyz"])
+        assert np.array_equal(point3D.rgb, point["rgb"])
+        assert np.allclose(point3D.error, point["error"])
+        track = tracks[track_offsets[i]:track_offsets[i + 1]]
+        assert np.array_equal(point3D.image_ids, track["image_id"])
+        assert np.array_equal(point3D.point2D_idxs, track["point2D_idx"])
+
+
 def main():
     import sys
     if len(sys.argv) != 3:
@@ -89,6 +104,8 @@ def main():
     compare_cameras(cameras_txt, cameras_bin)
     compare_images(images_txt, images_bin)
     compare_points(points3D_txt, points3D_bin)
+    compare_points_arrays(points3D_bin, read_points3d_binary_arrays(
+        os.path.join(path_to_model_bin_folder, "points3D.bin")))
 
     print("... text and binary models are equal.")
     print("Saving text model and reloading it ...")
@@ -225,6 +225,28 @@ Eigen::Vector2d Camera::WorldToImage(const Eigen::Vector2d& world_point) const {
   return image_point;
 }
 
+std::vector<Eigen::Vector2d> Camera::ImageToWorld(
+    const std::vector<Eigen::Vector2d>& image_points) const {
+  std::vector<Eigen::Vector2d> world_points(image_points.size());
+  if (!image_points.empty()) {
+    CameraModelImageToWorldBatch(model_id_, params_, image_points.size(),
+                                 image_points[0].data(),
+                                 world_points[0].data());
+  }
+  return world_points;
+}
+
+std::vector<Eigen::Vector2d> Camera::WorldToImage(
+    const std::vector<Eigen::Vector2d>& world_points) const {
+  std::vector<Eigen::Vector2d> image_points(world_points.size());
+  if (!world_points.empty()) {
+    CameraModelWorldToImageBatch(model_id_, params_, world_points.size(),
+                                 world_points[0].data(),
+                                 image_points[0].data());
+  }
+  return image_points;
+}
+
 void Camera::Rescale(const double scale) {
   CHECK_GT(scale, 0.0);
   const double scale_x =
@@ -136,6 +136,13 @@ class Camera {
   // Project point from world / infinity to image plane.
   Eigen::Vector2d WorldToImage(const Eigen::Vector2d& world_point) const;
 
+  // Batched versions of `ImageToWorld` and `WorldToImage`, which dispatch on
+  // the camera model only once and use vectorized kernels.
+  std::vector<Eigen::Vector2d> ImageToWorld(
+      const std::vector<Eigen::Vector2d>& image_points) const;
+  std::vector<Eigen::Vector2d> WorldToImage(
+      const std::vector<Eigen::Vector2d>& world_points) const;
+
   // Rescale camera dimensions and accordingly the focal length and
   // and the principal point.
   void Rescale(const double scale);
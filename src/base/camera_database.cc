@@ -31,12 +31,12 @@
 
 #include "base/camera_database.h"
 
+#include <cstring>
+
 #include "util/string.h"
 
 namespace colmap {
 
-const camera_specs_t CameraDatabase::specs_ = InitializeCameraSpecs();
-
 CameraDatabase::CameraDatabase() {}
 
 bool CameraDatabase::QuerySensorWidth(const std::string& make,
@@ -58,21 +58,24 @@ bool CameraDatabase::QuerySensorWidth(const std::string& make,
   // Check if cleaned_make exists in database: Test whether EXIF string is
   // substring of database entry and vice versa.
   size_t spec_matches = 0;
-  for (const auto& make_elem : specs_) {
-    if (StringContains(cleaned_make, make_elem.first) ||
-        StringContains(make_elem.first, cleaned_make)) {
-      for (const auto& model_elem : make_elem.second) {
-        if (StringContains(cleaned_model, model_elem.first) ||
-            StringContains(model_elem.first, cleaned_model)) {
-          *sensor_width = model_elem.second;
-          if (cleaned_model == model_elem.first) {
-            // Model exactly matches, return immediately.
-            return true;
-          }
-          spec_matches += 1;
-          if (spec_matches > 1) {
-            break;
-          }
+  for (size_t i = 0; i < kNumCameraMakeSpecs; ++i) {
+    const CameraMakeSpecs& make_specs = kCameraMakeSpecs[i];
+    if (std::strstr(cleaned_make.c_str(), make_specs.make) == nullptr &&
+        std::strstr(make_specs.make, cleaned_make.c_str()) == nullptr) {
+      continue;
+    }
+    for (const CameraModelSpecs* model_specs = make_specs.models_begin;
+         model_specs != make_specs.models_end; ++model_specs) {
+      if (std::strstr(cleaned_model.c_str(), model_specs->model) != nullptr ||
+          std::strstr(model_specs->model, cleaned_model.c_str()) != nullptr) {
+        *sensor_width = model_specs->sensor_width;
+        if (cleaned_model == model_specs->model) {
+          // Model exactly matches, return immediately.
+          return true;
+        }
+        spec_matches += 1;
+        if (spec_matches > 1) {
+          break;
         }
       }
     }
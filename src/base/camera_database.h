@@ -44,13 +44,10 @@ class CameraDatabase {
  public:
   CameraDatabase();
 
-  size_t NumEntries() const { return specs_.size(); }
+  size_t NumEntries() const { return kNumCameraMakeSpecs; }
 
   bool QuerySensorWidth(const std::string& make, const std::string& model,
                         double* sensor_width);
-
- private:
-  static const camera_specs_t specs_;
 };
 
 }  // namespace colmap
@@ -32,14 +32,25 @@
 #define TEST_NAME "base/camera_database"
 #include "util/testing.h"
 
+#include <cstring>
+
 #include "base/camera_database.h"
 
 using namespace colmap;
 
 BOOST_AUTO_TEST_CASE(TestInitialization) {
   CameraDatabase database;
-  camera_specs_t specs = InitializeCameraSpecs();
-  BOOST_CHECK_EQUAL(database.NumEntries(), specs.size());
+  BOOST_CHECK_EQUAL(database.NumEntries(), kNumCameraMakeSpecs);
+  BOOST_CHECK_GT(kNumCameraMakeSpecs, 0);
+  for (size_t i = 0; i < kNumCameraMakeSpecs; ++i) {
+    BOOST_CHECK(kCameraMakeSpecs[i].models_begin <
+                kCameraMakeSpecs[i].models_end);
+    if (i > 0) {
+      BOOST_CHECK_LT(std::strcmp(kCameraMakeSpecs[i - 1].make,
+                                 kCameraMakeSpecs[i].make),
+                     0);
+    }
+  }
 }
 
 BOOST_AUTO_TEST_CASE(TestExactMatch) {
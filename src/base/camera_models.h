@@ -32,6 +32,7 @@
 #ifndef COLMAP_SRC_BASE_CAMERA_MODELS_H_
 #define COLMAP_SRC_BASE_CAMERA_MODELS_H_
 
+#include <algorithm>
 #include <cfloat>
 #include <string>
 #include <vector>
@@ -69,6 +70,9 @@ namespace colmap {
 //    as (u, v, 1).
 //  - `ImageToWorldThreshold`: transform a threshold given in pixels to
 //    normalized units (e.g. useful for reprojection error thresholds).
+//  - `ImageToWorldBatch`: batched version of `ImageToWorld` over an array of
+//    interleaved points. Models with iterative undistortion should lift all
+//    points first and then call `IterativeUndistortionBatch`.
 //
 // Whenever you specify the camera parameters in a list, they must appear
 // exactly in the order as they are accessed in the defined model struct.
@@ -110,6 +114,9 @@ static const int kInvalidCameraModelId = -1;
   template <typename T>                                                        \
   static void ImageToWorld(const T* params, const T x, const T y, T* u, T* v); \
   template <typename T>                                                        \
+  static void ImageToWorldBatch(const T* params, const size_t num_points,      \
+                                const T* xy, T* uv);                           \
+  template <typename T>                                                        \
   static void Distortion(const T* extra_params, const T u, const T v, T* du,   \
                          T* dv);
 #endif
@@ -173,6 +180,20 @@ struct BaseCameraModel {
 
   template <typename T>
   static inline void IterativeUndistortion(const T* params, T* u, T* v);
+
+  // Batched versions of `WorldToImage` and `IterativeUndistortion` that
+  // operate on arrays of interleaved (u, v) or (x, y) coordinates. The input
+  // and output arrays may alias. The per-point kernels are inlined for the
+  // concrete camera model, so that the compiler can vectorize the loops.
+  template <typename T>
+  static inline void WorldToImageBatch(const T* params,
+                                       const size_t num_points, const T* uv,
+                                       T* xy);
+
+  template <typename T>
+  static inline void IterativeUndistortionBatch(const T* params,
+                                                const size_t num_points,
+                                                T* uv);
 };
 
 // Simple Pinhole camera model.
@@ -449,6 +470,24 @@ inline void CameraModelImageToWorld(const int model_id,
                                     const double x, const double y, double* u,
                                     double* v);
 
+// Batched versions of `CameraModelWorldToImage` and `CameraModelImageToWorld`
+// that dispatch on the camera model only once for all points. The points are
+// given as interleaved arrays of (u, v) or (x, y) coordinates with
+// `2 * num_points` entries each, and the input and output arrays may alias.
+//
+// @param model_id      Unique identifier of camera model.
+// @param params        Array of camera parameters.
+// @param num_points    Number of points to transform.
+// @param uv, xy        Input and output coordinates.
+inline void CameraModelWorldToImageBatch(const int model_id,
+                                         const std::vector<double>& params,
+                                         const size_t num_points,
+                                         const double* uv, double* xy);
+inline void CameraModelImageToWorldBatch(const int model_id,
+                                         const std::vector<double>& params,
+                                         const size_t num_points,
+                                         const double* xy, double* uv);
+
 // Convert pixel threshold in image plane to world space by dividing
 // the threshold through the mean focal length.
 //
@@ -587,6 +626,82 @@ void BaseCameraModel<CameraModel>::IterativeUndistortion(const T* params, T* u,
   *v = x(1);
 }
 
+template <typename CameraModel>
+template <typename T>
+void BaseCameraModel<CameraModel>::WorldToImageBatch(const T* params,
+                                                     const size_t num_points,
+                                                     const T* uv, T* xy) {
+  for (size_t i = 0; i < num_points; ++i) {
+    const T u = uv[2 * i];
+    const T v = uv[2 * i + 1];
+    CameraModel::WorldToImage(params, u, v, &xy[2 * i], &xy[2 * i + 1]);
+  }
+}
+
+template <typename CameraModel>
+template <typename T>
+void BaseCameraModel<CameraModel>::IterativeUndistortionBatch(
+    const T* params, const size_t num_points, T* uv) {
+  // Same Newton iteration as in `IterativeUndistortion` but performed in
+  // lockstep for blocks of points. Converged points are masked out instead of
+  // branching, so that the inner loops are free of early exits.
+  const size_t kNumIterations = 100;
+  const double kMaxStepNorm = 1e-10;
+  const double kRelStepSize = 1e-6;
+  const size_t kBlockSize = 64;
+
+  T x0[2 * kBlockSize];
+  bool active[kBlockSize];
+
+  for (size_t begin = 0; begin < num_points; begin += kBlockSize) {
+    const size_t block_size = std::min(kBlockSize, num_points - begin);
+    T* x = uv + 2 * begin;
+
+    std::copy(x, x + 2 * block_size, x0);
+    std::fill(active, active + block_size, true);
+
+    for (size_t iter = 0; iter < kNumIterations; ++iter) {
+      size_t num_active = 0;
+      for (size_t i = 0; i < block_size; ++i) {
+        const T u = x[2 * i];
+        const T v = x[2 * i + 1];
+        const T step0 = std::max(std::numeric_limits<double>::epsilon(),
+                                 std::abs(kRelStepSize * u));
+        const T step1 = std::max(std::numeric_limits<double>::epsilon(),
+                                 std::abs(kRelStepSize * v));
+
+        T du, dv, du_0b, dv_0b, du_0f, dv_0f, du_1b, dv_1b, du_1f, dv_1f;
+        CameraModel::Distortion(params, u, v, &du, &dv);
+        CameraModel::Distortion(params, u - step0, v, &du_0b, &dv_0b);
+        CameraModel::Distortion(params, u + step0, v, &du_0f, &dv_0f);
+        CameraModel::Distortion(params, u, v - step1, &du_1b, &dv_1b);
+        CameraModel::Distortion(params, u, v + step1, &du_1f, &dv_1f);
+
+        const T J00 = 1 + (du_0f - du_0b) / (2 * step0);
+        const T J01 = (du_1f - du_1b) / (2 * step1);
+        const T J10 = (dv_0f - dv_0b) / (2 * step0);
+        const T J11 = 1 + (dv_1f - dv_1b) / (2 * step1);
+        const T inv_det = 1 / (J00 * J11 - J01 * J10);
+
+        const T r0 = u + du - x0[2 * i];
+        const T r1 = v + dv - x0[2 * i + 1];
+        const T step_u = inv_det * (J11 * r0 - J01 * r1);
+        const T step_v = inv_det * (J00 * r1 - J10 * r0);
+
+        x[2 * i] = active[i] ? u - step_u : u;
+        x[2 * i + 1] = active[i] ? v - step_v : v;
+        active[i] =
+            active[i] && !(step_u * step_u + step_v * step_v < kMaxStepNorm);
+        num_active += active[i];
+      }
+
+      if (num_active == 0) {
+        break;
+      }
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // SimplePinholeCameraModel
 
@@ -636,6 +751,17 @@ void SimplePinholeCameraModel::ImageToWorld(const T* params, const T x,
   *v = (y - c2) / f;
 }
 
+template <typename T>
+void SimplePinholeCameraModel::ImageToWorldBatch(const T* params,
+                                                 const size_t num_points,
+                                                 const T* xy, T* uv) {
+  for (size_t i = 0; i < num_points; ++i) {
+    const T x = xy[2 * i];
+    const T y = xy[2 * i + 1];
+    ImageToWorld(params, x, y, &uv[2 * i], &uv[2 * i + 1]);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // PinholeCameraModel
 
@@ -687,6 +813,17 @@ void PinholeCameraModel::ImageToWorld(const T* params, const T x, const T y,
   *v = (y - c2) / f2;
 }
 
+template <typename T>
+void PinholeCameraModel::ImageToWorldBatch(const T* params,
+                                           const size_t num_points, const T* xy,
+                                           T* uv) {
+  for (size_t i = 0; i < num_points; ++i) {
+    const T x = xy[2 * i];
+    const T y = xy[2 * i + 1];
+    ImageToWorld(params, x, y, &uv[2 * i], &uv[2 * i + 1]);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // SimpleRadialCameraModel
 
@@ -743,6 +880,23 @@ void SimpleRadialCameraModel::ImageToWorld(const T* params, const T x,
   IterativeUndistortion(&params[3], u, v);
 }
 
+template <typename T>
+void SimpleRadialCameraModel::ImageToWorldBatch(const T* params,
+                                                const size_t num_points,
+                                                const T* xy, T* uv) {
+  const T f = params[0];
+  const T c1 = params[1];
+  const T c2 = params[2];
+
+  // Lift points to normalized plane
+  for (size_t i = 0; i < num_points; ++i) {
+    uv[2 * i] = (xy[2 * i] - c1) / f;
+    uv[2 * i + 1] = (xy[2 * i + 1] - c2) / f;
+  }
+
+  IterativeUndistortionBatch(&params[3], num_points, uv);
+}
+
 template <typename T>
 void SimpleRadialCameraModel::Distortion(const T* extra_params, const T u,
                                          const T v, T* du, T* dv) {
@@ -812,6 +966,23 @@ void RadialCameraModel::ImageToWorld(const T* params, const T x, const T y,
   IterativeUndistortion(&params[3], u, v);
 }
 
+template <typename T>
+void RadialCameraModel::ImageToWorldBatch(const T* params,
+                                          const size_t num_points, const T* xy,
+                                          T* uv) {
+  const T f = params[0];
+  const T c1 = params[1];
+  const T c2 = params[2];
+
+  // Lift points to normalized plane
+  for (size_t i = 0; i < num_points; ++i) {
+    uv[2 * i] = (xy[2 * i] - c1) / f;
+    uv[2 * i + 1] = (xy[2 * i + 1] - c2) / f;
+  }
+
+  IterativeUndistortionBatch(&params[3], num_points, uv);
+}
+
 template <typename T>
 void RadialCameraModel::Distortion(const T* extra_params, const T u, const T v,
                                    T* du, T* dv) {
@@ -884,6 +1055,24 @@ void OpenCVCameraModel::ImageToWorld(const T* params, const T x, const T y,
   IterativeUndistortion(&params[4], u, v);
 }
 
+template <typename T>
+void OpenCVCameraModel::ImageToWorldBatch(const T* params,
+                                          const size_t num_points, const T* xy,
+                                          T* uv) {
+  const T f1 = params[0];
+  const T f2 = params[1];
+  const T c1 = params[2];
+  const T c2 = params[3];
+
+  // Lift points to normalized plane
+  for (size_t i = 0; i < num_points; ++i) {
+    uv[2 * i] = (xy[2 * i] - c1) / f1;
+    uv[2 * i + 1] = (xy[2 * i + 1] - c2) / f2;
+  }
+
+  IterativeUndistortionBatch(&params[4], num_points, uv);
+}
+
 template <typename T>
 void OpenCVCameraModel::Distortion(const T* extra_params, const T u, const T v,
                                    T* du, T* dv) {
@@ -959,6 +1148,24 @@ void OpenCVFisheyeCameraModel::ImageToWorld(const T* params, const T x,
   IterativeUndistortion(&params[4], u, v);
 }
 
+template <typename T>
+void OpenCVFisheyeCameraModel::ImageToWorldBatch(const T* params,
+                                                 const size_t num_points,
+                                                 const T* xy, T* uv) {
+  const T f1 = params[0];
+  const T f2 = params[1];
+  const T c1 = params[2];
+  const T c2 = params[3];
+
+  // Lift points to normalized plane
+  for (size_t i = 0; i < num_points; ++i) {
+    uv[2 * i] = (xy[2 * i] - c1) / f1;
+    uv[2 * i + 1] = (xy[2 * i + 1] - c2) / f2;
+  }
+
+  IterativeUndistortionBatch(&params[4], num_points, uv);
+}
+
 template <typename T>
 void OpenCVFisheyeCameraModel::Distortion(const T* extra_params, const T u,
                                           const T v, T* du, T* dv) {
@@ -1054,6 +1261,24 @@ void FullOpenCVCameraModel::ImageToWorld(const T* params, const T x, const T y,
   IterativeUndistortion(&params[4], u, v);
 }
 
+template <typename T>
+void FullOpenCVCameraModel::ImageToWorldBatch(const T* params,
+                                              const size_t num_points,
+                                              const T* xy, T* uv) {
+  const T f1 = params[0];
+  const T f2 = params[1];
+  const T c1 = params[2];
+  const T c2 = params[3];
+
+  // Lift points to normalized plane
+  for (size_t i = 0; i < num_points; ++i) {
+    uv[2 * i] = (xy[2 * i] - c1) / f1;
+    uv[2 * i + 1] = (xy[2 * i + 1] - c2) / f2;
+  }
+
+  IterativeUndistortionBatch(&params[4], num_points, uv);
+}
+
 template <typename T>
 void FullOpenCVCameraModel::Distortion(const T* extra_params, const T u,
                                        const T v, T* du, T* dv) {
@@ -1133,6 +1358,16 @@ void FOVCameraModel::ImageToWorld(const T* params, const T x, const T y, T* u,
   Undistortion(&params[4], uu, vv, u, v);
 }
 
+template <typename T>
+void FOVCameraModel::ImageToWorldBatch(const T* params, const size_t num_points,
+                                       const T* xy, T* uv) {
+  for (size_t i = 0; i < num_points; ++i) {
+    const T x = xy[2 * i];
+    const T y = xy[2 * i + 1];
+    ImageToWorld(params, x, y, &uv[2 * i], &uv[2 * i + 1]);
+  }
+}
+
 template <typename T>
 void FOVCameraModel::Distortion(const T* extra_params, const T u, const T v,
                                 T* du, T* dv) {
@@ -1268,6 +1503,23 @@ void SimpleRadialFisheyeCameraModel::ImageToWorld(const T* params, const T x,
   IterativeUndistortion(&params[3], u, v);
 }
 
+template <typename T>
+void SimpleRadialFisheyeCameraModel::ImageToWorldBatch(const T* params,
+                                                       const size_t num_points,
+                                                       const T* xy, T* uv) {
+  const T f = params[0];
+  const T c1 = params[1];
+  const T c2 = params[2];
+
+  // Lift points to normalized plane
+  for (size_t i = 0; i < num_points; ++i) {
+    uv[2 * i] = (xy[2 * i] - c1) / f;
+    uv[2 * i + 1] = (xy[2 * i + 1] - c2) / f;
+  }
+
+  IterativeUndistortionBatch(&params[3], num_points, uv);
+}
+
 template <typename T>
 void SimpleRadialFisheyeCameraModel::Distortion(const T* extra_params,
                                                 const T u, const T v, T* du,
@@ -1344,6 +1596,23 @@ void RadialFisheyeCameraModel::ImageToWorld(const T* params, const T x,
   IterativeUndistortion(&params[3], u, v);
 }
 
+template <typename T>
+void RadialFisheyeCameraModel::ImageToWorldBatch(const T* params,
+                                                 const size_t num_points,
+                                                 const T* xy, T* uv) {
+  const T f = params[0];
+  const T c1 = params[1];
+  const T c2 = params[2];
+
+  // Lift points to normalized plane
+  for (size_t i = 0; i < num_points; ++i) {
+    uv[2 * i] = (xy[2 * i] - c1) / f;
+    uv[2 * i + 1] = (xy[2 * i + 1] - c2) / f;
+  }
+
+  IterativeUndistortionBatch(&params[3], num_points, uv);
+}
+
 template <typename T>
 void RadialFisheyeCameraModel::Distortion(const T* extra_params, const T u,
                                           const T v, T* du, T* dv) {
@@ -1456,6 +1725,36 @@ void ThinPrismFisheyeCameraModel::ImageToWorld(const T* params, const T x,
   }
 }
 
+template <typename T>
+void ThinPrismFisheyeCameraModel::ImageToWorldBatch(const T* params,
+                                                    const size_t num_points,
+                                                    const T* xy, T* uv) {
+  const T f1 = params[0];
+  const T f2 = params[1];
+  const T c1 = params[2];
+  const T c2 = params[3];
+
+  // Lift points to normalized plane
+  for (size_t i = 0; i < num_points; ++i) {
+    uv[2 * i] = (xy[2 * i] - c1) / f1;
+    uv[2 * i + 1] = (xy[2 * i + 1] - c2) / f2;
+  }
+
+  IterativeUndistortionBatch(&params[4], num_points, uv);
+
+  for (size_t i = 0; i < num_points; ++i) {
+    const T u = uv[2 * i];
+    const T v = uv[2 * i + 1];
+    const T theta = ceres::sqrt(u * u + v * v);
+    const T theta_cos_theta = theta * ceres::cos(theta);
+    if (theta_cos_theta > T(std::numeric_limits<double>::epsilon())) {
+      const T scale = ceres::sin(theta) / theta_cos_theta;
+      uv[2 * i] *= scale;
+      uv[2 * i + 1] *= scale;
+    }
+  }
+}
+
 template <typename T>
 void ThinPrismFisheyeCameraModel::Distortion(const T* extra_params, const T u,
                                              const T v, T* du, T* dv) {
@@ -1512,6 +1811,38 @@ void CameraModelImageToWorld(const int model_id,
   }
 }
 
+void CameraModelWorldToImageBatch(const int model_id,
+                                  const std::vector<double>& params,
+                                  const size_t num_points, const double* uv,
+                                  double* xy) {
+  switch (model_id) {
+#define CAMERA_MODEL_CASE(CameraModel)                                \
+  case CameraModel::kModelId:                                         \
+    CameraModel::WorldToImageBatch(params.data(), num_points, uv, xy); \
+    break;
+
+    CAMERA_MODEL_SWITCH_CASES
+
+#undef CAMERA_MODEL_CASE
+  }
+}
+
+void CameraModelImageToWorldBatch(const int model_id,
+                                  const std::vector<double>& params,
+                                  const size_t num_points, const double* xy,
+                                  double* uv) {
+  switch (model_id) {
+#define CAMERA_MODEL_CASE(CameraModel)                                \
+  case CameraModel::kModelId:                                         \
+    CameraModel::ImageToWorldBatch(params.data(), num_points, xy, uv); \
+    break;
+
+    CAMERA_MODEL_SWITCH_CASES
+
+#undef CAMERA_MODEL_CASE
+  }
+}
+
 double CameraModelImageToWorldThreshold(const int model_id,
                                         const std::vector<double>& params,
                                         const double threshold) {
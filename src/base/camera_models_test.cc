@@ -62,6 +62,51 @@ void TestImageToWorldToImage(const std::vector<double> params, const double x0,
   BOOST_CHECK_LT(std::abs(y - y0), 1e-6);
 }
 
+template <typename CameraModel>
+void TestBatch(const std::vector<double>& params) {
+  std::vector<double> world_points;
+  for (double u = -0.5; u <= 0.5; u += 0.1) {
+    for (double v = -0.5; v <= 0.5; v += 0.1) {
+      world_points.push_back(u);
+      world_points.push_back(v);
+    }
+  }
+
+  const size_t num_points = world_points.size() / 2;
+  std::vector<double> image_points(world_points.size());
+  CameraModelWorldToImageBatch(CameraModel::model_id, params, num_points,
+                               world_points.data(), image_points.data());
+  for (size_t i = 0; i < num_points; ++i) {
+    double x, y;
+    CameraModel::WorldToImage(params.data(), world_points[2 * i],
+                              world_points[2 * i + 1], &x, &y);
+    BOOST_CHECK_EQUAL(image_points[2 * i], x);
+    BOOST_CHECK_EQUAL(image_points[2 * i + 1], y);
+  }
+
+  std::vector<double> world_points2(image_points.size());
+  CameraModelImageToWorldBatch(CameraModel::model_id, params, num_points,
+                               image_points.data(), world_points2.data());
+  for (size_t i = 0; i < num_points; ++i) {
+    double u, v;
+    CameraModel::ImageToWorld(params.data(), image_points[2 * i],
+                              image_points[2 * i + 1], &u, &v);
+    BOOST_CHECK_LT(std::abs(world_points2[2 * i] - u), 1e-10);
+    BOOST_CHECK_LT(std::abs(world_points2[2 * i + 1] - v), 1e-10);
+    BOOST_CHECK_LT(std::abs(world_points2[2 * i] - world_points[2 * i]),
+                   1e-6);
+    BOOST_CHECK_LT(
+        std::abs(world_points2[2 * i + 1] - world_points[2 * i + 1]), 1e-6);
+  }
+
+  // In-place transformation.
+  CameraModelImageToWorldBatch(CameraModel::model_id, params, num_points,
+                               image_points.data(), image_points.data());
+  for (size_t i = 0; i < image_points.size(); ++i) {
+    BOOST_CHECK_EQUAL(image_points[i], world_points2[i]);
+  }
+}
+
 template <typename CameraModel>
 void TestModel(const std::vector<double>& params) {
   BOOST_CHECK(CameraModelVerifyParams(CameraModel::model_id, params));
@@ -125,6 +170,8 @@ void TestModel(const std::vector<double>& params) {
     }
   }
 
+  TestBatch<CameraModel>(params);
+
   const auto pp_idxs = CameraModel::principal_point_idxs;
   TestImageToWorldToImage<CameraModel>(params, params[pp_idxs.at(0)],
                                        params[pp_idxs.at(1)]);
@@ -31,7 +31,11 @@
 
 #include "base/camera_rig.h"
 
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
 #include "util/misc.h"
+#include "util/string.h"
 
 namespace colmap {
 
@@ -252,4 +256,65 @@ void CameraRig::ComputeAbsolutePose(const size_t snapshot_idx,
   *abs_tvec /= snapshot.size();
 }
 
+std::vector<CameraRig> ReadCameraRigConfig(
+    const std::string& rig_config_path, const Reconstruction& reconstruction,
+    const bool estimate_relative_poses) {
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(rig_config_path.c_str(), pt);
+
+  std::vector<CameraRig> camera_rigs;
+  for (const auto& rig_config : pt) {
+    CameraRig camera_rig;
+
+    std::vector<std::string> image_prefixes;
+    for (const auto& camera : rig_config.second.get_child("cameras")) {
+      const int camera_id = camera.second.get<int>("camera_id");
+      image_prefixes.push_back(camera.second.get<std::string>("image_prefix"));
+      camera_rig.AddCamera(camera_id, ComposeIdentityQuaternion(),
+                           Eigen::Vector3d(0, 0, 0));
+    }
+
+    camera_rig.SetRefCameraId(rig_config.second.get<int>("ref_camera_id"));
+
+    std::unordered_map<std::string, std::vector<image_t>> snapshots;
+    for (const auto& image_id_and_image : reconstruction.Images()) {
+      const image_t image_id = image_id_and_image.first;
+      const auto& image = image_id_and_image.second;
+      if (estimate_relative_poses && !image.IsRegistered()) {
+        continue;
+      }
+      for (const auto& image_prefix : image_prefixes) {
+        if (StringContains(image.Name(), image_prefix)) {
+          const std::string image_suffix =
+              StringGetAfter(image.Name(), image_prefix);
+          snapshots[image_suffix].push_back(image_id);
+        }
+      }
+    }
+
+    for (const auto& snapshot : snapshots) {
+      bool has_ref_camera = false;
+      for (const auto image_id : snapshot.second) {
+        const auto& image = reconstruction.Image(image_id);
+        if (image.CameraId() == camera_rig.RefCameraId()) {
+          has_ref_camera = true;
+        }
+      }
+
+      if (has_ref_camera) {
+        camera_rig.AddSnapshot(snapshot.second);
+      }
+    }
+
+    if (estimate_relative_poses) {
+      camera_rig.Check(reconstruction);
+      camera_rig.ComputeRelativePoses(reconstruction);
+    }
+
+    camera_rigs.push_back(camera_rig);
+  }
+
+  return camera_rigs;
+}
+
 }  // namespace colmap
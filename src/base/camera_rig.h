@@ -32,6 +32,7 @@
 #ifndef COLMAP_SRC_BASE_CAMERA_RIG_H_
 #define COLMAP_SRC_BASE_CAMERA_RIG_H_
 
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -123,6 +124,82 @@ class CameraRig {
   std::vector<std::vector<image_t>> snapshots_;
 };
 
+// Read the configuration of the camera rigs from a JSON file. The input images
+// of a camera rig must be named consistently to assign them to the appropriate
+// camera rig and the respective snapshots.
+//
+// An example configuration of a single camera rig:
+// [
+//   {
+//     "ref_camera_id": 1,
+//     "cameras":
+//     [
+//       {
+//           "camera_id": 1,
+//           "image_prefix": "left1_image"
+//       },
+//       {
+//           "camera_id": 2,
+//           "image_prefix": "left2_image"
+//       },
+//       {
+//           "camera_id": 3,
+//           "image_prefix": "right1_image"
+//       },
+//       {
+//           "camera_id": 4,
+//           "image_prefix": "right2_image"
+//       }
+//     ]
+//   }
+// ]
+//
+// This file specifies the configuration for a single camera rig and that you
+// could potentially define multiple camera rigs. The rig is composed of 4
+// cameras: all images of the first camera must have "left1_image" as a name
+// prefix, e.g., "left1_image_frame000.png" or "left1_image/frame000.png".
+// Images with the same suffix ("_frame000.png" and "/frame000.png") are
+// assigned to the same snapshot, i.e., they are assumed to be captured at the
+// same time. Only snapshots with the reference image registered will be added
+// to the bundle adjustment problem. The remaining images will be added with
+// independent poses to the bundle adjustment problem. The above configuration
+// could have the following input image file structure:
+//
+//    /path/to/images/...
+//        left1_image/...
+//            frame000.png
+//            frame001.png
+//            frame002.png
+//            ...
+//        left2_image/...
+//            frame000.png
+//            frame001.png
+//            frame002.png
+//            ...
+//        right1_image/...
+//            frame000.png
+//            frame001.png
+//            frame002.png
+//            ...
+//        right2_image/...
+//            frame000.png
+//            frame001.png
+//            frame002.png
+//            ...
+//
+// If `estimate_relative_poses` is true, the snapshots are composed of the
+// registered images and the relative extrinsics of the camera rig are inferred
+// from the reconstruction. Otherwise, the snapshots are composed of all images
+// in the reconstruction and the relative poses are left as identity, e.g., to
+// be estimated incrementally during the reconstruction.
+//
+// TODO: Provide an option to manually / explicitly set the relative extrinsics
+// of the camera rig. At the moment, the relative extrinsics are automatically
+// inferred from the reconstruction.
+std::vector<CameraRig> ReadCameraRigConfig(
+    const std::string& rig_config_path, const Reconstruction& reconstruction,
+    const bool estimate_relative_poses = true);
+
 }  // namespace colmap
 
 #endif  // COLMAP_SRC_BASE_CAMERA_RIG_H_
@@ -32,7 +32,10 @@
 #define TEST_NAME "base/camera_rig"
 #include "util/testing.h"
 
+#include <fstream>
+
 #include "base/camera_rig.h"
+#include "util/misc.h"
 
 using namespace colmap;
 
@@ -329,3 +332,55 @@ BOOST_AUTO_TEST_CASE(TestComputeAbsolutePose) {
   BOOST_CHECK_EQUAL(abs_qvec, ComposeIdentityQuaternion());
   BOOST_CHECK_EQUAL(abs_tvec, Eigen::Vector3d(0, -1, -2));
 }
+
+BOOST_AUTO_TEST_CASE(TestReadCameraRigConfig) {
+  const auto test_dir = boost::filesystem::temp_directory_path() /
+                        boost::filesystem::unique_path();
+  CreateDirIfNotExists(test_dir.string());
+  const std::string rig_config_path = (test_dir / "rig_config.json").string();
+
+  {
+    std::ofstream file(rig_config_path);
+    file << "[{\"ref_camera_id\": 1, \"cameras\": ["
+            "{\"camera_id\": 1, \"image_prefix\": \"left/\"},"
+            "{\"camera_id\": 2, \"image_prefix\": \"right/\"}]}]";
+  }
+
+  Reconstruction reconstruction;
+
+  for (camera_t camera_id = 1; camera_id <= 2; ++camera_id) {
+    Camera camera;
+    camera.SetCameraId(camera_id);
+    camera.InitializeWithName("PINHOLE", 1, 1, 1);
+    reconstruction.AddCamera(camera);
+  }
+
+  const std::vector<std::string> image_names = {
+      "left/000.png", "right/000.png", "left/001.png", "right/002.png"};
+  for (size_t i = 0; i < image_names.size(); ++i) {
+    Image image;
+    image.SetImageId(i);
+    image.SetCameraId(image_names[i].find("left") == 0 ? 1 : 2);
+    image.SetName(image_names[i]);
+    reconstruction.AddImage(image);
+  }
+
+  // Without estimating the relative poses, all images are assigned to
+  // snapshots, except for the snapshot without the reference camera.
+  const auto camera_rigs = ReadCameraRigConfig(
+      rig_config_path, reconstruction, /*estimate_relative_poses=*/false);
+  BOOST_CHECK_EQUAL(camera_rigs.size(), 1);
+  BOOST_CHECK_EQUAL(camera_rigs[0].NumCameras(), 2);
+  BOOST_CHECK_EQUAL(camera_rigs[0].RefCameraId(), 1);
+  BOOST_CHECK_EQUAL(camera_rigs[0].NumSnapshots(), 2);
+  size_t num_snapshot_images = 0;
+  for (const auto& snapshot : camera_rigs[0].Snapshots()) {
+    num_snapshot_images += snapshot.size();
+  }
+  BOOST_CHECK_EQUAL(num_snapshot_images, 3);
+  BOOST_CHECK_EQUAL(camera_rigs[0].RelativeQvec(2),
+                    ComposeIdentityQuaternion());
+  BOOST_CHECK_EQUAL(camera_rigs[0].RelativeTvec(2), Eigen::Vector3d::Zero());
+
+  boost::filesystem::remove_all(test_dir);
+}
@@ -308,6 +308,32 @@ BOOST_AUTO_TEST_CASE(TestWorldToImage) {
   BOOST_CHECK_EQUAL(camera.WorldToImage(Eigen::Vector2d(-0.5, -0.5))(1), 0.0);
 }
 
+BOOST_AUTO_TEST_CASE(TestImageToWorldToImageBatch) {
+  Camera camera;
+  camera.InitializeWithName("OPENCV", 100.0, 100, 80);
+  camera.SetParams({100, 110, 50, 40, 0.1, -0.05, 0.01, -0.02});
+  std::vector<Eigen::Vector2d> image_points;
+  for (double x = 0; x <= 100; x += 10) {
+    for (double y = 0; y <= 80; y += 10) {
+      image_points.emplace_back(x, y);
+    }
+  }
+  const std::vector<Eigen::Vector2d> world_points =
+      camera.ImageToWorld(image_points);
+  const std::vector<Eigen::Vector2d> image_points2 =
+      camera.WorldToImage(world_points);
+  BOOST_CHECK_EQUAL(world_points.size(), image_points.size());
+  BOOST_CHECK_EQUAL(image_points2.size(), image_points.size());
+  for (size_t i = 0; i < image_points.size(); ++i) {
+    BOOST_CHECK_LT(
+        (world_points[i] - camera.ImageToWorld(image_points[i])).norm(),
+        1e-10);
+    BOOST_CHECK_EQUAL(image_points2[i], camera.WorldToImage(world_points[i]));
+    BOOST_CHECK_LT((image_points2[i] - image_points[i]).norm(), 1e-6);
+  }
+  BOOST_CHECK(camera.ImageToWorld(std::vector<Eigen::Vector2d>()).empty());
+}
+
 BOOST_AUTO_TEST_CASE(TestRescale) {
   Camera camera;
   camera.InitializeWithName("SIMPLE_PINHOLE", 1.0, 1, 1);
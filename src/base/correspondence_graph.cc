@@ -31,10 +31,13 @@
 
 #include "base/correspondence_graph.h"
 
+#include <functional>
 #include <unordered_set>
 
 #include "base/pose.h"
+#include "util/endian.h"
 #include "util/string.h"
+#include "util/threading.h"
 
 namespace colmap {
 
@@ -51,12 +54,34 @@ CorrespondenceGraph::NumCorrespondencesBetweenImages() const {
   return num_corrs_between_images;
 }
 
+size_t CorrespondenceGraph::NumBytes() const {
+  size_t num_bytes =
+      sizeof(CorrespondenceGraph) +
+      image_pairs_.size() * (sizeof(image_pair_t) + sizeof(ImagePair));
+  for (const auto& image : images_) {
+    num_bytes += sizeof(image_t) + sizeof(Image) +
+                 image.second.corrs.capacity() *
+                     sizeof(std::vector<Correspondence>) +
+                 image.second.corrs_offsets.capacity() * sizeof(point2D_t) +
+                 image.second.flat_corrs.capacity() * sizeof(Correspondence);
+    for (const auto& point2D_corrs : image.second.corrs) {
+      num_bytes += point2D_corrs.capacity() * sizeof(Correspondence);
+    }
+  }
+  return num_bytes;
+}
+
 void CorrespondenceGraph::Finalize() {
   for (auto it = images_.begin(); it != images_.end();) {
+    // Images without new correspondences since the last call are unchanged.
+    if (it->second.IsFinalized()) {
+      ++it;
+      continue;
+    }
+    it->second.Pack();
     it->second.num_observations = 0;
-    for (auto& corr : it->second.corrs) {
-      corr.shrink_to_fit();
-      if (corr.size() > 0) {
+    for (size_t i = 0; i + 1 < it->second.corrs_offsets.size(); ++i) {
+      if (it->second.corrs_offsets[i + 1] > it->second.corrs_offsets[i]) {
         it->second.num_observations += 1;
       }
     }
@@ -88,6 +113,10 @@ void CorrespondenceGraph::AddCorrespondences(const image_t image_id1,
   struct Image& image1 = images_.at(image_id1);
   struct Image& image2 = images_.at(image_id2);
 
+  // Correspondences can only be added in the growable layout.
+  image1.Unpack();
+  image2.Unpack();
+
   // Store number of correspondences for each image to find good initial pair.
   image1.num_correspondences += matches.size();
   image2.num_correspondences += matches.size();
@@ -160,12 +189,174 @@ void CorrespondenceGraph::AddCorrespondences(const image_t image_id1,
   }
 }
 
+void CorrespondenceGraph::AddCorrespondences(
+    const std::vector<image_pair_t>& pair_ids,
+    const std::vector<const FeatureMatches*>& matches, const int num_threads) {
+  CHECK_EQ(pair_ids.size(), matches.size());
+
+  const size_t num_pairs = pair_ids.size();
+
+  std::vector<image_t> image_ids1(num_pairs);
+  std::vector<image_t> image_ids2(num_pairs);
+  for (size_t i = 0; i < num_pairs; ++i) {
+    Database::PairIdToImagePair(pair_ids[i], &image_ids1[i], &image_ids2[i]);
+    CHECK(ExistsImage(image_ids1[i])) << image_ids1[i];
+    CHECK(ExistsImage(image_ids2[i])) << image_ids2[i];
+  }
+
+  // Remove invalid and duplicate matches of each image pair independently.
+  // Since the image pairs are new, a match is a duplicate if and only if one
+  // of its points was already used by a previous match of the same pair.
+  std::vector<FeatureMatches> valid_matches(num_pairs);
+  std::vector<std::string> warnings(num_pairs);
+
+  auto FilterMatches = [&](const size_t begin_idx, const size_t end_idx) {
+    for (size_t i = begin_idx; i < end_idx; ++i) {
+      const image_t image_id1 = image_ids1[i];
+      const image_t image_id2 = image_ids2[i];
+      if (image_id1 == image_id2) {
+        warnings[i] += StringPrintf(
+            "WARNING: Cannot use self-matches for image_id=%d\n", image_id1);
+        continue;
+      }
+
+      const size_t num_points2D1 = images_.at(image_id1).NumPoints2D();
+      const size_t num_points2D2 = images_.at(image_id2).NumPoints2D();
+      std::vector<bool> used_points2D1(num_points2D1, false);
+      std::vector<bool> used_points2D2(num_points2D2, false);
+
+      valid_matches[i].reserve(matches[i]->size());
+      for (const auto& match : *matches[i]) {
+        const bool valid_idx1 = match.point2D_idx1 < num_points2D1;
+        const bool valid_idx2 = match.point2D_idx2 < num_points2D2;
+
+        if (valid_idx1 && valid_idx2) {
+          if (used_points2D1[match.point2D_idx1] ||
+              used_points2D2[match.point2D_idx2]) {
+            warnings[i] += StringPrintf(
+                "WARNING: Duplicate correspondence between "
+                "point2D_idx=%d in image_id=%d and point2D_idx=%d in "
+                "image_id=%d\n",
+                match.point2D_idx1, image_id1, match.point2D_idx2, image_id2);
+          } else {
+            used_points2D1[match.point2D_idx1] = true;
+            used_points2D2[match.point2D_idx2] = true;
+            valid_matches[i].push_back(match);
+          }
+        } else {
+          if (!valid_idx1) {
+            warnings[i] += StringPrintf(
+                "WARNING: point2D_idx=%d in image_id=%d does not exist\n",
+                match.point2D_idx1, image_id1);
+          }
+          if (!valid_idx2) {
+            warnings[i] += StringPrintf(
+                "WARNING: point2D_idx=%d in image_id=%d does not exist\n",
+                match.point2D_idx2, image_id2);
+          }
+        }
+      }
+    }
+  };
+
+  // Insert the correspondences of each image independently, by visiting its
+  // image pairs in the given order.
+  std::vector<image_t> image_ids;
+  std::unordered_map<image_t, std::vector<std::pair<size_t, bool>>>
+      image_pair_idxs;
+
+  auto InsertCorrespondences = [&](const size_t begin_idx,
+                                   const size_t end_idx) {
+    for (size_t i = begin_idx; i < end_idx; ++i) {
+      struct Image& image = images_.at(image_ids[i]);
+      for (const auto& pair_idx : image_pair_idxs.at(image_ids[i])) {
+        const bool is_first = pair_idx.second;
+        const image_t other_image_id = is_first ? image_ids2[pair_idx.first]
+                                                : image_ids1[pair_idx.first];
+        for (const auto& match : valid_matches[pair_idx.first]) {
+          if (is_first) {
+            image.corrs[match.point2D_idx1].emplace_back(other_image_id,
+                                                         match.point2D_idx2);
+          } else {
+            image.corrs[match.point2D_idx2].emplace_back(other_image_id,
+                                                         match.point2D_idx1);
+          }
+        }
+      }
+    }
+  };
+
+  auto ParallelFor = [num_threads](const size_t num_items,
+                                   const std::function<void(size_t, size_t)>&
+                                       func) {
+    const int num_eff_threads = std::min<int>(
+        GetEffectiveNumThreads(num_threads), std::max<size_t>(num_items, 1));
+    if (num_eff_threads <= 1) {
+      func(0, num_items);
+      return;
+    }
+    ThreadPool thread_pool(num_eff_threads);
+    const size_t chunk_size =
+        (num_items + num_eff_threads - 1) / num_eff_threads;
+    for (size_t begin_idx = 0; begin_idx < num_items; begin_idx += chunk_size) {
+      thread_pool.AddTask(func, begin_idx,
+                          std::min(begin_idx + chunk_size, num_items));
+    }
+    thread_pool.Wait();
+  };
+
+  ParallelFor(num_pairs, FilterMatches);
+
+  for (size_t i = 0; i < num_pairs; ++i) {
+    if (!warnings[i].empty()) {
+      std::cout << warnings[i] << std::flush;
+    }
+
+    const image_t image_id1 = image_ids1[i];
+    const image_t image_id2 = image_ids2[i];
+    if (image_id1 == image_id2) {
+      continue;
+    }
+
+    struct Image& image1 = images_.at(image_id1);
+    struct Image& image2 = images_.at(image_id2);
+    image1.Unpack();
+    image2.Unpack();
+
+    const point2D_t num_correspondences =
+        static_cast<point2D_t>(valid_matches[i].size());
+    image1.num_correspondences += num_correspondences;
+    image2.num_correspondences += num_correspondences;
+
+    CHECK(image_pairs_.emplace(pair_ids[i], ImagePair()).second)
+        << "Image pair " << image_id1 << ", " << image_id2
+        << " was already added";
+    image_pairs_[pair_ids[i]].num_correspondences = num_correspondences;
+
+    auto& pair_idxs1 = image_pair_idxs[image_id1];
+    if (pair_idxs1.empty()) {
+      image_ids.push_back(image_id1);
+    }
+    pair_idxs1.emplace_back(i, true);
+
+    auto& pair_idxs2 = image_pair_idxs[image_id2];
+    if (pair_idxs2.empty()) {
+      image_ids.push_back(image_id2);
+    }
+    pair_idxs2.emplace_back(i, false);
+  }
+
+  ParallelFor(image_ids.size(), InsertCorrespondences);
+}
+
 std::vector<CorrespondenceGraph::Correspondence>
 CorrespondenceGraph::FindTransitiveCorrespondences(
     const image_t image_id, const point2D_t point2D_idx,
     const size_t transitivity) const {
   if (transitivity == 1) {
-    return FindCorrespondences(image_id, point2D_idx);
+    const CorrespondenceRange corrs =
+        FindCorrespondences(image_id, point2D_idx);
+    return std::vector<Correspondence>(corrs.begin(), corrs.end());
   }
 
   std::vector<Correspondence> found_corrs;
@@ -188,8 +379,7 @@ CorrespondenceGraph::FindTransitiveCorrespondences(
       const Correspondence ref_corr = found_corrs[i];
 
       const Image& image = images_.at(ref_corr.image_id);
-      const std::vector<Correspondence>& ref_corrs =
-          image.corrs[ref_corr.point2D_idx];
+      const CorrespondenceRange ref_corrs = image.Corrs(ref_corr.point2D_idx);
 
       for (const Correspondence corr : ref_corrs) {
         // Check if correspondence already collected, otherwise collect.
@@ -235,9 +425,9 @@ FeatureMatches CorrespondenceGraph::FindCorrespondencesBetweenImages(
 
   const struct Image& image1 = images_.at(image_id1);
 
-  for (point2D_t point2D_idx1 = 0; point2D_idx1 < image1.corrs.size();
+  for (point2D_t point2D_idx1 = 0; point2D_idx1 < image1.NumPoints2D();
        ++point2D_idx1) {
-    for (const Correspondence& corr1 : image1.corrs[point2D_idx1]) {
+    for (const Correspondence& corr1 : image1.Corrs(point2D_idx1)) {
       if (corr1.image_id == image_id2) {
         found_corrs.emplace_back(point2D_idx1, corr1.point2D_idx);
       }
@@ -250,14 +440,128 @@ FeatureMatches CorrespondenceGraph::FindCorrespondencesBetweenImages(
 bool CorrespondenceGraph::IsTwoViewObservation(
     const image_t image_id, const point2D_t point2D_idx) const {
   const struct Image& image = images_.at(image_id);
-  const std::vector<Correspondence>& corrs = image.corrs.at(point2D_idx);
+  const CorrespondenceRange corrs = image.Corrs(point2D_idx);
   if (corrs.size() != 1) {
     return false;
   }
   const struct Image& other_image = images_.at(corrs[0].image_id);
-  const std::vector<Correspondence>& other_corrs =
-      other_image.corrs.at(corrs[0].point2D_idx);
-  return other_corrs.size() == 1;
+  return other_image.Corrs(corrs[0].point2D_idx).size() == 1;
+}
+
+void CorrespondenceGraph::Write(std::ostream* stream) const {
+  WriteBinaryLittleEndian<uint64_t>(stream, images_.size());
+  for (const auto& image : images_) {
+    WriteBinaryLittleEndian<image_t>(stream, image.first);
+    WriteBinaryLittleEndian<point2D_t>(stream, image.second.num_observations);
+    WriteBinaryLittleEndian<point2D_t>(stream,
+                                       image.second.num_correspondences);
+    const size_t num_points2D = image.second.NumPoints2D();
+    WriteBinaryLittleEndian<uint64_t>(stream, num_points2D);
+
+    point2D_t num_points2D_with_corrs = 0;
+    for (point2D_t point2D_idx = 0; point2D_idx < num_points2D;
+         ++point2D_idx) {
+      if (!image.second.Corrs(point2D_idx).empty()) {
+        num_points2D_with_corrs += 1;
+      }
+    }
+    WriteBinaryLittleEndian<point2D_t>(stream, num_points2D_with_corrs);
+
+    for (point2D_t point2D_idx = 0; point2D_idx < num_points2D;
+         ++point2D_idx) {
+      const CorrespondenceRange corrs = image.second.Corrs(point2D_idx);
+      if (corrs.empty()) {
+        continue;
+      }
+      WriteBinaryLittleEndian<point2D_t>(stream, point2D_idx);
+      WriteBinaryLittleEndian<uint64_t>(stream, corrs.size());
+      for (const auto& corr : corrs) {
+        WriteBinaryLittleEndian<image_t>(stream, corr.image_id);
+        WriteBinaryLittleEndian<point2D_t>(stream, corr.point2D_idx);
+      }
+    }
+  }
+
+  WriteBinaryLittleEndian<uint64_t>(stream, image_pairs_.size());
+  for (const auto& image_pair : image_pairs_) {
+    WriteBinaryLittleEndian<image_pair_t>(stream, image_pair.first);
+    WriteBinaryLittleEndian<point2D_t>(stream,
+                                       image_pair.second.num_correspondences);
+  }
+}
+
+void CorrespondenceGraph::Read(std::istream* stream) {
+  images_.clear();
+  image_pairs_.clear();
+
+  const size_t num_images = ReadBinaryLittleEndian<uint64_t>(stream);
+  images_.reserve(num_images);
+  for (size_t i = 0; i < num_images; ++i) {
+    const image_t image_id = ReadBinaryLittleEndian<image_t>(stream);
+    CHECK(!ExistsImage(image_id));
+    struct Image& image = images_[image_id];
+    image.num_observations = ReadBinaryLittleEndian<point2D_t>(stream);
+    image.num_correspondences = ReadBinaryLittleEndian<point2D_t>(stream);
+    image.corrs.resize(ReadBinaryLittleEndian<uint64_t>(stream));
+
+    const point2D_t num_points2D_with_corrs =
+        ReadBinaryLittleEndian<point2D_t>(stream);
+    for (point2D_t j = 0; j < num_points2D_with_corrs; ++j) {
+      const point2D_t point2D_idx = ReadBinaryLittleEndian<point2D_t>(stream);
+      auto& corrs = image.corrs.at(point2D_idx);
+      corrs.resize(ReadBinaryLittleEndian<uint64_t>(stream));
+      for (auto& corr : corrs) {
+        corr.image_id = ReadBinaryLittleEndian<image_t>(stream);
+        corr.point2D_idx = ReadBinaryLittleEndian<point2D_t>(stream);
+      }
+    }
+  }
+
+  const size_t num_image_pairs = ReadBinaryLittleEndian<uint64_t>(stream);
+  image_pairs_.reserve(num_image_pairs);
+  for (size_t i = 0; i < num_image_pairs; ++i) {
+    const image_pair_t pair_id = ReadBinaryLittleEndian<image_pair_t>(stream);
+    image_pairs_[pair_id].num_correspondences =
+        ReadBinaryLittleEndian<point2D_t>(stream);
+  }
+}
+
+void CorrespondenceGraph::Image::Pack() {
+  if (IsFinalized()) {
+    return;
+  }
+
+  corrs_offsets.resize(corrs.size() + 1);
+  corrs_offsets[0] = 0;
+  for (size_t i = 0; i < corrs.size(); ++i) {
+    corrs_offsets[i + 1] =
+        corrs_offsets[i] + static_cast<point2D_t>(corrs[i].size());
+  }
+
+  flat_corrs.clear();
+  flat_corrs.reserve(corrs_offsets.back());
+  for (const auto& point2D_corrs : corrs) {
+    flat_corrs.insert(flat_corrs.end(), point2D_corrs.begin(),
+                      point2D_corrs.end());
+  }
+
+  // Release the memory of the growable layout.
+  std::vector<std::vector<Correspondence>>().swap(corrs);
+}
+
+void CorrespondenceGraph::Image::Unpack() {
+  if (!IsFinalized()) {
+    return;
+  }
+
+  corrs.resize(corrs_offsets.size() - 1);
+  for (size_t i = 0; i < corrs.size(); ++i) {
+    corrs[i].assign(flat_corrs.begin() + corrs_offsets[i],
+                    flat_corrs.begin() + corrs_offsets[i + 1]);
+  }
+
+  std::vector<point2D_t>().swap(corrs_offsets);
+  std::vector<Correspondence>().swap(flat_corrs);
 }
 
 }  // namespace colmap
@@ -32,6 +32,7 @@
 #ifndef COLMAP_SRC_BASE_CORRESPONDENCE_GRAPH_H_
 #define COLMAP_SRC_BASE_CORRESPONDENCE_GRAPH_H_
 
+#include <iostream>
 #include <unordered_map>
 #include <vector>
 
@@ -57,6 +58,31 @@ class CorrespondenceGraph {
     point2D_t point2D_idx;
   };
 
+  // Contiguous range of correspondences of a single image point. The range is
+  // invalidated when correspondences are added or the graph is finalized.
+  class CorrespondenceRange {
+   public:
+    CorrespondenceRange() : begin_(nullptr), end_(nullptr) {}
+    CorrespondenceRange(const Correspondence* begin, const Correspondence* end)
+        : begin_(begin), end_(end) {}
+
+    inline const Correspondence* begin() const { return begin_; }
+    inline const Correspondence* end() const { return end_; }
+    inline size_t size() const { return end_ - begin_; }
+    inline bool empty() const { return begin_ == end_; }
+    inline const Correspondence& operator[](const size_t idx) const {
+      return begin_[idx];
+    }
+    inline const Correspondence& at(const size_t idx) const {
+      CHECK_LT(idx, size());
+      return begin_[idx];
+    }
+
+   private:
+    const Correspondence* begin_;
+    const Correspondence* end_;
+  };
+
   CorrespondenceGraph();
 
   // Number of added images.
@@ -83,12 +109,20 @@ class CorrespondenceGraph {
   std::unordered_map<image_pair_t, point2D_t> NumCorrespondencesBetweenImages()
       const;
 
+  // Get the approximate memory usage of the graph in bytes.
+  size_t NumBytes() const;
+
   // Finalize the database manager.
   //
   // - Calculates the number of observations per image by counting the number
   //   of image points that have at least one correspondence.
   // - Deletes images without observations, as they are useless for SfM.
-  // - Shrinks the correspondence vectors to their size to save memory.
+  // - Packs the correspondences of each image into a compressed sparse row
+  //   layout, i.e., a single contiguous array of correspondences indexed by
+  //   per-point offsets, to save memory and improve locality.
+  //
+  // The graph can be extended after finalization, in which case only the
+  // images that received new correspondences are processed again.
   void Finalize();
 
   // Add new image to the correspondence graph.
@@ -101,8 +135,16 @@ class CorrespondenceGraph {
   void AddCorrespondences(const image_t image_id1, const image_t image_id2,
                           const FeatureMatches& matches);
 
+  // Add correspondences between many image pairs using multiple threads. The
+  // resulting graph is the same as when calling `AddCorrespondences` for each
+  // image pair in the given order. The image pairs must be distinct and must
+  // not have been added to the graph before.
+  void AddCorrespondences(const std::vector<image_pair_t>& pair_ids,
+                          const std::vector<const FeatureMatches*>& matches,
+                          const int num_threads);
+
   // Find the correspondence of an image observation to all other images.
-  inline const std::vector<Correspondence>& FindCorrespondences(
+  inline CorrespondenceRange FindCorrespondences(
       const image_t image_id, const point2D_t point2D_idx) const;
 
   // Find correspondences to the given observation.
@@ -131,6 +173,13 @@ class CorrespondenceGraph {
   bool IsTwoViewObservation(const image_t image_id,
                             const point2D_t point2D_idx) const;
 
+  // Serialize the correspondence graph to / from a binary stream. Only image
+  // points with correspondences are stored, such that the serialized graph is
+  // typically much smaller than the in-memory representation. The read graph
+  // is not finalized, so that further correspondences can be added.
+  void Write(std::ostream* stream) const;
+  void Read(std::istream* stream);
+
  private:
   struct Image {
     // Number of 2D points with at least one correspondence to another image.
@@ -140,8 +189,40 @@ class CorrespondenceGraph {
     // to find a good initial pair, that is connected to many images.
     point2D_t num_correspondences = 0;
 
-    // Correspondences to other images per image point.
+    // Correspondences to other images per image point. Only used while the
+    // graph is built and empty after finalization.
     std::vector<std::vector<Correspondence>> corrs;
+
+    // Compressed sparse row layout of the correspondences after finalization,
+    // where the correspondences of point `i` are stored in the range
+    // `[flat_corrs[corrs_offsets[i]], flat_corrs[corrs_offsets[i + 1]])`.
+    // The offsets are empty if the image is not finalized.
+    std::vector<point2D_t> corrs_offsets;
+    std::vector<Correspondence> flat_corrs;
+
+    inline bool IsFinalized() const { return !corrs_offsets.empty(); }
+
+    inline size_t NumPoints2D() const {
+      return IsFinalized() ? corrs_offsets.size() - 1 : corrs.size();
+    }
+
+    inline CorrespondenceRange Corrs(const point2D_t point2D_idx) const {
+      if (IsFinalized()) {
+        CHECK_LT(point2D_idx + 1, corrs_offsets.size());
+        const Correspondence* data = flat_corrs.data();
+        return CorrespondenceRange(data + corrs_offsets[point2D_idx],
+                                   data + corrs_offsets[point2D_idx + 1]);
+      } else {
+        const std::vector<Correspondence>& point2D_corrs =
+            corrs.at(point2D_idx);
+        return CorrespondenceRange(
+            point2D_corrs.data(), point2D_corrs.data() + point2D_corrs.size());
+      }
+    }
+
+    // Convert between the growable and the compressed sparse row layout.
+    void Pack();
+    void Unpack();
   };
 
   struct ImagePair {
@@ -189,15 +270,15 @@ point2D_t CorrespondenceGraph::NumCorrespondencesBetweenImages(
   }
 }
 
-const std::vector<CorrespondenceGraph::Correspondence>&
+CorrespondenceGraph::CorrespondenceRange
 CorrespondenceGraph::FindCorrespondences(const image_t image_id,
                                          const point2D_t point2D_idx) const {
-  return images_.at(image_id).corrs.at(point2D_idx);
+  return images_.at(image_id).Corrs(point2D_idx);
 }
 
 bool CorrespondenceGraph::HasCorrespondences(
     const image_t image_id, const point2D_t point2D_idx) const {
-  return !images_.at(image_id).corrs.at(point2D_idx).empty();
+  return !images_.at(image_id).Corrs(point2D_idx).empty();
 }
 
 }  // namespace colmap
@@ -0,0 +1,61 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "base/synthetic.h"
+#include "util/random.h"
+
+using namespace colmap;
+
+static void BM_FindTransitiveCorrespondences(benchmark::State& state) {
+  SetPRNGSeed(0);
+
+  SyntheticDatasetOptions options;
+  options.num_images = state.range(0);
+  options.num_points3D = 1000;
+  Reconstruction reconstruction;
+  SynthesizeDataset(options, &reconstruction);
+
+  CorrespondenceGraph correspondence_graph;
+  SynthesizeCorrespondenceGraph(reconstruction, &correspondence_graph);
+
+  const point2D_t num_points2D = reconstruction.Image(1).NumPoints2D();
+  const size_t kTransitivity = 2;
+
+  point2D_t point2D_idx = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(correspondence_graph.FindTransitiveCorrespondences(
+        1, point2D_idx, kTransitivity));
+    point2D_idx = (point2D_idx + 1) % num_points2D;
+  }
+}
+
+BENCHMARK(BM_FindTransitiveCorrespondences)->Arg(10)->Arg(50);
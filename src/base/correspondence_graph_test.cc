@@ -371,3 +371,183 @@ BOOST_AUTO_TEST_CASE(TestDuplicate) {
   BOOST_CHECK_EQUAL(
       correspondence_graph.NumCorrespondencesBetweenImages().at(pair_id), 3);
 }
+
+BOOST_AUTO_TEST_CASE(TestReadWrite) {
+  CorrespondenceGraph correspondence_graph;
+  correspondence_graph.AddImage(0, 10);
+  correspondence_graph.AddImage(1, 10);
+  correspondence_graph.AddImage(2, 10);
+  FeatureMatches matches(3);
+  matches[0].point2D_idx1 = 0;
+  matches[0].point2D_idx2 = 0;
+  matches[1].point2D_idx1 = 1;
+  matches[1].point2D_idx2 = 2;
+  matches[2].point2D_idx1 = 3;
+  matches[2].point2D_idx2 = 7;
+  correspondence_graph.AddCorrespondences(0, 1, matches);
+  correspondence_graph.AddCorrespondences(1, 2, matches);
+  correspondence_graph.Finalize();
+
+  std::stringstream stream;
+  correspondence_graph.Write(&stream);
+  CorrespondenceGraph correspondence_graph_read;
+  correspondence_graph_read.Read(&stream);
+
+  BOOST_CHECK_EQUAL(correspondence_graph_read.NumImages(), 3);
+  BOOST_CHECK_EQUAL(correspondence_graph_read.NumImagePairs(), 2);
+  for (image_t image_id = 0; image_id < 3; ++image_id) {
+    BOOST_CHECK_EQUAL(
+        correspondence_graph_read.NumObservationsForImage(image_id),
+        correspondence_graph.NumObservationsForImage(image_id));
+    BOOST_CHECK_EQUAL(
+        correspondence_graph_read.NumCorrespondencesForImage(image_id),
+        correspondence_graph.NumCorrespondencesForImage(image_id));
+    for (point2D_t point2D_idx = 0; point2D_idx < 10; ++point2D_idx) {
+      const auto& corrs =
+          correspondence_graph.FindCorrespondences(image_id, point2D_idx);
+      const auto& corrs_read =
+          correspondence_graph_read.FindCorrespondences(image_id, point2D_idx);
+      BOOST_CHECK_EQUAL(corrs.size(), corrs_read.size());
+      for (size_t i = 0; i < corrs.size(); ++i) {
+        BOOST_CHECK_EQUAL(corrs[i].image_id, corrs_read[i].image_id);
+        BOOST_CHECK_EQUAL(corrs[i].point2D_idx, corrs_read[i].point2D_idx);
+      }
+    }
+  }
+  BOOST_CHECK_EQUAL(
+      correspondence_graph_read.NumCorrespondencesBetweenImages(0, 1), 3);
+  BOOST_CHECK_EQUAL(
+      correspondence_graph_read.NumCorrespondencesBetweenImages(1, 2), 3);
+  BOOST_CHECK_EQUAL(
+      correspondence_graph_read.NumCorrespondencesBetweenImages(0, 2), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestAddAfterFinalize) {
+  CorrespondenceGraph correspondence_graph;
+  correspondence_graph.AddImage(0, 10);
+  correspondence_graph.AddImage(1, 10);
+  correspondence_graph.AddImage(2, 10);
+  FeatureMatches matches(2);
+  matches[0].point2D_idx1 = 0;
+  matches[0].point2D_idx2 = 0;
+  matches[1].point2D_idx1 = 5;
+  matches[1].point2D_idx2 = 9;
+  correspondence_graph.AddCorrespondences(0, 1, matches);
+  correspondence_graph.AddCorrespondences(1, 2, matches);
+  correspondence_graph.Finalize();
+  BOOST_CHECK_EQUAL(correspondence_graph.FindCorrespondences(1, 0).size(), 2);
+  BOOST_CHECK_EQUAL(correspondence_graph.FindCorrespondences(1, 9).size(), 1);
+  BOOST_CHECK_EQUAL(correspondence_graph.FindCorrespondences(1, 4).size(), 0);
+  BOOST_CHECK_EQUAL(correspondence_graph.FindCorrespondences(2, 9).size(), 1);
+  BOOST_CHECK_EQUAL(
+      correspondence_graph.FindCorrespondences(2, 9).at(0).point2D_idx, 5);
+  correspondence_graph.AddCorrespondences(0, 2, matches);
+  correspondence_graph.Finalize();
+  BOOST_CHECK_EQUAL(correspondence_graph.FindCorrespondences(0, 0).size(), 2);
+  BOOST_CHECK_EQUAL(correspondence_graph.FindCorrespondences(0, 5).size(), 2);
+  BOOST_CHECK_EQUAL(correspondence_graph.FindCorrespondences(2, 0).size(), 2);
+  BOOST_CHECK_EQUAL(correspondence_graph.FindCorrespondences(2, 9).size(), 2);
+  BOOST_CHECK_EQUAL(correspondence_graph.NumObservationsForImage(0), 2);
+  BOOST_CHECK_EQUAL(correspondence_graph.NumObservationsForImage(2), 2);
+  BOOST_CHECK_EQUAL(correspondence_graph.NumCorrespondencesForImage(2), 4);
+  BOOST_CHECK_EQUAL(
+      correspondence_graph.FindTransitiveCorrespondences(0, 0, 2).size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(TestNumBytes) {
+  CorrespondenceGraph correspondence_graph;
+  const size_t empty_num_bytes = correspondence_graph.NumBytes();
+  BOOST_CHECK_GT(empty_num_bytes, 0);
+  correspondence_graph.AddImage(0, 10);
+  correspondence_graph.AddImage(1, 10);
+  const size_t images_num_bytes = correspondence_graph.NumBytes();
+  BOOST_CHECK_GT(images_num_bytes, empty_num_bytes);
+  FeatureMatches matches(2);
+  matches[0].point2D_idx1 = 0;
+  matches[0].point2D_idx2 = 0;
+  matches[1].point2D_idx1 = 5;
+  matches[1].point2D_idx2 = 9;
+  correspondence_graph.AddCorrespondences(0, 1, matches);
+  const size_t corrs_num_bytes = correspondence_graph.NumBytes();
+  BOOST_CHECK_GT(corrs_num_bytes, images_num_bytes);
+  // The compressed layout of the finalized graph requires less memory.
+  correspondence_graph.Finalize();
+  BOOST_CHECK_GT(correspondence_graph.NumBytes(), empty_num_bytes);
+  BOOST_CHECK_LT(correspondence_graph.NumBytes(), corrs_num_bytes);
+}
+
+BOOST_AUTO_TEST_CASE(TestAddCorrespondencesParallel) {
+  const image_t kNumImages = 10;
+  const point2D_t kNumPoints2D = 50;
+
+  std::vector<image_pair_t> pair_ids;
+  std::vector<FeatureMatches> matches;
+  for (image_t image_id1 = 0; image_id1 < kNumImages; ++image_id1) {
+    for (image_t image_id2 = image_id1 + 1; image_id2 < kNumImages;
+         ++image_id2) {
+      pair_ids.push_back(Database::ImagePairToPairId(image_id1, image_id2));
+      // Include duplicate and out of bounds matches.
+      FeatureMatches pair_matches(30);
+      for (size_t i = 0; i < pair_matches.size(); ++i) {
+        pair_matches[i].point2D_idx1 = (i * 7 + image_id2) % (kNumPoints2D + 2);
+        pair_matches[i].point2D_idx2 = (i * 3 + image_id1) % kNumPoints2D;
+      }
+      matches.push_back(pair_matches);
+    }
+  }
+
+  CorrespondenceGraph correspondence_graph;
+  for (image_t image_id = 0; image_id < kNumImages; ++image_id) {
+    correspondence_graph.AddImage(image_id, kNumPoints2D);
+  }
+  for (size_t i = 0; i < pair_ids.size(); ++i) {
+    image_t image_id1;
+    image_t image_id2;
+    Database::PairIdToImagePair(pair_ids[i], &image_id1, &image_id2);
+    correspondence_graph.AddCorrespondences(image_id1, image_id2, matches[i]);
+  }
+  correspondence_graph.Finalize();
+
+  std::vector<const FeatureMatches*> matches_ptrs;
+  for (const auto& pair_matches : matches) {
+    matches_ptrs.push_back(&pair_matches);
+  }
+
+  for (const int num_threads : {1, 4}) {
+    CorrespondenceGraph correspondence_graph_parallel;
+    for (image_t image_id = 0; image_id < kNumImages; ++image_id) {
+      correspondence_graph_parallel.AddImage(image_id, kNumPoints2D);
+    }
+    correspondence_graph_parallel.AddCorrespondences(pair_ids, matches_ptrs,
+                                                     num_threads);
+    correspondence_graph_parallel.Finalize();
+
+    BOOST_CHECK_EQUAL(correspondence_graph_parallel.NumImages(),
+                      correspondence_graph.NumImages());
+    BOOST_CHECK(
+        correspondence_graph_parallel.NumCorrespondencesBetweenImages() ==
+        correspondence_graph.NumCorrespondencesBetweenImages());
+    for (image_t image_id = 0; image_id < kNumImages; ++image_id) {
+      BOOST_CHECK_EQUAL(
+          correspondence_graph_parallel.NumObservationsForImage(image_id),
+          correspondence_graph.NumObservationsForImage(image_id));
+      BOOST_CHECK_EQUAL(
+          correspondence_graph_parallel.NumCorrespondencesForImage(image_id),
+          correspondence_graph.NumCorrespondencesForImage(image_id));
+      for (point2D_t point2D_idx = 0; point2D_idx < kNumPoints2D;
+           ++point2D_idx) {
+        const auto corrs =
+            correspondence_graph.FindCorrespondences(image_id, point2D_idx);
+        const auto corrs_parallel =
+            correspondence_graph_parallel.FindCorrespondences(image_id,
+                                                              point2D_idx);
+        BOOST_CHECK_EQUAL(corrs.size(), corrs_parallel.size());
+        for (size_t i = 0; i < corrs.size(); ++i) {
+          BOOST_CHECK_EQUAL(corrs[i].image_id, corrs_parallel[i].image_id);
+          BOOST_CHECK_EQUAL(corrs[i].point2D_idx,
+                            corrs_parallel[i].point2D_idx);
+        }
+      }
+    }
+  }
+}
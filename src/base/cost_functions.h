@@ -32,13 +32,330 @@
 #ifndef COLMAP_SRC_BASE_COST_FUNCTIONS_H_
 #define COLMAP_SRC_BASE_COST_FUNCTIONS_H_
 
+#include <type_traits>
+
 #include <Eigen/Core>
 
 #include <ceres/ceres.h>
 #include <ceres/rotation.h>
 
+#include "base/camera_models.h"
+
 namespace colmap {
 
+// Analytic derivatives of the image projection for camera models that are
+// frequently used in bundle adjustment. The specializations compute the pixel
+// coordinates of the normalized image point (u, v) together with the row-major
+// 2x2 Jacobian w.r.t. (u, v) and the row-major 2xN Jacobian w.r.t. the N camera
+// parameters. Both Jacobian pointers may be null. Camera models without a
+// specialization fall back to automatic differentiation.
+template <typename CameraModel>
+struct AnalyticCameraModel {
+  static const bool kEnabled = false;
+};
+
+template <>
+struct AnalyticCameraModel<SimplePinholeCameraModel> {
+  static const bool kEnabled = true;
+
+  static void WorldToImage(const double* params, const double u,
+                           const double v, double* x, double* y, double* J_uv,
+                           double* J_params) {
+    const double f = params[0];
+    *x = f * u + params[1];
+    *y = f * v + params[2];
+    if (J_uv != nullptr) {
+      J_uv[0] = f;
+      J_uv[1] = 0;
+      J_uv[2] = 0;
+      J_uv[3] = f;
+    }
+    if (J_params != nullptr) {
+      J_params[0] = u;
+      J_params[1] = 1;
+      J_params[2] = 0;
+      J_params[3] = v;
+      J_params[4] = 0;
+      J_params[5] = 1;
+    }
+  }
+};
+
+template <>
+struct AnalyticCameraModel<PinholeCameraModel> {
+  static const bool kEnabled = true;
+
+  static void WorldToImage(const double* params, const double u,
+                           const double v, double* x, double* y, double* J_uv,
+                           double* J_params) {
+    const double f1 = params[0];
+    const double f2 = params[1];
+    *x = f1 * u + params[2];
+    *y = f2 * v + params[3];
+    if (J_uv != nullptr) {
+      J_uv[0] = f1;
+      J_uv[1] = 0;
+      J_uv[2] = 0;
+      J_uv[3] = f2;
+    }
+    if (J_params != nullptr) {
+      J_params[0] = u;
+      J_params[1] = 0;
+      J_params[2] = 1;
+      J_params[3] = 0;
+      J_params[4] = 0;
+      J_params[5] = v;
+      J_params[6] = 0;
+      J_params[7] = 1;
+    }
+  }
+};
+
+template <>
+struct AnalyticCameraModel<SimpleRadialCameraModel> {
+  static const bool kEnabled = true;
+
+  static void WorldToImage(const double* params, const double u,
+                           const double v, double* x, double* y, double* J_uv,
+                           double* J_params) {
+    const double f = params[0];
+    const double k = params[3];
+
+    const double u2 = u * u;
+    const double uv = u * v;
+    const double v2 = v * v;
+    const double r2 = u2 + v2;
+    const double radial = k * r2;
+    const double ud = u + u * radial;
+    const double vd = v + v * radial;
+
+    *x = f * ud + params[1];
+    *y = f * vd + params[2];
+
+    if (J_uv != nullptr) {
+      J_uv[0] = f * (1 + radial + 2 * k * u2);
+      J_uv[1] = f * 2 * k * uv;
+      J_uv[2] = J_uv[1];
+      J_uv[3] = f * (1 + radial + 2 * k * v2);
+    }
+    if (J_params != nullptr) {
+      J_params[0] = ud;
+      J_params[1] = 1;
+      J_params[2] = 0;
+      J_params[3] = f * u * r2;
+      J_params[4] = vd;
+      J_params[5] = 0;
+      J_params[6] = 1;
+      J_params[7] = f * v * r2;
+    }
+  }
+};
+
+template <>
+struct AnalyticCameraModel<OpenCVCameraModel> {
+  static const bool kEnabled = true;
+
+  static void WorldToImage(const double* params, const double u,
+                           const double v, double* x, double* y, double* J_uv,
+                           double* J_params) {
+    const double f1 = params[0];
+    const double f2 = params[1];
+    const double k1 = params[4];
+    const double k2 = params[5];
+    const double p1 = params[6];
+    const double p2 = params[7];
+
+    const double u2 = u * u;
+    const double uv = u * v;
+    const double v2 = v * v;
+    const double r2 = u2 + v2;
+    const double radial = k1 * r2 + k2 * r2 * r2;
+    const double ud = u + u * radial + 2 * p1 * uv + p2 * (r2 + 2 * u2);
+    const double vd = v + v * radial + 2 * p2 * uv + p1 * (r2 + 2 * v2);
+
+    *x = f1 * ud + params[2];
+    *y = f2 * vd + params[3];
+
+    if (J_uv != nullptr) {
+      const double dradial = 2 * (k1 + 2 * k2 * r2);
+      J_uv[0] = f1 * (1 + radial + dradial * u2 + 2 * p1 * v + 6 * p2 * u);
+      J_uv[1] = f1 * (dradial * uv + 2 * p1 * u + 2 * p2 * v);
+      J_uv[2] = f2 * (dradial * uv + 2 * p2 * v + 2 * p1 * u);
+      J_uv[3] = f2 * (1 + radial + dradial * v2 + 2 * p2 * u + 6 * p1 * v);
+    }
+    if (J_params != nullptr) {
+      J_params[0] = ud;
+      J_params[1] = 0;
+      J_params[2] = 1;
+      J_params[3] = 0;
+      J_params[4] = f1 * u * r2;
+      J_params[5] = f1 * u * r2 * r2;
+      J_params[6] = f1 * 2 * uv;
+      J_params[7] = f1 * (r2 + 2 * u2);
+      J_params[8] = 0;
+      J_params[9] = vd;
+      J_params[10] = 0;
+      J_params[11] = 1;
+      J_params[12] = f2 * v * r2;
+      J_params[13] = f2 * v * r2 * r2;
+      J_params[14] = f2 * (r2 + 2 * v2);
+      J_params[15] = f2 * 2 * uv;
+    }
+  }
+};
+
+// Evaluates the re-projection error of a 3D point in a camera with unit
+// quaternion rotation qvec and translation tvec. The rotation follows
+// ceres::UnitQuaternionRotatePoint, such that the result is identical to the
+// automatically differentiated cost functions. All Jacobians are row-major
+// and may be null.
+template <typename CameraModel>
+void EvaluateAnalyticReprojectionError(
+    const double* qvec, const double* tvec, const double* point3D,
+    const double* camera_params, const double observed_x,
+    const double observed_y, double* residuals, double* J_qvec, double* J_tvec,
+    double* J_point3D, double* J_camera_params) {
+  const double a0 = qvec[0];
+  const double a1 = qvec[1];
+  const double a2 = qvec[2];
+  const double a3 = qvec[3];
+
+  const double t2 = a0 * a1;
+  const double t3 = a0 * a2;
+  const double t4 = a0 * a3;
+  const double t5 = -a1 * a1;
+  const double t6 = a1 * a2;
+  const double t7 = a1 * a3;
+  const double t8 = -a2 * a2;
+  const double t9 = a2 * a3;
+  const double t1 = -a3 * a3;
+
+  Eigen::Matrix3d R;
+  R << 1 + 2 * (t8 + t1), 2 * (t6 - t4), 2 * (t3 + t7),  //
+      2 * (t4 + t6), 1 + 2 * (t5 + t1), 2 * (t9 - t2),   //
+      2 * (t7 - t3), 2 * (t2 + t9), 1 + 2 * (t5 + t8);
+
+  const Eigen::Map<const Eigen::Vector3d> X(point3D);
+  const Eigen::Vector3d Xc = R * X + Eigen::Map<const Eigen::Vector3d>(tvec);
+
+  // Project to image plane.
+  const double inv_z = 1 / Xc(2);
+  const double u = Xc(0) * inv_z;
+  const double v = Xc(1) * inv_z;
+
+  // Distort and transform to pixel space.
+  const bool compute_J_uv =
+      J_qvec != nullptr || J_tvec != nullptr || J_point3D != nullptr;
+  Eigen::Matrix<double, 2, 2, Eigen::RowMajor> J_uv;
+  AnalyticCameraModel<CameraModel>::WorldToImage(
+      camera_params, u, v, &residuals[0], &residuals[1],
+      compute_J_uv ? J_uv.data() : nullptr, J_camera_params);
+
+  // Re-projection error.
+  residuals[0] -= observed_x;
+  residuals[1] -= observed_y;
+
+  if (!compute_J_uv) {
+    return;
+  }
+
+  // Chain rule through the perspective division.
+  Eigen::Matrix<double, 2, 3, Eigen::RowMajor> J_proj;
+  J_proj << inv_z, 0, -u * inv_z, 0, inv_z, -v * inv_z;
+  const Eigen::Matrix<double, 2, 3, Eigen::RowMajor> J_Xc = J_uv * J_proj;
+
+  if (J_qvec != nullptr) {
+    const double p0 = X(0);
+    const double p1 = X(1);
+    const double p2 = X(2);
+    Eigen::Matrix<double, 3, 4, Eigen::RowMajor> J_rot;
+    J_rot << -a3 * p1 + a2 * p2, a2 * p1 + a3 * p2,
+        -2 * a2 * p0 + a1 * p1 + a0 * p2, -2 * a3 * p0 - a0 * p1 + a1 * p2,
+        a3 * p0 - a1 * p2, a2 * p0 - 2 * a1 * p1 - a0 * p2, a1 * p0 + a3 * p2,
+        a0 * p0 - 2 * a3 * p1 + a2 * p2, -a2 * p0 + a1 * p1,
+        a3 * p0 + a0 * p1 - 2 * a1 * p2, -a0 * p0 + a3 * p1 - 2 * a2 * p2,
+        a1 * p0 + a2 * p1;
+    Eigen::Map<Eigen::Matrix<double, 2, 4, Eigen::RowMajor>> J_qvec_map(J_qvec);
+    J_qvec_map = 2 * J_Xc * J_rot;
+  }
+
+  if (J_tvec != nullptr) {
+    Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> J_tvec_map(J_tvec);
+    J_tvec_map = J_Xc;
+  }
+
+  if (J_point3D != nullptr) {
+    Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> J_point3D_map(
+        J_point3D);
+    J_point3D_map = J_Xc * R;
+  }
+}
+
+// Standard bundle adjustment cost function with analytic derivatives for
+// camera models with a specialization of AnalyticCameraModel.
+template <typename CameraModel>
+class AnalyticBundleAdjustmentCostFunction
+    : public ceres::SizedCostFunction<2, 4, 3, 3, CameraModel::kNumParams> {
+ public:
+  explicit AnalyticBundleAdjustmentCostFunction(const Eigen::Vector2d& point2D)
+      : observed_x_(point2D(0)), observed_y_(point2D(1)) {}
+
+  bool Evaluate(double const* const* parameters, double* residuals,
+                double** jacobians) const {
+    if (jacobians == nullptr) {
+      EvaluateAnalyticReprojectionError<CameraModel>(
+          parameters[0], parameters[1], parameters[2], parameters[3],
+          observed_x_, observed_y_, residuals, nullptr, nullptr, nullptr,
+          nullptr);
+    } else {
+      EvaluateAnalyticReprojectionError<CameraModel>(
+          parameters[0], parameters[1], parameters[2], parameters[3],
+          observed_x_, observed_y_, residuals, jacobians[0], jacobians[1],
+          jacobians[2], jacobians[3]);
+    }
+    return true;
+  }
+
+ private:
+  const double observed_x_;
+  const double observed_y_;
+};
+
+// Bundle adjustment cost function with analytic derivatives for variable
+// camera calibration and point parameters, and fixed camera pose.
+template <typename CameraModel>
+class AnalyticBundleAdjustmentConstantPoseCostFunction
+    : public ceres::SizedCostFunction<2, 3, CameraModel::kNumParams> {
+ public:
+  AnalyticBundleAdjustmentConstantPoseCostFunction(
+      const Eigen::Vector4d& qvec, const Eigen::Vector3d& tvec,
+      const Eigen::Vector2d& point2D)
+      : qvec_{qvec(0), qvec(1), qvec(2), qvec(3)},
+        tvec_{tvec(0), tvec(1), tvec(2)},
+        observed_x_(point2D(0)),
+        observed_y_(point2D(1)) {}
+
+  bool Evaluate(double const* const* parameters, double* residuals,
+                double** jacobians) const {
+    if (jacobians == nullptr) {
+      EvaluateAnalyticReprojectionError<CameraModel>(
+          qvec_, tvec_, parameters[0], parameters[1], observed_x_, observed_y_,
+          residuals, nullptr, nullptr, nullptr, nullptr);
+    } else {
+      EvaluateAnalyticReprojectionError<CameraModel>(
+          qvec_, tvec_, parameters[0], parameters[1], observed_x_, observed_y_,
+          residuals, nullptr, nullptr, jacobians[0], jacobians[1]);
+    }
+    return true;
+  }
+
+ private:
+  const double qvec_[4];
+  const double tvec_[3];
+  const double observed_x_;
+  const double observed_y_;
+};
+
 // Standard bundle adjustment cost function for variable
 // camera pose and calibration and point parameters.
 template <typename CameraModel>
@@ -47,7 +364,14 @@ class BundleAdjustmentCostFunction {
   explicit BundleAdjustmentCostFunction(const Eigen::Vector2d& point2D)
       : observed_x_(point2D(0)), observed_y_(point2D(1)) {}
 
+  // Uses analytic derivatives if available for the camera model.
   static ceres::CostFunction* Create(const Eigen::Vector2d& point2D) {
+    return Create(point2D,
+                  std::integral_constant<
+                      bool, AnalyticCameraModel<CameraModel>::kEnabled>());
+  }
+
+  static ceres::CostFunction* CreateAutoDiff(const Eigen::Vector2d& point2D) {
     return (new ceres::AutoDiffCostFunction<
             BundleAdjustmentCostFunction<CameraModel>, 2, 4, 3, 3,
             CameraModel::kNumParams>(
@@ -81,6 +405,16 @@ class BundleAdjustmentCostFunction {
   }
 
  private:
+  static ceres::CostFunction* Create(const Eigen::Vector2d& point2D,
+                                     std::true_type) {
+    return new AnalyticBundleAdjustmentCostFunction<CameraModel>(point2D);
+  }
+
+  static ceres::CostFunction* Create(const Eigen::Vector2d& point2D,
+                                     std::false_type) {
+    return CreateAutoDiff(point2D);
+  }
+
   const double observed_x_;
   const double observed_y_;
 };
@@ -103,9 +437,18 @@ class BundleAdjustmentConstantPoseCostFunction {
         observed_x_(point2D(0)),
         observed_y_(point2D(1)) {}
 
+  // Uses analytic derivatives if available for the camera model.
   static ceres::CostFunction* Create(const Eigen::Vector4d& qvec,
                                      const Eigen::Vector3d& tvec,
                                      const Eigen::Vector2d& point2D) {
+    return Create(qvec, tvec, point2D,
+                  std::integral_constant<
+                      bool, AnalyticCameraModel<CameraModel>::kEnabled>());
+  }
+
+  static ceres::CostFunction* CreateAutoDiff(const Eigen::Vector4d& qvec,
+                                             const Eigen::Vector3d& tvec,
+                                             const Eigen::Vector2d& point2D) {
     return (new ceres::AutoDiffCostFunction<
             BundleAdjustmentConstantPoseCostFunction<CameraModel>, 2, 3,
             CameraModel::kNumParams>(
@@ -140,6 +483,21 @@ class BundleAdjustmentConstantPoseCostFunction {
   }
 
  private:
+  static ceres::CostFunction* Create(const Eigen::Vector4d& qvec,
+                                     const Eigen::Vector3d& tvec,
+                                     const Eigen::Vector2d& point2D,
+                                     std::true_type) {
+    return new AnalyticBundleAdjustmentConstantPoseCostFunction<CameraModel>(
+        qvec, tvec, point2D);
+  }
+
+  static ceres::CostFunction* Create(const Eigen::Vector4d& qvec,
+                                     const Eigen::Vector3d& tvec,
+                                     const Eigen::Vector2d& point2D,
+                                     std::false_type) {
+    return CreateAutoDiff(qvec, tvec, point2D);
+  }
+
   const double qw_;
   const double qx_;
   const double qy_;
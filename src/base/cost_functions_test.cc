@@ -150,3 +150,111 @@ BOOST_AUTO_TEST_CASE(TestRelativePoseCostFunction) {
   BOOST_CHECK(cost_function->Evaluate(parameters, residuals, nullptr));
   BOOST_CHECK_EQUAL(residuals[0], 0.5);
 }
+
+namespace {
+
+// Checks the analytic residuals against the camera model and the analytic
+// Jacobians against central finite differences.
+template <typename CameraModel>
+void CheckAnalyticBundleAdjustmentCostFunction(
+    const std::vector<double>& camera_params_vector) {
+  BOOST_CHECK(AnalyticCameraModel<CameraModel>::kEnabled);
+
+  const Eigen::Vector2d point2D(10, 20);
+  Eigen::Vector4d qvec_eigen(0.9, 0.1, -0.2, 0.3);
+  qvec_eigen.normalize();
+
+  double qvec[4] = {qvec_eigen(0), qvec_eigen(1), qvec_eigen(2),
+                    qvec_eigen(3)};
+  double tvec[3] = {0.1, -0.2, 0.3};
+  double point3D[3] = {0.4, 0.2, 3};
+  std::vector<double> camera_params = camera_params_vector;
+
+  std::unique_ptr<ceres::CostFunction> cost_function(
+      BundleAdjustmentCostFunction<CameraModel>::Create(point2D));
+
+  double* parameters[4] = {qvec, tvec, point3D, camera_params.data()};
+  const int sizes[4] = {4, 3, 3, CameraModel::kNumParams};
+  double residuals[2];
+  std::vector<std::vector<double>> jacobians(4);
+  double* jacobian_ptrs[4];
+  for (int i = 0; i < 4; ++i) {
+    jacobians[i].resize(2 * sizes[i]);
+    jacobian_ptrs[i] = jacobians[i].data();
+  }
+  BOOST_CHECK(cost_function->Evaluate(parameters, residuals, jacobian_ptrs));
+
+  // Reference residuals.
+  const Eigen::Vector3d proj =
+      QuaternionToRotationMatrix(qvec_eigen) *
+          Eigen::Vector3d(point3D[0], point3D[1], point3D[2]) +
+      Eigen::Vector3d(tvec[0], tvec[1], tvec[2]);
+  double x, y;
+  CameraModel::WorldToImage(camera_params.data(), proj(0) / proj(2),
+                            proj(1) / proj(2), &x, &y);
+  BOOST_CHECK_CLOSE(residuals[0], x - point2D(0), 1e-6);
+  BOOST_CHECK_CLOSE(residuals[1], y - point2D(1), 1e-6);
+
+  // Without Jacobians.
+  double residuals_only[2];
+  BOOST_CHECK(cost_function->Evaluate(parameters, residuals_only, nullptr));
+  BOOST_CHECK_EQUAL(residuals_only[0], residuals[0]);
+  BOOST_CHECK_EQUAL(residuals_only[1], residuals[1]);
+
+  const double kEps = 1e-6;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < sizes[i]; ++j) {
+      const double value = parameters[i][j];
+      double residuals_plus[2];
+      double residuals_minus[2];
+      parameters[i][j] = value + kEps;
+      cost_function->Evaluate(parameters, residuals_plus, nullptr);
+      parameters[i][j] = value - kEps;
+      cost_function->Evaluate(parameters, residuals_minus, nullptr);
+      parameters[i][j] = value;
+      for (int k = 0; k < 2; ++k) {
+        const double numeric =
+            (residuals_plus[k] - residuals_minus[k]) / (2 * kEps);
+        BOOST_CHECK_SMALL(jacobians[i][k * sizes[i] + j] - numeric, 1e-4);
+      }
+    }
+  }
+
+  // The constant pose cost function must agree with the variable pose one.
+  std::unique_ptr<ceres::CostFunction> constant_pose_cost_function(
+      BundleAdjustmentConstantPoseCostFunction<CameraModel>::Create(
+          qvec_eigen, Eigen::Vector3d(tvec[0], tvec[1], tvec[2]), point2D));
+  double* constant_pose_parameters[2] = {point3D, camera_params.data()};
+  double constant_pose_residuals[2];
+  double* constant_pose_jacobian_ptrs[2];
+  std::vector<double> constant_pose_jacobians[2];
+  for (int i = 0; i < 2; ++i) {
+    constant_pose_jacobians[i].resize(2 * sizes[i + 2]);
+    constant_pose_jacobian_ptrs[i] = constant_pose_jacobians[i].data();
+  }
+  BOOST_CHECK(constant_pose_cost_function->Evaluate(
+      constant_pose_parameters, constant_pose_residuals,
+      constant_pose_jacobian_ptrs));
+  BOOST_CHECK_CLOSE(constant_pose_residuals[0], residuals[0], 1e-6);
+  BOOST_CHECK_CLOSE(constant_pose_residuals[1], residuals[1], 1e-6);
+  for (int i = 0; i < 2; ++i) {
+    for (size_t j = 0; j < constant_pose_jacobians[i].size(); ++j) {
+      BOOST_CHECK_SMALL(constant_pose_jacobians[i][j] - jacobians[i + 2][j],
+                        1e-10);
+    }
+  }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(TestAnalyticBundleAdjustmentCostFunction) {
+  BOOST_CHECK(!AnalyticCameraModel<RadialCameraModel>::kEnabled);
+  CheckAnalyticBundleAdjustmentCostFunction<SimplePinholeCameraModel>(
+      {500, 320, 240});
+  CheckAnalyticBundleAdjustmentCostFunction<PinholeCameraModel>(
+      {500, 520, 320, 240});
+  CheckAnalyticBundleAdjustmentCostFunction<SimpleRadialCameraModel>(
+      {500, 320, 240, 0.1});
+  CheckAnalyticBundleAdjustmentCostFunction<OpenCVCameraModel>(
+      {500, 520, 320, 240, 0.1, -0.05, 0.01, -0.02});
+}
@@ -32,7 +32,13 @@
 #include "base/database.h"
 
 #include <fstream>
+#include <numeric>
 
+#ifdef ZLIB_ENABLED
+#include <zlib.h>
+#endif
+
+#include "util/misc.h"
 #include "util/sqlite3_utils.h"
 #include "util/string.h"
 #include "util/version.h"
@@ -46,12 +52,44 @@ typedef Eigen::Matrix<uint8_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
     FeatureDescriptorsBlob;
 typedef Eigen::Matrix<point2D_t, Eigen::Dynamic, 2, Eigen::RowMajor>
     FeatureMatchesBlob;
+typedef Eigen::Matrix<int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+    VisualWordIdsBlob;
 
 void SwapFeatureMatchesBlob(FeatureMatchesBlob* matches) {
   matches->col(0).swap(matches->col(1));
 }
 
+// Check whether the affine shapes of all keypoints are similarity transforms,
+// i.e. upright and isotropic up to the given tolerance relative to their scale,
+// such that their scale and orientation suffice to represent them. Keypoints
+// extracted as similarity features are typically rescaled by slightly different
+// factors in x and y, so that their shapes are not exactly isotropic anymore.
+bool IsSimilarityKeypointShapes(const FeatureKeypoints& keypoints,
+                                const float max_relative_error) {
+  for (const auto& keypoint : keypoints) {
+    const float max_error = max_relative_error * keypoint.ComputeScale();
+    if (std::abs(keypoint.a11 - keypoint.a22) > max_error ||
+        std::abs(keypoint.a12 + keypoint.a21) > max_error) {
+      return false;
+    }
+  }
+  return true;
+}
+
 FeatureKeypointsBlob FeatureKeypointsToBlob(const FeatureKeypoints& keypoints) {
+  const float kMaxRelativeShapeError = 1e-3f;
+  if (IsSimilarityKeypointShapes(keypoints, kMaxRelativeShapeError)) {
+    const FeatureKeypointsBlob::Index kNumCols = 4;
+    FeatureKeypointsBlob blob(keypoints.size(), kNumCols);
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+      blob(i, 0) = keypoints[i].x;
+      blob(i, 1) = keypoints[i].y;
+      blob(i, 2) = keypoints[i].ComputeScale();
+      blob(i, 3) = keypoints[i].ComputeOrientation();
+    }
+    return blob;
+  }
+
   const FeatureKeypointsBlob::Index kNumCols = 6;
   FeatureKeypointsBlob blob(keypoints.size(), kNumCols);
   for (size_t i = 0; i < keypoints.size(); ++i) {
@@ -65,26 +103,93 @@ FeatureKeypointsBlob FeatureKeypointsToBlob(const FeatureKeypoints& keypoints) {
   return blob;
 }
 
-FeatureKeypoints FeatureKeypointsFromBlob(const FeatureKeypointsBlob& blob) {
-  FeatureKeypoints keypoints(static_cast<size_t>(blob.rows()));
-  if (blob.cols() == 2) {
-    for (FeatureKeypointsBlob::Index i = 0; i < blob.rows(); ++i) {
-      keypoints[i] = FeatureKeypoint(blob(i, 0), blob(i, 1));
+// In the half precision format, the locations of all keypoints are stored
+// first in single precision, followed by their shape parameters in half
+// precision.
+size_t NumHalfKeypointsBlobBytes(const size_t rows, const size_t cols) {
+  CHECK_GE(cols, 2);
+  return rows * (2 * sizeof(float) + (cols - 2) * sizeof(Eigen::half));
+}
+
+std::vector<uint8_t> FeatureKeypointsBlobToHalf(
+    const FeatureKeypointsBlob& blob) {
+  std::vector<uint8_t> data(NumHalfKeypointsBlobBytes(blob.rows(), blob.cols()));
+  float* locations = reinterpret_cast<float*>(data.data());
+  Eigen::half* shapes =
+      reinterpret_cast<Eigen::half*>(locations + 2 * blob.rows());
+  for (FeatureKeypointsBlob::Index i = 0; i < blob.rows(); ++i) {
+    *(locations++) = blob(i, 0);
+    *(locations++) = blob(i, 1);
+    for (FeatureKeypointsBlob::Index j = 2; j < blob.cols(); ++j) {
+      *(shapes++) = Eigen::half(blob(i, j));
     }
-  } else if (blob.cols() == 4) {
-    for (FeatureKeypointsBlob::Index i = 0; i < blob.rows(); ++i) {
-      keypoints[i] =
-          FeatureKeypoint(blob(i, 0), blob(i, 1), blob(i, 2), blob(i, 3));
-    }
-  } else if (blob.cols() == 6) {
-    for (FeatureKeypointsBlob::Index i = 0; i < blob.rows(); ++i) {
-      keypoints[i] = FeatureKeypoint(blob(i, 0), blob(i, 1), blob(i, 2),
-                                     blob(i, 3), blob(i, 4), blob(i, 5));
+  }
+  return data;
+}
+
+FeatureKeypoint FeatureKeypointFromParams(const float* params,
+                                          const size_t num_params) {
+  switch (num_params) {
+    case 2:
+      return FeatureKeypoint(params[0], params[1]);
+    case 4:
+      return FeatureKeypoint(params[0], params[1], params[2], params[3]);
+    case 6:
+      return FeatureKeypoint(params[0], params[1], params[2], params[3],
+                             params[4], params[5]);
+    default:
+      LOG(FATAL) << "Keypoint format not supported";
+      return FeatureKeypoint();
+  }
+}
+
+// Decode the keypoints of the current row of the statement with the columns
+// `rows, cols, data, format` starting at the given column. The keypoints are
+// decoded directly from the blob into the given vector, which is resized and
+// thus reuses its storage.
+void ReadKeypointsRow(sqlite3_stmt* sql_stmt, const int col,
+                      FeatureKeypoints* keypoints) {
+  const size_t rows =
+      static_cast<size_t>(sqlite3_column_int64(sql_stmt, col + 0));
+  const size_t cols =
+      static_cast<size_t>(sqlite3_column_int64(sql_stmt, col + 1));
+  const size_t num_bytes =
+      static_cast<size_t>(sqlite3_column_bytes(sql_stmt, col + 2));
+  const auto* data =
+      static_cast<const uint8_t*>(sqlite3_column_blob(sql_stmt, col + 2));
+  const bool is_half = sqlite3_column_int64(sql_stmt, col + 3) ==
+                       static_cast<int>(Database::KeypointsFormat::FLOAT16);
+
+  keypoints->resize(rows);
+  if (rows == 0) {
+    return;
+  }
+
+  CHECK_GE(cols, 2);
+  CHECK_LE(cols, 6);
+
+  float params[6];
+  if (is_half) {
+    CHECK_EQ(num_bytes, NumHalfKeypointsBlobBytes(rows, cols));
+    const float* locations = reinterpret_cast<const float*>(data);
+    const Eigen::half* shapes =
+        reinterpret_cast<const Eigen::half*>(locations + 2 * rows);
+    for (size_t i = 0; i < rows; ++i) {
+      params[0] = *(locations++);
+      params[1] = *(locations++);
+      for (size_t j = 2; j < cols; ++j) {
+        params[j] = static_cast<float>(*(shapes++));
+      }
+      (*keypoints)[i] = FeatureKeypointFromParams(params, cols);
     }
   } else {
-    LOG(FATAL) << "Keypoint format not supported";
+    const size_t num_row_bytes = cols * sizeof(float);
+    CHECK_EQ(num_bytes, rows * num_row_bytes);
+    for (size_t i = 0; i < rows; ++i) {
+      memcpy(params, data + i * num_row_bytes, num_row_bytes);
+      (*keypoints)[i] = FeatureKeypointFromParams(params, cols);
+    }
   }
-  return keypoints;
 }
 
 FeatureMatchesBlob FeatureMatchesToBlob(const FeatureMatches& matches) {
@@ -193,6 +298,240 @@ void WriteDynamicMatrixBlob(sqlite3_stmt* sql_stmt, const MatrixType& matrix,
                                  static_cast<int>(num_bytes), SQLITE_STATIC));
 }
 
+void AppendVarint(uint64_t value, std::vector<uint8_t>* data) {
+  while (value >= 0x80) {
+    data->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  data->push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t ReadVarint(const uint8_t** data, const uint8_t* end) {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    CHECK_LT(*data, end) << "Truncated variable-length integer";
+    const uint8_t byte = *((*data)++);
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  LOG(FATAL) << "Invalid variable-length integer";
+  return value;
+}
+
+// Map signed integers with small magnitude to unsigned integers with small
+// magnitude, i.e., 0, -1, 1, -2, 2, ... to 0, 1, 2, 3, 4, ...
+uint64_t ZigZagEncode(const int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(const uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// In the variable-length format, the matches are sorted by their point
+// indices and the differences of the first index to the previous match are
+// stored as unsigned and the differences of the second index as signed
+// variable-length integers, since the second indices are not sorted.
+std::vector<uint8_t> FeatureMatchesBlobToVarint(
+    const FeatureMatchesBlob& blob) {
+  std::vector<FeatureMatchesBlob::Index> order(blob.rows());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&blob](const FeatureMatchesBlob::Index i1,
+                    const FeatureMatchesBlob::Index i2) {
+              return blob(i1, 0) < blob(i2, 0) ||
+                     (blob(i1, 0) == blob(i2, 0) && blob(i1, 1) < blob(i2, 1));
+            });
+
+  std::vector<uint8_t> data;
+  data.reserve(3 * blob.rows());
+  int64_t prev_idx1 = 0;
+  int64_t prev_idx2 = 0;
+  for (const auto i : order) {
+    const int64_t idx1 = blob(i, 0);
+    const int64_t idx2 = blob(i, 1);
+    AppendVarint(static_cast<uint64_t>(idx1 - prev_idx1), &data);
+    AppendVarint(ZigZagEncode(idx2 - prev_idx2), &data);
+    prev_idx1 = idx1;
+    prev_idx2 = idx2;
+  }
+  return data;
+}
+
+FeatureMatchesBlob FeatureMatchesBlobFromVarint(const uint8_t* data,
+                                                const size_t num_bytes,
+                                                const size_t rows) {
+  FeatureMatchesBlob blob(rows, 2);
+  const uint8_t* end = data + num_bytes;
+  int64_t idx1 = 0;
+  int64_t idx2 = 0;
+  for (size_t i = 0; i < rows; ++i) {
+    idx1 += static_cast<int64_t>(ReadVarint(&data, end));
+    idx2 += ZigZagDecode(ReadVarint(&data, end));
+    blob(i, 0) = static_cast<point2D_t>(idx1);
+    blob(i, 1) = static_cast<point2D_t>(idx2);
+  }
+  CHECK(data == end) << "Unexpected trailing bytes in matches";
+  return blob;
+}
+
+// Encode the matches in the given format and return the format actually used,
+// since the compression is only used if it reduces the storage.
+Database::MatchesFormat EncodeFeatureMatchesBlob(
+    const FeatureMatchesBlob& blob, const Database::MatchesFormat format,
+    std::vector<uint8_t>* data) {
+  CHECK(format != Database::MatchesFormat::UINT32);
+
+  *data = FeatureMatchesBlobToVarint(blob);
+
+#ifdef ZLIB_ENABLED
+  if (format == Database::MatchesFormat::VARINT_ZLIB && !data->empty()) {
+    // The compressed data is prefixed with its uncompressed size.
+    std::vector<uint8_t> compressed_data;
+    AppendVarint(data->size(), &compressed_data);
+    const size_t num_header_bytes = compressed_data.size();
+    uLongf num_compressed_bytes = compressBound(data->size());
+    compressed_data.resize(num_header_bytes + num_compressed_bytes);
+    CHECK_EQ(compress2(compressed_data.data() + num_header_bytes,
+                       &num_compressed_bytes, data->data(), data->size(),
+                       Z_BEST_SPEED),
+             Z_OK);
+    compressed_data.resize(num_header_bytes + num_compressed_bytes);
+    if (compressed_data.size() < data->size()) {
+      *data = std::move(compressed_data);
+      return Database::MatchesFormat::VARINT_ZLIB;
+    }
+  }
+#endif
+
+  return Database::MatchesFormat::VARINT;
+}
+
+// Bind the matches to the columns `rows, cols, data` starting at the given
+// column and their format to the given format column. The encoded data must
+// live until the statement is executed.
+void WriteFeatureMatchesBlob(sqlite3_stmt* sql_stmt,
+                             const FeatureMatchesBlob& blob,
+                             Database::MatchesFormat format, const int col,
+                             const int format_col, std::vector<uint8_t>* data) {
+  if (format == Database::MatchesFormat::UINT32) {
+    WriteDynamicMatrixBlob(sql_stmt, blob, col);
+  } else {
+    format = EncodeFeatureMatchesBlob(blob, format, data);
+    SQLITE3_CALL(sqlite3_bind_int64(sql_stmt, col + 0, blob.rows()));
+    SQLITE3_CALL(sqlite3_bind_int64(sql_stmt, col + 1, blob.cols()));
+    SQLITE3_CALL(sqlite3_bind_blob(sql_stmt, col + 2, data->data(),
+                                   static_cast<int>(data->size()),
+                                   SQLITE_STATIC));
+  }
+  SQLITE3_CALL(
+      sqlite3_bind_int64(sql_stmt, format_col, static_cast<int>(format)));
+}
+
+// Read the matches from the columns `rows, cols, data` starting at the given
+// column in the format of the given format column.
+FeatureMatchesBlob ReadFeatureMatchesBlob(sqlite3_stmt* sql_stmt, const int rc,
+                                          const int col, const int format_col) {
+  const auto format =
+      rc == SQLITE_ROW ? static_cast<Database::MatchesFormat>(
+                             sqlite3_column_int64(sql_stmt, format_col))
+                       : Database::MatchesFormat::UINT32;
+  if (format == Database::MatchesFormat::UINT32) {
+    return ReadDynamicMatrixBlob<FeatureMatchesBlob>(sql_stmt, rc, col);
+  }
+
+  const size_t rows =
+      static_cast<size_t>(sqlite3_column_int64(sql_stmt, col + 0));
+  CHECK_EQ(sqlite3_column_int64(sql_stmt, col + 1), 2);
+  const size_t num_bytes =
+      static_cast<size_t>(sqlite3_column_bytes(sql_stmt, col + 2));
+  const auto* data =
+      static_cast<const uint8_t*>(sqlite3_column_blob(sql_stmt, col + 2));
+
+  if (format == Database::MatchesFormat::VARINT) {
+    return FeatureMatchesBlobFromVarint(data, num_bytes, rows);
+  }
+
+  CHECK(format == Database::MatchesFormat::VARINT_ZLIB)
+      << "Matches format not supported";
+#ifdef ZLIB_ENABLED
+  const uint8_t* compressed_data = data;
+  uLongf num_uncompressed_bytes =
+      static_cast<uLongf>(ReadVarint(&compressed_data, data + num_bytes));
+  std::vector<uint8_t> uncompressed_data(num_uncompressed_bytes);
+  CHECK_EQ(uncompress(uncompressed_data.data(), &num_uncompressed_bytes,
+                      compressed_data, data + num_bytes - compressed_data),
+           Z_OK);
+  CHECK_EQ(num_uncompressed_bytes, uncompressed_data.size());
+  return FeatureMatchesBlobFromVarint(uncompressed_data.data(),
+                                      uncompressed_data.size(), rows);
+#else
+  LOG(FATAL) << "Reading compressed matches requires zlib";
+  return FeatureMatchesBlob();
+#endif
+}
+
+// A table that is copied from database shards, where the identifiers of the
+// cameras, images, and image pairs are offset in the selected columns.
+struct ShardTable {
+  std::string name;
+  std::string columns;
+  std::string offset_columns;
+};
+
+std::vector<ShardTable> GetShardTables(const sqlite3_int64 camera_offset,
+                                       const sqlite3_int64 image_offset) {
+  // Offsetting both image identifiers preserves their order, such that the
+  // pair identifiers are offset by a constant.
+  const sqlite3_int64 pair_offset =
+      image_offset * (static_cast<sqlite3_int64>(Database::kMaxNumImages) + 1);
+  const std::string prior_columns =
+      "prior_qw, prior_qx, prior_qy, prior_qz, prior_tx, prior_ty, prior_tz";
+  const std::string camera_columns =
+      "model, width, height, params, prior_focal_length";
+  return {
+      {"cameras", "camera_id, " + camera_columns,
+       StringPrintf("camera_id + %lld AS camera_id, ", camera_offset) +
+           camera_columns},
+      {"images", "image_id, name, camera_id, " + prior_columns,
+       StringPrintf("image_id + %lld AS image_id, name, "
+                    "camera_id + %lld AS camera_id, ",
+                    image_offset, camera_offset) +
+           prior_columns},
+      {"keypoints", "image_id, rows, cols, data, format",
+       StringPrintf("image_id + %lld AS image_id, rows, cols, data, format",
+                    image_offset)},
+      {"descriptors", "image_id, rows, cols, data",
+       StringPrintf("image_id + %lld AS image_id, rows, cols, data",
+                    image_offset)},
+      {"visual_words", "image_id, vocab_hash, rows, cols, data",
+       StringPrintf("image_id + %lld AS image_id, vocab_hash, rows, cols, data",
+                    image_offset)},
+      {"matches", "pair_id, rows, cols, data, format",
+       StringPrintf("pair_id + %lld AS pair_id, rows, cols, data, format",
+                    pair_offset)},
+      {"two_view_geometries",
+       "pair_id, rows, cols, data, config, F, E, H, format",
+       StringPrintf("pair_id + %lld AS pair_id, rows, cols, data, config, F, "
+                    "E, H, format",
+                    pair_offset)},
+  };
+}
+
+sqlite3_int64 ReadInt64(sqlite3* database, const std::string& sql) {
+  sqlite3_stmt* sql_stmt;
+  SQLITE3_CALL(sqlite3_prepare_v2(database, sql.c_str(), -1, &sql_stmt, 0));
+  sqlite3_int64 value = 0;
+  if (SQLITE3_CALL(sqlite3_step(sql_stmt)) == SQLITE_ROW) {
+    value = sqlite3_column_int64(sql_stmt, 0);
+  }
+  SQLITE3_CALL(sqlite3_finalize(sql_stmt));
+  return value;
+}
+
 Camera ReadCameraRow(sqlite3_stmt* sql_stmt) {
   Camera camera;
 
@@ -238,6 +577,28 @@ Image ReadImageRow(sqlite3_stmt* sql_stmt) {
   return image;
 }
 
+// Read a row of the `two_view_geometries` table as selected by
+// `SELECT pair_id, rows, cols, data, config, F, E, H, format`.
+TwoViewGeometry ReadTwoViewGeometryRow(sqlite3_stmt* sql_stmt, const int rc) {
+  TwoViewGeometry two_view_geometry;
+
+  const FeatureMatchesBlob blob = ReadFeatureMatchesBlob(sql_stmt, rc, 1, 8);
+  two_view_geometry.inlier_matches = FeatureMatchesFromBlob(blob);
+
+  two_view_geometry.config =
+      static_cast<int>(sqlite3_column_int64(sql_stmt, 4));
+
+  two_view_geometry.F = ReadStaticMatrixBlob<Eigen::Matrix3d>(sql_stmt, rc, 5);
+  two_view_geometry.E = ReadStaticMatrixBlob<Eigen::Matrix3d>(sql_stmt, rc, 6);
+  two_view_geometry.H = ReadStaticMatrixBlob<Eigen::Matrix3d>(sql_stmt, rc, 7);
+
+  two_view_geometry.F.transposeInPlace();
+  two_view_geometry.E.transposeInPlace();
+  two_view_geometry.H.transposeInPlace();
+
+  return two_view_geometry;
+}
+
 }  // namespace
 
 const size_t Database::kMaxNumImages =
@@ -263,6 +624,11 @@ void Database::Open(const std::string& path) {
       SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,
       nullptr));
 
+  // Wait for the write lock of concurrent connections, e.g. of pipelined
+  // extraction and matching, instead of failing immediately.
+  const int kBusyTimeoutMs = 60000;
+  SQLITE3_CALL(sqlite3_busy_timeout(database_, kBusyTimeoutMs));
+
   // Don't wait for the operating system to write the changes to disk
   SQLITE3_EXEC(database_, "PRAGMA synchronous=OFF", nullptr);
 
@@ -278,14 +644,161 @@ void Database::Open(const std::string& path) {
   CreateTables();
   UpdateSchema();
   PrepareSQLStatements();
+
+  path_ = path;
+
+  const std::string feature_store_path = FeatureStorePath(path);
+  if (ExistsDir(feature_store_path)) {
+    feature_store_.reset(new FeatureStore(feature_store_path));
+  }
 }
 
+void Database::OpenReadOnly(const std::string& path) {
+  Close();
+
+  CHECK(DatabaseReadPool::IsSupported(path))
+      << "In-memory databases cannot be opened read-only";
+  CHECK(ExistsFile(path)) << "Database does not exist: " << path;
+
+  SQLITE3_CALL(sqlite3_open_v2(path.c_str(), &database_,
+                               SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX,
+                               nullptr));
+
+  // Store temporary tables and indices in memory
+  SQLITE3_EXEC(database_, "PRAGMA temp_store=MEMORY", nullptr);
+
+  // The tables cannot be created or updated through this connection.
+  CHECK(ExistsTable("feature_store") && ExistsTable("visual_words") &&
+        ExistsColumn("keypoints", "format") &&
+        ExistsColumn("matches", "format") &&
+        ExistsColumn("two_view_geometries", "format"))
+      << "Database must be opened for writing once to update its schema: "
+      << path;
+
+  PrepareSQLStatements();
+
+  path_ = path;
+  read_only_ = true;
+
+  const std::string feature_store_path = FeatureStorePath(path);
+  if (ExistsDir(feature_store_path)) {
+    feature_store_.reset(new FeatureStore(feature_store_path));
+  }
+}
+
+void Database::OpenShards(const std::vector<std::string>& paths) {
+  CHECK(!paths.empty());
+
+  // Update the schema of the shards, which cannot be done through the view.
+  for (const auto& path : paths) {
+    CHECK(ExistsFile(path)) << "Database does not exist: " << path;
+    Database shard(path);
+  }
+
+  // The empty tables of the in-memory database are shadowed by the views
+  // over the shards, since temporary objects take precedence in queries.
+  Open(":memory:");
+  FinalizeSQLStatements();
+
+  const int max_num_attached =
+      sqlite3_limit(database_, SQLITE_LIMIT_ATTACHED, -1);
+  CHECK_LE(paths.size(), static_cast<size_t>(max_num_attached))
+      << "SQLite supports views over at most " << max_num_attached
+      << " shards";
+
+  std::vector<std::string> view_sqls;
+  sqlite3_int64 camera_offset = 0;
+  sqlite3_int64 image_offset = 0;
+  for (size_t shard_idx = 0; shard_idx < paths.size(); ++shard_idx) {
+    const std::string schema_name =
+        StringPrintf("shard%d", static_cast<int>(shard_idx));
+    AttachDatabase(paths[shard_idx], schema_name);
+    const auto tables = GetShardTables(camera_offset, image_offset);
+    view_sqls.resize(tables.size());
+    for (size_t i = 0; i < tables.size(); ++i) {
+      view_sqls[i] += StringPrintf(
+          "%s SELECT %s FROM %s.%s", shard_idx == 0 ? "" : " UNION ALL",
+          tables[i].offset_columns.c_str(), schema_name.c_str(),
+          tables[i].name.c_str());
+    }
+    camera_offset += MaxColumn("camera_id", schema_name + ".cameras");
+    image_offset += MaxColumn("image_id", schema_name + ".images");
+    CHECK_LT(image_offset, kMaxNumImages)
+        << "The shards contain too many images";
+  }
+
+  const auto tables = GetShardTables(0, 0);
+  for (size_t i = 0; i < tables.size(); ++i) {
+    const std::string sql =
+        StringPrintf("CREATE TEMP VIEW %s AS%s;", tables[i].name.c_str(),
+                     view_sqls[i].c_str());
+    SQLITE3_EXEC(database_, sql.c_str(), nullptr);
+    // Views cannot be modified without triggers, which are required to
+    // prepare the write statements. Writing then fails like for other
+    // read-only connections.
+    for (const std::string operation : {"INSERT", "UPDATE", "DELETE"}) {
+      const std::string trigger_sql = StringPrintf(
+          "CREATE TEMP TRIGGER %s_%s INSTEAD OF %s ON %s BEGIN "
+          "SELECT RAISE(ABORT, 'Sharded databases are read-only'); END;",
+          tables[i].name.c_str(), operation.c_str(), operation.c_str(),
+          tables[i].name.c_str());
+      SQLITE3_EXEC(database_, trigger_sql.c_str(), nullptr);
+    }
+  }
+
+  CHECK_EQ(ReadInt64(database_,
+                     "SELECT COUNT(*) - COUNT(DISTINCT name) FROM images;"),
+           0)
+      << "The shards must not contain images with the same name";
+
+  PrepareSQLStatements();
+
+  read_only_ = true;
+}
+
+void Database::OpenShardedPath(const std::string& path) {
+  const auto paths = CSVToVector<std::string>(path);
+  if (paths.size() > 1) {
+    OpenShards(paths);
+  } else {
+    Open(path);
+  }
+}
+
+bool Database::IsReadOnly() const { return read_only_; }
+
+const std::string& Database::Path() const { return path_; }
+
 void Database::Close() {
   if (database_ != nullptr) {
     FinalizeSQLStatements();
     sqlite3_close_v2(database_);
     database_ = nullptr;
   }
+  path_.clear();
+  read_only_ = false;
+  feature_store_.reset();
+}
+
+void Database::SetKeypointsFormat(const KeypointsFormat format) {
+  keypoints_format_ = format;
+}
+
+void Database::SetMatchesFormat(const MatchesFormat format) {
+#ifndef ZLIB_ENABLED
+  if (format == MatchesFormat::VARINT_ZLIB) {
+    std::cout << "WARNING: Compression requires zlib, writing uncompressed "
+                 "matches"
+              << std::endl;
+    matches_format_ = MatchesFormat::VARINT;
+    return;
+  }
+#endif
+  matches_format_ = format;
+}
+
+std::string Database::FeatureStorePath(const std::string& path) {
+  return path + ".features";
 }
 
 bool Database::ExistsCamera(const camera_t camera_id) const {
@@ -433,15 +946,81 @@ FeatureKeypoints Database::ReadKeypoints(const image_t image_id) const {
   SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_read_keypoints_, 1, image_id));
 
   const int rc = SQLITE3_CALL(sqlite3_step(sql_stmt_read_keypoints_));
-  const FeatureKeypointsBlob blob = ReadDynamicMatrixBlob<FeatureKeypointsBlob>(
-      sql_stmt_read_keypoints_, rc, 0);
+
+  FeatureKeypoints keypoints;
+  if (rc == SQLITE_ROW) {
+    ReadKeypointsRow(sql_stmt_read_keypoints_, 0, &keypoints);
+  }
 
   SQLITE3_CALL(sqlite3_reset(sql_stmt_read_keypoints_));
 
-  return FeatureKeypointsFromBlob(blob);
+  return keypoints;
+}
+
+void Database::ReadAllKeypoints(
+    const std::function<FeatureKeypoints*(image_t)>& get_keypoints) const {
+  ReadKeypointsInRange(0, std::numeric_limits<image_t>::max(), get_keypoints);
+}
+
+void Database::ReadKeypointsInRange(
+    const image_t min_image_id, const image_t max_image_id,
+    const std::function<FeatureKeypoints*(image_t)>& get_keypoints) const {
+  SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_read_keypoints_range_, 1,
+                                  static_cast<sqlite3_int64>(min_image_id)));
+  SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_read_keypoints_range_, 2,
+                                  static_cast<sqlite3_int64>(max_image_id)));
+
+  while (SQLITE3_CALL(sqlite3_step(sql_stmt_read_keypoints_range_)) ==
+         SQLITE_ROW) {
+    const image_t image_id = static_cast<image_t>(
+        sqlite3_column_int64(sql_stmt_read_keypoints_range_, 0));
+    FeatureKeypoints* keypoints = get_keypoints(image_id);
+    if (keypoints != nullptr) {
+      ReadKeypointsRow(sql_stmt_read_keypoints_range_, 1, keypoints);
+    }
+  }
+
+  SQLITE3_CALL(sqlite3_reset(sql_stmt_read_keypoints_range_));
+}
+
+std::unordered_map<image_t, size_t> Database::ReadKeypointCounts() const {
+  std::unordered_map<image_t, size_t> num_keypoints;
+  num_keypoints.reserve(CountRows("keypoints"));
+
+  while (SQLITE3_CALL(sqlite3_step(sql_stmt_read_keypoint_counts_)) ==
+         SQLITE_ROW) {
+    const image_t image_id = static_cast<image_t>(
+        sqlite3_column_int64(sql_stmt_read_keypoint_counts_, 0));
+    num_keypoints.emplace(image_id,
+                          static_cast<size_t>(sqlite3_column_int64(
+                              sql_stmt_read_keypoint_counts_, 1)));
+  }
+
+  SQLITE3_CALL(sqlite3_reset(sql_stmt_read_keypoint_counts_));
+
+  return num_keypoints;
 }
 
 FeatureDescriptors Database::ReadDescriptors(const image_t image_id) const {
+  if (feature_store_) {
+    SQLITE3_CALL(
+        sqlite3_bind_int64(sql_stmt_read_feature_store_, 1, image_id));
+    const int rc = SQLITE3_CALL(sqlite3_step(sql_stmt_read_feature_store_));
+    if (rc == SQLITE_ROW) {
+      const size_t file_index = static_cast<size_t>(
+          sqlite3_column_int64(sql_stmt_read_feature_store_, 0));
+      const size_t offset = static_cast<size_t>(
+          sqlite3_column_int64(sql_stmt_read_feature_store_, 1));
+      const size_t rows = static_cast<size_t>(
+          sqlite3_column_int64(sql_stmt_read_feature_store_, 2));
+      const size_t cols = static_cast<size_t>(
+          sqlite3_column_int64(sql_stmt_read_feature_store_, 3));
+      SQLITE3_CALL(sqlite3_reset(sql_stmt_read_feature_store_));
+      return *feature_store_->ReadDescriptors(file_index, offset, rows, cols);
+    }
+    SQLITE3_CALL(sqlite3_reset(sql_stmt_read_feature_store_));
+  }
+
   SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_read_descriptors_, 1, image_id));
 
   const int rc = SQLITE3_CALL(sqlite3_step(sql_stmt_read_descriptors_));
@@ -454,6 +1033,22 @@ FeatureDescriptors Database::ReadDescriptors(const image_t image_id) const {
   return descriptors;
 }
 
+Eigen::MatrixXi Database::ReadVisualWordIds(const image_t image_id,
+                                            const uint64_t vocab_hash) const {
+  SQLITE3_CALL(
+      sqlite3_bind_int64(sql_stmt_read_visual_word_ids_, 1, image_id));
+  SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_read_visual_word_ids_, 2,
+                                  static_cast<sqlite3_int64>(vocab_hash)));
+
+  const int rc = SQLITE3_CALL(sqlite3_step(sql_stmt_read_visual_word_ids_));
+  const VisualWordIdsBlob blob = ReadDynamicMatrixBlob<VisualWordIdsBlob>(
+      sql_stmt_read_visual_word_ids_, rc, 0);
+
+  SQLITE3_CALL(sqlite3_reset(sql_stmt_read_visual_word_ids_));
+
+  return blob.cast<int>();
+}
+
 FeatureMatches Database::ReadMatches(image_t image_id1,
                                      image_t image_id2) const {
   const image_pair_t pair_id = ImagePairToPairId(image_id1, image_id2);
@@ -461,7 +1056,7 @@ FeatureMatches Database::ReadMatches(image_t image_id1,
 
   const int rc = SQLITE3_CALL(sqlite3_step(sql_stmt_read_matches_));
   FeatureMatchesBlob blob =
-      ReadDynamicMatrixBlob<FeatureMatchesBlob>(sql_stmt_read_matches_, rc, 0);
+      ReadFeatureMatchesBlob(sql_stmt_read_matches_, rc, 0, 3);
 
   SQLITE3_CALL(sqlite3_reset(sql_stmt_read_matches_));
 
@@ -481,8 +1076,8 @@ std::vector<std::pair<image_pair_t, FeatureMatches>> Database::ReadAllMatches()
          SQLITE_ROW) {
     const image_pair_t pair_id = static_cast<image_pair_t>(
         sqlite3_column_int64(sql_stmt_read_matches_all_, 0));
-    const FeatureMatchesBlob blob = ReadDynamicMatrixBlob<FeatureMatchesBlob>(
-        sql_stmt_read_matches_all_, rc, 1);
+    const FeatureMatchesBlob blob =
+        ReadFeatureMatchesBlob(sql_stmt_read_matches_all_, rc, 1, 4);
     all_matches.emplace_back(pair_id, FeatureMatchesFromBlob(blob));
   }
 
@@ -501,8 +1096,8 @@ TwoViewGeometry Database::ReadTwoViewGeometry(const image_t image_id1,
 
   TwoViewGeometry two_view_geometry;
 
-  FeatureMatchesBlob blob = ReadDynamicMatrixBlob<FeatureMatchesBlob>(
-      sql_stmt_read_two_view_geometry_, rc, 0);
+  FeatureMatchesBlob blob =
+      ReadFeatureMatchesBlob(sql_stmt_read_two_view_geometry_, rc, 0, 7);
 
   two_view_geometry.config = static_cast<int>(
       sqlite3_column_int64(sql_stmt_read_two_view_geometry_, 3));
@@ -534,34 +1129,34 @@ void Database::ReadTwoViewGeometries(
   int rc;
   while ((rc = SQLITE3_CALL(sqlite3_step(
               sql_stmt_read_two_view_geometries_))) == SQLITE_ROW) {
-    const image_pair_t pair_id = static_cast<image_pair_t>(
-        sqlite3_column_int64(sql_stmt_read_two_view_geometries_, 0));
-    image_pair_ids->push_back(pair_id);
-
-    TwoViewGeometry two_view_geometry;
-
-    const FeatureMatchesBlob blob = ReadDynamicMatrixBlob<FeatureMatchesBlob>(
-        sql_stmt_read_two_view_geometries_, rc, 1);
-    two_view_geometry.inlier_matches = FeatureMatchesFromBlob(blob);
-
-    two_view_geometry.config = static_cast<int>(
-        sqlite3_column_int64(sql_stmt_read_two_view_geometries_, 4));
+    image_pair_ids->push_back(static_cast<image_pair_t>(
+        sqlite3_column_int64(sql_stmt_read_two_view_geometries_, 0)));
+    two_view_geometries->push_back(ReadTwoViewGeometryRow(
+        sql_stmt_read_two_view_geometries_, rc));
+  }
 
-    two_view_geometry.F = ReadStaticMatrixBlob<Eigen::Matrix3d>(
-        sql_stmt_read_two_view_geometries_, rc, 5);
-    two_view_geometry.E = ReadStaticMatrixBlob<Eigen::Matrix3d>(
-        sql_stmt_read_two_view_geometries_, rc, 6);
-    two_view_geometry.H = ReadStaticMatrixBlob<Eigen::Matrix3d>(
-        sql_stmt_read_two_view_geometries_, rc, 7);
+  SQLITE3_CALL(sqlite3_reset(sql_stmt_read_two_view_geometries_));
+}
 
-    two_view_geometry.F.transposeInPlace();
-    two_view_geometry.E.transposeInPlace();
-    two_view_geometry.H.transposeInPlace();
+void Database::ReadTwoViewGeometries(
+    const image_pair_t min_pair_id, const image_pair_t max_pair_id,
+    std::vector<image_pair_t>* image_pair_ids,
+    std::vector<TwoViewGeometry>* two_view_geometries) const {
+  SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_read_two_view_geometries_range_, 1,
+                                  static_cast<sqlite3_int64>(min_pair_id)));
+  SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_read_two_view_geometries_range_, 2,
+                                  static_cast<sqlite3_int64>(max_pair_id)));
 
-    two_view_geometries->push_back(two_view_geometry);
+  int rc;
+  while ((rc = SQLITE3_CALL(sqlite3_step(
+              sql_stmt_read_two_view_geometries_range_))) == SQLITE_ROW) {
+    image_pair_ids->push_back(static_cast<image_pair_t>(
+        sqlite3_column_int64(sql_stmt_read_two_view_geometries_range_, 0)));
+    two_view_geometries->push_back(ReadTwoViewGeometryRow(
+        sql_stmt_read_two_view_geometries_range_, rc));
   }
 
-  SQLITE3_CALL(sqlite3_reset(sql_stmt_read_two_view_geometries_));
+  SQLITE3_CALL(sqlite3_reset(sql_stmt_read_two_view_geometries_range_));
 }
 
 void Database::ReadTwoViewGeometryNumInliers(
@@ -655,7 +1250,24 @@ void Database::WriteKeypoints(const image_t image_id,
   const FeatureKeypointsBlob blob = FeatureKeypointsToBlob(keypoints);
 
   SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_write_keypoints_, 1, image_id));
-  WriteDynamicMatrixBlob(sql_stmt_write_keypoints_, blob, 2);
+  SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_write_keypoints_, 5,
+                                  static_cast<int>(keypoints_format_)));
+
+  // Important: the converted data must live until the query is executed.
+  std::vector<uint8_t> half_data;
+  if (keypoints_format_ == KeypointsFormat::FLOAT16) {
+    half_data = FeatureKeypointsBlobToHalf(blob);
+    SQLITE3_CALL(
+        sqlite3_bind_int64(sql_stmt_write_keypoints_, 2, blob.rows()));
+    SQLITE3_CALL(
+        sqlite3_bind_int64(sql_stmt_write_keypoints_, 3, blob.cols()));
+    SQLITE3_CALL(sqlite3_bind_blob(
+        sql_stmt_write_keypoints_, 4,
+        reinterpret_cast<const char*>(half_data.data()),
+        static_cast<int>(half_data.size()), SQLITE_STATIC));
+  } else {
+    WriteDynamicMatrixBlob(sql_stmt_write_keypoints_, blob, 2);
+  }
 
   SQLITE3_CALL(sqlite3_step(sql_stmt_write_keypoints_));
   SQLITE3_CALL(sqlite3_reset(sql_stmt_write_keypoints_));
@@ -664,25 +1276,65 @@ void Database::WriteKeypoints(const image_t image_id,
 void Database::WriteDescriptors(const image_t image_id,
                                 const FeatureDescriptors& descriptors) const {
   SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_write_descriptors_, 1, image_id));
-  WriteDynamicMatrixBlob(sql_stmt_write_descriptors_, descriptors, 2);
+
+  if (feature_store_) {
+    size_t file_index;
+    size_t offset;
+    feature_store_->WriteDescriptors(image_id, descriptors, &file_index,
+                                     &offset);
+
+    SQLITE3_CALL(
+        sqlite3_bind_int64(sql_stmt_write_feature_store_, 1, image_id));
+    SQLITE3_CALL(
+        sqlite3_bind_int64(sql_stmt_write_feature_store_, 2, file_index));
+    SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_write_feature_store_, 3, offset));
+    SQLITE3_CALL(sqlite3_step(sql_stmt_write_feature_store_));
+    SQLITE3_CALL(sqlite3_reset(sql_stmt_write_feature_store_));
+
+    // The descriptors table still holds the dimensions of the descriptors,
+    // such that the counting of the descriptors works unchanged.
+    SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_write_descriptors_, 2,
+                                    descriptors.rows()));
+    SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_write_descriptors_, 3,
+                                    descriptors.cols()));
+    SQLITE3_CALL(sqlite3_bind_zeroblob(sql_stmt_write_descriptors_, 4, 0));
+  } else {
+    WriteDynamicMatrixBlob(sql_stmt_write_descriptors_, descriptors, 2);
+  }
 
   SQLITE3_CALL(sqlite3_step(sql_stmt_write_descriptors_));
   SQLITE3_CALL(sqlite3_reset(sql_stmt_write_descriptors_));
 }
 
+void Database::WriteVisualWordIds(const image_t image_id,
+                                  const uint64_t vocab_hash,
+                                  const Eigen::MatrixXi& word_ids) const {
+  SQLITE3_CALL(
+      sqlite3_bind_int64(sql_stmt_write_visual_word_ids_, 1, image_id));
+  SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_write_visual_word_ids_, 2,
+                                  static_cast<sqlite3_int64>(vocab_hash)));
+
+  const VisualWordIdsBlob blob = word_ids.cast<int32_t>();
+  WriteDynamicMatrixBlob(sql_stmt_write_visual_word_ids_, blob, 3);
+
+  SQLITE3_CALL(sqlite3_step(sql_stmt_write_visual_word_ids_));
+  SQLITE3_CALL(sqlite3_reset(sql_stmt_write_visual_word_ids_));
+}
+
 void Database::WriteMatches(const image_t image_id1, const image_t image_id2,
                             const FeatureMatches& matches) const {
   const image_pair_t pair_id = ImagePairToPairId(image_id1, image_id2);
   SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_write_matches_, 1, pair_id));
 
-  // Important: the swapped data must live until the query is executed.
+  // Important: the swapped and encoded data must live until the query is
+  // executed.
   FeatureMatchesBlob blob = FeatureMatchesToBlob(matches);
   if (SwapImagePair(image_id1, image_id2)) {
     SwapFeatureMatchesBlob(&blob);
-    WriteDynamicMatrixBlob(sql_stmt_write_matches_, blob, 2);
-  } else {
-    WriteDynamicMatrixBlob(sql_stmt_write_matches_, blob, 2);
   }
+  std::vector<uint8_t> data;
+  WriteFeatureMatchesBlob(sql_stmt_write_matches_, blob, matches_format_, 2, 5,
+                          &data);
 
   SQLITE3_CALL(sqlite3_step(sql_stmt_write_matches_));
   SQLITE3_CALL(sqlite3_reset(sql_stmt_write_matches_));
@@ -708,7 +1360,9 @@ void Database::WriteTwoViewGeometry(
 
   const FeatureMatchesBlob inlier_matches =
       FeatureMatchesToBlob(two_view_geometry_ptr->inlier_matches);
-  WriteDynamicMatrixBlob(sql_stmt_write_two_view_geometry_, inlier_matches, 2);
+  std::vector<uint8_t> inlier_matches_data;
+  WriteFeatureMatchesBlob(sql_stmt_write_two_view_geometry_, inlier_matches,
+                          matches_format_, 2, 9, &inlier_matches_data);
 
   SQLITE3_CALL(sqlite3_bind_int64(sql_stmt_write_two_view_geometry_, 5,
                                   two_view_geometry_ptr->config));
@@ -921,6 +1575,76 @@ void Database::Merge(const Database& database1, const Database& database2,
   }
 }
 
+void Database::MergeShards(const std::vector<std::string>& paths,
+                           Database* merged_database) {
+  CHECK_NOTNULL(merged_database);
+  CHECK(!merged_database->IsReadOnly());
+
+  const std::string kSchemaName = "shard";
+
+  for (const auto& path : paths) {
+    CHECK(ExistsFile(path)) << "Database does not exist: " << path;
+
+    // Opening the shard updates its schema.
+    const Database shard(path);
+
+    merged_database->AttachDatabase(path, kSchemaName);
+
+    const sqlite3_int64 camera_offset =
+        merged_database->MaxColumn("camera_id", "main.cameras");
+    const sqlite3_int64 image_offset =
+        merged_database->MaxColumn("image_id", "main.images");
+    CHECK_LT(image_offset + merged_database->MaxColumn(
+                                "image_id", kSchemaName + ".images"),
+             kMaxNumImages)
+        << "The merged database contains too many images";
+    CHECK_EQ(ReadInt64(merged_database->database_,
+                       StringPrintf("SELECT COUNT(*) FROM %s.images WHERE name "
+                                    "IN (SELECT name FROM main.images);",
+                                    kSchemaName.c_str())),
+             0)
+        << "The databases must not contain images with the same name, but "
+           "there are images in "
+        << path << " with names in the other databases";
+
+    {
+      DatabaseTransaction database_transaction(merged_database);
+      for (const auto& table : GetShardTables(camera_offset, image_offset)) {
+        std::string sql = StringPrintf(
+            "INSERT INTO main.%s(%s) SELECT %s FROM %s.%s", table.name.c_str(),
+            table.columns.c_str(), table.offset_columns.c_str(),
+            kSchemaName.c_str(), table.name.c_str());
+        // The descriptors in the feature store are copied separately below.
+        if (table.name == "descriptors") {
+          sql += StringPrintf(
+              " WHERE image_id NOT IN (SELECT image_id FROM %s.feature_store)",
+              kSchemaName.c_str());
+        }
+        SQLITE3_EXEC(merged_database->database_, (sql + ";").c_str(), nullptr);
+      }
+    }
+
+    merged_database->DetachDatabase(kSchemaName);
+
+    // The descriptors in the feature store of the shard are not contained in
+    // its tables and are thus copied through the database interface.
+    if (shard.feature_store_) {
+      sqlite3_stmt* sql_stmt;
+      SQLITE3_CALL(sqlite3_prepare_v2(shard.database_,
+                                      "SELECT image_id FROM feature_store;", -1,
+                                      &sql_stmt, 0));
+      DatabaseTransaction database_transaction(merged_database);
+      while (SQLITE3_CALL(sqlite3_step(sql_stmt)) == SQLITE_ROW) {
+        const image_t image_id =
+            static_cast<image_t>(sqlite3_column_int64(sql_stmt, 0));
+        merged_database->WriteDescriptors(image_id + image_offset,
+                                          shard.ReadDescriptors(image_id));
+      }
+      SQLITE3_CALL(sqlite3_finalize(sql_stmt));
+    }
+  }
+}
+
 void Database::BeginTransaction() const {
   SQLITE3_EXEC(database_, "BEGIN TRANSACTION", nullptr);
 }
@@ -1049,38 +1773,79 @@ void Database::PrepareSQLStatements() {
                                   &sql_stmt_read_images_, 0));
   sql_stmts_.push_back(sql_stmt_read_images_);
 
-  sql = "SELECT rows, cols, data FROM keypoints WHERE image_id = ?;";
+  sql = "SELECT rows, cols, data, format FROM keypoints WHERE image_id = ?;";
   SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
                                   &sql_stmt_read_keypoints_, 0));
   sql_stmts_.push_back(sql_stmt_read_keypoints_);
 
+  // The image_id is the primary key, so that the rows are scanned in the
+  // order of the image identifiers.
+  sql =
+      "SELECT image_id, rows, cols, data, format FROM keypoints "
+      "WHERE image_id >= ? AND image_id <= ?;";
+  SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
+                                  &sql_stmt_read_keypoints_range_, 0));
+  sql_stmts_.push_back(sql_stmt_read_keypoints_range_);
+
+  sql = "SELECT image_id, rows FROM keypoints;";
+  SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
+                                  &sql_stmt_read_keypoint_counts_, 0));
+  sql_stmts_.push_back(sql_stmt_read_keypoint_counts_);
+
+  sql =
+      "SELECT feature_store.file_index, feature_store.offset, "
+      "descriptors.rows, descriptors.cols FROM feature_store "
+      "INNER JOIN descriptors ON feature_store.image_id = descriptors.image_id "
+      "WHERE feature_store.image_id = ?;";
+  SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
+                                  &sql_stmt_read_feature_store_, 0));
+  sql_stmts_.push_back(sql_stmt_read_feature_store_);
+
   sql = "SELECT rows, cols, data FROM descriptors WHERE image_id = ?;";
   SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
                                   &sql_stmt_read_descriptors_, 0));
   sql_stmts_.push_back(sql_stmt_read_descriptors_);
 
-  sql = "SELECT rows, cols, data FROM matches WHERE pair_id = ?;";
+  sql =
+      "SELECT rows, cols, data FROM visual_words WHERE image_id = ? AND "
+      "vocab_hash = ?;";
+  SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
+                                  &sql_stmt_read_visual_word_ids_, 0));
+  sql_stmts_.push_back(sql_stmt_read_visual_word_ids_);
+
+  sql = "SELECT rows, cols, data, format FROM matches WHERE pair_id = ?;";
   SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
                                   &sql_stmt_read_matches_, 0));
   sql_stmts_.push_back(sql_stmt_read_matches_);
 
-  sql = "SELECT * FROM matches WHERE rows > 0;";
+  sql = "SELECT pair_id, rows, cols, data, format FROM matches WHERE rows > 0;";
   SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
                                   &sql_stmt_read_matches_all_, 0));
   sql_stmts_.push_back(sql_stmt_read_matches_all_);
 
   sql =
-      "SELECT rows, cols, data, config, F, E, H FROM two_view_geometries WHERE "
-      "pair_id = ?;";
+      "SELECT rows, cols, data, config, F, E, H, format FROM "
+      "two_view_geometries WHERE pair_id = ?;";
   SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
                                   &sql_stmt_read_two_view_geometry_, 0));
   sql_stmts_.push_back(sql_stmt_read_two_view_geometry_);
 
-  sql = "SELECT * FROM two_view_geometries WHERE rows > 0;";
+  sql =
+      "SELECT pair_id, rows, cols, data, config, F, E, H, format FROM "
+      "two_view_geometries WHERE rows > 0;";
   SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
                                   &sql_stmt_read_two_view_geometries_, 0));
   sql_stmts_.push_back(sql_stmt_read_two_view_geometries_);
 
+  sql =
+      "SELECT pair_id, rows, cols, data, config, F, E, H, format FROM "
+      "two_view_geometries WHERE rows > 0 AND pair_id >= ? AND pair_id <= ? "
+      "ORDER BY pair_id;";
+  SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
+                                  &sql_stmt_read_two_view_geometries_range_,
+                                  0));
+  sql_stmts_.push_back(sql_stmt_read_two_view_geometries_range_);
+
   sql = "SELECT pair_id, rows FROM two_view_geometries WHERE rows > 0;";
   SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
                                   &sql_stmt_read_two_view_geometry_num_inliers_,
@@ -1090,7 +1855,9 @@ void Database::PrepareSQLStatements() {
   //////////////////////////////////////////////////////////////////////////////
   // write_*
   //////////////////////////////////////////////////////////////////////////////
-  sql = "INSERT INTO keypoints(image_id, rows, cols, data) VALUES(?, ?, ?, ?);";
+  sql =
+      "INSERT INTO keypoints(image_id, rows, cols, data, format) "
+      "VALUES(?, ?, ?, ?, ?);";
   SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
                                   &sql_stmt_write_keypoints_, 0));
   sql_stmts_.push_back(sql_stmt_write_keypoints_);
@@ -1101,14 +1868,30 @@ void Database::PrepareSQLStatements() {
                                   &sql_stmt_write_descriptors_, 0));
   sql_stmts_.push_back(sql_stmt_write_descriptors_);
 
-  sql = "INSERT INTO matches(pair_id, rows, cols, data) VALUES(?, ?, ?, ?);";
+  sql =
+      "INSERT INTO feature_store(image_id, file_index, offset) "
+      "VALUES(?, ?, ?);";
+  SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
+                                  &sql_stmt_write_feature_store_, 0));
+  sql_stmts_.push_back(sql_stmt_write_feature_store_);
+
+  sql =
+      "INSERT OR REPLACE INTO visual_words(image_id, vocab_hash, rows, cols, "
+      "data) VALUES(?, ?, ?, ?, ?);";
+  SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
+                                  &sql_stmt_write_visual_word_ids_, 0));
+  sql_stmts_.push_back(sql_stmt_write_visual_word_ids_);
+
+  sql =
+      "INSERT INTO matches(pair_id, rows, cols, data, format) "
+      "VALUES(?, ?, ?, ?, ?);";
   SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
                                   &sql_stmt_write_matches_, 0));
   sql_stmts_.push_back(sql_stmt_write_matches_);
 
   sql =
       "INSERT INTO two_view_geometries(pair_id, rows, cols, data, config, F, "
-      "E, H) VALUES(?, ?, ?, ?, ?, ?, ?, ?);";
+      "E, H, format) VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?);";
   SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1,
                                   &sql_stmt_write_two_view_geometry_, 0));
   sql_stmts_.push_back(sql_stmt_write_two_view_geometry_);
@@ -1151,6 +1934,8 @@ void Database::CreateTables() const {
   CreateImageTable();
   CreateKeypointsTable();
   CreateDescriptorsTable();
+  CreateFeatureStoreTable();
+  CreateVisualWordsTable();
   CreateMatchesTable();
   CreateTwoViewGeometriesTable();
 }
@@ -1196,6 +1981,7 @@ void Database::CreateKeypointsTable() const {
       "    rows      INTEGER               NOT NULL,"
       "    cols      INTEGER               NOT NULL,"
       "    data      BLOB,"
+      "    format    INTEGER               NOT NULL  DEFAULT 0,"
       "FOREIGN KEY(image_id) REFERENCES images(image_id) ON DELETE CASCADE);";
 
   SQLITE3_EXEC(database_, sql.c_str(), nullptr);
@@ -1213,13 +1999,39 @@ void Database::CreateDescriptorsTable() const {
   SQLITE3_EXEC(database_, sql.c_str(), nullptr);
 }
 
+void Database::CreateFeatureStoreTable() const {
+  const std::string sql =
+      "CREATE TABLE IF NOT EXISTS feature_store"
+      "   (image_id    INTEGER  PRIMARY KEY  NOT NULL,"
+      "    file_index  INTEGER               NOT NULL,"
+      "    offset      INTEGER               NOT NULL,"
+      "FOREIGN KEY(image_id) REFERENCES images(image_id) ON DELETE CASCADE);";
+
+  SQLITE3_EXEC(database_, sql.c_str(), nullptr);
+}
+
+void Database::CreateVisualWordsTable() const {
+  const std::string sql =
+      "CREATE TABLE IF NOT EXISTS visual_words"
+      "   (image_id    INTEGER  NOT NULL,"
+      "    vocab_hash  INTEGER  NOT NULL,"
+      "    rows        INTEGER  NOT NULL,"
+      "    cols        INTEGER  NOT NULL,"
+      "    data        BLOB,"
+      "PRIMARY KEY(image_id, vocab_hash),"
+      "FOREIGN KEY(image_id) REFERENCES images(image_id) ON DELETE CASCADE);";
+
+  SQLITE3_EXEC(database_, sql.c_str(), nullptr);
+}
+
 void Database::CreateMatchesTable() const {
   const std::string sql =
       "CREATE TABLE IF NOT EXISTS matches"
       "   (pair_id  INTEGER  PRIMARY KEY  NOT NULL,"
       "    rows     INTEGER               NOT NULL,"
       "    cols     INTEGER               NOT NULL,"
-      "    data     BLOB);";
+      "    data     BLOB,"
+      "    format   INTEGER               NOT NULL  DEFAULT 0);";
 
   SQLITE3_EXEC(database_, sql.c_str(), nullptr);
 }
@@ -1239,12 +2051,38 @@ void Database::CreateTwoViewGeometriesTable() const {
         "    config   INTEGER               NOT NULL,"
         "    F        BLOB,"
         "    E        BLOB,"
-        "    H        BLOB);";
+        "    H        BLOB,"
+        "    format   INTEGER               NOT NULL  DEFAULT 0);";
     SQLITE3_EXEC(database_, sql.c_str(), nullptr);
   }
 }
 
+void Database::AttachDatabase(const std::string& path,
+                              const std::string& schema_name) const {
+  const std::string sql =
+      StringPrintf("ATTACH DATABASE ? AS %s;", schema_name.c_str());
+  sqlite3_stmt* sql_stmt;
+  SQLITE3_CALL(sqlite3_prepare_v2(database_, sql.c_str(), -1, &sql_stmt, 0));
+  SQLITE3_CALL(sqlite3_bind_text(sql_stmt, 1, path.c_str(),
+                                 static_cast<int>(path.size()), SQLITE_STATIC));
+  SQLITE3_CALL(sqlite3_step(sql_stmt));
+  SQLITE3_CALL(sqlite3_finalize(sql_stmt));
+}
+
+void Database::DetachDatabase(const std::string& schema_name) const {
+  const std::string sql =
+      StringPrintf("DETACH DATABASE %s;", schema_name.c_str());
+  SQLITE3_EXEC(database_, sql.c_str(), nullptr);
+}
+
 void Database::UpdateSchema() const {
+  if (!ExistsColumn("keypoints", "format")) {
+    SQLITE3_EXEC(database_,
+                 "ALTER TABLE keypoints ADD COLUMN format INTEGER NOT NULL "
+                 "DEFAULT 0;",
+                 nullptr);
+  }
+
   if (!ExistsColumn("two_view_geometries", "F")) {
     SQLITE3_EXEC(database_,
                  "ALTER TABLE two_view_geometries ADD COLUMN F BLOB;", nullptr);
@@ -1260,6 +2098,20 @@ void Database::UpdateSchema() const {
                  "ALTER TABLE two_view_geometries ADD COLUMN H BLOB;", nullptr);
   }
 
+  if (!ExistsColumn("matches", "format")) {
+    SQLITE3_EXEC(database_,
+                 "ALTER TABLE matches ADD COLUMN format INTEGER NOT NULL "
+                 "DEFAULT 0;",
+                 nullptr);
+  }
+
+  if (!ExistsColumn("two_view_geometries", "format")) {
+    SQLITE3_EXEC(database_,
+                 "ALTER TABLE two_view_geometries ADD COLUMN format INTEGER "
+                 "NOT NULL DEFAULT 0;",
+                 nullptr);
+  }
+
   // Update user version number.
   std::unique_lock<std::mutex> lock(update_schema_mutex_);
   const std::string update_user_version_sql =
@@ -1404,6 +2256,45 @@ size_t Database::MaxColumn(const std::string& column,
   return max;
 }
 
+DatabaseReadPool::DatabaseReadPool(const std::string& path)
+    : path_(path), num_connections_(0) {
+  CHECK(IsSupported(path_));
+}
+
+bool DatabaseReadPool::IsSupported(const std::string& path) {
+  return !path.empty() && path != ":memory:" &&
+         !StringStartsWith(path, "file::memory:");
+}
+
+DatabaseReadPool::Connection DatabaseReadPool::Acquire() {
+  std::unique_ptr<Database> database;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (idle_connections_.empty()) {
+      num_connections_ += 1;
+    } else {
+      database = std::move(idle_connections_.back());
+      idle_connections_.pop_back();
+    }
+  }
+
+  // Open new connections outside of the lock, since it is relatively slow.
+  if (!database) {
+    database.reset(new Database());
+    database->OpenReadOnly(path_);
+  }
+
+  return Connection(database.release(), [this](const Database* database) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_connections_.emplace_back(const_cast<Database*>(database));
+  });
+}
+
+size_t DatabaseReadPool::NumConnections() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return num_connections_;
+}
+
 DatabaseTransaction::DatabaseTransaction(Database* database)
     : database_(database), database_lock_(database->transaction_mutex_) {
   CHECK_NOTNULL(database_);
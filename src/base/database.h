@@ -32,6 +32,8 @@
 #ifndef COLMAP_SRC_BASE_DATABASE_H_
 #define COLMAP_SRC_BASE_DATABASE_H_
 
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
@@ -40,6 +42,7 @@
 
 #include "SQLite/sqlite3.h"
 #include "base/camera.h"
+#include "base/feature_store.h"
 #include "base/image.h"
 #include "estimators/two_view_geometry.h"
 #include "feature/types.h"
@@ -54,7 +57,39 @@ namespace colmap {
 // and trailing `EndTransaction`.
 class Database {
  public:
-  const static int kSchemaVersion = 1;
+  // Version 2 added the `format` column to the `keypoints` table.
+  // Version 3 added the `format` column to the `matches` and
+  // `two_view_geometries` tables.
+  const static int kSchemaVersion = 3;
+
+  // Storage format of the keypoints. The shape of the keypoints of an image
+  // is stored as scale and orientation, if that suffices for all of them, and
+  // otherwise as the full affine shape. The locations are always stored in
+  // single precision.
+  enum class KeypointsFormat {
+    // All parameters in single precision.
+    FLOAT32 = 0,
+    // The shape parameters in half precision, i.e. with a relative precision
+    // of about 1e-3, which halves the storage of similarity keypoints again.
+    FLOAT16 = 1,
+  };
+
+  // Storage format of the matches and the inlier matches of the two-view
+  // geometries. The number of matches is always stored in the `rows` column,
+  // so that the matches can be counted without decoding them.
+  enum class MatchesFormat {
+    // The point indices as raw 32-bit integers in the written order.
+    UINT32 = 0,
+    // The matches sorted by the first point index, whose differences to the
+    // previous match are stored as variable-length integers, typically
+    // reducing the storage by a factor of 2-3. Note that the order of the
+    // written matches is not preserved.
+    VARINT = 1,
+    // The variable-length encoding additionally compressed with zlib, which
+    // is only used for a pair if it reduces the storage. Writing falls back
+    // to the VARINT format, if COLMAP is built without zlib.
+    VARINT_ZLIB = 2,
+  };
 
   // The maximum number of images, that can be stored in the database.
   // This limitation arises due to the fact, that we generate unique IDs for
@@ -71,6 +106,50 @@ class Database {
   void Open(const std::string& path);
   void Close();
 
+  // Open an existing database as a read-only connection, which can be used
+  // concurrently to other read-only connections and one read-write connection
+  // to the same database in other threads, since the database is in WAL mode.
+  // The tables are neither created nor updated, so the database must have
+  // been opened for writing with the current schema before. All write
+  // operations fail for a read-only connection.
+  void OpenReadOnly(const std::string& path);
+
+  // Open a read-only view of multiple database shards, e.g., extracted and
+  // matched on different nodes, without physically merging them. The
+  // identifiers of the cameras and images of every shard are offset by the
+  // maximum identifiers of the previous shards, as in `MergeShards`, and the
+  // image names must be unique across the shards. Since the view is an
+  // in-memory database that attaches the shards, the number of shards is
+  // limited by SQLite (10 by default) and the descriptors in the feature
+  // stores of the shards cannot be read.
+  void OpenShards(const std::vector<std::string>& paths);
+
+  // Open the database at the given path or a read-only view of the shards,
+  // if the path is a comma-separated list of database paths.
+  void OpenShardedPath(const std::string& path);
+
+  // Whether the database was opened as a read-only connection.
+  bool IsReadOnly() const;
+
+  // Path of the opened database, which can be used to open further read
+  // connections for concurrent reading. Empty if not opened.
+  const std::string& Path() const;
+
+  // Path of the optional memory-mapped feature store of the database at the
+  // given path. If this directory exists when opening the database, new
+  // descriptors are written to the feature store instead of the SQLite blobs
+  // and are transparently read from there. Descriptors written before the
+  // creation of the store are still read from the SQLite blobs.
+  static std::string FeatureStorePath(const std::string& path);
+
+  // Set the format of subsequently written keypoints, while the keypoints are
+  // always read in the format in which they were written.
+  void SetKeypointsFormat(const KeypointsFormat format);
+
+  // Set the format of subsequently written matches and inlier matches, while
+  // the matches are always read in the format in which they were written.
+  void SetMatchesFormat(const MatchesFormat format);
+
   // Check if entry already exists in database. For image pairs, the order of
   // `image_id1` and `image_id2` does not matter.
   bool ExistsCamera(const camera_t camera_id) const;
@@ -147,8 +226,30 @@ class Database {
   std::vector<Image> ReadAllImages() const;
 
   FeatureKeypoints ReadKeypoints(const image_t image_id) const;
+
+  // Read the keypoints of all images or of the images with
+  // `min_image_id <= image_id <= max_image_id` in a single table scan in the
+  // order of the image identifiers. For each image with keypoints,
+  // `get_keypoints(image_id)` returns the storage into which the keypoints are
+  // decoded, or null to skip the image. The storage may be reused across
+  // images to stream through the keypoints without reallocation.
+  void ReadAllKeypoints(
+      const std::function<FeatureKeypoints*(image_t)>& get_keypoints) const;
+  void ReadKeypointsInRange(
+      const image_t min_image_id, const image_t max_image_id,
+      const std::function<FeatureKeypoints*(image_t)>& get_keypoints) const;
+
+  // Read the number of keypoints of all images with keypoints in a single
+  // table scan, which is equivalent to `NumKeypointsForImage` for each image.
+  std::unordered_map<image_t, size_t> ReadKeypointCounts() const;
   FeatureDescriptors ReadDescriptors(const image_t image_id) const;
 
+  // Read the cached visual words of the descriptors of an image for the
+  // vocabulary tree with the given hash, see `VisualIndex::VocabularyHash`,
+  // which are empty if the visual words of the image were not yet cached.
+  Eigen::MatrixXi ReadVisualWordIds(const image_t image_id,
+                                    const uint64_t vocab_hash) const;
+
   FeatureMatches ReadMatches(const image_t image_id1,
                              const image_t image_id2) const;
   std::vector<std::pair<image_pair_t, FeatureMatches>> ReadAllMatches() const;
@@ -159,6 +260,13 @@ class Database {
       std::vector<image_pair_t>* image_pair_ids,
       std::vector<TwoViewGeometry>* two_view_geometries) const;
 
+  // Read the two-view geometries of all image pairs with at least one inlier
+  // match and `min_pair_id <= pair_id <= max_pair_id`, ordered by pair id.
+  void ReadTwoViewGeometries(
+      const image_pair_t min_pair_id, const image_pair_t max_pair_id,
+      std::vector<image_pair_t>* image_pair_ids,
+      std::vector<TwoViewGeometry>* two_view_geometries) const;
+
   // Read all image pairs that have an entry in the `NumVerifiedImagePairs`
   // table with at least one inlier match and their number of inlier matches.
   void ReadTwoViewGeometryNumInliers(
@@ -181,6 +289,12 @@ class Database {
                       const FeatureKeypoints& keypoints) const;
   void WriteDescriptors(const image_t image_id,
                         const FeatureDescriptors& descriptors) const;
+
+  // Write the visual words of the descriptors of an image for the vocabulary
+  // tree with the given hash, which replaces previously cached visual words
+  // of the image for the same vocabulary tree.
+  void WriteVisualWordIds(const image_t image_id, const uint64_t vocab_hash,
+                          const Eigen::MatrixXi& word_ids) const;
   void WriteMatches(const image_t image_id1, const image_t image_id2,
                     const FeatureMatches& matches) const;
   void WriteTwoViewGeometry(const image_t image_id1, const image_t image_id2,
@@ -211,6 +325,15 @@ class Database {
   static void Merge(const Database& database1, const Database& database2,
                     Database* merged_database);
 
+  // Merge the database shards at the given paths into the given database by
+  // bulk copying their tables through SQL instead of reading and writing
+  // every row. The identifiers of the cameras and images of every shard are
+  // offset by the current maximum identifiers of the merged database, so that
+  // the pair identifiers of the matches are remapped by a constant offset.
+  // The image names must be unique across all databases.
+  static void MergeShards(const std::vector<std::string>& paths,
+                          Database* merged_database);
+
  private:
   friend class DatabaseTransaction;
 
@@ -233,11 +356,19 @@ class Database {
   void CreateImageTable() const;
   void CreateKeypointsTable() const;
   void CreateDescriptorsTable() const;
+  void CreateFeatureStoreTable() const;
+  void CreateVisualWordsTable() const;
   void CreateMatchesTable() const;
   void CreateTwoViewGeometriesTable() const;
 
   void UpdateSchema() const;
 
+  // Attach and detach another database to this connection under the given
+  // schema name to access its tables in queries of this connection.
+  void AttachDatabase(const std::string& path,
+                      const std::string& schema_name) const;
+  void DetachDatabase(const std::string& schema_name) const;
+
   bool ExistsTable(const std::string& table_name) const;
   bool ExistsColumn(const std::string& table_name,
                     const std::string& column_name) const;
@@ -252,7 +383,14 @@ class Database {
   size_t SumColumn(const std::string& column, const std::string& table) const;
   size_t MaxColumn(const std::string& column, const std::string& table) const;
 
+  std::string path_;
   sqlite3* database_ = nullptr;
+  bool read_only_ = false;
+
+  std::unique_ptr<FeatureStore> feature_store_;
+
+  KeypointsFormat keypoints_format_ = KeypointsFormat::FLOAT32;
+  MatchesFormat matches_format_ = MatchesFormat::UINT32;
 
   // Ensure that only one database object at a time updates the schema of a
   // database. Since the schema is updated every time a database is opened, this
@@ -295,16 +433,23 @@ class Database {
   sqlite3_stmt* sql_stmt_read_image_name_ = nullptr;
   sqlite3_stmt* sql_stmt_read_images_ = nullptr;
   sqlite3_stmt* sql_stmt_read_keypoints_ = nullptr;
+  sqlite3_stmt* sql_stmt_read_keypoints_range_ = nullptr;
+  sqlite3_stmt* sql_stmt_read_keypoint_counts_ = nullptr;
   sqlite3_stmt* sql_stmt_read_descriptors_ = nullptr;
+  sqlite3_stmt* sql_stmt_read_feature_store_ = nullptr;
+  sqlite3_stmt* sql_stmt_read_visual_word_ids_ = nullptr;
   sqlite3_stmt* sql_stmt_read_matches_ = nullptr;
   sqlite3_stmt* sql_stmt_read_matches_all_ = nullptr;
   sqlite3_stmt* sql_stmt_read_two_view_geometry_ = nullptr;
   sqlite3_stmt* sql_stmt_read_two_view_geometries_ = nullptr;
+  sqlite3_stmt* sql_stmt_read_two_view_geometries_range_ = nullptr;
   sqlite3_stmt* sql_stmt_read_two_view_geometry_num_inliers_ = nullptr;
 
   // write_*
   sqlite3_stmt* sql_stmt_write_keypoints_ = nullptr;
   sqlite3_stmt* sql_stmt_write_descriptors_ = nullptr;
+  sqlite3_stmt* sql_stmt_write_feature_store_ = nullptr;
+  sqlite3_stmt* sql_stmt_write_visual_word_ids_ = nullptr;
   sqlite3_stmt* sql_stmt_write_matches_ = nullptr;
   sqlite3_stmt* sql_stmt_write_two_view_geometry_ = nullptr;
 
@@ -332,6 +477,40 @@ class DatabaseTransaction {
   std::unique_lock<std::mutex> database_lock_;
 };
 
+// Pool of read-only connections to a database for concurrent reading from
+// multiple threads, e.g., of keypoints and descriptors. Every thread acquires
+// its own connection, which is returned to the pool when the handle is
+// destructed, such that the connections and their prepared statements are
+// reused. Connections are opened on demand, so the pool holds at most as
+// many connections as were used concurrently. The pool is thread-safe and
+// must outlive all acquired connections.
+class DatabaseReadPool {
+ public:
+  typedef std::unique_ptr<const Database, std::function<void(const Database*)>>
+      Connection;
+
+  explicit DatabaseReadPool(const std::string& path);
+
+  // Whether the database at the given path can be opened with multiple
+  // connections, which is not the case for in-memory databases.
+  static bool IsSupported(const std::string& path);
+
+  // Acquire an idle connection or open a new connection, if none is idle.
+  Connection Acquire();
+
+  // The number of opened connections, including the acquired connections.
+  size_t NumConnections() const;
+
+ private:
+  NON_COPYABLE(DatabaseReadPool)
+  NON_MOVABLE(DatabaseReadPool)
+
+  const std::string path_;
+  mutable std::mutex mutex_;
+  size_t num_connections_;
+  std::vector<std::unique_ptr<Database>> idle_connections_;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
@@ -31,15 +31,196 @@
 
 #include "base/database_cache.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <unordered_set>
 
 #include "feature/utils.h"
+#include "util/endian.h"
+#include "util/misc.h"
 #include "util/string.h"
+#include "util/threading.h"
 #include "util/timer.h"
 
 namespace colmap {
+namespace {
+
+const char kCorrespondenceGraphMagic[] = "COLMAP_CORRESPONDENCE_GRAPH";
+const uint32_t kCorrespondenceGraphVersion = 1;
+
+// Writes the not yet finalized correspondence graph together with the
+// verified image pairs and image sizes it was built from.
+void WriteCorrespondenceGraphSnapshot(
+    const std::string& path, const size_t min_num_matches,
+    const bool ignore_watermarks,
+    const std::unordered_map<image_pair_t, int>& pair_num_inliers,
+    const std::vector<std::pair<image_t, point2D_t>>& image_num_points2D,
+    const CorrespondenceGraph& correspondence_graph) {
+  // Write to a temporary file first, so that an interrupted write never
+  // leaves behind a truncated snapshot.
+  const std::string tmp_path = path + ".tmp";
 
-DatabaseCache::DatabaseCache() {}
+  {
+    std::ofstream file(tmp_path, std::ios::binary);
+    CHECK(file.is_open()) << tmp_path;
+
+    file.write(kCorrespondenceGraphMagic, sizeof(kCorrespondenceGraphMagic));
+    WriteBinaryLittleEndian<uint32_t>(&file, kCorrespondenceGraphVersion);
+    WriteBinaryLittleEndian<uint64_t>(&file, min_num_matches);
+    WriteBinaryLittleEndian<uint8_t>(&file, ignore_watermarks);
+
+    WriteBinaryLittleEndian<uint64_t>(&file, pair_num_inliers.size());
+    for (const auto& pair : pair_num_inliers) {
+      WriteBinaryLittleEndian<image_pair_t>(&file, pair.first);
+      WriteBinaryLittleEndian<int32_t>(&file, pair.second);
+    }
+
+    WriteBinaryLittleEndian<uint64_t>(&file, image_num_points2D.size());
+    for (const auto& image : image_num_points2D) {
+      WriteBinaryLittleEndian<image_t>(&file, image.first);
+      WriteBinaryLittleEndian<point2D_t>(&file, image.second);
+    }
+
+    correspondence_graph.Write(&file);
+    CHECK(file.good()) << tmp_path;
+  }
+
+  CHECK_EQ(std::rename(tmp_path.c_str(), path.c_str()), 0) << path;
+}
+
+// Reads a correspondence graph snapshot, if it is consistent with the current
+// state of the database. Image pairs that were verified after the snapshot was
+// written are returned in `new_pair_ids` and images contained in the snapshot
+// are returned in `image_ids`.
+bool ReadCorrespondenceGraphSnapshot(
+    const std::string& path, const Database& database,
+    const size_t min_num_matches, const bool ignore_watermarks,
+    const std::unordered_map<image_pair_t, int>& pair_num_inliers,
+    std::vector<image_pair_t>* new_pair_ids, std::vector<image_t>* image_ids,
+    CorrespondenceGraph* correspondence_graph) {
+  if (!ExistsFile(path)) {
+    return false;
+  }
+
+  std::ifstream file(path, std::ios::binary);
+  CHECK(file.is_open()) << path;
+
+  char magic[sizeof(kCorrespondenceGraphMagic)];
+  file.read(magic, sizeof(magic));
+  if (!file.good() ||
+      std::string(magic, sizeof(magic)) !=
+          std::string(kCorrespondenceGraphMagic, sizeof(magic)) ||
+      ReadBinaryLittleEndian<uint32_t>(&file) != kCorrespondenceGraphVersion ||
+      ReadBinaryLittleEndian<uint64_t>(&file) != min_num_matches ||
+      ReadBinaryLittleEndian<uint8_t>(&file) !=
+          static_cast<uint8_t>(ignore_watermarks)) {
+    return false;
+  }
+
+  // All image pairs in the snapshot must still exist unchanged, otherwise the
+  // graph would contain stale correspondences.
+  std::unordered_set<image_pair_t> snapshot_pair_ids;
+  const size_t num_pairs = ReadBinaryLittleEndian<uint64_t>(&file);
+  snapshot_pair_ids.reserve(num_pairs);
+  for (size_t i = 0; i < num_pairs; ++i) {
+    const image_pair_t pair_id = ReadBinaryLittleEndian<image_pair_t>(&file);
+    const int num_inliers = ReadBinaryLittleEndian<int32_t>(&file);
+    const auto it = pair_num_inliers.find(pair_id);
+    if (it == pair_num_inliers.end() || it->second != num_inliers) {
+      return false;
+    }
+    snapshot_pair_ids.insert(pair_id);
+  }
+
+  // The images must still have the same number of keypoints, otherwise the
+  // point indices of the correspondences are invalid.
+  const std::unordered_map<image_t, size_t> num_keypoints =
+      database.ReadKeypointCounts();
+  const size_t num_images = ReadBinaryLittleEndian<uint64_t>(&file);
+  std::vector<image_t> snapshot_image_ids;
+  snapshot_image_ids.reserve(num_images);
+  for (size_t i = 0; i < num_images; ++i) {
+    const image_t image_id = ReadBinaryLittleEndian<image_t>(&file);
+    const point2D_t num_points2D = ReadBinaryLittleEndian<point2D_t>(&file);
+    if (!file.good()) {
+      return false;
+    }
+    const auto it = num_keypoints.find(image_id);
+    if (it == num_keypoints.end()) {
+      // Images without keypoints are not in the keypoints table.
+      if (num_points2D != 0 || !database.ExistsImage(image_id)) {
+        return false;
+      }
+    } else if (it->second != num_points2D) {
+      return false;
+    }
+    snapshot_image_ids.push_back(image_id);
+  }
+
+  correspondence_graph->Read(&file);
+  if (!file.good()) {
+    *correspondence_graph = CorrespondenceGraph();
+    return false;
+  }
+
+  *image_ids = std::move(snapshot_image_ids);
+
+  new_pair_ids->clear();
+  for (const auto& pair : pair_num_inliers) {
+    if (snapshot_pair_ids.count(pair.first) == 0) {
+      new_pair_ids->push_back(pair.first);
+    }
+  }
+
+  return true;
+}
+
+// Runs `func(database, begin_idx, end_idx)` on contiguous chunks of
+// `num_items` items. The chunks are processed concurrently with separate
+// read-only connections to the database, unless it cannot be opened multiple
+// times.
+void ParallelReadDatabase(
+    const Database& database, const size_t num_items, const int num_threads,
+    const std::function<void(const Database&, size_t, size_t)>& func) {
+  const int num_eff_threads = std::min<int>(
+      GetEffectiveNumThreads(num_threads), std::max<size_t>(num_items, 1));
+  if (num_eff_threads <= 1 ||
+      !DatabaseReadPool::IsSupported(database.Path())) {
+    func(database, 0, num_items);
+    return;
+  }
+
+  DatabaseReadPool read_pool(database.Path());
+  ThreadPool thread_pool(num_eff_threads);
+  const size_t chunk_size = (num_items + num_eff_threads - 1) / num_eff_threads;
+  for (size_t begin_idx = 0; begin_idx < num_items; begin_idx += chunk_size) {
+    const size_t end_idx = std::min(begin_idx + chunk_size, num_items);
+    thread_pool.AddTask([&read_pool, &func, begin_idx, end_idx]() {
+      const auto thread_database = read_pool.Acquire();
+      func(*thread_database, begin_idx, end_idx);
+    });
+  }
+  thread_pool.Wait();
+}
+
+bool UseInlierMatches(const TwoViewGeometry& two_view_geometry,
+                      const size_t min_num_matches,
+                      const bool ignore_watermarks) {
+  return static_cast<size_t>(two_view_geometry.inlier_matches.size()) >=
+             min_num_matches &&
+         (!ignore_watermarks ||
+          two_view_geometry.config != TwoViewGeometry::WATERMARK);
+}
+
+}  // namespace
+
+DatabaseCache::DatabaseCache()
+    : min_num_matches_(0), ignore_watermarks_(false) {}
 
 void DatabaseCache::AddCamera(const class Camera& camera) {
   CHECK(!ExistsCamera(camera.CameraId()));
@@ -54,7 +235,19 @@ void DatabaseCache::AddImage(const class Image& image) {
 
 void DatabaseCache::Load(const Database& database, const size_t min_num_matches,
                          const bool ignore_watermarks,
-                         const std::unordered_set<std::string>& image_names) {
+                         const std::unordered_set<std::string>& image_names,
+                         const std::string& correspondence_graph_path,
+                         const int num_threads) {
+  const bool use_correspondence_graph_snapshot =
+      !correspondence_graph_path.empty() && image_names.empty();
+
+  min_num_matches_ = min_num_matches;
+  ignore_watermarks_ = ignore_watermarks;
+  image_names_ = image_names;
+
+  Timer total_timer;
+  total_timer.Start();
+
   //////////////////////////////////////////////////////////////////////////////
   // Load cameras
   //////////////////////////////////////////////////////////////////////////////
@@ -85,18 +278,109 @@ void DatabaseCache::Load(const Database& database, const size_t min_num_matches,
 
   std::vector<image_pair_t> image_pair_ids;
   std::vector<TwoViewGeometry> two_view_geometries;
-  database.ReadTwoViewGeometries(&image_pair_ids, &two_view_geometries);
 
-  std::cout << StringPrintf(" %d in %.3fs", image_pair_ids.size(),
-                            timer.ElapsedSeconds())
-            << std::endl;
+  // Images contained in the correspondence graph snapshot.
+  std::vector<image_t> snapshot_image_ids;
+  // Number of inliers of all verified image pairs in the database.
+  std::unordered_map<image_pair_t, int> pair_num_inliers;
+  // Sorted identifiers of all verified image pairs in the database.
+  std::vector<image_pair_t> all_image_pair_ids;
+  bool loaded_correspondence_graph_snapshot = false;
+
+  {
+    std::vector<std::pair<image_t, image_t>> image_pairs;
+    std::vector<int> num_inliers;
+    database.ReadTwoViewGeometryNumInliers(&image_pairs, &num_inliers);
+    pair_num_inliers.reserve(image_pairs.size());
+    all_image_pair_ids.reserve(image_pairs.size());
+    for (size_t i = 0; i < image_pairs.size(); ++i) {
+      const image_pair_t pair_id = Database::ImagePairToPairId(
+          image_pairs[i].first, image_pairs[i].second);
+      pair_num_inliers.emplace(pair_id, num_inliers[i]);
+      all_image_pair_ids.push_back(pair_id);
+    }
+    std::sort(all_image_pair_ids.begin(), all_image_pair_ids.end());
+    loaded_image_pair_ids_.insert(all_image_pair_ids.begin(),
+                                  all_image_pair_ids.end());
+  }
+
+  if (use_correspondence_graph_snapshot) {
+    loaded_correspondence_graph_snapshot = ReadCorrespondenceGraphSnapshot(
+        correspondence_graph_path, database, min_num_matches,
+        ignore_watermarks, pair_num_inliers, &image_pair_ids,
+        &snapshot_image_ids, &correspondence_graph_);
+  }
+
+  if (loaded_correspondence_graph_snapshot) {
+    // Only read the image pairs that were verified after the snapshot.
+    two_view_geometries.resize(image_pair_ids.size());
+    ParallelReadDatabase(
+        database, image_pair_ids.size(), num_threads,
+        [&image_pair_ids, &two_view_geometries](const Database& database,
+                                                const size_t begin_idx,
+                                                const size_t end_idx) {
+          for (size_t i = begin_idx; i < end_idx; ++i) {
+            image_t image_id1;
+            image_t image_id2;
+            Database::PairIdToImagePair(image_pair_ids[i], &image_id1,
+                                        &image_id2);
+            two_view_geometries[i] =
+                database.ReadTwoViewGeometry(image_id1, image_id2);
+          }
+        });
+
+    std::cout << StringPrintf(" %d in %.3fs (snapshot %d)",
+                              pair_num_inliers.size(), timer.ElapsedSeconds(),
+                              pair_num_inliers.size() - image_pair_ids.size())
+              << std::endl;
+  } else {
+    // Read contiguous ranges of image pairs concurrently and concatenate them
+    // in the order of the pair identifiers.
+    std::vector<std::vector<image_pair_t>> chunk_image_pair_ids;
+    std::vector<std::vector<TwoViewGeometry>> chunk_two_view_geometries;
+    std::mutex chunk_mutex;
+    std::vector<std::pair<size_t, size_t>> chunk_ranges;
+    ParallelReadDatabase(
+        database, all_image_pair_ids.size(), num_threads,
+        [&](const Database& database, const size_t begin_idx,
+            const size_t end_idx) {
+          if (begin_idx == end_idx) {
+            return;
+          }
+          std::vector<image_pair_t> pair_ids;
+          std::vector<TwoViewGeometry> geometries;
+          pair_ids.reserve(end_idx - begin_idx);
+          geometries.reserve(end_idx - begin_idx);
+          database.ReadTwoViewGeometries(all_image_pair_ids[begin_idx],
+                                         all_image_pair_ids[end_idx - 1],
+                                         &pair_ids, &geometries);
+          std::lock_guard<std::mutex> lock(chunk_mutex);
+          chunk_ranges.emplace_back(begin_idx, chunk_image_pair_ids.size());
+          chunk_image_pair_ids.push_back(std::move(pair_ids));
+          chunk_two_view_geometries.push_back(std::move(geometries));
+        });
+
+    std::sort(chunk_ranges.begin(), chunk_ranges.end());
+    image_pair_ids.reserve(all_image_pair_ids.size());
+    two_view_geometries.reserve(all_image_pair_ids.size());
+    for (const auto& chunk_range : chunk_ranges) {
+      auto& pair_ids = chunk_image_pair_ids[chunk_range.second];
+      auto& geometries = chunk_two_view_geometries[chunk_range.second];
+      image_pair_ids.insert(image_pair_ids.end(), pair_ids.begin(),
+                            pair_ids.end());
+      std::move(geometries.begin(), geometries.end(),
+                std::back_inserter(two_view_geometries));
+    }
+
+    std::cout << StringPrintf(" %d in %.3fs", image_pair_ids.size(),
+                              timer.ElapsedSeconds())
+              << std::endl;
+  }
 
   auto UseInlierMatchesCheck = [min_num_matches, ignore_watermarks](
                                    const TwoViewGeometry& two_view_geometry) {
-    return static_cast<size_t>(two_view_geometry.inlier_matches.size()) >=
-               min_num_matches &&
-           (!ignore_watermarks ||
-            two_view_geometry.config != TwoViewGeometry::WATERMARK);
+    return UseInlierMatches(two_view_geometry, min_num_matches,
+                            ignore_watermarks);
   };
 
   //////////////////////////////////////////////////////////////////////////////
@@ -127,6 +411,8 @@ void DatabaseCache::Load(const Database& database, const size_t min_num_matches,
     // Collect all images that are connected in the correspondence graph.
     std::unordered_set<image_t> connected_image_ids;
     connected_image_ids.reserve(image_ids.size());
+    connected_image_ids.insert(snapshot_image_ids.begin(),
+                               snapshot_image_ids.end());
     for (size_t i = 0; i < image_pair_ids.size(); ++i) {
       if (UseInlierMatchesCheck(two_view_geometries[i])) {
         image_t image_id1;
@@ -142,18 +428,59 @@ void DatabaseCache::Load(const Database& database, const size_t min_num_matches,
     // Load images with correspondences and discard images without
     // correspondences, as those images are useless for SfM.
     images_.reserve(connected_image_ids.size());
+    std::vector<class Image*> loaded_images;
+    loaded_images.reserve(connected_image_ids.size());
     for (const auto& image : images) {
       if (image_ids.count(image.ImageId()) > 0 &&
           connected_image_ids.count(image.ImageId()) > 0) {
-        images_.emplace(image.ImageId(), image);
-        const FeatureKeypoints keypoints =
-            database.ReadKeypoints(image.ImageId());
-        const std::vector<Eigen::Vector2d> points =
-            FeatureKeypointsToPointsVector(keypoints);
-        images_[image.ImageId()].SetPoints2D(points);
+        loaded_images.push_back(
+            &images_.emplace(image.ImageId(), image).first->second);
       }
     }
 
+    // The images are distinct objects, so their keypoints can be set
+    // concurrently. Every chunk of consecutive images reads the keypoints in
+    // a single scan over their range of identifiers instead of one query per
+    // image, where the keypoints of unloaded images in the range are skipped.
+    std::sort(loaded_images.begin(), loaded_images.end(),
+              [](const class Image* image1, const class Image* image2) {
+                return image1->ImageId() < image2->ImageId();
+              });
+    ParallelReadDatabase(
+        database, loaded_images.size(), num_threads,
+        [&loaded_images](const Database& database, const size_t begin_idx,
+                         const size_t end_idx) {
+          if (begin_idx == end_idx) {
+            return;
+          }
+          FeatureKeypoints keypoints;
+          class Image* image = nullptr;
+          size_t image_idx = begin_idx;
+          const auto SetPoints2D = [&image, &keypoints]() {
+            if (image != nullptr) {
+              image->SetPoints2D(FeatureKeypointsToPointsVector(keypoints));
+              image = nullptr;
+            }
+          };
+          database.ReadKeypointsInRange(
+              loaded_images[begin_idx]->ImageId(),
+              loaded_images[end_idx - 1]->ImageId(),
+              [&](const image_t image_id) -> FeatureKeypoints* {
+                SetPoints2D();
+                while (image_idx < end_idx &&
+                       loaded_images[image_idx]->ImageId() < image_id) {
+                  image_idx += 1;
+                }
+                if (image_idx < end_idx &&
+                    loaded_images[image_idx]->ImageId() == image_id) {
+                  image = loaded_images[image_idx];
+                  return &keypoints;
+                }
+                return nullptr;
+              });
+          SetPoints2D();
+        });
+
     std::cout << StringPrintf(" %d in %.3fs (connected %d)", images.size(),
                               timer.ElapsedSeconds(),
                               connected_image_ids.size())
@@ -168,18 +495,24 @@ void DatabaseCache::Load(const Database& database, const size_t min_num_matches,
   std::cout << "Building correspondence graph..." << std::flush;
 
   for (const auto& image : images_) {
-    correspondence_graph_.AddImage(image.first, image.second.NumPoints2D());
+    if (!correspondence_graph_.ExistsImage(image.first)) {
+      correspondence_graph_.AddImage(image.first, image.second.NumPoints2D());
+    }
   }
 
   size_t num_ignored_image_pairs = 0;
+  std::vector<image_pair_t> used_image_pair_ids;
+  std::vector<const FeatureMatches*> used_inlier_matches;
+  used_image_pair_ids.reserve(image_pair_ids.size());
+  used_inlier_matches.reserve(image_pair_ids.size());
   for (size_t i = 0; i < image_pair_ids.size(); ++i) {
     if (UseInlierMatchesCheck(two_view_geometries[i])) {
       image_t image_id1;
       image_t image_id2;
       Database::PairIdToImagePair(image_pair_ids[i], &image_id1, &image_id2);
       if (image_ids.count(image_id1) > 0 && image_ids.count(image_id2) > 0) {
-        correspondence_graph_.AddCorrespondences(
-            image_id1, image_id2, two_view_geometries[i].inlier_matches);
+        used_image_pair_ids.push_back(image_pair_ids[i]);
+        used_inlier_matches.push_back(&two_view_geometries[i].inlier_matches);
       } else {
         num_ignored_image_pairs += 1;
       }
@@ -188,6 +521,22 @@ void DatabaseCache::Load(const Database& database, const size_t min_num_matches,
     }
   }
 
+  correspondence_graph_.AddCorrespondences(used_image_pair_ids,
+                                           used_inlier_matches, num_threads);
+
+  if (use_correspondence_graph_snapshot &&
+      (!loaded_correspondence_graph_snapshot || !image_pair_ids.empty())) {
+    std::vector<std::pair<image_t, point2D_t>> image_num_points2D;
+    image_num_points2D.reserve(images_.size());
+    for (const auto& image : images_) {
+      image_num_points2D.emplace_back(image.first, image.second.NumPoints2D());
+    }
+    WriteCorrespondenceGraphSnapshot(correspondence_graph_path,
+                                     min_num_matches, ignore_watermarks,
+                                     pair_num_inliers, image_num_points2D,
+                                     correspondence_graph_);
+  }
+
   correspondence_graph_.Finalize();
 
   // Set number of observations and correspondences per image.
@@ -201,6 +550,213 @@ void DatabaseCache::Load(const Database& database, const size_t min_num_matches,
   std::cout << StringPrintf(" in %.3fs (ignored %d)", timer.ElapsedSeconds(),
                             num_ignored_image_pairs)
             << std::endl;
+
+  std::cout << StringPrintf("Loaded database cache in %.3fs (%d threads)",
+                            total_timer.ElapsedSeconds(),
+                            GetEffectiveNumThreads(num_threads))
+            << std::endl;
+}
+
+void DatabaseCache::LoadSubset(
+    const DatabaseCache& database_cache,
+    const std::unordered_set<std::string>& image_names,
+    const int num_threads) {
+  CHECK_NE(this, &database_cache);
+
+  min_num_matches_ = database_cache.min_num_matches_;
+  ignore_watermarks_ = database_cache.ignore_watermarks_;
+  image_names_ = image_names;
+  loaded_image_pair_ids_ = database_cache.loaded_image_pair_ids_;
+
+  Timer timer;
+  timer.Start();
+
+  cameras_ = database_cache.cameras_;
+
+  std::unordered_set<image_t> image_ids;
+  for (const auto& image : database_cache.images_) {
+    if (image_names.count(image.second.Name()) > 0) {
+      image_ids.insert(image.first);
+    }
+  }
+
+  // Collect the correspondences between the images of the subset for each
+  // image pair in the same order as the matches of the database, i.e. from the
+  // image with the smaller to the image with the larger identifier.
+  const class CorrespondenceGraph& correspondence_graph =
+      database_cache.correspondence_graph_;
+  std::unordered_map<image_pair_t, FeatureMatches> pair_matches;
+  for (const auto image_id1 : image_ids) {
+    if (!correspondence_graph.ExistsImage(image_id1)) {
+      continue;
+    }
+    const point2D_t num_points2D =
+        database_cache.images_.at(image_id1).NumPoints2D();
+    for (point2D_t point2D_idx = 0; point2D_idx < num_points2D;
+         ++point2D_idx) {
+      for (const auto& corr :
+           correspondence_graph.FindCorrespondences(image_id1, point2D_idx)) {
+        if (Database::SwapImagePair(image_id1, corr.image_id) ||
+            image_ids.count(corr.image_id) == 0) {
+          continue;
+        }
+        pair_matches[Database::ImagePairToPairId(image_id1, corr.image_id)]
+            .emplace_back(point2D_idx, corr.point2D_idx);
+      }
+    }
+  }
+
+  std::vector<image_pair_t> image_pair_ids;
+  image_pair_ids.reserve(pair_matches.size());
+  for (const auto& matches : pair_matches) {
+    image_pair_ids.push_back(matches.first);
+  }
+  std::sort(image_pair_ids.begin(), image_pair_ids.end());
+
+  // Load images with correspondences and discard images without
+  // correspondences, as those images are useless for SfM.
+  std::unordered_set<image_t> connected_image_ids;
+  std::vector<const FeatureMatches*> inlier_matches;
+  inlier_matches.reserve(image_pair_ids.size());
+  for (const auto pair_id : image_pair_ids) {
+    image_t image_id1;
+    image_t image_id2;
+    Database::PairIdToImagePair(pair_id, &image_id1, &image_id2);
+    connected_image_ids.insert(image_id1);
+    connected_image_ids.insert(image_id2);
+    inlier_matches.push_back(&pair_matches.at(pair_id));
+  }
+
+  images_.reserve(connected_image_ids.size());
+  for (const auto image_id : connected_image_ids) {
+    const class Image& image = database_cache.images_.at(image_id);
+    images_.emplace(image_id, image);
+    correspondence_graph_.AddImage(image_id, image.NumPoints2D());
+  }
+
+  correspondence_graph_.AddCorrespondences(image_pair_ids, inlier_matches,
+                                           num_threads);
+  correspondence_graph_.Finalize();
+
+  for (auto& image : images_) {
+    image.second.SetNumObservations(
+        correspondence_graph_.NumObservationsForImage(image.first));
+    image.second.SetNumCorrespondences(
+        correspondence_graph_.NumCorrespondencesForImage(image.first));
+  }
+
+  std::cout << StringPrintf("Loaded %d of %d images from database cache in "
+                            "%.3fs",
+                            images_.size(), database_cache.NumImages(),
+                            timer.ElapsedSeconds())
+            << std::endl;
+}
+
+bool DatabaseCache::Update(const Database& database,
+                           std::vector<image_t>* new_image_ids,
+                           std::vector<image_pair_t>* new_image_pair_ids) {
+  CHECK_NOTNULL(new_image_ids)->clear();
+  CHECK_NOTNULL(new_image_pair_ids)->clear();
+
+  std::vector<std::pair<image_t, image_t>> image_pairs;
+  std::vector<int> num_inliers;
+  database.ReadTwoViewGeometryNumInliers(&image_pairs, &num_inliers);
+
+  // Images that are not yet cached, or null if they are excluded by name.
+  std::unordered_map<image_t, std::unique_ptr<class Image>> new_images;
+  auto IsUsedImage = [this, &database, &new_images](const image_t image_id) {
+    if (ExistsImage(image_id)) {
+      return true;
+    }
+    auto it = new_images.find(image_id);
+    if (it == new_images.end()) {
+      std::unique_ptr<class Image> image(
+          new class Image(database.ReadImage(image_id)));
+      if (!image_names_.empty() && image_names_.count(image->Name()) == 0) {
+        image.reset();
+      }
+      it = new_images.emplace(image_id, std::move(image)).first;
+    }
+    return it->second != nullptr;
+  };
+
+  std::vector<FeatureMatches> inlier_matches;
+  for (size_t i = 0; i < image_pairs.size(); ++i) {
+    const image_pair_t pair_id = Database::ImagePairToPairId(
+        image_pairs[i].first, image_pairs[i].second);
+    if (!loaded_image_pair_ids_.insert(pair_id).second ||
+        static_cast<size_t>(num_inliers[i]) < min_num_matches_) {
+      continue;
+    }
+
+    image_t image_id1;
+    image_t image_id2;
+    Database::PairIdToImagePair(pair_id, &image_id1, &image_id2);
+    if (!IsUsedImage(image_id1) || !IsUsedImage(image_id2)) {
+      continue;
+    }
+
+    TwoViewGeometry two_view_geometry =
+        database.ReadTwoViewGeometry(image_id1, image_id2);
+    if (UseInlierMatches(two_view_geometry, min_num_matches_,
+                         ignore_watermarks_)) {
+      new_image_pair_ids->push_back(pair_id);
+      inlier_matches.push_back(std::move(two_view_geometry.inlier_matches));
+    }
+  }
+
+  if (new_image_pair_ids->empty()) {
+    return false;
+  }
+
+  // Images with correspondences only in discarded pairs are not loaded.
+  std::unordered_set<image_t> pair_image_ids;
+  for (const auto pair_id : *new_image_pair_ids) {
+    image_t image_id1;
+    image_t image_id2;
+    Database::PairIdToImagePair(pair_id, &image_id1, &image_id2);
+    pair_image_ids.insert(image_id1);
+    pair_image_ids.insert(image_id2);
+  }
+
+  for (const auto image_id : pair_image_ids) {
+    const auto it = new_images.find(image_id);
+    if (it != new_images.end()) {
+      class Image& image = *it->second;
+      if (!ExistsCamera(image.CameraId())) {
+        AddCamera(database.ReadCamera(image.CameraId()));
+      }
+      image.SetPoints2D(
+          FeatureKeypointsToPointsVector(database.ReadKeypoints(image_id)));
+      AddImage(image);
+      new_image_ids->push_back(image_id);
+    } else if (!correspondence_graph_.ExistsImage(image_id)) {
+      // Cached images without observations were removed from the graph.
+      correspondence_graph_.AddImage(image_id,
+                                     images_.at(image_id).NumPoints2D());
+    }
+  }
+
+  std::vector<const FeatureMatches*> used_inlier_matches;
+  used_inlier_matches.reserve(inlier_matches.size());
+  for (const auto& matches : inlier_matches) {
+    used_inlier_matches.push_back(&matches);
+  }
+  correspondence_graph_.AddCorrespondences(*new_image_pair_ids,
+                                           used_inlier_matches, 1);
+  correspondence_graph_.Finalize();
+
+  for (const auto image_id : pair_image_ids) {
+    if (correspondence_graph_.ExistsImage(image_id)) {
+      class Image& image = images_.at(image_id);
+      image.SetNumObservations(
+          correspondence_graph_.NumObservationsForImage(image_id));
+      image.SetNumCorrespondences(
+          correspondence_graph_.NumCorrespondencesForImage(image_id));
+    }
+  }
+
+  return true;
 }
 
 const class Image* DatabaseCache::FindImageWithName(
@@ -213,4 +769,14 @@ const class Image* DatabaseCache::FindImageWithName(
   return nullptr;
 }
 
+size_t DatabaseCache::NumBytes() const {
+  size_t num_bytes = correspondence_graph_.NumBytes() +
+                     cameras_.size() * sizeof(class Camera) +
+                     loaded_image_pair_ids_.size() * sizeof(image_pair_t);
+  for (const auto& image : images_) {
+    num_bytes += image.second.NumBytes();
+  }
+  return num_bytes;
+}
+
 }  // namespace colmap
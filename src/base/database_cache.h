@@ -88,18 +88,70 @@ class DatabaseCache {
   // @param ignore_watermarks     Whether to ignore watermark image pairs.
   // @param image_names           Whether to use only load the data for a subset
   //                              of the images. All images are used if empty.
+  // @param correspondence_graph_path  Optional path to a binary snapshot of
+  //                              the correspondence graph. If the snapshot
+  //                              matches the database, only the image pairs
+  //                              verified since it was written are read from
+  //                              the database and the snapshot is then
+  //                              updated. Only used if `image_names` is empty.
+  // @param num_threads           The number of threads used to read from the
+  //                              database through separate read connections
+  //                              and to build the correspondence graph.
   void Load(const Database& database, const size_t min_num_matches,
             const bool ignore_watermarks,
-            const std::unordered_set<std::string>& image_names);
+            const std::unordered_set<std::string>& image_names,
+            const std::string& correspondence_graph_path = "",
+            const int num_threads = -1);
+
+  // Load the subset of images from another cache that was already loaded,
+  // without accessing the database. The correspondence graph is restricted to
+  // the correspondences between the images of the subset and, as in `Load`,
+  // images without any correspondences in the subset are discarded. The
+  // settings of the other cache are inherited, such that `Update` only adds
+  // image pairs between the images of the subset.
+  //
+  // @param database_cache        Source cache from which to load data.
+  // @param image_names           The names of the images of the subset.
+  // @param num_threads           The number of threads used to build the
+  //                              correspondence graph.
+  void LoadSubset(const DatabaseCache& database_cache,
+                  const std::unordered_set<std::string>& image_names,
+                  const int num_threads = -1);
+
+  // Add the image pairs that were verified after the last call to `Load` or
+  // `Update`, using the same settings as `Load`. Images that become connected
+  // through these pairs are loaded together with their cameras and keypoints.
+  // The correspondence graph is only re-finalized for the affected images.
+  //
+  // @param database              Source database from which to load data.
+  // @param new_image_ids         Images that were added to the cache.
+  // @param new_image_pair_ids    Image pairs that were added to the
+  //                              correspondence graph.
+  //
+  // @return                      Whether any image pairs were added.
+  bool Update(const Database& database, std::vector<image_t>* new_image_ids,
+              std::vector<image_pair_t>* new_image_pair_ids);
 
   // Find specific image by name. Note that this uses linear search.
   const class Image* FindImageWithName(const std::string& name) const;
 
+  // Get the approximate memory usage of the cache in bytes.
+  size_t NumBytes() const;
+
  private:
   class CorrespondenceGraph correspondence_graph_;
 
   EIGEN_STL_UMAP(camera_t, class Camera) cameras_;
   EIGEN_STL_UMAP(image_t, class Image) images_;
+
+  // Settings of the last call to `Load`, which are reused by `Update`.
+  size_t min_num_matches_;
+  bool ignore_watermarks_;
+  std::unordered_set<std::string> image_names_;
+
+  // All image pairs in the database that were considered so far, including
+  // the ones that did not pass the inlier matches check.
+  std::unordered_set<image_pair_t> loaded_image_pair_ids_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -33,9 +33,56 @@
 #include "util/testing.h"
 
 #include "base/database_cache.h"
+#include "util/misc.h"
 
 using namespace colmap;
 
+namespace {
+
+void WriteTestImage(Database* database, const camera_t camera_id,
+                    const std::string& name) {
+  Image image;
+  image.SetName(name);
+  image.SetCameraId(camera_id);
+  image.SetImageId(database->WriteImage(image));
+  database->WriteKeypoints(image.ImageId(), FeatureKeypoints(20));
+}
+
+void WriteTestTwoViewGeometry(Database* database, const image_t image_id1,
+                              const image_t image_id2,
+                              const size_t num_inliers) {
+  TwoViewGeometry two_view_geometry;
+  two_view_geometry.config = TwoViewGeometry::CALIBRATED;
+  two_view_geometry.inlier_matches.resize(num_inliers);
+  for (size_t i = 0; i < num_inliers; ++i) {
+    two_view_geometry.inlier_matches[i].point2D_idx1 = i;
+    two_view_geometry.inlier_matches[i].point2D_idx2 = i;
+  }
+  database->WriteTwoViewGeometry(image_id1, image_id2, two_view_geometry);
+}
+
+void CheckEqualCorrespondenceGraphs(const DatabaseCache& cache1,
+                                    const DatabaseCache& cache2) {
+  BOOST_CHECK_EQUAL(cache1.NumImages(), cache2.NumImages());
+  const auto& graph1 = cache1.CorrespondenceGraph();
+  const auto& graph2 = cache2.CorrespondenceGraph();
+  BOOST_CHECK_EQUAL(graph1.NumImages(), graph2.NumImages());
+  BOOST_CHECK_EQUAL(graph1.NumImagePairs(), graph2.NumImagePairs());
+  BOOST_CHECK(graph1.NumCorrespondencesBetweenImages() ==
+              graph2.NumCorrespondencesBetweenImages());
+  for (const auto& image : cache1.Images()) {
+    BOOST_CHECK(cache2.ExistsImage(image.first));
+    BOOST_CHECK_EQUAL(graph1.NumObservationsForImage(image.first),
+                      graph2.NumObservationsForImage(image.first));
+    BOOST_CHECK_EQUAL(graph1.NumCorrespondencesForImage(image.first),
+                      graph2.NumCorrespondencesForImage(image.first));
+    BOOST_CHECK_EQUAL(image.second.NumCorrespondences(),
+                      cache2.Image(image.first).NumCorrespondences());
+  }
+}
+
+}  // namespace
+
 BOOST_AUTO_TEST_CASE(TestEmpty) {
   DatabaseCache cache;
   BOOST_CHECK_EQUAL(cache.NumCameras(), 0);
@@ -84,3 +131,193 @@ BOOST_AUTO_TEST_CASE(TestAddImage) {
   BOOST_CHECK_EQUAL(
       cache.CorrespondenceGraph().NumObservationsForImage(image.ImageId()), 0);
 }
+
+BOOST_AUTO_TEST_CASE(TestLoadCorrespondenceGraphSnapshot) {
+  const auto test_dir = boost::filesystem::temp_directory_path() /
+                        boost::filesystem::unique_path();
+  CreateDirIfNotExists(test_dir.string());
+  const std::string snapshot_path =
+      (test_dir / "correspondence_graph.bin").string();
+
+  Database database(":memory:");
+  Camera camera;
+  camera.InitializeWithId(SimplePinholeCameraModel::model_id, 1, 1, 1);
+  camera.SetCameraId(database.WriteCamera(camera));
+  for (int i = 0; i < 4; ++i) {
+    WriteTestImage(&database, camera.CameraId(), std::to_string(i));
+  }
+  WriteTestTwoViewGeometry(&database, 1, 2, 15);
+  WriteTestTwoViewGeometry(&database, 2, 3, 5);
+
+  // The first load builds the graph from scratch and writes the snapshot.
+  DatabaseCache cache1;
+  cache1.Load(database, 10, false, {}, snapshot_path);
+  BOOST_CHECK(ExistsFile(snapshot_path));
+  BOOST_CHECK_EQUAL(cache1.NumImages(), 2);
+
+  DatabaseCache cache2;
+  cache2.Load(database, 10, false, {}, snapshot_path);
+  CheckEqualCorrespondenceGraphs(cache1, cache2);
+
+  // Newly verified image pairs are added to the snapshot graph.
+  WriteTestTwoViewGeometry(&database, 3, 4, 12);
+  DatabaseCache cache3;
+  cache3.Load(database, 10, false, {}, snapshot_path);
+  BOOST_CHECK_EQUAL(cache3.NumImages(), 4);
+  DatabaseCache cache4;
+  cache4.Load(database, 10, false, {});
+  CheckEqualCorrespondenceGraphs(cache3, cache4);
+  DatabaseCache cache5;
+  cache5.Load(database, 10, false, {}, snapshot_path);
+  CheckEqualCorrespondenceGraphs(cache4, cache5);
+
+  // Removed image pairs invalidate the snapshot.
+  database.DeleteInlierMatches(3, 4);
+  DatabaseCache cache6;
+  cache6.Load(database, 10, false, {}, snapshot_path);
+  DatabaseCache cache7;
+  cache7.Load(database, 10, false, {});
+  CheckEqualCorrespondenceGraphs(cache6, cache7);
+  BOOST_CHECK_EQUAL(cache6.NumImages(), 2);
+
+  // A snapshot built with different options is ignored and rebuilt.
+  DatabaseCache cache8;
+  cache8.Load(database, 13, false, {}, snapshot_path);
+  DatabaseCache cache9;
+  cache9.Load(database, 13, false, {});
+  CheckEqualCorrespondenceGraphs(cache8, cache9);
+  BOOST_CHECK_EQUAL(cache8.NumImages(), 2);
+
+  boost::filesystem::remove_all(test_dir);
+}
+
+BOOST_AUTO_TEST_CASE(TestLoadParallel) {
+  const auto test_dir = boost::filesystem::temp_directory_path() /
+                        boost::filesystem::unique_path();
+  CreateDirIfNotExists(test_dir.string());
+  const std::string database_path = (test_dir / "database.db").string();
+
+  {
+    Database database(database_path);
+    Camera camera;
+    camera.InitializeWithId(SimplePinholeCameraModel::model_id, 1, 1, 1);
+    camera.SetCameraId(database.WriteCamera(camera));
+    for (int i = 0; i < 20; ++i) {
+      WriteTestImage(&database, camera.CameraId(), std::to_string(i));
+    }
+    for (image_t image_id1 = 1; image_id1 <= 20; ++image_id1) {
+      for (image_t image_id2 = image_id1 + 1; image_id2 <= 20; image_id2 += 3) {
+        WriteTestTwoViewGeometry(&database, image_id1, image_id2,
+                                 5 + (image_id1 + image_id2) % 15);
+      }
+    }
+  }
+
+  const Database database(database_path);
+  DatabaseCache cache;
+  cache.Load(database, 10, false, {}, "", 1);
+  for (const int num_threads : {2, 4, -1}) {
+    DatabaseCache cache_parallel;
+    cache_parallel.Load(database, 10, false, {}, "", num_threads);
+    CheckEqualCorrespondenceGraphs(cache, cache_parallel);
+    for (const auto& image : cache.Images()) {
+      BOOST_CHECK_EQUAL(image.second.NumPoints2D(),
+                        cache_parallel.Image(image.first).NumPoints2D());
+    }
+  }
+
+  boost::filesystem::remove_all(test_dir);
+}
+
+BOOST_AUTO_TEST_CASE(TestLoadSubset) {
+  Database database(":memory:");
+  Camera camera;
+  camera.InitializeWithId(SimplePinholeCameraModel::model_id, 1, 1, 1);
+  camera.SetCameraId(database.WriteCamera(camera));
+  for (int i = 0; i < 8; ++i) {
+    WriteTestImage(&database, camera.CameraId(), std::to_string(i));
+  }
+  for (image_t image_id1 = 1; image_id1 <= 8; ++image_id1) {
+    for (image_t image_id2 = image_id1 + 1; image_id2 <= 8; image_id2 += 2) {
+      WriteTestTwoViewGeometry(&database, image_id1, image_id2,
+                               5 + (image_id1 + image_id2) % 15);
+    }
+  }
+
+  DatabaseCache cache;
+  cache.Load(database, 10, false, {});
+
+  const std::unordered_set<std::string> image_names = {"0", "1", "2", "4",
+                                                       "5", "7"};
+  DatabaseCache loaded_cache;
+  loaded_cache.Load(database, 10, false, image_names);
+  DatabaseCache subset_cache;
+  subset_cache.LoadSubset(cache, image_names);
+  CheckEqualCorrespondenceGraphs(loaded_cache, subset_cache);
+  BOOST_CHECK_EQUAL(subset_cache.NumCameras(), 1);
+  for (const auto& image : subset_cache.Images()) {
+    BOOST_CHECK_EQUAL(image.second.NumPoints2D(), 20);
+    BOOST_CHECK_EQUAL(image.second.NumObservations(),
+                      loaded_cache.Image(image.first).NumObservations());
+  }
+
+  // Only image pairs between the images of the subset are updated.
+  WriteTestTwoViewGeometry(&database, 1, 3, 12);
+  WriteTestTwoViewGeometry(&database, 2, 4, 12);
+  std::vector<image_t> new_image_ids;
+  std::vector<image_pair_t> new_image_pair_ids;
+  BOOST_CHECK(
+      subset_cache.Update(database, &new_image_ids, &new_image_pair_ids));
+  BOOST_CHECK(new_image_ids.empty());
+  BOOST_CHECK_EQUAL(new_image_pair_ids.size(), 1);
+  BOOST_CHECK_EQUAL(new_image_pair_ids[0], Database::ImagePairToPairId(1, 3));
+}
+
+BOOST_AUTO_TEST_CASE(TestUpdate) {
+  const auto test_dir = boost::filesystem::temp_directory_path() /
+                        boost::filesystem::unique_path();
+  CreateDirIfNotExists(test_dir.string());
+  const std::string database_path = (test_dir / "database.db").string();
+
+  Database database(database_path);
+  Camera camera;
+  camera.InitializeWithId(SimplePinholeCameraModel::model_id, 1, 1, 1);
+  camera.SetCameraId(database.WriteCamera(camera));
+  for (int i = 0; i < 4; ++i) {
+    WriteTestImage(&database, camera.CameraId(), std::to_string(i));
+  }
+  WriteTestTwoViewGeometry(&database, 1, 2, 15);
+
+  DatabaseCache cache;
+  cache.Load(database, 10, false, {});
+  BOOST_CHECK_EQUAL(cache.NumImages(), 2);
+
+  std::vector<image_t> new_image_ids;
+  std::vector<image_pair_t> new_image_pair_ids;
+  BOOST_CHECK(!cache.Update(database, &new_image_ids, &new_image_pair_ids));
+  BOOST_CHECK(new_image_ids.empty());
+  BOOST_CHECK(new_image_pair_ids.empty());
+
+  WriteTestTwoViewGeometry(&database, 2, 3, 12);
+  WriteTestTwoViewGeometry(&database, 1, 3, 5);
+  WriteTestTwoViewGeometry(&database, 3, 4, 5);
+  BOOST_CHECK(cache.Update(database, &new_image_ids, &new_image_pair_ids));
+  BOOST_CHECK_EQUAL(new_image_ids.size(), 1);
+  BOOST_CHECK_EQUAL(new_image_ids[0], 3);
+  BOOST_CHECK_EQUAL(new_image_pair_ids.size(), 1);
+  BOOST_CHECK_EQUAL(new_image_pair_ids[0], Database::ImagePairToPairId(2, 3));
+  BOOST_CHECK(!cache.ExistsImage(4));
+  BOOST_CHECK_EQUAL(cache.Image(3).NumPoints2D(), 20);
+  BOOST_CHECK_EQUAL(cache.Image(3).NumObservations(), 12);
+  BOOST_CHECK_EQUAL(cache.Image(2).NumCorrespondences(), 27);
+
+  // The updated cache must match a freshly loaded one.
+  DatabaseCache loaded_cache;
+  loaded_cache.Load(database, 10, false, {});
+  CheckEqualCorrespondenceGraphs(cache, loaded_cache);
+
+  BOOST_CHECK(!cache.Update(database, &new_image_ids, &new_image_pair_ids));
+
+  database.Close();
+  boost::filesystem::remove_all(test_dir);
+}
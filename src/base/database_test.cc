@@ -34,7 +34,10 @@
 
 #include <thread>
 
+#include <boost/filesystem.hpp>
+
 #include "base/database.h"
+#include "util/misc.h"
 
 using namespace colmap;
 
@@ -246,6 +249,133 @@ BOOST_AUTO_TEST_CASE(TestKeypoints) {
   BOOST_CHECK_EQUAL(database.NumKeypointsForImage(image.ImageId()), 20);
 }
 
+BOOST_AUTO_TEST_CASE(TestKeypointsFormat) {
+  for (const auto format : {Database::KeypointsFormat::FLOAT32,
+                            Database::KeypointsFormat::FLOAT16}) {
+    Database database(kMemoryDatabasePath);
+    database.SetKeypointsFormat(format);
+    Camera camera;
+    camera.SetCameraId(database.WriteCamera(camera));
+    Image image;
+    image.SetCameraId(camera.CameraId());
+
+    FeatureKeypoints similarity_keypoints;
+    FeatureKeypoints affine_keypoints;
+    for (int i = 0; i < 10; ++i) {
+      similarity_keypoints.emplace_back(1000.25f + i, 500.5f - i, 1.0f + i,
+                                        0.3f * i - 1.5f);
+      affine_keypoints.emplace_back(1000.25f + i, 500.5f - i, 1.0f + i, 0.1f,
+                                    -0.2f, 2.0f - 0.1f * i);
+    }
+
+    const double max_error =
+        format == Database::KeypointsFormat::FLOAT32 ? 1e-5 : 1e-2;
+
+    for (const auto& keypoints : {similarity_keypoints, affine_keypoints}) {
+      image.SetName("test" + std::to_string(database.NumImages()));
+      image.SetImageId(database.WriteImage(image));
+      database.WriteKeypoints(image.ImageId(), keypoints);
+      const FeatureKeypoints keypoints_read =
+          database.ReadKeypoints(image.ImageId());
+      BOOST_CHECK_EQUAL(keypoints.size(), keypoints_read.size());
+      for (size_t i = 0; i < keypoints.size(); ++i) {
+        // The locations are always stored in single precision.
+        BOOST_CHECK_EQUAL(keypoints[i].x, keypoints_read[i].x);
+        BOOST_CHECK_EQUAL(keypoints[i].y, keypoints_read[i].y);
+        const float scale = keypoints[i].ComputeScale();
+        BOOST_CHECK_LE(std::abs(keypoints[i].a11 - keypoints_read[i].a11),
+                       max_error * scale);
+        BOOST_CHECK_LE(std::abs(keypoints[i].a12 - keypoints_read[i].a12),
+                       max_error * scale);
+        BOOST_CHECK_LE(std::abs(keypoints[i].a21 - keypoints_read[i].a21),
+                       max_error * scale);
+        BOOST_CHECK_LE(std::abs(keypoints[i].a22 - keypoints_read[i].a22),
+                       max_error * scale);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestReadAllKeypoints) {
+  Database database(kMemoryDatabasePath);
+  Camera camera;
+  camera.SetCameraId(database.WriteCamera(camera));
+  BOOST_CHECK(database.ReadKeypointCounts().empty());
+
+  std::vector<FeatureKeypoints> keypoints(4);
+  for (size_t i = 0; i < keypoints.size(); ++i) {
+    Image image;
+    image.SetName("test" + std::to_string(i));
+    image.SetCameraId(camera.CameraId());
+    image.SetImageId(database.WriteImage(image));
+    // The third image has no keypoints.
+    if (i == 2) {
+      continue;
+    }
+    for (size_t j = 0; j < 5 * (i + 1); ++j) {
+      keypoints[i].emplace_back(1.0f * i, 2.0f * j, 1.0f + j, 0.1f * j);
+    }
+    database.SetKeypointsFormat(i % 2 == 0
+                                    ? Database::KeypointsFormat::FLOAT32
+                                    : Database::KeypointsFormat::FLOAT16);
+    database.WriteKeypoints(image.ImageId(), keypoints[i]);
+  }
+
+  const auto num_keypoints = database.ReadKeypointCounts();
+  BOOST_CHECK_EQUAL(num_keypoints.size(), 3);
+  BOOST_CHECK_EQUAL(num_keypoints.at(1), 5);
+  BOOST_CHECK_EQUAL(num_keypoints.at(2), 10);
+  BOOST_CHECK_EQUAL(num_keypoints.count(3), 0);
+  BOOST_CHECK_EQUAL(num_keypoints.at(4), 20);
+
+  std::vector<image_t> image_ids;
+  FeatureKeypoints keypoints_read;
+  database.ReadAllKeypoints([&](const image_t image_id) {
+    // Check the keypoints of the previous image, which are decoded after the
+    // callback returned.
+    if (!image_ids.empty()) {
+      BOOST_CHECK_EQUAL(keypoints_read.size(),
+                        keypoints[image_ids.back() - 1].size());
+    }
+    image_ids.push_back(image_id);
+    return &keypoints_read;
+  });
+  BOOST_CHECK_EQUAL(image_ids.size(), 3);
+  BOOST_CHECK_EQUAL(image_ids[0], 1);
+  BOOST_CHECK_EQUAL(image_ids[1], 2);
+  BOOST_CHECK_EQUAL(image_ids[2], 4);
+  BOOST_CHECK_EQUAL(keypoints_read.size(), keypoints[3].size());
+  for (size_t i = 0; i < keypoints_read.size(); ++i) {
+    BOOST_CHECK_EQUAL(keypoints_read[i].x, keypoints[3][i].x);
+    BOOST_CHECK_EQUAL(keypoints_read[i].y, keypoints[3][i].y);
+  }
+
+  std::vector<FeatureKeypoints> keypoints_range(keypoints.size());
+  database.ReadKeypointsInRange(
+      2, 3, [&](const image_t image_id) -> FeatureKeypoints* {
+        BOOST_CHECK_GE(image_id, 2);
+        BOOST_CHECK_LE(image_id, 3);
+        return &keypoints_range[image_id - 1];
+      });
+  BOOST_CHECK(keypoints_range[0].empty());
+  BOOST_CHECK_EQUAL(keypoints_range[1].size(), keypoints[1].size());
+  for (size_t i = 0; i < keypoints[1].size(); ++i) {
+    BOOST_CHECK_EQUAL(keypoints_range[1][i].x, keypoints[1][i].x);
+    BOOST_CHECK_EQUAL(keypoints_range[1][i].y, keypoints[1][i].y);
+    BOOST_CHECK_CLOSE(keypoints_range[1][i].ComputeScale(),
+                      keypoints[1][i].ComputeScale(), 1e-1);
+  }
+  BOOST_CHECK(keypoints_range[3].empty());
+
+  // Skipped images are not decoded.
+  size_t num_calls = 0;
+  database.ReadAllKeypoints([&](const image_t) -> FeatureKeypoints* {
+    num_calls += 1;
+    return nullptr;
+  });
+  BOOST_CHECK_EQUAL(num_calls, 3);
+}
+
 BOOST_AUTO_TEST_CASE(TestDescriptors) {
   Database database(kMemoryDatabasePath);
   Camera camera;
@@ -279,6 +409,138 @@ BOOST_AUTO_TEST_CASE(TestDescriptors) {
   BOOST_CHECK_EQUAL(database.NumDescriptorsForImage(image.ImageId()), 20);
 }
 
+BOOST_AUTO_TEST_CASE(TestVisualWordIds) {
+  Database database(kMemoryDatabasePath);
+  Camera camera;
+  camera.SetCameraId(database.WriteCamera(camera));
+  Image image;
+  image.SetName("test");
+  image.SetCameraId(camera.CameraId());
+  image.SetImageId(database.WriteImage(image));
+  const uint64_t kVocabHash1 = 0xFFFFFFFFFFFFFFFFULL;
+  const uint64_t kVocabHash2 = 1;
+  BOOST_CHECK_EQUAL(
+      database.ReadVisualWordIds(image.ImageId(), kVocabHash1).size(), 0);
+  const Eigen::MatrixXi word_ids1 = Eigen::MatrixXi::Random(10, 2);
+  database.WriteVisualWordIds(image.ImageId(), kVocabHash1, word_ids1);
+  BOOST_CHECK(database.ReadVisualWordIds(image.ImageId(), kVocabHash1) ==
+              word_ids1);
+  BOOST_CHECK_EQUAL(
+      database.ReadVisualWordIds(image.ImageId(), kVocabHash2).size(), 0);
+  const Eigen::MatrixXi word_ids2 = Eigen::MatrixXi::Random(10, 1);
+  database.WriteVisualWordIds(image.ImageId(), kVocabHash2, word_ids2);
+  BOOST_CHECK(database.ReadVisualWordIds(image.ImageId(), kVocabHash1) ==
+              word_ids1);
+  BOOST_CHECK(database.ReadVisualWordIds(image.ImageId(), kVocabHash2) ==
+              word_ids2);
+  // Writing the visual words again replaces the cached visual words.
+  const Eigen::MatrixXi word_ids3 = Eigen::MatrixXi::Random(5, 1);
+  database.WriteVisualWordIds(image.ImageId(), kVocabHash2, word_ids3);
+  BOOST_CHECK(database.ReadVisualWordIds(image.ImageId(), kVocabHash2) ==
+              word_ids3);
+}
+
+BOOST_AUTO_TEST_CASE(TestOpenReadOnly) {
+  const auto test_dir = boost::filesystem::temp_directory_path() /
+                        boost::filesystem::unique_path();
+  CreateDirIfNotExists(test_dir.string());
+  const std::string path = (test_dir / "database.db").string();
+
+  Database database(path);
+  BOOST_CHECK(!database.IsReadOnly());
+  Camera camera;
+  camera.SetCameraId(database.WriteCamera(camera));
+  Image image;
+  image.SetName("test");
+  image.SetCameraId(camera.CameraId());
+  image.SetImageId(database.WriteImage(image));
+  const FeatureDescriptors descriptors = FeatureDescriptors::Random(10, 128);
+  database.WriteDescriptors(image.ImageId(), descriptors);
+
+  Database read_only_database;
+  read_only_database.OpenReadOnly(path);
+  BOOST_CHECK(read_only_database.IsReadOnly());
+  BOOST_CHECK_EQUAL(read_only_database.Path(), path);
+  BOOST_CHECK_EQUAL(read_only_database.NumImages(), 1);
+  BOOST_CHECK(read_only_database.ReadDescriptors(image.ImageId()) ==
+              descriptors);
+
+  // Writes of the read-write connection are visible to the reader.
+  image.SetName("test2");
+  image.SetImageId(database.WriteImage(image));
+  BOOST_CHECK_EQUAL(read_only_database.NumImages(), 2);
+
+  read_only_database.Close();
+  BOOST_CHECK(!read_only_database.IsReadOnly());
+  database.Close();
+  boost::filesystem::remove_all(test_dir);
+}
+
+BOOST_AUTO_TEST_CASE(TestReadPool) {
+  BOOST_CHECK(!DatabaseReadPool::IsSupported(kMemoryDatabasePath));
+  BOOST_CHECK(!DatabaseReadPool::IsSupported(""));
+
+  const auto test_dir = boost::filesystem::temp_directory_path() /
+                        boost::filesystem::unique_path();
+  CreateDirIfNotExists(test_dir.string());
+  const std::string path = (test_dir / "database.db").string();
+  BOOST_CHECK(DatabaseReadPool::IsSupported(path));
+
+  Database database(path);
+  Camera camera;
+  camera.SetCameraId(database.WriteCamera(camera));
+  const int kNumImages = 8;
+  std::vector<FeatureDescriptors> descriptors(kNumImages);
+  for (int i = 0; i < kNumImages; ++i) {
+    Image image;
+    image.SetName(std::to_string(i));
+    image.SetCameraId(camera.CameraId());
+    image.SetImageId(database.WriteImage(image));
+    descriptors[i] = FeatureDescriptors::Random(10 + i, 128);
+    database.WriteDescriptors(image.ImageId(), descriptors[i]);
+  }
+
+  DatabaseReadPool read_pool(path);
+  BOOST_CHECK_EQUAL(read_pool.NumConnections(), 0);
+
+  {
+    const auto connection1 = read_pool.Acquire();
+    BOOST_CHECK(connection1->IsReadOnly());
+    BOOST_CHECK_EQUAL(read_pool.NumConnections(), 1);
+    const auto connection2 = read_pool.Acquire();
+    BOOST_CHECK(connection1.get() != connection2.get());
+    BOOST_CHECK_EQUAL(read_pool.NumConnections(), 2);
+  }
+
+  // Released connections are reused.
+  read_pool.Acquire();
+  BOOST_CHECK_EQUAL(read_pool.NumConnections(), 2);
+
+  std::vector<std::thread> threads;
+  std::vector<int> num_equal(kNumImages, 0);
+  for (int i = 0; i < kNumImages; ++i) {
+    threads.emplace_back([&, i]() {
+      for (int j = 0; j < 10; ++j) {
+        const auto connection = read_pool.Acquire();
+        if (connection->ReadDescriptors(i + 1) == descriptors[i]) {
+          num_equal[i] += 1;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumImages; ++i) {
+    BOOST_CHECK_EQUAL(num_equal[i], 10);
+  }
+  BOOST_CHECK_LE(read_pool.NumConnections(), kNumImages);
+
+  database.Close();
+  boost::filesystem::remove_all(test_dir);
+}
+
 BOOST_AUTO_TEST_CASE(TestMatches) {
   Database database(kMemoryDatabasePath);
   const image_t image_id1 = 1;
@@ -382,6 +644,90 @@ BOOST_AUTO_TEST_CASE(TestTwoViewGeometry) {
   BOOST_CHECK_EQUAL(database.NumInlierMatches(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(TestMatchesFormat) {
+  FeatureMatches matches;
+  for (point2D_t i = 0; i < 1000; ++i) {
+    matches.emplace_back((7 * i) % 1000, 3 * i + (i % 5));
+  }
+  matches.emplace_back(std::numeric_limits<point2D_t>::max() - 1, 0);
+
+  const auto SortedMatches = [](FeatureMatches matches, const bool swap) {
+    if (swap) {
+      for (auto& match : matches) {
+        std::swap(match.point2D_idx1, match.point2D_idx2);
+      }
+    }
+    std::sort(matches.begin(), matches.end(),
+              [](const FeatureMatch& match1, const FeatureMatch& match2) {
+                return match1.point2D_idx1 < match2.point2D_idx1 ||
+                       (match1.point2D_idx1 == match2.point2D_idx1 &&
+                        match1.point2D_idx2 < match2.point2D_idx2);
+              });
+    if (swap) {
+      for (auto& match : matches) {
+        std::swap(match.point2D_idx1, match.point2D_idx2);
+      }
+    }
+    return matches;
+  };
+
+  const auto CheckEqualMatches = [](const FeatureMatches& matches1,
+                                    const FeatureMatches& matches2) {
+    BOOST_CHECK_EQUAL(matches1.size(), matches2.size());
+    for (size_t i = 0; i < std::min(matches1.size(), matches2.size()); ++i) {
+      BOOST_CHECK_EQUAL(matches1[i].point2D_idx1, matches2[i].point2D_idx1);
+      BOOST_CHECK_EQUAL(matches1[i].point2D_idx2, matches2[i].point2D_idx2);
+    }
+  };
+
+  for (const auto format : {Database::MatchesFormat::VARINT,
+                            Database::MatchesFormat::VARINT_ZLIB}) {
+    Database database(kMemoryDatabasePath);
+    database.SetMatchesFormat(format);
+
+    // The matches are stored sorted for the ordered image pair, so they are
+    // read sorted by the second index for the swapped image pair.
+    for (const bool swap : {false, true}) {
+      const image_t image_id1 = swap ? 2 : 1;
+      const image_t image_id2 = swap ? 1 : 2;
+
+      database.WriteMatches(image_id1, image_id2, matches);
+      CheckEqualMatches(database.ReadMatches(image_id1, image_id2),
+                        SortedMatches(matches, swap));
+      BOOST_CHECK_EQUAL(database.NumMatches(), matches.size());
+      BOOST_CHECK_EQUAL(database.ReadAllMatches().size(), 1);
+
+      TwoViewGeometry two_view_geometry;
+      two_view_geometry.config = TwoViewGeometry::UNCALIBRATED;
+      two_view_geometry.inlier_matches = matches;
+      database.WriteTwoViewGeometry(image_id1, image_id2, two_view_geometry);
+      CheckEqualMatches(
+          database.ReadTwoViewGeometry(image_id1, image_id2).inlier_matches,
+          SortedMatches(matches, swap));
+      BOOST_CHECK_EQUAL(database.NumInlierMatches(), matches.size());
+
+      std::vector<image_pair_t> image_pair_ids;
+      std::vector<TwoViewGeometry> two_view_geometries;
+      database.ReadTwoViewGeometries(&image_pair_ids, &two_view_geometries);
+      BOOST_CHECK_EQUAL(two_view_geometries.size(), 1);
+      BOOST_CHECK_EQUAL(two_view_geometries[0].inlier_matches.size(),
+                        matches.size());
+
+      database.ClearMatches();
+      database.ClearTwoViewGeometries();
+    }
+
+    // Empty matches.
+    database.WriteMatches(1, 2, FeatureMatches());
+    BOOST_CHECK(database.ReadMatches(1, 2).empty());
+
+    // Matches written in different formats can be read at the same time.
+    database.SetMatchesFormat(Database::MatchesFormat::UINT32);
+    database.WriteMatches(1, 3, matches);
+    CheckEqualMatches(database.ReadMatches(1, 3), matches);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestMerge) {
   Database database1(kMemoryDatabasePath);
   Database database2(kMemoryDatabasePath);
@@ -465,3 +811,89 @@ BOOST_AUTO_TEST_CASE(TestMerge) {
   BOOST_CHECK(!merged_database.ExistsMatches(2, 4));
   BOOST_CHECK(merged_database.ExistsMatches(3, 4));
 }
+
+void WriteDatabaseShard(const std::string& path, const std::string& prefix) {
+  Database database(path);
+  Camera camera;
+  camera.InitializeWithName("SIMPLE_PINHOLE", 1.0, 1, 1);
+  camera.SetCameraId(database.WriteCamera(camera));
+  for (int i = 0; i < 3; ++i) {
+    Image image;
+    image.SetName(prefix + std::to_string(i));
+    image.SetCameraId(camera.CameraId());
+    image.SetImageId(database.WriteImage(image));
+    database.WriteKeypoints(image.ImageId(), FeatureKeypoints(10 + i));
+    database.WriteDescriptors(image.ImageId(),
+                              FeatureDescriptors::Random(10 + i, 128));
+    database.WriteVisualWordIds(image.ImageId(), 1,
+                                Eigen::MatrixXi::Zero(10 + i, 1));
+  }
+  database.WriteMatches(1, 2, FeatureMatches(10));
+  TwoViewGeometry two_view_geometry;
+  two_view_geometry.inlier_matches = FeatureMatches(5);
+  database.WriteTwoViewGeometry(2, 3, two_view_geometry);
+}
+
+BOOST_AUTO_TEST_CASE(TestMergeShards) {
+  const auto test_dir = boost::filesystem::temp_directory_path() /
+                        boost::filesystem::unique_path();
+  CreateDirIfNotExists(test_dir.string());
+  const std::vector<std::string> paths = {(test_dir / "shard1.db").string(),
+                                          (test_dir / "shard2.db").string()};
+  WriteDatabaseShard(paths[0], "a");
+  WriteDatabaseShard(paths[1], "b");
+
+  Database merged_database(kMemoryDatabasePath);
+  Database::MergeShards(paths, &merged_database);
+  BOOST_CHECK_EQUAL(merged_database.NumCameras(), 2);
+  BOOST_CHECK_EQUAL(merged_database.NumImages(), 6);
+  BOOST_CHECK_EQUAL(merged_database.NumKeypoints(), 66);
+  BOOST_CHECK_EQUAL(merged_database.NumDescriptors(), 66);
+  BOOST_CHECK_EQUAL(merged_database.ReadImageWithName("b0").ImageId(), 4);
+  BOOST_CHECK_EQUAL(merged_database.ReadImageWithName("b0").CameraId(), 2);
+  BOOST_CHECK_EQUAL(merged_database.ReadKeypoints(5).size(), 11);
+  BOOST_CHECK_EQUAL(merged_database.ReadVisualWordIds(5, 1).rows(), 11);
+  BOOST_CHECK(merged_database.ExistsMatches(1, 2));
+  BOOST_CHECK(merged_database.ExistsMatches(4, 5));
+  BOOST_CHECK(!merged_database.ExistsMatches(2, 4));
+  BOOST_CHECK_EQUAL(merged_database.ReadMatches(4, 5).size(), 10);
+  BOOST_CHECK(merged_database.ExistsInlierMatches(5, 6));
+  BOOST_CHECK_EQUAL(merged_database.ReadTwoViewGeometry(5, 6)
+                        .inlier_matches.size(),
+                    5);
+
+  boost::filesystem::remove_all(test_dir);
+}
+
+BOOST_AUTO_TEST_CASE(TestOpenShards) {
+  const auto test_dir = boost::filesystem::temp_directory_path() /
+                        boost::filesystem::unique_path();
+  CreateDirIfNotExists(test_dir.string());
+  const std::vector<std::string> paths = {(test_dir / "shard1.db").string(),
+                                          (test_dir / "shard2.db").string()};
+  WriteDatabaseShard(paths[0], "a");
+  WriteDatabaseShard(paths[1], "b");
+
+  Database database;
+  database.OpenShardedPath(paths[0] + "," + paths[1]);
+  BOOST_CHECK(database.IsReadOnly());
+  BOOST_CHECK_EQUAL(database.NumCameras(), 2);
+  BOOST_CHECK_EQUAL(database.NumImages(), 6);
+  BOOST_CHECK_EQUAL(database.ReadAllImages().size(), 6);
+  BOOST_CHECK_EQUAL(database.ReadImageWithName("b2").ImageId(), 6);
+  BOOST_CHECK_EQUAL(database.ReadKeypoints(6).size(), 12);
+  BOOST_CHECK_EQUAL(database.ReadDescriptors(6).rows(), 12);
+  BOOST_CHECK_EQUAL(database.ReadVisualWordIds(6, 1).rows(), 12);
+  BOOST_CHECK_EQUAL(database.ReadAllMatches().size(), 2);
+  BOOST_CHECK_EQUAL(database.ReadMatches(4, 5).size(), 10);
+  BOOST_CHECK_EQUAL(database.ReadTwoViewGeometry(5, 6).inlier_matches.size(),
+                    5);
+  database.Close();
+
+  database.OpenShardedPath(paths[1]);
+  BOOST_CHECK(!database.IsReadOnly());
+  BOOST_CHECK_EQUAL(database.NumImages(), 3);
+  database.Close();
+
+  boost::filesystem::remove_all(test_dir);
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+
+#include "base/feature_store.h"
+
+#include <fstream>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "util/logging.h"
+#include "util/misc.h"
+
+namespace colmap {
+
+const size_t FeatureStore::kAlignment = 64;
+
+FeatureStore::FeatureStore(const std::string& path,
+                           const size_t num_images_per_file)
+    : path_(path), num_images_per_file_(num_images_per_file) {
+  CHECK(ExistsDir(path_)) << path_;
+  CHECK_GT(num_images_per_file_, 0);
+}
+
+const std::string& FeatureStore::Path() const { return path_; }
+
+void FeatureStore::WriteDescriptors(const image_t image_id,
+                                    const FeatureDescriptors& descriptors,
+                                    size_t* file_index, size_t* offset) {
+  CHECK_NE(image_id, kInvalidImageId);
+  CHECK_NOTNULL(file_index);
+  CHECK_NOTNULL(offset);
+
+  *file_index = (image_id - 1) / num_images_per_file_;
+
+  const std::string file_path = FilePath(*file_index);
+  const size_t file_size =
+      ExistsFile(file_path) ? boost::filesystem::file_size(file_path) : 0;
+
+  std::ofstream file(file_path, std::ios::binary | std::ios::app);
+  CHECK(file.is_open()) << file_path;
+
+  // Pad the file, such that the descriptors start at an aligned offset.
+  const size_t num_padding_bytes =
+      (kAlignment - file_size % kAlignment) % kAlignment;
+  const std::vector<char> padding(num_padding_bytes, 0);
+  file.write(padding.data(), num_padding_bytes);
+
+  *offset = file_size + num_padding_bytes;
+
+  file.write(reinterpret_cast<const char*>(descriptors.data()),
+             descriptors.size() * sizeof(FeatureDescriptors::Scalar));
+  CHECK(file.good()) << file_path;
+}
+
+std::shared_ptr<const FeatureStore::FeatureDescriptorsMap>
+FeatureStore::ReadDescriptors(const size_t file_index, const size_t offset,
+                              const size_t rows, const size_t cols) const {
+  const size_t num_bytes = rows * cols * sizeof(FeatureDescriptors::Scalar);
+  if (num_bytes == 0) {
+    return std::make_shared<const FeatureDescriptorsMap>(nullptr, rows, cols);
+  }
+
+  auto& mapped_region = mapped_regions_[file_index];
+  if (!mapped_region || mapped_region->get_size() < offset + num_bytes) {
+    const boost::interprocess::file_mapping file_mapping(
+        FilePath(file_index).c_str(), boost::interprocess::read_only);
+    mapped_region = std::make_shared<const boost::interprocess::mapped_region>(
+        file_mapping, boost::interprocess::read_only);
+    CHECK_GE(mapped_region->get_size(), offset + num_bytes)
+        << FilePath(file_index);
+  }
+
+  const auto data = static_cast<const FeatureDescriptors::Scalar*>(
+                        mapped_region->get_address()) +
+                    offset;
+
+  // The map holds a reference to the mapped region to keep it alive.
+  const auto region = mapped_region;
+  return std::shared_ptr<const FeatureDescriptorsMap>(
+      new FeatureDescriptorsMap(data, rows, cols),
+      [region](const FeatureDescriptorsMap* map) { delete map; });
+}
+
+std::string FeatureStore::FilePath(const size_t file_index) const {
+  return JoinPaths(path_, "descriptors" + std::to_string(file_index) + ".bin");
+}
+
+}  // namespace colmap
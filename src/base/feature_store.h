@@ -0,0 +1,102 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+
+#ifndef COLMAP_SRC_BASE_FEATURE_STORE_H_
+#define COLMAP_SRC_BASE_FEATURE_STORE_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <Eigen/Core>
+
+#include "feature/types.h"
+#include "util/types.h"
+
+namespace boost {
+namespace interprocess {
+class mapped_region;
+}  // namespace interprocess
+}  // namespace boost
+
+namespace colmap {
+
+// Memory-mapped store of feature descriptors as an alternative to the SQLite
+// blobs in the database. The descriptors of `num_images_per_file` images with
+// consecutive identifiers are appended to the same file, where the rows of
+// each image start at a 64-byte aligned offset. The descriptors can thus be
+// accessed through the memory mapping of the file without copying them. The
+// location of the descriptors in the store is not managed by this class but
+// must be recorded by the caller, e.g., in the database. The class is not
+// thread-safe, similar to the database.
+class FeatureStore {
+ public:
+  typedef Eigen::Map<const FeatureDescriptors> FeatureDescriptorsMap;
+
+  // The alignment of the offsets of the descriptors in the files in bytes.
+  const static size_t kAlignment;
+
+  explicit FeatureStore(const std::string& path,
+                        const size_t num_images_per_file = 1000);
+
+  // Path of the directory containing the files of the store.
+  const std::string& Path() const;
+
+  // Append the descriptors of the given image to its file and return the
+  // index of the file and the byte offset of the descriptors in the file.
+  void WriteDescriptors(const image_t image_id,
+                        const FeatureDescriptors& descriptors,
+                        size_t* file_index, size_t* offset);
+
+  // Map the descriptors at the given location without copying them. The
+  // returned object keeps the memory mapping of the file alive, such that it
+  // remains valid even if the store is appended or destructed.
+  std::shared_ptr<const FeatureDescriptorsMap> ReadDescriptors(
+      const size_t file_index, const size_t offset, const size_t rows,
+      const size_t cols) const;
+
+ private:
+  std::string FilePath(const size_t file_index) const;
+
+  const std::string path_;
+  const size_t num_images_per_file_;
+
+  // The current memory mapping of each file, which is replaced by a new
+  // mapping once the file was appended beyond the mapped region.
+  mutable std::unordered_map<
+      size_t, std::shared_ptr<const boost::interprocess::mapped_region>>
+      mapped_regions_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_BASE_FEATURE_STORE_H_
@@ -0,0 +1,166 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+
+#define TEST_NAME "base/feature_store"
+#include "util/testing.h"
+
+#include "base/database.h"
+#include "base/feature_store.h"
+#include "util/misc.h"
+
+using namespace colmap;
+
+namespace {
+
+std::string CreateTestDir() {
+  const auto path = boost::filesystem::temp_directory_path() /
+                    boost::filesystem::unique_path();
+  CreateDirIfNotExists(path.string());
+  return path.string();
+}
+
+void CheckEqualDescriptors(const FeatureDescriptors& descriptors1,
+                           const FeatureDescriptors& descriptors2) {
+  BOOST_CHECK_EQUAL(descriptors1.rows(), descriptors2.rows());
+  BOOST_CHECK_EQUAL(descriptors1.cols(), descriptors2.cols());
+  BOOST_CHECK(descriptors1 == descriptors2);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(TestWriteRead) {
+  const std::string path = CreateTestDir();
+  FeatureStore feature_store(path, 2);
+  BOOST_CHECK_EQUAL(feature_store.Path(), path);
+
+  const FeatureDescriptors descriptors1 = FeatureDescriptors::Random(10, 128);
+  const FeatureDescriptors descriptors2 = FeatureDescriptors::Random(3, 7);
+  const FeatureDescriptors descriptors3 = FeatureDescriptors::Random(20, 128);
+  const FeatureDescriptors descriptors4 = FeatureDescriptors(0, 128);
+
+  size_t file_index1, offset1;
+  feature_store.WriteDescriptors(1, descriptors1, &file_index1, &offset1);
+  BOOST_CHECK_EQUAL(file_index1, 0);
+  BOOST_CHECK_EQUAL(offset1, 0);
+
+  size_t file_index2, offset2;
+  feature_store.WriteDescriptors(2, descriptors2, &file_index2, &offset2);
+  BOOST_CHECK_EQUAL(file_index2, 0);
+  BOOST_CHECK_EQUAL(offset2, 10 * 128);
+
+  // Map the file before it is appended, which must be remapped afterwards.
+  CheckEqualDescriptors(
+      *feature_store.ReadDescriptors(file_index2, offset2, 3, 7),
+      descriptors2);
+
+  size_t file_index3, offset3;
+  feature_store.WriteDescriptors(4, descriptors3, &file_index3, &offset3);
+  BOOST_CHECK_EQUAL(file_index3, 1);
+  BOOST_CHECK_EQUAL(offset3, 0);
+
+  size_t file_index4, offset4;
+  feature_store.WriteDescriptors(3, descriptors4, &file_index4, &offset4);
+  BOOST_CHECK_EQUAL(file_index4, 1);
+  BOOST_CHECK_EQUAL(offset4, 20 * 128);
+
+  for (const size_t offset : {offset1, offset2, offset3, offset4}) {
+    BOOST_CHECK_EQUAL(offset % FeatureStore::kAlignment, 0);
+  }
+
+  const auto descriptors_map1 =
+      feature_store.ReadDescriptors(file_index1, offset1, 10, 128);
+  CheckEqualDescriptors(*descriptors_map1, descriptors1);
+  CheckEqualDescriptors(
+      *feature_store.ReadDescriptors(file_index3, offset3, 20, 128),
+      descriptors3);
+  CheckEqualDescriptors(
+      *feature_store.ReadDescriptors(file_index4, offset4, 0, 128),
+      descriptors4);
+
+  // The mapping remains valid after appending to the file.
+  feature_store.WriteDescriptors(2, descriptors1, &file_index2, &offset2);
+  CheckEqualDescriptors(*descriptors_map1, descriptors1);
+  CheckEqualDescriptors(
+      *feature_store.ReadDescriptors(file_index2, offset2, 10, 128),
+      descriptors1);
+
+  boost::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_CASE(TestDatabase) {
+  const std::string path = CreateTestDir();
+  const std::string database_path = JoinPaths(path, "database.db");
+
+  Camera camera;
+  Image image1;
+  image1.SetName("image1");
+  Image image2;
+  image2.SetName("image2");
+
+  const FeatureDescriptors descriptors1 = FeatureDescriptors::Random(10, 128);
+  const FeatureDescriptors descriptors2 = FeatureDescriptors::Random(20, 128);
+
+  {
+    // Descriptors written before the creation of the store.
+    Database database(database_path);
+    camera.SetCameraId(database.WriteCamera(camera));
+    image1.SetCameraId(camera.CameraId());
+    image1.SetImageId(database.WriteImage(image1));
+    database.WriteDescriptors(image1.ImageId(), descriptors1);
+  }
+
+  CreateDirIfNotExists(Database::FeatureStorePath(database_path));
+
+  {
+    Database database(database_path);
+    image2.SetCameraId(camera.CameraId());
+    image2.SetImageId(database.WriteImage(image2));
+    database.WriteDescriptors(image2.ImageId(), descriptors2);
+    BOOST_CHECK_EQUAL(database.NumDescriptors(), 30);
+    BOOST_CHECK_EQUAL(database.MaxNumDescriptors(), 20);
+    BOOST_CHECK_EQUAL(database.NumDescriptorsForImage(image2.ImageId()), 20);
+    CheckEqualDescriptors(database.ReadDescriptors(image1.ImageId()),
+                          descriptors1);
+    CheckEqualDescriptors(database.ReadDescriptors(image2.ImageId()),
+                          descriptors2);
+  }
+
+  {
+    Database database(database_path);
+    CheckEqualDescriptors(database.ReadDescriptors(image1.ImageId()),
+                          descriptors1);
+    CheckEqualDescriptors(database.ReadDescriptors(image2.ImageId()),
+                          descriptors2);
+  }
+
+  boost::filesystem::remove_all(path);
+}
@@ -31,6 +31,7 @@
 
 #include "base/graph_cut.h"
 
+#include <mutex>
 #include <unordered_map>
 
 #include <boost/graph/stoer_wagner_min_cut.hpp>
@@ -53,36 +54,46 @@ class GraclusGraph {
                const std::vector<int>& weights) {
     CHECK_EQ(edges.size(), weights.size());
 
-    std::unordered_map<int, std::vector<std::pair<int, int>>> adjacency_list;
-    for (size_t i = 0; i < edges.size(); ++i) {
-      const auto& edge = edges[i];
-      const auto weight = weights[i];
+    // Map the vertex identifiers to consecutive indices in the order of their
+    // first occurrence and count the degree of every vertex.
+    std::vector<std::pair<int, int>> edge_idxs;
+    edge_idxs.reserve(edges.size());
+    for (const auto& edge : edges) {
       const int vertex_idx1 = GetVertexIdx(edge.first);
       const int vertex_idx2 = GetVertexIdx(edge.second);
-      adjacency_list[vertex_idx1].emplace_back(vertex_idx2, weight);
-      adjacency_list[vertex_idx2].emplace_back(vertex_idx1, weight);
+      edge_idxs.emplace_back(vertex_idx1, vertex_idx2);
     }
 
-    xadj_.reserve(vertex_id_to_idx_.size() + 1);
-    adjncy_.reserve(2 * edges.size());
-    adjwgt_.reserve(2 * edges.size());
-
-    idxtype edge_idx = 0;
-    for (size_t i = 0; i < vertex_id_to_idx_.size(); ++i) {
-      xadj_.push_back(edge_idx);
+    std::vector<idxtype> degrees(vertex_idx_to_id_.size(), 0);
+    for (const auto& edge_idx : edge_idxs) {
+      degrees[edge_idx.first] += 1;
+      degrees[edge_idx.second] += 1;
+    }
 
-      if (adjacency_list.count(i) == 0) {
-        continue;
-      }
+    // Directly fill the compressed adjacency structure, where the neighbors
+    // of every vertex are stored in the order of the input edges.
+    xadj_.resize(vertex_idx_to_id_.size() + 1);
+    xadj_[0] = 0;
+    for (size_t i = 0; i < degrees.size(); ++i) {
+      xadj_[i + 1] = xadj_[i] + degrees[i];
+    }
 
-      for (const auto& edge : adjacency_list[i]) {
-        edge_idx += 1;
-        adjncy_.push_back(edge.first);
-        adjwgt_.push_back(edge.second);
-      }
+    adjncy_.resize(2 * edges.size());
+    adjwgt_.resize(2 * edges.size());
+
+    std::vector<idxtype> next_edge_idxs(xadj_.begin(), xadj_.end() - 1);
+    for (size_t i = 0; i < edge_idxs.size(); ++i) {
+      const int vertex_idx1 = edge_idxs[i].first;
+      const int vertex_idx2 = edge_idxs[i].second;
+      const idxtype edge_idx1 = next_edge_idxs[vertex_idx1]++;
+      adjncy_[edge_idx1] = vertex_idx2;
+      adjwgt_[edge_idx1] = weights[i];
+      const idxtype edge_idx2 = next_edge_idxs[vertex_idx2]++;
+      adjncy_[edge_idx2] = vertex_idx1;
+      adjwgt_[edge_idx2] = weights[i];
     }
 
-    xadj_.push_back(edge_idx);
+    const idxtype edge_idx = xadj_.back();
 
     CHECK_EQ(edge_idx, 2 * edges.size());
     CHECK_EQ(xadj_.size(), vertex_id_to_idx_.size() + 1);
@@ -124,22 +135,22 @@ class GraclusGraph {
   int GetVertexIdx(const int id) {
     const auto it = vertex_id_to_idx_.find(id);
     if (it == vertex_id_to_idx_.end()) {
-      const int idx = vertex_id_to_idx_.size();
+      const int idx = vertex_idx_to_id_.size();
       vertex_id_to_idx_.emplace(id, idx);
-      vertex_idx_to_id_.emplace(idx, id);
+      vertex_idx_to_id_.push_back(id);
       return idx;
     } else {
       return it->second;
     }
   }
 
-  int GetVertexId(const int idx) { return vertex_idx_to_id_.at(idx); }
+  int GetVertexId(const int idx) const { return vertex_idx_to_id_.at(idx); }
 
   GraphType data;
 
  private:
   std::unordered_map<int, int> vertex_id_to_idx_;
-  std::unordered_map<int, int> vertex_idx_to_id_;
+  std::vector<int> vertex_idx_to_id_;
   std::vector<idxtype> xadj_;
   std::vector<idxtype> adjncy_;
   std::vector<idxtype> adjwgt_;
@@ -193,6 +204,12 @@ std::unordered_map<int, int> ComputeNormalizedMinGraphCut(
 
   std::vector<idxtype> cut_labels(graph.data.nvtxs);
 
+  // Graclus draws from the global random number generator, which it reseeds on
+  // every invocation. Concurrent partitions are serialized to keep the cuts
+  // deterministic.
+  static std::mutex graclus_mutex;
+  std::unique_lock<std::mutex> graclus_lock(graclus_mutex);
+
   int options[11];
   options[0] = 0;
   int wgtflag = 1;
@@ -211,6 +228,8 @@ std::unordered_map<int, int> ComputeNormalizedMinGraphCut(
 
   ComputeNCut(&graph.data, &cut_labels[0], num_parts);
 
+  graclus_lock.unlock();
+
   std::unordered_map<int, int> labels;
   for (size_t idx = 0; idx < cut_labels.size(); ++idx) {
     labels.emplace(graph.GetVertexId(idx), cut_labels[idx]);
@@ -33,6 +33,7 @@
 #include "util/testing.h"
 
 #include "base/graph_cut.h"
+#include "util/random.h"
 
 using namespace colmap;
 
@@ -188,3 +189,63 @@ BOOST_AUTO_TEST_CASE(TestMinSTGraphCut3) {
   BOOST_CHECK(graph.IsConnectedToSink(1));
   BOOST_CHECK(graph.IsConnectedToSink(2));
 }
+
+BOOST_AUTO_TEST_CASE(TestMinSTGraphCutParallel) {
+  SetPRNGSeed(0);
+
+  const int kGridSize = 20;
+  const int kNumNodes = kGridSize * kGridSize;
+
+  MinSTGraphCut<int, int> graph(kNumNodes);
+  MinSTGraphCut<int, int> parallel_graph(kNumNodes);
+  std::vector<std::pair<int, int>> node_capacities;
+  std::vector<std::tuple<int, int, int, int>> edges;
+
+  for (int node_idx = 0; node_idx < kNumNodes; ++node_idx) {
+    node_capacities.emplace_back(RandomInteger(0, 10), RandomInteger(0, 10));
+    graph.AddNode(node_idx, node_capacities.back().first,
+                  node_capacities.back().second);
+    parallel_graph.AddNode(node_idx, node_capacities.back().first,
+                           node_capacities.back().second);
+    const int x = node_idx % kGridSize;
+    const int y = node_idx / kGridSize;
+    if (x + 1 < kGridSize) {
+      edges.emplace_back(node_idx, node_idx + 1, RandomInteger(0, 10),
+                         RandomInteger(0, 10));
+    }
+    if (y + 1 < kGridSize) {
+      edges.emplace_back(node_idx, node_idx + kGridSize, RandomInteger(0, 10),
+                         RandomInteger(0, 10));
+    }
+  }
+
+  for (const auto& edge : edges) {
+    graph.AddEdge(std::get<0>(edge), std::get<1>(edge), std::get<2>(edge),
+                  std::get<3>(edge));
+    parallel_graph.AddEdge(std::get<0>(edge), std::get<1>(edge),
+                           std::get<2>(edge), std::get<3>(edge));
+  }
+
+  const int flow = graph.Compute();
+  BOOST_CHECK_EQUAL(parallel_graph.ComputeParallel(4), flow);
+
+  // The capacity of the cut must equal the max-flow.
+  int cut_capacity = 0;
+  for (int node_idx = 0; node_idx < kNumNodes; ++node_idx) {
+    if (parallel_graph.IsConnectedToSource(node_idx)) {
+      cut_capacity += node_capacities[node_idx].second;
+    } else {
+      cut_capacity += node_capacities[node_idx].first;
+    }
+  }
+  for (const auto& edge : edges) {
+    const bool source1 = parallel_graph.IsConnectedToSource(std::get<0>(edge));
+    const bool source2 = parallel_graph.IsConnectedToSource(std::get<1>(edge));
+    if (source1 && !source2) {
+      cut_capacity += std::get<2>(edge);
+    } else if (!source1 && source2) {
+      cut_capacity += std::get<3>(edge);
+    }
+  }
+  BOOST_CHECK_EQUAL(cut_capacity, flow);
+}
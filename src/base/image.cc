@@ -67,68 +67,93 @@ void Image::TearDown() {
   point3D_visibility_pyramid_ = VisibilityPyramid(0, 0, 0);
 }
 
+size_t Image::NumBytes() const {
+  return sizeof(Image) + name_.capacity() +
+         points2D_xy_.capacity() * sizeof(point2D_coord_t) +
+         points2D_point3D_ids_.capacity() * sizeof(point3D_t) +
+         num_correspondences_have_point3D_.capacity() * sizeof(image_t);
+}
+
 void Image::SetPoints2D(const std::vector<Eigen::Vector2d>& points) {
-  CHECK(points2D_.empty());
-  points2D_.resize(points.size());
-  num_correspondences_have_point3D_.resize(points.size(), 0);
+  CHECK(points2D_xy_.empty());
+  points2D_xy_.resize(2 * points.size());
   for (point2D_t point2D_idx = 0; point2D_idx < points.size(); ++point2D_idx) {
-    points2D_[point2D_idx].SetXY(points[point2D_idx]);
+    SetPoint2DXY(point2D_idx, points[point2D_idx]);
   }
 }
 
 void Image::SetPoints2D(const std::vector<class Point2D>& points) {
-  CHECK(points2D_.empty());
-  points2D_ = points;
-  num_correspondences_have_point3D_.resize(points.size(), 0);
+  CHECK(points2D_xy_.empty());
+  points2D_xy_.resize(2 * points.size());
+  for (point2D_t point2D_idx = 0; point2D_idx < points.size(); ++point2D_idx) {
+    SetPoint2DXY(point2D_idx, points[point2D_idx].XY());
+    if (points[point2D_idx].HasPoint3D()) {
+      if (points2D_point3D_ids_.empty()) {
+        points2D_point3D_ids_.resize(points.size(), kInvalidPoint3DId);
+      }
+      points2D_point3D_ids_[point2D_idx] = points[point2D_idx].Point3DId();
+    }
+  }
 }
 
 void Image::SetPoint3DForPoint2D(const point2D_t point2D_idx,
                                  const point3D_t point3D_id) {
   CHECK_NE(point3D_id, kInvalidPoint3DId);
-  class Point2D& point2D = points2D_.at(point2D_idx);
-  if (!point2D.HasPoint3D()) {
+  CHECK_LT(point2D_idx, NumPoints2D());
+  if (points2D_point3D_ids_.empty()) {
+    points2D_point3D_ids_.resize(NumPoints2D(), kInvalidPoint3DId);
+  }
+  point3D_t& point2D_point3D_id = points2D_point3D_ids_[point2D_idx];
+  if (point2D_point3D_id == kInvalidPoint3DId) {
     num_points3D_ += 1;
   }
-  point2D.SetPoint3DId(point3D_id);
+  point2D_point3D_id = point3D_id;
 }
 
 void Image::ResetPoint3DForPoint2D(const point2D_t point2D_idx) {
-  class Point2D& point2D = points2D_.at(point2D_idx);
-  if (point2D.HasPoint3D()) {
-    point2D.SetPoint3DId(kInvalidPoint3DId);
+  CHECK_LT(point2D_idx, NumPoints2D());
+  if (points2D_point3D_ids_.empty()) {
+    return;
+  }
+  point3D_t& point2D_point3D_id = points2D_point3D_ids_[point2D_idx];
+  if (point2D_point3D_id != kInvalidPoint3DId) {
+    point2D_point3D_id = kInvalidPoint3DId;
     num_points3D_ -= 1;
   }
 }
 
 bool Image::HasPoint3D(const point3D_t point3D_id) const {
-  return std::find_if(points2D_.begin(), points2D_.end(),
-                      [point3D_id](const class Point2D& point2D) {
-                        return point2D.Point3DId() == point3D_id;
-                      }) != points2D_.end();
+  return std::find(points2D_point3D_ids_.begin(), points2D_point3D_ids_.end(),
+                   point3D_id) != points2D_point3D_ids_.end();
 }
 
 void Image::IncrementCorrespondenceHasPoint3D(const point2D_t point2D_idx) {
-  const class Point2D& point2D = points2D_.at(point2D_idx);
+  const Eigen::Vector2d xy = Point2DXY(point2D_idx);
+
+  if (num_correspondences_have_point3D_.empty()) {
+    num_correspondences_have_point3D_.resize(NumPoints2D(), 0);
+  }
 
   num_correspondences_have_point3D_[point2D_idx] += 1;
   if (num_correspondences_have_point3D_[point2D_idx] == 1) {
     num_visible_points3D_ += 1;
   }
 
-  point3D_visibility_pyramid_.SetPoint(point2D.X(), point2D.Y());
+  point3D_visibility_pyramid_.SetPoint(xy.x(), xy.y());
 
   assert(num_visible_points3D_ <= num_observations_);
 }
 
 void Image::DecrementCorrespondenceHasPoint3D(const point2D_t point2D_idx) {
-  const class Point2D& point2D = points2D_.at(point2D_idx);
+  const Eigen::Vector2d xy = Point2DXY(point2D_idx);
 
+  CHECK_GT(num_correspondences_have_point3D_.at(point2D_idx), 0);
   num_correspondences_have_point3D_[point2D_idx] -= 1;
   if (num_correspondences_have_point3D_[point2D_idx] == 0) {
     num_visible_points3D_ -= 1;
   }
 
-  point3D_visibility_pyramid_.ResetPoint(point2D.X(), point2D.Y());
+  point3D_visibility_pyramid_.ResetPoint(xy.x(), xy.y());
 
   assert(num_visible_points3D_ <= num_observations_);
 }
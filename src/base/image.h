@@ -54,6 +54,48 @@ class Image {
  public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
+  // Read-only range over the image points, which are composed from their
+  // separately stored coordinates and 3D point identifiers when accessed.
+  class Points2DRange {
+   public:
+    class const_iterator {
+     public:
+      const_iterator(const Image* image, const point2D_t point2D_idx)
+          : image_(image), point2D_idx_(point2D_idx) {}
+      inline class Point2D operator*() const {
+        return image_->ComposePoint2D(point2D_idx_);
+      }
+      inline const_iterator& operator++() {
+        ++point2D_idx_;
+        return *this;
+      }
+      inline bool operator==(const const_iterator& other) const {
+        return point2D_idx_ == other.point2D_idx_;
+      }
+      inline bool operator!=(const const_iterator& other) const {
+        return point2D_idx_ != other.point2D_idx_;
+      }
+
+     private:
+      const Image* image_;
+      point2D_t point2D_idx_;
+    };
+
+    explicit Points2DRange(const Image* image) : image_(image) {}
+    inline const_iterator begin() const { return const_iterator(image_, 0); }
+    inline const_iterator end() const {
+      return const_iterator(image_, image_->NumPoints2D());
+    }
+    inline size_t size() const { return image_->NumPoints2D(); }
+    inline bool empty() const { return size() == 0; }
+    inline class Point2D operator[](const point2D_t point2D_idx) const {
+      return image_->Point2D(point2D_idx);
+    }
+
+   private:
+    const Image* image_;
+  };
+
   Image();
 
   // Setup / tear down the image and necessary internal data structures before
@@ -84,6 +126,9 @@ class Image {
   // Get the number of image points.
   inline point2D_t NumPoints2D() const;
 
+  // Get the approximate memory usage of the image and its points in bytes.
+  size_t NumBytes() const;
+
   // Get the number of triangulations, i.e. the number of points that
   // are part of a 3D point track.
   inline point2D_t NumPoints3D() const;
@@ -141,13 +186,26 @@ class Image {
   inline bool HasTvecPrior() const;
   inline void SetTvecPrior(const Eigen::Vector3d& tvec);
 
-  // Access the coordinates of image points.
-  inline const class Point2D& Point2D(const point2D_t point2D_idx) const;
-  inline class Point2D& Point2D(const point2D_t point2D_idx);
-  inline const std::vector<class Point2D>& Points2D() const;
+  // Access the image points. The coordinates and the 3D point identifiers of
+  // the points are stored in separate arrays, so the points are returned by
+  // value. Loops that only need one of the fields should use the accessors of
+  // the individual fields below.
+  inline class Point2D Point2D(const point2D_t point2D_idx) const;
+  inline Points2DRange Points2D() const;
   void SetPoints2D(const std::vector<Eigen::Vector2d>& points);
   void SetPoints2D(const std::vector<class Point2D>& points);
 
+  // Access the coordinates of an image point.
+  inline Eigen::Vector2d Point2DXY(const point2D_t point2D_idx) const;
+  inline void SetPoint2DXY(const point2D_t point2D_idx,
+                           const Eigen::Vector2d& xy);
+
+  // Access the identifier of the 3D point observed by an image point. If the
+  // image point does not observe a 3D point, the identifier is
+  // `kInvalidPoint3DId`.
+  inline point3D_t Point2DPoint3DId(const point2D_t point2D_idx) const;
+  inline bool Point2DHasPoint3D(const point2D_t point2D_idx) const;
+
   // Set the point as triangulated, i.e. it is part of a 3D point track.
   void SetPoint3DForPoint2D(const point2D_t point2D_idx,
                             const point3D_t point3D_id);
@@ -233,14 +291,27 @@ class Image {
   Eigen::Vector4d qvec_prior_;
   Eigen::Vector3d tvec_prior_;
 
-  // All image points, including points that are not part of a 3D point track.
-  std::vector<class Point2D> points2D_;
-
-  // Per image point, the number of correspondences that have a 3D point.
+  // Compose an image point from its fields without bounds checking.
+  inline class Point2D ComposePoint2D(const point2D_t point2D_idx) const;
+
+  // All image points, including points that are not part of a 3D point track,
+  // stored as separate arrays of their interleaved (x, y) coordinates and
+  // their 3D point identifiers. Most loops over the points only access one of
+  // the fields, and the separate arrays avoid the padding of `Point2D`.
+  // The 3D point identifiers are only allocated once the first point is
+  // triangulated and are all `kInvalidPoint3DId` while empty, since many
+  // images, e.g., in the database cache, never observe a 3D point.
+  std::vector<point2D_coord_t> points2D_xy_;
+  std::vector<point3D_t> points2D_point3D_ids_;
+
+  // Per image point, the number of correspondences that have a 3D point. Only
+  // allocated on the first call to `IncrementCorrespondenceHasPoint3D` and
+  // all zero while empty.
   std::vector<image_t> num_correspondences_have_point3D_;
 
   // Data structure to compute the distribution of triangulated correspondences
-  // in the image. Note that this structure is only usable after `SetUp`.
+  // in the image. Note that this structure is only usable after `SetUp` and
+  // that its cells are only allocated once the first point is set.
   VisibilityPyramid point3D_visibility_pyramid_;
 };
 
@@ -272,7 +343,7 @@ bool Image::IsRegistered() const { return registered_; }
 void Image::SetRegistered(const bool registered) { registered_ = registered; }
 
 point2D_t Image::NumPoints2D() const {
-  return static_cast<point2D_t>(points2D_.size());
+  return static_cast<point2D_t>(points2D_xy_.size() / 2);
 }
 
 point2D_t Image::NumPoints3D() const { return num_points3D_; }
@@ -343,18 +414,50 @@ inline bool Image::HasTvecPrior() const { return !IsNaN(tvec_prior_.sum()); }
 
 void Image::SetTvecPrior(const Eigen::Vector3d& tvec) { tvec_prior_ = tvec; }
 
-const class Point2D& Image::Point2D(const point2D_t point2D_idx) const {
-  return points2D_.at(point2D_idx);
+class Point2D Image::Point2D(const point2D_t point2D_idx) const {
+  CHECK_LT(point2D_idx, NumPoints2D());
+  return ComposePoint2D(point2D_idx);
 }
 
-class Point2D& Image::Point2D(const point2D_t point2D_idx) {
-  return points2D_.at(point2D_idx);
+Image::Points2DRange Image::Points2D() const { return Points2DRange(this); }
+
+Eigen::Vector2d Image::Point2DXY(const point2D_t point2D_idx) const {
+  CHECK_LT(point2D_idx, NumPoints2D());
+  return Eigen::Vector2d(points2D_xy_[2 * point2D_idx],
+                         points2D_xy_[2 * point2D_idx + 1]);
 }
 
-const std::vector<class Point2D>& Image::Points2D() const { return points2D_; }
+void Image::SetPoint2DXY(const point2D_t point2D_idx,
+                         const Eigen::Vector2d& xy) {
+  CHECK_LT(point2D_idx, NumPoints2D());
+  points2D_xy_[2 * point2D_idx] = static_cast<point2D_coord_t>(xy.x());
+  points2D_xy_[2 * point2D_idx + 1] = static_cast<point2D_coord_t>(xy.y());
+}
+
+point3D_t Image::Point2DPoint3DId(const point2D_t point2D_idx) const {
+  CHECK_LT(point2D_idx, NumPoints2D());
+  if (points2D_point3D_ids_.empty()) {
+    return kInvalidPoint3DId;
+  }
+  return points2D_point3D_ids_[point2D_idx];
+}
+
+bool Image::Point2DHasPoint3D(const point2D_t point2D_idx) const {
+  return Point2DPoint3DId(point2D_idx) != kInvalidPoint3DId;
+}
+
+class Point2D Image::ComposePoint2D(const point2D_t point2D_idx) const {
+  return colmap::Point2D(Eigen::Vector2d(points2D_xy_[2 * point2D_idx],
+                                         points2D_xy_[2 * point2D_idx + 1]),
+                         points2D_point3D_ids_.empty()
+                             ? kInvalidPoint3DId
+                             : points2D_point3D_ids_[point2D_idx]);
+}
 
 bool Image::IsPoint3DVisible(const point2D_t point2D_idx) const {
-  return num_correspondences_have_point3D_.at(point2D_idx) > 0;
+  CHECK_LT(point2D_idx, NumPoints2D());
+  return !num_correspondences_have_point3D_.empty() &&
+         num_correspondences_have_point3D_[point2D_idx] > 0;
 }
 
 }  // namespace colmap
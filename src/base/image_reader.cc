@@ -84,6 +84,86 @@ ImageReader::ImageReader(const ImageReaderOptions& options, Database* database)
 
 ImageReader::Status ImageReader::Next(Camera* camera, Image* image,
                                       Bitmap* bitmap, Bitmap* mask) {
+  const size_t index = image_index_;
+  return Next(camera, image, bitmap, mask,
+              [&]() { return Decode(index, bitmap, mask); });
+}
+
+ImageReader::Status ImageReader::NextDecoded(Camera* camera, Image* image,
+                                             Bitmap* bitmap, Bitmap* mask,
+                                             const Status decode_status) {
+  return Next(camera, image, bitmap, mask,
+              [decode_status]() { return decode_status; });
+}
+
+std::string ImageReader::ImagePath(const size_t index) const {
+  return options_.image_list.at(index);
+}
+
+std::string ImageReader::MaskPath(const size_t index) const {
+  if (options_.mask_path.empty()) {
+    return "";
+  }
+  return JoinPaths(
+      options_.mask_path,
+      GetRelativePath(options_.image_path, options_.image_list.at(index)) +
+          ".png");
+}
+
+ImageReader::Status ImageReader::Decode(const size_t index, Bitmap* bitmap,
+                                        Bitmap* mask,
+                                        const bool header_only) const {
+  CHECK_NOTNULL(bitmap);
+
+  const std::string& image_path = options_.image_list.at(index);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Read image.
+  //////////////////////////////////////////////////////////////////////////////
+
+  if (header_only) {
+    if (!bitmap->ReadHeader(image_path)) {
+      return Status::BITMAP_ERROR;
+    }
+  } else if (!bitmap->Read(image_path, false)) {
+    return Status::BITMAP_ERROR;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Read mask.
+  //////////////////////////////////////////////////////////////////////////////
+
+  if (mask && !options_.mask_path.empty()) {
+    const std::string mask_path = MaskPath(index);
+    if (ExistsFile(mask_path) && !mask->Read(mask_path, false)) {
+      // NOTE: Maybe introduce a separate error type MASK_ERROR?
+      return Status::BITMAP_ERROR;
+    }
+  }
+
+  return Status::SUCCESS;
+}
+
+bool ImageReader::ExistsFeatures(const size_t index) const {
+  const std::string image_name = ImageName(index);
+  if (!database_->ExistsImageWithName(image_name)) {
+    return false;
+  }
+  const Image image = database_->ReadImageWithName(image_name);
+  return database_->ExistsKeypoints(image.ImageId()) &&
+         database_->ExistsDescriptors(image.ImageId());
+}
+
+std::string ImageReader::ImageName(const size_t index) const {
+  const std::string image_name =
+      StringReplace(options_.image_list.at(index), "\\", "/");
+  return image_name.substr(options_.image_path.size(),
+                           image_name.size() - options_.image_path.size());
+}
+
+ImageReader::Status ImageReader::Next(
+    Camera* camera, Image* image, Bitmap* bitmap, Bitmap* mask,
+    const std::function<Status()>& decode_func) {
   CHECK_NOTNULL(camera);
   CHECK_NOTNULL(image);
   CHECK_NOTNULL(bitmap);
@@ -91,19 +171,13 @@ ImageReader::Status ImageReader::Next(Camera* camera, Image* image,
   image_index_ += 1;
   CHECK_LE(image_index_, options_.image_list.size());
 
-  const std::string image_path = options_.image_list.at(image_index_ - 1);
-
   DatabaseTransaction database_transaction(database_);
 
   //////////////////////////////////////////////////////////////////////////////
   // Set the image name.
   //////////////////////////////////////////////////////////////////////////////
 
-  image->SetName(image_path);
-  image->SetName(StringReplace(image->Name(), "\\", "/"));
-  image->SetName(
-      image->Name().substr(options_.image_path.size(),
-                           image->Name().size() - options_.image_path.size()));
+  image->SetName(ImageName(image_index_ - 1));
 
   const std::string image_folder = GetParentDir(image->Name());
 
@@ -125,25 +199,12 @@ ImageReader::Status ImageReader::Next(Camera* camera, Image* image,
   }
 
   //////////////////////////////////////////////////////////////////////////////
-  // Read image.
+  // Decode image and mask.
   //////////////////////////////////////////////////////////////////////////////
 
-  if (!bitmap->Read(image_path, false)) {
-    return Status::BITMAP_ERROR;
-  }
-
-  //////////////////////////////////////////////////////////////////////////////
-  // Read mask.
-  //////////////////////////////////////////////////////////////////////////////
-
-  if (mask && !options_.mask_path.empty()) {
-    const std::string mask_path =
-        JoinPaths(options_.mask_path,
-                  GetRelativePath(options_.image_path, image_path) + ".png");
-    if (ExistsFile(mask_path) && !mask->Read(mask_path, false)) {
-      // NOTE: Maybe introduce a separate error type MASK_ERROR?
-      return Status::BITMAP_ERROR;
-    }
+  const Status decode_status = decode_func();
+  if (decode_status != Status::SUCCESS) {
+    return decode_status;
   }
 
   //////////////////////////////////////////////////////////////////////////////
@@ -151,20 +212,105 @@ ImageReader::Status ImageReader::Next(Camera* camera, Image* image,
   //////////////////////////////////////////////////////////////////////////////
 
   if (exists_image) {
-    const Camera camera = database_->ReadCamera(image->CameraId());
+    const Camera existing_camera = database_->ReadCamera(image->CameraId());
 
     if (options_.single_camera && prev_camera_.CameraId() != kInvalidCameraId &&
-        (camera.Width() != prev_camera_.Width() ||
-         camera.Height() != prev_camera_.Height())) {
+        (existing_camera.Width() != prev_camera_.Width() ||
+         existing_camera.Height() != prev_camera_.Height())) {
       return Status::CAMERA_SINGLE_DIM_ERROR;
     }
 
-    if (static_cast<size_t>(bitmap->Width()) != camera.Width() ||
-        static_cast<size_t>(bitmap->Height()) != camera.Height()) {
+    if (static_cast<size_t>(bitmap->Width()) != existing_camera.Width() ||
+        static_cast<size_t>(bitmap->Height()) != existing_camera.Height()) {
       return Status::CAMERA_EXIST_DIM_ERROR;
     }
+
+    // Keep the camera of the existing image, e.g., as written by
+    // `ImportMetadata`, and share it with the following images.
+    if (static_cast<camera_t>(options_.existing_camera_id) ==
+        kInvalidCameraId) {
+      prev_camera_ = existing_camera;
+    }
+
+    *camera = existing_camera;
+
+    image_folders_.insert(image_folder);
+    prev_image_folder_ = image_folder;
+
+    return Status::SUCCESS;
+  }
+
+  return AssignCamera(image_folder, ExtractMetadata(*bitmap), camera, image);
+}
+
+size_t ImageReader::ImportMetadata(const int num_threads) {
+  const size_t num_images = options_.image_list.size();
+
+  // Query the names of the existing images at once instead of checking each
+  // image individually.
+  std::unordered_set<std::string> existing_image_names;
+  if (database_->NumImages() > 0) {
+    for (const auto& image : database_->ReadAllImages()) {
+      existing_image_names.insert(image.Name());
+    }
   }
 
+  std::vector<ImageMetadata> metadata(num_images);
+  ParallelFor(image_index_, num_images,
+              [&](const size_t index) {
+                if (existing_image_names.count(ImageName(index)) > 0) {
+                  metadata[index].status = Status::IMAGE_EXISTS;
+                  return;
+                }
+                Bitmap bitmap;
+                const Status status =
+                    Decode(index, &bitmap, nullptr, /*header_only*/ true);
+                if (status == Status::SUCCESS) {
+                  metadata[index] = ExtractMetadata(bitmap);
+                } else {
+                  metadata[index].status = status;
+                }
+              },
+              num_threads);
+
+  // The cameras must be assigned in the order of the images, since images can
+  // share the camera of the previous image.
+  DatabaseTransaction database_transaction(database_);
+
+  size_t num_imported_images = 0;
+  for (size_t index = image_index_; index < num_images; ++index) {
+    if (metadata[index].status != Status::SUCCESS) {
+      continue;
+    }
+
+    Camera camera;
+    Image image;
+    image.SetName(ImageName(index));
+    if (AssignCamera(GetParentDir(image.Name()), metadata[index], &camera,
+                     &image) == Status::SUCCESS) {
+      database_->WriteImage(image);
+      num_imported_images += 1;
+    }
+  }
+
+  return num_imported_images;
+}
+
+ImageReader::ImageMetadata ImageReader::ExtractMetadata(const Bitmap& bitmap) {
+  ImageMetadata metadata;
+  metadata.status = Status::SUCCESS;
+  metadata.width = static_cast<size_t>(bitmap.Width());
+  metadata.height = static_cast<size_t>(bitmap.Height());
+  metadata.has_focal_length = bitmap.ExifFocalLength(&metadata.focal_length);
+  metadata.has_gps = bitmap.ExifLatitude(&metadata.gps(0)) &&
+                     bitmap.ExifLongitude(&metadata.gps(1)) &&
+                     bitmap.ExifAltitude(&metadata.gps(2));
+  return metadata;
+}
+
+ImageReader::Status ImageReader::AssignCamera(const std::string& image_folder,
+                                              const ImageMetadata& metadata,
+                                              Camera* camera, Image* image) {
   //////////////////////////////////////////////////////////////////////////////
   // Check image dimensions.
   //////////////////////////////////////////////////////////////////////////////
@@ -173,8 +319,8 @@ ImageReader::Status ImageReader::Next(Camera* camera, Image* image,
       ((options_.single_camera && !options_.single_camera_per_folder) ||
        (options_.single_camera_per_folder &&
         image_folder == prev_image_folder_)) &&
-      (prev_camera_.Width() != static_cast<size_t>(bitmap->Width()) ||
-       prev_camera_.Height() != static_cast<size_t>(bitmap->Height()))) {
+      (prev_camera_.Width() != metadata.width ||
+       prev_camera_.Height() != metadata.height)) {
     return Status::CAMERA_SINGLE_DIM_ERROR;
   }
 
@@ -191,20 +337,21 @@ ImageReader::Status ImageReader::Next(Camera* camera, Image* image,
     if (options_.camera_params.empty()) {
       // Extract focal length.
       double focal_length = 0.0;
-      if (bitmap->ExifFocalLength(&focal_length)) {
+      if (metadata.has_focal_length) {
+        focal_length = metadata.focal_length;
         prev_camera_.SetPriorFocalLength(true);
       } else {
         focal_length = options_.default_focal_length_factor *
-                       std::max(bitmap->Width(), bitmap->Height());
+                       std::max(metadata.width, metadata.height);
         prev_camera_.SetPriorFocalLength(false);
       }
 
       prev_camera_.InitializeWithId(prev_camera_.ModelId(), focal_length,
-                                    bitmap->Width(), bitmap->Height());
+                                    metadata.width, metadata.height);
     }
 
-    prev_camera_.SetWidth(static_cast<size_t>(bitmap->Width()));
-    prev_camera_.SetHeight(static_cast<size_t>(bitmap->Height()));
+    prev_camera_.SetWidth(metadata.width);
+    prev_camera_.SetHeight(metadata.height);
 
     if (!prev_camera_.VerifyParams()) {
       return Status::CAMERA_PARAM_ERROR;
@@ -219,9 +366,9 @@ ImageReader::Status ImageReader::Next(Camera* camera, Image* image,
   // Extract GPS data.
   //////////////////////////////////////////////////////////////////////////////
 
-  if (!bitmap->ExifLatitude(&image->TvecPrior(0)) ||
-      !bitmap->ExifLongitude(&image->TvecPrior(1)) ||
-      !bitmap->ExifAltitude(&image->TvecPrior(2))) {
+  if (metadata.has_gps) {
+    image->TvecPrior() = metadata.gps;
+  } else {
     image->TvecPrior().setConstant(std::numeric_limits<double>::quiet_NaN());
   }
 
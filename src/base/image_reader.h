@@ -32,6 +32,7 @@
 #ifndef COLMAP_SRC_BASE_IMAGE_READER_H_
 #define COLMAP_SRC_BASE_IMAGE_READER_H_
 
+#include <functional>
 #include <unordered_set>
 
 #include "base/database.h"
@@ -111,7 +112,64 @@ class ImageReader {
   size_t NextIndex() const;
   size_t NumImages() const;
 
+  // Path of the image file at the given index.
+  std::string ImagePath(const size_t index) const;
+
+  // Path of the mask file of the image at the given index, which is empty if
+  // no mask path is specified. The mask file does not have to exist.
+  std::string MaskPath(const size_t index) const;
+
+  // Decode the bitmap and the optional mask of the image at the given index.
+  // This does not access the database and the state of the reader, so it can
+  // be called concurrently to decode images ahead of `NextDecoded`. If
+  // `header_only`, only the dimensions and meta data of the bitmap are read,
+  // e.g., to decode its pixels later on the GPU.
+  Status Decode(const size_t index, Bitmap* bitmap, Bitmap* mask,
+                const bool header_only = false) const;
+
+  // Check whether the features of the image at the given index already exist
+  // in the database, in which case the image does not need to be decoded.
+  bool ExistsFeatures(const size_t index) const;
+
+  // Same as `Next`, but with the bitmap and mask of the next image already
+  // decoded by `Decode`, which returned the given status.
+  Status NextDecoded(Camera* camera, Image* image, Bitmap* bitmap,
+                     Bitmap* mask, const Status decode_status);
+
+  // Read the dimensions and EXIF meta data of all remaining images, which do
+  // not yet exist in the database, using up to `num_threads` threads without
+  // decoding their pixels. Then, assign the cameras of the images in order and
+  // write all new cameras and images to the database in a single transaction.
+  // Afterwards, `Next` reuses the written cameras and images. Returns the
+  // number of written images.
+  size_t ImportMetadata(const int num_threads = -1);
+
  private:
+  // Dimensions and EXIF meta data of an image required to assign its camera.
+  struct ImageMetadata {
+    Status status = Status::FAILURE;
+    size_t width = 0;
+    size_t height = 0;
+    bool has_focal_length = false;
+    double focal_length = 0.0;
+    bool has_gps = false;
+    Eigen::Vector3d gps = Eigen::Vector3d::Zero();
+  };
+
+  static ImageMetadata ExtractMetadata(const Bitmap& bitmap);
+
+  std::string ImageName(const size_t index) const;
+
+  // Assign the previous camera or a new camera to the given image, which does
+  // not yet exist in the database, depending on the camera options, and write
+  // a new camera to the database.
+  Status AssignCamera(const std::string& image_folder,
+                      const ImageMetadata& metadata, Camera* camera,
+                      Image* image);
+
+  Status Next(Camera* camera, Image* image, Bitmap* bitmap, Bitmap* mask,
+              const std::function<Status()>& decode_func);
+
   // Image reader options.
   ImageReaderOptions options_;
   Database* database_;
@@ -154,6 +154,28 @@ BOOST_AUTO_TEST_CASE(TestNumVisiblePoints3D) {
   BOOST_CHECK_EQUAL(image.NumVisiblePoints3D(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(TestLazyAllocation) {
+  Image image;
+  image.SetPoints2D(std::vector<Eigen::Vector2d>(10));
+  image.SetNumObservations(10);
+  Camera camera;
+  camera.SetWidth(10);
+  camera.SetHeight(10);
+  image.SetUp(camera);
+  const size_t num_bytes = image.NumBytes();
+  BOOST_CHECK(!image.Point2DHasPoint3D(0));
+  BOOST_CHECK(!image.IsPoint3DVisible(0));
+  BOOST_CHECK_EQUAL(image.Point3DVisibilityScore(), 0);
+  image.SetPoint3DForPoint2D(1, 1);
+  BOOST_CHECK_GT(image.NumBytes(), num_bytes);
+  BOOST_CHECK(!image.Point2DHasPoint3D(0));
+  BOOST_CHECK(image.Point2DHasPoint3D(1));
+  image.IncrementCorrespondenceHasPoint3D(2);
+  BOOST_CHECK(!image.IsPoint3DVisible(0));
+  BOOST_CHECK(image.IsPoint3DVisible(2));
+  BOOST_CHECK_GT(image.Point3DVisibilityScore(), 0);
+}
+
 BOOST_AUTO_TEST_CASE(TestPoint3DVisibilityScore) {
   Image image;
   std::vector<Eigen::Vector2d> points2D;
@@ -288,6 +310,33 @@ BOOST_AUTO_TEST_CASE(TestPoints2D) {
   BOOST_CHECK_EQUAL(image.Points2D().size(), 10);
   BOOST_CHECK_EQUAL(image.Point2D(0).X(), 1.0);
   BOOST_CHECK_EQUAL(image.Point2D(0).Y(), 2.0);
+  BOOST_CHECK_EQUAL(image.Point2DXY(0), Eigen::Vector2d(1.0, 2.0));
+  image.SetPoint2DXY(1, Eigen::Vector2d(3.0, 4.0));
+  BOOST_CHECK_EQUAL(image.Point2D(1).XY(), Eigen::Vector2d(3.0, 4.0));
+  BOOST_CHECK_EQUAL(image.Points2D()[1].XY(), Eigen::Vector2d(3.0, 4.0));
+  BOOST_CHECK_EQUAL(image.Point2DPoint3DId(1), kInvalidPoint3DId);
+  point2D_t num_points2D = 0;
+  for (const auto& point2D : image.Points2D()) {
+    BOOST_CHECK_EQUAL(point2D.XY(), image.Point2DXY(num_points2D));
+    BOOST_CHECK(!point2D.HasPoint3D());
+    num_points2D += 1;
+  }
+  BOOST_CHECK_EQUAL(num_points2D, 10);
+}
+
+BOOST_AUTO_TEST_CASE(TestSetPoints2D) {
+  std::vector<Point2D> points2D(2);
+  points2D[0].SetXY(Eigen::Vector2d(1.0, 2.0));
+  points2D[1].SetXY(Eigen::Vector2d(3.0, 4.0));
+  points2D[1].SetPoint3DId(1);
+  Image image;
+  image.SetPoints2D(points2D);
+  BOOST_CHECK_EQUAL(image.NumPoints2D(), 2);
+  BOOST_CHECK_EQUAL(image.Point2DXY(0), Eigen::Vector2d(1.0, 2.0));
+  BOOST_CHECK_EQUAL(image.Point2DXY(1), Eigen::Vector2d(3.0, 4.0));
+  BOOST_CHECK(!image.Point2DHasPoint3D(0));
+  BOOST_CHECK(image.Point2DHasPoint3D(1));
+  BOOST_CHECK_EQUAL(image.Point2DPoint3DId(1), 1);
 }
 
 BOOST_AUTO_TEST_CASE(TestPoint3D) {
@@ -0,0 +1,290 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "base/octree.h"
+
+#include "util/logging.h"
+
+namespace colmap {
+
+Octree::Octree(const size_t max_num_leaf_entries, const int max_depth)
+    : max_num_leaf_entries_(max_num_leaf_entries), max_depth_(max_depth) {
+  CHECK_GT(max_num_leaf_entries_, 0);
+  CHECK_GE(max_depth_, 0);
+}
+
+void Octree::Insert(const uint64_t id, const Eigen::Vector3d& position) {
+  CHECK(position.allFinite());
+  CHECK(positions_.emplace(id, position).second);
+
+  if (!root_) {
+    root_.reset(new Node);
+    root_->center = position;
+    root_->half_size = 1;
+  }
+
+  GrowRoot(position);
+
+  Node* node = root_.get();
+  node->num_entries += 1;
+  while (!node->IsLeaf()) {
+    node = node->children[node->ChildIndex(position)].get();
+    node->num_entries += 1;
+  }
+
+  node->entries.push_back({id, position});
+  if (node->entries.size() > max_num_leaf_entries_ &&
+      node->depth < max_depth_) {
+    Split(node);
+  }
+}
+
+void Octree::Remove(const uint64_t id) {
+  const auto it = positions_.find(id);
+  CHECK(it != positions_.end());
+  const Eigen::Vector3d position = it->second;
+  positions_.erase(it);
+
+  Node* node = root_.get();
+  while (true) {
+    node->num_entries -= 1;
+    if (!node->IsLeaf() && node->num_entries <= max_num_leaf_entries_ / 2) {
+      Merge(node);
+    }
+    if (node->IsLeaf()) {
+      break;
+    }
+    node = node->children[node->ChildIndex(position)].get();
+  }
+
+  for (size_t i = 0; i < node->entries.size(); ++i) {
+    if (node->entries[i].id == id) {
+      node->entries[i] = node->entries.back();
+      node->entries.pop_back();
+      return;
+    }
+  }
+
+  LOG(FATAL) << "Position not found in leaf node";
+}
+
+void Octree::Clear() {
+  root_.reset();
+  positions_.clear();
+}
+
+void Octree::QueryBox(const Eigen::Vector3d& bbox_min,
+                      const Eigen::Vector3d& bbox_max,
+                      std::vector<uint64_t>* ids) const {
+  CHECK_NOTNULL(ids);
+  if (root_) {
+    QueryBox(*root_, bbox_min, bbox_max, ids);
+  }
+}
+
+void Octree::QueryConvexRegion(const std::vector<Eigen::Vector4d>& planes,
+                               std::vector<uint64_t>* ids) const {
+  CHECK_NOTNULL(ids);
+  if (root_) {
+    QueryConvexRegion(*root_, planes, ids);
+  }
+}
+
+void Octree::GrowRoot(const Eigen::Vector3d& position) {
+  while (!root_->Contains(position)) {
+    std::unique_ptr<Node> root(new Node);
+    root->half_size = 2 * root_->half_size;
+    root->depth = root_->depth - 1;
+    root->num_entries = root_->num_entries;
+    for (int d = 0; d < 3; ++d) {
+      root->center(d) = root_->center(d) + (position(d) >= root_->center(d)
+                                                ? root_->half_size
+                                                : -root_->half_size);
+    }
+
+    const int old_root_index = root->ChildIndex(root_->center);
+    for (int i = 0; i < 8; ++i) {
+      if (i == old_root_index) {
+        root->children[i] = std::move(root_);
+        continue;
+      }
+      root->children[i].reset(new Node);
+      Node* child = root->children[i].get();
+      child->half_size = root->half_size / 2;
+      child->depth = root->depth + 1;
+      for (int d = 0; d < 3; ++d) {
+        child->center(d) = root->center(d) + ((i >> d) & 1
+                                                  ? child->half_size
+                                                  : -child->half_size);
+      }
+    }
+
+    root_ = std::move(root);
+  }
+}
+
+void Octree::Split(Node* node) const {
+  for (int i = 0; i < 8; ++i) {
+    node->children[i].reset(new Node);
+    Node* child = node->children[i].get();
+    child->half_size = node->half_size / 2;
+    child->depth = node->depth + 1;
+    for (int d = 0; d < 3; ++d) {
+      child->center(d) = node->center(d) + ((i >> d) & 1 ? child->half_size
+                                                         : -child->half_size);
+    }
+  }
+
+  for (const auto& entry : node->entries) {
+    Node* child = node->children[node->ChildIndex(entry.position)].get();
+    child->entries.push_back(entry);
+    child->num_entries += 1;
+  }
+  node->entries.clear();
+  node->entries.shrink_to_fit();
+
+  for (int i = 0; i < 8; ++i) {
+    Node* child = node->children[i].get();
+    if (child->entries.size() > max_num_leaf_entries_ &&
+        child->depth < max_depth_) {
+      Split(child);
+    }
+  }
+}
+
+void Octree::Merge(Node* node) const {
+  std::vector<Entry> entries;
+  entries.reserve(node->num_entries + 1);
+  CollectEntries(*node, &entries);
+  for (int i = 0; i < 8; ++i) {
+    node->children[i].reset();
+  }
+  node->entries = std::move(entries);
+}
+
+void Octree::CollectEntries(const Node& node, std::vector<Entry>* entries) {
+  if (node.IsLeaf()) {
+    entries->insert(entries->end(), node.entries.begin(), node.entries.end());
+  } else {
+    for (int i = 0; i < 8; ++i) {
+      CollectEntries(*node.children[i], entries);
+    }
+  }
+}
+
+void Octree::CollectIds(const Node& node, std::vector<uint64_t>* ids) {
+  if (node.IsLeaf()) {
+    for (const auto& entry : node.entries) {
+      ids->push_back(entry.id);
+    }
+  } else {
+    for (int i = 0; i < 8; ++i) {
+      if (node.children[i]->num_entries > 0) {
+        CollectIds(*node.children[i], ids);
+      }
+    }
+  }
+}
+
+void Octree::QueryBox(const Node& node, const Eigen::Vector3d& bbox_min,
+                      const Eigen::Vector3d& bbox_max,
+                      std::vector<uint64_t>* ids) {
+  if (node.num_entries == 0) {
+    return;
+  }
+
+  const Eigen::Vector3d node_min = node.center.array() - node.half_size;
+  const Eigen::Vector3d node_max = node.center.array() + node.half_size;
+  if ((node_max.array() < bbox_min.array()).any() ||
+      (node_min.array() > bbox_max.array()).any()) {
+    return;
+  }
+
+  if ((node_min.array() >= bbox_min.array()).all() &&
+      (node_max.array() <= bbox_max.array()).all()) {
+    CollectIds(node, ids);
+  } else if (node.IsLeaf()) {
+    for (const auto& entry : node.entries) {
+      if ((entry.position.array() >= bbox_min.array()).all() &&
+          (entry.position.array() <= bbox_max.array()).all()) {
+        ids->push_back(entry.id);
+      }
+    }
+  } else {
+    for (int i = 0; i < 8; ++i) {
+      QueryBox(*node.children[i], bbox_min, bbox_max, ids);
+    }
+  }
+}
+
+void Octree::QueryConvexRegion(const Node& node,
+                               const std::vector<Eigen::Vector4d>& planes,
+                               std::vector<uint64_t>* ids) {
+  if (node.num_entries == 0) {
+    return;
+  }
+
+  // Classify the node by the signed distances of its nearest and farthest
+  // corner to each plane.
+  bool intersects_boundary = false;
+  for (const auto& plane : planes) {
+    const double center_dist = plane.head<3>().dot(node.center) + plane(3);
+    const double corner_dist =
+        node.half_size * plane.head<3>().cwiseAbs().sum();
+    if (center_dist + corner_dist < 0) {
+      return;
+    } else if (center_dist - corner_dist < 0) {
+      intersects_boundary = true;
+    }
+  }
+
+  if (!intersects_boundary) {
+    CollectIds(node, ids);
+  } else if (node.IsLeaf()) {
+    for (const auto& entry : node.entries) {
+      bool inside = true;
+      for (const auto& plane : planes) {
+        if (plane.head<3>().dot(entry.position) + plane(3) < 0) {
+          inside = false;
+          break;
+        }
+      }
+      if (inside) {
+        ids->push_back(entry.id);
+      }
+    }
+  } else {
+    for (int i = 0; i < 8; ++i) {
+      QueryConvexRegion(*node.children[i], planes, ids);
+    }
+  }
+}
+
+}  // namespace colmap
@@ -0,0 +1,151 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_BASE_OCTREE_H_
+#define COLMAP_SRC_BASE_OCTREE_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "util/alignment.h"
+
+namespace colmap {
+
+// Octree over 3D positions with unique 64-bit identifiers, e.g., of 3D points
+// or of the projection centers of images, for region queries that only visit
+// the nodes intersecting the query region instead of all positions. A leaf
+// node is split into eight children once it contains more than
+// `max_num_leaf_entries` positions, unless it has reached the maximum depth,
+// and the children are merged again once their parent contains at most half
+// as many positions after removals. The root node grows to contain positions
+// outside of its current extent. Concurrent queries are thread-safe, but must
+// not run concurrently with modifications.
+class Octree {
+ public:
+  explicit Octree(const size_t max_num_leaf_entries = 64,
+                  const int max_depth = 24);
+
+  inline size_t Size() const;
+  inline bool Exists(const uint64_t id) const;
+
+  // Insert a new position, whose identifier must not exist yet.
+  void Insert(const uint64_t id, const Eigen::Vector3d& position);
+
+  // Remove the position with the given identifier, which must exist.
+  void Remove(const uint64_t id);
+
+  // Remove all positions.
+  void Clear();
+
+  // Find the identifiers of the positions inside the axis-aligned box, which
+  // includes its boundary. The identifiers are appended in arbitrary order.
+  void QueryBox(const Eigen::Vector3d& bbox_min,
+                const Eigen::Vector3d& bbox_max,
+                std::vector<uint64_t>* ids) const;
+
+  // Find the identifiers of the positions inside the convex region given as
+  // the intersection of the half-spaces `n^T x + d >= 0` with the planes
+  // `(n, d)`, e.g., a view frustum. The identifiers are appended in arbitrary
+  // order.
+  void QueryConvexRegion(const std::vector<Eigen::Vector4d>& planes,
+                         std::vector<uint64_t>* ids) const;
+
+ private:
+  struct Entry {
+    uint64_t id;
+    Eigen::Vector3d position;
+  };
+
+  struct Node {
+    // The node is the half-open cube around the center with the given half
+    // size, which is consistent with the assignment of positions to children
+    // in `ChildIndex`.
+    Eigen::Vector3d center;
+    double half_size = 0;
+    int depth = 0;
+    // The number of positions in the subtree of the node.
+    size_t num_entries = 0;
+    // The positions of a leaf node, which has no children.
+    std::vector<Entry> entries;
+    std::unique_ptr<Node> children[8];
+
+    inline bool IsLeaf() const { return !children[0]; }
+    inline int ChildIndex(const Eigen::Vector3d& position) const;
+    inline bool Contains(const Eigen::Vector3d& position) const;
+  };
+
+  // Double the size of the root until it contains the position.
+  void GrowRoot(const Eigen::Vector3d& position);
+  void Split(Node* node) const;
+  void Merge(Node* node) const;
+
+  static void CollectEntries(const Node& node, std::vector<Entry>* entries);
+  static void CollectIds(const Node& node, std::vector<uint64_t>* ids);
+  static void QueryBox(const Node& node, const Eigen::Vector3d& bbox_min,
+                       const Eigen::Vector3d& bbox_max,
+                       std::vector<uint64_t>* ids);
+  static void QueryConvexRegion(const Node& node,
+                                const std::vector<Eigen::Vector4d>& planes,
+                                std::vector<uint64_t>* ids);
+
+  size_t max_num_leaf_entries_;
+  int max_depth_;
+
+  std::unique_ptr<Node> root_;
+  std::unordered_map<uint64_t, Eigen::Vector3d> positions_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+size_t Octree::Size() const { return positions_.size(); }
+
+bool Octree::Exists(const uint64_t id) const {
+  return positions_.count(id) > 0;
+}
+
+int Octree::Node::ChildIndex(const Eigen::Vector3d& position) const {
+  return (position.x() >= center.x() ? 1 : 0) |
+         (position.y() >= center.y() ? 2 : 0) |
+         (position.z() >= center.z() ? 4 : 0);
+}
+
+bool Octree::Node::Contains(const Eigen::Vector3d& position) const {
+  const Eigen::Array3d offset = (position - center).array();
+  return (offset >= -half_size).all() && (offset < half_size).all();
+}
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_BASE_OCTREE_H_
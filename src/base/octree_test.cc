@@ -0,0 +1,185 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "base/octree"
+#include "util/testing.h"
+
+#include <algorithm>
+
+#include "base/octree.h"
+#include "util/random.h"
+
+using namespace colmap;
+
+namespace {
+
+std::vector<uint64_t> BruteForceQueryBox(
+    const std::vector<Eigen::Vector3d>& positions,
+    const Eigen::Vector3d& bbox_min, const Eigen::Vector3d& bbox_max) {
+  std::vector<uint64_t> ids;
+  for (size_t i = 0; i < positions.size(); ++i) {
+    if ((positions[i].array() >= bbox_min.array()).all() &&
+        (positions[i].array() <= bbox_max.array()).all()) {
+      ids.push_back(i);
+    }
+  }
+  return ids;
+}
+
+std::vector<uint64_t> Sorted(std::vector<uint64_t> ids) {
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(TestEmpty) {
+  Octree octree;
+  BOOST_CHECK_EQUAL(octree.Size(), 0);
+  BOOST_CHECK(!octree.Exists(0));
+  std::vector<uint64_t> ids;
+  octree.QueryBox(Eigen::Vector3d::Constant(-1), Eigen::Vector3d::Constant(1),
+                  &ids);
+  BOOST_CHECK(ids.empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestQueryBox) {
+  SetPRNGSeed(0);
+  Octree octree(4);
+  std::vector<Eigen::Vector3d> positions;
+  for (uint64_t id = 0; id < 1000; ++id) {
+    positions.emplace_back(RandomReal(-100.0, 100.0), RandomReal(-10.0, 10.0),
+                           RandomReal(0.0, 1.0));
+    octree.Insert(id, positions.back());
+  }
+  BOOST_CHECK_EQUAL(octree.Size(), 1000);
+  BOOST_CHECK(octree.Exists(999));
+
+  for (int i = 0; i < 10; ++i) {
+    const Eigen::Vector3d corner1(RandomReal(-100.0, 100.0),
+                                  RandomReal(-10.0, 10.0),
+                                  RandomReal(0.0, 1.0));
+    const Eigen::Vector3d corner2(RandomReal(-100.0, 100.0),
+                                  RandomReal(-10.0, 10.0),
+                                  RandomReal(0.0, 1.0));
+    const Eigen::Vector3d bbox_min = corner1.cwiseMin(corner2);
+    const Eigen::Vector3d bbox_max = corner1.cwiseMax(corner2);
+    std::vector<uint64_t> ids;
+    octree.QueryBox(bbox_min, bbox_max, &ids);
+    BOOST_CHECK(Sorted(ids) ==
+                BruteForceQueryBox(positions, bbox_min, bbox_max));
+  }
+
+  std::vector<uint64_t> ids;
+  octree.QueryBox(Eigen::Vector3d::Constant(-1000),
+                  Eigen::Vector3d::Constant(1000), &ids);
+  BOOST_CHECK_EQUAL(ids.size(), 1000);
+}
+
+BOOST_AUTO_TEST_CASE(TestRemove) {
+  Octree octree(2);
+  for (uint64_t id = 0; id < 100; ++id) {
+    octree.Insert(id, Eigen::Vector3d(id, 0, 0));
+  }
+  for (uint64_t id = 0; id < 100; id += 2) {
+    octree.Remove(id);
+  }
+  BOOST_CHECK_EQUAL(octree.Size(), 50);
+  BOOST_CHECK(!octree.Exists(0));
+  BOOST_CHECK(octree.Exists(1));
+
+  std::vector<uint64_t> ids;
+  octree.QueryBox(Eigen::Vector3d(10, -1, -1), Eigen::Vector3d(20, 1, 1),
+                  &ids);
+  BOOST_CHECK(Sorted(ids) ==
+              std::vector<uint64_t>({11, 13, 15, 17, 19}));
+
+  for (uint64_t id = 1; id < 100; id += 2) {
+    octree.Remove(id);
+  }
+  BOOST_CHECK_EQUAL(octree.Size(), 0);
+  ids.clear();
+  octree.QueryBox(Eigen::Vector3d::Constant(-1000),
+                  Eigen::Vector3d::Constant(1000), &ids);
+  BOOST_CHECK(ids.empty());
+
+  octree.Insert(0, Eigen::Vector3d(5, 0, 0));
+  octree.QueryBox(Eigen::Vector3d(4, -1, -1), Eigen::Vector3d(6, 1, 1), &ids);
+  BOOST_CHECK(ids == std::vector<uint64_t>({0}));
+
+  octree.Clear();
+  BOOST_CHECK_EQUAL(octree.Size(), 0);
+  BOOST_CHECK(!octree.Exists(0));
+}
+
+BOOST_AUTO_TEST_CASE(TestIdenticalPositions) {
+  Octree octree(1, 4);
+  for (uint64_t id = 0; id < 10; ++id) {
+    octree.Insert(id, Eigen::Vector3d(1, 2, 3));
+  }
+  std::vector<uint64_t> ids;
+  octree.QueryBox(Eigen::Vector3d(1, 2, 3), Eigen::Vector3d(1, 2, 3), &ids);
+  BOOST_CHECK_EQUAL(ids.size(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(TestQueryConvexRegion) {
+  Octree octree(4);
+  std::vector<Eigen::Vector3d> positions;
+  for (int x = -10; x <= 10; ++x) {
+    for (int y = -10; y <= 10; ++y) {
+      positions.emplace_back(x, y, 0);
+      octree.Insert(positions.size() - 1, positions.back());
+    }
+  }
+
+  // The box [-2, 3] x [-1, 4] as half-spaces.
+  const std::vector<Eigen::Vector4d> planes = {
+      Eigen::Vector4d(1, 0, 0, 2), Eigen::Vector4d(-1, 0, 0, 3),
+      Eigen::Vector4d(0, 1, 0, 1), Eigen::Vector4d(0, -1, 0, 4)};
+  std::vector<uint64_t> ids;
+  octree.QueryConvexRegion(planes, &ids);
+  BOOST_CHECK(Sorted(ids) ==
+              BruteForceQueryBox(positions, Eigen::Vector3d(-2, -1, -1),
+                                 Eigen::Vector3d(3, 4, 1)));
+
+  // The half-space x + y >= 15.
+  ids.clear();
+  octree.QueryConvexRegion({Eigen::Vector4d(1, 1, 0, -15)}, &ids);
+  size_t num_expected = 0;
+  for (const auto& position : positions) {
+    if (position.x() + position.y() >= 15) {
+      num_expected += 1;
+    }
+  }
+  BOOST_CHECK_EQUAL(ids.size(), num_expected);
+  for (const uint64_t id : ids) {
+    BOOST_CHECK_GE(positions[id].x() + positions[id].y(), 15);
+  }
+}
@@ -36,4 +36,7 @@ namespace colmap {
 Point2D::Point2D()
     : xy_(Eigen::Vector2d::Zero()), point3D_id_(kInvalidPoint3DId) {}
 
+Point2D::Point2D(const Eigen::Vector2d& xy, const point3D_t point3D_id)
+    : xy_(xy), point3D_id_(point3D_id) {}
+
 }  // namespace colmap
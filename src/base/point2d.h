@@ -39,6 +39,15 @@
 
 namespace colmap {
 
+// The scalar type of the image coordinates of the 2D points stored in images.
+// Single precision halves the memory of the coordinates and is sufficient for
+// the sub-pixel accuracy of feature detectors in typical image resolutions.
+#ifdef FLOAT_POINTS2D_ENABLED
+typedef float point2D_coord_t;
+#else
+typedef double point2D_coord_t;
+#endif
+
 // 2D point class corresponds to a feature in an image. It may or may not have a
 // corresponding 3D point if it is part of a triangulated track.
 class Point2D {
@@ -46,6 +55,7 @@ class Point2D {
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   Point2D();
+  Point2D(const Eigen::Vector2d& xy, const point3D_t point3D_id);
 
   // The coordinate in image space in pixels.
   inline const Eigen::Vector2d& XY() const;
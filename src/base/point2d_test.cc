@@ -70,3 +70,11 @@ BOOST_AUTO_TEST_CASE(TestPoint3DId) {
   BOOST_CHECK_EQUAL(point2D.Point3DId(), kInvalidPoint3DId);
   BOOST_CHECK_EQUAL(point2D.HasPoint3D(), false);
 }
+
+BOOST_AUTO_TEST_CASE(TestConstructor) {
+  Point2D point2D(Eigen::Vector2d(0.1, 0.2), 1);
+  BOOST_CHECK_EQUAL(point2D.X(), 0.1);
+  BOOST_CHECK_EQUAL(point2D.Y(), 0.2);
+  BOOST_CHECK_EQUAL(point2D.Point3DId(), 1);
+  BOOST_CHECK_EQUAL(point2D.HasPoint3D(), true);
+}
@@ -31,6 +31,8 @@
 
 #include "base/polynomial.h"
 
+#include <algorithm>
+
 #include <Eigen/Eigenvalues>
 
 #include "util/logging.h"
@@ -60,6 +62,160 @@ Eigen::VectorXd RemoveTrailingZeros(const Eigen::VectorXd& coeffs) {
   return coeffs.head(coeffs.size() - num_zeros);
 }
 
+// Evaluate the monic polynomial x^N + sum_{i=0}^{N-1} coeffs[i] x^{N-1-i}
+// and its derivative at x.
+double EvaluateMonicPolynomial(const double* coeffs, const int degree,
+                               const double x, double* derivative) {
+  double value = 1;
+  *derivative = 0;
+  for (int i = 0; i < degree; ++i) {
+    *derivative = *derivative * x + value;
+    value = value * x + coeffs[i];
+  }
+  return value;
+}
+
+// Polish the root of the monic polynomial using Newton iterations, as long as
+// they reduce the residual of the root.
+double PolishRealRoot(const double* coeffs, const int degree, double x) {
+  const int kNumIterations = 2;
+  double derivative;
+  double value = EvaluateMonicPolynomial(coeffs, degree, x, &derivative);
+  for (int iter = 0; iter < kNumIterations; ++iter) {
+    if (derivative == 0) {
+      break;
+    }
+    const double new_x = x - value / derivative;
+    double new_derivative;
+    const double new_value =
+        EvaluateMonicPolynomial(coeffs, degree, new_x, &new_derivative);
+    if (std::abs(new_value) >= std::abs(value)) {
+      break;
+    }
+    x = new_x;
+    value = new_value;
+    derivative = new_derivative;
+  }
+  return x;
+}
+
+// Find the real roots of a * x^2 + b * x + c = 0 with a != 0.
+int SolveRealQuadratic(const double a, const double b, const double c,
+                       double* roots) {
+  const double d = b * b - 4 * a * c;
+  if (d < 0) {
+    return 0;
+  }
+
+  // Avoid the cancellation of the smaller root.
+  const double t = -0.5 * (b + std::copysign(std::sqrt(d), b));
+  if (t == 0) {
+    roots[0] = 0;
+    roots[1] = 0;
+  } else {
+    roots[0] = t / a;
+    roots[1] = c / t;
+  }
+
+  return 2;
+}
+
+// Find the real roots of x^3 + b * x^2 + c * x + d = 0 using Cardano's method
+// for one and the trigonometric method for three real roots.
+int SolveRealMonicCubic(const double b, const double c, const double d,
+                        double* roots) {
+  // Substitute x = t - b / 3 to obtain the depressed cubic t^3 + p t + q.
+  const double shift = -b / 3;
+  const double p = c - b * b / 3;
+  const double q = (2 * b * b / 27 - c / 3) * b + d;
+
+  const double half_q = q / 2;
+  const double third_p = p / 3;
+  const double discriminant = half_q * half_q + third_p * third_p * third_p;
+
+  int num_roots = 0;
+  if (discriminant > 0) {
+    // The operands have equal sign to avoid cancellation.
+    const double u = std::cbrt(-half_q - std::copysign(std::sqrt(discriminant),
+                                                       half_q));
+    roots[num_roots++] = (u == 0 ? 0 : u - third_p / u) + shift;
+  } else if (p == 0) {
+    roots[num_roots++] = shift;
+    roots[num_roots++] = shift;
+    roots[num_roots++] = shift;
+  } else {
+    const double r = 2 * std::sqrt(-third_p);
+    const double cos_3phi =
+        std::max(-1.0, std::min(1.0, half_q / (third_p * r / 2)));
+    const double phi = std::acos(cos_3phi) / 3;
+    const double kTwoPiThirds = 2.0943951023931954923;
+    roots[num_roots++] = r * std::cos(phi) + shift;
+    roots[num_roots++] = r * std::cos(phi - kTwoPiThirds) + shift;
+    roots[num_roots++] = r * std::cos(phi + kTwoPiThirds) + shift;
+  }
+
+  const double coeffs[3] = {b, c, d};
+  for (int i = 0; i < num_roots; ++i) {
+    roots[i] = PolishRealRoot(coeffs, 3, roots[i]);
+  }
+
+  return num_roots;
+}
+
+// Find the real roots of x^4 + b * x^3 + c * x^2 + d * x + e = 0 using
+// Ferrari's method.
+int SolveRealMonicQuartic(const double b, const double c, const double d,
+                          const double e, double* roots) {
+  // Substitute x = y - b / 4 to obtain the depressed quartic
+  // y^4 + p y^2 + q y + r.
+  const double shift = -b / 4;
+  const double b2 = b * b;
+  const double p = c - 3 * b2 / 8;
+  const double q = (b2 / 8 - c / 2) * b + d;
+  const double r = ((-3 * b2 / 256 + c / 16) * b - d / 4) * b + e;
+
+  // The largest root of the resolvent cubic, which is positive for q != 0.
+  double resolvent_roots[3];
+  const int num_resolvent_roots =
+      SolveRealMonicCubic(p, p * p / 4 - r, -q * q / 8, resolvent_roots);
+  const double m = *std::max_element(resolvent_roots,
+                                     resolvent_roots + num_resolvent_roots);
+
+  int num_roots = 0;
+  double quadratic_roots[2];
+  if (q == 0 || m <= 0) {
+    // Biquadratic equation z^2 + p z + r = 0 with z = y^2.
+    const int num_quadratic_roots =
+        SolveRealQuadratic(1, p, r, quadratic_roots);
+    for (int i = 0; i < num_quadratic_roots; ++i) {
+      if (quadratic_roots[i] >= 0) {
+        const double y = std::sqrt(quadratic_roots[i]);
+        roots[num_roots++] = y + shift;
+        roots[num_roots++] = -y + shift;
+      }
+    }
+  } else {
+    // Factorize into the two quadratics y^2 -/+ s y + p / 2 + m +/- q / 2s.
+    const double s = std::sqrt(2 * m);
+    const double t = q / (2 * s);
+    for (const double sign : {-1.0, 1.0}) {
+      const int num_quadratic_roots =
+          SolveRealQuadratic(1, sign * s, p / 2 + m - sign * t,
+                             quadratic_roots);
+      for (int i = 0; i < num_quadratic_roots; ++i) {
+        roots[num_roots++] = quadratic_roots[i] + shift;
+      }
+    }
+  }
+
+  const double coeffs[4] = {b, c, d, e};
+  for (int i = 0; i < num_roots; ++i) {
+    roots[i] = PolishRealRoot(coeffs, 4, roots[i]);
+  }
+
+  return num_roots;
+}
+
 }  // namespace
 
 bool FindLinearPolynomialRoots(const Eigen::VectorXd& coeffs,
@@ -274,4 +430,48 @@ bool FindPolynomialRootsCompanionMatrix(const Eigen::VectorXd& coeffs_all,
   return true;
 }
 
+bool FindRealCubicPolynomialRoots(const Eigen::Vector4d& coeffs,
+                                  Eigen::Vector3d* real, int* num_roots) {
+  if (coeffs(0) == 0) {
+    *num_roots = 0;
+    if (coeffs(1) != 0) {
+      *num_roots =
+          SolveRealQuadratic(coeffs(1), coeffs(2), coeffs(3), real->data());
+    } else if (coeffs(2) != 0) {
+      (*real)((*num_roots)++) = -coeffs(3) / coeffs(2);
+    } else {
+      return false;
+    }
+  } else {
+    *num_roots =
+        SolveRealMonicCubic(coeffs(1) / coeffs(0), coeffs(2) / coeffs(0),
+                            coeffs(3) / coeffs(0), real->data());
+  }
+
+  std::sort(real->data(), real->data() + *num_roots);
+
+  return true;
+}
+
+bool FindRealQuarticPolynomialRoots(const Eigen::Matrix<double, 5, 1>& coeffs,
+                                    Eigen::Vector4d* real, int* num_roots) {
+  if (coeffs(0) == 0) {
+    Eigen::Vector3d cubic_real;
+    if (!FindRealCubicPolynomialRoots(coeffs.tail<4>(), &cubic_real,
+                                      num_roots)) {
+      return false;
+    }
+    real->head(*num_roots) = cubic_real.head(*num_roots);
+    return true;
+  }
+
+  *num_roots = SolveRealMonicQuartic(
+      coeffs(1) / coeffs(0), coeffs(2) / coeffs(0), coeffs(3) / coeffs(0),
+      coeffs(4) / coeffs(0), real->data());
+
+  std::sort(real->data(), real->data() + *num_roots);
+
+  return true;
+}
+
 }  // namespace colmap
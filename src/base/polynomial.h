@@ -32,7 +32,11 @@
 #ifndef COLMAP_SRC_BASE_POLYNOMIAL_H_
 #define COLMAP_SRC_BASE_POLYNOMIAL_H_
 
+#include <algorithm>
+#include <cmath>
+
 #include <Eigen/Core>
+#include <Eigen/Eigenvalues>
 
 namespace colmap {
 
@@ -83,6 +87,45 @@ bool FindPolynomialRootsCompanionMatrix(const Eigen::VectorXd& coeffs,
                                         Eigen::VectorXd* real,
                                         Eigen::VectorXd* imag);
 
+// Fixed-size variant of the companion matrix method, which does not allocate
+// memory, e.g., for the minimal solvers evaluated in the RANSAC loop. The
+// first `num_roots` elements of `real` and `imag` hold the roots. Polynomials
+// with vanishing leading or trailing coefficients are solved by the dynamic
+// variant above.
+template <int kNumCoeffs>
+bool FindPolynomialRootsCompanionMatrix(
+    const Eigen::Matrix<double, kNumCoeffs, 1>& coeffs,
+    Eigen::Matrix<double, kNumCoeffs - 1, 1>* real,
+    Eigen::Matrix<double, kNumCoeffs - 1, 1>* imag, int* num_roots);
+
+// Find only the real roots of a polynomial by bracketing them with a Sturm
+// sequence and refining them with safeguarded Newton iterations, based on:
+//
+//    D. Nister, An efficient solution to the five-point relative pose problem,
+//    IEEE-T-PAMI, 26(6), 2004.
+//
+// This is considerably faster than solving the eigenvalue problem of the
+// companion matrix, if the complex roots are not needed. The first
+// `num_roots` elements of `real` hold the distinct real roots in ascending
+// order. Polynomials with vanishing leading coefficient are solved by the
+// companion matrix method.
+template <int kNumCoeffs>
+bool FindRealPolynomialRootsSturm(
+    const Eigen::Matrix<double, kNumCoeffs, 1>& coeffs,
+    Eigen::Matrix<double, kNumCoeffs - 1, 1>* real, int* num_roots);
+
+// Find only the real roots of cubic and quartic polynomials in closed form
+// using Cardano's and Ferrari's method, which are polished with Newton
+// iterations. These do not allocate memory and are considerably faster than
+// the companion matrix method, e.g., for the minimal solvers. The first
+// `num_roots` elements of `real` hold the real roots in ascending order,
+// where repeated roots are contained multiple times. Polynomials with
+// vanishing leading coefficients are solved as lower degree polynomials.
+bool FindRealCubicPolynomialRoots(const Eigen::Vector4d& coeffs,
+                                  Eigen::Vector3d* real, int* num_roots);
+bool FindRealQuarticPolynomialRoots(const Eigen::Matrix<double, 5, 1>& coeffs,
+                                    Eigen::Vector4d* real, int* num_roots);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
@@ -96,6 +139,271 @@ T EvaluatePolynomial(const Eigen::VectorXd& coeffs, const T& x) {
   return value;
 }
 
+template <int kNumCoeffs>
+bool FindPolynomialRootsCompanionMatrix(
+    const Eigen::Matrix<double, kNumCoeffs, 1>& coeffs,
+    Eigen::Matrix<double, kNumCoeffs - 1, 1>* real,
+    Eigen::Matrix<double, kNumCoeffs - 1, 1>* imag, int* num_roots) {
+  const int kDegree = kNumCoeffs - 1;
+  static_assert(kDegree > 2, "Use the closed form solutions instead");
+
+  if (coeffs(0) == 0 || coeffs(kDegree) == 0) {
+    Eigen::VectorXd dynamic_real;
+    Eigen::VectorXd dynamic_imag;
+    if (!FindPolynomialRootsCompanionMatrix(Eigen::VectorXd(coeffs),
+                                            &dynamic_real, &dynamic_imag)) {
+      return false;
+    }
+    *num_roots = static_cast<int>(dynamic_real.size());
+    real->head(*num_roots) = dynamic_real;
+    imag->head(*num_roots) = dynamic_imag;
+    return true;
+  }
+
+  Eigen::Matrix<double, kDegree, kDegree> C;
+  C.setZero();
+  for (int i = 1; i < kDegree; ++i) {
+    C(i, i - 1) = 1;
+  }
+  C.row(0) = -coeffs.template tail<kDegree>().transpose() / coeffs(0);
+
+  const Eigen::EigenSolver<Eigen::Matrix<double, kDegree, kDegree>> solver(
+      C, false);
+  if (solver.info() != Eigen::Success) {
+    return false;
+  }
+
+  *real = solver.eigenvalues().real();
+  *imag = solver.eigenvalues().imag();
+  *num_roots = kDegree;
+
+  return true;
+}
+
+namespace internal {
+
+// Sturm sequence of a polynomial, where row `i` holds the left-aligned
+// coefficients of the `i`-th polynomial of degree `degrees[i]`.
+template <int kNumCoeffs>
+struct SturmSequence {
+  Eigen::Matrix<double, kNumCoeffs, kNumCoeffs, Eigen::RowMajor> polys;
+  int degrees[kNumCoeffs];
+  int size = 0;
+
+  double Evaluate(const int idx, const double x) const {
+    double value = 0.0;
+    for (int i = 0; i <= degrees[idx]; ++i) {
+      value = value * x + polys(idx, i);
+    }
+    return value;
+  }
+
+  int NumSignChanges(const double x) const {
+    int num_sign_changes = 0;
+    double prev_value = 0.0;
+    for (int i = 0; i < size; ++i) {
+      const double value = Evaluate(i, x);
+      if (value != 0.0) {
+        if ((prev_value < 0.0 && value > 0.0) ||
+            (prev_value > 0.0 && value < 0.0)) {
+          num_sign_changes += 1;
+        }
+        prev_value = value;
+      }
+    }
+    return num_sign_changes;
+  }
+};
+
+template <int kNumCoeffs>
+void BuildSturmSequence(const Eigen::Matrix<double, kNumCoeffs, 1>& coeffs,
+                        SturmSequence<kNumCoeffs>* sequence) {
+  const int kDegree = kNumCoeffs - 1;
+
+  // The polynomial and its derivative keep their scale for Newton's method.
+  sequence->polys.row(0) = coeffs.transpose() / coeffs(0);
+  sequence->degrees[0] = kDegree;
+  for (int i = 0; i < kDegree; ++i) {
+    sequence->polys(1, i) = (kDegree - i) * sequence->polys(0, i);
+  }
+  sequence->degrees[1] = kDegree - 1;
+  sequence->size = 2;
+
+  // The following polynomials are the negated remainders of the polynomial
+  // division of the two preceding polynomials.
+  Eigen::Matrix<double, 1, kNumCoeffs> rem;
+  while (sequence->size < kNumCoeffs &&
+         sequence->degrees[sequence->size - 1] > 0) {
+    const int idx = sequence->size;
+    const int num_dividend = sequence->degrees[idx - 2] + 1;
+    const int num_divisor = sequence->degrees[idx - 1] + 1;
+
+    rem.head(num_dividend) = sequence->polys.row(idx - 2).head(num_dividend);
+    const double scale = rem.head(num_dividend).cwiseAbs().maxCoeff();
+    for (int i = 0; i <= num_dividend - num_divisor; ++i) {
+      const double factor = rem(i) / sequence->polys(idx - 1, 0);
+      for (int j = 0; j < num_divisor; ++j) {
+        rem(i + j) -= factor * sequence->polys(idx - 1, j);
+      }
+    }
+
+    // Strip vanishing leading coefficients of the remainder. A vanishing
+    // remainder terminates the sequence at the greatest common divisor.
+    const double kEps = 1e-14;
+    int begin = num_dividend - num_divisor + 1;
+    while (begin < num_dividend && std::abs(rem(begin)) <= kEps * scale) {
+      begin += 1;
+    }
+    if (begin == num_dividend) {
+      break;
+    }
+
+    const int num_rem = num_dividend - begin;
+    const double norm = rem.segment(begin, num_rem).cwiseAbs().maxCoeff();
+    sequence->polys.row(idx).head(num_rem) =
+        -rem.segment(begin, num_rem) / norm;
+    sequence->degrees[idx] = num_rem - 1;
+    sequence->size += 1;
+  }
+}
+
+// Refine a root in the interval (lower, upper] with safeguarded Newton steps.
+template <int kNumCoeffs>
+double RefineSturmRoot(const SturmSequence<kNumCoeffs>& sequence,
+                       double lower, double upper) {
+  const int kMaxNumIterations = 100;
+  const double kEps = 1e-15;
+
+  const double lower_value = sequence.Evaluate(0, lower);
+  const double upper_value = sequence.Evaluate(0, upper);
+  if (upper_value == 0.0) {
+    return upper;
+  }
+
+  const bool has_sign_change = (lower_value < 0.0) != (upper_value < 0.0);
+
+  double x = 0.5 * (lower + upper);
+  double step = upper - lower;
+  double prev_step = step;
+  for (int i = 0; i < kMaxNumIterations; ++i) {
+    double next_x;
+    if (has_sign_change) {
+      const double value = sequence.Evaluate(0, x);
+      if (value == 0.0) {
+        break;
+      }
+      if ((value < 0.0) == (lower_value < 0.0)) {
+        lower = x;
+      } else {
+        upper = x;
+      }
+      // Bisect if Newton's method leaves the interval or converges slowly,
+      // e.g., far away from the root.
+      const double derivative = sequence.Evaluate(1, x);
+      next_x = x - value / derivative;
+      if (derivative == 0.0 || !(next_x > lower && next_x < upper) ||
+          std::abs(next_x - x) > 0.5 * std::abs(prev_step)) {
+        next_x = 0.5 * (lower + upper);
+      }
+    } else {
+      // Roots of even multiplicity do not change the sign of the polynomial,
+      // so the interval is bisected using the Sturm sequence.
+      if (sequence.NumSignChanges(lower) > sequence.NumSignChanges(x)) {
+        upper = x;
+      } else {
+        lower = x;
+      }
+      next_x = 0.5 * (lower + upper);
+    }
+
+    if (std::abs(next_x - x) <= kEps * std::max(1.0, std::abs(x))) {
+      return next_x;
+    }
+    prev_step = step;
+    step = next_x - x;
+    x = next_x;
+  }
+
+  return x;
+}
+
+template <int kNumCoeffs>
+void IsolateSturmRoots(const SturmSequence<kNumCoeffs>& sequence,
+                       const double lower, const double upper,
+                       const int lower_num_sign_changes,
+                       const int upper_num_sign_changes, const int depth,
+                       Eigen::Matrix<double, kNumCoeffs - 1, 1>* real,
+                       int* num_roots) {
+  const int num_interval_roots =
+      lower_num_sign_changes - upper_num_sign_changes;
+  if (num_interval_roots <= 0 || *num_roots >= kNumCoeffs - 1) {
+    return;
+  }
+
+  if (num_interval_roots == 1) {
+    (*real)((*num_roots)++) = RefineSturmRoot(sequence, lower, upper);
+    return;
+  }
+
+  const double mid = 0.5 * (lower + upper);
+
+  // Numerically indistinguishable roots are reported once.
+  const int kMaxDepth = 64;
+  if (depth >= kMaxDepth || mid <= lower || mid >= upper) {
+    (*real)((*num_roots)++) = mid;
+    return;
+  }
+
+  const int mid_num_sign_changes = sequence.NumSignChanges(mid);
+  IsolateSturmRoots(sequence, lower, mid, lower_num_sign_changes,
+                    mid_num_sign_changes, depth + 1, real, num_roots);
+  IsolateSturmRoots(sequence, mid, upper, mid_num_sign_changes,
+                    upper_num_sign_changes, depth + 1, real, num_roots);
+}
+
+}  // namespace internal
+
+template <int kNumCoeffs>
+bool FindRealPolynomialRootsSturm(
+    const Eigen::Matrix<double, kNumCoeffs, 1>& coeffs,
+    Eigen::Matrix<double, kNumCoeffs - 1, 1>* real, int* num_roots) {
+  const int kDegree = kNumCoeffs - 1;
+  static_assert(kDegree > 2, "Use the closed form solutions instead");
+
+  if (coeffs(0) == 0) {
+    Eigen::Matrix<double, kDegree, 1> roots_real;
+    Eigen::Matrix<double, kDegree, 1> roots_imag;
+    int num_complex_roots = 0;
+    if (!FindPolynomialRootsCompanionMatrix(coeffs, &roots_real, &roots_imag,
+                                            &num_complex_roots)) {
+      return false;
+    }
+    *num_roots = 0;
+    for (int i = 0; i < num_complex_roots; ++i) {
+      if (roots_imag(i) == 0) {
+        (*real)((*num_roots)++) = roots_real(i);
+      }
+    }
+    std::sort(real->data(), real->data() + *num_roots);
+    return true;
+  }
+
+  internal::SturmSequence<kNumCoeffs> sequence;
+  internal::BuildSturmSequence(coeffs, &sequence);
+
+  // All roots lie within the Cauchy bound.
+  const double bound =
+      1.0 + sequence.polys.row(0).tail(kDegree).cwiseAbs().maxCoeff();
+
+  *num_roots = 0;
+  internal::IsolateSturmRoots(sequence, -bound, bound,
+                              sequence.NumSignChanges(-bound),
+                              sequence.NumSignChanges(bound), 0, real,
+                              num_roots);
+
+  return true;
+}
+
 }  // namespace colmap
 
 #endif  // COLMAP_SRC_BASE_POLYNOMIAL_H_
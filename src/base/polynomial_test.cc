@@ -32,7 +32,11 @@
 #define TEST_NAME "base/polynomial"
 #include "util/testing.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/polynomial.h"
+#include "util/random.h"
 
 using namespace colmap;
 
@@ -182,3 +186,239 @@ BOOST_AUTO_TEST_CASE(TestFindPolynomialRootsCompanionMatrixZeroSolution) {
   ref_imag << 0, 0.651148, -0.651148, 0;
   BOOST_CHECK(imag.isApprox(ref_imag, 1e-6));
 }
+
+BOOST_AUTO_TEST_CASE(TestFindPolynomialRootsCompanionMatrixFixedSize) {
+  Eigen::Matrix<double, 5, 1> coeffs;
+  coeffs << 10, -5, 3, -3, 1;
+  Eigen::Vector4d real;
+  Eigen::Vector4d imag;
+  int num_roots = 0;
+  BOOST_CHECK(
+      FindPolynomialRootsCompanionMatrix(coeffs, &real, &imag, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 4);
+  Eigen::VectorXd ref_real;
+  Eigen::VectorXd ref_imag;
+  BOOST_CHECK(FindPolynomialRootsCompanionMatrix(Eigen::VectorXd(coeffs),
+                                                 &ref_real, &ref_imag));
+  BOOST_CHECK_EQUAL(real, Eigen::Vector4d(ref_real));
+  BOOST_CHECK_EQUAL(imag, Eigen::Vector4d(ref_imag));
+
+  // Degenerate polynomials are solved by the dynamic implementation.
+  coeffs << 0, 1, -6, 11, -6;
+  BOOST_CHECK(
+      FindPolynomialRootsCompanionMatrix(coeffs, &real, &imag, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 3);
+  std::sort(real.data(), real.data() + num_roots);
+  BOOST_CHECK_CLOSE(real(0), 1, 1e-6);
+  BOOST_CHECK_CLOSE(real(1), 2, 1e-6);
+  BOOST_CHECK_CLOSE(real(2), 3, 1e-6);
+  BOOST_CHECK_LT(imag.head<3>().norm(), 1e-6);
+
+  coeffs << 10, -5, 3, -3, 0;
+  BOOST_CHECK(
+      FindPolynomialRootsCompanionMatrix(coeffs, &real, &imag, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 4);
+  BOOST_CHECK_EQUAL(real(3), 0);
+  BOOST_CHECK_EQUAL(imag(3), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestFindRealPolynomialRootsSturm) {
+  // (x - 1) * (x + 2) * (x - 3) * (x^2 + 1)
+  Eigen::Matrix<double, 6, 1> coeffs;
+  coeffs << 1, -2, -4, 4, -5, 6;
+  Eigen::Matrix<double, 5, 1> real;
+  int num_roots = 0;
+  BOOST_CHECK(FindRealPolynomialRootsSturm(coeffs, &real, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 3);
+  BOOST_CHECK_CLOSE(real(0), -2, 1e-10);
+  BOOST_CHECK_CLOSE(real(1), 1, 1e-10);
+  BOOST_CHECK_CLOSE(real(2), 3, 1e-10);
+
+  // Double root at x = 2: (x - 2)^2 * (x + 1)
+  Eigen::Vector4d coeffs_double;
+  coeffs_double << 1, -3, 0, 4;
+  Eigen::Vector3d real_double;
+  BOOST_CHECK(
+      FindRealPolynomialRootsSturm(coeffs_double, &real_double, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 2);
+  BOOST_CHECK_CLOSE(real_double(0), -1, 1e-6);
+  BOOST_CHECK_CLOSE(real_double(1), 2, 1e-6);
+
+  // Vanishing leading coefficient: (x - 1) * (x - 2) * (x - 3)
+  Eigen::Matrix<double, 5, 1> coeffs_degenerate;
+  coeffs_degenerate << 0, 1, -6, 11, -6;
+  Eigen::Vector4d real_degenerate;
+  BOOST_CHECK(FindRealPolynomialRootsSturm(coeffs_degenerate, &real_degenerate,
+                                           &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 3);
+  BOOST_CHECK_CLOSE(real_degenerate(0), 1, 1e-6);
+  BOOST_CHECK_CLOSE(real_degenerate(1), 2, 1e-6);
+  BOOST_CHECK_CLOSE(real_degenerate(2), 3, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(TestFindRealPolynomialRootsSturmCompanionMatrix) {
+  SetPRNGSeed(0);
+  for (int k = 0; k < 100; ++k) {
+    Eigen::Matrix<double, 11, 1> coeffs;
+    for (int i = 0; i < coeffs.size(); ++i) {
+      coeffs(i) = RandomReal(-10.0, 10.0);
+    }
+
+    Eigen::Matrix<double, 10, 1> real;
+    int num_roots = 0;
+    BOOST_CHECK(FindRealPolynomialRootsSturm(coeffs, &real, &num_roots));
+
+    Eigen::Matrix<double, 10, 1> ref_real;
+    Eigen::Matrix<double, 10, 1> ref_imag;
+    int num_ref_roots = 0;
+    BOOST_CHECK(FindPolynomialRootsCompanionMatrix(coeffs, &ref_real,
+                                                   &ref_imag, &num_ref_roots));
+    std::vector<double> ref_real_roots;
+    for (int i = 0; i < num_ref_roots; ++i) {
+      if (ref_imag(i) == 0) {
+        ref_real_roots.push_back(ref_real(i));
+      }
+    }
+    std::sort(ref_real_roots.begin(), ref_real_roots.end());
+
+    BOOST_CHECK_EQUAL(num_roots, ref_real_roots.size());
+    for (int i = 0; i < std::min<int>(num_roots, ref_real_roots.size()); ++i) {
+      BOOST_CHECK_LT(std::abs(real(i) - ref_real_roots[i]), 1e-8);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestFindRealCubicPolynomialRoots) {
+  // (x - 1) * (x - 2) * (x - 3)
+  Eigen::Vector4d coeffs(2, -12, 22, -12);
+  Eigen::Vector3d real;
+  int num_roots = 0;
+  BOOST_CHECK(FindRealCubicPolynomialRoots(coeffs, &real, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 3);
+  BOOST_CHECK_CLOSE(real(0), 1, 1e-10);
+  BOOST_CHECK_CLOSE(real(1), 2, 1e-10);
+  BOOST_CHECK_CLOSE(real(2), 3, 1e-10);
+
+  // (x + 2) * (x^2 + 1)
+  coeffs << 1, 2, 1, 2;
+  BOOST_CHECK(FindRealCubicPolynomialRoots(coeffs, &real, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 1);
+  BOOST_CHECK_CLOSE(real(0), -2, 1e-10);
+
+  // Triple root: (x - 1)^3
+  coeffs << 1, -3, 3, -1;
+  BOOST_CHECK(FindRealCubicPolynomialRoots(coeffs, &real, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 3);
+  BOOST_CHECK_CLOSE(real(0), 1, 1e-6);
+  BOOST_CHECK_CLOSE(real(1), 1, 1e-6);
+  BOOST_CHECK_CLOSE(real(2), 1, 1e-6);
+
+  // Vanishing leading coefficients.
+  coeffs << 0, 1, -3, 2;
+  BOOST_CHECK(FindRealCubicPolynomialRoots(coeffs, &real, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 2);
+  BOOST_CHECK_CLOSE(real(0), 1, 1e-10);
+  BOOST_CHECK_CLOSE(real(1), 2, 1e-10);
+  coeffs << 0, 0, 2, 1;
+  BOOST_CHECK(FindRealCubicPolynomialRoots(coeffs, &real, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 1);
+  BOOST_CHECK_EQUAL(real(0), -0.5);
+  coeffs << 0, 0, 0, 1;
+  BOOST_CHECK(!FindRealCubicPolynomialRoots(coeffs, &real, &num_roots));
+}
+
+BOOST_AUTO_TEST_CASE(TestFindRealQuarticPolynomialRoots) {
+  // (x - 1) * (x + 2) * (x - 3) * (x + 4)
+  Eigen::Matrix<double, 5, 1> coeffs;
+  coeffs << 1, 2, -13, -14, 24;
+  Eigen::Vector4d real;
+  int num_roots = 0;
+  BOOST_CHECK(FindRealQuarticPolynomialRoots(coeffs, &real, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 4);
+  BOOST_CHECK_CLOSE(real(0), -4, 1e-10);
+  BOOST_CHECK_CLOSE(real(1), -2, 1e-10);
+  BOOST_CHECK_CLOSE(real(2), 1, 1e-10);
+  BOOST_CHECK_CLOSE(real(3), 3, 1e-10);
+
+  // Biquadratic: (x^2 - 1) * (x^2 - 4)
+  coeffs << 2, 0, -10, 0, 8;
+  BOOST_CHECK(FindRealQuarticPolynomialRoots(coeffs, &real, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 4);
+  BOOST_CHECK_CLOSE(real(0), -2, 1e-10);
+  BOOST_CHECK_CLOSE(real(1), -1, 1e-10);
+  BOOST_CHECK_CLOSE(real(2), 1, 1e-10);
+  BOOST_CHECK_CLOSE(real(3), 2, 1e-10);
+
+  // (x - 1) * (x - 2) * (x^2 + 1)
+  coeffs << 1, -3, 3, -3, 2;
+  BOOST_CHECK(FindRealQuarticPolynomialRoots(coeffs, &real, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 2);
+  BOOST_CHECK_CLOSE(real(0), 1, 1e-10);
+  BOOST_CHECK_CLOSE(real(1), 2, 1e-10);
+
+  // Vanishing leading coefficient: (x - 1) * (x - 2) * (x - 3)
+  coeffs << 0, 1, -6, 11, -6;
+  BOOST_CHECK(FindRealQuarticPolynomialRoots(coeffs, &real, &num_roots));
+  BOOST_CHECK_EQUAL(num_roots, 3);
+  BOOST_CHECK_CLOSE(real(0), 1, 1e-10);
+  BOOST_CHECK_CLOSE(real(1), 2, 1e-10);
+  BOOST_CHECK_CLOSE(real(2), 3, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(TestFindRealCubicQuarticPolynomialRootsCompanionMatrix) {
+  SetPRNGSeed(0);
+  for (int k = 0; k < 1000; ++k) {
+    Eigen::Matrix<double, 5, 1> coeffs;
+    for (int i = 0; i < coeffs.size(); ++i) {
+      coeffs(i) = RandomReal(-10.0, 10.0);
+    }
+
+    Eigen::Vector3d cubic_real;
+    int num_cubic_roots = 0;
+    BOOST_CHECK(FindRealCubicPolynomialRoots(coeffs.head<4>(), &cubic_real,
+                                             &num_cubic_roots));
+    Eigen::Vector4d quartic_real;
+    int num_quartic_roots = 0;
+    BOOST_CHECK(FindRealQuarticPolynomialRoots(coeffs, &quartic_real,
+                                               &num_quartic_roots));
+
+    Eigen::Vector3d ref_cubic_real;
+    Eigen::Vector3d ref_cubic_imag;
+    int num_ref_cubic_roots = 0;
+    BOOST_CHECK(FindPolynomialRootsCompanionMatrix(
+        Eigen::Vector4d(coeffs.head<4>()), &ref_cubic_real, &ref_cubic_imag,
+        &num_ref_cubic_roots));
+    Eigen::Vector4d ref_quartic_real;
+    Eigen::Vector4d ref_quartic_imag;
+    int num_ref_quartic_roots = 0;
+    BOOST_CHECK(FindPolynomialRootsCompanionMatrix(coeffs, &ref_quartic_real,
+                                                   &ref_quartic_imag,
+                                                   &num_ref_quartic_roots));
+
+    std::vector<double> ref_real_roots;
+    for (int i = 0; i < num_ref_cubic_roots; ++i) {
+      if (ref_cubic_imag(i) == 0) {
+        ref_real_roots.push_back(ref_cubic_real(i));
+      }
+    }
+    std::sort(ref_real_roots.begin(), ref_real_roots.end());
+    BOOST_CHECK_EQUAL(num_cubic_roots, ref_real_roots.size());
+    for (int i = 0; i < std::min<int>(num_cubic_roots, ref_real_roots.size());
+         ++i) {
+      BOOST_CHECK_LT(std::abs(cubic_real(i) - ref_real_roots[i]), 1e-8);
+    }
+
+    ref_real_roots.clear();
+    for (int i = 0; i < num_ref_quartic_roots; ++i) {
+      if (ref_quartic_imag(i) == 0) {
+        ref_real_roots.push_back(ref_quartic_real(i));
+      }
+    }
+    std::sort(ref_real_roots.begin(), ref_real_roots.end());
+    BOOST_CHECK_EQUAL(num_quartic_roots, ref_real_roots.size());
+    for (int i = 0;
+         i < std::min<int>(num_quartic_roots, ref_real_roots.size()); ++i) {
+      BOOST_CHECK_LT(std::abs(quartic_real(i) - ref_real_roots[i]), 1e-8);
+    }
+  }
+}
@@ -31,8 +31,16 @@
 
 #include "base/reconstruction.h"
 
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <future>
 
+#include "FLANN/flann.hpp"
 #include "base/database_cache.h"
 #include "base/pose.h"
 #include "base/projection.h"
@@ -43,11 +51,406 @@
 #include "util/bitmap.h"
 #include "util/misc.h"
 #include "util/ply.h"
+#include "util/threading.h"
 
 namespace colmap {
+namespace {
+
+const size_t kParallelChunkSize = 4096;
+
+// Tag of image identifiers in the change journal of a reconstruction.
+const uint64_t kImageChangeBit = 1ull << 63;
+
+// Maximum number of journaled changes before the journal is truncated and
+// consumers have to synchronize the entire reconstruction.
+const size_t kMaxNumJournaledChanges = 1 << 22;
+
+// Number of significant digits of floating point numbers in exported text
+// files, which matches the default formatting of std::ostream.
+const int kExportTextPrecision = 6;
+
+size_t NumParallelChunks(const size_t num_items) {
+  return (num_items + kParallelChunkSize - 1) / kParallelChunkSize;
+}
+
+// Evaluate the function for all items in fixed-size chunks, which are
+// processed in parallel. The chunks do not depend on the number of threads,
+// so that per-chunk partial results can be combined deterministically.
+void ParallelForChunks(
+    const int num_threads, const size_t num_items,
+    const std::function<void(const size_t, const size_t, const size_t)>&
+        func) {
+  const size_t num_chunks = NumParallelChunks(num_items);
+
+  const int num_eff_threads =
+      std::min(GetEffectiveNumThreads(num_threads),
+               static_cast<int>(std::max<size_t>(num_chunks, 1)));
+
+  if (num_eff_threads == 1) {
+    for (size_t chunk_idx = 0; chunk_idx < num_chunks; ++chunk_idx) {
+      func(chunk_idx, chunk_idx * kParallelChunkSize,
+           std::min((chunk_idx + 1) * kParallelChunkSize, num_items));
+    }
+    return;
+  }
+
+  ThreadPool thread_pool(num_eff_threads);
+  for (size_t chunk_idx = 0; chunk_idx < num_chunks; ++chunk_idx) {
+    thread_pool.AddTask([&func, chunk_idx, num_items]() {
+      func(chunk_idx, chunk_idx * kParallelChunkSize,
+           std::min((chunk_idx + 1) * kParallelChunkSize, num_items));
+    });
+  }
+  thread_pool.Wait();
+}
+
+// Exact nearest neighbor index of 3D locations based on a KD-tree. The index
+// references the locations, which must outlive it. Concurrent searches are
+// thread-safe.
+class LocationIndex {
+ public:
+  explicit LocationIndex(const std::vector<Eigen::Vector3d>& locations)
+      : locations_(locations) {
+    const flann::Matrix<double> locations_matrix(
+        const_cast<double*>(locations.data()->data()), locations.size(), 3);
+    index_.reset(new flann::Index<flann::L2_Simple<double>>(
+        locations_matrix, flann::KDTreeSingleIndexParams()));
+    index_->buildIndex();
+  }
+
+  // Compute the mean distance of the locations in the range [begin, end) to
+  // their nearest neighbors, excluding the location itself.
+  void ComputeMeanNeighborDistances(const size_t begin, const size_t end,
+                                    const size_t num_neighbors,
+                                    double* mean_distances) const {
+    const size_t num_queries = end - begin;
+    const size_t knn = std::min(num_neighbors + 1, locations_.size());
+    const flann::Matrix<double> query_matrix(
+        const_cast<double*>(locations_[begin].data()), num_queries, 3);
+    std::vector<size_t> indices(num_queries * knn);
+    std::vector<double> squared_distances(num_queries * knn);
+    flann::Matrix<size_t> indices_matrix(indices.data(), num_queries, knn);
+    flann::Matrix<double> distances_matrix(squared_distances.data(),
+                                           num_queries, knn);
+    index_->knnSearch(query_matrix, indices_matrix, distances_matrix, knn,
+                      flann::SearchParams(flann::FLANN_CHECKS_UNLIMITED));
+    for (size_t i = 0; i < num_queries; ++i) {
+      double distance_sum = 0;
+      // The first neighbor is the location itself or an identical location.
+      for (size_t k = 1; k < knn; ++k) {
+        distance_sum += std::sqrt(squared_distances[i * knn + k]);
+      }
+      mean_distances[i] = knn > 1 ? distance_sum / (knn - 1) : 0;
+    }
+  }
+
+  // Count the other locations within the radius of the locations in the
+  // range [begin, end), where the counts are limited to `max_num_neighbors`.
+  void CountNeighbors(const size_t begin, const size_t end,
+                      const double radius, const size_t max_num_neighbors,
+                      size_t* num_neighbors) const {
+    const flann::Matrix<double> query_matrix(
+        const_cast<double*>(locations_[begin].data()), end - begin, 3);
+    flann::SearchParams search_params(flann::FLANN_CHECKS_UNLIMITED);
+    search_params.sorted = false;
+    // Include the location itself.
+    search_params.max_neighbors = static_cast<int>(max_num_neighbors + 1);
+    std::vector<std::vector<size_t>> indices;
+    std::vector<std::vector<double>> squared_distances;
+    index_->radiusSearch(query_matrix, indices, squared_distances,
+                         static_cast<float>(radius * radius), search_params);
+    for (size_t i = 0; i < indices.size(); ++i) {
+      num_neighbors[i] = indices[i].empty() ? 0 : indices[i].size() - 1;
+    }
+  }
+
+ private:
+  const std::vector<Eigen::Vector3d>& locations_;
+  std::unique_ptr<flann::Index<flann::L2_Simple<double>>> index_;
+};
+
+// Parser of the space-separated items in a line of a text file. In contrast
+// to std::stringstream, it does not allocate and converts numbers directly.
+class TextLineParser {
+ public:
+  TextLineParser(const char* begin, const char* end)
+      : ptr_(begin), end_(end) {}
+
+  bool AtEnd() {
+    SkipSpaces();
+    return ptr_ == end_;
+  }
+
+  std::string ReadToken() {
+    SkipSpaces();
+    const char* token_begin = ptr_;
+    while (ptr_ < end_ && !IsSpace(*ptr_)) {
+      ++ptr_;
+    }
+    return std::string(token_begin, ptr_);
+  }
+
+  double ReadDouble() {
+    CHECK(!AtEnd()) << "Missing item in line";
+    char* item_end;
+    const double value = std::strtod(ptr_, &item_end);
+    Advance(item_end);
+    return value;
+  }
+
+  int64_t ReadInt() {
+    CHECK(!AtEnd()) << "Missing item in line";
+    char* item_end;
+    const int64_t value = std::strtoll(ptr_, &item_end, 10);
+    Advance(item_end);
+    return value;
+  }
+
+  uint64_t ReadUInt() {
+    CHECK(!AtEnd()) << "Missing item in line";
+    char* item_end;
+    const uint64_t value = std::strtoull(ptr_, &item_end, 10);
+    Advance(item_end);
+    return value;
+  }
+
+ private:
+  static bool IsSpace(const char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  void SkipSpaces() {
+    while (ptr_ < end_ && IsSpace(*ptr_)) {
+      ++ptr_;
+    }
+  }
+
+  void Advance(const char* item_end) {
+    CHECK(item_end > ptr_ && item_end <= end_) << "Invalid item in line";
+    ptr_ = item_end;
+  }
+
+  const char* ptr_;
+  const char* end_;
+};
+
+const char* FindLineEnd(const char* begin, const char* end) {
+  const void* line_end = std::memchr(begin, '\n', end - begin);
+  return line_end == nullptr ? end : static_cast<const char*>(line_end);
+}
+
+// Find the end of the last complete line in the text. At the end of the
+// file, the last line is complete even without a line break.
+const char* FindEndOfLastLine(const char* begin, const char* end,
+                              const bool is_last) {
+  if (is_last) {
+    return end;
+  }
+  for (const char* ptr = end; ptr > begin; --ptr) {
+    if (*(ptr - 1) == '\n') {
+      return ptr;
+    }
+  }
+  return begin;
+}
+
+bool IsEmptyOrCommentLine(const char* begin, const char* end) {
+  for (const char* ptr = begin; ptr < end; ++ptr) {
+    if (!std::isspace(static_cast<unsigned char>(*ptr))) {
+      return *ptr == '#';
+    }
+  }
+  return true;
+}
+
+// Call the function for all lines in the text that are not empty or comments.
+template <typename Func>
+void ForEachDataLine(const char* begin, const char* end, const Func& func) {
+  const char* line_begin = begin;
+  while (line_begin < end) {
+    const char* line_end = FindLineEnd(line_begin, end);
+    if (!IsEmptyOrCommentLine(line_begin, line_end)) {
+      func(line_begin, line_end);
+    }
+    line_begin = line_end + 1;
+  }
+}
+
+// Split the text at line breaks into chunks of similar size for parsing the
+// lines of the chunks in parallel.
+std::vector<std::pair<const char*, const char*>> SplitTextIntoChunks(
+    const char* begin, const char* end, const int num_threads) {
+  const size_t kMinNumBytesPerChunk = 1 << 20;
+  const size_t num_bytes = end - begin;
+  const size_t num_chunks = std::max<size_t>(
+      1, std::min<size_t>(4 * GetEffectiveNumThreads(num_threads),
+                          num_bytes / kMinNumBytesPerChunk));
+
+  std::vector<std::pair<const char*, const char*>> chunks;
+  chunks.reserve(num_chunks);
+  const char* chunk_begin = begin;
+  for (size_t chunk_idx = 1; chunk_idx <= num_chunks; ++chunk_idx) {
+    const char* chunk_end = begin + chunk_idx * num_bytes / num_chunks;
+    if (chunk_end < chunk_begin) {
+      continue;
+    }
+    chunk_end = std::min(FindLineEnd(chunk_end, end) + 1, end);
+    chunks.emplace_back(chunk_begin, chunk_end);
+    chunk_begin = chunk_end;
+  }
+
+  return chunks;
+}
+
+// Read the text file in blocks of bounded size. The function returns the
+// end of the complete records it consumed in the given block and the
+// remaining text is passed again at the beginning of the next block. At the
+// last block of the file, the function must consume all text.
+void ReadTextFileInBlocks(
+    const std::string& path,
+    const std::function<const char*(const char*, const char*, const bool)>&
+        func) {
+  std::ifstream file(path, std::ios::binary);
+  CHECK(file.is_open()) << path;
+
+  size_t block_size = 64 << 20;
+  std::vector<char> block;
+  size_t num_remaining_bytes = 0;
+
+  while (true) {
+    block.resize(num_remaining_bytes + block_size);
+    file.read(block.data() + num_remaining_bytes, block_size);
+    const size_t num_block_bytes = num_remaining_bytes + file.gcount();
+    const bool is_last = file.eof() || file.fail();
+    // Terminate the text such that number conversions stop at the end.
+    block.resize(num_block_bytes + 1);
+    block[num_block_bytes] = '\0';
+
+    const char* block_begin = block.data();
+    const char* block_end = block_begin + num_block_bytes;
+    const char* records_end = func(block_begin, block_end, is_last);
+    CHECK(records_end >= block_begin && records_end <= block_end);
+
+    if (is_last) {
+      CHECK(records_end == block_end) << "Incomplete record in " << path;
+      break;
+    }
+
+    num_remaining_bytes = block_end - records_end;
+    std::memmove(block.data(), records_end, num_remaining_bytes);
+
+    // Grow the block if it did not contain a single complete record.
+    if (records_end == block_begin) {
+      block_size *= 2;
+    }
+  }
+}
+
+// Append the value with the given number of significant digits. The default
+// precision ensures that we don't loose any precision by storing in text,
+// while a precision of 6 matches the default formatting of std::ostream.
+void AppendDouble(const double value, std::string* str,
+                  const int precision = 17) {
+  char buffer[32];
+  const int length =
+      std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+  str->append(buffer, length);
+}
+
+template <typename T>
+void AppendInteger(const T value, std::string* str) {
+  str->append(std::to_string(value));
+}
+
+// Format the lines of all items in parallel and write them to the file in
+// the order of the items. The items are formatted in chunks of the given
+// size, while the previous chunks are written, and only a bounded number of
+// formatted chunks is kept in memory.
+void WriteTextLinesInParallel(
+    const int num_threads, const size_t num_items, const size_t chunk_size,
+    const std::function<void(const size_t, std::string*)>& format_func,
+    std::ofstream* file) {
+  const size_t num_chunks = (num_items + chunk_size - 1) / chunk_size;
+
+  const auto FormatChunk = [&](const size_t chunk_idx) {
+    std::string lines;
+    const size_t begin = chunk_idx * chunk_size;
+    const size_t end = std::min(begin + chunk_size, num_items);
+    for (size_t i = begin; i < end; ++i) {
+      format_func(i, &lines);
+    }
+    return lines;
+  };
+
+  const int num_eff_threads =
+      std::min(GetEffectiveNumThreads(num_threads),
+               static_cast<int>(std::max<size_t>(num_chunks, 1)));
+
+  if (num_eff_threads == 1) {
+    for (size_t chunk_idx = 0; chunk_idx < num_chunks; ++chunk_idx) {
+      const std::string lines = FormatChunk(chunk_idx);
+      file->write(lines.data(), lines.size());
+    }
+    return;
+  }
+
+  ThreadPool thread_pool(num_eff_threads);
+  const size_t max_num_pending_chunks = 2 * num_eff_threads;
+  std::deque<std::future<std::string>> pending_chunks;
+  for (size_t chunk_idx = 0; chunk_idx < num_chunks; ++chunk_idx) {
+    pending_chunks.push_back(thread_pool.AddTask(FormatChunk, chunk_idx));
+    if (pending_chunks.size() == max_num_pending_chunks) {
+      const std::string lines = pending_chunks.front().get();
+      file->write(lines.data(), lines.size());
+      pending_chunks.pop_front();
+    }
+  }
+
+  while (!pending_chunks.empty()) {
+    const std::string lines = pending_chunks.front().get();
+    file->write(lines.data(), lines.size());
+    pending_chunks.pop_front();
+  }
+}
+
+// Format the lines of all 3D points in parallel, see WriteTextLinesInParallel.
+// The 3D points are formatted in batches to bound the memory of the formatted
+// text, since the map of 3D points is not randomly accessible.
+void WritePoint3DLinesInParallel(
+    const int num_threads, const DenseIdMap<point3D_t, Point3D>& points3D,
+    const std::function<void(const point3D_t, const Point3D&, std::string*)>&
+        format_func,
+    std::ofstream* file) {
+  const size_t kBatchSize = 1 << 20;
+  std::vector<std::pair<point3D_t, const Point3D*>> batch;
+  batch.reserve(std::min(kBatchSize, points3D.size()));
+
+  const auto WriteBatch = [&]() {
+    WriteTextLinesInParallel(
+        num_threads, batch.size(), kParallelChunkSize,
+        [&](const size_t i, std::string* lines) {
+          format_func(batch[i].first, *batch[i].second, lines);
+        },
+        file);
+    batch.clear();
+  };
+
+  for (const auto& point3D : points3D) {
+    batch.emplace_back(point3D.first, &point3D.second);
+    if (batch.size() == kBatchSize) {
+      WriteBatch();
+    }
+  }
+  WriteBatch();
+}
+
+}  // namespace
 
 Reconstruction::Reconstruction()
-    : correspondence_graph_(nullptr), num_added_points3D_(0) {}
+    : correspondence_graph_(nullptr),
+      num_added_points3D_(0),
+      journal_begin_version_(0),
+      version_(0) {}
 
 std::unordered_set<point3D_t> Reconstruction::Point3DIds() const {
   std::unordered_set<point3D_t> point3D_ids;
@@ -60,8 +463,19 @@ std::unordered_set<point3D_t> Reconstruction::Point3DIds() const {
   return point3D_ids;
 }
 
+const std::unordered_map<image_t, size_t>& Reconstruction::ImageCovisibility(
+    const image_t image_id) const {
+  static const std::unordered_map<image_t, size_t> kEmptyCovisibility;
+  const auto it = image_covisibility_.find(image_id);
+  if (it == image_covisibility_.end()) {
+    return kEmptyCovisibility;
+  }
+  return it->second;
+}
+
 void Reconstruction::Load(const DatabaseCache& database_cache) {
   correspondence_graph_ = nullptr;
+  MarkAllModified();
 
   // Add cameras.
   cameras_.reserve(database_cache.NumCameras());
@@ -80,7 +494,12 @@ void Reconstruction::Load(const DatabaseCache& database_cache) {
       class Image& existing_image = Image(image.second.ImageId());
       CHECK_EQ(existing_image.Name(), image.second.Name());
       if (existing_image.NumPoints2D() == 0) {
-        existing_image.SetPoints2D(image.second.Points2D());
+        std::vector<class Point2D> points2D;
+        points2D.reserve(image.second.NumPoints2D());
+        for (const class Point2D& point2D : image.second.Points2D()) {
+          points2D.push_back(point2D);
+        }
+        existing_image.SetPoints2D(points2D);
       } else {
         CHECK_EQ(image.second.NumPoints2D(), existing_image.NumPoints2D());
       }
@@ -100,6 +519,75 @@ void Reconstruction::Load(const DatabaseCache& database_cache) {
   }
 }
 
+void Reconstruction::LoadUpdate(
+    const DatabaseCache& database_cache,
+    const std::vector<image_t>& new_image_ids,
+    const std::vector<image_pair_t>& new_image_pair_ids) {
+  for (const auto image_id : new_image_ids) {
+    const class Image& image = database_cache.Image(image_id);
+    if (!ExistsCamera(image.CameraId())) {
+      AddCamera(database_cache.Camera(image.CameraId()));
+    }
+    if (!ExistsImage(image_id)) {
+      AddImage(image);
+      if (correspondence_graph_ != nullptr) {
+        Image(image_id).SetUp(Camera(image.CameraId()));
+      }
+    }
+  }
+
+  // The number of observations must be updated before any triangulated
+  // correspondences are counted below.
+  for (const auto pair_id : new_image_pair_ids) {
+    image_t image_id1;
+    image_t image_id2;
+    Database::PairIdToImagePair(pair_id, &image_id1, &image_id2);
+    for (const auto image_id : {image_id1, image_id2}) {
+      const class Image& cached_image = database_cache.Image(image_id);
+      class Image& image = Image(image_id);
+      image.SetNumObservations(cached_image.NumObservations());
+      image.SetNumCorrespondences(cached_image.NumCorrespondences());
+    }
+    image_pair_stats_[pair_id].num_total_corrs =
+        database_cache.CorrespondenceGraph().NumCorrespondencesBetweenImages(
+            image_id1, image_id2);
+  }
+
+  if (correspondence_graph_ == nullptr) {
+    return;
+  }
+
+  for (const auto pair_id : new_image_pair_ids) {
+    image_t image_id1;
+    image_t image_id2;
+    Database::PairIdToImagePair(pair_id, &image_id1, &image_id2);
+    class Image& image1 = Image(image_id1);
+    class Image& image2 = Image(image_id2);
+    const FeatureMatches matches =
+        correspondence_graph_->FindCorrespondencesBetweenImages(image_id1,
+                                                                image_id2);
+    for (const auto& match : matches) {
+      const point3D_t point3D_id1 = image1.Point2DPoint3DId(match.point2D_idx1);
+      const point3D_t point3D_id2 = image2.Point2DPoint3DId(match.point2D_idx2);
+      if (point3D_id1 != kInvalidPoint3DId) {
+        image2.IncrementCorrespondenceHasPoint3D(match.point2D_idx2);
+        if (!image2.IsRegistered()) {
+          modified_visibility_image_ids_.insert(image_id2);
+        }
+      }
+      if (point3D_id2 != kInvalidPoint3DId) {
+        image1.IncrementCorrespondenceHasPoint3D(match.point2D_idx1);
+        if (!image1.IsRegistered()) {
+          modified_visibility_image_ids_.insert(image_id1);
+        }
+      }
+      if (point3D_id1 != kInvalidPoint3DId && point3D_id1 == point3D_id2) {
+        image_pair_stats_[pair_id].num_tri_corrs += 1;
+      }
+    }
+  }
+}
+
 void Reconstruction::SetUp(const CorrespondenceGraph* correspondence_graph) {
   CHECK_NOTNULL(correspondence_graph);
   for (auto& image : images_) {
@@ -120,10 +608,17 @@ void Reconstruction::SetUp(const CorrespondenceGraph* correspondence_graph) {
       }
     }
   }
+
+  image_covisibility_.clear();
+  for (const auto& point3D : points3D_) {
+    UpdateImageCovisibility(point3D.second.Track().Elements(), true);
+  }
 }
 
 void Reconstruction::TearDown() {
   correspondence_graph_ = nullptr;
+  image_covisibility_.clear();
+  MarkAllModified();
 
   // Remove all not yet registered images.
   std::unordered_set<camera_t> keep_camera_ids;
@@ -161,6 +656,7 @@ void Reconstruction::AddCamera(const class Camera& camera) {
 void Reconstruction::AddImage(const class Image& image) {
   CHECK(!ExistsImage(image.ImageId()));
   images_[image.ImageId()] = image;
+  MarkImageModified(image.ImageId());
 }
 
 point3D_t Reconstruction::AddPoint3D(const Eigen::Vector3d& xyz,
@@ -168,6 +664,7 @@ point3D_t Reconstruction::AddPoint3D(const Eigen::Vector3d& xyz,
                                      const Eigen::Vector3ub& color) {
   const point3D_t point3D_id = ++num_added_points3D_;
   CHECK(!ExistsPoint3D(point3D_id));
+  MarkPoint3DModified(point3D_id);
 
   class Point3D& point3D = points3D_[point3D_id];
 
@@ -180,6 +677,7 @@ point3D_t Reconstruction::AddPoint3D(const Eigen::Vector3d& xyz,
     CHECK(!image.Point2D(track_el.point2D_idx).HasPoint3D());
     image.SetPoint3DForPoint2D(track_el.point2D_idx, point3D_id);
     CHECK_LE(image.NumPoints3D(), image.NumPoints2D());
+    MarkImageModified(track_el.image_id);
   }
 
   const bool kIsContinuedPoint3D = false;
@@ -189,6 +687,8 @@ point3D_t Reconstruction::AddPoint3D(const Eigen::Vector3d& xyz,
                                  kIsContinuedPoint3D);
   }
 
+  UpdateImageCovisibility(track.Elements(), true);
+
   return point3D_id;
 }
 
@@ -201,8 +701,12 @@ void Reconstruction::AddObservation(const point3D_t point3D_id,
   CHECK_LE(image.NumPoints3D(), image.NumPoints2D());
 
   class Point3D& point3D = Point3D(point3D_id);
+  UpdateImageCovisibility(track_el.image_id, point3D.Track().Elements(), true);
   point3D.Track().AddElement(track_el);
 
+  MarkImageModified(track_el.image_id);
+  MarkPoint3DModified(point3D_id);
+
   const bool kIsContinuedPoint3D = true;
   SetObservationAsTriangulated(track_el.image_id, track_el.point2D_idx,
                                kIsContinuedPoint3D);
@@ -252,9 +756,13 @@ void Reconstruction::DeletePoint3D(const point3D_t point3D_id) {
   for (const auto& track_el : track.Elements()) {
     class Image& image = Image(track_el.image_id);
     image.ResetPoint3DForPoint2D(track_el.point2D_idx);
+    MarkImageModified(track_el.image_id);
   }
 
+  UpdateImageCovisibility(track.Elements(), false);
+
   points3D_.erase(point3D_id);
+  MarkPoint3DModified(point3D_id);
 }
 
 void Reconstruction::DeleteObservation(const image_t image_id,
@@ -272,14 +780,19 @@ void Reconstruction::DeleteObservation(const image_t image_id,
   }
 
   point3D.Track().DeleteElement(image_id, point2D_idx);
+  UpdateImageCovisibility(image_id, point3D.Track().Elements(), false);
 
   const bool kIsDeletedPoint3D = false;
   ResetTriObservations(image_id, point2D_idx, kIsDeletedPoint3D);
 
   image.ResetPoint3DForPoint2D(point2D_idx);
+
+  MarkImageModified(image_id);
+  MarkPoint3DModified(point3D_id);
 }
 
 void Reconstruction::DeleteAllPoints2DAndPoints3D() {
+  MarkAllModified();
   points3D_.clear();
   for (auto& image : images_) {
     class Image new_image;
@@ -301,6 +814,8 @@ void Reconstruction::RegisterImage(const image_t image_id) {
   if (!image.IsRegistered()) {
     image.SetRegistered(true);
     reg_image_ids_.push_back(image_id);
+    modified_visibility_image_ids_.insert(image_id);
+    MarkImageModified(image_id);
   }
 }
 
@@ -315,12 +830,52 @@ void Reconstruction::DeRegisterImage(const image_t image_id) {
   }
 
   image.SetRegistered(false);
+  modified_visibility_image_ids_.insert(image_id);
+  MarkImageModified(image_id);
 
   reg_image_ids_.erase(
       std::remove(reg_image_ids_.begin(), reg_image_ids_.end(), image_id),
       reg_image_ids_.end());
 }
 
+bool Reconstruction::ReadChanges(const uint64_t version,
+                                 ReconstructionChanges* changes) const {
+  CHECK_NOTNULL(changes);
+
+  changes->image_ids.clear();
+  changes->point3D_ids.clear();
+
+  if (version < journal_begin_version_ || version > version_) {
+    return false;
+  }
+
+  for (size_t i = version - journal_begin_version_; i < change_journal_.size();
+       ++i) {
+    const uint64_t entry = change_journal_[i];
+    if (entry & kImageChangeBit) {
+      changes->image_ids.insert(static_cast<image_t>(entry & ~kImageChangeBit));
+    } else {
+      changes->point3D_ids.insert(static_cast<point3D_t>(entry));
+    }
+  }
+
+  return true;
+}
+
+void Reconstruction::MarkImageModified(const image_t image_id) {
+  RecordChange(kImageChangeBit | image_id);
+}
+
+void Reconstruction::MarkPoint3DModified(const point3D_t point3D_id) {
+  RecordChange(point3D_id);
+}
+
+void Reconstruction::MarkAllModified() {
+  version_ += 1;
+  journal_begin_version_ = version_;
+  change_journal_.clear();
+}
+
 void Reconstruction::Normalize(const double extent, const double p0,
                                const double p1, const bool use_images) {
   CHECK_GT(extent, 0);
@@ -335,6 +890,8 @@ void Reconstruction::Normalize(const double extent, const double p0,
     return;
   }
 
+  MarkAllModified();
+
   EIGEN_STL_UMAP(class Image*, Eigen::Vector3d) proj_centers;
 
   for (size_t i = 0; i < reg_image_ids_.size(); ++i) {
@@ -419,6 +976,7 @@ void Reconstruction::Normalize(const double extent, const double p0,
 }
 
 void Reconstruction::Transform(const SimilarityTransform3& tform) {
+  MarkAllModified();
   for (auto& image : images_) {
     tform.TransformPose(&image.second.Qvec(), &image.second.Tvec());
   }
@@ -428,36 +986,48 @@ void Reconstruction::Transform(const SimilarityTransform3& tform) {
 }
 
 bool Reconstruction::Merge(const Reconstruction& reconstruction,
-                           const double max_reproj_error) {
+                           const double max_reproj_error,
+                           const int num_threads) {
   const double kMinInlierObservations = 0.3;
 
   Eigen::Matrix3x4d alignment;
-  if (!ComputeAlignmentBetweenReconstructions(reconstruction, *this,
-                                              kMinInlierObservations,
-                                              max_reproj_error, &alignment)) {
+  if (!ComputeAlignmentBetweenReconstructions(
+          reconstruction, *this, kMinInlierObservations, max_reproj_error,
+          num_threads, &alignment)) {
     return false;
   }
 
+  Merge(reconstruction, alignment, max_reproj_error);
+
+  return true;
+}
+
+void Reconstruction::Merge(const Reconstruction& reconstruction,
+                           const Eigen::Matrix3x4d& alignment,
+                           const double max_reproj_error) {
   const SimilarityTransform3 tform(alignment);
 
-  // Find common and missing images in the two reconstructions.
+  // Find common and missing images in the two reconstructions. The images of
+  // this reconstruction are indexed by their identifier, such that every
+  // observation of the merged points requires only a single lookup.
 
-  std::unordered_set<image_t> common_image_ids;
-  common_image_ids.reserve(reconstruction.NumRegImages());
-  std::unordered_set<image_t> missing_image_ids;
-  missing_image_ids.reserve(reconstruction.NumRegImages());
+  std::unordered_map<image_t, class Image*> common_images;
+  common_images.reserve(reconstruction.NumRegImages());
+  std::unordered_map<image_t, class Image*> missing_images;
+  missing_images.reserve(reconstruction.NumRegImages());
 
   for (const auto& image_id : reconstruction.RegImageIds()) {
     if (ExistsImage(image_id)) {
-      common_image_ids.insert(image_id);
+      common_images.emplace(image_id, &Image(image_id));
     } else {
-      missing_image_ids.insert(image_id);
+      missing_images.emplace(image_id, nullptr);
     }
   }
 
   // Register the missing images in this reconstruction.
 
-  for (const auto image_id : missing_image_ids) {
+  for (auto& missing_image : missing_images) {
+    const image_t image_id = missing_image.first;
     auto reg_image = reconstruction.Image(image_id);
     reg_image.SetRegistered(false);
     AddImage(reg_image);
@@ -467,6 +1037,7 @@ bool Reconstruction::Merge(const Reconstruction& reconstruction,
     }
     auto& image = Image(image_id);
     tform.TransformPose(&image.Qvec(), &image.Tvec());
+    missing_image.second = &image;
   }
 
   // Merge the two point clouds using the following two rules:
@@ -476,45 +1047,85 @@ bool Reconstruction::Merge(const Reconstruction& reconstruction,
   //    - merge tracks that are unambiguous, i.e. only merge points in the two
   //      reconstructions if they have a one-to-one mapping.
   // Note that in both cases no cheirality or reprojection test is performed.
+  // Unambiguous tracks are directly appended to the existing point instead of
+  // creating a new point and merging it afterwards.
+
+  std::unordered_set<point3D_t> merged_point3D_ids;
+  merged_point3D_ids.reserve(reconstruction.NumPoints3D());
 
   for (const auto& point3D : reconstruction.Points3D()) {
     Track new_track;
-    Track old_track;
-    std::set<point3D_t> old_point3D_ids;
+    size_t old_track_length = 0;
+    point3D_t old_point3D_id = kInvalidPoint3DId;
+    bool ambiguous_old_point3D = false;
     for (const auto& track_el : point3D.second.Track().Elements()) {
-      if (common_image_ids.count(track_el.image_id) > 0) {
+      const auto common_image = common_images.find(track_el.image_id);
+      if (common_image != common_images.end()) {
         const auto& point2D =
-            Image(track_el.image_id).Point2D(track_el.point2D_idx);
+            common_image->second->Point2D(track_el.point2D_idx);
         if (point2D.HasPoint3D()) {
-          old_track.AddElement(track_el);
-          old_point3D_ids.insert(point2D.Point3DId());
+          old_track_length += 1;
+          if (old_point3D_id == kInvalidPoint3DId) {
+            old_point3D_id = point2D.Point3DId();
+          } else if (old_point3D_id != point2D.Point3DId()) {
+            ambiguous_old_point3D = true;
+          }
         } else {
           new_track.AddElement(track_el);
         }
-      } else if (missing_image_ids.count(track_el.image_id) > 0) {
-        Image(track_el.image_id).ResetPoint3DForPoint2D(track_el.point2D_idx);
+        continue;
+      }
+
+      const auto missing_image = missing_images.find(track_el.image_id);
+      if (missing_image != missing_images.end()) {
+        missing_image->second->ResetPoint3DForPoint2D(track_el.point2D_idx);
         new_track.AddElement(track_el);
       }
     }
 
-    const bool create_new_point = new_track.Length() >= 2;
     const bool merge_new_and_old_point =
-        (new_track.Length() + old_track.Length()) >= 2 &&
-        old_point3D_ids.size() == 1;
-    if (create_new_point || merge_new_and_old_point) {
+        (new_track.Length() + old_track_length) >= 2 &&
+        old_point3D_id != kInvalidPoint3DId && !ambiguous_old_point3D;
+    const bool create_new_point =
+        new_track.Length() >= 2 && !merge_new_and_old_point;
+
+    if (merge_new_and_old_point) {
+      if (new_track.Length() == 0) {
+        continue;
+      }
+
+      // Append the new observations to the existing point and update its
+      // position and color as the track length weighted average.
+      class Point3D& old_point3D = Point3D(old_point3D_id);
+      const double old_weight = old_point3D.Track().Length();
+      const double new_weight = new_track.Length();
       Eigen::Vector3d xyz = point3D.second.XYZ();
       tform.TransformPoint(&xyz);
-      const auto point3D_id =
-          AddPoint3D(xyz, new_track, point3D.second.Color());
-      if (old_point3D_ids.size() == 1) {
-        MergePoints3D(point3D_id, *old_point3D_ids.begin());
+      const Eigen::Vector3d merged_xyz =
+          (old_weight * old_point3D.XYZ() + new_weight * xyz) /
+          (old_weight + new_weight);
+      const Eigen::Vector3d merged_rgb =
+          (old_weight * old_point3D.Color().cast<double>() +
+           new_weight * point3D.second.Color().cast<double>()) /
+          (old_weight + new_weight);
+      old_point3D.SetXYZ(merged_xyz);
+      old_point3D.SetColor(merged_rgb.cast<uint8_t>());
+      for (const auto& track_el : new_track.Elements()) {
+        AddObservation(old_point3D_id, track_el);
       }
+      merged_point3D_ids.insert(old_point3D_id);
+    } else if (create_new_point) {
+      Eigen::Vector3d xyz = point3D.second.XYZ();
+      tform.TransformPoint(&xyz);
+      merged_point3D_ids.insert(
+          AddPoint3D(xyz, new_track, point3D.second.Color()));
     }
   }
 
-  FilterPoints3DWithLargeReprojectionError(max_reproj_error, Point3DIds());
-
-  return true;
+  // Only the merged points must be filtered, since the poses of the images and
+  // the other points of this reconstruction are not changed by the merge.
+  FilterPoints3DWithLargeReprojectionError(max_reproj_error,
+                                           merged_point3D_ids, 1);
 }
 
 bool Reconstruction::Align(const std::vector<std::string>& image_names,
@@ -621,6 +1232,136 @@ const class Image* Reconstruction::FindImageWithName(
   return nullptr;
 }
 
+std::vector<image_t> Reconstruction::FindImagesInBox(
+    const Eigen::Vector3d& bbox_min, const Eigen::Vector3d& bbox_max) const {
+  UpdateOctrees();
+  std::vector<uint64_t> ids;
+  octrees_.images.QueryBox(bbox_min, bbox_max, &ids);
+  return std::vector<image_t>(ids.begin(), ids.end());
+}
+
+std::vector<point3D_t> Reconstruction::FindPoints3DInBox(
+    const Eigen::Vector3d& bbox_min, const Eigen::Vector3d& bbox_max) const {
+  UpdateOctrees();
+  std::vector<uint64_t> ids;
+  octrees_.points3D.QueryBox(bbox_min, bbox_max, &ids);
+  return std::vector<point3D_t>(ids.begin(), ids.end());
+}
+
+std::vector<image_t> Reconstruction::FindImagesInRegion(
+    const std::vector<Eigen::Vector4d>& planes) const {
+  UpdateOctrees();
+  std::vector<uint64_t> ids;
+  octrees_.images.QueryConvexRegion(planes, &ids);
+  return std::vector<image_t>(ids.begin(), ids.end());
+}
+
+std::vector<point3D_t> Reconstruction::FindPoints3DInRegion(
+    const std::vector<Eigen::Vector4d>& planes) const {
+  UpdateOctrees();
+  std::vector<uint64_t> ids;
+  octrees_.points3D.QueryConvexRegion(planes, &ids);
+  return std::vector<point3D_t>(ids.begin(), ids.end());
+}
+
+std::vector<Eigen::Vector4d> Reconstruction::ComputeViewFrustum(
+    const image_t image_id, const double min_depth,
+    const double max_depth) const {
+  CHECK_GE(min_depth, 0);
+  CHECK_GT(max_depth, min_depth);
+
+  const class Image& image = Image(image_id);
+  const class Camera& camera = Camera(image.CameraId());
+  CHECK(image.IsRegistered());
+
+  // The rays through the corners of the image in camera space.
+  const double width = static_cast<double>(camera.Width());
+  const double height = static_cast<double>(camera.Height());
+  const std::array<Eigen::Vector2d, 4> corners = {
+      {Eigen::Vector2d(0, 0), Eigen::Vector2d(width, 0),
+       Eigen::Vector2d(width, height), Eigen::Vector2d(0, height)}};
+  std::array<Eigen::Vector3d, 4> rays;
+  for (size_t i = 0; i < corners.size(); ++i) {
+    rays[i] = camera.ImageToWorld(corners[i]).homogeneous();
+  }
+  const Eigen::Vector3d center_ray =
+      camera.ImageToWorld(Eigen::Vector2d(width / 2, height / 2)).homogeneous();
+
+  // The side planes through the camera center and two neighboring corner
+  // rays, and the near and far planes, in camera space.
+  std::vector<Eigen::Vector4d> planes;
+  planes.reserve(6);
+  for (size_t i = 0; i < rays.size(); ++i) {
+    Eigen::Vector3d normal = rays[i].cross(rays[(i + 1) % rays.size()]);
+    if (normal.dot(center_ray) < 0) {
+      normal = -normal;
+    }
+    planes.emplace_back(normal.x(), normal.y(), normal.z(), 0);
+  }
+  planes.emplace_back(0, 0, 1, -min_depth);
+  planes.emplace_back(0, 0, -1, max_depth);
+
+  // Transform the planes from camera to world space, where x_cam = R x + t.
+  const Eigen::Matrix3d R = image.RotationMatrix();
+  for (auto& plane : planes) {
+    const Eigen::Vector3d normal = plane.head<3>();
+    plane.head<3>() = R.transpose() * normal;
+    plane(3) += normal.dot(image.Tvec());
+  }
+
+  return planes;
+}
+
+Reconstruction Reconstruction::Crop(const Eigen::Vector3d& bbox_min,
+                                    const Eigen::Vector3d& bbox_max) const {
+  const std::vector<point3D_t> point3D_ids =
+      FindPoints3DInBox(bbox_min, bbox_max);
+  const std::unordered_set<point3D_t> point3D_id_set(point3D_ids.begin(),
+                                                     point3D_ids.end());
+
+  std::unordered_set<image_t> image_id_set;
+  for (const image_t image_id : FindImagesInBox(bbox_min, bbox_max)) {
+    image_id_set.insert(image_id);
+  }
+  for (const point3D_t point3D_id : point3D_ids) {
+    for (const auto& track_el : Point3D(point3D_id).Track().Elements()) {
+      image_id_set.insert(track_el.image_id);
+    }
+  }
+
+  Reconstruction cropped;
+  cropped.num_added_points3D_ = num_added_points3D_;
+
+  // Keep the order of the registered images.
+  for (const image_t image_id : reg_image_ids_) {
+    if (image_id_set.count(image_id) == 0) {
+      continue;
+    }
+
+    class Image image = Image(image_id);
+    for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
+         ++point2D_idx) {
+      const class Point2D& point2D = image.Point2D(point2D_idx);
+      if (point2D.HasPoint3D() &&
+          point3D_id_set.count(point2D.Point3DId()) == 0) {
+        image.ResetPoint3DForPoint2D(point2D_idx);
+      }
+    }
+
+    if (!cropped.ExistsCamera(image.CameraId())) {
+      cropped.cameras_.emplace(image.CameraId(), Camera(image.CameraId()));
+    }
+    cropped.reg_image_ids_.push_back(image_id);
+    cropped.images_.emplace(image_id, std::move(image));
+  }
+
+  for (const point3D_t point3D_id : point3D_ids) {
+    cropped.points3D_.emplace(point3D_id, Point3D(point3D_id));
+  }
+
+  return cropped;
+}
+
 std::vector<image_t> Reconstruction::FindCommonRegImageIds(
     const Reconstruction& reconstruction) const {
   std::vector<image_t> common_reg_image_ids;
@@ -669,18 +1410,18 @@ void Reconstruction::TranscribeImageIdsToDatabase(const Database& database) {
 
 size_t Reconstruction::FilterPoints3D(
     const double max_reproj_error, const double min_tri_angle,
-    const std::unordered_set<point3D_t>& point3D_ids) {
+    const std::unordered_set<point3D_t>& point3D_ids, const int num_threads) {
   size_t num_filtered = 0;
-  num_filtered +=
-      FilterPoints3DWithLargeReprojectionError(max_reproj_error, point3D_ids);
-  num_filtered +=
-      FilterPoints3DWithSmallTriangulationAngle(min_tri_angle, point3D_ids);
+  num_filtered += FilterPoints3DWithLargeReprojectionError(
+      max_reproj_error, point3D_ids, num_threads);
+  num_filtered += FilterPoints3DWithSmallTriangulationAngle(
+      min_tri_angle, point3D_ids, num_threads);
   return num_filtered;
 }
 
 size_t Reconstruction::FilterPoints3DInImages(
     const double max_reproj_error, const double min_tri_angle,
-    const std::unordered_set<image_t>& image_ids) {
+    const std::unordered_set<image_t>& image_ids, const int num_threads) {
   std::unordered_set<point3D_t> point3D_ids;
   for (const image_t image_id : image_ids) {
     const class Image& image = Image(image_id);
@@ -690,23 +1431,173 @@ size_t Reconstruction::FilterPoints3DInImages(
       }
     }
   }
-  return FilterPoints3D(max_reproj_error, min_tri_angle, point3D_ids);
+  return FilterPoints3D(max_reproj_error, min_tri_angle, point3D_ids,
+                        num_threads);
 }
 
 size_t Reconstruction::FilterAllPoints3D(const double max_reproj_error,
-                                         const double min_tri_angle) {
+                                         const double min_tri_angle,
+                                         const int num_threads) {
   // Important: First filter observations and points with large reprojection
   // error, so that observations with large reprojection error do not make
   // a point stable through a large triangulation angle.
   const std::unordered_set<point3D_t>& point3D_ids = Point3DIds();
   size_t num_filtered = 0;
-  num_filtered +=
-      FilterPoints3DWithLargeReprojectionError(max_reproj_error, point3D_ids);
-  num_filtered +=
-      FilterPoints3DWithSmallTriangulationAngle(min_tri_angle, point3D_ids);
+  num_filtered += FilterPoints3DWithLargeReprojectionError(
+      max_reproj_error, point3D_ids, num_threads);
+  num_filtered += FilterPoints3DWithSmallTriangulationAngle(
+      min_tri_angle, point3D_ids, num_threads);
   return num_filtered;
 }
 
+size_t Reconstruction::FilterPoints3DStatisticalOutliers(
+    const int num_neighbors, const double max_std_ratio,
+    const int num_threads) {
+  CHECK_GT(num_neighbors, 0);
+  CHECK_GE(max_std_ratio, 0);
+
+  std::vector<point3D_t> point3D_ids;
+  std::vector<Eigen::Vector3d> locations;
+  point3D_ids.reserve(points3D_.size());
+  locations.reserve(points3D_.size());
+  for (const auto& point3D : points3D_) {
+    point3D_ids.push_back(point3D.first);
+    locations.push_back(point3D.second.XYZ());
+  }
+
+  if (locations.size() <= static_cast<size_t>(num_neighbors)) {
+    return 0;
+  }
+
+  const LocationIndex location_index(locations);
+  std::vector<double> mean_distances(locations.size());
+  ParallelForChunks(
+      num_threads, locations.size(),
+      [&](const size_t, const size_t begin, const size_t end) {
+        location_index.ComputeMeanNeighborDistances(
+            begin, end, num_neighbors, &mean_distances[begin]);
+      });
+
+  double mean_distance = 0;
+  for (const double distance : mean_distances) {
+    mean_distance += distance;
+  }
+  mean_distance /= mean_distances.size();
+
+  double distance_variance = 0;
+  for (const double distance : mean_distances) {
+    distance_variance +=
+        (distance - mean_distance) * (distance - mean_distance);
+  }
+  distance_variance /= mean_distances.size();
+
+  const double max_mean_distance =
+      mean_distance + max_std_ratio * std::sqrt(distance_variance);
+
+  std::vector<point3D_t> outlier_point3D_ids;
+  for (size_t i = 0; i < point3D_ids.size(); ++i) {
+    if (mean_distances[i] > max_mean_distance) {
+      outlier_point3D_ids.push_back(point3D_ids[i]);
+    }
+  }
+
+  return DeletePoints3D(outlier_point3D_ids);
+}
+
+size_t Reconstruction::FilterPoints3DWithFewNeighbors(
+    const double radius, const int min_num_neighbors, const int num_threads) {
+  CHECK_GT(radius, 0);
+  CHECK_GE(min_num_neighbors, 0);
+
+  if (min_num_neighbors == 0 || points3D_.empty()) {
+    return 0;
+  }
+
+  std::vector<point3D_t> point3D_ids;
+  std::vector<Eigen::Vector3d> locations;
+  point3D_ids.reserve(points3D_.size());
+  locations.reserve(points3D_.size());
+  for (const auto& point3D : points3D_) {
+    point3D_ids.push_back(point3D.first);
+    locations.push_back(point3D.second.XYZ());
+  }
+
+  const LocationIndex location_index(locations);
+  std::vector<size_t> num_neighbors(locations.size());
+  ParallelForChunks(
+      num_threads, locations.size(),
+      [&](const size_t, const size_t begin, const size_t end) {
+        location_index.CountNeighbors(begin, end, radius, min_num_neighbors,
+                                      &num_neighbors[begin]);
+      });
+
+  std::vector<point3D_t> sparse_point3D_ids;
+  for (size_t i = 0; i < point3D_ids.size(); ++i) {
+    if (num_neighbors[i] < static_cast<size_t>(min_num_neighbors)) {
+      sparse_point3D_ids.push_back(point3D_ids[i]);
+    }
+  }
+
+  return DeletePoints3D(sparse_point3D_ids);
+}
+
+size_t Reconstruction::FilterPoints3DInSparseVoxels(const double voxel_size,
+                                                    const int min_num_points,
+                                                    const int num_threads) {
+  CHECK_GT(voxel_size, 0);
+  CHECK_GE(min_num_points, 0);
+
+  if (min_num_points <= 1 || points3D_.empty()) {
+    return 0;
+  }
+
+  std::vector<point3D_t> point3D_ids;
+  std::vector<const class Point3D*> points3D;
+  point3D_ids.reserve(points3D_.size());
+  points3D.reserve(points3D_.size());
+  for (const auto& point3D : points3D_) {
+    point3D_ids.push_back(point3D.first);
+    points3D.push_back(&point3D.second);
+  }
+
+  typedef std::array<int64_t, 3> Voxel;
+  struct VoxelHash {
+    size_t operator()(const Voxel& voxel) const {
+      return (static_cast<size_t>(voxel[0]) * 73856093) ^
+             (static_cast<size_t>(voxel[1]) * 19349663) ^
+             (static_cast<size_t>(voxel[2]) * 83492791);
+    }
+  };
+
+  std::vector<Voxel> voxels(points3D.size());
+  ParallelForChunks(
+      num_threads, points3D.size(),
+      [&](const size_t, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          const Eigen::Vector3d& xyz = points3D[i]->XYZ();
+          voxels[i] = {{static_cast<int64_t>(std::floor(xyz.x() / voxel_size)),
+                        static_cast<int64_t>(std::floor(xyz.y() / voxel_size)),
+                        static_cast<int64_t>(
+                            std::floor(xyz.z() / voxel_size))}};
+        }
+      });
+
+  std::unordered_map<Voxel, int, VoxelHash> voxel_num_points;
+  voxel_num_points.reserve(voxels.size());
+  for (const auto& voxel : voxels) {
+    voxel_num_points[voxel] += 1;
+  }
+
+  std::vector<point3D_t> sparse_point3D_ids;
+  for (size_t i = 0; i < point3D_ids.size(); ++i) {
+    if (voxel_num_points.at(voxels[i]) < min_num_points) {
+      sparse_point3D_ids.push_back(point3D_ids[i]);
+    }
+  }
+
+  return DeletePoints3D(sparse_point3D_ids);
+}
+
 size_t Reconstruction::FilterObservationsWithNegativeDepth() {
   size_t num_filtered = 0;
   for (const auto image_id : reg_image_ids_) {
@@ -751,6 +1642,23 @@ std::vector<image_t> Reconstruction::FilterImages(
   return filtered_image_ids;
 }
 
+size_t Reconstruction::NumBytes() const {
+  size_t num_bytes = sizeof(Reconstruction) +
+                     cameras_.size() * sizeof(class Camera) +
+                     points3D_.size() * sizeof(class Point3D) +
+                     ComputeNumObservations() * sizeof(TrackElement) +
+                     image_pair_stats_.size() *
+                         (sizeof(image_pair_t) + sizeof(ImagePairStat));
+  for (const auto& image : images_) {
+    num_bytes += image.second.NumBytes();
+  }
+  for (const auto& covisibility : image_covisibility_) {
+    num_bytes +=
+        covisibility.second.size() * (sizeof(image_t) + sizeof(size_t));
+  }
+  return num_bytes;
+}
+
 size_t Reconstruction::ComputeNumObservations() const {
   size_t num_obs = 0;
   for (const image_t image_id : reg_image_ids_) {
@@ -776,14 +1684,39 @@ double Reconstruction::ComputeMeanObservationsPerRegImage() const {
   }
 }
 
-double Reconstruction::ComputeMeanReprojectionError() const {
+double Reconstruction::ComputeMeanReprojectionError(
+    const int num_threads) const {
+  std::vector<const class Point3D*> points3D;
+  points3D.reserve(points3D_.size());
+  for (const auto& point3D : points3D_) {
+    points3D.push_back(&point3D.second);
+  }
+
+  // Sum up the errors per chunk and then combine the partial sums in order,
+  // which makes the result independent of the number of threads.
+  const size_t num_chunks = NumParallelChunks(points3D.size());
+  std::vector<double> chunk_error_sums(num_chunks, 0.0);
+  std::vector<size_t> chunk_num_valid_errors(num_chunks, 0);
+  ParallelForChunks(
+      num_threads, points3D.size(),
+      [&](const size_t chunk_idx, const size_t begin, const size_t end) {
+        double error_sum = 0.0;
+        size_t num_valid_errors = 0;
+        for (size_t i = begin; i < end; ++i) {
+          if (points3D[i]->HasError()) {
+            error_sum += points3D[i]->Error();
+            num_valid_errors += 1;
+          }
+        }
+        chunk_error_sums.at(chunk_idx) = error_sum;
+        chunk_num_valid_errors.at(chunk_idx) = num_valid_errors;
+      });
+
   double error_sum = 0.0;
   size_t num_valid_errors = 0;
-  for (const auto& point3D : points3D_) {
-    if (point3D.second.HasError()) {
-      error_sum += point3D.second.Error();
-      num_valid_errors += 1;
-    }
+  for (size_t chunk_idx = 0; chunk_idx < num_chunks; ++chunk_idx) {
+    error_sum += chunk_error_sums[chunk_idx];
+    num_valid_errors += chunk_num_valid_errors[chunk_idx];
   }
 
   if (num_valid_errors == 0) {
@@ -793,11 +1726,38 @@ double Reconstruction::ComputeMeanReprojectionError() const {
   }
 }
 
+Reconstruction::Statistics Reconstruction::ComputeStatistics(
+    const int num_threads) const {
+  Statistics statistics;
+  statistics.num_cameras = cameras_.size();
+  statistics.num_images = images_.size();
+  statistics.num_reg_images = reg_image_ids_.size();
+  statistics.num_points3D = points3D_.size();
+  statistics.num_observations = ComputeNumObservations();
+  if (statistics.num_points3D > 0) {
+    statistics.mean_track_length =
+        statistics.num_observations /
+        static_cast<double>(statistics.num_points3D);
+  }
+  if (statistics.num_reg_images > 0) {
+    statistics.mean_observations_per_reg_image =
+        statistics.num_observations /
+        static_cast<double>(statistics.num_reg_images);
+  }
+  // The only statistic that visits all points.
+  statistics.mean_reprojection_error =
+      ComputeMeanReprojectionError(num_threads);
+  return statistics;
+}
+
 void Reconstruction::Read(const std::string& path) {
   if (ExistsFile(JoinPaths(path, "cameras.bin")) &&
       ExistsFile(JoinPaths(path, "images.bin")) &&
       ExistsFile(JoinPaths(path, "points3D.bin"))) {
     ReadBinary(path);
+  } else if (ExistsFile(
+                 JoinPaths(path, ChunkedReconstructionReader::kFileName))) {
+    ReadChunked(path);
   } else if (ExistsFile(JoinPaths(path, "cameras.txt")) &&
              ExistsFile(JoinPaths(path, "images.txt")) &&
              ExistsFile(JoinPaths(path, "points3D.txt"))) {
@@ -809,22 +1769,26 @@ void Reconstruction::Read(const std::string& path) {
 
 void Reconstruction::Write(const std::string& path) const { WriteBinary(path); }
 
-void Reconstruction::ReadText(const std::string& path) {
+void Reconstruction::ReadText(const std::string& path,
+                              const int num_threads) {
+  MarkAllModified();
   ReadCamerasText(JoinPaths(path, "cameras.txt"));
-  ReadImagesText(JoinPaths(path, "images.txt"));
-  ReadPoints3DText(JoinPaths(path, "points3D.txt"));
+  ReadImagesText(JoinPaths(path, "images.txt"), num_threads);
+  ReadPoints3DText(JoinPaths(path, "points3D.txt"), num_threads);
 }
 
 void Reconstruction::ReadBinary(const std::string& path) {
+  MarkAllModified();
   ReadCamerasBinary(JoinPaths(path, "cameras.bin"));
   ReadImagesBinary(JoinPaths(path, "images.bin"));
   ReadPoints3DBinary(JoinPaths(path, "points3D.bin"));
 }
 
-void Reconstruction::WriteText(const std::string& path) const {
+void Reconstruction::WriteText(const std::string& path,
+                               const int num_threads) const {
   WriteCamerasText(JoinPaths(path, "cameras.txt"));
-  WriteImagesText(JoinPaths(path, "images.txt"));
-  WritePoints3DText(JoinPaths(path, "points3D.txt"));
+  WriteImagesText(JoinPaths(path, "images.txt"), num_threads);
+  WritePoints3DText(JoinPaths(path, "points3D.txt"), num_threads);
 }
 
 void Reconstruction::WriteBinary(const std::string& path) const {
@@ -833,9 +1797,49 @@ void Reconstruction::WriteBinary(const std::string& path) const {
   WritePoints3DBinary(JoinPaths(path, "points3D.bin"));
 }
 
-std::vector<PlyPoint> Reconstruction::ConvertToPLY() const {
-  std::vector<PlyPoint> ply_points;
-  ply_points.reserve(points3D_.size());
+void Reconstruction::ReadChunked(const std::string& path) {
+  MarkAllModified();
+  const ChunkedReconstructionReader reader(
+      JoinPaths(path, ChunkedReconstructionReader::kFileName));
+
+  for (const auto& camera : reader.ReadCameras()) {
+    cameras_.emplace(camera.first, camera.second);
+  }
+
+  for (auto& image : reader.ReadImages(/*with_points2D=*/true)) {
+    image.second.SetUp(Camera(image.second.CameraId()));
+    image.second.SetRegistered(true);
+    reg_image_ids_.push_back(image.first);
+    images_.emplace(image.first, std::move(image.second));
+  }
+  std::sort(reg_image_ids_.begin(), reg_image_ids_.end());
+
+  points3D_.reserve(reader.NumPoints3D());
+  std::unordered_map<point3D_t, class Point3D> chunk_points3D;
+  for (size_t chunk_idx = 0; chunk_idx < reader.Chunks().size(); ++chunk_idx) {
+    if (reader.Chunks()[chunk_idx].type !=
+        ChunkedReconstructionReader::ChunkType::POINTS3D) {
+      continue;
+    }
+    chunk_points3D.clear();
+    reader.ReadPoints3DChunk(chunk_idx, &chunk_points3D);
+    for (auto& point3D : chunk_points3D) {
+      num_added_points3D_ = std::max(num_added_points3D_, point3D.first);
+      points3D_.emplace(point3D.first, std::move(point3D.second));
+    }
+  }
+}
+
+void Reconstruction::WriteChunked(
+    const std::string& path,
+    const ChunkedReconstructionOptions& options) const {
+  WriteChunkedReconstruction(
+      *this, JoinPaths(path, ChunkedReconstructionReader::kFileName), options);
+}
+
+std::vector<PlyPoint> Reconstruction::ConvertToPLY() const {
+  std::vector<PlyPoint> ply_points;
+  ply_points.reserve(points3D_.size());
 
   for (const auto& point3D : points3D_) {
     PlyPoint ply_point;
@@ -852,6 +1856,7 @@ std::vector<PlyPoint> Reconstruction::ConvertToPLY() const {
 }
 
 void Reconstruction::ImportPLY(const std::string& path) {
+  MarkAllModified();
   points3D_.clear();
 
   const auto ply_points = ReadPly(path);
@@ -864,7 +1869,8 @@ void Reconstruction::ImportPLY(const std::string& path) {
   }
 }
 
-bool Reconstruction::ExportNVM(const std::string& path) const {
+bool Reconstruction::ExportNVM(const std::string& path,
+                               const int num_threads) const {
   std::ofstream file(path, std::ios::trunc);
   CHECK(file.is_open()) << path;
 
@@ -872,11 +1878,11 @@ bool Reconstruction::ExportNVM(const std::string& path) const {
   file << "NVM_V3 " << std::endl << " " << std::endl;
   file << reg_image_ids_.size() << "  " << std::endl;
 
-  std::unordered_map<image_t, size_t> image_id_to_idx_;
-  size_t image_idx = 0;
+  std::unordered_map<image_t, size_t> image_id_to_idx;
+  image_id_to_idx.reserve(reg_image_ids_.size());
 
-  for (const auto image_id : reg_image_ids_) {
-    const class Image& image = Image(image_id);
+  for (size_t image_idx = 0; image_idx < reg_image_ids_.size(); ++image_idx) {
+    const class Image& image = Image(reg_image_ids_[image_idx]);
     const class Camera& camera = Camera(image.CameraId());
 
     if (camera.ModelId() != SimpleRadialCameraModel::model_id) {
@@ -885,67 +1891,93 @@ bool Reconstruction::ExportNVM(const std::string& path) const {
       return false;
     }
 
-    const double f =
-        camera.Params(SimpleRadialCameraModel::focal_length_idxs[0]);
-    const double k =
-        -1 * camera.Params(SimpleRadialCameraModel::extra_params_idxs[0]);
-    const Eigen::Vector3d proj_center = image.ProjectionCenter();
+    image_id_to_idx.emplace(image.ImageId(), image_idx);
+  }
 
-    file << image.Name() << " ";
-    file << f << " ";
-    file << image.Qvec(0) << " ";
-    file << image.Qvec(1) << " ";
-    file << image.Qvec(2) << " ";
-    file << image.Qvec(3) << " ";
-    file << proj_center(0) << " ";
-    file << proj_center(1) << " ";
-    file << proj_center(2) << " ";
-    file << k << " ";
-    file << 0 << std::endl;
+  const size_t kNumImagesPerChunk = 256;
+  WriteTextLinesInParallel(
+      num_threads, reg_image_ids_.size(), kNumImagesPerChunk,
+      [&](const size_t i, std::string* lines) {
+        const class Image& image = Image(reg_image_ids_[i]);
+        const class Camera& camera = Camera(image.CameraId());
 
-    image_id_to_idx_[image_id] = image_idx;
-    image_idx += 1;
-  }
+        const double f =
+            camera.Params(SimpleRadialCameraModel::focal_length_idxs[0]);
+        const double k =
+            -1 * camera.Params(SimpleRadialCameraModel::extra_params_idxs[0]);
+        const Eigen::Vector3d proj_center = image.ProjectionCenter();
 
-  file << std::endl << points3D_.size() << std::endl;
+        *lines += image.Name();
+        *lines += ' ';
+        AppendDouble(f, lines, kExportTextPrecision);
+        for (int d = 0; d < 4; ++d) {
+          *lines += ' ';
+          AppendDouble(image.Qvec(d), lines, kExportTextPrecision);
+        }
+        for (int d = 0; d < 3; ++d) {
+          *lines += ' ';
+          AppendDouble(proj_center(d), lines, kExportTextPrecision);
+        }
+        *lines += ' ';
+        AppendDouble(k, lines, kExportTextPrecision);
+        *lines += " 0\n";
+      },
+      &file);
 
-  for (const auto& point3D : points3D_) {
-    file << point3D.second.XYZ()(0) << " ";
-    file << point3D.second.XYZ()(1) << " ";
-    file << point3D.second.XYZ()(2) << " ";
-    file << static_cast<int>(point3D.second.Color(0)) << " ";
-    file << static_cast<int>(point3D.second.Color(1)) << " ";
-    file << static_cast<int>(point3D.second.Color(2)) << " ";
+  file << std::endl << points3D_.size() << std::endl;
 
-    std::ostringstream line;
+  WritePoint3DLinesInParallel(
+      num_threads, points3D_,
+      [&](const point3D_t, const class Point3D& point3D, std::string* lines) {
+        for (int d = 0; d < 3; ++d) {
+          AppendDouble(point3D.XYZ(d), lines, kExportTextPrecision);
+          *lines += ' ';
+        }
+        for (int d = 0; d < 3; ++d) {
+          AppendInteger(static_cast<int>(point3D.Color(d)), lines);
+          *lines += ' ';
+        }
 
-    std::unordered_set<image_t> image_ids;
-    for (const auto& track_el : point3D.second.Track().Elements()) {
-      // Make sure that each point only has a single observation per image,
-      // since VisualSfM does not support with multiple observations.
-      if (image_ids.count(track_el.image_id) == 0) {
-        const class Image& image = Image(track_el.image_id);
-        const Point2D& point2D = image.Point2D(track_el.point2D_idx);
-        line << image_id_to_idx_[track_el.image_id] << " ";
-        line << track_el.point2D_idx << " ";
-        line << point2D.X() << " ";
-        line << point2D.Y() << " ";
-        image_ids.insert(track_el.image_id);
-      }
-    }
+        // Make sure that each point only has a single observation per image,
+        // since VisualSfM does not support with multiple observations.
+        std::vector<const TrackElement*> track_els;
+        track_els.reserve(point3D.Track().Length());
+        std::unordered_set<image_t> image_ids;
+        for (const auto& track_el : point3D.Track().Elements()) {
+          if (image_ids.insert(track_el.image_id).second) {
+            track_els.push_back(&track_el);
+          }
+        }
 
-    std::string line_string = line.str();
-    line_string = line_string.substr(0, line_string.size() - 1);
+        AppendInteger(track_els.size(), lines);
+        *lines += ' ';
 
-    file << image_ids.size() << " ";
-    file << line_string << std::endl;
-  }
+        bool is_first = true;
+        for (const TrackElement* track_el : track_els) {
+          if (!is_first) {
+            *lines += ' ';
+          }
+          is_first = false;
+          const class Image& image = Image(track_el->image_id);
+          const Point2D& point2D = image.Point2D(track_el->point2D_idx);
+          AppendInteger(image_id_to_idx.at(track_el->image_id), lines);
+          *lines += ' ';
+          AppendInteger(track_el->point2D_idx, lines);
+          *lines += ' ';
+          AppendDouble(point2D.X(), lines, kExportTextPrecision);
+          *lines += ' ';
+          AppendDouble(point2D.Y(), lines, kExportTextPrecision);
+        }
+        *lines += '\n';
+      },
+      &file);
 
   return true;
 }
 
 bool Reconstruction::ExportBundler(const std::string& path,
-                                   const std::string& list_path) const {
+                                   const std::string& list_path,
+                                   const int num_threads) const {
   std::ofstream file(path, std::ios::trunc);
   CHECK(file.is_open()) << path;
 
@@ -956,29 +1988,30 @@ bool Reconstruction::ExportBundler(const std::string& path,
 
   file << reg_image_ids_.size() << " " << points3D_.size() << std::endl;
 
-  std::unordered_map<image_t, size_t> image_id_to_idx_;
-  size_t image_idx = 0;
+  std::unordered_map<image_t, size_t> image_id_to_idx;
+  image_id_to_idx.reserve(reg_image_ids_.size());
 
-  for (const image_t image_id : reg_image_ids_) {
-    const class Image& image = Image(image_id);
+  // The focal length and the two radial distortion parameters of the images.
+  std::vector<Eigen::Vector3d> camera_params(reg_image_ids_.size());
+
+  std::string list_lines;
+  for (size_t image_idx = 0; image_idx < reg_image_ids_.size(); ++image_idx) {
+    const class Image& image = Image(reg_image_ids_[image_idx]);
     const class Camera& camera = Camera(image.CameraId());
 
-    double f;
-    double k1;
-    double k2;
     if (camera.ModelId() == SimplePinholeCameraModel::model_id ||
         camera.ModelId() == PinholeCameraModel::model_id) {
-      f = camera.MeanFocalLength();
-      k1 = 0.0;
-      k2 = 0.0;
+      camera_params[image_idx] =
+          Eigen::Vector3d(camera.MeanFocalLength(), 0.0, 0.0);
     } else if (camera.ModelId() == SimpleRadialCameraModel::model_id) {
-      f = camera.Params(SimpleRadialCameraModel::focal_length_idxs[0]);
-      k1 = camera.Params(SimpleRadialCameraModel::extra_params_idxs[0]);
-      k2 = 0.0;
+      camera_params[image_idx] = Eigen::Vector3d(
+          camera.Params(SimpleRadialCameraModel::focal_length_idxs[0]),
+          camera.Params(SimpleRadialCameraModel::extra_params_idxs[0]), 0.0);
     } else if (camera.ModelId() == RadialCameraModel::model_id) {
-      f = camera.Params(RadialCameraModel::focal_length_idxs[0]);
-      k1 = camera.Params(RadialCameraModel::extra_params_idxs[0]);
-      k2 = camera.Params(RadialCameraModel::extra_params_idxs[1]);
+      camera_params[image_idx] = Eigen::Vector3d(
+          camera.Params(RadialCameraModel::focal_length_idxs[0]),
+          camera.Params(RadialCameraModel::extra_params_idxs[0]),
+          camera.Params(RadialCameraModel::extra_params_idxs[1]));
     } else {
       std::cout << "WARNING: Bundler only supports `SIMPLE_RADIAL` and "
                    "`RADIAL` camera models."
@@ -986,59 +2019,96 @@ bool Reconstruction::ExportBundler(const std::string& path,
       return false;
     }
 
-    file << f << " " << k1 << " " << k2 << std::endl;
-
-    const Eigen::Matrix3d R = image.RotationMatrix();
-    file << R(0, 0) << " " << R(0, 1) << " " << R(0, 2) << std::endl;
-    file << -R(1, 0) << " " << -R(1, 1) << " " << -R(1, 2) << std::endl;
-    file << -R(2, 0) << " " << -R(2, 1) << " " << -R(2, 2) << std::endl;
-
-    file << image.Tvec(0) << " ";
-    file << -image.Tvec(1) << " ";
-    file << -image.Tvec(2) << std::endl;
+    list_lines += image.Name();
+    list_lines += '\n';
 
-    list_file << image.Name() << std::endl;
-
-    image_id_to_idx_[image_id] = image_idx;
-    image_idx += 1;
+    image_id_to_idx.emplace(image.ImageId(), image_idx);
   }
 
-  for (const auto& point3D : points3D_) {
-    file << point3D.second.XYZ()(0) << " ";
-    file << point3D.second.XYZ()(1) << " ";
-    file << point3D.second.XYZ()(2) << std::endl;
-
-    file << static_cast<int>(point3D.second.Color(0)) << " ";
-    file << static_cast<int>(point3D.second.Color(1)) << " ";
-    file << static_cast<int>(point3D.second.Color(2)) << std::endl;
+  list_file.write(list_lines.data(), list_lines.size());
 
-    std::ostringstream line;
-
-    line << point3D.second.Track().Length() << " ";
-
-    for (const auto& track_el : point3D.second.Track().Elements()) {
-      const class Image& image = Image(track_el.image_id);
-      const class Camera& camera = Camera(image.CameraId());
+  const size_t kNumImagesPerChunk = 256;
+  WriteTextLinesInParallel(
+      num_threads, reg_image_ids_.size(), kNumImagesPerChunk,
+      [&](const size_t i, std::string* lines) {
+        const class Image& image = Image(reg_image_ids_[i]);
 
-      // Bundler output assumes image coordinate system origin
-      // in the lower left corner of the image with the center of
-      // the lower left pixel being (0, 0). Our coordinate system
-      // starts in the upper left corner with the center of the
-      // upper left pixel being (0.5, 0.5).
-
-      const Point2D& point2D = image.Point2D(track_el.point2D_idx);
-
-      line << image_id_to_idx_.at(track_el.image_id) << " ";
-      line << track_el.point2D_idx << " ";
-      line << point2D.X() - camera.PrincipalPointX() << " ";
-      line << camera.PrincipalPointY() - point2D.Y() << " ";
-    }
+        for (int d = 0; d < 3; ++d) {
+          if (d > 0) {
+            *lines += ' ';
+          }
+          AppendDouble(camera_params[i](d), lines, kExportTextPrecision);
+        }
+        *lines += '\n';
+
+        const Eigen::Matrix3d R = image.RotationMatrix();
+        for (int r = 0; r < 3; ++r) {
+          for (int c = 0; c < 3; ++c) {
+            if (c > 0) {
+              *lines += ' ';
+            }
+            AppendDouble(r == 0 ? R(r, c) : -R(r, c), lines,
+                         kExportTextPrecision);
+          }
+          *lines += '\n';
+        }
 
-    std::string line_string = line.str();
-    line_string = line_string.substr(0, line_string.size() - 1);
+        AppendDouble(image.Tvec(0), lines, kExportTextPrecision);
+        *lines += ' ';
+        AppendDouble(-image.Tvec(1), lines, kExportTextPrecision);
+        *lines += ' ';
+        AppendDouble(-image.Tvec(2), lines, kExportTextPrecision);
+        *lines += '\n';
+      },
+      &file);
+
+  WritePoint3DLinesInParallel(
+      num_threads, points3D_,
+      [&](const point3D_t, const class Point3D& point3D, std::string* lines) {
+        for (int d = 0; d < 3; ++d) {
+          if (d > 0) {
+            *lines += ' ';
+          }
+          AppendDouble(point3D.XYZ(d), lines, kExportTextPrecision);
+        }
+        *lines += '\n';
 
-    file << line_string << std::endl;
-  }
+        for (int d = 0; d < 3; ++d) {
+          if (d > 0) {
+            *lines += ' ';
+          }
+          AppendInteger(static_cast<int>(point3D.Color(d)), lines);
+        }
+        *lines += '\n';
+
+        AppendInteger(point3D.Track().Length(), lines);
+
+        for (const auto& track_el : point3D.Track().Elements()) {
+          const class Image& image = Image(track_el.image_id);
+          const class Camera& camera = Camera(image.CameraId());
+
+          // Bundler output assumes image coordinate system origin
+          // in the lower left corner of the image with the center of
+          // the lower left pixel being (0, 0). Our coordinate system
+          // starts in the upper left corner with the center of the
+          // upper left pixel being (0.5, 0.5).
+
+          const Point2D& point2D = image.Point2D(track_el.point2D_idx);
+
+          *lines += ' ';
+          AppendInteger(image_id_to_idx.at(track_el.image_id), lines);
+          *lines += ' ';
+          AppendInteger(track_el.point2D_idx, lines);
+          *lines += ' ';
+          AppendDouble(point2D.X() - camera.PrincipalPointX(), lines,
+                       kExportTextPrecision);
+          *lines += ' ';
+          AppendDouble(camera.PrincipalPointY() - point2D.Y(), lines,
+                       kExportTextPrecision);
+        }
+        *lines += '\n';
+      },
+      &file);
 
   return true;
 }
@@ -1054,7 +2124,8 @@ void Reconstruction::ExportPLY(const std::string& path) const {
 void Reconstruction::ExportVRML(const std::string& images_path,
                                 const std::string& points3D_path,
                                 const double image_scale,
-                                const Eigen::Vector3d& image_rgb) const {
+                                const Eigen::Vector3d& image_rgb,
+                                const int num_threads) const {
   std::ofstream images_file(images_path, std::ios::trunc);
   CHECK(images_file.is_open()) << images_path;
 
@@ -1072,69 +2143,89 @@ void Reconstruction::ExportVRML(const std::string& images_path,
   points.emplace_back(+six / 3.0, +siy / 3.0, six * 1.0 * 2.0);
   points.emplace_back(-six / 3.0, +siy / 3.0, six * 1.0 * 2.0);
 
-  for (const auto& image : images_) {
-    if (!image.second.IsRegistered()) {
-      continue;
-    }
-
-    images_file << "Shape{\n";
-    images_file << " appearance Appearance {\n";
-    images_file << "  material DEF Default-ffRffGffB Material {\n";
-    images_file << "  ambientIntensity 0\n";
-    images_file << "  diffuseColor "
-                << " " << image_rgb(0) << " " << image_rgb(1) << " "
-                << image_rgb(2) << "\n";
-    images_file << "  emissiveColor 0.1 0.1 0.1 } }\n";
-    images_file << " geometry IndexedFaceSet {\n";
-    images_file << " solid FALSE \n";
-    images_file << " colorPerVertex TRUE \n";
-    images_file << " ccw TRUE \n";
-
-    images_file << " coord Coordinate {\n";
-    images_file << " point [\n";
-
-    Eigen::Transform<double, 3, Eigen::Affine> transform;
-    transform.matrix().topLeftCorner<3, 4>() =
-        image.second.InverseProjectionMatrix();
-
-    // Move camera base model to camera pose.
-    for (size_t i = 0; i < points.size(); i++) {
-      const Eigen::Vector3d point = transform * points[i];
-      images_file << point(0) << " " << point(1) << " " << point(2) << "\n";
-    }
-
-    images_file << " ] }\n";
-
-    images_file << "color Color {color [\n";
-    for (size_t p = 0; p < points.size(); p++) {
-      images_file << " " << image_rgb(0) << " " << image_rgb(1) << " "
-                  << image_rgb(2) << "\n";
-    }
+  std::string image_rgb_text;
+  for (int d = 0; d < 3; ++d) {
+    image_rgb_text += ' ';
+    AppendDouble(image_rgb(d), &image_rgb_text, kExportTextPrecision);
+  }
 
-    images_file << "\n] }\n";
+  std::vector<const class Image*> images;
+  images.reserve(reg_image_ids_.size());
+  for (const auto& image : images_) {
+    if (image.second.IsRegistered()) {
+      images.push_back(&image.second);
+    }
+  }
+
+  const size_t kNumImagesPerChunk = 64;
+  WriteTextLinesInParallel(
+      num_threads, images.size(), kNumImagesPerChunk,
+      [&](const size_t i, std::string* lines) {
+        *lines += "Shape{\n";
+        *lines += " appearance Appearance {\n";
+        *lines += "  material DEF Default-ffRffGffB Material {\n";
+        *lines += "  ambientIntensity 0\n";
+        *lines += "  diffuseColor ";
+        *lines += image_rgb_text;
+        *lines += '\n';
+        *lines += "  emissiveColor 0.1 0.1 0.1 } }\n";
+        *lines += " geometry IndexedFaceSet {\n";
+        *lines += " solid FALSE \n";
+        *lines += " colorPerVertex TRUE \n";
+        *lines += " ccw TRUE \n";
+
+        *lines += " coord Coordinate {\n";
+        *lines += " point [\n";
+
+        Eigen::Transform<double, 3, Eigen::Affine> transform;
+        transform.matrix().topLeftCorner<3, 4>() =
+            images[i]->InverseProjectionMatrix();
+
+        // Move camera base model to camera pose.
+        for (size_t j = 0; j < points.size(); j++) {
+          const Eigen::Vector3d point = transform * points[j];
+          for (int d = 0; d < 3; ++d) {
+            if (d > 0) {
+              *lines += ' ';
+            }
+            AppendDouble(point(d), lines, kExportTextPrecision);
+          }
+          *lines += '\n';
+        }
 
-    images_file << "coordIndex [\n";
-    images_file << " 0, 1, 2, 3, -1\n";
-    images_file << " 5, 6, 4, -1\n";
-    images_file << " 6, 7, 4, -1\n";
-    images_file << " 7, 8, 4, -1\n";
-    images_file << " 8, 5, 4, -1\n";
-    images_file << " \n] \n";
+        *lines += " ] }\n";
 
-    images_file << " texCoord TextureCoordinate { point [\n";
-    images_file << "  1 1,\n";
-    images_file << "  0 1,\n";
-    images_file << "  0 0,\n";
-    images_file << "  1 0,\n";
-    images_file << "  0 0,\n";
-    images_file << "  0 0,\n";
-    images_file << "  0 0,\n";
-    images_file << "  0 0,\n";
-    images_file << "  0 0,\n";
+        *lines += "color Color {color [\n";
+        for (size_t j = 0; j < points.size(); j++) {
+          *lines += image_rgb_text;
+          *lines += '\n';
+        }
 
-    images_file << " ] }\n";
-    images_file << "} }\n";
-  }
+        *lines += "\n] }\n";
+
+        *lines += "coordIndex [\n";
+        *lines += " 0, 1, 2, 3, -1\n";
+        *lines += " 5, 6, 4, -1\n";
+        *lines += " 6, 7, 4, -1\n";
+        *lines += " 7, 8, 4, -1\n";
+        *lines += " 8, 5, 4, -1\n";
+        *lines += " \n] \n";
+
+        *lines += " texCoord TextureCoordinate { point [\n";
+        *lines += "  1 1,\n";
+        *lines += "  0 1,\n";
+        *lines += "  0 0,\n";
+        *lines += "  1 0,\n";
+        *lines += "  0 0,\n";
+        *lines += "  0 0,\n";
+        *lines += "  0 0,\n";
+        *lines += "  0 0,\n";
+        *lines += "  0 0,\n";
+
+        *lines += " ] }\n";
+        *lines += "} }\n";
+      },
+      &images_file);
 
   // Write 3D points
 
@@ -1149,20 +2240,34 @@ void Reconstruction::ExportVRML(const std::string& images_path,
   points3D_file << " coord Coordinate {\n";
   points3D_file << "  point [\n";
 
-  for (const auto& point3D : points3D_) {
-    points3D_file << point3D.second.XYZ()(0) << ", ";
-    points3D_file << point3D.second.XYZ()(1) << ", ";
-    points3D_file << point3D.second.XYZ()(2) << std::endl;
-  }
+  WritePoint3DLinesInParallel(
+      num_threads, points3D_,
+      [](const point3D_t, const class Point3D& point3D, std::string* lines) {
+        for (int d = 0; d < 3; ++d) {
+          if (d > 0) {
+            *lines += ", ";
+          }
+          AppendDouble(point3D.XYZ(d), lines, kExportTextPrecision);
+        }
+        *lines += '\n';
+      },
+      &points3D_file);
 
   points3D_file << " ] }\n";
   points3D_file << " color Color { color [\n";
 
-  for (const auto& point3D : points3D_) {
-    points3D_file << point3D.second.Color(0) / 255.0 << ", ";
-    points3D_file << point3D.second.Color(1) / 255.0 << ", ";
-    points3D_file << point3D.second.Color(2) / 255.0 << std::endl;
-  }
+  WritePoint3DLinesInParallel(
+      num_threads, points3D_,
+      [](const point3D_t, const class Point3D& point3D, std::string* lines) {
+        for (int d = 0; d < 3; ++d) {
+          if (d > 0) {
+            *lines += ", ";
+          }
+          AppendDouble(point3D.Color(d) / 255.0, lines, kExportTextPrecision);
+        }
+        *lines += '\n';
+      },
+      &points3D_file);
 
   points3D_file << " ] } } }\n";
 }
@@ -1188,6 +2293,7 @@ bool Reconstruction::ExtractColorsForImage(const image_t image_id,
           const BitmapColor<uint8_t> color_ub = color.Cast<uint8_t>();
           point3D.SetColor(
               Eigen::Vector3ub(color_ub.r, color_ub.g, color_ub.b));
+          MarkPoint3DModified(point2D.Point3DId());
         }
       }
     }
@@ -1196,12 +2302,18 @@ bool Reconstruction::ExtractColorsForImage(const image_t image_id,
   return true;
 }
 
-void Reconstruction::ExtractColorsForAllImages(const std::string& path) {
-  EIGEN_STL_UMAP(point3D_t, Eigen::Vector3d) color_sums;
-  std::unordered_map<point3D_t, size_t> color_counts;
+void Reconstruction::ExtractColorsForAllImages(const std::string& path,
+                                               const int num_threads) {
+  typedef std::vector<std::pair<point3D_t, BitmapColor<float>>> ColorSamples;
 
-  for (size_t i = 0; i < reg_image_ids_.size(); ++i) {
-    const class Image& image = Image(reg_image_ids_[i]);
+  // Read the image and sample the colors of its observations. Only a bounded
+  // number of images is read concurrently and the samples of the images are
+  // accumulated in the order of the images, so that the mean colors are the
+  // same as for sequential extraction.
+  const auto SampleColors = [this, &path](const size_t reg_image_idx) {
+    ColorSamples color_samples;
+
+    const class Image& image = Image(reg_image_ids_[reg_image_idx]);
     const std::string image_path = JoinPaths(path, image.Name());
 
     Bitmap bitmap;
@@ -1209,31 +2321,74 @@ void Reconstruction::ExtractColorsForAllImages(const std::string& path) {
       std::cout << StringPrintf("Could not read image %s at path %s.",
                                 image.Name().c_str(), image_path.c_str())
                 << std::endl;
-      continue;
+      return color_samples;
     }
 
-    for (const Point2D point2D : image.Points2D()) {
+    color_samples.reserve(image.NumPoints3D());
+    for (const Point2D& point2D : image.Points2D()) {
       if (point2D.HasPoint3D()) {
         BitmapColor<float> color;
         // COLMAP assumes that the upper left pixel center is (0.5, 0.5).
         if (bitmap.InterpolateBilinear(point2D.X() - 0.5, point2D.Y() - 0.5,
                                        &color)) {
-          if (color_sums.count(point2D.Point3DId())) {
-            Eigen::Vector3d& color_sum = color_sums[point2D.Point3DId()];
-            color_sum(0) += color.r;
-            color_sum(1) += color.g;
-            color_sum(2) += color.b;
-            color_counts[point2D.Point3DId()] += 1;
-          } else {
-            color_sums.emplace(point2D.Point3DId(),
-                               Eigen::Vector3d(color.r, color.g, color.b));
-            color_counts.emplace(point2D.Point3DId(), 1);
-          }
+          color_samples.emplace_back(point2D.Point3DId(), color);
         }
       }
     }
+
+    return color_samples;
+  };
+
+  EIGEN_STL_UMAP(point3D_t, Eigen::Vector3d) color_sums;
+  std::unordered_map<point3D_t, size_t> color_counts;
+  color_sums.reserve(points3D_.size());
+  color_counts.reserve(points3D_.size());
+
+  const auto AccumulateColors = [&](const ColorSamples& color_samples) {
+    for (const auto& color_sample : color_samples) {
+      const BitmapColor<float>& color = color_sample.second;
+      auto color_sum = color_sums.find(color_sample.first);
+      if (color_sum == color_sums.end()) {
+        color_sums.emplace(color_sample.first,
+                           Eigen::Vector3d(color.r, color.g, color.b));
+        color_counts.emplace(color_sample.first, 1);
+      } else {
+        color_sum->second(0) += color.r;
+        color_sum->second(1) += color.g;
+        color_sum->second(2) += color.b;
+        color_counts[color_sample.first] += 1;
+      }
+    }
+  };
+
+  const int num_eff_threads =
+      std::min(GetEffectiveNumThreads(num_threads),
+               static_cast<int>(std::max<size_t>(reg_image_ids_.size(), 1)));
+
+  if (num_eff_threads == 1) {
+    for (size_t i = 0; i < reg_image_ids_.size(); ++i) {
+      AccumulateColors(SampleColors(i));
+    }
+  } else {
+    ThreadPool thread_pool(num_eff_threads);
+    const size_t max_num_pending_images = 2 * num_eff_threads;
+    std::deque<std::future<ColorSamples>> pending_images;
+    for (size_t i = 0; i < reg_image_ids_.size(); ++i) {
+      pending_images.push_back(thread_pool.AddTask(SampleColors, i));
+      if (pending_images.size() == max_num_pending_images) {
+        AccumulateColors(pending_images.front().get());
+        pending_images.pop_front();
+      }
+    }
+
+    while (!pending_images.empty()) {
+      AccumulateColors(pending_images.front().get());
+      pending_images.pop_front();
+    }
   }
 
+  MarkAllModified();
+
   const Eigen::Vector3ub kBlackColor = Eigen::Vector3ub::Zero();
   for (auto& point3D : points3D_) {
     if (color_sums.count(point3D.first)) {
@@ -1267,62 +2422,91 @@ void Reconstruction::CreateImageDirs(const std::string& path) const {
   }
 }
 
+size_t Reconstruction::DeletePoints3D(
+    const std::vector<point3D_t>& point3D_ids) {
+  size_t num_filtered = 0;
+  for (const point3D_t point3D_id : point3D_ids) {
+    num_filtered += Point3D(point3D_id).Track().Length();
+    DeletePoint3D(point3D_id);
+  }
+  return num_filtered;
+}
+
 size_t Reconstruction::FilterPoints3DWithSmallTriangulationAngle(
     const double min_tri_angle,
-    const std::unordered_set<point3D_t>& point3D_ids) {
+    const std::unordered_set<point3D_t>& point3D_ids, const int num_threads) {
   // Number of filtered points.
   size_t num_filtered = 0;
 
   // Minimum triangulation angle in radians.
   const double min_tri_angle_rad = DegToRad(min_tri_angle);
 
-  // Cache for image projection centers.
+  // Cache for image projection centers, which is filled up-front so that it
+  // can be shared by all threads without synchronization.
   EIGEN_STL_UMAP(image_t, Eigen::Vector3d) proj_centers;
+  proj_centers.reserve(reg_image_ids_.size());
+  for (const image_t image_id : reg_image_ids_) {
+    proj_centers.emplace(image_id, Image(image_id).ProjectionCenter());
+  }
 
+  std::vector<point3D_t> point3D_ids_vec;
+  point3D_ids_vec.reserve(point3D_ids.size());
   for (const auto point3D_id : point3D_ids) {
-    if (!ExistsPoint3D(point3D_id)) {
-      continue;
-    }
-
-    const class Point3D& point3D = Point3D(point3D_id);
-
-    // Calculate triangulation angle for all pairwise combinations of image
-    // poses in the track. Only delete point if none of the combinations
-    // has a sufficient triangulation angle.
-    bool keep_point = false;
-    for (size_t i1 = 0; i1 < point3D.Track().Length(); ++i1) {
-      const image_t image_id1 = point3D.Track().Element(i1).image_id;
-
-      Eigen::Vector3d proj_center1;
-      if (proj_centers.count(image_id1) == 0) {
-        const class Image& image1 = Image(image_id1);
-        proj_center1 = image1.ProjectionCenter();
-        proj_centers.emplace(image_id1, proj_center1);
-      } else {
-        proj_center1 = proj_centers.at(image_id1);
-      }
-
-      for (size_t i2 = 0; i2 < i1; ++i2) {
-        const image_t image_id2 = point3D.Track().Element(i2).image_id;
-        const Eigen::Vector3d proj_center2 = proj_centers.at(image_id2);
+    if (ExistsPoint3D(point3D_id)) {
+      point3D_ids_vec.push_back(point3D_id);
+    }
+  }
+
+  // Evaluate the points in parallel. Deleting a point does not affect the
+  // evaluation of any other point, so the deletion can be deferred.
+  std::vector<char> keep_points(point3D_ids_vec.size(), 0);
+  ParallelForChunks(
+      num_threads, point3D_ids_vec.size(),
+      [&](const size_t, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          const class Point3D& point3D = Point3D(point3D_ids_vec[i]);
+          const TrackElements& track_els = point3D.Track().Elements();
+
+          std::vector<Eigen::Vector3d> track_proj_centers;
+          track_proj_centers.reserve(track_els.size());
+          for (const auto& track_el : track_els) {
+            const auto proj_center = proj_centers.find(track_el.image_id);
+            if (proj_center == proj_centers.end()) {
+              track_proj_centers.push_back(
+                  Image(track_el.image_id).ProjectionCenter());
+            } else {
+              track_proj_centers.push_back(proj_center->second);
+            }
+          }
 
-        const double tri_angle = CalculateTriangulationAngle(
-            proj_center1, proj_center2, point3D.XYZ());
+          // Calculate triangulation angle for all pairwise combinations of
+          // image poses in the track. Only delete point if none of the
+          // combinations has a sufficient triangulation angle.
+          bool keep_point = false;
+          for (size_t i1 = 0; i1 < track_proj_centers.size(); ++i1) {
+            for (size_t i2 = 0; i2 < i1; ++i2) {
+              const double tri_angle = CalculateTriangulationAngle(
+                  track_proj_centers[i1], track_proj_centers[i2],
+                  point3D.XYZ());
+              if (tri_angle >= min_tri_angle_rad) {
+                keep_point = true;
+                break;
+              }
+            }
+
+            if (keep_point) {
+              break;
+            }
+          }
 
-        if (tri_angle >= min_tri_angle_rad) {
-          keep_point = true;
-          break;
+          keep_points[i] = keep_point;
         }
-      }
+      });
 
-      if (keep_point) {
-        break;
-      }
-    }
-
-    if (!keep_point) {
+  for (size_t i = 0; i < point3D_ids_vec.size(); ++i) {
+    if (!keep_points[i]) {
       num_filtered += 1;
-      DeletePoint3D(point3D_id);
+      DeletePoint3D(point3D_ids_vec[i]);
     }
   }
 
@@ -1331,51 +2515,70 @@ size_t Reconstruction::FilterPoints3DWithSmallTriangulationAngle(
 
 size_t Reconstruction::FilterPoints3DWithLargeReprojectionError(
     const double max_reproj_error,
-    const std::unordered_set<point3D_t>& point3D_ids) {
+    const std::unordered_set<point3D_t>& point3D_ids, const int num_threads) {
   const double max_squared_reproj_error = max_reproj_error * max_reproj_error;
 
   // Number of filtered points.
   size_t num_filtered = 0;
 
+  std::vector<point3D_t> point3D_ids_vec;
+  point3D_ids_vec.reserve(point3D_ids.size());
   for (const auto point3D_id : point3D_ids) {
-    if (!ExistsPoint3D(point3D_id)) {
-      continue;
-    }
-
-    class Point3D& point3D = Point3D(point3D_id);
-
-    if (point3D.Track().Length() < 2) {
-      DeletePoint3D(point3D_id);
-      num_filtered += point3D.Track().Length();
-      continue;
-    }
-
-    double reproj_error_sum = 0.0;
+    if (ExistsPoint3D(point3D_id)) {
+      point3D_ids_vec.push_back(point3D_id);
+    }
+  }
+
+  // Evaluate the reprojection errors of all points in parallel and then apply
+  // the resulting deletions serially in the original order.
+  std::vector<char> delete_points(point3D_ids_vec.size(), 0);
+  std::vector<double> reproj_error_sums(point3D_ids_vec.size(), 0.0);
+  std::vector<std::vector<TrackElement>> track_els_to_delete(
+      point3D_ids_vec.size());
+  ParallelForChunks(
+      num_threads, point3D_ids_vec.size(),
+      [&](const size_t, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          const class Point3D& point3D = Point3D(point3D_ids_vec[i]);
+
+          if (point3D.Track().Length() < 2) {
+            delete_points[i] = 1;
+            continue;
+          }
 
-    std::vector<TrackElement> track_els_to_delete;
+          for (const auto& track_el : point3D.Track().Elements()) {
+            const class Image& image = Image(track_el.image_id);
+            const class Camera& camera = Camera(image.CameraId());
+            const Point2D& point2D = image.Point2D(track_el.point2D_idx);
+            const double squared_reproj_error =
+                CalculateSquaredReprojectionError(point2D.XY(), point3D.XYZ(),
+                                                  image.Qvec(), image.Tvec(),
+                                                  camera);
+            if (squared_reproj_error > max_squared_reproj_error) {
+              track_els_to_delete[i].push_back(track_el);
+            } else {
+              reproj_error_sums[i] += std::sqrt(squared_reproj_error);
+            }
+          }
 
-    for (const auto& track_el : point3D.Track().Elements()) {
-      const class Image& image = Image(track_el.image_id);
-      const class Camera& camera = Camera(image.CameraId());
-      const Point2D& point2D = image.Point2D(track_el.point2D_idx);
-      const double squared_reproj_error = CalculateSquaredReprojectionError(
-          point2D.XY(), point3D.XYZ(), image.Qvec(), image.Tvec(), camera);
-      if (squared_reproj_error > max_squared_reproj_error) {
-        track_els_to_delete.push_back(track_el);
-      } else {
-        reproj_error_sum += std::sqrt(squared_reproj_error);
-      }
-    }
+          if (track_els_to_delete[i].size() >= point3D.Track().Length() - 1) {
+            delete_points[i] = 1;
+          }
+        }
+      });
 
-    if (track_els_to_delete.size() >= point3D.Track().Length() - 1) {
+  for (size_t i = 0; i < point3D_ids_vec.size(); ++i) {
+    const point3D_t point3D_id = point3D_ids_vec[i];
+    class Point3D& point3D = Point3D(point3D_id);
+    if (delete_points[i]) {
       num_filtered += point3D.Track().Length();
       DeletePoint3D(point3D_id);
     } else {
-      num_filtered += track_els_to_delete.size();
-      for (const auto& track_el : track_els_to_delete) {
+      num_filtered += track_els_to_delete[i].size();
+      for (const auto& track_el : track_els_to_delete[i]) {
         DeleteObservation(track_el.image_id, track_el.point2D_idx);
       }
-      point3D.SetError(reproj_error_sum / point3D.Track().Length());
+      point3D.SetError(reproj_error_sums[i] / point3D.Track().Length());
     }
   }
 
@@ -1385,232 +2588,227 @@ size_t Reconstruction::FilterPoints3DWithLargeReprojectionError(
 void Reconstruction::ReadCamerasText(const std::string& path) {
   cameras_.clear();
 
-  std::ifstream file(path);
-  CHECK(file.is_open()) << path;
-
-  std::string line;
-  std::string item;
-
-  while (std::getline(file, line)) {
-    StringTrim(&line);
-
-    if (line.empty() || line[0] == '#') {
-      continue;
-    }
-
-    std::stringstream line_stream(line);
+  ReadTextFileInBlocks(path, [&](const char* block_begin,
+                                 const char* block_end, const bool is_last) {
+    const char* records_end =
+        FindEndOfLastLine(block_begin, block_end, is_last);
+    ForEachDataLine(block_begin, records_end, [&](const char* line_begin,
+                                                  const char* line_end) {
+      TextLineParser parser(line_begin, line_end);
 
-    class Camera camera;
+      class Camera camera;
 
-    // ID
-    std::getline(line_stream, item, ' ');
-    camera.SetCameraId(std::stoul(item));
+      // ID
+      camera.SetCameraId(parser.ReadUInt());
 
-    // MODEL
-    std::getline(line_stream, item, ' ');
-    camera.SetModelIdFromName(item);
+      // MODEL
+      camera.SetModelIdFromName(parser.ReadToken());
 
-    // WIDTH
-    std::getline(line_stream, item, ' ');
-    camera.SetWidth(std::stoll(item));
+      // WIDTH
+      camera.SetWidth(parser.ReadUInt());
 
-    // HEIGHT
-    std::getline(line_stream, item, ' ');
-    camera.SetHeight(std::stoll(item));
+      // HEIGHT
+      camera.SetHeight(parser.ReadUInt());
 
-    // PARAMS
-    camera.Params().clear();
-    while (!line_stream.eof()) {
-      std::getline(line_stream, item, ' ');
-      camera.Params().push_back(std::stold(item));
-    }
+      // PARAMS
+      camera.Params().clear();
+      while (!parser.AtEnd()) {
+        camera.Params().push_back(parser.ReadDouble());
+      }
 
-    CHECK(camera.VerifyParams());
+      CHECK(camera.VerifyParams());
 
-    cameras_.emplace(camera.CameraId(), camera);
-  }
+      cameras_.emplace(camera.CameraId(), camera);
+    });
+    return records_end;
+  });
 }
 
-void Reconstruction::ReadImagesText(const std::string& path) {
+void Reconstruction::ReadImagesText(const std::string& path,
+                                    const int num_threads) {
   images_.clear();
 
-  std::ifstream file(path);
-  CHECK(file.is_open()) << path;
-
-  std::string line;
-  std::string item;
-
-  while (std::getline(file, line)) {
-    StringTrim(&line);
-
-    if (line.empty() || line[0] == '#') {
-      continue;
-    }
-
-    std::stringstream line_stream1(line);
-
-    // ID
-    std::getline(line_stream1, item, ' ');
-    const image_t image_id = std::stoul(item);
-
-    class Image image;
-    image.SetImageId(image_id);
-
-    image.SetRegistered(true);
-    reg_image_ids_.push_back(image_id);
-
-    // QVEC (qw, qx, qy, qz)
-    std::getline(line_stream1, item, ' ');
-    image.Qvec(0) = std::stold(item);
-
-    std::getline(line_stream1, item, ' ');
-    image.Qvec(1) = std::stold(item);
-
-    std::getline(line_stream1, item, ' ');
-    image.Qvec(2) = std::stold(item);
-
-    std::getline(line_stream1, item, ' ');
-    image.Qvec(3) = std::stold(item);
-
-    image.NormalizeQvec();
-
-    // TVEC
-    std::getline(line_stream1, item, ' ');
-    image.Tvec(0) = std::stold(item);
-
-    std::getline(line_stream1, item, ' ');
-    image.Tvec(1) = std::stold(item);
-
-    std::getline(line_stream1, item, ' ');
-    image.Tvec(2) = std::stold(item);
-
-    // CAMERA_ID
-    std::getline(line_stream1, item, ' ');
-    image.SetCameraId(std::stoul(item));
-
-    // NAME
-    std::getline(line_stream1, item, ' ');
-    image.SetName(item);
-
-    // POINTS2D
-    if (!std::getline(file, line)) {
-      break;
-    }
-
-    StringTrim(&line);
-    std::stringstream line_stream2(line);
-
-    std::vector<Eigen::Vector2d> points2D;
-    std::vector<point3D_t> point3D_ids;
-
-    if (!line.empty()) {
-      while (!line_stream2.eof()) {
-        Eigen::Vector2d point;
-
-        std::getline(line_stream2, item, ' ');
-        point.x() = std::stold(item);
-
-        std::getline(line_stream2, item, ' ');
-        point.y() = std::stold(item);
-
-        points2D.push_back(point);
-
-        std::getline(line_stream2, item, ' ');
-        if (item == "-1") {
-          point3D_ids.push_back(kInvalidPoint3DId);
-        } else {
-          point3D_ids.push_back(std::stoll(item));
-        }
+  // The begin and end of the data line and the 2D point line of an image.
+  typedef std::array<const char*, 4> ImageLines;
+  std::vector<ImageLines> image_lines;
+
+  ReadTextFileInBlocks(path, [&](const char* block_begin,
+                                 const char* block_end, const bool is_last) {
+    // Each image is stored in a data line followed by the line of its 2D
+    // points, which may be empty. Find the complete pairs of lines in a
+    // serial scan, such that the images can be parsed independently.
+    image_lines.clear();
+    const char* records_end = block_begin;
+    const char* line_begin = block_begin;
+    while (line_begin < block_end) {
+      const char* line_end = FindLineEnd(line_begin, block_end);
+      if (line_end == block_end && !is_last) {
+        break;
       }
-    }
-
-    image.SetUp(Camera(image.CameraId()));
-    image.SetPoints2D(points2D);
-
-    for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
-         ++point2D_idx) {
-      if (point3D_ids[point2D_idx] != kInvalidPoint3DId) {
-        image.SetPoint3DForPoint2D(point2D_idx, point3D_ids[point2D_idx]);
+      if (IsEmptyOrCommentLine(line_begin, line_end)) {
+        line_begin = records_end = line_end + 1;
+        continue;
       }
+      if (line_end == block_end) {
+        // The image has no line of 2D points at the end of the file.
+        records_end = block_end;
+        break;
+      }
+      const char* points2D_line_begin = line_end + 1;
+      const char* points2D_line_end =
+          FindLineEnd(points2D_line_begin, block_end);
+      if (points2D_line_end == block_end && !is_last) {
+        break;
+      }
+      image_lines.push_back(
+          {{line_begin, line_end, points2D_line_begin, points2D_line_end}});
+      line_begin = records_end = points2D_line_end + 1;
+    }
+    records_end = std::min(records_end, block_end);
+
+    std::vector<class Image> images(image_lines.size());
+    ParallelForChunks(
+        num_threads, image_lines.size(),
+        [&](const size_t, const size_t begin, const size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            class Image& image = images[i];
+
+            TextLineParser parser1(image_lines[i][0], image_lines[i][1]);
+
+            // ID
+            image.SetImageId(parser1.ReadUInt());
+
+            // QVEC (qw, qx, qy, qz)
+            image.Qvec(0) = parser1.ReadDouble();
+            image.Qvec(1) = parser1.ReadDouble();
+            image.Qvec(2) = parser1.ReadDouble();
+            image.Qvec(3) = parser1.ReadDouble();
+            image.NormalizeQvec();
+
+            // TVEC
+            image.Tvec(0) = parser1.ReadDouble();
+            image.Tvec(1) = parser1.ReadDouble();
+            image.Tvec(2) = parser1.ReadDouble();
+
+            // CAMERA_ID
+            image.SetCameraId(parser1.ReadUInt());
+
+            // NAME
+            image.SetName(parser1.ReadToken());
+
+            // POINTS2D
+            TextLineParser parser2(image_lines[i][2], image_lines[i][3]);
+
+            std::vector<Eigen::Vector2d> points2D;
+            std::vector<point3D_t> point3D_ids;
+            while (!parser2.AtEnd()) {
+              const double x = parser2.ReadDouble();
+              const double y = parser2.ReadDouble();
+              points2D.emplace_back(x, y);
+              const int64_t point3D_id = parser2.ReadInt();
+              if (point3D_id == -1) {
+                point3D_ids.push_back(kInvalidPoint3DId);
+              } else {
+                point3D_ids.push_back(static_cast<point3D_t>(point3D_id));
+              }
+            }
+
+            image.SetUp(Camera(image.CameraId()));
+            image.SetPoints2D(points2D);
+
+            for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
+                 ++point2D_idx) {
+              if (point3D_ids[point2D_idx] != kInvalidPoint3DId) {
+                image.SetPoint3DForPoint2D(point2D_idx,
+                                           point3D_ids[point2D_idx]);
+              }
+            }
+
+            image.SetRegistered(true);
+          }
+        });
+
+    for (auto& image : images) {
+      reg_image_ids_.push_back(image.ImageId());
+      images_.emplace(image.ImageId(), std::move(image));
     }
 
-    images_.emplace(image.ImageId(), image);
-  }
+    return records_end;
+  });
 }
 
-void Reconstruction::ReadPoints3DText(const std::string& path) {
+void Reconstruction::ReadPoints3DText(const std::string& path,
+                                      const int num_threads) {
   points3D_.clear();
 
-  std::ifstream file(path);
-  CHECK(file.is_open()) << path;
-
-  std::string line;
-  std::string item;
-
-  while (std::getline(file, line)) {
-    StringTrim(&line);
-
-    if (line.empty() || line[0] == '#') {
-      continue;
-    }
-
-    std::stringstream line_stream(line);
+  const auto ParsePoint3D = [](const char* line_begin, const char* line_end,
+                               point3D_t* point3D_id,
+                               class Point3D* point3D) {
+    TextLineParser parser(line_begin, line_end);
 
     // ID
-    std::getline(line_stream, item, ' ');
-    const point3D_t point3D_id = std::stoll(item);
-
-    // Make sure, that we can add new 3D points after reading 3D points
-    // without overwriting existing 3D points.
-    num_added_points3D_ = std::max(num_added_points3D_, point3D_id);
-
-    class Point3D point3D;
+    *point3D_id = parser.ReadUInt();
 
     // XYZ
-    std::getline(line_stream, item, ' ');
-    point3D.XYZ(0) = std::stold(item);
-
-    std::getline(line_stream, item, ' ');
-    point3D.XYZ(1) = std::stold(item);
-
-    std::getline(line_stream, item, ' ');
-    point3D.XYZ(2) = std::stold(item);
+    point3D->XYZ(0) = parser.ReadDouble();
+    point3D->XYZ(1) = parser.ReadDouble();
+    point3D->XYZ(2) = parser.ReadDouble();
 
     // Color
-    std::getline(line_stream, item, ' ');
-    point3D.Color(0) = static_cast<uint8_t>(std::stoi(item));
-
-    std::getline(line_stream, item, ' ');
-    point3D.Color(1) = static_cast<uint8_t>(std::stoi(item));
-
-    std::getline(line_stream, item, ' ');
-    point3D.Color(2) = static_cast<uint8_t>(std::stoi(item));
+    point3D->Color(0) = static_cast<uint8_t>(parser.ReadInt());
+    point3D->Color(1) = static_cast<uint8_t>(parser.ReadInt());
+    point3D->Color(2) = static_cast<uint8_t>(parser.ReadInt());
 
     // ERROR
-    std::getline(line_stream, item, ' ');
-    point3D.SetError(std::stold(item));
+    point3D->SetError(parser.ReadDouble());
 
     // TRACK
-    while (!line_stream.eof()) {
-      TrackElement track_el;
-
-      std::getline(line_stream, item, ' ');
-      StringTrim(&item);
-      if (item.empty()) {
-        break;
+    while (!parser.AtEnd()) {
+      const image_t image_id = parser.ReadUInt();
+      const point2D_t point2D_idx = parser.ReadUInt();
+      point3D->Track().AddElement(image_id, point2D_idx);
+    }
+
+    point3D->Track().Compress();
+  };
+
+  std::vector<std::vector<std::pair<point3D_t, class Point3D>>> chunk_points3D;
+
+  ReadTextFileInBlocks(path, [&](const char* block_begin,
+                                 const char* block_end, const bool is_last) {
+    const char* records_end =
+        FindEndOfLastLine(block_begin, block_end, is_last);
+    const auto chunks =
+        SplitTextIntoChunks(block_begin, records_end, num_threads);
+
+    chunk_points3D.resize(chunks.size());
+    ParallelForChunks(
+        num_threads, chunks.size(),
+        [&](const size_t, const size_t begin, const size_t end) {
+          for (size_t chunk_idx = begin; chunk_idx < end; ++chunk_idx) {
+            auto& points3D = chunk_points3D[chunk_idx];
+            ForEachDataLine(
+                chunks[chunk_idx].first, chunks[chunk_idx].second,
+                [&](const char* line_begin, const char* line_end) {
+                  points3D.emplace_back();
+                  ParsePoint3D(line_begin, line_end, &points3D.back().first,
+                               &points3D.back().second);
+                });
+          }
+        });
+
+    for (auto& points3D : chunk_points3D) {
+      for (auto& point3D : points3D) {
+        // Make sure, that we can add new 3D points after reading 3D points
+        // without overwriting existing 3D points.
+        num_added_points3D_ = std::max(num_added_points3D_, point3D.first);
+        points3D_.emplace(point3D.first, std::move(point3D.second));
       }
-      track_el.image_id = std::stoul(item);
-
-      std::getline(line_stream, item, ' ');
-      track_el.point2D_idx = std::stoul(item);
-
-      point3D.Track().AddElement(track_el);
+      points3D.clear();
     }
 
-    point3D.Track().Compress();
-
-    points3D_.emplace(point3D_id, point3D);
-  }
+    return records_end;
+  });
 }
 
 void Reconstruction::ReadCamerasBinary(const std::string& path) {
@@ -1725,33 +2923,34 @@ void Reconstruction::WriteCamerasText(const std::string& path) const {
   std::ofstream file(path, std::ios::trunc);
   CHECK(file.is_open()) << path;
 
-  // Ensure that we don't loose any precision by storing in text.
-  file.precision(17);
-
   file << "# Camera list with one line of data per camera:" << std::endl;
   file << "#   CAMERA_ID, MODEL, WIDTH, HEIGHT, PARAMS[]" << std::endl;
   file << "# Number of cameras: " << cameras_.size() << std::endl;
 
+  std::string line;
   for (const auto& camera : cameras_) {
-    std::ostringstream line;
+    line.clear();
 
-    line << camera.first << " ";
-    line << camera.second.ModelName() << " ";
-    line << camera.second.Width() << " ";
-    line << camera.second.Height() << " ";
+    AppendInteger(camera.first, &line);
+    line += ' ';
+    line += camera.second.ModelName();
+    line += ' ';
+    AppendInteger(camera.second.Width(), &line);
+    line += ' ';
+    AppendInteger(camera.second.Height(), &line);
 
     for (const double param : camera.second.Params()) {
-      line << param << " ";
+      line += ' ';
+      AppendDouble(param, &line);
     }
 
-    std::string line_string = line.str();
-    line_string = line_string.substr(0, line_string.size() - 1);
-
-    file << line_string << std::endl;
+    line += '\n';
+    file << line;
   }
 }
 
-void Reconstruction::WriteImagesText(const std::string& path) const {
+void Reconstruction::WriteImagesText(const std::string& path,
+                                     const int num_threads) const {
   std::ofstream file(path, std::ios::trunc);
   CHECK(file.is_open()) << path;
 
@@ -1767,54 +2966,66 @@ void Reconstruction::WriteImagesText(const std::string& path) const {
        << ", mean observations per image: "
        << ComputeMeanObservationsPerRegImage() << std::endl;
 
+  std::vector<const class Image*> images;
+  images.reserve(reg_image_ids_.size());
   for (const auto& image : images_) {
-    if (!image.second.IsRegistered()) {
-      continue;
+    if (image.second.IsRegistered()) {
+      images.push_back(&image.second);
     }
+  }
 
-    std::ostringstream line;
-    std::string line_string;
-
-    line << image.first << " ";
-
-    // QVEC (qw, qx, qy, qz)
-    const Eigen::Vector4d normalized_qvec =
-        NormalizeQuaternion(image.second.Qvec());
-    line << normalized_qvec(0) << " ";
-    line << normalized_qvec(1) << " ";
-    line << normalized_qvec(2) << " ";
-    line << normalized_qvec(3) << " ";
-
-    // TVEC
-    line << image.second.Tvec(0) << " ";
-    line << image.second.Tvec(1) << " ";
-    line << image.second.Tvec(2) << " ";
+  // Images can have many 2D points, so format them in small chunks.
+  const size_t kNumImagesPerChunk = 16;
+  WriteTextLinesInParallel(
+      num_threads, images.size(), kNumImagesPerChunk,
+      [&](const size_t i, std::string* lines) {
+        const class Image& image = *images[i];
 
-    line << image.second.CameraId() << " ";
+        AppendInteger(image.ImageId(), lines);
 
-    line << image.second.Name();
+        // QVEC (qw, qx, qy, qz)
+        const Eigen::Vector4d normalized_qvec =
+            NormalizeQuaternion(image.Qvec());
+        for (int d = 0; d < 4; ++d) {
+          *lines += ' ';
+          AppendDouble(normalized_qvec(d), lines);
+        }
 
-    file << line.str() << std::endl;
+        // TVEC
+        for (int d = 0; d < 3; ++d) {
+          *lines += ' ';
+          AppendDouble(image.Tvec(d), lines);
+        }
 
-    line.str("");
-    line.clear();
+        *lines += ' ';
+        AppendInteger(image.CameraId(), lines);
+        *lines += ' ';
+        *lines += image.Name();
+        *lines += '\n';
 
-    for (const Point2D& point2D : image.second.Points2D()) {
-      line << point2D.X() << " ";
-      line << point2D.Y() << " ";
-      if (point2D.HasPoint3D()) {
-        line << point2D.Point3DId() << " ";
-      } else {
-        line << -1 << " ";
-      }
-    }
-    line_string = line.str();
-    line_string = line_string.substr(0, line_string.size() - 1);
-    file << line_string << std::endl;
-  }
+        bool is_first = true;
+        for (const Point2D& point2D : image.Points2D()) {
+          if (!is_first) {
+            *lines += ' ';
+          }
+          is_first = false;
+          AppendDouble(point2D.X(), lines);
+          *lines += ' ';
+          AppendDouble(point2D.Y(), lines);
+          *lines += ' ';
+          if (point2D.HasPoint3D()) {
+            AppendInteger(point2D.Point3DId(), lines);
+          } else {
+            *lines += "-1";
+          }
+        }
+        *lines += '\n';
+      },
+      &file);
 }
 
-void Reconstruction::WritePoints3DText(const std::string& path) const {
+void Reconstruction::WritePoints3DText(const std::string& path,
+                                       const int num_threads) const {
   std::ofstream file(path, std::ios::trunc);
   CHECK(file.is_open()) << path;
 
@@ -1828,28 +3039,36 @@ void Reconstruction::WritePoints3DText(const std::string& path) const {
   file << "# Number of points: " << points3D_.size()
        << ", mean track length: " << ComputeMeanTrackLength() << std::endl;
 
-  for (const auto& point3D : points3D_) {
-    file << point3D.first << " ";
-    file << point3D.second.XYZ()(0) << " ";
-    file << point3D.second.XYZ()(1) << " ";
-    file << point3D.second.XYZ()(2) << " ";
-    file << static_cast<int>(point3D.second.Color(0)) << " ";
-    file << static_cast<int>(point3D.second.Color(1)) << " ";
-    file << static_cast<int>(point3D.second.Color(2)) << " ";
-    file << point3D.second.Error() << " ";
-
-    std::ostringstream line;
-
-    for (const auto& track_el : point3D.second.Track().Elements()) {
-      line << track_el.image_id << " ";
-      line << track_el.point2D_idx << " ";
-    }
-
-    std::string line_string = line.str();
-    line_string = line_string.substr(0, line_string.size() - 1);
-
-    file << line_string << std::endl;
-  }
+  WritePoint3DLinesInParallel(
+      num_threads, points3D_,
+      [](const point3D_t point3D_id, const class Point3D& point3D,
+         std::string* lines) {
+        AppendInteger(point3D_id, lines);
+        for (int d = 0; d < 3; ++d) {
+          *lines += ' ';
+          AppendDouble(point3D.XYZ(d), lines);
+        }
+        for (int d = 0; d < 3; ++d) {
+          *lines += ' ';
+          AppendInteger(static_cast<int>(point3D.Color(d)), lines);
+        }
+        *lines += ' ';
+        AppendDouble(point3D.Error(), lines);
+        *lines += ' ';
+
+        bool is_first = true;
+        for (const auto& track_el : point3D.Track().Elements()) {
+          if (!is_first) {
+            *lines += ' ';
+          }
+          is_first = false;
+          AppendInteger(track_el.image_id, lines);
+          *lines += ' ';
+          AppendInteger(track_el.point2D_idx, lines);
+        }
+        *lines += '\n';
+      },
+      &file);
 }
 
 void Reconstruction::WriteCamerasBinary(const std::string& path) const {
@@ -1931,6 +3150,49 @@ void Reconstruction::WritePoints3DBinary(const std::string& path) const {
   }
 }
 
+void Reconstruction::RecordChange(const uint64_t entry) {
+  if (change_journal_.size() >= kMaxNumJournaledChanges) {
+    MarkAllModified();
+  } else {
+    change_journal_.push_back(entry);
+    version_ += 1;
+  }
+}
+
+void Reconstruction::UpdateOctrees() const {
+  ReconstructionChanges changes;
+  if (!octrees_.is_built || !ReadChanges(octrees_.version, &changes)) {
+    octrees_.images.Clear();
+    octrees_.points3D.Clear();
+    for (const image_t image_id : reg_image_ids_) {
+      octrees_.images.Insert(image_id, Image(image_id).ProjectionCenter());
+    }
+    for (const auto& point3D : points3D_) {
+      octrees_.points3D.Insert(point3D.first, point3D.second.XYZ());
+    }
+  } else {
+    for (const image_t image_id : changes.image_ids) {
+      if (octrees_.images.Exists(image_id)) {
+        octrees_.images.Remove(image_id);
+      }
+      if (ExistsImage(image_id) && IsImageRegistered(image_id)) {
+        octrees_.images.Insert(image_id, Image(image_id).ProjectionCenter());
+      }
+    }
+    for (const point3D_t point3D_id : changes.point3D_ids) {
+      if (octrees_.points3D.Exists(point3D_id)) {
+        octrees_.points3D.Remove(point3D_id);
+      }
+      if (ExistsPoint3D(point3D_id)) {
+        octrees_.points3D.Insert(point3D_id, Point3D(point3D_id).XYZ());
+      }
+    }
+  }
+
+  octrees_.is_built = true;
+  octrees_.version = version_;
+}
+
 void Reconstruction::SetObservationAsTriangulated(
     const image_t image_id, const point2D_t point2D_idx,
     const bool is_continued_point3D) {
@@ -1939,20 +3201,22 @@ void Reconstruction::SetObservationAsTriangulated(
   }
 
   const class Image& image = Image(image_id);
-  const Point2D& point2D = image.Point2D(point2D_idx);
-  const std::vector<CorrespondenceGraph::Correspondence>& corrs =
+  const point3D_t point3D_id = image.Point2DPoint3DId(point2D_idx);
+  const CorrespondenceGraph::CorrespondenceRange corrs =
       correspondence_graph_->FindCorrespondences(image_id, point2D_idx);
 
   CHECK(image.IsRegistered());
-  CHECK(point2D.HasPoint3D());
+  CHECK_NE(point3D_id, kInvalidPoint3DId);
 
   for (const auto& corr : corrs) {
     class Image& corr_image = Image(corr.image_id);
-    const Point2D& corr_point2D = corr_image.Point2D(corr.point2D_idx);
     corr_image.IncrementCorrespondenceHasPoint3D(corr.point2D_idx);
+    if (!corr_image.IsRegistered()) {
+      modified_visibility_image_ids_.insert(corr.image_id);
+    }
     // Update number of shared 3D points between image pairs and make sure to
     // only count the correspondences once (not twice forward and backward).
-    if (point2D.Point3DId() == corr_point2D.Point3DId() &&
+    if (point3D_id == corr_image.Point2DPoint3DId(corr.point2D_idx) &&
         (is_continued_point3D || image_id < corr.image_id)) {
       const image_pair_t pair_id =
           Database::ImagePairToPairId(image_id, corr.image_id);
@@ -1973,20 +3237,22 @@ void Reconstruction::ResetTriObservations(const image_t image_id,
   }
 
   const class Image& image = Image(image_id);
-  const Point2D& point2D = image.Point2D(point2D_idx);
-  const std::vector<CorrespondenceGraph::Correspondence>& corrs =
+  const point3D_t point3D_id = image.Point2DPoint3DId(point2D_idx);
+  const CorrespondenceGraph::CorrespondenceRange corrs =
       correspondence_graph_->FindCorrespondences(image_id, point2D_idx);
 
   CHECK(image.IsRegistered());
-  CHECK(point2D.HasPoint3D());
+  CHECK_NE(point3D_id, kInvalidPoint3DId);
 
   for (const auto& corr : corrs) {
     class Image& corr_image = Image(corr.image_id);
-    const Point2D& corr_point2D = corr_image.Point2D(corr.point2D_idx);
     corr_image.DecrementCorrespondenceHasPoint3D(corr.point2D_idx);
+    if (!corr_image.IsRegistered()) {
+      modified_visibility_image_ids_.insert(corr.image_id);
+    }
     // Update number of shared 3D points between image pairs and make sure to
     // only count the correspondences once (not twice forward and backward).
-    if (point2D.Point3DId() == corr_point2D.Point3DId() &&
+    if (point3D_id == corr_image.Point2DPoint3DId(corr.point2D_idx) &&
         (!is_deleted_point3D || image_id < corr.image_id)) {
       const image_pair_t pair_id =
           Database::ImagePairToPairId(image_id, corr.image_id);
@@ -1997,4 +3263,59 @@ void Reconstruction::ResetTriObservations(const image_t image_id,
   }
 }
 
+void Reconstruction::UpdateImageCovisibility(const image_t image_id,
+                                             const TrackElements& track_els,
+                                             const bool increment) {
+  if (correspondence_graph_ == nullptr) {
+    return;
+  }
+
+  for (const auto& track_el : track_els) {
+    if (track_el.image_id != image_id) {
+      UpdateImagePairCovisibility(image_id, track_el.image_id, increment);
+    }
+  }
+}
+
+void Reconstruction::UpdateImageCovisibility(const TrackElements& track_els,
+                                             const bool increment) {
+  if (correspondence_graph_ == nullptr) {
+    return;
+  }
+
+  // Every pair of track elements in different images is counted, as if the
+  // elements were added to the track one after the other.
+  for (auto it = track_els.begin(); it != track_els.end(); ++it) {
+    for (auto other_it = track_els.begin(); other_it != it; ++other_it) {
+      if (it->image_id != other_it->image_id) {
+        UpdateImagePairCovisibility(it->image_id, other_it->image_id,
+                                    increment);
+      }
+    }
+  }
+}
+
+void Reconstruction::UpdateImagePairCovisibility(const image_t image_id1,
+                                                 const image_t image_id2,
+                                                 const bool increment) {
+  auto& covisibility1 = image_covisibility_[image_id1];
+  auto& covisibility2 = image_covisibility_[image_id2];
+  if (increment) {
+    covisibility1[image_id2] += 1;
+    covisibility2[image_id1] += 1;
+  } else {
+    // Only images with shared observations are kept in the co-visibility.
+    auto it1 = covisibility1.find(image_id2);
+    auto it2 = covisibility2.find(image_id1);
+    CHECK(it1 != covisibility1.end());
+    CHECK(it2 != covisibility2.end());
+    if (--it1->second == 0) {
+      covisibility1.erase(it1);
+    }
+    if (--it2->second == 0) {
+      covisibility2.erase(it2);
+    }
+  }
+}
+
 }  // namespace colmap
@@ -41,10 +41,13 @@
 #include "base/camera.h"
 #include "base/database.h"
 #include "base/image.h"
+#include "base/octree.h"
 #include "base/point2d.h"
 #include "base/point3d.h"
+#include "base/reconstruction_chunks.h"
 #include "base/track.h"
 #include "util/alignment.h"
+#include "util/dense_id_map.h"
 #include "util/types.h"
 
 namespace colmap {
@@ -55,6 +58,14 @@ class DatabaseCache;
 class CorrespondenceGraph;
 class SimilarityTransform3;
 
+// Identifiers of the images and 3D points that were added, modified, or
+// deleted since a given version of a reconstruction. Whether an object was
+// deleted is determined by checking whether it still exists.
+struct ReconstructionChanges {
+  std::unordered_set<image_t> image_ids;
+  std::unordered_set<point3D_t> point3D_ids;
+};
+
 // Reconstruction class holds all information about a single reconstructed
 // model. It is used by the mapping and bundle adjustment classes and can be
 // written to and read from disk.
@@ -67,6 +78,18 @@ class Reconstruction {
     size_t num_total_corrs = 0;
   };
 
+  // Statistics of the scene, see `ComputeStatistics`.
+  struct Statistics {
+    size_t num_cameras = 0;
+    size_t num_images = 0;
+    size_t num_reg_images = 0;
+    size_t num_points3D = 0;
+    size_t num_observations = 0;
+    double mean_track_length = 0.0;
+    double mean_observations_per_reg_image = 0.0;
+    double mean_reprojection_error = 0.0;
+  };
+
   Reconstruction();
 
   // Get number of objects.
@@ -96,13 +119,21 @@ class Reconstruction {
   inline const EIGEN_STL_UMAP(camera_t, class Camera) & Cameras() const;
   inline const EIGEN_STL_UMAP(image_t, class Image) & Images() const;
   inline const std::vector<image_t>& RegImageIds() const;
-  inline const EIGEN_STL_UMAP(point3D_t, class Point3D) & Points3D() const;
+  inline const DenseIdMap<point3D_t, class Point3D>& Points3D() const;
   inline const std::unordered_map<image_pair_t, ImagePairStat>& ImagePairs()
       const;
 
   // Identifiers of all 3D points.
   std::unordered_set<point3D_t> Point3DIds() const;
 
+  // The co-visibility of an image, i.e. the images that observe at least one
+  // of its 3D points and the number of their shared observations, where an
+  // observation of a 3D point is counted once for each observation of the
+  // same 3D point in the given image. The co-visibility is only maintained
+  // between `SetUp` and `TearDown` and empty otherwise.
+  const std::unordered_map<image_t, size_t>& ImageCovisibility(
+      const image_t image_id) const;
+
   // Check whether specific object exists.
   inline bool ExistsCamera(const camera_t camera_id) const;
   inline bool ExistsImage(const image_t image_id) const;
@@ -112,6 +143,14 @@ class Reconstruction {
   // Load data from given `DatabaseCache`.
   void Load(const DatabaseCache& database_cache);
 
+  // Load the images and image pairs that were added to the given
+  // `DatabaseCache` by `DatabaseCache::Update`. If the reconstruction is set
+  // up, the already triangulated observations are propagated along the new
+  // correspondences, so that the new images can be registered immediately.
+  void LoadUpdate(const DatabaseCache& database_cache,
+                  const std::vector<image_t>& new_image_ids,
+                  const std::vector<image_pair_t>& new_image_pair_ids);
+
   // Setup all relevant data structures before reconstruction. Note the
   // correspondence graph object must live until `TearDown` is called.
   void SetUp(const CorrespondenceGraph* correspondence_graph);
@@ -165,6 +204,34 @@ class Reconstruction {
   // Check if image is registered.
   inline bool IsImageRegistered(const image_t image_id) const;
 
+  // Get the identifiers of images whose registration status or, while not
+  // being registered, whose number of visible 3D points changed since the last
+  // call to `ClearModifiedVisibilityImages`. This is used to incrementally
+  // update the ranking of the next images to register.
+  inline const std::unordered_set<image_t>& GetModifiedVisibilityImages() const;
+
+  // Clear the collection of images with changed visibility.
+  inline void ClearModifiedVisibilityImages();
+
+  // Monotonically increasing version of the reconstruction, which changes
+  // whenever an image or 3D point is added, modified, or deleted.
+  inline uint64_t Version() const;
+
+  // Collect the images and 3D points changed since the given version. This
+  // enables consumers, such as the GUI, to incrementally mirror a
+  // reconstruction that is being built. Returns false if the changes are no
+  // longer available (or everything changed), in which case the consumer
+  // must synchronize all objects.
+  bool ReadChanges(const uint64_t version,
+                   ReconstructionChanges* changes) const;
+
+  // Record changes that are made through the mutable object accessors, e.g.,
+  // by bundle adjustment. Changes made through the other methods of this
+  // class are recorded automatically.
+  void MarkImageModified(const image_t image_id);
+  void MarkPoint3DModified(const point3D_t point3D_id);
+  void MarkAllModified();
+
   // Normalize scene by scaling and translation to avoid degenerate
   // visualization after bundle adjustment and to improve numerical
   // stability of algorithms.
@@ -187,6 +254,13 @@ class Reconstruction {
   // reconstructions are aligned using the projection centers of common
   // registered images. Return true if the two reconstructions could be merged.
   bool Merge(const Reconstruction& reconstruction,
+             const double max_reproj_error, const int num_threads = 1);
+
+  // Merge the given reconstruction into this reconstruction as above, using
+  // a precomputed alignment from the given to this reconstruction, e.g., from
+  // `ComputeAlignmentsBetweenReconstructions`.
+  void Merge(const Reconstruction& reconstruction,
+             const Eigen::Matrix3x4d& alignment,
              const double max_reproj_error);
 
   // Align the given reconstruction with a set of pre-defined camera positions.
@@ -196,7 +270,8 @@ class Reconstruction {
              const std::vector<Eigen::Vector3d>& locations,
              const int min_common_images);
 
-  // Robust alignment using RANSAC.
+  // Robust alignment using RANSAC. The hypotheses are evaluated in parallel
+  // with the number of threads in the RANSAC options.
   bool AlignRobust(const std::vector<std::string>& image_names,
                    const std::vector<Eigen::Vector3d>& locations,
                    const int min_common_images,
@@ -205,6 +280,41 @@ class Reconstruction {
   // Find specific image by name. Note that this uses linear search.
   const class Image* FindImageWithName(const std::string& name) const;
 
+  // Find the registered images, whose projection centers lie inside the given
+  // region, and the 3D points inside the given region. The region is either
+  // an axis-aligned box including its boundary or a convex region given as
+  // the intersection of the half-spaces `n^T x + d >= 0` with the planes
+  // `(n, d)`, e.g., the view frustum of an image, see `ComputeViewFrustum`.
+  // The queries use octrees over the projection centers and 3D points, which
+  // are built on the first query and afterwards updated with the changes
+  // since the previous query, see `ReadChanges`. Changes made through the
+  // mutable object accessors must therefore be marked as modified. The
+  // identifiers are returned in arbitrary order. Concurrent queries are not
+  // thread-safe, since they update the octrees.
+  std::vector<image_t> FindImagesInBox(const Eigen::Vector3d& bbox_min,
+                                       const Eigen::Vector3d& bbox_max) const;
+  std::vector<point3D_t> FindPoints3DInBox(
+      const Eigen::Vector3d& bbox_min, const Eigen::Vector3d& bbox_max) const;
+  std::vector<image_t> FindImagesInRegion(
+      const std::vector<Eigen::Vector4d>& planes) const;
+  std::vector<point3D_t> FindPoints3DInRegion(
+      const std::vector<Eigen::Vector4d>& planes) const;
+
+  // Compute the view frustum of a registered image between the given minimum
+  // and maximum depth as the planes of its six half-spaces in world space,
+  // which can be used for `FindImagesInRegion` and `FindPoints3DInRegion`.
+  std::vector<Eigen::Vector4d> ComputeViewFrustum(
+      const image_t image_id, const double min_depth,
+      const double max_depth) const;
+
+  // Crop the reconstruction to the 3D points inside the given axis-aligned
+  // box. The cropped reconstruction contains these 3D points, the registered
+  // images observing them or with their projection centers inside the box,
+  // and the cameras of these images, while the observations of all other 3D
+  // points are removed from the images. Only the cropped objects are copied.
+  Reconstruction Crop(const Eigen::Vector3d& bbox_min,
+                      const Eigen::Vector3d& bbox_max) const;
+
   // Find images that are both present in this and the given reconstruction.
   std::vector<image_t> FindCommonRegImageIds(
       const Reconstruction& reconstruction) const;
@@ -219,16 +329,48 @@ class Reconstruction {
   // @param max_reproj_error    The maximum reprojection error.
   // @param min_tri_angle       The minimum triangulation angle.
   // @param point3D_ids         The points to be filtered.
+  // @param num_threads         The number of threads used to evaluate the
+  //                            points, where -1 uses all available cores.
+  //                            The result does not depend on this value.
   //
   // @return                    The number of filtered observations.
   size_t FilterPoints3D(const double max_reproj_error,
                         const double min_tri_angle,
-                        const std::unordered_set<point3D_t>& point3D_ids);
+                        const std::unordered_set<point3D_t>& point3D_ids,
+                        const int num_threads = 1);
   size_t FilterPoints3DInImages(const double max_reproj_error,
                                 const double min_tri_angle,
-                                const std::unordered_set<image_t>& image_ids);
+                                const std::unordered_set<image_t>& image_ids,
+                                const int num_threads = 1);
   size_t FilterAllPoints3D(const double max_reproj_error,
-                           const double min_tri_angle);
+                           const double min_tri_angle,
+                           const int num_threads = 1);
+
+  // Filter 3D points whose mean distance to their nearest neighbors is larger
+  // than the mean plus `max_std_ratio` standard deviations of this distance
+  // over all points. The neighbors are found with a KD-tree, so that the
+  // filter runs in O(N log N) for N points.
+  //
+  // @return    The number of filtered observations.
+  size_t FilterPoints3DStatisticalOutliers(const int num_neighbors,
+                                           const double max_std_ratio,
+                                           const int num_threads = 1);
+
+  // Filter 3D points with less than `min_num_neighbors` other points within
+  // the given radius, using a KD-tree.
+  //
+  // @return    The number of filtered observations.
+  size_t FilterPoints3DWithFewNeighbors(const double radius,
+                                        const int min_num_neighbors,
+                                        const int num_threads = 1);
+
+  // Filter 3D points in voxels of the given size that contain less than
+  // `min_num_points` points.
+  //
+  // @return    The number of filtered observations.
+  size_t FilterPoints3DInSparseVoxels(const double voxel_size,
+                                      const int min_num_points,
+                                      const int num_threads = 1);
 
   // Filter observations that have negative depth.
   //
@@ -242,24 +384,39 @@ class Reconstruction {
                                     const double max_focal_length_ratio,
                                     const double max_extra_param);
 
+  // Estimate the memory usage of the reconstruction in bytes, where the track
+  // elements are assumed to be stored outside of the 3D points.
+  size_t NumBytes() const;
+
   // Compute statistics for scene.
   size_t ComputeNumObservations() const;
   double ComputeMeanTrackLength() const;
   double ComputeMeanObservationsPerRegImage() const;
-  double ComputeMeanReprojectionError() const;
+  double ComputeMeanReprojectionError(const int num_threads = 1) const;
+
+  // Compute all of the above statistics in a single pass over the points.
+  Statistics ComputeStatistics(const int num_threads = 1) const;
 
-  // Read data from text or binary file. Prefer binary data if it exists.
+  // Read data from text, binary, or chunked file. Prefer binary data if it
+  // exists, followed by chunked data.
   void Read(const std::string& path);
   void Write(const std::string& path) const;
 
-  // Read data from binary/text file.
-  void ReadText(const std::string& path);
+  // Read data from binary/text file. Text is parsed in parallel.
+  void ReadText(const std::string& path, const int num_threads = -1);
   void ReadBinary(const std::string& path);
 
-  // Write data from binary/text file.
-  void WriteText(const std::string& path) const;
+  // Write data from binary/text file. Text is formatted in parallel.
+  void WriteText(const std::string& path, const int num_threads = -1) const;
   void WriteBinary(const std::string& path) const;
 
+  // Read/write data from/to the chunked file in the given directory. See
+  // `ChunkedReconstructionReader` to only read parts of the data.
+  void ReadChunked(const std::string& path);
+  void WriteChunked(const std::string& path,
+                    const ChunkedReconstructionOptions& options =
+                        ChunkedReconstructionOptions()) const;
+
   // Convert 3D points in reconstruction to PLY point cloud.
   std::vector<PlyPoint> ConvertToPLY() const;
 
@@ -267,14 +424,15 @@ class Reconstruction {
   // only intended for visualization of data and usable for reconstruction.
   void ImportPLY(const std::string& path);
 
-  // Export to other data formats.
-  bool ExportNVM(const std::string& path) const;
-  bool ExportBundler(const std::string& path,
-                     const std::string& list_path) const;
+  // Export to other data formats. Text is formatted in parallel.
+  bool ExportNVM(const std::string& path, const int num_threads = -1) const;
+  bool ExportBundler(const std::string& path, const std::string& list_path,
+                     const int num_threads = -1) const;
   void ExportPLY(const std::string& path) const;
   void ExportVRML(const std::string& images_path,
                   const std::string& points3D_path, const double image_scale,
-                  const Eigen::Vector3d& image_rgb) const;
+                  const Eigen::Vector3d& image_rgb,
+                  const int num_threads = -1) const;
 
   // Extract colors for 3D points of given image. Colors will be extracted
   // only for 3D points which are completely black.
@@ -292,7 +450,11 @@ class Reconstruction {
   // @param path          Absolute or relative path to root folder of image.
   //                      The image path is determined by concatenating the
   //                      root path and the name of the image.
-  void ExtractColorsForAllImages(const std::string& path);
+  // @param num_threads   The number of threads used to read and sample the
+  //                      images. The colors do not depend on the number of
+  //                      threads.
+  void ExtractColorsForAllImages(const std::string& path,
+                                 const int num_threads = -1);
 
   // Create all image sub-directories in the given path.
   void CreateImageDirs(const std::string& path) const;
@@ -300,21 +462,25 @@ class Reconstruction {
  private:
   size_t FilterPoints3DWithSmallTriangulationAngle(
       const double min_tri_angle,
-      const std::unordered_set<point3D_t>& point3D_ids);
+      const std::unordered_set<point3D_t>& point3D_ids, const int num_threads);
   size_t FilterPoints3DWithLargeReprojectionError(
       const double max_reproj_error,
-      const std::unordered_set<point3D_t>& point3D_ids);
+      const std::unordered_set<point3D_t>& point3D_ids, const int num_threads);
+
+  // Delete the given 3D points and return the number of their observations.
+  size_t DeletePoints3D(const std::vector<point3D_t>& point3D_ids);
 
   void ReadCamerasText(const std::string& path);
-  void ReadImagesText(const std::string& path);
-  void ReadPoints3DText(const std::string& path);
+  void ReadImagesText(const std::string& path, const int num_threads);
+  void ReadPoints3DText(const std::string& path, const int num_threads);
   void ReadCamerasBinary(const std::string& path);
   void ReadImagesBinary(const std::string& path);
   void ReadPoints3DBinary(const std::string& path);
 
   void WriteCamerasText(const std::string& path) const;
-  void WriteImagesText(const std::string& path) const;
-  void WritePoints3DText(const std::string& path) const;
+  void WriteImagesText(const std::string& path, const int num_threads) const;
+  void WritePoints3DText(const std::string& path,
+                         const int num_threads) const;
   void WriteCamerasBinary(const std::string& path) const;
   void WriteImagesBinary(const std::string& path) const;
   void WritePoints3DBinary(const std::string& path) const;
@@ -325,19 +491,70 @@ class Reconstruction {
   void ResetTriObservations(const image_t image_id, const point2D_t point2D_idx,
                             const bool is_deleted_point3D);
 
+  // Increment or decrement the co-visibility between the given image and the
+  // images of the track elements, if the reconstruction is set up.
+  void UpdateImageCovisibility(const image_t image_id,
+                               const TrackElements& track_els,
+                               const bool increment);
+  void UpdateImageCovisibility(const TrackElements& track_els,
+                               const bool increment);
+  void UpdateImagePairCovisibility(const image_t image_id1,
+                                   const image_t image_id2,
+                                   const bool increment);
+
+  void RecordChange(const uint64_t entry);
+
+  // Build or update the octrees of the spatial queries, see `FindImagesInBox`.
+  void UpdateOctrees() const;
+
   const CorrespondenceGraph* correspondence_graph_;
 
   EIGEN_STL_UMAP(camera_t, class Camera) cameras_;
   EIGEN_STL_UMAP(image_t, class Image) images_;
-  EIGEN_STL_UMAP(point3D_t, class Point3D) points3D_;
+  DenseIdMap<point3D_t, class Point3D> points3D_;
 
   std::unordered_map<image_pair_t, ImagePairStat> image_pair_stats_;
 
+  // Octrees over the projection centers of the registered images and the 3D
+  // points as of the given version, see `FindImagesInBox`. The octrees are
+  // not copied with the reconstruction, but rebuilt on demand.
+  struct Octrees {
+    Octrees() : is_built(false), version(0) {}
+    Octrees(const Octrees&) : Octrees() {}
+    Octrees& operator=(const Octrees&) {
+      is_built = false;
+      images.Clear();
+      points3D.Clear();
+      return *this;
+    }
+
+    bool is_built;
+    uint64_t version;
+    Octree images;
+    Octree points3D;
+  };
+
+  mutable Octrees octrees_;
+
+  // Co-visibility graph of the images, see `ImageCovisibility`.
+  std::unordered_map<image_t, std::unordered_map<image_t, size_t>>
+      image_covisibility_;
+
   // { image_id, ... } where `images_.at(image_id).registered == true`.
   std::vector<image_t> reg_image_ids_;
 
+  // Images with changed visibility, see `GetModifiedVisibilityImages`.
+  std::unordered_set<image_t> modified_visibility_image_ids_;
+
   // Total number of added 3D points, used to generate unique identifiers.
   point3D_t num_added_points3D_;
+
+  // Journal of changed objects, see `ReadChanges`. Entry `i` is the change
+  // that produced version `journal_begin_version_ + i + 1`. Image identifiers
+  // are tagged with `kImageChangeBit` to distinguish them from 3D points.
+  std::vector<uint64_t> change_journal_;
+  uint64_t journal_begin_version_;
+  uint64_t version_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -414,7 +631,7 @@ const std::vector<image_t>& Reconstruction::RegImageIds() const {
   return reg_image_ids_;
 }
 
-const EIGEN_STL_UMAP(point3D_t, Point3D) & Reconstruction::Points3D() const {
+const DenseIdMap<point3D_t, Point3D>& Reconstruction::Points3D() const {
   return points3D_;
 }
 
@@ -443,6 +660,17 @@ bool Reconstruction::IsImageRegistered(const image_t image_id) const {
   return Image(image_id).IsRegistered();
 }
 
+const std::unordered_set<image_t>&
+Reconstruction::GetModifiedVisibilityImages() const {
+  return modified_visibility_image_ids_;
+}
+
+void Reconstruction::ClearModifiedVisibilityImages() {
+  modified_visibility_image_ids_.clear();
+}
+
+uint64_t Reconstruction::Version() const { return version_; }
+
 }  // namespace colmap
 
 #endif  // COLMAP_SRC_BASE_RECONSTRUCTION_H_
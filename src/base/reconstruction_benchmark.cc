@@ -0,0 +1,93 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <boost/filesystem.hpp>
+
+#include "base/synthetic.h"
+#include "util/random.h"
+
+using namespace colmap;
+
+namespace {
+
+void SynthesizeBenchmarkDataset(const int num_points3D,
+                                Reconstruction* reconstruction) {
+  SetPRNGSeed(0);
+  SyntheticDatasetOptions options;
+  options.num_images = 20;
+  options.num_points3D = num_points3D;
+  options.num_points2D_without_point3D = 100;
+  SynthesizeDataset(options, reconstruction);
+}
+
+std::string CreateTempDir() {
+  const std::string path = (boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path())
+                               .string();
+  boost::filesystem::create_directories(path);
+  return path;
+}
+
+}  // namespace
+
+static void BM_ReconstructionWriteBinary(benchmark::State& state) {
+  Reconstruction reconstruction;
+  SynthesizeBenchmarkDataset(state.range(0), &reconstruction);
+  const std::string path = CreateTempDir();
+  for (auto _ : state) {
+    reconstruction.WriteBinary(path);
+  }
+  boost::filesystem::remove_all(path);
+}
+
+BENCHMARK(BM_ReconstructionWriteBinary)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_ReconstructionReadBinary(benchmark::State& state) {
+  Reconstruction reconstruction;
+  SynthesizeBenchmarkDataset(state.range(0), &reconstruction);
+  const std::string path = CreateTempDir();
+  reconstruction.WriteBinary(path);
+  for (auto _ : state) {
+    Reconstruction read_reconstruction;
+    read_reconstruction.ReadBinary(path);
+    benchmark::DoNotOptimize(read_reconstruction.NumPoints3D());
+  }
+  boost::filesystem::remove_all(path);
+}
+
+BENCHMARK(BM_ReconstructionReadBinary)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond);
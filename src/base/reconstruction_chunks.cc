@@ -0,0 +1,667 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+#include "base/reconstruction_chunks.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#ifdef ZLIB_ENABLED
+#include <zlib.h>
+#endif
+
+#include "base/pose.h"
+#include "base/reconstruction.h"
+#include "util/endian.h"
+#include "util/logging.h"
+#include "util/misc.h"
+
+namespace colmap {
+namespace {
+
+typedef ChunkedReconstructionReader::Chunk Chunk;
+typedef ChunkedReconstructionReader::ChunkType ChunkType;
+
+const char kMagic[8] = {'C', 'O', 'L', 'M', 'A', 'P', 'R', 'C'};
+const uint32_t kVersion = 1;
+const size_t kIndexOffsetPosition = sizeof(kMagic) + sizeof(uint32_t);
+const size_t kHeaderNumBytes = kIndexOffsetPosition + sizeof(uint64_t);
+
+// The alignment of the chunk offsets in the file in bytes.
+const size_t kChunkAlignment = 64;
+
+// The number of bits per dimension of the space-filling curve.
+const int kNumMortonBits = 21;
+
+// Sequential little endian parser of the data of a chunk.
+class ChunkParser {
+ public:
+  ChunkParser(const char* data, const size_t num_bytes)
+      : data_(data), num_bytes_(num_bytes), pos_(0) {}
+
+  template <typename T>
+  T Read() {
+    CHECK_LE(pos_ + sizeof(T), num_bytes_) << "Truncated chunk";
+    T data_little_endian;
+    std::memcpy(&data_little_endian, data_ + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return LittleEndianToNative(data_little_endian);
+  }
+
+  std::string ReadString() {
+    const size_t length = Read<uint64_t>();
+    CHECK_LE(pos_ + length, num_bytes_) << "Truncated chunk";
+    const std::string str(data_ + pos_, length);
+    pos_ += length;
+    return str;
+  }
+
+ private:
+  const char* data_;
+  const size_t num_bytes_;
+  size_t pos_;
+};
+
+void WriteString(std::ostream* stream, const std::string& str) {
+  WriteBinaryLittleEndian<uint64_t>(stream, str.size());
+  stream->write(str.data(), str.size());
+}
+
+// Interleave the lower bits of the value with two zero bits each.
+uint64_t SpreadBits(uint64_t value) {
+  value &= (uint64_t(1) << kNumMortonBits) - 1;
+  value = (value | value << 32) & 0x1f00000000ffffULL;
+  value = (value | value << 16) & 0x1f0000ff0000ffULL;
+  value = (value | value << 8) & 0x100f00f00f00f00fULL;
+  value = (value | value << 4) & 0x10c30c30c30c30c3ULL;
+  value = (value | value << 2) & 0x1249249249249249ULL;
+  return value;
+}
+
+uint64_t MortonCode(const Eigen::Vector3d& xyz, const Eigen::Vector3d& min_xyz,
+                    const Eigen::Vector3d& scale) {
+  const double max_value = (uint64_t(1) << kNumMortonBits) - 1;
+  uint64_t code = 0;
+  for (int d = 0; d < 3; ++d) {
+    const double value = (xyz(d) - min_xyz(d)) * scale(d);
+    const uint64_t cell =
+        static_cast<uint64_t>(std::min(std::max(value, 0.0), max_value));
+    code |= SpreadBits(cell) << d;
+  }
+  return code;
+}
+
+class ChunkFileWriter {
+ public:
+  ChunkFileWriter(const std::string& path, const bool compress)
+      : path_(path), compress_(compress), file_(path, std::ios::trunc |
+                                                          std::ios::binary) {
+    CHECK(file_.is_open()) << path_;
+#ifndef ZLIB_ENABLED
+    if (compress_) {
+      std::cout << "WARNING: Compression requires zlib, writing uncompressed "
+                   "chunks instead."
+                << std::endl;
+      compress_ = false;
+    }
+#endif
+    file_.write(kMagic, sizeof(kMagic));
+    WriteBinaryLittleEndian<uint32_t>(&file_, kVersion);
+    WriteBinaryLittleEndian<uint64_t>(&file_, 0);
+  }
+
+  void WriteChunk(const ChunkType type, const std::string& data,
+                  const size_t num_items, const Eigen::Vector3d& bbox_min,
+                  const Eigen::Vector3d& bbox_max) {
+    Chunk chunk;
+    chunk.type = type;
+    chunk.num_raw_bytes = data.size();
+    chunk.num_items = num_items;
+    chunk.bbox_min = bbox_min;
+    chunk.bbox_max = bbox_max;
+
+    const uint64_t file_size = file_.tellp();
+    const size_t num_padding_bytes =
+        (kChunkAlignment - file_size % kChunkAlignment) % kChunkAlignment;
+    const std::vector<char> padding(num_padding_bytes, 0);
+    file_.write(padding.data(), num_padding_bytes);
+    chunk.offset = file_size + num_padding_bytes;
+
+#ifdef ZLIB_ENABLED
+    if (compress_ && !data.empty()) {
+      uLongf num_compressed_bytes = compressBound(data.size());
+      std::vector<char> compressed_data(num_compressed_bytes);
+      CHECK_EQ(compress2(reinterpret_cast<Bytef*>(compressed_data.data()),
+                         &num_compressed_bytes,
+                         reinterpret_cast<const Bytef*>(data.data()),
+                         data.size(), Z_DEFAULT_COMPRESSION),
+               Z_OK);
+      // Only keep the compressed data if it actually saves space.
+      if (num_compressed_bytes < data.size()) {
+        chunk.compressed = true;
+        chunk.num_bytes = num_compressed_bytes;
+        file_.write(compressed_data.data(), num_compressed_bytes);
+      }
+    }
+#endif
+
+    if (!chunk.compressed) {
+      chunk.num_bytes = data.size();
+      file_.write(data.data(), data.size());
+    }
+
+    chunks_.push_back(chunk);
+  }
+
+  void Close() {
+    const uint64_t index_offset = file_.tellp();
+    WriteBinaryLittleEndian<uint64_t>(&file_, chunks_.size());
+    for (const auto& chunk : chunks_) {
+      WriteBinaryLittleEndian<uint32_t>(&file_,
+                                        static_cast<uint32_t>(chunk.type));
+      WriteBinaryLittleEndian<uint32_t>(&file_, chunk.compressed ? 1 : 0);
+      WriteBinaryLittleEndian<uint64_t>(&file_, chunk.offset);
+      WriteBinaryLittleEndian<uint64_t>(&file_, chunk.num_bytes);
+      WriteBinaryLittleEndian<uint64_t>(&file_, chunk.num_raw_bytes);
+      WriteBinaryLittleEndian<uint64_t>(&file_, chunk.num_items);
+      for (int d = 0; d < 3; ++d) {
+        WriteBinaryLittleEndian<double>(&file_, chunk.bbox_min(d));
+      }
+      for (int d = 0; d < 3; ++d) {
+        WriteBinaryLittleEndian<double>(&file_, chunk.bbox_max(d));
+      }
+    }
+
+    // The index offset is only known at the end, so patch the header.
+    file_.seekp(kIndexOffsetPosition);
+    WriteBinaryLittleEndian<uint64_t>(&file_, index_offset);
+    file_.close();
+    CHECK(!file_.fail()) << path_;
+  }
+
+ private:
+  const std::string path_;
+  bool compress_;
+  std::ofstream file_;
+  std::vector<Chunk> chunks_;
+};
+
+void WriteCamerasChunk(const Reconstruction& reconstruction,
+                       ChunkFileWriter* writer) {
+  std::vector<camera_t> camera_ids;
+  camera_ids.reserve(reconstruction.NumCameras());
+  for (const auto& camera : reconstruction.Cameras()) {
+    camera_ids.push_back(camera.first);
+  }
+  std::sort(camera_ids.begin(), camera_ids.end());
+
+  std::ostringstream stream;
+  for (const camera_t camera_id : camera_ids) {
+    const class Camera& camera = reconstruction.Camera(camera_id);
+    WriteBinaryLittleEndian<camera_t>(&stream, camera_id);
+    WriteBinaryLittleEndian<int>(&stream, camera.ModelId());
+    WriteBinaryLittleEndian<uint64_t>(&stream, camera.Width());
+    WriteBinaryLittleEndian<uint64_t>(&stream, camera.Height());
+    WriteBinaryLittleEndian<double>(&stream, camera.Params());
+  }
+
+  writer->WriteChunk(ChunkType::CAMERAS, stream.str(), camera_ids.size(),
+                     Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero());
+}
+
+void WriteImageChunks(const Reconstruction& reconstruction,
+                      const size_t max_num_images_per_chunk,
+                      ChunkFileWriter* writer) {
+  std::vector<image_t> image_ids = reconstruction.RegImageIds();
+  std::sort(image_ids.begin(), image_ids.end());
+
+  for (size_t begin = 0; begin < image_ids.size();
+       begin += max_num_images_per_chunk) {
+    const size_t end =
+        std::min(begin + max_num_images_per_chunk, image_ids.size());
+
+    std::ostringstream poses_stream;
+    std::ostringstream points2D_stream;
+    Eigen::Vector3d bbox_min =
+        Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+    Eigen::Vector3d bbox_max =
+        Eigen::Vector3d::Constant(std::numeric_limits<double>::lowest());
+
+    for (size_t i = begin; i < end; ++i) {
+      const class Image& image = reconstruction.Image(image_ids[i]);
+
+      WriteBinaryLittleEndian<image_t>(&poses_stream, image.ImageId());
+      const Eigen::Vector4d normalized_qvec = NormalizeQuaternion(image.Qvec());
+      for (int d = 0; d < 4; ++d) {
+        WriteBinaryLittleEndian<double>(&poses_stream, normalized_qvec(d));
+      }
+      for (int d = 0; d < 3; ++d) {
+        WriteBinaryLittleEndian<double>(&poses_stream, image.Tvec(d));
+      }
+      WriteBinaryLittleEndian<camera_t>(&poses_stream, image.CameraId());
+      WriteString(&poses_stream, image.Name());
+
+      const Eigen::Vector3d proj_center = image.ProjectionCenter();
+      bbox_min = bbox_min.cwiseMin(proj_center);
+      bbox_max = bbox_max.cwiseMax(proj_center);
+
+      WriteBinaryLittleEndian<image_t>(&points2D_stream, image.ImageId());
+      WriteBinaryLittleEndian<uint64_t>(&points2D_stream, image.NumPoints2D());
+      for (const Point2D& point2D : image.Points2D()) {
+        WriteBinaryLittleEndian<double>(&points2D_stream, point2D.X());
+        WriteBinaryLittleEndian<double>(&points2D_stream, point2D.Y());
+        WriteBinaryLittleEndian<point3D_t>(&points2D_stream,
+                                           point2D.Point3DId());
+      }
+    }
+
+    writer->WriteChunk(ChunkType::IMAGE_POSES, poses_stream.str(), end - begin,
+                       bbox_min, bbox_max);
+    writer->WriteChunk(ChunkType::IMAGE_POINTS2D, points2D_stream.str(),
+                       end - begin, bbox_min, bbox_max);
+  }
+}
+
+void WritePoints3DChunks(const Reconstruction& reconstruction,
+                         const size_t max_num_points3D_per_chunk,
+                         ChunkFileWriter* writer) {
+  if (reconstruction.NumPoints3D() == 0) {
+    return;
+  }
+
+  Eigen::Vector3d min_xyz =
+      Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+  Eigen::Vector3d max_xyz =
+      Eigen::Vector3d::Constant(std::numeric_limits<double>::lowest());
+  for (const auto& point3D : reconstruction.Points3D()) {
+    min_xyz = min_xyz.cwiseMin(point3D.second.XYZ());
+    max_xyz = max_xyz.cwiseMax(point3D.second.XYZ());
+  }
+
+  const double num_cells = (uint64_t(1) << kNumMortonBits) - 1;
+  Eigen::Vector3d scale;
+  for (int d = 0; d < 3; ++d) {
+    const double extent = max_xyz(d) - min_xyz(d);
+    scale(d) = extent > 0 ? num_cells / extent : 0;
+  }
+
+  // Sort the points along the space-filling curve, such that consecutive
+  // points and thereby the points of a chunk are spatially close.
+  std::vector<std::pair<uint64_t, point3D_t>> sorted_points3D;
+  sorted_points3D.reserve(reconstruction.NumPoints3D());
+  for (const auto& point3D : reconstruction.Points3D()) {
+    sorted_points3D.emplace_back(
+        MortonCode(point3D.second.XYZ(), min_xyz, scale), point3D.first);
+  }
+  std::sort(sorted_points3D.begin(), sorted_points3D.end());
+
+  for (size_t begin = 0; begin < sorted_points3D.size();
+       begin += max_num_points3D_per_chunk) {
+    const size_t end =
+        std::min(begin + max_num_points3D_per_chunk, sorted_points3D.size());
+
+    std::ostringstream stream;
+    Eigen::Vector3d bbox_min =
+        Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+    Eigen::Vector3d bbox_max =
+        Eigen::Vector3d::Constant(std::numeric_limits<double>::lowest());
+
+    for (size_t i = begin; i < end; ++i) {
+      const point3D_t point3D_id = sorted_points3D[i].second;
+      const class Point3D& point3D = reconstruction.Point3D(point3D_id);
+
+      bbox_min = bbox_min.cwiseMin(point3D.XYZ());
+      bbox_max = bbox_max.cwiseMax(point3D.XYZ());
+
+      WriteBinaryLittleEndian<point3D_t>(&stream, point3D_id);
+      for (int d = 0; d < 3; ++d) {
+        WriteBinaryLittleEndian<double>(&stream, point3D.XYZ()(d));
+      }
+      for (int d = 0; d < 3; ++d) {
+        WriteBinaryLittleEndian<uint8_t>(&stream, point3D.Color(d));
+      }
+      WriteBinaryLittleEndian<double>(&stream, point3D.Error());
+      WriteBinaryLittleEndian<uint64_t>(&stream, point3D.Track().Length());
+      for (const auto& track_el : point3D.Track().Elements()) {
+        WriteBinaryLittleEndian<image_t>(&stream, track_el.image_id);
+        WriteBinaryLittleEndian<point2D_t>(&stream, track_el.point2D_idx);
+      }
+    }
+
+    writer->WriteChunk(ChunkType::POINTS3D, stream.str(), end - begin,
+                       bbox_min, bbox_max);
+  }
+}
+
+}  // namespace
+
+bool ChunkedReconstructionOptions::Check() const {
+  CHECK_OPTION_GT(max_num_images_per_chunk, 0);
+  CHECK_OPTION_GT(max_num_points3D_per_chunk, 0);
+  return true;
+}
+
+void WriteChunkedReconstruction(const Reconstruction& reconstruction,
+                                const std::string& path,
+                                const ChunkedReconstructionOptions& options) {
+  CHECK(options.Check());
+
+  ChunkFileWriter writer(path, options.compress);
+  WriteCamerasChunk(reconstruction, &writer);
+  WriteImageChunks(reconstruction, options.max_num_images_per_chunk, &writer);
+  WritePoints3DChunks(reconstruction, options.max_num_points3D_per_chunk,
+                      &writer);
+  writer.Close();
+}
+
+const std::string ChunkedReconstructionReader::kFileName =
+    "reconstruction.chunks";
+
+ChunkedReconstructionReader::ChunkedReconstructionReader(
+    const std::string& path)
+    : path_(path) {
+  const boost::interprocess::file_mapping file_mapping(
+      path_.c_str(), boost::interprocess::read_only);
+  mapped_region_ = std::make_shared<const boost::interprocess::mapped_region>(
+      file_mapping, boost::interprocess::read_only);
+
+  const char* data = static_cast<const char*>(mapped_region_->get_address());
+  const size_t num_bytes = mapped_region_->get_size();
+
+  CHECK_GE(num_bytes, kHeaderNumBytes) << path_;
+  CHECK_EQ(std::memcmp(data, kMagic, sizeof(kMagic)), 0)
+      << "Not a chunked reconstruction: " << path_;
+
+  ChunkParser header_parser(data + sizeof(kMagic),
+                            kHeaderNumBytes - sizeof(kMagic));
+  const uint32_t version = header_parser.Read<uint32_t>();
+  CHECK_EQ(version, kVersion) << "Unsupported version: " << path_;
+  const uint64_t index_offset = header_parser.Read<uint64_t>();
+  CHECK_GE(index_offset, kHeaderNumBytes) << path_;
+  CHECK_LE(index_offset, num_bytes) << path_;
+
+  ChunkParser index_parser(data + index_offset, num_bytes - index_offset);
+  chunks_.resize(index_parser.Read<uint64_t>());
+  for (auto& chunk : chunks_) {
+    const uint32_t type = index_parser.Read<uint32_t>();
+    CHECK_LE(type, static_cast<uint32_t>(ChunkType::POINTS3D)) << path_;
+    chunk.type = static_cast<ChunkType>(type);
+    chunk.compressed = index_parser.Read<uint32_t>() != 0;
+    chunk.offset = index_parser.Read<uint64_t>();
+    chunk.num_bytes = index_parser.Read<uint64_t>();
+    chunk.num_raw_bytes = index_parser.Read<uint64_t>();
+    chunk.num_items = index_parser.Read<uint64_t>();
+    for (int d = 0; d < 3; ++d) {
+      chunk.bbox_min(d) = index_parser.Read<double>();
+    }
+    for (int d = 0; d < 3; ++d) {
+      chunk.bbox_max(d) = index_parser.Read<double>();
+    }
+    CHECK_LE(chunk.offset + chunk.num_bytes, index_offset) << path_;
+  }
+}
+
+const std::vector<ChunkedReconstructionReader::Chunk>&
+ChunkedReconstructionReader::Chunks() const {
+  return chunks_;
+}
+
+size_t ChunkedReconstructionReader::NumCameras() const {
+  size_t num_cameras = 0;
+  for (const auto& chunk : chunks_) {
+    if (chunk.type == ChunkType::CAMERAS) {
+      num_cameras += chunk.num_items;
+    }
+  }
+  return num_cameras;
+}
+
+size_t ChunkedReconstructionReader::NumImages() const {
+  size_t num_images = 0;
+  for (const auto& chunk : chunks_) {
+    if (chunk.type == ChunkType::IMAGE_POSES) {
+      num_images += chunk.num_items;
+    }
+  }
+  return num_images;
+}
+
+size_t ChunkedReconstructionReader::NumPoints3D() const {
+  size_t num_points3D = 0;
+  for (const auto& chunk : chunks_) {
+    if (chunk.type == ChunkType::POINTS3D) {
+      num_points3D += chunk.num_items;
+    }
+  }
+  return num_points3D;
+}
+
+EIGEN_STL_UMAP(camera_t, class Camera)
+ChunkedReconstructionReader::ReadCameras() const {
+  EIGEN_STL_UMAP(camera_t, class Camera) cameras;
+  std::vector<char> buffer;
+  for (size_t chunk_idx = 0; chunk_idx < chunks_.size(); ++chunk_idx) {
+    const Chunk& chunk = chunks_[chunk_idx];
+    if (chunk.type != ChunkType::CAMERAS) {
+      continue;
+    }
+
+    ChunkParser parser(ChunkData(chunk_idx, &buffer), chunk.num_raw_bytes);
+    for (size_t i = 0; i < chunk.num_items; ++i) {
+      class Camera camera;
+      camera.SetCameraId(parser.Read<camera_t>());
+      camera.SetModelId(parser.Read<int>());
+      camera.SetWidth(parser.Read<uint64_t>());
+      camera.SetHeight(parser.Read<uint64_t>());
+      for (double& param : camera.Params()) {
+        param = parser.Read<double>();
+      }
+      CHECK(camera.VerifyParams());
+      cameras.emplace(camera.CameraId(), camera);
+    }
+  }
+  return cameras;
+}
+
+EIGEN_STL_UMAP(image_t, class Image)
+ChunkedReconstructionReader::ReadImages(const bool with_points2D) const {
+  EIGEN_STL_UMAP(image_t, class Image) images;
+  images.reserve(NumImages());
+
+  std::vector<char> buffer;
+  for (size_t chunk_idx = 0; chunk_idx < chunks_.size(); ++chunk_idx) {
+    const Chunk& chunk = chunks_[chunk_idx];
+    if (chunk.type != ChunkType::IMAGE_POSES) {
+      continue;
+    }
+
+    ChunkParser parser(ChunkData(chunk_idx, &buffer), chunk.num_raw_bytes);
+    for (size_t i = 0; i < chunk.num_items; ++i) {
+      class Image image;
+      image.SetImageId(parser.Read<image_t>());
+      for (int d = 0; d < 4; ++d) {
+        image.Qvec(d) = parser.Read<double>();
+      }
+      image.NormalizeQvec();
+      for (int d = 0; d < 3; ++d) {
+        image.Tvec(d) = parser.Read<double>();
+      }
+      image.SetCameraId(parser.Read<camera_t>());
+      image.SetName(parser.ReadString());
+      images.emplace(image.ImageId(), image);
+    }
+  }
+
+  if (!with_points2D) {
+    return images;
+  }
+
+  for (size_t chunk_idx = 0; chunk_idx < chunks_.size(); ++chunk_idx) {
+    const Chunk& chunk = chunks_[chunk_idx];
+    if (chunk.type != ChunkType::IMAGE_POINTS2D) {
+      continue;
+    }
+
+    ChunkParser parser(ChunkData(chunk_idx, &buffer), chunk.num_raw_bytes);
+    for (size_t i = 0; i < chunk.num_items; ++i) {
+      class Image& image = images.at(parser.Read<image_t>());
+
+      const size_t num_points2D = parser.Read<uint64_t>();
+      std::vector<Eigen::Vector2d> points2D;
+      points2D.reserve(num_points2D);
+      std::vector<point3D_t> point3D_ids;
+      point3D_ids.reserve(num_points2D);
+      for (size_t j = 0; j < num_points2D; ++j) {
+        const double x = parser.Read<double>();
+        const double y = parser.Read<double>();
+        points2D.emplace_back(x, y);
+        point3D_ids.push_back(parser.Read<point3D_t>());
+      }
+
+      image.SetPoints2D(points2D);
+      for (point2D_t point2D_idx = 0; point2D_idx < num_points2D;
+           ++point2D_idx) {
+        if (point3D_ids[point2D_idx] != kInvalidPoint3DId) {
+          image.SetPoint3DForPoint2D(point2D_idx, point3D_ids[point2D_idx]);
+        }
+      }
+    }
+  }
+
+  return images;
+}
+
+std::unordered_map<point3D_t, class Point3D>
+ChunkedReconstructionReader::ReadPoints3D() const {
+  std::unordered_map<point3D_t, class Point3D> points3D;
+  points3D.reserve(NumPoints3D());
+  for (size_t chunk_idx = 0; chunk_idx < chunks_.size(); ++chunk_idx) {
+    if (chunks_[chunk_idx].type == ChunkType::POINTS3D) {
+      ReadPoints3DChunk(chunk_idx, &points3D);
+    }
+  }
+  return points3D;
+}
+
+std::unordered_map<point3D_t, class Point3D>
+ChunkedReconstructionReader::ReadPoints3DInBox(
+    const Eigen::Vector3d& bbox_min, const Eigen::Vector3d& bbox_max) const {
+  std::unordered_map<point3D_t, class Point3D> points3D;
+  std::unordered_map<point3D_t, class Point3D> chunk_points3D;
+  for (size_t chunk_idx = 0; chunk_idx < chunks_.size(); ++chunk_idx) {
+    const Chunk& chunk = chunks_[chunk_idx];
+    if (chunk.type != ChunkType::POINTS3D ||
+        (chunk.bbox_max.array() < bbox_min.array()).any() ||
+        (chunk.bbox_min.array() > bbox_max.array()).any()) {
+      continue;
+    }
+
+    chunk_points3D.clear();
+    ReadPoints3DChunk(chunk_idx, &chunk_points3D);
+    for (auto& point3D : chunk_points3D) {
+      const Eigen::Vector3d& xyz = point3D.second.XYZ();
+      if ((xyz.array() >= bbox_min.array()).all() &&
+          (xyz.array() <= bbox_max.array()).all()) {
+        points3D.emplace(point3D.first, std::move(point3D.second));
+      }
+    }
+  }
+  return points3D;
+}
+
+void ChunkedReconstructionReader::ReadPoints3DChunk(
+    const size_t chunk_idx,
+    std::unordered_map<point3D_t, class Point3D>* points3D) const {
+  CHECK_NOTNULL(points3D);
+  const Chunk& chunk = chunks_.at(chunk_idx);
+  CHECK(chunk.type == ChunkType::POINTS3D);
+
+  std::vector<char> buffer;
+  ChunkParser parser(ChunkData(chunk_idx, &buffer), chunk.num_raw_bytes);
+  for (size_t i = 0; i < chunk.num_items; ++i) {
+    class Point3D point3D;
+
+    const point3D_t point3D_id = parser.Read<point3D_t>();
+    for (int d = 0; d < 3; ++d) {
+      point3D.XYZ()(d) = parser.Read<double>();
+    }
+    for (int d = 0; d < 3; ++d) {
+      point3D.Color(d) = parser.Read<uint8_t>();
+    }
+    point3D.SetError(parser.Read<double>());
+
+    const size_t track_length = parser.Read<uint64_t>();
+    point3D.Track().Reserve(track_length);
+    for (size_t j = 0; j < track_length; ++j) {
+      const image_t image_id = parser.Read<image_t>();
+      const point2D_t point2D_idx = parser.Read<point2D_t>();
+      point3D.Track().AddElement(image_id, point2D_idx);
+    }
+
+    points3D->emplace(point3D_id, std::move(point3D));
+  }
+}
+
+const char* ChunkedReconstructionReader::ChunkData(
+    const size_t chunk_idx, std::vector<char>* buffer) const {
+  const Chunk& chunk = chunks_.at(chunk_idx);
+  const char* data =
+      static_cast<const char*>(mapped_region_->get_address()) + chunk.offset;
+
+  if (!chunk.compressed) {
+    CHECK_EQ(chunk.num_bytes, chunk.num_raw_bytes) << path_;
+    return data;
+  }
+
+#ifdef ZLIB_ENABLED
+  buffer->resize(chunk.num_raw_bytes);
+  uLongf num_raw_bytes = chunk.num_raw_bytes;
+  CHECK_EQ(uncompress(reinterpret_cast<Bytef*>(buffer->data()),
+                      &num_raw_bytes, reinterpret_cast<const Bytef*>(data),
+                      chunk.num_bytes),
+           Z_OK)
+      << path_;
+  CHECK_EQ(num_raw_bytes, chunk.num_raw_bytes) << path_;
+  return buffer->data();
+#else
+  LOG(FATAL) << "Reading compressed chunks requires zlib: " << path_;
+  return nullptr;
+#endif
+}
+
+}  // namespace colmap
@@ -0,0 +1,157 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+#ifndef COLMAP_SRC_BASE_RECONSTRUCTION_CHUNKS_H_
+#define COLMAP_SRC_BASE_RECONSTRUCTION_CHUNKS_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "base/camera.h"
+#include "base/image.h"
+#include "base/point3d.h"
+#include "util/alignment.h"
+#include "util/types.h"
+
+namespace boost {
+namespace interprocess {
+class mapped_region;
+}  // namespace interprocess
+}  // namespace boost
+
+namespace colmap {
+
+class Reconstruction;
+
+// Chunked binary format of a reconstruction in a single file. In contrast to
+// the `cameras.bin`, `images.bin`, `points3D.bin` format, the data is split
+// into independent chunks, which are listed in an index at the end of the
+// file. The poses and the 2D points of the images are stored in separate
+// chunks and the 3D points are sorted along a space-filling curve, such that
+// each chunk of 3D points covers a compact region with a known bounding box.
+// Readers can thus load only the poses or only the 3D points in a region of
+// interest. Each chunk starts at an aligned offset and is read through a
+// memory mapping of the file. If compiled with zlib, chunks can optionally be
+// compressed.
+struct ChunkedReconstructionOptions {
+  // The maximum number of images per chunk.
+  int max_num_images_per_chunk = 1000;
+
+  // The maximum number of 3D points per chunk.
+  int max_num_points3D_per_chunk = 100000;
+
+  // Whether to compress the chunks. Ignored if compiled without zlib.
+  bool compress = false;
+
+  bool Check() const;
+};
+
+// Write the registered images, their cameras and all 3D points of the
+// reconstruction to the given file.
+void WriteChunkedReconstruction(const Reconstruction& reconstruction,
+                                const std::string& path,
+                                const ChunkedReconstructionOptions& options);
+
+// Reader of the chunked format, which only reads the index on construction.
+// All other data is read lazily on request. The class is not thread-safe.
+class ChunkedReconstructionReader {
+ public:
+  enum class ChunkType : uint32_t {
+    CAMERAS = 0,
+    IMAGE_POSES = 1,
+    IMAGE_POINTS2D = 2,
+    POINTS3D = 3,
+  };
+
+  struct Chunk {
+    ChunkType type = ChunkType::CAMERAS;
+    // Whether the data of the chunk is compressed.
+    bool compressed = false;
+    // The byte offset and size of the stored data in the file.
+    uint64_t offset = 0;
+    uint64_t num_bytes = 0;
+    // The size of the data after decompression.
+    uint64_t num_raw_bytes = 0;
+    // The number of cameras, images, or 3D points in the chunk.
+    uint64_t num_items = 0;
+    // The bounding box of the 3D points or the projection centers.
+    Eigen::Vector3d bbox_min = Eigen::Vector3d::Zero();
+    Eigen::Vector3d bbox_max = Eigen::Vector3d::Zero();
+  };
+
+  // The file name of the chunked format inside a reconstruction directory.
+  static const std::string kFileName;
+
+  explicit ChunkedReconstructionReader(const std::string& path);
+
+  const std::vector<Chunk>& Chunks() const;
+
+  size_t NumCameras() const;
+  size_t NumImages() const;
+  size_t NumPoints3D() const;
+
+  // Read all cameras.
+  EIGEN_STL_UMAP(camera_t, class Camera) ReadCameras() const;
+
+  // Read all images with or without their 2D points. Reading only the poses,
+  // names and camera identifiers does not touch the chunks of 2D points.
+  EIGEN_STL_UMAP(image_t, class Image) ReadImages(
+      const bool with_points2D) const;
+
+  // Read all 3D points or only the ones inside the given axis-aligned box,
+  // in which case only the chunks overlapping with the box are read.
+  std::unordered_map<point3D_t, class Point3D> ReadPoints3D() const;
+  std::unordered_map<point3D_t, class Point3D> ReadPoints3DInBox(
+      const Eigen::Vector3d& bbox_min, const Eigen::Vector3d& bbox_max) const;
+
+  // Read the 3D points of a single chunk of type `POINTS3D`.
+  void ReadPoints3DChunk(
+      const size_t chunk_idx,
+      std::unordered_map<point3D_t, class Point3D>* points3D) const;
+
+ private:
+  // Return the decompressed data of the chunk. For uncompressed chunks, the
+  // data points into the memory mapping and the buffer remains empty.
+  const char* ChunkData(const size_t chunk_idx,
+                        std::vector<char>* buffer) const;
+
+  const std::string path_;
+  std::vector<Chunk> chunks_;
+  std::shared_ptr<const boost::interprocess::mapped_region> mapped_region_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_BASE_RECONSTRUCTION_CHUNKS_H_
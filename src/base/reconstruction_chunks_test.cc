@@ -0,0 +1,224 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+#define TEST_NAME "base/reconstruction_chunks"
+#include "util/testing.h"
+
+#include "base/reconstruction.h"
+#include "base/reconstruction_chunks.h"
+#include "util/misc.h"
+
+using namespace colmap;
+
+namespace {
+
+std::string CreateTestDir() {
+  const auto path = boost::filesystem::temp_directory_path() /
+                    boost::filesystem::unique_path();
+  CreateDirIfNotExists(path.string());
+  return path.string();
+}
+
+void GenerateReconstruction(const image_t num_images,
+                            const size_t num_points3D,
+                            Reconstruction* reconstruction) {
+  Camera camera;
+  camera.SetCameraId(1);
+  camera.InitializeWithName("SIMPLE_RADIAL", 100, 200, 300);
+  reconstruction->AddCamera(camera);
+
+  for (image_t image_id = 1; image_id <= num_images; ++image_id) {
+    Image image;
+    image.SetImageId(image_id);
+    image.SetCameraId(1);
+    image.SetName("image" + std::to_string(image_id));
+    image.Tvec() = Eigen::Vector3d(image_id, 0, 0);
+    image.SetPoints2D(std::vector<Eigen::Vector2d>(
+        num_points3D, Eigen::Vector2d(image_id, 2 * image_id)));
+    reconstruction->AddImage(image);
+    reconstruction->RegisterImage(image_id);
+  }
+
+  for (size_t i = 0; i < num_points3D; ++i) {
+    Track track;
+    track.AddElement(1, i);
+    track.AddElement(2, i);
+    const point3D_t point3D_id = reconstruction->AddPoint3D(
+        Eigen::Vector3d(i, i % 7, -static_cast<double>(i)), track,
+        Eigen::Vector3ub(i % 256, 1, 2));
+    reconstruction->Point3D(point3D_id).SetError(0.5 * i);
+  }
+}
+
+void CheckEqualReconstructions(const Reconstruction& reconstruction1,
+                               const Reconstruction& reconstruction2) {
+  BOOST_CHECK_EQUAL(reconstruction1.NumCameras(),
+                    reconstruction2.NumCameras());
+  for (const auto& camera : reconstruction1.Cameras()) {
+    const Camera& camera2 = reconstruction2.Camera(camera.first);
+    BOOST_CHECK_EQUAL(camera.second.ModelId(), camera2.ModelId());
+    BOOST_CHECK_EQUAL(camera.second.Width(), camera2.Width());
+    BOOST_CHECK_EQUAL(camera.second.Height(), camera2.Height());
+    BOOST_CHECK(camera.second.Params() == camera2.Params());
+  }
+
+  BOOST_CHECK_EQUAL(reconstruction1.NumRegImages(),
+                    reconstruction2.NumRegImages());
+  for (const image_t image_id : reconstruction1.RegImageIds()) {
+    const Image& image1 = reconstruction1.Image(image_id);
+    const Image& image2 = reconstruction2.Image(image_id);
+    BOOST_CHECK(image2.IsRegistered());
+    BOOST_CHECK_EQUAL(image1.Name(), image2.Name());
+    BOOST_CHECK_EQUAL(image1.CameraId(), image2.CameraId());
+    BOOST_CHECK(image1.Qvec() == image2.Qvec());
+    BOOST_CHECK(image1.Tvec() == image2.Tvec());
+    BOOST_CHECK_EQUAL(image1.NumPoints2D(), image2.NumPoints2D());
+    BOOST_CHECK_EQUAL(image1.NumPoints3D(), image2.NumPoints3D());
+    for (point2D_t point2D_idx = 0; point2D_idx < image1.NumPoints2D();
+         ++point2D_idx) {
+      BOOST_CHECK(image1.Point2D(point2D_idx).XY() ==
+                  image2.Point2D(point2D_idx).XY());
+      BOOST_CHECK_EQUAL(image1.Point2D(point2D_idx).Point3DId(),
+                        image2.Point2D(point2D_idx).Point3DId());
+    }
+  }
+
+  BOOST_CHECK_EQUAL(reconstruction1.NumPoints3D(),
+                    reconstruction2.NumPoints3D());
+  for (const auto& point3D : reconstruction1.Points3D()) {
+    const Point3D& point3D2 = reconstruction2.Point3D(point3D.first);
+    BOOST_CHECK(point3D.second.XYZ() == point3D2.XYZ());
+    BOOST_CHECK(point3D.second.Color() == point3D2.Color());
+    BOOST_CHECK_EQUAL(point3D.second.Error(), point3D2.Error());
+    BOOST_CHECK_EQUAL(point3D.second.Track().Length(),
+                      point3D2.Track().Length());
+  }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(TestWriteRead) {
+  Reconstruction reconstruction;
+  GenerateReconstruction(5, 100, &reconstruction);
+
+  ChunkedReconstructionOptions options;
+  options.max_num_images_per_chunk = 2;
+  options.max_num_points3D_per_chunk = 30;
+
+  const std::string path = CreateTestDir();
+  reconstruction.WriteChunked(path, options);
+
+  ChunkedReconstructionReader reader(
+      JoinPaths(path, ChunkedReconstructionReader::kFileName));
+  // One camera chunk, three times two image chunks, four 3D point chunks.
+  BOOST_CHECK_EQUAL(reader.Chunks().size(), 11);
+  BOOST_CHECK_EQUAL(reader.NumCameras(), 1);
+  BOOST_CHECK_EQUAL(reader.NumImages(), 5);
+  BOOST_CHECK_EQUAL(reader.NumPoints3D(), 100);
+
+  Reconstruction read_reconstruction;
+  read_reconstruction.Read(path);
+  CheckEqualReconstructions(reconstruction, read_reconstruction);
+
+  // Reconstructions with new 3D points must not reuse existing identifiers.
+  const point3D_t point3D_id =
+      read_reconstruction.AddPoint3D(Eigen::Vector3d::Zero(), Track());
+  BOOST_CHECK(!reconstruction.ExistsPoint3D(point3D_id));
+
+  boost::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_CASE(TestWriteReadCompressed) {
+  Reconstruction reconstruction;
+  GenerateReconstruction(3, 50, &reconstruction);
+
+  ChunkedReconstructionOptions options;
+  options.max_num_points3D_per_chunk = 20;
+  options.compress = true;
+
+  const std::string path = CreateTestDir();
+  reconstruction.WriteChunked(path, options);
+
+  Reconstruction read_reconstruction;
+  read_reconstruction.ReadChunked(path);
+  CheckEqualReconstructions(reconstruction, read_reconstruction);
+
+  boost::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_CASE(TestReadImagesWithoutPoints2D) {
+  Reconstruction reconstruction;
+  GenerateReconstruction(3, 10, &reconstruction);
+
+  const std::string path = CreateTestDir();
+  reconstruction.WriteChunked(path);
+
+  ChunkedReconstructionReader reader(
+      JoinPaths(path, ChunkedReconstructionReader::kFileName));
+  const auto images = reader.ReadImages(/*with_points2D=*/false);
+  BOOST_CHECK_EQUAL(images.size(), 3);
+  for (const auto& image : images) {
+    BOOST_CHECK_EQUAL(image.second.NumPoints2D(), 0);
+    BOOST_CHECK_EQUAL(image.second.Name(),
+                      reconstruction.Image(image.first).Name());
+    BOOST_CHECK(image.second.Tvec() == reconstruction.Image(image.first).Tvec());
+  }
+
+  boost::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_CASE(TestReadPoints3DInBox) {
+  Reconstruction reconstruction;
+  GenerateReconstruction(2, 100, &reconstruction);
+
+  ChunkedReconstructionOptions options;
+  options.max_num_points3D_per_chunk = 10;
+
+  const std::string path = CreateTestDir();
+  reconstruction.WriteChunked(path, options);
+
+  ChunkedReconstructionReader reader(
+      JoinPaths(path, ChunkedReconstructionReader::kFileName));
+  BOOST_CHECK_EQUAL(reader.ReadPoints3D().size(), 100);
+
+  const Eigen::Vector3d bbox_min(10, 0, -50);
+  const Eigen::Vector3d bbox_max(50, 10, 0);
+  const auto points3D = reader.ReadPoints3DInBox(bbox_min, bbox_max);
+  BOOST_CHECK_EQUAL(points3D.size(), 41);
+  for (const auto& point3D : points3D) {
+    BOOST_CHECK((point3D.second.XYZ().array() >= bbox_min.array()).all());
+    BOOST_CHECK((point3D.second.XYZ().array() <= bbox_max.array()).all());
+    BOOST_CHECK(point3D.second.XYZ() ==
+                reconstruction.Point3D(point3D.first).XYZ());
+  }
+
+  boost::filesystem::remove_all(path);
+}
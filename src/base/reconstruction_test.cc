@@ -32,11 +32,16 @@
 #define TEST_NAME "base/reconstruction"
 #include "util/testing.h"
 
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
 #include "base/camera_models.h"
 #include "base/correspondence_graph.h"
 #include "base/pose.h"
 #include "base/reconstruction.h"
 #include "base/similarity_transform.h"
+#include "util/misc.h"
 
 using namespace colmap;
 
@@ -180,6 +185,175 @@ BOOST_AUTO_TEST_CASE(TestMergePoints3D) {
                     Eigen::Vector3ub(10, 10, 10));
 }
 
+BOOST_AUTO_TEST_CASE(TestImageCovisibility) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(3, &reconstruction, &correspondence_graph);
+  BOOST_CHECK(reconstruction.ImageCovisibility(1).empty());
+  const point3D_t point3D_id1 =
+      reconstruction.AddPoint3D(Eigen::Vector3d::Zero(), Track());
+  reconstruction.AddObservation(point3D_id1, TrackElement(1, 0));
+  reconstruction.AddObservation(point3D_id1, TrackElement(2, 0));
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(1).size(), 1);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(1).at(2), 1);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(2).at(1), 1);
+  reconstruction.AddObservation(point3D_id1, TrackElement(3, 0));
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(1).size(), 2);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(1).at(3), 1);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(3).at(2), 1);
+
+  Track track;
+  track.AddElement(1, 1);
+  track.AddElement(2, 1);
+  const point3D_t point3D_id2 =
+      reconstruction.AddPoint3D(Eigen::Vector3d::Zero(), track);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(1).at(2), 2);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(2).at(1), 2);
+
+  // Every observation of the merged point in one image is counted for every
+  // observation in the other images.
+  const point3D_t merged_point3D_id =
+      reconstruction.MergePoints3D(point3D_id1, point3D_id2);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(1).at(2), 4);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(2).at(1), 4);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(1).at(3), 2);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(3).at(2), 2);
+
+  reconstruction.DeleteObservation(3, 0);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(1).size(), 1);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(1).at(2), 4);
+  BOOST_CHECK(reconstruction.ImageCovisibility(3).empty());
+
+  reconstruction.DeletePoint3D(merged_point3D_id);
+  BOOST_CHECK(reconstruction.ImageCovisibility(1).empty());
+  BOOST_CHECK(reconstruction.ImageCovisibility(2).empty());
+
+  // The co-visibility is only maintained while the reconstruction is set up
+  // and recomputed from the existing 3D points.
+  reconstruction.AddPoint3D(Eigen::Vector3d::Zero(), track);
+  reconstruction.TearDown();
+  BOOST_CHECK(reconstruction.ImageCovisibility(1).empty());
+  reconstruction.SetUp(&correspondence_graph);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(1).size(), 1);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(1).at(2), 1);
+  BOOST_CHECK_EQUAL(reconstruction.ImageCovisibility(2).at(1), 1);
+}
+
+// Generate a reconstruction with the given registered images along the x-axis
+// that all observe the same grid of 3D points.
+void GenerateMergeReconstruction(const image_t first_image_id,
+                                 const image_t last_image_id,
+                                 Reconstruction* reconstruction) {
+  Camera camera;
+  camera.SetCameraId(1);
+  camera.InitializeWithName("PINHOLE", 100, 100, 100);
+  reconstruction->AddCamera(camera);
+
+  std::vector<Eigen::Vector3d> points3D;
+  for (int x = -2; x <= 2; ++x) {
+    for (int y = -2; y <= 2; ++y) {
+      points3D.emplace_back(x, y, 10 + x * y * 0.1);
+    }
+  }
+
+  for (image_t image_id = first_image_id; image_id <= last_image_id;
+       ++image_id) {
+    Image image;
+    image.SetImageId(image_id);
+    image.SetCameraId(1);
+    image.SetName("image" + std::to_string(image_id));
+    image.Tvec() = Eigen::Vector3d(-0.5 * image_id, 0.1 * image_id, 0);
+    std::vector<Eigen::Vector2d> points2D;
+    for (const auto& xyz : points3D) {
+      const Eigen::Vector3d point_in_image = xyz + image.Tvec();
+      points2D.push_back(camera.WorldToImage(point_in_image.hnormalized()));
+    }
+    image.SetPoints2D(points2D);
+    reconstruction->AddImage(image);
+    reconstruction->RegisterImage(image_id);
+  }
+
+  for (point2D_t point2D_idx = 0; point2D_idx < points3D.size();
+       ++point2D_idx) {
+    Track track;
+    for (image_t image_id = first_image_id; image_id <= last_image_id;
+         ++image_id) {
+      track.AddElement(image_id, point2D_idx);
+    }
+    reconstruction->AddPoint3D(points3D[point2D_idx], track,
+                               Eigen::Vector3ub(10, 10, 10));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestMerge) {
+  Reconstruction reconstruction1;
+  GenerateMergeReconstruction(1, 4, &reconstruction1);
+  Reconstruction reconstruction2;
+  GenerateMergeReconstruction(2, 5, &reconstruction2);
+  reconstruction2.Transform(SimilarityTransform3(
+      2, ComposeIdentityQuaternion(), Eigen::Vector3d(1, 2, 3)));
+
+  const size_t num_points3D = reconstruction1.NumPoints3D();
+  BOOST_CHECK(reconstruction1.Merge(reconstruction2, 1e-3));
+  BOOST_CHECK_EQUAL(reconstruction1.NumRegImages(), 5);
+  BOOST_CHECK_EQUAL(reconstruction1.NumPoints3D(), num_points3D);
+  for (const auto& point3D : reconstruction1.Points3D()) {
+    BOOST_CHECK_EQUAL(point3D.second.Track().Length(), 5);
+  }
+
+  const auto& image5 = reconstruction1.Image(5);
+  BOOST_CHECK(image5.Tvec().isApprox(Eigen::Vector3d(-2.5, 0.5, 0), 1e-6));
+  for (const auto& point2D : image5.Points2D()) {
+    BOOST_CHECK(point2D.HasPoint3D());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestMergeWithAlignments) {
+  Reconstruction reconstruction;
+  GenerateMergeReconstruction(1, 4, &reconstruction);
+  Reconstruction reconstruction1;
+  GenerateMergeReconstruction(2, 5, &reconstruction1);
+  reconstruction1.Transform(SimilarityTransform3(
+      2, ComposeIdentityQuaternion(), Eigen::Vector3d(1, 2, 3)));
+  Reconstruction reconstruction2;
+  GenerateMergeReconstruction(6, 8, &reconstruction2);
+  Reconstruction reconstruction3;
+  GenerateMergeReconstruction(2, 6, &reconstruction3);
+  reconstruction3.Transform(SimilarityTransform3(
+      0.5, ComposeIdentityQuaternion(), Eigen::Vector3d(-1, 0, 1)));
+
+  for (const int num_threads : {1, 4}) {
+    std::vector<Eigen::Matrix3x4d> alignments;
+    const std::vector<bool> success = ComputeAlignmentsBetweenReconstructions(
+        {&reconstruction1, &reconstruction2, &reconstruction3}, reconstruction,
+        0.3, 1e-3, num_threads, &alignments);
+    BOOST_CHECK_EQUAL(success.size(), 3);
+    BOOST_CHECK_EQUAL(alignments.size(), 3);
+    BOOST_CHECK(success[0]);
+    BOOST_CHECK(!success[1]);
+    BOOST_CHECK(success[2]);
+
+    const SimilarityTransform3 tform1(alignments[0]);
+    Eigen::Vector3d proj_center1 = reconstruction1.Image(2).ProjectionCenter();
+    tform1.TransformPoint(&proj_center1);
+    BOOST_CHECK(proj_center1.isApprox(
+        reconstruction.Image(2).ProjectionCenter(), 1e-6));
+
+    const SimilarityTransform3 tform3(alignments[2]);
+    Eigen::Vector3d proj_center3 = reconstruction3.Image(4).ProjectionCenter();
+    tform3.TransformPoint(&proj_center3);
+    BOOST_CHECK(proj_center3.isApprox(
+        reconstruction.Image(4).ProjectionCenter(), 1e-6));
+
+    if (num_threads == 1) {
+      reconstruction.Merge(reconstruction1, alignments[0], 1e-3);
+      BOOST_CHECK_EQUAL(reconstruction.NumRegImages(), 5);
+      BOOST_CHECK(reconstruction.Image(5).Tvec().isApprox(
+          Eigen::Vector3d(-2.5, 0.5, 0), 1e-6));
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestDeletePoint3D) {
   Reconstruction reconstruction;
   CorrespondenceGraph correspondence_graph;
@@ -428,6 +602,65 @@ BOOST_AUTO_TEST_CASE(TestFilterAllPoints) {
   BOOST_CHECK_EQUAL(reconstruction.NumPoints3D(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(TestFilterAllPointsMultiThreaded) {
+  const size_t kNumPoints3D = 10000;
+  const size_t kNumImages = 3;
+
+  size_t num_filtered[2];
+  size_t num_points3D[2];
+  double mean_reproj_error[2];
+  const int num_threads[2] = {1, 4};
+  for (int i = 0; i < 2; ++i) {
+    Reconstruction reconstruction;
+    CorrespondenceGraph correspondence_graph;
+
+    Camera camera;
+    camera.SetCameraId(1);
+    camera.InitializeWithName("PINHOLE", 1, 1, 1);
+    reconstruction.AddCamera(camera);
+
+    for (image_t image_id = 1; image_id <= kNumImages; ++image_id) {
+      Image image;
+      image.SetImageId(image_id);
+      image.SetCameraId(1);
+      image.SetName("image" + std::to_string(image_id));
+      image.SetTvec(Eigen::Vector3d(0.1 * image_id, 0, 0));
+      std::vector<Eigen::Vector2d> points2D(kNumPoints3D);
+      for (size_t j = 0; j < kNumPoints3D; ++j) {
+        const double noise = image_id == 1 ? 1e-5 * j : 0;
+        points2D[j] = Eigen::Vector2d(
+            0.1 * image_id / (1.0 + 1e-3 * j) + 0.5 + noise, 0.5);
+      }
+      image.SetPoints2D(points2D);
+      reconstruction.AddImage(image);
+      reconstruction.RegisterImage(image_id);
+      correspondence_graph.AddImage(image_id, kNumPoints3D);
+    }
+
+    reconstruction.SetUp(&correspondence_graph);
+
+    for (size_t j = 0; j < kNumPoints3D; ++j) {
+      Track track;
+      for (image_t image_id = 1; image_id <= kNumImages; ++image_id) {
+        track.AddElement(image_id, j);
+      }
+      reconstruction.AddPoint3D(Eigen::Vector3d(0, 0, 1.0 + 1e-3 * j), track);
+    }
+
+    num_filtered[i] =
+        reconstruction.FilterAllPoints3D(0.05, 1.0, num_threads[i]);
+    num_points3D[i] = reconstruction.NumPoints3D();
+    mean_reproj_error[i] =
+        reconstruction.ComputeMeanReprojectionError(num_threads[i]);
+  }
+
+  BOOST_CHECK_GT(num_filtered[0], 0);
+  BOOST_CHECK_GT(num_points3D[0], 0);
+  BOOST_CHECK_EQUAL(num_filtered[0], num_filtered[1]);
+  BOOST_CHECK_EQUAL(num_points3D[0], num_points3D[1]);
+  BOOST_CHECK_EQUAL(mean_reproj_error[0], mean_reproj_error[1]);
+}
+
 BOOST_AUTO_TEST_CASE(TestFilterObservationsWithNegativeDepth) {
   Reconstruction reconstruction;
   CorrespondenceGraph correspondence_graph;
@@ -532,3 +765,524 @@ BOOST_AUTO_TEST_CASE(TestComputeMeanReprojectionError) {
   reconstruction.Point3D(point3D_id1).SetError(2.0);
   BOOST_CHECK_EQUAL(reconstruction.ComputeMeanReprojectionError(), 2.0);
 }
+
+BOOST_AUTO_TEST_CASE(TestComputeStatistics) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(2, &reconstruction, &correspondence_graph);
+  const point3D_t point3D_id1 =
+      reconstruction.AddPoint3D(Eigen::Vector3d::Random(), Track());
+  reconstruction.AddObservation(point3D_id1, TrackElement(1, 0));
+  reconstruction.AddObservation(point3D_id1, TrackElement(2, 0));
+  reconstruction.Point3D(point3D_id1).SetError(2.0);
+  const point3D_t point3D_id2 =
+      reconstruction.AddPoint3D(Eigen::Vector3d::Random(), Track());
+  reconstruction.AddObservation(point3D_id2, TrackElement(1, 1));
+  reconstruction.Point3D(point3D_id2).SetError(1.0);
+
+  for (const int num_threads : {1, 4}) {
+    const Reconstruction::Statistics statistics =
+        reconstruction.ComputeStatistics(num_threads);
+    BOOST_CHECK_EQUAL(statistics.num_cameras, 1);
+    BOOST_CHECK_EQUAL(statistics.num_images, 2);
+    BOOST_CHECK_EQUAL(statistics.num_reg_images, 2);
+    BOOST_CHECK_EQUAL(statistics.num_points3D, 2);
+    BOOST_CHECK_EQUAL(statistics.num_observations,
+                      reconstruction.ComputeNumObservations());
+    BOOST_CHECK_EQUAL(statistics.mean_track_length,
+                      reconstruction.ComputeMeanTrackLength());
+    BOOST_CHECK_EQUAL(statistics.mean_observations_per_reg_image,
+                      reconstruction.ComputeMeanObservationsPerRegImage());
+    BOOST_CHECK_EQUAL(statistics.mean_reprojection_error,
+                      reconstruction.ComputeMeanReprojectionError());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestFilterPoints3DStatisticalOutliers) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(1, &reconstruction, &correspondence_graph);
+  // A dense grid of points and a single far away point.
+  for (int x = 0; x < 10; ++x) {
+    for (int y = 0; y < 10; ++y) {
+      reconstruction.AddPoint3D(Eigen::Vector3d(x, y, 0), Track());
+    }
+  }
+  const point3D_t outlier_point3D_id =
+      reconstruction.AddPoint3D(Eigen::Vector3d(100, 100, 100), Track());
+  reconstruction.AddObservation(outlier_point3D_id, TrackElement(1, 0));
+
+  Reconstruction reconstruction_multi_threaded = reconstruction;
+  BOOST_CHECK_EQUAL(
+      reconstruction.FilterPoints3DStatisticalOutliers(4, 2.0, 1), 1);
+  BOOST_CHECK_EQUAL(reconstruction.NumPoints3D(), 100);
+  BOOST_CHECK(!reconstruction.ExistsPoint3D(outlier_point3D_id));
+  BOOST_CHECK(!reconstruction.Image(1).Point2D(0).HasPoint3D());
+  BOOST_CHECK_EQUAL(
+      reconstruction_multi_threaded.FilterPoints3DStatisticalOutliers(4, 2.0,
+                                                                      4),
+      1);
+  BOOST_CHECK_EQUAL(reconstruction_multi_threaded.NumPoints3D(), 100);
+
+  // Too few points to find the neighbors.
+  Reconstruction small_reconstruction;
+  small_reconstruction.AddPoint3D(Eigen::Vector3d::Zero(), Track());
+  BOOST_CHECK_EQUAL(
+      small_reconstruction.FilterPoints3DStatisticalOutliers(4, 2.0), 0);
+  BOOST_CHECK_EQUAL(small_reconstruction.NumPoints3D(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestFilterPoints3DWithFewNeighbors) {
+  Reconstruction reconstruction;
+  const point3D_t point3D_id1 =
+      reconstruction.AddPoint3D(Eigen::Vector3d(0, 0, 0), Track());
+  const point3D_t point3D_id2 =
+      reconstruction.AddPoint3D(Eigen::Vector3d(0.5, 0, 0), Track());
+  const point3D_t point3D_id3 =
+      reconstruction.AddPoint3D(Eigen::Vector3d(0, 0.5, 0), Track());
+  const point3D_t point3D_id4 =
+      reconstruction.AddPoint3D(Eigen::Vector3d(2, 0, 0), Track());
+
+  Reconstruction reconstruction_copy = reconstruction;
+  reconstruction_copy.FilterPoints3DWithFewNeighbors(1.0, 0, 4);
+  BOOST_CHECK_EQUAL(reconstruction_copy.NumPoints3D(), 4);
+
+  reconstruction.FilterPoints3DWithFewNeighbors(1.0, 1, 4);
+  BOOST_CHECK_EQUAL(reconstruction.NumPoints3D(), 3);
+  BOOST_CHECK(!reconstruction.ExistsPoint3D(point3D_id4));
+
+  reconstruction.FilterPoints3DWithFewNeighbors(1.0, 2, 1);
+  BOOST_CHECK_EQUAL(reconstruction.NumPoints3D(), 3);
+  BOOST_CHECK(reconstruction.ExistsPoint3D(point3D_id1));
+  BOOST_CHECK(reconstruction.ExistsPoint3D(point3D_id2));
+  BOOST_CHECK(reconstruction.ExistsPoint3D(point3D_id3));
+
+  reconstruction.FilterPoints3DWithFewNeighbors(0.6, 2, 1);
+  BOOST_CHECK_EQUAL(reconstruction.NumPoints3D(), 1);
+  BOOST_CHECK(reconstruction.ExistsPoint3D(point3D_id1));
+}
+
+BOOST_AUTO_TEST_CASE(TestFilterPoints3DInSparseVoxels) {
+  Reconstruction reconstruction;
+  const point3D_t point3D_id1 =
+      reconstruction.AddPoint3D(Eigen::Vector3d(0.1, 0.1, 0.1), Track());
+  const point3D_t point3D_id2 =
+      reconstruction.AddPoint3D(Eigen::Vector3d(0.9, 0.9, 0.9), Track());
+  const point3D_t point3D_id3 =
+      reconstruction.AddPoint3D(Eigen::Vector3d(-0.1, 0.1, 0.1), Track());
+  const point3D_t point3D_id4 =
+      reconstruction.AddPoint3D(Eigen::Vector3d(-0.9, 0.9, 0.9), Track());
+  const point3D_t point3D_id5 =
+      reconstruction.AddPoint3D(Eigen::Vector3d(1.1, 0.1, 0.1), Track());
+
+  reconstruction.FilterPoints3DInSparseVoxels(1.0, 1, 4);
+  BOOST_CHECK_EQUAL(reconstruction.NumPoints3D(), 5);
+
+  reconstruction.FilterPoints3DInSparseVoxels(1.0, 2, 4);
+  BOOST_CHECK_EQUAL(reconstruction.NumPoints3D(), 4);
+  BOOST_CHECK(reconstruction.ExistsPoint3D(point3D_id1));
+  BOOST_CHECK(reconstruction.ExistsPoint3D(point3D_id2));
+  BOOST_CHECK(reconstruction.ExistsPoint3D(point3D_id3));
+  BOOST_CHECK(reconstruction.ExistsPoint3D(point3D_id4));
+  BOOST_CHECK(!reconstruction.ExistsPoint3D(point3D_id5));
+
+  reconstruction.FilterPoints3DInSparseVoxels(10.0, 5, 1);
+  BOOST_CHECK_EQUAL(reconstruction.NumPoints3D(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestModifiedVisibilityImages) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(3, &reconstruction, &correspondence_graph);
+  FeatureMatches matches(1);
+  matches[0].point2D_idx1 = 0;
+  matches[0].point2D_idx2 = 0;
+  correspondence_graph.AddCorrespondences(1, 2, matches);
+  correspondence_graph.AddCorrespondences(1, 3, matches);
+  for (image_t image_id = 1; image_id <= 3; ++image_id) {
+    reconstruction.Image(image_id).SetNumObservations(1);
+  }
+  reconstruction.ClearModifiedVisibilityImages();
+  BOOST_CHECK(reconstruction.GetModifiedVisibilityImages().empty());
+
+  reconstruction.DeRegisterImage(3);
+  BOOST_CHECK_EQUAL(reconstruction.GetModifiedVisibilityImages().size(), 1);
+  BOOST_CHECK_EQUAL(reconstruction.GetModifiedVisibilityImages().count(3), 1);
+  reconstruction.ClearModifiedVisibilityImages();
+
+  // Only the visibility of unregistered images is tracked.
+  Track track;
+  track.AddElement(1, 0);
+  const point3D_t point3D_id =
+      reconstruction.AddPoint3D(Eigen::Vector3d::Zero(), track);
+  BOOST_CHECK_EQUAL(reconstruction.Image(2).NumVisiblePoints3D(), 1);
+  BOOST_CHECK_EQUAL(reconstruction.Image(3).NumVisiblePoints3D(), 1);
+  BOOST_CHECK_EQUAL(reconstruction.GetModifiedVisibilityImages().size(), 1);
+  BOOST_CHECK_EQUAL(reconstruction.GetModifiedVisibilityImages().count(3), 1);
+  reconstruction.ClearModifiedVisibilityImages();
+
+  reconstruction.DeletePoint3D(point3D_id);
+  BOOST_CHECK_EQUAL(reconstruction.Image(3).NumVisiblePoints3D(), 0);
+  BOOST_CHECK_EQUAL(reconstruction.GetModifiedVisibilityImages().count(3), 1);
+  reconstruction.ClearModifiedVisibilityImages();
+
+  reconstruction.RegisterImage(3);
+  BOOST_CHECK_EQUAL(reconstruction.GetModifiedVisibilityImages().count(3), 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestReadChanges) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(3, &reconstruction, &correspondence_graph);
+
+  ReconstructionChanges changes;
+  BOOST_CHECK(reconstruction.ReadChanges(0, &changes));
+  BOOST_CHECK_EQUAL(changes.image_ids.size(), 3);
+  BOOST_CHECK_EQUAL(changes.point3D_ids.size(), 0);
+  BOOST_CHECK(!reconstruction.ReadChanges(reconstruction.Version() + 1,
+                                          &changes));
+
+  const uint64_t version1 = reconstruction.Version();
+  BOOST_CHECK(reconstruction.ReadChanges(version1, &changes));
+  BOOST_CHECK(changes.image_ids.empty());
+  BOOST_CHECK(changes.point3D_ids.empty());
+
+  Track track;
+  track.AddElement(1, 0);
+  track.AddElement(2, 0);
+  const point3D_t point3D_id1 =
+      reconstruction.AddPoint3D(Eigen::Vector3d::Zero(), track);
+  const uint64_t version2 = reconstruction.Version();
+  BOOST_CHECK_GT(version2, version1);
+  BOOST_CHECK(reconstruction.ReadChanges(version1, &changes));
+  BOOST_CHECK_EQUAL(changes.image_ids.size(), 2);
+  BOOST_CHECK_EQUAL(changes.image_ids.count(1), 1);
+  BOOST_CHECK_EQUAL(changes.image_ids.count(2), 1);
+  BOOST_CHECK_EQUAL(changes.point3D_ids.size(), 1);
+  BOOST_CHECK_EQUAL(changes.point3D_ids.count(point3D_id1), 1);
+
+  reconstruction.AddObservation(point3D_id1, TrackElement(3, 0));
+  reconstruction.MarkPoint3DModified(point3D_id1);
+  BOOST_CHECK(reconstruction.ReadChanges(version2, &changes));
+  BOOST_CHECK_EQUAL(changes.image_ids.size(), 1);
+  BOOST_CHECK_EQUAL(changes.image_ids.count(3), 1);
+  BOOST_CHECK_EQUAL(changes.point3D_ids.size(), 1);
+  BOOST_CHECK_EQUAL(changes.point3D_ids.count(point3D_id1), 1);
+
+  const uint64_t version3 = reconstruction.Version();
+  reconstruction.DeRegisterImage(3);
+  BOOST_CHECK(reconstruction.ReadChanges(version3, &changes));
+  BOOST_CHECK_EQUAL(changes.image_ids.count(3), 1);
+  BOOST_CHECK_EQUAL(changes.point3D_ids.count(point3D_id1), 1);
+  BOOST_CHECK(reconstruction.ExistsPoint3D(point3D_id1));
+
+  const uint64_t version4 = reconstruction.Version();
+  reconstruction.DeletePoint3D(point3D_id1);
+  BOOST_CHECK(reconstruction.ReadChanges(version4, &changes));
+  BOOST_CHECK_EQUAL(changes.image_ids.size(), 2);
+  BOOST_CHECK_EQUAL(changes.point3D_ids.size(), 1);
+  BOOST_CHECK_EQUAL(changes.point3D_ids.count(point3D_id1), 1);
+  BOOST_CHECK(!reconstruction.ExistsPoint3D(point3D_id1));
+
+  // Changes before global modifications are no longer available.
+  const uint64_t version5 = reconstruction.Version();
+  reconstruction.Transform(SimilarityTransform3());
+  BOOST_CHECK_GT(reconstruction.Version(), version5);
+  BOOST_CHECK(!reconstruction.ReadChanges(version5, &changes));
+  BOOST_CHECK(reconstruction.ReadChanges(reconstruction.Version(), &changes));
+  BOOST_CHECK(changes.image_ids.empty());
+  BOOST_CHECK(changes.point3D_ids.empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestFindInBoxAndRegion) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(3, &reconstruction, &correspondence_graph);
+  for (image_t image_id = 1; image_id <= 3; ++image_id) {
+    reconstruction.Image(image_id).Tvec() =
+        Eigen::Vector3d(-10.0 * image_id, 0, 0);
+    reconstruction.MarkImageModified(image_id);
+  }
+
+  std::vector<point3D_t> point3D_ids;
+  for (int i = 0; i < 10; ++i) {
+    Track track;
+    track.AddElement(1, i);
+    track.AddElement(2, i);
+    point3D_ids.push_back(
+        reconstruction.AddPoint3D(Eigen::Vector3d(10, 0, i), track));
+  }
+
+  auto image_ids = reconstruction.FindImagesInBox(Eigen::Vector3d(15, -1, -1),
+                                                  Eigen::Vector3d(30, 1, 1));
+  std::sort(image_ids.begin(), image_ids.end());
+  BOOST_CHECK(image_ids == std::vector<image_t>({2, 3}));
+  BOOST_CHECK_EQUAL(reconstruction
+                        .FindPoints3DInBox(Eigen::Vector3d(9, -1, 2.5),
+                                           Eigen::Vector3d(11, 1, 5))
+                        .size(),
+                    3);
+
+  // The octrees are updated with the changes since the previous query.
+  reconstruction.DeRegisterImage(3);
+  reconstruction.Point3D(point3D_ids[0]).XYZ() = Eigen::Vector3d(10, 0, 3);
+  reconstruction.MarkPoint3DModified(point3D_ids[0]);
+  reconstruction.DeletePoint3D(point3D_ids[4]);
+  image_ids = reconstruction.FindImagesInBox(Eigen::Vector3d(15, -1, -1),
+                                             Eigen::Vector3d(30, 1, 1));
+  BOOST_CHECK(image_ids == std::vector<image_t>({2}));
+  auto found_point3D_ids = reconstruction.FindPoints3DInBox(
+      Eigen::Vector3d(9, -1, 2.5), Eigen::Vector3d(11, 1, 5));
+  std::sort(found_point3D_ids.begin(), found_point3D_ids.end());
+  BOOST_CHECK(found_point3D_ids ==
+              std::vector<point3D_t>(
+                  {point3D_ids[0], point3D_ids[3], point3D_ids[5]}));
+
+  // The camera of image 1 at (10, 0, 0) looks along the z-axis with a field
+  // of view of 90 degrees.
+  reconstruction.Camera(1).SetWidth(2);
+  reconstruction.Camera(1).SetHeight(2);
+  const std::vector<Eigen::Vector4d> frustum =
+      reconstruction.ComputeViewFrustum(1, 1.5, 5.5);
+  BOOST_CHECK_EQUAL(frustum.size(), 6);
+  found_point3D_ids = reconstruction.FindPoints3DInRegion(frustum);
+  std::sort(found_point3D_ids.begin(), found_point3D_ids.end());
+  BOOST_CHECK(found_point3D_ids ==
+              std::vector<point3D_t>({point3D_ids[0], point3D_ids[2],
+                                      point3D_ids[3], point3D_ids[5]}));
+  BOOST_CHECK(reconstruction.FindImagesInRegion(frustum).empty());
+
+  // A copy of the reconstruction builds its own octrees.
+  const Reconstruction copy = reconstruction;
+  BOOST_CHECK_EQUAL(copy.FindPoints3DInRegion(frustum).size(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(TestCrop) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(3, &reconstruction, &correspondence_graph);
+  for (image_t image_id = 1; image_id <= 3; ++image_id) {
+    reconstruction.Image(image_id).Tvec() =
+        Eigen::Vector3d(-10.0 * image_id, 0, 0);
+  }
+
+  Track track1;
+  track1.AddElement(1, 0);
+  track1.AddElement(2, 0);
+  const point3D_t point3D_id1 =
+      reconstruction.AddPoint3D(Eigen::Vector3d(0, 0, 0), track1);
+  Track track2;
+  track2.AddElement(1, 1);
+  track2.AddElement(3, 1);
+  const point3D_t point3D_id2 =
+      reconstruction.AddPoint3D(Eigen::Vector3d(100, 0, 0), track2);
+
+  const Reconstruction cropped = reconstruction.Crop(
+      Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1));
+  BOOST_CHECK_EQUAL(cropped.NumCameras(), 1);
+  BOOST_CHECK_EQUAL(cropped.NumImages(), 2);
+  BOOST_CHECK_EQUAL(cropped.NumRegImages(), 2);
+  BOOST_CHECK(cropped.ExistsImage(1));
+  BOOST_CHECK(cropped.ExistsImage(2));
+  BOOST_CHECK(!cropped.ExistsImage(3));
+  BOOST_CHECK_EQUAL(cropped.NumPoints3D(), 1);
+  BOOST_CHECK(cropped.ExistsPoint3D(point3D_id1));
+  BOOST_CHECK(!cropped.ExistsPoint3D(point3D_id2));
+  BOOST_CHECK_EQUAL(cropped.Image(1).NumPoints3D(), 1);
+  BOOST_CHECK(cropped.Image(1).Point2D(0).HasPoint3D());
+  BOOST_CHECK(!cropped.Image(1).Point2D(1).HasPoint3D());
+  BOOST_CHECK_EQUAL(cropped.Image(2).NumPoints3D(), 1);
+  BOOST_CHECK_EQUAL(cropped.ComputeNumObservations(), 2);
+
+  // New 3D points do not collide with the cropped 3D points.
+  Reconstruction cropped_copy = cropped;
+  Track track3;
+  track3.AddElement(1, 2);
+  track3.AddElement(2, 2);
+  BOOST_CHECK_GT(cropped_copy.AddPoint3D(Eigen::Vector3d::Zero(), track3),
+                 point3D_id2);
+
+  // Images are included by their projection centers.
+  const Reconstruction cropped_images = reconstruction.Crop(
+      Eigen::Vector3d(25, -1, -1), Eigen::Vector3d(35, 1, 1));
+  BOOST_CHECK_EQUAL(cropped_images.NumImages(), 1);
+  BOOST_CHECK(cropped_images.ExistsImage(3));
+  BOOST_CHECK_EQUAL(cropped_images.NumPoints3D(), 0);
+  BOOST_CHECK_EQUAL(cropped_images.Image(3).NumPoints3D(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestWriteReadText) {
+  const size_t kNumPoints3D = 1000;
+  const size_t kNumImages = 5;
+
+  Reconstruction reconstruction;
+  Camera camera;
+  camera.SetCameraId(1);
+  camera.InitializeWithName("SIMPLE_RADIAL", 1.0 / 3.0, 100, 200);
+  reconstruction.AddCamera(camera);
+
+  for (image_t image_id = 1; image_id <= kNumImages; ++image_id) {
+    Image image;
+    image.SetImageId(image_id);
+    image.SetCameraId(1);
+    image.SetName("image" + std::to_string(image_id));
+    image.SetTvec(Eigen::Vector3d(0.1 * image_id, -1e-20, 1e20));
+    image.SetPoints2D(std::vector<Eigen::Vector2d>(
+        kNumPoints3D, Eigen::Vector2d(1.0 / image_id, 2)));
+    reconstruction.AddImage(image);
+    if (image_id < kNumImages) {
+      reconstruction.RegisterImage(image_id);
+    }
+  }
+
+  for (size_t j = 0; j < kNumPoints3D; ++j) {
+    Track track;
+    for (image_t image_id = 1; image_id < j % kNumImages; ++image_id) {
+      track.AddElement(image_id, j);
+    }
+    const point3D_t point3D_id = reconstruction.AddPoint3D(
+        Eigen::Vector3d(j / 7.0, -1.0 * j, 0), track,
+        Eigen::Vector3ub(j % 256, 0, 255));
+    reconstruction.Point3D(point3D_id).SetError(1.0 / (j + 1));
+  }
+
+  const auto temp_path = boost::filesystem::temp_directory_path() /
+                         boost::filesystem::unique_path();
+  const std::string path1 = (temp_path / "1").string();
+  const std::string path2 = (temp_path / "2").string();
+  boost::filesystem::create_directories(path1);
+  boost::filesystem::create_directories(path2);
+
+  reconstruction.WriteText(path1, 1);
+  reconstruction.WriteText(path2, 4);
+  for (const std::string file_name :
+       {"cameras.txt", "images.txt", "points3D.txt"}) {
+    std::ifstream file1(JoinPaths(path1, file_name));
+    std::ifstream file2(JoinPaths(path2, file_name));
+    const std::string text1((std::istreambuf_iterator<char>(file1)),
+                            std::istreambuf_iterator<char>());
+    const std::string text2((std::istreambuf_iterator<char>(file2)),
+                            std::istreambuf_iterator<char>());
+    BOOST_CHECK_EQUAL(text1, text2);
+  }
+
+  for (const int num_threads : {1, 4}) {
+    Reconstruction read_reconstruction;
+    read_reconstruction.ReadText(path1, num_threads);
+
+    BOOST_CHECK_EQUAL(read_reconstruction.NumCameras(), 1);
+    BOOST_CHECK(read_reconstruction.Camera(1).Params() == camera.Params());
+
+    BOOST_CHECK_EQUAL(read_reconstruction.NumRegImages(), kNumImages - 1);
+    BOOST_CHECK_EQUAL(read_reconstruction.NumImages(), kNumImages - 1);
+    for (const image_t image_id : reconstruction.RegImageIds()) {
+      const Image& image = reconstruction.Image(image_id);
+      const Image& read_image = read_reconstruction.Image(image_id);
+      BOOST_CHECK_EQUAL(read_image.Name(), image.Name());
+      BOOST_CHECK(read_image.Tvec() == image.Tvec());
+      BOOST_CHECK_EQUAL(read_image.NumPoints2D(), image.NumPoints2D());
+      BOOST_CHECK_EQUAL(read_image.NumPoints3D(), image.NumPoints3D());
+      for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
+           ++point2D_idx) {
+        BOOST_CHECK(read_image.Point2D(point2D_idx).XY() ==
+                    image.Point2D(point2D_idx).XY());
+        BOOST_CHECK_EQUAL(read_image.Point2D(point2D_idx).Point3DId(),
+                          image.Point2D(point2D_idx).Point3DId());
+      }
+    }
+
+    BOOST_CHECK_EQUAL(read_reconstruction.NumPoints3D(), kNumPoints3D);
+    for (const auto& point3D : reconstruction.Points3D()) {
+      const Point3D& read_point3D = read_reconstruction.Point3D(point3D.first);
+      BOOST_CHECK(read_point3D.XYZ() == point3D.second.XYZ());
+      BOOST_CHECK(read_point3D.Color() == point3D.second.Color());
+      BOOST_CHECK_EQUAL(read_point3D.Error(), point3D.second.Error());
+      BOOST_CHECK_EQUAL(read_point3D.Track().Length(),
+                        point3D.second.Track().Length());
+    }
+  }
+
+  boost::filesystem::remove_all(temp_path);
+}
+
+BOOST_AUTO_TEST_CASE(TestExportText) {
+  const size_t kNumPoints3D = 1000;
+  const size_t kNumImages = 5;
+
+  Reconstruction reconstruction;
+  Camera camera;
+  camera.SetCameraId(1);
+  camera.InitializeWithName("SIMPLE_RADIAL", 1.0 / 3.0, 100, 200);
+  reconstruction.AddCamera(camera);
+
+  for (image_t image_id = 1; image_id <= kNumImages; ++image_id) {
+    Image image;
+    image.SetImageId(image_id);
+    image.SetCameraId(1);
+    image.SetName("image" + std::to_string(image_id));
+    image.SetTvec(Eigen::Vector3d(0.1 * image_id, 0, 1));
+    image.SetPoints2D(std::vector<Eigen::Vector2d>(
+        kNumPoints3D, Eigen::Vector2d(1.0 / image_id, 2)));
+    reconstruction.AddImage(image);
+    reconstruction.RegisterImage(image_id);
+  }
+
+  for (size_t j = 0; j < kNumPoints3D; ++j) {
+    Track track;
+    for (image_t image_id = 1; image_id <= j % kNumImages; ++image_id) {
+      track.AddElement(image_id, j);
+    }
+    reconstruction.AddPoint3D(Eigen::Vector3d(j / 7.0, -1.0 * j, 0), track,
+                              Eigen::Vector3ub(j % 256, 0, 255));
+  }
+
+  const auto temp_path = boost::filesystem::temp_directory_path() /
+                         boost::filesystem::unique_path();
+  boost::filesystem::create_directories(temp_path);
+
+  const auto ReadFile = [](const std::string& path) {
+    std::ifstream file(path);
+    return std::string((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+  };
+
+  std::vector<std::string> texts[2];
+  for (const int num_threads : {1, 4}) {
+    const std::string path =
+        (temp_path / std::to_string(num_threads)).string();
+    BOOST_CHECK(reconstruction.ExportNVM(path + ".nvm", num_threads));
+    BOOST_CHECK(reconstruction.ExportBundler(
+        path + ".bundle.out", path + ".list.txt", num_threads));
+    reconstruction.ExportVRML(path + ".images.wrl", path + ".points3D.wrl", 1,
+                              Eigen::Vector3d(1, 0, 0), num_threads);
+    for (const std::string ext : {".nvm", ".bundle.out", ".list.txt",
+                                  ".images.wrl", ".points3D.wrl"}) {
+      texts[num_threads == 1 ? 0 : 1].push_back(ReadFile(path + ext));
+    }
+  }
+
+  BOOST_CHECK(texts[0] == texts[1]);
+
+  std::istringstream nvm_file(texts[0][0]);
+  std::string line;
+  std::getline(nvm_file, line);
+  BOOST_CHECK_EQUAL(line, "NVM_V3 ");
+  std::getline(nvm_file, line);
+  std::getline(nvm_file, line);
+  BOOST_CHECK_EQUAL(line, "5  ");
+  std::getline(nvm_file, line);
+  BOOST_CHECK_EQUAL(line, "image1 0.333333 1 0 0 0 -0.1 0 -1 -0 0");
+  for (size_t i = 0; i < kNumImages; ++i) {
+    std::getline(nvm_file, line);
+  }
+  std::getline(nvm_file, line);
+  BOOST_CHECK_EQUAL(line, "1000");
+  std::getline(nvm_file, line);
+  BOOST_CHECK_EQUAL(line, "0 -0 0 0 0 255 0 ");
+  std::getline(nvm_file, line);
+  BOOST_CHECK_EQUAL(line, "0.142857 -1 0 1 0 255 1 0 1 1 2");
+
+  BOOST_CHECK_EQUAL(texts[0][2], "image1\nimage2\nimage3\nimage4\nimage5\n");
+
+  boost::filesystem::remove_all(temp_path);
+}
@@ -31,17 +31,72 @@
 
 #include "base/scene_clustering.h"
 
+#include <mutex>
 #include <set>
+#include <unordered_map>
 
 #include "base/database.h"
 #include "base/graph_cut.h"
+#include "util/misc.h"
 #include "util/random.h"
+#include "util/threading.h"
+#include "util/timer.h"
 
 namespace colmap {
 
+// State shared between the concurrently partitioned sub-trees.
+struct SceneClustering::PartitionState {
+  ThreadPool* thread_pool = nullptr;
+
+  std::mutex mutex;
+
+  // The overlapping images of every partitioned child cluster, which are only
+  // inserted after the entire hierarchy was partitioned.
+  std::unordered_map<const Cluster*, std::vector<int>> overlapping_image_ids;
+
+  // The number of registered and partitioned clusters and the number of
+  // images per level of the hierarchy, used to report the progress.
+  std::vector<size_t> num_level_clusters;
+  std::vector<size_t> num_level_finished_clusters;
+  std::vector<size_t> num_level_images;
+  size_t num_reported_levels = 0;
+  Timer timer;
+
+  void RegisterCluster(const int level, const size_t num_images) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (num_level_clusters.size() <= static_cast<size_t>(level)) {
+      num_level_clusters.resize(level + 1, 0);
+      num_level_finished_clusters.resize(level + 1, 0);
+      num_level_images.resize(level + 1, 0);
+    }
+    num_level_clusters[level] += 1;
+    num_level_images[level] += num_images;
+  }
+
+  void FinishCluster(const int level) {
+    std::unique_lock<std::mutex> lock(mutex);
+    num_level_finished_clusters[level] += 1;
+    // A level is complete once all its clusters are partitioned, since every
+    // cluster registers its children before it is finished.
+    while (num_reported_levels < num_level_clusters.size() &&
+           num_level_finished_clusters[num_reported_levels] ==
+               num_level_clusters[num_reported_levels]) {
+      std::cout << StringPrintf(
+                       "  Level %d with %d clusters and %d images in %.3fs",
+                       num_reported_levels,
+                       num_level_clusters[num_reported_levels],
+                       num_level_images[num_reported_levels],
+                       timer.ElapsedSeconds())
+                << std::endl;
+      num_reported_levels += 1;
+    }
+  }
+};
+
 bool SceneClustering::Options::Check() const {
   CHECK_OPTION_GT(branching, 0);
   CHECK_OPTION_GE(image_overlap, 0);
+  CHECK_OPTION_GE(num_threads, -1);
   return true;
 }
 
@@ -67,18 +122,60 @@ void SceneClustering::Partition(
   root_cluster_.reset(new Cluster());
   root_cluster_->image_ids.insert(root_cluster_->image_ids.end(),
                                   image_ids.begin(), image_ids.end());
-  PartitionCluster(edges, num_inliers, root_cluster_.get());
+
+  // Partition the independent sub-trees of the hierarchy in parallel.
+  ThreadPool thread_pool(options_.num_threads);
+  PartitionState state;
+  state.thread_pool = &thread_pool;
+  state.timer.Start();
+  state.RegisterCluster(0, root_cluster_->image_ids.size());
+  PartitionCluster(edges, num_inliers, 0, root_cluster_.get(), &state);
+  thread_pool.Wait();
+
+  if (options_.image_overlap == 0) {
+    return;
+  }
+
+  // Recursively append the overlapping images to the child clusters and their
+  // children, where the overlap of the deeper levels comes first.
+  std::function<void(Cluster*)> InsertOverlappingImageIds =
+      [&](Cluster* cluster) {
+        for (auto& child_cluster : cluster->child_clusters) {
+          InsertOverlappingImageIds(&child_cluster);
+        }
+
+        for (auto& child_cluster : cluster->child_clusters) {
+          const auto& overlapping_image_ids =
+              state.overlapping_image_ids.at(&child_cluster);
+          std::function<void(Cluster*)> InsertImageIds =
+              [&](Cluster* subtree_cluster) {
+                subtree_cluster->image_ids.insert(
+                    subtree_cluster->image_ids.end(),
+                    overlapping_image_ids.begin(),
+                    overlapping_image_ids.end());
+                for (auto& subtree_child_cluster :
+                     subtree_cluster->child_clusters) {
+                  InsertImageIds(&subtree_child_cluster);
+                }
+              };
+          InsertImageIds(&child_cluster);
+        }
+      };
+
+  InsertOverlappingImageIds(root_cluster_.get());
 }
 
 void SceneClustering::PartitionCluster(
     const std::vector<std::pair<int, int>>& edges,
-    const std::vector<int>& weights, Cluster* cluster) {
+    const std::vector<int>& weights, const int level, Cluster* cluster,
+    PartitionState* state) {
   CHECK_EQ(edges.size(), weights.size());
 
   // If the cluster is small enough, we return from the recursive clustering.
   if (edges.size() == 0 ||
       cluster->image_ids.size() <=
           static_cast<size_t>(options_.leaf_max_num_images)) {
+    state->FinishCluster(level);
     return;
   }
 
@@ -112,12 +209,6 @@ void SceneClustering::PartitionCluster(
     }
   }
 
-  // Recursively partition all the child clusters.
-  for (int i = 0; i < options_.branching; ++i) {
-    PartitionCluster(child_edges[i], child_weights[i],
-                     &cluster->child_clusters[i]);
-  }
-
   if (options_.image_overlap > 0) {
     for (int i = 0; i < options_.branching; ++i) {
       // Sort the overlapping edges by the number of inlier matches, such
@@ -142,20 +233,28 @@ void SceneClustering::PartitionCluster(
         }
       }
 
-      // Recursively append the overlapping images to cluster and its children.
-      std::function<void(Cluster*)> InsertOverlappingImageIds =
-          [&](Cluster* cluster) {
-            cluster->image_ids.insert(cluster->image_ids.end(),
-                                      overlapping_image_ids.begin(),
-                                      overlapping_image_ids.end());
-            for (auto& child_cluster : cluster->child_clusters) {
-              InsertOverlappingImageIds(&child_cluster);
-            }
-          };
-
-      InsertOverlappingImageIds(&cluster->child_clusters[i]);
+      // The overlapping images are inserted once the child cluster and all
+      // its children are partitioned.
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->overlapping_image_ids[&cluster->child_clusters[i]].assign(
+          overlapping_image_ids.begin(), overlapping_image_ids.end());
     }
   }
+
+  // Recursively partition all the child clusters in parallel.
+  for (int i = 0; i < options_.branching; ++i) {
+    state->RegisterCluster(level + 1,
+                           cluster->child_clusters[i].image_ids.size());
+  }
+
+  for (int i = 0; i < options_.branching; ++i) {
+    state->thread_pool->AddTask(&SceneClustering::PartitionCluster, this,
+                                std::move(child_edges[i]),
+                                std::move(child_weights[i]), level + 1,
+                                &cluster->child_clusters[i], state);
+  }
+
+  state->FinishCluster(level);
 }
 
 const SceneClustering::Cluster* SceneClustering::GetRootCluster() const {
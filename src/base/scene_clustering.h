@@ -57,6 +57,10 @@ class SceneClustering {
     // overlap` images to satisfy the overlap constraint.
     int leaf_max_num_images = 500;
 
+    // The number of threads used to partition independent sub-trees of the
+    // hierarchy in parallel.
+    int num_threads = -1;
+
     bool Check() const;
   };
 
@@ -74,8 +78,11 @@ class SceneClustering {
   std::vector<const Cluster*> GetLeafClusters() const;
 
  private:
+  struct PartitionState;
+
   void PartitionCluster(const std::vector<std::pair<int, int>>& edges,
-                        const std::vector<int>& weights, Cluster* cluster);
+                        const std::vector<int>& weights, const int level,
+                        Cluster* cluster, PartitionState* state);
 
   const Options options_;
   std::unique_ptr<Cluster> root_cluster_;
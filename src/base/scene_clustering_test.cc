@@ -214,3 +214,50 @@ BOOST_AUTO_TEST_CASE(TestTwoOverlap) {
   BOOST_CHECK(image_ids1.count(2));
   BOOST_CHECK(image_ids1.count(3));
 }
+
+void CheckEqualClusters(const SceneClustering::Cluster& cluster1,
+                        const SceneClustering::Cluster& cluster2) {
+  BOOST_CHECK(cluster1.image_ids == cluster2.image_ids);
+  BOOST_REQUIRE_EQUAL(cluster1.child_clusters.size(),
+                      cluster2.child_clusters.size());
+  for (size_t i = 0; i < cluster1.child_clusters.size(); ++i) {
+    CheckEqualClusters(cluster1.child_clusters[i], cluster2.child_clusters[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestMultiThreaded) {
+  std::vector<std::pair<image_t, image_t>> image_pairs;
+  std::vector<int> num_inliers;
+  const image_t kNumRows = 10;
+  const image_t kNumCols = 20;
+  for (image_t row = 0; row < kNumRows; ++row) {
+    for (image_t col = 0; col < kNumCols; ++col) {
+      const image_t image_id = row * kNumCols + col;
+      if (col + 1 < kNumCols) {
+        image_pairs.emplace_back(image_id, image_id + 1);
+        num_inliers.push_back(10 + (image_id * 7) % 13);
+      }
+      if (row + 1 < kNumRows) {
+        image_pairs.emplace_back(image_id, image_id + kNumCols);
+        num_inliers.push_back(10 + (image_id * 5) % 11);
+      }
+    }
+  }
+
+  SceneClustering::Options options;
+  options.branching = 2;
+  options.image_overlap = 5;
+  options.leaf_max_num_images = 10;
+
+  options.num_threads = 1;
+  SceneClustering scene_clustering1(options);
+  scene_clustering1.Partition(image_pairs, num_inliers);
+
+  options.num_threads = 4;
+  SceneClustering scene_clustering2(options);
+  scene_clustering2.Partition(image_pairs, num_inliers);
+
+  BOOST_CHECK_GT(scene_clustering1.GetLeafClusters().size(), 8);
+  CheckEqualClusters(*scene_clustering1.GetRootCluster(),
+                     *scene_clustering2.GetRootCluster());
+}
@@ -36,6 +36,7 @@
 #include "base/reconstruction.h"
 #include "estimators/similarity_transform.h"
 #include "optim/loransac.h"
+#include "util/threading.h"
 
 namespace colmap {
 namespace {
@@ -255,13 +256,14 @@ bool ComputeAlignmentBetweenReconstructions(
     const Reconstruction& src_reconstruction,
     const Reconstruction& ref_reconstruction,
     const double min_inlier_observations, const double max_reproj_error,
-    Eigen::Matrix3x4d* alignment) {
+    const int num_threads, Eigen::Matrix3x4d* alignment) {
   CHECK_GE(min_inlier_observations, 0.0);
   CHECK_LE(min_inlier_observations, 1.0);
 
   RANSACOptions ransac_options;
   ransac_options.max_error = 1.0 - min_inlier_observations;
   ransac_options.min_inlier_ratio = 0.2;
+  ransac_options.num_threads = num_threads;
 
   LORANSAC<ReconstructionAlignmentEstimator, ReconstructionAlignmentEstimator>
       ransac(ransac_options);
@@ -294,4 +296,46 @@ bool ComputeAlignmentBetweenReconstructions(
   return report.success;
 }
 
+std::vector<bool> ComputeAlignmentsBetweenReconstructions(
+    const std::vector<const Reconstruction*>& src_reconstructions,
+    const Reconstruction& ref_reconstruction,
+    const double min_inlier_observations, const double max_reproj_error,
+    const int num_threads, std::vector<Eigen::Matrix3x4d>* alignments) {
+  alignments->resize(src_reconstructions.size());
+
+  const int num_eff_threads = std::min(
+      GetEffectiveNumThreads(num_threads),
+      static_cast<int>(std::max<size_t>(src_reconstructions.size(), 1)));
+
+  // A single alignment uses all threads for its hypotheses, while multiple
+  // alignments are distributed among the threads without nesting.
+  if (num_eff_threads == 1) {
+    std::vector<bool> success(src_reconstructions.size());
+    for (size_t i = 0; i < src_reconstructions.size(); ++i) {
+      success[i] = ComputeAlignmentBetweenReconstructions(
+          *src_reconstructions[i], ref_reconstruction, min_inlier_observations,
+          max_reproj_error, num_threads, &(*alignments)[i]);
+    }
+    return success;
+  }
+
+  ThreadPool thread_pool(num_eff_threads);
+  std::vector<std::future<bool>> futures;
+  futures.reserve(src_reconstructions.size());
+  for (size_t i = 0; i < src_reconstructions.size(); ++i) {
+    futures.push_back(thread_pool.AddTask([&, i]() {
+      return ComputeAlignmentBetweenReconstructions(
+          *src_reconstructions[i], ref_reconstruction, min_inlier_observations,
+          max_reproj_error, 1, &(*alignments)[i]);
+    }));
+  }
+
+  std::vector<bool> success(src_reconstructions.size());
+  for (size_t i = 0; i < futures.size(); ++i) {
+    success[i] = futures[i].get();
+  }
+
+  return success;
+}
+
 }  // namespace colmap
@@ -82,12 +82,23 @@ class SimilarityTransform3 {
 // robustly inside RANSAC from corresponding projection centers. An alignment
 // is verified by reprojecting common 3D point observations.
 // The min_inlier_observations threshold determines how many observations
-// in a common image must reproject within the given threshold.
+// in a common image must reproject within the given threshold. The hypotheses
+// of RANSAC are evaluated with the given number of threads.
 bool ComputeAlignmentBetweenReconstructions(
     const Reconstruction& src_reconstruction,
     const Reconstruction& ref_reconstruction,
     const double min_inlier_observations, const double max_reproj_error,
-    Eigen::Matrix3x4d* alignment);
+    const int num_threads, Eigen::Matrix3x4d* alignment);
+
+// Robustly compute the alignments of multiple reconstructions to the same
+// reference reconstruction, e.g., when merging many sub-models into one. The
+// alignments are estimated in parallel and the success of each alignment is
+// returned in the same order as the source reconstructions.
+std::vector<bool> ComputeAlignmentsBetweenReconstructions(
+    const std::vector<const Reconstruction*>& src_reconstructions,
+    const Reconstruction& ref_reconstruction,
+    const double min_inlier_observations, const double max_reproj_error,
+    const int num_threads, std::vector<Eigen::Matrix3x4d>* alignments);
 
 }  // namespace colmap
 
@@ -0,0 +1,204 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "base/spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#include "util/endian.h"
+#include "util/logging.h"
+
+namespace colmap {
+
+SpatialIndex::SpatialIndex(const double voxel_size)
+    : voxel_size_(voxel_size) {
+  CHECK_GT(voxel_size_, 0);
+}
+
+SpatialIndex::Voxel SpatialIndex::LocationToVoxel(
+    const Eigen::Vector3d& location) const {
+  const Eigen::Vector3d voxel = (location / voxel_size_).array().floor();
+  CHECK_LT(voxel.cwiseAbs().maxCoeff(), std::numeric_limits<int>::max() / 2)
+      << "Voxel size too small for the location range";
+  return {static_cast<int>(voxel(0)), static_cast<int>(voxel(1)),
+          static_cast<int>(voxel(2))};
+}
+
+void SpatialIndex::Insert(const image_t image_id,
+                          const Eigen::Vector3d& location) {
+  CHECK(locations_.emplace(image_id, location).second);
+
+  const Voxel voxel = LocationToVoxel(location);
+  voxels_[voxel].push_back({image_id, location});
+
+  if (locations_.size() == 1) {
+    min_voxel_ = voxel;
+    max_voxel_ = voxel;
+  } else {
+    min_voxel_.x = std::min(min_voxel_.x, voxel.x);
+    min_voxel_.y = std::min(min_voxel_.y, voxel.y);
+    min_voxel_.z = std::min(min_voxel_.z, voxel.z);
+    max_voxel_.x = std::max(max_voxel_.x, voxel.x);
+    max_voxel_.y = std::max(max_voxel_.y, voxel.y);
+    max_voxel_.z = std::max(max_voxel_.z, voxel.z);
+  }
+}
+
+void SpatialIndex::Search(const Eigen::Vector3d& location,
+                          const size_t max_num_neighbors,
+                          const double max_distance,
+                          std::vector<image_t>* image_ids,
+                          std::vector<double>* distances) const {
+  CHECK_NOTNULL(image_ids)->clear();
+  CHECK_NOTNULL(distances)->clear();
+
+  if (max_num_neighbors == 0 || locations_.empty()) {
+    return;
+  }
+
+  const double max_squared_distance = max_distance * max_distance;
+
+  // Max-heap of the nearest neighbors by squared distance.
+  std::vector<std::pair<double, image_t>> neighbors;
+  neighbors.reserve(max_num_neighbors + 1);
+
+  auto VisitVoxel = [&](const int x, const int y, const int z) {
+    const auto it = voxels_.find({x, y, z});
+    if (it == voxels_.end()) {
+      return;
+    }
+    for (const auto& entry : it->second) {
+      const double squared_distance =
+          (entry.location - location).squaredNorm();
+      if (squared_distance > max_squared_distance ||
+          (neighbors.size() == max_num_neighbors &&
+           squared_distance >= neighbors.front().first)) {
+        continue;
+      }
+      neighbors.emplace_back(squared_distance, entry.image_id);
+      std::push_heap(neighbors.begin(), neighbors.end());
+      if (neighbors.size() > max_num_neighbors) {
+        std::pop_heap(neighbors.begin(), neighbors.end());
+        neighbors.pop_back();
+      }
+    }
+  };
+
+  // Visit the voxels in rings of increasing Chebyshev distance around the
+  // voxel of the query, until the remaining rings cannot contain any closer
+  // locations or all occupied voxels were visited.
+  const Voxel center = LocationToVoxel(location);
+  const int max_ring = std::max(
+      {center.x - min_voxel_.x, max_voxel_.x - center.x,
+       center.y - min_voxel_.y, max_voxel_.y - center.y,
+       center.z - min_voxel_.z, max_voxel_.z - center.z, 0});
+
+  for (int ring = 0; ring <= max_ring; ++ring) {
+    // Any location in the ring is at least this far from the query.
+    const double min_ring_distance = std::max(0, ring - 1) * voxel_size_;
+    const double min_ring_squared_distance =
+        min_ring_distance * min_ring_distance;
+    if (min_ring_squared_distance > max_squared_distance ||
+        (neighbors.size() == max_num_neighbors &&
+         min_ring_squared_distance >= neighbors.front().first)) {
+      break;
+    }
+
+    const int min_x = std::max(center.x - ring, min_voxel_.x);
+    const int max_x = std::min(center.x + ring, max_voxel_.x);
+    const int min_y = std::max(center.y - ring, min_voxel_.y);
+    const int max_y = std::min(center.y + ring, max_voxel_.y);
+    const int min_z = std::max(center.z - ring, min_voxel_.z);
+    const int max_z = std::min(center.z + ring, max_voxel_.z);
+    for (int x = min_x; x <= max_x; ++x) {
+      for (int y = min_y; y <= max_y; ++y) {
+        if (std::abs(x - center.x) == ring || std::abs(y - center.y) == ring) {
+          for (int z = min_z; z <= max_z; ++z) {
+            VisitVoxel(x, y, z);
+          }
+        } else {
+          // Only the two caps of the ring remain in the z-direction.
+          for (const int z : {center.z - ring, center.z + ring}) {
+            if (z >= min_z && z <= max_z) {
+              VisitVoxel(x, y, z);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  std::sort_heap(neighbors.begin(), neighbors.end());
+
+  image_ids->reserve(neighbors.size());
+  distances->reserve(neighbors.size());
+  for (const auto& neighbor : neighbors) {
+    image_ids->push_back(neighbor.second);
+    distances->push_back(std::sqrt(neighbor.first));
+  }
+}
+
+void SpatialIndex::Read(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  CHECK(file.is_open()) << path;
+
+  *this = SpatialIndex(ReadBinaryLittleEndian<double>(&file));
+
+  const size_t num_locations = ReadBinaryLittleEndian<uint64_t>(&file);
+  locations_.reserve(num_locations);
+  for (size_t i = 0; i < num_locations; ++i) {
+    const image_t image_id = ReadBinaryLittleEndian<image_t>(&file);
+    Eigen::Vector3d location;
+    location(0) = ReadBinaryLittleEndian<double>(&file);
+    location(1) = ReadBinaryLittleEndian<double>(&file);
+    location(2) = ReadBinaryLittleEndian<double>(&file);
+    Insert(image_id, location);
+  }
+}
+
+void SpatialIndex::Write(const std::string& path) const {
+  std::ofstream file(path, std::ios::trunc | std::ios::binary);
+  CHECK(file.is_open()) << path;
+
+  WriteBinaryLittleEndian<double>(&file, voxel_size_);
+
+  WriteBinaryLittleEndian<uint64_t>(&file, locations_.size());
+  for (const auto& location : locations_) {
+    WriteBinaryLittleEndian<image_t>(&file, location.first);
+    WriteBinaryLittleEndian<double>(&file, location.second(0));
+    WriteBinaryLittleEndian<double>(&file, location.second(1));
+    WriteBinaryLittleEndian<double>(&file, location.second(2));
+  }
+}
+
+}  // namespace colmap
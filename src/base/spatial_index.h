@@ -0,0 +1,128 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_BASE_SPATIAL_INDEX_H_
+#define COLMAP_SRC_BASE_SPATIAL_INDEX_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "util/types.h"
+
+namespace colmap {
+
+// Index of 3D image locations for radius-bounded nearest neighbor search,
+// e.g., of the GPS priors transformed to Cartesian coordinates. The locations
+// are hashed into a uniform voxel grid, so that a query only visits the
+// occupied voxels around the query location instead of all locations. The
+// index supports incremental insertion and can be written to and read from
+// disk to be reused for newly added images. Concurrent searches are
+// thread-safe, but must not run concurrently with insertions.
+class SpatialIndex {
+ public:
+  // The voxel size should be in the order of the maximum search distance.
+  explicit SpatialIndex(const double voxel_size);
+
+  inline double VoxelSize() const;
+  inline size_t NumLocations() const;
+  inline bool ExistsImage(const image_t image_id) const;
+
+  // Insert the location of an image, which must not be indexed yet.
+  void Insert(const image_t image_id, const Eigen::Vector3d& location);
+
+  // Find the nearest indexed images within the maximum distance to the query
+  // location, sorted by increasing distance.
+  //
+  // @param location            The query location.
+  // @param max_num_neighbors   The maximum number of images to return.
+  // @param max_distance        The maximum Euclidean distance to the query.
+  // @param image_ids           The found images.
+  // @param distances           The distances of the found images.
+  void Search(const Eigen::Vector3d& location, const size_t max_num_neighbors,
+              const double max_distance, std::vector<image_t>* image_ids,
+              std::vector<double>* distances) const;
+
+  // Read and write the index in binary format.
+  void Read(const std::string& path);
+  void Write(const std::string& path) const;
+
+ private:
+  struct Voxel {
+    int x;
+    int y;
+    int z;
+    inline bool operator==(const Voxel& other) const {
+      return x == other.x && y == other.y && z == other.z;
+    }
+  };
+
+  struct VoxelHash {
+    inline size_t operator()(const Voxel& voxel) const {
+      return (static_cast<size_t>(voxel.x) * 73856093) ^
+             (static_cast<size_t>(voxel.y) * 19349663) ^
+             (static_cast<size_t>(voxel.z) * 83492791);
+    }
+  };
+
+  struct Entry {
+    image_t image_id;
+    Eigen::Vector3d location;
+  };
+
+  Voxel LocationToVoxel(const Eigen::Vector3d& location) const;
+
+  double voxel_size_;
+
+  std::unordered_map<Voxel, std::vector<Entry>, VoxelHash> voxels_;
+  std::unordered_map<image_t, Eigen::Vector3d> locations_;
+
+  // Bounding box of the occupied voxels, which limits the search.
+  Voxel min_voxel_;
+  Voxel max_voxel_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+double SpatialIndex::VoxelSize() const { return voxel_size_; }
+
+size_t SpatialIndex::NumLocations() const { return locations_.size(); }
+
+bool SpatialIndex::ExistsImage(const image_t image_id) const {
+  return locations_.count(image_id) > 0;
+}
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_BASE_SPATIAL_INDEX_H_
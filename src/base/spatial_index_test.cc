@@ -0,0 +1,152 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "base/spatial_index"
+#include "util/testing.h"
+
+#include <algorithm>
+
+#include "base/spatial_index.h"
+#include "util/random.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestEmpty) {
+  SpatialIndex index(1.0);
+  BOOST_CHECK_EQUAL(index.VoxelSize(), 1.0);
+  BOOST_CHECK_EQUAL(index.NumLocations(), 0);
+  std::vector<image_t> image_ids;
+  std::vector<double> distances;
+  index.Search(Eigen::Vector3d::Zero(), 10, 1.0, &image_ids, &distances);
+  BOOST_CHECK(image_ids.empty());
+  BOOST_CHECK(distances.empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestInsert) {
+  SpatialIndex index(1.0);
+  index.Insert(1, Eigen::Vector3d(0, 0, 0));
+  index.Insert(2, Eigen::Vector3d(0.5, 0, 0));
+  index.Insert(3, Eigen::Vector3d(-3, 0, 0));
+  BOOST_CHECK_EQUAL(index.NumLocations(), 3);
+  BOOST_CHECK(index.ExistsImage(1));
+  BOOST_CHECK(index.ExistsImage(3));
+  BOOST_CHECK(!index.ExistsImage(4));
+
+  std::vector<image_t> image_ids;
+  std::vector<double> distances;
+  index.Search(Eigen::Vector3d(0.1, 0, 0), 10, 1.0, &image_ids, &distances);
+  BOOST_CHECK_EQUAL(image_ids.size(), 2);
+  BOOST_CHECK_EQUAL(image_ids[0], 1);
+  BOOST_CHECK_EQUAL(image_ids[1], 2);
+  BOOST_CHECK_CLOSE(distances[0], 0.1, 1e-6);
+  BOOST_CHECK_CLOSE(distances[1], 0.4, 1e-6);
+
+  index.Search(Eigen::Vector3d(0.1, 0, 0), 1, 10.0, &image_ids, &distances);
+  BOOST_CHECK_EQUAL(image_ids.size(), 1);
+  BOOST_CHECK_EQUAL(image_ids[0], 1);
+
+  index.Search(Eigen::Vector3d(0.1, 0, 0), 10, 10.0, &image_ids, &distances);
+  BOOST_CHECK_EQUAL(image_ids.size(), 3);
+  BOOST_CHECK_EQUAL(image_ids[2], 3);
+
+  // Query outside of the bounding box of the indexed locations.
+  index.Search(Eigen::Vector3d(0, 0, 5), 10, 5.1, &image_ids, &distances);
+  BOOST_CHECK_EQUAL(image_ids.size(), 2);
+  BOOST_CHECK_EQUAL(image_ids[0], 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestSearchBruteForce) {
+  SetPRNGSeed(0);
+
+  for (const double voxel_size : {0.1, 1.0, 10.0}) {
+    SpatialIndex index(voxel_size);
+    std::vector<Eigen::Vector3d> locations;
+    for (image_t image_id = 0; image_id < 500; ++image_id) {
+      locations.emplace_back(RandomReal(-10.0, 10.0), RandomReal(-10.0, 10.0),
+                             RandomReal(-1.0, 1.0));
+      index.Insert(image_id, locations.back());
+    }
+
+    for (int i = 0; i < 50; ++i) {
+      const Eigen::Vector3d query(RandomReal(-12.0, 12.0),
+                                  RandomReal(-12.0, 12.0),
+                                  RandomReal(-2.0, 2.0));
+      const size_t max_num_neighbors = RandomInteger(1, 20);
+      const double max_distance = RandomReal(0.5, 5.0);
+
+      std::vector<std::pair<double, image_t>> expected;
+      for (image_t image_id = 0; image_id < locations.size(); ++image_id) {
+        const double distance = (locations[image_id] - query).norm();
+        if (distance <= max_distance) {
+          expected.emplace_back(distance, image_id);
+        }
+      }
+      std::sort(expected.begin(), expected.end());
+      expected.resize(std::min(expected.size(), max_num_neighbors));
+
+      std::vector<image_t> image_ids;
+      std::vector<double> distances;
+      index.Search(query, max_num_neighbors, max_distance, &image_ids,
+                   &distances);
+      BOOST_CHECK_EQUAL(image_ids.size(), expected.size());
+      for (size_t j = 0; j < std::min(image_ids.size(), expected.size());
+           ++j) {
+        BOOST_CHECK_EQUAL(image_ids[j], expected[j].second);
+        BOOST_CHECK_CLOSE(distances[j], expected[j].first, 1e-6);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestReadWrite) {
+  SpatialIndex index(2.0);
+  index.Insert(1, Eigen::Vector3d(1, 2, 3));
+  index.Insert(5, Eigen::Vector3d(-1, 4, 3));
+
+  const std::string path = (boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path())
+                               .string();
+  index.Write(path);
+
+  SpatialIndex read_index(1.0);
+  read_index.Read(path);
+  BOOST_CHECK_EQUAL(read_index.VoxelSize(), 2.0);
+  BOOST_CHECK_EQUAL(read_index.NumLocations(), 2);
+  BOOST_CHECK(read_index.ExistsImage(1));
+  BOOST_CHECK(read_index.ExistsImage(5));
+
+  std::vector<image_t> image_ids;
+  std::vector<double> distances;
+  read_index.Search(Eigen::Vector3d(-1, 4, 3), 1, 1.0, &image_ids, &distances);
+  BOOST_CHECK_EQUAL(image_ids.size(), 1);
+  BOOST_CHECK_EQUAL(image_ids[0], 5);
+
+  boost::filesystem::remove(path);
+}
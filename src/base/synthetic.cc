@@ -0,0 +1,178 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "base/synthetic.h"
+
+#include <unordered_map>
+
+#include "base/camera_models.h"
+#include "base/pose.h"
+#include "util/logging.h"
+#include "util/misc.h"
+#include "util/random.h"
+
+namespace colmap {
+
+bool SyntheticDatasetOptions::Check() const {
+  CHECK_OPTION_GT(num_cameras, 0);
+  CHECK_OPTION_GE(num_images, num_cameras);
+  CHECK_OPTION_GE(num_points3D, 0);
+  CHECK_OPTION_GE(num_points2D_without_point3D, 0);
+  CHECK_OPTION_GT(camera_width, 0);
+  CHECK_OPTION_GT(camera_height, 0);
+  CHECK_OPTION(ExistsCameraModelWithName(camera_model_name));
+  CHECK_OPTION_GT(camera_focal_length, 0);
+  CHECK_OPTION_GE(point2D_stddev, 0);
+  return true;
+}
+
+void SynthesizeDataset(const SyntheticDatasetOptions& options,
+                       Reconstruction* reconstruction) {
+  CHECK(options.Check());
+  CHECK_NOTNULL(reconstruction);
+  CHECK_EQ(reconstruction->NumCameras(), 0);
+  CHECK_EQ(reconstruction->NumImages(), 0);
+
+  for (int camera_idx = 0; camera_idx < options.num_cameras; ++camera_idx) {
+    Camera camera;
+    camera.SetCameraId(camera_idx + 1);
+    camera.InitializeWithName(options.camera_model_name,
+                              options.camera_focal_length,
+                              options.camera_width, options.camera_height);
+    reconstruction->AddCamera(camera);
+  }
+
+  std::vector<Eigen::Vector3d> points3D(options.num_points3D);
+  for (auto& xyz : points3D) {
+    xyz = Eigen::Vector3d(RandomReal(-0.5, 0.5), RandomReal(-0.5, 0.5),
+                          RandomReal(-0.5, 0.5));
+  }
+
+  // Place the images on a circle around the points at a distance, where the
+  // unit cube approximately fills the field of view.
+  const double kRadius = 1.5 * options.camera_focal_length /
+                         std::min(options.camera_width, options.camera_height);
+  std::vector<Track> tracks(options.num_points3D);
+  for (int image_idx = 0; image_idx < options.num_images; ++image_idx) {
+    const image_t image_id = image_idx + 1;
+    const camera_t camera_id = image_idx % options.num_cameras + 1;
+    const Camera& camera = reconstruction->Camera(camera_id);
+
+    const double angle = 2 * M_PI * image_idx / options.num_images;
+    const Eigen::Vector3d proj_center(kRadius * std::cos(angle),
+                                      kRadius * std::sin(angle), 0.1 * kRadius);
+    const Eigen::Vector3d z_axis = -proj_center.normalized();
+    const Eigen::Vector3d x_axis =
+        Eigen::Vector3d::UnitZ().cross(z_axis).normalized();
+    Eigen::Matrix3d R;
+    R.row(0) = x_axis.transpose();
+    R.row(1) = z_axis.cross(x_axis).transpose();
+    R.row(2) = z_axis.transpose();
+
+    Image image;
+    image.SetImageId(image_id);
+    image.SetCameraId(camera_id);
+    image.SetName(StringPrintf("image%06d.png", image_id));
+    image.SetQvec(RotationMatrixToQuaternion(R));
+    image.SetTvec(-R * proj_center);
+
+    const Eigen::Matrix3x4d proj_matrix = image.ProjectionMatrix();
+    std::vector<Eigen::Vector2d> points2D;
+    points2D.reserve(options.num_points3D +
+                     options.num_points2D_without_point3D);
+    for (int point3D_idx = 0; point3D_idx < options.num_points3D;
+         ++point3D_idx) {
+      const Eigen::Vector3d point =
+          proj_matrix * points3D[point3D_idx].homogeneous();
+      Eigen::Vector2d point2D = camera.WorldToImage(point.hnormalized());
+      if (options.point2D_stddev > 0) {
+        point2D += Eigen::Vector2d(RandomGaussian(0.0, options.point2D_stddev),
+                                   RandomGaussian(0.0, options.point2D_stddev));
+      }
+      points2D.push_back(point2D);
+      tracks[point3D_idx].AddElement(image_id, point3D_idx);
+    }
+
+    for (int i = 0; i < options.num_points2D_without_point3D; ++i) {
+      points2D.emplace_back(RandomReal(0.0, 1.0 * options.camera_width),
+                            RandomReal(0.0, 1.0 * options.camera_height));
+    }
+
+    image.SetPoints2D(points2D);
+    reconstruction->AddImage(image);
+    reconstruction->RegisterImage(image_id);
+  }
+
+  for (int point3D_idx = 0; point3D_idx < options.num_points3D;
+       ++point3D_idx) {
+    reconstruction->AddPoint3D(points3D[point3D_idx], tracks[point3D_idx]);
+  }
+}
+
+void SynthesizeCorrespondenceGraph(const Reconstruction& reconstruction,
+                                   CorrespondenceGraph* correspondence_graph) {
+  CHECK_NOTNULL(correspondence_graph);
+
+  for (const auto& image : reconstruction.Images()) {
+    correspondence_graph->AddImage(image.first, image.second.NumPoints2D());
+  }
+
+  std::unordered_map<image_pair_t, FeatureMatches> matches;
+  for (const auto& point3D : reconstruction.Points3D()) {
+    const auto& track_els = point3D.second.Track().Elements();
+    for (size_t i1 = 0; i1 < track_els.size(); ++i1) {
+      for (size_t i2 = i1 + 1; i2 < track_els.size(); ++i2) {
+        const TrackElement& track_el1 = track_els[i1];
+        const TrackElement& track_el2 = track_els[i2];
+        if (track_el1.image_id < track_el2.image_id) {
+          matches[Database::ImagePairToPairId(track_el1.image_id,
+                                              track_el2.image_id)]
+              .emplace_back(track_el1.point2D_idx, track_el2.point2D_idx);
+        } else if (track_el1.image_id > track_el2.image_id) {
+          matches[Database::ImagePairToPairId(track_el2.image_id,
+                                              track_el1.image_id)]
+              .emplace_back(track_el2.point2D_idx, track_el1.point2D_idx);
+        }
+      }
+    }
+  }
+
+  for (const auto& pair_matches : matches) {
+    image_t image_id1;
+    image_t image_id2;
+    Database::PairIdToImagePair(pair_matches.first, &image_id1, &image_id2);
+    correspondence_graph->AddCorrespondences(image_id1, image_id2,
+                                             pair_matches.second);
+  }
+
+  correspondence_graph->Finalize();
+}
+
+}  // namespace colmap
@@ -0,0 +1,82 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_BASE_SYNTHETIC_H_
+#define COLMAP_SRC_BASE_SYNTHETIC_H_
+
+#include <string>
+
+#include "base/correspondence_graph.h"
+#include "base/reconstruction.h"
+
+namespace colmap {
+
+struct SyntheticDatasetOptions {
+  // The number of cameras, which are shared by the images in turn.
+  int num_cameras = 2;
+
+  // The number of registered images, which are placed on a circle around
+  // the 3D points and look at its center.
+  int num_images = 10;
+
+  // The number of 3D points, which are uniformly distributed in the unit cube
+  // centered at the origin and observed by all images.
+  int num_points3D = 100;
+
+  // The number of 2D points per image without a corresponding 3D point.
+  int num_points2D_without_point3D = 10;
+
+  // The camera parameters of all cameras.
+  int camera_width = 1024;
+  int camera_height = 768;
+  std::string camera_model_name = "SIMPLE_RADIAL";
+  double camera_focal_length = 1024;
+
+  // The standard deviation of the Gaussian noise added to the projections of
+  // the 3D points in pixels.
+  double point2D_stddev = 0.0;
+
+  bool Check() const;
+};
+
+// Synthesize a reconstruction with exact poses, 3D points and observations
+// for testing and benchmarking. The random number generator is used and the
+// results are deterministic for a fixed PRNG seed.
+void SynthesizeDataset(const SyntheticDatasetOptions& options,
+                       Reconstruction* reconstruction);
+
+// Build the correspondence graph that contains all pairwise correspondences
+// between the observations of the 3D points of the reconstruction.
+void SynthesizeCorrespondenceGraph(const Reconstruction& reconstruction,
+                                   CorrespondenceGraph* correspondence_graph);
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_BASE_SYNTHETIC_H_
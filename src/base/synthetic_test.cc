@@ -0,0 +1,94 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "base/synthetic"
+#include "util/testing.h"
+
+#include "base/projection.h"
+#include "base/synthetic.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestSynthesizeDataset) {
+  SyntheticDatasetOptions options;
+  Reconstruction reconstruction;
+  SynthesizeDataset(options, &reconstruction);
+
+  BOOST_CHECK_EQUAL(reconstruction.NumCameras(), options.num_cameras);
+  BOOST_CHECK_EQUAL(reconstruction.NumImages(), options.num_images);
+  BOOST_CHECK_EQUAL(reconstruction.NumRegImages(), options.num_images);
+  BOOST_CHECK_EQUAL(reconstruction.NumPoints3D(), options.num_points3D);
+
+  for (const auto& image : reconstruction.Images()) {
+    BOOST_CHECK_EQUAL(image.second.NumPoints2D(),
+                      options.num_points3D +
+                          options.num_points2D_without_point3D);
+    BOOST_CHECK_EQUAL(image.second.NumPoints3D(), options.num_points3D);
+  }
+
+  for (const auto& point3D : reconstruction.Points3D()) {
+    BOOST_CHECK_EQUAL(point3D.second.Track().Length(), options.num_images);
+    for (const auto& track_el : point3D.second.Track().Elements()) {
+      const Image& image = reconstruction.Image(track_el.image_id);
+      const Camera& camera = reconstruction.Camera(image.CameraId());
+      BOOST_CHECK(HasPointPositiveDepth(image.ProjectionMatrix(),
+                                        point3D.second.XYZ()));
+      BOOST_CHECK_LT(CalculateSquaredReprojectionError(
+                         image.Point2D(track_el.point2D_idx).XY(),
+                         point3D.second.XYZ(), image.Qvec(), image.Tvec(),
+                         camera),
+                     1e-6);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestSynthesizeCorrespondenceGraph) {
+  SyntheticDatasetOptions options;
+  options.num_images = 4;
+  options.num_points3D = 20;
+  Reconstruction reconstruction;
+  SynthesizeDataset(options, &reconstruction);
+
+  CorrespondenceGraph correspondence_graph;
+  SynthesizeCorrespondenceGraph(reconstruction, &correspondence_graph);
+
+  BOOST_CHECK_EQUAL(correspondence_graph.NumImages(), options.num_images);
+  BOOST_CHECK_EQUAL(correspondence_graph.NumImagePairs(), 6);
+  for (image_t image_id1 = 1; image_id1 <= 4; ++image_id1) {
+    for (image_t image_id2 = image_id1 + 1; image_id2 <= 4; ++image_id2) {
+      BOOST_CHECK_EQUAL(correspondence_graph.NumCorrespondencesBetweenImages(
+                            image_id1, image_id2),
+                        options.num_points3D);
+    }
+  }
+  BOOST_CHECK_EQUAL(
+      correspondence_graph.FindTransitiveCorrespondences(1, 0, 2).size(),
+      options.num_images - 1);
+}
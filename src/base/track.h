@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "util/logging.h"
+#include "util/small_vector.h"
 #include "util/types.h"
 
 namespace colmap {
@@ -49,6 +50,10 @@ struct TrackElement {
   point2D_t point2D_idx;
 };
 
+// The elements of a track. Most tracks only have a few elements, which are
+// stored inline to avoid a separate heap allocation for every 3D point.
+typedef SmallVector<TrackElement, 4> TrackElements;
+
 class Track {
  public:
   Track();
@@ -57,8 +62,8 @@ class Track {
   inline size_t Length() const;
 
   // Access all elements.
-  inline const std::vector<TrackElement>& Elements() const;
-  inline std::vector<TrackElement>& Elements();
+  inline const TrackElements& Elements() const;
+  inline TrackElements& Elements();
   inline void SetElements(const std::vector<TrackElement>& elements);
 
   // Access specific elements.
@@ -70,6 +75,7 @@ class Track {
   inline void AddElement(const TrackElement& element);
   inline void AddElement(const image_t image_id, const point2D_t point2D_idx);
   inline void AddElements(const std::vector<TrackElement>& elements);
+  inline void AddElements(const TrackElements& elements);
 
   // Delete existing element.
   inline void DeleteElement(const size_t idx);
@@ -79,11 +85,12 @@ class Track {
   // specified number of elements.
   inline void Reserve(const size_t num_elements);
 
-  // Shrink the capacity of track vector to fit its size to save memory.
+  // Shrink the capacity of track vector to fit its size to save memory. The
+  // elements are moved back inline, if they fit.
   inline void Compress();
 
  private:
-  std::vector<TrackElement> elements_;
+  TrackElements elements_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -92,12 +99,12 @@ class Track {
 
 size_t Track::Length() const { return elements_.size(); }
 
-const std::vector<TrackElement>& Track::Elements() const { return elements_; }
+const TrackElements& Track::Elements() const { return elements_; }
 
-std::vector<TrackElement>& Track::Elements() { return elements_; }
+TrackElements& Track::Elements() { return elements_; }
 
 void Track::SetElements(const std::vector<TrackElement>& elements) {
-  elements_ = elements;
+  elements_ = TrackElements(elements.begin(), elements.end());
 }
 
 // Access specific elements.
@@ -123,6 +130,11 @@ void Track::AddElements(const std::vector<TrackElement>& elements) {
   elements_.insert(elements_.end(), elements.begin(), elements.end());
 }
 
+void Track::AddElements(const TrackElements& elements) {
+  CHECK_NE(&elements, &elements_);
+  elements_.insert(elements_.end(), elements.begin(), elements.end());
+}
+
 void Track::DeleteElement(const size_t idx) {
   CHECK_LT(idx, elements_.size());
   elements_.erase(elements_.begin() + idx);
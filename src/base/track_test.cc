@@ -119,19 +119,42 @@ BOOST_AUTO_TEST_CASE(TestDeleteElement) {
 BOOST_AUTO_TEST_CASE(TestReserve) {
   Track track;
   track.Reserve(2);
-  BOOST_CHECK_EQUAL(track.Elements().capacity(), 2);
+  BOOST_CHECK_EQUAL(track.Elements().capacity(), 4);
+  BOOST_CHECK(track.Elements().is_inline());
+  track.Reserve(8);
+  BOOST_CHECK_EQUAL(track.Elements().capacity(), 8);
+  BOOST_CHECK(!track.Elements().is_inline());
 }
 
 BOOST_AUTO_TEST_CASE(TestCompress) {
   Track track;
-  track.AddElement(0, 1);
-  track.AddElement(0, 2);
-  track.AddElement(0, 3);
-  track.AddElement(0, 3);
-  BOOST_CHECK_EQUAL(track.Elements().capacity(), 4);
+  for (point2D_t point2D_idx = 0; point2D_idx < 6; ++point2D_idx) {
+    track.AddElement(0, point2D_idx);
+  }
+  BOOST_CHECK_EQUAL(track.Elements().capacity(), 8);
+  track.Compress();
+  BOOST_CHECK_EQUAL(track.Elements().capacity(), 6);
   track.DeleteElement(0);
   track.DeleteElement(0);
-  BOOST_CHECK_EQUAL(track.Elements().capacity(), 4);
+  track.DeleteElement(0);
+  BOOST_CHECK_EQUAL(track.Elements().capacity(), 6);
   track.Compress();
-  BOOST_CHECK_EQUAL(track.Elements().capacity(), 2);
+  BOOST_CHECK_EQUAL(track.Elements().capacity(), 4);
+  BOOST_CHECK(track.Elements().is_inline());
+  BOOST_CHECK_EQUAL(track.Length(), 3);
+  BOOST_CHECK_EQUAL(track.Element(0).point2D_idx, 3);
+  BOOST_CHECK_EQUAL(track.Element(2).point2D_idx, 5);
+}
+
+BOOST_AUTO_TEST_CASE(TestAddElements) {
+  Track track1;
+  track1.AddElement(0, 1);
+  track1.AddElement(0, 2);
+  Track track2;
+  track2.AddElement(1, 1);
+  track2.AddElements(track1.Elements());
+  track2.AddElements(track1.Elements());
+  BOOST_CHECK_EQUAL(track2.Length(), 5);
+  BOOST_CHECK_EQUAL(track2.Element(0).image_id, 1);
+  BOOST_CHECK_EQUAL(track2.Element(4).point2D_idx, 2);
 }
@@ -41,6 +41,30 @@
 namespace colmap {
 namespace {
 
+// Maximum distance between the images of the corners of a width x height
+// image under the two homographies.
+double ComputeMaxCornerDistance(const Eigen::Matrix3d& H1,
+                                const Eigen::Matrix3d& H2, const double width,
+                                const double height) {
+  double max_distance = 0;
+  for (const double x : {0.0, width}) {
+    for (const double y : {0.0, height}) {
+      const Eigen::Vector3d corner(x, y, 1);
+      max_distance =
+          std::max(max_distance,
+                   ((H1 * corner).hnormalized() - (H2 * corner).hnormalized())
+                       .norm());
+    }
+  }
+  return max_distance;
+}
+
+// An image in the COLMAP undistortion pipeline.
+struct UndistortionJob {
+  size_t reg_image_idx = 0;
+  Bitmap bitmap;
+};
+
 template <typename Derived>
 void WriteMatrix(const Eigen::MatrixBase<Derived>& matrix,
                  std::ofstream* file) {
@@ -80,6 +104,7 @@ void WriteCOLMAPCommands(const bool geometric,
                          const std::string& workspace_path,
                          const std::string& workspace_format,
                          const std::string& pmvs_option_name,
+                         const std::string& distorted_image_path,
                          const std::string& output_prefix,
                          const std::string& indent, std::ofstream* file) {
   if (geometric) {
@@ -92,6 +117,10 @@ void WriteCOLMAPCommands(const bool geometric,
       *file << indent << "  --pmvs_option_name " << pmvs_option_name << " \\"
             << std::endl;
     }
+    if (!distorted_image_path.empty()) {
+      *file << indent << "  --PatchMatchStereo.distorted_image_path "
+            << distorted_image_path << " \\" << std::endl;
+    }
     *file << indent << "  --PatchMatchStereo.max_image_size 2000 \\"
           << std::endl;
     *file << indent << "  --PatchMatchStereo.geom_consistency true"
@@ -106,6 +135,10 @@ void WriteCOLMAPCommands(const bool geometric,
       *file << indent << "  --pmvs_option_name " << pmvs_option_name << " \\"
             << std::endl;
     }
+    if (!distorted_image_path.empty()) {
+      *file << indent << "  --PatchMatchStereo.distorted_image_path "
+            << distorted_image_path << " \\" << std::endl;
+    }
     *file << indent << "  --PatchMatchStereo.max_image_size 2000 \\"
           << std::endl;
     *file << indent << "  --PatchMatchStereo.geom_consistency false"
@@ -121,6 +154,10 @@ void WriteCOLMAPCommands(const bool geometric,
     *file << indent << "  --pmvs_option_name " << pmvs_option_name << " \\"
           << std::endl;
   }
+  if (!distorted_image_path.empty()) {
+    *file << indent << "  --StereoFusion.distorted_image_path "
+          << distorted_image_path << " \\" << std::endl;
+  }
   if (geometric) {
     *file << indent << "  --input_type geometric \\" << std::endl;
   } else {
@@ -155,42 +192,46 @@ COLMAPUndistorter::COLMAPUndistorter(const UndistortCameraOptions& options,
     : options_(options),
       image_path_(image_path),
       output_path_(output_path),
-      reconstruction_(reconstruction) {}
+      reconstruction_(reconstruction) {
+  CHECK_GT(options_.queue_size, 0);
+  CHECK(options_.image_encoding == "DEFAULT" ||
+        options_.image_encoding == "FAST" ||
+        options_.image_encoding == "UNCOMPRESSED" ||
+        options_.image_encoding == "NONE")
+      << "Invalid image encoding: " << options_.image_encoding;
+}
 
 void COLMAPUndistorter::Run() {
   PrintHeading1("Image undistortion");
 
-  CreateDirIfNotExists(JoinPaths(output_path_, "images"));
+  const bool write_images = options_.image_encoding != "NONE";
+
+  if (write_images) {
+    CreateDirIfNotExists(JoinPaths(output_path_, "images"));
+    reconstruction_.CreateImageDirs(JoinPaths(output_path_, "images"));
+  }
   CreateDirIfNotExists(JoinPaths(output_path_, "sparse"));
   CreateDirIfNotExists(JoinPaths(output_path_, "stereo"));
   CreateDirIfNotExists(JoinPaths(output_path_, "stereo/depth_maps"));
   CreateDirIfNotExists(JoinPaths(output_path_, "stereo/normal_maps"));
   CreateDirIfNotExists(JoinPaths(output_path_, "stereo/consistency_graphs"));
-  reconstruction_.CreateImageDirs(JoinPaths(output_path_, "images"));
+  CreateDirIfNotExists(JoinPaths(output_path_, "stereo/confidence_maps"));
   reconstruction_.CreateImageDirs(JoinPaths(output_path_, "stereo/depth_maps"));
   reconstruction_.CreateImageDirs(
       JoinPaths(output_path_, "stereo/normal_maps"));
   reconstruction_.CreateImageDirs(
       JoinPaths(output_path_, "stereo/consistency_graphs"));
+  reconstruction_.CreateImageDirs(
+      JoinPaths(output_path_, "stereo/confidence_maps"));
 
-  ThreadPool thread_pool;
-  std::vector<std::future<void>> futures;
-  futures.reserve(reconstruction_.NumRegImages());
-  for (size_t i = 0; i < reconstruction_.NumRegImages(); ++i) {
-    futures.push_back(
-        thread_pool.AddTask(&COLMAPUndistorter::Undistort, this, i));
-  }
-
-  for (size_t i = 0; i < futures.size(); ++i) {
-    if (IsStopped()) {
-      break;
-    }
-
-    std::cout << StringPrintf("Undistorting image [%d/%d]", i + 1,
-                              futures.size())
-              << std::endl;
-
-    futures[i].get();
+  if (write_images) {
+    UndistortImages();
+  } else {
+    // The stereo and fusion stages undistort the original images on the fly
+    // with the distorted cameras.
+    std::cout << "Writing distorted reconstruction..." << std::endl;
+    CreateDirIfNotExists(JoinPaths(output_path_, "sparse", "distorted"));
+    reconstruction_.Write(JoinPaths(output_path_, "sparse", "distorted"));
   }
 
   std::cout << "Writing reconstruction..." << std::endl;
@@ -209,28 +250,118 @@ void COLMAPUndistorter::Run() {
   GetTimer().PrintMinutes();
 }
 
-void COLMAPUndistorter::Undistort(const size_t reg_image_idx) const {
-  const image_t image_id = reconstruction_.RegImageIds().at(reg_image_idx);
-  const Image& image = reconstruction_.Image(image_id);
-  const Camera& camera = reconstruction_.Camera(image.CameraId());
+void COLMAPUndistorter::UndistortImages() {
+  // The images are decoded, undistorted, and encoded in separate stages, such
+  // that reading and writing overlaps with the undistortion. The bounded
+  // queues between the stages limit the number of images in memory.
+  const int num_threads = GetEffectiveNumThreads(options_.num_threads);
+  ThreadPool decode_thread_pool(num_threads);
+  ThreadPool undistort_thread_pool(num_threads);
+  ThreadPool encode_thread_pool(num_threads);
+  JobQueue<UndistortionJob> undistort_queue(options_.queue_size);
+  JobQueue<UndistortionJob> encode_queue(options_.queue_size);
+
+  undistortion_maps_ =
+      CreateUndistortionMapCache(options_, reconstruction_, num_threads);
+
+  std::vector<std::future<void>> decode_futures;
+  decode_futures.reserve(reconstruction_.NumRegImages());
+  for (size_t i = 0; i < reconstruction_.NumRegImages(); ++i) {
+    decode_futures.push_back(decode_thread_pool.AddTask([&, i]() {
+      const image_t image_id = reconstruction_.RegImageIds().at(i);
+      const Image& image = reconstruction_.Image(image_id);
+      UndistortionJob job;
+      job.reg_image_idx = i;
+      const std::string input_image_path = JoinPaths(image_path_, image.Name());
+      if (!job.bitmap.Read(input_image_path)) {
+        std::cerr << "ERROR: Cannot read image at path " << input_image_path
+                  << std::endl;
+        return;
+      }
+      undistort_queue.Push(std::move(job));
+    }));
+  }
 
-  const std::string output_image_path =
-      JoinPaths(output_path_, "images", image.Name());
+  for (int i = 0; i < num_threads; ++i) {
+    undistort_thread_pool.AddTask([&]() {
+      while (true) {
+        auto input_job = undistort_queue.Pop();
+        if (!input_job.IsValid()) {
+          break;
+        }
+        const image_t image_id =
+            reconstruction_.RegImageIds().at(input_job.Data().reg_image_idx);
+        const std::shared_ptr<const UndistortionMap> undistortion_map =
+            undistortion_maps_->Get(reconstruction_.Image(image_id).CameraId());
+        UndistortionJob output_job;
+        output_job.reg_image_idx = input_job.Data().reg_image_idx;
+        UndistortImage(*undistortion_map, input_job.Data().bitmap,
+                       &output_job.bitmap);
+        input_job.Data().bitmap.Deallocate();
+        encode_queue.Push(std::move(output_job));
+      }
+    });
 
-  Bitmap distorted_bitmap;
-  const std::string input_image_path = JoinPaths(image_path_, image.Name());
-  if (!distorted_bitmap.Read(input_image_path)) {
-    std::cerr << "ERROR: Cannot read image at path " << input_image_path
+    encode_thread_pool.AddTask([&]() {
+      while (true) {
+        const auto job = encode_queue.Pop();
+        if (!job.IsValid()) {
+          break;
+        }
+        const image_t image_id =
+            reconstruction_.RegImageIds().at(job.Data().reg_image_idx);
+        const std::string output_image_path = JoinPaths(
+            output_path_, "images", reconstruction_.Image(image_id).Name());
+        if (!WriteImage(job.Data().bitmap, output_image_path)) {
+          std::cerr << "ERROR: Cannot write image at path "
+                    << output_image_path << std::endl;
+        }
+      }
+    });
+  }
+
+  for (size_t i = 0; i < decode_futures.size(); ++i) {
+    if (IsStopped()) {
+      undistort_queue.Stop();
+      encode_queue.Stop();
+      undistort_queue.Clear();
+      encode_queue.Clear();
+      decode_thread_pool.Stop();
+      break;
+    }
+
+    std::cout << StringPrintf("Undistorting image [%d/%d]", i + 1,
+                              decode_futures.size())
               << std::endl;
-    return;
+
+    decode_futures[i].get();
   }
 
-  Bitmap undistorted_bitmap;
-  Camera undistorted_camera;
-  UndistortImage(options_, distorted_bitmap, camera, &undistorted_bitmap,
-                 &undistorted_camera);
+  undistort_queue.Wait();
+  undistort_queue.Stop();
+  undistort_thread_pool.Wait();
 
-  undistorted_bitmap.Write(output_image_path);
+  encode_queue.Wait();
+  encode_queue.Stop();
+  encode_thread_pool.Wait();
+}
+
+bool COLMAPUndistorter::WriteImage(const Bitmap& bitmap,
+                                   const std::string& path) const {
+  if (options_.image_encoding == "UNCOMPRESSED") {
+    return bitmap.Write(path, FIF_BMP);
+  } else if (options_.image_encoding == "FAST") {
+    switch (FreeImage_GetFIFFromFilename(path.c_str())) {
+      case FIF_UNKNOWN:
+      case FIF_PNG:
+        return bitmap.Write(path, FIF_PNG, PNG_Z_BEST_SPEED);
+      case FIF_TIFF:
+        return bitmap.Write(path, FIF_TIFF, TIFF_NONE);
+      default:
+        break;
+    }
+  }
+  return bitmap.Write(path);
 }
 
 void COLMAPUndistorter::WritePatchMatchConfig() const {
@@ -263,7 +394,9 @@ void COLMAPUndistorter::WriteScript(const bool geometric) const {
 
   file << "# You must set $COLMAP_EXE_PATH to " << std::endl
        << "# the directory containing the COLMAP executables." << std::endl;
-  WriteCOLMAPCommands(geometric, ".", "COLMAP", "option-all", "", "", &file);
+  WriteCOLMAPCommands(geometric, ".", "COLMAP", "option-all",
+                      options_.image_encoding == "NONE" ? image_path_ : "", "",
+                      "", &file);
 }
 
 PMVSUndistorter::PMVSUndistorter(const UndistortCameraOptions& options,
@@ -284,6 +417,8 @@ void PMVSUndistorter::Run() {
   CreateDirIfNotExists(JoinPaths(output_path_, "pmvs/models"));
 
   ThreadPool thread_pool;
+  undistortion_maps_ = CreateUndistortionMapCache(
+      options_, reconstruction_, thread_pool.NumThreads());
   std::vector<std::future<void>> futures;
   futures.reserve(reconstruction_.NumRegImages());
   for (size_t i = 0; i < reconstruction_.NumRegImages(); ++i) {
@@ -340,7 +475,6 @@ void PMVSUndistorter::Undistort(const size_t reg_image_idx) const {
 
   const image_t image_id = reconstruction_.RegImageIds().at(reg_image_idx);
   const Image& image = reconstruction_.Image(image_id);
-  const Camera& camera = reconstruction_.Camera(image.CameraId());
 
   Bitmap distorted_bitmap;
   const std::string input_image_path = JoinPaths(image_path_, image.Name());
@@ -351,10 +485,11 @@ void PMVSUndistorter::Undistort(const size_t reg_image_idx) const {
     return;
   }
 
+  const std::shared_ptr<const UndistortionMap> undistortion_map =
+      undistortion_maps_->Get(image.CameraId());
   Bitmap undistorted_bitmap;
-  Camera undistorted_camera;
-  UndistortImage(options_, distorted_bitmap, camera, &undistorted_bitmap,
-                 &undistorted_camera);
+  UndistortImage(*undistortion_map, distorted_bitmap, &undistorted_bitmap);
+  const Camera& undistorted_camera = undistortion_map->undistorted_camera;
 
   undistorted_bitmap.Write(output_image_path);
   WriteProjectionMatrix(proj_matrix_path, undistorted_camera, image, "CONTOUR");
@@ -438,8 +573,8 @@ void PMVSUndistorter::WriteCOLMAPScript(const bool geometric) const {
 
   file << "# You must set $COLMAP_EXE_PATH to " << std::endl
        << "# the directory containing the COLMAP executables." << std::endl;
-  WriteCOLMAPCommands(geometric, "pmvs", "PMVS", "option-all", "option-all-",
-                      "", &file);
+  WriteCOLMAPCommands(geometric, "pmvs", "PMVS", "option-all", "",
+                      "option-all-", "", &file);
 }
 
 void PMVSUndistorter::WriteCMVSCOLMAPScript(const bool geometric) const {
@@ -464,7 +599,7 @@ void PMVSUndistorter::WriteCMVSCOLMAPScript(const bool geometric) const {
   file << "        continue" << std::endl;
   file << "    fi" << std::endl;
   file << "    rm -rf \"$workspace_path/stereo\"" << std::endl;
-  WriteCOLMAPCommands(geometric, "pmvs", "PMVS", "$option_name",
+  WriteCOLMAPCommands(geometric, "pmvs", "PMVS", "$option_name", "",
                       "$option_name-", "    ", &file);
   file << "done" << std::endl;
 }
@@ -511,6 +646,8 @@ void CMPMVSUndistorter::Run() {
   PrintHeading1("Image undistortion (CMP-MVS)");
 
   ThreadPool thread_pool;
+  undistortion_maps_ = CreateUndistortionMapCache(
+      options_, reconstruction_, thread_pool.NumThreads());
   std::vector<std::future<void>> futures;
   futures.reserve(reconstruction_.NumRegImages());
   for (size_t i = 0; i < reconstruction_.NumRegImages(); ++i) {
@@ -541,7 +678,6 @@ void CMPMVSUndistorter::Undistort(const size_t reg_image_idx) const {
 
   const image_t image_id = reconstruction_.RegImageIds().at(reg_image_idx);
   const Image& image = reconstruction_.Image(image_id);
-  const Camera& camera = reconstruction_.Camera(image.CameraId());
 
   Bitmap distorted_bitmap;
   const std::string input_image_path = JoinPaths(image_path_, image.Name());
@@ -551,10 +687,11 @@ void CMPMVSUndistorter::Undistort(const size_t reg_image_idx) const {
     return;
   }
 
+  const std::shared_ptr<const UndistortionMap> undistortion_map =
+      undistortion_maps_->Get(image.CameraId());
   Bitmap undistorted_bitmap;
-  Camera undistorted_camera;
-  UndistortImage(options_, distorted_bitmap, camera, &undistorted_bitmap,
-                 &undistorted_camera);
+  UndistortImage(*undistortion_map, distorted_bitmap, &undistorted_bitmap);
+  const Camera& undistorted_camera = undistortion_map->undistorted_camera;
 
   undistorted_bitmap.Write(output_image_path);
   WriteProjectionMatrix(proj_matrix_path, undistorted_camera, image, "CONTOUR");
@@ -629,12 +766,16 @@ StereoImageRectifier::StereoImageRectifier(
       image_path_(image_path),
       output_path_(output_path),
       stereo_pairs_(stereo_pairs),
-      reconstruction_(reconstruction) {}
+      reconstruction_(reconstruction),
+      max_num_cached_maps_(static_cast<size_t>(
+          GetEffectiveNumThreads(options.num_threads))) {
+  CHECK_GE(options_.max_rectification_map_error, 0);
+}
 
 void StereoImageRectifier::Run() {
   PrintHeading1("Stereo rectification");
 
-  ThreadPool thread_pool;
+  ThreadPool thread_pool(options_.num_threads);
   std::vector<std::future<void>> futures;
   futures.reserve(stereo_pairs_.size());
   for (const auto& stereo_pair : stereo_pairs_) {
@@ -699,14 +840,15 @@ void StereoImageRectifier::Rectify(const image_t image_id1,
   ComputeRelativePose(image1.Qvec(), image1.Tvec(), image2.Qvec(),
                       image2.Tvec(), &qvec, &tvec);
 
+  Eigen::Matrix4d Q;
+  const auto rectification_map =
+      GetRectificationMap(image1.CameraId(), image2.CameraId(), qvec, tvec, &Q);
+
   Bitmap undistorted_bitmap1;
   Bitmap undistorted_bitmap2;
-  Camera undistorted_camera;
-  Eigen::Matrix4d Q;
-  RectifyAndUndistortStereoImages(
-      options_, distorted_bitmap1, distorted_bitmap2, camera1, camera2, qvec,
-      tvec, &undistorted_bitmap1, &undistorted_bitmap2, &undistorted_camera,
-      &Q);
+  RectifyAndUndistortStereoImages(*rectification_map, distorted_bitmap1,
+                                  distorted_bitmap2, &undistorted_bitmap1,
+                                  &undistorted_bitmap2);
 
   undistorted_bitmap1.Write(output_image1_path);
   undistorted_bitmap2.Write(output_image2_path);
@@ -717,6 +859,56 @@ void StereoImageRectifier::Rectify(const image_t image_id1,
   WriteMatrix(Q, &Q_file);
 }
 
+std::shared_ptr<const StereoRectificationMap>
+StereoImageRectifier::GetRectificationMap(const camera_t camera_id1,
+                                          const camera_t camera_id2,
+                                          const Eigen::Vector4d& qvec,
+                                          const Eigen::Vector3d& tvec,
+                                          Eigen::Matrix4d* Q) const {
+  const Camera& camera1 = reconstruction_.Camera(camera_id1);
+  const Camera& camera2 = reconstruction_.Camera(camera_id2);
+
+  // The homographies and Q are cheap to compute, only the per-pixel maps are
+  // worth caching. Note that Q also depends on the baseline of the pair.
+  const Camera undistorted_camera = UndistortCamera(options_, camera1);
+  Eigen::Matrix3d H1;
+  Eigen::Matrix3d H2;
+  RectifyStereoCameras(undistorted_camera, undistorted_camera, qvec, tvec, &H1,
+                       &H2, Q);
+
+  {
+    std::unique_lock<std::mutex> lock(cached_maps_mutex_);
+    for (auto it = cached_maps_.begin(); it != cached_maps_.end(); ++it) {
+      if (it->camera_id1 != camera_id1 || it->camera_id2 != camera_id2) {
+        continue;
+      }
+      const double map_error = std::max(
+          ComputeMaxCornerDistance(H1.inverse(), it->map->H1.inverse(),
+                                   camera1.Width(), camera1.Height()),
+          ComputeMaxCornerDistance(H2.inverse(), it->map->H2.inverse(),
+                                   camera2.Width(), camera2.Height()));
+      if (map_error <= options_.max_rectification_map_error) {
+        cached_maps_.splice(cached_maps_.begin(), cached_maps_, it);
+        return cached_maps_.front().map;
+      }
+    }
+  }
+
+  // Compute the map outside of the lock, such that other pairs proceed.
+  std::shared_ptr<const StereoRectificationMap> rectification_map =
+      std::make_shared<StereoRectificationMap>(CreateStereoRectificationMap(
+          camera1, camera2, undistorted_camera, H1, H2));
+
+  std::unique_lock<std::mutex> lock(cached_maps_mutex_);
+  cached_maps_.push_front(
+      CachedRectificationMap{camera_id1, camera_id2, rectification_map});
+  while (cached_maps_.size() > max_num_cached_maps_) {
+    cached_maps_.pop_back();
+  }
+
+  return rectification_map;
+}
+
 Camera UndistortCamera(const UndistortCameraOptions& options,
                        const Camera& camera) {
   CHECK_GE(options.blank_pixels, 0);
@@ -909,14 +1101,40 @@ void UndistortImage(const UndistortCameraOptions& options,
   CHECK_EQ(distorted_camera.Width(), distorted_bitmap.Width());
   CHECK_EQ(distorted_camera.Height(), distorted_bitmap.Height());
 
-  *undistorted_camera = UndistortCamera(options, distorted_camera);
-  undistorted_bitmap->Allocate(static_cast<int>(undistorted_camera->Width()),
-                               static_cast<int>(undistorted_camera->Height()),
+  const UndistortionMap undistortion_map =
+      CreateUndistortionMap(options, distorted_camera);
+  UndistortImage(undistortion_map, distorted_bitmap, undistorted_bitmap);
+  *undistorted_camera = undistortion_map.undistorted_camera;
+}
+
+UndistortionMap CreateUndistortionMap(const UndistortCameraOptions& options,
+                                      const Camera& distorted_camera) {
+  const Camera undistorted_camera = UndistortCamera(options, distorted_camera);
+  return UndistortionMap{undistorted_camera,
+                         CameraWarpMap(distorted_camera, undistorted_camera)};
+}
+
+std::unique_ptr<UndistortionMapCache> CreateUndistortionMapCache(
+    const UndistortCameraOptions& options,
+    const Reconstruction& reconstruction, const size_t max_num_maps) {
+  CHECK_GT(max_num_maps, 0);
+  const auto create_map = [options, &reconstruction](const camera_t camera_id) {
+    return CreateUndistortionMap(options, reconstruction.Camera(camera_id));
+  };
+  return std::unique_ptr<UndistortionMapCache>(
+      new UndistortionMapCache(max_num_maps, max_num_maps, create_map));
+}
+
+void UndistortImage(const UndistortionMap& undistortion_map,
+                    const Bitmap& distorted_bitmap,
+                    Bitmap* undistorted_bitmap) {
+  const Camera& undistorted_camera = undistortion_map.undistorted_camera;
+  undistorted_bitmap->Allocate(static_cast<int>(undistorted_camera.Width()),
+                               static_cast<int>(undistorted_camera.Height()),
                                distorted_bitmap.IsRGB());
   distorted_bitmap.CloneMetadata(undistorted_bitmap);
 
-  WarpImageBetweenCameras(distorted_camera, *undistorted_camera,
-                          distorted_bitmap, undistorted_bitmap);
+  undistortion_map.warp_map.Warp(distorted_bitmap, undistorted_bitmap);
 }
 
 void UndistortReconstruction(const UndistortCameraOptions& options,
@@ -931,11 +1149,17 @@ void UndistortReconstruction(const UndistortCameraOptions& options,
     auto& image = reconstruction->Image(distorted_image.first);
     const auto& distorted_camera = distorted_cameras.at(image.CameraId());
     const auto& undistorted_camera = reconstruction->Camera(image.CameraId());
+    std::vector<Eigen::Vector2d> points2D(image.NumPoints2D());
+    for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
+         ++point2D_idx) {
+      points2D[point2D_idx] = image.Point2DXY(point2D_idx);
+    }
+    const std::vector<Eigen::Vector2d> undistorted_points2D =
+        undistorted_camera.WorldToImage(
+            distorted_camera.ImageToWorld(points2D));
     for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
          ++point2D_idx) {
-      auto& point2D = image.Point2D(point2D_idx);
-      point2D.SetXY(undistorted_camera.WorldToImage(
-          distorted_camera.ImageToWorld(point2D.XY())));
+      image.SetPoint2DXY(point2D_idx, undistorted_points2D[point2D_idx]);
     }
   }
 }
@@ -1015,27 +1239,47 @@ void RectifyAndUndistortStereoImages(
   CHECK_EQ(distorted_camera2.Height(), distorted_image2.Height());
 
   *undistorted_camera = UndistortCamera(options, distorted_camera1);
-  undistorted_image1->Allocate(static_cast<int>(undistorted_camera->Width()),
-                               static_cast<int>(undistorted_camera->Height()),
-                               distorted_image1.IsRGB());
-  distorted_image1.CloneMetadata(undistorted_image1);
-
-  undistorted_image2->Allocate(static_cast<int>(undistorted_camera->Width()),
-                               static_cast<int>(undistorted_camera->Height()),
-                               distorted_image2.IsRGB());
-  distorted_image2.CloneMetadata(undistorted_image2);
 
   Eigen::Matrix3d H1;
   Eigen::Matrix3d H2;
   RectifyStereoCameras(*undistorted_camera, *undistorted_camera, qvec, tvec,
                        &H1, &H2, Q);
 
-  WarpImageWithHomographyBetweenCameras(H1.inverse(), distorted_camera1,
-                                        *undistorted_camera, distorted_image1,
-                                        undistorted_image1);
-  WarpImageWithHomographyBetweenCameras(H2.inverse(), distorted_camera2,
-                                        *undistorted_camera, distorted_image2,
-                                        undistorted_image2);
+  RectifyAndUndistortStereoImages(
+      CreateStereoRectificationMap(distorted_camera1, distorted_camera2,
+                                   *undistorted_camera, H1, H2),
+      distorted_image1, distorted_image2, undistorted_image1,
+      undistorted_image2);
+}
+
+StereoRectificationMap CreateStereoRectificationMap(
+    const Camera& distorted_camera1, const Camera& distorted_camera2,
+    const Camera& undistorted_camera, const Eigen::Matrix3d& H1,
+    const Eigen::Matrix3d& H2) {
+  return StereoRectificationMap{
+      undistorted_camera, H1, H2,
+      CameraWarpMap(H1.inverse(), distorted_camera1, undistorted_camera),
+      CameraWarpMap(H2.inverse(), distorted_camera2, undistorted_camera)};
+}
+
+void RectifyAndUndistortStereoImages(
+    const StereoRectificationMap& rectification_map,
+    const Bitmap& distorted_image1, const Bitmap& distorted_image2,
+    Bitmap* undistorted_image1, Bitmap* undistorted_image2) {
+  const Camera& undistorted_camera = rectification_map.undistorted_camera;
+
+  undistorted_image1->Allocate(static_cast<int>(undistorted_camera.Width()),
+                               static_cast<int>(undistorted_camera.Height()),
+                               distorted_image1.IsRGB());
+  distorted_image1.CloneMetadata(undistorted_image1);
+
+  undistorted_image2->Allocate(static_cast<int>(undistorted_camera.Width()),
+                               static_cast<int>(undistorted_camera.Height()),
+                               distorted_image2.IsRGB());
+  distorted_image2.CloneMetadata(undistorted_image2);
+
+  rectification_map.warp_map1.Warp(distorted_image1, undistorted_image1);
+  rectification_map.warp_map2.Warp(distorted_image2, undistorted_image2);
 }
 
 }  // namespace colmap
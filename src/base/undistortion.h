@@ -32,9 +32,15 @@
 #ifndef COLMAP_SRC_BASE_UNDISTORTION_H_
 #define COLMAP_SRC_BASE_UNDISTORTION_H_
 
+#include <list>
+#include <memory>
+#include <mutex>
+
 #include "base/reconstruction.h"
+#include "base/warp.h"
 #include "util/alignment.h"
 #include "util/bitmap.h"
+#include "util/cache.h"
 #include "util/threading.h"
 
 namespace colmap {
@@ -59,6 +65,54 @@ struct UndistortCameraOptions {
   double roi_min_y = 0.0;
   double roi_max_x = 1.0;
   double roi_max_y = 1.0;
+
+  // The number of threads of each stage of the COLMAP undistortion pipeline,
+  // which decodes, undistorts, and encodes the images concurrently.
+  int num_threads = -1;
+
+  // The maximum number of decoded and undistorted images buffered between
+  // the stages of the COLMAP undistortion pipeline.
+  int queue_size = 16;
+
+  // The encoding of the images written by the COLMAP undistorter:
+  //  - DEFAULT: The format of the file extension with high quality.
+  //  - FAST: The fastest compression level for PNG and TIFF images, while
+  //          JPEG images are written as for DEFAULT.
+  //  - UNCOMPRESSED: Uncompressed BMP data under the original image name.
+  //          COLMAP detects the format of images by their content, so that the
+  //          stereo and fusion stages read them regardless of the extension.
+  //  - NONE: No images are written. Instead, the distorted reconstruction is
+  //          written to `sparse/distorted` and the stereo and fusion stages
+  //          undistort the original images as they are read.
+  std::string image_encoding = "DEFAULT";
+
+  // The maximum displacement in pixels of the image corners between the
+  // rectifying homographies of two stereo pairs of the same cameras, such that
+  // the image rectifier reuses the rectification maps of one pair for the
+  // other. Stereo rigs with a fixed relative pose thereby compute the maps
+  // only once. Maps are only reused for identical homographies if zero.
+  double max_rectification_map_error = 0.01;
+};
+
+// Undistorted camera of a distorted camera together with the precomputed
+// pixel mapping between the two cameras. All images of the same camera share
+// the same map, so that the camera models need not be evaluated per image.
+struct UndistortionMap {
+  Camera undistorted_camera;
+  CameraWarpMap warp_map;
+};
+
+// Thread-safe cache of undistortion maps indexed by the camera identifier.
+typedef ShardedLRUCache<camera_t, UndistortionMap> UndistortionMapCache;
+
+// Rectified and undistorted camera of a stereo pair together with the
+// rectifying homographies and the precomputed pixel mappings of both images.
+struct StereoRectificationMap {
+  Camera undistorted_camera;
+  Eigen::Matrix3d H1;
+  Eigen::Matrix3d H2;
+  CameraWarpMap warp_map1;
+  CameraWarpMap warp_map2;
 };
 
 // Undistort images and export undistorted cameras, as required by the
@@ -73,7 +127,8 @@ class COLMAPUndistorter : public Thread {
  private:
   void Run();
 
-  void Undistort(const size_t reg_image_idx) const;
+  void UndistortImages();
+  bool WriteImage(const Bitmap& bitmap, const std::string& path) const;
   void WritePatchMatchConfig() const;
   void WriteFusionConfig() const;
   void WriteScript(const bool geometric) const;
@@ -82,6 +137,7 @@ class COLMAPUndistorter : public Thread {
   std::string image_path_;
   std::string output_path_;
   const Reconstruction& reconstruction_;
+  std::unique_ptr<UndistortionMapCache> undistortion_maps_;
 };
 
 // Undistort images and prepare data for CMVS/PMVS.
@@ -107,6 +163,7 @@ class PMVSUndistorter : public Thread {
   std::string image_path_;
   std::string output_path_;
   const Reconstruction& reconstruction_;
+  std::unique_ptr<UndistortionMapCache> undistortion_maps_;
 };
 
 // Undistort images and prepare data for CMP-MVS.
@@ -126,6 +183,7 @@ class CMPMVSUndistorter : public Thread {
   std::string image_path_;
   std::string output_path_;
   const Reconstruction& reconstruction_;
+  std::unique_ptr<UndistortionMapCache> undistortion_maps_;
 };
   
 // Undistort images and export undistorted cameras without the need for a
@@ -163,11 +221,29 @@ class StereoImageRectifier : public Thread {
 
   void Rectify(const image_t image_id1, const image_t image_id2) const;
 
+  // Get the rectification map of a stereo pair from the cache or compute it,
+  // if no cached map of the same cameras has close enough homographies.
+  std::shared_ptr<const StereoRectificationMap> GetRectificationMap(
+      const camera_t camera_id1, const camera_t camera_id2,
+      const Eigen::Vector4d& qvec, const Eigen::Vector3d& tvec,
+      Eigen::Matrix4d* Q) const;
+
+  struct CachedRectificationMap {
+    camera_t camera_id1;
+    camera_t camera_id2;
+    std::shared_ptr<const StereoRectificationMap> map;
+  };
+
   UndistortCameraOptions options_;
   std::string image_path_;
   std::string output_path_;
   const std::vector<std::pair<image_t, image_t>>& stereo_pairs_;
   const Reconstruction& reconstruction_;
+
+  // The most recently used rectification maps, ordered by last use.
+  size_t max_num_cached_maps_;
+  mutable std::mutex cached_maps_mutex_;
+  mutable std::list<CachedRectificationMap> cached_maps_;
 };
 
 // Undistort camera by resizing the image and shifting the principal point.
@@ -198,6 +274,20 @@ void UndistortImage(const UndistortCameraOptions& options,
                     const Camera& distorted_camera, Bitmap* undistorted_image,
                     Camera* undistorted_camera);
 
+// Compute the undistorted camera and the pixel mapping for a distorted camera.
+UndistortionMap CreateUndistortionMap(const UndistortCameraOptions& options,
+                                      const Camera& distorted_camera);
+
+// Create a cache of the undistortion maps for the cameras in the given
+// reconstruction. The cache holds at most `max_num_maps` maps at a time.
+std::unique_ptr<UndistortionMapCache> CreateUndistortionMapCache(
+    const UndistortCameraOptions& options,
+    const Reconstruction& reconstruction, const size_t max_num_maps);
+
+// Undistort image using a precomputed undistortion map.
+void UndistortImage(const UndistortionMap& undistortion_map,
+                    const Bitmap& distorted_image, Bitmap* undistorted_image);
+
 // Undistort all cameras in the reconstruction and accordingly all
 // observations in their corresponding images.
 void UndistortReconstruction(const UndistortCameraOptions& options,
@@ -221,6 +311,19 @@ void RectifyAndUndistortStereoImages(
     const Eigen::Vector3d& tvec, Bitmap* undistorted_image1,
     Bitmap* undistorted_image2, Camera* undistorted_camera, Eigen::Matrix4d* Q);
 
+// Compute the pixel mappings of a stereo pair for the given rectified camera
+// and the rectification homographies computed by `RectifyStereoCameras`.
+StereoRectificationMap CreateStereoRectificationMap(
+    const Camera& distorted_camera1, const Camera& distorted_camera2,
+    const Camera& undistorted_camera, const Eigen::Matrix3d& H1,
+    const Eigen::Matrix3d& H2);
+
+// Rectify and undistort the stereo image pair using a precomputed map.
+void RectifyAndUndistortStereoImages(
+    const StereoRectificationMap& rectification_map,
+    const Bitmap& distorted_image1, const Bitmap& distorted_image2,
+    Bitmap* undistorted_image1, Bitmap* undistorted_image2);
+
 }  // namespace colmap
 
 #endif  // COLMAP_SRC_BASE_UNDISTORTION_H_
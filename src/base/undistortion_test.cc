@@ -247,3 +247,63 @@ BOOST_AUTO_TEST_CASE(TestRectifyStereoCameras) {
   Q_ref << 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, -2.67261, -0.5, -0.5, 1, 0;
   BOOST_CHECK(Q.isApprox(Q_ref, 1e-5));
 }
+
+BOOST_AUTO_TEST_CASE(TestCreateStereoRectificationMap) {
+  Camera distorted_camera;
+  distorted_camera.InitializeWithName("SIMPLE_RADIAL", 100, 100, 80);
+  distorted_camera.Params(3) = 0.1;
+
+  UndistortCameraOptions options;
+  const Camera undistorted_camera = UndistortCamera(options, distorted_camera);
+
+  const Eigen::Vector4d qvec =
+      RotationMatrixToQuaternion(EulerAnglesToRotationMatrix(0.01, 0.02, 0));
+  const Eigen::Vector3d tvec(1, 0.05, 0);
+
+  Eigen::Matrix3d H1;
+  Eigen::Matrix3d H2;
+  Eigen::Matrix4d Q;
+  RectifyStereoCameras(undistorted_camera, undistorted_camera, qvec, tvec, &H1,
+                       &H2, &Q);
+
+  const StereoRectificationMap rectification_map =
+      CreateStereoRectificationMap(distorted_camera, distorted_camera,
+                                   undistorted_camera, H1, H2);
+  BOOST_CHECK_EQUAL(rectification_map.undistorted_camera.Width(),
+                    undistorted_camera.Width());
+  BOOST_CHECK_EQUAL(rectification_map.undistorted_camera.Height(),
+                    undistorted_camera.Height());
+  BOOST_CHECK_EQUAL(rectification_map.H1, H1);
+  BOOST_CHECK_EQUAL(rectification_map.H2, H2);
+  BOOST_CHECK_EQUAL(rectification_map.warp_map1.SourceWidth(), 100);
+  BOOST_CHECK_EQUAL(rectification_map.warp_map1.SourceHeight(), 80);
+  BOOST_CHECK_EQUAL(rectification_map.warp_map2.TargetWidth(),
+                    undistorted_camera.Width());
+  BOOST_CHECK_EQUAL(rectification_map.warp_map2.TargetHeight(),
+                    undistorted_camera.Height());
+
+  Bitmap distorted_image;
+  distorted_image.Allocate(100, 80, false);
+  distorted_image.Fill(BitmapColor<uint8_t>(255));
+
+  Bitmap undistorted_image1;
+  Bitmap undistorted_image2;
+  RectifyAndUndistortStereoImages(rectification_map, distorted_image,
+                                  distorted_image, &undistorted_image1,
+                                  &undistorted_image2);
+  BOOST_CHECK_EQUAL(undistorted_image1.Width(), undistorted_camera.Width());
+  BOOST_CHECK_EQUAL(undistorted_image1.Height(), undistorted_camera.Height());
+  BOOST_CHECK_EQUAL(undistorted_image2.Width(), undistorted_camera.Width());
+  BOOST_CHECK_EQUAL(undistorted_image2.Height(), undistorted_camera.Height());
+
+  // The image centers are mapped into the image for a small rotation.
+  BitmapColor<uint8_t> color;
+  BOOST_CHECK(undistorted_image1.GetPixel(undistorted_image1.Width() / 2,
+                                          undistorted_image1.Height() / 2,
+                                          &color));
+  BOOST_CHECK_EQUAL(color.r, 255);
+  BOOST_CHECK(undistorted_image2.GetPixel(undistorted_image2.Width() / 2,
+                                          undistorted_image2.Height() / 2,
+                                          &color));
+  BOOST_CHECK_EQUAL(color.r, 255);
+}
@@ -34,74 +34,113 @@
 #include "util/math.h"
 
 namespace colmap {
+namespace {
+
+// Spread the lower 32 bits of the value to the even bits of the result.
+uint64_t SpreadBits(uint64_t value) {
+  value &= 0xFFFFFFFF;
+  value = (value | (value << 16)) & 0x0000FFFF0000FFFF;
+  value = (value | (value << 8)) & 0x00FF00FF00FF00FF;
+  value = (value | (value << 4)) & 0x0F0F0F0F0F0F0F0F;
+  value = (value | (value << 2)) & 0x3333333333333333;
+  value = (value | (value << 1)) & 0x5555555555555555;
+  return value;
+}
+
+}  // namespace
 
 VisibilityPyramid::VisibilityPyramid() : VisibilityPyramid(0, 0, 0) {}
 
 VisibilityPyramid::VisibilityPyramid(const size_t num_levels,
                                      const size_t width, const size_t height)
-    : width_(width), height_(height), score_(0), max_score_(0) {
-  pyramid_.resize(num_levels);
+    : width_(width),
+      height_(height),
+      score_(0),
+      max_score_(0),
+      num_levels_(num_levels) {
+  level_offsets_.resize(num_levels);
+  size_t num_words = 0;
   for (size_t level = 0; level < num_levels; ++level) {
     const size_t level_plus_one = level + 1;
-    const int dim = 1 << level_plus_one;
-    pyramid_[level].setZero(dim, dim);
-    max_score_ += dim * dim * dim * dim;
+    const size_t dim = static_cast<size_t>(1) << level_plus_one;
+    const size_t num_cells = dim * dim;
+    level_offsets_[level] = num_words;
+    num_words += (num_cells + 63) / 64;
+    max_score_ += num_cells * num_cells;
   }
 }
 
 void VisibilityPyramid::SetPoint(const double x, const double y) {
-  CHECK_GT(pyramid_.size(), 0);
+  CHECK_GT(num_levels_, 0);
 
-  size_t cx = 0;
-  size_t cy = 0;
-  CellForPoint(x, y, &cx, &cy);
+  if (counts_.empty()) {
+    Allocate();
+  }
 
-  for (int i = static_cast<int>(pyramid_.size() - 1); i >= 0; --i) {
-    auto& level = pyramid_[i];
+  const size_t cell_idx = CellForPoint(x, y);
+  counts_[cell_idx] += 1;
+  if (counts_[cell_idx] > 1) {
+    return;
+  }
 
-    level(cy, cx) += 1;
-    if (level(cy, cx) == 1) {
-      score_ += level.size();
+  // Populate the cells from the finest to the coarsest level until reaching
+  // a cell that was already populated, as are then all its ancestors.
+  size_t idx = cell_idx;
+  for (int level = static_cast<int>(num_levels_ - 1); level >= 0; --level) {
+    uint64_t& word = occupancy_[level_offsets_[level] + (idx >> 6)];
+    const uint64_t bit = static_cast<uint64_t>(1) << (idx & 63);
+    if (word & bit) {
+      break;
     }
-
-    cx = cx >> 1;
-    cy = cy >> 1;
+    word |= bit;
+    score_ += static_cast<size_t>(1) << (2 * (level + 1));
+    idx >>= 2;
   }
 
   CHECK_LE(score_, max_score_);
 }
 
 void VisibilityPyramid::ResetPoint(const double x, const double y) {
-  CHECK_GT(pyramid_.size(), 0);
-
-  size_t cx = 0;
-  size_t cy = 0;
-  CellForPoint(x, y, &cx, &cy);
-
-  for (int i = static_cast<int>(pyramid_.size() - 1); i >= 0; --i) {
-    auto& level = pyramid_[i];
+  CHECK_GT(num_levels_, 0);
+  CHECK(!counts_.empty());
+
+  const size_t cell_idx = CellForPoint(x, y);
+  CHECK_GT(counts_[cell_idx], 0);
+  counts_[cell_idx] -= 1;
+  if (counts_[cell_idx] > 0) {
+    return;
+  }
 
-    level(cy, cx) -= 1;
-    if (level(cy, cx) == 0) {
-      score_ -= level.size();
+  // Clear the cells from the finest to the coarsest level until reaching a
+  // cell with a populated sibling, which keeps their parent populated.
+  size_t idx = cell_idx;
+  for (int level = static_cast<int>(num_levels_ - 1); level >= 0; --level) {
+    uint64_t& word = occupancy_[level_offsets_[level] + (idx >> 6)];
+    word &= ~(static_cast<uint64_t>(1) << (idx & 63));
+    score_ -= static_cast<size_t>(1) << (2 * (level + 1));
+    if ((word >> (idx & 60)) & 0xF) {
+      break;
     }
-
-    cx = cx >> 1;
-    cy = cy >> 1;
+    idx >>= 2;
   }
+}
 
-  CHECK_LE(score_, max_score_);
+void VisibilityPyramid::Allocate() {
+  const size_t dim = static_cast<size_t>(1) << num_levels_;
+  const size_t num_cells = dim * dim;
+  counts_.resize(num_cells, 0);
+  occupancy_.resize(level_offsets_.back() + (num_cells + 63) / 64, 0);
 }
 
-void VisibilityPyramid::CellForPoint(const double x, const double y, size_t* cx,
-                                     size_t* cy) const {
+size_t VisibilityPyramid::CellForPoint(const double x, const double y) const {
   CHECK_GT(width_, 0);
   CHECK_GT(height_, 0);
-  const int max_dim = 1 << pyramid_.size();
-  *cx = Clip<size_t>(static_cast<size_t>(max_dim * x / width_), 0,
-                     static_cast<size_t>(max_dim - 1));
-  *cy = Clip<size_t>(static_cast<size_t>(max_dim * y / height_), 0,
-                     static_cast<size_t>(max_dim - 1));
+  const size_t max_dim = static_cast<size_t>(1) << num_levels_;
+  const size_t cx = Clip<size_t>(static_cast<size_t>(max_dim * x / width_), 0,
+                                 max_dim - 1);
+  const size_t cy = Clip<size_t>(static_cast<size_t>(max_dim * y / height_),
+                                 0, max_dim - 1);
+  return static_cast<size_t>(SpreadBits(cx) | (SpreadBits(cy) << 1));
 }
 
 }  // namespace colmap
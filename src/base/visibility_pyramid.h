@@ -34,9 +34,7 @@
 
 #include <vector>
 
-#include <Eigen/Core>
-
-#include "util/alignment.h"
+#include "util/types.h"
 
 namespace colmap {
 
@@ -51,6 +49,13 @@ namespace colmap {
 // populated by at least one point and the contributed score is according
 // to its resolution in the pyramid. A cell in a higher resolution level
 // contributes a higher score to the overall score.
+//
+// The cells of all levels are stored in Morton order, such that the four
+// children of a cell are consecutive. The number of points is only counted in
+// the finest level, while the occupancy of all levels is bit-packed, so that an
+// update only touches a few words and the occupancy of the parent of a cell
+// follows from its four sibling bits. The cells are only allocated when the
+// first point is set, since many pyramids never receive any points.
 class VisibilityPyramid {
  public:
   VisibilityPyramid();
@@ -68,8 +73,11 @@ class VisibilityPyramid {
   inline size_t MaxScore() const;
 
  private:
-  void CellForPoint(const double x, const double y, size_t* cx,
-                    size_t* cy) const;
+  // Allocate the cells of all levels.
+  void Allocate();
+
+  // Morton index of the cell of the point in the finest level.
+  size_t CellForPoint(const double x, const double y) const;
 
   // Range of the input points.
   size_t width_;
@@ -81,15 +89,22 @@ class VisibilityPyramid {
   // The maximum score when all cells are populated.
   size_t max_score_;
 
-  // The visibilty pyramid with multiple levels.
-  std::vector<Eigen::MatrixXi> pyramid_;
+  size_t num_levels_;
+
+  // The number of points in each cell of the finest level.
+  std::vector<uint32_t> counts_;
+
+  // The bit-packed occupancy of the cells of all levels. The cells of each
+  // level start at the word given by the offset of the level.
+  std::vector<uint64_t> occupancy_;
+  std::vector<size_t> level_offsets_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
 
-size_t VisibilityPyramid::NumLevels() const { return pyramid_.size(); }
+size_t VisibilityPyramid::NumLevels() const { return num_levels_; }
 
 size_t VisibilityPyramid::Width() const { return width_; }
 
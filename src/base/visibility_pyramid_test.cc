@@ -32,6 +32,8 @@
 #define TEST_NAME "base/visibility_pyramid"
 #include "util/testing.h"
 
+#include <Eigen/Core>
+
 #include "base/visibility_pyramid.h"
 
 using namespace colmap;
@@ -89,3 +91,50 @@ BOOST_AUTO_TEST_CASE(TestScore) {
         2 * scores.sum() + 2 * scores.tail(scores.size() - 1).sum());
   }
 }
+
+BOOST_AUTO_TEST_CASE(TestRandomUpdates) {
+  const size_t kNumLevels = 4;
+  const size_t kMaxDim = 1 << kNumLevels;
+  VisibilityPyramid pyramid(kNumLevels, kMaxDim, kMaxDim);
+
+  // Compare against the score computed from scratch with per-cell counts.
+  std::vector<int> counts(kMaxDim * kMaxDim, 0);
+  std::vector<std::pair<size_t, size_t>> points;
+  std::srand(0);
+  for (int i = 0; i < 1000; ++i) {
+    if (points.empty() || std::rand() % 3 != 0) {
+      const size_t x = std::rand() % kMaxDim;
+      const size_t y = std::rand() % kMaxDim;
+      pyramid.SetPoint(x, y);
+      counts[y * kMaxDim + x] += 1;
+      points.emplace_back(x, y);
+    } else {
+      const size_t idx = std::rand() % points.size();
+      const auto point = points[idx];
+      pyramid.ResetPoint(point.first, point.second);
+      counts[point.second * kMaxDim + point.first] -= 1;
+      points.erase(points.begin() + idx);
+    }
+
+    size_t score = 0;
+    for (size_t level = 0; level < kNumLevels; ++level) {
+      const size_t dim = 2 << level;
+      const size_t scale = kMaxDim / dim;
+      for (size_t cy = 0; cy < dim; ++cy) {
+        for (size_t cx = 0; cx < dim; ++cx) {
+          bool populated = false;
+          for (size_t y = cy * scale; y < (cy + 1) * scale; ++y) {
+            for (size_t x = cx * scale; x < (cx + 1) * scale; ++x) {
+              populated |= counts[y * kMaxDim + x] > 0;
+            }
+          }
+          if (populated) {
+            score += dim * dim;
+          }
+        }
+      }
+    }
+
+    BOOST_CHECK_EQUAL(pyramid.Score(), score);
+  }
+}
@@ -33,6 +33,7 @@
 
 #include "VLFeat/imopv.h"
 #include "util/logging.h"
+#include "util/threading.h"
 
 namespace colmap {
 namespace {
@@ -46,18 +47,19 @@ float GetPixelConstantBorder(const float* data, const int rows, const int cols,
   }
 }
 
-}  // namespace
+// Fixed-point representation of the bilinear interpolation weights in [0, 1].
+const float kWeightScale = 65535.0f;
 
-void WarpImageBetweenCameras(const Camera& source_camera,
-                             const Camera& target_camera,
-                             const Bitmap& source_image, Bitmap* target_image) {
-  CHECK_EQ(source_camera.Width(), source_image.Width());
-  CHECK_EQ(source_camera.Height(), source_image.Height());
-  CHECK_NOTNULL(target_image);
+uint16_t QuantizeWeight(const double weight) {
+  return static_cast<uint16_t>(
+      std::round(std::min(std::max(weight, 0.0), 1.0) * kWeightScale));
+}
 
-  target_image->Allocate(static_cast<int>(source_camera.Width()),
-                         static_cast<int>(source_camera.Height()),
-                         source_image.IsRGB());
+}  // namespace
+
+CameraWarpMap::CameraWarpMap(const Camera& source_camera,
+                             const Camera& target_camera) {
+  Allocate(source_camera, target_camera);
 
   // To avoid aliasing, perform the warping in the source resolution and
   // then rescale the image at the end.
@@ -67,34 +69,192 @@ void WarpImageBetweenCameras(const Camera& source_camera,
     scaled_target_camera.Rescale(source_camera.Width(), source_camera.Height());
   }
 
-  Eigen::Vector2d image_point;
-  for (int y = 0; y < target_image->Height(); ++y) {
-    image_point.y() = y + 0.5;
-    for (int x = 0; x < target_image->Width(); ++x) {
-      image_point.x() = x + 0.5;
+  std::vector<Eigen::Vector2d> image_points(source_width_);
+  for (int y = 0; y < source_height_; ++y) {
+    // Camera models assume that the upper left pixel center is (0.5, 0.5).
+    for (int x = 0; x < source_width_; ++x) {
+      image_points[x] = Eigen::Vector2d(x + 0.5, y + 0.5);
+    }
 
-      // Camera models assume that the upper left pixel center is (0.5, 0.5).
-      const Eigen::Vector2d world_point =
-          scaled_target_camera.ImageToWorld(image_point);
-      const Eigen::Vector2d source_point =
-          source_camera.WorldToImage(world_point);
+    // Transform the entire row at once to use the batched camera kernels.
+    SetRow(y, source_camera.WorldToImage(
+                  scaled_target_camera.ImageToWorld(image_points)));
+  }
+}
 
-      BitmapColor<float> color;
-      if (source_image.InterpolateBilinear(source_point.x() - 0.5,
-                                           source_point.y() - 0.5, &color)) {
-        target_image->SetPixel(x, y, color.Cast<uint8_t>());
-      } else {
-        target_image->SetPixel(x, y, BitmapColor<uint8_t>(0));
-      }
+CameraWarpMap::CameraWarpMap(const Eigen::Matrix3d& H,
+                             const Camera& source_camera,
+                             const Camera& target_camera) {
+  Allocate(source_camera, target_camera);
+
+  std::vector<Eigen::Vector2d> image_points(source_width_);
+  for (int y = 0; y < source_height_; ++y) {
+    // Camera models assume that the upper left pixel center is (0.5, 0.5).
+    for (int x = 0; x < source_width_; ++x) {
+      image_points[x] =
+          (H * Eigen::Vector3d(x + 0.5, y + 0.5, 1)).hnormalized();
     }
+
+    SetRow(y, source_camera.WorldToImage(
+                  target_camera.ImageToWorld(image_points)));
   }
+}
 
-  if (target_camera.Width() != source_camera.Width() ||
-      target_camera.Height() != source_camera.Height()) {
-    target_image->Rescale(target_camera.Width(), target_camera.Height());
+void CameraWarpMap::Allocate(const Camera& source_camera,
+                             const Camera& target_camera) {
+  source_width_ = static_cast<int>(source_camera.Width());
+  source_height_ = static_cast<int>(source_camera.Height());
+  target_width_ = static_cast<int>(target_camera.Width());
+  target_height_ = static_cast<int>(target_camera.Height());
+
+  const size_t num_pixels =
+      static_cast<size_t>(source_width_) * static_cast<size_t>(source_height_);
+  source_cols_.resize(num_pixels);
+  source_rows_.resize(num_pixels);
+  col_weights_.resize(num_pixels);
+  row_weights_.resize(num_pixels);
+}
+
+void CameraWarpMap::SetRow(const int y,
+                           const std::vector<Eigen::Vector2d>& source_points) {
+  CHECK_EQ(source_points.size(), source_width_);
+  for (int x = 0; x < source_width_; ++x) {
+    const size_t idx = static_cast<size_t>(y) * source_width_ + x;
+
+    // Same conventions as in `Bitmap::InterpolateBilinear`, whose bottom-up
+    // row indices are converted to top-down row indices here.
+    const double source_x = source_points[x].x() - 0.5;
+    const double inv_source_y =
+        source_height_ - 1 - (source_points[x].y() - 0.5);
+    const double col = std::floor(source_x);
+    const double inv_row = std::floor(inv_source_y);
+    if (col < 0 || col + 1 >= source_width_ || inv_row < 0 ||
+        inv_row + 1 >= source_height_) {
+      source_cols_[idx] = -1;
+      source_rows_[idx] = -1;
+      col_weights_[idx] = 0;
+      row_weights_[idx] = 0;
+      continue;
+    }
+
+    source_cols_[idx] = static_cast<int>(col);
+    source_rows_[idx] = source_height_ - 2 - static_cast<int>(inv_row);
+    col_weights_[idx] = QuantizeWeight(source_x - col);
+    row_weights_[idx] = QuantizeWeight(inv_source_y - inv_row);
   }
 }
 
+int CameraWarpMap::SourceWidth() const { return source_width_; }
+
+int CameraWarpMap::SourceHeight() const { return source_height_; }
+
+int CameraWarpMap::TargetWidth() const { return target_width_; }
+
+int CameraWarpMap::TargetHeight() const { return target_height_; }
+
+size_t CameraWarpMap::NumBytes() const {
+  return source_cols_.size() * sizeof(int) +
+         source_rows_.size() * sizeof(int) +
+         col_weights_.size() * sizeof(uint16_t) +
+         row_weights_.size() * sizeof(uint16_t);
+}
+
+void CameraWarpMap::Warp(const Bitmap& source_image, Bitmap* target_image,
+                         const int num_threads) const {
+  CHECK_EQ(source_width_, source_image.Width());
+  CHECK_EQ(source_height_, source_image.Height());
+  CHECK_NOTNULL(target_image);
+
+  target_image->Allocate(source_width_, source_height_, source_image.IsRGB());
+
+  std::vector<const uint8_t*> source_lines(source_height_);
+  for (int y = 0; y < source_height_; ++y) {
+    source_lines[y] = source_image.GetScanline(y);
+  }
+
+  const int num_eff_threads =
+      std::min(GetEffectiveNumThreads(num_threads), source_height_);
+  if (num_eff_threads <= 1) {
+    WarpRows(source_lines, 0, source_height_, target_image);
+  } else {
+    ThreadPool thread_pool(num_eff_threads);
+    const int chunk_size =
+        (source_height_ + num_eff_threads - 1) / num_eff_threads;
+    for (int begin_row = 0; begin_row < source_height_;
+         begin_row += chunk_size) {
+      const int end_row = std::min(begin_row + chunk_size, source_height_);
+      thread_pool.AddTask([&, begin_row, end_row]() {
+        WarpRows(source_lines, begin_row, end_row, target_image);
+      });
+    }
+    thread_pool.Wait();
+  }
+
+  if (target_width_ != source_width_ || target_height_ != source_height_) {
+    target_image->Rescale(target_width_, target_height_);
+  }
+}
+
+void CameraWarpMap::WarpRows(const std::vector<const uint8_t*>& source_lines,
+                             const int begin_row, const int end_row,
+                             Bitmap* target_image) const {
+  const bool is_rgb = target_image->IsRGB();
+  for (int y = begin_row; y < end_row; ++y) {
+    uint8_t* target_line = target_image->GetScanline(y);
+    const size_t row_offset = static_cast<size_t>(y) * source_width_;
+    const int* cols = &source_cols_[row_offset];
+    const int* rows = &source_rows_[row_offset];
+    const uint16_t* col_weights = &col_weights_[row_offset];
+    const uint16_t* row_weights = &row_weights_[row_offset];
+
+    if (is_rgb) {
+      for (int x = 0; x < source_width_; ++x) {
+        uint8_t* target_pixel = &target_line[3 * x];
+        if (cols[x] < 0) {
+          target_pixel[0] = 0;
+          target_pixel[1] = 0;
+          target_pixel[2] = 0;
+          continue;
+        }
+        const float wx = col_weights[x] / kWeightScale;
+        const float wy = row_weights[x] / kWeightScale;
+        const uint8_t* p00 = &source_lines[rows[x]][3 * cols[x]];
+        const uint8_t* p10 = &source_lines[rows[x] + 1][3 * cols[x]];
+        for (int c = 0; c < 3; ++c) {
+          const float v0 = (1 - wx) * p00[c] + wx * p00[c + 3];
+          const float v1 = (1 - wx) * p10[c] + wx * p10[c + 3];
+          target_pixel[c] =
+              static_cast<uint8_t>(wy * v0 + (1 - wy) * v1 + 0.5f);
+        }
+      }
+    } else {
+      for (int x = 0; x < source_width_; ++x) {
+        if (cols[x] < 0) {
+          target_line[x] = 0;
+          continue;
+        }
+        const float wx = col_weights[x] / kWeightScale;
+        const float wy = row_weights[x] / kWeightScale;
+        const uint8_t* p00 = &source_lines[rows[x]][cols[x]];
+        const uint8_t* p10 = &source_lines[rows[x] + 1][cols[x]];
+        const float v0 = (1 - wx) * p00[0] + wx * p00[1];
+        const float v1 = (1 - wx) * p10[0] + wx * p10[1];
+        target_line[x] = static_cast<uint8_t>(wy * v0 + (1 - wy) * v1 + 0.5f);
+      }
+    }
+  }
+}
+
+void WarpImageBetweenCameras(const Camera& source_camera,
+                             const Camera& target_camera,
+                             const Bitmap& source_image, Bitmap* target_image) {
+  CHECK_EQ(source_camera.Width(), source_image.Width());
+  CHECK_EQ(source_camera.Height(), source_image.Height());
+  CHECK_NOTNULL(target_image);
+
+  CameraWarpMap(source_camera, target_camera).Warp(source_image, target_image);
+}
+
 void WarpImageWithHomography(const Eigen::Matrix3d& H,
                              const Bitmap& source_image, Bitmap* target_image) {
   CHECK_NOTNULL(target_image);
@@ -130,45 +290,8 @@ void WarpImageWithHomographyBetweenCameras(const Eigen::Matrix3d& H,
   CHECK_EQ(source_camera.Height(), source_image.Height());
   CHECK_NOTNULL(target_image);
 
-  target_image->Allocate(static_cast<int>(source_camera.Width()),
-                         static_cast<int>(source_camera.Height()),
-                         source_image.IsRGB());
-
-  // To avoid aliasing, perform the warping in the source resolution and
-  // then rescale the image at the end.
-  Camera scaled_target_camera = target_camera;
-  if (target_camera.Width() != source_camera.Width() ||
-      target_camera.Height() != source_camera.Height()) {
-    scaled_target_camera.Rescale(source_camera.Width(), source_camera.Height());
-  }
-
-  Eigen::Vector3d image_point(0, 0, 1);
-  for (int y = 0; y < target_image->Height(); ++y) {
-    image_point.y() = y + 0.5;
-    for (int x = 0; x < target_image->Width(); ++x) {
-      image_point.x() = x + 0.5;
-
-      // Camera models assume that the upper left pixel center is (0.5, 0.5).
-      const Eigen::Vector3d warped_point = H * image_point;
-      const Eigen::Vector2d world_point =
-          target_camera.ImageToWorld(warped_point.hnormalized());
-      const Eigen::Vector2d source_point =
-          source_camera.WorldToImage(world_point);
-
-      BitmapColor<float> color;
-      if (source_image.InterpolateBilinear(source_point.x() - 0.5,
-                                           source_point.y() - 0.5, &color)) {
-        target_image->SetPixel(x, y, color.Cast<uint8_t>());
-      } else {
-        target_image->SetPixel(x, y, BitmapColor<uint8_t>(0));
-      }
-    }
-  }
-
-  if (target_camera.Width() != source_camera.Width() ||
-      target_camera.Height() != source_camera.Height()) {
-    target_image->Rescale(target_camera.Width(), target_camera.Height());
-  }
+  CameraWarpMap(H, source_camera, target_camera)
+      .Warp(source_image, target_image);
 }
 
 void ResampleImageBilinear(const float* data, const int rows, const int cols,
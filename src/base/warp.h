@@ -32,12 +32,67 @@
 #ifndef COLMAP_SRC_BASE_WARP_H_
 #define COLMAP_SRC_BASE_WARP_H_
 
+#include <vector>
+
 #include "base/camera.h"
 #include "util/alignment.h"
 #include "util/bitmap.h"
 
 namespace colmap {
 
+// Precomputed inverse mapping from the pixels of a target camera to the
+// bilinear interpolation positions in a source camera. The mapping only
+// depends on the two cameras, so it can be computed once and then reused to
+// warp all images of the same camera without evaluating the camera models.
+class CameraWarpMap {
+ public:
+  CameraWarpMap(const Camera& source_camera, const Camera& target_camera);
+
+  // Mapping of `WarpImageWithHomographyBetweenCameras`, where the homography
+  // is first applied to the pixels of the target image.
+  CameraWarpMap(const Eigen::Matrix3d& H, const Camera& source_camera,
+                const Camera& target_camera);
+
+  // Dimensions of the source and target images.
+  int SourceWidth() const;
+  int SourceHeight() const;
+  int TargetWidth() const;
+  int TargetHeight() const;
+
+  // Number of bytes required to store the map.
+  size_t NumBytes() const;
+
+  // Warp the source image to the target image, equivalent to
+  // `WarpImageBetweenCameras`. The rows of the image are processed in
+  // parallel if `num_threads` is not 1. The function allocates the target
+  // image.
+  void Warp(const Bitmap& source_image, Bitmap* target_image,
+            const int num_threads = 1) const;
+
+ private:
+  void Allocate(const Camera& source_camera, const Camera& target_camera);
+  void SetRow(const int y, const std::vector<Eigen::Vector2d>& source_points);
+
+  void WarpRows(const std::vector<const uint8_t*>& source_lines,
+                const int begin_row, const int end_row,
+                Bitmap* target_image) const;
+
+  int source_width_;
+  int source_height_;
+  int target_width_;
+  int target_height_;
+
+  // For each pixel of the map in row-major order, the column and top row of
+  // the upper left source pixel and the fixed-point weights of the right
+  // column and the top row. A negative column denotes a pixel outside of the
+  // source image. To avoid aliasing, the map has the resolution of the source
+  // image and the warped image is rescaled to the target resolution at the end.
+  std::vector<int> source_cols_;
+  std::vector<int> source_rows_;
+  std::vector<uint16_t> col_weights_;
+  std::vector<uint16_t> row_weights_;
+};
+
 // Warp source image to target image by projecting the pixels of the target
 // image up to infinity and projecting it down into the source image
 // (i.e. an inverse mapping). The function allocates the target image.
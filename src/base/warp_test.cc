@@ -106,6 +106,104 @@ BOOST_AUTO_TEST_CASE(TestIdenticalCameras) {
   CheckBitmapsEqual(source_image_rgb, target_image_rgb);
 }
 
+BOOST_AUTO_TEST_CASE(TestCameraWarpMap) {
+  Camera source_camera;
+  source_camera.InitializeWithName("SIMPLE_RADIAL", 100, 100, 80);
+  source_camera.SetParams({100, 50, 40, 0.1});
+  Camera target_camera;
+  target_camera.InitializeWithName("PINHOLE", 90, 100, 80);
+
+  const CameraWarpMap warp_map(source_camera, target_camera);
+  BOOST_CHECK_EQUAL(warp_map.SourceWidth(), 100);
+  BOOST_CHECK_EQUAL(warp_map.SourceHeight(), 80);
+  BOOST_CHECK_EQUAL(warp_map.TargetWidth(), 100);
+  BOOST_CHECK_EQUAL(warp_map.TargetHeight(), 80);
+  BOOST_CHECK_GT(warp_map.NumBytes(), 0);
+
+  for (const bool as_rgb : {false, true}) {
+    Bitmap source_image;
+    GenerateRandomBitmap(100, 80, as_rgb, &source_image);
+
+    Bitmap target_image;
+    warp_map.Warp(source_image, &target_image);
+    BOOST_CHECK_EQUAL(target_image.Width(), 100);
+    BOOST_CHECK_EQUAL(target_image.Height(), 80);
+
+    // Compare against the per-pixel evaluation of the camera models.
+    for (int y = 0; y < target_image.Height(); ++y) {
+      for (int x = 0; x < target_image.Width(); ++x) {
+        const Eigen::Vector2d source_point = source_camera.WorldToImage(
+            target_camera.ImageToWorld(Eigen::Vector2d(x + 0.5, y + 0.5)));
+        BitmapColor<float> expected_color;
+        if (!source_image.InterpolateBilinear(source_point.x() - 0.5,
+                                              source_point.y() - 0.5,
+                                              &expected_color)) {
+          expected_color = BitmapColor<float>(0, 0, 0);
+        }
+        BitmapColor<uint8_t> color;
+        BOOST_CHECK(target_image.GetPixel(x, y, &color));
+        BOOST_CHECK_LE(std::abs(color.r - expected_color.r), 1);
+        if (as_rgb) {
+          BOOST_CHECK_LE(std::abs(color.g - expected_color.g), 1);
+          BOOST_CHECK_LE(std::abs(color.b - expected_color.b), 1);
+        }
+      }
+    }
+
+    Bitmap parallel_target_image;
+    warp_map.Warp(source_image, &parallel_target_image, 4);
+    CheckBitmapsEqual(target_image, parallel_target_image);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestCameraWarpMapWithHomography) {
+  Camera source_camera;
+  source_camera.InitializeWithName("SIMPLE_RADIAL", 100, 100, 80);
+  source_camera.SetParams({100, 50, 40, 0.1});
+  Camera target_camera;
+  target_camera.InitializeWithName("PINHOLE", 90, 100, 80);
+
+  Eigen::Matrix3d H;
+  H << 1, 0.05, -2, -0.02, 1, 3, 0, 0, 1;
+
+  const CameraWarpMap warp_map(H, source_camera, target_camera);
+  BOOST_CHECK_EQUAL(warp_map.SourceWidth(), 100);
+  BOOST_CHECK_EQUAL(warp_map.SourceHeight(), 80);
+  BOOST_CHECK_EQUAL(warp_map.TargetWidth(), 100);
+  BOOST_CHECK_EQUAL(warp_map.TargetHeight(), 80);
+
+  for (const bool as_rgb : {false, true}) {
+    Bitmap source_image;
+    GenerateRandomBitmap(100, 80, as_rgb, &source_image);
+
+    Bitmap target_image;
+    warp_map.Warp(source_image, &target_image);
+
+    // Compare against the per-pixel evaluation of the camera models.
+    for (int y = 0; y < target_image.Height(); ++y) {
+      for (int x = 0; x < target_image.Width(); ++x) {
+        const Eigen::Vector2d warped_point =
+            (H * Eigen::Vector3d(x + 0.5, y + 0.5, 1)).hnormalized();
+        const Eigen::Vector2d source_point = source_camera.WorldToImage(
+            target_camera.ImageToWorld(warped_point));
+        BitmapColor<float> expected_color;
+        if (!source_image.InterpolateBilinear(source_point.x() - 0.5,
+                                              source_point.y() - 0.5,
+                                              &expected_color)) {
+          expected_color = BitmapColor<float>(0, 0, 0);
+        }
+        BitmapColor<uint8_t> color;
+        BOOST_CHECK(target_image.GetPixel(x, y, &color));
+        BOOST_CHECK_LE(std::abs(color.r - expected_color.r), 1);
+        if (as_rgb) {
+          BOOST_CHECK_LE(std::abs(color.g - expected_color.g), 1);
+          BOOST_CHECK_LE(std::abs(color.b - expected_color.b), 1);
+        }
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestShiftedCameras) {
   Camera source_camera;
   source_camera.InitializeWithName("PINHOLE", 1, 100, 100);
@@ -31,6 +31,9 @@
 
 #include "controllers/automatic_reconstruction.h"
 
+#include <chrono>
+#include <thread>
+
 #include "base/undistortion.h"
 #include "controllers/incremental_mapper.h"
 #include "feature/extraction.h"
@@ -38,6 +41,7 @@
 #include "mvs/fusion.h"
 #include "mvs/meshing.h"
 #include "mvs/patch_match.h"
+#include "util/gpu_scheduler.h"
 #include "util/misc.h"
 #include "util/option_manager.h"
 
@@ -47,7 +51,8 @@ AutomaticReconstructionController::AutomaticReconstructionController(
     const Options& options, ReconstructionManager* reconstruction_manager)
     : options_(options),
       reconstruction_manager_(reconstruction_manager),
-      active_thread_(nullptr) {
+      active_thread_(nullptr),
+      active_pipeline_thread_(nullptr) {
   CHECK(ExistsDir(options_.workspace_path));
   CHECK(ExistsDir(options_.image_path));
   CHECK_NOTNULL(reconstruction_manager_);
@@ -84,6 +89,7 @@ AutomaticReconstructionController::AutomaticReconstructionController(
   option_manager_.sift_matching->num_threads = options_.num_threads;
   option_manager_.mapper->num_threads = options_.num_threads;
   option_manager_.poisson_meshing->num_threads = options_.num_threads;
+  option_manager_.mesh_simplification->num_threads = options_.num_threads;
 
   ImageReaderOptions reader_options = *option_manager_.image_reader;
   reader_options.database_path = *option_manager_.database_path;
@@ -132,6 +138,9 @@ void AutomaticReconstructionController::Stop() {
   if (active_thread_ != nullptr) {
     active_thread_->Stop();
   }
+  if (active_pipeline_thread_ != nullptr) {
+    active_pipeline_thread_->Stop();
+  }
   Thread::Stop();
 }
 
@@ -140,13 +149,17 @@ void AutomaticReconstructionController::Run() {
     return;
   }
 
-  RunFeatureExtraction();
+  if (options_.pipelined && options_.data_type == DataType::VIDEO) {
+    RunPipelinedFeatureExtractionAndMatching();
+  } else {
+    RunFeatureExtraction();
 
-  if (IsStopped()) {
-    return;
-  }
+    if (IsStopped()) {
+      return;
+    }
 
-  RunFeatureMatching();
+    RunFeatureMatching();
+  }
 
   if (IsStopped()) {
     return;
@@ -163,6 +176,8 @@ void AutomaticReconstructionController::Run() {
   if (options_.dense) {
     RunDenseMapper();
   }
+
+  GpuScheduler::Get().PrintStats();
 }
 
 void AutomaticReconstructionController::RunFeatureExtraction() {
@@ -199,6 +214,62 @@ void AutomaticReconstructionController::RunFeatureMatching() {
   active_thread_ = nullptr;
 }
 
+void AutomaticReconstructionController::
+    RunPipelinedFeatureExtractionAndMatching() {
+  CHECK(feature_extractor_);
+  CHECK(sequential_matcher_);
+
+  active_thread_ = feature_extractor_.get();
+  feature_extractor_->Start();
+
+  // Match the images extracted so far in rounds, where each round only
+  // matches the image pairs that are not yet in the database. Loop detection
+  // is deferred to the final round, since it queries all images.
+  SequentialMatchingOptions round_options =
+      *option_manager_.sequential_matching;
+  round_options.loop_detection = false;
+  const size_t min_num_new_images =
+      static_cast<size_t>(std::max(round_options.overlap, 1));
+
+  const std::chrono::seconds kPollInterval(1);
+  Database database(*option_manager_.database_path);
+  size_t num_matched_images = 0;
+  while (!feature_extractor_->IsFinished() && !IsStopped()) {
+    std::this_thread::sleep_for(kPollInterval);
+
+    const size_t num_images = database.NumImages();
+    if (num_images < num_matched_images + min_num_new_images) {
+      continue;
+    }
+
+    SequentialFeatureMatcher matcher(round_options,
+                                     *option_manager_.sift_matching,
+                                     *option_manager_.database_path);
+    active_pipeline_thread_ = &matcher;
+    matcher.Start();
+    matcher.Wait();
+    active_pipeline_thread_ = nullptr;
+
+    num_matched_images = num_images;
+  }
+
+  feature_extractor_->Wait();
+  feature_extractor_.reset();
+  active_thread_ = nullptr;
+
+  if (IsStopped()) {
+    return;
+  }
+
+  active_thread_ = sequential_matcher_.get();
+  sequential_matcher_->Start();
+  sequential_matcher_->Wait();
+  exhaustive_matcher_.reset();
+  sequential_matcher_.reset();
+  vocab_tree_matcher_.reset();
+  active_thread_ = nullptr;
+}
+
 void AutomaticReconstructionController::RunSparseMapper() {
   const auto sparse_path = JoinPaths(options_.workspace_path, "sparse");
   if (ExistsDir(sparse_path)) {
@@ -219,6 +290,46 @@ void AutomaticReconstructionController::RunSparseMapper() {
   IncrementalMapperController mapper(
       option_manager_.mapper.get(), *option_manager_.image_path,
       *option_manager_.database_path, reconstruction_manager_);
+
+  // In pipelined mode, each finished model is densely reconstructed while
+  // the mapper continues with the next model. Finished models are no longer
+  // modified by the mapper and their objects have stable addresses.
+  JobQueue<std::pair<size_t, const Reconstruction*>> dense_queue;
+  std::thread dense_thread;
+  size_t num_finished_models = 0;
+#ifdef CUDA_ENABLED
+  const bool pipeline_dense = options_.pipelined && options_.dense;
+#else
+  const bool pipeline_dense = false;
+#endif
+  if (pipeline_dense) {
+    CreateDirIfNotExists(JoinPaths(options_.workspace_path, "dense"));
+    dense_thread = std::thread([&]() {
+      while (true) {
+        auto job = dense_queue.Pop();
+        if (!job.IsValid() || IsStopped() ||
+            !RunDenseMapper(job.Data().first, *job.Data().second,
+                            &active_pipeline_thread_)) {
+          break;
+        }
+      }
+    });
+
+    // Discarded models are deleted before the callback, so that a new model
+    // exists only if the last one was kept.
+    mapper.AddCallback(IncrementalMapperController::LAST_IMAGE_REG_CALLBACK,
+                       [&]() {
+                         if (reconstruction_manager_->Size() >
+                             num_finished_models) {
+                           dense_queue.Push(std::make_pair(
+                               num_finished_models,
+                               &reconstruction_manager_->Get(
+                                   num_finished_models)));
+                           num_finished_models += 1;
+                         }
+                       });
+  }
+
   active_thread_ = &mapper;
   mapper.Start();
   mapper.Wait();
@@ -226,6 +337,12 @@ void AutomaticReconstructionController::RunSparseMapper() {
 
   CreateDirIfNotExists(sparse_path);
   reconstruction_manager_->Write(sparse_path, &option_manager_);
+
+  if (pipeline_dense) {
+    dense_queue.Wait();
+    dense_queue.Stop();
+    dense_thread.join();
+  }
 }
 
 void AutomaticReconstructionController::RunDenseMapper() {
@@ -239,107 +356,119 @@ void AutomaticReconstructionController::RunDenseMapper() {
 
   CreateDirIfNotExists(JoinPaths(options_.workspace_path, "dense"));
 
+  // Models that were already densely reconstructed in pipelined mode are
+  // skipped, since their outputs exist.
   for (size_t i = 0; i < reconstruction_manager_->Size(); ++i) {
     if (IsStopped()) {
       return;
     }
 
-    const std::string dense_path =
-        JoinPaths(options_.workspace_path, "dense", std::to_string(i));
-    const std::string fused_path = JoinPaths(dense_path, "fused.ply");
-
-    std::string meshing_path;
-    if (options_.mesher == Mesher::POISSON) {
-      meshing_path = JoinPaths(dense_path, "meshed-poisson.ply");
-    } else if (options_.mesher == Mesher::DELAUNAY) {
-      meshing_path = JoinPaths(dense_path, "meshed-delaunay.ply");
+    if (!RunDenseMapper(i, reconstruction_manager_->Get(i), &active_thread_)) {
+      return;
     }
+  }
+}
 
-    if (ExistsFile(fused_path) && ExistsFile(meshing_path)) {
-      continue;
-    }
+bool AutomaticReconstructionController::RunDenseMapper(
+    const size_t reconstruction_idx, const Reconstruction& reconstruction,
+    Thread** active_thread) {
+  const std::string dense_path = JoinPaths(
+      options_.workspace_path, "dense", std::to_string(reconstruction_idx));
+  const std::string fused_path = JoinPaths(dense_path, "fused.ply");
+
+  std::string meshing_path;
+  if (options_.mesher == Mesher::POISSON) {
+    meshing_path = JoinPaths(dense_path, "meshed-poisson.ply");
+  } else if (options_.mesher == Mesher::DELAUNAY) {
+    meshing_path = JoinPaths(dense_path, "meshed-delaunay.ply");
+  }
 
-    // Image undistortion.
-
-    if (!ExistsDir(dense_path)) {
-      CreateDirIfNotExists(dense_path);
-
-      UndistortCameraOptions undistortion_options;
-      undistortion_options.max_image_size =
-          option_manager_.patch_match_stereo->max_image_size;
-      COLMAPUndistorter undistorter(undistortion_options,
-                                    reconstruction_manager_->Get(i),
-                                    *option_manager_.image_path, dense_path);
-      active_thread_ = &undistorter;
-      undistorter.Start();
-      undistorter.Wait();
-      active_thread_ = nullptr;
-    }
+  if (ExistsFile(fused_path) && ExistsFile(meshing_path)) {
+    return true;
+  }
 
-    if (IsStopped()) {
-      return;
-    }
+  // Image undistortion.
 
-    // Patch match stereo.
+  if (!ExistsDir(dense_path)) {
+    CreateDirIfNotExists(dense_path);
 
-    {
-      mvs::PatchMatchController patch_match_controller(
-          *option_manager_.patch_match_stereo, dense_path, "COLMAP", "");
-      active_thread_ = &patch_match_controller;
-      patch_match_controller.Start();
-      patch_match_controller.Wait();
-      active_thread_ = nullptr;
-    }
+    UndistortCameraOptions undistortion_options;
+    undistortion_options.max_image_size =
+        option_manager_.patch_match_stereo->max_image_size;
+    COLMAPUndistorter undistorter(undistortion_options, reconstruction,
+                                  *option_manager_.image_path, dense_path);
+    *active_thread = &undistorter;
+    undistorter.Start();
+    undistorter.Wait();
+    *active_thread = nullptr;
+  }
 
-    if (IsStopped()) {
-      return;
-    }
+  if (IsStopped()) {
+    return false;
+  }
 
-    // Stereo fusion.
-
-    if (!ExistsFile(fused_path)) {
-      auto fusion_options = *option_manager_.stereo_fusion;
-      const int num_reg_images = reconstruction_manager_->Get(i).NumRegImages();
-      fusion_options.min_num_pixels =
-          std::min(num_reg_images + 1, fusion_options.min_num_pixels);
-      mvs::StereoFusion fuser(
-          fusion_options, dense_path, "COLMAP", "",
-          options_.quality == Quality::HIGH ? "geometric" : "photometric");
-      active_thread_ = &fuser;
-      fuser.Start();
-      fuser.Wait();
-      active_thread_ = nullptr;
-
-      std::cout << "Writing output: " << fused_path << std::endl;
-      WriteBinaryPlyPoints(fused_path, fuser.GetFusedPoints());
-      mvs::WritePointsVisibility(fused_path + ".vis",
-                                 fuser.GetFusedPointsVisibility());
-    }
+  // Patch match stereo.
 
-    if (IsStopped()) {
-      return;
-    }
+  {
+    mvs::PatchMatchController patch_match_controller(
+        *option_manager_.patch_match_stereo, dense_path, "COLMAP", "");
+    *active_thread = &patch_match_controller;
+    patch_match_controller.Start();
+    patch_match_controller.Wait();
+    *active_thread = nullptr;
+  }
 
-    // Surface meshing.
+  if (IsStopped()) {
+    return false;
+  }
+
+  // Stereo fusion.
+
+  if (!ExistsFile(fused_path)) {
+    auto fusion_options = *option_manager_.stereo_fusion;
+    const int num_reg_images = reconstruction.NumRegImages();
+    fusion_options.min_num_pixels =
+        std::min(num_reg_images + 1, fusion_options.min_num_pixels);
+    mvs::StereoFusion fuser(
+        fusion_options, dense_path, "COLMAP", "",
+        options_.quality == Quality::HIGH ? "geometric" : "photometric");
+    *active_thread = &fuser;
+    fuser.Start();
+    fuser.Wait();
+    *active_thread = nullptr;
+
+    std::cout << "Writing output: " << fused_path << std::endl;
+    WriteBinaryPlyPoints(fused_path, fuser.GetFusedPoints());
+    mvs::WritePointsVisibility(fused_path + ".vis",
+                               fuser.GetFusedPointsVisibility());
+  }
 
-    if (!ExistsFile(meshing_path)) {
-      if (options_.mesher == Mesher::POISSON) {
-        mvs::PoissonMeshing(*option_manager_.poisson_meshing, fused_path,
-                            meshing_path);
-      } else if (options_.mesher == Mesher::DELAUNAY) {
+  if (IsStopped()) {
+    return false;
+  }
+
+  // Surface meshing.
+
+  if (!ExistsFile(meshing_path)) {
+    if (options_.mesher == Mesher::POISSON) {
+      mvs::PoissonMeshing(*option_manager_.poisson_meshing, fused_path,
+                          meshing_path, *option_manager_.mesh_simplification);
+    } else if (options_.mesher == Mesher::DELAUNAY) {
 #ifdef CGAL_ENABLED
-        mvs::DenseDelaunayMeshing(*option_manager_.delaunay_meshing, dense_path,
-                                  meshing_path);
+      mvs::DenseDelaunayMeshing(*option_manager_.delaunay_meshing, dense_path,
+                                meshing_path,
+                                *option_manager_.mesh_simplification);
 #else   // CGAL_ENABLED
-        std::cout << std::endl
-                  << "WARNING: Skipping Delaunay meshing because CGAL is "
-                     "not available."
-                  << std::endl;
-        return;
+      std::cout << std::endl
+                << "WARNING: Skipping Delaunay meshing because CGAL is "
+                   "not available."
+                << std::endl;
+      return false;
 #endif  // CGAL_ENABLED
-      }
     }
   }
+
+  return true;
 }
 
 }  // namespace colmap
@@ -81,6 +81,13 @@ class AutomaticReconstructionController : public Thread {
     bool dense = false;
 #endif
 
+    // Whether to overlap the reconstruction stages to reduce the end-to-end
+    // latency. For video data, the images extracted so far are matched while
+    // the extraction continues. The dense reconstruction of each model starts
+    // as soon as the mapper has finished it, while mapping continues with the
+    // next model.
+    bool pipelined = false;
+
     // The meshing algorithm to be used.
     Mesher mesher = Mesher::POISSON;
 
@@ -105,13 +112,23 @@ class AutomaticReconstructionController : public Thread {
   void Run() override;
   void RunFeatureExtraction();
   void RunFeatureMatching();
+  void RunPipelinedFeatureExtractionAndMatching();
   void RunSparseMapper();
   void RunDenseMapper();
 
+  // Run the dense reconstruction of a single model, where the currently
+  // running stage is exposed through `active_thread` so that it can be
+  // stopped. Returns false if the remaining models should be skipped.
+  bool RunDenseMapper(const size_t reconstruction_idx,
+                      const Reconstruction& reconstruction,
+                      Thread** active_thread);
+
   const Options options_;
   OptionManager option_manager_;
   ReconstructionManager* reconstruction_manager_;
   Thread* active_thread_;
+  // The stage that runs concurrently to the active thread in pipelined mode.
+  Thread* active_pipeline_thread_;
   std::unique_ptr<Thread> feature_extractor_;
   std::unique_ptr<Thread> exhaustive_matcher_;
   std::unique_ptr<Thread> sequential_matcher_;
@@ -97,7 +97,10 @@ void BundleAdjustmentController::Run() {
 
   // Run bundle adjustment.
   BundleAdjuster bundle_adjuster(ba_options, ba_config);
-  bundle_adjuster.Solve(reconstruction_);
+  if (bundle_adjuster.Solve(reconstruction_)) {
+    PrintHeading2("Convergence trajectory");
+    PrintSolverTrajectory(bundle_adjuster.Summary());
+  }
 
   GetTimer().PrintMinutes();
 }
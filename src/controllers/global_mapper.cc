@@ -0,0 +1,218 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "controllers/global_mapper.h"
+
+#include "util/misc.h"
+
+namespace colmap {
+
+bool GlobalMapperController::Options::Check() const {
+  CHECK_OPTION_GE(num_ba_iterations, 0);
+  CHECK_OPTION(mapper.Check());
+  return true;
+}
+
+GlobalMapperController::GlobalMapperController(
+    const Options& options, const IncrementalMapperOptions& mapper_options,
+    ReconstructionManager* reconstruction_manager)
+    : options_(options),
+      mapper_options_(mapper_options),
+      reconstruction_manager_(reconstruction_manager) {
+  CHECK(options_.Check());
+  CHECK(mapper_options_.Check());
+}
+
+void GlobalMapperController::Run() {
+  //////////////////////////////////////////////////////////////////////////////
+  // Load database
+  //////////////////////////////////////////////////////////////////////////////
+
+  PrintHeading1("Loading database");
+
+  DatabaseCache database_cache;
+
+  {
+    Database database;
+    database.OpenShardedPath(options_.database_path);
+    Timer timer;
+    timer.Start();
+    const size_t min_num_matches =
+        static_cast<size_t>(mapper_options_.min_num_matches);
+    database_cache.Load(database, min_num_matches,
+                        mapper_options_.ignore_watermarks,
+                        mapper_options_.image_names,
+                        mapper_options_.correspondence_graph_path,
+                        mapper_options_.num_threads);
+    std::cout << std::endl;
+    timer.PrintMinutes();
+  }
+
+  std::cout << std::endl;
+
+  if (database_cache.NumImages() == 0) {
+    std::cout << "WARNING: No images with matches found in the database."
+              << std::endl
+              << std::endl;
+    return;
+  }
+
+  const IncrementalMapper::Options incremental_options =
+      mapper_options_.Mapper();
+  GlobalMapper::Options global_options = options_.mapper;
+  global_options.min_focal_length_ratio =
+      incremental_options.min_focal_length_ratio;
+  global_options.max_focal_length_ratio =
+      incremental_options.max_focal_length_ratio;
+  global_options.max_extra_param = incremental_options.max_extra_param;
+  global_options.filter_max_reproj_error =
+      incremental_options.filter_max_reproj_error;
+  global_options.filter_min_tri_angle =
+      incremental_options.filter_min_tri_angle;
+  global_options.num_threads = mapper_options_.num_threads;
+
+  const IncrementalTriangulator::Options tri_options =
+      mapper_options_.Triangulation();
+
+  // The initial structure is triangulated from averaged poses, which is more
+  // prone to outliers than incrementally refined poses.
+  BundleAdjustmentOptions ba_options = mapper_options_.GlobalBundleAdjustment();
+  ba_options.loss_function_type =
+      BundleAdjustmentOptions::LossFunctionType::CAUCHY;
+
+  GlobalMapper mapper(&database_cache);
+
+  const size_t reconstruction_idx = reconstruction_manager_->Add();
+  Reconstruction& reconstruction =
+      reconstruction_manager_->Get(reconstruction_idx);
+
+  mapper.BeginReconstruction(&reconstruction);
+
+  auto DiscardReconstruction = [&]() {
+    const bool kDiscardReconstruction = true;
+    mapper.EndReconstruction(kDiscardReconstruction);
+    reconstruction_manager_->Delete(reconstruction_idx);
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Motion averaging
+  //////////////////////////////////////////////////////////////////////////////
+
+  PrintHeading1("Estimating relative poses");
+
+  const size_t num_relative_poses =
+      mapper.EstimateRelativePoses(global_options);
+  std::cout << StringPrintf("  => Image pairs: %d", num_relative_poses)
+            << std::endl;
+
+  if (IsStopped()) {
+    DiscardReconstruction();
+    return;
+  }
+
+  PrintHeading1("Rotation averaging");
+
+  const size_t num_rotations = mapper.EstimateRotations(global_options);
+  std::cout << StringPrintf("  => Images: %d", num_rotations) << std::endl;
+  std::cout << StringPrintf("  => Inlier image pairs: %d",
+                            mapper.RelativePoses().size())
+            << std::endl;
+
+  if (num_rotations < 2 || IsStopped()) {
+    DiscardReconstruction();
+    return;
+  }
+
+  PrintHeading1("Translation averaging");
+
+  const size_t num_positions = mapper.EstimatePositions(global_options);
+  std::cout << StringPrintf("  => Images: %d", num_positions) << std::endl;
+
+  if (num_positions < 2 || IsStopped()) {
+    DiscardReconstruction();
+    return;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Triangulation and refinement
+  //////////////////////////////////////////////////////////////////////////////
+
+  PrintHeading1("Triangulation");
+
+  const size_t num_reg_images = mapper.RegisterImages();
+  std::cout << StringPrintf("  => Registered images: %d", num_reg_images)
+            << std::endl;
+
+  const size_t num_tris = mapper.TriangulateImages(tri_options);
+  std::cout << StringPrintf("  => Triangulated observations: %d", num_tris)
+            << std::endl;
+
+  for (int i = 0; i < options_.num_ba_iterations; ++i) {
+    if (IsStopped()) {
+      break;
+    }
+
+    if (reconstruction.NumRegImages() < 2) {
+      DiscardReconstruction();
+      return;
+    }
+
+    PrintHeading1("Global bundle adjustment");
+
+    mapper.AdjustGlobalBundle(ba_options);
+
+    const size_t num_filtered_observations = mapper.FilterPoints(global_options);
+    const size_t num_filtered_images = mapper.FilterImages(global_options);
+    std::cout << StringPrintf("  => Filtered observations: %d",
+                              num_filtered_observations)
+              << std::endl;
+    std::cout << StringPrintf("  => Filtered images: %d", num_filtered_images)
+              << std::endl;
+
+    if (i + 1 < options_.num_ba_iterations) {
+      const size_t num_retriangulated = mapper.Retriangulate(tri_options);
+      std::cout << StringPrintf("  => Retriangulated observations: %d",
+                                num_retriangulated)
+                << std::endl;
+    }
+  }
+
+  if (mapper_options_.extract_colors) {
+    reconstruction.ExtractColorsForAllImages(options_.image_path);
+  }
+
+  const bool kDiscardReconstruction = false;
+  mapper.EndReconstruction(kDiscardReconstruction);
+
+  std::cout << std::endl;
+  GetTimer().PrintMinutes();
+}
+
+}  // namespace colmap
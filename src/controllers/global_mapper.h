@@ -0,0 +1,85 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_CONTROLLERS_GLOBAL_MAPPER_H_
+#define COLMAP_SRC_CONTROLLERS_GLOBAL_MAPPER_H_
+
+#include "base/reconstruction_manager.h"
+#include "controllers/incremental_mapper.h"
+#include "sfm/global_mapper.h"
+#include "util/threading.h"
+
+namespace colmap {
+
+// Global mapping first estimates the relative poses of all verified image
+// pairs, then estimates all image rotations and positions at once using
+// rotation and translation averaging, triangulates the scene structure in a
+// single pass, and finally refines the reconstruction with a few rounds of
+// global bundle adjustment. In contrast to incremental mapping, the number of
+// bundle adjustments is independent of the number of images, which makes it
+// suitable for large-scale scenes.
+class GlobalMapperController : public Thread {
+ public:
+  struct Options {
+    // The path to the image folder which are used as input.
+    std::string image_path;
+
+    // The path to the database file which is used as input.
+    std::string database_path;
+
+    // The number of rounds of global bundle adjustment, point filtering, and
+    // re-triangulation after the initial triangulation.
+    int num_ba_iterations = 3;
+
+    // Relative pose estimation and motion averaging options. The options for
+    // the filtering of images and points and the number of threads are taken
+    // from the incremental mapper options.
+    GlobalMapper::Options mapper;
+
+    bool Check() const;
+  };
+
+  // The database loading, triangulation, and bundle adjustment options are
+  // taken from the given incremental mapper options.
+  GlobalMapperController(const Options& options,
+                         const IncrementalMapperOptions& mapper_options,
+                         ReconstructionManager* reconstruction_manager);
+
+ private:
+  void Run() override;
+
+  const Options options_;
+  const IncrementalMapperOptions mapper_options_;
+  ReconstructionManager* reconstruction_manager_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_CONTROLLERS_GLOBAL_MAPPER_H_
@@ -31,40 +31,112 @@
 
 #include "controllers/hierarchical_mapper.h"
 
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <unordered_set>
+
 #include "base/scene_clustering.h"
+#include "base/similarity_transform.h"
 #include "util/misc.h"
+#include "util/option_manager.h"
+#include "util/timer.h"
 
 namespace colmap {
 namespace {
 
+// Merge the reconstructions of all child clusters of the given cluster. The
+// reconstructions of the child clusters must be complete. The mutex guards the
+// insertion and deletion of the reconstruction managers, so that sibling
+// clusters can be merged concurrently. The alignments of the reconstructions
+// are estimated with the given number of threads.
 void MergeClusters(
     const SceneClustering::Cluster& cluster,
     std::unordered_map<const SceneClustering::Cluster*, ReconstructionManager>*
-        reconstruction_managers) {
+        reconstruction_managers,
+    std::mutex* reconstruction_managers_mutex, const int num_threads) {
   // Extract all reconstructions from all child clusters.
   std::vector<Reconstruction*> reconstructions;
-  for (const auto& child_cluster : cluster.child_clusters) {
-    if (!child_cluster.child_clusters.empty()) {
-      MergeClusters(child_cluster, reconstruction_managers);
-    }
-
-    auto& reconstruction_manager = reconstruction_managers->at(&child_cluster);
-    for (size_t i = 0; i < reconstruction_manager.Size(); ++i) {
-      reconstructions.push_back(&reconstruction_manager.Get(i));
+  {
+    std::unique_lock<std::mutex> lock(*reconstruction_managers_mutex);
+    for (const auto& child_cluster : cluster.child_clusters) {
+      auto& reconstruction_manager =
+          reconstruction_managers->at(&child_cluster);
+      for (size_t i = 0; i < reconstruction_manager.Size(); ++i) {
+        reconstructions.push_back(&reconstruction_manager.Get(i));
+      }
     }
   }
 
-  // Try to merge all child cluster reconstruction.
+  // Try to merge all child cluster reconstruction. A pair of reconstructions
+  // that failed to merge is only retried once one of them has absorbed another
+  // reconstruction, since their alignment cannot change otherwise.
+  Timer timer;
+  timer.Start();
+
+  const size_t num_child_reconstructions = reconstructions.size();
+  size_t num_merge_attempts = 0;
+  std::set<std::pair<const Reconstruction*, const Reconstruction*>>
+      failed_pairs;
+
+  // Same thresholds as in `Reconstruction::Merge`.
+  const double kMinInlierObservations = 0.3;
+  const double kMaxReprojError = 8.0;
+
+  std::vector<size_t> candidate_idxs;
+  std::vector<const Reconstruction*> candidate_reconstructions;
+  std::vector<Eigen::Matrix3x4d> alignments;
+
   while (reconstructions.size() > 1) {
     bool merge_success = false;
     for (size_t i = 0; i < reconstructions.size(); ++i) {
+      candidate_idxs.clear();
+      candidate_reconstructions.clear();
       for (size_t j = 0; j < i; ++j) {
-        const double kMaxReprojError = 8.0;
-        if (reconstructions[i]->Merge(*reconstructions[j], kMaxReprojError)) {
+        if (failed_pairs.count(std::make_pair(reconstructions[i],
+                                              reconstructions[j])) == 0) {
+          candidate_idxs.push_back(j);
+          candidate_reconstructions.push_back(reconstructions[j]);
+        }
+      }
+
+      if (candidate_idxs.empty()) {
+        continue;
+      }
+
+      // Align all candidates to the reconstruction at once and merge the
+      // first one in the original order that could be aligned.
+      const std::vector<bool> alignment_success =
+          ComputeAlignmentsBetweenReconstructions(
+              candidate_reconstructions, *reconstructions[i],
+              kMinInlierObservations, kMaxReprojError, num_threads,
+              &alignments);
+
+      for (size_t k = 0; k < candidate_idxs.size(); ++k) {
+        const size_t j = candidate_idxs[k];
+
+        num_merge_attempts += 1;
+
+        if (alignment_success[k]) {
+          reconstructions[i]->Merge(*reconstructions[j], alignments[k],
+                                    kMaxReprojError);
+          for (auto it = failed_pairs.begin(); it != failed_pairs.end();) {
+            if (it->first == reconstructions[i] ||
+                it->second == reconstructions[i]) {
+              it = failed_pairs.erase(it);
+            } else {
+              ++it;
+            }
+          }
           reconstructions.erase(reconstructions.begin() + j);
           merge_success = true;
           break;
         }
+
+        failed_pairs.insert(
+            std::make_pair(reconstructions[i], reconstructions[j]));
       }
 
       if (merge_success) {
@@ -77,20 +149,180 @@ void MergeClusters(
     }
   }
 
-  // Insert a new reconstruction manager for merged cluster.
-  auto& reconstruction_manager = (*reconstruction_managers)[&cluster];
+  std::cout << StringPrintf(
+                   "  Merged %d into %d reconstructions with %d attempts in "
+                   "%.3fs",
+                   num_child_reconstructions, reconstructions.size(),
+                   num_merge_attempts, timer.ElapsedSeconds())
+            << std::endl;
+
+  // Create a new reconstruction manager for merged cluster.
+  ReconstructionManager merged_reconstruction_manager;
   for (const auto& reconstruction : reconstructions) {
-    reconstruction_manager.Add();
-    reconstruction_manager.Get(reconstruction_manager.Size() - 1) =
-        *reconstruction;
+    merged_reconstruction_manager.Add();
+    merged_reconstruction_manager.Get(merged_reconstruction_manager.Size() -
+                                      1) = *reconstruction;
   }
 
-  // Delete all merged child cluster reconstruction managers.
+  // Insert the merged cluster and delete all merged child clusters.
+  std::unique_lock<std::mutex> lock(*reconstruction_managers_mutex);
+  (*reconstruction_managers)[&cluster] =
+      std::move(merged_reconstruction_manager);
   for (const auto& child_cluster : cluster.child_clusters) {
     reconstruction_managers->erase(&child_cluster);
   }
 }
 
+// Split a leaf cluster into child clusters by partitioning the scene graph
+// restricted to the images of the cluster. Returns false if the cluster could
+// not be split any further.
+bool SplitLeafCluster(
+    const SceneClustering::Options& clustering_options,
+    const std::vector<std::pair<image_t, image_t>>& image_pairs,
+    const std::vector<int>& num_inliers, SceneClustering::Cluster* cluster) {
+  CHECK(cluster->child_clusters.empty());
+
+  const std::unordered_set<image_t> image_ids(cluster->image_ids.begin(),
+                                              cluster->image_ids.end());
+  std::vector<std::pair<image_t, image_t>> cluster_image_pairs;
+  std::vector<int> cluster_num_inliers;
+  for (size_t i = 0; i < image_pairs.size(); ++i) {
+    if (image_ids.count(image_pairs[i].first) &&
+        image_ids.count(image_pairs[i].second)) {
+      cluster_image_pairs.push_back(image_pairs[i]);
+      cluster_num_inliers.push_back(num_inliers[i]);
+    }
+  }
+
+  SceneClustering::Options split_options = clustering_options;
+  split_options.leaf_max_num_images =
+      std::max<int>(1, cluster->image_ids.size() / 2);
+  SceneClustering split_clustering(split_options);
+  split_clustering.Partition(cluster_image_pairs, cluster_num_inliers);
+
+  const SceneClustering::Cluster* split_root_cluster =
+      split_clustering.GetRootCluster();
+  if (split_root_cluster->child_clusters.empty()) {
+    return false;
+  }
+
+  cluster->child_clusters = split_root_cluster->child_clusters;
+
+  return true;
+}
+
+// Recursively split all leaf clusters with more than the given number of
+// images, as the scheduler would do before reconstructing them.
+void SplitOversizedLeafClusters(
+    const SceneClustering::Options& clustering_options,
+    const std::vector<std::pair<image_t, image_t>>& image_pairs,
+    const std::vector<int>& num_inliers, const double max_leaf_num_images,
+    SceneClustering::Cluster* cluster) {
+  if (cluster->child_clusters.empty()) {
+    if (cluster->image_ids.size() <= max_leaf_num_images ||
+        !SplitLeafCluster(clustering_options, image_pairs, num_inliers,
+                          cluster)) {
+      return;
+    }
+  }
+
+  for (auto& child_cluster : cluster->child_clusters) {
+    SplitOversizedLeafClusters(clustering_options, image_pairs, num_inliers,
+                               max_leaf_num_images, &child_cluster);
+  }
+}
+
+std::string GetClusterJobPath(const std::string& job_path,
+                              const int cluster_id) {
+  return JoinPaths(job_path, "cluster" + std::to_string(cluster_id));
+}
+
+// Write the cluster hierarchy to `clusters.txt` and one mapping job for each
+// leaf cluster into its own directory. The cluster identifiers are assigned in
+// depth-first pre-order and the root cluster has no parent (-1). The commands
+// to run all jobs are listed in `jobs.txt`.
+void WriteClusterJobs(
+    const HierarchicalMapperController::Options& options,
+    const IncrementalMapperOptions& mapper_options,
+    const std::unordered_map<image_t, std::string>& image_id_to_name,
+    const SceneClustering::Cluster& root_cluster) {
+  CreateDirIfNotExists(options.job_path);
+
+  std::ofstream clusters_file(JoinPaths(options.job_path, "clusters.txt"),
+                              std::ios::trunc);
+  CHECK(clusters_file.is_open());
+  clusters_file << "# Cluster hierarchy with one line per cluster:"
+                << std::endl;
+  clusters_file << "#   CLUSTER_ID, PARENT_CLUSTER_ID, NUM_IMAGES" << std::endl;
+
+  std::ofstream jobs_file(JoinPaths(options.job_path, "jobs.txt"),
+                          std::ios::trunc);
+  CHECK(jobs_file.is_open());
+
+  int num_clusters = 0;
+  int num_jobs = 0;
+
+  std::function<void(const SceneClustering::Cluster&, int)> WriteCluster =
+      [&](const SceneClustering::Cluster& cluster,
+          const int parent_cluster_id) {
+        const int cluster_id = num_clusters;
+        num_clusters += 1;
+
+        clusters_file << cluster_id << " " << parent_cluster_id << " "
+                      << cluster.image_ids.size() << std::endl;
+
+        if (!cluster.child_clusters.empty()) {
+          for (const auto& child_cluster : cluster.child_clusters) {
+            WriteCluster(child_cluster, cluster_id);
+          }
+          return;
+        }
+
+        if (cluster.image_ids.empty()) {
+          return;
+        }
+
+        const std::string cluster_path =
+            GetClusterJobPath(options.job_path, cluster_id);
+        const std::string sparse_path = JoinPaths(cluster_path, "sparse");
+        CreateDirIfNotExists(cluster_path);
+        CreateDirIfNotExists(sparse_path);
+
+        const std::string image_list_path =
+            JoinPaths(cluster_path, "image_list.txt");
+        std::ofstream image_list_file(image_list_path, std::ios::trunc);
+        CHECK(image_list_file.is_open());
+        for (const auto image_id : cluster.image_ids) {
+          image_list_file << image_id_to_name.at(image_id) << std::endl;
+        }
+
+        OptionManager cluster_options;
+        cluster_options.AddDatabaseOptions();
+        cluster_options.AddImageOptions();
+        cluster_options.AddMapperOptions();
+        *cluster_options.database_path = options.database_path;
+        *cluster_options.image_path = options.image_path;
+        *cluster_options.mapper = mapper_options;
+        cluster_options.mapper->max_model_overlap = 3;
+        cluster_options.mapper->init_num_trials = options.init_num_trials;
+
+        const std::string project_path = JoinPaths(cluster_path, "project.ini");
+        cluster_options.Write(project_path);
+
+        jobs_file << "colmap mapper --project_path " << project_path
+                  << " --image_list_path " << image_list_path
+                  << " --output_path " << sparse_path << std::endl;
+
+        num_jobs += 1;
+      };
+
+  WriteCluster(root_cluster, -1);
+
+  std::cout << StringPrintf("Wrote %d clusters with %d mapping jobs to %s",
+                            num_clusters, num_jobs, options.job_path.c_str())
+            << std::endl;
+}
+
 }  // namespace
 
 bool HierarchicalMapperController::Options::Check() const {
@@ -123,9 +355,12 @@ void HierarchicalMapperController::Run() {
   SceneClustering scene_clustering(clustering_options_);
 
   std::unordered_map<image_t, std::string> image_id_to_name;
+  std::vector<std::pair<image_t, image_t>> image_pairs;
+  std::vector<int> num_inliers;
 
   {
-    Database database(options_.database_path);
+    Database database;
+    database.OpenShardedPath(options_.database_path);
 
     std::cout << "Reading images..." << std::endl;
     const auto images = database.ReadAllImages();
@@ -134,8 +369,6 @@ void HierarchicalMapperController::Run() {
     }
 
     std::cout << "Reading scene graph..." << std::endl;
-    std::vector<std::pair<image_t, image_t>> image_pairs;
-    std::vector<int> num_inliers;
     database.ReadTwoViewGeometryNumInliers(&image_pairs, &num_inliers);
 
     std::cout << "Partitioning scene graph..." << std::endl;
@@ -155,13 +388,53 @@ void HierarchicalMapperController::Run() {
   std::cout << StringPrintf("Clusters have %d images", total_num_images)
             << std::endl;
 
+  const double max_leaf_num_images =
+      options_.max_leaf_size_ratio * total_num_images / leaf_clusters.size();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Write cluster jobs
+  //////////////////////////////////////////////////////////////////////////////
+
+  if (!options_.job_path.empty()) {
+    PrintHeading1("Writing cluster jobs");
+
+    SceneClustering::Cluster root_cluster = *scene_clustering.GetRootCluster();
+    if (options_.max_leaf_size_ratio > 0) {
+      SplitOversizedLeafClusters(clustering_options_, image_pairs, num_inliers,
+                                 max_leaf_num_images, &root_cluster);
+    }
+
+    WriteClusterJobs(options_, mapper_options_, image_id_to_name,
+                     root_cluster);
+
+    std::cout << std::endl;
+    GetTimer().PrintMinutes();
+    return;
+  }
+
   //////////////////////////////////////////////////////////////////////////////
   // Reconstruct clusters
   //////////////////////////////////////////////////////////////////////////////
 
+  PrintHeading1("Loading database");
+
+  // Load the database only once and let the workers extract the images of
+  // their clusters from the shared cache, instead of reading the overlapping
+  // images and matches of every cluster from the database again.
+  DatabaseCache database_cache;
+  {
+    Database database;
+    database.OpenShardedPath(options_.database_path);
+    database_cache.Load(
+        database, static_cast<size_t>(mapper_options_.min_num_matches),
+        mapper_options_.ignore_watermarks, {},
+        mapper_options_.correspondence_graph_path, mapper_options_.num_threads);
+  }
+
   PrintHeading1("Reconstructing clusters");
 
-  // Determine the number of workers and threads per worker.
+  // Determine the number of workers and the total number of threads, which
+  // are distributed among the currently reconstructed clusters.
   const int kMaxNumThreads = -1;
   const int num_eff_threads = GetEffectiveNumThreads(kMaxNumThreads);
   const int kDefaultNumWorkers = 8;
@@ -170,60 +443,176 @@ void HierarchicalMapperController::Run() {
           ? std::min(static_cast<int>(leaf_clusters.size()),
                      std::min(kDefaultNumWorkers, num_eff_threads))
           : options_.num_workers;
-  const int num_threads_per_worker =
-      std::max(1, num_eff_threads / num_eff_workers);
+
+  // Copy the cluster hierarchy, such that oversized leaf clusters can be
+  // split further while scheduling the reconstruction of the clusters.
+  SceneClustering::Cluster root_cluster = *scene_clustering.GetRootCluster();
+
+  // The scheduler state, which is only accessed by this thread. A cluster is
+  // finished once its reconstruction or the merging of its child clusters is
+  // complete, and the merging of a cluster starts as soon as all its child
+  // clusters are finished.
+  std::vector<SceneClustering::Cluster*> pending_clusters;
+  std::unordered_map<const SceneClustering::Cluster*,
+                     const SceneClustering::Cluster*>
+      parent_clusters;
+  std::unordered_map<const SceneClustering::Cluster*, size_t>
+      num_unfinished_child_clusters;
+  std::unordered_map<const SceneClustering::Cluster*,
+                     std::unique_ptr<IncrementalMapperOptions>>
+      reconstructing_clusters;
+  size_t num_merging_clusters = 0;
+
+  std::function<void(SceneClustering::Cluster*)> RegisterCluster =
+      [&](SceneClustering::Cluster* cluster) {
+        if (cluster->child_clusters.empty()) {
+          pending_clusters.push_back(cluster);
+          return;
+        }
+        num_unfinished_child_clusters[cluster] = cluster->child_clusters.size();
+        for (auto& child_cluster : cluster->child_clusters) {
+          parent_clusters[&child_cluster] = cluster;
+          RegisterCluster(&child_cluster);
+        }
+      };
+
+  RegisterCluster(&root_cluster);
+
+  // Shared state between the scheduler and the workers.
+  std::mutex mutex;
+  std::condition_variable finished_condition;
+  std::vector<const SceneClustering::Cluster*> finished_clusters;
+  std::unordered_map<const SceneClustering::Cluster*, ReconstructionManager>
+      reconstruction_managers;
+
+  auto FinishCluster = [&](const SceneClustering::Cluster* cluster) {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished_clusters.push_back(cluster);
+    finished_condition.notify_one();
+  };
 
   // Function to reconstruct one cluster using incremental mapping.
   auto ReconstructCluster = [&, this](
-                                const SceneClustering::Cluster& cluster,
+                                const SceneClustering::Cluster* cluster,
+                                const IncrementalMapperOptions* custom_options,
                                 ReconstructionManager* reconstruction_manager) {
-    if (cluster.image_ids.empty()) {
-      return;
+    if (!cluster->image_ids.empty()) {
+      IncrementalMapperController mapper(custom_options, options_.image_path,
+                                         options_.database_path,
+                                         &database_cache,
+                                         reconstruction_manager);
+      mapper.Start();
+      mapper.Wait();
     }
+    FinishCluster(cluster);
+  };
 
-    IncrementalMapperOptions custom_options = mapper_options_;
-    custom_options.max_model_overlap = 3;
-    custom_options.init_num_trials = options_.init_num_trials;
-    custom_options.num_threads = num_threads_per_worker;
+  auto MergeChildClusters = [&](const SceneClustering::Cluster* cluster) {
+    MergeClusters(*cluster, &reconstruction_managers, &mutex,
+                  std::max(1, num_eff_threads / num_eff_workers));
+    FinishCluster(cluster);
+  };
 
-    for (const auto image_id : cluster.image_ids) {
-      custom_options.image_names.insert(image_id_to_name.at(image_id));
+  // Distribute all threads evenly among the reconstructed clusters. The
+  // mappers read the number of threads from their options whenever they start
+  // a new multi-threaded step, so that threads freed by finished clusters are
+  // handed to the clusters that are still being reconstructed.
+  auto DistributeThreads = [&]() {
+    if (reconstructing_clusters.empty()) {
+      return;
+    }
+    const int num_threads = std::max(
+        1, num_eff_threads / static_cast<int>(reconstructing_clusters.size()));
+    for (auto& reconstructing_cluster : reconstructing_clusters) {
+      reconstructing_cluster.second->num_threads = num_threads;
     }
-
-    IncrementalMapperController mapper(&custom_options, options_.image_path,
-                                       options_.database_path,
-                                       reconstruction_manager);
-    mapper.Start();
-    mapper.Wait();
   };
 
-  // Start reconstructing the bigger clusters first for resource usage.
-  std::sort(leaf_clusters.begin(), leaf_clusters.end(),
-            [](const SceneClustering::Cluster* cluster1,
-               const SceneClustering::Cluster* cluster2) {
-              return cluster1->image_ids.size() > cluster2->image_ids.size();
-            });
+  ThreadPool thread_pool(num_eff_workers);
 
-  // Start the reconstruction workers.
+  while (true) {
+    // Start reconstructing the bigger clusters first for resource usage.
+    while (reconstructing_clusters.size() + num_merging_clusters <
+               static_cast<size_t>(num_eff_workers) &&
+           !pending_clusters.empty()) {
+      auto largest_cluster = std::max_element(
+          pending_clusters.begin(), pending_clusters.end(),
+          [](const SceneClustering::Cluster* cluster1,
+             const SceneClustering::Cluster* cluster2) {
+            return cluster1->image_ids.size() < cluster2->image_ids.size();
+          });
+      SceneClustering::Cluster* cluster = *largest_cluster;
+      pending_clusters.erase(largest_cluster);
+
+      // Split clusters that would otherwise dominate the total runtime.
+      if (options_.max_leaf_size_ratio > 0 &&
+          cluster->image_ids.size() > max_leaf_num_images &&
+          SplitLeafCluster(clustering_options_, image_pairs, num_inliers,
+                           cluster)) {
+        std::cout << StringPrintf("  Split cluster with %d images",
+                                  cluster->image_ids.size())
+                  << std::endl;
+        RegisterCluster(cluster);
+        continue;
+      }
 
-  std::unordered_map<const SceneClustering::Cluster*, ReconstructionManager>
-      reconstruction_managers;
-  reconstruction_managers.reserve(leaf_clusters.size());
+      std::unique_ptr<IncrementalMapperOptions> custom_options(
+          new IncrementalMapperOptions(mapper_options_));
+      custom_options->max_model_overlap = 3;
+      custom_options->init_num_trials = options_.init_num_trials;
+      for (const auto image_id : cluster->image_ids) {
+        custom_options->image_names.insert(image_id_to_name.at(image_id));
+      }
 
-  ThreadPool thread_pool(num_eff_workers);
-  for (const auto& cluster : leaf_clusters) {
-    thread_pool.AddTask(ReconstructCluster, *cluster,
-                        &reconstruction_managers[cluster]);
-  }
-  thread_pool.Wait();
+      ReconstructionManager* reconstruction_manager;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        reconstruction_manager = &reconstruction_managers[cluster];
+      }
 
-  //////////////////////////////////////////////////////////////////////////////
-  // Merge clusters
-  //////////////////////////////////////////////////////////////////////////////
+      const IncrementalMapperOptions* custom_options_ptr =
+          custom_options.get();
+      reconstructing_clusters.emplace(cluster, std::move(custom_options));
+      DistributeThreads();
+      thread_pool.AddTask(ReconstructCluster, cluster, custom_options_ptr,
+                          reconstruction_manager);
+    }
 
-  PrintHeading1("Merging clusters");
+    if (pending_clusters.empty() && reconstructing_clusters.empty() &&
+        num_merging_clusters == 0) {
+      break;
+    }
 
-  MergeClusters(*scene_clustering.GetRootCluster(), &reconstruction_managers);
+    std::vector<const SceneClustering::Cluster*> newly_finished_clusters;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      finished_condition.wait(lock, [&]() {
+        return !finished_clusters.empty();
+      });
+      newly_finished_clusters.swap(finished_clusters);
+    }
+
+    for (const auto cluster : newly_finished_clusters) {
+      if (reconstructing_clusters.erase(cluster) == 0) {
+        num_merging_clusters -= 1;
+      }
+
+      const auto parent_cluster = parent_clusters.find(cluster);
+      if (parent_cluster == parent_clusters.end()) {
+        continue;
+      }
+
+      // Merge the siblings as soon as all of them are finished.
+      if (--num_unfinished_child_clusters.at(parent_cluster->second) == 0) {
+        num_merging_clusters += 1;
+        thread_pool.AddTask(MergeChildClusters, parent_cluster->second);
+      }
+    }
+
+    DistributeThreads();
+  }
+
+  thread_pool.Wait();
 
   CHECK_EQ(reconstruction_managers.size(), 1);
   *reconstruction_manager_ = std::move(reconstruction_managers.begin()->second);
@@ -232,4 +621,78 @@ void HierarchicalMapperController::Run() {
   GetTimer().PrintMinutes();
 }
 
+void MergeHierarchicalMapperJobs(
+    const std::string& job_path,
+    ReconstructionManager* reconstruction_manager) {
+  PrintHeading1("Merging cluster jobs");
+
+  // Read the cluster hierarchy in depth-first pre-order.
+  std::unordered_map<int, std::vector<int>> child_cluster_ids;
+  int root_cluster_id = -1;
+  for (const auto& line :
+       ReadTextFileLines(JoinPaths(job_path, "clusters.txt"))) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::stringstream line_stream(line);
+    int cluster_id;
+    int parent_cluster_id;
+    line_stream >> cluster_id >> parent_cluster_id;
+    CHECK(!line_stream.fail()) << line;
+    if (parent_cluster_id == -1) {
+      CHECK_EQ(root_cluster_id, -1) << "Multiple root clusters";
+      root_cluster_id = cluster_id;
+    } else {
+      child_cluster_ids[parent_cluster_id].push_back(cluster_id);
+    }
+  }
+
+  CHECK_NE(root_cluster_id, -1) << "Missing root cluster";
+
+  // Rebuild the hierarchy, read the models of the leaf clusters, and merge the
+  // child clusters bottom-up in the same way as the hierarchical mapper.
+  std::mutex reconstruction_managers_mutex;
+  std::unordered_map<const SceneClustering::Cluster*, ReconstructionManager>
+      reconstruction_managers;
+
+  std::function<void(SceneClustering::Cluster*, int)> MergeCluster =
+      [&](SceneClustering::Cluster* cluster, const int cluster_id) {
+        const auto child_ids = child_cluster_ids.find(cluster_id);
+        if (child_ids == child_cluster_ids.end()) {
+          auto& leaf_reconstruction_manager = reconstruction_managers[cluster];
+          const std::string sparse_path =
+              JoinPaths(GetClusterJobPath(job_path, cluster_id), "sparse");
+          if (ExistsDir(sparse_path)) {
+            for (const auto& model_path : GetDirList(sparse_path)) {
+              leaf_reconstruction_manager.Read(model_path);
+            }
+          }
+          std::cout << StringPrintf("  Cluster %d with %d models", cluster_id,
+                                    leaf_reconstruction_manager.Size())
+                    << std::endl;
+          return;
+        }
+
+        // Allocate all children first, since the merging is keyed by their
+        // addresses in the hierarchy.
+        cluster->child_clusters.resize(child_ids->second.size());
+        for (size_t i = 0; i < child_ids->second.size(); ++i) {
+          MergeCluster(&cluster->child_clusters[i], child_ids->second[i]);
+        }
+
+        MergeClusters(*cluster, &reconstruction_managers,
+                      &reconstruction_managers_mutex, -1);
+      };
+
+  SceneClustering::Cluster root_cluster;
+  MergeCluster(&root_cluster, root_cluster_id);
+
+  CHECK_EQ(reconstruction_managers.size(), 1);
+  *reconstruction_manager = std::move(reconstruction_managers.begin()->second);
+
+  std::cout << StringPrintf("Merged into %d models",
+                            reconstruction_manager->Size())
+            << std::endl;
+}
+
 }  // namespace colmap
@@ -59,6 +59,19 @@ class HierarchicalMapperController : public Thread {
     // The number of workers used to reconstruct clusters in parallel.
     int num_workers = -1;
 
+    // Leaf clusters with more than this ratio times the mean number of images
+    // of all leaf clusters are split further before they are reconstructed,
+    // so that a single large cluster does not dominate the total runtime.
+    // Set to a non-positive value to disable the splitting.
+    double max_leaf_size_ratio = 2.0;
+
+    // If not empty, the clusters are not reconstructed by this controller.
+    // Instead, the cluster hierarchy and a self-contained mapping job for each
+    // leaf cluster are written to this directory. The jobs can be run
+    // independently on separate machines using `colmap mapper` and the
+    // resulting models can then be merged using `MergeHierarchicalMapperJobs`.
+    std::string job_path;
+
     bool Check() const;
   };
 
@@ -77,6 +90,12 @@ class HierarchicalMapperController : public Thread {
   ReconstructionManager* reconstruction_manager_;
 };
 
+// Merge the models of the mapping jobs written by the hierarchical mapper
+// following the same cluster hierarchy as the hierarchical mapper. The models
+// of each job are expected in the `sparse` folder of the job directory.
+void MergeHierarchicalMapperJobs(const std::string& job_path,
+                                 ReconstructionManager* reconstruction_manager);
+
 }  // namespace colmap
 
 #endif  // COLMAP_SRC_CONTROLLERS_HIERARCHICAL_MAPPER_H_
@@ -31,13 +31,20 @@
 
 #include "controllers/incremental_mapper.h"
 
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "util/endian.h"
 #include "util/misc.h"
+#include "util/profiling.h"
 
 namespace colmap {
 namespace {
 
 size_t TriangulateImage(const IncrementalMapperOptions& options,
                         const Image& image, IncrementalMapper* mapper) {
+  ProfileScope profile_scope("TriangulateImage");
   std::cout << "  => Continued observations: " << image.NumPoints3D()
             << std::endl;
   const size_t num_tris =
@@ -46,8 +53,19 @@ size_t TriangulateImage(const IncrementalMapperOptions& options,
   return num_tris;
 }
 
+void LoadCameraRigs(const IncrementalMapperOptions& options,
+                    IncrementalMapper* mapper) {
+  if (options.rig_config_path.empty()) {
+    return;
+  }
+  mapper->SetCameraRigs(ReadCameraRigConfig(options.rig_config_path,
+                                            mapper->GetReconstruction(),
+                                            /*estimate_relative_poses=*/false));
+}
+
 void AdjustGlobalBundle(const IncrementalMapperOptions& options,
                         IncrementalMapper* mapper) {
+  ProfileScope profile_scope("AdjustGlobalBundle");
   BundleAdjustmentOptions custom_ba_options = options.GlobalBundleAdjustment();
 
   const size_t num_reg_images = mapper->GetReconstruction().NumRegImages();
@@ -69,19 +87,32 @@ void AdjustGlobalBundle(const IncrementalMapperOptions& options,
                                           mapper->GetReconstruction())) {
     mapper->AdjustParallelGlobalBundle(
         custom_ba_options, options.ParallelGlobalBundleAdjustment());
+  } else if (options.ba_global_max_num_images_per_partition > 0 &&
+             static_cast<int>(num_reg_images) >
+                 options.ba_global_max_num_images_per_partition) {
+    mapper->AdjustPartitionedGlobalBundle(
+        options.Mapper(), custom_ba_options,
+        options.PartitionedGlobalBundleAdjustment());
   } else {
     mapper->AdjustGlobalBundle(options.Mapper(), custom_ba_options);
   }
 }
 
-void IterativeLocalRefinement(const IncrementalMapperOptions& options,
-                              const image_t image_id,
-                              IncrementalMapper* mapper) {
+size_t IterativeLocalRefinement(const IncrementalMapperOptions& options,
+                                const std::vector<image_t>& image_ids,
+                                IncrementalMapper* mapper) {
+  ProfileScope profile_scope("IterativeLocalRefinement");
+  size_t num_changed_observations = 0;
   auto ba_options = options.LocalBundleAdjustment();
   for (int i = 0; i < options.ba_local_max_refinements; ++i) {
-    const auto report = mapper->AdjustLocalBundle(
-        options.Mapper(), ba_options, options.Triangulation(), image_id,
-        mapper->GetModifiedPoints3D());
+    const auto report =
+        image_ids.size() == 1
+            ? mapper->AdjustLocalBundle(options.Mapper(), ba_options,
+                                        options.Triangulation(), image_ids[0],
+                                        mapper->GetModifiedPoints3D())
+            : mapper->AdjustLocalBundles(options.Mapper(), ba_options,
+                                         options.Triangulation(), image_ids,
+                                         mapper->GetModifiedPoints3D());
     std::cout << "  => Merged observations: " << report.num_merged_observations
               << std::endl;
     std::cout << "  => Completed observations: "
@@ -94,6 +125,9 @@ void IterativeLocalRefinement(const IncrementalMapperOptions& options,
         static_cast<double>(report.num_adjusted_observations);
     std::cout << StringPrintf("  => Changed observations: %.6f", changed)
               << std::endl;
+    num_changed_observations += report.num_merged_observations +
+                                report.num_completed_observations +
+                                report.num_filtered_observations;
     if (changed < options.ba_local_max_refinement_change) {
       break;
     }
@@ -102,10 +136,12 @@ void IterativeLocalRefinement(const IncrementalMapperOptions& options,
         BundleAdjustmentOptions::LossFunctionType::TRIVIAL;
   }
   mapper->ClearModifiedPoints3D();
+  return num_changed_observations;
 }
 
 void IterativeGlobalRefinement(const IncrementalMapperOptions& options,
                                IncrementalMapper* mapper) {
+  ProfileScope profile_scope("IterativeGlobalRefinement");
   PrintHeading1("Retriangulation");
   CompleteAndMergeTracks(options, mapper);
   std::cout << "  => Retriangulated observations: "
@@ -130,6 +166,101 @@ void IterativeGlobalRefinement(const IncrementalMapperOptions& options,
   FilterImages(options, mapper);
 }
 
+// Decides when to perform periodic global bundle adjustment during the
+// incremental mapping of a model, either after fixed growth rates of the model
+// or adaptively based on the drift of the reprojection error and the number of
+// changed observations, and keeps track of the global bundle adjustment time.
+class GlobalRefinementScheduler {
+ public:
+  GlobalRefinementScheduler(const IncrementalMapperOptions& options,
+                            const Reconstruction& reconstruction)
+      : options_(options),
+        reconstruction_(reconstruction),
+        refinement_time_(0) {
+    timer_.Start();
+    Update();
+  }
+
+  // Accumulate the observations changed since the last global refinement,
+  // e.g., by local bundle adjustment and track merging and completion.
+  void AddChangedObservations(const size_t num_changed_observations) {
+    num_changed_observations_ += num_changed_observations;
+  }
+
+  // Whether periodic global refinement should be performed now.
+  bool IsDue() const {
+    if (refinement_time_ >
+        options_.ba_global_max_time_fraction * timer_.ElapsedSeconds()) {
+      return false;
+    }
+
+    if (!options_.ba_global_adaptive) {
+      const size_t num_reg_images = reconstruction_.NumRegImages();
+      const size_t num_points = reconstruction_.NumPoints3D();
+      return num_reg_images >=
+                 options_.ba_global_images_ratio * prev_num_reg_images_ ||
+             num_reg_images >=
+                 options_.ba_global_images_freq + prev_num_reg_images_ ||
+             num_points >= options_.ba_global_points_ratio * prev_num_points_ ||
+             num_points >= options_.ba_global_points_freq + prev_num_points_;
+    }
+
+    const size_t num_observations = reconstruction_.ComputeNumObservations();
+    const size_t num_new_observations =
+        num_observations > prev_num_observations_
+            ? num_observations - prev_num_observations_
+            : prev_num_observations_ - num_observations;
+    if (num_new_observations + num_changed_observations_ >
+        options_.ba_global_max_changed_ratio *
+            std::max<size_t>(prev_num_observations_, 1)) {
+      return true;
+    }
+
+    const double mean_reproj_error =
+        reconstruction_.ComputeMeanReprojectionError(options_.num_threads);
+    return mean_reproj_error >
+           (1 + options_.ba_global_max_error_drift) * prev_mean_reproj_error_;
+  }
+
+  // Whether the number of registered images or 3D points did not change since
+  // the last global refinement.
+  bool IsRefined() const {
+    return reconstruction_.NumRegImages() == prev_num_reg_images_ ||
+           reconstruction_.NumPoints3D() == prev_num_points_;
+  }
+
+  // Perform global refinement and reset the schedule.
+  void Refine(IncrementalMapper* mapper) {
+    Timer timer;
+    timer.Start();
+    IterativeGlobalRefinement(options_, mapper);
+    refinement_time_ += timer.ElapsedSeconds();
+    Update();
+  }
+
+ private:
+  void Update() {
+    prev_num_reg_images_ = reconstruction_.NumRegImages();
+    prev_num_points_ = reconstruction_.NumPoints3D();
+    if (options_.ba_global_adaptive) {
+      prev_num_observations_ = reconstruction_.ComputeNumObservations();
+      prev_mean_reproj_error_ =
+          reconstruction_.ComputeMeanReprojectionError(options_.num_threads);
+    }
+    num_changed_observations_ = 0;
+  }
+
+  const IncrementalMapperOptions& options_;
+  const Reconstruction& reconstruction_;
+  Timer timer_;
+  double refinement_time_;
+  size_t prev_num_reg_images_ = 0;
+  size_t prev_num_points_ = 0;
+  size_t prev_num_observations_ = 0;
+  double prev_mean_reproj_error_ = 0;
+  size_t num_changed_observations_ = 0;
+};
+
 void ExtractColors(const std::string& image_path, const image_t image_id,
                    Reconstruction* reconstruction) {
   if (!reconstruction->ExtractColorsForImage(image_id, image_path)) {
@@ -140,22 +271,232 @@ void ExtractColors(const std::string& image_path, const image_t image_id,
   }
 }
 
-void WriteSnapshot(const Reconstruction& reconstruction,
-                   const std::string& snapshot_path) {
-  PrintHeading1("Creating snapshot");
-  // Get the current timestamp in milliseconds.
-  const size_t timestamp =
-      std::chrono::duration_cast<std::chrono::milliseconds>(
-          std::chrono::high_resolution_clock::now().time_since_epoch())
-          .count();
-  // Write reconstruction to unique path with current timestamp.
-  const std::string path =
-      JoinPaths(snapshot_path, StringPrintf("%010d", timestamp));
-  CreateDirIfNotExists(path);
-  std::cout << "  => Writing to " << path << std::endl;
-  reconstruction.Write(path);
+// Writes reconstruction snapshots in a background thread, so that the mapper
+// can continue to register images, while large models are written to disk.
+// The reconstruction is copied on hand-off, which is much faster than writing
+// it. At most one snapshot is written at a time to bound the memory usage.
+class SnapshotWriter {
+ public:
+  explicit SnapshotWriter(const std::string& snapshot_path)
+      : snapshot_path_(snapshot_path), thread_pool_(1) {}
+
+  ~SnapshotWriter() { Wait(); }
+
+  void Write(const Reconstruction& reconstruction) {
+    PrintHeading1("Creating snapshot");
+    // Get the current timestamp in milliseconds.
+    const size_t timestamp =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now().time_since_epoch())
+            .count();
+    // Write reconstruction to unique path with current timestamp.
+    const std::string path =
+        JoinPaths(snapshot_path_, StringPrintf("%010d", timestamp));
+    std::cout << "  => Writing to " << path << std::endl;
+
+    // Only block, if the previous snapshot is still being written.
+    thread_pool_.Wait();
+
+    const auto snapshot = std::make_shared<Reconstruction>(reconstruction);
+    thread_pool_.AddTask([snapshot, path]() {
+      CreateDirIfNotExists(path);
+      snapshot->Write(path);
+    });
+  }
+
+  // Wait until all snapshots are written.
+  void Wait() { thread_pool_.Wait(); }
+
+ private:
+  const std::string snapshot_path_;
+  ThreadPool thread_pool_;
+};
+
+const char kMapperCheckpointMagic[] = "COLMAP_MAPPER_CHECKPOINT";
+const uint32_t kMapperCheckpointVersion = 1;
+
+void WriteCounts(std::ostream* stream,
+                 const std::unordered_map<image_t, size_t>& counts) {
+  WriteBinaryLittleEndian<uint64_t>(stream, counts.size());
+  for (const auto& count : counts) {
+    WriteBinaryLittleEndian<image_t>(stream, count.first);
+    WriteBinaryLittleEndian<uint64_t>(stream, count.second);
+  }
+}
+
+void ReadCounts(std::istream* stream,
+                std::unordered_map<image_t, size_t>* counts) {
+  const size_t num_counts = ReadBinaryLittleEndian<uint64_t>(stream);
+  counts->clear();
+  counts->reserve(num_counts);
+  for (size_t i = 0; i < num_counts; ++i) {
+    const image_t image_id = ReadBinaryLittleEndian<image_t>(stream);
+    (*counts)[image_id] = ReadBinaryLittleEndian<uint64_t>(stream);
+  }
+}
+
+template <typename T>
+void WriteIds(std::ostream* stream, const std::unordered_set<T>& ids) {
+  WriteBinaryLittleEndian<uint64_t>(stream, ids.size());
+  for (const T id : ids) {
+    WriteBinaryLittleEndian<T>(stream, id);
+  }
 }
 
+template <typename T>
+void ReadIds(std::istream* stream, std::unordered_set<T>* ids) {
+  const size_t num_ids = ReadBinaryLittleEndian<uint64_t>(stream);
+  ids->clear();
+  ids->reserve(num_ids);
+  for (size_t i = 0; i < num_ids; ++i) {
+    ids->insert(ReadBinaryLittleEndian<T>(stream));
+  }
+}
+
+// Checkpoint of the incremental reconstruction in a folder. The finished
+// models are written once to "model<idx>" sub-folders, the current model to a
+// new "current<idx>" sub-folder on every update, and the state of the mapper
+// to the "mapper.bin" file. The state file is replaced last and refers to the
+// current model, so that an interrupted update leaves the previous checkpoint
+// intact.
+class MapperCheckpoint {
+ public:
+  explicit MapperCheckpoint(const std::string& path)
+      : path_(path),
+        num_written_models_(0),
+        num_updates_(0),
+        has_current_model_(false) {}
+
+  // Read the checkpoint into the empty reconstruction manager. Returns false,
+  // if there is no valid checkpoint.
+  bool Read(ReconstructionManager* reconstruction_manager,
+            IncrementalMapper::State* mapper_state, int* num_trials,
+            bool* has_current_model) {
+    CHECK_EQ(reconstruction_manager->Size(), 0);
+
+    const std::string state_path = JoinPaths(path_, "mapper.bin");
+    if (!ExistsFile(state_path)) {
+      return false;
+    }
+
+    std::ifstream file(state_path, std::ios::binary);
+    CHECK(file.is_open()) << state_path;
+
+    char magic[sizeof(kMapperCheckpointMagic)];
+    file.read(magic, sizeof(magic));
+    if (!file.good() ||
+        std::string(magic, sizeof(magic)) !=
+            std::string(kMapperCheckpointMagic, sizeof(magic)) ||
+        ReadBinaryLittleEndian<uint32_t>(&file) != kMapperCheckpointVersion) {
+      return false;
+    }
+
+    *num_trials = ReadBinaryLittleEndian<int32_t>(&file);
+    const size_t num_finished_models = ReadBinaryLittleEndian<uint64_t>(&file);
+    *has_current_model = ReadBinaryLittleEndian<uint8_t>(&file) != 0;
+    const size_t num_updates = ReadBinaryLittleEndian<uint64_t>(&file);
+    ReadCounts(&file, &mapper_state->num_registrations);
+    ReadCounts(&file, &mapper_state->init_num_reg_trials);
+    ReadIds(&file, &mapper_state->init_image_pairs);
+    ReadIds(&file, &mapper_state->filtered_images);
+    ReadCounts(&file, &mapper_state->num_reg_trials);
+    ReadIds(&file, &mapper_state->existing_image_ids);
+    CHECK(file.good()) << state_path;
+
+    for (size_t i = 0; i < num_finished_models; ++i) {
+      const size_t idx = reconstruction_manager->Add();
+      reconstruction_manager->Get(idx).ReadBinary(ModelPath(i));
+    }
+
+    if (*has_current_model) {
+      const size_t idx = reconstruction_manager->Add();
+      reconstruction_manager->Get(idx).ReadBinary(
+          CurrentModelPath(num_updates));
+    }
+
+    num_written_models_ = num_finished_models;
+    num_updates_ = num_updates;
+    has_current_model_ = *has_current_model;
+
+    return true;
+  }
+
+  // Update the checkpoint, where the current model is the last model of the
+  // reconstruction manager, if `has_current_model` is true.
+  void Write(const ReconstructionManager& reconstruction_manager,
+             const bool has_current_model, const int num_trials,
+             const IncrementalMapper::State& mapper_state) {
+    PrintHeading1("Creating checkpoint");
+
+    CreateDirIfNotExists(path_);
+
+    const size_t num_finished_models =
+        reconstruction_manager.Size() - (has_current_model ? 1 : 0);
+    for (; num_written_models_ < num_finished_models; ++num_written_models_) {
+      const std::string model_path = ModelPath(num_written_models_);
+      CreateDirIfNotExists(model_path);
+      reconstruction_manager.Get(num_written_models_).WriteBinary(model_path);
+    }
+
+    const size_t num_updates = num_updates_ + 1;
+    if (has_current_model) {
+      const std::string model_path = CurrentModelPath(num_updates);
+      CreateDirIfNotExists(model_path);
+      reconstruction_manager.Get(num_finished_models).WriteBinary(model_path);
+    }
+
+    const std::string state_path = JoinPaths(path_, "mapper.bin");
+    const std::string tmp_state_path = state_path + ".tmp";
+
+    {
+      std::ofstream file(tmp_state_path, std::ios::binary);
+      CHECK(file.is_open()) << tmp_state_path;
+
+      file.write(kMapperCheckpointMagic, sizeof(kMapperCheckpointMagic));
+      WriteBinaryLittleEndian<uint32_t>(&file, kMapperCheckpointVersion);
+      WriteBinaryLittleEndian<int32_t>(&file, num_trials);
+      WriteBinaryLittleEndian<uint64_t>(&file, num_finished_models);
+      WriteBinaryLittleEndian<uint8_t>(&file, has_current_model);
+      WriteBinaryLittleEndian<uint64_t>(&file, num_updates);
+      WriteCounts(&file, mapper_state.num_registrations);
+      WriteCounts(&file, mapper_state.init_num_reg_trials);
+      WriteIds(&file, mapper_state.init_image_pairs);
+      WriteIds(&file, mapper_state.filtered_images);
+      WriteCounts(&file, mapper_state.num_reg_trials);
+      WriteIds(&file, mapper_state.existing_image_ids);
+      CHECK(file.good()) << tmp_state_path;
+    }
+
+    CHECK_EQ(std::rename(tmp_state_path.c_str(), state_path.c_str()), 0)
+        << state_path;
+
+    if (has_current_model_) {
+      boost::filesystem::remove_all(CurrentModelPath(num_updates_));
+    }
+
+    num_updates_ = num_updates;
+    has_current_model_ = has_current_model;
+
+    std::cout << "  => Wrote " << num_finished_models << " finished models"
+              << (has_current_model ? " and the current model" : "") << " to "
+              << path_ << std::endl;
+  }
+
+ private:
+  std::string ModelPath(const size_t idx) const {
+    return JoinPaths(path_, "model" + std::to_string(idx));
+  }
+
+  std::string CurrentModelPath(const size_t update_idx) const {
+    return JoinPaths(path_, "current" + std::to_string(update_idx));
+  }
+
+  const std::string path_;
+  size_t num_written_models_;
+  size_t num_updates_;
+  bool has_current_model_;
+};
+
 }  // namespace
 
 size_t FilterPoints(const IncrementalMapperOptions& options,
@@ -206,6 +547,7 @@ IncrementalTriangulator::Options IncrementalMapperOptions::Triangulation()
   options.min_focal_length_ratio = min_focal_length_ratio;
   options.max_focal_length_ratio = max_focal_length_ratio;
   options.max_extra_param = max_extra_param;
+  options.num_threads = num_threads;
   return options;
 }
 
@@ -228,6 +570,7 @@ BundleAdjustmentOptions IncrementalMapperOptions::LocalBundleAdjustment()
   options.refine_extra_params = ba_refine_extra_params;
   options.min_num_residuals_for_multi_threading =
       ba_min_num_residuals_for_multi_threading;
+  options.use_mixed_precision = ba_use_mixed_precision;
   options.loss_function_scale = 1.0;
   options.loss_function_type =
       BundleAdjustmentOptions::LossFunctionType::SOFT_L1;
@@ -253,6 +596,9 @@ BundleAdjustmentOptions IncrementalMapperOptions::GlobalBundleAdjustment()
   options.refine_extra_params = ba_refine_extra_params;
   options.min_num_residuals_for_multi_threading =
 	  ba_min_num_residuals_for_multi_threading;
+  options.use_gpu = ba_global_use_gpu;
+  options.gpu_index = ba_global_gpu_index;
+  options.use_mixed_precision = ba_use_mixed_precision;
   options.loss_function_type =
       BundleAdjustmentOptions::LossFunctionType::TRIVIAL;
   return options;
@@ -270,12 +616,24 @@ IncrementalMapperOptions::ParallelGlobalBundleAdjustment() const {
   return options;
 }
 
+PartitionedBundleAdjuster::Options
+IncrementalMapperOptions::PartitionedGlobalBundleAdjustment() const {
+  PartitionedBundleAdjuster::Options options;
+  options.max_num_images_per_partition =
+      ba_global_max_num_images_per_partition;
+  options.print_summary = true;
+  options.num_threads = num_threads;
+  return options;
+}
+
 bool IncrementalMapperOptions::Check() const {
   CHECK_OPTION_GT(min_num_matches, 0);
+  CHECK_OPTION_GT(streaming_poll_interval, 0);
   CHECK_OPTION_GT(max_num_models, 0);
   CHECK_OPTION_GT(max_model_overlap, 0);
   CHECK_OPTION_GE(min_model_size, 0);
   CHECK_OPTION_GT(init_num_trials, 0);
+  CHECK_OPTION_GT(reg_batch_size, 0);
   CHECK_OPTION_GT(min_focal_length_ratio, 0);
   CHECK_OPTION_GT(max_focal_length_ratio, 0);
   CHECK_OPTION_GE(max_extra_param, 0);
@@ -285,12 +643,19 @@ bool IncrementalMapperOptions::Check() const {
   CHECK_OPTION_GT(ba_global_points_ratio, 1.0);
   CHECK_OPTION_GT(ba_global_images_freq, 0);
   CHECK_OPTION_GT(ba_global_points_freq, 0);
+  CHECK_OPTION_GE(ba_global_max_error_drift, 0);
+  CHECK_OPTION_GE(ba_global_max_changed_ratio, 0);
+  CHECK_OPTION_GT(ba_global_max_time_fraction, 0);
+  CHECK_OPTION_LE(ba_global_max_time_fraction, 1);
   CHECK_OPTION_GT(ba_global_max_num_iterations, 0);
   CHECK_OPTION_GT(ba_local_max_refinements, 0);
   CHECK_OPTION_GE(ba_local_max_refinement_change, 0);
   CHECK_OPTION_GT(ba_global_max_refinements, 0);
   CHECK_OPTION_GE(ba_global_max_refinement_change, 0);
   CHECK_OPTION_GE(snapshot_images_freq, 0);
+  CHECK_OPTION_GE(checkpoint_images_freq, 0);
+  CHECK_OPTION(checkpoint_images_freq == 0 || !checkpoint_path.empty());
+  CHECK_OPTION(!resume || !checkpoint_path.empty());
   CHECK_OPTION(Mapper().Check());
   CHECK_OPTION(Triangulation().Check());
   return true;
@@ -300,19 +665,50 @@ IncrementalMapperController::IncrementalMapperController(
     const IncrementalMapperOptions* options, const std::string& image_path,
     const std::string& database_path,
     ReconstructionManager* reconstruction_manager)
+    : IncrementalMapperController(options, image_path, database_path, nullptr,
+                                  reconstruction_manager) {}
+
+IncrementalMapperController::IncrementalMapperController(
+    const IncrementalMapperOptions* options, const std::string& image_path,
+    const std::string& database_path,
+    const DatabaseCache* source_database_cache,
+    ReconstructionManager* reconstruction_manager)
     : options_(options),
       image_path_(image_path),
       database_path_(database_path),
-      reconstruction_manager_(reconstruction_manager) {
+      reconstruction_manager_(reconstruction_manager),
+      source_database_cache_(source_database_cache),
+      database_updated_(false),
+      database_cache_memory_("database_cache", [this]() {
+        return database_cache_.NumBytes();
+      }) {
   CHECK(options_->Check());
   RegisterCallback(INITIAL_IMAGE_PAIR_REG_CALLBACK);
   RegisterCallback(NEXT_IMAGE_REG_CALLBACK);
   RegisterCallback(LAST_IMAGE_REG_CALLBACK);
+  database_update_timer_.Start();
+}
+
+void IncrementalMapperController::NotifyDatabaseUpdate() {
+  {
+    std::unique_lock<std::mutex> lock(database_update_mutex_);
+    database_updated_ = true;
+  }
+  database_update_condition_.notify_all();
+}
+
+void IncrementalMapperController::Stop() {
+  Thread::Stop();
+  database_update_condition_.notify_all();
 }
 
 void IncrementalMapperController::Run() {
+  ProfileScope profile_scope("IncrementalMapperController::Run");
+
   if (!LoadDatabase()) {
-    return;
+    if (!options_->streaming || !WaitForDatabaseUpdate(nullptr)) {
+      return;
+    }
   }
 
   IncrementalMapper::Options init_mapper_options = options_->Mapper();
@@ -342,6 +738,7 @@ void IncrementalMapperController::Run() {
 }
 
 bool IncrementalMapperController::LoadDatabase() {
+  ProfileScope profile_scope("IncrementalMapperController::LoadDatabase");
   PrintHeading1("Loading database");
 
   // Make sure images of the given reconstruction are also included when
@@ -355,17 +752,32 @@ bool IncrementalMapperController::LoadDatabase() {
     }
   }
 
-  Database database(database_path_);
   Timer timer;
   timer.Start();
-  const size_t min_num_matches = static_cast<size_t>(options_->min_num_matches);
-  database_cache_.Load(database, min_num_matches, options_->ignore_watermarks,
-                       image_names);
+  if (source_database_cache_ != nullptr) {
+    if (image_names.empty()) {
+      for (const auto& image : source_database_cache_->Images()) {
+        image_names.insert(image.second.Name());
+      }
+    }
+    database_cache_.LoadSubset(*source_database_cache_, image_names,
+                               options_->num_threads);
+  } else {
+    Database database;
+    database.OpenShardedPath(database_path_);
+    const size_t min_num_matches =
+        static_cast<size_t>(options_->min_num_matches);
+    database_cache_.Load(database, min_num_matches, options_->ignore_watermarks,
+                         image_names, options_->correspondence_graph_path,
+                         options_->num_threads);
+  }
   std::cout << std::endl;
   timer.PrintMinutes();
 
   std::cout << std::endl;
 
+  database_cache_memory_.Update();
+
   if (database_cache_.NumImages() == 0) {
     std::cout << "WARNING: No images with matches found in the database."
               << std::endl
@@ -376,6 +788,59 @@ bool IncrementalMapperController::LoadDatabase() {
   return true;
 }
 
+bool IncrementalMapperController::UpdateDatabaseCache(
+    IncrementalMapper* mapper) {
+  {
+    std::unique_lock<std::mutex> lock(database_update_mutex_);
+    if (!database_updated_ && database_update_timer_.ElapsedSeconds() <
+                                  options_->streaming_poll_interval) {
+      return false;
+    }
+    database_updated_ = false;
+  }
+
+  database_update_timer_.Restart();
+
+  Database database;
+  database.OpenShardedPath(database_path_);
+  std::vector<image_t> new_image_ids;
+  std::vector<image_pair_t> new_image_pair_ids;
+  if (!database_cache_.Update(database, &new_image_ids,
+                              &new_image_pair_ids)) {
+    return false;
+  }
+
+  database_cache_memory_.Update();
+
+  if (mapper != nullptr) {
+    mapper->LoadDatabaseCacheUpdate(new_image_ids, new_image_pair_ids);
+    LoadCameraRigs(*options_, mapper);
+  }
+
+  std::cout << StringPrintf("  => Loaded %d new images and %d new image pairs",
+                            new_image_ids.size(), new_image_pair_ids.size())
+            << std::endl;
+
+  return true;
+}
+
+bool IncrementalMapperController::WaitForDatabaseUpdate(
+    IncrementalMapper* mapper) {
+  while (!IsStopped()) {
+    {
+      std::unique_lock<std::mutex> lock(database_update_mutex_);
+      database_update_condition_.wait_for(
+          lock,
+          std::chrono::duration<double>(options_->streaming_poll_interval),
+          [this]() { return database_updated_ || IsStopped(); });
+    }
+    if (!IsStopped() && UpdateDatabaseCache(mapper)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void IncrementalMapperController::Reconstruct(
     const IncrementalMapper::Options& init_mapper_options) {
   const bool kDiscardReconstruction = true;
@@ -386,6 +851,16 @@ void IncrementalMapperController::Reconstruct(
 
   IncrementalMapper mapper(&database_cache_);
 
+  // The memory usage of all reconstructions, which is reported whenever
+  // images were registered.
+  ScopedMemoryComponent reconstruction_memory("reconstruction", [this]() {
+    size_t num_bytes = 0;
+    for (size_t i = 0; i < reconstruction_manager_->Size(); ++i) {
+      num_bytes += reconstruction_manager_->Get(i).NumBytes();
+    }
+    return num_bytes;
+  });
+
   // Is there a sub-model before we start the reconstruction? I.e. the user
   // has imported an existing reconstruction.
   const bool initial_reconstruction_given = reconstruction_manager_->Size() > 0;
@@ -393,15 +868,40 @@ void IncrementalMapperController::Reconstruct(
                                                   "single reconstruction, but "
                                                   "multiple are given.";
 
-  for (int num_trials = 0; num_trials < options_->init_num_trials;
-       ++num_trials) {
+  // Continue from the finished models, the current model, and the state of
+  // the mapper in the checkpoint.
+  std::unique_ptr<MapperCheckpoint> checkpoint;
+  std::unique_ptr<IncrementalMapper::State> resume_mapper_state;
+  int num_trials_begin = 0;
+  bool resume_current_model = false;
+  if (!options_->checkpoint_path.empty()) {
+    checkpoint.reset(new MapperCheckpoint(options_->checkpoint_path));
+    if (options_->resume) {
+      CHECK(!initial_reconstruction_given)
+          << "Cannot resume from a checkpoint and an existing reconstruction.";
+      resume_mapper_state.reset(new IncrementalMapper::State());
+      if (checkpoint->Read(reconstruction_manager_, resume_mapper_state.get(),
+                           &num_trials_begin, &resume_current_model)) {
+        std::cout << "Resuming from checkpoint with "
+                  << reconstruction_manager_->Size() << " models" << std::endl;
+      } else {
+        resume_mapper_state.reset();
+      }
+    }
+  }
+
+  for (int num_trials = num_trials_begin;
+       num_trials < options_->init_num_trials; ++num_trials) {
     BlockIfPaused();
     if (IsStopped()) {
       break;
     }
 
     size_t reconstruction_idx;
-    if (!initial_reconstruction_given || num_trials > 0) {
+    if (resume_current_model) {
+      reconstruction_idx = reconstruction_manager_->Size() - 1;
+      resume_current_model = false;
+    } else if (!initial_reconstruction_given || num_trials > 0) {
       reconstruction_idx = reconstruction_manager_->Add();
     } else {
       reconstruction_idx = 0;
@@ -411,6 +911,11 @@ void IncrementalMapperController::Reconstruct(
         reconstruction_manager_->Get(reconstruction_idx);
 
     mapper.BeginReconstruction(&reconstruction);
+    if (resume_mapper_state) {
+      mapper.SetState(*resume_mapper_state);
+      resume_mapper_state.reset();
+    }
+    LoadCameraRigs(*options_, &mapper);
 
     ////////////////////////////////////////////////////////////////////////////
     // Register initial pair
@@ -428,6 +933,10 @@ void IncrementalMapperController::Reconstruct(
           std::cout << "  => No good initial image pair found." << std::endl;
           mapper.EndReconstruction(kDiscardReconstruction);
           reconstruction_manager_->Delete(reconstruction_idx);
+          // In streaming mode, retry once new images arrived.
+          if (options_->streaming && WaitForDatabaseUpdate(nullptr)) {
+            continue;
+          }
           break;
         }
       } else {
@@ -482,6 +991,8 @@ void IncrementalMapperController::Reconstruct(
       }
     }
 
+    reconstruction_memory.Update();
+
     Callback(INITIAL_IMAGE_PAIR_REG_CALLBACK);
 
     ////////////////////////////////////////////////////////////////////////////
@@ -489,23 +1000,39 @@ void IncrementalMapperController::Reconstruct(
     ////////////////////////////////////////////////////////////////////////////
 
     size_t snapshot_prev_num_reg_images = reconstruction.NumRegImages();
-    size_t ba_prev_num_reg_images = reconstruction.NumRegImages();
-    size_t ba_prev_num_points = reconstruction.NumPoints3D();
+    std::unique_ptr<SnapshotWriter> snapshot_writer;
+    if (options_->snapshot_images_freq > 0) {
+      snapshot_writer.reset(new SnapshotWriter(options_->snapshot_path));
+    }
+    size_t checkpoint_prev_num_reg_images = reconstruction.NumRegImages();
+    GlobalRefinementScheduler global_refinement_scheduler(*options_,
+                                                          reconstruction);
 
+    // In streaming mode, the model is only finished once the controller is
+    // stopped and otherwise waits for new data when no image can be
+    // registered.
     bool reg_next_success = true;
     bool prev_reg_next_success = true;
-    while (reg_next_success) {
+    while (reg_next_success ||
+           (options_->streaming && WaitForDatabaseUpdate(&mapper))) {
       BlockIfPaused();
       if (IsStopped()) {
         break;
       }
 
+      if (options_->streaming) {
+        UpdateDatabaseCache(&mapper);
+      }
+
       reg_next_success = false;
 
       const std::vector<image_t> next_images =
           mapper.FindNextImages(options_->Mapper());
 
       if (next_images.empty()) {
+        if (options_->streaming) {
+          continue;
+        }
         break;
       }
 
@@ -513,36 +1040,87 @@ void IncrementalMapperController::Reconstruct(
         const image_t next_image_id = next_images[reg_trial];
         const Image& next_image = reconstruction.Image(next_image_id);
 
-        PrintHeading1(StringPrintf("Registering image #%d (%d)", next_image_id,
-                                   reconstruction.NumRegImages() + 1));
+        std::vector<image_t> reg_image_ids;
+        bool reg_snapshot = false;
 
-        std::cout << StringPrintf("  => Image sees %d / %d points",
-                                  next_image.NumVisiblePoints3D(),
-                                  next_image.NumObservations())
-                  << std::endl;
+        if (reg_trial == 0 && options_->reg_batch_size > 1 &&
+            options_->rig_config_path.empty() && next_images.size() > 1) {
+          const size_t batch_size =
+              std::min(next_images.size(),
+                       static_cast<size_t>(options_->reg_batch_size));
+          const std::vector<image_t> batch_image_ids(
+              next_images.begin(), next_images.begin() + batch_size);
+
+          PrintHeading1(StringPrintf("Registering %d images (%d)", batch_size,
+                                     reconstruction.NumRegImages() + 1));
 
-        reg_next_success =
-            mapper.RegisterNextImage(options_->Mapper(), next_image_id);
+          ProfileScope profile_scope("RegisterNextImages");
+          reg_image_ids =
+              mapper.RegisterNextImages(options_->Mapper(), batch_image_ids);
+
+          std::cout << StringPrintf("  => Registered %d / %d images",
+                                    reg_image_ids.size(), batch_size)
+                    << std::endl;
+        } else {
+          PrintHeading1(StringPrintf("Registering image #%d (%d)",
+                                     next_image_id,
+                                     reconstruction.NumRegImages() + 1));
+
+          std::cout << StringPrintf("  => Image sees %d / %d points",
+                                    next_image.NumVisiblePoints3D(),
+                                    next_image.NumObservations())
+                    << std::endl;
+
+          if (!options_->rig_config_path.empty()) {
+            ProfileScope profile_scope("RegisterNextSnapshot");
+            reg_image_ids =
+                mapper.RegisterNextSnapshot(options_->Mapper(), next_image_id);
+            reg_snapshot = !reg_image_ids.empty();
+            if (reg_snapshot) {
+              std::cout << StringPrintf("  => Registered %d snapshot images",
+                                        reg_image_ids.size())
+                        << std::endl;
+            }
+          }
+
+          if (reg_image_ids.empty()) {
+            ProfileScope profile_scope("RegisterNextImage");
+            if (mapper.RegisterNextImage(options_->Mapper(), next_image_id)) {
+              reg_image_ids.push_back(next_image_id);
+            }
+          }
+        }
+
+        reg_next_success = !reg_image_ids.empty();
+
+        ProfileCounter("registration_trials", 1);
+        ProfileCounter("registered_images", reg_image_ids.size());
 
         if (reg_next_success) {
-          TriangulateImage(*options_, next_image, &mapper);
-          IterativeLocalRefinement(*options_, next_image_id, &mapper);
+          for (const image_t reg_image_id : reg_image_ids) {
+            TriangulateImage(*options_, reconstruction.Image(reg_image_id),
+                             &mapper);
+          }
 
-          if (reconstruction.NumRegImages() >=
-                  options_->ba_global_images_ratio * ba_prev_num_reg_images ||
-              reconstruction.NumRegImages() >=
-                  options_->ba_global_images_freq + ba_prev_num_reg_images ||
-              reconstruction.NumPoints3D() >=
-                  options_->ba_global_points_ratio * ba_prev_num_points ||
-              reconstruction.NumPoints3D() >=
-                  options_->ba_global_points_freq + ba_prev_num_points) {
-            IterativeGlobalRefinement(*options_, &mapper);
-            ba_prev_num_points = reconstruction.NumPoints3D();
-            ba_prev_num_reg_images = reconstruction.NumRegImages();
+          if (reg_snapshot) {
+            ProfileScope profile_scope("AdjustSnapshotBundle");
+            mapper.AdjustSnapshotBundle(options_->LocalBundleAdjustment(),
+                                        next_image_id);
+          }
+
+          // The local bundles of batch registered images in different regions
+          // of the model are adjusted concurrently.
+          global_refinement_scheduler.AddChangedObservations(
+              IterativeLocalRefinement(*options_, reg_image_ids, &mapper));
+
+          if (global_refinement_scheduler.IsDue()) {
+            global_refinement_scheduler.Refine(&mapper);
           }
 
           if (options_->extract_colors) {
-            ExtractColors(image_path_, next_image_id, &reconstruction);
+            for (const image_t reg_image_id : reg_image_ids) {
+              ExtractColors(image_path_, reg_image_id, &reconstruction);
+            }
           }
 
           if (options_->snapshot_images_freq > 0 &&
@@ -550,9 +1128,21 @@ void IncrementalMapperController::Reconstruct(
                   options_->snapshot_images_freq +
                       snapshot_prev_num_reg_images) {
             snapshot_prev_num_reg_images = reconstruction.NumRegImages();
-            WriteSnapshot(reconstruction, options_->snapshot_path);
+            snapshot_writer->Write(reconstruction);
+          }
+
+          if (checkpoint && options_->checkpoint_images_freq > 0 &&
+              reconstruction.NumRegImages() >=
+                  options_->checkpoint_images_freq +
+                      checkpoint_prev_num_reg_images) {
+            checkpoint_prev_num_reg_images = reconstruction.NumRegImages();
+            checkpoint->Write(*reconstruction_manager_,
+                              /*has_current_model=*/true, num_trials,
+                              mapper.GetState());
           }
 
+          reconstruction_memory.Update();
+
           Callback(NEXT_IMAGE_REG_CALLBACK);
 
           break;
@@ -583,13 +1173,19 @@ void IncrementalMapperController::Reconstruct(
       if (!reg_next_success && prev_reg_next_success) {
         reg_next_success = true;
         prev_reg_next_success = false;
-        IterativeGlobalRefinement(*options_, &mapper);
+        global_refinement_scheduler.Refine(&mapper);
       } else {
         prev_reg_next_success = reg_next_success;
       }
     }
 
     if (IsStopped()) {
+      // The interrupted model is continued, when resuming from the checkpoint.
+      if (checkpoint) {
+        checkpoint->Write(*reconstruction_manager_,
+                          /*has_current_model=*/true, num_trials,
+                          mapper.GetState());
+      }
       const bool kDiscardReconstruction = false;
       mapper.EndReconstruction(kDiscardReconstruction);
       break;
@@ -597,9 +1193,8 @@ void IncrementalMapperController::Reconstruct(
 
     // Only run final global BA, if last incremental BA was not global.
     if (reconstruction.NumRegImages() >= 2 &&
-        reconstruction.NumRegImages() != ba_prev_num_reg_images &&
-        reconstruction.NumPoints3D() != ba_prev_num_points) {
-      IterativeGlobalRefinement(*options_, &mapper);
+        !global_refinement_scheduler.IsRefined()) {
+      global_refinement_scheduler.Refine(&mapper);
     }
 
     // If the total number of images is small then do not enforce the minimum
@@ -617,6 +1212,12 @@ void IncrementalMapperController::Reconstruct(
       mapper.EndReconstruction(kDiscardReconstruction);
     }
 
+    if (checkpoint) {
+      checkpoint->Write(*reconstruction_manager_,
+                        /*has_current_model=*/false, num_trials + 1,
+                        mapper.GetState());
+    }
+
     Callback(LAST_IMAGE_REG_CALLBACK);
 
     const size_t max_num_models = static_cast<size_t>(options_->max_num_models);
@@ -32,9 +32,14 @@
 #ifndef COLMAP_SRC_CONTROLLERS_INCREMENTAL_MAPPER_H_
 #define COLMAP_SRC_CONTROLLERS_INCREMENTAL_MAPPER_H_
 
+#include <condition_variable>
+#include <mutex>
+
 #include "base/reconstruction_manager.h"
 #include "sfm/incremental_mapper.h"
+#include "util/memory_accountant.h"
 #include "util/threading.h"
+#include "util/timer.h"
 
 namespace colmap {
 
@@ -46,6 +51,23 @@ struct IncrementalMapperOptions {
   // Whether to ignore the inlier matches of watermark image pairs.
   bool ignore_watermarks = false;
 
+  // Optional path to a binary snapshot of the correspondence graph. The
+  // snapshot is written on the first run and incrementally updated with newly
+  // verified image pairs on subsequent runs, which avoids rebuilding the graph
+  // from all two-view geometries in the database.
+  std::string correspondence_graph_path = "";
+
+  // Whether to keep extending the current model with the images and image
+  // pairs that are added to the database while the mapper is running, e.g.,
+  // by a concurrent feature extraction and matching of a live video stream.
+  // The mapper then waits for new data instead of finishing the model and
+  // only finishes once it is stopped.
+  bool streaming = false;
+
+  // The interval in seconds at which the database is checked for new data in
+  // streaming mode, unless the mapper is notified earlier.
+  double streaming_poll_interval = 1.0;
+
   // Whether to reconstruct multiple sub-models.
   bool multiple_models = true;
 
@@ -70,6 +92,22 @@ struct IncrementalMapperOptions {
   // The number of trials to initialize the reconstruction.
   int init_num_trials = 200;
 
+  // The number of next images to register jointly per iteration. If larger
+  // than one, the poses of the best ranked next images are estimated in
+  // parallel against the same model, instead of registering one image at a
+  // time. The local bundles of the registered images are then adjusted
+  // concurrently, if they do not overlap.
+  int reg_batch_size = 1;
+
+  // Path to a JSON configuration of camera rigs, as read by
+  // `ReadCameraRigConfig`. If given, the next images are registered together
+  // with the unregistered images of their snapshot using a generalized
+  // absolute pose, once the relative poses of the rig cameras can be estimated
+  // from completely registered snapshots. The snapshot is then adjusted as a
+  // rigid camera rig before the local refinement. Takes precedence over the
+  // batched registration of `reg_batch_size`.
+  std::string rig_config_path = "";
+
   // Whether to extract colors for reconstructed points.
   bool extract_colors = true;
 
@@ -90,6 +128,10 @@ struct IncrementalMapperOptions {
   // enable multi-threading solving of the problems.
   int ba_min_num_residuals_for_multi_threading = 50000;
 
+  // Whether to factorize the reduced camera system in single precision with
+  // double precision refinement in local and global bundle adjustment.
+  bool ba_use_mixed_precision = false;
+
   // The number of images to optimize in local bundle adjustment.
   int ba_local_num_images = 6;
 
@@ -102,12 +144,38 @@ struct IncrementalMapperOptions {
   // The GPU index for PBA bundle adjustment.
   int ba_global_pba_gpu_index = -1;
 
+  // Whether to solve global bundle adjustment with the CUDA backends of
+  // Ceres-Solver and the index of the GPU to use.
+  bool ba_global_use_gpu = false;
+  int ba_global_gpu_index = -1;
+
+  // The maximum number of images per partition in global bundle adjustment.
+  // If positive, larger models are adjusted as partitioned problems, whose
+  // shared cameras and points are made consistent using consensus ADMM.
+  int ba_global_max_num_images_per_partition = -1;
+
   // The growth rates after which to perform global bundle adjustment.
   double ba_global_images_ratio = 1.1;
   double ba_global_points_ratio = 1.1;
   int ba_global_images_freq = 500;
   int ba_global_points_freq = 250000;
 
+  // Whether to schedule global bundle adjustment adaptively instead of after
+  // the fixed growth rates above. Global bundle adjustment is then performed,
+  // if the mean reprojection error of the model increased by more than the
+  // given ratio since the last global bundle adjustment or if the number of
+  // new and changed observations since then exceeds the given ratio of the
+  // observations at the last global bundle adjustment.
+  bool ba_global_adaptive = false;
+  double ba_global_max_error_drift = 0.1;
+  double ba_global_max_changed_ratio = 0.1;
+
+  // The maximum fraction of the incremental mapping time to spend in periodic
+  // global bundle adjustment. Global bundle adjustments are postponed while
+  // this budget is exceeded. The final global bundle adjustment of a model is
+  // always performed.
+  double ba_global_max_time_fraction = 1.0;
+
   // The maximum number of global bundle adjustment iterations.
   int ba_global_max_num_iterations = 50;
 
@@ -119,10 +187,21 @@ struct IncrementalMapperOptions {
 
   // Path to a folder with reconstruction snapshots during incremental
   // reconstruction. Snapshots will be saved according to the specified
-  // frequency of registered images.
+  // frequency of registered images. Snapshots are written in the background,
+  // while the reconstruction continues.
   std::string snapshot_path = "";
   int snapshot_images_freq = 0;
 
+  // Path to a folder with a checkpoint of the incremental reconstruction,
+  // which consists of the finished models, the current model, and the state
+  // of the mapper. The checkpoint is updated according to the specified
+  // frequency of registered images and after every finished model, where the
+  // finished models are only written once. If `resume` is set, the mapper
+  // continues from the checkpoint in the folder, if it exists.
+  std::string checkpoint_path = "";
+  int checkpoint_images_freq = 0;
+  bool resume = false;
+
   // Which images to reconstruct. If no images are specified, all images will
   // be reconstructed by default.
   std::unordered_set<std::string> image_names;
@@ -135,6 +214,7 @@ struct IncrementalMapperOptions {
   BundleAdjustmentOptions LocalBundleAdjustment() const;
   BundleAdjustmentOptions GlobalBundleAdjustment() const;
   ParallelBundleAdjuster::Options ParallelGlobalBundleAdjustment() const;
+  PartitionedBundleAdjuster::Options PartitionedGlobalBundleAdjustment() const;
 
   bool Check() const;
 
@@ -166,16 +246,50 @@ class IncrementalMapperController : public Thread {
                               const std::string& database_path,
                               ReconstructionManager* reconstruction_manager);
 
+  // Load the images from the given database cache instead of the database,
+  // e.g., to reconstruct many subsets of the images of a cache that is shared
+  // between multiple controllers. The cache must outlive the controller. The
+  // database is only read for updates in streaming mode.
+  IncrementalMapperController(const IncrementalMapperOptions* options,
+                              const std::string& image_path,
+                              const std::string& database_path,
+                              const DatabaseCache* source_database_cache,
+                              ReconstructionManager* reconstruction_manager);
+
+  // Notify the mapper in streaming mode that new data was written to the
+  // database, so that it is loaded without waiting for the next poll.
+  void NotifyDatabaseUpdate();
+
+  void Stop() override;
+
  private:
   void Run();
   bool LoadDatabase();
   void Reconstruct(const IncrementalMapper::Options& init_mapper_options);
 
+  // Load the data that was added to the database since the last update into
+  // the database cache and, if given, the current reconstruction of the
+  // mapper. The database is only read if the mapper was notified or the poll
+  // interval elapsed. Returns whether any new data was loaded.
+  bool UpdateDatabaseCache(IncrementalMapper* mapper);
+
+  // Block until new data was loaded from the database or the controller was
+  // stopped, in which case false is returned.
+  bool WaitForDatabaseUpdate(IncrementalMapper* mapper);
+
   const IncrementalMapperOptions* options_;
   const std::string image_path_;
   const std::string database_path_;
   ReconstructionManager* reconstruction_manager_;
+  const DatabaseCache* source_database_cache_;
   DatabaseCache database_cache_;
+
+  std::mutex database_update_mutex_;
+  std::condition_variable database_update_condition_;
+  bool database_updated_;
+  Timer database_update_timer_;
+
+  ScopedMemoryComponent database_cache_memory_;
 };
 
 // Globally filter points and images in mapper.
@@ -0,0 +1,348 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "controllers/localization_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+#include "base/camera_models.h"
+#include "util/bitmap.h"
+#include "util/logging.h"
+#include "util/misc.h"
+
+namespace colmap {
+namespace {
+
+bool IsWouldBlockError(const boost::system::error_code& error) {
+  return error == boost::asio::error::would_block ||
+         error == boost::asio::error::try_again;
+}
+
+// Reads newline-terminated lines from a non-blocking socket. The socket is
+// polled at a short interval to keep the latency of the requests low, while
+// the server can still be stopped.
+class LineReader {
+ public:
+  LineReader(boost::asio::ip::tcp::socket* socket,
+             const std::function<bool()>& is_stopped)
+      : socket_(socket), is_stopped_(is_stopped) {}
+
+  // Returns false if the connection was closed or the server was stopped.
+  bool ReadLine(std::string* line) {
+    const std::chrono::milliseconds kReadPollInterval(1);
+    size_t pos = buffer_.find('\n');
+    while (pos == std::string::npos) {
+      if (is_stopped_()) {
+        return false;
+      }
+      char buffer[4096];
+      boost::system::error_code error;
+      const size_t num_bytes =
+          socket_->read_some(boost::asio::buffer(buffer), error);
+      if (IsWouldBlockError(error)) {
+        std::this_thread::sleep_for(kReadPollInterval);
+        continue;
+      } else if (error) {
+        return false;
+      }
+      buffer_.append(buffer, num_bytes);
+      pos = buffer_.find('\n');
+    }
+    *line = buffer_.substr(0, pos);
+    buffer_.erase(0, pos + 1);
+    StringTrim(line);
+    return true;
+  }
+
+ private:
+  boost::asio::ip::tcp::socket* socket_;
+  std::function<bool()> is_stopped_;
+  std::string buffer_;
+};
+
+bool WriteLine(boost::asio::ip::tcp::socket* socket, const std::string& line) {
+  boost::system::error_code error;
+  socket->non_blocking(false, error);
+  boost::asio::write(*socket, boost::asio::buffer(line + "\n"), error);
+  socket->non_blocking(true, error);
+  return !error;
+}
+
+bool ReadCamera(std::istringstream* request, Camera* camera,
+                std::string* error) {
+  std::string model_name;
+  size_t width;
+  size_t height;
+  if (!(*request >> model_name >> width >> height)) {
+    *error = "Invalid camera";
+    return false;
+  }
+
+  if (!ExistsCameraModelWithName(model_name)) {
+    *error = "Invalid camera model";
+    return false;
+  }
+
+  camera->SetModelIdFromName(model_name);
+  camera->SetWidth(width);
+  camera->SetHeight(height);
+  for (double& param : camera->Params()) {
+    if (!(*request >> param)) {
+      *error = "Invalid camera parameters";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ReadFeatures(const size_t num_features, LineReader* reader,
+                  FeatureKeypoints* keypoints,
+                  FeatureDescriptors* descriptors) {
+  keypoints->resize(num_features);
+  descriptors->resize(num_features, 128);
+  std::string line;
+  for (size_t i = 0; i < num_features; ++i) {
+    if (!reader->ReadLine(&line)) {
+      return false;
+    }
+    std::istringstream line_stream(line);
+    float x, y, scale, orientation;
+    if (!(line_stream >> x >> y >> scale >> orientation)) {
+      return false;
+    }
+    (*keypoints)[i] = FeatureKeypoint(x, y, scale, orientation);
+    for (int j = 0; j < 128; ++j) {
+      int value;
+      if (!(line_stream >> value) || value < 0 || value > 255) {
+        return false;
+      }
+      (*descriptors)(i, j) = static_cast<uint8_t>(value);
+    }
+  }
+  return true;
+}
+
+bool ExtractFeatures(const SiftExtractionOptions& options,
+                     const std::string& image_path, const Camera& camera,
+                     FeatureKeypoints* keypoints,
+                     FeatureDescriptors* descriptors) {
+  Bitmap bitmap;
+  if (!bitmap.Read(image_path, false)) {
+    return false;
+  }
+
+  if (static_cast<int>(bitmap.Width()) > options.max_image_size ||
+      static_cast<int>(bitmap.Height()) > options.max_image_size) {
+    const double scale = static_cast<double>(options.max_image_size) /
+                         std::max(bitmap.Width(), bitmap.Height());
+    bitmap.Rescale(static_cast<int>(bitmap.Width() * scale),
+                   static_cast<int>(bitmap.Height() * scale));
+  }
+
+  if (!ExtractSiftFeaturesCPU(options, bitmap, keypoints, descriptors)) {
+    return false;
+  }
+
+  // Express the keypoints in the resolution of the query camera.
+  const float scale_x = static_cast<float>(camera.Width()) / bitmap.Width();
+  const float scale_y = static_cast<float>(camera.Height()) / bitmap.Height();
+  if (scale_x != 1.0f || scale_y != 1.0f) {
+    for (auto& keypoint : *keypoints) {
+      keypoint.Rescale(scale_x, scale_y);
+    }
+  }
+
+  return true;
+}
+
+std::string FormatPose(const Eigen::Vector4d& qvec, const Eigen::Vector3d& tvec,
+                       const size_t num_inliers, const Camera& camera,
+                       const bool with_params) {
+  std::ostringstream response;
+  response.precision(17);
+  response << "OK";
+  for (int i = 0; i < 4; ++i) {
+    response << " " << qvec(i);
+  }
+  for (int i = 0; i < 3; ++i) {
+    response << " " << tvec(i);
+  }
+  response << " " << num_inliers;
+  if (with_params) {
+    for (const double param : camera.Params()) {
+      response << " " << param;
+    }
+  }
+  return response.str();
+}
+
+}  // namespace
+
+bool LocalizationServer::Options::Check() const {
+  CHECK_OPTION_GE(port, 0);
+  CHECK_OPTION_NE(num_threads, 0);
+  CHECK_OPTION(localizer.Check());
+  CHECK_OPTION(sift_extraction.Check());
+  return true;
+}
+
+LocalizationServer::LocalizationServer(const Options& options,
+                                       const Localizer* localizer)
+    : options_(options), localizer_(localizer), port_(options.port) {
+  CHECK(options_.Check());
+  CHECK_NOTNULL(localizer_);
+}
+
+int LocalizationServer::Port() const { return port_; }
+
+void LocalizationServer::Run() {
+  using boost::asio::ip::tcp;
+
+  boost::asio::io_service io_service;
+  std::unique_ptr<tcp::acceptor> acceptor;
+  try {
+    acceptor.reset(
+        new tcp::acceptor(io_service, tcp::endpoint(tcp::v4(), port_)));
+    acceptor->non_blocking(true);
+  } catch (const boost::system::system_error& error) {
+    std::cerr << StringPrintf("ERROR: Failed to start localization server on "
+                              "port %d - %s.",
+                              port_.load(), error.what())
+              << std::endl;
+    SignalInvalidSetup();
+    return;
+  }
+
+  port_ = acceptor->local_endpoint().port();
+
+  SignalValidSetup();
+
+  const auto is_stopped = [this]() { return IsStopped(); };
+
+  const auto handle_connection =
+      [this, &is_stopped](const std::shared_ptr<tcp::socket>& socket) {
+        LineReader reader(socket.get(), is_stopped);
+        std::string line;
+        while (reader.ReadLine(&line)) {
+          if (line.empty()) {
+            continue;
+          }
+
+          std::istringstream request(line);
+          std::string command;
+          request >> command;
+
+          std::string error;
+          Camera camera;
+          FeatureKeypoints keypoints;
+          FeatureDescriptors descriptors;
+          if (command != "LOCALIZE_FEATURES" && command != "LOCALIZE_IMAGE") {
+            error = "Unknown command";
+          } else if (!ReadCamera(&request, &camera, &error)) {
+            // The error is set by the camera parser.
+          } else if (command == "LOCALIZE_FEATURES") {
+            size_t num_features;
+            if (!(request >> num_features)) {
+              error = "Invalid number of features";
+            } else if (!ReadFeatures(num_features, &reader, &keypoints,
+                                     &descriptors)) {
+              // The stream cannot be resynchronized with the requests.
+              WriteLine(socket.get(), "FAILED Invalid features");
+              break;
+            }
+          } else {
+            std::string image_path;
+            if (!std::getline(request >> std::ws, image_path)) {
+              error = "Invalid image path";
+            } else if (!ExtractFeatures(options_.sift_extraction, image_path,
+                                        camera, &keypoints, &descriptors)) {
+              error = "Failed to extract features";
+            }
+          }
+
+          std::string response;
+          if (error.empty()) {
+            Eigen::Vector4d qvec;
+            Eigen::Vector3d tvec;
+            size_t num_inliers;
+            if (localizer_->Localize(options_.localizer, keypoints,
+                                     descriptors, &camera, &qvec, &tvec,
+                                     &num_inliers)) {
+              response =
+                  FormatPose(qvec, tvec, num_inliers, camera,
+                             options_.localizer.estimate_focal_length);
+            } else {
+              response = "FAILED Localization failed";
+            }
+          } else {
+            response = "FAILED " + error;
+          }
+
+          if (!WriteLine(socket.get(), response)) {
+            break;
+          }
+        }
+
+        boost::system::error_code error;
+        socket->shutdown(tcp::socket::shutdown_both, error);
+      };
+
+  ThreadPool thread_pool(GetEffectiveNumThreads(options_.num_threads));
+
+  // Poll for connections, such that the server can be stopped.
+  const std::chrono::milliseconds kPollInterval(10);
+  while (!IsStopped()) {
+    std::shared_ptr<tcp::socket> socket(new tcp::socket(io_service));
+    boost::system::error_code error;
+    acceptor->accept(*socket, error);
+    if (IsWouldBlockError(error)) {
+      std::this_thread::sleep_for(kPollInterval);
+      continue;
+    } else if (error) {
+      continue;
+    }
+
+    socket->non_blocking(true, error);
+    socket->set_option(tcp::no_delay(true), error);
+    thread_pool.AddTask(handle_connection, socket);
+  }
+
+  thread_pool.Wait();
+}
+
+}  // namespace colmap
@@ -0,0 +1,91 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_CONTROLLERS_LOCALIZATION_SERVER_H_
+#define COLMAP_SRC_CONTROLLERS_LOCALIZATION_SERVER_H_
+
+#include <atomic>
+
+#include "feature/sift.h"
+#include "sfm/localizer.h"
+#include "util/threading.h"
+
+namespace colmap {
+
+// Long-running server, which localizes query images against a resident
+// reconstruction. The clients connect via TCP and send one request per line,
+// which is answered by a single response line:
+//
+//    LOCALIZE_FEATURES MODEL WIDTH HEIGHT PARAMS[] NUM_FEATURES
+//    X Y SCALE ORIENTATION D_1 ... D_128   (NUM_FEATURES lines)
+//
+//    LOCALIZE_IMAGE MODEL WIDTH HEIGHT PARAMS[] IMAGE_PATH
+//
+// where the image path refers to a file on the server, from which SIFT
+// features are extracted on the CPU. A successful localization is answered by
+//
+//    OK QW QX QY QZ TX TY TZ NUM_INLIERS [PARAMS[]]
+//
+// with the refined camera parameters, if the focal length is estimated, and
+// failures are answered by `FAILED REASON`. Requests on different connections
+// are processed concurrently. If the given port is zero, an arbitrary free
+// port is chosen.
+class LocalizationServer : public Thread {
+ public:
+  struct Options {
+    // The port on which the server listens.
+    int port = 5555;
+
+    // The maximum number of concurrently served connections.
+    int num_threads = -1;
+
+    LocalizerOptions localizer;
+
+    SiftExtractionOptions sift_extraction;
+
+    bool Check() const;
+  };
+
+  LocalizationServer(const Options& options, const Localizer* localizer);
+
+  // The port, on which the server is listening after a valid setup.
+  int Port() const;
+
+ private:
+  void Run() override;
+
+  const Options options_;
+  const Localizer* localizer_;
+  std::atomic<int> port_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_CONTROLLERS_LOCALIZATION_SERVER_H_
@@ -0,0 +1,293 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "controllers/pipeline.h"
+
+#include "base/undistortion.h"
+#include "controllers/incremental_mapper.h"
+#include "feature/extraction.h"
+#include "feature/matching.h"
+#include "mvs/fusion.h"
+#include "mvs/patch_match.h"
+#include "util/misc.h"
+
+namespace colmap {
+
+bool PipelineController::Options::Check() const {
+  CHECK_OPTION(ExistsDir(workspace_path));
+  CHECK_OPTION(!stages.empty());
+  // Every stage must run after the stages it depends on and at most once.
+  for (size_t i = 1; i < stages.size(); ++i) {
+    CHECK_OPTION_LT(static_cast<int>(stages[i - 1]),
+                    static_cast<int>(stages[i]));
+  }
+  CHECK_OPTION(fusion_input_type == "photometric" ||
+               fusion_input_type == "geometric");
+  return true;
+}
+
+bool PipelineController::ParseStages(const std::string& stages_str,
+                                     std::vector<Stage>* stages) {
+  CHECK_NOTNULL(stages);
+  stages->clear();
+  for (const auto& stage_name : CSVToVector<std::string>(stages_str)) {
+    if (stage_name == "feature_extractor") {
+      stages->push_back(Stage::FEATURE_EXTRACTION);
+    } else if (stage_name == "exhaustive_matcher") {
+      stages->push_back(Stage::EXHAUSTIVE_MATCHING);
+    } else if (stage_name == "sequential_matcher") {
+      stages->push_back(Stage::SEQUENTIAL_MATCHING);
+    } else if (stage_name == "vocab_tree_matcher") {
+      stages->push_back(Stage::VOCAB_TREE_MATCHING);
+    } else if (stage_name == "spatial_matcher") {
+      stages->push_back(Stage::SPATIAL_MATCHING);
+    } else if (stage_name == "mapper") {
+      stages->push_back(Stage::MAPPING);
+    } else if (stage_name == "image_undistorter") {
+      stages->push_back(Stage::IMAGE_UNDISTORTION);
+    } else if (stage_name == "patch_match_stereo") {
+      stages->push_back(Stage::PATCH_MATCH_STEREO);
+    } else if (stage_name == "stereo_fusion") {
+      stages->push_back(Stage::STEREO_FUSION);
+    } else {
+      std::cerr << "ERROR: Invalid stage `" << stage_name << "`" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+PipelineController::PipelineController(
+    const Options& options, OptionManager* option_manager,
+    ReconstructionManager* reconstruction_manager)
+    : options_(options),
+      option_manager_(option_manager),
+      reconstruction_manager_(reconstruction_manager),
+      active_thread_(nullptr) {
+  CHECK(options_.Check());
+  CHECK_NOTNULL(option_manager_);
+  CHECK_NOTNULL(reconstruction_manager_);
+
+  if (HasStage(Stage::FEATURE_EXTRACTION)) {
+    ImageReaderOptions reader_options = *option_manager_->image_reader;
+    reader_options.database_path = *option_manager_->database_path;
+    reader_options.image_path = *option_manager_->image_path;
+    feature_extractor_.reset(new SiftFeatureExtractor(
+        reader_options, *option_manager_->sift_extraction));
+  }
+
+  for (const auto stage : options_.stages) {
+    if (stage == Stage::EXHAUSTIVE_MATCHING) {
+      feature_matcher_.reset(new ExhaustiveFeatureMatcher(
+          *option_manager_->exhaustive_matching,
+          *option_manager_->sift_matching, *option_manager_->database_path));
+    } else if (stage == Stage::SEQUENTIAL_MATCHING) {
+      feature_matcher_.reset(new SequentialFeatureMatcher(
+          *option_manager_->sequential_matching,
+          *option_manager_->sift_matching, *option_manager_->database_path));
+    } else if (stage == Stage::VOCAB_TREE_MATCHING) {
+      feature_matcher_.reset(new VocabTreeFeatureMatcher(
+          *option_manager_->vocab_tree_matching,
+          *option_manager_->sift_matching, *option_manager_->database_path));
+    } else if (stage == Stage::SPATIAL_MATCHING) {
+      feature_matcher_.reset(new SpatialFeatureMatcher(
+          *option_manager_->spatial_matching, *option_manager_->sift_matching,
+          *option_manager_->database_path));
+    }
+  }
+}
+
+void PipelineController::Stop() {
+  if (active_thread_ != nullptr) {
+    active_thread_->Stop();
+  }
+  Thread::Stop();
+}
+
+void PipelineController::Run() {
+  for (const auto stage : options_.stages) {
+    if (IsStopped()) {
+      return;
+    }
+
+    switch (stage) {
+      case Stage::FEATURE_EXTRACTION:
+        RunThread(feature_extractor_.get());
+        feature_extractor_.reset();
+        break;
+      case Stage::EXHAUSTIVE_MATCHING:
+      case Stage::SEQUENTIAL_MATCHING:
+      case Stage::VOCAB_TREE_MATCHING:
+      case Stage::SPATIAL_MATCHING:
+        RunThread(feature_matcher_.get());
+        feature_matcher_.reset();
+        break;
+      case Stage::MAPPING:
+        RunMapper();
+        break;
+      case Stage::IMAGE_UNDISTORTION:
+        RunImageUndistortion();
+        break;
+      case Stage::PATCH_MATCH_STEREO:
+        RunPatchMatchStereo();
+        break;
+      case Stage::STEREO_FUSION:
+        RunStereoFusion();
+        break;
+    }
+  }
+
+  GetTimer().PrintMinutes();
+}
+
+bool PipelineController::HasStage(const Stage stage) const {
+  return std::find(options_.stages.begin(), options_.stages.end(), stage) !=
+         options_.stages.end();
+}
+
+void PipelineController::RunThread(Thread* thread) {
+  CHECK_NOTNULL(thread);
+  active_thread_ = thread;
+  thread->Start();
+  thread->Wait();
+  active_thread_ = nullptr;
+}
+
+void PipelineController::RunMapper() {
+  IncrementalMapperController mapper(
+      option_manager_->mapper.get(), *option_manager_->image_path,
+      *option_manager_->database_path, reconstruction_manager_);
+  RunThread(&mapper);
+
+  // The models are only written as the output of the pipeline, while the
+  // following stages use the models in memory.
+  const std::string sparse_path =
+      JoinPaths(options_.workspace_path, "sparse");
+  CreateDirIfNotExists(sparse_path);
+  reconstruction_manager_->Write(sparse_path, option_manager_);
+}
+
+void PipelineController::RunImageUndistortion() {
+  ReadSparseModels();
+
+  UndistortCameraOptions undistortion_options;
+  undistortion_options.max_image_size =
+      option_manager_->patch_match_stereo->max_image_size;
+
+  CreateDirIfNotExists(JoinPaths(options_.workspace_path, "dense"));
+
+  for (size_t i = 0; i < reconstruction_manager_->Size(); ++i) {
+    if (IsStopped()) {
+      return;
+    }
+
+    const std::string dense_path = DensePath(i);
+    CreateDirIfNotExists(dense_path);
+    COLMAPUndistorter undistorter(undistortion_options,
+                                  reconstruction_manager_->Get(i),
+                                  *option_manager_->image_path, dense_path);
+    RunThread(&undistorter);
+  }
+}
+
+void PipelineController::RunPatchMatchStereo() {
+#ifndef CUDA_ENABLED
+  std::cout << std::endl
+            << "WARNING: Skipping patch match stereo because CUDA is not "
+               "available."
+            << std::endl;
+  return;
+#endif  // CUDA_ENABLED
+
+  ReadSparseModels();
+
+  for (size_t i = 0; i < reconstruction_manager_->Size(); ++i) {
+    if (IsStopped()) {
+      return;
+    }
+
+    mvs::PatchMatchController patch_match_controller(
+        *option_manager_->patch_match_stereo, DensePath(i), "COLMAP", "");
+    RunThread(&patch_match_controller);
+  }
+}
+
+void PipelineController::RunStereoFusion() {
+  ReadSparseModels();
+
+  for (size_t i = 0; i < reconstruction_manager_->Size(); ++i) {
+    if (IsStopped()) {
+      return;
+    }
+
+    auto fusion_options = *option_manager_->stereo_fusion;
+    const int num_reg_images = reconstruction_manager_->Get(i).NumRegImages();
+    fusion_options.min_num_pixels =
+        std::min(num_reg_images + 1, fusion_options.min_num_pixels);
+
+    const std::string dense_path = DensePath(i);
+    mvs::StereoFusion fuser(fusion_options, dense_path, "COLMAP", "",
+                            options_.fusion_input_type);
+
+    const std::string fused_path = JoinPaths(dense_path, "fused.ply");
+    std::cout << "Writing output: " << fused_path << std::endl;
+    mvs::FusedPointsWriter writer(fused_path);
+    fuser.SetFusedPointsWriter(&writer);
+
+    RunThread(&fuser);
+
+    writer.Close();
+  }
+}
+
+void PipelineController::ReadSparseModels() {
+  if (reconstruction_manager_->Size() > 0 || HasStage(Stage::MAPPING)) {
+    return;
+  }
+
+  const std::string sparse_path =
+      JoinPaths(options_.workspace_path, "sparse");
+  CHECK(ExistsDir(sparse_path))
+      << "The sparse models must be reconstructed by the mapper stage or "
+         "exist in the workspace";
+  auto dir_list = GetDirList(sparse_path);
+  std::sort(dir_list.begin(), dir_list.end());
+  for (const auto& dir : dir_list) {
+    reconstruction_manager_->Read(dir);
+  }
+}
+
+std::string PipelineController::DensePath(
+    const size_t reconstruction_idx) const {
+  return JoinPaths(options_.workspace_path, "dense",
+                   std::to_string(reconstruction_idx));
+}
+
+}  // namespace colmap
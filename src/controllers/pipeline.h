@@ -0,0 +1,117 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_CONTROLLERS_PIPELINE_H_
+#define COLMAP_SRC_CONTROLLERS_PIPELINE_H_
+
+#include <string>
+#include <vector>
+
+#include "base/reconstruction_manager.h"
+#include "util/option_manager.h"
+#include "util/threading.h"
+
+namespace colmap {
+
+// Run a sequence of reconstruction stages in a single process. In contrast to
+// running the stages as separate commands, the sparse models stay in memory
+// between the mapper and the following stages instead of being written to and
+// read from disk, and the database is only written by the stages that produce
+// new data. The stages must be declared in their order of dependencies.
+class PipelineController : public Thread {
+ public:
+  enum class Stage {
+    FEATURE_EXTRACTION,
+    EXHAUSTIVE_MATCHING,
+    SEQUENTIAL_MATCHING,
+    VOCAB_TREE_MATCHING,
+    SPATIAL_MATCHING,
+    MAPPING,
+    IMAGE_UNDISTORTION,
+    PATCH_MATCH_STEREO,
+    STEREO_FUSION,
+  };
+
+  struct Options {
+    // The path to the workspace folder, in which the sparse models are stored
+    // in the "sparse" and the dense models in the "dense" sub-folder.
+    std::string workspace_path;
+
+    // The stages to run in the given order.
+    std::vector<Stage> stages;
+
+    // The input type of the stereo fusion.
+    std::string fusion_input_type = "geometric";
+
+    bool Check() const;
+  };
+
+  // Parse the stages from a comma-separated list of the names of the
+  // corresponding commands, e.g., "feature_extractor,exhaustive_matcher".
+  static bool ParseStages(const std::string& stages_str,
+                          std::vector<Stage>* stages);
+
+  // The option manager must provide the database and image paths and the
+  // options of all stages.
+  PipelineController(const Options& options, OptionManager* option_manager,
+                     ReconstructionManager* reconstruction_manager);
+
+  void Stop() override;
+
+ private:
+  void Run() override;
+
+  bool HasStage(const Stage stage) const;
+
+  void RunThread(Thread* thread);
+  void RunMapper();
+  void RunImageUndistortion();
+  void RunPatchMatchStereo();
+  void RunStereoFusion();
+
+  // Load the sparse models from the workspace, if they were not reconstructed
+  // by the mapper in this pipeline.
+  void ReadSparseModels();
+
+  std::string DensePath(const size_t reconstruction_idx) const;
+
+  const Options options_;
+  OptionManager* option_manager_;
+  ReconstructionManager* reconstruction_manager_;
+  Thread* active_thread_;
+
+  // Stages that use OpenGL must be created in the main thread.
+  std::unique_ptr<Thread> feature_extractor_;
+  std::unique_ptr<Thread> feature_matcher_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_CONTROLLERS_PIPELINE_H_
@@ -31,6 +31,8 @@
 
 #include "estimators/absolute_pose.h"
 
+#include <algorithm>
+
 #include "base/polynomial.h"
 #include "estimators/utils.h"
 #include "util/logging.h"
@@ -49,6 +51,22 @@ std::vector<P3PEstimator::M_t> P3PEstimator::Estimate(
   CHECK_EQ(points2D.size(), 3);
   CHECK_EQ(points3D.size(), 3);
 
+  std::array<X_t, kMinNumSamples> points2D_array;
+  std::array<Y_t, kMinNumSamples> points3D_array;
+  std::copy(points2D.begin(), points2D.end(), points2D_array.begin());
+  std::copy(points3D.begin(), points3D.end(), points3D_array.begin());
+
+  std::array<M_t, kMaxNumModels> models;
+  const size_t num_models =
+      EstimateMinimal(points2D_array, points3D_array, &models);
+
+  return std::vector<M_t>(models.begin(), models.begin() + num_models);
+}
+
+size_t P3PEstimator::EstimateMinimal(
+    const std::array<X_t, kMinNumSamples>& points2D,
+    const std::array<Y_t, kMinNumSamples>& points3D,
+    std::array<M_t, kMaxNumModels>* models) {
   Eigen::Matrix3d points3D_world;
   points3D_world.col(0) = points3D[0];
   points3D_world.col(1) = points3D[1];
@@ -98,21 +116,15 @@ std::vector<P3PEstimator::M_t> P3PEstimator::Estimate(
               (p * r + q * p2 - 2 * q) * b + (r * p + 2 * q) * a * b - 2 * q;
   coeffs(4) = a2 + b2 - 2 * a + (2 - p2) * b - 2 * a * b + 1;
 
-  Eigen::VectorXd roots_real;
-  Eigen::VectorXd roots_imag;
-  if (!FindPolynomialRootsCompanionMatrix(coeffs, &roots_real, &roots_imag)) {
-    return std::vector<P3PEstimator::M_t>({});
+  Eigen::Vector4d roots_real;
+  int num_roots = 0;
+  if (!FindRealQuarticPolynomialRoots(coeffs, &roots_real, &num_roots)) {
+    return 0;
   }
 
-  std::vector<M_t> models;
-  models.reserve(roots_real.size());
-
-  for (Eigen::VectorXd::Index i = 0; i < roots_real.size(); ++i) {
-    const double kMaxRootImag = 1e-10;
-    if (std::abs(roots_imag(i)) > kMaxRootImag) {
-      continue;
-    }
+  size_t num_models = 0;
 
+  for (int i = 0; i < num_roots; ++i) {
     const double x = roots_real(i);
     if (x < 0) {
       continue;
@@ -167,10 +179,11 @@ std::vector<P3PEstimator::M_t> P3PEstimator::Estimate(
     // Find transformation from the world to the camera system.
     const Eigen::Matrix4d transform =
         Eigen::umeyama(points3D_world, points3D_camera, false);
-    models.push_back(transform.topLeftCorner<3, 4>());
+    (*models)[num_models] = transform.topLeftCorner<3, 4>();
+    num_models += 1;
   }
 
-  return models;
+  return num_models;
 }
 
 void P3PEstimator::Residuals(const std::vector<X_t>& points2D,
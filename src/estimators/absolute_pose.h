@@ -61,6 +61,9 @@ class P3PEstimator {
   // The minimum number of samples needed to estimate a model.
   static const int kMinNumSamples = 3;
 
+  // The maximum number of models estimated from a minimal sample.
+  static const int kMaxNumModels = 4;
+
   // Estimate the most probable solution of the P3P problem from a set of
   // three 2D-3D point correspondences.
   //
@@ -71,6 +74,13 @@ class P3PEstimator {
   static std::vector<M_t> Estimate(const std::vector<X_t>& points2D,
                                    const std::vector<Y_t>& points3D);
 
+  // Allocation-free variant of `Estimate` used in the hypothesis loop of
+  // RANSAC. Returns the number of poses written to `models`.
+  static size_t EstimateMinimal(
+      const std::array<X_t, kMinNumSamples>& points2D,
+      const std::array<Y_t, kMinNumSamples>& points3D,
+      std::array<M_t, kMaxNumModels>* models);
+
   // Calculate the squared reprojection error given a set of 2D-3D point
   // correspondences and a projection matrix.
   //
@@ -0,0 +1,204 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "estimators/absolute_pose_cuda.h"
+
+#include <cfloat>
+
+#include "util/cudacc.h"
+#include "util/logging.h"
+
+namespace colmap {
+namespace {
+
+const int kBlockSize = 256;
+
+// Note that the residual is computed with the same expressions as the CPU
+// implementation in estimators/utils.cc.
+__device__ double ComputeSquaredReprojectionError(const double* P,
+                                                  const double x_0,
+                                                  const double x_1,
+                                                  const double X_0,
+                                                  const double X_1,
+                                                  const double X_2) {
+  // The matrix is stored in column-major order.
+  const double px_2 = P[2] * X_0 + P[5] * X_1 + P[8] * X_2 + P[11];
+
+  // Check if 3D point is in front of camera.
+  if (px_2 > DBL_EPSILON) {
+    const double px_0 = P[0] * X_0 + P[3] * X_1 + P[6] * X_2 + P[9];
+    const double px_1 = P[1] * X_0 + P[4] * X_1 + P[7] * X_2 + P[10];
+
+    const double inv_px_2 = 1.0 / px_2;
+    const double dx_0 = x_0 - px_0 * inv_px_2;
+    const double dx_1 = x_1 - px_1 * inv_px_2;
+
+    return dx_0 * dx_0 + dx_1 * dx_1;
+  } else {
+    return DBL_MAX;
+  }
+}
+
+// Each block evaluates one model, where the threads of the block iterate over
+// the correspondences and the per-thread supports are reduced in shared
+// memory.
+__global__ void EvaluateModelsKernel(const double* points2D,
+                                     const double* points3D,
+                                     const int num_points,
+                                     const double* models,
+                                     const double max_residual,
+                                     int* num_inliers, double* residual_sums) {
+  __shared__ double model[12];
+  __shared__ int block_num_inliers[kBlockSize];
+  __shared__ double block_residual_sums[kBlockSize];
+
+  if (threadIdx.x < 12) {
+    model[threadIdx.x] = models[12 * blockIdx.x + threadIdx.x];
+  }
+  __syncthreads();
+
+  int thread_num_inliers = 0;
+  double thread_residual_sum = 0;
+  for (int i = threadIdx.x; i < num_points; i += blockDim.x) {
+    const double residual = ComputeSquaredReprojectionError(
+        model, points2D[2 * i + 0], points2D[2 * i + 1], points3D[3 * i + 0],
+        points3D[3 * i + 1], points3D[3 * i + 2]);
+    if (residual <= max_residual) {
+      thread_num_inliers += 1;
+      thread_residual_sum += residual;
+    }
+  }
+
+  block_num_inliers[threadIdx.x] = thread_num_inliers;
+  block_residual_sums[threadIdx.x] = thread_residual_sum;
+  __syncthreads();
+
+  for (int stride = blockDim.x / 2; stride > 0; stride /= 2) {
+    if (threadIdx.x < stride) {
+      block_num_inliers[threadIdx.x] += block_num_inliers[threadIdx.x + stride];
+      block_residual_sums[threadIdx.x] +=
+          block_residual_sums[threadIdx.x + stride];
+    }
+    __syncthreads();
+  }
+
+  if (threadIdx.x == 0) {
+    num_inliers[blockIdx.x] = block_num_inliers[0];
+    residual_sums[blockIdx.x] = block_residual_sums[0];
+  }
+}
+
+}  // namespace
+
+void EvaluateAbsolutePoseModelsCUDA(
+    const std::vector<Eigen::Vector2d>& points2D,
+    const std::vector<Eigen::Vector3d>& points3D,
+    const std::vector<Eigen::Matrix3x4d>& models, const double max_residual,
+    std::vector<InlierSupportMeasurer::Support>* supports) {
+  CHECK_EQ(points2D.size(), points3D.size());
+  CHECK_NOTNULL(supports);
+
+  supports->clear();
+  if (models.empty()) {
+    return;
+  }
+
+  const int num_points = static_cast<int>(points2D.size());
+  const int num_models = static_cast<int>(models.size());
+
+  // Pack the points and models contiguously, since the points may be padded
+  // and the models are not necessarily stored contiguously.
+  std::vector<double> host_points(5 * num_points);
+  for (int i = 0; i < num_points; ++i) {
+    host_points[2 * i + 0] = points2D[i](0);
+    host_points[2 * i + 1] = points2D[i](1);
+    host_points[2 * num_points + 3 * i + 0] = points3D[i](0);
+    host_points[2 * num_points + 3 * i + 1] = points3D[i](1);
+    host_points[2 * num_points + 3 * i + 2] = points3D[i](2);
+  }
+
+  std::vector<double> host_models(12 * num_models);
+  for (int i = 0; i < num_models; ++i) {
+    Eigen::Map<Eigen::Matrix3x4d>(host_models.data() + 12 * i) = models[i];
+  }
+
+  // Each calling thread uses its own stream, such that the evaluations of
+  // concurrently registered images overlap on the device.
+  cudaStream_t stream;
+  CUDA_SAFE_CALL(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+
+  double* points_device;
+  double* models_device;
+  int* num_inliers_device;
+  double* residual_sums_device;
+  CUDA_SAFE_CALL(
+      cudaMalloc(&points_device, host_points.size() * sizeof(double)));
+  CUDA_SAFE_CALL(
+      cudaMalloc(&models_device, host_models.size() * sizeof(double)));
+  CUDA_SAFE_CALL(cudaMalloc(&num_inliers_device, num_models * sizeof(int)));
+  CUDA_SAFE_CALL(
+      cudaMalloc(&residual_sums_device, num_models * sizeof(double)));
+
+  CUDA_SAFE_CALL(cudaMemcpyAsync(points_device, host_points.data(),
+                                 host_points.size() * sizeof(double),
+                                 cudaMemcpyHostToDevice, stream));
+  CUDA_SAFE_CALL(cudaMemcpyAsync(models_device, host_models.data(),
+                                 host_models.size() * sizeof(double),
+                                 cudaMemcpyHostToDevice, stream));
+
+  EvaluateModelsKernel<<<num_models, kBlockSize, 0, stream>>>(
+      points_device, points_device + 2 * num_points, num_points, models_device,
+      max_residual, num_inliers_device, residual_sums_device);
+  CUDA_CHECK();
+
+  std::vector<int> num_inliers(num_models);
+  std::vector<double> residual_sums(num_models);
+  CUDA_SAFE_CALL(cudaMemcpyAsync(num_inliers.data(), num_inliers_device,
+                                 num_models * sizeof(int),
+                                 cudaMemcpyDeviceToHost, stream));
+  CUDA_SAFE_CALL(cudaMemcpyAsync(residual_sums.data(), residual_sums_device,
+                                 num_models * sizeof(double),
+                                 cudaMemcpyDeviceToHost, stream));
+  CUDA_SAFE_CALL(cudaStreamSynchronize(stream));
+
+  CUDA_SAFE_CALL(cudaFree(points_device));
+  CUDA_SAFE_CALL(cudaFree(models_device));
+  CUDA_SAFE_CALL(cudaFree(num_inliers_device));
+  CUDA_SAFE_CALL(cudaFree(residual_sums_device));
+  CUDA_SAFE_CALL(cudaStreamDestroy(stream));
+
+  supports->resize(num_models);
+  for (int i = 0; i < num_models; ++i) {
+    (*supports)[i].num_inliers = static_cast<size_t>(num_inliers[i]);
+    (*supports)[i].residual_sum = residual_sums[i];
+  }
+}
+
+}  // namespace colmap
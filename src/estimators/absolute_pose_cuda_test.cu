@@ -0,0 +1,74 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "estimators/absolute_pose_cuda_test"
+#include "util/testing.h"
+
+#include "estimators/absolute_pose_cuda.h"
+#include "estimators/utils.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestEvaluateAbsolutePoseModels) {
+  std::vector<Eigen::Vector2d> points2D;
+  std::vector<Eigen::Vector3d> points3D;
+  for (size_t i = 0; i < 1000; ++i) {
+    points2D.push_back(Eigen::Vector2d::Random());
+    points3D.push_back(Eigen::Vector3d::Random());
+  }
+
+  std::vector<Eigen::Matrix3x4d> models;
+  for (size_t i = 0; i < 10; ++i) {
+    models.push_back(Eigen::Matrix3x4d::Random());
+    models.back()(2, 3) = 2;
+  }
+
+  const double kMaxResidual = 0.1;
+
+  std::vector<InlierSupportMeasurer::Support> supports;
+  EvaluateAbsolutePoseModelsCUDA(points2D, points3D, models, kMaxResidual,
+                                 &supports);
+  BOOST_REQUIRE_EQUAL(supports.size(), models.size());
+
+  for (size_t i = 0; i < models.size(); ++i) {
+    std::vector<double> residuals;
+    ComputeSquaredReprojectionError(points2D, points3D, models[i], &residuals);
+    const auto support =
+        InlierSupportMeasurer().Evaluate(residuals, kMaxResidual);
+    BOOST_CHECK_EQUAL(supports[i].num_inliers, support.num_inliers);
+    BOOST_CHECK_CLOSE(supports[i].residual_sum, support.residual_sum, 1e-6);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestEmpty) {
+  std::vector<InlierSupportMeasurer::Support> supports(1);
+  EvaluateAbsolutePoseModelsCUDA({}, {}, {}, 1, &supports);
+  BOOST_CHECK(supports.empty());
+}
@@ -32,6 +32,8 @@
 #define TEST_NAME "base/absolute_pose"
 #include "util/testing.h"
 
+#include <array>
+
 #include <Eigen/Core>
 
 #include "base/pose.h"
@@ -103,6 +105,45 @@ BOOST_AUTO_TEST_CASE(TestP3P) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestP3PMinimal) {
+  std::array<Eigen::Vector3d, P3PEstimator::kMinNumSamples> points3D;
+  points3D[0] = Eigen::Vector3d(1, 1, 1);
+  points3D[1] = Eigen::Vector3d(0, 1, 1);
+  points3D[2] = Eigen::Vector3d(3, 1.2, 4);
+
+  const SimilarityTransform3 orig_tform(1, Eigen::Vector4d(1, 0.2, 0, 0),
+                                        Eigen::Vector3d(0.3, 0, 0));
+
+  std::array<Eigen::Vector2d, P3PEstimator::kMinNumSamples> points2D;
+  for (size_t i = 0; i < points3D.size(); ++i) {
+    Eigen::Vector3d point3D_camera = points3D[i];
+    orig_tform.TransformPoint(&point3D_camera);
+    points2D[i] = point3D_camera.hnormalized();
+  }
+
+  std::array<P3PEstimator::M_t, P3PEstimator::kMaxNumModels> models;
+  const size_t num_models =
+      P3PEstimator::EstimateMinimal(points2D, points3D, &models);
+
+  const std::vector<P3PEstimator::M_t> ref_models = P3PEstimator::Estimate(
+      std::vector<P3PEstimator::X_t>(points2D.begin(), points2D.end()),
+      std::vector<P3PEstimator::Y_t>(points3D.begin(), points3D.end()));
+
+  BOOST_CHECK_EQUAL(num_models, ref_models.size());
+  for (size_t i = 0; i < std::min(num_models, ref_models.size()); ++i) {
+    BOOST_CHECK_LT((models[i] - ref_models[i]).norm(), 1e-10);
+  }
+
+  bool found_model = false;
+  for (size_t i = 0; i < num_models; ++i) {
+    if ((orig_tform.Matrix().topLeftCorner<3, 4>() - models[i]).norm() <
+        1e-6) {
+      found_model = true;
+    }
+  }
+  BOOST_CHECK(found_model);
+}
+
 BOOST_AUTO_TEST_CASE(TestEPNP) {
   SetPRNGSeed(0);
 
@@ -38,6 +38,8 @@
 #include "optim/ransac.h"
 #include "util/logging.h"
 #include "util/misc.h"
+#include "util/random.h"
+#include "util/threading.h"
 
 namespace colmap {
 namespace {
@@ -139,6 +141,138 @@ Eigen::Vector3d FindBestConsensusAxis(const std::vector<Eigen::Vector3d>& axes,
   return best_axis;
 }
 
+// Normalize the axis to unit length or return zero if it is undetermined.
+Eigen::Vector3d NormalizeAxis(const Eigen::Vector3d& axis) {
+  if (axis.isZero()) {
+    return Eigen::Vector3d::Zero();
+  }
+  return axis.normalized();
+}
+
+// Check whether the axis changed by at most the given cosine distance. An axis
+// that is undetermined in both estimates is considered converged.
+bool HasAxisConverged(const Eigen::Vector3d& prev_axis,
+                      const Eigen::Vector3d& axis,
+                      const double max_axis_change) {
+  if (prev_axis.isZero() || axis.isZero()) {
+    return prev_axis.isZero() && axis.isZero();
+  }
+  return 1 - prev_axis.dot(axis) <= max_axis_change;
+}
+
+struct ImageAxes {
+  // The detected line statistics for logging.
+  int num_lines = 0;
+  int num_horizontal_lines = 0;
+  int num_vertical_lines = 0;
+  int num_horizontal_inliers = 0;
+  int num_vertical_inliers = 0;
+
+  // The horizontal vanishing direction in world coordinates. Its sign is not
+  // yet consistent with the axes of the other images.
+  bool has_horizontal_axis = false;
+  Eigen::Vector3d horizontal_axis = Eigen::Vector3d::Zero();
+
+  // The downward vanishing direction in world coordinates.
+  bool has_vertical_axis = false;
+  Eigen::Vector3d vertical_axis = Eigen::Vector3d::Zero();
+};
+
+// Read and undistort a single image, detect its line segments, and estimate
+// the horizontal and vertical vanishing directions. Safe to call concurrently.
+ImageAxes EstimateImageAxes(
+    const ManhattanWorldFrameEstimationOptions& options,
+    const Reconstruction& reconstruction, const image_t image_id,
+    const std::string& image_path) {
+  const auto& image = reconstruction.Image(image_id);
+  const auto& camera = reconstruction.Camera(image.CameraId());
+
+  ImageAxes image_axes;
+
+  Bitmap bitmap;
+  CHECK(bitmap.Read(JoinPaths(image_path, image.Name())));
+
+  UndistortCameraOptions undistortion_options;
+  undistortion_options.max_image_size = options.max_image_size;
+
+  Bitmap undistorted_bitmap;
+  Camera undistorted_camera;
+  UndistortImage(undistortion_options, bitmap, camera, &undistorted_bitmap,
+                 &undistorted_camera);
+
+  // Release the full resolution image before the line detection.
+  bitmap.Deallocate();
+
+  const std::vector<LineSegment> line_segments =
+      DetectLineSegments(undistorted_bitmap, options.min_line_length);
+  const std::vector<LineSegmentOrientation> line_orientations =
+      ClassifyLineSegmentOrientations(line_segments,
+                                      options.line_orientation_tolerance);
+
+  std::vector<LineSegment> horizontal_line_segments;
+  std::vector<LineSegment> vertical_line_segments;
+  std::vector<Eigen::Vector3d> horizontal_lines;
+  std::vector<Eigen::Vector3d> vertical_lines;
+  for (size_t i = 0; i < line_segments.size(); ++i) {
+    const auto line_segment = line_segments[i];
+    const Eigen::Vector3d line_segment_start = line_segment.start.homogeneous();
+    const Eigen::Vector3d line_segment_end = line_segment.end.homogeneous();
+    const Eigen::Vector3d line = line_segment_start.cross(line_segment_end);
+    if (line_orientations[i] == LineSegmentOrientation::HORIZONTAL) {
+      horizontal_line_segments.push_back(line_segment);
+      horizontal_lines.push_back(line);
+    } else if (line_orientations[i] == LineSegmentOrientation::VERTICAL) {
+      vertical_line_segments.push_back(line_segment);
+      vertical_lines.push_back(line);
+    }
+  }
+
+  image_axes.num_lines = static_cast<int>(line_segments.size());
+  image_axes.num_horizontal_lines = static_cast<int>(horizontal_lines.size());
+  image_axes.num_vertical_lines = static_cast<int>(vertical_lines.size());
+
+  RANSACOptions ransac_options;
+  ransac_options.max_error = options.max_line_vp_distance;
+  RANSAC<VanishingPointEstimator> ransac(ransac_options);
+  const auto horizontal_report =
+      ransac.Estimate(horizontal_line_segments, horizontal_lines);
+  const auto vertical_report =
+      ransac.Estimate(vertical_line_segments, vertical_lines);
+
+  image_axes.num_horizontal_inliers =
+      static_cast<int>(horizontal_report.support.num_inliers);
+  image_axes.num_vertical_inliers =
+      static_cast<int>(vertical_report.support.num_inliers);
+
+  const Eigen::Matrix3d inv_calib_matrix =
+      undistorted_camera.CalibrationMatrix().inverse();
+  const Eigen::Vector4d inv_qvec = InvertQuaternion(image.Qvec());
+
+  if (horizontal_report.success) {
+    const Eigen::Vector3d horizontal_camera_axis =
+        (inv_calib_matrix * horizontal_report.model).normalized();
+    image_axes.has_horizontal_axis = true;
+    image_axes.horizontal_axis =
+        QuaternionRotatePoint(inv_qvec, horizontal_camera_axis).normalized();
+  }
+
+  if (vertical_report.success) {
+    const Eigen::Vector3d vertical_camera_axis =
+        (inv_calib_matrix * vertical_report.model).normalized();
+    Eigen::Vector3d vertical_axis =
+        QuaternionRotatePoint(inv_qvec, vertical_camera_axis).normalized();
+    // Make sure axis points downwards in the image, assuming that the image
+    // was taken in upright orientation.
+    if (vertical_camera_axis.dot(Eigen::Vector3d(0, 1, 0)) < 0) {
+      vertical_axis = -vertical_axis;
+    }
+    image_axes.has_vertical_axis = true;
+    image_axes.vertical_axis = vertical_axis;
+  }
+
+  return image_axes;
+}
+
 }  // namespace
 
 Eigen::Vector3d EstimateGravityVectorFromImageOrientation(
@@ -156,112 +290,98 @@ Eigen::Vector3d EstimateGravityVectorFromImageOrientation(
 Eigen::Matrix3d EstimateManhattanWorldFrame(
     const ManhattanWorldFrameEstimationOptions& options,
     const Reconstruction& reconstruction, const std::string& image_path) {
+  CHECK_GT(options.num_images_per_batch, 0);
+  CHECK_GE(options.max_axis_change, 0);
+
+  std::vector<image_t> image_ids = reconstruction.RegImageIds();
+  const bool early_stopping = options.max_axis_change > 0;
+  if (options.max_num_images >= 0 &&
+      static_cast<size_t>(options.max_num_images) < image_ids.size()) {
+    Shuffle(static_cast<uint32_t>(options.max_num_images), &image_ids);
+    image_ids.resize(options.max_num_images);
+  } else if (early_stopping) {
+    // Process the images in random order so that every batch is an unbiased
+    // sample of the scene and early stopping does not depend on image order.
+    Shuffle(static_cast<uint32_t>(image_ids.size()), &image_ids);
+  }
+
+  ThreadPool thread_pool(GetEffectiveNumThreads(options.num_threads));
+
   std::vector<Eigen::Vector3d> rightward_axes;
   std::vector<Eigen::Vector3d> downward_axes;
-  for (size_t i = 0; i < reconstruction.NumRegImages(); ++i) {
-    const auto image_id = reconstruction.RegImageIds()[i];
-    const auto& image = reconstruction.Image(image_id);
-    const auto& camera = reconstruction.Camera(image.CameraId());
-
-    PrintHeading1(StringPrintf("Processing image %s (%d / %d)",
-                               image.Name().c_str(), i + 1,
-                               reconstruction.NumRegImages()));
-
-    std::cout << "Reading image..." << std::endl;
-
-    colmap::Bitmap bitmap;
-    CHECK(bitmap.Read(colmap::JoinPaths(image_path, image.Name())));
-
-    std::cout << "Undistorting image..." << std::endl;
-
-    UndistortCameraOptions undistortion_options;
-    undistortion_options.max_image_size = options.max_image_size;
-
-    Bitmap undistorted_bitmap;
-    Camera undistorted_camera;
-    UndistortImage(undistortion_options, bitmap, camera, &undistorted_bitmap,
-                   &undistorted_camera);
-
-    std::cout << "Detecting lines...";
-
-    const std::vector<LineSegment> line_segments =
-        DetectLineSegments(undistorted_bitmap, options.min_line_length);
-    const std::vector<LineSegmentOrientation> line_orientations =
-        ClassifyLineSegmentOrientations(line_segments,
-                                        options.line_orientation_tolerance);
-
-    std::cout << StringPrintf(" %d", line_segments.size());
-
-    std::vector<LineSegment> horizontal_line_segments;
-    std::vector<LineSegment> vertical_line_segments;
-    std::vector<Eigen::Vector3d> horizontal_lines;
-    std::vector<Eigen::Vector3d> vertical_lines;
-    for (size_t i = 0; i < line_segments.size(); ++i) {
-      const auto line_segment = line_segments[i];
-      const Eigen::Vector3d line_segment_start =
-          line_segment.start.homogeneous();
-      const Eigen::Vector3d line_segment_end = line_segment.end.homogeneous();
-      const Eigen::Vector3d line = line_segment_start.cross(line_segment_end);
-      if (line_orientations[i] == LineSegmentOrientation::HORIZONTAL) {
-        horizontal_line_segments.push_back(line_segment);
-        horizontal_lines.push_back(line);
-      } else if (line_orientations[i] == LineSegmentOrientation::VERTICAL) {
-        vertical_line_segments.push_back(line_segment);
-        vertical_lines.push_back(line);
-      }
+  Eigen::Vector3d prev_rightward_axis = Eigen::Vector3d::Zero();
+  Eigen::Vector3d prev_downward_axis = Eigen::Vector3d::Zero();
+
+  for (size_t batch_begin = 0; batch_begin < image_ids.size();
+       batch_begin += options.num_images_per_batch) {
+    const size_t batch_end =
+        std::min(image_ids.size(), batch_begin + options.num_images_per_batch);
+
+    // Submit only one batch at a time to bound the number of pending images.
+    std::vector<std::future<ImageAxes>> futures;
+    futures.reserve(batch_end - batch_begin);
+    for (size_t i = batch_begin; i < batch_end; ++i) {
+      futures.push_back(thread_pool.AddTask(EstimateImageAxes, options,
+                                            std::cref(reconstruction),
+                                            image_ids[i], image_path));
     }
 
-    std::cout << StringPrintf(" (%d horizontal, %d vertical)",
-                              horizontal_lines.size(), vertical_lines.size())
-              << std::endl;
-
-    std::cout << "Estimating vanishing points...";
-
-    RANSACOptions ransac_options;
-    ransac_options.max_error = options.max_line_vp_distance;
-    RANSAC<VanishingPointEstimator> ransac(ransac_options);
-    const auto horizontal_report =
-        ransac.Estimate(horizontal_line_segments, horizontal_lines);
-    const auto vertical_report =
-        ransac.Estimate(vertical_line_segments, vertical_lines);
-
-    std::cout << StringPrintf(" (%d horizontal inliers, %d vertical inliers)",
-                              horizontal_report.support.num_inliers,
-                              vertical_report.support.num_inliers)
-              << std::endl;
-
-    std::cout << "Composing coordinate axes..." << std::endl;
-
-    const Eigen::Matrix3d inv_calib_matrix =
-        undistorted_camera.CalibrationMatrix().inverse();
-    const Eigen::Vector4d inv_qvec = InvertQuaternion(image.Qvec());
-
-    if (horizontal_report.success) {
-      const Eigen::Vector3d horizontal_camera_axis =
-          (inv_calib_matrix * horizontal_report.model).normalized();
-      Eigen::Vector3d horizontal_axis =
-          QuaternionRotatePoint(inv_qvec, horizontal_camera_axis).normalized();
-      // Make sure all axes point into the same direction.
-      if (rightward_axes.size() > 0 &&
-          rightward_axes[0].dot(horizontal_axis) < 0) {
-        horizontal_axis = -horizontal_axis;
+    for (size_t i = batch_begin; i < batch_end; ++i) {
+      const ImageAxes image_axes = futures[i - batch_begin].get();
+      const auto& image = reconstruction.Image(image_ids[i]);
+
+      std::cout << StringPrintf(
+                       "Processed image %s (%d / %d): %d lines (%d "
+                       "horizontal, %d vertical), %d horizontal inliers, %d "
+                       "vertical inliers",
+                       image.Name().c_str(), i + 1, image_ids.size(),
+                       image_axes.num_lines, image_axes.num_horizontal_lines,
+                       image_axes.num_vertical_lines,
+                       image_axes.num_horizontal_inliers,
+                       image_axes.num_vertical_inliers)
+                << std::endl;
+
+      if (image_axes.has_horizontal_axis) {
+        Eigen::Vector3d horizontal_axis = image_axes.horizontal_axis;
+        // Make sure all axes point into the same direction.
+        if (rightward_axes.size() > 0 &&
+            rightward_axes[0].dot(horizontal_axis) < 0) {
+          horizontal_axis = -horizontal_axis;
+        }
+        rightward_axes.push_back(horizontal_axis);
+        std::cout << "  Horizontal: " << horizontal_axis.transpose()
+                  << std::endl;
       }
-      rightward_axes.push_back(horizontal_axis);
-      std::cout << "  Horizontal: " << horizontal_axis.transpose() << std::endl;
-    }
 
-    if (vertical_report.success) {
-      const Eigen::Vector3d vertical_camera_axis =
-          (inv_calib_matrix * vertical_report.model).normalized();
-      Eigen::Vector3d vertical_axis =
-          QuaternionRotatePoint(inv_qvec, vertical_camera_axis).normalized();
-      // Make sure axis points downwards in the image, assuming that the image
-      // was taken in upright orientation.
-      if (vertical_camera_axis.dot(Eigen::Vector3d(0, 1, 0)) < 0) {
-        vertical_axis = -vertical_axis;
+      if (image_axes.has_vertical_axis) {
+        downward_axes.push_back(image_axes.vertical_axis);
+        std::cout << "  Vertical: " << image_axes.vertical_axis.transpose()
+                  << std::endl;
       }
-      downward_axes.push_back(vertical_axis);
-      std::cout << "  Vertical: " << vertical_axis.transpose() << std::endl;
+    }
+
+    if (!early_stopping || batch_end == image_ids.size()) {
+      continue;
+    }
+
+    const Eigen::Vector3d rightward_axis = NormalizeAxis(
+        FindBestConsensusAxis(rightward_axes, options.max_axis_distance));
+    const Eigen::Vector3d downward_axis = NormalizeAxis(
+        FindBestConsensusAxis(downward_axes, options.max_axis_distance));
+    const bool converged =
+        HasAxisConverged(prev_rightward_axis, rightward_axis,
+                         options.max_axis_change) &&
+        HasAxisConverged(prev_downward_axis, downward_axis,
+                         options.max_axis_change) &&
+        (!rightward_axis.isZero() || !downward_axis.isZero());
+    prev_rightward_axis = rightward_axis;
+    prev_downward_axis = downward_axis;
+
+    if (converged) {
+      std::cout << StringPrintf("Axes converged after %d / %d images",
+                                batch_end, image_ids.size())
+                << std::endl;
+      break;
     }
   }
 
@@ -49,6 +49,15 @@ struct ManhattanWorldFrameEstimationOptions {
   double max_line_vp_distance = 0.5;
   // The maximum cosine distance between estimated axes to be inliers.
   double max_axis_distance = 0.05;
+  // The number of threads for reading images and detecting lines.
+  int num_threads = -1;
+  // The maximum number of randomly sampled images, all images if -1.
+  int max_num_images = -1;
+  // Stop early once the consensus axes change by at most this cosine distance
+  // between two consecutive batches of images. Disabled if zero.
+  double max_axis_change = 0.0;
+  // The number of images processed between two convergence checks.
+  int num_images_per_batch = 32;
 };
 
 // Estimate gravity vector by assuming gravity-aligned image orientation, i.e.
@@ -43,36 +43,38 @@
 #include "util/math.h"
 
 namespace colmap {
+namespace {
 
-std::vector<EssentialMatrixFivePointEstimator::M_t>
-EssentialMatrixFivePointEstimator::Estimate(const std::vector<X_t>& points1,
-                                            const std::vector<Y_t>& points2) {
-  CHECK_EQ(points1.size(), points2.size());
-
-  // Step 1: Extraction of the nullspace x, y, z, w.
-
-  Eigen::Matrix<double, Eigen::Dynamic, 9> Q(points1.size(), 9);
+// Step 1 of the five-point algorithm: Linear epipolar constraints of the
+// corresponding points, whose nullspace contains the essential matrix.
+template <typename Points1, typename Points2, typename Matrix>
+void ComputeEpipolarConstraints(const Points1& points1,
+                                const Points2& points2, Matrix* Q) {
   for (size_t i = 0; i < points1.size(); ++i) {
     const double x1_0 = points1[i](0);
     const double x1_1 = points1[i](1);
     const double x2_0 = points2[i](0);
     const double x2_1 = points2[i](1);
-    Q(i, 0) = x1_0 * x2_0;
-    Q(i, 1) = x1_1 * x2_0;
-    Q(i, 2) = x2_0;
-    Q(i, 3) = x1_0 * x2_1;
-    Q(i, 4) = x1_1 * x2_1;
-    Q(i, 5) = x2_1;
-    Q(i, 6) = x1_0;
-    Q(i, 7) = x1_1;
-    Q(i, 8) = 1;
+    (*Q)(i, 0) = x1_0 * x2_0;
+    (*Q)(i, 1) = x1_1 * x2_0;
+    (*Q)(i, 2) = x2_0;
+    (*Q)(i, 3) = x1_0 * x2_1;
+    (*Q)(i, 4) = x1_1 * x2_1;
+    (*Q)(i, 5) = x2_1;
+    (*Q)(i, 6) = x1_0;
+    (*Q)(i, 7) = x1_1;
+    (*Q)(i, 8) = 1;
   }
+}
 
-  // Extract the 4 Eigen vectors corresponding to the smallest singular values.
-  const Eigen::JacobiSVD<Eigen::Matrix<double, Eigen::Dynamic, 9>> svd(
-      Q, Eigen::ComputeFullV);
-  const Eigen::Matrix<double, 9, 4> E = svd.matrixV().block<9, 4>(0, 5);
-
+// Steps 3 to 5 of the five-point algorithm given the nullspace vectors `E`.
+// The real roots of the tenth degree polynomial are either extracted with
+// Sturm sequences or from the eigenvalues of its companion matrix. Returns
+// the number of essential matrices written to `models`.
+size_t EstimateEssentialMatricesFromNullspace(
+    const Eigen::Matrix<double, 9, 4>& E, const bool use_sturm,
+    std::array<Eigen::Matrix3d,
+               EssentialMatrixFivePointEstimator::kMaxNumModels>* models) {
   // Step 3: Gauss-Jordan elimination with partial pivoting on A.
 
   Eigen::Matrix<double, 10, 20> A;
@@ -100,16 +102,22 @@ EssentialMatrixFivePointEstimator::Estimate(const std::vector<X_t>& points1,
   Eigen::Matrix<double, 11, 1> coeffs;
 #include "estimators/essential_matrix_coeffs.h"
 
-  Eigen::VectorXd roots_real;
-  Eigen::VectorXd roots_imag;
-  if (!FindPolynomialRootsCompanionMatrix(coeffs, &roots_real, &roots_imag)) {
-    return {};
+  Eigen::Matrix<double, 10, 1> roots_real;
+  Eigen::Matrix<double, 10, 1> roots_imag;
+  int num_roots = 0;
+  if (use_sturm) {
+    if (!FindRealPolynomialRootsSturm(coeffs, &roots_real, &num_roots)) {
+      return 0;
+    }
+    roots_imag.setZero();
+  } else if (!FindPolynomialRootsCompanionMatrix(coeffs, &roots_real,
+                                                 &roots_imag, &num_roots)) {
+    return 0;
   }
 
-  std::vector<M_t> models;
-  models.reserve(roots_real.size());
+  size_t num_models = 0;
 
-  for (Eigen::VectorXd::Index i = 0; i < roots_imag.size(); ++i) {
+  for (int i = 0; i < num_roots; ++i) {
     const double kMaxRootImag = 1e-10;
     if (std::abs(roots_imag(i)) > kMaxRootImag) {
       continue;
@@ -136,18 +144,71 @@ EssentialMatrixFivePointEstimator::Estimate(const std::vector<X_t>& points1,
       continue;
     }
 
-    Eigen::MatrixXd essential_vec = E.col(0) * (X(0) / X(2)) +
-                                    E.col(1) * (X(1) / X(2)) + E.col(2) * z1 +
-                                    E.col(3);
+    Eigen::Matrix<double, 9, 1> essential_vec =
+        E.col(0) * (X(0) / X(2)) + E.col(1) * (X(1) / X(2)) + E.col(2) * z1 +
+        E.col(3);
     essential_vec /= essential_vec.norm();
 
-    const Eigen::Matrix3d essential_matrix =
+    (*models)[num_models] =
         Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>>(
             essential_vec.data());
-    models.push_back(essential_matrix);
+    num_models += 1;
   }
 
-  return models;
+  return num_models;
+}
+
+}  // namespace
+
+std::vector<EssentialMatrixFivePointEstimator::M_t>
+EssentialMatrixFivePointEstimator::Estimate(const std::vector<X_t>& points1,
+                                            const std::vector<Y_t>& points2) {
+  CHECK_EQ(points1.size(), points2.size());
+
+  // Step 1: Extraction of the nullspace x, y, z, w.
+
+  Eigen::Matrix<double, Eigen::Dynamic, 9> Q(points1.size(), 9);
+  ComputeEpipolarConstraints(points1, points2, &Q);
+
+  // Extract the 4 Eigen vectors corresponding to the smallest singular values.
+  const Eigen::JacobiSVD<Eigen::Matrix<double, Eigen::Dynamic, 9>> svd(
+      Q, Eigen::ComputeFullV);
+  const Eigen::Matrix<double, 9, 4> E = svd.matrixV().block<9, 4>(0, 5);
+
+  std::array<M_t, kMaxNumModels> models;
+  const size_t num_models =
+      EstimateEssentialMatricesFromNullspace(E, false, &models);
+
+  return std::vector<M_t>(models.begin(), models.begin() + num_models);
+}
+
+size_t EssentialMatrixFivePointEstimator::EstimateMinimal(
+    const std::array<X_t, kMinNumSamples>& points1,
+    const std::array<Y_t, kMinNumSamples>& points2,
+    std::array<M_t, kMaxNumModels>* models) {
+  return EstimateMinimal(points1, points2, false, models);
+}
+
+size_t EssentialMatrixFivePointEstimator::EstimateMinimal(
+    const std::array<X_t, kMinNumSamples>& points1,
+    const std::array<Y_t, kMinNumSamples>& points2, const bool use_sturm,
+    std::array<M_t, kMaxNumModels>* models) {
+  Eigen::Matrix<double, kMinNumSamples, 9> Q;
+  ComputeEpipolarConstraints(points1, points2, &Q);
+
+  const Eigen::JacobiSVD<Eigen::Matrix<double, kMinNumSamples, 9>> svd(
+      Q, Eigen::ComputeFullV);
+  const Eigen::Matrix<double, 9, 4> E = svd.matrixV().block<9, 4>(0, 5);
+
+  return EstimateEssentialMatricesFromNullspace(E, use_sturm, models);
+}
+
+size_t EssentialMatrixFivePointSturmEstimator::EstimateMinimal(
+    const std::array<X_t, kMinNumSamples>& points1,
+    const std::array<Y_t, kMinNumSamples>& points2,
+    std::array<M_t, kMaxNumModels>* models) {
+  return EssentialMatrixFivePointEstimator::EstimateMinimal(points1, points2,
+                                                            true, models);
 }
 
 void EssentialMatrixFivePointEstimator::Residuals(
@@ -32,6 +32,7 @@
 #ifndef COLMAP_SRC_ESTIMATORS_ESSENTIAL_MATRIX_H_
 #define COLMAP_SRC_ESTIMATORS_ESSENTIAL_MATRIX_H_
 
+#include <array>
 #include <vector>
 
 #include <Eigen/Core>
@@ -59,6 +60,9 @@ class EssentialMatrixFivePointEstimator {
   // The minimum number of samples needed to estimate a model.
   static const int kMinNumSamples = 5;
 
+  // The maximum number of models estimated from a minimal sample.
+  static const int kMaxNumModels = 10;
+
   // Estimate up to 10 possible essential matrix solutions from a set of
   // corresponding points.
   //
@@ -71,6 +75,22 @@ class EssentialMatrixFivePointEstimator {
   static std::vector<M_t> Estimate(const std::vector<X_t>& points1,
                                    const std::vector<Y_t>& points2);
 
+  // Allocation-free variant of `Estimate` for exactly 5 correspondences used
+  // in the hypothesis loop of RANSAC. Returns the number of essential
+  // matrices written to `models`.
+  static size_t EstimateMinimal(
+      const std::array<X_t, kMinNumSamples>& points1,
+      const std::array<Y_t, kMinNumSamples>& points2,
+      std::array<M_t, kMaxNumModels>* models);
+
+  // Same as above, where `use_sturm` selects whether the real roots of the
+  // tenth degree polynomial are found with Sturm sequences instead of the
+  // eigenvalues of its companion matrix.
+  static size_t EstimateMinimal(
+      const std::array<X_t, kMinNumSamples>& points1,
+      const std::array<Y_t, kMinNumSamples>& points2, const bool use_sturm,
+      std::array<M_t, kMaxNumModels>* models);
+
   // Calculate the residuals of a set of corresponding points and a given
   // essential matrix.
   //
@@ -85,6 +105,20 @@ class EssentialMatrixFivePointEstimator {
                         std::vector<double>* residuals);
 };
 
+// Variant of the 5-Point estimator, which brackets the real roots of the
+// tenth degree polynomial with Sturm sequences, as proposed in the paper,
+// instead of computing all roots as eigenvalues of the companion matrix.
+// This is faster in the RANSAC hypothesis loop, while the non-minimal
+// `Estimate` is inherited unchanged.
+class EssentialMatrixFivePointSturmEstimator
+    : public EssentialMatrixFivePointEstimator {
+ public:
+  static size_t EstimateMinimal(
+      const std::array<X_t, kMinNumSamples>& points1,
+      const std::array<Y_t, kMinNumSamples>& points2,
+      std::array<M_t, kMaxNumModels>* models);
+};
+
 // Essential matrix estimator from corresponding normalized point pairs.
 //
 // This algorithm solves the 8-Point problem based on the following paper:
@@ -32,7 +32,10 @@
 #define TEST_NAME "estimators/essential_matrix"
 #include "util/testing.h"
 
+#include <array>
+
 #include <Eigen/Core>
+#include <Eigen/Geometry>
 
 #include "base/camera_models.h"
 #include "base/essential_matrix.h"
@@ -88,6 +91,49 @@ BOOST_AUTO_TEST_CASE(TestFivePoint) {
   BOOST_CHECK(!report.inlier_mask[11]);
 }
 
+BOOST_AUTO_TEST_CASE(TestFivePointSturm) {
+  SetPRNGSeed(0);
+
+  const Eigen::Matrix3d R =
+      Eigen::AngleAxisd(0.2, Eigen::Vector3d(0.3, 1, 0.1).normalized())
+          .toRotationMatrix();
+  const Eigen::Vector3d t = Eigen::Vector3d(1, 0.2, 0.1).normalized();
+  const Eigen::Matrix3d ref_E = EssentialMatrixFromPose(R, t).normalized();
+
+  for (int k = 0; k < 100; ++k) {
+    std::array<Eigen::Vector2d, 5> points1;
+    std::array<Eigen::Vector2d, 5> points2;
+    for (size_t i = 0; i < points1.size(); ++i) {
+      const Eigen::Vector3d point3D(RandomReal(-1.0, 1.0),
+                                    RandomReal(-1.0, 1.0),
+                                    RandomReal(3.0, 6.0));
+      points1[i] = point3D.hnormalized();
+      points2[i] = (R * point3D + t).hnormalized();
+    }
+
+    std::array<Eigen::Matrix3d, 10> models;
+    const size_t num_models = EssentialMatrixFivePointSturmEstimator::
+        EstimateMinimal(points1, points2, &models);
+
+    std::array<Eigen::Matrix3d, 10> ref_models;
+    const size_t num_ref_models =
+        EssentialMatrixFivePointEstimator::EstimateMinimal(points1, points2,
+                                                           &ref_models);
+
+    BOOST_CHECK_EQUAL(num_models, num_ref_models);
+
+    bool found_model = false;
+    for (size_t i = 0; i < num_models; ++i) {
+      const double diff = std::min((models[i] - ref_E).norm(),
+                                   (models[i] + ref_E).norm());
+      if (diff < 1e-5) {
+        found_model = true;
+      }
+    }
+    BOOST_CHECK(found_model);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestEightPoint) {
   const double points1_raw[] = {1.839035, 1.924743, 0.543582,  0.375221,
                                 0.473240, 0.142522, 0.964910,  0.598376,
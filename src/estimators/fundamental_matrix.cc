@@ -31,6 +31,7 @@
 
 #include "estimators/fundamental_matrix.h"
 
+#include <algorithm>
 #include <cfloat>
 #include <complex>
 #include <vector>
@@ -51,6 +52,22 @@ FundamentalMatrixSevenPointEstimator::Estimate(
   CHECK_EQ(points1.size(), 7);
   CHECK_EQ(points2.size(), 7);
 
+  std::array<X_t, kMinNumSamples> points1_array;
+  std::array<Y_t, kMinNumSamples> points2_array;
+  std::copy(points1.begin(), points1.end(), points1_array.begin());
+  std::copy(points2.begin(), points2.end(), points2_array.begin());
+
+  std::array<M_t, kMaxNumModels> models;
+  const size_t num_models =
+      EstimateMinimal(points1_array, points2_array, &models);
+
+  return std::vector<M_t>(models.begin(), models.begin() + num_models);
+}
+
+size_t FundamentalMatrixSevenPointEstimator::EstimateMinimal(
+    const std::array<X_t, kMinNumSamples>& points1,
+    const std::array<Y_t, kMinNumSamples>& points2,
+    std::array<M_t, kMaxNumModels>* models) {
   // Note that no normalization of the points is necessary here.
 
   // Setup system of equations: [points2(i,:), 1]' * F * [points1(i,:), 1]'.
@@ -107,39 +124,35 @@ FundamentalMatrixSevenPointEstimator::Estimate(
               f1(8) * (f2(0) * f2(4) - f2(1) * f2(3));
   coeffs(3) = f2(0) * t3 - f2(1) * t4 + f2(2) * t5;
 
-  Eigen::VectorXd roots_real;
-  Eigen::VectorXd roots_imag;
-  if (!FindPolynomialRootsCompanionMatrix(coeffs, &roots_real, &roots_imag)) {
-    return {};
+  Eigen::Vector3d roots_real;
+  int num_roots = 0;
+  if (!FindRealCubicPolynomialRoots(coeffs, &roots_real, &num_roots)) {
+    return 0;
   }
 
-  std::vector<M_t> models;
-  models.reserve(roots_real.size());
-
-  for (Eigen::VectorXd::Index i = 0; i < roots_real.size(); ++i) {
-    const double kMaxRootImag = 1e-10;
-    if (std::abs(roots_imag(i)) > kMaxRootImag) {
-      continue;
-    }
+  size_t num_models = 0;
 
+  for (int i = 0; i < num_roots; ++i) {
     const double lambda = roots_real(i);
     const double mu = 1;
 
-    Eigen::MatrixXd F = lambda * f1 + mu * f2;
-
-    F.resize(3, 3);
+    // The coefficients of F are stored in row-major order.
+    Eigen::Matrix<double, 1, 9> F = lambda * f1 + mu * f2;
 
     const double kEps = 1e-10;
-    if (std::abs(F(2, 2)) < kEps) {
+    if (std::abs(F(8)) < kEps) {
       continue;
     }
 
-    F /= F(2, 2);
+    F /= F(8);
 
-    models.push_back(F.transpose());
+    (*models)[num_models] =
+        Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor>>(
+            F.data());
+    num_models += 1;
   }
 
-  return models;
+  return num_models;
 }
 
 void FundamentalMatrixSevenPointEstimator::Residuals(
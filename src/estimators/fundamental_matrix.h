@@ -32,6 +32,7 @@
 #ifndef COLMAP_SRC_ESTIMATORS_FUNDAMENTAL_MATRIX_H_
 #define COLMAP_SRC_ESTIMATORS_FUNDAMENTAL_MATRIX_H_
 
+#include <array>
 #include <vector>
 
 #include <Eigen/Core>
@@ -59,6 +60,9 @@ class FundamentalMatrixSevenPointEstimator {
   // The minimum number of samples needed to estimate a model.
   static const int kMinNumSamples = 7;
 
+  // The maximum number of models estimated from a minimal sample.
+  static const int kMaxNumModels = 3;
+
   // Estimate either 1 or 3 possible fundamental matrix solutions from a set of
   // corresponding points.
   //
@@ -71,6 +75,13 @@ class FundamentalMatrixSevenPointEstimator {
   static std::vector<M_t> Estimate(const std::vector<X_t>& points1,
                                    const std::vector<Y_t>& points2);
 
+  // Allocation-free variant of `Estimate` used in the hypothesis loop of
+  // RANSAC. Returns the number of fundamental matrices written to `models`.
+  static size_t EstimateMinimal(
+      const std::array<X_t, kMinNumSamples>& points1,
+      const std::array<Y_t, kMinNumSamples>& points2,
+      std::array<M_t, kMaxNumModels>* models);
+
   // Calculate the residuals of a set of corresponding points and a given
   // fundamental matrix.
   //
@@ -159,16 +159,18 @@ std::vector<Eigen::Vector3d> ComputeDepthsSylvester(
     const Eigen::Matrix<double, 3, 6>& K) {
   const Eigen::Matrix<double, 9, 1> coeffs = ComputeDepthsSylvesterCoeffs(K);
 
-  Eigen::VectorXd roots_real;
-  Eigen::VectorXd roots_imag;
-  if (!FindPolynomialRootsCompanionMatrix(coeffs, &roots_real, &roots_imag)) {
+  Eigen::Matrix<double, 8, 1> roots_real;
+  Eigen::Matrix<double, 8, 1> roots_imag;
+  int num_roots = 0;
+  if (!FindPolynomialRootsCompanionMatrix(coeffs, &roots_real, &roots_imag,
+                                          &num_roots)) {
     return std::vector<Eigen::Vector3d>();
   }
 
   // Back-substitute every lambda_3 to the system of equations.
   std::vector<Eigen::Vector3d> depths;
-  depths.reserve(roots_real.size());
-  for (Eigen::VectorXd::Index i = 0; i < roots_real.size(); ++i) {
+  depths.reserve(num_roots);
+  for (int i = 0; i < num_roots; ++i) {
     const double kMaxRootImagRatio = 1e-3;
     if (std::abs(roots_imag(i)) > kMaxRootImagRatio * std::abs(roots_real(i))) {
       continue;
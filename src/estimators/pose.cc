@@ -35,8 +35,11 @@
 #include "base/cost_functions.h"
 #include "base/essential_matrix.h"
 #include "base/pose.h"
+#include "base/projection.h"
 #include "estimators/absolute_pose.h"
+#include "estimators/absolute_pose_cuda.h"
 #include "estimators/essential_matrix.h"
+#include "estimators/generalized_absolute_pose.h"
 #include "optim/bundle_adjustment.h"
 #include "util/matrix.h"
 #include "util/misc.h"
@@ -52,6 +55,7 @@ void EstimateAbsolutePoseKernel(const Camera& camera,
                                 const std::vector<Eigen::Vector2d>& points2D,
                                 const std::vector<Eigen::Vector3d>& points3D,
                                 const RANSACOptions& options,
+                                const bool use_gpu,
                                 AbsolutePoseRANSAC::Report* report) {
   // Scale the focal length by the given factor.
   Camera scaled_camera = camera;
@@ -71,6 +75,11 @@ void EstimateAbsolutePoseKernel(const Camera& camera,
   custom_options.max_error =
       scaled_camera.ImageToWorldThreshold(options.max_error);
   AbsolutePoseRANSAC ransac(custom_options);
+#ifdef CUDA_ENABLED
+  if (use_gpu) {
+    ransac.batch_evaluator = EvaluateAbsolutePoseModelsCUDA;
+  }
+#endif
   *report = ransac.Estimate(points2D_N, points3D);
 }
 
@@ -111,10 +120,16 @@ bool EstimateAbsolutePose(const AbsolutePoseEstimationOptions& options,
   ThreadPool thread_pool(std::min(
       options.num_threads, static_cast<int>(focal_length_factors.size())));
 
+  // Multiple focal length samples are already estimated in parallel.
+  RANSACOptions ransac_options = options.ransac_options;
+  if (focal_length_factors.size() > 1) {
+    ransac_options.num_threads = 1;
+  }
+
   for (size_t i = 0; i < focal_length_factors.size(); ++i) {
     futures[i] = thread_pool.AddTask(
         EstimateAbsolutePoseKernel, *camera, focal_length_factors[i], points2D,
-        points3D, options.ransac_options, &reports[i]);
+        points3D, ransac_options, options.use_gpu, &reports[i]);
   }
 
   double focal_length_factor = 0;
@@ -157,6 +172,68 @@ bool EstimateAbsolutePose(const AbsolutePoseEstimationOptions& options,
   return true;
 }
 
+bool EstimateGeneralizedAbsolutePose(
+    const RANSACOptions& options, const std::vector<Eigen::Vector2d>& points2D,
+    const std::vector<Eigen::Vector3d>& points3D,
+    const std::vector<size_t>& camera_idxs,
+    const std::vector<Eigen::Vector4d>& rel_qvecs,
+    const std::vector<Eigen::Vector3d>& rel_tvecs,
+    const std::vector<Camera>& cameras, Eigen::Vector4d* qvec,
+    Eigen::Vector3d* tvec, size_t* num_inliers,
+    std::vector<char>* inlier_mask) {
+  CHECK_EQ(points2D.size(), points3D.size());
+  CHECK_EQ(points2D.size(), camera_idxs.size());
+  CHECK_EQ(rel_qvecs.size(), cameras.size());
+  CHECK_EQ(rel_tvecs.size(), cameras.size());
+  CHECK_GT(cameras.size(), 0);
+  options.Check();
+
+  *num_inliers = 0;
+  inlier_mask->clear();
+
+  std::vector<Eigen::Matrix3x4d> rel_tforms(cameras.size());
+  double mean_focal_length = 0;
+  for (size_t i = 0; i < cameras.size(); ++i) {
+    rel_tforms[i] = ComposeProjectionMatrix(rel_qvecs[i], rel_tvecs[i]);
+    mean_focal_length += cameras[i].MeanFocalLength();
+  }
+  mean_focal_length /= cameras.size();
+
+  std::vector<GP3PEstimator::X_t> points2D_N(points2D.size());
+  for (size_t i = 0; i < points2D.size(); ++i) {
+    const size_t camera_idx = camera_idxs[i];
+    CHECK_LT(camera_idx, cameras.size());
+    points2D_N[i].rel_tform = rel_tforms[camera_idx];
+    points2D_N[i].xy = cameras[camera_idx].ImageToWorld(points2D[i]);
+  }
+
+  // The GP3P residual is the squared cosine distance between the observed and
+  // the projected rays, so convert the pixel threshold to a cosine distance,
+  // which RANSAC squares in turn.
+  RANSACOptions custom_options = options;
+  const double max_angular_error = options.max_error / mean_focal_length;
+  custom_options.max_error = 1 - std::cos(max_angular_error);
+
+  RANSAC<GP3PEstimator> ransac(custom_options);
+  const auto report = ransac.Estimate(points2D_N, points3D);
+
+  if (!report.success) {
+    return false;
+  }
+
+  *num_inliers = report.support.num_inliers;
+  *inlier_mask = report.inlier_mask;
+
+  *qvec = RotationMatrixToQuaternion(report.model.leftCols<3>());
+  *tvec = report.model.rightCols<1>();
+
+  if (IsNaN(*qvec) || IsNaN(*tvec)) {
+    return false;
+  }
+
+  return true;
+}
+
 size_t EstimateRelativePose(const RANSACOptions& ransac_options,
                             const std::vector<Eigen::Vector2d>& points1,
                             const std::vector<Eigen::Vector2d>& points2,
@@ -314,6 +391,97 @@ bool RefineAbsolutePose(const AbsolutePoseRefinementOptions& options,
   return summary.IsSolutionUsable();
 }
 
+bool RefineGeneralizedAbsolutePose(
+    const AbsolutePoseRefinementOptions& options,
+    const std::vector<char>& inlier_mask,
+    const std::vector<Eigen::Vector2d>& points2D,
+    const std::vector<Eigen::Vector3d>& points3D,
+    const std::vector<size_t>& camera_idxs,
+    const std::vector<Eigen::Vector4d>& rel_qvecs,
+    const std::vector<Eigen::Vector3d>& rel_tvecs,
+    const std::vector<Camera>& cameras, Eigen::Vector4d* qvec,
+    Eigen::Vector3d* tvec) {
+  CHECK_EQ(inlier_mask.size(), points2D.size());
+  CHECK_EQ(points2D.size(), points3D.size());
+  CHECK_EQ(points2D.size(), camera_idxs.size());
+  CHECK_EQ(rel_qvecs.size(), cameras.size());
+  CHECK_EQ(rel_tvecs.size(), cameras.size());
+  options.Check();
+
+  ceres::LossFunction* loss_function =
+      new ceres::CauchyLoss(options.loss_function_scale);
+
+  // Copies of the constant parameters, since Ceres requires mutable pointers.
+  std::vector<Eigen::Vector3d> points3D_copy = points3D;
+  std::vector<Eigen::Vector4d> rel_qvecs_copy = rel_qvecs;
+  std::vector<Eigen::Vector3d> rel_tvecs_copy = rel_tvecs;
+  std::vector<Camera> cameras_copy = cameras;
+
+  *qvec = NormalizeQuaternion(*qvec);
+
+  ceres::Problem problem;
+
+  for (size_t i = 0; i < points2D.size(); ++i) {
+    // Skip outlier observations
+    if (!inlier_mask[i]) {
+      continue;
+    }
+
+    const size_t camera_idx = camera_idxs[i];
+    Camera& camera = cameras_copy[camera_idx];
+
+    ceres::CostFunction* cost_function = nullptr;
+
+    switch (camera.ModelId()) {
+#define CAMERA_MODEL_CASE(CameraModel)                                     \
+  case CameraModel::kModelId:                                              \
+    cost_function =                                                        \
+        RigBundleAdjustmentCostFunction<CameraModel>::Create(points2D[i]); \
+    break;
+
+      CAMERA_MODEL_SWITCH_CASES
+
+#undef CAMERA_MODEL_CASE
+    }
+
+    problem.AddResidualBlock(cost_function, loss_function, qvec->data(),
+                             tvec->data(), rel_qvecs_copy[camera_idx].data(),
+                             rel_tvecs_copy[camera_idx].data(),
+                             points3D_copy[i].data(), camera.ParamsData());
+    problem.SetParameterBlockConstant(rel_qvecs_copy[camera_idx].data());
+    problem.SetParameterBlockConstant(rel_tvecs_copy[camera_idx].data());
+    problem.SetParameterBlockConstant(points3D_copy[i].data());
+    problem.SetParameterBlockConstant(camera.ParamsData());
+  }
+
+  if (problem.NumResiduals() > 0) {
+    ceres::LocalParameterization* quaternion_parameterization =
+        new ceres::QuaternionParameterization;
+    problem.SetParameterization(qvec->data(), quaternion_parameterization);
+  }
+
+  ceres::Solver::Options solver_options;
+  solver_options.gradient_tolerance = options.gradient_tolerance;
+  solver_options.max_num_iterations = options.max_num_iterations;
+  solver_options.linear_solver_type = ceres::DENSE_QR;
+
+  // The overhead of creating threads is too large.
+  solver_options.num_threads = 1;
+#if CERES_VERSION_MAJOR < 2
+  solver_options.num_linear_solver_threads = 1;
+#endif  // CERES_VERSION_MAJOR
+
+  ceres::Solver::Summary summary;
+  ceres::Solve(solver_options, &problem, &summary);
+
+  if (options.print_summary) {
+    PrintHeading2("Generalized pose refinement report");
+    PrintSolverSummary(summary);
+  }
+
+  return summary.IsSolutionUsable();
+}
+
 bool RefineRelativePose(const ceres::Solver::Options& options,
                         const std::vector<Eigen::Vector2d>& points1,
                         const std::vector<Eigen::Vector2d>& points2,
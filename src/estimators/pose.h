@@ -66,6 +66,10 @@ struct AbsolutePoseEstimationOptions {
   // Number of threads for parallel estimation of focal length.
   int num_threads = ThreadPool::kMaxNumThreads;
 
+  // Whether to evaluate the P3P hypotheses in batches on the GPU, if CUDA is
+  // available. The minimal samples are still solved on the CPU.
+  bool use_gpu = false;
+
   // Options used for P3P RANSAC.
   RANSACOptions ransac_options;
 
@@ -129,6 +133,37 @@ bool EstimateAbsolutePose(const AbsolutePoseEstimationOptions& options,
                           Camera* camera, size_t* num_inliers,
                           std::vector<char>* inlier_mask);
 
+// Estimate generalized absolute pose of a multi-camera rig from 2D-3D
+// correspondences using the GP3P solver.
+//
+// The relative poses and calibrations of the rig cameras are assumed known.
+// The maximum error in the RANSAC options is specified in pixels and converted
+// to a threshold on the angular error using the mean focal length of the
+// rig cameras.
+//
+// @param options              RANSAC options.
+// @param points2D             Corresponding 2D points.
+// @param points3D             Corresponding 3D points.
+// @param camera_idxs          Index of the rig camera of each 2D point.
+// @param rel_qvecs            Relative rotations from the rig to the cameras.
+// @param rel_tvecs            Relative translations from the rig to cameras.
+// @param cameras              Calibrations of the rig cameras.
+// @param qvec                 Estimated rotation component of the rig as
+//                             unit Quaternion coefficients (w, x, y, z).
+// @param tvec                 Estimated translation component of the rig.
+// @param num_inliers          Number of inliers in RANSAC.
+// @param inlier_mask          Inlier mask for 2D-3D correspondences.
+//
+// @return                     Whether pose is estimated successfully.
+bool EstimateGeneralizedAbsolutePose(
+    const RANSACOptions& options, const std::vector<Eigen::Vector2d>& points2D,
+    const std::vector<Eigen::Vector3d>& points3D,
+    const std::vector<size_t>& camera_idxs,
+    const std::vector<Eigen::Vector4d>& rel_qvecs,
+    const std::vector<Eigen::Vector3d>& rel_tvecs,
+    const std::vector<Camera>& cameras, Eigen::Vector4d* qvec,
+    Eigen::Vector3d* tvec, size_t* num_inliers, std::vector<char>* inlier_mask);
+
 // Estimate relative from 2D-2D correspondences.
 //
 // Pose of first camera is assumed to be at the origin without rotation. Pose
@@ -168,6 +203,34 @@ bool RefineAbsolutePose(const AbsolutePoseRefinementOptions& options,
                         Eigen::Vector4d* qvec, Eigen::Vector3d* tvec,
                         Camera* camera);
 
+// Refine generalized absolute pose of a multi-camera rig from 2D-3D
+// correspondences. The relative poses and calibrations of the rig cameras
+// are kept constant.
+//
+// @param options              Refinement options.
+// @param inlier_mask          Inlier mask for 2D-3D correspondences.
+// @param points2D             Corresponding 2D points.
+// @param points3D             Corresponding 3D points.
+// @param camera_idxs          Index of the rig camera of each 2D point.
+// @param rel_qvecs            Relative rotations from the rig to the cameras.
+// @param rel_tvecs            Relative translations from the rig to cameras.
+// @param cameras              Calibrations of the rig cameras.
+// @param qvec                 Refined rotation component of the rig as
+//                             unit Quaternion coefficients (w, x, y, z).
+// @param tvec                 Refined translation component of the rig.
+//
+// @return                     Whether the solution is usable.
+bool RefineGeneralizedAbsolutePose(
+    const AbsolutePoseRefinementOptions& options,
+    const std::vector<char>& inlier_mask,
+    const std::vector<Eigen::Vector2d>& points2D,
+    const std::vector<Eigen::Vector3d>& points3D,
+    const std::vector<size_t>& camera_idxs,
+    const std::vector<Eigen::Vector4d>& rel_qvecs,
+    const std::vector<Eigen::Vector3d>& rel_tvecs,
+    const std::vector<Camera>& cameras, Eigen::Vector4d* qvec,
+    Eigen::Vector3d* tvec);
+
 // Refine relative pose of two cameras.
 //
 // Minimizes the Sampson error between corresponding normalized points using
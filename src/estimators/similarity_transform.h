@@ -101,13 +101,13 @@ std::vector<typename SimilarityTransformEstimator<kDim, kEstimateScale>::M_t>
 SimilarityTransformEstimator<kDim, kEstimateScale>::Estimate(
     const std::vector<X_t>& src, const std::vector<Y_t>& dst) {
   CHECK_EQ(src.size(), dst.size());
+  CHECK_GT(src.size(), 0);
 
-  Eigen::Matrix<double, kDim, Eigen::Dynamic> src_mat(kDim, src.size());
-  Eigen::Matrix<double, kDim, Eigen::Dynamic> dst_mat(kDim, dst.size());
-  for (size_t i = 0; i < src.size(); ++i) {
-    src_mat.col(i) = src[i];
-    dst_mat.col(i) = dst[i];
-  }
+  // The points are stored contiguously, so they are mapped without copies.
+  const Eigen::Map<const Eigen::Matrix<double, kDim, Eigen::Dynamic>> src_mat(
+      src[0].data(), kDim, src.size());
+  const Eigen::Map<const Eigen::Matrix<double, kDim, Eigen::Dynamic>> dst_mat(
+      dst[0].data(), kDim, dst.size());
 
   std::vector<M_t> models(1);
   models[0] = Eigen::umeyama(src_mat, dst_mat, kEstimateScale)
@@ -124,10 +124,20 @@ void SimilarityTransformEstimator<kDim, kEstimateScale>::Residuals(
 
   residuals->resize(src.size());
 
-  for (size_t i = 0; i < src.size(); ++i) {
-    const Y_t dst_transformed = matrix * src[i].homogeneous();
-    (*residuals)[i] = (dst[i] - dst_transformed).squaredNorm();
+  if (src.empty()) {
+    return;
   }
+
+  // Transform all points at once, which is vectorized by Eigen.
+  const Eigen::Map<const Eigen::Matrix<double, kDim, Eigen::Dynamic>> src_mat(
+      src[0].data(), kDim, src.size());
+  const Eigen::Map<const Eigen::Matrix<double, kDim, Eigen::Dynamic>> dst_mat(
+      dst[0].data(), kDim, dst.size());
+  Eigen::Map<Eigen::RowVectorXd>(residuals->data(), residuals->size()) =
+      ((matrix.template leftCols<kDim>().lazyProduct(src_mat)).colwise() +
+       matrix.col(kDim) - dst_mat)
+          .colwise()
+          .squaredNorm();
 }
 
 }  // namespace colmap
@@ -31,6 +31,9 @@
 
 #include "estimators/triangulation.h"
 
+#include <algorithm>
+
+#include <Eigen/Eigenvalues>
 #include <Eigen/Geometry>
 
 #include "base/projection.h"
@@ -42,6 +45,75 @@
 #include "util/math.h"
 
 namespace colmap {
+namespace {
+
+double ComputeTriangulationResidual(
+    const TriangulationEstimator::ResidualType residual_type,
+    const TriangulationEstimator::PointData& point_data,
+    const TriangulationEstimator::PoseData& pose_data,
+    const Eigen::Vector3d& xyz) {
+  if (residual_type ==
+      TriangulationEstimator::ResidualType::REPROJECTION_ERROR) {
+    return CalculateSquaredReprojectionError(point_data.point, xyz,
+                                             pose_data.proj_matrix,
+                                             *pose_data.camera);
+  } else {
+    const double angular_error = CalculateNormalizedAngularError(
+        point_data.point_normalized, xyz, pose_data.proj_matrix);
+    return angular_error * angular_error;
+  }
+}
+
+// Triangulate a short track from all its observations without RANSAC.
+// Returns true if the point satisfies the cheirality and triangulation angle
+// constraints and all observations are inliers.
+bool EstimateTriangulationClosedForm(
+    const EstimateTriangulationOptions& options,
+    const TriangulationEstimator::PointData* point_data,
+    const TriangulationEstimator::PoseData* pose_data,
+    const size_t num_observations, Eigen::Vector3d* xyz) {
+  if (num_observations == 2) {
+    *xyz = TriangulatePoint(pose_data[0].proj_matrix, pose_data[1].proj_matrix,
+                            point_data[0].point_normalized,
+                            point_data[1].point_normalized);
+  } else {
+    Eigen::Matrix4d A = Eigen::Matrix4d::Zero();
+    for (size_t i = 0; i < num_observations; ++i) {
+      const Eigen::Vector3d point =
+          point_data[i].point_normalized.homogeneous().normalized();
+      const Eigen::Matrix3x4d term =
+          pose_data[i].proj_matrix -
+          point * point.transpose() * pose_data[i].proj_matrix;
+      A += term.transpose() * term;
+    }
+    const Eigen::SelfAdjointEigenSolver<Eigen::Matrix4d> eigen_solver(A);
+    *xyz = eigen_solver.eigenvectors().col(0).hnormalized();
+  }
+
+  const double max_residual =
+      options.ransac_options.max_error * options.ransac_options.max_error;
+  for (size_t i = 0; i < num_observations; ++i) {
+    if (!HasPointPositiveDepth(pose_data[i].proj_matrix, *xyz) ||
+        ComputeTriangulationResidual(options.residual_type, point_data[i],
+                                     pose_data[i], *xyz) > max_residual) {
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < num_observations; ++i) {
+    for (size_t j = 0; j < i; ++j) {
+      if (CalculateTriangulationAngle(pose_data[i].proj_center,
+                                      pose_data[j].proj_center,
+                                      *xyz) >= options.min_tri_angle) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+}  // namespace
 
 void TriangulationEstimator::SetMinTriAngle(const double min_tri_angle) {
   CHECK_GE(min_tri_angle, 0);
@@ -117,15 +189,8 @@ void TriangulationEstimator::Residuals(const std::vector<X_t>& point_data,
   residuals->resize(point_data.size());
 
   for (size_t i = 0; i < point_data.size(); ++i) {
-    if (residual_type_ == ResidualType::REPROJECTION_ERROR) {
-      (*residuals)[i] = CalculateSquaredReprojectionError(
-          point_data[i].point, xyz, pose_data[i].proj_matrix,
-          *pose_data[i].camera);
-    } else if (residual_type_ == ResidualType::ANGULAR_ERROR) {
-      const double angular_error = CalculateNormalizedAngularError(
-          point_data[i].point_normalized, xyz, pose_data[i].proj_matrix);
-      (*residuals)[i] = angular_error * angular_error;
-    }
+    (*residuals)[i] = ComputeTriangulationResidual(
+        residual_type_, point_data[i], pose_data[i], xyz);
   }
 }
 
@@ -159,4 +224,72 @@ bool EstimateTriangulation(
   return report.success;
 }
 
+void EstimateTriangulations(const EstimateTriangulationOptions& options,
+                            const TriangulationBatch& batch,
+                            std::vector<char>* success,
+                            std::vector<Eigen::Vector3d>* xyzs,
+                            std::vector<char>* inlier_masks) {
+  CHECK_NOTNULL(success);
+  CHECK_NOTNULL(xyzs);
+  CHECK_NOTNULL(inlier_masks);
+  CHECK_EQ(batch.point_data.size(), batch.pose_data.size());
+  CHECK_EQ(batch.track_offsets.back(), batch.point_data.size());
+  options.Check();
+
+  const size_t num_tracks = batch.NumTracks();
+  success->assign(num_tracks, false);
+  xyzs->resize(num_tracks);
+  inlier_masks->assign(batch.point_data.size(), false);
+
+  const size_t kMaxClosedFormTrackLength = 3;
+  const size_t kExhaustiveSamplingThreshold = 15;
+
+  EstimateTriangulationOptions track_options = options;
+  std::vector<TriangulationEstimator::PointData> track_point_data;
+  std::vector<TriangulationEstimator::PoseData> track_pose_data;
+  std::vector<char> track_inlier_mask;
+
+  for (size_t track_idx = 0; track_idx < num_tracks; ++track_idx) {
+    const size_t begin = batch.track_offsets[track_idx];
+    const size_t end = batch.track_offsets[track_idx + 1];
+    const size_t num_observations = end - begin;
+    CHECK_GE(num_observations, 2);
+
+    Eigen::Vector3d& xyz = (*xyzs)[track_idx];
+
+    if (num_observations <= kMaxClosedFormTrackLength) {
+      if (EstimateTriangulationClosedForm(
+              options, &batch.point_data[begin], &batch.pose_data[begin],
+              num_observations, &xyz)) {
+        (*success)[track_idx] = true;
+        std::fill(inlier_masks->begin() + begin, inlier_masks->begin() + end,
+                  true);
+        continue;
+      } else if (num_observations == 2) {
+        continue;
+      }
+    }
+
+    track_options.ransac_options.min_num_trials =
+        options.ransac_options.min_num_trials;
+    if (num_observations <= kExhaustiveSamplingThreshold) {
+      track_options.ransac_options.min_num_trials = std::min(
+          options.ransac_options.max_num_trials,
+          std::max(options.ransac_options.min_num_trials,
+                   NChooseK(num_observations, 2)));
+    }
+
+    track_point_data.assign(batch.point_data.begin() + begin,
+                            batch.point_data.begin() + end);
+    track_pose_data.assign(batch.pose_data.begin() + begin,
+                           batch.pose_data.begin() + end);
+    if (EstimateTriangulation(track_options, track_point_data,
+                              track_pose_data, &track_inlier_mask, &xyz)) {
+      (*success)[track_idx] = true;
+      std::copy(track_inlier_mask.begin(), track_inlier_mask.end(),
+                inlier_masks->begin() + begin);
+    }
+  }
+}
+
 }  // namespace colmap
@@ -120,6 +120,15 @@ class TriangulationEstimator {
   double min_tri_angle_ = 0.0;
 };
 
+}  // namespace colmap
+
+EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION_CUSTOM(
+    colmap::TriangulationEstimator::PointData)
+EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION_CUSTOM(
+    colmap::TriangulationEstimator::PoseData)
+
+namespace colmap {
+
 struct EstimateTriangulationOptions {
   // Minimum triangulation angle in radians.
   double min_tri_angle = 0.0;
@@ -146,11 +155,40 @@ bool EstimateTriangulation(
     const std::vector<TriangulationEstimator::PoseData>& pose_data,
     std::vector<char>* inlier_mask, Eigen::Vector3d* xyz);
 
-}  // namespace colmap
+// Observations of multiple tracks packed into contiguous arrays, where the
+// observations of the i-th track are stored in the range
+// [track_offsets[i], track_offsets[i + 1]).
+struct TriangulationBatch {
+  std::vector<TriangulationEstimator::PointData> point_data;
+  std::vector<TriangulationEstimator::PoseData> pose_data;
+  std::vector<size_t> track_offsets = {0};
 
-EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION_CUSTOM(
-    colmap::TriangulationEstimator::PointData)
-EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION_CUSTOM(
-    colmap::TriangulationEstimator::PoseData)
+  size_t NumTracks() const { return track_offsets.size() - 1; }
+
+  // Finish a track with all observations added since the previous track.
+  void FinishTrack() { track_offsets.push_back(point_data.size()); }
+
+  void Clear() {
+    point_data.clear();
+    pose_data.clear();
+    track_offsets.assign(1, 0);
+  }
+};
+
+// Estimate the 3D points of all tracks in the batch as in
+// `EstimateTriangulation`. The outputs `success` and `xyzs` have one entry
+// per track and `inlier_masks` has one entry per observation in the packed
+// layout of the batch. Tracks with two observations are only triangulated in
+// closed form, since RANSAC would evaluate the same single hypothesis. Tracks
+// with three observations are first triangulated from all observations and
+// only estimated with RANSAC, if any of them is an outlier. Tracks with up to
+// 15 observations are sampled exhaustively by RANSAC.
+void EstimateTriangulations(const EstimateTriangulationOptions& options,
+                            const TriangulationBatch& batch,
+                            std::vector<char>* success,
+                            std::vector<Eigen::Vector3d>* xyzs,
+                            std::vector<char>* inlier_masks);
+
+}  // namespace colmap
 
 #endif  // COLMAP_SRC_ESTIMATORS_TRIANGULATION_H_
@@ -0,0 +1,154 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "estimators/triangulation"
+#include "util/testing.h"
+
+#include <Eigen/Core>
+
+#include "base/projection.h"
+#include "estimators/triangulation.h"
+#include "util/random.h"
+
+using namespace colmap;
+
+namespace {
+
+void AddObservation(const Camera& camera, const Eigen::Vector3d& xyz,
+                    const double tx, TriangulationBatch* batch) {
+  const Eigen::Matrix3d R = Eigen::Matrix3d::Identity();
+  const Eigen::Matrix3x4d proj_matrix =
+      ComposeProjectionMatrix(R, Eigen::Vector3d(tx, 0, 0));
+  const Eigen::Vector2d point =
+      camera.WorldToImage((proj_matrix * xyz.homogeneous()).hnormalized());
+  batch->point_data.emplace_back(point, camera.ImageToWorld(point));
+  batch->pose_data.emplace_back(proj_matrix, Eigen::Vector3d(-tx, 0, 0),
+                                &camera);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(TestEstimateTriangulations) {
+  SetPRNGSeed(0);
+
+  Camera camera;
+  camera.InitializeWithName("PINHOLE", 500, 1000, 1000);
+
+  const Eigen::Vector3d xyz(0.5, -0.2, 5);
+  const Eigen::Vector3d outlier_xyz(-1, 1, 4);
+
+  TriangulationBatch batch;
+
+  // Two-view track.
+  AddObservation(camera, xyz, 0, &batch);
+  AddObservation(camera, xyz, 1, &batch);
+  batch.FinishTrack();
+
+  // Two-view track with an outlier.
+  AddObservation(camera, xyz, 0, &batch);
+  AddObservation(camera, outlier_xyz, 1, &batch);
+  batch.FinishTrack();
+
+  // Three-view track.
+  AddObservation(camera, xyz, 0, &batch);
+  AddObservation(camera, xyz, 1, &batch);
+  AddObservation(camera, xyz, 2, &batch);
+  batch.FinishTrack();
+
+  // Three-view track with an outlier.
+  AddObservation(camera, xyz, 0, &batch);
+  AddObservation(camera, outlier_xyz, 1, &batch);
+  AddObservation(camera, xyz, 2, &batch);
+  batch.FinishTrack();
+
+  // Multi-view track with outliers.
+  for (int i = 0; i < 8; ++i) {
+    AddObservation(camera, i % 3 == 1 ? outlier_xyz : xyz, i, &batch);
+  }
+  batch.FinishTrack();
+
+  BOOST_CHECK_EQUAL(batch.NumTracks(), 5);
+
+  EstimateTriangulationOptions options;
+  options.min_tri_angle = DegToRad(1.0);
+  options.residual_type =
+      TriangulationEstimator::ResidualType::REPROJECTION_ERROR;
+  options.ransac_options.max_error = 1;
+
+  std::vector<char> success;
+  std::vector<Eigen::Vector3d> xyzs;
+  std::vector<char> inlier_masks;
+  EstimateTriangulations(options, batch, &success, &xyzs, &inlier_masks);
+
+  BOOST_CHECK_EQUAL(success.size(), 5);
+  BOOST_CHECK_EQUAL(xyzs.size(), 5);
+  BOOST_CHECK_EQUAL(inlier_masks.size(), batch.point_data.size());
+
+  BOOST_CHECK(success[0]);
+  BOOST_CHECK(!success[1]);
+  BOOST_CHECK(success[2]);
+  BOOST_CHECK(success[3]);
+  BOOST_CHECK(success[4]);
+
+  for (const size_t track_idx : {0, 2, 3, 4}) {
+    BOOST_CHECK_LT((xyzs[track_idx] - xyz).norm(), 1e-6);
+  }
+
+  for (size_t track_idx = 0; track_idx < batch.NumTracks(); ++track_idx) {
+    const size_t begin = batch.track_offsets[track_idx];
+    const size_t end = batch.track_offsets[track_idx + 1];
+    for (size_t i = begin; i < end; ++i) {
+      if (!success[track_idx]) {
+        BOOST_CHECK(!inlier_masks[i]);
+      } else {
+        const Eigen::Vector2d point = camera.WorldToImage(
+            (batch.pose_data[i].proj_matrix * xyz.homogeneous()).hnormalized());
+        const bool is_inlier =
+            (batch.point_data[i].point - point).norm() < 1e-6;
+        BOOST_CHECK_EQUAL(inlier_masks[i], is_inlier);
+      }
+    }
+  }
+
+  // The batched estimation agrees with the individual estimation.
+  const size_t begin = batch.track_offsets[4];
+  const std::vector<TriangulationEstimator::PointData> point_data(
+      batch.point_data.begin() + begin, batch.point_data.end());
+  const std::vector<TriangulationEstimator::PoseData> pose_data(
+      batch.pose_data.begin() + begin, batch.pose_data.end());
+  options.ransac_options.min_num_trials = NChooseK(point_data.size(), 2);
+  Eigen::Vector3d ref_xyz;
+  std::vector<char> ref_inlier_mask;
+  BOOST_CHECK(EstimateTriangulation(options, point_data, pose_data,
+                                    &ref_inlier_mask, &ref_xyz));
+  BOOST_CHECK_LT((ref_xyz - xyzs[4]).norm(), 1e-6);
+  BOOST_CHECK(std::equal(ref_inlier_mask.begin(), ref_inlier_mask.end(),
+                         inlier_masks.begin() + begin));
+}
@@ -43,13 +43,95 @@
 #include "estimators/fundamental_matrix.h"
 #include "estimators/homography_matrix.h"
 #include "estimators/translation_transform.h"
+#include "estimators/two_view_geometry_cuda.h"
 #include "optim/loransac.h"
+#include "optim/progressive_sampler.h"
 #include "optim/ransac.h"
 #include "util/random.h"
 
 namespace colmap {
 namespace {
 
+// Evaluate the hypotheses of the given RANSAC instance in batches on the GPU.
+// Without CUDA, the hypotheses are evaluated on the CPU as usual.
+template <typename RANSACType>
+void SetGPUBatchEvaluator(const TwoViewResidualType residual_type,
+                          RANSACType* ransac) {
+#ifdef CUDA_ENABLED
+  ransac->batch_evaluator =
+      [residual_type](const std::vector<Eigen::Vector2d>& points1,
+                      const std::vector<Eigen::Vector2d>& points2,
+                      const std::vector<Eigen::Matrix3d>& models,
+                      const double max_residual,
+                      std::vector<InlierSupportMeasurer::Support>* supports) {
+        EvaluateTwoViewModelsCUDA(residual_type, points1, points2, models,
+                                  max_residual, supports);
+      };
+#endif
+}
+
+// Robustly estimate a model with LO-RANSAC, where the samples are drawn with
+// PROSAC if the correspondences are sorted by their quality.
+template <typename Estimator, typename LocalEstimator>
+typename RANSAC<Estimator>::Report EstimateLORANSAC(
+    const std::vector<typename Estimator::X_t>& X,
+    const std::vector<typename Estimator::Y_t>& Y,
+    const RANSACOptions& ransac_options, const TwoViewResidualType residual_type,
+    const TwoViewGeometry::Options& options) {
+  if (!options.use_prosac) {
+    LORANSAC<Estimator, LocalEstimator> ransac(ransac_options);
+    if (options.use_gpu) {
+      SetGPUBatchEvaluator(residual_type, &ransac);
+    }
+    return ransac.Estimate(X, Y);
+  }
+
+  LORANSAC<Estimator, LocalEstimator, InlierSupportMeasurer,
+           ProgressiveSampler>
+      prosac(ransac_options);
+  if (options.use_gpu) {
+    SetGPUBatchEvaluator(residual_type, &prosac);
+  }
+  const auto prosac_report = prosac.Estimate(X, Y);
+
+  typename RANSAC<Estimator>::Report report;
+  report.success = prosac_report.success;
+  report.num_trials = prosac_report.num_trials;
+  report.support = prosac_report.support;
+  report.inlier_mask = prosac_report.inlier_mask;
+  report.model = prosac_report.model;
+  return report;
+}
+
+// Robustly estimate an essential matrix, where the minimal samples are solved
+// with the five-point solver selected in the options.
+RANSAC<EssentialMatrixFivePointEstimator>::Report EstimateEssentialMatrix(
+    const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector2d>& points2,
+    const RANSACOptions& ransac_options,
+    const TwoViewGeometry::Options& options) {
+  if (!options.use_sturm_five_point) {
+    return EstimateLORANSAC<EssentialMatrixFivePointEstimator,
+                            EssentialMatrixFivePointEstimator>(
+        points1, points2, ransac_options, TwoViewResidualType::SAMPSON,
+        options);
+  }
+
+  const auto sturm_report =
+      EstimateLORANSAC<EssentialMatrixFivePointSturmEstimator,
+                       EssentialMatrixFivePointEstimator>(
+          points1, points2, ransac_options, TwoViewResidualType::SAMPSON,
+          options);
+
+  RANSAC<EssentialMatrixFivePointEstimator>::Report report;
+  report.success = sturm_report.success;
+  report.num_trials = sturm_report.num_trials;
+  report.support = sturm_report.support;
+  report.inlier_mask = sturm_report.inlier_mask;
+  report.model = sturm_report.model;
+  return report;
+}
+
 FeatureMatches ExtractInlierMatches(const FeatureMatches& matches,
                                     const size_t num_inliers,
                                     const std::vector<char>& inlier_mask) {
@@ -260,23 +342,56 @@ void TwoViewGeometry::EstimateCalibrated(
        camera2.ImageToWorldThreshold(options.ransac_options.max_error)) /
       2;
 
-  LORANSAC<EssentialMatrixFivePointEstimator, EssentialMatrixFivePointEstimator>
-      E_ransac(E_ransac_options);
-  const auto E_report =
-      E_ransac.Estimate(matched_points1_normalized, matched_points2_normalized);
+  if (options.fast_path) {
+    auto fast_E_ransac_options = E_ransac_options;
+    fast_E_ransac_options.max_num_trials = std::min(
+        fast_E_ransac_options.max_num_trials, options.fast_path_max_num_trials);
+    fast_E_ransac_options.min_num_trials =
+        std::min(fast_E_ransac_options.min_num_trials,
+                 fast_E_ransac_options.max_num_trials);
+
+    const auto fast_E_report = EstimateEssentialMatrix(
+        matched_points1_normalized, matched_points2_normalized,
+        fast_E_ransac_options, options);
+
+    const size_t num_inliers = fast_E_report.support.num_inliers;
+    if (fast_E_report.success && num_inliers >= options.min_num_inliers &&
+        num_inliers >= options.fast_path_min_inlier_ratio * matches.size()) {
+      config = ConfigurationType::CALIBRATED;
+      E = fast_E_report.model;
+      // The fundamental matrix is used for guided matching.
+      F = camera2.CalibrationMatrix().transpose().inverse() * E *
+          camera1.CalibrationMatrix().inverse();
+      inlier_matches =
+          ExtractInlierMatches(matches, num_inliers, fast_E_report.inlier_mask);
+
+      if (options.detect_watermark &&
+          DetectWatermark(camera1, matched_points1, camera2, matched_points2,
+                          num_inliers, fast_E_report.inlier_mask, options)) {
+        config = ConfigurationType::WATERMARK;
+      }
+
+      return;
+    }
+  }
+
+  const auto E_report = EstimateEssentialMatrix(
+      matched_points1_normalized, matched_points2_normalized, E_ransac_options,
+      options);
   E = E_report.model;
 
-  LORANSAC<FundamentalMatrixSevenPointEstimator,
-           FundamentalMatrixEightPointEstimator>
-      F_ransac(options.ransac_options);
-  const auto F_report = F_ransac.Estimate(matched_points1, matched_points2);
+  const auto F_report = EstimateLORANSAC<FundamentalMatrixSevenPointEstimator,
+                                         FundamentalMatrixEightPointEstimator>(
+      matched_points1, matched_points2, options.ransac_options,
+      TwoViewResidualType::SAMPSON, options);
   F = F_report.model;
 
   // Estimate planar or panoramic model.
 
-  LORANSAC<HomographyMatrixEstimator, HomographyMatrixEstimator> H_ransac(
-      options.ransac_options);
-  const auto H_report = H_ransac.Estimate(matched_points1, matched_points2);
+  const auto H_report =
+      EstimateLORANSAC<HomographyMatrixEstimator, HomographyMatrixEstimator>(
+          matched_points1, matched_points2, options.ransac_options,
+          TwoViewResidualType::TRANSFER, options);
   H = H_report.model;
 
   if ((!E_report.success && !F_report.success && !H_report.success) ||
@@ -383,17 +498,18 @@ void TwoViewGeometry::EstimateUncalibrated(
 
   // Estimate epipolar model.
 
-  LORANSAC<FundamentalMatrixSevenPointEstimator,
-           FundamentalMatrixEightPointEstimator>
-      F_ransac(options.ransac_options);
-  const auto F_report = F_ransac.Estimate(matched_points1, matched_points2);
+  const auto F_report = EstimateLORANSAC<FundamentalMatrixSevenPointEstimator,
+                                         FundamentalMatrixEightPointEstimator>(
+      matched_points1, matched_points2, options.ransac_options,
+      TwoViewResidualType::SAMPSON, options);
   F = F_report.model;
 
   // Estimate planar or panoramic model.
 
-  LORANSAC<HomographyMatrixEstimator, HomographyMatrixEstimator> H_ransac(
-      options.ransac_options);
-  const auto H_report = H_ransac.Estimate(matched_points1, matched_points2);
+  const auto H_report =
+      EstimateLORANSAC<HomographyMatrixEstimator, HomographyMatrixEstimator>(
+          matched_points1, matched_points2, options.ransac_options,
+          TwoViewResidualType::TRANSFER, options);
   H = H_report.model;
 
   if ((!F_report.success && !H_report.success) ||
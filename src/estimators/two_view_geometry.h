@@ -104,6 +104,33 @@ struct TwoViewGeometry {
     // Whether to ignore watermark models in multiple model estimation.
     bool multiple_ignore_watermark = true;
 
+    // Whether the matches are sorted by their quality in descending order,
+    // e.g. by their ratio test score, in which case PROSAC is used instead of
+    // uniform random sampling to estimate the geometry.
+    bool use_prosac = false;
+
+    // Whether to evaluate the hypotheses of multiple RANSAC trials at once on
+    // the current CUDA device instead of one by one on the CPU. This does not
+    // change the estimated geometry, up to floating point rounding, but pays
+    // off for image pairs with many correspondences.
+    bool use_gpu = false;
+
+    // Whether to find the real roots of the five-point essential matrix
+    // solver with Sturm sequences instead of the eigenvalues of the companion
+    // matrix, which is faster for the verification of calibrated image pairs.
+    bool use_sturm_five_point = false;
+
+    // Whether to first only estimate an essential matrix with at most
+    // `fast_path_max_num_trials` RANSAC trials for calibrated image pairs,
+    // e.g. consecutive video frames. If its inlier ratio is at least
+    // `fast_path_min_inlier_ratio`, the pair is accepted as calibrated without
+    // estimating the fundamental matrix and homography, i.e. without checking
+    // for a planar or panoramic configuration. Otherwise, the full estimation
+    // is performed.
+    bool fast_path = false;
+    double fast_path_min_inlier_ratio = 0.8;
+    size_t fast_path_max_num_trials = 50;
+
     // Options used to robustly estimate the geometry.
     RANSACOptions ransac_options;
 
@@ -117,6 +144,9 @@ struct TwoViewGeometry {
       CHECK_LE(watermark_min_inlier_ratio, 1);
       CHECK_GE(watermark_border_size, 0);
       CHECK_LE(watermark_border_size, 1);
+      CHECK_GE(fast_path_min_inlier_ratio, 0);
+      CHECK_LE(fast_path_min_inlier_ratio, 1);
+      CHECK_GT(fast_path_max_num_trials, 0);
       ransac_options.Check();
     }
   };
@@ -0,0 +1,212 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+#include "estimators/two_view_geometry_cuda.h"
+
+#include "util/cudacc.h"
+#include "util/logging.h"
+
+namespace colmap {
+namespace {
+
+const int kBlockSize = 256;
+
+// Note that the residuals are computed with the same expressions as the CPU
+// implementations in estimators/utils.cc.
+__device__ double ComputeSquaredSampsonError(const double* E, const double x1_0,
+                                             const double x1_1,
+                                             const double x2_0,
+                                             const double x2_1) {
+  // The matrix is stored in column-major order.
+  const double Ex1_0 = E[0] * x1_0 + E[3] * x1_1 + E[6];
+  const double Ex1_1 = E[1] * x1_0 + E[4] * x1_1 + E[7];
+  const double Ex1_2 = E[2] * x1_0 + E[5] * x1_1 + E[8];
+
+  const double Etx2_0 = E[0] * x2_0 + E[1] * x2_1 + E[2];
+  const double Etx2_1 = E[3] * x2_0 + E[4] * x2_1 + E[5];
+
+  const double x2tEx1 = x2_0 * Ex1_0 + x2_1 * Ex1_1 + Ex1_2;
+
+  return x2tEx1 * x2tEx1 / (Ex1_0 * Ex1_0 + Ex1_1 * Ex1_1 + Etx2_0 * Etx2_0 +
+                            Etx2_1 * Etx2_1);
+}
+
+__device__ double ComputeSquaredTransferError(const double* H, const double s_0,
+                                              const double s_1,
+                                              const double d_0,
+                                              const double d_1) {
+  // The matrix is stored in column-major order.
+  const double pd_0 = H[0] * s_0 + H[3] * s_1 + H[6];
+  const double pd_1 = H[1] * s_0 + H[4] * s_1 + H[7];
+  const double pd_2 = H[2] * s_0 + H[5] * s_1 + H[8];
+
+  const double inv_pd_2 = 1.0 / pd_2;
+  const double dd_0 = d_0 - pd_0 * inv_pd_2;
+  const double dd_1 = d_1 - pd_1 * inv_pd_2;
+
+  return dd_0 * dd_0 + dd_1 * dd_1;
+}
+
+// Each block evaluates one model, where the threads of the block iterate over
+// the points and the per-thread supports are reduced in shared memory.
+__global__ void EvaluateModelsKernel(const TwoViewResidualType residual_type,
+                                     const double* points1,
+                                     const double* points2,
+                                     const int num_points,
+                                     const double* models,
+                                     const double max_residual,
+                                     int* num_inliers, double* residual_sums) {
+  __shared__ double model[9];
+  __shared__ int block_num_inliers[kBlockSize];
+  __shared__ double block_residual_sums[kBlockSize];
+
+  if (threadIdx.x < 9) {
+    model[threadIdx.x] = models[9 * blockIdx.x + threadIdx.x];
+  }
+  __syncthreads();
+
+  int thread_num_inliers = 0;
+  double thread_residual_sum = 0;
+  for (int i = threadIdx.x; i < num_points; i += blockDim.x) {
+    const double x1_0 = points1[2 * i + 0];
+    const double x1_1 = points1[2 * i + 1];
+    const double x2_0 = points2[2 * i + 0];
+    const double x2_1 = points2[2 * i + 1];
+    double residual;
+    if (residual_type == TwoViewResidualType::SAMPSON) {
+      residual = ComputeSquaredSampsonError(model, x1_0, x1_1, x2_0, x2_1);
+    } else {
+      residual = ComputeSquaredTransferError(model, x1_0, x1_1, x2_0, x2_1);
+    }
+    if (residual <= max_residual) {
+      thread_num_inliers += 1;
+      thread_residual_sum += residual;
+    }
+  }
+
+  block_num_inliers[threadIdx.x] = thread_num_inliers;
+  block_residual_sums[threadIdx.x] = thread_residual_sum;
+  __syncthreads();
+
+  for (int stride = blockDim.x / 2; stride > 0; stride /= 2) {
+    if (threadIdx.x < stride) {
+      block_num_inliers[threadIdx.x] += block_num_inliers[threadIdx.x + stride];
+      block_residual_sums[threadIdx.x] +=
+          block_residual_sums[threadIdx.x + stride];
+    }
+    __syncthreads();
+  }
+
+  if (threadIdx.x == 0) {
+    num_inliers[blockIdx.x] = block_num_inliers[0];
+    residual_sums[blockIdx.x] = block_residual_sums[0];
+  }
+}
+
+}  // namespace
+
+void EvaluateTwoViewModelsCUDA(
+    const TwoViewResidualType residual_type,
+    const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Matrix3d>& models, const double max_residual,
+    std::vector<InlierSupportMeasurer::Support>* supports) {
+  CHECK_EQ(points1.size(), points2.size());
+  CHECK_NOTNULL(supports);
+
+  supports->clear();
+  if (models.empty()) {
+    return;
+  }
+
+  const int num_points = static_cast<int>(points1.size());
+  const int num_models = static_cast<int>(models.size());
+
+  // Pack the points and models contiguously, since the points may be padded
+  // and the models are not necessarily stored contiguously.
+  std::vector<double> host_points(4 * num_points);
+  for (int i = 0; i < num_points; ++i) {
+    host_points[2 * i + 0] = points1[i](0);
+    host_points[2 * i + 1] = points1[i](1);
+    host_points[2 * (num_points + i) + 0] = points2[i](0);
+    host_points[2 * (num_points + i) + 1] = points2[i](1);
+  }
+
+  std::vector<double> host_models(9 * num_models);
+  for (int i = 0; i < num_models; ++i) {
+    Eigen::Map<Eigen::Matrix3d>(host_models.data() + 9 * i) = models[i];
+  }
+
+  double* points_device;
+  double* models_device;
+  int* num_inliers_device;
+  double* residual_sums_device;
+  CUDA_SAFE_CALL(
+      cudaMalloc(&points_device, host_points.size() * sizeof(double)));
+  CUDA_SAFE_CALL(
+      cudaMalloc(&models_device, host_models.size() * sizeof(double)));
+  CUDA_SAFE_CALL(cudaMalloc(&num_inliers_device, num_models * sizeof(int)));
+  CUDA_SAFE_CALL(
+      cudaMalloc(&residual_sums_device, num_models * sizeof(double)));
+
+  CUDA_SAFE_CALL(cudaMemcpy(points_device, host_points.data(),
+                            host_points.size() * sizeof(double),
+                            cudaMemcpyHostToDevice));
+  CUDA_SAFE_CALL(cudaMemcpy(models_device, host_models.data(),
+                            host_models.size() * sizeof(double),
+                            cudaMemcpyHostToDevice));
+
+  EvaluateModelsKernel<<<num_models, kBlockSize>>>(
+      residual_type, points_device, points_device + 2 * num_points, num_points,
+      models_device, max_residual, num_inliers_device, residual_sums_device);
+  CUDA_SYNC_AND_CHECK();
+
+  std::vector<int> num_inliers(num_models);
+  std::vector<double> residual_sums(num_models);
+  CUDA_SAFE_CALL(cudaMemcpy(num_inliers.data(), num_inliers_device,
+                            num_models * sizeof(int), cudaMemcpyDeviceToHost));
+  CUDA_SAFE_CALL(cudaMemcpy(residual_sums.data(), residual_sums_device,
+                            num_models * sizeof(double),
+                            cudaMemcpyDeviceToHost));
+
+  CUDA_SAFE_CALL(cudaFree(points_device));
+  CUDA_SAFE_CALL(cudaFree(models_device));
+  CUDA_SAFE_CALL(cudaFree(num_inliers_device));
+  CUDA_SAFE_CALL(cudaFree(residual_sums_device));
+
+  supports->resize(num_models);
+  for (int i = 0; i < num_models; ++i) {
+    (*supports)[i].num_inliers = static_cast<size_t>(num_inliers[i]);
+    (*supports)[i].residual_sum = residual_sums[i];
+  }
+}
+
+}  // namespace colmap
@@ -0,0 +1,73 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+#ifndef COLMAP_SRC_ESTIMATORS_TWO_VIEW_GEOMETRY_CUDA_H_
+#define COLMAP_SRC_ESTIMATORS_TWO_VIEW_GEOMETRY_CUDA_H_
+
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "optim/support_measurement.h"
+#include "util/alignment.h"
+#include "util/types.h"
+
+namespace colmap {
+
+enum class TwoViewResidualType {
+  // Squared Sampson error of an essential or fundamental matrix.
+  SAMPSON,
+  // Squared transfer error of a homography.
+  TRANSFER,
+};
+
+// Evaluate the inlier support of multiple two-view models for the same set of
+// corresponding points in a single kernel launch on the current CUDA device.
+// The result is equivalent to computing the residuals with
+// `ComputeSquaredSampsonError` or `ComputeSquaredTransferError` and measuring
+// their support with `InlierSupportMeasurer`, up to floating point rounding.
+//
+// @param residual_type  The residual of the models.
+// @param points1        First set of corresponding points.
+// @param points2        Second set of corresponding points.
+// @param models         The 3x3 models to evaluate.
+// @param max_residual   Maximum residual for a point to be an inlier.
+// @param supports       The output support of each model.
+void EvaluateTwoViewModelsCUDA(
+    const TwoViewResidualType residual_type,
+    const std::vector<Eigen::Vector2d>& points1,
+    const std::vector<Eigen::Vector2d>& points2,
+    const std::vector<Eigen::Matrix3d>& models, const double max_residual,
+    std::vector<InlierSupportMeasurer::Support>* supports);
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_ESTIMATORS_TWO_VIEW_GEOMETRY_CUDA_H_
@@ -32,8 +32,10 @@
 #define TEST_NAME "estimators/two_view_geometry"
 #include "util/testing.h"
 
+#include "base/camera.h"
 #include "base/pose.h"
 #include "estimators/two_view_geometry.h"
+#include "util/random.h"
 
 using namespace colmap;
 
@@ -83,3 +85,90 @@ BOOST_AUTO_TEST_CASE(TestInvert) {
   BOOST_CHECK_EQUAL(two_view_geometry.inlier_matches[1].point2D_idx1, 2);
   BOOST_CHECK_EQUAL(two_view_geometry.inlier_matches[1].point2D_idx2, 3);
 }
+
+BOOST_AUTO_TEST_CASE(TestEstimateCalibratedFastPath) {
+  SetPRNGSeed(0);
+
+  Camera camera;
+  camera.InitializeWithName("PINHOLE", 500, 1000, 1000);
+  camera.SetPriorFocalLength(true);
+
+  const Eigen::Matrix3d R =
+      Eigen::AngleAxisd(0.05, Eigen::Vector3d::UnitY()).toRotationMatrix();
+  const Eigen::Vector3d t(1, 0, 0);
+
+  std::vector<Eigen::Vector2d> points1;
+  std::vector<Eigen::Vector2d> points2;
+  FeatureMatches matches;
+  for (size_t i = 0; i < 200; ++i) {
+    const Eigen::Vector3d point3D(RandomReal(-5.0, 5.0), RandomReal(-5.0, 5.0),
+                                  RandomReal(10.0, 20.0));
+    points1.push_back(camera.WorldToImage(point3D.hnormalized()));
+    points2.push_back(camera.WorldToImage((R * point3D + t).hnormalized()));
+    matches.emplace_back(i, i);
+  }
+
+  TwoViewGeometry::Options options;
+  options.ransac_options.max_error = 1;
+  options.fast_path = true;
+
+  TwoViewGeometry two_view_geometry;
+  two_view_geometry.Estimate(camera, points1, camera, points2, matches,
+                             options);
+  BOOST_CHECK_EQUAL(two_view_geometry.config, TwoViewGeometry::CALIBRATED);
+  BOOST_CHECK_EQUAL(two_view_geometry.inlier_matches.size(), matches.size());
+  BOOST_CHECK_NE(two_view_geometry.F, Eigen::Matrix3d::Zero());
+  // The homography is only estimated in the full estimation.
+  BOOST_CHECK_EQUAL(two_view_geometry.H, Eigen::Matrix3d::Zero());
+
+  // Too many outliers for the fast path.
+  for (size_t i = 0; i < 60; ++i) {
+    points2[i] = Eigen::Vector2d(RandomReal(0.0, 1000.0),
+                                 RandomReal(0.0, 1000.0));
+  }
+
+  TwoViewGeometry full_two_view_geometry;
+  full_two_view_geometry.Estimate(camera, points1, camera, points2, matches,
+                                  options);
+  BOOST_CHECK_EQUAL(full_two_view_geometry.config,
+                    TwoViewGeometry::CALIBRATED);
+  BOOST_CHECK_NE(full_two_view_geometry.H, Eigen::Matrix3d::Zero());
+}
+
+BOOST_AUTO_TEST_CASE(TestEstimateCalibratedSturm) {
+  SetPRNGSeed(0);
+
+  Camera camera;
+  camera.InitializeWithName("PINHOLE", 500, 1000, 1000);
+  camera.SetPriorFocalLength(true);
+
+  const Eigen::Matrix3d R =
+      Eigen::AngleAxisd(0.05, Eigen::Vector3d::UnitY()).toRotationMatrix();
+  const Eigen::Vector3d t(1, 0, 0);
+
+  std::vector<Eigen::Vector2d> points1;
+  std::vector<Eigen::Vector2d> points2;
+  FeatureMatches matches;
+  for (size_t i = 0; i < 200; ++i) {
+    const Eigen::Vector3d point3D(RandomReal(-5.0, 5.0), RandomReal(-5.0, 5.0),
+                                  RandomReal(10.0, 20.0));
+    points1.push_back(camera.WorldToImage(point3D.hnormalized()));
+    if (i < 50) {
+      points2.emplace_back(RandomReal(0.0, 1000.0), RandomReal(0.0, 1000.0));
+    } else {
+      points2.push_back(camera.WorldToImage((R * point3D + t).hnormalized()));
+    }
+    matches.emplace_back(i, i);
+  }
+
+  TwoViewGeometry::Options options;
+  options.ransac_options.max_error = 1;
+  options.use_sturm_five_point = true;
+
+  TwoViewGeometry two_view_geometry;
+  two_view_geometry.Estimate(camera, points1, camera, points2, matches,
+                             options);
+  BOOST_CHECK_EQUAL(two_view_geometry.config, TwoViewGeometry::CALIBRATED);
+  BOOST_CHECK_GE(two_view_geometry.inlier_matches.size(), 150);
+  BOOST_CHECK_LT(two_view_geometry.inlier_matches.size(), 160);
+}
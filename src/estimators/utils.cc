@@ -31,56 +31,350 @@
 
 #include "estimators/utils.h"
 
+#if defined(SIMD_ENABLED) && (defined(__AVX__) || defined(__SSE2__))
+#include <immintrin.h>
+#define VECTORIZED_RESIDUALS
+#endif
+
 #include "util/logging.h"
 
 namespace colmap {
+namespace {
+
+#ifdef VECTORIZED_RESIDUALS
+
+// Thin wrappers around the SSE2 and AVX double precision intrinsics, such that
+// the residual kernels below are written only once. The points are stored as
+// arrays of Eigen vectors and are transposed into one packet per coordinate
+// while loading, which avoids repacking the points for every model.
+#if defined(__AVX__)
+
+typedef __m256d Packet;
+const size_t kPacketSize = 4;
+
+inline Packet PSet(const double value) { return _mm256_set1_pd(value); }
+inline Packet PSetInterleaved(const double a, const double b) {
+  return _mm256_set_pd(b, a, b, a);
+}
+inline Packet PLoad(const double* data) { return _mm256_loadu_pd(data); }
+inline Packet PAdd(const Packet a, const Packet b) {
+  return _mm256_add_pd(a, b);
+}
+inline Packet PSub(const Packet a, const Packet b) {
+  return _mm256_sub_pd(a, b);
+}
+inline Packet PMul(const Packet a, const Packet b) {
+  return _mm256_mul_pd(a, b);
+}
+inline Packet PDiv(const Packet a, const Packet b) {
+  return _mm256_div_pd(a, b);
+}
+
+// Select the elements of `a` where `a_cond > b_cond`, otherwise of `b`.
+inline Packet PSelectGreater(const Packet a_cond, const Packet b_cond,
+                             const Packet a, const Packet b) {
+  return _mm256_blendv_pd(b, a, _mm256_cmp_pd(a_cond, b_cond, _CMP_GT_OQ));
+}
+
+inline void PStore(double* data, const Packet a) { _mm256_storeu_pd(data, a); }
+
+inline void PLoadPoints(const Eigen::Vector2d* points, Packet* x, Packet* y) {
+  const __m256d p01 = _mm256_loadu_pd(points[0].data());
+  const __m256d p23 = _mm256_loadu_pd(points[2].data());
+  const __m256d p02 = _mm256_permute2f128_pd(p01, p23, 0x20);
+  const __m256d p13 = _mm256_permute2f128_pd(p01, p23, 0x31);
+  *x = _mm256_unpacklo_pd(p02, p13);
+  *y = _mm256_unpackhi_pd(p02, p13);
+}
+
+inline void PLoadPoints(const Eigen::Vector3d* points, Packet* x, Packet* y,
+                        Packet* z) {
+  const double* data = points[0].data();
+  *x = _mm256_set_pd(data[9], data[6], data[3], data[0]);
+  *y = _mm256_set_pd(data[10], data[7], data[4], data[1]);
+  *z = _mm256_set_pd(data[11], data[8], data[5], data[2]);
+}
+
+typedef __m256 PacketF;
+const size_t kPacketSizeF = 8;
+
+inline PacketF PSet(const float value) { return _mm256_set1_ps(value); }
+inline PacketF PAdd(const PacketF a, const PacketF b) {
+  return _mm256_add_ps(a, b);
+}
+inline PacketF PMul(const PacketF a, const PacketF b) {
+  return _mm256_mul_ps(a, b);
+}
+inline PacketF PDiv(const PacketF a, const PacketF b) {
+  return _mm256_div_ps(a, b);
+}
+
+inline void PStore(float* data, const PacketF a) { _mm256_storeu_ps(data, a); }
+
+inline void PLoadPoints(const Eigen::Vector2f* points, PacketF* x,
+                        PacketF* y) {
+  const __m256 p0123 = _mm256_loadu_ps(points[0].data());
+  const __m256 p4567 = _mm256_loadu_ps(points[4].data());
+  const __m256 p0145 = _mm256_permute2f128_ps(p0123, p4567, 0x20);
+  const __m256 p2367 = _mm256_permute2f128_ps(p0123, p4567, 0x31);
+  *x = _mm256_shuffle_ps(p0145, p2367, _MM_SHUFFLE(2, 0, 2, 0));
+  *y = _mm256_shuffle_ps(p0145, p2367, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+#else
+
+typedef __m128d Packet;
+const size_t kPacketSize = 2;
+
+inline Packet PSet(const double value) { return _mm_set1_pd(value); }
+inline Packet PSetInterleaved(const double a, const double b) {
+  return _mm_set_pd(b, a);
+}
+inline Packet PLoad(const double* data) { return _mm_loadu_pd(data); }
+inline Packet PAdd(const Packet a, const Packet b) { return _mm_add_pd(a, b); }
+inline Packet PSub(const Packet a, const Packet b) { return _mm_sub_pd(a, b); }
+inline Packet PMul(const Packet a, const Packet b) { return _mm_mul_pd(a, b); }
+inline Packet PDiv(const Packet a, const Packet b) { return _mm_div_pd(a, b); }
+
+// Select the elements of `a` where `a_cond > b_cond`, otherwise of `b`.
+inline Packet PSelectGreater(const Packet a_cond, const Packet b_cond,
+                             const Packet a, const Packet b) {
+  const __m128d mask = _mm_cmpgt_pd(a_cond, b_cond);
+  return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+inline void PStore(double* data, const Packet a) { _mm_storeu_pd(data, a); }
+
+inline void PLoadPoints(const Eigen::Vector2d* points, Packet* x, Packet* y) {
+  const __m128d p0 = _mm_loadu_pd(points[0].data());
+  const __m128d p1 = _mm_loadu_pd(points[1].data());
+  *x = _mm_unpacklo_pd(p0, p1);
+  *y = _mm_unpackhi_pd(p0, p1);
+}
+
+inline void PLoadPoints(const Eigen::Vector3d* points, Packet* x, Packet* y,
+                        Packet* z) {
+  const double* data = points[0].data();
+  const __m128d v0 = _mm_loadu_pd(data);
+  const __m128d v1 = _mm_loadu_pd(data + 2);
+  const __m128d v2 = _mm_loadu_pd(data + 4);
+  *x = _mm_shuffle_pd(v0, v1, 2);
+  *y = _mm_shuffle_pd(v0, v2, 1);
+  *z = _mm_shuffle_pd(v1, v2, 2);
+}
+
+typedef __m128 PacketF;
+const size_t kPacketSizeF = 4;
+
+inline PacketF PSet(const float value) { return _mm_set1_ps(value); }
+inline PacketF PAdd(const PacketF a, const PacketF b) {
+  return _mm_add_ps(a, b);
+}
+inline PacketF PMul(const PacketF a, const PacketF b) {
+  return _mm_mul_ps(a, b);
+}
+inline PacketF PDiv(const PacketF a, const PacketF b) {
+  return _mm_div_ps(a, b);
+}
+
+inline void PStore(float* data, const PacketF a) { _mm_storeu_ps(data, a); }
+
+inline void PLoadPoints(const Eigen::Vector2f* points, PacketF* x,
+                        PacketF* y) {
+  const __m128 p01 = _mm_loadu_ps(points[0].data());
+  const __m128 p23 = _mm_loadu_ps(points[2].data());
+  *x = _mm_shuffle_ps(p01, p23, _MM_SHUFFLE(2, 0, 2, 0));
+  *y = _mm_shuffle_ps(p01, p23, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+#endif
+
+// Maps the scalar type of the templated kernels to its packet type.
+template <typename T>
+struct PacketTraits;
+
+template <>
+struct PacketTraits<double> {
+  typedef Packet Type;
+  static const size_t kSize = kPacketSize;
+};
+
+template <>
+struct PacketTraits<float> {
+  typedef PacketF Type;
+  static const size_t kSize = kPacketSizeF;
+};
+
+#endif  // VECTORIZED_RESIDUALS
+
+template <typename T>
+void ComputeSquaredSampsonErrorKernel(const Eigen::Matrix<T, 2, 1>* points1,
+                                      const Eigen::Matrix<T, 2, 1>* points2,
+                                      const size_t num_points,
+                                      const Eigen::Matrix<T, 3, 3>& E,
+                                      T* residuals) {
+  // Note that this code might not be as nice as Eigen expressions,
+  // but it is significantly faster in various tests
+
+  const T E_00 = E(0, 0);
+  const T E_01 = E(0, 1);
+  const T E_02 = E(0, 2);
+  const T E_10 = E(1, 0);
+  const T E_11 = E(1, 1);
+  const T E_12 = E(1, 2);
+  const T E_20 = E(2, 0);
+  const T E_21 = E(2, 1);
+  const T E_22 = E(2, 2);
+
+  size_t i = 0;
+
+#ifdef VECTORIZED_RESIDUALS
+  // The packets evaluate the same expressions as the scalar code below.
+  typedef typename PacketTraits<T>::Type P;
+  const size_t kSize = PacketTraits<T>::kSize;
+
+  const P pE_00 = PSet(E_00);
+  const P pE_01 = PSet(E_01);
+  const P pE_02 = PSet(E_02);
+  const P pE_10 = PSet(E_10);
+  const P pE_11 = PSet(E_11);
+  const P pE_12 = PSet(E_12);
+  const P pE_20 = PSet(E_20);
+  const P pE_21 = PSet(E_21);
+  const P pE_22 = PSet(E_22);
+
+  for (; i + kSize <= num_points; i += kSize) {
+    P x1_0, x1_1, x2_0, x2_1;
+    PLoadPoints(&points1[i], &x1_0, &x1_1);
+    PLoadPoints(&points2[i], &x2_0, &x2_1);
+
+    const P Ex1_0 = PAdd(PAdd(PMul(pE_00, x1_0), PMul(pE_01, x1_1)), pE_02);
+    const P Ex1_1 = PAdd(PAdd(PMul(pE_10, x1_0), PMul(pE_11, x1_1)), pE_12);
+    const P Ex1_2 = PAdd(PAdd(PMul(pE_20, x1_0), PMul(pE_21, x1_1)), pE_22);
+
+    const P Etx2_0 = PAdd(PAdd(PMul(pE_00, x2_0), PMul(pE_10, x2_1)), pE_20);
+    const P Etx2_1 = PAdd(PAdd(PMul(pE_01, x2_0), PMul(pE_11, x2_1)), pE_21);
+
+    const P x2tEx1 = PAdd(PAdd(PMul(x2_0, Ex1_0), PMul(x2_1, Ex1_1)), Ex1_2);
+
+    PStore(residuals + i,
+           PDiv(PMul(x2tEx1, x2tEx1),
+                PAdd(PAdd(PAdd(PMul(Ex1_0, Ex1_0), PMul(Ex1_1, Ex1_1)),
+                          PMul(Etx2_0, Etx2_0)),
+                     PMul(Etx2_1, Etx2_1))));
+  }
+#endif
+
+  for (; i < num_points; ++i) {
+    const T x1_0 = points1[i](0);
+    const T x1_1 = points1[i](1);
+    const T x2_0 = points2[i](0);
+    const T x2_1 = points2[i](1);
+
+    // Ex1 = E * points1[i].homogeneous();
+    const T Ex1_0 = E_00 * x1_0 + E_01 * x1_1 + E_02;
+    const T Ex1_1 = E_10 * x1_0 + E_11 * x1_1 + E_12;
+    const T Ex1_2 = E_20 * x1_0 + E_21 * x1_1 + E_22;
+
+    // Etx2 = E.transpose() * points2[i].homogeneous();
+    const T Etx2_0 = E_00 * x2_0 + E_10 * x2_1 + E_20;
+    const T Etx2_1 = E_01 * x2_0 + E_11 * x2_1 + E_21;
+
+    // x2tEx1 = points2[i].homogeneous().transpose() * Ex1;
+    const T x2tEx1 = x2_0 * Ex1_0 + x2_1 * Ex1_1 + Ex1_2;
+
+    // Sampson distance
+    residuals[i] =
+        x2tEx1 * x2tEx1 /
+        (Ex1_0 * Ex1_0 + Ex1_1 * Ex1_1 + Etx2_0 * Etx2_0 + Etx2_1 * Etx2_1);
+  }
+}
+
+}  // namespace
 
 void CenterAndNormalizeImagePoints(const std::vector<Eigen::Vector2d>& points,
                                    std::vector<Eigen::Vector2d>* normed_points,
                                    Eigen::Matrix3d* matrix) {
+  normed_points->resize(points.size());
+  CenterAndNormalizeImagePoints(points.data(), points.size(),
+                                normed_points->data(), matrix);
+}
+
+void CenterAndNormalizeImagePoints(const Eigen::Vector2d* points,
+                                   const size_t num_points,
+                                   Eigen::Vector2d* normed_points,
+                                   Eigen::Matrix3d* matrix) {
+  // The points are processed as a flat array of interleaved coordinates. The
+  // packet size is even, so that even elements are x and odd elements are y.
+  const size_t num_values = 2 * num_points;
+  const double* values = num_points > 0 ? points[0].data() : nullptr;
+  double* normed_values = num_points > 0 ? normed_points[0].data() : nullptr;
+
   // Calculate centroid
   Eigen::Vector2d centroid(0, 0);
-  for (const auto point : points) {
-    centroid += point;
+  size_t i = 0;
+#ifdef VECTORIZED_RESIDUALS
+  Packet sum = PSet(0.0);
+  for (; i + kPacketSize <= num_values; i += kPacketSize) {
+    sum = PAdd(sum, PLoad(values + i));
+  }
+  double sums[kPacketSize];
+  PStore(sums, sum);
+  for (size_t j = 0; j < kPacketSize; j += 2) {
+    centroid(0) += sums[j];
+    centroid(1) += sums[j + 1];
   }
-  centroid /= points.size();
+#endif
+  for (; i < num_values; i += 2) {
+    centroid(0) += values[i];
+    centroid(1) += values[i + 1];
+  }
+  centroid /= num_points;
 
   // Root mean square error to centroid of all points
   double rms_mean_dist = 0;
-  for (const auto point : points) {
-    rms_mean_dist += (point - centroid).squaredNorm();
+  i = 0;
+#ifdef VECTORIZED_RESIDUALS
+  const Packet pcentroid = PSetInterleaved(centroid(0), centroid(1));
+  Packet sum_sq = PSet(0.0);
+  for (; i + kPacketSize <= num_values; i += kPacketSize) {
+    const Packet diff = PSub(PLoad(values + i), pcentroid);
+    sum_sq = PAdd(sum_sq, PMul(diff, diff));
+  }
+  double sums_sq[kPacketSize];
+  PStore(sums_sq, sum_sq);
+  for (size_t j = 0; j < kPacketSize; ++j) {
+    rms_mean_dist += sums_sq[j];
   }
-  rms_mean_dist = std::sqrt(rms_mean_dist / points.size());
+#endif
+  for (; i < num_values; i += 2) {
+    const double diff_0 = values[i] - centroid(0);
+    const double diff_1 = values[i + 1] - centroid(1);
+    rms_mean_dist += diff_0 * diff_0 + diff_1 * diff_1;
+  }
+  rms_mean_dist = std::sqrt(rms_mean_dist / num_points);
 
   // Compose normalization matrix
   const double norm_factor = std::sqrt(2.0) / rms_mean_dist;
   *matrix << norm_factor, 0, -norm_factor * centroid(0), 0, norm_factor,
       -norm_factor * centroid(1), 0, 0, 1;
 
-  // Apply normalization matrix
-  normed_points->resize(points.size());
+  // Apply normalization matrix, which is a pure scaling and translation.
+  const double offset_0 = (*matrix)(0, 2);
+  const double offset_1 = (*matrix)(1, 2);
 
-  const double M_00 = (*matrix)(0, 0);
-  const double M_01 = (*matrix)(0, 1);
-  const double M_02 = (*matrix)(0, 2);
-  const double M_10 = (*matrix)(1, 0);
-  const double M_11 = (*matrix)(1, 1);
-  const double M_12 = (*matrix)(1, 2);
-  const double M_20 = (*matrix)(2, 0);
-  const double M_21 = (*matrix)(2, 1);
-  const double M_22 = (*matrix)(2, 2);
-
-  for (size_t i = 0; i < points.size(); ++i) {
-    const double p_0 = points[i](0);
-    const double p_1 = points[i](1);
-
-    const double np_0 = M_00 * p_0 + M_01 * p_1 + M_02;
-    const double np_1 = M_10 * p_0 + M_11 * p_1 + M_12;
-    const double np_2 = M_20 * p_0 + M_21 * p_1 + M_22;
-
-    const double inv_np_2 = 1.0 / np_2;
-    (*normed_points)[i](0) = np_0 * inv_np_2;
-    (*normed_points)[i](1) = np_1 * inv_np_2;
+  i = 0;
+#ifdef VECTORIZED_RESIDUALS
+  const Packet pnorm_factor = PSet(norm_factor);
+  const Packet poffset = PSetInterleaved(offset_0, offset_1);
+  for (; i + kPacketSize <= num_values; i += kPacketSize) {
+    PStore(normed_values + i,
+           PAdd(PMul(pnorm_factor, PLoad(values + i)), poffset));
+  }
+#endif
+  for (; i < num_values; i += 2) {
+    normed_values[i] = norm_factor * values[i] + offset_0;
+    normed_values[i + 1] = norm_factor * values[i + 1] + offset_1;
   }
 }
 
@@ -89,45 +383,23 @@ void ComputeSquaredSampsonError(const std::vector<Eigen::Vector2d>& points1,
                                 const Eigen::Matrix3d& E,
                                 std::vector<double>* residuals) {
   CHECK_EQ(points1.size(), points2.size());
-
   residuals->resize(points1.size());
+  ComputeSquaredSampsonErrorKernel(points1.data(), points2.data(),
+                                   points1.size(), E, residuals->data());
+}
 
-  // Note that this code might not be as nice as Eigen expressions,
-  // but it is significantly faster in various tests
-
-  const double E_00 = E(0, 0);
-  const double E_01 = E(0, 1);
-  const double E_02 = E(0, 2);
-  const double E_10 = E(1, 0);
-  const double E_11 = E(1, 1);
-  const double E_12 = E(1, 2);
-  const double E_20 = E(2, 0);
-  const double E_21 = E(2, 1);
-  const double E_22 = E(2, 2);
-
-  for (size_t i = 0; i < points1.size(); ++i) {
-    const double x1_0 = points1[i](0);
-    const double x1_1 = points1[i](1);
-    const double x2_0 = points2[i](0);
-    const double x2_1 = points2[i](1);
-
-    // Ex1 = E * points1[i].homogeneous();
-    const double Ex1_0 = E_00 * x1_0 + E_01 * x1_1 + E_02;
-    const double Ex1_1 = E_10 * x1_0 + E_11 * x1_1 + E_12;
-    const double Ex1_2 = E_20 * x1_0 + E_21 * x1_1 + E_22;
-
-    // Etx2 = E.transpose() * points2[i].homogeneous();
-    const double Etx2_0 = E_00 * x2_0 + E_10 * x2_1 + E_20;
-    const double Etx2_1 = E_01 * x2_0 + E_11 * x2_1 + E_21;
-
-    // x2tEx1 = points2[i].homogeneous().transpose() * Ex1;
-    const double x2tEx1 = x2_0 * Ex1_0 + x2_1 * Ex1_1 + Ex1_2;
+void ComputeSquaredSampsonError(const Eigen::Vector2d* points1,
+                                const Eigen::Vector2d* points2,
+                                const size_t num_points,
+                                const Eigen::Matrix3d& E, double* residuals) {
+  ComputeSquaredSampsonErrorKernel(points1, points2, num_points, E, residuals);
+}
 
-    // Sampson distance
-    (*residuals)[i] =
-        x2tEx1 * x2tEx1 /
-        (Ex1_0 * Ex1_0 + Ex1_1 * Ex1_1 + Etx2_0 * Etx2_0 + Etx2_1 * Etx2_1);
-  }
+void ComputeSquaredSampsonError(const Eigen::Vector2f* points1,
+                                const Eigen::Vector2f* points2,
+                                const size_t num_points,
+                                const Eigen::Matrix3f& E, float* residuals) {
+  ComputeSquaredSampsonErrorKernel(points1, points2, num_points, E, residuals);
 }
 
 void ComputeSquaredReprojectionError(
@@ -135,9 +407,17 @@ void ComputeSquaredReprojectionError(
     const std::vector<Eigen::Vector3d>& points3D,
     const Eigen::Matrix3x4d& proj_matrix, std::vector<double>* residuals) {
   CHECK_EQ(points2D.size(), points3D.size());
-
   residuals->resize(points2D.size());
+  ComputeSquaredReprojectionError(points2D.data(), points3D.data(),
+                                  points2D.size(), proj_matrix,
+                                  residuals->data());
+}
 
+void ComputeSquaredReprojectionError(const Eigen::Vector2d* points2D,
+                                     const Eigen::Vector3d* points3D,
+                                     const size_t num_points,
+                                     const Eigen::Matrix3x4d& proj_matrix,
+                                     double* residuals) {
   // Note that this code might not be as nice as Eigen expressions,
   // but it is significantly faster in various tests.
 
@@ -154,7 +434,54 @@ void ComputeSquaredReprojectionError(
   const double P_22 = proj_matrix(2, 2);
   const double P_23 = proj_matrix(2, 3);
 
-  for (size_t i = 0; i < points2D.size(); ++i) {
+  size_t i = 0;
+
+#ifdef VECTORIZED_RESIDUALS
+  // The packets evaluate the same expressions as the scalar code below.
+  const Packet pP_00 = PSet(P_00);
+  const Packet pP_01 = PSet(P_01);
+  const Packet pP_02 = PSet(P_02);
+  const Packet pP_03 = PSet(P_03);
+  const Packet pP_10 = PSet(P_10);
+  const Packet pP_11 = PSet(P_11);
+  const Packet pP_12 = PSet(P_12);
+  const Packet pP_13 = PSet(P_13);
+  const Packet pP_20 = PSet(P_20);
+  const Packet pP_21 = PSet(P_21);
+  const Packet pP_22 = PSet(P_22);
+  const Packet pP_23 = PSet(P_23);
+  const Packet kOne = PSet(1.0);
+  const Packet kEps = PSet(std::numeric_limits<double>::epsilon());
+  const Packet kMax = PSet(std::numeric_limits<double>::max());
+
+  for (; i + kPacketSize <= num_points; i += kPacketSize) {
+    Packet X_0, X_1, X_2;
+    PLoadPoints(&points3D[i], &X_0, &X_1, &X_2);
+    Packet x_0, x_1;
+    PLoadPoints(&points2D[i], &x_0, &x_1);
+
+    const Packet px_0 = PAdd(
+        PAdd(PAdd(PMul(pP_00, X_0), PMul(pP_01, X_1)), PMul(pP_02, X_2)),
+        pP_03);
+    const Packet px_1 = PAdd(
+        PAdd(PAdd(PMul(pP_10, X_0), PMul(pP_11, X_1)), PMul(pP_12, X_2)),
+        pP_13);
+    const Packet px_2 = PAdd(
+        PAdd(PAdd(PMul(pP_20, X_0), PMul(pP_21, X_1)), PMul(pP_22, X_2)),
+        pP_23);
+
+    // Points behind the camera are masked out after the projection.
+    const Packet inv_px_2 = PDiv(kOne, px_2);
+    const Packet dx_0 = PSub(x_0, PMul(px_0, inv_px_2));
+    const Packet dx_1 = PSub(x_1, PMul(px_1, inv_px_2));
+
+    PStore(residuals + i,
+           PSelectGreater(px_2, kEps,
+                          PAdd(PMul(dx_0, dx_0), PMul(dx_1, dx_1)), kMax));
+  }
+#endif
+
+  for (; i < num_points; ++i) {
     const double X_0 = points3D[i](0);
     const double X_1 = points3D[i](1);
     const double X_2 = points3D[i](2);
@@ -174,11 +501,88 @@ void ComputeSquaredReprojectionError(
       const double dx_0 = x_0 - px_0 * inv_px_2;
       const double dx_1 = x_1 - px_1 * inv_px_2;
 
-      (*residuals)[i] = dx_0 * dx_0 + dx_1 * dx_1;
+      residuals[i] = dx_0 * dx_0 + dx_1 * dx_1;
     } else {
-      (*residuals)[i] = std::numeric_limits<double>::max();
+      residuals[i] = std::numeric_limits<double>::max();
     }
   }
 }
 
+void ComputeSquaredTransferError(const std::vector<Eigen::Vector2d>& points1,
+                                 const std::vector<Eigen::Vector2d>& points2,
+                                 const Eigen::Matrix3d& H,
+                                 std::vector<double>* residuals) {
+  CHECK_EQ(points1.size(), points2.size());
+  residuals->resize(points1.size());
+  ComputeSquaredTransferError(points1.data(), points2.data(), points1.size(),
+                              H, residuals->data());
+}
+
+void ComputeSquaredTransferError(const Eigen::Vector2d* points1,
+                                 const Eigen::Vector2d* points2,
+                                 const size_t num_points,
+                                 const Eigen::Matrix3d& H, double* residuals) {
+  // Note that this code might not be as nice as Eigen expressions,
+  // but it is significantly faster in various tests.
+
+  const double H_00 = H(0, 0);
+  const double H_01 = H(0, 1);
+  const double H_02 = H(0, 2);
+  const double H_10 = H(1, 0);
+  const double H_11 = H(1, 1);
+  const double H_12 = H(1, 2);
+  const double H_20 = H(2, 0);
+  const double H_21 = H(2, 1);
+  const double H_22 = H(2, 2);
+
+  size_t i = 0;
+
+#ifdef VECTORIZED_RESIDUALS
+  // The packets evaluate the same expressions as the scalar code below.
+  const Packet pH_00 = PSet(H_00);
+  const Packet pH_01 = PSet(H_01);
+  const Packet pH_02 = PSet(H_02);
+  const Packet pH_10 = PSet(H_10);
+  const Packet pH_11 = PSet(H_11);
+  const Packet pH_12 = PSet(H_12);
+  const Packet pH_20 = PSet(H_20);
+  const Packet pH_21 = PSet(H_21);
+  const Packet pH_22 = PSet(H_22);
+  const Packet kOne = PSet(1.0);
+
+  for (; i + kPacketSize <= num_points; i += kPacketSize) {
+    Packet s_0, s_1, d_0, d_1;
+    PLoadPoints(&points1[i], &s_0, &s_1);
+    PLoadPoints(&points2[i], &d_0, &d_1);
+
+    const Packet pd_0 = PAdd(PAdd(PMul(pH_00, s_0), PMul(pH_01, s_1)), pH_02);
+    const Packet pd_1 = PAdd(PAdd(PMul(pH_10, s_0), PMul(pH_11, s_1)), pH_12);
+    const Packet pd_2 = PAdd(PAdd(PMul(pH_20, s_0), PMul(pH_21, s_1)), pH_22);
+
+    const Packet inv_pd_2 = PDiv(kOne, pd_2);
+    const Packet dd_0 = PSub(d_0, PMul(pd_0, inv_pd_2));
+    const Packet dd_1 = PSub(d_1, PMul(pd_1, inv_pd_2));
+
+    PStore(residuals + i, PAdd(PMul(dd_0, dd_0), PMul(dd_1, dd_1)));
+  }
+#endif
+
+  for (; i < num_points; ++i) {
+    const double s_0 = points1[i](0);
+    const double s_1 = points1[i](1);
+    const double d_0 = points2[i](0);
+    const double d_1 = points2[i](1);
+
+    const double pd_0 = H_00 * s_0 + H_01 * s_1 + H_02;
+    const double pd_1 = H_10 * s_0 + H_11 * s_1 + H_12;
+    const double pd_2 = H_20 * s_0 + H_21 * s_1 + H_22;
+
+    const double inv_pd_2 = 1.0 / pd_2;
+    const double dd_0 = d_0 - pd_0 * inv_pd_2;
+    const double dd_1 = d_1 - pd_1 * inv_pd_2;
+
+    residuals[i] = dd_0 * dd_0 + dd_1 * dd_1;
+  }
+}
+
 }  // namespace colmap
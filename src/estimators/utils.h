@@ -60,6 +60,18 @@ void CenterAndNormalizeImagePoints(const std::vector<Eigen::Vector2d>& points,
                                    std::vector<Eigen::Vector2d>* normed_points,
                                    Eigen::Matrix3d* matrix);
 
+// Same as above but writes into caller provided storage, so that repeated
+// calls do not allocate. The output may alias the input points.
+//
+// @param points          Array of `num_points` image coordinates.
+// @param num_points      Number of image coordinates.
+// @param normed_points   Array of `num_points` transformed image coordinates.
+// @param matrix          3x3 transformation matrix.
+void CenterAndNormalizeImagePoints(const Eigen::Vector2d* points,
+                                   const size_t num_points,
+                                   Eigen::Vector2d* normed_points,
+                                   Eigen::Matrix3d* matrix);
+
 // Calculate the residuals of a set of corresponding points and a given
 // fundamental or essential matrix.
 //
@@ -74,6 +86,22 @@ void ComputeSquaredSampsonError(const std::vector<Eigen::Vector2d>& points1,
                                 const Eigen::Matrix3d& E,
                                 std::vector<double>* residuals);
 
+// Same as above but writes `num_points` residuals into caller provided storage.
+void ComputeSquaredSampsonError(const Eigen::Vector2d* points1,
+                                const Eigen::Vector2d* points2,
+                                const size_t num_points,
+                                const Eigen::Matrix3d& E, double* residuals);
+
+// Single precision variant that processes twice as many points per SIMD
+// instruction. It is intended to quickly verify or pre-filter a model, e.g.,
+// for points given in normalized coordinates, where the reduced precision
+// does not matter. The result agrees with the double precision version up to
+// floating point rounding.
+void ComputeSquaredSampsonError(const Eigen::Vector2f* points1,
+                                const Eigen::Vector2f* points2,
+                                const size_t num_points,
+                                const Eigen::Matrix3f& E, float* residuals);
+
 // Calculate the squared reprojection error given a set of 2D-3D point
 // correspondences and a projection matrix. Returns DBL_MAX if a 3D point is
 // behind the given camera.
@@ -87,6 +115,32 @@ void ComputeSquaredReprojectionError(
     const std::vector<Eigen::Vector3d>& points3D,
     const Eigen::Matrix3x4d& proj_matrix, std::vector<double>* residuals);
 
+// Same as above but writes `num_points` residuals into caller provided storage.
+void ComputeSquaredReprojectionError(const Eigen::Vector2d* points2D,
+                                     const Eigen::Vector3d* points3D,
+                                     const size_t num_points,
+                                     const Eigen::Matrix3x4d& proj_matrix,
+                                     double* residuals);
+
+// Calculate the squared transfer error of a set of corresponding points and a
+// given homography matrix, i.e. the squared distance between the points in the
+// second set and the points of the first set transformed by the homography.
+//
+// @param points1     First set of corresponding points.
+// @param points2     Second set of corresponding points.
+// @param H           3x3 homography matrix.
+// @param residuals   Output vector of residuals.
+void ComputeSquaredTransferError(const std::vector<Eigen::Vector2d>& points1,
+                                 const std::vector<Eigen::Vector2d>& points2,
+                                 const Eigen::Matrix3d& H,
+                                 std::vector<double>* residuals);
+
+// Same as above but writes `num_points` residuals into caller provided storage.
+void ComputeSquaredTransferError(const Eigen::Vector2d* points1,
+                                 const Eigen::Vector2d* points2,
+                                 const size_t num_points,
+                                 const Eigen::Matrix3d& H, double* residuals);
+
 }  // namespace colmap
 
 #endif  // COLMAP_SRC_ESTIMATORS_UTILS_H_
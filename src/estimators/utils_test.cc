@@ -60,6 +60,36 @@ BOOST_AUTO_TEST_CASE(TestCenterAndNormalizeImagePoints) {
   BOOST_CHECK_LT(std::abs(mean_point[1]), 1e-6);
 }
 
+BOOST_AUTO_TEST_CASE(TestCenterAndNormalizeImagePointsInPlace) {
+  // Odd number of points to exercise both the vectorized and scalar paths.
+  std::vector<Eigen::Vector2d> points;
+  for (size_t i = 0; i < 13; ++i) {
+    points.push_back(Eigen::Vector2d::Random());
+  }
+
+  std::vector<Eigen::Vector2d> normed_points;
+  Eigen::Matrix3d matrix;
+  CenterAndNormalizeImagePoints(points, &normed_points, &matrix);
+
+  std::vector<Eigen::Vector2d> inplace_points = points;
+  Eigen::Matrix3d inplace_matrix;
+  CenterAndNormalizeImagePoints(inplace_points.data(), inplace_points.size(),
+                                inplace_points.data(), &inplace_matrix);
+
+  BOOST_CHECK_EQUAL(matrix, inplace_matrix);
+  double rms_dist = 0;
+  for (size_t i = 0; i < points.size(); ++i) {
+    BOOST_CHECK_EQUAL(normed_points[i], inplace_points[i]);
+    BOOST_CHECK_LT(
+        (normed_points[i] - (matrix * points[i].homogeneous()).hnormalized())
+            .norm(),
+        1e-12);
+    rms_dist += normed_points[i].squaredNorm();
+  }
+  BOOST_CHECK_CLOSE(std::sqrt(rms_dist / points.size()), std::sqrt(2.0),
+                    1e-6);
+}
+
 BOOST_AUTO_TEST_CASE(TestComputeSquaredSampsonError) {
   std::vector<Eigen::Vector2d> points1;
   points1.emplace_back(0, 0);
@@ -81,3 +111,113 @@ BOOST_AUTO_TEST_CASE(TestComputeSquaredSampsonError) {
   BOOST_CHECK_EQUAL(residuals[1], 0.5);
   BOOST_CHECK_EQUAL(residuals[2], 2);
 }
+
+BOOST_AUTO_TEST_CASE(TestComputeSquaredSampsonErrorVectorized) {
+  // Odd number of points to exercise both the vectorized and scalar paths.
+  std::vector<Eigen::Vector2d> points1;
+  std::vector<Eigen::Vector2d> points2;
+  for (size_t i = 0; i < 11; ++i) {
+    points1.push_back(Eigen::Vector2d::Random());
+    points2.push_back(Eigen::Vector2d::Random());
+  }
+
+  const Eigen::Matrix3d E = EssentialMatrixFromPose(
+      Eigen::Quaterniond(Eigen::Vector4d::Random().normalized())
+          .toRotationMatrix(),
+      Eigen::Vector3d::Random());
+
+  std::vector<double> residuals;
+  ComputeSquaredSampsonError(points1, points2, E, &residuals);
+
+  BOOST_CHECK_EQUAL(residuals.size(), points1.size());
+  for (size_t i = 0; i < points1.size(); ++i) {
+    const Eigen::Vector3d Ex1 = E * points1[i].homogeneous();
+    const Eigen::Vector3d Etx2 = E.transpose() * points2[i].homogeneous();
+    const double x2tEx1 = points2[i].homogeneous().dot(Ex1);
+    const double expected =
+        x2tEx1 * x2tEx1 / (Ex1.head<2>().squaredNorm() +
+                           Etx2.head<2>().squaredNorm());
+    BOOST_CHECK_CLOSE(residuals[i], expected, 1e-6);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestComputeSquaredSampsonErrorFloat) {
+  // Number of points to exercise both the vectorized and scalar paths.
+  std::vector<Eigen::Vector2d> points1;
+  std::vector<Eigen::Vector2d> points2;
+  std::vector<Eigen::Vector2f> points1f;
+  std::vector<Eigen::Vector2f> points2f;
+  for (size_t i = 0; i < 19; ++i) {
+    points1f.push_back(Eigen::Vector2f::Random());
+    points2f.push_back(Eigen::Vector2f::Random());
+    points1.push_back(points1f.back().cast<double>());
+    points2.push_back(points2f.back().cast<double>());
+  }
+
+  const Eigen::Matrix3d E = EssentialMatrixFromPose(
+      Eigen::Quaterniond(Eigen::Vector4d::Random().normalized())
+          .toRotationMatrix(),
+      Eigen::Vector3d::Random());
+
+  std::vector<double> residuals(points1.size());
+  ComputeSquaredSampsonError(points1.data(), points2.data(), points1.size(), E,
+                             residuals.data());
+
+  std::vector<float> residualsf(points1f.size());
+  ComputeSquaredSampsonError(points1f.data(), points2f.data(), points1f.size(),
+                             E.cast<float>(), residualsf.data());
+
+  for (size_t i = 0; i < points1.size(); ++i) {
+    BOOST_CHECK_LT(std::abs(residualsf[i] - residuals[i]),
+                   1e-4 * (1 + residuals[i]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestComputeSquaredReprojectionError) {
+  const Eigen::Matrix3x4d proj_matrix = Eigen::Matrix3x4d::Identity();
+
+  std::vector<Eigen::Vector2d> points2D;
+  std::vector<Eigen::Vector3d> points3D;
+  for (size_t i = 0; i < 11; ++i) {
+    points2D.push_back(Eigen::Vector2d::Random());
+    points3D.emplace_back(Eigen::Vector2d::Random().x(),
+                          Eigen::Vector2d::Random().y(), i % 3 == 0 ? -1 : 2);
+  }
+
+  std::vector<double> residuals;
+  ComputeSquaredReprojectionError(points2D, points3D, proj_matrix, &residuals);
+
+  BOOST_CHECK_EQUAL(residuals.size(), points2D.size());
+  for (size_t i = 0; i < points2D.size(); ++i) {
+    if (i % 3 == 0) {
+      BOOST_CHECK_EQUAL(residuals[i], std::numeric_limits<double>::max());
+    } else {
+      const double expected =
+          (points2D[i] - points3D[i].hnormalized()).squaredNorm();
+      BOOST_CHECK_CLOSE(residuals[i], expected, 1e-6);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestComputeSquaredTransferError) {
+  Eigen::Matrix3d H = Eigen::Matrix3d::Random();
+  H(2, 2) = 10;
+
+  std::vector<Eigen::Vector2d> points1;
+  std::vector<Eigen::Vector2d> points2;
+  for (size_t i = 0; i < 11; ++i) {
+    points1.push_back(Eigen::Vector2d::Random());
+    points2.push_back(Eigen::Vector2d::Random());
+  }
+
+  std::vector<double> residuals;
+  ComputeSquaredTransferError(points1, points2, H, &residuals);
+
+  BOOST_CHECK_EQUAL(residuals.size(), points1.size());
+  for (size_t i = 0; i < points1.size(); ++i) {
+    const double expected =
+        (points2[i] - (H * points1[i].homogeneous()).hnormalized())
+            .squaredNorm();
+    BOOST_CHECK_CLOSE(residuals[i], expected, 1e-6);
+  }
+}
@@ -33,13 +33,13 @@
 #define NOMINMAX
 #endif
 
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/property_tree/ptree.hpp>
-
 #include "base/similarity_transform.h"
 #include "controllers/automatic_reconstruction.h"
 #include "controllers/bundle_adjustment.h"
+#include "controllers/global_mapper.h"
 #include "controllers/hierarchical_mapper.h"
+#include "controllers/localization_server.h"
+#include "controllers/pipeline.h"
 #include "estimators/coordinate_frame.h"
 #include "feature/extraction.h"
 #include "feature/matching.h"
@@ -47,8 +47,12 @@
 #include "mvs/meshing.h"
 #include "mvs/patch_match.h"
 #include "retrieval/visual_index.h"
+#include "sfm/tiled_triangulator.h"
 #include "ui/main_window.h"
+#include "util/memory_accountant.h"
+#include "util/metrics.h"
 #include "util/opengl_utils.h"
+#include "util/profiling.h"
 #include "util/version.h"
 
 using namespace colmap;
@@ -111,6 +115,7 @@ int RunAutomaticReconstructor(int argc, char** argv) {
                            &reconstruction_options.single_camera);
   options.AddDefaultOption("sparse", &reconstruction_options.sparse);
   options.AddDefaultOption("dense", &reconstruction_options.dense);
+  options.AddDefaultOption("pipelined", &reconstruction_options.pipelined);
   options.AddDefaultOption("mesher", &mesher, "{poisson, delaunay}");
   options.AddDefaultOption("num_threads", &reconstruction_options.num_threads);
   options.AddDefaultOption("use_gpu", &reconstruction_options.use_gpu);
@@ -211,26 +216,35 @@ int RunBundleAdjuster(int argc, char** argv) {
 int RunColorExtractor(int argc, char** argv) {
   std::string input_path;
   std::string output_path;
+  int num_threads = -1;
 
   OptionManager options;
   options.AddImageOptions();
   options.AddDefaultOption("input_path", &input_path);
   options.AddRequiredOption("output_path", &output_path);
+  options.AddDefaultOption("num_threads", &num_threads);
   options.Parse(argc, argv);
 
   Reconstruction reconstruction;
   reconstruction.Read(input_path);
-  reconstruction.ExtractColorsForAllImages(*options.image_path);
+  reconstruction.ExtractColorsForAllImages(*options.image_path, num_threads);
   reconstruction.Write(output_path);
 
   return EXIT_SUCCESS;
 }
 
 int RunDatabaseCreator(int argc, char** argv) {
+  bool use_feature_store = false;
+
   OptionManager options;
   options.AddDatabaseOptions();
+  options.AddDefaultOption("use_feature_store", &use_feature_store);
   options.Parse(argc, argv);
 
+  if (use_feature_store) {
+    CreateDirIfNotExists(Database::FeatureStorePath(*options.database_path));
+  }
+
   Database database(*options.database_path);
 
   return EXIT_SUCCESS;
@@ -239,23 +253,40 @@ int RunDatabaseCreator(int argc, char** argv) {
 int RunDatabaseMerger(int argc, char** argv) {
   std::string database_path1;
   std::string database_path2;
+  std::string database_paths;
   std::string merged_database_path;
 
   OptionManager options;
-  options.AddRequiredOption("database_path1", &database_path1);
-  options.AddRequiredOption("database_path2", &database_path2);
+  options.AddDefaultOption("database_path1", &database_path1);
+  options.AddDefaultOption("database_path2", &database_path2);
+  options.AddDefaultOption("database_paths", &database_paths,
+                           "Comma-separated list of additional databases");
   options.AddRequiredOption("merged_database_path", &merged_database_path);
   options.Parse(argc, argv);
 
+  std::vector<std::string> paths;
+  for (const auto& path : CSVToVector<std::string>(database_paths)) {
+    paths.push_back(path);
+  }
+  if (!database_path2.empty()) {
+    paths.insert(paths.begin(), database_path2);
+  }
+  if (!database_path1.empty()) {
+    paths.insert(paths.begin(), database_path1);
+  }
+
+  if (paths.size() < 2) {
+    std::cout << "ERROR: At least two databases must be merged." << std::endl;
+    return EXIT_FAILURE;
+  }
+
   if (ExistsFile(merged_database_path)) {
     std::cout << "ERROR: Merged database file must not exist." << std::endl;
     return EXIT_FAILURE;
   }
 
-  Database database1(database_path1);
-  Database database2(database_path2);
   Database merged_database(merged_database_path);
-  Database::Merge(database1, database2, &merged_database);
+  Database::MergeShards(paths, &merged_database);
 
   return EXIT_SUCCESS;
 }
@@ -297,13 +328,16 @@ int RunStereoFuser(int argc, char** argv) {
   mvs::StereoFusion fuser(*options.stereo_fusion, workspace_path,
                           workspace_format, pmvs_option_name, input_type);
 
+  // Stream the fused points to the output, so that they are not all kept in
+  // memory for large scenes.
+  std::cout << "Writing output: " << output_path << std::endl;
+  mvs::FusedPointsWriter writer(output_path);
+  fuser.SetFusedPointsWriter(&writer);
+
   fuser.Start();
   fuser.Wait();
 
-  std::cout << "Writing output: " << output_path << std::endl;
-  WriteBinaryPlyPoints(output_path, fuser.GetFusedPoints());
-  mvs::WritePointsVisibility(output_path + ".vis",
-                             fuser.GetFusedPointsVisibility());
+  writer.Close();
 
   return EXIT_SUCCESS;
 }
@@ -316,9 +350,11 @@ int RunPoissonMesher(int argc, char** argv) {
   options.AddRequiredOption("input_path", &input_path);
   options.AddRequiredOption("output_path", &output_path);
   options.AddPoissonMeshingOptions();
+  options.AddMeshSimplificationOptions();
   options.Parse(argc, argv);
 
-  CHECK(mvs::PoissonMeshing(*options.poisson_meshing, input_path, output_path));
+  CHECK(mvs::PoissonMeshing(*options.poisson_meshing, input_path, output_path,
+                            *options.mesh_simplification));
 
   return EXIT_SUCCESS;
 }
@@ -371,15 +407,16 @@ int RunDelaunayMesher(int argc, char** argv) {
   options.AddDefaultOption("input_type", &input_type, "{dense, sparse}");
   options.AddRequiredOption("output_path", &output_path);
   options.AddDelaunayMeshingOptions();
+  options.AddMeshSimplificationOptions();
   options.Parse(argc, argv);
 
   StringToLower(&input_type);
   if (input_type == "sparse") {
     mvs::SparseDelaunayMeshing(*options.delaunay_meshing, input_path,
-                               output_path);
+                               output_path, *options.mesh_simplification);
   } else if (input_type == "dense") {
     mvs::DenseDelaunayMeshing(*options.delaunay_meshing, input_path,
-                              output_path);
+                              output_path, *options.mesh_simplification);
   } else {
     std::cout << "ERROR: Invalid input type - "
                  "supported values are 'sparse' and 'dense'."
@@ -431,6 +468,49 @@ int RunPatchMatchStereo(int argc, char** argv) {
 #endif  // CUDA_ENABLED
 }
 
+int RunPipeline(int argc, char** argv) {
+  PipelineController::Options pipeline_options;
+  std::string stages;
+
+  OptionManager options;
+  options.AddAllOptions();
+  options.AddRequiredOption("workspace_path", &pipeline_options.workspace_path);
+  options.AddRequiredOption(
+      "stages", &stages,
+      "Comma-separated list of the stage commands in their order, e.g., "
+      "feature_extractor,exhaustive_matcher,mapper,image_undistorter,"
+      "patch_match_stereo,stereo_fusion");
+  options.AddDefaultOption("fusion_input_type",
+                           &pipeline_options.fusion_input_type,
+                           "{photometric, geometric}");
+  options.Parse(argc, argv);
+
+  if (!PipelineController::ParseStages(stages, &pipeline_options.stages) ||
+      !pipeline_options.Check()) {
+    return EXIT_FAILURE;
+  }
+
+  const bool use_opengl =
+      kUseOpenGL &&
+      (options.sift_extraction->use_gpu || options.sift_matching->use_gpu);
+
+  ReconstructionManager reconstruction_manager;
+
+  if (use_opengl) {
+    QApplication app(argc, argv);
+    PipelineController controller(pipeline_options, &options,
+                                  &reconstruction_manager);
+    RunThreadWithOpenGLContext(&controller);
+  } else {
+    PipelineController controller(pipeline_options, &options,
+                                  &reconstruction_manager);
+    controller.Start();
+    controller.Wait();
+  }
+
+  return EXIT_SUCCESS;
+}
+
 int RunExhaustiveMatcher(int argc, char** argv) {
   OptionManager options;
   options.AddDatabaseOptions();
@@ -550,7 +630,8 @@ int RunFeatureImporter(int argc, char** argv) {
     return EXIT_FAILURE;
   }
 
-  FeatureImporter feature_importer(reader_options, import_path);
+  FeatureImporter feature_importer(reader_options, import_path,
+                                   options.sift_extraction->num_threads);
   feature_importer.Start();
   feature_importer.Wait();
 
@@ -733,6 +814,11 @@ int RunImageRectifier(int argc, char** argv) {
   options.AddDefaultOption("max_scale", &undistort_camera_options.max_scale);
   options.AddDefaultOption("max_image_size",
                            &undistort_camera_options.max_image_size);
+  options.AddDefaultOption("num_threads",
+                           &undistort_camera_options.num_threads);
+  options.AddDefaultOption(
+      "max_rectification_map_error",
+      &undistort_camera_options.max_rectification_map_error);
   options.Parse(argc, argv);
 
   Reconstruction reconstruction;
@@ -753,11 +839,13 @@ int RunImageRectifier(int argc, char** argv) {
 int RunImageRegistrator(int argc, char** argv) {
   std::string input_path;
   std::string output_path;
+  bool triangulate = false;
 
   OptionManager options;
   options.AddDatabaseOptions();
   options.AddRequiredOption("input_path", &input_path);
   options.AddRequiredOption("output_path", &output_path);
+  options.AddDefaultOption("triangulate", &triangulate);
   options.AddMapperOptions();
   options.Parse(argc, argv);
 
@@ -783,7 +871,9 @@ int RunImageRegistrator(int argc, char** argv) {
         static_cast<size_t>(options.mapper->min_num_matches);
     database_cache.Load(database, min_num_matches,
                         options.mapper->ignore_watermarks,
-                        options.mapper->image_names);
+                        options.mapper->image_names,
+                        options.mapper->correspondence_graph_path,
+                        options.mapper->num_threads);
     std::cout << std::endl;
     timer.PrintMinutes();
   }
@@ -798,19 +888,95 @@ int RunImageRegistrator(int argc, char** argv) {
 
   const auto mapper_options = options.mapper->Mapper();
 
-  for (const auto& image : reconstruction.Images()) {
-    if (image.second.IsRegistered()) {
-      continue;
+  std::vector<image_t> new_reg_image_ids;
+
+  if (options.mapper->reg_batch_size > 1) {
+    // The new images do not extend the model, so their poses can be estimated
+    // concurrently in batches. Images that were not registered, because
+    // another image of the batch refined their shared camera, are attempted
+    // once more in a later batch.
+    std::vector<image_t> image_ids;
+    for (const auto& image : reconstruction.Images()) {
+      if (!image.second.IsRegistered()) {
+        image_ids.push_back(image.first);
+      }
     }
 
-    PrintHeading1("Registering image #" + std::to_string(image.first) + " (" +
-                  std::to_string(reconstruction.NumRegImages() + 1) + ")");
+    std::unordered_set<image_t> retried_image_ids;
+    for (size_t i = 0; i < image_ids.size();) {
+      const size_t batch_size =
+          std::min(image_ids.size() - i,
+                   static_cast<size_t>(options.mapper->reg_batch_size));
+      const std::vector<image_t> batch_image_ids(
+          image_ids.begin() + i, image_ids.begin() + i + batch_size);
+      i += batch_size;
+
+      PrintHeading1(StringPrintf(
+          "Registering %d images (%d)", static_cast<int>(batch_size),
+          static_cast<int>(reconstruction.NumRegImages() + 1)));
+
+      const std::vector<image_t> reg_image_ids =
+          mapper.RegisterNextImages(mapper_options, batch_image_ids);
+
+      std::cout << StringPrintf("  => Registered %d / %d images",
+                                static_cast<int>(reg_image_ids.size()),
+                                static_cast<int>(batch_size))
+                << std::endl;
 
-    std::cout << "  => Image sees " << image.second.NumVisiblePoints3D()
-              << " / " << image.second.NumObservations() << " points"
-              << std::endl;
+      new_reg_image_ids.insert(new_reg_image_ids.end(), reg_image_ids.begin(),
+                               reg_image_ids.end());
+
+      std::unordered_set<camera_t> reg_camera_ids;
+      for (const image_t image_id : reg_image_ids) {
+        reg_camera_ids.insert(reconstruction.Image(image_id).CameraId());
+      }
+
+      for (const image_t image_id : batch_image_ids) {
+        const Image& image = reconstruction.Image(image_id);
+        if (!image.IsRegistered() &&
+            reg_camera_ids.count(image.CameraId()) > 0 &&
+            retried_image_ids.insert(image_id).second) {
+          image_ids.push_back(image_id);
+        }
+      }
+    }
+  } else {
+    for (const auto& image : reconstruction.Images()) {
+      if (image.second.IsRegistered()) {
+        continue;
+      }
 
-    mapper.RegisterNextImage(mapper_options, image.first);
+      PrintHeading1("Registering image #" + std::to_string(image.first) +
+                    " (" + std::to_string(reconstruction.NumRegImages() + 1) +
+                    ")");
+
+      std::cout << "  => Image sees " << image.second.NumVisiblePoints3D()
+                << " / " << image.second.NumObservations() << " points"
+                << std::endl;
+
+      if (mapper.RegisterNextImage(mapper_options, image.first)) {
+        new_reg_image_ids.push_back(image.first);
+      }
+    }
+  }
+
+  // The new images are only triangulated once all of them are registered,
+  // so that their poses are all estimated against the input model. They are
+  // triangulated in the order of their identifiers, so that the result does
+  // not depend on the order of the registrations.
+  if (triangulate) {
+    PrintHeading1("Triangulating " +
+                  std::to_string(new_reg_image_ids.size()) + " images");
+
+    std::sort(new_reg_image_ids.begin(), new_reg_image_ids.end());
+    const auto tri_options = options.mapper->Triangulation();
+    size_t num_tri_observations = 0;
+    for (const image_t image_id : new_reg_image_ids) {
+      num_tri_observations += mapper.TriangulateImage(tri_options, image_id);
+    }
+
+    std::cout << "  => Triangulated " << num_tri_observations
+              << " observations" << std::endl;
   }
 
   const bool kDiscardReconstruction = false;
@@ -844,6 +1010,12 @@ int RunImageUndistorter(int argc, char** argv) {
   options.AddDefaultOption("roi_min_y", &undistort_camera_options.roi_min_y);
   options.AddDefaultOption("roi_max_x", &undistort_camera_options.roi_max_x);
   options.AddDefaultOption("roi_max_y", &undistort_camera_options.roi_max_y);
+  options.AddDefaultOption("num_threads",
+                           &undistort_camera_options.num_threads);
+  options.AddDefaultOption("queue_size", &undistort_camera_options.queue_size);
+  options.AddDefaultOption("image_encoding",
+                           &undistort_camera_options.image_encoding,
+                           "{DEFAULT, FAST, UNCOMPRESSED, NONE}");
   options.Parse(argc, argv);
 
   CreateDirIfNotExists(output_path);
@@ -966,6 +1138,89 @@ int RunImageUndistorterStandalone(int argc, char** argv) {
   return EXIT_SUCCESS;
 }
 
+int RunLocalizationServer(int argc, char** argv) {
+  std::string input_path;
+  std::string vocab_tree_path;
+  LocalizationServer::Options server_options;
+
+  OptionManager options;
+  options.AddDatabaseOptions();
+  options.AddExtractionOptions();
+  options.AddRequiredOption("input_path", &input_path);
+  options.AddDefaultOption("port", &server_options.port);
+  options.AddDefaultOption("num_threads", &server_options.num_threads);
+  options.AddDefaultOption("max_distance",
+                           &server_options.localizer.max_distance);
+  options.AddDefaultOption("max_ratio", &server_options.localizer.max_ratio);
+  options.AddDefaultOption("max_error", &server_options.localizer.max_error);
+  options.AddDefaultOption("min_inlier_ratio",
+                           &server_options.localizer.min_inlier_ratio);
+  options.AddDefaultOption("min_num_inliers",
+                           &server_options.localizer.min_num_inliers);
+  options.AddDefaultOption("estimate_focal_length",
+                           &server_options.localizer.estimate_focal_length);
+  options.AddDefaultOption("localizer_num_threads",
+                           &server_options.localizer.num_threads);
+  options.AddDefaultOption("vocab_tree_path", &vocab_tree_path);
+  options.AddDefaultOption("max_num_matches",
+                           &server_options.localizer.max_num_matches);
+  options.AddDefaultOption("num_checks", &server_options.localizer.num_checks);
+  options.Parse(argc, argv);
+
+  if (!ExistsDir(input_path)) {
+    std::cerr << "ERROR: `input_path` is not a directory" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  server_options.sift_extraction = *options.sift_extraction;
+  if (!server_options.Check()) {
+    return EXIT_FAILURE;
+  }
+
+  Reconstruction reconstruction;
+  reconstruction.Read(input_path);
+
+  PrintHeading1("Building localization index");
+
+  Timer timer;
+  timer.Start();
+
+  // Quantize the point descriptors through the vocabulary tree, if given,
+  // instead of indexing the descriptors of all observations.
+  std::unique_ptr<retrieval::VisualIndex<>> visual_index;
+  if (!vocab_tree_path.empty()) {
+    visual_index.reset(new retrieval::VisualIndex<>());
+    visual_index->Read(vocab_tree_path);
+  }
+
+  std::unique_ptr<Localizer> localizer;
+  {
+    Database database(*options.database_path);
+    localizer.reset(
+        new Localizer(reconstruction, database, visual_index.get()));
+  }
+
+  std::cout << "Indexed " << localizer->NumDescriptors()
+            << " descriptors of " << localizer->NumPoints3D() << " points"
+            << std::endl;
+  timer.PrintSeconds();
+
+  LocalizationServer server(server_options, localizer.get());
+  server.Start();
+  if (!server.CheckValidSetup()) {
+    server.Wait();
+    return EXIT_FAILURE;
+  }
+
+  std::cout << StringPrintf("Serving localization requests on port %d",
+                            server.Port())
+            << std::endl;
+
+  server.Wait();
+
+  return EXIT_SUCCESS;
+}
+
 int RunMapper(int argc, char** argv) {
   std::string input_path;
   std::string output_path;
@@ -1038,6 +1293,45 @@ int RunMapper(int argc, char** argv) {
   return EXIT_SUCCESS;
 }
 
+int RunGlobalMapper(int argc, char** argv) {
+  GlobalMapperController::Options global_options;
+  std::string output_path;
+
+  OptionManager options;
+  options.AddRequiredOption("database_path", &global_options.database_path);
+  options.AddRequiredOption("image_path", &global_options.image_path);
+  options.AddRequiredOption("output_path", &output_path);
+  options.AddDefaultOption("num_ba_iterations",
+                           &global_options.num_ba_iterations);
+  options.AddDefaultOption("min_num_inliers",
+                           &global_options.mapper.min_num_inliers);
+  options.AddDefaultOption("max_error", &global_options.mapper.max_error);
+  options.AddDefaultOption("min_tri_angle",
+                           &global_options.mapper.min_tri_angle);
+  options.AddDefaultOption("max_rotation_error",
+                           &global_options.mapper.max_rotation_error);
+  options.AddDefaultOption("max_translation_error",
+                           &global_options.mapper.max_translation_error);
+  options.AddMapperOptions();
+  options.Parse(argc, argv);
+
+  if (!ExistsDir(output_path)) {
+    std::cerr << "ERROR: `output_path` is not a directory." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ReconstructionManager reconstruction_manager;
+
+  GlobalMapperController global_mapper(global_options, *options.mapper,
+                                       &reconstruction_manager);
+  global_mapper.Start();
+  global_mapper.Wait();
+
+  reconstruction_manager.Write(output_path, &options);
+
+  return EXIT_SUCCESS;
+}
+
 int RunHierarchicalMapper(int argc, char** argv) {
   HierarchicalMapperController::Options hierarchical_options;
   SceneClustering::Options clustering_options;
@@ -1049,6 +1343,9 @@ int RunHierarchicalMapper(int argc, char** argv) {
   options.AddRequiredOption("image_path", &hierarchical_options.image_path);
   options.AddRequiredOption("output_path", &output_path);
   options.AddDefaultOption("num_workers", &hierarchical_options.num_workers);
+  options.AddDefaultOption("max_leaf_size_ratio",
+                           &hierarchical_options.max_leaf_size_ratio);
+  options.AddDefaultOption("job_path", &hierarchical_options.job_path);
   options.AddDefaultOption("image_overlap", &clustering_options.image_overlap);
   options.AddDefaultOption("leaf_max_num_images",
                            &clustering_options.leaf_max_num_images);
@@ -1073,6 +1370,33 @@ int RunHierarchicalMapper(int argc, char** argv) {
   return EXIT_SUCCESS;
 }
 
+int RunHierarchicalMapperMerger(int argc, char** argv) {
+  std::string job_path;
+  std::string output_path;
+
+  OptionManager options;
+  options.AddRequiredOption("job_path", &job_path);
+  options.AddRequiredOption("output_path", &output_path);
+  options.Parse(argc, argv);
+
+  if (!ExistsDir(job_path)) {
+    std::cerr << "ERROR: `job_path` is not a directory." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!ExistsDir(output_path)) {
+    std::cerr << "ERROR: `output_path` is not a directory." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ReconstructionManager reconstruction_manager;
+  MergeHierarchicalMapperJobs(job_path, &reconstruction_manager);
+
+  reconstruction_manager.Write(output_path, nullptr);
+
+  return EXIT_SUCCESS;
+}
+
 int RunMatchesImporter(int argc, char** argv) {
   std::string match_list_path;
   std::string match_type = "pairs";
@@ -1124,6 +1448,7 @@ int RunModelAligner(int argc, char** argv) {
   int min_common_images = 3;
   bool robust_alignment = true;
   RANSACOptions ransac_options;
+  ransac_options.num_threads = -1;
 
   OptionManager options;
   options.AddRequiredOption("input_path", &input_path);
@@ -1133,6 +1458,8 @@ int RunModelAligner(int argc, char** argv) {
   options.AddDefaultOption("robust_alignment", &robust_alignment);
   options.AddDefaultOption("robust_alignment_max_error",
                            &ransac_options.max_error);
+  options.AddDefaultOption("robust_alignment_num_threads",
+                           &ransac_options.num_threads);
   options.Parse(argc, argv);
 
   if (robust_alignment && ransac_options.max_error <= 0) {
@@ -1198,34 +1525,36 @@ int RunModelAligner(int argc, char** argv) {
 
 int RunModelAnalyzer(int argc, char** argv) {
   std::string path;
+  int num_threads = -1;
 
   OptionManager options;
   options.AddRequiredOption("path", &path);
+  options.AddDefaultOption("num_threads", &num_threads);
   options.Parse(argc, argv);
 
   Reconstruction reconstruction;
   reconstruction.Read(path);
 
-  std::cout << StringPrintf("Cameras: %d", reconstruction.NumCameras())
-            << std::endl;
-  std::cout << StringPrintf("Images: %d", reconstruction.NumImages())
+  const Reconstruction::Statistics statistics =
+      reconstruction.ComputeStatistics(num_threads);
+
+  std::cout << StringPrintf("Cameras: %d", statistics.num_cameras)
             << std::endl;
-  std::cout << StringPrintf("Registered images: %d",
-                            reconstruction.NumRegImages())
+  std::cout << StringPrintf("Images: %d", statistics.num_images) << std::endl;
+  std::cout << StringPrintf("Registered images: %d", statistics.num_reg_images)
             << std::endl;
-  std::cout << StringPrintf("Points: %d", reconstruction.NumPoints3D())
+  std::cout << StringPrintf("Points: %d", statistics.num_points3D)
             << std::endl;
-  std::cout << StringPrintf("Observations: %d",
-                            reconstruction.ComputeNumObservations())
+  std::cout << StringPrintf("Observations: %d", statistics.num_observations)
             << std::endl;
   std::cout << StringPrintf("Mean track length: %f",
-                            reconstruction.ComputeMeanTrackLength())
+                            statistics.mean_track_length)
             << std::endl;
   std::cout << StringPrintf("Mean observations per image: %f",
-                            reconstruction.ComputeMeanObservationsPerRegImage())
+                            statistics.mean_observations_per_reg_image)
             << std::endl;
   std::cout << StringPrintf("Mean reprojection error: %fpx",
-                            reconstruction.ComputeMeanReprojectionError())
+                            statistics.mean_reprojection_error)
             << std::endl;
 
   return EXIT_SUCCESS;
@@ -1235,12 +1564,18 @@ int RunModelConverter(int argc, char** argv) {
   std::string input_path;
   std::string output_path;
   std::string output_type;
+  ChunkedReconstructionOptions chunked_options;
 
   OptionManager options;
   options.AddRequiredOption("input_path", &input_path);
   options.AddRequiredOption("output_path", &output_path);
   options.AddRequiredOption("output_type", &output_type,
-                            "{BIN, TXT, NVM, Bundler, VRML, PLY}");
+                            "{BIN, CHUNKED, TXT, NVM, Bundler, VRML, PLY}");
+  options.AddDefaultOption("max_num_images_per_chunk",
+                           &chunked_options.max_num_images_per_chunk);
+  options.AddDefaultOption("max_num_points3D_per_chunk",
+                           &chunked_options.max_num_points3D_per_chunk);
+  options.AddDefaultOption("compress", &chunked_options.compress);
   options.Parse(argc, argv);
 
   Reconstruction reconstruction;
@@ -1249,6 +1584,8 @@ int RunModelConverter(int argc, char** argv) {
   StringToLower(&output_type);
   if (output_type == "bin") {
     reconstruction.WriteBinary(output_path);
+  } else if (output_type == "chunked") {
+    reconstruction.WriteChunked(output_path, chunked_options);
   } else if (output_type == "txt") {
     reconstruction.WriteText(output_path);
   } else if (output_type == "nvm") {
@@ -1332,6 +1669,14 @@ int RunModelOrientationAligner(int argc, char** argv) {
                            "{MANHATTAN-WORLD, IMAGE-ORIENTATION}");
   options.AddDefaultOption("max_image_size",
                            &frame_estimation_options.max_image_size);
+  options.AddDefaultOption("num_threads",
+                           &frame_estimation_options.num_threads);
+  options.AddDefaultOption("max_num_images",
+                           &frame_estimation_options.max_num_images);
+  options.AddDefaultOption("max_axis_change",
+                           &frame_estimation_options.max_axis_change);
+  options.AddDefaultOption("num_images_per_batch",
+                           &frame_estimation_options.num_images_per_batch);
   options.Parse(argc, argv);
 
   StringToLower(&method);
@@ -1415,6 +1760,14 @@ int RunPointFiltering(int argc, char** argv) {
   size_t min_track_len = 2;
   double max_reproj_error = 4.0;
   double min_tri_angle = 1.5;
+  // The spatial filters are disabled by default.
+  int outlier_num_neighbors = 0;
+  double outlier_max_std_ratio = 2.0;
+  double neighbor_radius = 0.0;
+  int min_num_neighbors = 1;
+  double voxel_size = 0.0;
+  int min_num_points_per_voxel = 2;
+  int num_threads = -1;
 
   OptionManager options;
   options.AddRequiredOption("input_path", &input_path);
@@ -1422,13 +1775,36 @@ int RunPointFiltering(int argc, char** argv) {
   options.AddDefaultOption("min_track_len", &min_track_len);
   options.AddDefaultOption("max_reproj_error", &max_reproj_error);
   options.AddDefaultOption("min_tri_angle", &min_tri_angle);
+  options.AddDefaultOption("outlier_num_neighbors", &outlier_num_neighbors);
+  options.AddDefaultOption("outlier_max_std_ratio", &outlier_max_std_ratio);
+  options.AddDefaultOption("neighbor_radius", &neighbor_radius);
+  options.AddDefaultOption("min_num_neighbors", &min_num_neighbors);
+  options.AddDefaultOption("voxel_size", &voxel_size);
+  options.AddDefaultOption("min_num_points_per_voxel",
+                           &min_num_points_per_voxel);
+  options.AddDefaultOption("num_threads", &num_threads);
   options.Parse(argc, argv);
 
   Reconstruction reconstruction;
   reconstruction.Read(input_path);
 
-  size_t num_filtered =
-      reconstruction.FilterAllPoints3D(max_reproj_error, min_tri_angle);
+  size_t num_filtered = reconstruction.FilterAllPoints3D(
+      max_reproj_error, min_tri_angle, num_threads);
+
+  if (outlier_num_neighbors > 0) {
+    num_filtered += reconstruction.FilterPoints3DStatisticalOutliers(
+        outlier_num_neighbors, outlier_max_std_ratio, num_threads);
+  }
+
+  if (neighbor_radius > 0) {
+    num_filtered += reconstruction.FilterPoints3DWithFewNeighbors(
+        neighbor_radius, min_num_neighbors, num_threads);
+  }
+
+  if (voxel_size > 0) {
+    num_filtered += reconstruction.FilterPoints3DInSparseVoxels(
+        voxel_size, min_num_points_per_voxel, num_threads);
+  }
 
   for (const auto point3D_id : reconstruction.Point3DIds()) {
     const auto& point3D = reconstruction.Point3D(point3D_id);
@@ -1449,6 +1825,7 @@ int RunPointTriangulator(int argc, char** argv) {
   std::string input_path;
   std::string output_path;
   bool clear_points = false;
+  int max_num_images_per_tile = -1;
 
   OptionManager options;
   options.AddDatabaseOptions();
@@ -1458,6 +1835,10 @@ int RunPointTriangulator(int argc, char** argv) {
   options.AddDefaultOption(
       "clear_points", &clear_points,
       "Whether to clear all existing points and observations");
+  options.AddDefaultOption(
+      "max_num_images_per_tile", &max_num_images_per_tile,
+      "If positive, the images are triangulated and refined in spatial tiles "
+      "of at most this number of images in parallel");
   options.AddMapperOptions();
   options.Parse(argc, argv);
 
@@ -1492,7 +1873,9 @@ int RunPointTriangulator(int argc, char** argv) {
         static_cast<size_t>(mapper_options.min_num_matches);
     database_cache.Load(database, min_num_matches,
                         mapper_options.ignore_watermarks,
-                        mapper_options.image_names);
+                        mapper_options.image_names,
+                        mapper_options.correspondence_graph_path,
+                        mapper_options.num_threads);
 
     if (clear_points) {
       reconstruction.DeleteAllPoints2DAndPoints3D();
@@ -1517,6 +1900,45 @@ int RunPointTriangulator(int argc, char** argv) {
 
   const auto tri_options = mapper_options.Triangulation();
 
+  if (max_num_images_per_tile > 0) {
+    PrintHeading1("Tiled triangulation");
+
+    auto ba_options = mapper_options.GlobalBundleAdjustment();
+
+    TiledTriangulator::Options tiled_options;
+    tiled_options.max_num_images_per_tile = max_num_images_per_tile;
+    tiled_options.max_reproj_error =
+        mapper_options.mapper.filter_max_reproj_error;
+    tiled_options.num_threads = mapper_options.num_threads;
+
+    TiledTriangulator tiled_triangulator(
+        tiled_options, &database_cache.CorrespondenceGraph(), &reconstruction);
+    tiled_triangulator.Triangulate(tri_options, ba_options);
+
+    const auto& report = tiled_triangulator.GetReport();
+    std::cout << "  => Triangulated " << report.num_tiles << " tiles"
+              << std::endl;
+    std::cout << "  => Created " << report.num_created_points3D << " points"
+              << std::endl;
+    std::cout << "  => Merged " << report.num_merged_observations
+              << " observations" << std::endl;
+
+    // Join the remaining duplicate tracks across the tile borders.
+    PrintHeading1("Retriangulation");
+    CompleteAndMergeTracks(mapper_options, &mapper);
+    FilterPoints(mapper_options, &mapper);
+
+    PrintHeading1("Extracting colors");
+    reconstruction.ExtractColorsForAllImages(*options.image_path);
+
+    const bool kDiscardReconstruction = false;
+    mapper.EndReconstruction(kDiscardReconstruction);
+
+    reconstruction.Write(output_path);
+
+    return EXIT_SUCCESS;
+  }
+
   const auto& reg_image_ids = reconstruction.RegImageIds();
 
   for (size_t i = 0; i < reg_image_ids.size(); ++i) {
@@ -1595,126 +2017,6 @@ int RunPointTriangulator(int argc, char** argv) {
   return EXIT_SUCCESS;
 }
 
-// Read the configuration of the camera rigs from a JSON file. The input images
-// of a camera rig must be named consistently to assign them to the appropriate
-// camera rig and the respective snapshots.
-//
-// An example configuration of a single camera rig:
-// [
-//   {
-//     "ref_camera_id": 1,
-//     "cameras":
-//     [
-//       {
-//           "camera_id": 1,
-//           "image_prefix": "left1_image"
-//       },
-//       {
-//           "camera_id": 2,
-//           "image_prefix": "left2_image"
-//       },
-//       {
-//           "camera_id": 3,
-//           "image_prefix": "right1_image"
-//       },
-//       {
-//           "camera_id": 4,
-//           "image_prefix": "right2_image"
-//       }
-//     ]
-//   }
-// ]
-//
-// This file specifies the configuration for a single camera rig and that you
-// could potentially define multiple camera rigs. The rig is composed of 4
-// cameras: all images of the first camera must have "left1_image" as a name
-// prefix, e.g., "left1_image_frame000.png" or "left1_image/frame000.png".
-// Images with the same suffix ("_frame000.png" and "/frame000.png") are
-// assigned to the same snapshot, i.e., they are assumed to be captured at the
-// same time. Only snapshots with the reference image registered will be added
-// to the bundle adjustment problem. The remaining images will be added with
-// independent poses to the bundle adjustment problem. The above configuration
-// could have the following input image file structure:
-//
-//    /path/to/images/...
-//        left1_image/...
-//            frame000.png
-//            frame001.png
-//            frame002.png
-//            ...
-//        left2_image/...
-//            frame000.png
-//            frame001.png
-//            frame002.png
-//            ...
-//        right1_image/...
-//            frame000.png
-//            frame001.png
-//            frame002.png
-//            ...
-//        right2_image/...
-//            frame000.png
-//            frame001.png
-//            frame002.png
-//            ...
-//
-// TODO: Provide an option to manually / explicitly set the relative extrinsics
-// of the camera rig. At the moment, the relative extrinsics are automatically
-// inferred from the reconstruction.
-std::vector<CameraRig> ReadCameraRigConfig(
-    const std::string& rig_config_path, const Reconstruction& reconstruction) {
-  boost::property_tree::ptree pt;
-  boost::property_tree::read_json(rig_config_path.c_str(), pt);
-
-  std::vector<CameraRig> camera_rigs;
-  for (const auto& rig_config : pt) {
-    CameraRig camera_rig;
-
-    std::vector<std::string> image_prefixes;
-    for (const auto& camera : rig_config.second.get_child("cameras")) {
-      const int camera_id = camera.second.get<int>("camera_id");
-      image_prefixes.push_back(camera.second.get<std::string>("image_prefix"));
-      camera_rig.AddCamera(camera_id, ComposeIdentityQuaternion(),
-                           Eigen::Vector3d(0, 0, 0));
-    }
-
-    camera_rig.SetRefCameraId(rig_config.second.get<int>("ref_camera_id"));
-
-    std::unordered_map<std::string, std::vector<image_t>> snapshots;
-    for (const auto image_id : reconstruction.RegImageIds()) {
-      const auto& image = reconstruction.Image(image_id);
-      for (const auto& image_prefix : image_prefixes) {
-        if (StringContains(image.Name(), image_prefix)) {
-          const std::string image_suffix =
-              StringGetAfter(image.Name(), image_prefix);
-          snapshots[image_suffix].push_back(image_id);
-        }
-      }
-    }
-
-    for (const auto& snapshot : snapshots) {
-      bool has_ref_camera = false;
-      for (const auto image_id : snapshot.second) {
-        const auto& image = reconstruction.Image(image_id);
-        if (image.CameraId() == camera_rig.RefCameraId()) {
-          has_ref_camera = true;
-        }
-      }
-
-      if (has_ref_camera) {
-        camera_rig.AddSnapshot(snapshot.second);
-      }
-    }
-
-    camera_rig.Check(reconstruction);
-    camera_rig.ComputeRelativePoses(reconstruction);
-
-    camera_rigs.push_back(camera_rig);
-  }
-
-  return camera_rigs;
-}
-
 int RunRigBundleAdjuster(int argc, char** argv) {
   std::string input_path;
   std::string output_path;
@@ -1815,53 +2117,60 @@ int RunTransitiveMatcher(int argc, char** argv) {
   return EXIT_SUCCESS;
 }
 
-// Loads descriptors for training from the database. Loads all descriptors from
-// the database if max_num_images < 0, otherwise the descriptors of a random
-// subset of images are selected.
-FeatureDescriptors LoadRandomDatabaseDescriptors(
-    const std::string& database_path, const int max_num_images) {
-  Database database(database_path);
-  DatabaseTransaction database_transaction(&database);
-
-  const std::vector<Image> images = database.ReadAllImages();
-
-  FeatureDescriptors descriptors;
-
-  std::vector<size_t> image_idxs;
-  size_t num_descriptors = 0;
-  if (max_num_images < 0) {
-    // All images in the database.
-    image_idxs.resize(images.size());
-    std::iota(image_idxs.begin(), image_idxs.end(), 0);
-    num_descriptors = database.NumDescriptors();
-  } else {
-    // Random subset of images in the database.
-    CHECK_LE(max_num_images, images.size());
-    RandomSampler random_sampler(max_num_images);
-    random_sampler.Initialize(images.size());
-    image_idxs = random_sampler.Sample();
-    for (const auto image_idx : image_idxs) {
-      const auto& image = images.at(image_idx);
-      num_descriptors += database.NumDescriptorsForImage(image.ImageId());
+// Streams descriptors for training from the database, one image at a time.
+// Streams all descriptors from the database if max_num_images < 0, otherwise
+// the descriptors of a random subset of images are selected.
+class DatabaseDescriptorStream
+    : public retrieval::VisualIndex<>::DescriptorStreamType {
+ public:
+  DatabaseDescriptorStream(const std::string& database_path,
+                           const int max_num_images)
+      : database_(database_path), image_idx_(0) {
+    const std::vector<Image> images = database_.ReadAllImages();
+    if (max_num_images < 0) {
+      // All images in the database.
+      for (const auto& image : images) {
+        image_ids_.push_back(image.ImageId());
+      }
+    } else {
+      // Random subset of images in the database.
+      CHECK_LE(max_num_images, images.size());
+      RandomSampler random_sampler(max_num_images);
+      random_sampler.Initialize(images.size());
+      for (const auto image_idx : random_sampler.Sample()) {
+        image_ids_.push_back(images.at(image_idx).ImageId());
+      }
     }
   }
 
-  descriptors.resize(num_descriptors, 128);
-
-  size_t descriptor_row = 0;
-  for (const auto image_idx : image_idxs) {
-    const auto& image = images.at(image_idx);
-    const FeatureDescriptors image_descriptors =
-        database.ReadDescriptors(image.ImageId());
-    descriptors.block(descriptor_row, 0, image_descriptors.rows(), 128) =
-        image_descriptors;
-    descriptor_row += image_descriptors.rows();
+  size_t NumDescriptors() {
+    size_t num_descriptors = 0;
+    for (const auto image_id : image_ids_) {
+      num_descriptors += database_.NumDescriptorsForImage(image_id);
+    }
+    return num_descriptors;
   }
 
-  CHECK_EQ(descriptor_row, num_descriptors);
+  void Reset() override { image_idx_ = 0; }
 
-  return descriptors;
-}
+  bool Next(retrieval::VisualIndex<>::DescType* descriptors) override {
+    while (image_idx_ < image_ids_.size()) {
+      const FeatureDescriptors image_descriptors =
+          database_.ReadDescriptors(image_ids_[image_idx_]);
+      image_idx_ += 1;
+      if (image_descriptors.rows() > 0) {
+        *descriptors = image_descriptors;
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  Database database_;
+  std::vector<image_t> image_ids_;
+  size_t image_idx_;
+};
 
 int RunVocabTreeBuilder(int argc, char** argv) {
   std::string vocab_tree_path;
@@ -1875,19 +2184,21 @@ int RunVocabTreeBuilder(int argc, char** argv) {
   options.AddDefaultOption("num_checks", &build_options.num_checks);
   options.AddDefaultOption("branching", &build_options.branching);
   options.AddDefaultOption("num_iterations", &build_options.num_iterations);
+  options.AddDefaultOption("max_num_embedding_descriptors",
+                           &build_options.max_num_embedding_descriptors);
+  options.AddDefaultOption("num_threads", &build_options.num_threads);
   options.AddDefaultOption("max_num_images", &max_num_images);
   options.Parse(argc, argv);
 
   retrieval::VisualIndex<> visual_index;
 
-  std::cout << "Loading descriptors..." << std::endl;
-  const auto descriptors =
-      LoadRandomDatabaseDescriptors(*options.database_path, max_num_images);
-  std::cout << "  => Loaded a total of " << descriptors.rows() << " descriptors"
-            << std::endl;
+  DatabaseDescriptorStream descriptor_stream(*options.database_path,
+                                             max_num_images);
+  std::cout << "Streaming a total of " << descriptor_stream.NumDescriptors()
+            << " descriptors" << std::endl;
 
   std::cout << "Building index for visual words..." << std::endl;
-  visual_index.Build(build_options, descriptors);
+  visual_index.Build(build_options, &descriptor_stream);
   std::cout << " => Quantized descriptor space using "
             << visual_index.NumVisualWords() << " visual words" << std::endl;
 
@@ -1964,6 +2275,10 @@ int RunVocabTreeRetriever(int argc, char** argv) {
   options.AddDefaultOption("num_checks", &query_options.num_checks);
   options.AddDefaultOption("num_images_after_verification",
                            &query_options.num_images_after_verification);
+  options.AddDefaultOption("verification_min_num_inliers",
+                           &query_options.verification_min_num_inliers);
+  options.AddDefaultOption("max_verification_time",
+                           &query_options.max_verification_time);
   options.AddDefaultOption("max_num_features", &max_num_features);
   options.Parse(argc, argv);
 
@@ -1983,6 +2298,11 @@ int RunVocabTreeRetriever(int argc, char** argv) {
   // Perform image indexing
   //////////////////////////////////////////////////////////////////////////////
 
+  // The visual words of the images are cached in the database, so that they
+  // are not re-quantized for the same vocabulary tree in subsequent runs.
+  const retrieval::VisualIndex<>::IndexOptions index_options;
+  const uint64_t vocab_hash = visual_index.VocabularyHash();
+
   for (size_t i = 0; i < database_images.size(); ++i) {
     Timer timer;
     timer.Start();
@@ -1996,14 +2316,30 @@ int RunVocabTreeRetriever(int argc, char** argv) {
       continue;
     }
 
-    auto keypoints = database.ReadKeypoints(database_images[i].ImageId());
-    auto descriptors = database.ReadDescriptors(database_images[i].ImageId());
+    const image_t image_id = database_images[i].ImageId();
+    auto keypoints = database.ReadKeypoints(image_id);
+    auto descriptors = database.ReadDescriptors(image_id);
     if (max_num_features > 0 && descriptors.rows() > max_num_features) {
       ExtractTopScaleFeatures(&keypoints, &descriptors, max_num_features);
     }
 
-    visual_index.Add(retrieval::VisualIndex<>::IndexOptions(),
-                     database_images[i].ImageId(), keypoints, descriptors);
+    if (descriptors.rows() == 0) {
+      visual_index.Add(index_options, image_id, keypoints, descriptors);
+    } else {
+      Eigen::MatrixXi word_ids =
+          database.ReadVisualWordIds(image_id, vocab_hash);
+      if (word_ids.rows() == descriptors.rows() &&
+          word_ids.cols() == index_options.num_neighbors) {
+        std::cout << " (cached)";
+      } else {
+        word_ids = visual_index.FindWordIds(
+            descriptors, index_options.num_neighbors, index_options.num_checks,
+            index_options.num_threads);
+        database.WriteVisualWordIds(image_id, vocab_hash, word_ids);
+      }
+      visual_index.Add(index_options, image_id, keypoints, descriptors,
+                       word_ids);
+    }
 
     std::cout << StringPrintf(" in %.3fs", timer.ElapsedSeconds()) << std::endl;
   }
@@ -2121,7 +2457,10 @@ int main(int argc, char** argv) {
   commands.emplace_back("exhaustive_matcher", &RunExhaustiveMatcher);
   commands.emplace_back("feature_extractor", &RunFeatureExtractor);
   commands.emplace_back("feature_importer", &RunFeatureImporter);
+  commands.emplace_back("global_mapper", &RunGlobalMapper);
   commands.emplace_back("hierarchical_mapper", &RunHierarchicalMapper);
+  commands.emplace_back("hierarchical_mapper_merger",
+                        &RunHierarchicalMapperMerger);
   commands.emplace_back("image_deleter", &RunImageDeleter);
   commands.emplace_back("image_filterer", &RunImageFilterer);
   commands.emplace_back("image_rectifier", &RunImageRectifier);
@@ -2129,6 +2468,7 @@ int main(int argc, char** argv) {
   commands.emplace_back("image_undistorter", &RunImageUndistorter);
   commands.emplace_back("image_undistorter_standalone",
                         &RunImageUndistorterStandalone);
+  commands.emplace_back("localization_server", &RunLocalizationServer);
   commands.emplace_back("mapper", &RunMapper);
   commands.emplace_back("matches_importer", &RunMatchesImporter);
   commands.emplace_back("model_aligner", &RunModelAligner);
@@ -2138,6 +2478,7 @@ int main(int argc, char** argv) {
   commands.emplace_back("model_orientation_aligner",
                         &RunModelOrientationAligner);
   commands.emplace_back("patch_match_stereo", &RunPatchMatchStereo);
+  commands.emplace_back("pipeline", &RunPipeline);
   commands.emplace_back("point_filtering", &RunPointFiltering);
   commands.emplace_back("point_triangulator", &RunPointTriangulator);
   commands.emplace_back("poisson_mesher", &RunPoissonMesher);
@@ -2177,7 +2518,12 @@ int main(int argc, char** argv) {
       int command_argc = argc - 1;
       char** command_argv = &argv[1];
       command_argv[0] = argv[0];
-      return matched_command_func(command_argc, command_argv);
+      const int return_code = matched_command_func(command_argc, command_argv);
+      StopMetricsServer();
+      FinalizeProfiling();
+      FinalizeMemoryAccounting();
+      FinalizeLogging();
+      return return_code;
     }
   }
 
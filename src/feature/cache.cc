@@ -0,0 +1,159 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "feature/cache.h"
+
+#include <fstream>
+#include <random>
+
+#include <boost/filesystem.hpp>
+
+#include "util/logging.h"
+#include "util/misc.h"
+#include "util/string.h"
+
+namespace colmap {
+namespace {
+
+// Version of the stored features, which must be incremented whenever the
+// extraction changes its results for the same options.
+const int kFeatureCacheVersion = 1;
+
+// 64-bit FNV-1a hash.
+class Hasher {
+ public:
+  void Update(const void* data, const size_t num_bytes) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < num_bytes; ++i) {
+      hash_ = (hash_ ^ bytes[i]) * 1099511628211ULL;
+    }
+  }
+
+  void Update(const std::string& data) { Update(data.data(), data.size()); }
+
+  // Update the hash with the size and the content of the file. Returns false
+  // if the file cannot be opened.
+  bool UpdateFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+      return false;
+    }
+    std::vector<char> buffer(1 << 20);
+    uint64_t num_bytes = 0;
+    while (file) {
+      file.read(buffer.data(), buffer.size());
+      Update(buffer.data(), static_cast<size_t>(file.gcount()));
+      num_bytes += static_cast<uint64_t>(file.gcount());
+    }
+    Update(&num_bytes, sizeof(num_bytes));
+    return true;
+  }
+
+  std::string HexDigest() const {
+    return StringPrintf("%016llx", static_cast<unsigned long long>(hash_));
+  }
+
+ private:
+  uint64_t hash_ = 14695981039346656037ULL;
+};
+
+}  // namespace
+
+FeatureCache::FeatureCache(const std::string& path,
+                           const SiftExtractionOptions& options,
+                           const std::string& camera_mask_path) {
+  // Only the options that change the extracted features are hashed, which
+  // excludes, e.g., the number of threads or the storage format.
+  Hasher hasher;
+  hasher.Update(StringPrintf(
+      "version=%d,use_gpu=%d,max_image_size=%d,tile_size=%d,tile_overlap=%d,"
+      "max_num_features=%d,first_octave=%d,num_octaves=%d,"
+      "octave_resolution=%d,peak_threshold=%.17g,edge_threshold=%.17g,"
+      "estimate_affine_shape=%d,max_num_orientations=%d,upright=%d,"
+      "darkness_adaptivity=%d,domain_size_pooling=%d,dsp_min_scale=%.17g,"
+      "dsp_max_scale=%.17g,dsp_num_scales=%d,normalization=%d",
+      kFeatureCacheVersion, options.use_gpu, options.max_image_size,
+      options.tile_size, options.tile_overlap, options.max_num_features,
+      options.first_octave, options.num_octaves, options.octave_resolution,
+      options.peak_threshold, options.edge_threshold,
+      options.estimate_affine_shape, options.max_num_orientations,
+      options.upright, options.darkness_adaptivity,
+      options.domain_size_pooling, options.dsp_min_scale,
+      options.dsp_max_scale, options.dsp_num_scales,
+      static_cast<int>(options.normalization)));
+  if (!camera_mask_path.empty()) {
+    hasher.UpdateFile(camera_mask_path);
+  }
+
+  path_ = JoinPaths(path, hasher.HexDigest());
+  boost::filesystem::create_directories(path_);
+}
+
+const std::string& FeatureCache::Path() const { return path_; }
+
+std::string FeatureCache::Key(const std::string& image_path,
+                              const std::string& mask_path) {
+  Hasher hasher;
+  if (!hasher.UpdateFile(image_path)) {
+    return "";
+  }
+  if (!mask_path.empty()) {
+    hasher.UpdateFile(mask_path);
+  }
+  return hasher.HexDigest();
+}
+
+bool FeatureCache::Read(const std::string& key, FeatureKeypoints* keypoints,
+                        FeatureDescriptors* descriptors) const {
+  const std::string path = FeaturesPath(key);
+  if (!ExistsFile(path)) {
+    return false;
+  }
+  LoadSiftFeaturesFromBinaryFile(path, keypoints, descriptors);
+  return true;
+}
+
+void FeatureCache::Write(const std::string& key,
+                         const FeatureKeypoints& keypoints,
+                         const FeatureDescriptors& descriptors) const {
+  // Write to a unique temporary file first and then rename it, such that
+  // concurrent readers in other processes never see partially written files.
+  const std::string path = FeaturesPath(key);
+  const std::string tmp_path =
+      StringPrintf("%s.%08x.tmp", path.c_str(), std::random_device()());
+  WriteSiftFeaturesToBinaryFile(tmp_path, keypoints, descriptors);
+  boost::filesystem::rename(tmp_path, path);
+}
+
+std::string FeatureCache::FeaturesPath(const std::string& key) const {
+  return JoinPaths(path_, key + ".bin");
+}
+
+}  // namespace colmap
@@ -0,0 +1,81 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_FEATURE_CACHE_H_
+#define COLMAP_SRC_FEATURE_CACHE_H_
+
+#include <string>
+
+#include "feature/sift.h"
+#include "feature/types.h"
+
+namespace colmap {
+
+// Shared on-disk store of extracted features, which can be reused across
+// projects and databases, e.g., for repeated surveys of overlapping areas or
+// for images that were moved or re-exported under a different name. The
+// features of an image are keyed by the hash of its file content and of its
+// optional mask, and they are stored in a sub-directory per hash of the
+// extraction options and the camera mask, which affect the features. The
+// features are stored after scaling them to the original image resolution and
+// masking them, i.e., as they are written to the database. Multiple processes
+// can share the same cache, since files are written atomically.
+class FeatureCache {
+ public:
+  FeatureCache(const std::string& path, const SiftExtractionOptions& options,
+               const std::string& camera_mask_path = "");
+
+  // Directory of the features extracted with the given options.
+  const std::string& Path() const;
+
+  // Compute the key of an image from the content of its file and of its
+  // optional mask file, which is ignored if empty or if it does not exist.
+  // Returns an empty key if the image file cannot be read.
+  static std::string Key(const std::string& image_path,
+                         const std::string& mask_path = "");
+
+  // Read the cached features of the image with the given key. Returns false
+  // if the features do not exist in the cache.
+  bool Read(const std::string& key, FeatureKeypoints* keypoints,
+            FeatureDescriptors* descriptors) const;
+
+  // Write the features of the image with the given key to the cache.
+  void Write(const std::string& key, const FeatureKeypoints& keypoints,
+             const FeatureDescriptors& descriptors) const;
+
+ private:
+  std::string FeaturesPath(const std::string& key) const;
+
+  std::string path_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_FEATURE_CACHE_H_
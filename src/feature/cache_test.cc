@@ -0,0 +1,130 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "feature/cache"
+#include "util/testing.h"
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "feature/cache.h"
+#include "util/misc.h"
+
+using namespace colmap;
+
+namespace {
+
+std::string CreateTestDir() {
+  const std::string path = (boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path())
+                               .string();
+  boost::filesystem::create_directories(path);
+  return path;
+}
+
+void WriteTestFile(const std::string& path, const std::string& content) {
+  std::ofstream file(path, std::ios::binary);
+  file << content;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(TestKey) {
+  const std::string dir = CreateTestDir();
+  const std::string image_path1 = JoinPaths(dir, "image1.jpg");
+  const std::string image_path2 = JoinPaths(dir, "image2.jpg");
+  const std::string image_path3 = JoinPaths(dir, "image3.jpg");
+  const std::string mask_path = JoinPaths(dir, "image1.jpg.png");
+  WriteTestFile(image_path1, "image");
+  WriteTestFile(image_path2, "image");
+  WriteTestFile(image_path3, "other image");
+  WriteTestFile(mask_path, "mask");
+
+  BOOST_CHECK_EQUAL(FeatureCache::Key(image_path1),
+                    FeatureCache::Key(image_path2));
+  BOOST_CHECK_NE(FeatureCache::Key(image_path1),
+                 FeatureCache::Key(image_path3));
+  BOOST_CHECK_NE(FeatureCache::Key(image_path1),
+                 FeatureCache::Key(image_path1, mask_path));
+  BOOST_CHECK_EQUAL(
+      FeatureCache::Key(image_path1),
+      FeatureCache::Key(image_path1, JoinPaths(dir, "missing.png")));
+  BOOST_CHECK_EQUAL(FeatureCache::Key(JoinPaths(dir, "missing.jpg")), "");
+
+  boost::filesystem::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(TestReadWrite) {
+  const std::string dir = CreateTestDir();
+
+  SiftExtractionOptions options;
+  FeatureCache cache(dir, options);
+  BOOST_CHECK(ExistsDir(cache.Path()));
+
+  FeatureKeypoints keypoints;
+  FeatureDescriptors descriptors;
+  BOOST_CHECK(!cache.Read("key", &keypoints, &descriptors));
+
+  FeatureKeypoints ref_keypoints(2);
+  ref_keypoints[0] = FeatureKeypoint(1, 2, 3, 4, 5, 6);
+  ref_keypoints[1] = FeatureKeypoint(7, 8, 9, 10, 11, 12);
+  FeatureDescriptors ref_descriptors(2, 128);
+  for (int i = 0; i < ref_descriptors.size(); ++i) {
+    ref_descriptors.data()[i] = static_cast<uint8_t>(i % 256);
+  }
+  cache.Write("key", ref_keypoints, ref_descriptors);
+
+  BOOST_CHECK(cache.Read("key", &keypoints, &descriptors));
+  BOOST_CHECK_EQUAL(keypoints.size(), 2);
+  for (size_t i = 0; i < keypoints.size(); ++i) {
+    BOOST_CHECK_EQUAL(keypoints[i].x, ref_keypoints[i].x);
+    BOOST_CHECK_EQUAL(keypoints[i].y, ref_keypoints[i].y);
+    BOOST_CHECK_EQUAL(keypoints[i].a11, ref_keypoints[i].a11);
+    BOOST_CHECK_EQUAL(keypoints[i].a12, ref_keypoints[i].a12);
+    BOOST_CHECK_EQUAL(keypoints[i].a21, ref_keypoints[i].a21);
+    BOOST_CHECK_EQUAL(keypoints[i].a22, ref_keypoints[i].a22);
+  }
+  BOOST_CHECK(descriptors == ref_descriptors);
+
+  // The same options share the cached features, while different options do
+  // not, except for options that do not change the extracted features.
+  options.num_threads = 3;
+  FeatureCache same_cache(dir, options);
+  BOOST_CHECK_EQUAL(same_cache.Path(), cache.Path());
+  BOOST_CHECK(same_cache.Read("key", &keypoints, &descriptors));
+
+  options.max_num_features += 1;
+  FeatureCache other_cache(dir, options);
+  BOOST_CHECK_NE(other_cache.Path(), cache.Path());
+  BOOST_CHECK(!other_cache.Read("key", &keypoints, &descriptors));
+
+  boost::filesystem::remove_all(dir);
+}
@@ -0,0 +1,164 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_FEATURE_DESCRIPTOR_TILE_CUDA_H_
+#define COLMAP_SRC_FEATURE_DESCRIPTOR_TILE_CUDA_H_
+
+#include <cstdint>
+
+#include <cuda_runtime.h>
+#include <mma.h>
+
+// Device functions to compute the dot products between tiles of 128-dim 8-bit
+// descriptors with a block of `kTileBlockSize` threads, as used by the
+// brute-force matchers and searches. This header must only be included in
+// CUDA sources.
+
+namespace colmap {
+namespace internal {
+
+const int kTileBlockSize = 256;
+
+// Number of descriptors per tile.
+const int kTileSize = 64;
+
+// The descriptors of a tile are stored in chunks of 16 dimensions, which is
+// the inner dimension of the tensor core matrix fragments. The chunks of all
+// descriptors are contiguous, such that the fragments are 256-bit aligned.
+const int kTileDescriptorDim = 128;
+const int kTileChunkSize = 16;
+const int kTileNumChunks = kTileDescriptorDim / kTileChunkSize;
+
+// The threads of a row of the dot products process disjoint column blocks.
+const int kTileThreadsPerRow = kTileBlockSize / kTileSize;
+const int kTileColsPerThread = kTileSize / kTileThreadsPerRow;
+
+// Padded row stride of the dot products of two tiles.
+const int kTileDotsStride = kTileSize + 4;
+
+// Load the descriptors of a tile into shared memory. Descriptors beyond the
+// end are set to zero.
+__device__ inline void LoadDescriptorTile(const uint8_t* descriptors,
+                                          const int num_descriptors,
+                                          const int tile_begin, uint4* tile) {
+  const uint4* chunks = reinterpret_cast<const uint4*>(descriptors);
+  for (int i = threadIdx.x; i < kTileSize * kTileNumChunks;
+       i += kTileBlockSize) {
+    const int row = i / kTileNumChunks;
+    const int chunk = i % kTileNumChunks;
+    const int idx = tile_begin + row;
+    tile[chunk * kTileSize + row] =
+        idx < num_descriptors ? chunks[idx * kTileNumChunks + chunk]
+                              : make_uint4(0, 0, 0, 0);
+  }
+}
+
+#if !defined(__CUDA_ARCH__) || __CUDA_ARCH__ < 720
+__device__ inline unsigned int DotProduct4(const unsigned int a,
+                                           const unsigned int b,
+                                           const unsigned int c) {
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 610
+  return __dp4a(a, b, c);
+#else
+  unsigned int sum = c;
+  for (int i = 0; i < 32; i += 8) {
+    sum += ((a >> i) & 0xFF) * ((b >> i) & 0xFF);
+  }
+  return sum;
+#endif
+}
+#endif
+
+// Compute the dot products between all descriptors of two tiles, where the
+// product of the i-th descriptor of the first and the j-th descriptor of the
+// second tile is stored at `dots[i * kTileDotsStride + j]`. The products of
+// 8-bit integers are accumulated in 32-bit integers and are thus exact. On
+// devices with compute capability 7.2 or higher, the tiles are multiplied on
+// the tensor cores and otherwise with packed 4-way dot products.
+__device__ inline void ComputeTileDotProducts(const uint4* tile1,
+                                              const uint4* tile2, int* dots) {
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 720
+  using namespace nvcuda;
+
+  // Each warp computes two of the 4x4 fragments of 16x16 dot products.
+  const int warp_idx = threadIdx.x / 32;
+  const int fragment_row = warp_idx / 2;
+  for (int i = 0; i < 2; ++i) {
+    const int fragment_col = 2 * (warp_idx % 2) + i;
+
+    wmma::fragment<wmma::accumulator, 16, 16, 16, int> acc_fragment;
+    wmma::fill_fragment(acc_fragment, 0);
+
+    for (int chunk = 0; chunk < kTileNumChunks; ++chunk) {
+      wmma::fragment<wmma::matrix_a, 16, 16, 16, unsigned char,
+                     wmma::row_major>
+          fragment1;
+      wmma::fragment<wmma::matrix_b, 16, 16, 16, unsigned char,
+                     wmma::col_major>
+          fragment2;
+      wmma::load_matrix_sync(
+          fragment1,
+          reinterpret_cast<const unsigned char*>(
+              tile1 + chunk * kTileSize + 16 * fragment_row),
+          kTileChunkSize);
+      wmma::load_matrix_sync(
+          fragment2,
+          reinterpret_cast<const unsigned char*>(
+              tile2 + chunk * kTileSize + 16 * fragment_col),
+          kTileChunkSize);
+      wmma::mma_sync(acc_fragment, fragment1, fragment2, acc_fragment);
+    }
+
+    wmma::store_matrix_sync(
+        dots + 16 * fragment_row * kTileDotsStride + 16 * fragment_col,
+        acc_fragment, kTileDotsStride, wmma::mem_row_major);
+  }
+#else
+  const int row = threadIdx.x / kTileThreadsPerRow;
+  const int col_begin = (threadIdx.x % kTileThreadsPerRow) * kTileColsPerThread;
+  for (int col = col_begin; col < col_begin + kTileColsPerThread; ++col) {
+    unsigned int dot = 0;
+    for (int chunk = 0; chunk < kTileNumChunks; ++chunk) {
+      const uint4 values1 = tile1[chunk * kTileSize + row];
+      const uint4 values2 = tile2[chunk * kTileSize + col];
+      dot = DotProduct4(values1.x, values2.x, dot);
+      dot = DotProduct4(values1.y, values2.y, dot);
+      dot = DotProduct4(values1.z, values2.z, dot);
+      dot = DotProduct4(values1.w, values2.w, dot);
+    }
+    dots[row * kTileDotsStride + col] = static_cast<int>(dot);
+  }
+#endif
+}
+
+}  // namespace internal
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_FEATURE_DESCRIPTOR_TILE_CUDA_H_
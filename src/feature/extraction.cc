@@ -36,11 +36,33 @@
 #include "SiftGPU/SiftGPU.h"
 #include "feature/sift.h"
 #include "util/cuda.h"
+#include "util/gpu_scheduler.h"
 #include "util/misc.h"
+#ifdef NVJPEG_ENABLED
+#include "util/nvjpeg.h"
+#endif
 
 namespace colmap {
 namespace {
 
+// The stage of the per-image progress lines of the feature extraction, whose
+// verbosity and rate can be configured through `log_stage_levels` and
+// `log_progress_interval`.
+const char* const kExtractionLogStage = "feature_extraction";
+
+void ResizeBitmap(const int max_image_size, Bitmap* bitmap) {
+  if (static_cast<int>(bitmap->Width()) > max_image_size ||
+      static_cast<int>(bitmap->Height()) > max_image_size) {
+    // Fit the down-sampled version exactly into the max dimensions.
+    const double scale = static_cast<double>(max_image_size) /
+                         std::max(bitmap->Width(), bitmap->Height());
+    const int new_width = static_cast<int>(bitmap->Width() * scale);
+    const int new_height = static_cast<int>(bitmap->Height() * scale);
+
+    bitmap->Rescale(new_width, new_height);
+  }
+}
+
 void ScaleKeypoints(const Bitmap& bitmap, const Camera& camera,
                     FeatureKeypoints* keypoints) {
   if (static_cast<size_t>(bitmap.Width()) != camera.Width() ||
@@ -79,6 +101,68 @@ void MaskKeypoints(const Bitmap& mask, FeatureKeypoints* keypoints,
   descriptors->conservativeResize(out_index, descriptors->cols());
 }
 
+void PrintExtractionProgress(const internal::ImageData& image_data,
+                             const size_t image_index, const size_t num_images,
+                             const bool print_details) {
+  std::cout << StringPrintf("Processed file [%d/%d]", image_index, num_images)
+            << std::endl;
+
+  std::cout << StringPrintf("  Name:            %s",
+                            image_data.image.Name().c_str())
+            << std::endl;
+
+  if (image_data.status == ImageReader::Status::IMAGE_EXISTS) {
+    std::cout << "  SKIP: Features for image already extracted." << std::endl;
+  } else if (image_data.status == ImageReader::Status::BITMAP_ERROR) {
+    std::cout << "  ERROR: Failed to read image file format." << std::endl;
+  } else if (image_data.status ==
+             ImageReader::Status::CAMERA_SINGLE_DIM_ERROR) {
+    std::cout << "  ERROR: Single camera specified, "
+                 "but images have different dimensions."
+              << std::endl;
+  } else if (image_data.status ==
+             ImageReader::Status::CAMERA_EXIST_DIM_ERROR) {
+    std::cout << "  ERROR: Image previously processed, but current image "
+                 "has different dimensions."
+              << std::endl;
+  } else if (image_data.status == ImageReader::Status::CAMERA_PARAM_ERROR) {
+    std::cout << "  ERROR: Camera has invalid parameters." << std::endl;
+  } else if (image_data.status == ImageReader::Status::FAILURE) {
+    std::cout << "  ERROR: Failed to extract features." << std::endl;
+  }
+
+  if (image_data.status != ImageReader::Status::SUCCESS || !print_details) {
+    return;
+  }
+
+  std::cout << StringPrintf("  Dimensions:      %d x %d",
+                            image_data.camera.Width(),
+                            image_data.camera.Height())
+            << std::endl;
+  std::cout << StringPrintf("  Camera:          #%d - %s",
+                            image_data.camera.CameraId(),
+                            image_data.camera.ModelName().c_str())
+            << std::endl;
+  std::cout << StringPrintf("  Focal Length:    %.2fpx",
+                            image_data.camera.MeanFocalLength());
+  if (image_data.camera.HasPriorFocalLength()) {
+    std::cout << " (Prior)" << std::endl;
+  } else {
+    std::cout << std::endl;
+  }
+  if (image_data.image.HasTvecPrior()) {
+    std::cout << StringPrintf("  GPS:             LAT=%.3f, LON=%.3f, ALT=%.3f",
+                              image_data.image.TvecPrior(0),
+                              image_data.image.TvecPrior(1),
+                              image_data.image.TvecPrior(2))
+              << std::endl;
+  }
+  std::cout << StringPrintf("  Features:        %d%s",
+                            image_data.keypoints.size(),
+                            image_data.cached_features ? " (Cached)" : "")
+            << std::endl;
+}
+
 }  // namespace
 
 SiftFeatureExtractor::SiftFeatureExtractor(
@@ -87,10 +171,22 @@ SiftFeatureExtractor::SiftFeatureExtractor(
     : reader_options_(reader_options),
       sift_options_(sift_options),
       database_(reader_options_.database_path),
-      image_reader_(reader_options_, &database_) {
+      image_reader_(reader_options_, &database_),
+      use_gpu_decode_(false),
+      next_decode_index_(0) {
   CHECK(reader_options_.Check());
   CHECK(sift_options_.Check());
 
+  if (sift_options_.half_precision_keypoints) {
+    database_.SetKeypointsFormat(Database::KeypointsFormat::FLOAT16);
+  }
+
+  if (!sift_options_.feature_cache_path.empty()) {
+    feature_cache_.reset(new FeatureCache(sift_options_.feature_cache_path,
+                                          sift_options_,
+                                          reader_options_.camera_mask_path));
+  }
+
   std::shared_ptr<Bitmap> camera_mask;
   if (!reader_options_.camera_mask_path.empty()) {
     camera_mask = std::shared_ptr<Bitmap>(new Bitmap());
@@ -106,54 +202,97 @@ SiftFeatureExtractor::SiftFeatureExtractor(
   const int num_threads = GetEffectiveNumThreads(sift_options_.num_threads);
   CHECK_GT(num_threads, 0);
 
+  const int num_decode_threads =
+      GetEffectiveNumThreads(sift_options_.num_decode_threads);
+  decode_thread_pool_.reset(new ThreadPool(num_decode_threads));
+  decode_stats_.reset(
+      new internal::PipelineStageStats("Decode", num_decode_threads, 0));
+  reader_stats_.reset(new internal::PipelineStageStats(
+      "Read", 1, sift_options_.decode_queue_size));
+
   // Make sure that we only have limited number of objects in the queue to avoid
   // excess in memory usage since images and features take lots of memory.
-  const int kQueueSize = 1;
-  resizer_queue_.reset(new JobQueue<internal::ImageData>(kQueueSize));
-  extractor_queue_.reset(new JobQueue<internal::ImageData>(kQueueSize));
-  writer_queue_.reset(new JobQueue<internal::ImageData>(kQueueSize));
-
-  if (sift_options_.max_image_size > 0) {
+  resizer_queue_.reset(
+      new JobQueue<internal::ImageData>(sift_options_.queue_size));
+  extractor_queue_.reset(
+      new JobQueue<internal::ImageData>(sift_options_.queue_size));
+  writer_queue_.reset(
+      new JobQueue<internal::ImageData>(sift_options_.queue_size));
+
+  metrics_gauges_.Add("job_queue_size{queue=\"resizer\"}",
+                      [this]() { return resizer_queue_->Size(); });
+  metrics_gauges_.Add("job_queue_size{queue=\"extractor\"}",
+                      [this]() { return extractor_queue_->Size(); });
+  metrics_gauges_.Add("job_queue_size{queue=\"writer\"}",
+                      [this]() { return writer_queue_->Size(); });
+
+  // In tiled extraction, the images are extracted at their full resolution.
+  if (sift_options_.max_image_size > 0 && sift_options_.tile_size == 0) {
+    resizer_stats_.reset(new internal::PipelineStageStats(
+        "Resize", num_threads, sift_options_.queue_size));
     for (int i = 0; i < num_threads; ++i) {
       resizers_.emplace_back(new internal::ImageResizerThread(
           sift_options_.max_image_size, resizer_queue_.get(),
-          extractor_queue_.get()));
+          extractor_queue_.get(), resizer_stats_.get()));
     }
   }
 
   if (!sift_options_.domain_size_pooling &&
       !sift_options_.estimate_affine_shape && sift_options_.use_gpu) {
-    std::vector<int> gpu_indices = CSVToVector<int>(sift_options_.gpu_index);
-    CHECK_GT(gpu_indices.size(), 0);
-
-#ifdef CUDA_ENABLED
-    if (gpu_indices.size() == 1 && gpu_indices[0] == -1) {
-      const int num_cuda_devices = GetNumCudaDevices();
-      CHECK_GT(num_cuda_devices, 0);
-      gpu_indices.resize(num_cuda_devices);
-      std::iota(gpu_indices.begin(), gpu_indices.end(), 0);
+    const std::vector<int> gpu_indices =
+        GpuScheduler::Get().GetGpuIndices(sift_options_.gpu_index);
+
+    // Expand a single number of contexts to all GPUs.
+    std::vector<int> num_gpu_contexts =
+        CSVToVector<int>(sift_options_.num_gpu_contexts);
+    if (num_gpu_contexts.size() == 1) {
+      num_gpu_contexts.resize(gpu_indices.size(), num_gpu_contexts[0]);
     }
-#endif  // CUDA_ENABLED
+    CHECK_EQ(num_gpu_contexts.size(), gpu_indices.size());
+
+    const int num_extractors = std::accumulate(num_gpu_contexts.begin(),
+                                               num_gpu_contexts.end(), 0);
+    extractor_stats_.reset(new internal::PipelineStageStats(
+        "Extract", num_extractors, sift_options_.queue_size));
+#ifdef NVJPEG_ENABLED
+    use_gpu_decode_ = sift_options_.use_gpu_decode;
+#else
+    if (sift_options_.use_gpu_decode) {
+      std::cerr << "WARNING: GPU decoding requires nvJPEG support, decoding "
+                   "images on the CPU instead."
+                << std::endl;
+    }
+#endif  // NVJPEG_ENABLED
 
     auto sift_gpu_options = sift_options_;
-    for (const auto& gpu_index : gpu_indices) {
-      sift_gpu_options.gpu_index = std::to_string(gpu_index);
-      extractors_.emplace_back(new internal::SiftFeatureExtractorThread(
-          sift_gpu_options, camera_mask, extractor_queue_.get(),
-          writer_queue_.get()));
+    sift_gpu_options.use_gpu_decode = use_gpu_decode_;
+    for (size_t i = 0; i < gpu_indices.size(); ++i) {
+      sift_gpu_options.gpu_index = std::to_string(gpu_indices[i]);
+      sift_gpu_options.num_gpu_contexts = "1";
+      for (int j = 0; j < num_gpu_contexts[i]; ++j) {
+        extractors_.emplace_back(new internal::SiftFeatureExtractorThread(
+            sift_gpu_options, camera_mask, extractor_queue_.get(),
+            writer_queue_.get(), extractor_stats_.get()));
+      }
     }
   } else {
+    extractor_stats_.reset(new internal::PipelineStageStats(
+        "Extract", num_threads, sift_options_.queue_size));
     auto custom_sift_options = sift_options_;
     custom_sift_options.use_gpu = false;
+    custom_sift_options.use_gpu_decode = false;
     for (int i = 0; i < num_threads; ++i) {
       extractors_.emplace_back(new internal::SiftFeatureExtractorThread(
           custom_sift_options, camera_mask, extractor_queue_.get(),
-          writer_queue_.get()));
+          writer_queue_.get(), extractor_stats_.get()));
     }
   }
 
+  writer_stats_.reset(
+      new internal::PipelineStageStats("Write", 1, sift_options_.queue_size));
   writer_.reset(new internal::FeatureWriterThread(
-      image_reader_.NumImages(), &database_, writer_queue_.get()));
+      image_reader_.NumImages(), &database_, feature_cache_.get(),
+      writer_queue_.get(), writer_stats_.get()));
 }
 
 void SiftFeatureExtractor::Run() {
@@ -175,28 +314,56 @@ void SiftFeatureExtractor::Run() {
     }
   }
 
+  Timer import_timer;
+  import_timer.Start();
+  const size_t num_imported_images =
+      image_reader_.ImportMetadata(sift_options_.num_decode_threads);
+  std::cout << StringPrintf("Imported %d new images in %.3fs",
+                            num_imported_images,
+                            import_timer.ElapsedSeconds())
+            << std::endl;
+
+  next_decode_index_ = image_reader_.NextIndex();
+  ReadNextImages();
+
   while (image_reader_.NextIndex() < image_reader_.NumImages()) {
     if (IsStopped()) {
       resizer_queue_->Stop();
       extractor_queue_->Stop();
       resizer_queue_->Clear();
       extractor_queue_->Clear();
+      decode_thread_pool_->Stop();
       break;
     }
 
-    internal::ImageData image_data;
-    image_data.status =
-        image_reader_.Next(&image_data.camera, &image_data.image,
-                           &image_data.bitmap, &image_data.mask);
+    size_t num_decoded_images = 0;
+    for (const auto& decode_future : decode_futures_) {
+      if (decode_future.wait_for(std::chrono::seconds(0)) ==
+          std::future_status::ready) {
+        num_decoded_images += 1;
+      }
+    }
+
+    CHECK(!decode_futures_.empty());
+    internal::ImageData image_data = decode_futures_.front().get();
+    decode_futures_.pop_front();
+    ReadNextImages();
+
+    Timer timer;
+    timer.Start();
+    image_data.status = image_reader_.NextDecoded(
+        &image_data.camera, &image_data.image, &image_data.bitmap,
+        &image_data.mask, image_data.status);
+    reader_stats_->AddJob(timer.ElapsedSeconds(), num_decoded_images);
 
     if (image_data.status != ImageReader::Status::SUCCESS) {
       image_data.bitmap.Deallocate();
     }
 
-    if (sift_options_.max_image_size > 0) {
-      CHECK(resizer_queue_->Push(image_data));
+    if (!resizers_.empty()) {
+      CHECK(resizer_queue_->Push(std::move(image_data)));
     } else {
-      CHECK(extractor_queue_->Push(image_data));
+      CHECK(extractor_queue_->Push(std::move(image_data)));
     }
   }
 
@@ -216,12 +383,83 @@ void SiftFeatureExtractor::Run() {
   writer_queue_->Stop();
   writer_->Wait();
 
+  PrintPipelineStats();
+
   GetTimer().PrintMinutes();
 }
 
+void SiftFeatureExtractor::ReadNextImages() {
+  while (decode_futures_.size() <
+             static_cast<size_t>(sift_options_.decode_queue_size) &&
+         next_decode_index_ < image_reader_.NumImages()) {
+    const size_t index = next_decode_index_;
+    next_decode_index_ += 1;
+
+    // Images with existing features are skipped by the reader before using
+    // the decoded bitmap, so there is no need to decode them.
+    const bool decode = !image_reader_.ExistsFeatures(index);
+
+    decode_futures_.push_back(
+        decode_thread_pool_->AddTask([this, index, decode]() {
+          internal::ImageData image_data;
+          if (decode) {
+            Timer timer;
+            timer.Start();
+            const std::string image_path = image_reader_.ImagePath(index);
+            // Only the header of images with cached features is needed to
+            // assign their cameras.
+            if (feature_cache_) {
+              image_data.feature_cache_key = FeatureCache::Key(
+                  image_path, image_reader_.MaskPath(index));
+              if (!image_data.feature_cache_key.empty() &&
+                  feature_cache_->Read(image_data.feature_cache_key,
+                                       &image_data.keypoints,
+                                       &image_data.descriptors)) {
+                image_data.cached_features = true;
+                image_data.status =
+                    image_reader_.Decode(index, &image_data.bitmap, nullptr,
+                                         /*header_only*/ true);
+              }
+            }
+            if (!image_data.cached_features && use_gpu_decode_ &&
+                FreeImage_GetFileType(image_path.c_str(), 0) == FIF_JPEG) {
+              image_data.status =
+                  image_reader_.Decode(index, &image_data.bitmap,
+                                       &image_data.mask, /*header_only*/ true);
+              if (image_data.status == ImageReader::Status::SUCCESS) {
+                image_data.gpu_decode_path = image_path;
+              }
+            }
+            if (!image_data.cached_features &&
+                image_data.gpu_decode_path.empty()) {
+              image_data.status = image_reader_.Decode(
+                  index, &image_data.bitmap, &image_data.mask);
+            }
+            decode_stats_->AddJob(timer.ElapsedSeconds(), 0);
+          }
+          return image_data;
+        }));
+  }
+}
+
+void SiftFeatureExtractor::PrintPipelineStats() const {
+  PrintHeading2("Pipeline statistics");
+  const double elapsed_seconds = GetTimer().ElapsedSeconds();
+  decode_stats_->Print(elapsed_seconds);
+  reader_stats_->Print(elapsed_seconds);
+  if (resizer_stats_) {
+    resizer_stats_->Print(elapsed_seconds);
+  }
+  extractor_stats_->Print(elapsed_seconds);
+  writer_stats_->Print(elapsed_seconds);
+}
+
 FeatureImporter::FeatureImporter(const ImageReaderOptions& reader_options,
-                                 const std::string& import_path)
-    : reader_options_(reader_options), import_path_(import_path) {}
+                                 const std::string& import_path,
+                                 const int num_threads)
+    : reader_options_(reader_options),
+      import_path_(import_path),
+      num_threads_(num_threads) {}
 
 void FeatureImporter::Run() {
   PrintHeading1("Feature import");
@@ -233,62 +471,153 @@ void FeatureImporter::Run() {
 
   Database database(reader_options_.database_path);
   ImageReader image_reader(reader_options_, &database);
+  image_reader.ImportMetadata();
 
+  ThreadPool thread_pool(GetEffectiveNumThreads(num_threads_));
+
+  struct ImportData {
+    Image image;
+    FeatureKeypoints keypoints;
+    FeatureDescriptors descriptors;
+  };
+
+  // The metadata of the images is read sequentially, while their features are
+  // parsed concurrently. The features of a batch of images are written in one
+  // transaction once all of them are parsed.
+  std::vector<std::unique_ptr<ImportData>> batch;
+  std::vector<std::future<void>> batch_futures;
+  batch.reserve(kBatchSize);
+  batch_futures.reserve(kBatchSize);
+
+  const auto WriteBatch = [&]() {
+    for (auto& future : batch_futures) {
+      future.get();
+    }
+
+    DatabaseTransaction database_transaction(&database);
+    for (auto& data : batch) {
+      Image& image = data->image;
+      if (image.ImageId() == kInvalidImageId) {
+        image.SetImageId(database.WriteImage(image));
+      }
+      if (!database.ExistsKeypoints(image.ImageId())) {
+        database.WriteKeypoints(image.ImageId(), data->keypoints);
+      }
+      if (!database.ExistsDescriptors(image.ImageId())) {
+        database.WriteDescriptors(image.ImageId(), data->descriptors);
+      }
+    }
+
+    batch.clear();
+    batch_futures.clear();
+  };
+
+  size_t num_imported = 0;
   while (image_reader.NextIndex() < image_reader.NumImages()) {
     if (IsStopped()) {
       break;
     }
 
-    std::cout << StringPrintf("Processing file [%d/%d]",
-                              image_reader.NextIndex() + 1,
-                              image_reader.NumImages())
-              << std::endl;
-
-    // Load image data and possibly save camera to database.
+    // Load image data and possibly save camera to database. The pixels of the
+    // image are not needed to import its features.
     Camera camera;
     Image image;
     Bitmap bitmap;
-    if (image_reader.Next(&camera, &image, &bitmap, nullptr) !=
+    const ImageReader::Status decode_status = image_reader.Decode(
+        image_reader.NextIndex(), &bitmap, nullptr, /*header_only*/ true);
+    if (image_reader.NextDecoded(&camera, &image, &bitmap, nullptr,
+                                 decode_status) !=
         ImageReader::Status::SUCCESS) {
       continue;
     }
 
-    const std::string path = JoinPaths(import_path_, image.Name() + ".txt");
-
-    if (ExistsFile(path)) {
-      FeatureKeypoints keypoints;
-      FeatureDescriptors descriptors;
-      LoadSiftFeaturesFromTextFile(path, &keypoints, &descriptors);
-
-      std::cout << "  Features:       " << keypoints.size() << std::endl;
-
-      DatabaseTransaction database_transaction(&database);
-
-      if (image.ImageId() == kInvalidImageId) {
-        image.SetImageId(database.WriteImage(image));
-      }
+    const std::string path = JoinPaths(import_path_, image.Name());
+    bool is_binary;
+    if (ExistsFile(path + ".bin")) {
+      is_binary = true;
+    } else if (ExistsFile(path + ".txt")) {
+      is_binary = false;
+    } else {
+      std::cout << "  SKIP: No features found at " << path << ".txt"
+                << std::endl;
+      continue;
+    }
 
-      if (!database.ExistsKeypoints(image.ImageId())) {
-        database.WriteKeypoints(image.ImageId(), keypoints);
+    batch.emplace_back(new ImportData);
+    ImportData* data = batch.back().get();
+    data->image = image;
+    batch_futures.push_back(thread_pool.AddTask([data, path, is_binary]() {
+      if (is_binary) {
+        LoadSiftFeaturesFromBinaryFile(path + ".bin", &data->keypoints,
+                                       &data->descriptors);
+      } else {
+        LoadSiftFeaturesFromTextFile(path + ".txt", &data->keypoints,
+                                     &data->descriptors);
       }
+    }));
 
-      if (!database.ExistsDescriptors(image.ImageId())) {
-        database.WriteDescriptors(image.ImageId(), descriptors);
-      }
-    } else {
-      std::cout << "  SKIP: No features found at " << path << std::endl;
+    num_imported += 1;
+    if (batch.size() == kBatchSize) {
+      WriteBatch();
+      std::cout << StringPrintf("Imported features of %d / %d images",
+                                num_imported, image_reader.NumImages())
+                << std::endl;
     }
   }
 
+  WriteBatch();
+  std::cout << StringPrintf("Imported features of %d / %d images",
+                            num_imported, image_reader.NumImages())
+            << std::endl;
+
   GetTimer().PrintMinutes();
 }
 
 namespace internal {
 
+PipelineStageStats::PipelineStageStats(const std::string& name,
+                                       const size_t num_threads,
+                                       const size_t max_queue_size)
+    : name_(name),
+      num_threads_(num_threads),
+      max_queue_size_(max_queue_size),
+      num_jobs_(0),
+      busy_seconds_(0.0),
+      total_queue_size_(0) {
+  CHECK_GT(num_threads_, 0);
+}
+
+void PipelineStageStats::AddJob(const double busy_seconds,
+                                const size_t queue_size) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  num_jobs_ += 1;
+  busy_seconds_ += busy_seconds;
+  total_queue_size_ += queue_size;
+}
+
+void PipelineStageStats::Print(const double elapsed_seconds) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const double utilization =
+      elapsed_seconds > 0 ? busy_seconds_ / (num_threads_ * elapsed_seconds)
+                          : 0.0;
+  std::cout << StringPrintf("  %-8s threads=%d, jobs=%d, utilization=%.1f%%",
+                            name_.c_str(), num_threads_, num_jobs_,
+                            100.0 * utilization);
+  if (max_queue_size_ > 0 && num_jobs_ > 0) {
+    std::cout << StringPrintf(", queue=%.2f/%d",
+                              static_cast<double>(total_queue_size_) /
+                                  num_jobs_,
+                              max_queue_size_);
+  }
+  std::cout << std::endl;
+}
+
 ImageResizerThread::ImageResizerThread(const int max_image_size,
                                        JobQueue<ImageData>* input_queue,
-                                       JobQueue<ImageData>* output_queue)
+                                       JobQueue<ImageData>* output_queue,
+                                       PipelineStageStats* stats)
     : max_image_size_(max_image_size),
+      stats_(stats),
       input_queue_(input_queue),
       output_queue_(output_queue) {}
 
@@ -298,27 +627,23 @@ void ImageResizerThread::Run() {
       break;
     }
 
-    const auto input_job = input_queue_->Pop();
+    const size_t queue_size = input_queue_->Size();
+    auto input_job = input_queue_->Pop();
     if (input_job.IsValid()) {
-      auto image_data = input_job.Data();
-
-      if (image_data.status == ImageReader::Status::SUCCESS) {
-        if (static_cast<int>(image_data.bitmap.Width()) > max_image_size_ ||
-            static_cast<int>(image_data.bitmap.Height()) > max_image_size_) {
-          // Fit the down-sampled version exactly into the max dimensions.
-          const double scale =
-              static_cast<double>(max_image_size_) /
-              std::max(image_data.bitmap.Width(), image_data.bitmap.Height());
-          const int new_width =
-              static_cast<int>(image_data.bitmap.Width() * scale);
-          const int new_height =
-              static_cast<int>(image_data.bitmap.Height() * scale);
-
-          image_data.bitmap.Rescale(new_width, new_height);
-        }
+      auto image_data = std::move(input_job.Data());
+
+      Timer timer;
+      timer.Start();
+
+      // Images decoded on the GPU are resized by the extractor.
+      if (image_data.status == ImageReader::Status::SUCCESS &&
+          !image_data.cached_features && image_data.gpu_decode_path.empty()) {
+        ResizeBitmap(max_image_size_, &image_data.bitmap);
       }
 
-      output_queue_->Push(image_data);
+      stats_->AddJob(timer.ElapsedSeconds(), queue_size);
+
+      output_queue_->Push(std::move(image_data));
     } else {
       break;
     }
@@ -328,9 +653,11 @@ void ImageResizerThread::Run() {
 SiftFeatureExtractorThread::SiftFeatureExtractorThread(
     const SiftExtractionOptions& sift_options,
     const std::shared_ptr<Bitmap>& camera_mask,
-    JobQueue<ImageData>* input_queue, JobQueue<ImageData>* output_queue)
+    JobQueue<ImageData>* input_queue, JobQueue<ImageData>* output_queue,
+    PipelineStageStats* stats)
     : sift_options_(sift_options),
       camera_mask_(camera_mask),
+      stats_(stats),
       input_queue_(input_queue),
       output_queue_(output_queue) {
   CHECK(sift_options_.Check());
@@ -358,6 +685,14 @@ void SiftFeatureExtractorThread::Run() {
     }
   }
 
+#ifdef NVJPEG_ENABLED
+  std::unique_ptr<NvJpegDecoder> jpeg_decoder;
+  if (sift_options_.use_gpu && sift_options_.use_gpu_decode) {
+    SetBestCudaDevice(std::stoi(sift_options_.gpu_index));
+    jpeg_decoder.reset(new NvJpegDecoder());
+  }
+#endif  // NVJPEG_ENABLED
+
   SignalValidSetup();
 
   while (true) {
@@ -365,25 +700,67 @@ void SiftFeatureExtractorThread::Run() {
       break;
     }
 
-    const auto input_job = input_queue_->Pop();
+    const size_t queue_size = input_queue_->Size();
+    auto input_job = input_queue_->Pop();
     if (input_job.IsValid()) {
-      auto image_data = input_job.Data();
+      auto image_data = std::move(input_job.Data());
+
+      Timer timer;
+      timer.Start();
+
+#ifdef NVJPEG_ENABLED
+      if (image_data.status == ImageReader::Status::SUCCESS &&
+          !image_data.gpu_decode_path.empty()) {
+        CHECK(jpeg_decoder);
+        const int width = image_data.bitmap.Width();
+        const int height = image_data.bitmap.Height();
+        // Fall back to decoding on the CPU for images not supported by nvJPEG.
+        if (!jpeg_decoder->DecodeGrey(image_data.gpu_decode_path,
+                                      &image_data.bitmap) &&
+            !image_data.bitmap.Read(image_data.gpu_decode_path, false)) {
+          image_data.status = ImageReader::Status::BITMAP_ERROR;
+        } else if (image_data.bitmap.Width() != width ||
+                   image_data.bitmap.Height() != height) {
+          image_data.status = ImageReader::Status::BITMAP_ERROR;
+        } else if (sift_options_.tile_size == 0) {
+          ResizeBitmap(sift_options_.max_image_size, &image_data.bitmap);
+        }
+      }
+#endif  // NVJPEG_ENABLED
+
+      if (image_data.status == ImageReader::Status::SUCCESS &&
+          !image_data.cached_features) {
+        // The Gaussian, DoG, and gradient pyramids of SiftGPU take roughly
+        // eight floats per pixel of the extracted image or tile.
+        GpuScheduler::Lease gpu_lease;
+        if (sift_gpu) {
+          size_t num_pixels = static_cast<size_t>(image_data.bitmap.Width()) *
+                              image_data.bitmap.Height();
+          if (sift_options_.tile_size > 0) {
+            const size_t tile_size =
+                sift_options_.tile_size + 2 * sift_options_.tile_overlap;
+            num_pixels = std::min(num_pixels, tile_size * tile_size);
+          }
+          gpu_lease = GpuScheduler::Get().Acquire(
+              sift_options_.gpu_index, 8 * sizeof(float) * num_pixels);
+        }
 
-      if (image_data.status == ImageReader::Status::SUCCESS) {
         bool success = false;
-        if (sift_options_.estimate_affine_shape ||
-            sift_options_.domain_size_pooling) {
-          success = ExtractCovariantSiftFeaturesCPU(
-              sift_options_, image_data.bitmap, &image_data.keypoints,
-              &image_data.descriptors);
-        } else if (sift_options_.use_gpu) {
-          success = ExtractSiftFeaturesGPU(
-              sift_options_, image_data.bitmap, sift_gpu.get(),
+        if (sift_options_.tile_size > 0 &&
+            std::max(image_data.bitmap.Width(), image_data.bitmap.Height()) >
+                sift_options_.tile_size + 2 * sift_options_.tile_overlap) {
+          success = ExtractTiledSiftFeatures(
+              sift_options_, image_data.bitmap,
+              [&](const Bitmap& bitmap, FeatureKeypoints* keypoints,
+                  FeatureDescriptors* descriptors) {
+                return ExtractSiftFeatures(bitmap, sift_gpu.get(), keypoints,
+                                           descriptors);
+              },
               &image_data.keypoints, &image_data.descriptors);
         } else {
-          success = ExtractSiftFeaturesCPU(sift_options_, image_data.bitmap,
-                                           &image_data.keypoints,
-                                           &image_data.descriptors);
+          success = ExtractSiftFeatures(image_data.bitmap, sift_gpu.get(),
+                                        &image_data.keypoints,
+                                        &image_data.descriptors);
         }
         if (success) {
           ScaleKeypoints(image_data.bitmap, image_data.camera,
@@ -403,17 +780,41 @@ void SiftFeatureExtractorThread::Run() {
 
       image_data.bitmap.Deallocate();
 
-      output_queue_->Push(image_data);
+      stats_->AddJob(timer.ElapsedSeconds(), queue_size);
+
+      output_queue_->Push(std::move(image_data));
     } else {
       break;
     }
   }
 }
 
+bool SiftFeatureExtractorThread::ExtractSiftFeatures(
+    const Bitmap& bitmap, SiftGPU* sift_gpu, FeatureKeypoints* keypoints,
+    FeatureDescriptors* descriptors) {
+  if (sift_options_.estimate_affine_shape ||
+      sift_options_.domain_size_pooling) {
+    return ExtractCovariantSiftFeaturesCPU(sift_options_, bitmap, keypoints,
+                                           descriptors);
+  } else if (sift_options_.use_gpu) {
+    return ExtractSiftFeaturesGPU(sift_options_, bitmap, sift_gpu, keypoints,
+                                  descriptors);
+  } else {
+    return ExtractSiftFeaturesCPU(sift_options_, bitmap, keypoints,
+                                  descriptors);
+  }
+}
+
 FeatureWriterThread::FeatureWriterThread(const size_t num_images,
                                          Database* database,
-                                         JobQueue<ImageData>* input_queue)
-    : num_images_(num_images), database_(database), input_queue_(input_queue) {}
+                                         FeatureCache* feature_cache,
+                                         JobQueue<ImageData>* input_queue,
+                                         PipelineStageStats* stats)
+    : num_images_(num_images),
+      database_(database),
+      feature_cache_(feature_cache),
+      input_queue_(input_queue),
+      stats_(stats) {}
 
 void FeatureWriterThread::Run() {
   size_t image_index = 0;
@@ -422,87 +823,58 @@ void FeatureWriterThread::Run() {
       break;
     }
 
+    const size_t queue_size = input_queue_->Size();
     auto input_job = input_queue_->Pop();
     if (input_job.IsValid()) {
       auto& image_data = input_job.Data();
 
-      image_index += 1;
+      Timer timer;
+      timer.Start();
 
-      std::cout << StringPrintf("Processed file [%d/%d]", image_index,
-                                num_images_)
-                << std::endl;
-
-      std::cout << StringPrintf("  Name:            %s",
-                                image_data.image.Name().c_str())
-                << std::endl;
+      image_index += 1;
 
-      if (image_data.status == ImageReader::Status::IMAGE_EXISTS) {
-        std::cout << "  SKIP: Features for image already extracted."
-                  << std::endl;
-      } else if (image_data.status == ImageReader::Status::BITMAP_ERROR) {
-        std::cout << "  ERROR: Failed to read image file format." << std::endl;
-      } else if (image_data.status ==
-                 ImageReader::Status::CAMERA_SINGLE_DIM_ERROR) {
-        std::cout << "  ERROR: Single camera specified, "
-                     "but images have different dimensions."
-                  << std::endl;
-      } else if (image_data.status ==
-                 ImageReader::Status::CAMERA_EXIST_DIM_ERROR) {
-        std::cout << "  ERROR: Image previously processed, but current image "
-                     "has different dimensions."
-                  << std::endl;
-      } else if (image_data.status == ImageReader::Status::CAMERA_PARAM_ERROR) {
-        std::cout << "  ERROR: Camera has invalid parameters." << std::endl;
-      } else if (image_data.status == ImageReader::Status::FAILURE) {
-        std::cout << "  ERROR: Failed to extract features." << std::endl;
+      // Failures are always reported, while the remaining progress lines can
+      // be rate-limited and their details omitted at verbosity level zero.
+      const bool failed =
+          image_data.status != ImageReader::Status::SUCCESS &&
+          image_data.status != ImageReader::Status::IMAGE_EXISTS;
+      if (ShouldPrintProgress(kExtractionLogStage, 0,
+                              failed || image_index == num_images_)) {
+        PrintExtractionProgress(
+            image_data, image_index, num_images_,
+            IsStageLogLevelEnabled(kExtractionLogStage, 1));
       }
 
       if (image_data.status != ImageReader::Status::SUCCESS) {
+        stats_->AddJob(timer.ElapsedSeconds(), queue_size);
         continue;
       }
 
-      std::cout << StringPrintf("  Dimensions:      %d x %d",
-                                image_data.camera.Width(),
-                                image_data.camera.Height())
-                << std::endl;
-      std::cout << StringPrintf("  Camera:          #%d - %s",
-                                image_data.camera.CameraId(),
-                                image_data.camera.ModelName().c_str())
-                << std::endl;
-      std::cout << StringPrintf("  Focal Length:    %.2fpx",
-                                image_data.camera.MeanFocalLength());
-      if (image_data.camera.HasPriorFocalLength()) {
-        std::cout << " (Prior)" << std::endl;
-      } else {
-        std::cout << std::endl;
-      }
-      if (image_data.image.HasTvecPrior()) {
-        std::cout << StringPrintf(
-                         "  GPS:             LAT=%.3f, LON=%.3f, ALT=%.3f",
-                         image_data.image.TvecPrior(0),
-                         image_data.image.TvecPrior(1),
-                         image_data.image.TvecPrior(2))
-                  << std::endl;
-      }
-      std::cout << StringPrintf("  Features:        %d",
-                                image_data.keypoints.size())
-                << std::endl;
+      {
+        DatabaseTransaction database_transaction(database_);
 
-      DatabaseTransaction database_transaction(database_);
+        if (image_data.image.ImageId() == kInvalidImageId) {
+          image_data.image.SetImageId(database_->WriteImage(image_data.image));
+        }
 
-      if (image_data.image.ImageId() == kInvalidImageId) {
-        image_data.image.SetImageId(database_->WriteImage(image_data.image));
-      }
+        if (!database_->ExistsKeypoints(image_data.image.ImageId())) {
+          database_->WriteKeypoints(image_data.image.ImageId(),
+                                    image_data.keypoints);
+        }
 
-      if (!database_->ExistsKeypoints(image_data.image.ImageId())) {
-        database_->WriteKeypoints(image_data.image.ImageId(),
-                                  image_data.keypoints);
+        if (!database_->ExistsDescriptors(image_data.image.ImageId())) {
+          database_->WriteDescriptors(image_data.image.ImageId(),
+                                      image_data.descriptors);
+        }
       }
 
-      if (!database_->ExistsDescriptors(image_data.image.ImageId())) {
-        database_->WriteDescriptors(image_data.image.ImageId(),
-                                    image_data.descriptors);
+      if (feature_cache_ != nullptr && !image_data.cached_features &&
+          !image_data.feature_cache_key.empty()) {
+        feature_cache_->Write(image_data.feature_cache_key,
+                              image_data.keypoints, image_data.descriptors);
       }
+
+      stats_->AddJob(timer.ElapsedSeconds(), queue_size);
     } else {
       break;
     }
@@ -32,9 +32,14 @@
 #ifndef COLMAP_SRC_FEATURE_EXTRACTION_H_
 #define COLMAP_SRC_FEATURE_EXTRACTION_H_
 
+#include <deque>
+#include <future>
+
 #include "base/database.h"
 #include "base/image_reader.h"
+#include "feature/cache.h"
 #include "feature/sift.h"
+#include "util/metrics.h"
 #include "util/opengl_utils.h"
 #include "util/threading.h"
 
@@ -43,6 +48,7 @@ namespace colmap {
 namespace internal {
 
 struct ImageData;
+class PipelineStageStats;
 
 }  // namespace internal
 
@@ -55,12 +61,27 @@ class SiftFeatureExtractor : public Thread {
  private:
   void Run();
 
+  // Decode the images ahead of the reader in the decode thread pool, while
+  // keeping at most `decode_queue_size` decoded images in memory.
+  void ReadNextImages();
+
+  void PrintPipelineStats() const;
+
   const ImageReaderOptions reader_options_;
   const SiftExtractionOptions sift_options_;
 
   Database database_;
   ImageReader image_reader_;
 
+  std::unique_ptr<FeatureCache> feature_cache_;
+
+  // Whether JPEG images are decoded by the extractors on the GPU.
+  bool use_gpu_decode_;
+
+  std::unique_ptr<ThreadPool> decode_thread_pool_;
+  size_t next_decode_index_;
+  std::deque<std::future<internal::ImageData>> decode_futures_;
+
   std::vector<std::unique_ptr<Thread>> resizers_;
   std::vector<std::unique_ptr<Thread>> extractors_;
   std::unique_ptr<Thread> writer_;
@@ -68,20 +89,35 @@ class SiftFeatureExtractor : public Thread {
   std::unique_ptr<JobQueue<internal::ImageData>> resizer_queue_;
   std::unique_ptr<JobQueue<internal::ImageData>> extractor_queue_;
   std::unique_ptr<JobQueue<internal::ImageData>> writer_queue_;
+
+  std::unique_ptr<internal::PipelineStageStats> decode_stats_;
+  std::unique_ptr<internal::PipelineStageStats> reader_stats_;
+  std::unique_ptr<internal::PipelineStageStats> resizer_stats_;
+  std::unique_ptr<internal::PipelineStageStats> extractor_stats_;
+  std::unique_ptr<internal::PipelineStageStats> writer_stats_;
+
+  ScopedMetricsGauges metrics_gauges_;
 };
 
-// Import features from text files. Each image must have a corresponding text
-// file with the same name and an additional ".txt" suffix.
+// Import features from text or binary files. Each image must have a
+// corresponding file with the same name and an additional ".txt" suffix for
+// the text format or ".bin" suffix for the binary format, see
+// `LoadSiftFeaturesFromTextFile` and `LoadSiftFeaturesFromBinaryFile`. The
+// files are parsed by multiple threads and written to the database in batches
+// of images with one transaction per batch.
 class FeatureImporter : public Thread {
  public:
   FeatureImporter(const ImageReaderOptions& reader_options,
-                  const std::string& import_path);
+                  const std::string& import_path, const int num_threads = -1);
 
  private:
+  const static size_t kBatchSize = 256;
+
   void Run();
 
   const ImageReaderOptions reader_options_;
   const std::string import_path_;
+  const int num_threads_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -98,19 +134,57 @@ struct ImageData {
   Bitmap bitmap;
   Bitmap mask;
 
+  // Path of the image, if only the header of the bitmap was read and its
+  // pixels must still be decoded on the GPU by the extractor.
+  std::string gpu_decode_path;
+
+  // Key of the image in the feature cache, if enabled, and whether the
+  // features were read from the cache, in which case only the header of the
+  // bitmap was read and the features must not be extracted.
+  std::string feature_cache_key;
+  bool cached_features = false;
+
   FeatureKeypoints keypoints;
   FeatureDescriptors descriptors;
 };
 
+// Accumulates the busy time of the threads of a pipeline stage and the
+// occupancy of its input queue, as sampled whenever a job is started. The
+// utilization is the fraction of the elapsed time, in which the threads of
+// the stage were busy. A stage with a low utilization and an empty input
+// queue is starved by the previous stage, while a stage with a high
+// utilization and a full input queue is the bottleneck of the pipeline.
+class PipelineStageStats {
+ public:
+  PipelineStageStats(const std::string& name, const size_t num_threads,
+                     const size_t max_queue_size);
+
+  void AddJob(const double busy_seconds, const size_t queue_size);
+
+  void Print(const double elapsed_seconds) const;
+
+ private:
+  const std::string name_;
+  const size_t num_threads_;
+  const size_t max_queue_size_;
+
+  mutable std::mutex mutex_;
+  size_t num_jobs_;
+  double busy_seconds_;
+  size_t total_queue_size_;
+};
+
 class ImageResizerThread : public Thread {
  public:
   ImageResizerThread(const int max_image_size, JobQueue<ImageData>* input_queue,
-                     JobQueue<ImageData>* output_queue);
+                     JobQueue<ImageData>* output_queue,
+                     PipelineStageStats* stats);
 
  private:
   void Run();
 
   const int max_image_size_;
+  PipelineStageStats* stats_;
 
   JobQueue<ImageData>* input_queue_;
   JobQueue<ImageData>* output_queue_;
@@ -121,13 +195,19 @@ class SiftFeatureExtractorThread : public Thread {
   SiftFeatureExtractorThread(const SiftExtractionOptions& sift_options,
                              const std::shared_ptr<Bitmap>& camera_mask,
                              JobQueue<ImageData>* input_queue,
-                             JobQueue<ImageData>* output_queue);
+                             JobQueue<ImageData>* output_queue,
+                             PipelineStageStats* stats);
 
  private:
   void Run();
 
+  bool ExtractSiftFeatures(const Bitmap& bitmap, SiftGPU* sift_gpu,
+                           FeatureKeypoints* keypoints,
+                           FeatureDescriptors* descriptors);
+
   const SiftExtractionOptions sift_options_;
   std::shared_ptr<Bitmap> camera_mask_;
+  PipelineStageStats* stats_;
 
   std::unique_ptr<OpenGLContextManager> opengl_context_;
 
@@ -138,14 +218,18 @@ class SiftFeatureExtractorThread : public Thread {
 class FeatureWriterThread : public Thread {
  public:
   FeatureWriterThread(const size_t num_images, Database* database,
-                      JobQueue<ImageData>* input_queue);
+                      FeatureCache* feature_cache,
+                      JobQueue<ImageData>* input_queue,
+                      PipelineStageStats* stats);
 
  private:
   void Run();
 
   const size_t num_images_;
   Database* database_;
+  FeatureCache* feature_cache_;
   JobQueue<ImageData>* input_queue_;
+  PipelineStageStats* stats_;
 };
 
 }  // namespace internal
@@ -32,22 +32,177 @@
 #include "feature/matching.h"
 
 #include <fstream>
-#include <numeric>
 
 #include "SiftGPU/SiftGPU.h"
 #include "base/gps.h"
+#include "base/spatial_index.h"
+#include "feature/sift_cuda.h"
 #include "feature/utils.h"
 #include "retrieval/visual_index.h"
 #include "util/cuda.h"
+#include "util/endian.h"
+#include "util/gpu_scheduler.h"
 #include "util/misc.h"
+#include "util/profiling.h"
+#include "util/random.h"
 
 namespace colmap {
 namespace {
 
+// Maximum number of batches of image pairs that the sequential and vocabulary
+// tree matchers keep in flight in the matching pipeline. Their batches are
+// small, so several batches are needed to keep all matching threads busy.
+const size_t kMaxNumPendingMatchBatches = 4;
+
+// The loop detection index of the sequential matcher is prepared for queries
+// whenever the number of images indexed since the last preparation reaches
+// this fraction of the previously prepared images, but at least the minimum
+// number. The geometric growth keeps the total cost of the repeated
+// preparations linear in the number of images.
+const size_t kMinNumLoopDetectionBatchImages = 100;
+const double kLoopDetectionBatchGrowth = 0.1;
+
+// Number of images whose visual words are assigned in one batch when indexing
+// images in the visual index.
+const size_t kNumVisualIndexBatchImages = 16;
+
+// Number of blocks of images whose features fit into the cache of the
+// exhaustive matcher.
+const size_t kNumExhaustiveCachedBlocks = 5;
+
+// Number of images after the current window of the sequential matcher, whose
+// features are prefetched into the cache ahead of the matching.
+const size_t kNumSequentialPrefetchImages = 8;
+
+// The stage of the progress lines of the matchers, whose verbosity and rate
+// can be configured through `log_stage_levels` and `log_progress_interval`.
+const char* const kMatchingLogStage = "feature_matching";
+
+// Remove the descriptors of the images, that were evicted from the feature
+// matcher cache since the given number of evictions, from the GPU descriptor
+// cache, so that it retains the descriptors of the images still being matched.
+void EvictCachedDescriptorsGPU(FeatureMatcherCache* cache,
+                               size_t* num_evictions,
+                               SiftMatchGPU* sift_match_gpu) {
+  std::vector<image_t> image_ids;
+  cache->GetEvictedImageIds(num_evictions, &image_ids);
+  for (const auto image_id : image_ids) {
+    EvictCachedSiftDescriptorsGPU(image_id, sift_match_gpu);
+  }
+}
+
 void PrintElapsedTime(const Timer& timer) {
   std::cout << StringPrintf(" in %.3fs", timer.ElapsedSeconds()) << std::endl;
 }
 
+// Print the progress line of a matched image or block with its elapsed time,
+// unless it is dropped by the rate limit of the matching stage.
+void PrintMatchingProgress(const std::string& line, const Timer& timer,
+                           const bool force = false) {
+  if (ShouldPrintProgress(kMatchingLogStage, 0, force)) {
+    std::cout << line;
+    PrintElapsedTime(timer);
+  }
+}
+
+// Order the blocks of the exhaustive matcher, such that the features of as
+// few blocks as possible are read from the database. The rows of the block
+// grid are processed in groups, whose blocks stay in the cache, while the
+// remaining blocks stream past them in alternating directions. The blocks
+// (i, j) and (j, i) share their features and are thus scheduled together.
+// Besides the group, the cache must hold the blocks of the previous, the
+// current, and the prefetched next job, so that the number of column reads is
+// reduced by roughly twice the group size compared to a row-major order.
+std::vector<std::pair<size_t, size_t>> GetExhaustiveBlockSchedule(
+    const size_t num_blocks, const size_t num_cached_blocks) {
+  const size_t group_size =
+      num_cached_blocks > 4 ? num_cached_blocks - 3 : 1;
+
+  std::vector<std::pair<size_t, size_t>> schedule;
+  schedule.reserve(num_blocks * num_blocks);
+
+  bool reverse = false;
+  for (size_t group_begin = 0; group_begin < num_blocks;
+       group_begin += group_size) {
+    const size_t group_end = std::min(group_begin + group_size, num_blocks);
+    for (size_t k = group_begin; k < num_blocks; ++k) {
+      const size_t block_idx2 =
+          reverse ? num_blocks - 1 - (k - group_begin) : k;
+      for (size_t block_idx1 = group_begin;
+           block_idx1 < group_end && block_idx1 <= block_idx2; ++block_idx1) {
+        schedule.emplace_back(block_idx1, block_idx2);
+        if (block_idx1 != block_idx2) {
+          schedule.emplace_back(block_idx2, block_idx1);
+        }
+      }
+    }
+    reverse = !reverse;
+  }
+
+  return schedule;
+}
+
+// Add the image to the visual index with its visual words cached in the
+// database for the vocabulary with the given hash. The cached visual words are
+// only valid for the same descriptors, which is approximated by their number,
+// since selecting a different number of top scale features or re-extracting
+// the features typically changes the number of descriptors. Returns false, if
+// the image has no valid cached visual words and was not added.
+bool AddImageWithCachedVisualWords(
+    const retrieval::VisualIndex<>::IndexOptions& index_options,
+    const uint64_t vocab_hash, const image_t image_id,
+    const FeatureKeypoints& keypoints,
+    const retrieval::VisualIndex<>::DescType& descriptors,
+    FeatureMatcherCache* cache, retrieval::VisualIndex<>* visual_index) {
+  if (descriptors.rows() == 0) {
+    return false;
+  }
+
+  const Eigen::MatrixXi word_ids =
+      cache->GetVisualWordIds(image_id, vocab_hash);
+  if (word_ids.rows() != descriptors.rows() ||
+      word_ids.cols() != index_options.num_neighbors) {
+    return false;
+  }
+
+  visual_index->Add(index_options, image_id, keypoints, descriptors, word_ids);
+
+  return true;
+}
+
+void AddImageToVisualIndex(
+    const retrieval::VisualIndex<>::IndexOptions& index_options,
+    const int max_num_features, const uint64_t vocab_hash,
+    const image_t image_id, FeatureMatcherCache* cache,
+    retrieval::VisualIndex<>* visual_index) {
+  if (visual_index->ImageIndexed(image_id)) {
+    return;
+  }
+
+  auto keypoints = *cache->GetKeypoints(image_id);
+  auto descriptors = *cache->GetDescriptors(image_id);
+  if (max_num_features > 0 && descriptors.rows() > max_num_features) {
+    ExtractTopScaleFeatures(&keypoints, &descriptors, max_num_features);
+  }
+
+  if (AddImageWithCachedVisualWords(index_options, vocab_hash, image_id,
+                                    keypoints, descriptors, cache,
+                                    visual_index)) {
+    return;
+  }
+
+  if (descriptors.rows() == 0) {
+    visual_index->Add(index_options, image_id, keypoints, descriptors);
+    return;
+  }
+
+  const Eigen::MatrixXi word_ids = visual_index->FindWordIds(
+      descriptors, index_options.num_neighbors, index_options.num_checks,
+      index_options.num_threads);
+  visual_index->Add(index_options, image_id, keypoints, descriptors, word_ids);
+  cache->WriteVisualWordIds(vocab_hash, {image_id}, {word_ids});
+}
+
 void IndexImagesInVisualIndex(const int num_threads, const int num_checks,
                               const int max_num_features,
                               const std::vector<image_t>& image_ids,
@@ -57,26 +212,83 @@ void IndexImagesInVisualIndex(const int num_threads, const int num_checks,
   index_options.num_threads = num_threads;
   index_options.num_checks = num_checks;
 
+  // The visual words of the images are cached in the database for this
+  // vocabulary, so that subsequent runs do not need to re-quantize them.
+  const uint64_t vocab_hash = visual_index->VocabularyHash();
+
+  std::vector<int> batch_image_ids;
+  std::vector<FeatureKeypoints> batch_keypoints;
+  std::vector<retrieval::VisualIndex<>::DescType> batch_descriptors;
+  std::vector<Eigen::MatrixXi> batch_word_ids;
+  size_t num_cached_images = 0;
+
+  Timer timer;
+
+  const auto AddBatch = [&](const size_t i) {
+    std::cout << StringPrintf("Indexing images [%d/%d] (%d images)", i + 1,
+                              image_ids.size(), batch_image_ids.size())
+              << std::flush;
+    visual_index->Add(index_options, batch_image_ids, batch_keypoints,
+                      batch_descriptors, &batch_word_ids);
+    const std::vector<image_t> word_image_ids(batch_image_ids.begin(),
+                                              batch_image_ids.end());
+    cache->WriteVisualWordIds(vocab_hash, word_image_ids, batch_word_ids);
+    PrintElapsedTime(timer);
+    batch_image_ids.clear();
+    batch_keypoints.clear();
+    batch_descriptors.clear();
+    batch_word_ids.clear();
+  };
+
+  // The visual words of a batch of images are assigned at once, which keeps
+  // the GPU busy, if the visual index searches the words on the GPU.
   for (size_t i = 0; i < image_ids.size(); ++i) {
     if (thread->IsStopped()) {
       return;
     }
 
-    Timer timer;
-    timer.Start();
+    // Images from a previously written index do not need to be re-quantized.
+    if (visual_index->ImageIndexed(image_ids[i])) {
+      std::cout << StringPrintf("Indexing image [%d/%d] -> already indexed",
+                                i + 1, image_ids.size())
+                << std::endl;
+      continue;
+    }
 
-    std::cout << StringPrintf("Indexing image [%d/%d]", i + 1, image_ids.size())
-              << std::flush;
+    if (batch_image_ids.empty()) {
+      timer.Restart();
+    }
 
-    auto keypoints = cache->GetKeypoints(image_ids[i]);
-    auto descriptors = cache->GetDescriptors(image_ids[i]);
+    auto keypoints = *cache->GetKeypoints(image_ids[i]);
+    auto descriptors = *cache->GetDescriptors(image_ids[i]);
     if (max_num_features > 0 && descriptors.rows() > max_num_features) {
       ExtractTopScaleFeatures(&keypoints, &descriptors, max_num_features);
     }
 
-    visual_index->Add(index_options, image_ids[i], keypoints, descriptors);
+    if (AddImageWithCachedVisualWords(index_options, vocab_hash,
+                                      image_ids[i], keypoints, descriptors,
+                                      cache, visual_index)) {
+      num_cached_images += 1;
+      continue;
+    }
 
-    PrintElapsedTime(timer);
+    batch_image_ids.push_back(image_ids[i]);
+    batch_keypoints.push_back(std::move(keypoints));
+    batch_descriptors.push_back(descriptors);
+
+    if (batch_image_ids.size() == kNumVisualIndexBatchImages) {
+      AddBatch(i);
+    }
+  }
+
+  if (!batch_image_ids.empty()) {
+    AddBatch(image_ids.size() - 1);
+  }
+
+  if (num_cached_images > 0) {
+    std::cout << StringPrintf("Indexed %d images with cached visual words",
+                              num_cached_images)
+              << std::endl;
   }
 
   // Compute the TF-IDF weights, etc.
@@ -88,7 +300,9 @@ void MatchNearestNeighborsInVisualIndex(
     const int num_checks, const int num_images_after_verification,
     const int max_num_features, const std::vector<image_t>& image_ids,
     Thread* thread, FeatureMatcherCache* cache,
-    retrieval::VisualIndex<>* visual_index, SiftFeatureMatcher* matcher) {
+    retrieval::VisualIndex<>* visual_index, SiftFeatureMatcher* matcher,
+    const std::function<bool(image_t, image_t)>& exclude_image_pair =
+        nullptr) {
   struct Retrieval {
     image_t image_id = kInvalidImageId;
     std::vector<retrieval::ImageScore> image_scores;
@@ -106,9 +320,11 @@ void MatchNearestNeighborsInVisualIndex(
   query_options.num_neighbors = num_neighbors;
   query_options.num_checks = num_checks;
   query_options.num_images_after_verification = num_images_after_verification;
+  // The images are already queried in parallel by the retrieval thread pool.
+  query_options.num_threads = 1;
   auto QueryFunc = [&](const image_t image_id) {
-    auto keypoints = cache->GetKeypoints(image_id);
-    auto descriptors = cache->GetDescriptors(image_id);
+    auto keypoints = *cache->GetKeypoints(image_id);
+    auto descriptors = *cache->GetDescriptors(image_id);
     if (max_num_features > 0 && descriptors.rows() > max_num_features) {
       ExtractTopScaleFeatures(&keypoints, &descriptors, max_num_features);
     }
@@ -121,6 +337,12 @@ void MatchNearestNeighborsInVisualIndex(
     CHECK(retrieval_queue.Push(retrieval));
   };
 
+  // A previously written index may contain images that no longer exist in the
+  // database, which must not be matched.
+  const std::vector<image_t> database_image_ids = cache->GetImageIds();
+  const std::unordered_set<image_t> database_image_id_set(
+      database_image_ids.begin(), database_image_ids.end());
+
   // Initially, make all retrieval threads busy and continue with the matching.
   size_t image_idx = 0;
   const size_t init_num_tasks =
@@ -141,8 +363,9 @@ void MatchNearestNeighborsInVisualIndex(
     Timer timer;
     timer.Start();
 
-    std::cout << StringPrintf("Matching image [%d/%d]", i + 1, image_ids.size())
-              << std::flush;
+    const std::string image_name =
+        StringPrintf("Matching image [%d/%d]", i + 1, image_ids.size());
+    const bool last_image = i + 1 == image_ids.size();
 
     // Push the next image to the retrieval queue.
     if (image_idx < image_ids.size()) {
@@ -161,19 +384,265 @@ void MatchNearestNeighborsInVisualIndex(
     image_pairs.clear();
     image_pairs.reserve(image_scores.size());
     for (const auto image_score : image_scores) {
-      image_pairs.emplace_back(image_id, image_score.image_id);
+      if (database_image_id_set.count(image_score.image_id) > 0 &&
+          (!exclude_image_pair ||
+           !exclude_image_pair(image_id, image_score.image_id))) {
+        image_pairs.emplace_back(image_id, image_score.image_id);
+      }
     }
 
-    matcher->Match(image_pairs);
+    matcher->MatchAsync(image_pairs, [image_name, timer, last_image]() {
+      PrintMatchingProgress(image_name, timer, last_image);
+    });
+    matcher->Wait(kMaxNumPendingMatchBatches);
+  }
 
-    PrintElapsedTime(timer);
+  matcher->Wait();
+}
+
+// Query the given images in the loop detection index of the sequential
+// matcher, which contains all images up to the current position in the
+// sequence, and match them against the retrieved images.
+void RunSequentialLoopDetection(
+    const SequentialMatchingOptions& options,
+    const SiftMatchingOptions& match_options,
+    const std::unordered_map<image_t, size_t>& image_idxs,
+    const std::vector<image_t>& loop_image_ids, Thread* thread,
+    FeatureMatcherCache* cache, retrieval::VisualIndex<>* visual_index,
+    SiftFeatureMatcher* matcher) {
+  // Compute the TF-IDF weights, etc. of all images indexed so far.
+  visual_index->Prepare();
+
+  // Images close to each other in the sequence are already matched by the
+  // sequential matching.
+  const size_t exclusion_window =
+      static_cast<size_t>(options.loop_detection_exclusion_window);
+  const auto ExcludeImagePair = [&image_idxs, exclusion_window](
+                                    const image_t image_id1,
+                                    const image_t image_id2) {
+    const auto it1 = image_idxs.find(image_id1);
+    const auto it2 = image_idxs.find(image_id2);
+    if (it1 == image_idxs.end() || it2 == image_idxs.end()) {
+      return false;
+    }
+    const size_t image_idx_diff = it1->second > it2->second
+                                      ? it1->second - it2->second
+                                      : it2->second - it1->second;
+    return image_idx_diff <= exclusion_window;
+  };
+
+  MatchNearestNeighborsInVisualIndex(
+      match_options.num_threads, options.loop_detection_num_images,
+      options.loop_detection_num_nearest_neighbors,
+      options.loop_detection_num_checks,
+      options.loop_detection_num_images_after_verification,
+      options.loop_detection_max_num_features, loop_image_ids, thread, cache,
+      visual_index, matcher, ExcludeImagePair);
+}
+
+// Verified image pair in the adjacency of the transitive matcher.
+struct TransitiveEdge {
+  size_t image_idx;
+  int num_inliers;
+  // The transitive matching iteration in which the image pair was added.
+  int iteration;
+};
+
+// Find the unknown image pairs a-c connected by a path a-b-c of two verified
+// image pairs, of which at least one was verified in the given iteration,
+// i.e., is in the frontier. The image pairs are ranked by their evidence of
+// shared tracks, which is the minimum number of inliers along a path summed
+// over all paths between the two images. The frontier is expanded in
+// parallel and at most `max_num_image_pairs` are returned, if positive.
+std::vector<image_pair_t> FindTransitiveImagePairs(
+    const std::vector<image_t>& image_ids,
+    const std::vector<std::vector<TransitiveEdge>>& adjacency,
+    const std::vector<std::pair<size_t, size_t>>& frontier,
+    const std::unordered_set<image_pair_t>& known_image_pair_ids,
+    const int iteration, const int max_num_image_pairs,
+    const int num_threads) {
+  typedef std::unordered_map<image_pair_t, double> ScoreMap;
+
+  // Expands the paths through one frontier edge, where the edge is the first
+  // part of the path from image_idx1 via image_idx2.
+  const auto ExpandEdge = [&](const size_t image_idx1, const size_t image_idx2,
+                              const int num_inliers,
+                              const image_pair_t edge_pair_id,
+                              ScoreMap* scores) {
+    for (const auto& edge : adjacency[image_idx2]) {
+      if (edge.image_idx == image_idx1) {
+        continue;
+      }
+      // Count paths of two frontier edges only once.
+      if (edge.iteration == iteration &&
+          Database::ImagePairToPairId(image_ids[image_idx2],
+                                      image_ids[edge.image_idx]) <
+              edge_pair_id) {
+        continue;
+      }
+      const image_pair_t pair_id = Database::ImagePairToPairId(
+          image_ids[image_idx1], image_ids[edge.image_idx]);
+      if (known_image_pair_ids.count(pair_id) == 0) {
+        (*scores)[pair_id] += std::min(num_inliers, edge.num_inliers);
+      }
+    }
+  };
+
+  ThreadPool thread_pool(num_threads);
+  const size_t num_chunks = thread_pool.NumThreads();
+  const size_t chunk_size = (frontier.size() + num_chunks - 1) / num_chunks;
+  std::vector<ScoreMap> chunk_scores(num_chunks);
+  for (size_t chunk_idx = 0; chunk_idx < num_chunks; ++chunk_idx) {
+    const size_t begin = chunk_idx * chunk_size;
+    const size_t end = std::min(begin + chunk_size, frontier.size());
+    if (begin >= end) {
+      break;
+    }
+    thread_pool.AddTask([&, chunk_idx, begin, end]() {
+      ScoreMap& scores = chunk_scores[chunk_idx];
+      for (size_t i = begin; i < end; ++i) {
+        const size_t image_idx1 = frontier[i].first;
+        const size_t image_idx2 = frontier[i].second;
+        const image_pair_t edge_pair_id = Database::ImagePairToPairId(
+            image_ids[image_idx1], image_ids[image_idx2]);
+        int num_inliers = 0;
+        for (const auto& edge : adjacency[image_idx1]) {
+          if (edge.image_idx == image_idx2) {
+            num_inliers = edge.num_inliers;
+            break;
+          }
+        }
+        ExpandEdge(image_idx1, image_idx2, num_inliers, edge_pair_id,
+                   &scores);
+        ExpandEdge(image_idx2, image_idx1, num_inliers, edge_pair_id,
+                   &scores);
+      }
+    });
+  }
+  thread_pool.Wait();
+
+  ScoreMap& scores = chunk_scores[0];
+  for (size_t chunk_idx = 1; chunk_idx < num_chunks; ++chunk_idx) {
+    for (const auto& score : chunk_scores[chunk_idx]) {
+      scores[score.first] += score.second;
+    }
+    ScoreMap().swap(chunk_scores[chunk_idx]);
+  }
+
+  std::vector<std::pair<double, image_pair_t>> ranked_image_pairs;
+  ranked_image_pairs.reserve(scores.size());
+  for (const auto& score : scores) {
+    ranked_image_pairs.emplace_back(score.second, score.first);
+  }
+
+  size_t num_image_pairs = ranked_image_pairs.size();
+  if (max_num_image_pairs > 0) {
+    num_image_pairs =
+        std::min(num_image_pairs, static_cast<size_t>(max_num_image_pairs));
   }
+  std::partial_sort(
+      ranked_image_pairs.begin(), ranked_image_pairs.begin() + num_image_pairs,
+      ranked_image_pairs.end(),
+      std::greater<std::pair<double, image_pair_t>>());
+
+  std::vector<image_pair_t> image_pair_ids(num_image_pairs);
+  for (size_t i = 0; i < num_image_pairs; ++i) {
+    image_pair_ids[i] = ranked_image_pairs[i].second;
+  }
+
+  return image_pair_ids;
+}
+
+// Image pair with its matches as read from an import file.
+struct ImportedMatches {
+  std::string image_name1;
+  std::string image_name2;
+  FeatureMatches matches;
+};
+
+// Read the next image pair and its matches from a text file in the format of
+// `FeaturePairsMatchingOptions`. Returns false at the end of the file.
+bool ReadNextTextMatches(std::istream* file, ImportedMatches* data) {
+  std::string line;
+  bool found_pair = false;
+  while (std::getline(*file, line)) {
+    StringTrim(&line);
+    if (!line.empty()) {
+      found_pair = true;
+      break;
+    }
+  }
+
+  if (!found_pair) {
+    return false;
+  }
+
+  std::istringstream line_stream(line);
+  line_stream >> data->image_name1 >> data->image_name2;
+
+  data->matches.clear();
+  while (std::getline(*file, line)) {
+    StringTrim(&line);
+    if (line.empty()) {
+      break;
+    }
+
+    // Parse the indices in place, which is much faster than string streams.
+    const char* cursor = line.c_str();
+    char* end;
+    FeatureMatch match;
+    match.point2D_idx1 = static_cast<point2D_t>(std::strtoul(cursor, &end, 10));
+    const bool valid_idx1 = end != cursor;
+    cursor = end;
+    match.point2D_idx2 = static_cast<point2D_t>(std::strtoul(cursor, &end, 10));
+    if (!valid_idx1 || end == cursor) {
+      std::cerr << "ERROR: Cannot read feature matches." << std::endl;
+      break;
+    }
+
+    data->matches.push_back(match);
+  }
+
+  return true;
+}
+
+// Read the next image pair and its matches from a binary file in the format
+// of `FeaturePairsMatchingOptions`. Returns false at the end of the file.
+bool ReadNextBinaryMatches(std::istream* file, ImportedMatches* data) {
+  if (file->peek() == std::char_traits<char>::eof()) {
+    return false;
+  }
+
+  const auto ReadImageName = [file](std::string* image_name) {
+    const uint32_t length = ReadBinaryLittleEndian<uint32_t>(file);
+    image_name->resize(length);
+    file->read(&(*image_name)[0], length);
+  };
+
+  ReadImageName(&data->image_name1);
+  ReadImageName(&data->image_name2);
+
+  const size_t num_matches = ReadBinaryLittleEndian<uint64_t>(file);
+  std::vector<point2D_t> point2D_idxs(2 * num_matches);
+  file->read(reinterpret_cast<char*>(point2D_idxs.data()),
+             point2D_idxs.size() * sizeof(point2D_t));
+  CHECK(*file) << "Invalid binary matches file";
+
+  data->matches.resize(num_matches);
+  for (size_t i = 0; i < num_matches; ++i) {
+    data->matches[i].point2D_idx1 = LittleEndianToNative(point2D_idxs[2 * i]);
+    data->matches[i].point2D_idx2 =
+        LittleEndianToNative(point2D_idxs[2 * i + 1]);
+  }
+
+  return true;
 }
 
 }  // namespace
 
 bool ExhaustiveMatchingOptions::Check() const {
   CHECK_OPTION_GT(block_size, 1);
+  CHECK_OPTION_GE(pre_filter_min_score, 0.0);
   return true;
 }
 
@@ -183,6 +652,7 @@ bool SequentialMatchingOptions::Check() const {
   CHECK_OPTION_GT(loop_detection_num_images, 0);
   CHECK_OPTION_GT(loop_detection_num_nearest_neighbors, 0);
   CHECK_OPTION_GT(loop_detection_num_checks, 0);
+  CHECK_OPTION_GE(loop_detection_exclusion_window, 0);
   return true;
 }
 
@@ -196,12 +666,14 @@ bool VocabTreeMatchingOptions::Check() const {
 bool SpatialMatchingOptions::Check() const {
   CHECK_OPTION_GT(max_num_neighbors, 0);
   CHECK_OPTION_GT(max_distance, 0.0);
+  CHECK_OPTION_GE(pre_filter_min_score, 0.0);
   return true;
 }
 
 bool TransitiveMatchingOptions::Check() const {
   CHECK_OPTION_GT(batch_size, 0);
   CHECK_OPTION_GT(num_iterations, 0);
+  CHECK_OPTION_NE(max_num_image_pairs, 0);
   return true;
 }
 
@@ -213,8 +685,13 @@ bool ImagePairsMatchingOptions::Check() const {
 bool FeaturePairsMatchingOptions::Check() const { return true; }
 
 FeatureMatcherCache::FeatureMatcherCache(const size_t cache_size,
-                                         const Database* database)
-    : cache_size_(cache_size), database_(database) {
+                                         Database* database)
+    : cache_size_(cache_size),
+      database_(database),
+      num_loaded_keypoints_(0),
+      num_loaded_keypoints_bytes_(0),
+      num_loaded_descriptors_(0),
+      num_loaded_descriptors_bytes_(0) {
   CHECK_NOTNULL(database_);
 }
 
@@ -231,15 +708,89 @@ void FeatureMatcherCache::Setup() {
     images_cache_.emplace(image.ImageId(), image);
   }
 
-  keypoints_cache_.reset(new LRUCache<image_t, FeatureKeypoints>(
-      cache_size_, [this](const image_t image_id) {
-        return database_->ReadKeypoints(image_id);
+  // Use one shard per hardware thread to reduce contention between the
+  // matcher and verifier threads. The features of cache misses are read
+  // through separate read-only connections, so that the threads do not
+  // serialize on the database. Otherwise, the database is only locked while
+  // reading the data of a cache miss.
+  const size_t num_shards = GetEffectiveNumThreads(-1);
+
+  if (DatabaseReadPool::IsSupported(database_->Path())) {
+    database_read_pool_.reset(new DatabaseReadPool(database_->Path()));
+  }
+
+  // The memory usage is reported, whenever features are loaded.
+  memory_component_.reset(new ScopedMemoryComponent(
+      "feature_matcher_cache", [this]() { return NumBytes(); },
+      [this](const size_t num_bytes) { Shrink(num_bytes); }));
+
+  keypoints_cache_.reset(new ShardedLRUCache<image_t, FeatureKeypoints>(
+      cache_size_, num_shards, [this](const image_t image_id) {
+        FeatureKeypoints keypoints;
+        if (database_read_pool_) {
+          keypoints = database_read_pool_->Acquire()->ReadKeypoints(image_id);
+        } else {
+          std::unique_lock<std::mutex> lock(database_mutex_);
+          keypoints = database_->ReadKeypoints(image_id);
+        }
+        num_loaded_keypoints_ += 1;
+        num_loaded_keypoints_bytes_ +=
+            keypoints.size() * sizeof(FeatureKeypoint);
+        memory_component_->Update();
+        return keypoints;
       }));
 
-  descriptors_cache_.reset(new LRUCache<image_t, FeatureDescriptors>(
-      cache_size_, [this](const image_t image_id) {
-        return database_->ReadDescriptors(image_id);
+  descriptors_cache_.reset(new ShardedLRUCache<image_t, FeatureDescriptors>(
+      cache_size_, num_shards, [this](const image_t image_id) {
+        FeatureDescriptors descriptors;
+        if (database_read_pool_) {
+          descriptors =
+              database_read_pool_->Acquire()->ReadDescriptors(image_id);
+        } else {
+          std::unique_lock<std::mutex> lock(database_mutex_);
+          descriptors = database_->ReadDescriptors(image_id);
+        }
+        num_loaded_descriptors_ += 1;
+        num_loaded_descriptors_bytes_ +=
+            descriptors.size() * sizeof(FeatureDescriptors::Scalar);
+        memory_component_->Update();
+        return descriptors;
       }));
+
+  // The indices share the descriptors with the descriptors cache, so that a
+  // cached index keeps its descriptors alive even if they were evicted.
+  flann_index_cache_.reset(new ShardedLRUCache<image_t, SiftFLANNIndex>(
+      cache_size_, num_shards, [this](const image_t image_id) {
+        return SiftFLANNIndex(GetDescriptors(image_id));
+      }));
+}
+
+size_t FeatureMatcherCache::NumBytes() const {
+  size_t num_bytes = 0;
+  if (num_loaded_keypoints_ > 0) {
+    num_bytes += keypoints_cache_->NumElems() * num_loaded_keypoints_bytes_ /
+                 num_loaded_keypoints_;
+  }
+  if (num_loaded_descriptors_ > 0) {
+    num_bytes += descriptors_cache_->NumElems() *
+                 num_loaded_descriptors_bytes_ / num_loaded_descriptors_;
+  }
+  return num_bytes;
+}
+
+void FeatureMatcherCache::Shrink(const size_t num_bytes) {
+  const size_t cached_num_bytes = NumBytes();
+  if (cached_num_bytes == 0) {
+    return;
+  }
+  const double retained_fraction =
+      1.0 - std::min(1.0, static_cast<double>(num_bytes) / cached_num_bytes);
+  keypoints_cache_->Shrink(
+      static_cast<size_t>(retained_fraction * keypoints_cache_->NumElems()));
+  descriptors_cache_->Shrink(
+      static_cast<size_t>(retained_fraction * descriptors_cache_->NumElems()));
+  flann_index_cache_->Shrink(
+      static_cast<size_t>(retained_fraction * flann_index_cache_->NumElems()));
 }
 
 const Camera& FeatureMatcherCache::GetCamera(const camera_t camera_id) const {
@@ -250,18 +801,45 @@ const Image& FeatureMatcherCache::GetImage(const image_t image_id) const {
   return images_cache_.at(image_id);
 }
 
-const FeatureKeypoints& FeatureMatcherCache::GetKeypoints(
+std::shared_ptr<const FeatureKeypoints> FeatureMatcherCache::GetKeypoints(
     const image_t image_id) {
-  std::unique_lock<std::mutex> lock(database_mutex_);
   return keypoints_cache_->Get(image_id);
 }
 
-const FeatureDescriptors& FeatureMatcherCache::GetDescriptors(
+std::shared_ptr<const FeatureDescriptors> FeatureMatcherCache::GetDescriptors(
     const image_t image_id) {
-  std::unique_lock<std::mutex> lock(database_mutex_);
   return descriptors_cache_->Get(image_id);
 }
 
+std::shared_ptr<const SiftFLANNIndex> FeatureMatcherCache::GetFLANNIndex(
+    const image_t image_id) {
+  return flann_index_cache_->Get(image_id);
+}
+
+void FeatureMatcherCache::Prefetch(const image_t image_id) {
+  keypoints_cache_->Prefetch(image_id);
+  descriptors_cache_->Prefetch(image_id);
+}
+
+void FeatureMatcherCache::Evict(const image_t image_id) {
+  keypoints_cache_->Erase(image_id);
+  descriptors_cache_->Erase(image_id);
+  flann_index_cache_->Erase(image_id);
+  std::unique_lock<std::mutex> lock(evicted_image_ids_mutex_);
+  evicted_image_ids_.push_back(image_id);
+}
+
+void FeatureMatcherCache::GetEvictedImageIds(size_t* num_evictions,
+                                             std::vector<image_t>* image_ids) {
+  CHECK_NOTNULL(num_evictions);
+  CHECK_NOTNULL(image_ids);
+  std::unique_lock<std::mutex> lock(evicted_image_ids_mutex_);
+  CHECK_LE(*num_evictions, evicted_image_ids_.size());
+  image_ids->assign(evicted_image_ids_.begin() + *num_evictions,
+                    evicted_image_ids_.end());
+  *num_evictions = evicted_image_ids_.size();
+}
+
 FeatureMatches FeatureMatcherCache::GetMatches(const image_t image_id1,
                                                const image_t image_id2) {
   std::unique_lock<std::mutex> lock(database_mutex_);
@@ -303,6 +881,18 @@ void FeatureMatcherCache::WriteTwoViewGeometry(
   database_->WriteTwoViewGeometry(image_id1, image_id2, two_view_geometry);
 }
 
+void FeatureMatcherCache::WriteMatchesAndTwoViewGeometries(
+    const std::vector<internal::FeatureMatcherData>& data) {
+  std::unique_lock<std::mutex> lock(database_mutex_);
+  DatabaseTransaction database_transaction(database_);
+  for (const auto& pair_data : data) {
+    database_->WriteMatches(pair_data.image_id1, pair_data.image_id2,
+                            pair_data.matches);
+    database_->WriteTwoViewGeometry(pair_data.image_id1, pair_data.image_id2,
+                                    pair_data.two_view_geometry);
+  }
+}
+
 void FeatureMatcherCache::DeleteMatches(const image_t image_id1,
                                         const image_t image_id2) {
   std::unique_lock<std::mutex> lock(database_mutex_);
@@ -315,6 +905,29 @@ void FeatureMatcherCache::DeleteInlierMatches(const image_t image_id1,
   database_->DeleteInlierMatches(image_id1, image_id2);
 }
 
+Eigen::MatrixXi FeatureMatcherCache::GetVisualWordIds(
+    const image_t image_id, const uint64_t vocab_hash) {
+  std::unique_lock<std::mutex> lock(database_mutex_);
+  return database_->ReadVisualWordIds(image_id, vocab_hash);
+}
+
+void FeatureMatcherCache::WriteVisualWordIds(
+    const uint64_t vocab_hash, const std::vector<image_t>& image_ids,
+    const std::vector<Eigen::MatrixXi>& word_ids) {
+  CHECK_EQ(image_ids.size(), word_ids.size());
+  std::unique_lock<std::mutex> lock(database_mutex_);
+  if (database_->IsReadOnly()) {
+    return;
+  }
+  DatabaseTransaction database_transaction(database_);
+  for (size_t i = 0; i < image_ids.size(); ++i) {
+    // Images without descriptors need not be quantized.
+    if (word_ids[i].size() > 0) {
+      database_->WriteVisualWordIds(image_ids[i], vocab_hash, word_ids[i]);
+    }
+  }
+}
+
 FeatureMatcherThread::FeatureMatcherThread(const SiftMatchingOptions& options,
                                            FeatureMatcherCache* cache)
     : options_(options), cache_(cache) {}
@@ -341,17 +954,16 @@ void SiftCPUFeatureMatcher::Run() {
       break;
     }
 
-    const auto input_job = input_queue_->Pop();
+    auto input_job = input_queue_->Pop();
     if (input_job.IsValid()) {
-      auto data = input_job.Data();
+      auto data = std::move(input_job.Data());
 
-      const FeatureDescriptors descriptors1 =
-          cache_->GetDescriptors(data.image_id1);
-      const FeatureDescriptors descriptors2 =
-          cache_->GetDescriptors(data.image_id2);
-      MatchSiftFeaturesCPU(options_, descriptors1, descriptors2, &data.matches);
+      const auto index1 = cache_->GetFLANNIndex(data.image_id1);
+      const auto index2 = cache_->GetFLANNIndex(data.image_id2);
+      MatchSiftFeaturesCPUFLANN(options_, *index1, *index2, &data.matches);
+      ProfileCounter("matched_pairs", 1);
 
-      CHECK(output_queue_->Push(data));
+      CHECK(output_queue_->Push(std::move(data)));
     }
   }
 }
@@ -367,6 +979,8 @@ SiftGPUFeatureMatcher::SiftGPUFeatureMatcher(const SiftMatchingOptions& options,
 
   prev_uploaded_image_ids_[0] = kInvalidImageId;
   prev_uploaded_image_ids_[1] = kInvalidImageId;
+  prefetched_image_ids_[0] = kInvalidImageId;
+  prefetched_image_ids_[1] = kInvalidImageId;
 
 #ifndef CUDA_ENABLED
   opengl_context_.reset(new OpenGLContextManager());
@@ -388,39 +1002,164 @@ void SiftGPUFeatureMatcher::Run() {
 
   SignalValidSetup();
 
+  // The next job is popped and its descriptors are fetched from the cache,
+  // while the current job is matched on the GPU.
+  ThreadPool prefetch_thread_pool(1);
+  auto next_input_job = prefetch_thread_pool.AddTask(
+      &SiftGPUFeatureMatcher::PrefetchInputJob, this);
+
+  size_t num_evictions = 0;
+
   while (true) {
     if (IsStopped()) {
       break;
     }
 
-    const auto input_job = input_queue_->Pop();
+    auto input_job = next_input_job.get();
     if (input_job.IsValid()) {
-      auto data = input_job.Data();
+      auto data = std::move(input_job.Data());
 
-      const FeatureDescriptors* descriptors1_ptr;
-      GetDescriptorData(0, data.image_id1, &descriptors1_ptr);
-      const FeatureDescriptors* descriptors2_ptr;
-      GetDescriptorData(1, data.image_id2, &descriptors2_ptr);
-      MatchSiftFeaturesGPU(options_, descriptors1_ptr, descriptors2_ptr,
-                           &sift_match_gpu, &data.matches);
+      // SiftMatchGPU allocates its buffers on setup, so the lease only
+      // accounts for the occupancy of the device.
+      GpuScheduler::Lease gpu_lease =
+          GpuScheduler::Get().Acquire(options_.gpu_index);
 
-      CHECK(output_queue_->Push(data));
+      EvictCachedDescriptorsGPU(cache_, &num_evictions, &sift_match_gpu);
+
+      SetDescriptorData(0, data.image_id1, &sift_match_gpu);
+      SetDescriptorData(1, data.image_id2, &sift_match_gpu);
+
+      next_input_job = prefetch_thread_pool.AddTask(
+          &SiftGPUFeatureMatcher::PrefetchInputJob, this);
+
+      MatchSiftFeaturesGPU(options_, nullptr, nullptr, &sift_match_gpu,
+                           &data.matches);
+      ProfileCounter("matched_pairs", 1);
+
+      CHECK(output_queue_->Push(std::move(data)));
+    } else {
+      next_input_job = prefetch_thread_pool.AddTask(
+          &SiftGPUFeatureMatcher::PrefetchInputJob, this);
     }
   }
+
 }
 
-void SiftGPUFeatureMatcher::GetDescriptorData(
-    const int index, const image_t image_id,
-    const FeatureDescriptors** descriptors_ptr) {
+void SiftGPUFeatureMatcher::SetDescriptorData(const int index,
+                                              const image_t image_id,
+                                              SiftMatchGPU* sift_match_gpu) {
   CHECK_GE(index, 0);
   CHECK_LE(index, 1);
   if (prev_uploaded_image_ids_[index] == image_id) {
-    *descriptors_ptr = nullptr;
-  } else {
-    prev_uploaded_descriptors_[index] = cache_->GetDescriptors(image_id);
-    *descriptors_ptr = &prev_uploaded_descriptors_[index];
-    prev_uploaded_image_ids_[index] = image_id;
+    return;
+  }
+
+  if (!SetCachedSiftDescriptorsGPU(index, image_id, sift_match_gpu)) {
+    if (prefetched_image_ids_[index] == image_id) {
+      std::swap(prev_uploaded_descriptors_[index],
+                prefetched_descriptors_[index]);
+    } else {
+      prev_uploaded_descriptors_[index] = cache_->GetDescriptors(image_id);
+    }
+    UploadSiftDescriptorsGPU(index, image_id,
+                             *prev_uploaded_descriptors_[index],
+                             sift_match_gpu);
   }
+
+  if (prefetched_image_ids_[index] == image_id) {
+    prefetched_image_ids_[index] = kInvalidImageId;
+    prefetched_descriptors_[index].reset();
+  }
+
+  prev_uploaded_image_ids_[index] = image_id;
+}
+
+JobQueue<SiftGPUFeatureMatcher::Input>::Job
+SiftGPUFeatureMatcher::PrefetchInputJob() {
+  auto input_job = input_queue_->Pop();
+  if (input_job.IsValid()) {
+    PrefetchDescriptorData(0, input_job.Data().image_id1);
+    PrefetchDescriptorData(1, input_job.Data().image_id2);
+  }
+  return input_job;
+}
+
+void SiftGPUFeatureMatcher::PrefetchDescriptorData(const int index,
+                                                   const image_t image_id) {
+  CHECK_GE(index, 0);
+  CHECK_LE(index, 1);
+  if (prev_uploaded_image_ids_[index] != image_id &&
+      prefetched_image_ids_[index] != image_id) {
+    prefetched_descriptors_[index] = cache_->GetDescriptors(image_id);
+    prefetched_image_ids_[index] = image_id;
+  }
+}
+
+SiftCUDAFeatureMatcher::SiftCUDAFeatureMatcher(
+    const SiftMatchingOptions& options, FeatureMatcherCache* cache,
+    JobQueue<Input>* input_queue, JobQueue<Output>* output_queue)
+    : FeatureMatcherThread(options, cache),
+      input_queue_(input_queue),
+      output_queue_(output_queue) {
+  CHECK(options_.Check());
+}
+
+void SiftCUDAFeatureMatcher::Run() {
+#ifdef CUDA_ENABLED
+  SetBestCudaDevice(std::stoi(options_.gpu_index));
+
+  SiftMatcherCUDA sift_matcher_cuda;
+
+  SignalValidSetup();
+
+  std::array<image_t, 2> uploaded_image_ids;
+  std::array<point2D_t, 2> uploaded_num_descriptors;
+  uploaded_image_ids.fill(kInvalidImageId);
+  uploaded_num_descriptors.fill(0);
+
+  while (true) {
+    if (IsStopped()) {
+      break;
+    }
+
+    auto input_job = input_queue_->Pop();
+    if (input_job.IsValid()) {
+      auto data = std::move(input_job.Data());
+
+      // Fetch the descriptors before leasing the device, since they might
+      // have to be read from the database.
+      const std::array<image_t, 2> image_ids = {
+          {data.image_id1, data.image_id2}};
+      std::array<std::shared_ptr<const FeatureDescriptors>, 2> descriptors;
+      for (int i = 0; i < 2; ++i) {
+        if (uploaded_image_ids[i] != image_ids[i]) {
+          descriptors[i] = cache_->GetDescriptors(image_ids[i]);
+          uploaded_num_descriptors[i] = descriptors[i]->rows();
+        }
+      }
+
+      GpuScheduler::Lease gpu_lease = GpuScheduler::Get().Acquire(
+          options_.gpu_index,
+          SiftMatcherCUDA::EstimateMemory(uploaded_num_descriptors[0],
+                                          uploaded_num_descriptors[1]));
+
+      for (int i = 0; i < 2; ++i) {
+        if (descriptors[i]) {
+          sift_matcher_cuda.SetDescriptors(i, *descriptors[i]);
+          uploaded_image_ids[i] = image_ids[i];
+        }
+      }
+
+      sift_matcher_cuda.Match(options_, &data.matches);
+      ProfileCounter("matched_pairs", 1);
+
+      CHECK(output_queue_->Push(std::move(data)));
+    }
+  }
+#else
+  std::cout << "ERROR: Tensor core matching requires CUDA" << std::endl;
+  SignalInvalidSetup();
+#endif
 }
 
 GuidedSiftCPUFeatureMatcher::GuidedSiftCPUFeatureMatcher(
@@ -440,26 +1179,26 @@ void GuidedSiftCPUFeatureMatcher::Run() {
       break;
     }
 
-    const auto input_job = input_queue_->Pop();
+    auto input_job = input_queue_->Pop();
     if (input_job.IsValid()) {
-      auto data = input_job.Data();
+      auto data = std::move(input_job.Data());
 
       if (data.two_view_geometry.inlier_matches.size() <
           static_cast<size_t>(options_.min_num_inliers)) {
-        CHECK(output_queue_->Push(data));
+        CHECK(output_queue_->Push(std::move(data)));
         continue;
       }
 
-      const FeatureKeypoints keypoints1 = cache_->GetKeypoints(data.image_id1);
-      const FeatureKeypoints keypoints2 = cache_->GetKeypoints(data.image_id2);
-      const FeatureDescriptors descriptors1 =
-          cache_->GetDescriptors(data.image_id1);
-      const FeatureDescriptors descriptors2 =
-          cache_->GetDescriptors(data.image_id2);
-      MatchGuidedSiftFeaturesCPU(options_, keypoints1, keypoints2, descriptors1,
-                                 descriptors2, &data.two_view_geometry);
-
-      CHECK(output_queue_->Push(data));
+      const auto keypoints1 = cache_->GetKeypoints(data.image_id1);
+      const auto keypoints2 = cache_->GetKeypoints(data.image_id2);
+      const auto descriptors1 = cache_->GetDescriptors(data.image_id1);
+      const auto descriptors2 = cache_->GetDescriptors(data.image_id2);
+      MatchGuidedSiftFeaturesCPU(options_, *keypoints1, *keypoints2,
+                                 *descriptors1, *descriptors2,
+                                 &data.two_view_geometry);
+      ProfileCounter("guided_matched_pairs", 1);
+
+      CHECK(output_queue_->Push(std::move(data)));
     }
   }
 }
@@ -495,53 +1234,65 @@ void GuidedSiftGPUFeatureMatcher::Run() {
 
   SignalValidSetup();
 
+  size_t num_evictions = 0;
+
   while (true) {
     if (IsStopped()) {
       break;
     }
 
-    const auto input_job = input_queue_->Pop();
+    auto input_job = input_queue_->Pop();
     if (input_job.IsValid()) {
-      auto data = input_job.Data();
+      auto data = std::move(input_job.Data());
 
       if (data.two_view_geometry.inlier_matches.size() <
           static_cast<size_t>(options_.min_num_inliers)) {
-        CHECK(output_queue_->Push(data));
+        CHECK(output_queue_->Push(std::move(data)));
         continue;
       }
 
-      const FeatureDescriptors* descriptors1_ptr;
+      GpuScheduler::Lease gpu_lease =
+          GpuScheduler::Get().Acquire(options_.gpu_index);
+
+      EvictCachedDescriptorsGPU(cache_, &num_evictions, &sift_match_gpu);
+
       const FeatureKeypoints* keypoints1_ptr;
-      GetFeatureData(0, data.image_id1, &keypoints1_ptr, &descriptors1_ptr);
-      const FeatureDescriptors* descriptors2_ptr;
+      SetFeatureData(0, data.image_id1, &sift_match_gpu, &keypoints1_ptr);
       const FeatureKeypoints* keypoints2_ptr;
-      GetFeatureData(1, data.image_id2, &keypoints2_ptr, &descriptors2_ptr);
+      SetFeatureData(1, data.image_id2, &sift_match_gpu, &keypoints2_ptr);
 
       MatchGuidedSiftFeaturesGPU(options_, keypoints1_ptr, keypoints2_ptr,
-                                 descriptors1_ptr, descriptors2_ptr,
-                                 &sift_match_gpu, &data.two_view_geometry);
+                                 nullptr, nullptr, &sift_match_gpu,
+                                 &data.two_view_geometry);
+      ProfileCounter("guided_matched_pairs", 1);
 
-      CHECK(output_queue_->Push(data));
+      CHECK(output_queue_->Push(std::move(data)));
     }
   }
 }
 
-void GuidedSiftGPUFeatureMatcher::GetFeatureData(
-    const int index, const image_t image_id,
-    const FeatureKeypoints** keypoints_ptr,
-    const FeatureDescriptors** descriptors_ptr) {
+void GuidedSiftGPUFeatureMatcher::SetFeatureData(
+    const int index, const image_t image_id, SiftMatchGPU* sift_match_gpu,
+    const FeatureKeypoints** keypoints_ptr) {
   CHECK_GE(index, 0);
   CHECK_LE(index, 1);
   if (prev_uploaded_image_ids_[index] == image_id) {
     *keypoints_ptr = nullptr;
-    *descriptors_ptr = nullptr;
-  } else {
-    prev_uploaded_keypoints_[index] = cache_->GetKeypoints(image_id);
+    return;
+  }
+
+  prev_uploaded_keypoints_[index] = cache_->GetKeypoints(image_id);
+  if (!SetCachedSiftDescriptorsGPU(index, image_id, sift_match_gpu)) {
     prev_uploaded_descriptors_[index] = cache_->GetDescriptors(image_id);
-    *keypoints_ptr = &prev_uploaded_keypoints_[index];
-    *descriptors_ptr = &prev_uploaded_descriptors_[index];
-    prev_uploaded_image_ids_[index] = image_id;
+    CHECK_EQ(prev_uploaded_descriptors_[index]->rows(),
+             prev_uploaded_keypoints_[index]->size());
+    UploadSiftDescriptorsGPU(index, image_id,
+                             *prev_uploaded_descriptors_[index],
+                             sift_match_gpu);
   }
+
+  *keypoints_ptr = prev_uploaded_keypoints_[index].get();
+  prev_uploaded_image_ids_[index] = image_id;
 }
 
 TwoViewGeometryVerifier::TwoViewGeometryVerifier(
@@ -563,6 +1314,16 @@ TwoViewGeometryVerifier::TwoViewGeometryVerifier(
       static_cast<size_t>(options_.max_num_trials);
   two_view_geometry_options_.ransac_options.min_inlier_ratio =
       options_.min_inlier_ratio;
+  two_view_geometry_options_.ransac_options.use_sprt = options_.use_sprt;
+  two_view_geometry_options_.use_prosac = options_.use_prosac;
+  two_view_geometry_options_.use_gpu = options_.use_gpu_verification;
+  two_view_geometry_options_.use_sturm_five_point =
+      options_.use_sturm_five_point;
+  two_view_geometry_options_.fast_path = options_.fast_verification;
+  two_view_geometry_options_.fast_path_min_inlier_ratio =
+      options_.fast_verification_min_inlier_ratio;
+  two_view_geometry_options_.fast_path_max_num_trials =
+      static_cast<size_t>(options_.fast_verification_max_num_trials);
 }
 
 void TwoViewGeometryVerifier::Run() {
@@ -571,23 +1332,27 @@ void TwoViewGeometryVerifier::Run() {
       break;
     }
 
-    const auto input_job = input_queue_->Pop();
+    auto input_job = input_queue_->Pop();
     if (input_job.IsValid()) {
-      auto data = input_job.Data();
+      auto data = std::move(input_job.Data());
 
       if (data.matches.size() < static_cast<size_t>(options_.min_num_inliers)) {
-        CHECK(output_queue_->Push(data));
+        CHECK(output_queue_->Push(std::move(data)));
         continue;
       }
 
+      // Independent of which verifier processes the image pair.
+      ScopedPRNGStream prng_stream(
+          Database::ImagePairToPairId(data.image_id1, data.image_id2));
+
       const auto& camera1 =
           cache_->GetCamera(cache_->GetImage(data.image_id1).CameraId());
       const auto& camera2 =
           cache_->GetCamera(cache_->GetImage(data.image_id2).CameraId());
       const auto keypoints1 = cache_->GetKeypoints(data.image_id1);
       const auto keypoints2 = cache_->GetKeypoints(data.image_id2);
-      const auto points1 = FeatureKeypointsToPointsVector(keypoints1);
-      const auto points2 = FeatureKeypointsToPointsVector(keypoints2);
+      const auto points1 = FeatureKeypointsToPointsVector(*keypoints1);
+      const auto points2 = FeatureKeypointsToPointsVector(*keypoints2);
 
       if (options_.multiple_models) {
         data.two_view_geometry.EstimateMultiple(camera1, points1, camera2,
@@ -598,40 +1363,138 @@ void TwoViewGeometryVerifier::Run() {
                                         data.matches,
                                         two_view_geometry_options_);
       }
+      ProfileCounter("verified_pairs", 1);
 
-      CHECK(output_queue_->Push(data));
+      CHECK(output_queue_->Push(std::move(data)));
     }
   }
 }
 
+FeatureMatcherWriter::FeatureMatcherWriter(
+    const SiftMatchingOptions& options, FeatureMatcherCache* cache,
+    JobQueue<Input>* input_queue,
+    const std::function<void(const std::vector<Input>&)>& written_callback)
+    : options_(options),
+      cache_(cache),
+      input_queue_(input_queue),
+      written_callback_(written_callback),
+      next_sequence_id_(0) {
+  CHECK(options_.Check());
+  CHECK(written_callback_);
+  batch_.reserve(kMaxBatchSize);
+}
+
+void FeatureMatcherWriter::Run() {
+  while (true) {
+    if (IsStopped()) {
+      break;
+    }
+
+    // Flush the current batch, if no further results are immediately
+    // available, so that waiting callers are not blocked any longer.
+    if (!batch_.empty() && input_queue_->Size() == 0) {
+      WriteBatch();
+    }
+
+    // Pop all immediately available results at once to reduce contention
+    // with the verifier threads pushing into the queue.
+    auto input_data = input_queue_->PopBatch(kMaxBatchSize - batch_.size());
+    for (auto& data : input_data) {
+      if (data.matches.size() < static_cast<size_t>(options_.min_num_inliers)) {
+        data.matches = {};
+      }
+
+      if (data.two_view_geometry.inlier_matches.size() <
+          static_cast<size_t>(options_.min_num_inliers)) {
+        data.two_view_geometry = TwoViewGeometry();
+      }
+
+      if (kDeterministic) {
+        const size_t sequence_id = data.sequence_id;
+        reorder_buffer_.emplace(sequence_id, std::move(data));
+      } else {
+        batch_.push_back(std::move(data));
+      }
+    }
+
+    // Move the results that are next in the order of submission to the batch.
+    while (!reorder_buffer_.empty() &&
+           reorder_buffer_.begin()->first == next_sequence_id_) {
+      batch_.push_back(std::move(reorder_buffer_.begin()->second));
+      reorder_buffer_.erase(reorder_buffer_.begin());
+      next_sequence_id_ += 1;
+    }
+
+    if (batch_.size() >= kMaxBatchSize) {
+      WriteBatch();
+    }
+  }
+
+  // Write the results that are still missing their predecessors, if the
+  // pipeline was stopped before all submitted results arrived.
+  for (auto& data : reorder_buffer_) {
+    batch_.push_back(std::move(data.second));
+  }
+  reorder_buffer_.clear();
+
+  WriteBatch();
+}
+
+void FeatureMatcherWriter::WriteBatch() {
+  if (batch_.empty()) {
+    return;
+  }
+
+  ProfileScope profile_scope("FeatureMatcherWriter::WriteBatch");
+  ProfileCounter("written_pairs", batch_.size());
+  cache_->WriteMatchesAndTwoViewGeometries(batch_);
+  written_callback_(batch_);
+  batch_.clear();
+}
+
 SiftFeatureMatcher::SiftFeatureMatcher(const SiftMatchingOptions& options,
                                        Database* database,
                                        FeatureMatcherCache* cache)
-    : options_(options), database_(database), cache_(cache), is_setup_(false) {
+    : options_(options),
+      database_(database),
+      cache_(cache),
+      is_setup_(false),
+      next_batch_id_(0),
+      next_sequence_id_(0) {
   CHECK(options_.Check());
 
+  if (options_.compress_matches) {
+    database_->SetMatchesFormat(Database::MatchesFormat::VARINT_ZLIB);
+  }
+
+  metrics_gauges_.Add("job_queue_size{queue=\"matcher\"}",
+                      [this]() { return matcher_queue_.Size(); });
+  metrics_gauges_.Add("job_queue_size{queue=\"verifier\"}",
+                      [this]() { return verifier_queue_.Size(); });
+  metrics_gauges_.Add("job_queue_size{queue=\"guided_matcher\"}",
+                      [this]() { return guided_matcher_queue_.Size(); });
+  metrics_gauges_.Add("job_queue_size{queue=\"matcher_output\"}",
+                      [this]() { return output_queue_.Size(); });
+
   const int num_threads = GetEffectiveNumThreads(options_.num_threads);
   CHECK_GT(num_threads, 0);
 
-  std::vector<int> gpu_indices = CSVToVector<int>(options_.gpu_index);
-  CHECK_GT(gpu_indices.size(), 0);
-
-#ifdef CUDA_ENABLED
-  if (options_.use_gpu && gpu_indices.size() == 1 && gpu_indices[0] == -1) {
-    const int num_cuda_devices = GetNumCudaDevices();
-    CHECK_GT(num_cuda_devices, 0);
-    gpu_indices.resize(num_cuda_devices);
-    std::iota(gpu_indices.begin(), gpu_indices.end(), 0);
-  }
-#endif  // CUDA_ENABLED
+  const std::vector<int> gpu_indices =
+      options_.use_gpu ? GpuScheduler::Get().GetGpuIndices(options_.gpu_index)
+                       : std::vector<int>();
 
   if (options_.use_gpu) {
     auto gpu_options = options_;
     matchers_.reserve(gpu_indices.size());
     for (const auto& gpu_index : gpu_indices) {
       gpu_options.gpu_index = std::to_string(gpu_index);
-      matchers_.emplace_back(new SiftGPUFeatureMatcher(
-          gpu_options, cache, &matcher_queue_, &verifier_queue_));
+      if (options_.use_tensor_core_matching) {
+        matchers_.emplace_back(new SiftCUDAFeatureMatcher(
+            gpu_options, cache, &matcher_queue_, &verifier_queue_));
+      } else {
+        matchers_.emplace_back(new SiftGPUFeatureMatcher(
+            gpu_options, cache, &matcher_queue_, &verifier_queue_));
+      }
     }
   } else {
     matchers_.reserve(num_threads);
@@ -669,6 +1532,29 @@ SiftFeatureMatcher::SiftFeatureMatcher(const SiftMatchingOptions& options,
           options_, cache, &verifier_queue_, &output_queue_));
     }
   }
+
+  // The matchers and verifiers with the same index share a NUMA node. The GPU
+  // matchers are left to the operating system.
+  if (options_.numa_aware) {
+    for (size_t i = 0; i < verifiers_.size(); ++i) {
+      const int numa_node = GetNumaNodeOfThread(i, verifiers_.size());
+      verifiers_[i]->SetNumaNode(numa_node);
+      if (!options_.use_gpu) {
+        matchers_[i]->SetNumaNode(numa_node);
+        if (options_.guided_matching) {
+          guided_matchers_[i]->SetNumaNode(numa_node);
+        }
+      }
+    }
+  }
+
+  writer_.reset(new FeatureMatcherWriter(
+      options_, cache, &output_queue_,
+      [this](const std::vector<internal::FeatureMatcherData>& outputs) {
+        HandleWrittenOutputs(outputs);
+      }));
+
+  thread_pool_.reset(new ThreadPool(1));
 }
 
 SiftFeatureMatcher::~SiftFeatureMatcher() {
@@ -689,6 +1575,8 @@ SiftFeatureMatcher::~SiftFeatureMatcher() {
     guided_matcher->Stop();
   }
 
+  writer_->Stop();
+
   matcher_queue_.Stop();
   verifier_queue_.Stop();
   guided_matcher_queue_.Stop();
@@ -705,6 +1593,8 @@ SiftFeatureMatcher::~SiftFeatureMatcher() {
   for (auto& guided_matcher : guided_matchers_) {
     guided_matcher->Wait();
   }
+
+  writer_->Wait();
 }
 
 bool SiftFeatureMatcher::Setup() {
@@ -726,6 +1616,8 @@ bool SiftFeatureMatcher::Setup() {
     guided_matcher->Start();
   }
 
+  writer_->Start();
+
   for (auto& matcher : matchers_) {
     if (!matcher->CheckValidSetup()) {
       return false;
@@ -745,94 +1637,325 @@ bool SiftFeatureMatcher::Setup() {
 
 void SiftFeatureMatcher::Match(
     const std::vector<std::pair<image_t, image_t>>& image_pairs) {
+  ProfileScope profile_scope("SiftFeatureMatcher::Match");
+  MatchAsync(image_pairs);
+  Wait();
+  CHECK_EQ(output_queue_.Size(), 0);
+}
+
+void SiftFeatureMatcher::MatchAsync(
+    const std::vector<std::pair<image_t, image_t>>& image_pairs,
+    const std::function<void()>& callback) {
   CHECK_NOTNULL(database_);
   CHECK_NOTNULL(cache_);
   CHECK(is_setup_);
 
-  if (image_pairs.empty()) {
+  //////////////////////////////////////////////////////////////////////////////
+  // Collect the image pairs to be matched
+  //////////////////////////////////////////////////////////////////////////////
+
+  // Group the image pairs by their first image, such that the descriptors of
+  // the first image remain uploaded to the GPU for consecutive image pairs.
+  std::vector<std::pair<image_t, image_t>> ordered_image_pairs = image_pairs;
+  if (options_.use_gpu) {
+    std::stable_sort(ordered_image_pairs.begin(), ordered_image_pairs.end(),
+                     [](const std::pair<image_t, image_t>& image_pair1,
+                        const std::pair<image_t, image_t>& image_pair2) {
+                       return image_pair1.first < image_pair2.first;
+                     });
+  }
+
+  const size_t batch_id = next_batch_id_++;
+
+  std::vector<internal::FeatureMatcherData> matcher_data;
+  std::vector<internal::FeatureMatcherData> verifier_data;
+
+  for (const auto image_pair : ordered_image_pairs) {
+    // Avoid self-matches.
+    if (image_pair.first == image_pair.second) {
+      continue;
+    }
+
+    // Avoid duplicate image pairs, also with respect to previously submitted
+    // batches whose results are not yet written to the database.
+    const image_pair_t pair_id =
+        Database::ImagePairToPairId(image_pair.first, image_pair.second);
+    {
+      std::unique_lock<std::mutex> lock(pending_mutex_);
+      if (pending_image_pair_ids_.count(pair_id) > 0) {
+        continue;
+      }
+    }
+
+    const bool exists_matches =
+        cache_->ExistsMatches(image_pair.first, image_pair.second);
+    const bool exists_inlier_matches =
+        cache_->ExistsInlierMatches(image_pair.first, image_pair.second);
+
+    if (exists_matches && exists_inlier_matches) {
+      continue;
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(pending_mutex_);
+      pending_image_pair_ids_.insert(pair_id);
+    }
+
+    // If only one of the matches or inlier matches exist, we recompute them
+    // from scratch and delete the existing results. This must be done before
+    // pushing the jobs to the queue, otherwise database constraints might fail
+    // when writing an existing result into the database.
+
+    if (exists_inlier_matches) {
+      cache_->DeleteInlierMatches(image_pair.first, image_pair.second);
+    }
+
+    internal::FeatureMatcherData data;
+    data.batch_id = batch_id;
+    data.sequence_id = next_sequence_id_++;
+    data.image_id1 = image_pair.first;
+    data.image_id2 = image_pair.second;
+
+    if (exists_matches) {
+      data.matches = cache_->GetMatches(image_pair.first, image_pair.second);
+      cache_->DeleteMatches(image_pair.first, image_pair.second);
+      verifier_data.push_back(std::move(data));
+    } else {
+      matcher_data.push_back(std::move(data));
+    }
+  }
+
+  const size_t num_outputs = matcher_data.size() + verifier_data.size();
+  if (num_outputs == 0) {
+    if (callback) {
+      callback();
+    }
     return;
   }
 
+  // The batch must be registered before its first job is pushed, since its
+  // results might be written before the remaining jobs are pushed.
+  {
+    std::unique_lock<std::mutex> lock(pending_mutex_);
+    PendingBatch& pending_batch = pending_batches_[batch_id];
+    pending_batch.num_outputs = num_outputs;
+    pending_batch.callback = callback;
+  }
+
   //////////////////////////////////////////////////////////////////////////////
   // Match the image pairs
   //////////////////////////////////////////////////////////////////////////////
 
-  std::unordered_set<image_pair_t> image_pair_ids;
-  image_pair_ids.reserve(image_pairs.size());
+  for (auto& data : verifier_data) {
+    CHECK(verifier_queue_.Push(std::move(data)));
+  }
 
-  size_t num_outputs = 0;
-  for (const auto image_pair : image_pairs) {
-    // Avoid self-matches.
-    if (image_pair.first == image_pair.second) {
-      continue;
+  for (auto& data : matcher_data) {
+    CHECK(matcher_queue_.Push(std::move(data)));
+  }
+}
+
+void SiftFeatureMatcher::Wait(const size_t max_num_pending_batches) {
+  std::unique_lock<std::mutex> lock(pending_mutex_);
+  pending_condition_.wait(lock, [this, max_num_pending_batches]() {
+    return pending_batches_.size() <= max_num_pending_batches;
+  });
+}
+
+void SiftFeatureMatcher::HandleWrittenOutputs(
+    const std::vector<internal::FeatureMatcherData>& outputs) {
+  std::vector<size_t> finished_batch_ids;
+  std::vector<std::function<void()>> callbacks;
+
+  {
+    std::unique_lock<std::mutex> lock(pending_mutex_);
+    for (const auto& output : outputs) {
+      pending_image_pair_ids_.erase(
+          Database::ImagePairToPairId(output.image_id1, output.image_id2));
+      auto& pending_batch = pending_batches_.at(output.batch_id);
+      CHECK_GT(pending_batch.num_outputs, 0);
+      pending_batch.num_outputs -= 1;
+      if (pending_batch.num_outputs == 0) {
+        finished_batch_ids.push_back(output.batch_id);
+        if (pending_batch.callback) {
+          callbacks.push_back(pending_batch.callback);
+        }
+      }
+    }
+  }
+
+  // Invoke the callbacks without holding the lock, such that they can submit
+  // new batches. The batches are only marked as finished afterwards, so that
+  // waiting for a batch also waits for its callback.
+  for (const auto& callback : callbacks) {
+    callback();
+  }
+
+  if (finished_batch_ids.empty()) {
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(pending_mutex_);
+    for (const auto batch_id : finished_batch_ids) {
+      pending_batches_.erase(batch_id);
+    }
+  }
+
+  pending_condition_.notify_all();
+}
+
+void SiftFeatureMatcher::Prefetch(
+    const std::vector<std::pair<image_t, image_t>>& image_pairs) {
+  CHECK_NOTNULL(cache_);
+
+  // Only keep one batch in flight to bound the amount of data that is loaded
+  // into the cache ahead of the matching.
+  if (prefetch_future_.valid()) {
+    prefetch_future_.get();
+  }
+
+  std::vector<image_t> image_ids;
+  image_ids.reserve(2 * image_pairs.size());
+  std::unordered_set<image_t> unique_image_ids;
+  unique_image_ids.reserve(2 * image_pairs.size());
+  for (const auto& image_pair : image_pairs) {
+    if (unique_image_ids.insert(image_pair.first).second) {
+      image_ids.push_back(image_pair.first);
     }
+    if (unique_image_ids.insert(image_pair.second).second) {
+      image_ids.push_back(image_pair.second);
+    }
+  }
+
+  prefetch_future_ = thread_pool_->AddTask([this, image_ids]() {
+    for (const auto image_id : image_ids) {
+      cache_->GetKeypoints(image_id);
+      cache_->GetDescriptors(image_id);
+    }
+  });
+}
+
+ImagePairPreFilter::ImagePairPreFilter(const std::string& vocab_tree_path,
+                                       const double min_score,
+                                       const int min_num_features,
+                                       const int num_threads,
+                                       FeatureMatcherCache* cache)
+    : vocab_tree_path_(vocab_tree_path),
+      min_score_(min_score),
+      min_num_features_(min_num_features),
+      num_threads_(num_threads),
+      cache_(cache) {
+  CHECK_GE(min_score_, 0);
+  CHECK_NOTNULL(cache_);
+}
+
+bool ImagePairPreFilter::Setup(const std::vector<image_t>& image_ids,
+                               Thread* thread) {
+  const int kNumChecks = 256;
+
+  retrieval::VisualIndex<> visual_index;
+  visual_index.Read(vocab_tree_path_);
 
-    // Avoid duplicate image pairs.
-    const image_pair_t pair_id =
-        Database::ImagePairToPairId(image_pair.first, image_pair.second);
-    if (image_pair_ids.count(pair_id) > 0) {
-      continue;
-    }
+  IndexImagesInVisualIndex(num_threads_, kNumChecks, -1, image_ids, thread,
+                           cache_, &visual_index);
 
-    image_pair_ids.insert(pair_id);
+  if (thread->IsStopped()) {
+    return false;
+  }
 
-    const bool exists_matches =
-        cache_->ExistsMatches(image_pair.first, image_pair.second);
-    const bool exists_inlier_matches =
-        cache_->ExistsInlierMatches(image_pair.first, image_pair.second);
+  Timer timer;
+  timer.Start();
 
-    if (exists_matches && exists_inlier_matches) {
-      continue;
-    }
+  std::cout << "Pre-filtering image pairs" << std::flush;
 
-    num_outputs += 1;
+  retrieval::VisualIndex<>::QueryOptions query_options;
+  query_options.max_num_images = -1;
+  query_options.num_checks = kNumChecks;
+  query_options.num_threads = 1;
 
-    // If only one of the matches or inlier matches exist, we recompute them
-    // from scratch and delete the existing results. This must be done before
-    // pushing the jobs to the queue, otherwise database constraints might fail
-    // when writing an existing result into the database.
+  struct QueryResult {
+    size_t num_features = 0;
+    std::vector<image_t> similar_image_ids;
+  };
 
-    if (exists_inlier_matches) {
-      cache_->DeleteInlierMatches(image_pair.first, image_pair.second);
+  // Only the similar images are kept for each query image, since the full
+  // retrieval scores are quadratic in the number of images.
+  auto QueryFunc = [&](const image_t image_id) {
+    QueryResult result;
+    if (thread->IsStopped()) {
+      return result;
     }
 
-    internal::FeatureMatcherData data;
-    data.image_id1 = image_pair.first;
-    data.image_id2 = image_pair.second;
+    const auto descriptors = cache_->GetDescriptors(image_id);
+    result.num_features = static_cast<size_t>(descriptors->rows());
 
-    if (exists_matches) {
-      data.matches = cache_->GetMatches(image_pair.first, image_pair.second);
-      cache_->DeleteMatches(image_pair.first, image_pair.second);
-      CHECK(verifier_queue_.Push(data));
-    } else {
-      CHECK(matcher_queue_.Push(data));
+    std::vector<retrieval::ImageScore> image_scores;
+    visual_index.Query(query_options, *descriptors, &image_scores);
+    for (const auto& image_score : image_scores) {
+      if (image_score.score >= min_score_ &&
+          static_cast<image_t>(image_score.image_id) != image_id) {
+        result.similar_image_ids.push_back(image_score.image_id);
+      }
     }
+
+    return result;
+  };
+
+  ThreadPool thread_pool(num_threads_);
+  std::vector<std::future<QueryResult>> futures;
+  futures.reserve(image_ids.size());
+  for (const auto image_id : image_ids) {
+    futures.push_back(thread_pool.AddTask(QueryFunc, image_id));
   }
 
-  //////////////////////////////////////////////////////////////////////////////
-  // Write results to database
-  //////////////////////////////////////////////////////////////////////////////
+  size_t num_similar_pairs = 0;
+  for (size_t i = 0; i < image_ids.size(); ++i) {
+    const QueryResult result = futures[i].get();
+    num_similar_pairs += result.similar_image_ids.size();
+    num_features_.emplace(image_ids[i], result.num_features);
+    similar_image_ids_.emplace(
+        image_ids[i],
+        std::unordered_set<image_t>(result.similar_image_ids.begin(),
+                                    result.similar_image_ids.end()));
+  }
 
-  for (size_t i = 0; i < num_outputs; ++i) {
-    const auto output_job = output_queue_.Pop();
-    CHECK(output_job.IsValid());
-    auto output = output_job.Data();
+  if (thread->IsStopped()) {
+    return false;
+  }
 
-    if (output.matches.size() < static_cast<size_t>(options_.min_num_inliers)) {
-      output.matches = {};
-    }
+  std::cout << StringPrintf(" with %d retrieved image pairs", num_similar_pairs);
+  PrintElapsedTime(timer);
 
-    if (output.two_view_geometry.inlier_matches.size() <
-        static_cast<size_t>(options_.min_num_inliers)) {
-      output.two_view_geometry = TwoViewGeometry();
-    }
+  return true;
+}
 
-    cache_->WriteMatches(output.image_id1, output.image_id2, output.matches);
-    cache_->WriteTwoViewGeometry(output.image_id1, output.image_id2,
-                                 output.two_view_geometry);
+bool ImagePairPreFilter::IsAccepted(const image_t image_id1,
+                                    const image_t image_id2) const {
+  const auto num_features1 = num_features_.find(image_id1);
+  const auto num_features2 = num_features_.find(image_id2);
+  if (num_features1 == num_features_.end() ||
+      num_features2 == num_features_.end()) {
+    return true;
   }
 
-  CHECK_EQ(output_queue_.Size(), 0);
+  if (num_features1->second < static_cast<size_t>(min_num_features_) ||
+      num_features2->second < static_cast<size_t>(min_num_features_)) {
+    return false;
+  }
+
+  return similar_image_ids_.at(image_id1).count(image_id2) > 0 ||
+         similar_image_ids_.at(image_id2).count(image_id1) > 0;
+}
+
+void ImagePairPreFilter::Filter(
+    std::vector<std::pair<image_t, image_t>>* image_pairs) const {
+  image_pairs->erase(
+      std::remove_if(image_pairs->begin(), image_pairs->end(),
+                     [this](const std::pair<image_t, image_t>& image_pair) {
+                       return !IsAccepted(image_pair.first, image_pair.second);
+                     }),
+      image_pairs->end());
 }
 
 ExhaustiveFeatureMatcher::ExhaustiveFeatureMatcher(
@@ -841,7 +1964,7 @@ ExhaustiveFeatureMatcher::ExhaustiveFeatureMatcher(
     : options_(options),
       match_options_(match_options),
       database_(database_path),
-      cache_(5 * options_.block_size, &database_),
+      cache_(kNumExhaustiveCachedBlocks * options_.block_size, &database_),
       matcher_(match_options, &database_, &cache_) {
   CHECK(options_.Check());
   CHECK(match_options_.Check());
@@ -858,56 +1981,96 @@ void ExhaustiveFeatureMatcher::Run() {
 
   const std::vector<image_t> image_ids = cache_.GetImageIds();
 
+  if (!options_.pre_filter_vocab_tree_path.empty()) {
+    pre_filter_.reset(new ImagePairPreFilter(
+        options_.pre_filter_vocab_tree_path, options_.pre_filter_min_score,
+        match_options_.min_num_inliers, match_options_.num_threads, &cache_));
+    if (!pre_filter_->Setup(image_ids, this)) {
+      GetTimer().PrintMinutes();
+      return;
+    }
+  }
+
   const size_t block_size = static_cast<size_t>(options_.block_size);
   const size_t num_blocks = static_cast<size_t>(
       std::ceil(static_cast<double>(image_ids.size()) / block_size));
   const size_t num_pairs_per_block = block_size * (block_size - 1) / 2;
 
+  auto CollectBlockImagePairs =
+      [&](const size_t start_idx1, const size_t start_idx2,
+          std::vector<std::pair<image_t, image_t>>* image_pairs) {
+        const size_t end_idx1 =
+            std::min(image_ids.size(), start_idx1 + block_size) - 1;
+        const size_t end_idx2 =
+            std::min(image_ids.size(), start_idx2 + block_size) - 1;
+        image_pairs->clear();
+        for (size_t idx1 = start_idx1; idx1 <= end_idx1; ++idx1) {
+          for (size_t idx2 = start_idx2; idx2 <= end_idx2; ++idx2) {
+            const size_t block_id1 = idx1 % block_size;
+            const size_t block_id2 = idx2 % block_size;
+            if ((idx1 > idx2 && block_id1 <= block_id2) ||
+                (idx1 < idx2 &&
+                 block_id1 < block_id2)) {  // Avoid duplicate pairs
+              image_pairs->emplace_back(image_ids[idx1], image_ids[idx2]);
+            }
+          }
+        }
+        if (pre_filter_) {
+          pre_filter_->Filter(image_pairs);
+        }
+      };
+
   std::vector<std::pair<image_t, image_t>> image_pairs;
   image_pairs.reserve(num_pairs_per_block);
+  std::vector<std::pair<image_t, image_t>> next_image_pairs;
+  next_image_pairs.reserve(num_pairs_per_block);
 
-  for (size_t start_idx1 = 0; start_idx1 < image_ids.size();
-       start_idx1 += block_size) {
-    const size_t end_idx1 =
-        std::min(image_ids.size(), start_idx1 + block_size) - 1;
-    for (size_t start_idx2 = 0; start_idx2 < image_ids.size();
-         start_idx2 += block_size) {
-      const size_t end_idx2 =
-          std::min(image_ids.size(), start_idx2 + block_size) - 1;
-
-      if (IsStopped()) {
-        GetTimer().PrintMinutes();
-        return;
-      }
-
-      Timer timer;
-      timer.Start();
+  const std::vector<std::pair<size_t, size_t>> block_schedule =
+      GetExhaustiveBlockSchedule(num_blocks, kNumExhaustiveCachedBlocks);
 
-      std::cout << StringPrintf("Matching block [%d/%d, %d/%d]",
-                                start_idx1 / block_size + 1, num_blocks,
-                                start_idx2 / block_size + 1, num_blocks)
-                << std::flush;
+  if (!block_schedule.empty()) {
+    CollectBlockImagePairs(0, 0, &next_image_pairs);
+  }
 
-      image_pairs.clear();
-      for (size_t idx1 = start_idx1; idx1 <= end_idx1; ++idx1) {
-        for (size_t idx2 = start_idx2; idx2 <= end_idx2; ++idx2) {
-          const size_t block_id1 = idx1 % block_size;
-          const size_t block_id2 = idx2 % block_size;
-          if ((idx1 > idx2 && block_id1 <= block_id2) ||
-              (idx1 < idx2 &&
-               block_id1 < block_id2)) {  // Avoid duplicate pairs
-            image_pairs.emplace_back(image_ids[idx1], image_ids[idx2]);
-          }
-        }
-      }
+  for (size_t i = 0; i < block_schedule.size(); ++i) {
+    if (IsStopped()) {
+      GetTimer().PrintMinutes();
+      return;
+    }
 
-      DatabaseTransaction database_transaction(&database_);
-      matcher_.Match(image_pairs);
+    Timer timer;
+    timer.Start();
 
-      PrintElapsedTime(timer);
+    const size_t block_idx1 = block_schedule[i].first;
+    const size_t block_idx2 = block_schedule[i].second;
+
+    // Submit the block without waiting for its results, such that the
+    // matching pipeline does not run empty at the block boundaries.
+    std::swap(image_pairs, next_image_pairs);
+    const std::string block_name = StringPrintf(
+        "Matching block [%d/%d, %d/%d] (%d/%d)", block_idx1 + 1, num_blocks,
+        block_idx2 + 1, num_blocks, i + 1, block_schedule.size());
+    const bool last_block = i + 1 == block_schedule.size();
+    matcher_.MatchAsync(image_pairs, [block_name, timer, last_block]() {
+      PrintMatchingProgress(block_name, timer, last_block);
+    });
+
+    // Load the features of the next block in the background, while the
+    // current block is being matched.
+    if (i + 1 < block_schedule.size()) {
+      CollectBlockImagePairs(block_schedule[i + 1].first * block_size,
+                             block_schedule[i + 1].second * block_size,
+                             &next_image_pairs);
+      matcher_.Prefetch(next_image_pairs);
     }
+
+    // Only keep the current and the previous block in flight, since the
+    // cache only holds the features of a few blocks.
+    matcher_.Wait(1);
   }
 
+  matcher_.Wait();
+
   GetTimer().PrintMinutes();
 }
 
@@ -918,7 +2081,8 @@ SequentialFeatureMatcher::SequentialFeatureMatcher(
       match_options_(match_options),
       database_(database_path),
       cache_(std::max(5 * options_.loop_detection_num_images,
-                      5 * options_.overlap),
+                      5 * options_.overlap +
+                          static_cast<int>(kNumSequentialPrefetchImages)),
              &database_),
       matcher_(match_options, &database_, &cache_) {
   CHECK(options_.Check());
@@ -937,9 +2101,6 @@ void SequentialFeatureMatcher::Run() {
   const std::vector<image_t> ordered_image_ids = GetOrderedImageIds();
 
   RunSequentialMatching(ordered_image_ids);
-  if (options_.loop_detection) {
-    RunLoopDetection(ordered_image_ids);
-  }
 
   GetTimer().PrintMinutes();
 }
@@ -969,9 +2130,38 @@ std::vector<image_t> SequentialFeatureMatcher::GetOrderedImageIds() const {
 
 void SequentialFeatureMatcher::RunSequentialMatching(
     const std::vector<image_t>& image_ids) {
+  // The images are added to the loop detection index as the sequence is
+  // matched, and the loop detection queries run interleaved with the
+  // asynchronous sequential matching instead of in a separate phase after it.
+  std::unique_ptr<retrieval::VisualIndex<>> visual_index;
+  std::unordered_map<image_t, size_t> image_idxs;
+  std::vector<image_t> loop_image_ids;
+  size_t num_prepared_images = 0;
+
+  retrieval::VisualIndex<>::IndexOptions index_options;
+  index_options.num_threads = match_options_.num_threads;
+  index_options.num_checks = options_.loop_detection_num_checks;
+
+  uint64_t vocab_hash = 0;
+  if (options_.loop_detection) {
+    visual_index.reset(new retrieval::VisualIndex<>());
+    visual_index->Read(options_.vocab_tree_path);
+    vocab_hash = visual_index->VocabularyHash();
+    image_idxs.reserve(image_ids.size());
+    for (size_t image_idx = 0; image_idx < image_ids.size(); ++image_idx) {
+      image_idxs.emplace(image_ids[image_idx], image_idx);
+    }
+  }
+
   std::vector<std::pair<image_t, image_t>> image_pairs;
   image_pairs.reserve(options_.overlap);
 
+  // The features of the images in the window of the current image and of the
+  // next images are prefetched, while the previous images are matched. An
+  // image is last matched as the first image of its own batch, so its features
+  // are evicted once its batch can no longer be in flight.
+  size_t num_prefetched_images = 0;
+
   for (size_t image_idx1 = 0; image_idx1 < image_ids.size(); ++image_idx1) {
     if (IsStopped()) {
       return;
@@ -979,12 +2169,23 @@ void SequentialFeatureMatcher::RunSequentialMatching(
 
     const auto image_id1 = image_ids.at(image_idx1);
 
+    const size_t prefetch_end_idx =
+        std::min(image_ids.size(), image_idx1 + options_.overlap +
+                                       kNumSequentialPrefetchImages);
+    for (; num_prefetched_images < prefetch_end_idx; ++num_prefetched_images) {
+      cache_.Prefetch(image_ids[num_prefetched_images]);
+    }
+
+    if (image_idx1 > kMaxNumPendingMatchBatches) {
+      cache_.Evict(image_ids[image_idx1 - kMaxNumPendingMatchBatches - 1]);
+    }
+
     Timer timer;
     timer.Start();
 
-    std::cout << StringPrintf("Matching image [%d/%d]", image_idx1 + 1,
-                              image_ids.size())
-              << std::flush;
+    const std::string image_name = StringPrintf(
+        "Matching image [%d/%d]", image_idx1 + 1, image_ids.size());
+    const bool last_image = image_idx1 + 1 == image_ids.size();
 
     image_pairs.clear();
     for (int i = 0; i < options_.overlap; ++i) {
@@ -1003,43 +2204,44 @@ void SequentialFeatureMatcher::RunSequentialMatching(
       }
     }
 
-    DatabaseTransaction database_transaction(&database_);
-    matcher_.Match(image_pairs);
+    matcher_.MatchAsync(image_pairs, [image_name, timer, last_image]() {
+      PrintMatchingProgress(image_name, timer, last_image);
+    });
 
-    PrintElapsedTime(timer);
-  }
-}
+    if (visual_index) {
+      AddImageToVisualIndex(index_options,
+                            options_.loop_detection_max_num_features,
+                            vocab_hash, image_id1, &cache_,
+                            visual_index.get());
 
-void SequentialFeatureMatcher::RunLoopDetection(
-    const std::vector<image_t>& image_ids) {
-  // Read the pre-trained vocabulary tree from disk.
-  retrieval::VisualIndex<> visual_index;
-  visual_index.Read(options_.vocab_tree_path);
+      // Only perform loop detection for every n-th image.
+      if (image_idx1 % options_.loop_detection_period == 0) {
+        loop_image_ids.push_back(image_id1);
+      }
 
-  // Index all images in the visual index.
-  IndexImagesInVisualIndex(match_options_.num_threads,
-                           options_.loop_detection_num_checks,
-                           options_.loop_detection_max_num_features, image_ids,
-                           this, &cache_, &visual_index);
+      const size_t num_new_images = image_idx1 + 1 - num_prepared_images;
+      if (num_new_images >=
+          std::max(kMinNumLoopDetectionBatchImages,
+                   static_cast<size_t>(kLoopDetectionBatchGrowth *
+                                       num_prepared_images))) {
+        RunSequentialLoopDetection(options_, match_options_, image_idxs,
+                                   loop_image_ids, this, &cache_,
+                                   visual_index.get(), &matcher_);
+        loop_image_ids.clear();
+        num_prepared_images = image_idx1 + 1;
+      }
+    }
 
-  if (IsStopped()) {
-    return;
+    matcher_.Wait(kMaxNumPendingMatchBatches);
   }
 
-  // Only perform loop detection for every n-th image.
-  std::vector<image_t> match_image_ids;
-  for (size_t i = 0; i < image_ids.size();
-       i += options_.loop_detection_period) {
-    match_image_ids.push_back(image_ids[i]);
+  if (visual_index && !loop_image_ids.empty()) {
+    RunSequentialLoopDetection(options_, match_options_, image_idxs,
+                               loop_image_ids, this, &cache_,
+                               visual_index.get(), &matcher_);
   }
 
-  MatchNearestNeighborsInVisualIndex(
-      match_options_.num_threads, options_.loop_detection_num_images,
-      options_.loop_detection_num_nearest_neighbors,
-      options_.loop_detection_num_checks,
-      options_.loop_detection_num_images_after_verification,
-      options_.loop_detection_max_num_features, match_image_ids, this, &cache_,
-      &visual_index, &matcher_);
+  matcher_.Wait();
 }
 
 VocabTreeFeatureMatcher::VocabTreeFeatureMatcher(
@@ -1067,6 +2269,13 @@ void VocabTreeFeatureMatcher::Run() {
   retrieval::VisualIndex<> visual_index;
   visual_index.Read(options_.vocab_tree_path);
 
+#ifdef CUDA_ENABLED
+  if (options_.use_gpu) {
+    visual_index.SetupGPU(
+        GpuScheduler::Get().GetGpuIndices(match_options_.gpu_index).at(0));
+  }
+#endif
+
   const std::vector<image_t> all_image_ids = cache_.GetImageIds();
   std::vector<image_t> image_ids;
   if (options_.match_list_path == "") {
@@ -1109,6 +2318,11 @@ void VocabTreeFeatureMatcher::Run() {
     return;
   }
 
+  // Optionally save the indexed images to speed up future indexing.
+  if (!options_.output_index_path.empty()) {
+    visual_index.Write(options_.output_index_path);
+  }
+
   // Match all images in the visual index.
   MatchNearestNeighborsInVisualIndex(
       match_options_.num_threads, options_.num_images,
@@ -1151,19 +2365,12 @@ void SpatialFeatureMatcher::Run() {
 
   std::cout << "Indexing images..." << std::flush;
 
-  GPSTransform gps_transform;
-
-  size_t num_locations = 0;
-  Eigen::Matrix<float, Eigen::Dynamic, 3, Eigen::RowMajor> location_matrix(
-      image_ids.size(), 3);
-
-  std::vector<size_t> location_idxs;
-  location_idxs.reserve(image_ids.size());
+  std::vector<image_t> location_image_ids;
+  std::vector<Eigen::Vector3d> locations;
+  location_image_ids.reserve(image_ids.size());
+  locations.reserve(image_ids.size());
 
-  std::vector<Eigen::Vector3d> ells(1);
-
-  for (size_t i = 0; i < image_ids.size(); ++i) {
-    const auto image_id = image_ids[i];
+  for (const auto image_id : image_ids) {
     const auto& image = cache_.GetImage(image_id);
 
     if ((image.TvecPrior(0) == 0 && image.TvecPrior(1) == 0 &&
@@ -1173,33 +2380,19 @@ void SpatialFeatureMatcher::Run() {
       continue;
     }
 
-    location_idxs.push_back(i);
-
-    if (options_.is_gps) {
-      ells[0](0) = image.TvecPrior(0);
-      ells[0](1) = image.TvecPrior(1);
-      ells[0](2) = options_.ignore_z ? 0 : image.TvecPrior(2);
-
-      const auto xyzs = gps_transform.EllToXYZ(ells);
-
-      location_matrix(num_locations, 0) = static_cast<float>(xyzs[0](0));
-      location_matrix(num_locations, 1) = static_cast<float>(xyzs[0](1));
-      location_matrix(num_locations, 2) = static_cast<float>(xyzs[0](2));
-    } else {
-      location_matrix(num_locations, 0) =
-          static_cast<float>(image.TvecPrior(0));
-      location_matrix(num_locations, 1) =
-          static_cast<float>(image.TvecPrior(1));
-      location_matrix(num_locations, 2) =
-          static_cast<float>(options_.ignore_z ? 0 : image.TvecPrior(2));
-    }
+    location_image_ids.push_back(image_id);
+    locations.emplace_back(image.TvecPrior(0), image.TvecPrior(1),
+                           options_.ignore_z ? 0 : image.TvecPrior(2));
+  }
 
-    num_locations += 1;
+  if (options_.is_gps) {
+    GPSTransform gps_transform;
+    locations = gps_transform.EllToXYZ(locations);
   }
 
   PrintElapsedTime(timer);
 
-  if (num_locations == 0) {
+  if (locations.empty()) {
     std::cout << " => No images with location data." << std::endl;
     GetTimer().PrintMinutes();
     return;
@@ -1213,13 +2406,35 @@ void SpatialFeatureMatcher::Run() {
 
   std::cout << "Building search index..." << std::flush;
 
-  flann::Matrix<float> locations(location_matrix.data(), num_locations,
-                                 location_matrix.cols());
+  // The voxels of the index have the size of the search radius, such that
+  // a search usually only visits the neighboring voxels.
+  SpatialIndex spatial_index(options_.max_distance);
+  if (!options_.index_path.empty() && ExistsFile(options_.index_path)) {
+    spatial_index.Read(options_.index_path);
+    if (spatial_index.VoxelSize() != options_.max_distance) {
+      std::cout << " => Rebuilding index with different voxel size"
+                << std::flush;
+      spatial_index = SpatialIndex(options_.max_distance);
+    }
+  }
+
+  // Only the images that are not yet indexed are matched against the index,
+  // since the other images were already matched when they were indexed.
+  std::vector<size_t> query_idxs;
+  query_idxs.reserve(locations.size());
+  for (size_t i = 0; i < locations.size(); ++i) {
+    if (!spatial_index.ExistsImage(location_image_ids[i])) {
+      spatial_index.Insert(location_image_ids[i], locations[i]);
+      query_idxs.push_back(i);
+    }
+  }
 
-  flann::LinearIndexParams index_params;
-  flann::LinearIndex<flann::L2<float>> search_index(index_params);
-  search_index.buildIndex(locations);
+  if (!options_.index_path.empty() && !query_idxs.empty()) {
+    spatial_index.Write(options_.index_path);
+  }
 
+  std::cout << StringPrintf(" %d new of %d", query_idxs.size(),
+                            spatial_index.NumLocations());
   PrintElapsedTime(timer);
 
   //////////////////////////////////////////////////////////////////////////////
@@ -1230,41 +2445,55 @@ void SpatialFeatureMatcher::Run() {
 
   std::cout << "Searching for nearest neighbors..." << std::flush;
 
-  const int knn = std::min<int>(options_.max_num_neighbors, num_locations);
+  // The query itself is always its own nearest neighbor.
+  const size_t max_num_neighbors =
+      static_cast<size_t>(options_.max_num_neighbors) + 1;
+
+  std::vector<std::vector<image_t>> neighbor_image_ids(query_idxs.size());
+
+  {
+    ThreadPool thread_pool(match_options_.num_threads);
+    const size_t num_workers = thread_pool.NumThreads();
+    const size_t chunk_size = (query_idxs.size() + num_workers - 1) /
+                              std::max<size_t>(num_workers, 1);
+    for (size_t begin = 0; begin < query_idxs.size(); begin += chunk_size) {
+      const size_t end = std::min(begin + chunk_size, query_idxs.size());
+      thread_pool.AddTask([&, begin, end]() {
+        std::vector<double> distances;
+        for (size_t i = begin; i < end; ++i) {
+          spatial_index.Search(locations[query_idxs[i]], max_num_neighbors,
+                               options_.max_distance, &neighbor_image_ids[i],
+                               &distances);
+        }
+      });
+    }
+    thread_pool.Wait();
+  }
 
-  Eigen::Matrix<size_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      index_matrix(num_locations, knn);
-  flann::Matrix<size_t> indices(index_matrix.data(), num_locations, knn);
+  PrintElapsedTime(timer);
 
-  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      distance_matrix(num_locations, knn);
-  flann::Matrix<float> distances(distance_matrix.data(), num_locations, knn);
+  //////////////////////////////////////////////////////////////////////////////
+  // Pre-filtering
+  //////////////////////////////////////////////////////////////////////////////
 
-  flann::SearchParams search_params(flann::FLANN_CHECKS_AUTOTUNED);
-  if (match_options_.num_threads == ThreadPool::kMaxNumThreads) {
-    search_params.cores = std::thread::hardware_concurrency();
-  } else {
-    search_params.cores = match_options_.num_threads;
-  }
-  if (search_params.cores <= 0) {
-    search_params.cores = 1;
+  if (!options_.pre_filter_vocab_tree_path.empty()) {
+    pre_filter_.reset(new ImagePairPreFilter(
+        options_.pre_filter_vocab_tree_path, options_.pre_filter_min_score,
+        match_options_.min_num_inliers, match_options_.num_threads, &cache_));
+    if (!pre_filter_->Setup(image_ids, this)) {
+      GetTimer().PrintMinutes();
+      return;
+    }
   }
 
-  search_index.knnSearch(locations, indices, distances, knn, search_params);
-
-  PrintElapsedTime(timer);
-
   //////////////////////////////////////////////////////////////////////////////
   // Matching
   //////////////////////////////////////////////////////////////////////////////
 
-  const float max_distance =
-      static_cast<float>(options_.max_distance * options_.max_distance);
-
   std::vector<std::pair<image_t, image_t>> image_pairs;
-  image_pairs.reserve(knn);
+  image_pairs.reserve(max_num_neighbors);
 
-  for (size_t i = 0; i < num_locations; ++i) {
+  for (size_t i = 0; i < query_idxs.size(); ++i) {
     if (IsStopped()) {
       GetTimer().PrintMinutes();
       return;
@@ -1272,33 +2501,24 @@ void SpatialFeatureMatcher::Run() {
 
     timer.Restart();
 
-    std::cout << StringPrintf("Matching image [%d/%d]", i + 1, num_locations)
-              << std::flush;
-
     image_pairs.clear();
 
-    for (int j = 0; j < knn; ++j) {
-      // Check if query equals result.
-      if (index_matrix(i, j) == i) {
-        continue;
-      }
-
-      // Since the nearest neighbors are sorted by distance, we can break.
-      if (distance_matrix(i, j) > max_distance) {
-        break;
+    const image_t image_id = location_image_ids[query_idxs[i]];
+    for (const image_t nn_image_id : neighbor_image_ids[i]) {
+      if (nn_image_id != image_id) {
+        image_pairs.emplace_back(image_id, nn_image_id);
       }
+    }
 
-      const size_t idx = location_idxs[i];
-      const image_t image_id = image_ids.at(idx);
-      const size_t nn_idx = location_idxs.at(index_matrix(i, j));
-      const image_t nn_image_id = image_ids.at(nn_idx);
-      image_pairs.emplace_back(image_id, nn_image_id);
+    if (pre_filter_) {
+      pre_filter_->Filter(&image_pairs);
     }
 
-    DatabaseTransaction database_transaction(&database_);
     matcher_.Match(image_pairs);
 
-    PrintElapsedTime(timer);
+    PrintMatchingProgress(
+        StringPrintf("Matching image [%d/%d]", i + 1, query_idxs.size()), timer,
+        i + 1 == query_idxs.size());
   }
 
   GetTimer().PrintMinutes();
@@ -1326,9 +2546,48 @@ void TransitiveFeatureMatcher::Run() {
   cache_.Setup();
 
   const std::vector<image_t> image_ids = cache_.GetImageIds();
+  std::unordered_map<image_t, size_t> image_idxs;
+  image_idxs.reserve(image_ids.size());
+  for (size_t image_idx = 0; image_idx < image_ids.size(); ++image_idx) {
+    image_idxs.emplace(image_ids[image_idx], image_idx);
+  }
+
+  // The verified image pairs are only read once from the database. The image
+  // pairs verified in an iteration are appended to the adjacency and form the
+  // frontier of the next iteration, which only expands the paths through
+  // these new image pairs.
+  std::vector<std::vector<TransitiveEdge>> adjacency(image_ids.size());
+  std::vector<std::pair<size_t, size_t>> frontier;
+  std::unordered_set<image_pair_t> known_image_pair_ids;
+
+  auto AddEdge = [&](const size_t image_idx1, const size_t image_idx2,
+                     const int num_inliers, const int iteration) {
+    adjacency[image_idx1].push_back({image_idx2, num_inliers, iteration});
+    adjacency[image_idx2].push_back({image_idx1, num_inliers, iteration});
+    frontier.emplace_back(image_idx1, image_idx2);
+  };
+
+  {
+    std::vector<std::pair<image_t, image_t>> existing_image_pairs;
+    std::vector<int> existing_num_inliers;
+    database_.ReadTwoViewGeometryNumInliers(&existing_image_pairs,
+                                            &existing_num_inliers);
+    CHECK_EQ(existing_image_pairs.size(), existing_num_inliers.size());
+
+    for (size_t i = 0; i < existing_image_pairs.size(); ++i) {
+      const auto it1 = image_idxs.find(existing_image_pairs[i].first);
+      const auto it2 = image_idxs.find(existing_image_pairs[i].second);
+      if (it1 != image_idxs.end() && it2 != image_idxs.end()) {
+        AddEdge(it1->second, it2->second, existing_num_inliers[i], 0);
+        known_image_pair_ids.insert(Database::ImagePairToPairId(
+            existing_image_pairs[i].first, existing_image_pairs[i].second));
+      }
+    }
+  }
+
+  const size_t batch_size = static_cast<size_t>(options_.batch_size);
 
   std::vector<std::pair<image_t, image_t>> image_pairs;
-  std::unordered_set<image_pair_t> image_pair_ids;
 
   for (int iteration = 0; iteration < options_.num_iterations; ++iteration) {
     if (IsStopped()) {
@@ -1343,60 +2602,62 @@ void TransitiveFeatureMatcher::Run() {
                               options_.num_iterations)
               << std::endl;
 
-    std::vector<std::pair<image_t, image_t>> existing_image_pairs;
-    std::vector<int> existing_num_inliers;
-    database_.ReadTwoViewGeometryNumInliers(&existing_image_pairs,
-                                            &existing_num_inliers);
+    const std::vector<image_pair_t> transitive_image_pair_ids =
+        FindTransitiveImagePairs(image_ids, adjacency, frontier,
+                                 known_image_pair_ids, iteration,
+                                 options_.max_num_image_pairs,
+                                 match_options_.num_threads);
 
-    CHECK_EQ(existing_image_pairs.size(), existing_num_inliers.size());
+    std::cout << StringPrintf("  Found %d transitive image pairs",
+                              transitive_image_pair_ids.size());
+    PrintElapsedTime(timer);
+    timer.Restart();
 
-    std::unordered_map<image_t, std::vector<image_t>> adjacency;
-    for (const auto& image_pair : existing_image_pairs) {
-      adjacency[image_pair.first].push_back(image_pair.second);
-      adjacency[image_pair.second].push_back(image_pair.first);
+    if (transitive_image_pair_ids.empty()) {
+      break;
     }
 
-    const size_t batch_size = static_cast<size_t>(options_.batch_size);
-
     size_t num_batches = 0;
-    image_pairs.clear();
-    image_pair_ids.clear();
-    for (const auto& image : adjacency) {
-      const auto image_id1 = image.first;
-      for (const auto& image_id2 : image.second) {
-        if (adjacency.count(image_id2) > 0) {
-          for (const auto& image_id3 : adjacency.at(image_id2)) {
-            const auto image_pair_id =
-                Database::ImagePairToPairId(image_id1, image_id3);
-            if (image_pair_ids.count(image_pair_id) == 0) {
-              image_pairs.emplace_back(image_id1, image_id3);
-              image_pair_ids.insert(image_pair_id);
-              if (image_pairs.size() >= batch_size) {
-                num_batches += 1;
-                std::cout << StringPrintf("  Batch %d", num_batches)
-                          << std::flush;
-                DatabaseTransaction database_transaction(&database_);
-                matcher_.Match(image_pairs);
-                image_pairs.clear();
-                PrintElapsedTime(timer);
-                timer.Restart();
-
-                if (IsStopped()) {
-                  GetTimer().PrintMinutes();
-                  return;
-                }
-              }
-            }
-          }
-        }
+    for (size_t begin = 0; begin < transitive_image_pair_ids.size();
+         begin += batch_size) {
+      if (IsStopped()) {
+        GetTimer().PrintMinutes();
+        return;
+      }
+
+      const size_t end =
+          std::min(begin + batch_size, transitive_image_pair_ids.size());
+      image_pairs.clear();
+      for (size_t i = begin; i < end; ++i) {
+        image_t image_id1;
+        image_t image_id2;
+        Database::PairIdToImagePair(transitive_image_pair_ids[i], &image_id1,
+                                    &image_id2);
+        image_pairs.emplace_back(image_id1, image_id2);
       }
+
+      num_batches += 1;
+      std::cout << StringPrintf("  Batch %d", num_batches) << std::flush;
+      matcher_.Match(image_pairs);
+      PrintElapsedTime(timer);
+      timer.Restart();
     }
 
-    num_batches += 1;
-    std::cout << StringPrintf("  Batch %d", num_batches) << std::flush;
-    DatabaseTransaction database_transaction(&database_);
-    matcher_.Match(image_pairs);
-    PrintElapsedTime(timer);
+    // Only read back the image pairs matched in this iteration.
+    frontier.clear();
+    for (const image_pair_t pair_id : transitive_image_pair_ids) {
+      known_image_pair_ids.insert(pair_id);
+      image_t image_id1;
+      image_t image_id2;
+      Database::PairIdToImagePair(pair_id, &image_id1, &image_id2);
+      const int num_inliers = static_cast<int>(
+          database_.ReadTwoViewGeometry(image_id1, image_id2)
+              .inlier_matches.size());
+      if (num_inliers > 0) {
+        AddEdge(image_idxs.at(image_id1), image_idxs.at(image_id2),
+                num_inliers, iteration + 1);
+      }
+    }
   }
 
   GetTimer().PrintMinutes();
@@ -1488,10 +2749,6 @@ void ImagePairsFeatureMatcher::Run() {
     Timer timer;
     timer.Start();
 
-    std::cout << StringPrintf("Matching block [%d/%d]",
-                              i / options_.block_size + 1, num_match_blocks)
-              << std::flush;
-
     const size_t block_end = i + options_.block_size <= image_pairs.size()
                                  ? i + options_.block_size
                                  : image_pairs.size();
@@ -1501,10 +2758,12 @@ void ImagePairsFeatureMatcher::Run() {
       block_image_pairs.push_back(image_pairs[j]);
     }
 
-    DatabaseTransaction database_transaction(&database_);
     matcher_.Match(block_image_pairs);
 
-    PrintElapsedTime(timer);
+    PrintMatchingProgress(StringPrintf("Matching block [%d/%d]",
+                                       i / options_.block_size + 1,
+                                       num_match_blocks),
+                          timer, block_end == image_pairs.size());
   }
 
   GetTimer().PrintMinutes();
@@ -1533,128 +2792,137 @@ void FeaturePairsFeatureMatcher::Run() {
     image_name_to_image.emplace(image.Name(), &image);
   }
 
-  std::ifstream file(options_.match_list_path);
+  const bool is_binary = HasFileExtension(options_.match_list_path, ".bin");
+  std::ifstream file(options_.match_list_path,
+                     is_binary ? std::ios::binary : std::ios::in);
   CHECK(file.is_open()) << options_.match_list_path;
 
-  std::string line;
-  while (std::getline(file, line)) {
+  TwoViewGeometry::Options two_view_geometry_options;
+  two_view_geometry_options.min_num_inliers =
+      static_cast<size_t>(match_options_.min_num_inliers);
+  two_view_geometry_options.ransac_options.max_error = match_options_.max_error;
+  two_view_geometry_options.ransac_options.confidence =
+      match_options_.confidence;
+  two_view_geometry_options.ransac_options.min_num_trials =
+      static_cast<size_t>(match_options_.min_num_trials);
+  two_view_geometry_options.ransac_options.max_num_trials =
+      static_cast<size_t>(match_options_.max_num_trials);
+  two_view_geometry_options.ransac_options.min_inlier_ratio =
+      match_options_.min_inlier_ratio;
+  two_view_geometry_options.ransac_options.use_sprt = match_options_.use_sprt;
+
+  ThreadPool thread_pool(GetEffectiveNumThreads(match_options_.num_threads));
+
+  struct PairData {
+    image_t image_id1 = kInvalidImageId;
+    image_t image_id2 = kInvalidImageId;
+    FeatureMatches matches;
+    TwoViewGeometry two_view_geometry;
+  };
+
+  // The matches are read sequentially in batches of image pairs, whose
+  // geometries are then verified concurrently, and finally written to the
+  // database in one transaction per batch.
+  std::vector<PairData> batch;
+  batch.reserve(kBatchSize);
+  ImportedMatches imported_matches;
+  size_t num_imported_pairs = 0;
+  bool end_of_file = false;
+  while (!end_of_file) {
     if (IsStopped()) {
       GetTimer().PrintMinutes();
       return;
     }
 
-    StringTrim(&line);
-    if (line.empty()) {
-      continue;
-    }
-
-    std::istringstream line_stream(line);
-
-    std::string image_name1, image_name2;
-    try {
-      line_stream >> image_name1 >> image_name2;
-    } catch (...) {
-      std::cerr << "ERROR: Could not read image pair." << std::endl;
-      break;
-    }
-
-    std::cout << StringPrintf("%s - %s", image_name1.c_str(),
-                              image_name2.c_str())
-              << std::endl;
-
-    if (image_name_to_image.count(image_name1) == 0) {
-      std::cout << StringPrintf("SKIP: Image %s not found in database.",
-                                image_name1.c_str())
-                << std::endl;
-      break;
-    }
-    if (image_name_to_image.count(image_name2) == 0) {
-      std::cout << StringPrintf("SKIP: Image %s not found in database.",
-                                image_name2.c_str())
-                << std::endl;
-      break;
-    }
-
-    const Image& image1 = *image_name_to_image[image_name1];
-    const Image& image2 = *image_name_to_image[image_name2];
-
-    bool skip_pair = false;
-    if (database_.ExistsInlierMatches(image1.ImageId(), image2.ImageId())) {
-      std::cout << "SKIP: Matches for image pair already exist in database."
-                << std::endl;
-      skip_pair = true;
-    }
-
-    FeatureMatches matches;
-    while (std::getline(file, line)) {
-      StringTrim(&line);
-
-      if (line.empty()) {
+    batch.clear();
+    while (batch.size() < kBatchSize) {
+      if (!(is_binary ? ReadNextBinaryMatches(&file, &imported_matches)
+                      : ReadNextTextMatches(&file, &imported_matches))) {
+        end_of_file = true;
         break;
       }
 
-      std::istringstream line_stream(line);
-
-      FeatureMatch match;
-      try {
-        line_stream >> match.point2D_idx1 >> match.point2D_idx2;
-      } catch (...) {
-        std::cerr << "ERROR: Cannot read feature matches." << std::endl;
+      const std::string& image_name1 = imported_matches.image_name1;
+      const std::string& image_name2 = imported_matches.image_name2;
+      if (image_name_to_image.count(image_name1) == 0) {
+        std::cout << StringPrintf("SKIP: Image %s not found in database.",
+                                  image_name1.c_str())
+                  << std::endl;
+        end_of_file = true;
+        break;
+      }
+      if (image_name_to_image.count(image_name2) == 0) {
+        std::cout << StringPrintf("SKIP: Image %s not found in database.",
+                                  image_name2.c_str())
+                  << std::endl;
+        end_of_file = true;
         break;
       }
 
-      matches.push_back(match);
-    }
+      PairData data;
+      data.image_id1 = image_name_to_image.at(image_name1)->ImageId();
+      data.image_id2 = image_name_to_image.at(image_name2)->ImageId();
 
-    if (skip_pair) {
-      continue;
-    }
+      if (database_.ExistsInlierMatches(data.image_id1, data.image_id2)) {
+        std::cout << StringPrintf("SKIP: Matches for image pair %s - %s "
+                                  "already exist in database.",
+                                  image_name1.c_str(), image_name2.c_str())
+                  << std::endl;
+        continue;
+      }
 
-    const Camera& camera1 = cache_.GetCamera(image1.CameraId());
-    const Camera& camera2 = cache_.GetCamera(image2.CameraId());
-
-    if (options_.verify_matches) {
-      database_.WriteMatches(image1.ImageId(), image2.ImageId(), matches);
-
-      const auto keypoints1 = cache_.GetKeypoints(image1.ImageId());
-      const auto keypoints2 = cache_.GetKeypoints(image2.ImageId());
-
-      TwoViewGeometry two_view_geometry;
-      TwoViewGeometry::Options two_view_geometry_options;
-      two_view_geometry_options.min_num_inliers =
-          static_cast<size_t>(match_options_.min_num_inliers);
-      two_view_geometry_options.ransac_options.max_error =
-          match_options_.max_error;
-      two_view_geometry_options.ransac_options.confidence =
-          match_options_.confidence;
-      two_view_geometry_options.ransac_options.min_num_trials =
-          static_cast<size_t>(match_options_.min_num_trials);
-      two_view_geometry_options.ransac_options.max_num_trials =
-          static_cast<size_t>(match_options_.max_num_trials);
-      two_view_geometry_options.ransac_options.min_inlier_ratio =
-          match_options_.min_inlier_ratio;
-
-      two_view_geometry.Estimate(
-          camera1, FeatureKeypointsToPointsVector(keypoints1), camera2,
-          FeatureKeypointsToPointsVector(keypoints2), matches,
-          two_view_geometry_options);
-
-      database_.WriteTwoViewGeometry(image1.ImageId(), image2.ImageId(),
-                                     two_view_geometry);
-    } else {
-      TwoViewGeometry two_view_geometry;
+      data.matches = std::move(imported_matches.matches);
+      batch.push_back(std::move(data));
+    }
 
-      if (camera1.HasPriorFocalLength() && camera2.HasPriorFocalLength()) {
-        two_view_geometry.config = TwoViewGeometry::CALIBRATED;
+    std::vector<std::future<void>> futures;
+    futures.reserve(batch.size());
+    for (auto& data : batch) {
+      const Camera& camera1 =
+          cache_.GetCamera(cache_.GetImage(data.image_id1).CameraId());
+      const Camera& camera2 =
+          cache_.GetCamera(cache_.GetImage(data.image_id2).CameraId());
+      if (options_.verify_matches) {
+        futures.push_back(thread_pool.AddTask([&, camera1, camera2]() {
+          // Independent of which thread verifies the image pair.
+          ScopedPRNGStream prng_stream(
+              Database::ImagePairToPairId(data.image_id1, data.image_id2));
+          const auto keypoints1 = cache_.GetKeypoints(data.image_id1);
+          const auto keypoints2 = cache_.GetKeypoints(data.image_id2);
+          data.two_view_geometry.Estimate(
+              camera1, FeatureKeypointsToPointsVector(*keypoints1), camera2,
+              FeatureKeypointsToPointsVector(*keypoints2), data.matches,
+              two_view_geometry_options);
+        }));
       } else {
-        two_view_geometry.config = TwoViewGeometry::UNCALIBRATED;
+        if (camera1.HasPriorFocalLength() && camera2.HasPriorFocalLength()) {
+          data.two_view_geometry.config = TwoViewGeometry::CALIBRATED;
+        } else {
+          data.two_view_geometry.config = TwoViewGeometry::UNCALIBRATED;
+        }
+        data.two_view_geometry.inlier_matches = data.matches;
       }
+    }
 
-      two_view_geometry.inlier_matches = matches;
+    for (auto& future : futures) {
+      future.get();
+    }
 
-      database_.WriteTwoViewGeometry(image1.ImageId(), image2.ImageId(),
-                                     two_view_geometry);
+    {
+      DatabaseTransaction database_transaction(&database_);
+      for (const auto& data : batch) {
+        if (options_.verify_matches) {
+          database_.WriteMatches(data.image_id1, data.image_id2, data.matches);
+        }
+        database_.WriteTwoViewGeometry(data.image_id1, data.image_id2,
+                                       data.two_view_geometry);
+      }
     }
+
+    num_imported_pairs += batch.size();
+    std::cout << StringPrintf("Imported matches of %d image pairs",
+                              num_imported_pairs)
+              << std::endl;
   }
 
   GetTimer().PrintMinutes();
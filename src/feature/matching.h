@@ -33,13 +33,21 @@
 #define COLMAP_SRC_FEATURE_MATCHING_H_
 
 #include <array>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "base/database.h"
 #include "feature/sift.h"
 #include "util/alignment.h"
 #include "util/cache.h"
+#include "util/memory_accountant.h"
+#include "util/metrics.h"
 #include "util/opengl_utils.h"
 #include "util/threading.h"
 #include "util/timer.h"
@@ -50,6 +58,14 @@ struct ExhaustiveMatchingOptions {
   // Block size, i.e. number of images to simultaneously load into memory.
   int block_size = 50;
 
+  // Optional path to a vocabulary tree, which is used to reject image pairs
+  // before matching, if their retrieval score is below the minimum score or
+  // if one of the images has fewer features than required for verification.
+  std::string pre_filter_vocab_tree_path = "";
+
+  // The minimum normalized retrieval score of an image pair to be matched.
+  double pre_filter_min_score = 0.05;
+
   bool Check() const;
 };
 
@@ -66,6 +82,10 @@ struct SequentialMatchingOptions {
   // Loop detection is invoked every `loop_detection_period` images.
   int loop_detection_period = 10;
 
+  // Images within this distance of a loop detection query in the sequence are
+  // not matched against it, since they are covered by the sequential matching.
+  int loop_detection_exclusion_window = 0;
+
   // The number of images to retrieve in loop detection. This number should
   // be significantly bigger than the sequential matching overlap.
   int loop_detection_num_images = 50;
@@ -84,9 +104,14 @@ struct SequentialMatchingOptions {
   // image has more features, only the largest-scale features will be indexed.
   int loop_detection_max_num_features = -1;
 
-  // Path to the vocabulary tree.
+  // Path to the vocabulary tree. This can also be an index previously written
+  // to `output_index_path`, in which case only new images are indexed.
   std::string vocab_tree_path = "";
 
+  // Optional path to which the vocabulary tree is written together with the
+  // indexed images of the database to speed up future indexing.
+  std::string output_index_path = "";
+
   bool Check() const;
 };
 
@@ -108,9 +133,20 @@ struct VocabTreeMatchingOptions {
   // image has more features, only the largest-scale features will be indexed.
   int max_num_features = -1;
 
-  // Path to the vocabulary tree.
+  // Whether to assign the visual words of the images on the GPU with an exact
+  // nearest neighbor search instead of the approximate FLANN search. The
+  // first GPU of SiftMatching.gpu_index is used. At most 8 nearest neighbors
+  // are searched on the GPU. Only available if compiled with CUDA.
+  bool use_gpu = false;
+
+  // Path to the vocabulary tree. This can also be an index previously written
+  // to `output_index_path`, in which case only new images are indexed.
   std::string vocab_tree_path = "";
 
+  // Optional path to which the vocabulary tree is written together with the
+  // indexed images of the database to speed up future indexing.
+  std::string output_index_path = "";
+
   // Optional path to file with specific image names to match.
   std::string match_list_path = "";
 
@@ -132,6 +168,20 @@ struct SpatialMatchingOptions {
   // coordinates the unit is Euclidean distance in meters.
   double max_distance = 100;
 
+  // Optional path to a spatial index of the image locations. If the index
+  // exists, only the images that are not yet indexed are inserted and matched
+  // against it. The updated index is then written back to this path. The
+  // index must have been built with the same location settings.
+  std::string index_path = "";
+
+  // Optional path to a vocabulary tree, which is used to reject image pairs
+  // before matching, if their retrieval score is below the minimum score or
+  // if one of the images has fewer features than required for verification.
+  std::string pre_filter_vocab_tree_path = "";
+
+  // The minimum normalized retrieval score of an image pair to be matched.
+  double pre_filter_min_score = 0.05;
+
   bool Check() const;
 };
 
@@ -142,6 +192,11 @@ struct TransitiveMatchingOptions {
   // The number of transitive closure iterations.
   int num_iterations = 3;
 
+  // The maximum number of transitive image pairs to match per iteration. The
+  // image pairs with the most shared inliers along their transitive paths are
+  // matched first. Unlimited if negative.
+  int max_num_image_pairs = -1;
+
   bool Check() const;
 };
 
@@ -149,7 +204,22 @@ struct ImagePairsMatchingOptions {
   // Number of image pairs to match in one batch.
   int block_size = 100;
 
-  // Path to the file with the matches.
+  // Path to the file with the matches. In the text format, every image pair
+  // is given by a line with the names of the two images, followed by one line
+  // per match with the indices of the two matched features, and an empty line:
+  //
+  //    image_name1.jpg image_name2.jpg
+  //    0 1
+  //    2 3
+  //
+  //    image_name1.jpg image_name3.jpg
+  //    ...
+  //
+  // For large imports, the file can be in the faster binary format, if it has
+  // the ".bin" extension. Every image pair is stored as the lengths (uint32)
+  // and characters of the two image names, followed by the number of matches
+  // (uint64) and the two feature indices (uint32) of every match, where all
+  // numbers are stored in little endian byte order.
   std::string match_list_path = "";
 
   bool Check() const;
@@ -168,6 +238,10 @@ struct FeaturePairsMatchingOptions {
 namespace internal {
 
 struct FeatureMatcherData {
+  // Identifier of the batch of image pairs the data was submitted with.
+  size_t batch_id = 0;
+  // Position of the image pair in the order of submission across all batches.
+  size_t sequence_id = 0;
   image_t image_id1 = kInvalidImageId;
   image_t image_id2 = kInvalidImageId;
   FeatureMatches matches;
@@ -176,17 +250,40 @@ struct FeatureMatcherData {
 
 }  // namespace internal
 
-// Cache for feature matching to minimize database access during matching.
+// Cache for feature matching to minimize database access during matching. The
+// cache is safe to be accessed concurrently by the matcher and verifier
+// threads. The keypoints and descriptors are held in sharded caches with one
+// lock per shard and handed out as shared pointers, so that they are not copied
+// on access and remain valid after they are evicted from the cache.
 class FeatureMatcherCache {
  public:
-  FeatureMatcherCache(const size_t cache_size, const Database* database);
+  FeatureMatcherCache(const size_t cache_size, Database* database);
 
   void Setup();
 
   const Camera& GetCamera(const camera_t camera_id) const;
   const Image& GetImage(const image_t image_id) const;
-  const FeatureKeypoints& GetKeypoints(const image_t image_id);
-  const FeatureDescriptors& GetDescriptors(const image_t image_id);
+  std::shared_ptr<const FeatureKeypoints> GetKeypoints(const image_t image_id);
+  std::shared_ptr<const FeatureDescriptors> GetDescriptors(
+      const image_t image_id);
+  std::shared_ptr<const SiftFLANNIndex> GetFLANNIndex(const image_t image_id);
+
+  // Load the keypoints and descriptors of an image into the cache in the
+  // background, e.g., for images that are matched next in a known order.
+  void Prefetch(const image_t image_id);
+
+  // Remove the features of an image from the cache, once it is known not to
+  // be matched anymore, e.g., after it left the window of sequential matching.
+  // Features that are still in use remain valid. The matchers are notified
+  // through `GetEvictedImageIds`, so they can release their device copies.
+  void Evict(const image_t image_id);
+
+  // Get the images evicted since the given number of evictions and set it to
+  // the current number of evictions, so that each caller sees every eviction
+  // exactly once by starting with zero.
+  void GetEvictedImageIds(size_t* num_evictions,
+                          std::vector<image_t>* image_ids);
+
   FeatureMatches GetMatches(const image_t image_id1, const image_t image_id2);
   std::vector<image_t> GetImageIds() const;
 
@@ -198,17 +295,50 @@ class FeatureMatcherCache {
   void WriteTwoViewGeometry(const image_t image_id1, const image_t image_id2,
                             const TwoViewGeometry& two_view_geometry);
 
+  // Write the matches and two-view geometries of multiple image pairs in a
+  // single database transaction.
+  void WriteMatchesAndTwoViewGeometries(
+      const std::vector<internal::FeatureMatcherData>& data);
+
   void DeleteMatches(const image_t image_id1, const image_t image_id2);
   void DeleteInlierMatches(const image_t image_id1, const image_t image_id2);
 
+  // Read the cached visual words of an image for the given vocabulary tree
+  // and write the visual words of multiple images in a single database
+  // transaction, see `Database::ReadVisualWordIds`. The visual words are not
+  // cached, if the database is read-only.
+  Eigen::MatrixXi GetVisualWordIds(const image_t image_id,
+                                   const uint64_t vocab_hash);
+  void WriteVisualWordIds(const uint64_t vocab_hash,
+                          const std::vector<image_t>& image_ids,
+                          const std::vector<Eigen::MatrixXi>& word_ids);
+
  private:
+  // Estimate the memory usage of the cached keypoints and descriptors from the
+  // average size of the loaded ones and release memory by evicting features
+  // from all caches in proportion.
+  size_t NumBytes() const;
+  void Shrink(const size_t num_bytes);
+
   const size_t cache_size_;
-  const Database* database_;
+  Database* database_;
   std::mutex database_mutex_;
+  // Read-only connections for loading the features of cache misses
+  // concurrently, if the database can be opened multiple times.
+  std::unique_ptr<DatabaseReadPool> database_read_pool_;
   EIGEN_STL_UMAP(camera_t, Camera) cameras_cache_;
   EIGEN_STL_UMAP(image_t, Image) images_cache_;
-  std::unique_ptr<LRUCache<image_t, FeatureKeypoints>> keypoints_cache_;
-  std::unique_ptr<LRUCache<image_t, FeatureDescriptors>> descriptors_cache_;
+  std::unique_ptr<ShardedLRUCache<image_t, FeatureKeypoints>> keypoints_cache_;
+  std::unique_ptr<ShardedLRUCache<image_t, FeatureDescriptors>>
+      descriptors_cache_;
+  std::unique_ptr<ShardedLRUCache<image_t, SiftFLANNIndex>> flann_index_cache_;
+  std::mutex evicted_image_ids_mutex_;
+  std::vector<image_t> evicted_image_ids_;
+  std::atomic<size_t> num_loaded_keypoints_;
+  std::atomic<size_t> num_loaded_keypoints_bytes_;
+  std::atomic<size_t> num_loaded_descriptors_;
+  std::atomic<size_t> num_loaded_descriptors_bytes_;
+  std::unique_ptr<ScopedMemoryComponent> memory_component_;
 };
 
 class FeatureMatcherThread : public Thread {
@@ -253,8 +383,17 @@ class SiftGPUFeatureMatcher : public FeatureMatcherThread {
  protected:
   void Run() override;
 
-  void GetDescriptorData(const int index, const image_t image_id,
-                         const FeatureDescriptors** descriptors_ptr);
+  // Set the descriptors of an image as the index-th descriptors of the GPU
+  // matcher, if not already set, either from the GPU descriptor cache or by
+  // uploading the (prefetched) descriptors.
+  void SetDescriptorData(const int index, const image_t image_id,
+                         SiftMatchGPU* sift_match_gpu);
+
+  // Pop the next job from the input queue and fetch the descriptors that are
+  // not yet uploaded to the GPU. This is executed in a separate thread, such
+  // that the host-side work overlaps with the matching of the previous job.
+  JobQueue<Input>::Job PrefetchInputJob();
+  void PrefetchDescriptorData(const int index, const image_t image_id);
 
   JobQueue<Input>* input_queue_;
   JobQueue<Output>* output_queue_;
@@ -263,7 +402,33 @@ class SiftGPUFeatureMatcher : public FeatureMatcherThread {
 
   // The previously uploaded images to the GPU.
   std::array<image_t, 2> prev_uploaded_image_ids_;
-  std::array<FeatureDescriptors, 2> prev_uploaded_descriptors_;
+  std::array<std::shared_ptr<const FeatureDescriptors>, 2>
+      prev_uploaded_descriptors_;
+
+  // The prefetched images for the next job.
+  std::array<image_t, 2> prefetched_image_ids_;
+  std::array<std::shared_ptr<const FeatureDescriptors>, 2>
+      prefetched_descriptors_;
+};
+
+// Brute-force feature matcher on the tensor cores of a CUDA device, see
+// `SiftMatcherCUDA`. The descriptors of an image are only uploaded again if
+// the image changes with respect to the previous job.
+class SiftCUDAFeatureMatcher : public FeatureMatcherThread {
+ public:
+  typedef internal::FeatureMatcherData Input;
+  typedef internal::FeatureMatcherData Output;
+
+  SiftCUDAFeatureMatcher(const SiftMatchingOptions& options,
+                         FeatureMatcherCache* cache,
+                         JobQueue<Input>* input_queue,
+                         JobQueue<Output>* output_queue);
+
+ protected:
+  void Run() override;
+
+  JobQueue<Input>* input_queue_;
+  JobQueue<Output>* output_queue_;
 };
 
 class GuidedSiftCPUFeatureMatcher : public FeatureMatcherThread {
@@ -296,9 +461,12 @@ class GuidedSiftGPUFeatureMatcher : public FeatureMatcherThread {
  private:
   void Run() override;
 
-  void GetFeatureData(const int index, const image_t image_id,
-                      const FeatureKeypoints** keypoints_ptr,
-                      const FeatureDescriptors** descriptors_ptr);
+  // Set the descriptors of the image from the device descriptor cache or
+  // upload them. Only the keypoints must then be passed to the matching,
+  // which is NULL if the image was already uploaded in the previous job.
+  void SetFeatureData(const int index, const image_t image_id,
+                      SiftMatchGPU* sift_match_gpu,
+                      const FeatureKeypoints** keypoints_ptr);
 
   JobQueue<Input>* input_queue_;
   JobQueue<Output>* output_queue_;
@@ -307,8 +475,10 @@ class GuidedSiftGPUFeatureMatcher : public FeatureMatcherThread {
 
   // The previously uploaded images to the GPU.
   std::array<image_t, 2> prev_uploaded_image_ids_;
-  std::array<FeatureKeypoints, 2> prev_uploaded_keypoints_;
-  std::array<FeatureDescriptors, 2> prev_uploaded_descriptors_;
+  std::array<std::shared_ptr<const FeatureKeypoints>, 2>
+      prev_uploaded_keypoints_;
+  std::array<std::shared_ptr<const FeatureDescriptors>, 2>
+      prev_uploaded_descriptors_;
 };
 
 class TwoViewGeometryVerifier : public Thread {
@@ -331,11 +501,51 @@ class TwoViewGeometryVerifier : public Thread {
   JobQueue<Output>* output_queue_;
 };
 
+// Writes the results of the matching pipeline to the database on a dedicated
+// thread, such that the matching is not blocked by the database. The results
+// are grouped into batches that are each written in one transaction. The
+// callback is invoked on the writer thread after each written batch. In the
+// deterministic mode, the results are written in the order of submission
+// instead of the order in which they arrive from the verifiers, such that the
+// written batches and callbacks do not depend on the scheduling.
+class FeatureMatcherWriter : public Thread {
+ public:
+  typedef internal::FeatureMatcherData Input;
+
+  FeatureMatcherWriter(
+      const SiftMatchingOptions& options, FeatureMatcherCache* cache,
+      JobQueue<Input>* input_queue,
+      const std::function<void(const std::vector<Input>&)>& written_callback);
+
+ protected:
+  // Maximum number of results written in one database transaction.
+  static const size_t kMaxBatchSize = 500;
+
+  void Run() override;
+  void WriteBatch();
+
+  const SiftMatchingOptions options_;
+  FeatureMatcherCache* cache_;
+  JobQueue<Input>* input_queue_;
+
+  const std::function<void(const std::vector<Input>&)> written_callback_;
+
+  std::vector<Input> batch_;
+
+  // The results that arrived before all previously submitted results in the
+  // deterministic mode, and the sequence identifier of the next result.
+  std::map<size_t, Input> reorder_buffer_;
+  size_t next_sequence_id_;
+};
+
 // Multi-threaded and multi-GPU SIFT feature matcher, which writes the computed
 // results to the database and skips already matched image pairs. To improve
 // performance of the matching by taking advantage of caching and database
-// transactions, pass multiple images to the `Match` function. Note that the
-// database should be in an active transaction while calling `Match`.
+// transactions, pass multiple images to the `Match` function. To keep the
+// pipeline saturated across batches, submit consecutive batches with
+// `MatchAsync` instead. The results are written to the database in batched
+// transactions by a separate thread, so the database must not be in an active
+// transaction while matching.
 class SiftFeatureMatcher {
  public:
   SiftFeatureMatcher(const SiftMatchingOptions& options, Database* database,
@@ -346,25 +556,91 @@ class SiftFeatureMatcher {
   // Setup the matchers and return if successful.
   bool Setup();
 
-  // Match one batch of multiple image pairs.
+  // Match one batch of multiple image pairs and wait until its results are
+  // written to the database.
   void Match(const std::vector<std::pair<image_t, image_t>>& image_pairs);
 
+  // Submit one batch of multiple image pairs for matching without waiting for
+  // the results. The optional callback is invoked once all results of the
+  // batch are written to the database, possibly from another thread.
+  void MatchAsync(const std::vector<std::pair<image_t, image_t>>& image_pairs,
+                  const std::function<void()>& callback = nullptr);
+
+  // Wait until at most the given number of submitted batches are pending.
+  void Wait(const size_t max_num_pending_batches = 0);
+
+  // Load the keypoints and descriptors of the next batch of image pairs into
+  // the cache on a background thread, while the current batch is matched.
+  void Prefetch(const std::vector<std::pair<image_t, image_t>>& image_pairs);
+
  private:
   SiftMatchingOptions options_;
   Database* database_;
   FeatureMatcherCache* cache_;
 
+  void HandleWrittenOutputs(
+      const std::vector<internal::FeatureMatcherData>& outputs);
+
   bool is_setup_;
 
+  struct PendingBatch {
+    size_t num_outputs = 0;
+    std::function<void()> callback;
+  };
+
+  // The submitted batches whose results are not yet fully written and the
+  // image pairs that are currently in the pipeline.
+  size_t next_batch_id_;
+  size_t next_sequence_id_;
+  std::unordered_map<size_t, PendingBatch> pending_batches_;
+  std::unordered_set<image_pair_t> pending_image_pair_ids_;
+  std::mutex pending_mutex_;
+  std::condition_variable pending_condition_;
+
   std::vector<std::unique_ptr<FeatureMatcherThread>> matchers_;
   std::vector<std::unique_ptr<FeatureMatcherThread>> guided_matchers_;
   std::vector<std::unique_ptr<Thread>> verifiers_;
+  std::unique_ptr<FeatureMatcherWriter> writer_;
   std::unique_ptr<ThreadPool> thread_pool_;
+  std::future<void> prefetch_future_;
 
   JobQueue<internal::FeatureMatcherData> matcher_queue_;
   JobQueue<internal::FeatureMatcherData> verifier_queue_;
   JobQueue<internal::FeatureMatcherData> guided_matcher_queue_;
   JobQueue<internal::FeatureMatcherData> output_queue_;
+
+  ScopedMetricsGauges metrics_gauges_;
+};
+
+// Cheap filter that rejects image pairs before any descriptor matching, if the
+// images are unlikely to overlap. Each image is queried against all indexed
+// images in a vocabulary tree and an image pair is only accepted, if one of
+// the images retrieves the other with at least the given minimum score and
+// both images have at least the given minimum number of features.
+class ImagePairPreFilter {
+ public:
+  ImagePairPreFilter(const std::string& vocab_tree_path, const double min_score,
+                     const int min_num_features, const int num_threads,
+                     FeatureMatcherCache* cache);
+
+  // Index and query the given images in the vocabulary tree. Returns false, if
+  // the thread was stopped during the setup.
+  bool Setup(const std::vector<image_t>& image_ids, Thread* thread);
+
+  bool IsAccepted(const image_t image_id1, const image_t image_id2) const;
+
+  // Remove the rejected image pairs in-place.
+  void Filter(std::vector<std::pair<image_t, image_t>>* image_pairs) const;
+
+ private:
+  const std::string vocab_tree_path_;
+  const double min_score_;
+  const int min_num_features_;
+  const int num_threads_;
+  FeatureMatcherCache* cache_;
+
+  std::unordered_map<image_t, size_t> num_features_;
+  std::unordered_map<image_t, std::unordered_set<image_t>> similar_image_ids_;
 };
 
 // Exhaustively match images by processing each block in the exhaustive match
@@ -404,6 +680,7 @@ class ExhaustiveFeatureMatcher : public Thread {
   Database database_;
   FeatureMatcherCache cache_;
   SiftFeatureMatcher matcher_;
+  std::unique_ptr<ImagePairPreFilter> pre_filter_;
 };
 
 // Sequentially match images within neighborhood:
@@ -435,7 +712,6 @@ class SequentialFeatureMatcher : public Thread {
 
   std::vector<image_t> GetOrderedImageIds() const;
   void RunSequentialMatching(const std::vector<image_t>& image_ids);
-  void RunLoopDetection(const std::vector<image_t>& image_ids);
 
   const SequentialMatchingOptions options_;
   const SiftMatchingOptions match_options_;
@@ -477,6 +753,7 @@ class SpatialFeatureMatcher : public Thread {
   Database database_;
   FeatureMatcherCache cache_;
   SiftFeatureMatcher matcher_;
+  std::unique_ptr<ImagePairPreFilter> pre_filter_;
 };
 
 // Match transitive image pairs in a database with existing feature matches.
@@ -547,6 +824,7 @@ class FeaturePairsFeatureMatcher : public Thread {
 
  private:
   const static size_t kCacheSize = 100;
+  const static size_t kBatchSize = 1000;
 
   void Run() override;
 
@@ -31,56 +31,185 @@
 
 #include "feature/sift.h"
 
+#include <algorithm>
 #include <array>
 #include <fstream>
+#include <iterator>
 #include <memory>
 
+#if defined(SIMD_ENABLED) && (defined(__AVX2__) || defined(__SSE2__))
+#include <immintrin.h>
+#elif defined(SIMD_ENABLED) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "FLANN/flann.hpp"
 #include "SiftGPU/SiftGPU.h"
 #include "VLFeat/covdet.h"
 #include "VLFeat/sift.h"
 #include "feature/utils.h"
 #include "util/cuda.h"
+#include "util/endian.h"
 #include "util/logging.h"
 #include "util/math.h"
 #include "util/misc.h"
 #include "util/opengl_utils.h"
+#include "util/threading.h"
 
 namespace colmap {
 namespace {
 
-size_t FindBestMatchesOneWayBruteForce(const Eigen::MatrixXi& dists,
-                                       const float max_ratio,
-                                       const float max_distance,
-                                       std::vector<int>* matches) {
+// Running best and second best match of a descriptor, which is updated as the
+// candidate descriptors are visited in ascending index order. In case of equal
+// distances, the candidate with the smaller index is kept as the best match.
+struct SiftBestMatch {
+  inline void Update(const int idx, const int dist) {
+    if (dist > best_dist) {
+      best_idx = idx;
+      second_best_dist = best_dist;
+      best_dist = dist;
+    } else if (dist > second_best_dist) {
+      second_best_dist = dist;
+    }
+  }
+
+  int best_idx = -1;
+  int best_dist = 0;
+  int second_best_dist = 0;
+};
+
+// Compute the dot product between two SIFT descriptors with 128 dimensions.
+// The products are accumulated in 32-bit integers, which cannot overflow for
+// 128 * 255 * 255 < 2^31, so that all code paths produce identical results.
+inline int ComputeSiftDescriptorDotProduct(const uint8_t* descriptor1,
+                                           const uint8_t* descriptor2) {
+#if defined(SIMD_ENABLED) && defined(__AVX2__)
+  __m256i sum = _mm256_setzero_si256();
+  for (int i = 0; i < 128; i += 16) {
+    const __m256i values1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(descriptor1 + i)));
+    const __m256i values2 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(descriptor2 + i)));
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(values1, values2));
+  }
+  __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                 _mm256_extracti128_si256(sum, 1));
+  sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, 0x4E));
+  sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, 0xB1));
+  return _mm_cvtsi128_si32(sum128);
+#elif defined(SIMD_ENABLED) && defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sum = _mm_setzero_si128();
+  for (int i = 0; i < 128; i += 16) {
+    const __m128i values1 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(descriptor1 + i));
+    const __m128i values2 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(descriptor2 + i));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(values1, zero),
+                                            _mm_unpacklo_epi8(values2, zero)));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpackhi_epi8(values1, zero),
+                                            _mm_unpackhi_epi8(values2, zero)));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+  return _mm_cvtsi128_si32(sum);
+#elif defined(SIMD_ENABLED) && defined(__ARM_NEON)
+  uint32x4_t sum = vdupq_n_u32(0);
+  for (int i = 0; i < 128; i += 16) {
+    const uint8x16_t values1 = vld1q_u8(descriptor1 + i);
+    const uint8x16_t values2 = vld1q_u8(descriptor2 + i);
+    sum = vpadalq_u16(
+        sum, vmull_u8(vget_low_u8(values1), vget_low_u8(values2)));
+    sum = vpadalq_u16(
+        sum, vmull_u8(vget_high_u8(values1), vget_high_u8(values2)));
+  }
+  const uint64x2_t sum64 = vpaddlq_u32(sum);
+  return static_cast<int>(vgetq_lane_u64(sum64, 0) + vgetq_lane_u64(sum64, 1));
+#else
+  int dot = 0;
+  for (int i = 0; i < 128; ++i) {
+    dot += static_cast<int>(descriptor1[i]) * static_cast<int>(descriptor2[i]);
+  }
+  return dot;
+#endif
+}
+
+// Find the best and second best matches in both directions without computing
+// the full distance matrix. The descriptors are processed in blocks, such that
+// a block of descriptors from the first set stays in the L1 cache while a
+// block of descriptors from the second set is streamed from the L2 cache.
+// Note that both directions are visited in ascending index order, so that the
+// results are identical to a brute-force search over the full matrix.
+void FindBestMatchesBlockedBruteForce(
+    const FeatureDescriptors& descriptors1,
+    const FeatureDescriptors& descriptors2, const bool cross_check,
+    std::vector<SiftBestMatch>* best_matches12,
+    std::vector<SiftBestMatch>* best_matches21) {
+  const int kBlockSize1 = 64;
+  const int kBlockSize2 = 256;
+
+  const int num_descriptors1 = static_cast<int>(descriptors1.rows());
+  const int num_descriptors2 = static_cast<int>(descriptors2.rows());
+
+  best_matches12->clear();
+  best_matches12->resize(num_descriptors1);
+  best_matches21->clear();
+  if (cross_check) {
+    best_matches21->resize(num_descriptors2);
+  }
+
+  if (num_descriptors1 == 0 || num_descriptors2 == 0) {
+    return;
+  }
+
+  CHECK_EQ(descriptors1.cols(), 128);
+  CHECK_EQ(descriptors2.cols(), 128);
+
+  for (int block_begin1 = 0; block_begin1 < num_descriptors1;
+       block_begin1 += kBlockSize1) {
+    const int block_end1 =
+        std::min(block_begin1 + kBlockSize1, num_descriptors1);
+    for (int block_begin2 = 0; block_begin2 < num_descriptors2;
+         block_begin2 += kBlockSize2) {
+      const int block_end2 =
+          std::min(block_begin2 + kBlockSize2, num_descriptors2);
+      for (int i1 = block_begin1; i1 < block_end1; ++i1) {
+        const uint8_t* descriptor1 = descriptors1.data() + 128 * i1;
+        SiftBestMatch& best_match12 = (*best_matches12)[i1];
+        for (int i2 = block_begin2; i2 < block_end2; ++i2) {
+          const int dist = ComputeSiftDescriptorDotProduct(
+              descriptor1, descriptors2.data() + 128 * i2);
+          best_match12.Update(i2, dist);
+          if (cross_check) {
+            (*best_matches21)[i2].Update(i1, dist);
+          }
+        }
+      }
+    }
+  }
+}
+
+size_t FindBestMatchesOneWayBruteForce(
+    const std::vector<SiftBestMatch>& best_matches, const float max_ratio,
+    const float max_distance, std::vector<int>* matches,
+    std::vector<float>* ratios) {
   // SIFT descriptor vectors are normalized to length 512.
   const float kDistNorm = 1.0f / (512.0f * 512.0f);
 
   size_t num_matches = 0;
-  matches->resize(dists.rows(), -1);
+  matches->resize(best_matches.size(), -1);
+  ratios->resize(best_matches.size(), 1.0f);
 
-  for (Eigen::Index i1 = 0; i1 < dists.rows(); ++i1) {
-    int best_i2 = -1;
-    int best_dist = 0;
-    int second_best_dist = 0;
-    for (Eigen::Index i2 = 0; i2 < dists.cols(); ++i2) {
-      const int dist = dists(i1, i2);
-      if (dist > best_dist) {
-        best_i2 = i2;
-        second_best_dist = best_dist;
-        best_dist = dist;
-      } else if (dist > second_best_dist) {
-        second_best_dist = dist;
-      }
-    }
+  for (size_t i1 = 0; i1 < best_matches.size(); ++i1) {
+    const SiftBestMatch& best_match = best_matches[i1];
 
     // Check if any match found.
-    if (best_i2 == -1) {
+    if (best_match.best_idx == -1) {
       continue;
     }
 
     const float best_dist_normed =
-        std::acos(std::min(kDistNorm * best_dist, 1.0f));
+        std::acos(std::min(kDistNorm * best_match.best_dist, 1.0f));
 
     // Check if match distance passes threshold.
     if (best_dist_normed > max_distance) {
@@ -88,7 +217,7 @@ size_t FindBestMatchesOneWayBruteForce(const Eigen::MatrixXi& dists,
     }
 
     const float second_best_dist_normed =
-        std::acos(std::min(kDistNorm * second_best_dist, 1.0f));
+        std::acos(std::min(kDistNorm * best_match.second_best_dist, 1.0f));
 
     // Check if match passes ratio test. Keep this comparison >= in order to
     // ensure that the case of best == second_best is detected.
@@ -97,26 +226,44 @@ size_t FindBestMatchesOneWayBruteForce(const Eigen::MatrixXi& dists,
     }
 
     num_matches += 1;
-    (*matches)[i1] = best_i2;
+    (*matches)[i1] = best_match.best_idx;
+    (*ratios)[i1] = best_dist_normed / second_best_dist_normed;
   }
 
   return num_matches;
 }
 
-void FindBestMatchesBruteForce(const Eigen::MatrixXi& dists,
-                               const float max_ratio, const float max_distance,
-                               const bool cross_check,
-                               FeatureMatches* matches) {
+// Sort the matches by their ratio test score in the first image, such that
+// the most distinctive matches come first, as expected by PROSAC.
+void SortMatchesByRatio(const std::vector<float>& ratios12,
+                        FeatureMatches* matches) {
+  std::stable_sort(matches->begin(), matches->end(),
+                   [&ratios12](const FeatureMatch& match1,
+                               const FeatureMatch& match2) {
+                     return ratios12[match1.point2D_idx1] <
+                            ratios12[match2.point2D_idx1];
+                   });
+}
+
+// Apply the distance and ratio tests to the best matches in both directions
+// and optionally only keep the mutually best matches.
+void SelectBestMatches(const std::vector<SiftBestMatch>& best_matches12,
+                       const std::vector<SiftBestMatch>& best_matches21,
+                       const float max_ratio, const float max_distance,
+                       const bool cross_check, const bool sort_by_ratio,
+                       FeatureMatches* matches) {
   matches->clear();
 
   std::vector<int> matches12;
+  std::vector<float> ratios12;
   const size_t num_matches12 = FindBestMatchesOneWayBruteForce(
-      dists, max_ratio, max_distance, &matches12);
+      best_matches12, max_ratio, max_distance, &matches12, &ratios12);
 
   if (cross_check) {
     std::vector<int> matches21;
+    std::vector<float> ratios21;
     const size_t num_matches21 = FindBestMatchesOneWayBruteForce(
-        dists.transpose(), max_ratio, max_distance, &matches21);
+        best_matches21, max_ratio, max_distance, &matches21, &ratios21);
     matches->reserve(std::min(num_matches12, num_matches21));
     for (size_t i1 = 0; i1 < matches12.size(); ++i1) {
       if (matches12[i1] != -1 && matches21[matches12[i1]] != -1 &&
@@ -138,6 +285,90 @@ void FindBestMatchesBruteForce(const Eigen::MatrixXi& dists,
       }
     }
   }
+
+  if (sort_by_ratio) {
+    SortMatchesByRatio(ratios12, matches);
+  }
+}
+
+void FindBestMatchesBruteForce(const FeatureDescriptors& descriptors1,
+                               const FeatureDescriptors& descriptors2,
+                               const float max_ratio, const float max_distance,
+                               const bool cross_check, const bool sort_by_ratio,
+                               FeatureMatches* matches) {
+  std::vector<SiftBestMatch> best_matches12;
+  std::vector<SiftBestMatch> best_matches21;
+  FindBestMatchesBlockedBruteForce(descriptors1, descriptors2, cross_check,
+                                   &best_matches12, &best_matches21);
+  SelectBestMatches(best_matches12, best_matches21, max_ratio, max_distance,
+                    cross_check, sort_by_ratio, matches);
+}
+
+// Find the best and second best matches of the first descriptors among the
+// second descriptors. The asymmetric distances between the full descriptors
+// of the first set and the product quantization codes of the second set
+// select the nearest candidates, which are then re-ranked using the exact
+// dot products with the full descriptors of the second set.
+void FindBestMatchesOneWayPQ(const FeatureDescriptorCodebook& codebook,
+                             const FeatureDescriptors& descriptors1,
+                             const FeatureDescriptors& descriptors2,
+                             const FeatureDescriptors& codes2,
+                             const int num_candidates,
+                             std::vector<SiftBestMatch>* best_matches) {
+  const int num_descriptors1 = static_cast<int>(descriptors1.rows());
+  const int num_descriptors2 = static_cast<int>(descriptors2.rows());
+
+  best_matches->clear();
+  best_matches->resize(num_descriptors1);
+
+  if (num_descriptors1 == 0 || num_descriptors2 == 0) {
+    return;
+  }
+
+  const int num_subspaces = codebook.NumSubspaces();
+
+  CHECK_EQ(descriptors1.cols(), 128);
+  CHECK_EQ(descriptors2.cols(), 128);
+  CHECK_EQ(codes2.rows(), num_descriptors2);
+  CHECK_EQ(codes2.cols(), num_subspaces);
+
+  const int num_used_candidates = std::min(num_candidates, num_descriptors2);
+
+  std::vector<std::pair<float, int>> candidates(num_descriptors2);
+  for (int i1 = 0; i1 < num_descriptors1; ++i1) {
+    const uint8_t* descriptor1 = descriptors1.data() + 128 * i1;
+    const auto table =
+        ComputeFeatureDescriptorDistanceTable(codebook, descriptor1);
+
+    for (int i2 = 0; i2 < num_descriptors2; ++i2) {
+      const uint8_t* code2 = codes2.data() + num_subspaces * i2;
+      float dist = 0.0f;
+      for (int s = 0; s < num_subspaces; ++s) {
+        dist += table.data()[s * FeatureDescriptorCodebook::kNumCentroids +
+                             code2[s]];
+      }
+      candidates[i2] = std::make_pair(dist, i2);
+    }
+
+    std::nth_element(candidates.begin(),
+                     candidates.begin() + num_used_candidates - 1,
+                     candidates.end());
+
+    // Visit the candidates in ascending index order, such that ties are
+    // resolved in the same way as in the brute-force search.
+    std::sort(candidates.begin(), candidates.begin() + num_used_candidates,
+              [](const std::pair<float, int>& candidate1,
+                 const std::pair<float, int>& candidate2) {
+                return candidate1.second < candidate2.second;
+              });
+
+    SiftBestMatch& best_match = (*best_matches)[i1];
+    for (int k = 0; k < num_used_candidates; ++k) {
+      const int i2 = candidates[k].second;
+      best_match.Update(i2, ComputeSiftDescriptorDotProduct(
+                                descriptor1, descriptors2.data() + 128 * i2));
+    }
+  }
 }
 
 // Mutexes that ensure that only one thread extracts/matches on the same GPU
@@ -200,64 +431,19 @@ Eigen::MatrixXi ComputeSiftDistanceMatrix(
   return dists;
 }
 
-void FindBestMatchesOneWayFLANN(
-    const FeatureDescriptors& query, const FeatureDescriptors& database,
-    Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>*
-        indices,
-    Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>*
-        distances) {
-  const size_t kNumNearestNeighbors = 2;
-  const size_t kNumTreesInForest = 4;
-
-  indices->resize(query.rows(), std::min(kNumNearestNeighbors,
-                                         static_cast<size_t>(database.rows())));
-  distances->resize(
-      query.rows(),
-      std::min(kNumNearestNeighbors, static_cast<size_t>(database.rows())));
-  const flann::Matrix<uint8_t> query_matrix(const_cast<uint8_t*>(query.data()),
-                                            query.rows(), 128);
-  const flann::Matrix<uint8_t> database_matrix(
-      const_cast<uint8_t*>(database.data()), database.rows(), 128);
-
-  if (query.rows() == 0 || database.rows() == 0) {
-    return;
-  }
-
-  flann::Matrix<int> indices_matrix(indices->data(), query.rows(),
-                                    kNumNearestNeighbors);
-  std::vector<float> distances_vector(query.rows() * kNumNearestNeighbors);
-  flann::Matrix<float> distances_matrix(distances_vector.data(), query.rows(),
-                                        kNumNearestNeighbors);
-  flann::Index<flann::L2<uint8_t>> index(
-      database_matrix, flann::KDTreeIndexParams(kNumTreesInForest));
-  index.buildIndex();
-  index.knnSearch(query_matrix, indices_matrix, distances_matrix,
-                  kNumNearestNeighbors, flann::SearchParams(128));
-
-  for (Eigen::Index query_index = 0; query_index < indices->rows();
-       ++query_index) {
-    for (Eigen::Index k = 0; k < indices->cols(); ++k) {
-      const Eigen::Index database_index = indices->coeff(query_index, k);
-      distances->coeffRef(query_index, k) =
-          query.row(query_index)
-              .cast<int>()
-              .dot(database.row(database_index).cast<int>());
-    }
-  }
-}
-
 size_t FindBestMatchesOneWayFLANN(
     const Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         indices,
     const Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         distances,
-    const float max_ratio, const float max_distance,
-    std::vector<int>* matches) {
+    const float max_ratio, const float max_distance, std::vector<int>* matches,
+    std::vector<float>* ratios) {
   // SIFT descriptor vectors are normalized to length 512.
   const float kDistNorm = 1.0f / (512.0f * 512.0f);
 
   size_t num_matches = 0;
   matches->resize(indices.rows(), -1);
+  ratios->resize(indices.rows(), 1.0f);
 
   for (int d1_idx = 0; d1_idx < indices.rows(); ++d1_idx) {
     int best_i2 = -1;
@@ -299,6 +485,7 @@ size_t FindBestMatchesOneWayFLANN(
 
     num_matches += 1;
     (*matches)[d1_idx] = best_i2;
+    (*ratios)[d1_idx] = best_dist_normed / second_best_dist_normed;
   }
 
   return num_matches;
@@ -314,17 +501,21 @@ void FindBestMatchesFLANN(
     const Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         distances_2to1,
     const float max_ratio, const float max_distance, const bool cross_check,
-    FeatureMatches* matches) {
+    const bool sort_by_ratio, FeatureMatches* matches) {
   matches->clear();
 
   std::vector<int> matches12;
-  const size_t num_matches12 = FindBestMatchesOneWayFLANN(
-      indices_1to2, distances_1to2, max_ratio, max_distance, &matches12);
+  std::vector<float> ratios12;
+  const size_t num_matches12 =
+      FindBestMatchesOneWayFLANN(indices_1to2, distances_1to2, max_ratio,
+                                 max_distance, &matches12, &ratios12);
 
   if (cross_check && indices_2to1.rows()) {
     std::vector<int> matches21;
-    const size_t num_matches21 = FindBestMatchesOneWayFLANN(
-        indices_2to1, distances_2to1, max_ratio, max_distance, &matches21);
+    std::vector<float> ratios21;
+    const size_t num_matches21 =
+        FindBestMatchesOneWayFLANN(indices_2to1, distances_2to1, max_ratio,
+                                   max_distance, &matches21, &ratios21);
     matches->reserve(std::min(num_matches12, num_matches21));
     for (size_t i1 = 0; i1 < matches12.size(); ++i1) {
       if (matches12[i1] != -1 && matches21[matches12[i1]] != -1 &&
@@ -346,6 +537,10 @@ void FindBestMatchesFLANN(
       }
     }
   }
+
+  if (sort_by_ratio) {
+    SortMatchesByRatio(ratios12, matches);
+  }
 }
 
 void WarnIfMaxNumMatchesReachedGPU(const SiftMatchGPU& sift_match_gpu,
@@ -366,11 +561,125 @@ void WarnDarknessAdaptivityNotAvailable() {
 
 }  // namespace
 
+struct SiftFLANNIndex::Impl {
+  std::shared_ptr<const FeatureDescriptors> descriptors;
+  std::unique_ptr<flann::Index<flann::L2<uint8_t>>> index;
+};
+
+SiftFLANNIndex::SiftFLANNIndex(
+    const std::shared_ptr<const FeatureDescriptors>& descriptors)
+    : impl_(new Impl()) {
+  const size_t kNumTreesInForest = 4;
+
+  CHECK(descriptors);
+  impl_->descriptors = descriptors;
+
+  if (descriptors->rows() == 0) {
+    return;
+  }
+
+  CHECK_EQ(descriptors->cols(), 128);
+
+  const flann::Matrix<uint8_t> database_matrix(
+      const_cast<uint8_t*>(descriptors->data()), descriptors->rows(), 128);
+  impl_->index.reset(new flann::Index<flann::L2<uint8_t>>(
+      database_matrix, flann::KDTreeIndexParams(kNumTreesInForest)));
+  impl_->index->buildIndex();
+}
+
+SiftFLANNIndex::SiftFLANNIndex(SiftFLANNIndex&& other) = default;
+
+SiftFLANNIndex::~SiftFLANNIndex() {}
+
+const FeatureDescriptors& SiftFLANNIndex::Descriptors() const {
+  return *impl_->descriptors;
+}
+
+void SiftFLANNIndex::Search(const FeatureDescriptors& query,
+                            const int num_threads, IndexMatrix* indices,
+                            IndexMatrix* distances) const {
+  const size_t kNumNearestNeighbors = 2;
+
+  const FeatureDescriptors& database = *impl_->descriptors;
+  const size_t num_neighbors =
+      std::min(kNumNearestNeighbors, static_cast<size_t>(database.rows()));
+
+  indices->resize(query.rows(), num_neighbors);
+  distances->resize(query.rows(), num_neighbors);
+
+  if (query.rows() == 0 || database.rows() == 0) {
+    return;
+  }
+
+  CHECK_EQ(query.cols(), 128);
+
+  auto SearchChunk = [&](const Eigen::Index begin, const Eigen::Index end) {
+    const size_t num_queries = static_cast<size_t>(end - begin);
+    const flann::Matrix<uint8_t> query_matrix(
+        const_cast<uint8_t*>(query.data()) + 128 * begin, num_queries, 128);
+    flann::Matrix<int> indices_matrix(indices->data() + num_neighbors * begin,
+                                      num_queries, num_neighbors);
+    std::vector<float> distances_vector(num_queries * num_neighbors);
+    flann::Matrix<float> distances_matrix(distances_vector.data(), num_queries,
+                                          num_neighbors);
+    impl_->index->knnSearch(query_matrix, indices_matrix, distances_matrix,
+                            num_neighbors, flann::SearchParams(128));
+
+    for (Eigen::Index query_index = begin; query_index < end; ++query_index) {
+      for (Eigen::Index k = 0; k < indices->cols(); ++k) {
+        const Eigen::Index database_index = indices->coeff(query_index, k);
+        distances->coeffRef(query_index, k) =
+            query.row(query_index)
+                .cast<int>()
+                .dot(database.row(database_index).cast<int>());
+      }
+    }
+  };
+
+  const int num_chunks = static_cast<int>(
+      std::min(static_cast<Eigen::Index>(GetEffectiveNumThreads(num_threads)),
+               query.rows()));
+  if (num_chunks <= 1) {
+    SearchChunk(0, query.rows());
+    return;
+  }
+
+  ThreadPool thread_pool(num_chunks);
+  std::vector<std::future<void>> futures;
+  futures.reserve(num_chunks);
+  for (int i = 0; i < num_chunks; ++i) {
+    const Eigen::Index begin = i * query.rows() / num_chunks;
+    const Eigen::Index end = (i + 1) * query.rows() / num_chunks;
+    futures.push_back(thread_pool.AddTask(SearchChunk, begin, end));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+}
+
 bool SiftExtractionOptions::Check() const {
   if (use_gpu) {
-    CHECK_OPTION_GT(CSVToVector<int>(gpu_index).size(), 0);
+    const std::vector<int> gpu_indices = CSVToVector<int>(gpu_index);
+    CHECK_OPTION_GT(gpu_indices.size(), 0);
+    const std::vector<int> num_contexts = CSVToVector<int>(num_gpu_contexts);
+    CHECK_OPTION_GT(num_contexts.size(), 0);
+    if (num_contexts.size() > 1) {
+      CHECK_OPTION_EQ(num_contexts.size(), gpu_indices.size());
+    }
+    for (const int num_gpu_contexts : num_contexts) {
+      CHECK_OPTION_GT(num_gpu_contexts, 0);
+    }
   }
+  CHECK_OPTION_NE(num_intra_image_threads, 0);
+  CHECK_OPTION_NE(num_decode_threads, 0);
+  CHECK_OPTION_GT(decode_queue_size, 0);
+  CHECK_OPTION_GT(queue_size, 0);
   CHECK_OPTION_GT(max_image_size, 0);
+  CHECK_OPTION_GE(tile_size, 0);
+  if (tile_size > 0) {
+    CHECK_OPTION_GE(tile_overlap, 0);
+    CHECK_OPTION_LE(tile_size + 2 * tile_overlap, max_image_size);
+  }
   CHECK_OPTION_GT(max_num_features, 0);
   CHECK_OPTION_GT(octave_resolution, 0);
   CHECK_OPTION_GT(peak_threshold, 0.0);
@@ -397,6 +706,11 @@ bool SiftMatchingOptions::Check() const {
   CHECK_OPTION_GE(min_inlier_ratio, 0);
   CHECK_OPTION_LE(min_inlier_ratio, 1);
   CHECK_OPTION_GE(min_num_inliers, 0);
+  CHECK_OPTION_GE(gpu_descriptor_cache_size, 0);
+  CHECK_OPTION_NE(num_intra_pair_threads, 0);
+  CHECK_OPTION_GE(fast_verification_min_inlier_ratio, 0);
+  CHECK_OPTION_LE(fast_verification_min_inlier_ratio, 1);
+  CHECK_OPTION_GT(fast_verification_max_num_trials, 0);
   return true;
 }
 
@@ -426,6 +740,13 @@ bool ExtractSiftFeaturesCPU(const SiftExtractionOptions& options,
   vl_sift_set_peak_thresh(sift.get(), options.peak_threshold);
   vl_sift_set_edge_thresh(sift.get(), options.edge_threshold);
 
+  std::unique_ptr<ThreadPool> thread_pool;
+  const int num_intra_image_threads =
+      GetEffectiveNumThreads(options.num_intra_image_threads);
+  if (num_intra_image_threads > 1) {
+    thread_pool.reset(new ThreadPool(num_intra_image_threads));
+  }
+
   // Iterate through octaves.
   std::vector<size_t> level_num_features;
   std::vector<FeatureKeypoints> level_keypoints;
@@ -458,33 +779,19 @@ bool ExtractSiftFeaturesCPU(const SiftExtractionOptions& options,
       continue;
     }
 
-    // Extract features with different orientations per DOG level.
-    size_t level_idx = 0;
-    int prev_level = -1;
-    for (int i = 0; i < num_keypoints; ++i) {
-      if (vl_keypoints[i].is != prev_level) {
-        if (i > 0) {
-          // Resize containers of previous DOG level.
-          level_keypoints.back().resize(level_idx);
-          if (descriptors != nullptr) {
-            level_descriptors.back().conservativeResize(level_idx, 128);
-          }
-        }
-
-        // Add containers for new DOG level.
-        level_idx = 0;
-        level_num_features.push_back(0);
-        level_keypoints.emplace_back(options.max_num_orientations *
-                                     num_keypoints);
-        if (descriptors != nullptr) {
-          level_descriptors.emplace_back(
-              options.max_num_orientations * num_keypoints, 128);
-        }
-      }
-
-      level_num_features.back() += 1;
-      prev_level = vl_keypoints[i].is;
+    // Extract the features with different orientations for all keypoints of
+    // the octave. The features of the i-th keypoint are stored in the slots
+    // starting at i * max_num_orientations.
+    std::vector<int> octave_num_orientations(num_keypoints, 0);
+    FeatureKeypoints octave_keypoints(options.max_num_orientations *
+                                      num_keypoints);
+    FeatureDescriptors octave_descriptors;
+    if (descriptors != nullptr) {
+      octave_descriptors.resize(options.max_num_orientations * num_keypoints,
+                                128);
+    }
 
+    auto ExtractKeypointFeatures = [&](const int i) {
       // Extract feature orientations.
       double angles[4];
       int num_orientations;
@@ -501,9 +808,11 @@ bool ExtractSiftFeaturesCPU(const SiftExtractionOptions& options,
       // local maxima. It is not clear which procedure is better.
       const int num_used_orientations =
           std::min(num_orientations, options.max_num_orientations);
+      octave_num_orientations[i] = num_used_orientations;
 
       for (int o = 0; o < num_used_orientations; ++o) {
-        level_keypoints.back()[level_idx] =
+        const int idx = i * options.max_num_orientations + o;
+        octave_keypoints[idx] =
             FeatureKeypoint(vl_keypoints[i].x + 0.5f, vl_keypoints[i].y + 0.5f,
                             vl_keypoints[i].sigma, angles[o]);
         if (descriptors != nullptr) {
@@ -520,18 +829,79 @@ bool ExtractSiftFeaturesCPU(const SiftExtractionOptions& options,
             LOG(FATAL) << "Normalization type not supported";
           }
 
-          level_descriptors.back().row(level_idx) =
-              FeatureDescriptorsToUnsignedByte(desc);
+          octave_descriptors.row(idx) = FeatureDescriptorsToUnsignedByte(desc);
         }
+      }
+    };
 
-        level_idx += 1;
+    // The gradients of the octave are lazily computed by VLFeat for the first
+    // keypoint inside the image bounds. Afterwards, the orientations and
+    // descriptors only read from the filter and can be computed concurrently.
+    int keypoint_idx = 0;
+    for (; keypoint_idx < num_keypoints && sift->grad_o != sift->o_cur;
+         ++keypoint_idx) {
+      ExtractKeypointFeatures(keypoint_idx);
+    }
+
+    if (thread_pool && keypoint_idx < num_keypoints) {
+      const int kNumChunksPerThread = 4;
+      const int num_remaining_keypoints = num_keypoints - keypoint_idx;
+      const int num_chunks = std::min(
+          num_remaining_keypoints,
+          kNumChunksPerThread * static_cast<int>(thread_pool->NumThreads()));
+      const int chunk_size =
+          (num_remaining_keypoints + num_chunks - 1) / num_chunks;
+      std::vector<std::future<void>> futures;
+      futures.reserve(num_chunks);
+      for (int begin = keypoint_idx; begin < num_keypoints;
+           begin += chunk_size) {
+        const int end = std::min(num_keypoints, begin + chunk_size);
+        futures.push_back(thread_pool->AddTask([&, begin, end]() {
+          for (int k = begin; k < end; ++k) {
+            ExtractKeypointFeatures(k);
+          }
+        }));
+      }
+      for (auto& future : futures) {
+        future.get();
+      }
+    } else {
+      for (; keypoint_idx < num_keypoints; ++keypoint_idx) {
+        ExtractKeypointFeatures(keypoint_idx);
       }
     }
 
-    // Resize containers for last DOG level in octave.
-    level_keypoints.back().resize(level_idx);
-    if (descriptors != nullptr) {
-      level_descriptors.back().conservativeResize(level_idx, 128);
+    // Group the extracted features per DOG level.
+    int prev_level = -1;
+    for (int i = 0; i < num_keypoints; ++i) {
+      if (vl_keypoints[i].is != prev_level) {
+        int num_level_features = 0;
+        for (int j = i;
+             j < num_keypoints && vl_keypoints[j].is == vl_keypoints[i].is;
+             ++j) {
+          num_level_features += octave_num_orientations[j];
+        }
+
+        // Add containers for new DOG level.
+        level_num_features.push_back(0);
+        level_keypoints.emplace_back();
+        level_keypoints.back().reserve(num_level_features);
+        if (descriptors != nullptr) {
+          level_descriptors.emplace_back(num_level_features, 128);
+        }
+      }
+
+      level_num_features.back() += 1;
+      prev_level = vl_keypoints[i].is;
+
+      for (int o = 0; o < octave_num_orientations[i]; ++o) {
+        const int idx = i * options.max_num_orientations + o;
+        if (descriptors != nullptr) {
+          level_descriptors.back().row(level_keypoints.back().size()) =
+              octave_descriptors.row(idx);
+        }
+        level_keypoints.back().push_back(octave_keypoints[idx]);
+      }
     }
   }
 
@@ -615,20 +985,120 @@ bool ExtractCovariantSiftFeaturesCPU(const SiftExtractionOptions& options,
 
   vl_covdet_detect(covdet.get(), options.max_num_features);
 
+  std::unique_ptr<ThreadPool> thread_pool;
+  const int num_intra_image_threads =
+      GetEffectiveNumThreads(options.num_intra_image_threads);
+  if (num_intra_image_threads > 1) {
+    thread_pool.reset(new ThreadPool(num_intra_image_threads));
+  }
+
+  // The affine shapes, orientations, and descriptors of the frames only read
+  // the scale space of the detector, so they are computed concurrently in
+  // chunks of frames, where every chunk uses its own worker of the detector
+  // with separate scratch buffers.
+  const auto ProcessFrames = [&](const int num_frames,
+                                 const std::function<void(
+                                     VlCovDet* worker, int begin, int end)>&
+                                     process_func) {
+    if (!thread_pool || num_frames <= 1) {
+      process_func(covdet.get(), 0, num_frames);
+      return;
+    }
+
+    const int kNumChunksPerThread = 4;
+    const int num_chunks = std::min(
+        num_frames,
+        kNumChunksPerThread * static_cast<int>(thread_pool->NumThreads()));
+    const int chunk_size = (num_frames + num_chunks - 1) / num_chunks;
+    std::vector<std::future<void>> futures;
+    futures.reserve(num_chunks);
+    for (int begin = 0; begin < num_frames; begin += chunk_size) {
+      const int end = std::min(num_frames, begin + chunk_size);
+      futures.push_back(thread_pool->AddTask([&, begin, end]() {
+        std::unique_ptr<VlCovDet, void (*)(VlCovDet*)> worker(
+            vl_covdet_new_worker(covdet.get()), &vl_covdet_delete_worker);
+        CHECK(worker);
+        process_func(worker.get(), begin, end);
+      }));
+    }
+    for (auto& future : futures) {
+      future.get();
+    }
+  };
+
+  std::vector<VlCovDetFeature> features(
+      vl_covdet_get_features(covdet.get()),
+      vl_covdet_get_features(covdet.get()) +
+          vl_covdet_get_num_features(covdet.get()));
+
   if (!options.upright) {
+    const int num_frames = static_cast<int>(features.size());
     if (options.estimate_affine_shape) {
-      vl_covdet_extract_affine_shape(covdet.get());
+      // Same as vl_covdet_extract_affine_shape, which discards the features
+      // without a reliable affine shape.
+      std::vector<char> adapted(num_frames, false);
+      ProcessFrames(num_frames, [&](VlCovDet* worker, int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          VlFrameOrientedEllipse adapted_frame;
+          if (vl_covdet_extract_affine_shape_for_frame(
+                  worker, &adapted_frame, features[i].frame) == VL_ERR_OK) {
+            features[i].frame = adapted_frame;
+            adapted[i] = true;
+          }
+        }
+      });
+
+      size_t num_adapted = 0;
+      for (int i = 0; i < num_frames; ++i) {
+        if (adapted[i]) {
+          features[num_adapted] = features[i];
+          num_adapted += 1;
+        }
+      }
+      features.resize(num_adapted);
     } else {
-      vl_covdet_extract_orientations(covdet.get());
+      // Same as vl_covdet_extract_orientations, which rotates the frame of a
+      // feature by its first orientation and appends a rotated copy of the
+      // feature for every further orientation.
+      std::vector<std::vector<VlCovDetFeatureOrientation>> orientations(
+          num_frames);
+      ProcessFrames(num_frames, [&](VlCovDet* worker, int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          vl_size num_orientations;
+          const VlCovDetFeatureOrientation* frame_orientations =
+              vl_covdet_extract_orientations_for_frame(
+                  worker, &num_orientations, features[i].frame);
+          orientations[i].assign(frame_orientations,
+                                 frame_orientations + num_orientations);
+        }
+      });
+
+      for (int i = 0; i < num_frames; ++i) {
+        const VlFrameOrientedEllipse frame = features[i].frame;
+        for (size_t j = 0; j < orientations[i].size(); ++j) {
+          VlCovDetFeature* oriented;
+          if (j == 0) {
+            oriented = &features[i];
+          } else {
+            features.push_back(features[i]);
+            oriented = &features.back();
+          }
+
+          const double r1 = std::cos(orientations[i][j].angle);
+          const double r2 = std::sin(orientations[i][j].angle);
+          oriented->orientationScore = orientations[i][j].score;
+          oriented->frame.a11 = frame.a11 * r1 + frame.a12 * r2;
+          oriented->frame.a21 = frame.a21 * r1 + frame.a22 * r2;
+          oriented->frame.a12 = -frame.a11 * r2 + frame.a12 * r1;
+          oriented->frame.a22 = -frame.a21 * r2 + frame.a22 * r1;
+        }
+      }
     }
   }
 
-  const int num_features = vl_covdet_get_num_features(covdet.get());
-  VlCovDetFeature* features = vl_covdet_get_features(covdet.get());
-
   // Sort features according to detected octave and scale.
   std::sort(
-      features, features + num_features,
+      features.begin(), features.end(),
       [](const VlCovDetFeature& feature1, const VlCovDetFeature& feature2) {
         if (feature1.o == feature2.o) {
           return feature1.s > feature2.s;
@@ -641,7 +1111,7 @@ bool ExtractCovariantSiftFeaturesCPU(const SiftExtractionOptions& options,
 
   // Copy detected keypoints and clamp when maximum number of features reached.
   int prev_octave_scale_idx = std::numeric_limits<int>::max();
-  for (int i = 0; i < num_features; ++i) {
+  for (size_t i = 0; i < features.size(); ++i) {
     FeatureKeypoint keypoint;
     keypoint.x = features[i].frame.x + 0.5;
     keypoint.y = features[i].frame.y + 0.5;
@@ -675,9 +1145,6 @@ bool ExtractCovariantSiftFeaturesCPU(const SiftExtractionOptions& options,
     const double kSigma =
         kPatchRelativeExtent / (3.0 * (4 + 1) / 2) / kPatchStep;
 
-    std::vector<float> patch(kPatchSide * kPatchSide);
-    std::vector<float> patchXY(2 * kPatchSide * kPatchSide);
-
     float dsp_min_scale = 1;
     float dsp_scale_step = 0;
     int dsp_num_scales = 1;
@@ -688,9 +1155,8 @@ bool ExtractCovariantSiftFeaturesCPU(const SiftExtractionOptions& options,
       dsp_num_scales = options.dsp_num_scales;
     }
 
-    Eigen::Matrix<float, Eigen::Dynamic, 128, Eigen::RowMajor>
-        scaled_descriptors(dsp_num_scales, 128);
-
+    // The filter is only used to compute raw descriptors, which does not
+    // modify its state, so it is shared by all threads.
     std::unique_ptr<VlSiftFilt, void (*)(VlSiftFilt*)> sift(
         vl_sift_new(16, 16, 1, 3, 0), &vl_sift_delete);
     if (!sift) {
@@ -699,52 +1165,146 @@ bool ExtractCovariantSiftFeaturesCPU(const SiftExtractionOptions& options,
 
     vl_sift_set_magnif(sift.get(), 3.0);
 
-    for (size_t i = 0; i < keypoints->size(); ++i) {
-      for (int s = 0; s < dsp_num_scales; ++s) {
-        const double dsp_scale = dsp_min_scale + s * dsp_scale_step;
+    ProcessFrames(
+        static_cast<int>(keypoints->size()),
+        [&](VlCovDet* worker, int begin, int end) {
+          std::vector<float> patch(kPatchSide * kPatchSide);
+          std::vector<float> patchXY(2 * kPatchSide * kPatchSide);
+          Eigen::Matrix<float, Eigen::Dynamic, 128, Eigen::RowMajor>
+              scaled_descriptors(dsp_num_scales, 128);
+
+          for (int i = begin; i < end; ++i) {
+            for (int s = 0; s < dsp_num_scales; ++s) {
+              const double dsp_scale = dsp_min_scale + s * dsp_scale_step;
+
+              VlFrameOrientedEllipse scaled_frame = features[i].frame;
+              scaled_frame.a11 *= dsp_scale;
+              scaled_frame.a12 *= dsp_scale;
+              scaled_frame.a21 *= dsp_scale;
+              scaled_frame.a22 *= dsp_scale;
+
+              vl_covdet_extract_patch_for_frame(
+                  worker, patch.data(), kPatchResolution,
+                  kPatchRelativeExtent, kPatchRelativeSmoothing,
+                  scaled_frame);
+
+              vl_imgradient_polar_f(patchXY.data(), patchXY.data() + 1, 2,
+                                    2 * kPatchSide, patch.data(), kPatchSide,
+                                    kPatchSide, kPatchSide);
+
+              vl_sift_calc_raw_descriptor(
+                  sift.get(), patchXY.data(), scaled_descriptors.row(s).data(),
+                  kPatchSide, kPatchSide, kPatchResolution, kPatchResolution,
+                  kSigma, 0);
+            }
+
+            Eigen::Matrix<float, 1, 128> descriptor;
+            if (options.domain_size_pooling) {
+              descriptor = scaled_descriptors.colwise().mean();
+            } else {
+              descriptor = scaled_descriptors;
+            }
+
+            if (options.normalization ==
+                SiftExtractionOptions::Normalization::L2) {
+              descriptor = L2NormalizeFeatureDescriptors(descriptor);
+            } else if (options.normalization ==
+                       SiftExtractionOptions::Normalization::L1_ROOT) {
+              descriptor = L1RootNormalizeFeatureDescriptors(descriptor);
+            } else {
+              LOG(FATAL) << "Normalization type not supported";
+            }
+
+            descriptors->row(i) = FeatureDescriptorsToUnsignedByte(descriptor);
+          }
+        });
 
-        VlFrameOrientedEllipse scaled_frame = features[i].frame;
-        scaled_frame.a11 *= dsp_scale;
-        scaled_frame.a12 *= dsp_scale;
-        scaled_frame.a21 *= dsp_scale;
-        scaled_frame.a22 *= dsp_scale;
+    *descriptors = TransformVLFeatToUBCFeatureDescriptors(*descriptors);
+  }
 
-        vl_covdet_extract_patch_for_frame(
-            covdet.get(), patch.data(), kPatchResolution, kPatchRelativeExtent,
-            kPatchRelativeSmoothing, scaled_frame);
+  return true;
+}
 
-        vl_imgradient_polar_f(patchXY.data(), patchXY.data() + 1, 2,
-                              2 * kPatchSide, patch.data(), kPatchSide,
-                              kPatchSide, kPatchSide);
+bool ExtractTiledSiftFeatures(
+    const SiftExtractionOptions& options, const Bitmap& bitmap,
+    const std::function<bool(const Bitmap&, FeatureKeypoints*,
+                             FeatureDescriptors*)>& extract_func,
+    FeatureKeypoints* keypoints, FeatureDescriptors* descriptors) {
+  CHECK(options.Check());
+  CHECK_GT(options.tile_size, 0);
+  CHECK(extract_func);
+  CHECK_NOTNULL(keypoints);
+  CHECK_NOTNULL(descriptors);
 
-        vl_sift_calc_raw_descriptor(sift.get(), patchXY.data(),
-                                    scaled_descriptors.row(s).data(),
-                                    kPatchSide, kPatchSide, kPatchResolution,
-                                    kPatchResolution, kSigma, 0);
+  keypoints->clear();
+  descriptors->resize(0, 128);
+
+  std::vector<FeatureKeypoints> tile_keypoints;
+  std::vector<FeatureDescriptors> tile_descriptors;
+  size_t num_features = 0;
+
+  for (int y = 0; y < bitmap.Height(); y += options.tile_size) {
+    for (int x = 0; x < bitmap.Width(); x += options.tile_size) {
+      // The interior of the tile, extended by the overlap on all sides.
+      const int interior_width =
+          std::min(options.tile_size, bitmap.Width() - x);
+      const int interior_height =
+          std::min(options.tile_size, bitmap.Height() - y);
+      const int min_x = std::max(0, x - options.tile_overlap);
+      const int min_y = std::max(0, y - options.tile_overlap);
+      const int max_x =
+          std::min(bitmap.Width(), x + interior_width + options.tile_overlap);
+      const int max_y =
+          std::min(bitmap.Height(), y + interior_height + options.tile_overlap);
+
+      FeatureKeypoints curr_keypoints;
+      FeatureDescriptors curr_descriptors;
+      if (!extract_func(bitmap.Crop(min_x, min_y, max_x - min_x, max_y - min_y),
+                        &curr_keypoints, &curr_descriptors)) {
+        return false;
       }
 
-      Eigen::Matrix<float, 1, 128> descriptor;
-      if (options.domain_size_pooling) {
-        descriptor = scaled_descriptors.colwise().mean();
-      } else {
-        descriptor = scaled_descriptors;
+      CHECK_EQ(curr_keypoints.size(), curr_descriptors.rows());
+
+      // Only keep the features inside the interior of the tile, such that
+      // features in the overlap are not extracted multiple times.
+      FeatureKeypoints interior_keypoints;
+      interior_keypoints.reserve(curr_keypoints.size());
+      std::vector<int> interior_idxs;
+      interior_idxs.reserve(curr_keypoints.size());
+      for (size_t i = 0; i < curr_keypoints.size(); ++i) {
+        FeatureKeypoint keypoint = curr_keypoints[i];
+        keypoint.x += min_x;
+        keypoint.y += min_y;
+        if (keypoint.x >= x && keypoint.x < x + interior_width &&
+            keypoint.y >= y && keypoint.y < y + interior_height) {
+          interior_keypoints.push_back(keypoint);
+          interior_idxs.push_back(static_cast<int>(i));
+        }
       }
 
-      if (options.normalization == SiftExtractionOptions::Normalization::L2) {
-        descriptor = L2NormalizeFeatureDescriptors(descriptor);
-      } else if (options.normalization ==
-                 SiftExtractionOptions::Normalization::L1_ROOT) {
-        descriptor = L1RootNormalizeFeatureDescriptors(descriptor);
-      } else {
-        LOG(FATAL) << "Normalization type not supported";
+      FeatureDescriptors interior_descriptors(interior_idxs.size(), 128);
+      for (size_t i = 0; i < interior_idxs.size(); ++i) {
+        interior_descriptors.row(i) = curr_descriptors.row(interior_idxs[i]);
       }
 
-      descriptors->row(i) = FeatureDescriptorsToUnsignedByte(descriptor);
+      num_features += interior_keypoints.size();
+      tile_keypoints.push_back(std::move(interior_keypoints));
+      tile_descriptors.push_back(std::move(interior_descriptors));
     }
+  }
 
-    *descriptors = TransformVLFeatToUBCFeatureDescriptors(*descriptors);
+  keypoints->reserve(num_features);
+  descriptors->resize(num_features, 128);
+  for (size_t i = 0; i < tile_keypoints.size(); ++i) {
+    descriptors->middleRows(keypoints->size(), tile_keypoints[i].size()) =
+        tile_descriptors[i];
+    keypoints->insert(keypoints->end(), tile_keypoints[i].begin(),
+                      tile_keypoints[i].end());
   }
 
+  ExtractTopScaleFeatures(keypoints, descriptors, options.max_num_features);
+
   return true;
 }
 
@@ -856,31 +1416,47 @@ bool ExtractSiftFeaturesGPU(const SiftExtractionOptions& options,
   CHECK(!options.estimate_affine_shape);
   CHECK(!options.domain_size_pooling);
 
-  std::unique_lock<std::mutex> lock(
-      *sift_extraction_mutexes[sift_gpu->gpu_index]);
+  // The staging buffers are reused across the images extracted by the same
+  // thread, which owns the SiftGPU context. SiftGPU itself keeps its pyramid
+  // allocated for all images up to the largest size seen so far.
+  thread_local std::vector<uint8_t> bitmap_raw_bits;
+  thread_local std::vector<SiftKeypoint> keypoints_data;
+  thread_local std::vector<float> descriptors_data;
 
   // Note, that this produces slightly different results than using SiftGPU
   // directly for RGB->GRAY conversion, since it uses different weights.
-  const std::vector<uint8_t> bitmap_raw_bits = bitmap.ConvertToRawBits();
-  const int code =
-      sift_gpu->RunSIFT(bitmap.ScanWidth(), bitmap.Height(),
-                        bitmap_raw_bits.data(), GL_LUMINANCE, GL_UNSIGNED_BYTE);
+  bitmap.ConvertToRawBits(&bitmap_raw_bits);
 
-  const int kSuccessCode = 1;
-  if (code != kSuccessCode) {
-    return false;
-  }
+  size_t num_features;
+  {
+    // The CUDA kernels of SiftGPU bind global textures, so only one context
+    // per device can run at a time, while the conversion of the input and the
+    // normalization of the output overlap with other contexts.
+    std::unique_lock<std::mutex> lock(
+        *sift_extraction_mutexes[sift_gpu->gpu_index]);
+
+    const int code =
+        sift_gpu->RunSIFT(bitmap.ScanWidth(), bitmap.Height(),
+                          bitmap_raw_bits.data(), GL_LUMINANCE,
+                          GL_UNSIGNED_BYTE);
+
+    const int kSuccessCode = 1;
+    if (code != kSuccessCode) {
+      return false;
+    }
 
-  const size_t num_features = static_cast<size_t>(sift_gpu->GetFeatureNum());
+    num_features = static_cast<size_t>(sift_gpu->GetFeatureNum());
 
-  std::vector<SiftKeypoint> keypoints_data(num_features);
+    // Download the extracted keypoints and descriptors.
+    keypoints_data.resize(num_features);
+    descriptors_data.resize(num_features * 128);
+    sift_gpu->GetFeatureVector(keypoints_data.data(), descriptors_data.data());
+  }
 
   // Eigen's default is ColMajor, but SiftGPU stores result as RowMajor.
-  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      descriptors_float(num_features, 128);
-
-  // Download the extracted keypoints and descriptors.
-  sift_gpu->GetFeatureVector(keypoints_data.data(), descriptors_float.data());
+  Eigen::MatrixXf descriptors_float = Eigen::Map<const Eigen::Matrix<
+      float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(
+      descriptors_data.data(), num_features, 128);
 
   keypoints->resize(num_features);
   for (size_t i = 0; i < num_features; ++i) {
@@ -909,20 +1485,25 @@ void LoadSiftFeaturesFromTextFile(const std::string& path,
   CHECK_NOTNULL(keypoints);
   CHECK_NOTNULL(descriptors);
 
-  std::ifstream file(path.c_str());
+  std::ifstream file(path.c_str(), std::ios::binary);
   CHECK(file.is_open()) << path;
 
-  std::string line;
-  std::string item;
+  // Read the entire file and parse the numbers in place, which is much faster
+  // than parsing the lines through string streams.
+  const std::string text((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  const char* cursor = text.c_str();
 
-  std::getline(file, line);
-  std::stringstream header_line_stream(line);
+  const auto ParseNumber = [&]() {
+    char* end;
+    const float value = std::strtof(cursor, &end);
+    CHECK_NE(end, cursor) << "Invalid feature file: " << path;
+    cursor = end;
+    return value;
+  };
 
-  std::getline(header_line_stream >> std::ws, item, ' ');
-  const point2D_t num_features = std::stoul(item);
-
-  std::getline(header_line_stream >> std::ws, item, ' ');
-  const size_t dim = std::stoul(item);
+  const point2D_t num_features = static_cast<point2D_t>(ParseNumber());
+  const size_t dim = static_cast<size_t>(ParseNumber());
 
   CHECK_EQ(dim, 128) << "SIFT features must have 128 dimensions";
 
@@ -930,27 +1511,15 @@ void LoadSiftFeaturesFromTextFile(const std::string& path,
   descriptors->resize(num_features, dim);
 
   for (size_t i = 0; i < num_features; ++i) {
-    std::getline(file, line);
-    std::stringstream feature_line_stream(line);
-
-    std::getline(feature_line_stream >> std::ws, item, ' ');
-    const float x = std::stold(item);
-
-    std::getline(feature_line_stream >> std::ws, item, ' ');
-    const float y = std::stold(item);
-
-    std::getline(feature_line_stream >> std::ws, item, ' ');
-    const float scale = std::stold(item);
-
-    std::getline(feature_line_stream >> std::ws, item, ' ');
-    const float orientation = std::stold(item);
-
+    const float x = ParseNumber();
+    const float y = ParseNumber();
+    const float scale = ParseNumber();
+    const float orientation = ParseNumber();
     (*keypoints)[i] = FeatureKeypoint(x, y, scale, orientation);
 
     // Descriptor
     for (size_t j = 0; j < dim; ++j) {
-      std::getline(feature_line_stream >> std::ws, item, ' ');
-      const float value = std::stod(item);
+      const float value = ParseNumber();
       CHECK_GE(value, 0);
       CHECK_LE(value, 255);
       (*descriptors)(i, j) = TruncateCast<float, uint8_t>(value);
@@ -958,6 +1527,63 @@ void LoadSiftFeaturesFromTextFile(const std::string& path,
   }
 }
 
+void LoadSiftFeaturesFromBinaryFile(const std::string& path,
+                                    FeatureKeypoints* keypoints,
+                                    FeatureDescriptors* descriptors) {
+  CHECK_NOTNULL(keypoints);
+  CHECK_NOTNULL(descriptors);
+
+  std::ifstream file(path.c_str(), std::ios::binary);
+  CHECK(file.is_open()) << path;
+
+  const size_t num_features = ReadBinaryLittleEndian<uint64_t>(&file);
+  const size_t dim = ReadBinaryLittleEndian<uint64_t>(&file);
+  CHECK_EQ(dim, 128) << "SIFT features must have 128 dimensions";
+
+  std::vector<float> keypoints_data(6 * num_features);
+  file.read(reinterpret_cast<char*>(keypoints_data.data()),
+            keypoints_data.size() * sizeof(float));
+  keypoints->resize(num_features);
+  for (size_t i = 0; i < num_features; ++i) {
+    const float* keypoint_data = &keypoints_data[6 * i];
+    (*keypoints)[i] = FeatureKeypoint(LittleEndianToNative(keypoint_data[0]),
+                                      LittleEndianToNative(keypoint_data[1]),
+                                      LittleEndianToNative(keypoint_data[2]),
+                                      LittleEndianToNative(keypoint_data[3]),
+                                      LittleEndianToNative(keypoint_data[4]),
+                                      LittleEndianToNative(keypoint_data[5]));
+  }
+
+  descriptors->resize(num_features, dim);
+  file.read(reinterpret_cast<char*>(descriptors->data()),
+            descriptors->size());
+
+  CHECK(file) << "Invalid feature file: " << path;
+}
+
+void WriteSiftFeaturesToBinaryFile(const std::string& path,
+                                   const FeatureKeypoints& keypoints,
+                                   const FeatureDescriptors& descriptors) {
+  CHECK_EQ(keypoints.size(), descriptors.rows());
+  CHECK_EQ(descriptors.cols(), 128);
+
+  std::ofstream file(path.c_str(), std::ios::trunc | std::ios::binary);
+  CHECK(file.is_open()) << path;
+
+  WriteBinaryLittleEndian<uint64_t>(&file, keypoints.size());
+  WriteBinaryLittleEndian<uint64_t>(&file, descriptors.cols());
+  for (const auto& keypoint : keypoints) {
+    WriteBinaryLittleEndian<float>(&file, keypoint.x);
+    WriteBinaryLittleEndian<float>(&file, keypoint.y);
+    WriteBinaryLittleEndian<float>(&file, keypoint.a11);
+    WriteBinaryLittleEndian<float>(&file, keypoint.a12);
+    WriteBinaryLittleEndian<float>(&file, keypoint.a21);
+    WriteBinaryLittleEndian<float>(&file, keypoint.a22);
+  }
+  file.write(reinterpret_cast<const char*>(descriptors.data()),
+             descriptors.size());
+}
+
 void MatchSiftFeaturesCPUBruteForce(const SiftMatchingOptions& match_options,
                                     const FeatureDescriptors& descriptors1,
                                     const FeatureDescriptors& descriptors2,
@@ -965,41 +1591,74 @@ void MatchSiftFeaturesCPUBruteForce(const SiftMatchingOptions& match_options,
   CHECK(match_options.Check());
   CHECK_NOTNULL(matches);
 
-  const Eigen::MatrixXi distances = ComputeSiftDistanceMatrix(
-      nullptr, nullptr, descriptors1, descriptors2, nullptr);
+  FindBestMatchesBruteForce(
+      descriptors1, descriptors2, match_options.max_ratio,
+      match_options.max_distance, match_options.cross_check,
+      match_options.use_prosac, matches);
+}
 
-  FindBestMatchesBruteForce(distances, match_options.max_ratio,
-                            match_options.max_distance,
-                            match_options.cross_check, matches);
+void MatchSiftFeaturesCPUPQ(const SiftMatchingOptions& match_options,
+                            const FeatureDescriptorCodebook& codebook,
+                            const FeatureDescriptors& descriptors1,
+                            const FeatureDescriptors& codes1,
+                            const FeatureDescriptors& descriptors2,
+                            const FeatureDescriptors& codes2,
+                            const int num_candidates,
+                            FeatureMatches* matches) {
+  CHECK(match_options.Check());
+  CHECK_GT(num_candidates, 0);
+  CHECK_NOTNULL(matches);
+
+  std::vector<SiftBestMatch> best_matches12;
+  std::vector<SiftBestMatch> best_matches21;
+  FindBestMatchesOneWayPQ(codebook, descriptors1, descriptors2, codes2,
+                          num_candidates, &best_matches12);
+  if (match_options.cross_check) {
+    FindBestMatchesOneWayPQ(codebook, descriptors2, descriptors1, codes1,
+                            num_candidates, &best_matches21);
+  }
+
+  SelectBestMatches(best_matches12, best_matches21, match_options.max_ratio,
+                    match_options.max_distance, match_options.cross_check,
+                    match_options.use_prosac, matches);
 }
 
 void MatchSiftFeaturesCPUFLANN(const SiftMatchingOptions& match_options,
                                const FeatureDescriptors& descriptors1,
                                const FeatureDescriptors& descriptors2,
                                FeatureMatches* matches) {
+  // The indices only reference the descriptors for the duration of the call.
+  const auto NoDelete = [](const FeatureDescriptors*) {};
+  const SiftFLANNIndex index1(
+      std::shared_ptr<const FeatureDescriptors>(&descriptors1, NoDelete));
+  const SiftFLANNIndex index2(
+      std::shared_ptr<const FeatureDescriptors>(&descriptors2, NoDelete));
+  MatchSiftFeaturesCPUFLANN(match_options, index1, index2, matches);
+}
+
+void MatchSiftFeaturesCPUFLANN(const SiftMatchingOptions& match_options,
+                               const SiftFLANNIndex& index1,
+                               const SiftFLANNIndex& index2,
+                               FeatureMatches* matches) {
   CHECK(match_options.Check());
   CHECK_NOTNULL(matches);
 
-  Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      indices_1to2;
-  Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      distances_1to2;
-  Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      indices_2to1;
-  Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      distances_2to1;
+  SiftFLANNIndex::IndexMatrix indices_1to2;
+  SiftFLANNIndex::IndexMatrix distances_1to2;
+  SiftFLANNIndex::IndexMatrix indices_2to1;
+  SiftFLANNIndex::IndexMatrix distances_2to1;
 
-  FindBestMatchesOneWayFLANN(descriptors1, descriptors2, &indices_1to2,
-                             &distances_1to2);
+  index2.Search(index1.Descriptors(), match_options.num_intra_pair_threads,
+                &indices_1to2, &distances_1to2);
   if (match_options.cross_check) {
-    FindBestMatchesOneWayFLANN(descriptors2, descriptors1, &indices_2to1,
-                               &distances_2to1);
+    index1.Search(index2.Descriptors(), match_options.num_intra_pair_threads,
+                  &indices_2to1, &distances_2to1);
   }
 
   FindBestMatchesFLANN(indices_1to2, distances_1to2, indices_2to1,
                        distances_2to1, match_options.max_ratio,
                        match_options.max_distance, match_options.cross_check,
-                       matches);
+                       match_options.use_prosac, matches);
 }
 
 void MatchSiftFeaturesCPU(const SiftMatchingOptions& match_options,
@@ -1078,7 +1737,7 @@ void MatchGuidedSiftFeaturesCPU(const SiftMatchingOptions& match_options,
   FindBestMatchesFLANN(indices_1to2, distances_1to2, indices_2to1,
                        distances_2to1, match_options.max_ratio,
                        match_options.max_distance, match_options.cross_check,
-                       &two_view_geometry->inlier_matches);
+                       false, &two_view_geometry->inlier_matches);
 }
 
 bool CreateSiftGPUMatcher(const SiftMatchingOptions& match_options,
@@ -1136,6 +1795,9 @@ bool CreateSiftGPUMatcher(const SiftMatchingOptions& match_options,
   }
 #endif  // CUDA_ENABLED
 
+  sift_match_gpu->SetDescriptorCacheSize(static_cast<size_t>(
+      1024.0 * 1024.0 * 1024.0 * match_options.gpu_descriptor_cache_size));
+
   sift_match_gpu->gpu_index = gpu_indices[0];
   if (sift_matching_mutexes.count(gpu_indices[0]) == 0) {
     sift_matching_mutexes.emplace(
@@ -1145,6 +1807,45 @@ bool CreateSiftGPUMatcher(const SiftMatchingOptions& match_options,
   return true;
 }
 
+void UploadSiftDescriptorsGPU(const int index, const image_t image_id,
+                              const FeatureDescriptors& descriptors,
+                              SiftMatchGPU* sift_match_gpu) {
+  CHECK_GE(index, 0);
+  CHECK_LE(index, 1);
+  CHECK_NOTNULL(sift_match_gpu);
+  CHECK_EQ(descriptors.cols(), 128);
+
+  std::unique_lock<std::mutex> lock(
+      *sift_matching_mutexes[sift_match_gpu->gpu_index]);
+
+  WarnIfMaxNumMatchesReachedGPU(*sift_match_gpu, descriptors);
+  sift_match_gpu->SetDescriptors(index, descriptors.rows(), descriptors.data(),
+                                 static_cast<int>(image_id));
+}
+
+bool SetCachedSiftDescriptorsGPU(const int index, const image_t image_id,
+                                 SiftMatchGPU* sift_match_gpu) {
+  CHECK_GE(index, 0);
+  CHECK_LE(index, 1);
+  CHECK_NOTNULL(sift_match_gpu);
+
+  std::unique_lock<std::mutex> lock(
+      *sift_matching_mutexes[sift_match_gpu->gpu_index]);
+
+  return sift_match_gpu->SetCachedDescriptors(index,
+                                              static_cast<int>(image_id));
+}
+
+void EvictCachedSiftDescriptorsGPU(const image_t image_id,
+                                   SiftMatchGPU* sift_match_gpu) {
+  CHECK_NOTNULL(sift_match_gpu);
+
+  std::unique_lock<std::mutex> lock(
+      *sift_matching_mutexes[sift_match_gpu->gpu_index]);
+
+  sift_match_gpu->EvictCachedDescriptors(static_cast<int>(image_id));
+}
+
 void MatchSiftFeaturesGPU(const SiftMatchingOptions& match_options,
                           const FeatureDescriptors* descriptors1,
                           const FeatureDescriptors* descriptors2,
@@ -1219,11 +1920,13 @@ void MatchGuidedSiftFeaturesGPU(const SiftMatchingOptions& match_options,
     CHECK_EQ(descriptors1->rows(), keypoints1->size());
     CHECK_EQ(descriptors1->cols(), 128);
     WarnIfMaxNumMatchesReachedGPU(*sift_match_gpu, *descriptors1);
-    const size_t kIndex = 0;
-    sift_match_gpu->SetDescriptors(kIndex, descriptors1->rows(),
+    sift_match_gpu->SetDescriptors(0, descriptors1->rows(),
                                    descriptors1->data());
+  }
+
+  if (keypoints1 != nullptr) {
     sift_match_gpu->SetFeautreLocation(
-        kIndex, reinterpret_cast<const float*>(keypoints1->data()),
+        0, reinterpret_cast<const float*>(keypoints1->data()),
         kFeatureShapeNumElems);
   }
 
@@ -1232,11 +1935,13 @@ void MatchGuidedSiftFeaturesGPU(const SiftMatchingOptions& match_options,
     CHECK_EQ(descriptors2->rows(), keypoints2->size());
     CHECK_EQ(descriptors2->cols(), 128);
     WarnIfMaxNumMatchesReachedGPU(*sift_match_gpu, *descriptors2);
-    const size_t kIndex = 1;
-    sift_match_gpu->SetDescriptors(kIndex, descriptors2->rows(),
+    sift_match_gpu->SetDescriptors(1, descriptors2->rows(),
                                    descriptors2->data());
+  }
+
+  if (keypoints2 != nullptr) {
     sift_match_gpu->SetFeautreLocation(
-        kIndex, reinterpret_cast<const float*>(keypoints2->data()),
+        1, reinterpret_cast<const float*>(keypoints2->data()),
         kFeatureShapeNumElems);
   }
 
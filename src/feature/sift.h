@@ -32,6 +32,9 @@
 #ifndef COLMAP_SRC_FEATURE_SIFT_H_
 #define COLMAP_SRC_FEATURE_SIFT_H_
 
+#include <functional>
+#include <memory>
+
 #include "estimators/two_view_geometry.h"
 #include "feature/types.h"
 #include "util/bitmap.h"
@@ -41,10 +44,32 @@ class SiftMatchGPU;
 
 namespace colmap {
 
+struct FeatureDescriptorCodebook;
+
 struct SiftExtractionOptions {
   // Number of threads for feature extraction.
   int num_threads = -1;
 
+  // Number of threads used to compute the orientations and descriptors within
+  // a single image in the CPU extraction, including the affine shapes and the
+  // domain-size pooled descriptors of the covariant extraction. This allows
+  // to use all cores for a few large images, while the memory is bounded by
+  // the number of images extracted concurrently, e.g., by setting num_threads
+  // to a small number.
+  int num_intra_image_threads = 1;
+
+  // Number of threads used to decode the images ahead of the extraction,
+  // which can otherwise be the bottleneck for fast GPU extraction.
+  int num_decode_threads = -1;
+
+  // Maximum number of images that are decoded ahead of the extraction. The
+  // memory usage grows linearly with the number of decoded images.
+  int decode_queue_size = 8;
+
+  // Maximum number of images in the queues between the resize, extraction,
+  // and write stages of the pipeline.
+  int queue_size = 1;
+
   // Whether to use the GPU for feature extraction.
   bool use_gpu = true;
 
@@ -52,9 +77,32 @@ struct SiftExtractionOptions {
   // you should separate multiple GPU indices by comma, e.g., "0,1,2,3".
   std::string gpu_index = "-1";
 
+  // Number of concurrent SiftGPU contexts per GPU, either a single value for
+  // all GPUs or one comma-separated value per GPU in gpu_index, e.g., "2,1".
+  // The GPU kernels of the contexts on one device are serialized, but the
+  // upload, readback, and descriptor normalization of one image overlap with
+  // the extraction of another image, which keeps a fast GPU busy.
+  std::string num_gpu_contexts = "1";
+
+  // Whether to decode JPEG images on the GPU using nvJPEG, if the GPU is used
+  // for feature extraction and nvJPEG support is enabled in the build. Only
+  // the header and meta data of the images are then read on the CPU.
+  bool use_gpu_decode = false;
+
   // Maximum image size, otherwise image will be down-scaled.
   int max_image_size = 3200;
 
+  // Tile size for the extraction of very large images. If positive, images
+  // are not down-scaled to the maximum image size but features are extracted
+  // independently in overlapping tiles, which bounds the memory of the
+  // extraction by the tile size instead of the image size. The tile size plus
+  // twice the overlap must not exceed the maximum image size.
+  int tile_size = 0;
+
+  // Overlap in pixels between neighboring tiles, which should be larger than
+  // the support region of the largest-scale features that should be kept.
+  int tile_overlap = 128;
+
   // Maximum number of features to detect, keeping larger-scale features.
   int max_num_features = 8192;
 
@@ -110,6 +158,16 @@ struct SiftExtractionOptions {
   };
   Normalization normalization = Normalization::L1_ROOT;
 
+  // Whether to store the affine shape of keypoints in half precision in the
+  // database. Keypoint locations are always stored in full precision.
+  bool half_precision_keypoints = false;
+
+  // Optional path to a directory, in which the extracted features are cached
+  // by the content of the images and the extraction options, see
+  // `FeatureCache`. Images with cached features are not extracted again, even
+  // if they were renamed or are imported into a different database.
+  std::string feature_cache_path = "";
+
   bool Check() const;
 };
 
@@ -117,6 +175,16 @@ struct SiftMatchingOptions {
   // Number of threads for feature matching and geometric verification.
   int num_threads = -1;
 
+  // Number of threads used to search the nearest neighbors of a single image
+  // pair in the CPU matching. By default, image pairs are only matched in
+  // parallel by the num_threads matchers.
+  int num_intra_pair_threads = 1;
+
+  // Whether to distribute the CPU matcher and verifier threads evenly over the
+  // NUMA nodes of the system and bind them to their nodes. The keypoints and
+  // descriptors loaded by a thread are then allocated on its node.
+  bool numa_aware = false;
+
   // Whether to use the GPU for feature matching.
   bool use_gpu = true;
 
@@ -124,6 +192,13 @@ struct SiftMatchingOptions {
   // you should separate multiple GPU indices by comma, e.g., "0,1,2,3".
   std::string gpu_index = "-1";
 
+  // Whether to match on the GPU with exact brute-force search, where the
+  // descriptor dot products are computed as an 8-bit integer matrix product
+  // on the tensor cores, instead of with SiftGPU. This is not limited by
+  // max_num_matches and supports use_prosac. Guided matching still uses
+  // SiftGPU. Only available if compiled with CUDA.
+  bool use_tensor_core_matching = false;
+
   // Maximum distance ratio between first and second best match.
   double max_ratio = 0.8;
 
@@ -151,6 +226,35 @@ struct SiftMatchingOptions {
   // number of iterations.
   double min_inlier_ratio = 0.25;
 
+  // Whether to reject hopeless RANSAC hypotheses early with the Sequential
+  // Probability Ratio Test, which speeds up the verification of image pairs
+  // with low inlier ratios.
+  bool use_sprt = false;
+
+  // Whether to sort the matches by their ratio test score and to sample the
+  // most distinctive matches first with PROSAC during geometric verification.
+  // Only the CPU and tensor core matchers can sort the matches, since SiftGPU
+  // does not report the scores, so this should be combined with use_gpu=false
+  // or use_tensor_core_matching=true.
+  bool use_prosac = false;
+
+  // Whether to evaluate the RANSAC hypotheses of geometric verification in
+  // batches on the GPU. Only available if compiled with CUDA.
+  bool use_gpu_verification = false;
+
+  // Whether to solve the minimal samples of the essential matrix with the
+  // faster Sturm sequence variant of the five-point algorithm.
+  bool use_sturm_five_point = false;
+
+  // Whether to accept calibrated image pairs after only estimating an
+  // essential matrix with at most `fast_verification_max_num_trials` trials,
+  // if its inlier ratio is at least `fast_verification_min_inlier_ratio`.
+  // This skips the planar and panoramic checks and is mainly intended for
+  // sequential matching of video frames.
+  bool fast_verification = false;
+  double fast_verification_min_inlier_ratio = 0.8;
+  int fast_verification_max_num_trials = 50;
+
   // Minimum number of inliers for an image pair to be considered as
   // geometrically verified.
   int min_num_inliers = 15;
@@ -161,6 +265,18 @@ struct SiftMatchingOptions {
   // Whether to perform guided matching, if geometric verification succeeds.
   bool guided_matching = false;
 
+  // Cache size in gigabytes for descriptors that are kept on the GPU after
+  // being uploaded once. The descriptors are evicted in least-recently-used
+  // order, as in the feature matcher cache, and each image consumes 128 bytes
+  // per feature. Set to 0 to disable the cache. Only supported for CUDA.
+  double gpu_descriptor_cache_size = 0.5;
+
+  // Whether to store the matches and inlier matches in the database delta
+  // and variable-length encoded and compressed with zlib, if available, which
+  // reduces the size of the database and the time to load it. Note that the
+  // matches of an image pair are then stored in sorted order.
+  bool compress_matches = false;
+
   bool Check() const;
 };
 
@@ -174,6 +290,17 @@ bool ExtractCovariantSiftFeaturesCPU(const SiftExtractionOptions& options,
                                      FeatureKeypoints* keypoints,
                                      FeatureDescriptors* descriptors);
 
+// Extract features from overlapping tiles of the given image using the given
+// extraction function for the individual tiles. Features in the overlap of
+// multiple tiles are only kept for the tile whose interior contains them.
+// After merging the tiles, the max_num_features largest-scale features are
+// kept.
+bool ExtractTiledSiftFeatures(
+    const SiftExtractionOptions& options, const Bitmap& bitmap,
+    const std::function<bool(const Bitmap&, FeatureKeypoints*,
+                             FeatureDescriptors*)>& extract_func,
+    FeatureKeypoints* keypoints, FeatureDescriptors* descriptors);
+
 // Create a SiftGPU feature extractor. The same SiftGPU instance can be used to
 // extract features for multiple images. Note a OpenGL context must be made
 // current in the thread of the caller. If the gpu_index is not -1, the CUDA
@@ -210,6 +337,50 @@ void LoadSiftFeaturesFromTextFile(const std::string& path,
                                   FeatureKeypoints* keypoints,
                                   FeatureDescriptors* descriptors);
 
+// Load and write keypoints and descriptors in the binary format, which is
+// much faster to import for large datasets than the text format:
+//
+//    NUM_FEATURES (uint64), DIM (uint64)
+//    NUM_FEATURES x (X Y A11 A12 A21 A22) (float32)
+//    NUM_FEATURES x DIM descriptor values in row-major order (uint8)
+//
+// where all values are stored in little endian byte order and the affine
+// shape A of the keypoints is stored as in FeatureKeypoint.
+void LoadSiftFeaturesFromBinaryFile(const std::string& path,
+                                    FeatureKeypoints* keypoints,
+                                    FeatureDescriptors* descriptors);
+void WriteSiftFeaturesToBinaryFile(const std::string& path,
+                                   const FeatureKeypoints& keypoints,
+                                   const FeatureDescriptors& descriptors);
+
+// Nearest neighbor search index over the SIFT descriptors of one image using
+// a randomized KD-tree forest. Building the index is often as expensive as
+// searching it, so the index should be reused when matching the same image
+// against multiple other images. The index is safe to search concurrently.
+class SiftFLANNIndex {
+ public:
+  typedef Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      IndexMatrix;
+
+  explicit SiftFLANNIndex(
+      const std::shared_ptr<const FeatureDescriptors>& descriptors);
+  SiftFLANNIndex(SiftFLANNIndex&& other);
+  ~SiftFLANNIndex();
+
+  const FeatureDescriptors& Descriptors() const;
+
+  // Find the two nearest neighbors of all query descriptors, where the
+  // distances are returned as dot products of the descriptors. The query
+  // descriptors are split into chunks that are searched by the given number
+  // of threads.
+  void Search(const FeatureDescriptors& query, const int num_threads,
+              IndexMatrix* indices, IndexMatrix* distances) const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
 // Match the given SIFT features on the CPU.
 void MatchSiftFeaturesCPUBruteForce(const SiftMatchingOptions& match_options,
                                     const FeatureDescriptors& descriptors1,
@@ -219,6 +390,10 @@ void MatchSiftFeaturesCPUFLANN(const SiftMatchingOptions& match_options,
                                const FeatureDescriptors& descriptors1,
                                const FeatureDescriptors& descriptors2,
                                FeatureMatches* matches);
+void MatchSiftFeaturesCPUFLANN(const SiftMatchingOptions& match_options,
+                               const SiftFLANNIndex& index1,
+                               const SiftFLANNIndex& index2,
+                               FeatureMatches* matches);
 void MatchSiftFeaturesCPU(const SiftMatchingOptions& match_options,
                           const FeatureDescriptors& descriptors1,
                           const FeatureDescriptors& descriptors2,
@@ -230,6 +405,21 @@ void MatchGuidedSiftFeaturesCPU(const SiftMatchingOptions& match_options,
                                 const FeatureDescriptors& descriptors2,
                                 TwoViewGeometry* two_view_geometry);
 
+// Match the given SIFT features on the CPU using product quantization. The
+// codes must be computed from the descriptors with EncodeFeatureDescriptors
+// and the given codebook. For each feature, the `num_candidates` nearest
+// features in the other image according to the asymmetric distance between
+// descriptor and codes are re-ranked using the full descriptors, which avoids
+// computing the exact distances to all features.
+void MatchSiftFeaturesCPUPQ(const SiftMatchingOptions& match_options,
+                            const FeatureDescriptorCodebook& codebook,
+                            const FeatureDescriptors& descriptors1,
+                            const FeatureDescriptors& codes1,
+                            const FeatureDescriptors& descriptors2,
+                            const FeatureDescriptors& codes2,
+                            const int num_candidates,
+                            FeatureMatches* matches);
+
 // Create a SiftGPU feature matcher. Note that if CUDA is not available or the
 // gpu_index is -1, the OpenGLContextManager must be created in the main thread
 // of the Qt application before calling this function. The same SiftMatchGPU
@@ -237,6 +427,25 @@ void MatchGuidedSiftFeaturesCPU(const SiftMatchingOptions& match_options,
 bool CreateSiftGPUMatcher(const SiftMatchingOptions& match_options,
                           SiftMatchGPU* sift_match_gpu);
 
+// Upload the descriptors of an image as the first (index = 0) or second
+// (index = 1) set of descriptors to the GPU, such that they can be matched by
+// passing NULL descriptors to `MatchSiftFeaturesGPU`. The descriptors are also
+// added to the GPU descriptor cache, if enabled.
+void UploadSiftDescriptorsGPU(const int index, const image_t image_id,
+                              const FeatureDescriptors& descriptors,
+                              SiftMatchGPU* sift_match_gpu);
+
+// Set the previously uploaded descriptors of an image from the GPU descriptor
+// cache as the first or second set of descriptors without uploading them
+// again. Returns false, if the descriptors of the image are not cached.
+bool SetCachedSiftDescriptorsGPU(const int index, const image_t image_id,
+                                 SiftMatchGPU* sift_match_gpu);
+
+// Remove the descriptors of an image from the GPU descriptor cache, e.g., once
+// it is not matched anymore, so that the cache retains the images that are.
+void EvictCachedSiftDescriptorsGPU(const image_t image_id,
+                                   SiftMatchGPU* sift_match_gpu);
+
 // Match the given SIFT features on the GPU. If either of the descriptors is
 // NULL, the keypoints/descriptors will not be uploaded and the previously
 // uploaded descriptors will be reused for the matching.
@@ -245,6 +454,13 @@ void MatchSiftFeaturesGPU(const SiftMatchingOptions& match_options,
                           const FeatureDescriptors* descriptors2,
                           SiftMatchGPU* sift_match_gpu,
                           FeatureMatches* matches);
+
+// Match the given SIFT features on the GPU using the given two-view geometry
+// to filter the candidate matches on the device. If only the descriptors of
+// an image are NULL, only its keypoint locations are uploaded and combined
+// with the previously set descriptors, e.g., by UploadSiftDescriptorsGPU or
+// SetCachedSiftDescriptorsGPU. If both are NULL, the previously uploaded
+// keypoints and descriptors are reused.
 void MatchGuidedSiftFeaturesGPU(const SiftMatchingOptions& match_options,
                                 const FeatureKeypoints* keypoints1,
                                 const FeatureKeypoints* keypoints2,
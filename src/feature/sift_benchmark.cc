@@ -0,0 +1,137 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "feature/sift.h"
+#include "feature/utils.h"
+#include "util/bitmap.h"
+#include "util/random.h"
+
+using namespace colmap;
+
+namespace {
+
+// Image with blobs of random size and intensity, which produce SIFT features
+// at multiple scales.
+Bitmap CreateRandomBlobBitmap(const int width, const int height) {
+  Bitmap bitmap;
+  bitmap.Allocate(width, height, false);
+  bitmap.Fill(BitmapColor<uint8_t>(128));
+  const int num_blobs = width * height / 500;
+  for (int i = 0; i < num_blobs; ++i) {
+    const int x0 = RandomInteger(0, width - 1);
+    const int y0 = RandomInteger(0, height - 1);
+    const int radius = RandomInteger(2, 20);
+    const uint8_t intensity = static_cast<uint8_t>(RandomInteger(0, 255));
+    for (int y = std::max(0, y0 - radius);
+         y < std::min(height, y0 + radius + 1); ++y) {
+      for (int x = std::max(0, x0 - radius);
+           x < std::min(width, x0 + radius + 1); ++x) {
+        if ((x - x0) * (x - x0) + (y - y0) * (y - y0) <= radius * radius) {
+          bitmap.SetPixel(x, y, BitmapColor<uint8_t>(intensity));
+        }
+      }
+    }
+  }
+  return bitmap;
+}
+
+FeatureDescriptors CreateRandomDescriptors(const size_t num_features) {
+  Eigen::MatrixXf descriptors(num_features, 128);
+  for (Eigen::MatrixXf::Index i = 0; i < descriptors.size(); ++i) {
+    descriptors(i) = RandomReal(0.0f, 1.0f);
+  }
+  return FeatureDescriptorsToUnsignedByte(
+      L2NormalizeFeatureDescriptors(descriptors));
+}
+
+}  // namespace
+
+static void BM_ExtractSiftFeaturesCPU(benchmark::State& state) {
+  SetPRNGSeed(0);
+  const Bitmap bitmap = CreateRandomBlobBitmap(state.range(0), state.range(0));
+  SiftExtractionOptions options;
+  options.num_threads = 1;
+  size_t num_features = 0;
+  for (auto _ : state) {
+    FeatureKeypoints keypoints;
+    FeatureDescriptors descriptors;
+    CHECK(ExtractSiftFeaturesCPU(options, bitmap, &keypoints, &descriptors));
+    num_features = keypoints.size();
+  }
+  state.counters["num_features"] = num_features;
+}
+
+BENCHMARK(BM_ExtractSiftFeaturesCPU)
+    ->Arg(640)
+    ->Arg(1600)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_MatchSiftFeaturesCPUBruteForce(benchmark::State& state) {
+  SetPRNGSeed(0);
+  const FeatureDescriptors descriptors1 =
+      CreateRandomDescriptors(state.range(0));
+  const FeatureDescriptors descriptors2 =
+      CreateRandomDescriptors(state.range(0));
+  SiftMatchingOptions options;
+  options.num_threads = 1;
+  for (auto _ : state) {
+    FeatureMatches matches;
+    MatchSiftFeaturesCPUBruteForce(options, descriptors1, descriptors2,
+                                   &matches);
+    benchmark::DoNotOptimize(matches);
+  }
+}
+
+BENCHMARK(BM_MatchSiftFeaturesCPUBruteForce)
+    ->Arg(1000)
+    ->Arg(4000)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_MatchSiftFeaturesCPUFLANN(benchmark::State& state) {
+  SetPRNGSeed(0);
+  const FeatureDescriptors descriptors1 =
+      CreateRandomDescriptors(state.range(0));
+  const FeatureDescriptors descriptors2 =
+      CreateRandomDescriptors(state.range(0));
+  SiftMatchingOptions options;
+  options.num_threads = 1;
+  for (auto _ : state) {
+    FeatureMatches matches;
+    MatchSiftFeaturesCPUFLANN(options, descriptors1, descriptors2, &matches);
+    benchmark::DoNotOptimize(matches);
+  }
+}
+
+BENCHMARK(BM_MatchSiftFeaturesCPUFLANN)
+    ->Arg(1000)
+    ->Arg(4000)
+    ->Unit(benchmark::kMillisecond);
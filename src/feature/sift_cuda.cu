@@ -0,0 +1,427 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "feature/sift_cuda.h"
+
+#include <algorithm>
+
+#include "feature/descriptor_tile_cuda.h"
+#include "util/cudacc.h"
+#include "util/logging.h"
+
+namespace colmap {
+namespace {
+
+using namespace internal;
+
+// Same update rule as the CPU brute-force matcher, such that ties are resolved
+// in favor of the smaller index.
+struct BestMatch {
+  int best_idx;
+  int best_dist;
+  int second_best_dist;
+};
+
+__device__ void UpdateBestMatch(const int idx, const int dist,
+                                BestMatch* best_match) {
+  if (dist > best_match->best_dist) {
+    best_match->best_idx = idx;
+    best_match->second_best_dist = best_match->best_dist;
+    best_match->best_dist = dist;
+  } else if (dist > best_match->second_best_dist) {
+    best_match->second_best_dist = dist;
+  }
+}
+
+// Merge the best matches of two disjoint sets of columns. The result is the
+// same as sequentially updating the best match with all columns.
+__device__ void MergeBestMatch(const BestMatch& other, BestMatch* best_match) {
+  if (other.best_dist > best_match->best_dist ||
+      (other.best_dist == best_match->best_dist &&
+       other.best_idx < best_match->best_idx)) {
+    best_match->second_best_dist =
+        max(best_match->best_dist, other.second_best_dist);
+    best_match->best_idx = other.best_idx;
+    best_match->best_dist = other.best_dist;
+  } else {
+    best_match->second_best_dist =
+        max(best_match->second_best_dist, other.best_dist);
+  }
+}
+
+// Merge the best and second best match of the adjacent lanes that share the
+// same row or column, where the result is stored in the first lane.
+__device__ void MergeLaneBestMatches(BestMatch* best_match) {
+  for (int offset = kTileThreadsPerRow / 2; offset > 0; offset /= 2) {
+    BestMatch other;
+    other.best_idx =
+        __shfl_down_sync(0xFFFFFFFF, best_match->best_idx, offset);
+    other.best_dist =
+        __shfl_down_sync(0xFFFFFFFF, best_match->best_dist, offset);
+    other.second_best_dist =
+        __shfl_down_sync(0xFFFFFFFF, best_match->second_best_dist, offset);
+    MergeBestMatch(other, best_match);
+  }
+}
+
+// The best matches of the second set are packed into 64 bits, such that the
+// partial results of all blocks can be merged with atomic compare-and-swap.
+// The distances are at most 512^2 < 2^19 and the index is stored with an
+// offset of one in the remaining bits, so that zero is the empty best match.
+const int kPackedDistBits = 19;
+const int kMaxNumPackedIdxs = (1 << (64 - 2 * kPackedDistBits)) - 1;
+
+__device__ unsigned long long PackBestMatch(const BestMatch& best_match) {
+  return (static_cast<unsigned long long>(best_match.best_idx + 1)
+          << (2 * kPackedDistBits)) |
+         (static_cast<unsigned long long>(best_match.best_dist)
+          << kPackedDistBits) |
+         static_cast<unsigned long long>(best_match.second_best_dist);
+}
+
+__device__ BestMatch UnpackBestMatch(const unsigned long long packed) {
+  const unsigned long long kDistMask = (1ull << kPackedDistBits) - 1;
+  BestMatch best_match;
+  best_match.best_idx = static_cast<int>(packed >> (2 * kPackedDistBits)) - 1;
+  best_match.best_dist =
+      static_cast<int>((packed >> kPackedDistBits) & kDistMask);
+  best_match.second_best_dist = static_cast<int>(packed & kDistMask);
+  return best_match;
+}
+
+__device__ void AtomicMergeBestMatch(const BestMatch& other,
+                                     unsigned long long* packed) {
+  unsigned long long old_packed = *packed;
+  while (true) {
+    BestMatch best_match = UnpackBestMatch(old_packed);
+    MergeBestMatch(other, &best_match);
+    const unsigned long long new_packed = PackBestMatch(best_match);
+    if (new_packed == old_packed) {
+      return;
+    }
+    const unsigned long long assumed_packed = old_packed;
+    old_packed = atomicCAS(packed, assumed_packed, new_packed);
+    if (old_packed == assumed_packed) {
+      return;
+    }
+  }
+}
+
+// Apply the distance and ratio tests to the best match, where the match is -1
+// if the tests fail.
+__device__ void TestBestMatch(const BestMatch& best_match,
+                              const float max_ratio, const float max_distance,
+                              int* match, float* ratio) {
+  *match = -1;
+  *ratio = 1.0f;
+  if (best_match.best_idx != -1) {
+    // SIFT descriptor vectors are normalized to length 512.
+    const float kDistNorm = 1.0f / (512.0f * 512.0f);
+    const float best_dist_normed =
+        acosf(fminf(kDistNorm * best_match.best_dist, 1.0f));
+    const float second_best_dist_normed =
+        acosf(fminf(kDistNorm * best_match.second_best_dist, 1.0f));
+    if (best_dist_normed <= max_distance &&
+        best_dist_normed < max_ratio * second_best_dist_normed) {
+      *match = best_match.best_idx;
+      *ratio = best_dist_normed / second_best_dist_normed;
+    }
+  }
+}
+
+// Find the best match of each descriptor in the first set among the second
+// set and apply the distance and ratio tests. Each block processes one tile
+// of the first set and streams over all tiles of the second set, while each
+// row keeps track of its best and second best match in registers. With
+// kCrossCheck, the same dot products also update the best and second best
+// match of each descriptor in the second set among the rows of the tile,
+// which are merged over all blocks into best_matches21, such that both
+// directions are matched in a single pass.
+template <bool kCrossCheck>
+__global__ void FindBestMatchesKernel(const uint8_t* descriptors1,
+                                      const int num_descriptors1,
+                                      const uint8_t* descriptors2,
+                                      const int num_descriptors2,
+                                      const float max_ratio,
+                                      const float max_distance, int* matches,
+                                      float* ratios,
+                                      unsigned long long* best_matches21) {
+  __shared__ __align__(128) uint4 tile1[kTileNumChunks * kTileSize];
+  __shared__ __align__(128) uint4 tile2[kTileNumChunks * kTileSize];
+  __shared__ __align__(128) int dots[kTileSize * kTileDotsStride];
+
+  const int tile_begin1 = blockIdx.x * kTileSize;
+  LoadDescriptorTile(descriptors1, num_descriptors1, tile_begin1, tile1);
+
+  const int row = threadIdx.x / kTileThreadsPerRow;
+  const int col_begin =
+      (threadIdx.x % kTileThreadsPerRow) * kTileColsPerThread;
+
+  BestMatch best_match;
+  best_match.best_idx = -1;
+  best_match.best_dist = 0;
+  best_match.second_best_dist = 0;
+
+  for (int tile_begin2 = 0; tile_begin2 < num_descriptors2;
+       tile_begin2 += kTileSize) {
+    __syncthreads();
+    LoadDescriptorTile(descriptors2, num_descriptors2, tile_begin2, tile2);
+    __syncthreads();
+    ComputeTileDotProducts(tile1, tile2, dots);
+    __syncthreads();
+    const int* row_dots = dots + row * kTileDotsStride;
+    for (int col = col_begin; col < col_begin + kTileColsPerThread; ++col) {
+      UpdateBestMatch(tile_begin2 + col, row_dots[col], &best_match);
+    }
+
+    if (kCrossCheck) {
+      // The tile is square, such that the threads of a column are assigned
+      // the same way as the threads of a row with transposed coordinates.
+      const int col = row;
+      const int row_begin = col_begin;
+      BestMatch best_match21;
+      best_match21.best_idx = -1;
+      best_match21.best_dist = 0;
+      best_match21.second_best_dist = 0;
+      for (int row2 = row_begin; row2 < row_begin + kTileColsPerThread;
+           ++row2) {
+        if (tile_begin1 + row2 < num_descriptors1) {
+          UpdateBestMatch(tile_begin1 + row2,
+                          dots[row2 * kTileDotsStride + col], &best_match21);
+        }
+      }
+      MergeLaneBestMatches(&best_match21);
+      const int idx2 = tile_begin2 + col;
+      if (threadIdx.x % kTileThreadsPerRow == 0 && idx2 < num_descriptors2 &&
+          best_match21.best_idx != -1) {
+        AtomicMergeBestMatch(best_match21, best_matches21 + idx2);
+      }
+    }
+  }
+
+  // The threads of a row are adjacent lanes of the same warp.
+  MergeLaneBestMatches(&best_match);
+
+  const int idx1 = tile_begin1 + row;
+  if (threadIdx.x % kTileThreadsPerRow != 0 || idx1 >= num_descriptors1) {
+    return;
+  }
+
+  int match;
+  float ratio;
+  TestBestMatch(best_match, max_ratio, max_distance, &match, &ratio);
+
+  matches[idx1] = match;
+  if (ratios != nullptr) {
+    ratios[idx1] = ratio;
+  }
+}
+
+// Apply the distance and ratio tests to the merged best matches of the second
+// set, which were found in the same pass as the best matches of the first set.
+__global__ void TestBestMatches21Kernel(
+    const unsigned long long* best_matches21, const int num_descriptors2,
+    const float max_ratio, const float max_distance, int* matches21) {
+  const int idx2 = blockIdx.x * blockDim.x + threadIdx.x;
+  if (idx2 < num_descriptors2) {
+    float ratio;
+    TestBestMatch(UnpackBestMatch(best_matches21[idx2]), max_ratio,
+                  max_distance, &matches21[idx2], &ratio);
+  }
+}
+
+__global__ void CrossCheckMatchesKernel(int* matches12,
+                                        const int num_descriptors1,
+                                        const int* matches21) {
+  const int idx1 = blockIdx.x * blockDim.x + threadIdx.x;
+  if (idx1 < num_descriptors1 && matches12[idx1] != -1 &&
+      matches21[matches12[idx1]] != idx1) {
+    matches12[idx1] = -1;
+  }
+}
+
+template <typename T>
+void ReserveDeviceMemory(const size_t size, T** ptr, size_t* capacity) {
+  if (size <= *capacity) {
+    return;
+  }
+  if (*ptr != nullptr) {
+    CUDA_SAFE_CALL(cudaFree(*ptr));
+  }
+  CUDA_SAFE_CALL(cudaMalloc(ptr, size * sizeof(T)));
+  *capacity = size;
+}
+
+}  // namespace
+
+SiftMatcherCUDA::SiftMatcherCUDA()
+    : ratios_device_(nullptr), best_matches21_device_(nullptr) {
+  num_descriptors_.fill(0);
+  descriptors_device_.fill(nullptr);
+  descriptors_capacity_.fill(0);
+  matches_device_.fill(nullptr);
+  matches_capacity_.fill(0);
+  ratios_capacity_ = 0;
+  best_matches21_capacity_ = 0;
+}
+
+SiftMatcherCUDA::~SiftMatcherCUDA() {
+  for (int i = 0; i < 2; ++i) {
+    if (descriptors_device_[i] != nullptr) {
+      CUDA_SAFE_CALL(cudaFree(descriptors_device_[i]));
+    }
+    if (matches_device_[i] != nullptr) {
+      CUDA_SAFE_CALL(cudaFree(matches_device_[i]));
+    }
+  }
+  if (ratios_device_ != nullptr) {
+    CUDA_SAFE_CALL(cudaFree(ratios_device_));
+  }
+  if (best_matches21_device_ != nullptr) {
+    CUDA_SAFE_CALL(cudaFree(best_matches21_device_));
+  }
+}
+
+void SiftMatcherCUDA::SetDescriptors(const int index,
+                                     const FeatureDescriptors& descriptors) {
+  CHECK_GE(index, 0);
+  CHECK_LE(index, 1);
+  CHECK_EQ(descriptors.cols(), kTileDescriptorDim);
+
+  num_descriptors_[index] = static_cast<int>(descriptors.rows());
+  ReserveDeviceMemory(static_cast<size_t>(descriptors.size()),
+                      &descriptors_device_[index],
+                      &descriptors_capacity_[index]);
+  if (descriptors.size() > 0) {
+    CUDA_SAFE_CALL(cudaMemcpy(descriptors_device_[index], descriptors.data(),
+                              descriptors.size() * sizeof(uint8_t),
+                              cudaMemcpyHostToDevice));
+  }
+}
+
+void SiftMatcherCUDA::Match(const SiftMatchingOptions& match_options,
+                            FeatureMatches* matches) {
+  CHECK(match_options.Check());
+  CHECK_NOTNULL(matches);
+
+  matches->clear();
+
+  const int num_descriptors1 = num_descriptors_[0];
+  const int num_descriptors2 = num_descriptors_[1];
+  if (num_descriptors1 == 0 || num_descriptors2 == 0) {
+    return;
+  }
+
+  const float max_ratio = static_cast<float>(match_options.max_ratio);
+  const float max_distance = static_cast<float>(match_options.max_distance);
+
+  ReserveDeviceMemory(num_descriptors1, &matches_device_[0],
+                      &matches_capacity_[0]);
+  ReserveDeviceMemory(num_descriptors1, &ratios_device_, &ratios_capacity_);
+
+  const int num_blocks1 = (num_descriptors1 + kTileSize - 1) / kTileSize;
+
+  if (match_options.cross_check) {
+    CHECK_LT(num_descriptors1, kMaxNumPackedIdxs);
+    ReserveDeviceMemory(num_descriptors2, &matches_device_[1],
+                        &matches_capacity_[1]);
+    ReserveDeviceMemory(num_descriptors2, &best_matches21_device_,
+                        &best_matches21_capacity_);
+    CUDA_SAFE_CALL(cudaMemset(best_matches21_device_, 0,
+                              num_descriptors2 * sizeof(unsigned long long)));
+    FindBestMatchesKernel<true><<<num_blocks1, kTileBlockSize>>>(
+        descriptors_device_[0], num_descriptors1, descriptors_device_[1],
+        num_descriptors2, max_ratio, max_distance, matches_device_[0],
+        ratios_device_, best_matches21_device_);
+    TestBestMatches21Kernel<<<
+        (num_descriptors2 + kTileBlockSize - 1) / kTileBlockSize,
+        kTileBlockSize>>>(best_matches21_device_, num_descriptors2, max_ratio,
+                          max_distance, matches_device_[1]);
+    CrossCheckMatchesKernel<<<
+        (num_descriptors1 + kTileBlockSize - 1) / kTileBlockSize,
+        kTileBlockSize>>>(matches_device_[0], num_descriptors1,
+                          matches_device_[1]);
+  } else {
+    FindBestMatchesKernel<false><<<num_blocks1, kTileBlockSize>>>(
+        descriptors_device_[0], num_descriptors1, descriptors_device_[1],
+        num_descriptors2, max_ratio, max_distance, matches_device_[0],
+        ratios_device_, nullptr);
+  }
+
+  CUDA_SYNC_AND_CHECK();
+
+  std::vector<int> matches12(num_descriptors1);
+  CUDA_SAFE_CALL(cudaMemcpy(matches12.data(), matches_device_[0],
+                            num_descriptors1 * sizeof(int),
+                            cudaMemcpyDeviceToHost));
+
+  for (int i1 = 0; i1 < num_descriptors1; ++i1) {
+    if (matches12[i1] != -1) {
+      FeatureMatch match;
+      match.point2D_idx1 = i1;
+      match.point2D_idx2 = matches12[i1];
+      matches->push_back(match);
+    }
+  }
+
+  // Sort the matches by their ratio test score, as expected by PROSAC.
+  if (match_options.use_prosac) {
+    std::vector<float> ratios12(num_descriptors1);
+    CUDA_SAFE_CALL(cudaMemcpy(ratios12.data(), ratios_device_,
+                              num_descriptors1 * sizeof(float),
+                              cudaMemcpyDeviceToHost));
+    std::stable_sort(matches->begin(), matches->end(),
+                     [&ratios12](const FeatureMatch& match1,
+                                 const FeatureMatch& match2) {
+                       return ratios12[match1.point2D_idx1] <
+                              ratios12[match2.point2D_idx1];
+                     });
+  }
+}
+
+size_t SiftMatcherCUDA::EstimateMemory(const size_t num_descriptors1,
+                                       const size_t num_descriptors2) {
+  return (kTileDescriptorDim * sizeof(uint8_t) + sizeof(int)) *
+             (num_descriptors1 + num_descriptors2) +
+         sizeof(float) * num_descriptors1 +
+         sizeof(unsigned long long) * num_descriptors2;
+}
+
+void MatchSiftFeaturesCUDA(const SiftMatchingOptions& match_options,
+                           const FeatureDescriptors& descriptors1,
+                           const FeatureDescriptors& descriptors2,
+                           FeatureMatches* matches) {
+  SiftMatcherCUDA matcher;
+  matcher.SetDescriptors(0, descriptors1);
+  matcher.SetDescriptors(1, descriptors2);
+  matcher.Match(match_options, matches);
+}
+
+}  // namespace colmap
@@ -0,0 +1,106 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_FEATURE_SIFT_CUDA_H_
+#define COLMAP_SRC_FEATURE_SIFT_CUDA_H_
+
+#include <array>
+
+#include "feature/sift.h"
+#include "feature/types.h"
+#include "util/types.h"
+
+namespace colmap {
+
+// Brute-force SIFT feature matcher on the current CUDA device. The dot
+// products between the descriptors are computed as a tiled 8-bit integer
+// matrix product, which runs on the tensor cores of devices with compute
+// capability 7.2 or higher and with packed 4-way dot product instructions on
+// older devices. The search for the best and second best match, the distance
+// and ratio tests, and the cross-check are fused into the matrix product, so
+// that the distance matrix is never stored and the number of features is only
+// limited by the device memory for the descriptors. With cross-checking, the
+// best matches in both directions are found in a single pass over the matrix
+// product. Since the products are
+// exact, the matches are the same as in `MatchSiftFeaturesCPUBruteForce` up to
+// floating point rounding in the distance and ratio tests.
+//
+// Example usage:
+//
+//    SiftMatcherCUDA matcher;
+//    matcher.SetDescriptors(0, descriptors1);
+//    matcher.SetDescriptors(1, descriptors2);
+//    matcher.Match(match_options, &matches);
+//
+class SiftMatcherCUDA {
+ public:
+  SiftMatcherCUDA();
+  ~SiftMatcherCUDA();
+
+  // Upload the descriptors of the first (index 0) or second (index 1) image.
+  // The device buffers only grow, such that they are reused across images.
+  void SetDescriptors(const int index, const FeatureDescriptors& descriptors);
+
+  // Match the uploaded descriptors. In contrast to SiftGPU, the number of
+  // matches is not limited by `max_num_matches`. If `use_prosac` is set, the
+  // matches are sorted by their ratio test score.
+  void Match(const SiftMatchingOptions& match_options,
+             FeatureMatches* matches);
+
+  // The number of bytes of device memory required to match the given number
+  // of descriptors in the first and second image.
+  static size_t EstimateMemory(const size_t num_descriptors1,
+                               const size_t num_descriptors2);
+
+ private:
+  NON_COPYABLE(SiftMatcherCUDA)
+
+  std::array<int, 2> num_descriptors_;
+  std::array<uint8_t*, 2> descriptors_device_;
+  std::array<size_t, 2> descriptors_capacity_;
+  std::array<int*, 2> matches_device_;
+  std::array<size_t, 2> matches_capacity_;
+  float* ratios_device_;
+  size_t ratios_capacity_;
+  unsigned long long* best_matches21_device_;
+  size_t best_matches21_capacity_;
+};
+
+// Match the given descriptors on the current CUDA device. This is a
+// convenience wrapper around `SiftMatcherCUDA`, which should be used directly
+// to reuse the device buffers and uploaded descriptors across image pairs.
+void MatchSiftFeaturesCUDA(const SiftMatchingOptions& match_options,
+                           const FeatureDescriptors& descriptors1,
+                           const FeatureDescriptors& descriptors2,
+                           FeatureMatches* matches);
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_FEATURE_SIFT_CUDA_H_
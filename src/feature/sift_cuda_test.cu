@@ -0,0 +1,128 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "feature/sift_cuda_test"
+#include "util/testing.h"
+
+#include "feature/sift_cuda.h"
+#include "feature/utils.h"
+#include "util/random.h"
+
+using namespace colmap;
+
+FeatureDescriptors CreateRandomFeatureDescriptors(const size_t num_features) {
+  Eigen::MatrixXf descriptors(num_features, 128);
+  for (size_t i = 0; i < num_features; ++i) {
+    for (size_t j = 0; j < 128; ++j) {
+      descriptors(i, j) = std::pow(RandomReal(0.0f, 1.0f), 2);
+    }
+  }
+  return FeatureDescriptorsToUnsignedByte(
+      L2NormalizeFeatureDescriptors(descriptors));
+}
+
+void CheckEqualMatches(const FeatureMatches& matches1,
+                       const FeatureMatches& matches2) {
+  BOOST_REQUIRE_EQUAL(matches1.size(), matches2.size());
+  for (size_t i = 0; i < matches1.size(); ++i) {
+    BOOST_CHECK_EQUAL(matches1[i].point2D_idx1, matches2[i].point2D_idx1);
+    BOOST_CHECK_EQUAL(matches1[i].point2D_idx2, matches2[i].point2D_idx2);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestMatchSiftFeaturesCUDA) {
+  SetPRNGSeed(0);
+  const FeatureDescriptors empty_descriptors =
+      CreateRandomFeatureDescriptors(0);
+  const FeatureDescriptors descriptors1 = CreateRandomFeatureDescriptors(2);
+  const FeatureDescriptors descriptors2 = descriptors1.colwise().reverse();
+
+  FeatureMatches matches;
+
+  MatchSiftFeaturesCUDA(SiftMatchingOptions(), descriptors1, descriptors2,
+                        &matches);
+  BOOST_CHECK_EQUAL(matches.size(), 2);
+  BOOST_CHECK_EQUAL(matches[0].point2D_idx1, 0);
+  BOOST_CHECK_EQUAL(matches[0].point2D_idx2, 1);
+  BOOST_CHECK_EQUAL(matches[1].point2D_idx1, 1);
+  BOOST_CHECK_EQUAL(matches[1].point2D_idx2, 0);
+
+  MatchSiftFeaturesCUDA(SiftMatchingOptions(), empty_descriptors, descriptors2,
+                        &matches);
+  BOOST_CHECK_EQUAL(matches.size(), 0);
+  MatchSiftFeaturesCUDA(SiftMatchingOptions(), descriptors1, empty_descriptors,
+                        &matches);
+  BOOST_CHECK_EQUAL(matches.size(), 0);
+  MatchSiftFeaturesCUDA(SiftMatchingOptions(), empty_descriptors,
+                        empty_descriptors, &matches);
+  BOOST_CHECK_EQUAL(matches.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestMatchSiftFeaturesCUDAvsBruteForce) {
+  SetPRNGSeed(0);
+
+  // The feature counts are not multiples of the tile size.
+  FeatureDescriptors descriptors1 = CreateRandomFeatureDescriptors(1000);
+  FeatureDescriptors descriptors2 = CreateRandomFeatureDescriptors(1500);
+
+  // Plant some clearly distinctive matches with small perturbations.
+  for (int i = 0; i < 500; ++i) {
+    descriptors2.row(3 * i) = descriptors1.row(2 * i);
+    descriptors2(3 * i, i % 128) /= 2;
+  }
+
+  SiftMatcherCUDA matcher;
+  for (const bool cross_check : {true, false}) {
+    for (const bool use_prosac : {true, false}) {
+      SiftMatchingOptions match_options;
+      match_options.cross_check = cross_check;
+      match_options.use_prosac = use_prosac;
+
+      FeatureMatches matches_bf;
+      MatchSiftFeaturesCPUBruteForce(match_options, descriptors1, descriptors2,
+                                     &matches_bf);
+      BOOST_CHECK_GE(matches_bf.size(), 500);
+
+      matcher.SetDescriptors(0, descriptors1);
+      matcher.SetDescriptors(1, descriptors2);
+      FeatureMatches matches_cuda;
+      matcher.Match(match_options, &matches_cuda);
+      CheckEqualMatches(matches_bf, matches_cuda);
+
+      // Reverse the order of the images, where the buffers are reused.
+      MatchSiftFeaturesCPUBruteForce(match_options, descriptors2, descriptors1,
+                                     &matches_bf);
+      matcher.SetDescriptors(0, descriptors2);
+      matcher.SetDescriptors(1, descriptors1);
+      matcher.Match(match_options, &matches_cuda);
+      CheckEqualMatches(matches_bf, matches_cuda);
+    }
+  }
+}
@@ -32,7 +32,10 @@
 #define TEST_NAME "feature/sift_test"
 #include "util/testing.h"
 
+#include <fstream>
+
 #include <QApplication>
+#include <boost/filesystem.hpp>
 
 #include "SiftGPU/SiftGPU.h"
 #include "feature/sift.h"
@@ -79,6 +82,81 @@ BOOST_AUTO_TEST_CASE(TestExtractSiftFeaturesCPU) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestExtractSiftFeaturesCPUIntraImageThreads) {
+  Bitmap bitmap;
+  CreateImageWithSquare(256, &bitmap);
+
+  FeatureKeypoints keypoints;
+  FeatureDescriptors descriptors;
+  BOOST_CHECK(ExtractSiftFeaturesCPU(SiftExtractionOptions(), bitmap,
+                                     &keypoints, &descriptors));
+
+  SiftExtractionOptions options;
+  options.num_intra_image_threads = 4;
+  FeatureKeypoints threaded_keypoints;
+  FeatureDescriptors threaded_descriptors;
+  BOOST_CHECK(ExtractSiftFeaturesCPU(options, bitmap, &threaded_keypoints,
+                                     &threaded_descriptors));
+
+  BOOST_CHECK_EQUAL(threaded_keypoints.size(), keypoints.size());
+  for (size_t i = 0; i < keypoints.size(); ++i) {
+    BOOST_CHECK_EQUAL(threaded_keypoints[i].x, keypoints[i].x);
+    BOOST_CHECK_EQUAL(threaded_keypoints[i].y, keypoints[i].y);
+    BOOST_CHECK_EQUAL(threaded_keypoints[i].a11, keypoints[i].a11);
+    BOOST_CHECK_EQUAL(threaded_keypoints[i].a12, keypoints[i].a12);
+  }
+  BOOST_CHECK(threaded_descriptors == descriptors);
+}
+
+BOOST_AUTO_TEST_CASE(TestExtractTiledSiftFeatures) {
+  Bitmap bitmap;
+  CreateImageWithSquare(256, &bitmap);
+
+  SiftExtractionOptions options;
+  options.tile_size = 100;
+  options.tile_overlap = 64;
+
+  int num_tiles = 0;
+  const auto ExtractFunc = [&](const Bitmap& tile_bitmap,
+                               FeatureKeypoints* keypoints,
+                               FeatureDescriptors* descriptors) {
+    num_tiles += 1;
+    BOOST_CHECK_LE(tile_bitmap.Width(),
+                   options.tile_size + 2 * options.tile_overlap);
+    BOOST_CHECK_LE(tile_bitmap.Height(),
+                   options.tile_size + 2 * options.tile_overlap);
+    return ExtractSiftFeaturesCPU(options, tile_bitmap, keypoints,
+                                  descriptors);
+  };
+
+  FeatureKeypoints keypoints;
+  FeatureDescriptors descriptors;
+  BOOST_CHECK(ExtractTiledSiftFeatures(options, bitmap, ExtractFunc,
+                                       &keypoints, &descriptors));
+  BOOST_CHECK_EQUAL(num_tiles, 9);
+
+  BOOST_CHECK_GT(keypoints.size(), 0);
+  BOOST_CHECK_EQUAL(descriptors.rows(), keypoints.size());
+  for (size_t i = 0; i < keypoints.size(); ++i) {
+    BOOST_CHECK_GE(keypoints[i].x, 0);
+    BOOST_CHECK_GE(keypoints[i].y, 0);
+    BOOST_CHECK_LE(keypoints[i].x, bitmap.Width());
+    BOOST_CHECK_LE(keypoints[i].y, bitmap.Height());
+    for (size_t j = 0; j < i; ++j) {
+      BOOST_CHECK(keypoints[i].x != keypoints[j].x ||
+                  keypoints[i].y != keypoints[j].y ||
+                  keypoints[i].a11 != keypoints[j].a11 ||
+                  keypoints[i].a12 != keypoints[j].a12);
+    }
+  }
+
+  options.max_num_features = 5;
+  BOOST_CHECK(ExtractTiledSiftFeatures(options, bitmap, ExtractFunc,
+                                       &keypoints, &descriptors));
+  BOOST_CHECK_LE(keypoints.size(), 5);
+  BOOST_CHECK_EQUAL(descriptors.rows(), keypoints.size());
+}
+
 BOOST_AUTO_TEST_CASE(TestExtractCovariantSiftFeaturesCPU) {
   Bitmap bitmap;
   CreateImageWithSquare(256, &bitmap);
@@ -190,6 +268,89 @@ BOOST_AUTO_TEST_CASE(TestExtractCovariantAffineDSPSiftFeaturesCPU) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestExtractCovariantSiftFeaturesCPUIntraImageThreads) {
+  Bitmap bitmap;
+  CreateImageWithSquare(256, &bitmap);
+
+  for (const bool estimate_affine_shape : {false, true}) {
+    SiftExtractionOptions options;
+    options.estimate_affine_shape = estimate_affine_shape;
+    options.domain_size_pooling = true;
+    FeatureKeypoints keypoints;
+    FeatureDescriptors descriptors;
+    BOOST_CHECK(ExtractCovariantSiftFeaturesCPU(options, bitmap, &keypoints,
+                                                &descriptors));
+
+    options.num_intra_image_threads = 4;
+    FeatureKeypoints threaded_keypoints;
+    FeatureDescriptors threaded_descriptors;
+    BOOST_CHECK(ExtractCovariantSiftFeaturesCPU(
+        options, bitmap, &threaded_keypoints, &threaded_descriptors));
+
+    BOOST_CHECK_EQUAL(threaded_keypoints.size(), keypoints.size());
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+      BOOST_CHECK_EQUAL(threaded_keypoints[i].x, keypoints[i].x);
+      BOOST_CHECK_EQUAL(threaded_keypoints[i].y, keypoints[i].y);
+      BOOST_CHECK_EQUAL(threaded_keypoints[i].a11, keypoints[i].a11);
+      BOOST_CHECK_EQUAL(threaded_keypoints[i].a12, keypoints[i].a12);
+      BOOST_CHECK_EQUAL(threaded_keypoints[i].a21, keypoints[i].a21);
+      BOOST_CHECK_EQUAL(threaded_keypoints[i].a22, keypoints[i].a22);
+    }
+    BOOST_CHECK(threaded_descriptors == descriptors);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestLoadSiftFeaturesFromFile) {
+  const std::string text_path = (boost::filesystem::temp_directory_path() /
+                                 boost::filesystem::unique_path())
+                                    .string();
+  {
+    std::ofstream file(text_path);
+    file << "2 128\n";
+    for (int i = 0; i < 2; ++i) {
+      file << i + 0.5 << " " << 2 * i + 0.25 << " 1.5 0.0";
+      for (int j = 0; j < 128; ++j) {
+        file << " " << (i + j) % 256;
+      }
+      file << "\n";
+    }
+  }
+
+  FeatureKeypoints keypoints;
+  FeatureDescriptors descriptors;
+  LoadSiftFeaturesFromTextFile(text_path, &keypoints, &descriptors);
+  BOOST_CHECK_EQUAL(keypoints.size(), 2);
+  BOOST_CHECK_EQUAL(descriptors.rows(), 2);
+  BOOST_CHECK_EQUAL(descriptors.cols(), 128);
+  for (int i = 0; i < 2; ++i) {
+    BOOST_CHECK_EQUAL(keypoints[i].x, i + 0.5f);
+    BOOST_CHECK_EQUAL(keypoints[i].y, 2 * i + 0.25f);
+    BOOST_CHECK_CLOSE(keypoints[i].ComputeScale(), 1.5f, 1e-4);
+    BOOST_CHECK_EQUAL(keypoints[i].ComputeOrientation(), 0.0f);
+    for (int j = 0; j < 128; ++j) {
+      BOOST_CHECK_EQUAL(descriptors(i, j), (i + j) % 256);
+    }
+  }
+
+  const std::string binary_path = text_path + ".bin";
+  WriteSiftFeaturesToBinaryFile(binary_path, keypoints, descriptors);
+
+  FeatureKeypoints binary_keypoints;
+  FeatureDescriptors binary_descriptors;
+  LoadSiftFeaturesFromBinaryFile(binary_path, &binary_keypoints,
+                                 &binary_descriptors);
+  BOOST_CHECK_EQUAL(binary_keypoints.size(), keypoints.size());
+  for (size_t i = 0; i < keypoints.size(); ++i) {
+    BOOST_CHECK_EQUAL(binary_keypoints[i].x, keypoints[i].x);
+    BOOST_CHECK_EQUAL(binary_keypoints[i].y, keypoints[i].y);
+    BOOST_CHECK_EQUAL(binary_keypoints[i].a11, keypoints[i].a11);
+    BOOST_CHECK_EQUAL(binary_keypoints[i].a12, keypoints[i].a12);
+    BOOST_CHECK_EQUAL(binary_keypoints[i].a21, keypoints[i].a21);
+    BOOST_CHECK_EQUAL(binary_keypoints[i].a22, keypoints[i].a22);
+  }
+  BOOST_CHECK(binary_descriptors == descriptors);
+}
+
 BOOST_AUTO_TEST_CASE(TestExtractSiftFeaturesGPU) {
   char app_name[] = "Test";
   int argc = 1;
@@ -430,6 +591,178 @@ BOOST_AUTO_TEST_CASE(TestMatchSiftFeaturesCPUFLANNvsBruteForce) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestMatchSiftFeaturesCPUFLANNIndex) {
+  const auto descriptors1 = std::make_shared<const FeatureDescriptors>(
+      CreateRandomFeatureDescriptors(500));
+  const auto descriptors2 = std::make_shared<const FeatureDescriptors>(
+      descriptors1->colwise().reverse());
+  const auto empty_descriptors = std::make_shared<const FeatureDescriptors>(
+      CreateRandomFeatureDescriptors(0));
+
+  const SiftFLANNIndex index1(descriptors1);
+  const SiftFLANNIndex index2(descriptors2);
+  const SiftFLANNIndex empty_index(empty_descriptors);
+  BOOST_CHECK_EQUAL(&index1.Descriptors(), descriptors1.get());
+
+  SiftMatchingOptions match_options;
+  FeatureMatches matches;
+
+  // The same index can be reused for multiple image pairs.
+  for (int i = 0; i < 2; ++i) {
+    MatchSiftFeaturesCPUFLANN(match_options, index1, index2, &matches);
+    BOOST_CHECK_EQUAL(matches.size(), 500);
+  }
+
+  // Searching in parallel produces the same results for the same index.
+  FeatureMatches matches_parallel;
+  match_options.num_intra_pair_threads = 4;
+  MatchSiftFeaturesCPUFLANN(match_options, index1, index2, &matches_parallel);
+  CheckEqualMatches(matches, matches_parallel);
+
+  MatchSiftFeaturesCPUFLANN(match_options, empty_index, index2, &matches);
+  BOOST_CHECK_EQUAL(matches.size(), 0);
+  MatchSiftFeaturesCPUFLANN(match_options, index1, empty_index, &matches);
+  BOOST_CHECK_EQUAL(matches.size(), 0);
+  MatchSiftFeaturesCPUFLANN(match_options, empty_index, empty_index, &matches);
+  BOOST_CHECK_EQUAL(matches.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestMatchSiftFeaturesCPUBruteForceBlocks) {
+  // Use a number of features that is not a multiple of the block sizes.
+  const FeatureDescriptors descriptors1 = CreateRandomFeatureDescriptors(555);
+  const FeatureDescriptors descriptors2 = descriptors1.colwise().reverse();
+
+  for (const bool cross_check : {true, false}) {
+    SiftMatchingOptions match_options;
+    match_options.cross_check = cross_check;
+
+    FeatureMatches matches;
+    MatchSiftFeaturesCPUBruteForce(match_options, descriptors1, descriptors2,
+                                   &matches);
+    BOOST_REQUIRE_EQUAL(matches.size(), 555);
+    for (size_t i = 0; i < matches.size(); ++i) {
+      BOOST_CHECK_EQUAL(matches[i].point2D_idx1, i);
+      BOOST_CHECK_EQUAL(matches[i].point2D_idx2, 554 - i);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestMatchSiftFeaturesCPUSortByRatio) {
+  const FeatureDescriptors descriptors1 = CreateRandomFeatureDescriptors(100);
+  FeatureDescriptors descriptors2 = descriptors1;
+  for (int i = 0; i < descriptors2.rows(); ++i) {
+    for (int j = 0; j < descriptors2.cols(); ++j) {
+      descriptors2(i, j) = static_cast<uint8_t>(std::max(
+          0, std::min(255, descriptors2(i, j) + RandomInteger(-i / 5, i / 5))));
+    }
+  }
+
+  // The ratio test scores as computed by the matcher.
+  auto ComputeRatio = [&](const point2D_t point2D_idx1) {
+    const Eigen::VectorXi dists =
+        descriptors2.cast<int>() *
+        descriptors1.row(point2D_idx1).transpose().cast<int>();
+    int best_dist = 0;
+    int second_best_dist = 0;
+    for (int i = 0; i < dists.size(); ++i) {
+      if (dists(i) > best_dist) {
+        second_best_dist = best_dist;
+        best_dist = dists(i);
+      } else if (dists(i) > second_best_dist) {
+        second_best_dist = dists(i);
+      }
+    }
+    const float kDistNorm = 1.0f / (512.0f * 512.0f);
+    return std::acos(std::min(kDistNorm * best_dist, 1.0f)) /
+           std::acos(std::min(kDistNorm * second_best_dist, 1.0f));
+  };
+
+  auto CheckSortedMatches = [&](FeatureMatches matches,
+                                FeatureMatches sorted_matches,
+                                const bool check_ratios) {
+    BOOST_REQUIRE_EQUAL(matches.size(), sorted_matches.size());
+    for (size_t i = 1; check_ratios && i < sorted_matches.size(); ++i) {
+      BOOST_CHECK_LE(ComputeRatio(sorted_matches[i - 1].point2D_idx1),
+                     ComputeRatio(sorted_matches[i].point2D_idx1));
+    }
+    const auto CompareMatches = [](const FeatureMatch& match1,
+                                   const FeatureMatch& match2) {
+      return match1.point2D_idx1 < match2.point2D_idx1;
+    };
+    std::sort(sorted_matches.begin(), sorted_matches.end(), CompareMatches);
+    CheckEqualMatches(matches, sorted_matches);
+  };
+
+  for (const bool cross_check : {true, false}) {
+    SiftMatchingOptions match_options;
+    match_options.cross_check = cross_check;
+    SiftMatchingOptions sort_match_options = match_options;
+    sort_match_options.use_prosac = true;
+
+    FeatureMatches matches;
+    FeatureMatches sorted_matches;
+    MatchSiftFeaturesCPUBruteForce(match_options, descriptors1, descriptors2,
+                                   &matches);
+    MatchSiftFeaturesCPUBruteForce(sort_match_options, descriptors1,
+                                   descriptors2, &sorted_matches);
+    BOOST_CHECK_GT(matches.size(), 0);
+    CheckSortedMatches(matches, sorted_matches, true);
+
+    MatchSiftFeaturesCPUFLANN(match_options, descriptors1, descriptors2,
+                              &matches);
+    MatchSiftFeaturesCPUFLANN(sort_match_options, descriptors1, descriptors2,
+                              &sorted_matches);
+    CheckSortedMatches(matches, sorted_matches, false);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestMatchSiftFeaturesCPUPQ) {
+  const FeatureDescriptors descriptors1 = CreateRandomFeatureDescriptors(200);
+  const FeatureDescriptors descriptors2 = descriptors1.colwise().reverse();
+
+  FeatureDescriptors training_descriptors(400, 128);
+  training_descriptors << descriptors1, descriptors2;
+  const FeatureDescriptorCodebook codebook =
+      TrainFeatureDescriptorCodebook(training_descriptors, 16);
+  const FeatureDescriptors codes1 =
+      EncodeFeatureDescriptors(codebook, descriptors1);
+  const FeatureDescriptors codes2 =
+      EncodeFeatureDescriptors(codebook, descriptors2);
+
+  for (const bool cross_check : {true, false}) {
+    SiftMatchingOptions match_options;
+    match_options.cross_check = cross_check;
+
+    // Re-ranking all candidates is equivalent to brute-force matching.
+    FeatureMatches matches_bf;
+    FeatureMatches matches_pq;
+    MatchSiftFeaturesCPUBruteForce(match_options, descriptors1, descriptors2,
+                                   &matches_bf);
+    MatchSiftFeaturesCPUPQ(match_options, codebook, descriptors1, codes1,
+                           descriptors2, codes2, 200, &matches_pq);
+    CheckEqualMatches(matches_bf, matches_pq);
+
+    MatchSiftFeaturesCPUPQ(match_options, codebook, descriptors1, codes1,
+                           descriptors2, codes2, 10, &matches_pq);
+    BOOST_REQUIRE_EQUAL(matches_pq.size(), 200);
+    for (size_t i = 0; i < matches_pq.size(); ++i) {
+      BOOST_CHECK_EQUAL(matches_pq[i].point2D_idx1, i);
+      BOOST_CHECK_EQUAL(matches_pq[i].point2D_idx2, 199 - i);
+    }
+
+    const FeatureDescriptors empty_descriptors =
+        CreateRandomFeatureDescriptors(0);
+    const FeatureDescriptors empty_codes =
+        EncodeFeatureDescriptors(codebook, empty_descriptors);
+    MatchSiftFeaturesCPUPQ(match_options, codebook, empty_descriptors,
+                           empty_codes, descriptors2, codes2, 10, &matches_pq);
+    BOOST_CHECK_EQUAL(matches_pq.size(), 0);
+    MatchSiftFeaturesCPUPQ(match_options, codebook, descriptors1, codes1,
+                           empty_descriptors, empty_codes, 10, &matches_pq);
+    BOOST_CHECK_EQUAL(matches_pq.size(), 0);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestMatchGuidedSiftFeaturesCPU) {
   FeatureKeypoints empty_keypoints(0);
   FeatureKeypoints keypoints1(2);
@@ -762,6 +1095,20 @@ BOOST_AUTO_TEST_CASE(TestMatchGuidedSiftFeaturesGPU) {
       BOOST_CHECK_EQUAL(two_view_geometry.inlier_matches[0].point2D_idx1, 1);
       BOOST_CHECK_EQUAL(two_view_geometry.inlier_matches[0].point2D_idx2, 0);
 
+      // Reuse separately uploaded descriptors with new keypoints.
+      UploadSiftDescriptorsGPU(0, 1, descriptors1, &sift_match_gpu);
+      UploadSiftDescriptorsGPU(1, 2, descriptors2, &sift_match_gpu);
+      keypoints1[0].x = 1;
+      MatchGuidedSiftFeaturesGPU(SiftMatchingOptions(), &keypoints1,
+                                 &keypoints2, nullptr, nullptr,
+                                 &sift_match_gpu, &two_view_geometry);
+      BOOST_CHECK_EQUAL(two_view_geometry.inlier_matches.size(), 2);
+      BOOST_CHECK_EQUAL(two_view_geometry.inlier_matches[0].point2D_idx1, 0);
+      BOOST_CHECK_EQUAL(two_view_geometry.inlier_matches[0].point2D_idx2, 1);
+      BOOST_CHECK_EQUAL(two_view_geometry.inlier_matches[1].point2D_idx1, 1);
+      BOOST_CHECK_EQUAL(two_view_geometry.inlier_matches[1].point2D_idx2, 0);
+
+      keypoints1[0].x = 100;
       MatchGuidedSiftFeaturesGPU(SiftMatchingOptions(), &empty_keypoints,
                                  &keypoints2, &empty_descriptors, &descriptors2,
                                  &sift_match_gpu, &two_view_geometry);
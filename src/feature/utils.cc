@@ -31,7 +31,10 @@
 
 #include "feature/utils.h"
 
+#include <numeric>
+
 #include "util/math.h"
+#include "util/random.h"
 
 namespace colmap {
 
@@ -76,6 +79,136 @@ FeatureDescriptors FeatureDescriptorsToUnsignedByte(
   return descriptors_unsigned_byte;
 }
 
+const int FeatureDescriptorCodebook::kNumCentroids = 256;
+
+int FeatureDescriptorCodebook::NumSubspaces() const {
+  return static_cast<int>(centroids.rows() / kNumCentroids);
+}
+
+int FeatureDescriptorCodebook::SubspaceDim() const {
+  return static_cast<int>(centroids.cols());
+}
+
+FeatureDescriptorCodebook TrainFeatureDescriptorCodebook(
+    const FeatureDescriptors& descriptors, const int num_subspaces,
+    const int num_iterations) {
+  CHECK_GT(descriptors.rows(), 0);
+  CHECK_GT(num_subspaces, 0);
+  CHECK_EQ(descriptors.cols() % num_subspaces, 0);
+  CHECK_GE(num_iterations, 0);
+
+  const int kNumCentroids = FeatureDescriptorCodebook::kNumCentroids;
+  const int num_descriptors = static_cast<int>(descriptors.rows());
+  const int subspace_dim = static_cast<int>(descriptors.cols()) / num_subspaces;
+
+  FeatureDescriptorCodebook codebook;
+  codebook.centroids.resize(num_subspaces * kNumCentroids, subspace_dim);
+
+  // Initialize the centroids with randomly selected descriptors. If there are
+  // fewer descriptors than centroids, some of them are duplicated.
+  std::vector<int> init_indices(num_descriptors);
+  std::iota(init_indices.begin(), init_indices.end(), 0);
+  Shuffle(static_cast<uint32_t>(std::min(num_descriptors, kNumCentroids)),
+          &init_indices);
+
+  std::vector<int> assignments(num_descriptors);
+  Eigen::MatrixXf sums(kNumCentroids, subspace_dim);
+  std::vector<int> counts(kNumCentroids);
+
+  for (int s = 0; s < num_subspaces; ++s) {
+    const Eigen::MatrixXf subvectors =
+        descriptors.block(0, s * subspace_dim, num_descriptors, subspace_dim)
+            .cast<float>();
+    auto centroids = codebook.centroids.block(s * kNumCentroids, 0,
+                                              kNumCentroids, subspace_dim);
+    for (int c = 0; c < kNumCentroids; ++c) {
+      centroids.row(c) = subvectors.row(init_indices[c % num_descriptors]);
+    }
+
+    for (int iter = 0; iter < num_iterations; ++iter) {
+      for (int i = 0; i < num_descriptors; ++i) {
+        (centroids.rowwise() - subvectors.row(i))
+            .rowwise()
+            .squaredNorm()
+            .minCoeff(&assignments[i]);
+      }
+
+      sums.setZero();
+      std::fill(counts.begin(), counts.end(), 0);
+      for (int i = 0; i < num_descriptors; ++i) {
+        sums.row(assignments[i]) += subvectors.row(i);
+        counts[assignments[i]] += 1;
+      }
+
+      // Empty clusters keep their previous centroid.
+      for (int c = 0; c < kNumCentroids; ++c) {
+        if (counts[c] > 0) {
+          centroids.row(c) = sums.row(c) / counts[c];
+        }
+      }
+    }
+  }
+
+  return codebook;
+}
+
+FeatureDescriptors EncodeFeatureDescriptors(
+    const FeatureDescriptorCodebook& codebook,
+    const FeatureDescriptors& descriptors) {
+  const int num_subspaces = codebook.NumSubspaces();
+  const int subspace_dim = codebook.SubspaceDim();
+  CHECK_EQ(descriptors.cols(), num_subspaces * subspace_dim);
+
+  const int kNumCentroids = FeatureDescriptorCodebook::kNumCentroids;
+
+  FeatureDescriptors codes(descriptors.rows(), num_subspaces);
+  for (FeatureDescriptors::Index i = 0; i < descriptors.rows(); ++i) {
+    for (int s = 0; s < num_subspaces; ++s) {
+      const Eigen::RowVectorXf subvector =
+          descriptors.block(i, s * subspace_dim, 1, subspace_dim)
+              .cast<float>();
+      int idx;
+      (codebook.centroids
+           .block(s * kNumCentroids, 0, kNumCentroids, subspace_dim)
+           .rowwise() -
+       subvector)
+          .rowwise()
+          .squaredNorm()
+          .minCoeff(&idx);
+      codes(i, s) = static_cast<uint8_t>(idx);
+    }
+  }
+
+  return codes;
+}
+
+Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+ComputeFeatureDescriptorDistanceTable(const FeatureDescriptorCodebook& codebook,
+                                      const uint8_t* descriptor) {
+  const int num_subspaces = codebook.NumSubspaces();
+  const int subspace_dim = codebook.SubspaceDim();
+  const int kNumCentroids = FeatureDescriptorCodebook::kNumCentroids;
+
+  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> table(
+      num_subspaces, kNumCentroids);
+  for (int s = 0; s < num_subspaces; ++s) {
+    const Eigen::RowVectorXf subvector =
+        Eigen::Map<const Eigen::Matrix<uint8_t, 1, Eigen::Dynamic>>(
+            descriptor + s * subspace_dim, subspace_dim)
+            .cast<float>();
+    table.row(s) =
+        (codebook.centroids
+             .block(s * kNumCentroids, 0, kNumCentroids, subspace_dim)
+             .rowwise() -
+         subvector)
+            .rowwise()
+            .squaredNorm()
+            .transpose();
+  }
+
+  return table;
+}
+
 void ExtractTopScaleFeatures(FeatureKeypoints* keypoints,
                              FeatureDescriptors* descriptors,
                              const size_t num_features) {
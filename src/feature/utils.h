@@ -57,6 +57,45 @@ Eigen::MatrixXf L1RootNormalizeFeatureDescriptors(
 FeatureDescriptors FeatureDescriptorsToUnsignedByte(
     const Eigen::MatrixXf& descriptors);
 
+// Product quantization codebook for feature descriptors, see "Product
+// Quantization for Nearest Neighbor Search", H. Jegou, M. Douze, C. Schmid,
+// PAMI 2011. The descriptor dimensions are split into equally sized
+// subspaces, which are quantized independently with 256 centroids each, such
+// that every descriptor is encoded by one byte per subspace.
+struct FeatureDescriptorCodebook {
+  static const int kNumCentroids;
+
+  int NumSubspaces() const;
+  int SubspaceDim() const;
+
+  // The centroid `c` of the subspace `s` is stored in row
+  // `s * kNumCentroids + c`.
+  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      centroids;
+};
+
+// Train a product quantization codebook with the given number of subspaces
+// using k-means on the given (ideally, a representative sample of) unsigned
+// byte descriptors. The number of subspaces must divide the descriptor
+// dimension, e.g., 16 or 32 subspaces for 128-D SIFT descriptors.
+FeatureDescriptorCodebook TrainFeatureDescriptorCodebook(
+    const FeatureDescriptors& descriptors, const int num_subspaces,
+    const int num_iterations = 20);
+
+// Encode unsigned byte descriptors as product quantization codes, where each
+// row contains the centroid indices of one descriptor in all subspaces.
+FeatureDescriptors EncodeFeatureDescriptors(
+    const FeatureDescriptorCodebook& codebook,
+    const FeatureDescriptors& descriptors);
+
+// Compute the squared distances between the subvectors of a single unsigned
+// byte descriptor and all centroids of the codebook, where row `s` holds the
+// distances in subspace `s`. The asymmetric distance between the descriptor
+// and a code is then the sum of the table entries selected by the code.
+Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+ComputeFeatureDescriptorDistanceTable(const FeatureDescriptorCodebook& codebook,
+                                      const uint8_t* descriptor);
+
 // Extract the descriptors corresponding to the largest-scale features.
 void ExtractTopScaleFeatures(FeatureKeypoints* keypoints,
                              FeatureDescriptors* descriptors,
@@ -80,6 +80,51 @@ BOOST_AUTO_TEST_CASE(TestFeatureDescriptorsToUnsignedByte) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestFeatureDescriptorCodebook) {
+  Eigen::MatrixXf descriptors = Eigen::MatrixXf::Random(500, 128);
+  descriptors.array() += 1.0f;
+  const FeatureDescriptors descriptors_uint8 =
+      FeatureDescriptorsToUnsignedByte(
+          L2NormalizeFeatureDescriptors(descriptors));
+
+  for (const int num_subspaces : {16, 32}) {
+    const FeatureDescriptorCodebook codebook =
+        TrainFeatureDescriptorCodebook(descriptors_uint8, num_subspaces);
+    BOOST_CHECK_EQUAL(codebook.NumSubspaces(), num_subspaces);
+    BOOST_CHECK_EQUAL(codebook.SubspaceDim(), 128 / num_subspaces);
+
+    const FeatureDescriptors codes =
+        EncodeFeatureDescriptors(codebook, descriptors_uint8);
+    BOOST_CHECK_EQUAL(codes.rows(), descriptors_uint8.rows());
+    BOOST_CHECK_EQUAL(codes.cols(), num_subspaces);
+
+    for (FeatureDescriptors::Index i = 0; i < descriptors_uint8.rows(); ++i) {
+      const auto table = ComputeFeatureDescriptorDistanceTable(
+          codebook, descriptors_uint8.data() + 128 * i);
+      BOOST_CHECK_EQUAL(table.rows(), num_subspaces);
+      BOOST_CHECK_EQUAL(table.cols(), FeatureDescriptorCodebook::kNumCentroids);
+      // Each descriptor is encoded by its nearest centroids.
+      for (int s = 0; s < num_subspaces; ++s) {
+        BOOST_CHECK_EQUAL(table(s, codes(i, s)), table.row(s).minCoeff());
+      }
+    }
+  }
+
+  // Fewer descriptors than centroids are exactly reproduced by the codebook.
+  const FeatureDescriptors few_descriptors_uint8 = descriptors_uint8.topRows(10);
+  const FeatureDescriptorCodebook codebook =
+      TrainFeatureDescriptorCodebook(few_descriptors_uint8, 16);
+  const FeatureDescriptors codes =
+      EncodeFeatureDescriptors(codebook, few_descriptors_uint8);
+  for (FeatureDescriptors::Index i = 0; i < few_descriptors_uint8.rows(); ++i) {
+    const auto table = ComputeFeatureDescriptorDistanceTable(
+        codebook, few_descriptors_uint8.data() + 128 * i);
+    for (int s = 0; s < 16; ++s) {
+      BOOST_CHECK_EQUAL(table(s, codes(i, s)), 0.0f);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestExtractTopScaleFeatures) {
   FeatureKeypoints keypoints(5);
   keypoints[0].Rescale(3);
@@ -31,9 +31,12 @@
 
 #include "mvs/consistency_graph.h"
 
+#include <algorithm>
 #include <fstream>
+#include <limits>
 #include <numeric>
 
+#include "mvs/mat.h"
 #include "util/logging.h"
 #include "util/misc.h"
 
@@ -50,6 +53,10 @@ ConsistencyGraph::ConsistencyGraph(const size_t width, const size_t height,
   InitializeMap(width, height);
 }
 
+size_t ConsistencyGraph::GetWidth() const { return map_.cols(); }
+
+size_t ConsistencyGraph::GetHeight() const { return map_.rows(); }
+
 size_t ConsistencyGraph::GetNumBytes() const {
   return (data_.size() + map_.size()) * sizeof(int);
 }
@@ -68,6 +75,13 @@ void ConsistencyGraph::GetImageIdxs(const int row, const int col,
 }
 
 void ConsistencyGraph::Read(const std::string& path) {
+  if (ReadMatFormatTag(path) == CompactConsistencyGraph::kFormatTag) {
+    CompactConsistencyGraph compact_consistency_graph;
+    compact_consistency_graph.Read(path);
+    *this = compact_consistency_graph.ToConsistencyGraph();
+    return;
+  }
+
   std::fstream text_file(path, std::ios::in | std::ios::binary);
   CHECK(text_file.is_open()) << path;
 
@@ -127,5 +141,186 @@ void ConsistencyGraph::InitializeMap(const size_t width, const size_t height) {
   }
 }
 
+const std::string CompactConsistencyGraph::kFormatTag = "csr";
+
+CompactConsistencyGraph::CompactConsistencyGraph()
+    : row_offsets_(1, 0), image_offsets_(1, 0) {}
+
+CompactConsistencyGraph::CompactConsistencyGraph(
+    const ConsistencyGraph& consistency_graph)
+    : width_(consistency_graph.GetWidth()),
+      height_(consistency_graph.GetHeight()) {
+  CHECK_LE(width_, std::numeric_limits<uint16_t>::max() + 1);
+  row_offsets_.reserve(height_ + 1);
+  row_offsets_.push_back(0);
+  image_offsets_.push_back(0);
+  for (size_t row = 0; row < height_; ++row) {
+    for (size_t col = 0; col < width_; ++col) {
+      int num_images;
+      const int* image_idxs;
+      consistency_graph.GetImageIdxs(row, col, &num_images, &image_idxs);
+      if (num_images == 0) {
+        continue;
+      }
+      cols_.push_back(col);
+      for (int i = 0; i < num_images; ++i) {
+        CHECK_GE(image_idxs[i], 0);
+        CHECK_LE(image_idxs[i], std::numeric_limits<uint16_t>::max());
+        image_idxs_.push_back(image_idxs[i]);
+      }
+      image_offsets_.push_back(image_idxs_.size());
+    }
+    row_offsets_.push_back(cols_.size());
+  }
+}
+
+size_t CompactConsistencyGraph::GetWidth() const { return width_; }
+
+size_t CompactConsistencyGraph::GetHeight() const { return height_; }
+
+size_t CompactConsistencyGraph::GetNumBytes() const {
+  return (row_offsets_.size() + image_offsets_.size()) * sizeof(uint32_t) +
+         (cols_.size() + image_idxs_.size()) * sizeof(uint16_t);
+}
+
+void CompactConsistencyGraph::GetImageIdxs(
+    const int row, const int col, int* num_images,
+    const uint16_t** image_idxs) const {
+  *num_images = 0;
+  *image_idxs = nullptr;
+
+  if (row < static_cast<int>(row_begin_) ||
+      row >= static_cast<int>(row_begin_ + row_offsets_.size() - 1)) {
+    return;
+  }
+
+  const auto cols_begin = cols_.begin() + row_offsets_[row - row_begin_];
+  const auto cols_end = cols_.begin() + row_offsets_[row - row_begin_ + 1];
+  const auto col_it = std::lower_bound(cols_begin, cols_end, col);
+  if (col_it == cols_end || *col_it != col) {
+    return;
+  }
+
+  const size_t pixel_idx = col_it - cols_.begin();
+  *num_images = image_offsets_[pixel_idx + 1] - image_offsets_[pixel_idx];
+  *image_idxs = &image_idxs_[image_offsets_[pixel_idx]];
+}
+
+ConsistencyGraph CompactConsistencyGraph::ToConsistencyGraph() const {
+  std::vector<int> data;
+  data.reserve(3 * cols_.size() + image_idxs_.size());
+  for (size_t i = 0; i + 1 < row_offsets_.size(); ++i) {
+    for (uint32_t pixel_idx = row_offsets_[i]; pixel_idx < row_offsets_[i + 1];
+         ++pixel_idx) {
+      data.push_back(cols_[pixel_idx]);
+      data.push_back(row_begin_ + i);
+      data.push_back(image_offsets_[pixel_idx + 1] -
+                     image_offsets_[pixel_idx]);
+      data.insert(data.end(), image_idxs_.begin() + image_offsets_[pixel_idx],
+                  image_idxs_.begin() + image_offsets_[pixel_idx + 1]);
+    }
+  }
+  return ConsistencyGraph(width_, height_, data);
+}
+
+void CompactConsistencyGraph::Read(const std::string& path) {
+  if (ReadMatFormatTag(path) == kFormatTag) {
+    ReadRows(path, 0, std::numeric_limits<size_t>::max());
+  } else {
+    ConsistencyGraph consistency_graph;
+    consistency_graph.Read(path);
+    *this = CompactConsistencyGraph(consistency_graph);
+  }
+}
+
+void CompactConsistencyGraph::ReadRows(const std::string& path,
+                                       const size_t row_begin,
+                                       const size_t row_end) {
+  std::fstream text_file(path, std::ios::in | std::ios::binary);
+  CHECK(text_file.is_open()) << path;
+
+  std::string format_tag;
+  std::getline(text_file, format_tag, '&');
+  CHECK_EQ(format_tag, kFormatTag) << path;
+
+  size_t num_pixels = 0;
+  size_t num_image_idxs = 0;
+  char unused_char;
+  text_file >> width_ >> unused_char >> height_ >> unused_char >>
+      num_pixels >> unused_char >> num_image_idxs >> unused_char;
+  const std::streampos pos = text_file.tellg();
+  text_file.close();
+
+  CHECK_GT(width_, 0);
+  CHECK_GT(height_, 0);
+
+  std::fstream binary_file(path, std::ios::in | std::ios::binary);
+  CHECK(binary_file.is_open()) << path;
+  binary_file.seekg(pos);
+
+  std::vector<uint32_t> row_offsets(height_ + 1);
+  ReadBinaryLittleEndian<uint32_t>(&binary_file, &row_offsets);
+  CHECK_EQ(row_offsets.back(), num_pixels) << path;
+
+  row_begin_ = std::min(row_begin, height_);
+  const size_t row_end_clamped =
+      std::max(row_begin_, std::min(row_end, height_));
+  const uint32_t pixel_begin = row_offsets[row_begin_];
+  const uint32_t pixel_end = row_offsets[row_end_clamped];
+
+  row_offsets_.assign(row_offsets.begin() + row_begin_,
+                      row_offsets.begin() + row_end_clamped + 1);
+  for (auto& row_offset : row_offsets_) {
+    row_offset -= pixel_begin;
+  }
+
+  const std::streampos cols_pos = binary_file.tellg();
+  binary_file.seekg(
+      cols_pos + static_cast<std::streamoff>(pixel_begin * sizeof(uint16_t)));
+  cols_.resize(pixel_end - pixel_begin);
+  ReadBinaryLittleEndian<uint16_t>(&binary_file, &cols_);
+
+  const std::streampos image_offsets_pos =
+      cols_pos + static_cast<std::streamoff>(num_pixels * sizeof(uint16_t));
+  binary_file.seekg(image_offsets_pos + static_cast<std::streamoff>(
+                                            pixel_begin * sizeof(uint32_t)));
+  image_offsets_.resize(pixel_end - pixel_begin + 1);
+  ReadBinaryLittleEndian<uint32_t>(&binary_file, &image_offsets_);
+  const uint32_t image_idx_begin = image_offsets_.front();
+  for (auto& image_offset : image_offsets_) {
+    image_offset -= image_idx_begin;
+  }
+
+  const std::streampos image_idxs_pos =
+      image_offsets_pos +
+      static_cast<std::streamoff>((num_pixels + 1) * sizeof(uint32_t));
+  binary_file.seekg(image_idxs_pos + static_cast<std::streamoff>(
+                                         image_idx_begin * sizeof(uint16_t)));
+  image_idxs_.resize(image_offsets_.back());
+  ReadBinaryLittleEndian<uint16_t>(&binary_file, &image_idxs_);
+
+  CHECK(binary_file.good()) << path;
+}
+
+void CompactConsistencyGraph::Write(const std::string& path) const {
+  CHECK_EQ(row_begin_, 0);
+  CHECK_EQ(row_offsets_.size(), height_ + 1);
+
+  std::fstream text_file(path, std::ios::out);
+  CHECK(text_file.is_open()) << path;
+  text_file << kFormatTag << "&" << width_ << "&" << height_ << "&"
+            << cols_.size() << "&" << image_idxs_.size() << "&";
+  text_file.close();
+
+  std::fstream binary_file(path,
+                           std::ios::out | std::ios::binary | std::ios::app);
+  CHECK(binary_file.is_open()) << path;
+  WriteBinaryLittleEndian<uint32_t>(&binary_file, row_offsets_);
+  WriteBinaryLittleEndian<uint16_t>(&binary_file, cols_);
+  WriteBinaryLittleEndian<uint32_t>(&binary_file, image_offsets_);
+  WriteBinaryLittleEndian<uint16_t>(&binary_file, image_idxs_);
+  binary_file.close();
+}
+
 }  // namespace mvs
 }  // namespace colmap
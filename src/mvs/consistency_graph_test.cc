@@ -32,7 +32,10 @@
 #define TEST_NAME "mvs/consistency_graph_test"
 #include "util/testing.h"
 
+#include <boost/filesystem.hpp>
+
 #include "mvs/consistency_graph.h"
+#include "mvs/mat.h"
 
 using namespace colmap;
 using namespace colmap::mvs;
@@ -97,3 +100,84 @@ BOOST_AUTO_TEST_CASE(TestFull) {
   BOOST_CHECK_EQUAL(image_idxs[0], 100);
   BOOST_CHECK_EQUAL(consistency_graph.GetNumBytes(), 48);
 }
+
+BOOST_AUTO_TEST_CASE(TestCompact) {
+  const std::vector<int> data = {1, 0, 3, 5, 7, 33, 0, 1, 1, 100,
+                                 2, 1, 2, 4, 6,  0, 2, 0};
+  const ConsistencyGraph consistency_graph(3, 3, data);
+  const CompactConsistencyGraph compact_consistency_graph(consistency_graph);
+  BOOST_CHECK_EQUAL(compact_consistency_graph.GetWidth(), 3);
+  BOOST_CHECK_EQUAL(compact_consistency_graph.GetHeight(), 3);
+  BOOST_CHECK_EQUAL(compact_consistency_graph.GetNumBytes(),
+                    (4 + 4) * sizeof(uint32_t) + (3 + 6) * sizeof(uint16_t));
+
+  for (int row = 0; row < 3; ++row) {
+    for (int col = 0; col < 3; ++col) {
+      int num_images;
+      const int* image_idxs;
+      consistency_graph.GetImageIdxs(row, col, &num_images, &image_idxs);
+      int compact_num_images;
+      const uint16_t* compact_image_idxs;
+      compact_consistency_graph.GetImageIdxs(row, col, &compact_num_images,
+                                             &compact_image_idxs);
+      BOOST_CHECK_EQUAL(num_images, compact_num_images);
+      for (int i = 0; i < num_images; ++i) {
+        BOOST_CHECK_EQUAL(image_idxs[i], compact_image_idxs[i]);
+      }
+    }
+  }
+
+  int num_images;
+  const int* image_idxs;
+  const ConsistencyGraph converted_consistency_graph =
+      compact_consistency_graph.ToConsistencyGraph();
+  converted_consistency_graph.GetImageIdxs(1, 2, &num_images, &image_idxs);
+  BOOST_CHECK_EQUAL(num_images, 2);
+  BOOST_CHECK_EQUAL(image_idxs[0], 4);
+  BOOST_CHECK_EQUAL(image_idxs[1], 6);
+  converted_consistency_graph.GetImageIdxs(0, 2, &num_images, &image_idxs);
+  BOOST_CHECK_EQUAL(num_images, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestCompactReadWrite) {
+  const std::vector<int> data = {1, 0, 3, 5, 7, 33, 0, 1, 1, 100,
+                                 2, 1, 2, 4, 6,  1, 2, 1, 8};
+  const ConsistencyGraph consistency_graph(3, 3, data);
+  const std::string path = (boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path())
+                               .string();
+  CompactConsistencyGraph(consistency_graph).Write(path);
+  BOOST_CHECK_EQUAL(ReadMatFormatTag(path),
+                    CompactConsistencyGraph::kFormatTag);
+
+  ConsistencyGraph read_consistency_graph;
+  read_consistency_graph.Read(path);
+  BOOST_CHECK_EQUAL(read_consistency_graph.GetWidth(), 3);
+  BOOST_CHECK_EQUAL(read_consistency_graph.GetHeight(), 3);
+  int num_images;
+  const int* image_idxs;
+  read_consistency_graph.GetImageIdxs(0, 1, &num_images, &image_idxs);
+  BOOST_CHECK_EQUAL(num_images, 3);
+  BOOST_CHECK_EQUAL(image_idxs[2], 33);
+
+  CompactConsistencyGraph rows_consistency_graph;
+  rows_consistency_graph.ReadRows(path, 1, 2);
+  const uint16_t* compact_image_idxs;
+  rows_consistency_graph.GetImageIdxs(0, 1, &num_images, &compact_image_idxs);
+  BOOST_CHECK_EQUAL(num_images, 0);
+  rows_consistency_graph.GetImageIdxs(1, 0, &num_images, &compact_image_idxs);
+  BOOST_CHECK_EQUAL(num_images, 1);
+  BOOST_CHECK_EQUAL(compact_image_idxs[0], 100);
+  rows_consistency_graph.GetImageIdxs(1, 2, &num_images, &compact_image_idxs);
+  BOOST_CHECK_EQUAL(num_images, 2);
+  BOOST_CHECK_EQUAL(compact_image_idxs[1], 6);
+  rows_consistency_graph.GetImageIdxs(2, 1, &num_images, &compact_image_idxs);
+  BOOST_CHECK_EQUAL(num_images, 0);
+
+  rows_consistency_graph.ReadRows(path, 2, 10);
+  rows_consistency_graph.GetImageIdxs(2, 1, &num_images, &compact_image_idxs);
+  BOOST_CHECK_EQUAL(num_images, 1);
+  BOOST_CHECK_EQUAL(compact_image_idxs[0], 8);
+
+  boost::filesystem::remove(path);
+}
@@ -37,6 +37,7 @@
 #include <cuda_runtime.h>
 
 #include "mvs/gpu_mat.h"
+#include "mvs/gpu_memory_pool.h"
 #include "util/cudacc.h"
 
 namespace colmap {
@@ -58,6 +59,7 @@ class CudaArrayWrapper {
   void CopyToDevice(const T* data);
   void CopyToHost(const T* data);
   void CopyFromGpuMat(const GpuMat<T>& array);
+  void CopyFromGpuMatAsync(const GpuMat<T>& array, cudaStream_t stream);
 
  private:
   // Define class as non-copyable and non-movable.
@@ -68,7 +70,7 @@ class CudaArrayWrapper {
   void Allocate();
   void Deallocate();
 
-  cudaArray* array_;
+  std::shared_ptr<cudaArray> array_;
 
   size_t width_;
   size_t height_;
@@ -82,7 +84,7 @@ class CudaArrayWrapper {
 template <typename T>
 CudaArrayWrapper<T>::CudaArrayWrapper(const size_t width, const size_t height,
                                       const size_t depth)
-    : width_(width), height_(height), depth_(depth), array_(nullptr) {}
+    : width_(width), height_(height), depth_(depth) {}
 
 template <typename T>
 CudaArrayWrapper<T>::~CudaArrayWrapper() {
@@ -91,12 +93,12 @@ CudaArrayWrapper<T>::~CudaArrayWrapper() {
 
 template <typename T>
 const cudaArray* CudaArrayWrapper<T>::GetPtr() const {
-  return array_;
+  return array_.get();
 }
 
 template <typename T>
 cudaArray* CudaArrayWrapper<T>::GetPtr() {
-  return array_;
+  return array_.get();
 }
 
 template <typename T>
@@ -120,7 +122,7 @@ void CudaArrayWrapper<T>::CopyToDevice(const T* data) {
   Allocate();
   params.extent = make_cudaExtent(width_, height_, depth_);
   params.kind = cudaMemcpyHostToDevice;
-  params.dstArray = array_;
+  params.dstArray = array_.get();
   params.srcPtr =
       make_cudaPitchedPtr((void*)data, width_ * sizeof(T), width_, height_);
   CUDA_SAFE_CALL(cudaMemcpy3D(&params));
@@ -133,7 +135,7 @@ void CudaArrayWrapper<T>::CopyToHost(const T* data) {
   params.kind = cudaMemcpyDeviceToHost;
   params.dstPtr =
       make_cudaPitchedPtr((void*)data, width_ * sizeof(T), width_, height_);
-  params.srcArray = array_;
+  params.srcArray = array_.get();
   CUDA_SAFE_CALL(cudaMemcpy3D(&params));
 }
 
@@ -143,26 +145,36 @@ void CudaArrayWrapper<T>::CopyFromGpuMat(const GpuMat<T>& array) {
   cudaMemcpy3DParms parameters = {0};
   parameters.extent = make_cudaExtent(width_, height_, depth_);
   parameters.kind = cudaMemcpyDeviceToDevice;
-  parameters.dstArray = array_;
+  parameters.dstArray = array_.get();
   parameters.srcPtr = make_cudaPitchedPtr((void*)array.GetPtr(),
                                           array.GetPitch(), width_, height_);
   CUDA_SAFE_CALL(cudaMemcpy3D(&parameters));
 }
 
+template <typename T>
+void CudaArrayWrapper<T>::CopyFromGpuMatAsync(const GpuMat<T>& array,
+                                              cudaStream_t stream) {
+  Allocate();
+  cudaMemcpy3DParms parameters = {0};
+  parameters.extent = make_cudaExtent(width_, height_, depth_);
+  parameters.kind = cudaMemcpyDeviceToDevice;
+  parameters.dstArray = array_.get();
+  parameters.srcPtr = make_cudaPitchedPtr((void*)array.GetPtr(),
+                                          array.GetPitch(), width_, height_);
+  CUDA_SAFE_CALL(cudaMemcpy3DAsync(&parameters, stream));
+}
+
 template <typename T>
 void CudaArrayWrapper<T>::Allocate() {
   Deallocate();
   struct cudaExtent extent = make_cudaExtent(width_, height_, depth_);
   cudaChannelFormatDesc fmt = cudaCreateChannelDesc<T>();
-  CUDA_SAFE_CALL(cudaMalloc3DArray(&array_, &fmt, extent, cudaArrayLayered));
+  array_ = GpuMemoryPool::Get().AllocateArray(fmt, extent, cudaArrayLayered);
 }
 
 template <typename T>
 void CudaArrayWrapper<T>::Deallocate() {
-  if (array_ != nullptr) {
-    CUDA_SAFE_CALL(cudaFreeArray(array_));
-    array_ = nullptr;
-  }
+  array_.reset();
 }
 
 }  // namespace mvs
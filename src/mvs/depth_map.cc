@@ -54,6 +54,16 @@ DepthMap::DepthMap(const Mat<float>& mat, const float depth_min,
   data_ = mat.GetData();
 }
 
+void DepthMap::Read(const std::string& path) {
+  if (ReadMatFormatTag(path) == CompactDepthMap::kFormatTag) {
+    CompactDepthMap compact_depth_map;
+    compact_depth_map.Read(path);
+    *this = compact_depth_map.ToDepthMap();
+  } else {
+    Mat<float>::Read(path);
+  }
+}
+
 void DepthMap::Rescale(const float factor) {
   if (width_ * height_ == 0) {
     return;
@@ -127,5 +137,44 @@ Bitmap DepthMap::ToBitmap(const float min_percentile,
   return bitmap;
 }
 
+const std::string CompactDepthMap::kFormatTag = "f16";
+
+CompactDepthMap::CompactDepthMap() : Mat<uint16_t>(0, 0, 1) {}
+
+CompactDepthMap::CompactDepthMap(const DepthMap& depth_map)
+    : Mat<uint16_t>(depth_map.GetWidth(), depth_map.GetHeight(), 1),
+      depth_min_(depth_map.GetDepthMin()),
+      depth_max_(depth_map.GetDepthMax()) {
+  const float kMaxHalfValue = 65504.0f;
+  const std::vector<float>& depths = depth_map.GetData();
+  for (size_t i = 0; i < depths.size(); ++i) {
+    data_[i] = FloatToHalf(std::min(depths[i], kMaxHalfValue));
+  }
+}
+
+DepthMap CompactDepthMap::ToDepthMap() const {
+  DepthMap depth_map(width_, height_, depth_min_, depth_max_);
+  float* depths = depth_map.GetPtr();
+  for (size_t i = 0; i < data_.size(); ++i) {
+    depths[i] = HalfToFloat(data_[i]);
+  }
+  return depth_map;
+}
+
+void CompactDepthMap::Read(const std::string& path) {
+  if (ReadMatFormatTag(path) == kFormatTag) {
+    ReadWithFormatTag(path, kFormatTag);
+    CHECK_EQ(depth_, 1) << path;
+  } else {
+    DepthMap depth_map;
+    depth_map.Read(path);
+    *this = CompactDepthMap(depth_map);
+  }
+}
+
+void CompactDepthMap::Write(const std::string& path) const {
+  WriteWithFormatTag(path, kFormatTag);
+}
+
 }  // namespace mvs
 }  // namespace colmap
@@ -37,6 +37,7 @@
 
 #include "mvs/mat.h"
 #include "util/bitmap.h"
+#include "util/math.h"
 
 namespace colmap {
 namespace mvs {
@@ -53,6 +54,9 @@ class DepthMap : public Mat<float> {
 
   inline float Get(const size_t row, const size_t col) const;
 
+  // Read the depth map in the full precision or the compact format.
+  void Read(const std::string& path);
+
   void Rescale(const float factor);
   void Downsize(const size_t max_width, const size_t max_height);
 
@@ -63,6 +67,34 @@ class DepthMap : public Mat<float> {
   float depth_max_ = -1.0f;
 };
 
+// Depth map with half precision depths, which halves the memory and disk usage
+// at a relative depth precision of about 5e-4. Depths beyond the half
+// precision range are clamped to its maximum of 65504.
+class CompactDepthMap : public Mat<uint16_t> {
+ public:
+  // Tag that distinguishes the compact from the full precision file format.
+  static const std::string kFormatTag;
+
+  CompactDepthMap();
+  explicit CompactDepthMap(const DepthMap& depth_map);
+
+  inline float GetDepthMin() const;
+  inline float GetDepthMax() const;
+
+  inline float Get(const size_t row, const size_t col) const;
+
+  DepthMap ToDepthMap() const;
+
+  // Read the depth map in the full precision or the compact format and write
+  // it in the compact format.
+  void Read(const std::string& path);
+  void Write(const std::string& path) const;
+
+ private:
+  float depth_min_ = -1.0f;
+  float depth_max_ = -1.0f;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
@@ -75,6 +107,14 @@ float DepthMap::Get(const size_t row, const size_t col) const {
   return data_.at(row * width_ + col);
 }
 
+float CompactDepthMap::GetDepthMin() const { return depth_min_; }
+
+float CompactDepthMap::GetDepthMax() const { return depth_max_; }
+
+float CompactDepthMap::Get(const size_t row, const size_t col) const {
+  return HalfToFloat(data_.at(row * width_ + col));
+}
+
 }  // namespace mvs
 }  // namespace colmap
 
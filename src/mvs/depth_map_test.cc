@@ -32,6 +32,8 @@
 #define TEST_NAME "mvs/depth_map_test"
 #include "util/testing.h"
 
+#include <boost/filesystem.hpp>
+
 #include "mvs/depth_map.h"
 
 using namespace colmap;
@@ -94,3 +96,73 @@ BOOST_AUTO_TEST_CASE(TestToBitmap) {
   BOOST_CHECK(bitmap.GetPixel(1, 1, &color));
   BOOST_CHECK_EQUAL(color, BitmapColor<uint8_t>(128, 0, 0));
 }
+
+BOOST_AUTO_TEST_CASE(TestCompactDepthMap) {
+  DepthMap depth_map(3, 2, 0.1, 1e5);
+  depth_map.Set(0, 0, 0, 0);
+  depth_map.Set(0, 1, 0, 0.1);
+  depth_map.Set(0, 2, 0, 1);
+  depth_map.Set(1, 0, 0, 3.14159);
+  depth_map.Set(1, 1, 0, 1234.5);
+  depth_map.Set(1, 2, 0, 1e5);
+  const CompactDepthMap compact_depth_map(depth_map);
+  BOOST_CHECK_EQUAL(compact_depth_map.GetWidth(), 3);
+  BOOST_CHECK_EQUAL(compact_depth_map.GetHeight(), 2);
+  BOOST_CHECK_EQUAL(compact_depth_map.GetNumBytes(),
+                    depth_map.GetNumBytes() / 2);
+  BOOST_CHECK_EQUAL(compact_depth_map.GetDepthMin(), 0.1f);
+  BOOST_CHECK_EQUAL(compact_depth_map.GetDepthMax(), 1e5f);
+  BOOST_CHECK_EQUAL(compact_depth_map.Get(0, 0), 0);
+  BOOST_CHECK_EQUAL(compact_depth_map.Get(0, 2), 1);
+  BOOST_CHECK_EQUAL(compact_depth_map.Get(1, 2), 65504);
+  for (size_t col = 1; col < 3; ++col) {
+    BOOST_CHECK_CLOSE(compact_depth_map.Get(0, col), depth_map.Get(0, col),
+                      0.05);
+    BOOST_CHECK_CLOSE(compact_depth_map.Get(1, col - 1),
+                      depth_map.Get(1, col - 1), 0.05);
+  }
+
+  const DepthMap converted_depth_map = compact_depth_map.ToDepthMap();
+  BOOST_CHECK_EQUAL(converted_depth_map.GetWidth(), 3);
+  BOOST_CHECK_EQUAL(converted_depth_map.GetHeight(), 2);
+  for (size_t row = 0; row < 2; ++row) {
+    for (size_t col = 0; col < 3; ++col) {
+      BOOST_CHECK_EQUAL(converted_depth_map.Get(row, col),
+                        compact_depth_map.Get(row, col));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestCompactDepthMapReadWrite) {
+  DepthMap depth_map(3, 2, 0, 1);
+  depth_map.Fill(0.5);
+  depth_map.Set(1, 2, 0, 0.25);
+
+  const std::string path = (boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path())
+                               .string();
+
+  CompactDepthMap(depth_map).Write(path);
+  BOOST_CHECK_EQUAL(ReadMatFormatTag(path), CompactDepthMap::kFormatTag);
+
+  DepthMap read_depth_map;
+  read_depth_map.Read(path);
+  CompactDepthMap read_compact_depth_map;
+  read_compact_depth_map.Read(path);
+  BOOST_CHECK_EQUAL(read_depth_map.GetWidth(), 3);
+  BOOST_CHECK_EQUAL(read_depth_map.GetHeight(), 2);
+  BOOST_CHECK_EQUAL(read_compact_depth_map.GetWidth(), 3);
+  BOOST_CHECK_EQUAL(read_compact_depth_map.GetHeight(), 2);
+  BOOST_CHECK_EQUAL(read_depth_map.Get(0, 0), 0.5f);
+  BOOST_CHECK_EQUAL(read_depth_map.Get(1, 2), 0.25f);
+  BOOST_CHECK_EQUAL(read_compact_depth_map.Get(1, 2), 0.25f);
+
+  depth_map.Write(path);
+  BOOST_CHECK_EQUAL(ReadMatFormatTag(path), "");
+  read_compact_depth_map.Read(path);
+  BOOST_CHECK_EQUAL(read_compact_depth_map.GetWidth(), 3);
+  BOOST_CHECK_EQUAL(read_compact_depth_map.Get(0, 0), 0.5f);
+  BOOST_CHECK_EQUAL(read_compact_depth_map.Get(1, 2), 0.25f);
+
+  boost::filesystem::remove(path);
+}
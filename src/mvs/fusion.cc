@@ -31,12 +31,36 @@
 
 #include "mvs/fusion.h"
 
+#include <limits>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef CUDA_ENABLED
+#include "mvs/fusion_cuda.h"
+#endif
 #include "util/misc.h"
+#include "util/profiling.h"
+#include "util/random.h"
 
 namespace colmap {
 namespace mvs {
 namespace internal {
 
+// Number of fused points after which the points of sequential fusion are
+// added to the output.
+const size_t kNumFusedPointsPerChunk = 1 << 20;
+
+// Fraction of the cache size that is used for prefetching the images of the
+// current and next positions in the fusion order.
+const double kPrefetchCacheFraction = 0.1;
+const size_t kNumPrefetchPositions = 2;
+
+// Number of tiles of the deterministic parallel fusion, which is independent
+// of the number of threads, such that the fused points are the same.
+const size_t kNumDeterministicTiles = 64;
+
 template <typename T>
 float Median(std::vector<T>* elems) {
   CHECK(!elems->empty());
@@ -52,30 +76,92 @@ float Median(std::vector<T>* elems) {
   }
 }
 
-// Use the sparse model to find most connected image that has not yet been
-// fused. This is used as a heuristic to ensure that the workspace cache reuses
-// already cached images as efficient as possible.
-int FindNextImage(const std::vector<std::vector<int>>& overlapping_images,
-                  const std::vector<char>& used_images,
-                  const std::vector<char>& fused_images,
-                  const int prev_image_idx) {
-  CHECK_EQ(used_images.size(), fused_images.size());
+// Determine the order in which the used images are fused, such that the
+// images accessed by consecutive reference images are reused from a cache of
+// at most cache_num_images images. Fusing a reference image accesses the image
+// itself and its overlapping images. The order is determined greedily by
+// simulating a least recently used cache, where the next image is the not yet
+// fused image with the most of its accessed images in the cache.
+std::vector<int> ComputeFusionOrder(
+    const std::vector<std::vector<int>>& overlapping_images,
+    const std::vector<char>& used_images, const size_t cache_num_images) {
+  CHECK_EQ(overlapping_images.size(), used_images.size());
+  CHECK_GT(cache_num_images, 0);
+
+  const int num_images = static_cast<int>(used_images.size());
+
+  // For every image, the reference images whose fusion accesses the image.
+  std::vector<std::vector<int>> accessing_images(num_images);
+  for (int image_idx = 0; image_idx < num_images; ++image_idx) {
+    if (!used_images[image_idx]) {
+      continue;
+    }
+    accessing_images[image_idx].push_back(image_idx);
+    for (const int overlapping_image_idx : overlapping_images[image_idx]) {
+      if (used_images.at(overlapping_image_idx)) {
+        accessing_images[overlapping_image_idx].push_back(image_idx);
+      }
+    }
+  }
 
-  for (const auto image_idx : overlapping_images.at(prev_image_idx)) {
-    if (used_images.at(image_idx) && !fused_images.at(image_idx)) {
-      return image_idx;
+  // The not yet fused images sorted by their negative number of cached
+  // accessed images and their index, such that the best next image is first.
+  std::vector<int> num_cached(num_images, 0);
+  std::set<std::pair<int, int>> candidates;
+  for (int image_idx = 0; image_idx < num_images; ++image_idx) {
+    if (used_images[image_idx]) {
+      candidates.emplace(0, image_idx);
     }
   }
 
-  // If none of the overlapping images are not yet fused, simply return the
-  // first image that has not yet been fused.
-  for (size_t image_idx = 0; image_idx < fused_images.size(); ++image_idx) {
-    if (used_images[image_idx] && !fused_images[image_idx]) {
-      return image_idx;
+  const auto UpdateNumCached = [&](const int image_idx, const int delta) {
+    for (const int accessing_image_idx : accessing_images[image_idx]) {
+      int& count = num_cached[accessing_image_idx];
+      if (candidates.erase(std::make_pair(-count, accessing_image_idx))) {
+        candidates.emplace(-(count + delta), accessing_image_idx);
+      }
+      count += delta;
+    }
+  };
+
+  std::list<int> cache_list;
+  std::unordered_map<int, std::list<int>::iterator> cache_map;
+
+  const auto AccessImage = [&](const int image_idx) {
+    const auto it = cache_map.find(image_idx);
+    if (it == cache_map.end()) {
+      cache_list.push_front(image_idx);
+      cache_map.emplace(image_idx, cache_list.begin());
+      UpdateNumCached(image_idx, 1);
+    } else {
+      cache_list.splice(cache_list.begin(), cache_list, it->second);
+    }
+  };
+
+  std::vector<int> fusion_order;
+  fusion_order.reserve(candidates.size());
+
+  while (!candidates.empty()) {
+    const int image_idx = candidates.begin()->second;
+    candidates.erase(candidates.begin());
+    fusion_order.push_back(image_idx);
+
+    for (const int overlapping_image_idx : overlapping_images[image_idx]) {
+      if (used_images.at(overlapping_image_idx)) {
+        AccessImage(overlapping_image_idx);
+      }
+    }
+    AccessImage(image_idx);
+
+    while (cache_list.size() > cache_num_images) {
+      const int evicted_image_idx = cache_list.back();
+      cache_list.pop_back();
+      cache_map.erase(evicted_image_idx);
+      UpdateNumCached(evicted_image_idx, -1);
     }
   }
 
-  return -1;
+  return fusion_order;
 }
 
 }  // namespace internal
@@ -92,6 +178,15 @@ void StereoFusionOptions::Print() const {
   PrintOption(max_normal_error);
   PrintOption(check_num_images);
   PrintOption(cache_size);
+  PrintOption(distorted_image_path);
+  PrintOption(num_threads);
+  PrintOption(numa_aware);
+  PrintOption(compact_maps);
+  PrintOption(mmap_maps);
+  PrintOption(min_confidence);
+  PrintOption(use_gpu);
+  PrintOption(gpu_index);
+  PrintOption(gpu_cache_size);
 #undef PrintOption
 }
 
@@ -104,9 +199,115 @@ bool StereoFusionOptions::Check() const {
   CHECK_OPTION_GE(max_normal_error, 0);
   CHECK_OPTION_GT(check_num_images, 0);
   CHECK_OPTION_GT(cache_size, 0);
+  CHECK_OPTION_GE(num_threads, -1);
+  CHECK_OPTION_NE(num_threads, 0);
+  CHECK_OPTION_GE(min_confidence, 0);
+  CHECK_OPTION_GE(gpu_index, -1);
+  CHECK_OPTION_GT(gpu_cache_size, 0);
+  if (mmap_maps) {
+    CHECK_OPTION(!compact_maps);
+    CHECK_OPTION_LE(max_image_size, 0);
+  }
   return true;
 }
 
+size_t FusedPointsChunk::NumPoints() const { return points.size(); }
+
+void FusedPointsChunk::Clear() {
+  // Release the memory, since a chunk can be large.
+  std::vector<PlyPoint>().swap(points);
+  std::vector<uint32_t>().swap(num_visible_images);
+  std::vector<uint32_t>().swap(visible_image_idxs);
+}
+
+const uint64_t FusedPointsWriter::kChunkedVisibilityMarker =
+    std::numeric_limits<uint64_t>::max();
+
+FusedPointsWriter::FusedPointsWriter(const std::string& path)
+    : ply_writer_(path) {
+  const std::string vis_path = path + ".vis";
+  vis_file_.open(vis_path, std::ios::out | std::ios::binary);
+  CHECK(vis_file_.is_open()) << vis_path;
+  WriteBinaryLittleEndian<uint64_t>(&vis_file_, kChunkedVisibilityMarker);
+  // The number of points is overwritten on closing.
+  WriteBinaryLittleEndian<uint64_t>(&vis_file_, 0);
+}
+
+FusedPointsWriter::~FusedPointsWriter() { Close(); }
+
+size_t FusedPointsWriter::NumPoints() const { return ply_writer_.NumPoints(); }
+
+void FusedPointsWriter::Write(const FusedPointsChunk& chunk) {
+  CHECK(vis_file_.is_open());
+  CHECK_EQ(chunk.points.size(), chunk.num_visible_images.size());
+
+  ply_writer_.Write(chunk.points);
+
+  WriteBinaryLittleEndian<uint64_t>(&vis_file_, chunk.points.size());
+  WriteBinaryLittleEndian<uint64_t>(&vis_file_,
+                                    chunk.visible_image_idxs.size());
+  WriteBinaryLittleEndian<uint32_t>(&vis_file_, chunk.num_visible_images);
+  WriteBinaryLittleEndian<uint32_t>(&vis_file_, chunk.visible_image_idxs);
+}
+
+void FusedPointsWriter::Close() {
+  if (!vis_file_.is_open()) {
+    return;
+  }
+
+  vis_file_.seekp(sizeof(uint64_t));
+  WriteBinaryLittleEndian<uint64_t>(&vis_file_, ply_writer_.NumPoints());
+  vis_file_.close();
+
+  ply_writer_.Close();
+}
+
+StereoFusion::FusedPixelMask::FusedPixelMask() : width_(0), num_words_(0) {}
+
+StereoFusion::FusedPixelMask::FusedPixelMask(const int width, const int height)
+    : width_(width),
+      num_words_((static_cast<size_t>(width) * height + 31) / 32) {
+  words_.reset(new std::atomic<uint32_t>[num_words_]);
+  for (size_t i = 0; i < num_words_; ++i) {
+    words_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+bool StereoFusion::FusedPixelMask::IsSet(const int row, const int col) const {
+  const size_t idx = static_cast<size_t>(row) * width_ + col;
+  const uint32_t bit = 1u << (idx % 32);
+  return (words_[idx / 32].load(std::memory_order_relaxed) & bit) != 0;
+}
+
+bool StereoFusion::FusedPixelMask::TestAndSet(const int row, const int col) {
+  const size_t idx = static_cast<size_t>(row) * width_ + col;
+  const uint32_t bit = 1u << (idx % 32);
+  return (words_[idx / 32].fetch_or(bit, std::memory_order_relaxed) & bit) !=
+         0;
+}
+
+size_t StereoFusion::FusedPixelMask::NumWords() const { return num_words_; }
+
+void StereoFusion::FusedPixelMask::GetWords(uint32_t* words) const {
+  for (size_t i = 0; i < num_words_; ++i) {
+    words[i] = words_[i].load(std::memory_order_relaxed);
+  }
+}
+
+void StereoFusion::FusedPixelMask::SetWords(const uint32_t* words) {
+  for (size_t i = 0; i < num_words_; ++i) {
+    words_[i].store(words[i], std::memory_order_relaxed);
+  }
+}
+
+void StereoFusion::FusedPixelMask::Merge(const FusedPixelMask& other) {
+  CHECK_EQ(num_words_, other.num_words_);
+  for (size_t i = 0; i < num_words_; ++i) {
+    words_[i].fetch_or(other.words_[i].load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+  }
+}
+
 StereoFusion::StereoFusion(const StereoFusionOptions& options,
                            const std::string& workspace_path,
                            const std::string& workspace_format,
@@ -119,10 +320,18 @@ StereoFusion::StereoFusion(const StereoFusionOptions& options,
       input_type_(input_type),
       max_squared_reproj_error_(options_.max_reproj_error *
                                 options_.max_reproj_error),
-      min_cos_normal_error_(std::cos(DegToRad(options_.max_normal_error))) {
+      min_cos_normal_error_(std::cos(DegToRad(options_.max_normal_error))),
+      fused_points_writer_(nullptr),
+      num_fused_points_(0) {
   CHECK(options_.Check());
 }
 
+void StereoFusion::SetFusedPointsWriter(FusedPointsWriter* writer) {
+  fused_points_writer_ = writer;
+}
+
+size_t StereoFusion::NumFusedPoints() const { return num_fused_points_; }
+
 const std::vector<PlyPoint>& StereoFusion::GetFusedPoints() const {
   return fused_points_;
 }
@@ -133,6 +342,9 @@ const std::vector<std::vector<int>>& StereoFusion::GetFusedPointsVisibility()
 }
 
 void StereoFusion::Run() {
+  ProfileScope profile_scope("StereoFusion::Run");
+
+  num_fused_points_ = 0;
   fused_points_.clear();
   fused_points_visibility_.clear();
 
@@ -153,9 +365,12 @@ void StereoFusion::Run() {
   workspace_options.max_image_size = options_.max_image_size;
   workspace_options.image_as_rgb = true;
   workspace_options.cache_size = options_.cache_size;
+  workspace_options.prefetch_size =
+      internal::kPrefetchCacheFraction * options_.cache_size;
   workspace_options.workspace_path = workspace_path_;
   workspace_options.workspace_format = workspace_format_;
   workspace_options.input_type = input_type_;
+  workspace_options.distorted_image_path = options_.distorted_image_path;
 
   workspace_.reset(new Workspace(workspace_options));
 
@@ -177,7 +392,6 @@ void StereoFusion::Run() {
   }
 
   used_images_.resize(model.images.size(), false);
-  fused_images_.resize(model.images.size(), false);
   fused_pixel_masks_.resize(model.images.size());
   depth_map_sizes_.resize(model.images.size());
   bitmap_scales_.resize(model.images.size());
@@ -202,20 +416,38 @@ void StereoFusion::Run() {
     }
 
     const auto& image = model.images.at(image_idx);
-    const auto& depth_map = workspace_->GetDepthMap(image_idx);
+    size_t depth_map_width;
+    size_t depth_map_height;
+    if (options_.compact_maps) {
+      const auto& depth_map = workspace_->GetCompactDepthMap(image_idx);
+      depth_map_width = depth_map.GetWidth();
+      depth_map_height = depth_map.GetHeight();
+    } else if (options_.mmap_maps) {
+      const auto& depth_map = workspace_->GetMappedDepthMap(image_idx);
+      depth_map_width = depth_map.GetWidth();
+      depth_map_height = depth_map.GetHeight();
+    } else {
+      const auto& depth_map = workspace_->GetDepthMap(image_idx);
+      depth_map_width = depth_map.GetWidth();
+      depth_map_height = depth_map.GetHeight();
+    }
 
     used_images_.at(image_idx) = true;
 
     fused_pixel_masks_.at(image_idx) =
-        Mat<bool>(depth_map.GetWidth(), depth_map.GetHeight(), 1);
-    fused_pixel_masks_.at(image_idx).Fill(false);
+        FusedPixelMask(depth_map_width, depth_map_height);
 
     depth_map_sizes_.at(image_idx) =
-        std::make_pair(depth_map.GetWidth(), depth_map.GetHeight());
+        std::make_pair(depth_map_width, depth_map_height);
+
+    if (options_.min_confidence > 0 &&
+        workspace_->HasConfidenceMap(image_idx)) {
+      MaskUnconfidentPixels(image_idx);
+    }
 
     bitmap_scales_.at(image_idx) = std::make_pair(
-        static_cast<float>(depth_map.GetWidth()) / image.GetWidth(),
-        static_cast<float>(depth_map.GetHeight()) / image.GetHeight());
+        static_cast<float>(depth_map_width) / image.GetWidth(),
+        static_cast<float>(depth_map_height) / image.GetHeight());
 
     Eigen::Matrix<float, 3, 3, Eigen::RowMajor> K =
         Eigen::Map<const Eigen::Matrix<float, 3, 3, Eigen::RowMajor>>(
@@ -235,97 +467,562 @@ void StereoFusion::Run() {
             .transpose();
   }
 
+  const int num_threads = GetEffectiveNumThreads(options_.num_threads);
+
+  bool use_gpu = options_.use_gpu;
+#ifndef CUDA_ENABLED
+  if (use_gpu) {
+    std::cout << "WARNING: Requested GPU fusion, but COLMAP was built without "
+                 "CUDA support, falling back to the CPU fusion."
+              << std::endl;
+    use_gpu = false;
+  }
+#endif  // CUDA_ENABLED
+
+  if (use_gpu) {
+#ifdef CUDA_ENABLED
+    ScheduleFusion(options_.gpu_cache_size);
+    FuseCuda();
+#endif  // CUDA_ENABLED
+  } else if (kDeterministic) {
+    // The fusion order depends on the cache size, which must therefore not
+    // depend on the number of threads.
+    ScheduleFusion(options_.cache_size);
+    FuseParallel(num_threads);
+  } else {
+    ScheduleFusion(options_.cache_size / num_threads);
+    if (num_threads == 1) {
+      FuseSequential();
+    } else {
+      FuseParallel(num_threads);
+    }
+  }
+
+  fused_points_.shrink_to_fit();
+  fused_points_visibility_.shrink_to_fit();
+
+  if (num_fused_points_ == 0) {
+    std::cout << "WARNING: Could not fuse any points. This is likely caused by "
+                 "incorrect settings - filtering must be enabled for the last "
+                 "call to patch match stereo."
+              << std::endl;
+  }
+
+  std::cout << "Number of fused points: " << num_fused_points_ << std::endl;
+  GetTimer().PrintMinutes();
+}
+
+void StereoFusion::ScheduleFusion(const double cache_size) {
+  // Estimate the number of images that fit into the cache from the average
+  // size of the bitmaps, depth maps, and normal maps of the used images.
+  const auto& model = workspace_->GetModel();
+  double num_bytes = 0;
+  size_t num_used_images = 0;
+  for (size_t image_idx = 0; image_idx < used_images_.size(); ++image_idx) {
+    if (used_images_[image_idx]) {
+      const auto& image = model.images.at(image_idx);
+      const double num_map_pixels =
+          static_cast<double>(depth_map_sizes_[image_idx].first) *
+          depth_map_sizes_[image_idx].second;
+      // Note that the mapped maps have the same size as the full precision
+      // maps, since they count towards the cache size.
+      const double num_map_bytes_per_pixel =
+          options_.compact_maps
+              ? sizeof(uint16_t) + 2 * sizeof(int16_t)
+              : 4.0 * sizeof(float);
+      num_bytes += 3.0 * image.GetWidth() * image.GetHeight() +
+                   num_map_bytes_per_pixel * num_map_pixels;
+      num_used_images += 1;
+    }
+  }
+
+  size_t cache_num_images = 1;
+  if (num_used_images > 0 && num_bytes > 0) {
+    const double cache_num_bytes = 1024.0 * 1024.0 * 1024.0 * cache_size;
+    cache_num_images = std::max<size_t>(
+        1, static_cast<size_t>(cache_num_bytes * num_used_images / num_bytes));
+  }
+
+  fusion_order_ = internal::ComputeFusionOrder(overlapping_images_,
+                                               used_images_, cache_num_images);
+
+  fusion_order_accesses_.clear();
+  fusion_order_accesses_.resize(used_images_.size());
+  for (size_t position = 0; position < fusion_order_.size(); ++position) {
+    const int image_idx = fusion_order_[position];
+    fusion_order_accesses_[image_idx].push_back(position);
+    for (const int overlapping_image_idx : overlapping_images_[image_idx]) {
+      fusion_order_accesses_.at(overlapping_image_idx).push_back(position);
+    }
+  }
+}
+
+size_t StereoFusion::GetNextAccess(const int image_idx,
+                                   const size_t position) const {
+  const auto& accesses = fusion_order_accesses_.at(image_idx);
+  const auto next_access =
+      std::lower_bound(accesses.begin(), accesses.end(), position);
+  if (next_access == accesses.end()) {
+    return std::numeric_limits<size_t>::max();
+  }
+  return *next_access;
+}
+
+void StereoFusion::PrefetchImages(const size_t begin, const size_t end,
+                                  Workspace* workspace) const {
+  std::vector<int> image_idxs;
+  std::unordered_set<int> unique_image_idxs;
+  for (size_t position = begin; position < end; ++position) {
+    const int image_idx = fusion_order_[position];
+    if (unique_image_idxs.insert(image_idx).second) {
+      image_idxs.push_back(image_idx);
+    }
+    for (const int overlapping_image_idx : overlapping_images_[image_idx]) {
+      if (used_images_.at(overlapping_image_idx) &&
+          unique_image_idxs.insert(overlapping_image_idx).second) {
+        image_idxs.push_back(overlapping_image_idx);
+      }
+    }
+  }
+
+  // The compact and memory mapped maps are read directly in their format.
+  const bool full_maps = !options_.compact_maps && !options_.mmap_maps;
+  workspace->Prefetch(image_idxs, true, full_maps, full_maps);
+}
+
+void StereoFusion::FuseSequential() {
+  FusionState state;
+  state.workspace = workspace_.get();
+  state.fused_images.resize(used_images_.size(), false);
+
+  // Evict the cached image that is accessed last in the fusion order.
+  size_t position = 0;
+  workspace_->SetCacheEvictionRankFunc([this, &position](const int image_idx) {
+    return GetNextAccess(image_idx, position);
+  });
+
   size_t num_fused_images = 0;
-  for (int image_idx = 0; image_idx >= 0;
-       image_idx = internal::FindNextImage(overlapping_images_, used_images_,
-                                           fused_images_, image_idx)) {
+  for (; position < fusion_order_.size(); ++position) {
     if (IsStopped()) {
       break;
     }
 
+    const int image_idx = fusion_order_[position];
+
+    PrefetchImages(position,
+                   std::min(fusion_order_.size(),
+                            position + internal::kNumPrefetchPositions),
+                   workspace_.get());
+
     Timer timer;
     timer.Start();
 
     std::cout << StringPrintf("Fusing image [%d/%d]", num_fused_images + 1,
-                              model.images.size())
+                              fusion_order_.size())
               << std::flush;
 
+    FuseImage(image_idx, &state);
+
+    num_fused_images += 1;
+
+    if (state.fused_points.NumPoints() >= internal::kNumFusedPointsPerChunk) {
+      AddFusedPoints(&state.fused_points);
+    }
+
+    std::cout << StringPrintf(" in %.3fs (%d points)", timer.ElapsedSeconds(),
+                              num_fused_points_ +
+                                  state.fused_points.NumPoints())
+              << std::endl;
+  }
+
+  workspace_->SetCacheEvictionRankFunc(nullptr);
+
+  AddFusedPoints(&state.fused_points);
+}
+
+void StereoFusion::FuseParallel(const int num_threads) {
+  // Tiles of consecutive images in the fusion order overlap, such that they
+  // reuse the cached images of their threads.
+  const std::vector<int>& image_idxs = fusion_order_;
+
+  // Use multiple tiles per thread for better load balancing.
+  const size_t kNumTilesPerThread = 4;
+  const size_t num_tiles = std::min(
+      image_idxs.size(), kDeterministic ? internal::kNumDeterministicTiles
+                                        : kNumTilesPerThread * num_threads);
+  if (num_tiles == 0) {
+    return;
+  }
+  const size_t num_images_per_tile =
+      (image_idxs.size() + num_tiles - 1) / num_tiles;
+
+  // The images loaded during the setup are not needed anymore, since every
+  // thread uses its own workspace with an equal share of the cache.
+  workspace_->ClearCache();
+  Workspace::Options workspace_options = workspace_->GetOptions();
+  workspace_options.cache_size /= num_threads;
+  workspace_options.prefetch_size /= num_threads;
+
+  std::vector<std::unique_ptr<Workspace>> workspaces(num_threads);
+  std::vector<size_t> positions(num_threads, 0);
+  std::vector<FusionState> states(num_tiles);
+
+  // The points of finished tiles are added to the output in the order of the
+  // tiles, as soon as all previous tiles are finished.
+  std::vector<char> finished_tiles(num_tiles, false);
+  size_t next_tile_idx = 0;
+
+  // The pixels claimed by the added tiles in the deterministic fusion.
+  std::vector<FusedPixelMask> claimed_pixel_masks(used_images_.size());
+  auto AddTileFusedPoints = [&](FusionState* state) {
+    if (kDeterministic) {
+      CommitFusedPoints(state, &claimed_pixel_masks);
+    } else {
+      AddFusedPoints(&state->fused_points);
+    }
+  };
+
+  ThreadPool thread_pool(num_threads, options_.numa_aware);
+  std::mutex mutex;
+  size_t num_fused_tiles = 0;
+
+  for (size_t tile_idx = 0; tile_idx < num_tiles; ++tile_idx) {
+    thread_pool.AddTask([&, tile_idx]() {
+      if (IsStopped()) {
+        return;
+      }
+
+      Timer timer;
+      timer.Start();
+
+      const int thread_idx = thread_pool.GetThreadIndex();
+      size_t& position = positions.at(thread_idx);
+      std::unique_ptr<Workspace>& workspace = workspaces.at(thread_idx);
+      if (!workspace) {
+        workspace.reset(new Workspace(workspace_options));
+        workspace->SetCacheEvictionRankFunc(
+            [this, &position](const int image_idx) {
+              return GetNextAccess(image_idx, position);
+            });
+      }
+
+      FusionState& state = states[tile_idx];
+      state.workspace = workspace.get();
+      state.fused_images.resize(used_images_.size(), false);
+      if (kDeterministic) {
+        state.fused_pixel_masks.resize(used_images_.size());
+      }
+
+      const size_t begin = tile_idx * num_images_per_tile;
+      const size_t end =
+          std::min(image_idxs.size(), begin + num_images_per_tile);
+      for (position = begin; position < end; ++position) {
+        PrefetchImages(
+            position,
+            std::min(end, position + internal::kNumPrefetchPositions),
+            workspace.get());
+        FuseImage(image_idxs[position], &state);
+      }
+
+      std::unique_lock<std::mutex> lock(mutex);
+      num_fused_tiles += 1;
+      std::cout << StringPrintf("Fused tile [%d/%d] with %d images in %.3fs "
+                                "(%d points)",
+                                num_fused_tiles, num_tiles, end - begin,
+                                timer.ElapsedSeconds(),
+                                state.fused_points.NumPoints())
+                << std::endl;
+
+      finished_tiles[tile_idx] = true;
+      while (next_tile_idx < num_tiles && finished_tiles[next_tile_idx]) {
+        AddTileFusedPoints(&states[next_tile_idx]);
+        next_tile_idx += 1;
+      }
+    });
+  }
+
+  thread_pool.Wait();
+
+  // Add the points of the remaining tiles, if the fusion was stopped.
+  for (; next_tile_idx < num_tiles; ++next_tile_idx) {
+    AddTileFusedPoints(&states[next_tile_idx]);
+  }
+}
+
+#ifdef CUDA_ENABLED
+
+void StereoFusion::FuseCuda() {
+  StereoFusionCuda::Options cuda_options;
+  cuda_options.gpu_index = options_.gpu_index;
+  cuda_options.min_num_pixels = options_.min_num_pixels;
+  cuda_options.max_num_pixels = options_.max_num_pixels;
+  cuda_options.max_reproj_error = options_.max_reproj_error;
+  cuda_options.max_depth_error = options_.max_depth_error;
+  cuda_options.min_cos_normal_error = min_cos_normal_error_;
+  StereoFusionCuda fusion_cuda(cuda_options);
+
+  const size_t max_num_bytes =
+      static_cast<size_t>(1024.0 * 1024.0 * 1024.0 * options_.gpu_cache_size);
+
+  // Upload an image with its fused pixel mask to the device.
+  auto UploadImage = [&](const int image_idx) {
     const int width = depth_map_sizes_.at(image_idx).first;
     const int height = depth_map_sizes_.at(image_idx).second;
+    std::vector<float> depth_map(static_cast<size_t>(width) * height);
+    std::vector<float> normal_map(3 * depth_map.size());
+    for (int row = 0; row < height; ++row) {
+      for (int col = 0; col < width; ++col) {
+        const size_t idx = static_cast<size_t>(row) * width + col;
+        depth_map[idx] = GetDepth(workspace_.get(), image_idx, row, col);
+        GetNormal(workspace_.get(), image_idx, row, col, &normal_map[3 * idx]);
+      }
+    }
+
+    const auto& bitmap = workspace_->GetBitmap(image_idx);
+    std::vector<uint8_t> bitmap_data(3 * static_cast<size_t>(bitmap.Width()) *
+                                     bitmap.Height());
+    for (int y = 0; y < bitmap.Height(); ++y) {
+      for (int x = 0; x < bitmap.Width(); ++x) {
+        BitmapColor<uint8_t> color;
+        bitmap.GetPixel(x, y, &color);
+        const size_t idx = 3 * (static_cast<size_t>(y) * bitmap.Width() + x);
+        bitmap_data[idx] = color.r;
+        bitmap_data[idx + 1] = color.g;
+        bitmap_data[idx + 2] = color.b;
+      }
+    }
+
     const auto& fused_pixel_mask = fused_pixel_masks_.at(image_idx);
+    std::vector<uint32_t> fused_pixel_mask_words(fused_pixel_mask.NumWords());
+    fused_pixel_mask.GetWords(fused_pixel_mask_words.data());
+
+    StereoFusionCuda::HostImage image;
+    image.width = width;
+    image.height = height;
+    image.depth_map = depth_map.data();
+    image.normal_map = normal_map.data();
+    image.fused_pixel_mask = fused_pixel_mask_words.data();
+    image.bitmap_width = bitmap.Width();
+    image.bitmap_height = bitmap.Height();
+    image.bitmap = bitmap_data.data();
+    image.bitmap_scale_x = bitmap_scales_.at(image_idx).first;
+    image.bitmap_scale_y = bitmap_scales_.at(image_idx).second;
+    std::copy(P_.at(image_idx).data(), P_.at(image_idx).data() + 12, image.P);
+    std::copy(inv_P_.at(image_idx).data(), inv_P_.at(image_idx).data() + 12,
+              image.inv_P);
+    std::copy(inv_R_.at(image_idx).data(), inv_R_.at(image_idx).data() + 9,
+              image.inv_R);
+    fusion_cuda.UploadImage(image_idx, image);
+  };
+
+  // Release an image and copy its fused pixel mask back to the host.
+  auto ReleaseImage = [&](const int image_idx) {
+    auto& fused_pixel_mask = fused_pixel_masks_.at(image_idx);
+    std::vector<uint32_t> fused_pixel_mask_words(fused_pixel_mask.NumWords());
+    fusion_cuda.ReleaseImage(image_idx, fused_pixel_mask_words.data());
+    fused_pixel_mask.SetWords(fused_pixel_mask_words.data());
+  };
+
+  std::vector<char> fused_images(used_images_.size(), false);
+  std::vector<StereoFusionCuda::FusedPoint> cuda_fused_points;
+  FusedPointsChunk fused_points;
+
+  for (size_t position = 0; position < fusion_order_.size(); ++position) {
+    if (IsStopped()) {
+      break;
+    }
+
+    Timer timer;
+    timer.Start();
+
+    std::cout << StringPrintf("Fusing image [%d/%d]", position + 1,
+                              fusion_order_.size())
+              << std::flush;
+
+    const int ref_image_idx = fusion_order_[position];
+
+    // Already fused reference images are skipped, as in the CPU fusion.
+    std::vector<int> src_image_idxs;
+    for (const int image_idx : overlapping_images_.at(ref_image_idx)) {
+      if (used_images_.at(image_idx) && !fused_images.at(image_idx) &&
+          src_image_idxs.size() <
+              static_cast<size_t>(StereoFusionCuda::kMaxNumSrcImages)) {
+        src_image_idxs.push_back(image_idx);
+      }
+    }
 
-    FusionData data;
-    data.image_idx = image_idx;
-    data.traversal_depth = 0;
+    std::unordered_set<int> image_idxs(src_image_idxs.begin(),
+                                       src_image_idxs.end());
+    image_idxs.insert(ref_image_idx);
 
-    for (data.row = 0; data.row < height; ++data.row) {
-      for (data.col = 0; data.col < width; ++data.col) {
-        if (fused_pixel_mask.Get(data.row, data.col)) {
-          continue;
+    // Evict the images on the device that are accessed last in the fusion
+    // order, until the missing images fit into the cache.
+    for (const int image_idx : image_idxs) {
+      if (fusion_cuda.HasImage(image_idx)) {
+        continue;
+      }
+
+      while (fusion_cuda.NumBytes() >= max_num_bytes) {
+        int evicted_image_idx = -1;
+        size_t evicted_next_access = 0;
+        for (const int cached_image_idx : fusion_cuda.GetImageIdxs()) {
+          if (image_idxs.count(cached_image_idx) > 0) {
+            continue;
+          }
+          const size_t next_access = GetNextAccess(cached_image_idx, position);
+          if (evicted_image_idx == -1 || next_access > evicted_next_access) {
+            evicted_image_idx = cached_image_idx;
+            evicted_next_access = next_access;
+          }
+        }
+        if (evicted_image_idx == -1) {
+          break;
         }
+        ReleaseImage(evicted_image_idx);
+      }
 
-        fusion_queue_.push_back(data);
+      UploadImage(image_idx);
+    }
 
-        Fuse();
+    fusion_cuda.FuseImage(ref_image_idx, src_image_idxs, &cuda_fused_points);
+
+    for (const auto& cuda_fused_point : cuda_fused_points) {
+      PlyPoint fused_point;
+      fused_point.x = cuda_fused_point.x;
+      fused_point.y = cuda_fused_point.y;
+      fused_point.z = cuda_fused_point.z;
+      fused_point.nx = cuda_fused_point.nx;
+      fused_point.ny = cuda_fused_point.ny;
+      fused_point.nz = cuda_fused_point.nz;
+      fused_point.r = cuda_fused_point.r;
+      fused_point.g = cuda_fused_point.g;
+      fused_point.b = cuda_fused_point.b;
+      fused_points.points.push_back(fused_point);
+
+      uint32_t num_visible_images = 0;
+      for (size_t i = 0; i <= src_image_idxs.size(); ++i) {
+        if (cuda_fused_point.visibility & (static_cast<uint64_t>(1) << i)) {
+          fused_points.visible_image_idxs.push_back(
+              i == 0 ? ref_image_idx : src_image_idxs[i - 1]);
+          num_visible_images += 1;
+        }
       }
+      fused_points.num_visible_images.push_back(num_visible_images);
     }
 
-    num_fused_images += 1;
-    fused_images_.at(image_idx) = true;
+    // The reference image is not accessed anymore, since fused images are
+    // skipped by the following reference images.
+    fusion_cuda.ReleaseImage(ref_image_idx, nullptr);
+    fused_images.at(ref_image_idx) = true;
+
+    ProfileCounter("fused_images", 1);
+
+    if (fused_points.NumPoints() >= internal::kNumFusedPointsPerChunk) {
+      AddFusedPoints(&fused_points);
+    }
 
     std::cout << StringPrintf(" in %.3fs (%d points)", timer.ElapsedSeconds(),
-                              fused_points_.size())
+                              num_fused_points_ + fused_points.NumPoints())
               << std::endl;
   }
 
-  fused_points_.shrink_to_fit();
-  fused_points_visibility_.shrink_to_fit();
+  AddFusedPoints(&fused_points);
+}
 
-  if (fused_points_.empty()) {
-    std::cout << "WARNING: Could not fuse any points. This is likely caused by "
-                 "incorrect settings - filtering must be enabled for the last "
-                 "call to patch match stereo."
+#endif  // CUDA_ENABLED
+
+void StereoFusion::MaskUnconfidentPixels(const int image_idx) {
+  const int width = depth_map_sizes_.at(image_idx).first;
+  const int height = depth_map_sizes_.at(image_idx).second;
+
+  Mat<uint8_t> confidence_map;
+  confidence_map.Read(workspace_->GetConfidenceMapPath(image_idx));
+  if (confidence_map.GetWidth() != static_cast<size_t>(width) ||
+      confidence_map.GetHeight() != static_cast<size_t>(height)) {
+    std::cout << StringPrintf(
+                     "WARNING: Ignoring confidence map of image %s, because "
+                     "its size differs from the depth map.",
+                     workspace_->GetModel().GetImageName(image_idx).c_str())
               << std::endl;
+    return;
   }
 
-  std::cout << "Number of fused points: " << fused_points_.size() << std::endl;
-  GetTimer().PrintMinutes();
+  auto& fused_pixel_mask = fused_pixel_masks_.at(image_idx);
+  size_t num_masked_pixels = 0;
+  for (int row = 0; row < height; ++row) {
+    for (int col = 0; col < width; ++col) {
+      if (confidence_map.Get(row, col) < options_.min_confidence) {
+        fused_pixel_mask.TestAndSet(row, col);
+        num_masked_pixels += 1;
+      }
+    }
+  }
+
+  ProfileCounter("unconfident_pixels", num_masked_pixels);
 }
 
-void StereoFusion::Fuse() {
-  CHECK_EQ(fusion_queue_.size(), 1);
+void StereoFusion::FuseImage(const int image_idx, FusionState* state) {
+  ProfileScope profile_scope("StereoFusion::FuseImage");
+  ProfileCounter("fused_images", 1);
+
+  const int width = depth_map_sizes_.at(image_idx).first;
+  const int height = depth_map_sizes_.at(image_idx).second;
+  const auto& fused_pixel_mask = GetFusedPixelMask(image_idx, state);
+
+  FusionData data;
+  data.image_idx = image_idx;
+  data.traversal_depth = 0;
+
+  for (data.row = 0; data.row < height; ++data.row) {
+    for (data.col = 0; data.col < width; ++data.col) {
+      if (fused_pixel_mask.IsSet(data.row, data.col)) {
+        continue;
+      }
+
+      state->fusion_queue.push_back(data);
+
+      Fuse(state);
+    }
+  }
+
+  state->fused_images.at(image_idx) = true;
+}
+
+void StereoFusion::Fuse(FusionState* state) {
+  CHECK_EQ(state->fusion_queue.size(), 1);
+
+  const FusionData ref_data = state->fusion_queue.front();
 
   Eigen::Vector4f fused_ref_point = Eigen::Vector4f::Zero();
   Eigen::Vector3f fused_ref_normal = Eigen::Vector3f::Zero();
 
-  fused_point_x_.clear();
-  fused_point_y_.clear();
-  fused_point_z_.clear();
-  fused_point_nx_.clear();
-  fused_point_ny_.clear();
-  fused_point_nz_.clear();
-  fused_point_r_.clear();
-  fused_point_g_.clear();
-  fused_point_b_.clear();
-  fused_point_visibility_.clear();
-
-  while (!fusion_queue_.empty()) {
-    const auto data = fusion_queue_.back();
+  state->fused_point_x.clear();
+  state->fused_point_y.clear();
+  state->fused_point_z.clear();
+  state->fused_point_nx.clear();
+  state->fused_point_ny.clear();
+  state->fused_point_nz.clear();
+  state->fused_point_r.clear();
+  state->fused_point_g.clear();
+  state->fused_point_b.clear();
+  state->fused_point_visibility.clear();
+
+  while (!state->fusion_queue.empty()) {
+    const auto data = state->fusion_queue.back();
     const int image_idx = data.image_idx;
     const int row = data.row;
     const int col = data.col;
     const int traversal_depth = data.traversal_depth;
 
-    fusion_queue_.pop_back();
+    state->fusion_queue.pop_back();
 
     // Check if pixel already fused.
-    auto& fused_pixel_mask = fused_pixel_masks_.at(image_idx);
-    if (fused_pixel_mask.Get(row, col)) {
+    auto& fused_pixel_mask = GetFusedPixelMask(image_idx, state);
+    if (fused_pixel_mask.IsSet(row, col)) {
       continue;
     }
 
-    const auto& depth_map = workspace_->GetDepthMap(image_idx);
-    const float depth = depth_map.Get(row, col);
+    const float depth = GetDepth(state->workspace, image_idx, row, col);
 
     // Pixels with negative depth are filtered.
     if (depth <= 0.0f) {
@@ -355,11 +1052,9 @@ void StereoFusion::Fuse() {
     }
 
     // Determine normal direction in global reference frame.
-    const auto& normal_map = workspace_->GetNormalMap(image_idx);
-    const Eigen::Vector3f normal =
-        inv_R_.at(image_idx) * Eigen::Vector3f(normal_map.Get(row, col, 0),
-                                               normal_map.Get(row, col, 1),
-                                               normal_map.Get(row, col, 2));
+    Eigen::Vector3f normal;
+    GetNormal(state->workspace, image_idx, row, col, normal.data());
+    normal = inv_R_.at(image_idx) * normal;
 
     // Check for consistent normal direction with reference normal.
     if (traversal_depth > 0) {
@@ -377,23 +1072,25 @@ void StereoFusion::Fuse() {
     // Read the color of the pixel.
     BitmapColor<uint8_t> color;
     const auto& bitmap_scale = bitmap_scales_.at(image_idx);
-    workspace_->GetBitmap(image_idx).InterpolateNearestNeighbor(
+    state->workspace->GetBitmap(image_idx).InterpolateNearestNeighbor(
         col / bitmap_scale.first, row / bitmap_scale.second, &color);
 
-    // Set the current pixel as visited.
-    fused_pixel_mask.Set(row, col, true);
+    // Set the current pixel as visited, unless another thread was faster.
+    if (fused_pixel_mask.TestAndSet(row, col)) {
+      continue;
+    }
 
     // Accumulate statistics for fused point.
-    fused_point_x_.push_back(xyz(0));
-    fused_point_y_.push_back(xyz(1));
-    fused_point_z_.push_back(xyz(2));
-    fused_point_nx_.push_back(normal(0));
-    fused_point_ny_.push_back(normal(1));
-    fused_point_nz_.push_back(normal(2));
-    fused_point_r_.push_back(color.r);
-    fused_point_g_.push_back(color.g);
-    fused_point_b_.push_back(color.b);
-    fused_point_visibility_.insert(image_idx);
+    state->fused_point_x.push_back(xyz(0));
+    state->fused_point_y.push_back(xyz(1));
+    state->fused_point_z.push_back(xyz(2));
+    state->fused_point_nx.push_back(normal(0));
+    state->fused_point_ny.push_back(normal(1));
+    state->fused_point_nz.push_back(normal(2));
+    state->fused_point_r.push_back(color.r);
+    state->fused_point_g.push_back(color.g);
+    state->fused_point_b.push_back(color.b);
+    state->fused_point_visibility.insert(image_idx);
 
     // Remember the first pixel as the reference.
     if (traversal_depth == 0) {
@@ -401,7 +1098,8 @@ void StereoFusion::Fuse() {
       fused_ref_normal = normal;
     }
 
-    if (fused_point_x_.size() >= static_cast<size_t>(options_.max_num_pixels)) {
+    if (state->fused_point_x.size() >=
+        static_cast<size_t>(options_.max_num_pixels)) {
       break;
     }
 
@@ -414,7 +1112,7 @@ void StereoFusion::Fuse() {
 
     for (const auto next_image_idx : overlapping_images_.at(image_idx)) {
       if (!used_images_.at(next_image_idx) ||
-          fused_images_.at(next_image_idx)) {
+          state->fused_images.at(next_image_idx)) {
         continue;
       }
 
@@ -432,46 +1130,166 @@ void StereoFusion::Fuse() {
         continue;
       }
 
-      fusion_queue_.push_back(next_data);
+      state->fusion_queue.push_back(next_data);
     }
   }
 
-  fusion_queue_.clear();
+  state->fusion_queue.clear();
 
-  const size_t num_pixels = fused_point_x_.size();
+  const size_t num_pixels = state->fused_point_x.size();
   if (num_pixels >= static_cast<size_t>(options_.min_num_pixels)) {
     PlyPoint fused_point;
 
     Eigen::Vector3f fused_normal;
-    fused_normal.x() = internal::Median(&fused_point_nx_);
-    fused_normal.y() = internal::Median(&fused_point_ny_);
-    fused_normal.z() = internal::Median(&fused_point_nz_);
+    fused_normal.x() = internal::Median(&state->fused_point_nx);
+    fused_normal.y() = internal::Median(&state->fused_point_ny);
+    fused_normal.z() = internal::Median(&state->fused_point_nz);
     const float fused_normal_norm = fused_normal.norm();
     if (fused_normal_norm < std::numeric_limits<float>::epsilon()) {
       return;
     }
 
-    fused_point.x = internal::Median(&fused_point_x_);
-    fused_point.y = internal::Median(&fused_point_y_);
-    fused_point.z = internal::Median(&fused_point_z_);
+    fused_point.x = internal::Median(&state->fused_point_x);
+    fused_point.y = internal::Median(&state->fused_point_y);
+    fused_point.z = internal::Median(&state->fused_point_z);
 
     fused_point.nx = fused_normal.x() / fused_normal_norm;
     fused_point.ny = fused_normal.y() / fused_normal_norm;
     fused_point.nz = fused_normal.z() / fused_normal_norm;
 
     fused_point.r = TruncateCast<float, uint8_t>(
-        std::round(internal::Median(&fused_point_r_)));
+        std::round(internal::Median(&state->fused_point_r)));
     fused_point.g = TruncateCast<float, uint8_t>(
-        std::round(internal::Median(&fused_point_g_)));
+        std::round(internal::Median(&state->fused_point_g)));
     fused_point.b = TruncateCast<float, uint8_t>(
-        std::round(internal::Median(&fused_point_b_)));
+        std::round(internal::Median(&state->fused_point_b)));
+
+    state->fused_points.points.push_back(fused_point);
+    state->fused_points.num_visible_images.push_back(
+        state->fused_point_visibility.size());
+    state->fused_points.visible_image_idxs.insert(
+        state->fused_points.visible_image_idxs.end(),
+        state->fused_point_visibility.begin(),
+        state->fused_point_visibility.end());
+    if (!state->fused_pixel_masks.empty()) {
+      state->fused_point_refs.push_back(ref_data);
+    }
+  }
+}
+
+StereoFusion::FusedPixelMask& StereoFusion::GetFusedPixelMask(
+    const int image_idx, FusionState* state) {
+  if (state->fused_pixel_masks.empty()) {
+    return fused_pixel_masks_.at(image_idx);
+  }
+
+  // Copy the shared mask, which is not modified during the deterministic
+  // fusion, on the first access, such that it contains the masked pixels.
+  auto& fused_pixel_mask = state->fused_pixel_masks.at(image_idx);
+  if (fused_pixel_mask.NumWords() == 0) {
+    const auto& depth_map_size = depth_map_sizes_.at(image_idx);
+    fused_pixel_mask =
+        FusedPixelMask(depth_map_size.first, depth_map_size.second);
+    fused_pixel_mask.Merge(fused_pixel_masks_.at(image_idx));
+  }
 
-    fused_points_.push_back(fused_point);
-    fused_points_visibility_.emplace_back(fused_point_visibility_.begin(),
-                                          fused_point_visibility_.end());
+  return fused_pixel_mask;
+}
+
+void StereoFusion::CommitFusedPoints(
+    FusionState* state, std::vector<FusedPixelMask>* claimed_pixel_masks) {
+  const FusedPointsChunk& fused_points = state->fused_points;
+  CHECK_EQ(fused_points.NumPoints(), state->fused_point_refs.size());
+
+  FusedPointsChunk committed_points;
+  size_t offset = 0;
+  for (size_t i = 0; i < fused_points.NumPoints(); ++i) {
+    const FusionData& ref_data = state->fused_point_refs[i];
+    const auto& claimed_pixel_mask =
+        claimed_pixel_masks->at(ref_data.image_idx);
+    const uint32_t num_visible_images = fused_points.num_visible_images[i];
+    if (claimed_pixel_mask.NumWords() == 0 ||
+        !claimed_pixel_mask.IsSet(ref_data.row, ref_data.col)) {
+      const auto begin = fused_points.visible_image_idxs.begin() + offset;
+      committed_points.points.push_back(fused_points.points[i]);
+      committed_points.num_visible_images.push_back(num_visible_images);
+      committed_points.visible_image_idxs.insert(
+          committed_points.visible_image_idxs.end(), begin,
+          begin + num_visible_images);
+    }
+    offset += num_visible_images;
+  }
+
+  for (size_t image_idx = 0; image_idx < state->fused_pixel_masks.size();
+       ++image_idx) {
+    const auto& fused_pixel_mask = state->fused_pixel_masks[image_idx];
+    if (fused_pixel_mask.NumWords() == 0) {
+      continue;
+    }
+    auto& claimed_pixel_mask = claimed_pixel_masks->at(image_idx);
+    if (claimed_pixel_mask.NumWords() == 0) {
+      const auto& depth_map_size = depth_map_sizes_.at(image_idx);
+      claimed_pixel_mask =
+          FusedPixelMask(depth_map_size.first, depth_map_size.second);
+    }
+    claimed_pixel_mask.Merge(fused_pixel_mask);
+  }
+
+  state->fused_pixel_masks.clear();
+  state->fused_pixel_masks.shrink_to_fit();
+  state->fused_point_refs.clear();
+  state->fused_points.Clear();
+
+  AddFusedPoints(&committed_points);
+}
+
+float StereoFusion::GetDepth(Workspace* workspace, const int image_idx,
+                              const int row, const int col) const {
+  if (options_.compact_maps) {
+    return workspace->GetCompactDepthMap(image_idx).Get(row, col);
+  } else if (options_.mmap_maps) {
+    return workspace->GetMappedDepthMap(image_idx).Get(row, col);
+  } else {
+    return workspace->GetDepthMap(image_idx).Get(row, col);
   }
 }
 
+void StereoFusion::GetNormal(Workspace* workspace, const int image_idx,
+                             const int row, const int col,
+                             float normal[3]) const {
+  if (options_.compact_maps) {
+    workspace->GetCompactNormalMap(image_idx).GetSlice(row, col, normal);
+  } else if (options_.mmap_maps) {
+    workspace->GetMappedNormalMap(image_idx).GetSlice(row, col, normal);
+  } else {
+    workspace->GetNormalMap(image_idx).GetSlice(row, col, normal);
+  }
+}
+
+void StereoFusion::AddFusedPoints(FusedPointsChunk* chunk) {
+  if (chunk->NumPoints() == 0) {
+    return;
+  }
+
+  num_fused_points_ += chunk->NumPoints();
+  ProfileCounter("fused_points", chunk->NumPoints());
+
+  if (fused_points_writer_ != nullptr) {
+    fused_points_writer_->Write(*chunk);
+  } else {
+    fused_points_.insert(fused_points_.end(), chunk->points.begin(),
+                         chunk->points.end());
+    size_t offset = 0;
+    for (const uint32_t num_visible_images : chunk->num_visible_images) {
+      const auto begin = chunk->visible_image_idxs.begin() + offset;
+      fused_points_visibility_.emplace_back(begin, begin + num_visible_images);
+      offset += num_visible_images;
+    }
+  }
+
+  chunk->Clear();
+}
+
 void WritePointsVisibility(
     const std::string& path,
     const std::vector<std::vector<int>>& points_visibility) {
@@ -488,5 +1306,57 @@ void WritePointsVisibility(
   }
 }
 
+PointsVisibilityReader::PointsVisibilityReader(const std::string& path)
+    : num_read_points_(0) {
+  file_.open(path, std::ios::in | std::ios::binary);
+  CHECK(file_.is_open()) << path;
+
+  const uint64_t header = ReadBinaryLittleEndian<uint64_t>(&file_);
+  is_chunked_ = header == FusedPointsWriter::kChunkedVisibilityMarker;
+  if (is_chunked_) {
+    num_points_ = ReadBinaryLittleEndian<uint64_t>(&file_);
+  } else {
+    num_points_ = header;
+  }
+}
+
+size_t PointsVisibilityReader::NumPoints() const { return num_points_; }
+
+bool PointsVisibilityReader::ReadChunk(
+    std::vector<uint32_t>* num_visible_images,
+    std::vector<uint32_t>* visible_image_idxs) {
+  num_visible_images->clear();
+  visible_image_idxs->clear();
+
+  if (num_read_points_ >= num_points_) {
+    return false;
+  }
+
+  if (is_chunked_) {
+    num_visible_images->resize(ReadBinaryLittleEndian<uint64_t>(&file_));
+    visible_image_idxs->resize(ReadBinaryLittleEndian<uint64_t>(&file_));
+    ReadBinaryLittleEndian<uint32_t>(&file_, num_visible_images);
+    ReadBinaryLittleEndian<uint32_t>(&file_, visible_image_idxs);
+  } else {
+    const size_t chunk_num_points = std::min(
+        num_points_ - num_read_points_, internal::kNumFusedPointsPerChunk);
+    num_visible_images->reserve(chunk_num_points);
+    for (size_t i = 0; i < chunk_num_points; ++i) {
+      const uint32_t num_visible = ReadBinaryLittleEndian<uint32_t>(&file_);
+      num_visible_images->push_back(num_visible);
+      for (uint32_t j = 0; j < num_visible; ++j) {
+        visible_image_idxs->push_back(ReadBinaryLittleEndian<uint32_t>(&file_));
+      }
+    }
+  }
+
+  CHECK(file_.good()) << "Truncated visibility file";
+
+  num_read_points_ += num_visible_images->size();
+  CHECK_LE(num_read_points_, num_points_);
+
+  return true;
+}
+
 }  // namespace mvs
 }  // namespace colmap
@@ -32,6 +32,9 @@
 #ifndef COLMAP_SRC_MVS_FUSION_H_
 #define COLMAP_SRC_MVS_FUSION_H_
 
+#include <atomic>
+#include <fstream>
+#include <memory>
 #include <unordered_set>
 #include <vector>
 
@@ -81,9 +84,68 @@ struct StereoFusionOptions {
   // maps, normal maps, and consistency graphs of this number of images in
   // memory. A higher value leads to less disk access and faster fusion, while
   // a lower value leads to reduced memory usage. Note that a single image can
-  // consume a lot of memory, if the consistency graph is dense.
+  // consume a lot of memory, if the consistency graph is dense. The images are
+  // fused in an order that reuses the cached overlapping images, and the
+  // cached images are evicted by the time of their next use in this order.
   double cache_size = 32.0;
 
+  // Path to the original distorted images, which are then undistorted on
+  // the fly instead of reading the undistorted images of the workspace. This
+  // requires a workspace written by the COLMAP undistorter with
+  // `image_encoding=NONE`.
+  std::string distorted_image_path;
+
+  // The number of threads to use for fusion. With multiple threads, the
+  // reference images are partitioned into tiles of consecutive overlapping
+  // images, which are fused concurrently. Every thread keeps its own cache
+  // with an equal share of the cache size. Pixels are claimed atomically, so
+  // that every pixel is fused into at most one point, and the points are
+  // returned in the order of the tiles. Note that the points fused at the
+  // boundaries of the tiles depend on the scheduling of the threads, unless
+  // the global deterministic mode is enabled, in which case the tiles are
+  // independent of the number of threads, claim pixels privately, and drop
+  // the points whose reference pixel was claimed by a previous tile.
+  int num_threads = -1;
+
+  // Whether to distribute the fusion threads evenly over the NUMA nodes of the
+  // system and bind them to their nodes, such that the cached images of every
+  // thread are allocated on its node.
+  bool numa_aware = false;
+
+  // Whether to cache the depth and normal maps in the compact representation
+  // with half precision depths and octahedral normals, which reduces their
+  // memory by a factor of 2.4, such that more images fit into the cache.
+  bool compact_maps = false;
+
+  // Whether to memory map the depth and normal maps instead of reading them,
+  // such that only the pages of the fused pixels are read from disk and the
+  // pages are shared through the page cache with other processes. The mapped
+  // maps count towards the cache size. This requires the maps to be stored in
+  // the full precision format and is incompatible with `max_image_size`.
+  bool mmap_maps = false;
+
+  // Minimum number of source images in which a pixel must be consistent
+  // according to the confidence maps written by the patch match stereo with
+  // `write_confidence_map`. Pixels below the threshold are neither fused nor
+  // used to start a fused point, which reduces the work of the fusion. Images
+  // without confidence map are fused entirely. Set to 0 to disable.
+  int min_confidence = 0;
+
+  // Whether to fuse on the GPU, which keeps the maps of the reference image
+  // and its overlapping images on the device and fuses all pixels of the
+  // reference image in parallel. A pixel is only fused with its direct
+  // projections into at most 63 overlapping images, i.e., the traversal depth
+  // is limited to one. Requires CUDA, otherwise the CPU fusion is used.
+  bool use_gpu = false;
+
+  // Index of the GPU used for fusion, where -1 selects the best GPU.
+  int gpu_index = -1;
+
+  // Cache size in gigabytes for the depth maps, normal maps, and bitmaps on
+  // the GPU. The images are evicted by the time of their next use in the
+  // fusion order.
+  double gpu_cache_size = 4.0;
+
   // Check the options for validity.
   bool Check() const;
 
@@ -91,6 +153,54 @@ struct StereoFusionOptions {
   void Print() const;
 };
 
+// A chunk of fused points with their visibility in compressed sparse row
+// format, i.e., the indices of the images in which a point is visible are
+// stored consecutively after the image indices of the previous point.
+struct FusedPointsChunk {
+  std::vector<PlyPoint> points;
+  std::vector<uint32_t> num_visible_images;
+  std::vector<uint32_t> visible_image_idxs;
+
+  size_t NumPoints() const;
+  void Clear();
+};
+
+// Writer of the fused points and their visibility, which are appended in
+// chunks while the fusion is running, such that the fused points do not have
+// to be kept in memory. The points are written as a binary PLY file to the
+// given path and the visibility to the path with the suffix ".vis" in the
+// following chunked format:
+//
+//    <kChunkedVisibilityMarker : uint64_t>
+//    <num_points : uint64_t>
+//    <chunk1_num_points : uint64_t>
+//    <chunk1_num_visible_image_idxs : uint64_t>
+//    <point1_num_visible_images : uint32_t> ...
+//    <point1_image_idx1 : uint32_t><point1_image_idx2 : uint32_t> ...
+//    <chunk2_num_points : uint64_t>
+//    ...
+class FusedPointsWriter {
+ public:
+  // Marker at the beginning of the chunked visibility format, which
+  // distinguishes it from the format written by WritePointsVisibility.
+  static const uint64_t kChunkedVisibilityMarker;
+
+  explicit FusedPointsWriter(const std::string& path);
+  ~FusedPointsWriter();
+
+  size_t NumPoints() const;
+
+  // Append the chunk of points and their visibility to the files.
+  void Write(const FusedPointsChunk& chunk);
+
+  // Write the final number of points and close the files.
+  void Close();
+
+ private:
+  BinaryPlyPointsWriter ply_writer_;
+  std::fstream vis_file_;
+};
+
 class StereoFusion : public Thread {
  public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -101,12 +211,120 @@ class StereoFusion : public Thread {
                const std::string& pmvs_option_name,
                const std::string& input_type);
 
+  // Stream the fused points to the given writer while fusing instead of
+  // keeping them in memory, in which case the getters return no points. The
+  // writer must remain valid until the fusion has finished.
+  void SetFusedPointsWriter(FusedPointsWriter* writer);
+
+  size_t NumFusedPoints() const;
   const std::vector<PlyPoint>& GetFusedPoints() const;
   const std::vector<std::vector<int>>& GetFusedPointsVisibility() const;
 
  private:
+  struct FusionData {
+    int image_idx = kInvalidImageId;
+    int row = 0;
+    int col = 0;
+    int traversal_depth = -1;
+    bool operator()(const FusionData& data1, const FusionData& data2) {
+      return data1.image_idx > data2.image_idx;
+    }
+  };
+
+  // Mask of the already fused pixels of an image. The pixels are stored as
+  // bits, which can be claimed by multiple threads with an atomic
+  // test-and-set.
+  class FusedPixelMask {
+   public:
+    FusedPixelMask();
+    FusedPixelMask(const int width, const int height);
+
+    bool IsSet(const int row, const int col) const;
+
+    // Set the pixel and return whether it was already set before.
+    bool TestAndSet(const int row, const int col);
+
+    // Copy the bits of the mask to or from an array of 32-bit words, where
+    // bit i of word j is the pixel with row-major index 32 * j + i.
+    size_t NumWords() const;
+    void GetWords(uint32_t* words) const;
+    void SetWords(const uint32_t* words);
+
+    // Set all pixels that are set in the other mask of the same size.
+    void Merge(const FusedPixelMask& other);
+
+   private:
+    int width_;
+    size_t num_words_;
+    std::unique_ptr<std::atomic<uint32_t>[]> words_;
+  };
+
+  // The state of fusing a sequence of reference images, which is separate for
+  // every concurrently fused tile of reference images.
+  struct FusionState {
+    // The workspace used to read the bitmaps, depth maps, and normal maps.
+    Workspace* workspace = nullptr;
+
+    // Reference images that were already fused in this state.
+    std::vector<char> fused_images;
+
+    // Next points to fuse.
+    std::vector<FusionData> fusion_queue;
+
+    // Already fused points, which were not yet added to the output.
+    FusedPointsChunk fused_points;
+
+    // The pixels claimed by this state in the deterministic fusion, which are
+    // copied from the shared masks when an image is first accessed, and the
+    // reference pixels of the fused points. The shared masks are used if the
+    // private masks are empty.
+    std::vector<FusedPixelMask> fused_pixel_masks;
+    std::vector<FusionData> fused_point_refs;
+
+    // Points of different pixels of the currently point to be fused.
+    std::vector<float> fused_point_x;
+    std::vector<float> fused_point_y;
+    std::vector<float> fused_point_z;
+    std::vector<float> fused_point_nx;
+    std::vector<float> fused_point_ny;
+    std::vector<float> fused_point_nz;
+    std::vector<uint8_t> fused_point_r;
+    std::vector<uint8_t> fused_point_g;
+    std::vector<uint8_t> fused_point_b;
+    std::unordered_set<int> fused_point_visibility;
+  };
+
   void Run();
-  void Fuse();
+  // Mark the pixels below the minimum confidence as fused, such that they are
+  // skipped by the fusion.
+  void MaskUnconfidentPixels(const int image_idx);
+  void ScheduleFusion(const double cache_size);
+  size_t GetNextAccess(const int image_idx, const size_t position) const;
+  // Prefetch the images that are accessed in the given range of positions in
+  // the fusion order.
+  void PrefetchImages(const size_t begin, const size_t end,
+                      Workspace* workspace) const;
+  void FuseSequential();
+  void FuseParallel(const int num_threads);
+  void FuseImage(const int image_idx, FusionState* state);
+  void Fuse(FusionState* state);
+  FusedPixelMask& GetFusedPixelMask(const int image_idx, FusionState* state);
+  // Add the points of a tile in the deterministic fusion, except for the
+  // points whose reference pixel was claimed by a previous tile, and add the
+  // claimed pixels of the tile to the given masks.
+  void CommitFusedPoints(FusionState* state,
+                         std::vector<FusedPixelMask>* claimed_pixel_masks);
+#ifdef CUDA_ENABLED
+  // Fuse the reference images in the fusion order on the GPU.
+  void FuseCuda();
+#endif
+  // Get the depth and normal of a pixel from the maps in the representation
+  // selected by the options.
+  float GetDepth(Workspace* workspace, const int image_idx, const int row,
+                 const int col) const;
+  void GetNormal(Workspace* workspace, const int image_idx, const int row,
+                 const int col, float normal[3]) const;
+  void AddFusedPoints(FusedPointsChunk* chunk);
 
   const StereoFusionOptions options_;
   const std::string workspace_path_;
@@ -118,43 +336,24 @@ class StereoFusion : public Thread {
 
   std::unique_ptr<Workspace> workspace_;
   std::vector<char> used_images_;
-  std::vector<char> fused_images_;
   std::vector<std::vector<int>> overlapping_images_;
-  std::vector<Mat<bool>> fused_pixel_masks_;
+  std::vector<FusedPixelMask> fused_pixel_masks_;
   std::vector<std::pair<int, int>> depth_map_sizes_;
   std::vector<std::pair<float, float>> bitmap_scales_;
   std::vector<Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> P_;
   std::vector<Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> inv_P_;
   std::vector<Eigen::Matrix<float, 3, 3, Eigen::RowMajor>> inv_R_;
 
-  struct FusionData {
-    int image_idx = kInvalidImageId;
-    int row = 0;
-    int col = 0;
-    int traversal_depth = -1;
-    bool operator()(const FusionData& data1, const FusionData& data2) {
-      return data1.image_idx > data2.image_idx;
-    }
-  };
-
-  // Next points to fuse.
-  std::vector<FusionData> fusion_queue_;
+  // The order in which the reference images are fused and, for every image,
+  // the sorted positions in this order at which the image is accessed.
+  std::vector<int> fusion_order_;
+  std::vector<std::vector<size_t>> fusion_order_accesses_;
 
-  // Already fused points.
+  // Already fused points, which are only kept in memory without a writer.
+  FusedPointsWriter* fused_points_writer_;
+  size_t num_fused_points_;
   std::vector<PlyPoint> fused_points_;
   std::vector<std::vector<int>> fused_points_visibility_;
-
-  // Points of different pixels of the currently point to be fused.
-  std::vector<float> fused_point_x_;
-  std::vector<float> fused_point_y_;
-  std::vector<float> fused_point_z_;
-  std::vector<float> fused_point_nx_;
-  std::vector<float> fused_point_ny_;
-  std::vector<float> fused_point_nz_;
-  std::vector<uint8_t> fused_point_r_;
-  std::vector<uint8_t> fused_point_g_;
-  std::vector<uint8_t> fused_point_b_;
-  std::unordered_set<int> fused_point_visibility_;
 };
 
 // Write the visiblity information into a binary file of the following format:
@@ -173,6 +372,28 @@ void WritePointsVisibility(
     const std::string& path,
     const std::vector<std::vector<int>>& points_visibility);
 
+// Reader of the visibility information written by WritePointsVisibility or
+// FusedPointsWriter, which reads the visibility in chunks of points, such that
+// large files can be processed without keeping all of it in memory.
+class PointsVisibilityReader {
+ public:
+  explicit PointsVisibilityReader(const std::string& path);
+
+  size_t NumPoints() const;
+
+  // Read the visibility of the next chunk of points into the number of
+  // visible images per point and the concatenated visible image indices.
+  // Returns false if all points have been read.
+  bool ReadChunk(std::vector<uint32_t>* num_visible_images,
+                 std::vector<uint32_t>* visible_image_idxs);
+
+ private:
+  std::ifstream file_;
+  bool is_chunked_;
+  size_t num_points_;
+  size_t num_read_points_;
+};
+
 }  // namespace mvs
 }  // namespace colmap
 
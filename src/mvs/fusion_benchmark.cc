@@ -0,0 +1,164 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "base/synthetic.h"
+#include "mvs/depth_map.h"
+#include "mvs/fusion.h"
+#include "mvs/normal_map.h"
+#include "util/bitmap.h"
+#include "util/misc.h"
+#include "util/random.h"
+
+using namespace colmap;
+
+namespace {
+
+// Create a dense workspace with the exact depth and normal maps of a sphere,
+// which is observed by the images of a synthetic sparse reconstruction.
+std::string CreateSphereWorkspace() {
+  const std::string path = (boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path())
+                               .string();
+  CreateDirIfNotExists(path);
+  CreateDirIfNotExists(JoinPaths(path, "sparse"));
+  CreateDirIfNotExists(JoinPaths(path, "images"));
+  CreateDirIfNotExists(JoinPaths(path, "stereo"));
+  CreateDirIfNotExists(JoinPaths(path, "stereo/depth_maps"));
+  CreateDirIfNotExists(JoinPaths(path, "stereo/normal_maps"));
+
+  SetPRNGSeed(0);
+  SyntheticDatasetOptions options;
+  options.num_cameras = 1;
+  options.num_images = 10;
+  options.num_points3D = 100;
+  options.camera_width = 400;
+  options.camera_height = 300;
+  options.camera_focal_length = 400;
+  options.camera_model_name = "PINHOLE";
+  Reconstruction reconstruction;
+  SynthesizeDataset(options, &reconstruction);
+  reconstruction.WriteBinary(JoinPaths(path, "sparse"));
+
+  const double kSphereRadius = 0.5;
+
+  std::ofstream fusion_config_file(JoinPaths(path, "stereo/fusion.cfg"));
+  CHECK(fusion_config_file.is_open());
+
+  for (const auto& image : reconstruction.Images()) {
+    const Camera& camera = reconstruction.Camera(image.second.CameraId());
+    const Eigen::Matrix3d R = image.second.RotationMatrix();
+    const Eigen::Vector3d proj_center = image.second.ProjectionCenter();
+    const Eigen::Matrix3d inv_K = camera.CalibrationMatrix().inverse();
+
+    Bitmap bitmap;
+    bitmap.Allocate(camera.Width(), camera.Height(), true);
+    bitmap.Fill(BitmapColor<uint8_t>(128));
+    bitmap.Write(JoinPaths(path, "images", image.second.Name()));
+
+    mvs::DepthMap depth_map(camera.Width(), camera.Height(), 0, 0);
+    mvs::NormalMap normal_map(camera.Width(), camera.Height());
+    float depth_min = std::numeric_limits<float>::max();
+    float depth_max = 0;
+    for (size_t row = 0; row < camera.Height(); ++row) {
+      for (size_t col = 0; col < camera.Width(); ++col) {
+        // Intersect the viewing ray with the sphere, where the ray has unit
+        // depth in the camera frame, such that the ray parameter is the depth.
+        const Eigen::Vector3d ray =
+            R.transpose() * inv_K * Eigen::Vector3d(col + 0.5, row + 0.5, 1);
+        const double a = ray.squaredNorm();
+        const double b = 2 * ray.dot(proj_center);
+        const double c =
+            proj_center.squaredNorm() - kSphereRadius * kSphereRadius;
+        const double discriminant = b * b - 4 * a * c;
+        if (discriminant < 0) {
+          continue;
+        }
+        const double depth = (-b - std::sqrt(discriminant)) / (2 * a);
+        const Eigen::Vector3d normal =
+            R * (proj_center + depth * ray).normalized();
+        depth_map.Set(row, col, depth);
+        for (int d = 0; d < 3; ++d) {
+          normal_map.Set(row, col, d, normal(d));
+        }
+        depth_min = std::min(depth_min, static_cast<float>(depth));
+        depth_max = std::max(depth_max, static_cast<float>(depth));
+      }
+    }
+
+    const std::string file_name = image.second.Name() + ".geometric.bin";
+    mvs::DepthMap(depth_map, depth_min, depth_max)
+        .Write(JoinPaths(path, "stereo/depth_maps", file_name));
+    normal_map.Write(JoinPaths(path, "stereo/normal_maps", file_name));
+
+    fusion_config_file << image.second.Name() << std::endl;
+  }
+
+  return path;
+}
+
+}  // namespace
+
+static void BM_StereoFusion(benchmark::State& state) {
+  const std::string workspace_path = CreateSphereWorkspace();
+
+  mvs::StereoFusionOptions options;
+  options.num_threads = state.range(0);
+
+  // Measure the throughput cost of the deterministic mode.
+  kDeterministic = state.range(1) != 0;
+
+  size_t num_fused_points = 0;
+  for (auto _ : state) {
+    mvs::StereoFusion fuser(options, workspace_path, "COLMAP", "",
+                            "geometric");
+    fuser.Start();
+    fuser.Wait();
+    num_fused_points = fuser.GetFusedPoints().size();
+  }
+
+  state.counters["num_fused_points"] = num_fused_points;
+
+  kDeterministic = false;
+
+  boost::filesystem::remove_all(workspace_path);
+}
+
+BENCHMARK(BM_StereoFusion)
+    ->Args({1, 0})
+    ->Args({4, 0})
+    ->Args({1, 1})
+    ->Args({4, 1})
+    ->Unit(benchmark::kMillisecond);
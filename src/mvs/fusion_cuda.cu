@@ -0,0 +1,429 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "mvs/fusion_cuda.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "mvs/gpu_memory_pool.h"
+#include "util/cuda.h"
+#include "util/cudacc.h"
+#include "util/logging.h"
+
+namespace colmap {
+namespace mvs {
+namespace {
+
+const int kMaxNumImages = StereoFusionCuda::kMaxNumSrcImages + 1;
+
+// Number of threads per block in either dimension.
+const int kBlockSize = 16;
+
+// The data of an image on the device, as it is accessed by the kernel.
+struct FusionImage {
+  int width;
+  int height;
+  const float* depth_map;
+  const float* normal_map;
+  uint32_t* fused_pixel_mask;
+  int bitmap_width;
+  int bitmap_height;
+  const uint8_t* bitmap;
+  float bitmap_scale_x;
+  float bitmap_scale_y;
+  float P[12];
+  float inv_P[12];
+  float inv_R[9];
+};
+
+__device__ inline bool IsFused(const FusionImage& image, const int idx) {
+  return (image.fused_pixel_mask[idx / 32] & (1u << (idx % 32))) != 0;
+}
+
+// Set the pixel as fused and return whether it was already fused before.
+__device__ inline bool TestAndSetFused(const FusionImage& image,
+                                       const int idx) {
+  const uint32_t bit = 1u << (idx % 32);
+  return (atomicOr(&image.fused_pixel_mask[idx / 32], bit) & bit) != 0;
+}
+
+__device__ inline void Mat34DotVec4(const float mat[12], const float vec[3],
+                                    float result[3]) {
+  result[0] = mat[0] * vec[0] + mat[1] * vec[1] + mat[2] * vec[2] + mat[3];
+  result[1] = mat[4] * vec[0] + mat[5] * vec[1] + mat[6] * vec[2] + mat[7];
+  result[2] = mat[8] * vec[0] + mat[9] * vec[1] + mat[10] * vec[2] + mat[11];
+}
+
+__device__ inline void Mat33DotVec3(const float mat[9], const float vec[3],
+                                    float result[3]) {
+  result[0] = mat[0] * vec[0] + mat[1] * vec[1] + mat[2] * vec[2];
+  result[1] = mat[3] * vec[0] + mat[4] * vec[1] + mat[5] * vec[2];
+  result[2] = mat[6] * vec[0] + mat[7] * vec[1] + mat[8] * vec[2];
+}
+
+// Read the 3D point, the normal in the global frame, and the color of a pixel.
+__device__ inline void ReadPixel(const FusionImage& image, const int row,
+                                 const int col, const float depth,
+                                 float xyz[3], float normal[3],
+                                 float color[3]) {
+  const float point[3] = {col * depth, row * depth, depth};
+  Mat34DotVec4(image.inv_P, point, xyz);
+
+  const int idx = row * image.width + col;
+  Mat33DotVec3(image.inv_R, image.normal_map + 3 * idx, normal);
+
+  const int x = static_cast<int>(roundf(col / image.bitmap_scale_x));
+  const int y = static_cast<int>(roundf(row / image.bitmap_scale_y));
+  if (x >= 0 && x < image.bitmap_width && y >= 0 && y < image.bitmap_height) {
+    const uint8_t* pixel = image.bitmap + 3 * (y * image.bitmap_width + x);
+    color[0] = pixel[0];
+    color[1] = pixel[1];
+    color[2] = pixel[2];
+  } else {
+    color[0] = 0.0f;
+    color[1] = 0.0f;
+    color[2] = 0.0f;
+  }
+}
+
+// Compute the median of the given values, which are sorted in place.
+__device__ inline float Median(float* values, const int num_values) {
+  for (int i = 1; i < num_values; ++i) {
+    const float value = values[i];
+    int j = i - 1;
+    while (j >= 0 && values[j] > value) {
+      values[j + 1] = values[j];
+      j -= 1;
+    }
+    values[j + 1] = value;
+  }
+  const int mid_idx = num_values / 2;
+  if (num_values % 2 == 0) {
+    return (values[mid_idx - 1] + values[mid_idx]) / 2.0f;
+  } else {
+    return values[mid_idx];
+  }
+}
+
+__global__ void FuseImageKernel(const FusionImage* images, const int num_images,
+                                const StereoFusionCuda::Options options,
+                                StereoFusionCuda::FusedPoint* fused_points,
+                                unsigned int* num_fused_points) {
+  const int row = blockDim.y * blockIdx.y + threadIdx.y;
+  const int col = blockDim.x * blockIdx.x + threadIdx.x;
+
+  const FusionImage& ref_image = images[0];
+  if (row >= ref_image.height || col >= ref_image.width) {
+    return;
+  }
+
+  const int ref_idx = row * ref_image.width + col;
+  const float ref_depth = ref_image.depth_map[ref_idx];
+  if (ref_depth <= 0.0f || IsFused(ref_image, ref_idx) ||
+      TestAndSetFused(ref_image, ref_idx)) {
+    return;
+  }
+
+  // The 3D points, normals, and colors of the fused pixels, which are stored
+  // per component for the median.
+  float values[9][kMaxNumImages];
+  float xyz[3];
+  float normal[3];
+  float color[3];
+
+  ReadPixel(ref_image, row, col, ref_depth, xyz, normal, color);
+  const float ref_xyz[3] = {xyz[0], xyz[1], xyz[2]};
+  const float ref_normal[3] = {normal[0], normal[1], normal[2]};
+  for (int i = 0; i < 3; ++i) {
+    values[i][0] = xyz[i];
+    values[3 + i][0] = normal[i];
+    values[6 + i][0] = color[i];
+  }
+
+  int num_pixels = 1;
+  uint64_t visibility = 1;
+
+  for (int image_idx = 1; image_idx < num_images; ++image_idx) {
+    if (num_pixels >= options.max_num_pixels) {
+      break;
+    }
+
+    const FusionImage& image = images[image_idx];
+
+    float proj[3];
+    Mat34DotVec4(image.P, ref_xyz, proj);
+    const float proj_col = proj[0] / proj[2];
+    const float proj_row = proj[1] / proj[2];
+    const float src_col = roundf(proj_col);
+    const float src_row = roundf(proj_row);
+    // Note that the comparisons also reject invalid projections.
+    if (!(src_col >= 0.0f && src_col < image.width && src_row >= 0.0f &&
+          src_row < image.height)) {
+      continue;
+    }
+
+    const int src_idx = static_cast<int>(src_row) * image.width +
+                        static_cast<int>(src_col);
+    if (IsFused(image, src_idx)) {
+      continue;
+    }
+
+    const float depth = image.depth_map[src_idx];
+    if (depth <= 0.0f) {
+      continue;
+    }
+
+    const float depth_error = fabsf((proj[2] - depth) / depth);
+    if (depth_error > options.max_depth_error) {
+      continue;
+    }
+
+    const float col_diff = proj_col - src_col;
+    const float row_diff = proj_row - src_row;
+    if (col_diff * col_diff + row_diff * row_diff >
+        options.max_reproj_error * options.max_reproj_error) {
+      continue;
+    }
+
+    ReadPixel(image, static_cast<int>(src_row), static_cast<int>(src_col),
+              depth, xyz, normal, color);
+
+    const float cos_normal_error = ref_normal[0] * normal[0] +
+                                   ref_normal[1] * normal[1] +
+                                   ref_normal[2] * normal[2];
+    if (cos_normal_error < options.min_cos_normal_error) {
+      continue;
+    }
+
+    // Claim the pixel, unless another thread was faster.
+    if (TestAndSetFused(image, src_idx)) {
+      continue;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+      values[i][num_pixels] = xyz[i];
+      values[3 + i][num_pixels] = normal[i];
+      values[6 + i][num_pixels] = color[i];
+    }
+    num_pixels += 1;
+    visibility |= static_cast<uint64_t>(1) << image_idx;
+  }
+
+  if (num_pixels < options.min_num_pixels) {
+    return;
+  }
+
+  StereoFusionCuda::FusedPoint fused_point;
+
+  const float fused_nx = Median(values[3], num_pixels);
+  const float fused_ny = Median(values[4], num_pixels);
+  const float fused_nz = Median(values[5], num_pixels);
+  const float fused_normal_norm =
+      sqrtf(fused_nx * fused_nx + fused_ny * fused_ny + fused_nz * fused_nz);
+  if (fused_normal_norm < FLT_EPSILON) {
+    return;
+  }
+
+  fused_point.x = Median(values[0], num_pixels);
+  fused_point.y = Median(values[1], num_pixels);
+  fused_point.z = Median(values[2], num_pixels);
+  fused_point.nx = fused_nx / fused_normal_norm;
+  fused_point.ny = fused_ny / fused_normal_norm;
+  fused_point.nz = fused_nz / fused_normal_norm;
+  fused_point.r = static_cast<uint8_t>(
+      fminf(255.0f, fmaxf(0.0f, roundf(Median(values[6], num_pixels)))));
+  fused_point.g = static_cast<uint8_t>(
+      fminf(255.0f, fmaxf(0.0f, roundf(Median(values[7], num_pixels)))));
+  fused_point.b = static_cast<uint8_t>(
+      fminf(255.0f, fmaxf(0.0f, roundf(Median(values[8], num_pixels)))));
+  fused_point.pixel_idx = ref_idx;
+  fused_point.visibility = visibility;
+
+  fused_points[atomicAdd(num_fused_points, 1u)] = fused_point;
+}
+
+template <typename T>
+std::shared_ptr<void> UploadToDevice(const T* data, const size_t num_elems) {
+  const size_t num_bytes = num_elems * sizeof(T);
+  std::shared_ptr<void> device_data = GpuMemoryPool::Get().Allocate(num_bytes);
+  CUDA_SAFE_CALL(cudaMemcpy(device_data.get(), data, num_bytes,
+                            cudaMemcpyHostToDevice));
+  return device_data;
+}
+
+}  // namespace
+
+StereoFusionCuda::StereoFusionCuda(const Options& options)
+    : options_(options), num_bytes_(0) {
+  SetBestCudaDevice(options_.gpu_index);
+}
+
+StereoFusionCuda::~StereoFusionCuda() {}
+
+size_t StereoFusionCuda::NumBytes() const { return num_bytes_; }
+
+bool StereoFusionCuda::HasImage(const int image_idx) const {
+  return images_.count(image_idx) > 0;
+}
+
+std::vector<int> StereoFusionCuda::GetImageIdxs() const {
+  std::vector<int> image_idxs;
+  image_idxs.reserve(images_.size());
+  for (const auto& image : images_) {
+    image_idxs.push_back(image.first);
+  }
+  return image_idxs;
+}
+
+void StereoFusionCuda::UploadImage(const int image_idx,
+                                   const HostImage& image) {
+  CHECK(!HasImage(image_idx));
+  CHECK_NOTNULL(image.depth_map);
+  CHECK_NOTNULL(image.normal_map);
+  CHECK_NOTNULL(image.fused_pixel_mask);
+  CHECK_NOTNULL(image.bitmap);
+
+  const size_t num_pixels = static_cast<size_t>(image.width) * image.height;
+  const size_t num_mask_words = (num_pixels + 31) / 32;
+  const size_t num_bitmap_bytes =
+      3 * static_cast<size_t>(image.bitmap_width) * image.bitmap_height;
+
+  DeviceImage& device_image = images_[image_idx];
+  device_image.width = image.width;
+  device_image.height = image.height;
+  device_image.bitmap_width = image.bitmap_width;
+  device_image.bitmap_height = image.bitmap_height;
+  device_image.depth_map = UploadToDevice(image.depth_map, num_pixels);
+  device_image.normal_map = UploadToDevice(image.normal_map, 3 * num_pixels);
+  device_image.fused_pixel_mask =
+      UploadToDevice(image.fused_pixel_mask, num_mask_words);
+  device_image.bitmap = UploadToDevice(image.bitmap, num_bitmap_bytes);
+  device_image.bitmap_scale_x = image.bitmap_scale_x;
+  device_image.bitmap_scale_y = image.bitmap_scale_y;
+  std::copy(image.P, image.P + 12, device_image.P);
+  std::copy(image.inv_P, image.inv_P + 12, device_image.inv_P);
+  std::copy(image.inv_R, image.inv_R + 9, device_image.inv_R);
+  device_image.num_bytes = 4 * num_pixels * sizeof(float) +
+                           num_mask_words * sizeof(uint32_t) +
+                           num_bitmap_bytes;
+
+  num_bytes_ += device_image.num_bytes;
+}
+
+void StereoFusionCuda::ReleaseImage(const int image_idx,
+                                    uint32_t* fused_pixel_mask) {
+  const auto image = images_.find(image_idx);
+  CHECK(image != images_.end());
+
+  if (fused_pixel_mask != nullptr) {
+    const size_t num_pixels =
+        static_cast<size_t>(image->second.width) * image->second.height;
+    CUDA_SAFE_CALL(cudaMemcpy(
+        fused_pixel_mask, image->second.fused_pixel_mask.get(),
+        (num_pixels + 31) / 32 * sizeof(uint32_t), cudaMemcpyDeviceToHost));
+  }
+
+  num_bytes_ -= image->second.num_bytes;
+  images_.erase(image);
+}
+
+void StereoFusionCuda::FuseImage(const int ref_image_idx,
+                                 const std::vector<int>& src_image_idxs,
+                                 std::vector<FusedPoint>* fused_points) {
+  CHECK_LE(src_image_idxs.size(), kMaxNumSrcImages);
+
+  std::vector<FusionImage> images(src_image_idxs.size() + 1);
+  for (size_t i = 0; i < images.size(); ++i) {
+    const int image_idx = i == 0 ? ref_image_idx : src_image_idxs[i - 1];
+    const auto device_image = images_.find(image_idx);
+    CHECK(device_image != images_.end());
+    const DeviceImage& src = device_image->second;
+    FusionImage& image = images[i];
+    image.width = src.width;
+    image.height = src.height;
+    image.depth_map = static_cast<const float*>(src.depth_map.get());
+    image.normal_map = static_cast<const float*>(src.normal_map.get());
+    image.fused_pixel_mask =
+        static_cast<uint32_t*>(src.fused_pixel_mask.get());
+    image.bitmap_width = src.bitmap_width;
+    image.bitmap_height = src.bitmap_height;
+    image.bitmap = static_cast<const uint8_t*>(src.bitmap.get());
+    image.bitmap_scale_x = src.bitmap_scale_x;
+    image.bitmap_scale_y = src.bitmap_scale_y;
+    std::copy(src.P, src.P + 12, image.P);
+    std::copy(src.inv_P, src.inv_P + 12, image.inv_P);
+    std::copy(src.inv_R, src.inv_R + 9, image.inv_R);
+  }
+
+  const FusionImage& ref_image = images[0];
+  const size_t num_ref_pixels =
+      static_cast<size_t>(ref_image.width) * ref_image.height;
+
+  const std::shared_ptr<void> device_images =
+      UploadToDevice(images.data(), images.size());
+  // Every reference pixel produces at most one point.
+  const std::shared_ptr<void> device_fused_points =
+      GpuMemoryPool::Get().Allocate(num_ref_pixels * sizeof(FusedPoint));
+  const unsigned int kNumFusedPoints = 0;
+  const std::shared_ptr<void> device_num_fused_points =
+      UploadToDevice(&kNumFusedPoints, 1);
+
+  const dim3 block_size(kBlockSize, kBlockSize, 1);
+  const dim3 grid_size((ref_image.width - 1) / kBlockSize + 1,
+                       (ref_image.height - 1) / kBlockSize + 1, 1);
+  FuseImageKernel<<<grid_size, block_size>>>(
+      static_cast<const FusionImage*>(device_images.get()),
+      static_cast<int>(images.size()), options_,
+      static_cast<FusedPoint*>(device_fused_points.get()),
+      static_cast<unsigned int*>(device_num_fused_points.get()));
+  CUDA_SYNC_AND_CHECK();
+
+  unsigned int num_fused_points;
+  CUDA_SAFE_CALL(cudaMemcpy(&num_fused_points, device_num_fused_points.get(),
+                            sizeof(unsigned int), cudaMemcpyDeviceToHost));
+
+  fused_points->resize(num_fused_points);
+  if (num_fused_points > 0) {
+    CUDA_SAFE_CALL(cudaMemcpy(
+        fused_points->data(), device_fused_points.get(),
+        num_fused_points * sizeof(FusedPoint), cudaMemcpyDeviceToHost));
+  }
+
+  // The points are appended in the order in which the threads finished.
+  std::sort(fused_points->begin(), fused_points->end(),
+            [](const FusedPoint& point1, const FusedPoint& point2) {
+              return point1.pixel_idx < point2.pixel_idx;
+            });
+}
+
+}  // namespace mvs
+}  // namespace colmap
@@ -0,0 +1,158 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_MVS_FUSION_CUDA_H_
+#define COLMAP_SRC_MVS_FUSION_CUDA_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace colmap {
+namespace mvs {
+
+// Fusion of the depth maps on the GPU. The depth maps, normal maps, bitmaps,
+// and projection matrices of the reference image and its overlapping images
+// are kept on the device. Every pixel of the reference image is projected into
+// all overlapping images in parallel and fused with the projected pixels that
+// pass the depth, reprojection, and normal consistency checks. In contrast to
+// the traversal of the CPU fusion, a pixel is only fused with its direct
+// projections into the overlapping images, since all candidates are checked
+// against the reference pixel anyway. Pixels are claimed atomically, such
+// that every pixel is fused into at most one point.
+//
+// This class hides the CUDA code from the fusion, since NVCC cannot compile
+// the Eigen code used there.
+class StereoFusionCuda {
+ public:
+  struct Options {
+    // Index of the GPU used for fusion, where -1 selects the best GPU.
+    int gpu_index = -1;
+    int min_num_pixels = 5;
+    int max_num_pixels = 10000;
+    float max_reproj_error = 2.0f;
+    float max_depth_error = 0.01f;
+    // Cosine of the maximum angular difference of the normals.
+    float min_cos_normal_error = 0.98f;
+  };
+
+  // Maximum number of overlapping images fused with a reference image, such
+  // that the visibility of a point fits into a 64-bit mask.
+  static const int kMaxNumSrcImages = 63;
+
+  // The data of an image in host memory. The maps are stored in row-major
+  // order, where the normal map stores the three components consecutively,
+  // and the bitmap is stored as RGB in row-major order. The projection
+  // matrices are 3x4 and the rotation is 3x3 in row-major order. The fused
+  // pixel mask stores a bit per pixel in 32-bit words.
+  struct HostImage {
+    int width = 0;
+    int height = 0;
+    const float* depth_map = nullptr;
+    const float* normal_map = nullptr;
+    const uint32_t* fused_pixel_mask = nullptr;
+    int bitmap_width = 0;
+    int bitmap_height = 0;
+    const uint8_t* bitmap = nullptr;
+    float bitmap_scale_x = 1.0f;
+    float bitmap_scale_y = 1.0f;
+    float P[12];
+    float inv_P[12];
+    float inv_R[9];
+  };
+
+  // A fused point with the index of its reference pixel and the bit mask of
+  // the images in which it is visible, where the first bit is the reference
+  // image and bit i the i-th source image.
+  struct FusedPoint {
+    float x;
+    float y;
+    float z;
+    float nx;
+    float ny;
+    float nz;
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint32_t pixel_idx;
+    uint64_t visibility;
+  };
+
+  explicit StereoFusionCuda(const Options& options);
+  ~StereoFusionCuda();
+
+  // Number of bytes of the images on the device.
+  size_t NumBytes() const;
+
+  bool HasImage(const int image_idx) const;
+  std::vector<int> GetImageIdxs() const;
+
+  // Upload the image to the device, where it is kept until it is released.
+  void UploadImage(const int image_idx, const HostImage& image);
+
+  // Copy the fused pixel mask of the image back to the host and release the
+  // memory of the image on the device.
+  void ReleaseImage(const int image_idx, uint32_t* fused_pixel_mask);
+
+  // Fuse the not yet fused pixels of the reference image with the given
+  // source images, which must all be on the device. The fused points are
+  // returned in row-major order of their reference pixels.
+  void FuseImage(const int ref_image_idx,
+                 const std::vector<int>& src_image_idxs,
+                 std::vector<FusedPoint>* fused_points);
+
+ private:
+  struct DeviceImage {
+    int width = 0;
+    int height = 0;
+    int bitmap_width = 0;
+    int bitmap_height = 0;
+    size_t num_bytes = 0;
+    std::shared_ptr<void> depth_map;
+    std::shared_ptr<void> normal_map;
+    std::shared_ptr<void> fused_pixel_mask;
+    std::shared_ptr<void> bitmap;
+    float bitmap_scale_x = 1.0f;
+    float bitmap_scale_y = 1.0f;
+    float P[12];
+    float inv_P[12];
+    float inv_R[9];
+  };
+
+  const Options options_;
+  std::unordered_map<int, DeviceImage> images_;
+  size_t num_bytes_;
+};
+
+}  // namespace mvs
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_MVS_FUSION_CUDA_H_
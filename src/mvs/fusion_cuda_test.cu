@@ -0,0 +1,204 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "mvs/fusion_cuda_test"
+#include "util/testing.h"
+
+#include <vector>
+
+#include "mvs/fusion_cuda.h"
+
+using namespace colmap;
+using namespace colmap::mvs;
+
+namespace {
+
+const int kWidth = 64;
+const int kHeight = 48;
+const float kFocalLength = 64.0f;
+const float kPrincipalPointX = 32.0f;
+const float kPrincipalPointY = 24.0f;
+
+// An image with identity rotation and the given translation, which observes a
+// fronto-parallel plane at the given depth with uniform color.
+struct SyntheticImage {
+  SyntheticImage(const float tx, const float depth, const uint8_t color)
+      : depth_map(kWidth * kHeight, depth),
+        normal_map(3 * kWidth * kHeight, 0.0f),
+        fused_pixel_mask((kWidth * kHeight + 31) / 32, 0),
+        bitmap(3 * kWidth * kHeight, color) {
+    for (int i = 0; i < kWidth * kHeight; ++i) {
+      normal_map[3 * i + 2] = -1.0f;
+    }
+
+    image.width = kWidth;
+    image.height = kHeight;
+    image.depth_map = depth_map.data();
+    image.normal_map = normal_map.data();
+    image.fused_pixel_mask = fused_pixel_mask.data();
+    image.bitmap_width = kWidth;
+    image.bitmap_height = kHeight;
+    image.bitmap = bitmap.data();
+
+    const float P[12] = {kFocalLength, 0, kPrincipalPointX,
+                         kFocalLength * tx, 0, kFocalLength,
+                         kPrincipalPointY, 0, 0, 0, 1, 0};
+    const float inv_P[12] = {1 / kFocalLength, 0,
+                             -kPrincipalPointX / kFocalLength, -tx, 0,
+                             1 / kFocalLength,
+                             -kPrincipalPointY / kFocalLength, 0, 0, 0, 1, 0};
+    const float inv_R[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    std::copy(P, P + 12, image.P);
+    std::copy(inv_P, inv_P + 12, image.inv_P);
+    std::copy(inv_R, inv_R + 9, image.inv_R);
+  }
+
+  std::vector<float> depth_map;
+  std::vector<float> normal_map;
+  std::vector<uint32_t> fused_pixel_mask;
+  std::vector<uint8_t> bitmap;
+  StereoFusionCuda::HostImage image;
+};
+
+size_t CountFusedPixels(const std::vector<uint32_t>& fused_pixel_mask) {
+  size_t num_fused_pixels = 0;
+  for (const uint32_t word : fused_pixel_mask) {
+    for (int i = 0; i < 32; ++i) {
+      num_fused_pixels += (word >> i) & 1;
+    }
+  }
+  return num_fused_pixels;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(TestFuseImage) {
+  // The second image is shifted by 8 pixels at a depth of 2.
+  SyntheticImage ref_image(0.0f, 2.0f, 100);
+  SyntheticImage src_image(-0.25f, 2.0f, 200);
+
+  StereoFusionCuda::Options options;
+  options.min_num_pixels = 2;
+  StereoFusionCuda fusion_cuda(options);
+  fusion_cuda.UploadImage(0, ref_image.image);
+  fusion_cuda.UploadImage(1, src_image.image);
+  BOOST_CHECK(fusion_cuda.HasImage(0));
+  BOOST_CHECK(fusion_cuda.HasImage(1));
+  BOOST_CHECK_GT(fusion_cuda.NumBytes(), 0);
+
+  std::vector<StereoFusionCuda::FusedPoint> fused_points;
+  fusion_cuda.FuseImage(0, {1}, &fused_points);
+  BOOST_CHECK_EQUAL(fused_points.size(), (kWidth - 8) * kHeight);
+
+  for (size_t i = 0; i < fused_points.size(); ++i) {
+    const auto& fused_point = fused_points[i];
+    const int row = fused_point.pixel_idx / kWidth;
+    const int col = fused_point.pixel_idx % kWidth;
+    BOOST_CHECK_GE(col, 8);
+    if (i > 0) {
+      BOOST_CHECK_GT(fused_point.pixel_idx, fused_points[i - 1].pixel_idx);
+    }
+    BOOST_CHECK_CLOSE(fused_point.x,
+                      2 * (col - kPrincipalPointX) / kFocalLength, 1e-3);
+    BOOST_CHECK_CLOSE(fused_point.y,
+                      2 * (row - kPrincipalPointY) / kFocalLength, 1e-3);
+    BOOST_CHECK_CLOSE(fused_point.z, 2.0f, 1e-4);
+    BOOST_CHECK_EQUAL(fused_point.nz, -1.0f);
+    BOOST_CHECK_EQUAL(fused_point.r, 150);
+    BOOST_CHECK_EQUAL(fused_point.visibility, 3);
+  }
+
+  fusion_cuda.ReleaseImage(0, ref_image.fused_pixel_mask.data());
+  fusion_cuda.ReleaseImage(1, src_image.fused_pixel_mask.data());
+  BOOST_CHECK(!fusion_cuda.HasImage(0));
+  BOOST_CHECK(!fusion_cuda.HasImage(1));
+  BOOST_CHECK_EQUAL(fusion_cuda.NumBytes(), 0);
+  BOOST_CHECK_EQUAL(CountFusedPixels(ref_image.fused_pixel_mask),
+                    kWidth * kHeight);
+  BOOST_CHECK_EQUAL(CountFusedPixels(src_image.fused_pixel_mask),
+                    (kWidth - 8) * kHeight);
+}
+
+BOOST_AUTO_TEST_CASE(TestFuseImageInconsistent) {
+  SyntheticImage ref_image(0.0f, 2.0f, 100);
+  SyntheticImage src_image1(-0.25f, 2.5f, 200);
+  SyntheticImage src_image2(-0.25f, 2.0f, 200);
+  // The normals of the second source image are not consistent.
+  for (int i = 0; i < kWidth * kHeight; ++i) {
+    src_image2.normal_map[3 * i] = 1.0f;
+    src_image2.normal_map[3 * i + 2] = 0.0f;
+  }
+
+  StereoFusionCuda::Options options;
+  options.min_num_pixels = 1;
+  StereoFusionCuda fusion_cuda(options);
+  fusion_cuda.UploadImage(0, ref_image.image);
+  fusion_cuda.UploadImage(1, src_image1.image);
+  fusion_cuda.UploadImage(2, src_image2.image);
+
+  std::vector<StereoFusionCuda::FusedPoint> fused_points;
+  fusion_cuda.FuseImage(0, {1, 2}, &fused_points);
+  BOOST_CHECK_EQUAL(fused_points.size(), kWidth * kHeight);
+  for (const auto& fused_point : fused_points) {
+    BOOST_CHECK_EQUAL(fused_point.r, 100);
+    BOOST_CHECK_EQUAL(fused_point.visibility, 1);
+  }
+
+  fusion_cuda.ReleaseImage(1, src_image1.fused_pixel_mask.data());
+  fusion_cuda.ReleaseImage(2, src_image2.fused_pixel_mask.data());
+  BOOST_CHECK_EQUAL(CountFusedPixels(src_image1.fused_pixel_mask), 0);
+  BOOST_CHECK_EQUAL(CountFusedPixels(src_image2.fused_pixel_mask), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestFuseImageFusedPixels) {
+  SyntheticImage ref_image(0.0f, 2.0f, 100);
+  SyntheticImage src_image(-0.25f, 2.0f, 200);
+  // The first row of the reference image and all pixels of the source image
+  // were already fused.
+  for (int i = 0; i < kWidth / 32; ++i) {
+    ref_image.fused_pixel_mask[i] = 0xFFFFFFFF;
+  }
+  std::fill(src_image.fused_pixel_mask.begin(),
+            src_image.fused_pixel_mask.end(), 0xFFFFFFFF);
+
+  StereoFusionCuda::Options options;
+  options.min_num_pixels = 1;
+  StereoFusionCuda fusion_cuda(options);
+  fusion_cuda.UploadImage(0, ref_image.image);
+  fusion_cuda.UploadImage(1, src_image.image);
+
+  std::vector<StereoFusionCuda::FusedPoint> fused_points;
+  fusion_cuda.FuseImage(0, {1}, &fused_points);
+  BOOST_CHECK_EQUAL(fused_points.size(), kWidth * (kHeight - 1));
+  for (const auto& fused_point : fused_points) {
+    BOOST_CHECK_GE(fused_point.pixel_idx, kWidth);
+    BOOST_CHECK_EQUAL(fused_point.visibility, 1);
+  }
+}
@@ -43,6 +43,7 @@
 #include "mvs/cuda_flip.h"
 #include "mvs/cuda_rotate.h"
 #include "mvs/cuda_transpose.h"
+#include "mvs/gpu_memory_pool.h"
 #include "mvs/mat.h"
 #include "util/cuda.h"
 #include "util/cudacc.h"
@@ -105,6 +106,9 @@ class GpuMat {
   const static size_t kBlockDimX = 32;
   const static size_t kBlockDimY = 16;
 
+  // Alignment of the rows in the pooled memory.
+  const static size_t kPitchAlignment = 512;
+
   std::shared_ptr<T> array_;
   T* array_ptr_;
 
@@ -174,10 +178,11 @@ GpuMat<T>::GpuMat(const size_t width, const size_t height, const size_t depth)
       width_(width),
       height_(height),
       depth_(depth) {
-  CUDA_SAFE_CALL(cudaMallocPitch((void**)&array_ptr_, &pitch_,
-                                 width_ * sizeof(T), height_ * depth_));
-
-  array_ = std::shared_ptr<T>(array_ptr_, cudaFree);
+  pitch_ = ((width_ * sizeof(T) + kPitchAlignment - 1) / kPitchAlignment) *
+           kPitchAlignment;
+  array_ = std::static_pointer_cast<T>(
+      GpuMemoryPool::Get().Allocate(pitch_ * height_ * depth_));
+  array_ptr_ = array_.get();
 
   ComputeCudaConfig();
 }
@@ -0,0 +1,179 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "mvs/gpu_memory_pool.h"
+
+#include "util/cudacc.h"
+
+namespace colmap {
+namespace mvs {
+
+GpuMemoryPool& GpuMemoryPool::Get() {
+  // The pool is never destroyed, since the devices may already be reset,
+  // when static objects are destroyed at exit.
+  static GpuMemoryPool* pool = new GpuMemoryPool();
+  return *pool;
+}
+
+std::shared_ptr<void> GpuMemoryPool::Allocate(const size_t num_bytes) {
+  if (num_bytes == 0) {
+    return nullptr;
+  }
+
+  int device;
+  CUDA_SAFE_CALL(cudaGetDevice(&device));
+
+  const size_t block_size = GetBlockSize(num_bytes);
+
+  void* ptr = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DevicePool& device_pool = device_pools_[device];
+    std::vector<void*>& blocks = device_pool.blocks[block_size];
+    if (!blocks.empty()) {
+      ptr = blocks.back();
+      blocks.pop_back();
+      device_pool.num_cached_bytes -= block_size;
+    }
+  }
+
+  if (ptr == nullptr) {
+    cudaError_t error = cudaMalloc(&ptr, block_size);
+    if (error == cudaErrorMemoryAllocation) {
+      // Reset the error and retry without the cached memory.
+      cudaGetLastError();
+      Release();
+      error = cudaMalloc(&ptr, block_size);
+    }
+    CUDA_SAFE_CALL(error);
+  }
+
+  return std::shared_ptr<void>(ptr, [this, device, block_size](void* ptr) {
+    Free(device, block_size, ptr);
+  });
+}
+
+std::shared_ptr<cudaArray> GpuMemoryPool::AllocateArray(
+    const cudaChannelFormatDesc& format, const cudaExtent& extent,
+    const unsigned int flags) {
+  int device;
+  CUDA_SAFE_CALL(cudaGetDevice(&device));
+
+  const ArrayKey key(format.x, format.y, format.z, format.w,
+                     static_cast<int>(format.f), extent.width, extent.height,
+                     extent.depth, flags);
+
+  cudaArray* array = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<cudaArray*>& arrays = device_pools_[device].arrays[key];
+    if (!arrays.empty()) {
+      array = arrays.back();
+      arrays.pop_back();
+    }
+  }
+
+  if (array == nullptr) {
+    cudaError_t error = cudaMalloc3DArray(&array, &format, extent, flags);
+    if (error == cudaErrorMemoryAllocation) {
+      // Reset the error and retry without the cached memory.
+      cudaGetLastError();
+      Release();
+      error = cudaMalloc3DArray(&array, &format, extent, flags);
+    }
+    CUDA_SAFE_CALL(error);
+  }
+
+  return std::shared_ptr<cudaArray>(
+      array, [this, device, key](cudaArray* array) {
+        FreeArray(device, key, array);
+      });
+}
+
+void GpuMemoryPool::Release() {
+  int device;
+  CUDA_SAFE_CALL(cudaGetDevice(&device));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  DevicePool& device_pool = device_pools_[device];
+  for (auto& blocks : device_pool.blocks) {
+    for (void* ptr : blocks.second) {
+      CUDA_SAFE_CALL(cudaFree(ptr));
+    }
+  }
+  for (auto& arrays : device_pool.arrays) {
+    for (cudaArray* array : arrays.second) {
+      CUDA_SAFE_CALL(cudaFreeArray(array));
+    }
+  }
+  device_pool.blocks.clear();
+  device_pool.arrays.clear();
+  device_pool.num_cached_bytes = 0;
+}
+
+size_t GpuMemoryPool::NumCachedBytes() {
+  int device;
+  CUDA_SAFE_CALL(cudaGetDevice(&device));
+  std::lock_guard<std::mutex> lock(mutex_);
+  return device_pools_[device].num_cached_bytes;
+}
+
+size_t GpuMemoryPool::GetBlockSize(const size_t num_bytes) {
+  const size_t kMinBlockSize = 512;
+  if (num_bytes <= kMinBlockSize) {
+    return kMinBlockSize;
+  }
+
+  // Find the power of two, such that power < num_bytes <= 2 * power, and round
+  // up to a multiple of a quarter of it.
+  size_t power = kMinBlockSize;
+  while (2 * power < num_bytes) {
+    power *= 2;
+  }
+  const size_t step = power / 4;
+  return ((num_bytes + step - 1) / step) * step;
+}
+
+void GpuMemoryPool::Free(const int device, const size_t block_size,
+                         void* ptr) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  DevicePool& device_pool = device_pools_[device];
+  device_pool.blocks[block_size].push_back(ptr);
+  device_pool.num_cached_bytes += block_size;
+}
+
+void GpuMemoryPool::FreeArray(const int device, const ArrayKey& key,
+                              cudaArray* array) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  device_pools_[device].arrays[key].push_back(array);
+}
+
+}  // namespace mvs
+}  // namespace colmap
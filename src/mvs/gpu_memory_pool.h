@@ -0,0 +1,108 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_MVS_GPU_MEMORY_POOL_H_
+#define COLMAP_SRC_MVS_GPU_MEMORY_POOL_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <cuda_runtime.h>
+
+namespace colmap {
+namespace mvs {
+
+// Pool of device memory, which keeps freed memory blocks and arrays for later
+// allocations instead of returning them to the driver. Consecutive patch match
+// problems allocate maps of the same or similar sizes, which are then reused
+// without the latency of device allocations and without fragmenting the
+// device memory. The memory is pooled per device and blocks are rounded up to
+// size classes, where each power of two is divided into four size classes,
+// such that at most 20% of a block are unused. If an allocation fails, the
+// cached memory of the device is released and the allocation is retried.
+//
+// Note that pooled memory is reused without synchronization. Memory used by
+// asynchronous operations on streams other than the default stream must only
+// be freed after the stream is synchronized.
+class GpuMemoryPool {
+ public:
+  // Get the pool shared by all threads of the process.
+  static GpuMemoryPool& Get();
+
+  // Allocate a block of at least the given number of bytes on the current
+  // device. The block is returned to the pool, once the last reference to it
+  // is reset. Returns null for zero bytes.
+  std::shared_ptr<void> Allocate(const size_t num_bytes);
+
+  // Allocate a layered array with the given format and extent on the current
+  // device. The array is returned to the pool, once the last reference to it
+  // is reset.
+  std::shared_ptr<cudaArray> AllocateArray(const cudaChannelFormatDesc& format,
+                                           const cudaExtent& extent,
+                                           const unsigned int flags);
+
+  // Free the cached blocks and arrays of the current device.
+  void Release();
+
+  // Number of bytes of the cached blocks of the current device.
+  size_t NumCachedBytes();
+
+  // Round the number of bytes up to the size of the pooled block.
+  static size_t GetBlockSize(const size_t num_bytes);
+
+ private:
+  GpuMemoryPool() = default;
+
+  // Channel format, extent, and flags of a pooled array.
+  typedef std::tuple<int, int, int, int, int, size_t, size_t, size_t,
+                     unsigned int>
+      ArrayKey;
+
+  struct DevicePool {
+    std::unordered_map<size_t, std::vector<void*>> blocks;
+    std::map<ArrayKey, std::vector<cudaArray*>> arrays;
+    size_t num_cached_bytes = 0;
+  };
+
+  void Free(const int device, const size_t block_size, void* ptr);
+  void FreeArray(const int device, const ArrayKey& key, cudaArray* array);
+
+  std::mutex mutex_;
+  std::unordered_map<int, DevicePool> device_pools_;
+};
+
+}  // namespace mvs
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_MVS_GPU_MEMORY_POOL_H_
@@ -0,0 +1,121 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "mvs/gpu_memory_pool_test"
+#include "util/testing.h"
+
+#include "mvs/gpu_mat.h"
+#include "mvs/gpu_memory_pool.h"
+
+using namespace colmap;
+using namespace colmap::mvs;
+
+BOOST_AUTO_TEST_CASE(TestGetBlockSize) {
+  BOOST_CHECK_EQUAL(GpuMemoryPool::GetBlockSize(1), 512);
+  BOOST_CHECK_EQUAL(GpuMemoryPool::GetBlockSize(512), 512);
+  BOOST_CHECK_EQUAL(GpuMemoryPool::GetBlockSize(513), 640);
+  BOOST_CHECK_EQUAL(GpuMemoryPool::GetBlockSize(640), 640);
+  BOOST_CHECK_EQUAL(GpuMemoryPool::GetBlockSize(641), 768);
+  BOOST_CHECK_EQUAL(GpuMemoryPool::GetBlockSize(1024), 1024);
+  BOOST_CHECK_EQUAL(GpuMemoryPool::GetBlockSize(1025), 1280);
+  for (size_t num_bytes = 1; num_bytes < 100000; num_bytes += 7) {
+    const size_t block_size = GpuMemoryPool::GetBlockSize(num_bytes);
+    BOOST_CHECK_GE(block_size, num_bytes);
+    BOOST_CHECK_LE(block_size, std::max<size_t>(512, 1.25 * num_bytes));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAllocate) {
+  GpuMemoryPool& pool = GpuMemoryPool::Get();
+  pool.Release();
+  BOOST_CHECK_EQUAL(pool.NumCachedBytes(), 0);
+  BOOST_CHECK(!pool.Allocate(0));
+
+  std::shared_ptr<void> block1 = pool.Allocate(1000);
+  BOOST_CHECK(block1);
+  void* ptr1 = block1.get();
+  block1.reset();
+  BOOST_CHECK_EQUAL(pool.NumCachedBytes(), 1024);
+
+  // The cached block of the same size class is reused.
+  std::shared_ptr<void> block2 = pool.Allocate(1024);
+  BOOST_CHECK_EQUAL(block2.get(), ptr1);
+  BOOST_CHECK_EQUAL(pool.NumCachedBytes(), 0);
+
+  std::shared_ptr<void> block3 = pool.Allocate(2000);
+  BOOST_CHECK_NE(block3.get(), ptr1);
+  block2.reset();
+  block3.reset();
+  BOOST_CHECK_EQUAL(pool.NumCachedBytes(), 1024 + 2048);
+
+  pool.Release();
+  BOOST_CHECK_EQUAL(pool.NumCachedBytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestAllocateArray) {
+  GpuMemoryPool& pool = GpuMemoryPool::Get();
+  const cudaChannelFormatDesc format = cudaCreateChannelDesc<float>();
+  const cudaExtent extent = make_cudaExtent(10, 20, 3);
+
+  std::shared_ptr<cudaArray> array1 =
+      pool.AllocateArray(format, extent, cudaArrayLayered);
+  BOOST_CHECK(array1);
+  cudaArray* ptr1 = array1.get();
+  array1.reset();
+
+  std::shared_ptr<cudaArray> array2 =
+      pool.AllocateArray(format, make_cudaExtent(20, 10, 3), cudaArrayLayered);
+  BOOST_CHECK_NE(array2.get(), ptr1);
+
+  std::shared_ptr<cudaArray> array3 =
+      pool.AllocateArray(format, extent, cudaArrayLayered);
+  BOOST_CHECK_EQUAL(array3.get(), ptr1);
+}
+
+BOOST_AUTO_TEST_CASE(TestGpuMatReuse) {
+  GpuMemoryPool::Get().Release();
+
+  const float* ptr = nullptr;
+  {
+    GpuMat<float> array(100, 100, 2);
+    array.FillWithScalar(1.0f);
+    ptr = array.GetPtr();
+  }
+
+  GpuMat<float> array(100, 100, 2);
+  BOOST_CHECK_EQUAL(array.GetPtr(), ptr);
+  array.FillWithScalar(2.0f);
+
+  std::vector<float> array_host(100 * 100 * 2, 0.0f);
+  array.CopyToHost(array_host.data(), 100 * sizeof(float));
+  for (const float value : array_host) {
+    BOOST_CHECK_EQUAL(value, 2.0f);
+  }
+}
@@ -89,6 +89,25 @@ void Image::Downsize(const size_t max_width, const size_t max_height) {
   Rescale(std::min(factor_x, factor_y));
 }
 
+Image Image::Crop(const size_t x, const size_t y, const size_t width,
+                  const size_t height) const {
+  CHECK_GT(width, 0);
+  CHECK_GT(height, 0);
+  CHECK_LE(x + width, width_);
+  CHECK_LE(y + height, height_);
+
+  float K[9];
+  memcpy(K, K_, 9 * sizeof(float));
+  K[2] -= x;
+  K[5] -= y;
+
+  Image cropped_image(path_, width, height, K, R_, T_);
+  if (bitmap_.Data() != nullptr) {
+    cropped_image.bitmap_ = bitmap_.Crop(x, y, width, height);
+  }
+  return cropped_image;
+}
+
 void ComputeRelativePose(const float R1[9], const float T1[3],
                          const float R2[9], const float T2[3], float R[9],
                          float T[3]) {
@@ -68,6 +68,12 @@ class Image {
   void Rescale(const float factor_x, const float factor_y);
   void Downsize(const size_t max_width, const size_t max_height);
 
+  // Crop the region with the given top-left corner and size, where the
+  // principal point is shifted such that the cropped image observes the same
+  // rays as the corresponding pixels of the original image.
+  Image Crop(const size_t x, const size_t y, const size_t width,
+             const size_t height) const;
+
  private:
   std::string path_;
   size_t width_;
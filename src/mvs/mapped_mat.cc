@@ -0,0 +1,65 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "mvs/mapped_mat.h"
+
+#include <cctype>
+
+namespace colmap {
+namespace mvs {
+
+size_t ParseMappedMatHeader(const MappedFile& file, size_t* width,
+                            size_t* height, size_t* depth) {
+  const char* data = file.GetData();
+  const size_t num_bytes = file.GetNumBytes();
+
+  size_t offset = 0;
+  size_t* dims[3] = {width, height, depth};
+  for (size_t* dim : dims) {
+    CHECK(offset < num_bytes && std::isdigit(data[offset]))
+        << "Only untagged matrix files can be mapped";
+    *dim = 0;
+    while (offset < num_bytes && std::isdigit(data[offset])) {
+      *dim = 10 * *dim + (data[offset] - '0');
+      offset += 1;
+    }
+    CHECK(offset < num_bytes && data[offset] == '&');
+    offset += 1;
+  }
+
+  CHECK_GT(*width, 0);
+  CHECK_GT(*height, 0);
+  CHECK_GT(*depth, 0);
+
+  return offset;
+}
+
+}  // namespace mvs
+}  // namespace colmap
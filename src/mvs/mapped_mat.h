@@ -0,0 +1,140 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_MVS_MAPPED_MAT_H_
+#define COLMAP_SRC_MVS_MAPPED_MAT_H_
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "util/endian.h"
+#include "util/logging.h"
+#include "util/mapped_file.h"
+#include "util/types.h"
+
+namespace colmap {
+namespace mvs {
+
+// Read-only matrix, whose data is memory mapped from a file in the format of
+// `Mat<T>::Write`. In contrast to `Mat<T>::Read`, only the accessed pages are
+// read from disk and no copy of the data is made. Furthermore, the pages are
+// shared through the page cache with all processes mapping the same file.
+// The matrix file must not be modified while it is mapped.
+template <typename T>
+class MappedMat {
+ public:
+  MappedMat();
+
+  size_t GetWidth() const;
+  size_t GetHeight() const;
+  size_t GetDepth() const;
+
+  // The number of bytes of the mapped data.
+  size_t GetNumBytes() const;
+
+  T Get(const size_t row, const size_t col, const size_t slice = 0) const;
+  void GetSlice(const size_t row, const size_t col, T* values) const;
+
+  // Map the matrix from a file in the untagged, little endian format.
+  void Read(const std::string& path);
+
+ private:
+  size_t width_ = 0;
+  size_t height_ = 0;
+  size_t depth_ = 0;
+  std::shared_ptr<MappedFile> file_;
+  const char* data_ = nullptr;
+};
+
+// Parse the header of a matrix file and return the offset of its data.
+size_t ParseMappedMatHeader(const MappedFile& file, size_t* width,
+                            size_t* height, size_t* depth);
+
+////////////////////////////////////////////////////////////////////////////////
+// Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+MappedMat<T>::MappedMat() {}
+
+template <typename T>
+size_t MappedMat<T>::GetWidth() const {
+  return width_;
+}
+
+template <typename T>
+size_t MappedMat<T>::GetHeight() const {
+  return height_;
+}
+
+template <typename T>
+size_t MappedMat<T>::GetDepth() const {
+  return depth_;
+}
+
+template <typename T>
+size_t MappedMat<T>::GetNumBytes() const {
+  return width_ * height_ * depth_ * sizeof(T);
+}
+
+template <typename T>
+T MappedMat<T>::Get(const size_t row, const size_t col,
+                    const size_t slice) const {
+  const size_t index = slice * width_ * height_ + row * width_ + col;
+  DCHECK_LT(index, width_ * height_ * depth_);
+  // The data is not necessarily aligned, since the header has variable length.
+  T value;
+  std::memcpy(&value, data_ + index * sizeof(T), sizeof(T));
+  return value;
+}
+
+template <typename T>
+void MappedMat<T>::GetSlice(const size_t row, const size_t col,
+                            T* values) const {
+  for (size_t slice = 0; slice < depth_; ++slice) {
+    values[slice] = Get(row, col, slice);
+  }
+}
+
+template <typename T>
+void MappedMat<T>::Read(const std::string& path) {
+  CHECK(IsLittleEndian()) << "Memory mapping requires a little endian host";
+  file_ = std::make_shared<MappedFile>(path);
+  const size_t offset =
+      ParseMappedMatHeader(*file_, &width_, &height_, &depth_);
+  CHECK_EQ(file_->GetNumBytes(), offset + GetNumBytes()) << path;
+  data_ = file_->GetData() + offset;
+}
+
+}  // namespace mvs
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_MVS_MAPPED_MAT_H_
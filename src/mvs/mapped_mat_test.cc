@@ -0,0 +1,90 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "mvs/mapped_mat_test"
+#include "util/testing.h"
+
+#include <boost/filesystem.hpp>
+
+#include "mvs/mapped_mat.h"
+#include "mvs/mat.h"
+
+using namespace colmap::mvs;
+
+BOOST_AUTO_TEST_CASE(TestEmpty) {
+  MappedMat<float> mat;
+  BOOST_CHECK_EQUAL(mat.GetWidth(), 0);
+  BOOST_CHECK_EQUAL(mat.GetHeight(), 0);
+  BOOST_CHECK_EQUAL(mat.GetDepth(), 0);
+  BOOST_CHECK_EQUAL(mat.GetNumBytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestRead) {
+  Mat<float> mat(3, 2, 2);
+  for (size_t slice = 0; slice < 2; ++slice) {
+    for (size_t row = 0; row < 2; ++row) {
+      for (size_t col = 0; col < 3; ++col) {
+        mat.Set(row, col, slice, slice * 100 + row * 10 + col + 0.5f);
+      }
+    }
+  }
+
+  const std::string path = (boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path())
+                               .string();
+  mat.Write(path);
+
+  MappedMat<float> mapped_mat;
+  mapped_mat.Read(path);
+  BOOST_CHECK_EQUAL(mapped_mat.GetWidth(), 3);
+  BOOST_CHECK_EQUAL(mapped_mat.GetHeight(), 2);
+  BOOST_CHECK_EQUAL(mapped_mat.GetDepth(), 2);
+  BOOST_CHECK_EQUAL(mapped_mat.GetNumBytes(), mat.GetNumBytes());
+  for (size_t slice = 0; slice < 2; ++slice) {
+    for (size_t row = 0; row < 2; ++row) {
+      for (size_t col = 0; col < 3; ++col) {
+        BOOST_CHECK_EQUAL(mapped_mat.Get(row, col, slice),
+                          mat.Get(row, col, slice));
+      }
+    }
+  }
+
+  float values[2];
+  mapped_mat.GetSlice(1, 2, values);
+  BOOST_CHECK_EQUAL(values[0], 12.5f);
+  BOOST_CHECK_EQUAL(values[1], 112.5f);
+
+  // The mapping remains valid for copies of the matrix.
+  const MappedMat<float> copied_mapped_mat = mapped_mat;
+  mapped_mat = MappedMat<float>();
+  BOOST_CHECK_EQUAL(copied_mapped_mat.Get(1, 1, 1), 111.5f);
+
+  boost::filesystem::remove(path);
+}
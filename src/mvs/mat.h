@@ -32,6 +32,7 @@
 #ifndef COLMAP_SRC_MVS_MAT_H_
 #define COLMAP_SRC_MVS_MAT_H_
 
+#include <cctype>
 #include <fstream>
 #include <string>
 #include <vector>
@@ -71,12 +72,22 @@ class Mat {
   void Write(const std::string& path) const;
 
  protected:
+  // Read and write the matrix with a format tag preceding the header, which
+  // distinguishes different encodings of the same data in derived classes.
+  void ReadWithFormatTag(const std::string& path,
+                         const std::string& format_tag);
+  void WriteWithFormatTag(const std::string& path,
+                          const std::string& format_tag) const;
+
   size_t width_ = 0;
   size_t height_ = 0;
   size_t depth_ = 0;
   std::vector<T> data_;
 };
 
+// Read the format tag of a matrix file, which is empty for untagged files.
+inline std::string ReadMatFormatTag(const std::string& path);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
@@ -155,9 +166,26 @@ void Mat<T>::Fill(const T value) {
 
 template <typename T>
 void Mat<T>::Read(const std::string& path) {
+  ReadWithFormatTag(path, "");
+}
+
+template <typename T>
+void Mat<T>::Write(const std::string& path) const {
+  WriteWithFormatTag(path, "");
+}
+
+template <typename T>
+void Mat<T>::ReadWithFormatTag(const std::string& path,
+                               const std::string& format_tag) {
   std::fstream text_file(path, std::ios::in | std::ios::binary);
   CHECK(text_file.is_open()) << path;
 
+  if (!format_tag.empty()) {
+    std::string file_format_tag;
+    std::getline(text_file, file_format_tag, '&');
+    CHECK_EQ(file_format_tag, format_tag) << path;
+  }
+
   char unused_char;
   text_file >> width_ >> unused_char >> height_ >> unused_char >> depth_ >>
       unused_char;
@@ -177,9 +205,13 @@ void Mat<T>::Read(const std::string& path) {
 }
 
 template <typename T>
-void Mat<T>::Write(const std::string& path) const {
+void Mat<T>::WriteWithFormatTag(const std::string& path,
+                                const std::string& format_tag) const {
   std::fstream text_file(path, std::ios::out);
   CHECK(text_file.is_open()) << path;
+  if (!format_tag.empty()) {
+    text_file << format_tag << "&";
+  }
   text_file << width_ << "&" << height_ << "&" << depth_ << "&";
   text_file.close();
 
@@ -190,6 +222,16 @@ void Mat<T>::Write(const std::string& path) const {
   binary_file.close();
 }
 
+std::string ReadMatFormatTag(const std::string& path) {
+  std::fstream text_file(path, std::ios::in | std::ios::binary);
+  CHECK(text_file.is_open()) << path;
+  std::string format_tag;
+  if (!std::isdigit(text_file.peek())) {
+    std::getline(text_file, format_tag, '&');
+  }
+  return format_tag;
+}
+
 }  // namespace mvs
 }  // namespace colmap
 
@@ -0,0 +1,633 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "mvs/mesh_simplification.h"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <Eigen/LU>
+
+#include "util/logging.h"
+#include "util/misc.h"
+#include "util/string.h"
+#include "util/threading.h"
+#include "util/timer.h"
+
+namespace colmap {
+namespace mvs {
+namespace {
+
+// The minimum cosine of the angle between the normal of a face before and
+// after an edge collapse, below which the collapse is rejected as a flip.
+const double kMinCollapseNormalCos = 0.2;
+
+// The quadric error of a point x given by x^T A x + 2 b^T x + c, which is the
+// weighted sum of the squared distances of the point to a set of planes.
+struct Quadric {
+  Quadric() : A(Eigen::Matrix3d::Zero()), b(Eigen::Vector3d::Zero()), c(0) {}
+
+  void AddPlane(const Eigen::Vector3d& normal, const double d,
+                const double weight) {
+    A += weight * normal * normal.transpose();
+    b += weight * d * normal;
+    c += weight * d * d;
+  }
+
+  Quadric& operator+=(const Quadric& other) {
+    A += other.A;
+    b += other.b;
+    c += other.c;
+    return *this;
+  }
+
+  double Error(const Eigen::Vector3d& x) const {
+    return x.dot(A * x) + 2 * b.dot(x) + c;
+  }
+
+  Eigen::Matrix3d A;
+  Eigen::Vector3d b;
+  double c;
+};
+
+class QuadricMeshDecimator {
+ public:
+  explicit QuadricMeshDecimator(const PlyMesh& mesh);
+
+  size_t NumFaces() const;
+
+  // Collapse edges until at most the given number of faces remain. Can be
+  // called repeatedly with decreasing numbers of faces.
+  void Decimate(const size_t max_num_faces);
+
+  // Extract the remaining faces and their vertices.
+  PlyMesh Mesh() const;
+
+ private:
+  struct Collapse {
+    double cost;
+    int vertex_idx1;
+    int vertex_idx2;
+    int version1;
+    int version2;
+    Eigen::Vector3d position;
+
+    bool operator>(const Collapse& other) const { return cost > other.cost; }
+  };
+
+  void PushCollapse(const int vertex_idx1, const int vertex_idx2);
+  bool IsValidCollapse(const int removed_vertex_idx,
+                       const int kept_vertex_idx,
+                       const Eigen::Vector3d& position) const;
+  void ApplyCollapse(const int removed_vertex_idx, const int kept_vertex_idx,
+                     const Eigen::Vector3d& position);
+  void RemoveVertexFace(const int vertex_idx, const int face_idx);
+
+  std::vector<Eigen::Vector3d> positions_;
+  std::vector<Quadric> quadrics_;
+  std::vector<bool> locked_vertices_;
+  std::vector<bool> removed_vertices_;
+  // Incremented whenever a vertex changes, which invalidates the queued
+  // collapses of its edges.
+  std::vector<int> vertex_versions_;
+  std::vector<std::vector<int>> vertex_faces_;
+  std::vector<std::array<int, 3>> faces_;
+  std::vector<bool> removed_faces_;
+  size_t num_faces_;
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>>
+      collapses_;
+};
+
+QuadricMeshDecimator::QuadricMeshDecimator(const PlyMesh& mesh)
+    : positions_(mesh.vertices.size()),
+      quadrics_(mesh.vertices.size()),
+      locked_vertices_(mesh.vertices.size(), false),
+      removed_vertices_(mesh.vertices.size(), false),
+      vertex_versions_(mesh.vertices.size(), 0),
+      vertex_faces_(mesh.vertices.size()),
+      num_faces_(0) {
+  for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+    positions_[i] = Eigen::Vector3d(mesh.vertices[i].x, mesh.vertices[i].y,
+                                    mesh.vertices[i].z);
+  }
+
+  // The number of faces of every edge, which identifies the boundary and
+  // non-manifold edges, whose vertices are locked.
+  std::unordered_map<uint64_t, int> edge_num_faces;
+  const auto EdgeKey = [](const int vertex_idx1, const int vertex_idx2) {
+    return (static_cast<uint64_t>(std::min(vertex_idx1, vertex_idx2)) << 32) |
+           static_cast<uint64_t>(std::max(vertex_idx1, vertex_idx2));
+  };
+
+  faces_.reserve(mesh.faces.size());
+  for (const auto& mesh_face : mesh.faces) {
+    const std::array<int, 3> face = {{static_cast<int>(mesh_face.vertex_idx1),
+                                      static_cast<int>(mesh_face.vertex_idx2),
+                                      static_cast<int>(mesh_face.vertex_idx3)}};
+    if (face[0] == face[1] || face[1] == face[2] || face[0] == face[2]) {
+      continue;
+    }
+
+    const int face_idx = static_cast<int>(faces_.size());
+    faces_.push_back(face);
+    for (int i = 0; i < 3; ++i) {
+      CHECK_LT(face[i], positions_.size());
+      vertex_faces_[face[i]].push_back(face_idx);
+      edge_num_faces[EdgeKey(face[i], face[(i + 1) % 3])] += 1;
+    }
+
+    // Each face contributes its plane weighted by its area.
+    const Eigen::Vector3d normal =
+        (positions_[face[1]] - positions_[face[0]])
+            .cross(positions_[face[2]] - positions_[face[0]]);
+    const double normal_norm = normal.norm();
+    if (normal_norm > 0) {
+      const Eigen::Vector3d unit_normal = normal / normal_norm;
+      const double d = -unit_normal.dot(positions_[face[0]]);
+      for (int i = 0; i < 3; ++i) {
+        quadrics_[face[i]].AddPlane(unit_normal, d, 0.5 * normal_norm);
+      }
+    }
+  }
+
+  num_faces_ = faces_.size();
+  removed_faces_.resize(faces_.size(), false);
+
+  for (const auto& edge : edge_num_faces) {
+    if (edge.second != 2) {
+      locked_vertices_[edge.first >> 32] = true;
+      locked_vertices_[edge.first & 0xFFFFFFFF] = true;
+    }
+  }
+
+  for (const auto& edge : edge_num_faces) {
+    PushCollapse(static_cast<int>(edge.first >> 32),
+                 static_cast<int>(edge.first & 0xFFFFFFFF));
+  }
+}
+
+size_t QuadricMeshDecimator::NumFaces() const { return num_faces_; }
+
+void QuadricMeshDecimator::Decimate(const size_t max_num_faces) {
+  while (num_faces_ > max_num_faces && !collapses_.empty()) {
+    const Collapse collapse = collapses_.top();
+    collapses_.pop();
+
+    if (removed_vertices_[collapse.vertex_idx1] ||
+        removed_vertices_[collapse.vertex_idx2] ||
+        vertex_versions_[collapse.vertex_idx1] != collapse.version1 ||
+        vertex_versions_[collapse.vertex_idx2] != collapse.version2) {
+      continue;
+    }
+
+    // A locked vertex is always kept, and at most one vertex is locked.
+    int removed_vertex_idx = collapse.vertex_idx2;
+    int kept_vertex_idx = collapse.vertex_idx1;
+    if (locked_vertices_[removed_vertex_idx]) {
+      std::swap(removed_vertex_idx, kept_vertex_idx);
+    }
+
+    if (IsValidCollapse(removed_vertex_idx, kept_vertex_idx,
+                        collapse.position)) {
+      ApplyCollapse(removed_vertex_idx, kept_vertex_idx, collapse.position);
+    }
+  }
+}
+
+PlyMesh QuadricMeshDecimator::Mesh() const {
+  PlyMesh mesh;
+  mesh.faces.reserve(num_faces_);
+  std::vector<int> vertex_idxs(positions_.size(), -1);
+  for (size_t face_idx = 0; face_idx < faces_.size(); ++face_idx) {
+    if (removed_faces_[face_idx]) {
+      continue;
+    }
+    std::array<size_t, 3> face;
+    for (int i = 0; i < 3; ++i) {
+      int& vertex_idx = vertex_idxs[faces_[face_idx][i]];
+      if (vertex_idx == -1) {
+        vertex_idx = static_cast<int>(mesh.vertices.size());
+        const Eigen::Vector3d& position = positions_[faces_[face_idx][i]];
+        mesh.vertices.emplace_back(static_cast<float>(position.x()),
+                                   static_cast<float>(position.y()),
+                                   static_cast<float>(position.z()));
+      }
+      face[i] = static_cast<size_t>(vertex_idx);
+    }
+    mesh.faces.emplace_back(face[0], face[1], face[2]);
+  }
+  return mesh;
+}
+
+void QuadricMeshDecimator::PushCollapse(const int vertex_idx1,
+                                        const int vertex_idx2) {
+  if (locked_vertices_[vertex_idx1] && locked_vertices_[vertex_idx2]) {
+    return;
+  }
+
+  Quadric quadric = quadrics_[vertex_idx1];
+  quadric += quadrics_[vertex_idx2];
+
+  const Eigen::Vector3d& position1 = positions_[vertex_idx1];
+  const Eigen::Vector3d& position2 = positions_[vertex_idx2];
+
+  Collapse collapse;
+  collapse.vertex_idx1 = vertex_idx1;
+  collapse.vertex_idx2 = vertex_idx2;
+  collapse.version1 = vertex_versions_[vertex_idx1];
+  collapse.version2 = vertex_versions_[vertex_idx2];
+
+  if (locked_vertices_[vertex_idx1]) {
+    collapse.position = position1;
+  } else if (locked_vertices_[vertex_idx2]) {
+    collapse.position = position2;
+  } else {
+    // Choose the position with the smallest error out of the endpoints, the
+    // midpoint, and the optimal position, if the quadric is well-conditioned
+    // and the optimal position lies close to the edge.
+    std::vector<Eigen::Vector3d> positions = {position1, position2,
+                                              0.5 * (position1 + position2)};
+    Eigen::Matrix3d A_inv;
+    bool invertible = false;
+    quadric.A.computeInverseWithCheck(A_inv, invertible);
+    if (invertible) {
+      const Eigen::Vector3d optimal_position = -A_inv * quadric.b;
+      if ((optimal_position - positions[2]).norm() <=
+          (position1 - position2).norm()) {
+        positions.push_back(optimal_position);
+      }
+    }
+
+    double min_error = std::numeric_limits<double>::max();
+    for (const auto& position : positions) {
+      const double error = quadric.Error(position);
+      if (error < min_error) {
+        min_error = error;
+        collapse.position = position;
+      }
+    }
+  }
+
+  // Clamp negative errors due to numerical inaccuracies.
+  collapse.cost = std::max(0.0, quadric.Error(collapse.position));
+  collapses_.push(collapse);
+}
+
+bool QuadricMeshDecimator::IsValidCollapse(
+    const int removed_vertex_idx, const int kept_vertex_idx,
+    const Eigen::Vector3d& position) const {
+  // The collapse keeps the mesh manifold, if the vertices only share the
+  // neighbors opposite of their shared edge.
+  std::unordered_set<int> kept_neighbors;
+  for (const int face_idx : vertex_faces_[kept_vertex_idx]) {
+    for (const int vertex_idx : faces_[face_idx]) {
+      if (vertex_idx != kept_vertex_idx && vertex_idx != removed_vertex_idx) {
+        kept_neighbors.insert(vertex_idx);
+      }
+    }
+  }
+
+  size_t num_shared_faces = 0;
+  std::unordered_set<int> shared_neighbors;
+  for (const int face_idx : vertex_faces_[removed_vertex_idx]) {
+    const auto& face = faces_[face_idx];
+    const bool is_shared_face =
+        face[0] == kept_vertex_idx || face[1] == kept_vertex_idx ||
+        face[2] == kept_vertex_idx;
+    if (is_shared_face) {
+      num_shared_faces += 1;
+      continue;
+    }
+
+    // Reject the collapse, if it flips or degenerates one of the faces.
+    std::array<Eigen::Vector3d, 3> face_positions;
+    for (int i = 0; i < 3; ++i) {
+      if (kept_neighbors.count(face[i]) > 0) {
+        shared_neighbors.insert(face[i]);
+      }
+      face_positions[i] = positions_[face[i]];
+    }
+    const Eigen::Vector3d normal =
+        (face_positions[1] - face_positions[0])
+            .cross(face_positions[2] - face_positions[0]);
+    for (int i = 0; i < 3; ++i) {
+      if (face[i] == removed_vertex_idx) {
+        face_positions[i] = position;
+      }
+    }
+    const Eigen::Vector3d new_normal =
+        (face_positions[1] - face_positions[0])
+            .cross(face_positions[2] - face_positions[0]);
+    if (new_normal.dot(normal) <=
+        kMinCollapseNormalCos * new_normal.norm() * normal.norm()) {
+      return false;
+    }
+  }
+
+  if (num_shared_faces == 0 || shared_neighbors.size() != num_shared_faces) {
+    return false;
+  }
+
+  // The faces of the kept vertex move, if the vertex is not locked.
+  if (!locked_vertices_[kept_vertex_idx]) {
+    for (const int face_idx : vertex_faces_[kept_vertex_idx]) {
+      const auto& face = faces_[face_idx];
+      if (face[0] == removed_vertex_idx || face[1] == removed_vertex_idx ||
+          face[2] == removed_vertex_idx) {
+        continue;
+      }
+      std::array<Eigen::Vector3d, 3> face_positions;
+      for (int i = 0; i < 3; ++i) {
+        face_positions[i] = positions_[face[i]];
+      }
+      const Eigen::Vector3d normal =
+          (face_positions[1] - face_positions[0])
+              .cross(face_positions[2] - face_positions[0]);
+      for (int i = 0; i < 3; ++i) {
+        if (face[i] == kept_vertex_idx) {
+          face_positions[i] = position;
+        }
+      }
+      const Eigen::Vector3d new_normal =
+          (face_positions[1] - face_positions[0])
+              .cross(face_positions[2] - face_positions[0]);
+      if (new_normal.dot(normal) <=
+          kMinCollapseNormalCos * new_normal.norm() * normal.norm()) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void QuadricMeshDecimator::ApplyCollapse(const int removed_vertex_idx,
+                                         const int kept_vertex_idx,
+                                         const Eigen::Vector3d& position) {
+  const std::vector<int> removed_vertex_faces =
+      std::move(vertex_faces_[removed_vertex_idx]);
+  vertex_faces_[removed_vertex_idx].clear();
+
+  for (const int face_idx : removed_vertex_faces) {
+    auto& face = faces_[face_idx];
+    if (face[0] == kept_vertex_idx || face[1] == kept_vertex_idx ||
+        face[2] == kept_vertex_idx) {
+      removed_faces_[face_idx] = true;
+      num_faces_ -= 1;
+      for (const int vertex_idx : face) {
+        if (vertex_idx != removed_vertex_idx) {
+          RemoveVertexFace(vertex_idx, face_idx);
+        }
+      }
+    } else {
+      for (int& vertex_idx : face) {
+        if (vertex_idx == removed_vertex_idx) {
+          vertex_idx = kept_vertex_idx;
+        }
+      }
+      vertex_faces_[kept_vertex_idx].push_back(face_idx);
+    }
+  }
+
+  removed_vertices_[removed_vertex_idx] = true;
+  positions_[kept_vertex_idx] = position;
+  quadrics_[kept_vertex_idx] += quadrics_[removed_vertex_idx];
+  vertex_versions_[removed_vertex_idx] += 1;
+  vertex_versions_[kept_vertex_idx] += 1;
+
+  std::unordered_set<int> neighbors;
+  for (const int face_idx : vertex_faces_[kept_vertex_idx]) {
+    for (const int vertex_idx : faces_[face_idx]) {
+      if (vertex_idx != kept_vertex_idx &&
+          neighbors.insert(vertex_idx).second) {
+        PushCollapse(kept_vertex_idx, vertex_idx);
+      }
+    }
+  }
+}
+
+void QuadricMeshDecimator::RemoveVertexFace(const int vertex_idx,
+                                            const int face_idx) {
+  auto& vertex_faces = vertex_faces_[vertex_idx];
+  const auto it = std::find(vertex_faces.begin(), vertex_faces.end(), face_idx);
+  CHECK(it != vertex_faces.end());
+  *it = vertex_faces.back();
+  vertex_faces.pop_back();
+}
+
+Eigen::Vector3f FaceCentroid(const PlyMesh& mesh, const PlyMeshFace& face) {
+  const auto& vertex1 = mesh.vertices[face.vertex_idx1];
+  const auto& vertex2 = mesh.vertices[face.vertex_idx2];
+  const auto& vertex3 = mesh.vertices[face.vertex_idx3];
+  return Eigen::Vector3f(vertex1.x + vertex2.x + vertex3.x,
+                         vertex1.y + vertex2.y + vertex3.y,
+                         vertex1.z + vertex2.z + vertex3.z) /
+         3.0f;
+}
+
+// Recursively split the faces at the median of the longest axis of the
+// bounding box of their centroids, until each block has at most the given
+// number of faces. The blocks are returned as ranges of the face indices.
+void SplitMeshBlocks(const std::vector<Eigen::Vector3f>& centroids,
+                     const size_t max_num_faces,
+                     std::vector<size_t>::iterator face_idxs_begin,
+                     std::vector<size_t>::iterator face_idxs_end,
+                     std::vector<std::pair<std::vector<size_t>::iterator,
+                                           std::vector<size_t>::iterator>>*
+                         blocks) {
+  const size_t num_faces = face_idxs_end - face_idxs_begin;
+  if (num_faces <= max_num_faces) {
+    blocks->emplace_back(face_idxs_begin, face_idxs_end);
+    return;
+  }
+
+  Eigen::AlignedBox3f box;
+  for (auto it = face_idxs_begin; it != face_idxs_end; ++it) {
+    box.extend(centroids[*it]);
+  }
+
+  int axis;
+  box.sizes().maxCoeff(&axis);
+
+  const auto face_idxs_median = face_idxs_begin + num_faces / 2;
+  std::nth_element(face_idxs_begin, face_idxs_median, face_idxs_end,
+                   [&](const size_t idx1, const size_t idx2) {
+                     return centroids[idx1](axis) < centroids[idx2](axis);
+                   });
+
+  SplitMeshBlocks(centroids, max_num_faces, face_idxs_begin, face_idxs_median,
+                  blocks);
+  SplitMeshBlocks(centroids, max_num_faces, face_idxs_median, face_idxs_end,
+                  blocks);
+}
+
+// Extract the given faces and their vertices from the mesh.
+PlyMesh ExtractMeshBlock(const PlyMesh& mesh,
+                         std::vector<size_t>::const_iterator face_idxs_begin,
+                         std::vector<size_t>::const_iterator face_idxs_end) {
+  PlyMesh block_mesh;
+  block_mesh.faces.reserve(face_idxs_end - face_idxs_begin);
+  std::unordered_map<size_t, size_t> vertex_idxs;
+  const auto BlockVertexIdx = [&](const size_t vertex_idx) {
+    const auto it = vertex_idxs.emplace(vertex_idx, block_mesh.vertices.size());
+    if (it.second) {
+      block_mesh.vertices.push_back(mesh.vertices[vertex_idx]);
+    }
+    return it.first->second;
+  };
+  for (auto it = face_idxs_begin; it != face_idxs_end; ++it) {
+    const PlyMeshFace& face = mesh.faces[*it];
+    const size_t vertex_idx1 = BlockVertexIdx(face.vertex_idx1);
+    const size_t vertex_idx2 = BlockVertexIdx(face.vertex_idx2);
+    const size_t vertex_idx3 = BlockVertexIdx(face.vertex_idx3);
+    block_mesh.faces.emplace_back(vertex_idx1, vertex_idx2, vertex_idx3);
+  }
+  return block_mesh;
+}
+
+}  // namespace
+
+bool MeshSimplificationOptions::Check() const {
+  CHECK_OPTION_GE(num_levels, 0);
+  CHECK_OPTION_GT(level_face_ratio, 0);
+  CHECK_OPTION_LT(level_face_ratio, 1);
+  CHECK_OPTION_GT(max_block_num_faces, 0);
+  return true;
+}
+
+PlyMesh DecimateMesh(const PlyMesh& mesh, const size_t max_num_faces) {
+  QuadricMeshDecimator decimator(mesh);
+  decimator.Decimate(max_num_faces);
+  return decimator.Mesh();
+}
+
+std::string GetMeshLevelOfDetailPath(const std::string& path,
+                                     const int level) {
+  std::string root = path;
+  if (HasFileExtension(path, ".ply")) {
+    std::string ext;
+    SplitFileExtension(path, &root, &ext);
+  }
+  return StringPrintf("%s.lod%d.ply", root.c_str(), level);
+}
+
+void WriteMeshLevelsOfDetail(const MeshSimplificationOptions& options,
+                             const PlyMesh& mesh, const std::string& path) {
+  CHECK(options.Check());
+
+  if (options.num_levels == 0) {
+    return;
+  }
+
+  Timer timer;
+  timer.Start();
+
+  std::vector<Eigen::Vector3f> centroids(mesh.faces.size());
+  for (size_t face_idx = 0; face_idx < mesh.faces.size(); ++face_idx) {
+    centroids[face_idx] = FaceCentroid(mesh, mesh.faces[face_idx]);
+  }
+
+  std::vector<size_t> face_idxs(mesh.faces.size());
+  std::iota(face_idxs.begin(), face_idxs.end(), 0);
+
+  std::vector<std::pair<std::vector<size_t>::iterator,
+                        std::vector<size_t>::iterator>>
+      blocks;
+  SplitMeshBlocks(centroids, options.max_block_num_faces, face_idxs.begin(),
+                  face_idxs.end(), &blocks);
+  centroids.clear();
+  centroids.shrink_to_fit();
+
+  std::vector<std::unique_ptr<BinaryPlyMeshWriter>> writers;
+  for (int level = 1; level <= options.num_levels; ++level) {
+    writers.emplace_back(
+        new BinaryPlyMeshWriter(GetMeshLevelOfDetailPath(path, level)));
+  }
+
+  // Each block is decimated progressively from one level to the next.
+  const auto DecimateBlock = [&](const size_t block_idx) {
+    QuadricMeshDecimator decimator(ExtractMeshBlock(
+        mesh, blocks[block_idx].first, blocks[block_idx].second));
+    std::vector<PlyMesh> level_meshes;
+    level_meshes.reserve(options.num_levels);
+    double max_num_faces = decimator.NumFaces();
+    for (int level = 1; level <= options.num_levels; ++level) {
+      max_num_faces *= options.level_face_ratio;
+      decimator.Decimate(static_cast<size_t>(max_num_faces));
+      level_meshes.push_back(decimator.Mesh());
+    }
+    return level_meshes;
+  };
+
+  // The blocks are written in order, and only a bounded number of decimated
+  // blocks are kept in memory, while waiting for their predecessors.
+  ThreadPool thread_pool(GetEffectiveNumThreads(options.num_threads));
+  const size_t max_num_pending_blocks = 2 * thread_pool.NumThreads();
+  std::deque<std::future<std::vector<PlyMesh>>> pending_blocks;
+  size_t next_block_idx = 0;
+  for (size_t block_idx = 0; block_idx < blocks.size(); ++block_idx) {
+    while (next_block_idx < blocks.size() &&
+           pending_blocks.size() < max_num_pending_blocks) {
+      pending_blocks.push_back(
+          thread_pool.AddTask(DecimateBlock, next_block_idx));
+      next_block_idx += 1;
+    }
+
+    const std::vector<PlyMesh> level_meshes = pending_blocks.front().get();
+    pending_blocks.pop_front();
+    for (int level = 0; level < options.num_levels; ++level) {
+      writers[level]->Write(level_meshes[level]);
+    }
+  }
+
+  for (int level = 0; level < options.num_levels; ++level) {
+    writers[level]->Close();
+    std::cout << StringPrintf("Level of detail %d: %d vertices, %d faces",
+                              level + 1, writers[level]->NumVertices(),
+                              writers[level]->NumFaces())
+              << std::endl;
+  }
+
+  timer.PrintSeconds();
+}
+
+}  // namespace mvs
+}  // namespace colmap
@@ -0,0 +1,88 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_MVS_MESH_SIMPLIFICATION_H_
+#define COLMAP_SRC_MVS_MESH_SIMPLIFICATION_H_
+
+#include <string>
+#include <vector>
+
+#include "util/ply.h"
+
+namespace colmap {
+namespace mvs {
+
+struct MeshSimplificationOptions {
+  // The number of levels of detail that are written next to the mesh, where
+  // level l is written to "<mesh>.lod<l>.ply". Disabled if zero.
+  int num_levels = 0;
+
+  // The fraction of the faces of the previous level that each level retains.
+  double level_face_ratio = 0.25;
+
+  // The mesh is split into spatial blocks with at most this many faces, which
+  // are decimated independently in parallel and streamed to the output. The
+  // boundary vertices of each block are kept fixed, so that the blocks still
+  // fit together, which leaves the block borders at the original resolution.
+  int max_block_num_faces = 250000;
+
+  // The number of threads used for decimating the blocks.
+  int num_threads = -1;
+
+  bool Check() const;
+};
+
+// Decimate the mesh by iteratively collapsing the edge with the smallest
+// quadric error, as described in:
+//
+//    M. Garland and P. Heckbert. "Surface simplification using quadric error
+//    metrics". SIGGRAPH, 1997.
+//
+// The decimation stops once at most the given number of faces remain or no
+// edge can be collapsed anymore. Collapses that would flip a face or make the
+// mesh non-manifold are rejected. Vertices on the boundary of the mesh are not
+// moved, so that independently decimated parts of a mesh still fit together.
+PlyMesh DecimateMesh(const PlyMesh& mesh, const size_t max_num_faces);
+
+// Get the path of the given level of detail of the mesh at the given path.
+std::string GetMeshLevelOfDetailPath(const std::string& path,
+                                     const int level);
+
+// Write the levels of detail of the mesh at the given path. Each level is
+// decimated from the previous level block by block, and the blocks are written
+// as soon as they are decimated, such that the decimated levels are never
+// kept in memory as a whole.
+void WriteMeshLevelsOfDetail(const MeshSimplificationOptions& options,
+                             const PlyMesh& mesh, const std::string& path);
+
+}  // namespace mvs
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_MVS_MESH_SIMPLIFICATION_H_
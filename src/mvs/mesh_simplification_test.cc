@@ -0,0 +1,163 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "mvs/mesh_simplification_test"
+#include "util/testing.h"
+
+#include <fstream>
+#include <set>
+
+#include <boost/filesystem.hpp>
+
+#include "mvs/mesh_simplification.h"
+
+using namespace colmap;
+using namespace colmap::mvs;
+
+namespace {
+
+// Planar grid mesh in the z=0 plane with two triangles per grid cell.
+PlyMesh CreateGridMesh(const int num_cells) {
+  PlyMesh mesh;
+  for (int y = 0; y <= num_cells; ++y) {
+    for (int x = 0; x <= num_cells; ++x) {
+      mesh.vertices.emplace_back(x, y, 0);
+    }
+  }
+  for (int y = 0; y < num_cells; ++y) {
+    for (int x = 0; x < num_cells; ++x) {
+      const size_t idx = y * (num_cells + 1) + x;
+      mesh.faces.emplace_back(idx, idx + 1, idx + num_cells + 2);
+      mesh.faces.emplace_back(idx, idx + num_cells + 2, idx + num_cells + 1);
+    }
+  }
+  return mesh;
+}
+
+size_t ReadPlyHeaderNumFaces(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  BOOST_CHECK(file.is_open());
+  std::string line;
+  while (std::getline(file, line) && line != "end_header") {
+    if (line.find("element face") == 0) {
+      return std::stoull(line.substr(13));
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(TestDecimateMeshPlanarGrid) {
+  const int kNumCells = 20;
+  const PlyMesh mesh = CreateGridMesh(kNumCells);
+  const PlyMesh decimated_mesh = DecimateMesh(mesh, 100);
+
+  BOOST_CHECK_LE(decimated_mesh.faces.size(), 100);
+  BOOST_CHECK_GT(decimated_mesh.faces.size(), 0);
+  BOOST_CHECK_LT(decimated_mesh.vertices.size(), mesh.vertices.size());
+
+  // The mesh stays planar and the boundary vertices are preserved.
+  std::set<std::pair<float, float>> vertices;
+  for (const auto& vertex : decimated_mesh.vertices) {
+    BOOST_CHECK_EQUAL(vertex.z, 0);
+    BOOST_CHECK_GE(vertex.x, 0);
+    BOOST_CHECK_LE(vertex.x, kNumCells);
+    BOOST_CHECK_GE(vertex.y, 0);
+    BOOST_CHECK_LE(vertex.y, kNumCells);
+    vertices.emplace(vertex.x, vertex.y);
+  }
+  for (int i = 0; i <= kNumCells; ++i) {
+    BOOST_CHECK_EQUAL(vertices.count(std::make_pair(i, 0.0f)), 1);
+    BOOST_CHECK_EQUAL(vertices.count(std::make_pair(i, 1.0f * kNumCells)), 1);
+    BOOST_CHECK_EQUAL(vertices.count(std::make_pair(0.0f, i)), 1);
+    BOOST_CHECK_EQUAL(vertices.count(std::make_pair(1.0f * kNumCells, i)), 1);
+  }
+
+  // The decimated mesh covers the same area with consistent orientation.
+  double area = 0;
+  for (const auto& face : decimated_mesh.faces) {
+    BOOST_CHECK_LT(face.vertex_idx1, decimated_mesh.vertices.size());
+    BOOST_CHECK_LT(face.vertex_idx2, decimated_mesh.vertices.size());
+    BOOST_CHECK_LT(face.vertex_idx3, decimated_mesh.vertices.size());
+    const auto& vertex1 = decimated_mesh.vertices[face.vertex_idx1];
+    const auto& vertex2 = decimated_mesh.vertices[face.vertex_idx2];
+    const auto& vertex3 = decimated_mesh.vertices[face.vertex_idx3];
+    const double face_area =
+        0.5 * ((vertex2.x - vertex1.x) * (vertex3.y - vertex1.y) -
+               (vertex3.x - vertex1.x) * (vertex2.y - vertex1.y));
+    BOOST_CHECK_GT(face_area, 0);
+    area += face_area;
+  }
+  BOOST_CHECK_CLOSE(area, kNumCells * kNumCells, 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(TestDecimateMeshNoop) {
+  const PlyMesh mesh = CreateGridMesh(4);
+  const PlyMesh decimated_mesh = DecimateMesh(mesh, mesh.faces.size());
+  BOOST_CHECK_EQUAL(decimated_mesh.vertices.size(), mesh.vertices.size());
+  BOOST_CHECK_EQUAL(decimated_mesh.faces.size(), mesh.faces.size());
+}
+
+BOOST_AUTO_TEST_CASE(TestGetMeshLevelOfDetailPath) {
+  BOOST_CHECK_EQUAL(GetMeshLevelOfDetailPath("meshed.ply", 1),
+                    "meshed.lod1.ply");
+  BOOST_CHECK_EQUAL(GetMeshLevelOfDetailPath("dir/meshed.ply", 2),
+                    "dir/meshed.lod2.ply");
+  BOOST_CHECK_EQUAL(GetMeshLevelOfDetailPath("meshed", 3), "meshed.lod3.ply");
+}
+
+BOOST_AUTO_TEST_CASE(TestWriteMeshLevelsOfDetail) {
+  const std::string path =
+      (boost::filesystem::temp_directory_path() /
+       boost::filesystem::unique_path("%%%%-%%%%-%%%%.ply"))
+          .string();
+
+  const PlyMesh mesh = CreateGridMesh(40);
+
+  MeshSimplificationOptions options;
+  options.num_levels = 3;
+  options.level_face_ratio = 0.5;
+  options.max_block_num_faces = 1000;
+  options.num_threads = 2;
+  WriteMeshLevelsOfDetail(options, mesh, path);
+
+  BOOST_CHECK(!boost::filesystem::exists(path));
+  size_t prev_num_faces = mesh.faces.size();
+  for (int level = 1; level <= options.num_levels; ++level) {
+    const std::string level_path = GetMeshLevelOfDetailPath(path, level);
+    BOOST_CHECK(boost::filesystem::exists(level_path));
+    const size_t num_faces = ReadPlyHeaderNumFaces(level_path);
+    BOOST_CHECK_GT(num_faces, 0);
+    BOOST_CHECK_LT(num_faces, prev_num_faces);
+    prev_num_faces = num_faces;
+    boost::filesystem::remove(level_path);
+  }
+}
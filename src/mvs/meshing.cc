@@ -31,25 +31,32 @@
 
 #include "mvs/meshing.h"
 
+#include <algorithm>
 #include <fstream>
+#include <limits>
+#include <numeric>
 #include <unordered_map>
 #include <vector>
 
 #ifdef CGAL_ENABLED
 #include <CGAL/Delaunay_triangulation_3.h>
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Spatial_sort_traits_adapter_3.h>
+#include <CGAL/property_map.h>
+#include <CGAL/spatial_sort.h>
 #endif  // CGAL_ENABLED
 
+#include "PoissonRecon/Ply.h"
 #include "PoissonRecon/PoissonRecon.h"
 #include "PoissonRecon/SurfaceTrimmer.h"
 #include "base/graph_cut.h"
 #include "base/reconstruction.h"
+#include "mvs/fusion.h"
 #include "util/endian.h"
 #include "util/logging.h"
 #include "util/misc.h"
 #include "util/option_manager.h"
 #include "util/ply.h"
-#include "util/random.h"
 #include "util/threading.h"
 #include "util/timer.h"
 
@@ -102,6 +109,8 @@ bool PoissonMeshingOptions::Check() const {
   CHECK_OPTION_GE(trim, 0);
   CHECK_OPTION_GE(num_threads, -1);
   CHECK_OPTION_NE(num_threads, 0);
+  CHECK_OPTION_GE(max_tile_num_points, 0);
+  CHECK_OPTION_GE(tile_overlap, 0);
   return true;
 }
 
@@ -120,11 +129,11 @@ bool DelaunayMeshingOptions::Check() const {
   return true;
 }
 
-bool PoissonMeshing(const PoissonMeshingOptions& options,
-                    const std::string& input_path,
-                    const std::string& output_path) {
-  CHECK(options.Check());
+namespace {
 
+bool RunPoissonRecon(const PoissonMeshingOptions& options,
+                     const std::string& input_path,
+                     const std::string& output_path) {
   std::vector<std::string> args;
 
   args.push_back("./binary");
@@ -195,6 +204,231 @@ bool PoissonMeshing(const PoissonMeshingOptions& options,
                         const_cast<char**>(args_cstr.data())) == EXIT_SUCCESS;
 }
 
+Eigen::Vector3f PlyPointToEigen(const PlyPoint& point) {
+  return Eigen::Vector3f(point.x, point.y, point.z);
+}
+
+struct PoissonTile {
+  // The region of the tile, whose outer boundaries are unbounded.
+  Eigen::AlignedBox3f box;
+  // The bounding box of the points inside the tile.
+  Eigen::AlignedBox3f point_box;
+};
+
+// Recursively split the points at the median of the longest axis of their
+// bounding box, until each tile has at most the given number of points.
+void SplitPoissonTiles(const std::vector<PlyPoint>& points,
+                       const size_t max_num_points,
+                       const Eigen::AlignedBox3f& box,
+                       std::vector<size_t>::iterator point_idxs_begin,
+                       std::vector<size_t>::iterator point_idxs_end,
+                       std::vector<PoissonTile>* tiles) {
+  Eigen::AlignedBox3f point_box;
+  for (auto it = point_idxs_begin; it != point_idxs_end; ++it) {
+    point_box.extend(PlyPointToEigen(points[*it]));
+  }
+
+  const size_t num_points = point_idxs_end - point_idxs_begin;
+  if (num_points <= max_num_points) {
+    PoissonTile tile;
+    tile.box = box;
+    tile.point_box = point_box;
+    tiles->push_back(tile);
+    return;
+  }
+
+  int axis;
+  point_box.sizes().maxCoeff(&axis);
+
+  const auto point_idxs_median = point_idxs_begin + num_points / 2;
+  std::nth_element(point_idxs_begin, point_idxs_median, point_idxs_end,
+                   [&](const size_t idx1, const size_t idx2) {
+                     return PlyPointToEigen(points[idx1])(axis) <
+                            PlyPointToEigen(points[idx2])(axis);
+                   });
+  const float split = PlyPointToEigen(points[*point_idxs_median])(axis);
+
+  Eigen::AlignedBox3f lower_box = box;
+  lower_box.max()(axis) = split;
+  Eigen::AlignedBox3f upper_box = box;
+  upper_box.min()(axis) = split;
+
+  SplitPoissonTiles(points, max_num_points, lower_box, point_idxs_begin,
+                    point_idxs_median, tiles);
+  SplitPoissonTiles(points, max_num_points, upper_box, point_idxs_median,
+                    point_idxs_end, tiles);
+}
+
+bool RunTiledPoissonRecon(const PoissonMeshingOptions& options,
+                          const std::string& input_path,
+                          const std::string& output_path) {
+  const std::vector<PlyPoint> points = ReadPly(input_path);
+
+  std::vector<size_t> point_idxs(points.size());
+  std::iota(point_idxs.begin(), point_idxs.end(), 0);
+
+  const float kInf = std::numeric_limits<float>::infinity();
+  std::vector<PoissonTile> tiles;
+  SplitPoissonTiles(points, options.max_tile_num_points,
+                    Eigen::AlignedBox3f(Eigen::Vector3f::Constant(-kInf),
+                                        Eigen::Vector3f::Constant(kInf)),
+                    point_idxs.begin(), point_idxs.end(), &tiles);
+
+  // The Poisson reconstruction uses global state and therefore cannot run
+  // concurrently. Instead, each tile is parallelized internally.
+  typedef PlyColorVertex<float> Vertex;
+  std::vector<Vertex> merged_vertices;
+  std::vector<std::vector<int>> merged_polygons;
+
+  for (size_t tile_idx = 0; tile_idx < tiles.size(); ++tile_idx) {
+    const auto& tile = tiles[tile_idx];
+
+    std::cout << StringPrintf("Reconstructing tile [%d/%d]", tile_idx + 1,
+                              tiles.size())
+              << std::endl;
+
+    const Eigen::Vector3f overlap =
+        options.tile_overlap * tile.point_box.sizes();
+    const Eigen::AlignedBox3f overlap_box(tile.point_box.min() - overlap,
+                                          tile.point_box.max() + overlap);
+
+    std::vector<PlyPoint> tile_points;
+    for (const auto& point : points) {
+      if (overlap_box.contains(PlyPointToEigen(point))) {
+        tile_points.push_back(point);
+      }
+    }
+
+    const std::string tile_points_path =
+        StringPrintf("%s.tile%d-points.ply", output_path.c_str(),
+                     static_cast<int>(tile_idx));
+    const std::string tile_mesh_path =
+        StringPrintf("%s.tile%d-mesh.ply", output_path.c_str(),
+                     static_cast<int>(tile_idx));
+
+    WriteBinaryPlyPoints(tile_points_path, tile_points);
+    tile_points.clear();
+
+    const bool success =
+        RunPoissonRecon(options, tile_points_path, tile_mesh_path);
+    boost::filesystem::remove(tile_points_path);
+    if (!success) {
+      boost::filesystem::remove(tile_mesh_path);
+      return false;
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<std::vector<int>> polygons;
+    int file_type;
+    const bool read_success = PlyReadPolygons(
+        const_cast<char*>(tile_mesh_path.c_str()), vertices, polygons,
+        Vertex::ReadProperties, Vertex::ReadComponents, file_type);
+    boost::filesystem::remove(tile_mesh_path);
+    if (!read_success) {
+      return false;
+    }
+
+    // Only keep the faces whose centroid lies inside the tile, such that the
+    // overlapping regions of neighboring tiles are not duplicated. Note that
+    // the tile boxes are half-open to assign faces on the boundary once.
+    std::vector<int> merged_vertex_idxs(vertices.size(), -1);
+    for (const auto& polygon : polygons) {
+      if (polygon.empty()) {
+        continue;
+      }
+
+      Eigen::Vector3f centroid = Eigen::Vector3f::Zero();
+      for (const int vertex_idx : polygon) {
+        const auto& point = vertices.at(vertex_idx).point;
+        centroid += Eigen::Vector3f(point[0], point[1], point[2]);
+      }
+      centroid /= polygon.size();
+
+      if ((centroid.array() < tile.box.min().array()).any() ||
+          (centroid.array() >= tile.box.max().array()).any()) {
+        continue;
+      }
+
+      std::vector<int> merged_polygon(polygon.size());
+      for (size_t i = 0; i < polygon.size(); ++i) {
+        int& merged_vertex_idx = merged_vertex_idxs[polygon[i]];
+        if (merged_vertex_idx == -1) {
+          merged_vertex_idx = static_cast<int>(merged_vertices.size());
+          merged_vertices.push_back(vertices[polygon[i]]);
+        }
+        merged_polygon[i] = merged_vertex_idx;
+      }
+      merged_polygons.push_back(merged_polygon);
+    }
+  }
+
+  // The first three properties are the vertex coordinates.
+  const int num_properties = options.color > 0 ? Vertex::WriteComponents : 3;
+  return PlyWritePolygons(const_cast<char*>(output_path.c_str()),
+                          merged_vertices, merged_polygons,
+                          Vertex::WriteProperties, num_properties,
+                          PLY_BINARY_NATIVE) != 0;
+}
+
+// Read the geometry of a Poisson mesh and triangulate its polygons.
+bool ReadPoissonMesh(const std::string& path, PlyMesh* mesh) {
+  typedef PlyColorVertex<float> Vertex;
+  std::vector<Vertex> vertices;
+  std::vector<std::vector<int>> polygons;
+  int file_type;
+  if (!PlyReadPolygons(const_cast<char*>(path.c_str()), vertices, polygons,
+                       Vertex::ReadProperties, Vertex::ReadComponents,
+                       file_type)) {
+    return false;
+  }
+
+  mesh->vertices.reserve(vertices.size());
+  for (const auto& vertex : vertices) {
+    mesh->vertices.emplace_back(vertex.point[0], vertex.point[1],
+                                vertex.point[2]);
+  }
+
+  mesh->faces.reserve(polygons.size());
+  for (const auto& polygon : polygons) {
+    for (size_t i = 2; i < polygon.size(); ++i) {
+      mesh->faces.emplace_back(polygon[0], polygon[i - 1], polygon[i]);
+    }
+  }
+
+  return true;
+}
+
+}  // namespace
+
+bool PoissonMeshing(const PoissonMeshingOptions& options,
+                    const std::string& input_path,
+                    const std::string& output_path,
+                    const MeshSimplificationOptions& simplification_options) {
+  CHECK(options.Check());
+  CHECK(simplification_options.Check());
+
+  bool success;
+  if (options.max_tile_num_points > 0) {
+    success = RunTiledPoissonRecon(options, input_path, output_path);
+  } else {
+    success = RunPoissonRecon(options, input_path, output_path);
+  }
+
+  if (!success || simplification_options.num_levels == 0) {
+    return success;
+  }
+
+  PlyMesh mesh;
+  if (!ReadPoissonMesh(output_path, &mesh)) {
+    return false;
+  }
+
+  std::cout << "Writing levels of detail..." << std::endl;
+  WriteMeshLevelsOfDetail(simplification_options, mesh, output_path);
+
+  return true;
+}
+
 #ifdef CGAL_ENABLED
 
 K::Point_3 EigenToCGAL(const Eigen::Vector3f& point) {
@@ -282,26 +516,30 @@ class DelaunayMeshingInput {
 
     const auto& ply_points = ReadPly(JoinPaths(path, "fused.ply"));
 
-    const std::string vis_path = JoinPaths(path, "fused.ply.vis");
-    std::fstream vis_file(vis_path, std::ios::in | std::ios::binary);
-    CHECK(vis_file.is_open()) << vis_path;
-
-    const size_t vis_num_points = ReadBinaryLittleEndian<uint64_t>(&vis_file);
-    CHECK_EQ(vis_num_points, ply_points.size());
+    // The visibility is read in chunks, as it can be much larger than the
+    // points themselves.
+    PointsVisibilityReader vis_reader(JoinPaths(path, "fused.ply.vis"));
+    CHECK_EQ(vis_reader.NumPoints(), ply_points.size());
 
     points.reserve(ply_points.size());
-    for (const auto& ply_point : ply_points) {
-      const int point_idx = points.size();
-      DelaunayMeshingInput::Point input_point;
-      input_point.position =
-          Eigen::Vector3f(ply_point.x, ply_point.y, ply_point.z);
-      input_point.num_visible_images =
-          ReadBinaryLittleEndian<uint32_t>(&vis_file);
-      for (uint32_t i = 0; i < input_point.num_visible_images; ++i) {
-        const int image_idx = ReadBinaryLittleEndian<uint32_t>(&vis_file);
-        images.at(image_idx).point_idxs.push_back(point_idx);
+    std::vector<uint32_t> num_visible_images;
+    std::vector<uint32_t> visible_image_idxs;
+    while (vis_reader.ReadChunk(&num_visible_images, &visible_image_idxs)) {
+      size_t offset = 0;
+      for (const uint32_t num_visible : num_visible_images) {
+        const int point_idx = points.size();
+        const auto& ply_point = ply_points.at(point_idx);
+        DelaunayMeshingInput::Point input_point;
+        input_point.position =
+            Eigen::Vector3f(ply_point.x, ply_point.y, ply_point.z);
+        input_point.num_visible_images = num_visible;
+        for (uint32_t i = 0; i < num_visible; ++i) {
+          const int image_idx = visible_image_idxs[offset + i];
+          images.at(image_idx).point_idxs.push_back(point_idx);
+        }
+        offset += num_visible;
+        points.push_back(input_point);
       }
-      points.push_back(input_point);
     }
   }
 
@@ -330,33 +568,46 @@ class DelaunayMeshingInput {
       }
     }
 
-    std::vector<size_t> point_idxs(points.size());
-    std::iota(point_idxs.begin(), point_idxs.end(), 0);
-    Shuffle(point_idxs.size(), &point_idxs);
+    // Sort the points along a space filling curve, such that consecutive
+    // points are spatially close. The sort is randomized (BRIO), so the
+    // insertion order still avoids degenerate worst cases, while the previous
+    // point's cell is a good hint for locating and inserting the next point.
+    typedef std::pair<K::Point_3, size_t> IndexedPoint;
+    std::vector<IndexedPoint> sorted_points(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+      sorted_points[i] = IndexedPoint(EigenToCGAL(points[i].position), i);
+    }
+    CGAL::spatial_sort(
+        sorted_points.begin(), sorted_points.end(),
+        CGAL::Spatial_sort_traits_adapter_3<
+            K, CGAL::First_of_pair_property_map<IndexedPoint>>());
 
     Delaunay triangulation;
+    Delaunay::Cell_handle hint_cell;
 
     const float max_squared_proj_dist = max_proj_dist * max_proj_dist;
     const float min_depth_ratio = 1.0f - max_depth_dist;
     const float max_depth_ratio = 1.0f + max_depth_dist;
 
-    for (const auto point_idx : point_idxs) {
+    for (const auto& sorted_point : sorted_points) {
+      const K::Point_3& point_position = sorted_point.first;
+      const size_t point_idx = sorted_point.second;
       const auto& point = points[point_idx];
       const auto& visible_image_idxs = points_visible_image_idxs[point_idx];
 
-      const K::Point_3 point_position = EigenToCGAL(point.position);
-
       // Insert point into triangulation until there is one cell.
       if (triangulation.number_of_vertices() < 4) {
-        triangulation.insert(point_position);
+        hint_cell = triangulation.insert(point_position)->cell();
         continue;
       }
 
-      const Delaunay::Cell_handle cell = triangulation.locate(point_position);
+      const Delaunay::Cell_handle cell =
+          triangulation.locate(point_position, hint_cell);
+      hint_cell = cell;
 
       // If the point is outside the current hull, then extend the hull.
       if (triangulation.is_infinite(cell)) {
-        triangulation.insert(point_position);
+        hint_cell = triangulation.insert(point_position, cell)->cell();
         continue;
       }
 
@@ -412,7 +663,7 @@ class DelaunayMeshingInput {
       }
 
       if (insert_point) {
-        triangulation.insert(point_position);
+        hint_cell = triangulation.insert(point_position, cell)->cell();
       }
     }
 
@@ -821,7 +1072,7 @@ PlyMesh DelaunayMeshing(const DelaunayMeshingOptions& options,
       }
     }
 
-    CHECK(result_queue.Push(image_cell_graph_data));
+    CHECK(result_queue.Push(std::move(image_cell_graph_data)));
   };
 
   // Add first batch of images to the thread job queue.
@@ -916,7 +1167,11 @@ PlyMesh DelaunayMeshing(const DelaunayMeshingOptions& options,
   // Extract the surface facets as the oriented min-cut of the graph.
 
   std::cout << "Running graph-cut optimization..." << std::endl;
-  graph_cut.Compute();
+  if (options.parallel_graph_cut) {
+    graph_cut.ComputeParallel(options.num_threads);
+  } else {
+    graph_cut.Compute();
+  }
 
   std::cout << "Extracting surface as min-cut..." << std::endl;
 
@@ -1005,9 +1260,10 @@ PlyMesh DelaunayMeshing(const DelaunayMeshingOptions& options,
   return mesh;
 }
 
-void SparseDelaunayMeshing(const DelaunayMeshingOptions& options,
-                           const std::string& input_path,
-                           const std::string& output_path) {
+void SparseDelaunayMeshing(
+    const DelaunayMeshingOptions& options, const std::string& input_path,
+    const std::string& output_path,
+    const MeshSimplificationOptions& simplification_options) {
   Timer timer;
   timer.Start();
 
@@ -1019,12 +1275,18 @@ void SparseDelaunayMeshing(const DelaunayMeshingOptions& options,
   std::cout << "Writing surface mesh..." << std::endl;
   WriteBinaryPlyMesh(output_path, mesh);
 
+  if (simplification_options.num_levels > 0) {
+    std::cout << "Writing levels of detail..." << std::endl;
+    WriteMeshLevelsOfDetail(simplification_options, mesh, output_path);
+  }
+
   timer.PrintSeconds();
 }
 
-void DenseDelaunayMeshing(const DelaunayMeshingOptions& options,
-                          const std::string& input_path,
-                          const std::string& output_path) {
+void DenseDelaunayMeshing(
+    const DelaunayMeshingOptions& options, const std::string& input_path,
+    const std::string& output_path,
+    const MeshSimplificationOptions& simplification_options) {
   Timer timer;
   timer.Start();
 
@@ -1036,6 +1298,11 @@ void DenseDelaunayMeshing(const DelaunayMeshingOptions& options,
   std::cout << "Writing surface mesh..." << std::endl;
   WriteBinaryPlyMesh(output_path, mesh);
 
+  if (simplification_options.num_levels > 0) {
+    std::cout << "Writing levels of detail..." << std::endl;
+    WriteMeshLevelsOfDetail(simplification_options, mesh, output_path);
+  }
+
   timer.PrintSeconds();
 }
 
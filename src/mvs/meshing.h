@@ -34,6 +34,8 @@
 
 #include <string>
 
+#include "mvs/mesh_simplification.h"
+
 namespace colmap {
 namespace mvs {
 
@@ -64,6 +66,17 @@ struct PoissonMeshingOptions {
   // The number of threads used for the Poisson reconstruction.
   int num_threads = -1;
 
+  // If positive, the point cloud is recursively split into spatial tiles with
+  // at most this many points. The tiles are reconstructed one after another
+  // and their meshes are merged, which bounds the memory usage of the octree
+  // for large scenes.
+  int max_tile_num_points = 0;
+
+  // The overlap of neighboring tiles relative to the extent of a tile. Each
+  // tile is reconstructed with the points in its enlarged region but only the
+  // mesh faces inside the tile are kept, which hides the boundary artifacts.
+  double tile_overlap = 0.1;
+
   bool Check() const;
 };
 
@@ -96,16 +109,25 @@ struct DelaunayMeshingOptions {
   double max_side_length_factor = 25.0;
   double max_side_length_percentile = 95.0;
 
+  // Whether to compute the graph-cut with multiple threads by solving blocks
+  // of cells in parallel and hierarchically merging them. This yields the
+  // same min-cut but temporarily needs about twice the memory of the graph.
+  bool parallel_graph_cut = false;
+
   // The number of threads to use for reconstruction. Default is all threads.
   int num_threads = -1;
 
   bool Check() const;
 };
 
-// Perform Poisson surface reconstruction and return true if successful.
+// Perform Poisson surface reconstruction and return true if successful. The
+// simplification options optionally add decimated levels of detail next to
+// the output mesh, see `WriteMeshLevelsOfDetail`.
 bool PoissonMeshing(const PoissonMeshingOptions& options,
                     const std::string& input_path,
-                    const std::string& output_path);
+                    const std::string& output_path,
+                    const MeshSimplificationOptions& simplification_options =
+                        MeshSimplificationOptions());
 
 
 #ifdef CGAL_ENABLED
@@ -119,13 +141,18 @@ bool PoissonMeshing(const PoissonMeshingOptions& options,
 // In case of sparse input, the path should point to a sparse COLMAP
 // reconstruction. In case of dense input, the path should point to a dense
 // COLMAP workspace folder, which has been fully processed by the stereo and
-// fusion pipeline.
-void SparseDelaunayMeshing(const DelaunayMeshingOptions& options,
-                           const std::string& input_path,
-                           const std::string& output_path);
-void DenseDelaunayMeshing(const DelaunayMeshingOptions& options,
-                           const std::string& input_path,
-                           const std::string& output_path);
+// fusion pipeline. The simplification options optionally add decimated
+// levels of detail next to the output mesh.
+void SparseDelaunayMeshing(
+    const DelaunayMeshingOptions& options, const std::string& input_path,
+    const std::string& output_path,
+    const MeshSimplificationOptions& simplification_options =
+        MeshSimplificationOptions());
+void DenseDelaunayMeshing(
+    const DelaunayMeshingOptions& options, const std::string& input_path,
+    const std::string& output_path,
+    const MeshSimplificationOptions& simplification_options =
+        MeshSimplificationOptions());
 
 #endif  // CGAL_ENABLED
 
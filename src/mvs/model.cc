@@ -37,9 +37,26 @@
 #include "base/reconstruction.h"
 #include "base/triangulation.h"
 #include "util/misc.h"
+#include "util/threading.h"
 
 namespace colmap {
 namespace mvs {
+namespace {
+
+// Compute the indices of the points observed by each image. An image is
+// listed once per observation of the same point.
+std::vector<std::vector<int>> ComputeImagePointIdxs(
+    const size_t num_images, const std::vector<Model::Point>& points) {
+  std::vector<std::vector<int>> image_point_idxs(num_images);
+  for (size_t point_idx = 0; point_idx < points.size(); ++point_idx) {
+    for (const int image_idx : points[point_idx].track) {
+      image_point_idxs.at(image_idx).push_back(point_idx);
+    }
+  }
+  return image_point_idxs;
+}
+
+}  // namespace
 
 void Model::Read(const std::string& path, const std::string& format) {
   auto format_lower_case = format;
@@ -215,20 +232,214 @@ std::vector<std::pair<float, float>> Model::ComputeDepthRanges() const {
   return depth_ranges;
 }
 
+bool Model::ComputeDepthPrior(const int image_idx, DepthMap* depth_map,
+                              NormalMap* normal_map) const {
+  CHECK_NOTNULL(depth_map);
+  CHECK_NOTNULL(normal_map);
+
+  const auto& image = images.at(image_idx);
+  const int width = static_cast<int>(image.GetWidth());
+  const int height = static_cast<int>(image.GetHeight());
+  const float* K = image.GetK();
+  const Eigen::Map<const Eigen::Matrix<float, 3, 3, Eigen::RowMajor>> R(
+      image.GetR());
+  const Eigen::Map<const Eigen::Vector3f> T(image.GetT());
+
+  // Project the sparse points observed in the image.
+  std::vector<Eigen::Vector3f> projections;
+  for (const auto& point : points) {
+    if (std::find(point.track.begin(), point.track.end(), image_idx) ==
+        point.track.end()) {
+      continue;
+    }
+    const Eigen::Vector3f X =
+        R * Eigen::Vector3f(point.x, point.y, point.z) + T;
+    if (X.z() <= 0) {
+      continue;
+    }
+    const float col = K[0] * X.x() / X.z() + K[2];
+    const float row = K[4] * X.y() / X.z() + K[5];
+    if (col >= 0 && row >= 0 && col < width && row < height) {
+      projections.emplace_back(col, row, X.z());
+    }
+  }
+
+  const size_t kMinNumPoints = 10;
+  if (projections.size() < kMinNumPoints) {
+    return false;
+  }
+
+  // Choose the grid cells such that every cell contains a few points for
+  // uniformly distributed projections.
+  const float kNumPointsPerCell = 4.0f;
+  const float kMinCellSize = 8.0f;
+  const float cell_size = std::max(
+      kMinCellSize,
+      std::sqrt(kNumPointsPerCell * width * height / projections.size()));
+  const int grid_width = std::max(1, static_cast<int>(width / cell_size));
+  const int grid_height = std::max(1, static_cast<int>(height / cell_size));
+  const float cell_width = static_cast<float>(width) / grid_width;
+  const float cell_height = static_cast<float>(height) / grid_height;
+
+  // The depth of a cell is the median depth of its points.
+  std::vector<std::vector<float>> cell_depths(grid_width * grid_height);
+  for (const auto& projection : projections) {
+    const int grid_col = std::min(
+        grid_width - 1, static_cast<int>(projection.x() / cell_width));
+    const int grid_row = std::min(
+        grid_height - 1, static_cast<int>(projection.y() / cell_height));
+    cell_depths[grid_row * grid_width + grid_col].push_back(projection.z());
+  }
+
+  std::vector<float> grid(grid_width * grid_height, 0.0f);
+  for (size_t i = 0; i < cell_depths.size(); ++i) {
+    auto& depths = cell_depths[i];
+    if (!depths.empty()) {
+      std::nth_element(depths.begin(), depths.begin() + depths.size() / 2,
+                       depths.end());
+      grid[i] = depths[depths.size() / 2];
+    }
+  }
+
+  // Fill the empty cells with the average depth of their filled neighbors,
+  // until all cells are filled.
+  bool has_empty_cells = true;
+  while (has_empty_cells) {
+    has_empty_cells = false;
+    std::vector<float> filled_grid = grid;
+    for (int r = 0; r < grid_height; ++r) {
+      for (int c = 0; c < grid_width; ++c) {
+        if (grid[r * grid_width + c] > 0) {
+          continue;
+        }
+        float depth_sum = 0.0f;
+        int num_depths = 0;
+        for (int dr = -1; dr <= 1; ++dr) {
+          for (int dc = -1; dc <= 1; ++dc) {
+            const int nr = r + dr;
+            const int nc = c + dc;
+            if (nr >= 0 && nc >= 0 && nr < grid_height && nc < grid_width &&
+                grid[nr * grid_width + nc] > 0) {
+              depth_sum += grid[nr * grid_width + nc];
+              num_depths += 1;
+            }
+          }
+        }
+        if (num_depths > 0) {
+          filled_grid[r * grid_width + c] = depth_sum / num_depths;
+        } else {
+          has_empty_cells = true;
+        }
+      }
+    }
+    grid.swap(filled_grid);
+  }
+
+  // Bilinearly interpolate the depths between the cell centers.
+  const auto grid_depth_range = std::minmax_element(grid.begin(), grid.end());
+  *depth_map = DepthMap(width, height, *grid_depth_range.first,
+                        *grid_depth_range.second);
+  for (int r = 0; r < height; ++r) {
+    const float grid_r = std::max(
+        0.0f, std::min(grid_height - 1.0f, (r + 0.5f) / cell_height - 0.5f));
+    const int r0 = static_cast<int>(grid_r);
+    const int r1 = std::min(grid_height - 1, r0 + 1);
+    const float wr = grid_r - r0;
+    for (int c = 0; c < width; ++c) {
+      const float grid_c = std::max(
+          0.0f, std::min(grid_width - 1.0f, (c + 0.5f) / cell_width - 0.5f));
+      const int c0 = static_cast<int>(grid_c);
+      const int c1 = std::min(grid_width - 1, c0 + 1);
+      const float wc = grid_c - c0;
+      const float depth0 = (1 - wc) * grid[r0 * grid_width + c0] +
+                           wc * grid[r0 * grid_width + c1];
+      const float depth1 = (1 - wc) * grid[r1 * grid_width + c0] +
+                           wc * grid[r1 * grid_width + c1];
+      depth_map->Set(r, c, (1 - wr) * depth0 + wr * depth1);
+    }
+  }
+
+  // Derive the normals from the interpolated depths by central differences
+  // of the back-projected points and orient them towards the camera.
+  const auto BackProject = [&](const int r, const int c) {
+    const float depth = depth_map->Get(r, c);
+    return Eigen::Vector3f(depth * (c - K[2]) / K[0],
+                           depth * (r - K[5]) / K[4], depth);
+  };
+
+  *normal_map = NormalMap(width, height);
+  for (int r = 0; r < height; ++r) {
+    const int r0 = std::max(0, r - 1);
+    const int r1 = std::min(height - 1, r + 1);
+    for (int c = 0; c < width; ++c) {
+      const int c0 = std::max(0, c - 1);
+      const int c1 = std::min(width - 1, c + 1);
+      Eigen::Vector3f normal = (BackProject(r, c1) - BackProject(r, c0))
+                                   .cross(BackProject(r1, c) -
+                                          BackProject(r0, c));
+      const float norm = normal.norm();
+      if (norm > 0) {
+        normal /= norm;
+      } else {
+        normal = Eigen::Vector3f(0, 0, -1);
+      }
+      const Eigen::Vector3f view_ray((c - K[2]) / K[0], (r - K[5]) / K[4], 1);
+      if (normal.dot(view_ray) > 0) {
+        normal = -normal;
+      }
+      for (int d = 0; d < 3; ++d) {
+        normal_map->Set(r, c, d, normal(d));
+      }
+    }
+  }
+
+  return true;
+}
+
 std::vector<std::map<int, int>> Model::ComputeSharedPoints() const {
+  const auto image_point_idxs = ComputeImagePointIdxs(images.size(), points);
+
+  // Each image accumulates the number of shared points with all other images
+  // independently in a dense per-thread counter, which avoids the overhead of
+  // updating the sparse maps for every pair of observations.
+  ThreadPool thread_pool;
+  std::vector<std::vector<int>> thread_num_shared_points(
+      thread_pool.NumThreads(), std::vector<int>(images.size(), 0));
+
   std::vector<std::map<int, int>> shared_points(images.size());
-  for (const auto& point : points) {
-    for (size_t i = 0; i < point.track.size(); ++i) {
-      const int image_idx1 = point.track[i];
-      for (size_t j = 0; j < i; ++j) {
-        const int image_idx2 = point.track[j];
-        if (image_idx1 != image_idx2) {
-          shared_points.at(image_idx1)[image_idx2] += 1;
-          shared_points.at(image_idx2)[image_idx1] += 1;
+
+  auto ComputeImageSharedPoints = [&](const int image_idx) {
+    auto& num_shared_points =
+        thread_num_shared_points[thread_pool.GetThreadIndex()];
+
+    std::vector<int> overlapping_image_idxs;
+    for (const int point_idx : image_point_idxs[image_idx]) {
+      for (const int other_image_idx : points[point_idx].track) {
+        if (other_image_idx != image_idx) {
+          if (num_shared_points[other_image_idx] == 0) {
+            overlapping_image_idxs.push_back(other_image_idx);
+          }
+          num_shared_points[other_image_idx] += 1;
         }
       }
     }
+
+    std::sort(overlapping_image_idxs.begin(), overlapping_image_idxs.end());
+
+    auto& image_shared_points = shared_points[image_idx];
+    for (const int other_image_idx : overlapping_image_idxs) {
+      image_shared_points.emplace_hint(image_shared_points.end(),
+                                       other_image_idx,
+                                       num_shared_points[other_image_idx]);
+      num_shared_points[other_image_idx] = 0;
+    }
+  };
+
+  for (size_t image_idx = 0; image_idx < images.size(); ++image_idx) {
+    thread_pool.AddTask(ComputeImageSharedPoints, image_idx);
   }
+  thread_pool.Wait();
+
   return shared_points;
 }
 
@@ -242,33 +453,53 @@ std::vector<std::map<int, float>> Model::ComputeTriangulationAngles(
     proj_centers[image_idx] = C.cast<double>();
   }
 
-  std::vector<std::map<int, std::vector<float>>> all_triangulation_angles(
-      images.size());
-  for (const auto& point : points) {
-    for (size_t i = 0; i < point.track.size(); ++i) {
-      const int image_idx1 = point.track[i];
-      for (size_t j = 0; j < i; ++j) {
-        const int image_idx2 = point.track[j];
-        if (image_idx1 != image_idx2) {
-          const float angle = CalculateTriangulationAngle(
-              proj_centers.at(image_idx1), proj_centers.at(image_idx2),
-              Eigen::Vector3d(point.x, point.y, point.z));
-          all_triangulation_angles.at(image_idx1)[image_idx2].push_back(angle);
-          all_triangulation_angles.at(image_idx2)[image_idx1].push_back(angle);
+  const auto image_point_idxs = ComputeImagePointIdxs(images.size(), points);
+
+  // Each image collects the triangulation angles with all other images
+  // independently in per-thread buffers, whose memory is reused across images.
+  ThreadPool thread_pool;
+  std::vector<std::vector<std::vector<float>>> thread_triangulation_angles(
+      thread_pool.NumThreads(), std::vector<std::vector<float>>(images.size()));
+
+  std::vector<std::map<int, float>> triangulation_angles(images.size());
+
+  auto ComputeImageTriangulationAngles = [&](const int image_idx) {
+    auto& all_triangulation_angles =
+        thread_triangulation_angles[thread_pool.GetThreadIndex()];
+
+    std::vector<int> overlapping_image_idxs;
+    for (const int point_idx : image_point_idxs[image_idx]) {
+      const auto& point = points[point_idx];
+      const Eigen::Vector3d point_position(point.x, point.y, point.z);
+      for (const int other_image_idx : point.track) {
+        if (other_image_idx != image_idx) {
+          auto& angles = all_triangulation_angles[other_image_idx];
+          if (angles.empty()) {
+            overlapping_image_idxs.push_back(other_image_idx);
+          }
+          angles.push_back(CalculateTriangulationAngle(
+              proj_centers[image_idx], proj_centers[other_image_idx],
+              point_position));
         }
       }
     }
-  }
 
-  std::vector<std::map<int, float>> triangulation_angles(images.size());
-  for (size_t image_idx = 0; image_idx < all_triangulation_angles.size();
-       ++image_idx) {
-    const auto& overlapping_images = all_triangulation_angles[image_idx];
-    for (const auto& image : overlapping_images) {
-      triangulation_angles[image_idx].emplace(
-          image.first, Percentile(image.second, percentile));
+    std::sort(overlapping_image_idxs.begin(), overlapping_image_idxs.end());
+
+    auto& image_triangulation_angles = triangulation_angles[image_idx];
+    for (const int other_image_idx : overlapping_image_idxs) {
+      auto& angles = all_triangulation_angles[other_image_idx];
+      image_triangulation_angles.emplace_hint(
+          image_triangulation_angles.end(), other_image_idx,
+          Percentile(angles, percentile));
+      angles.clear();
     }
+  };
+
+  for (size_t image_idx = 0; image_idx < images.size(); ++image_idx) {
+    thread_pool.AddTask(ComputeImageTriangulationAngles, image_idx);
   }
+  thread_pool.Wait();
 
   return triangulation_angles;
 }
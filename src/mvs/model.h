@@ -77,6 +77,13 @@ struct Model {
   // Compute the robust minimum and maximum depths from the sparse point cloud.
   std::vector<std::pair<float, float>> ComputeDepthRanges() const;
 
+  // Compute a dense depth and normal prior for an image by projecting the
+  // sparse points into the image and interpolating their depths piecewise
+  // bilinearly on a coarse grid. The normals are derived from the interpolated
+  // depths. Returns false, if the image observes too few sparse points.
+  bool ComputeDepthPrior(const int image_idx, DepthMap* depth_map,
+                         NormalMap* normal_map) const;
+
   // Compute the number of shared points between all overlapping images.
   std::vector<std::map<int, int>> ComputeSharedPoints() const;
 
@@ -47,6 +47,16 @@ NormalMap::NormalMap(const Mat<float>& mat)
   data_ = mat.GetData();
 }
 
+void NormalMap::Read(const std::string& path) {
+  if (ReadMatFormatTag(path) == CompactNormalMap::kFormatTag) {
+    CompactNormalMap compact_normal_map;
+    compact_normal_map.Read(path);
+    *this = compact_normal_map.ToNormalMap();
+  } else {
+    Mat<float>::Read(path);
+  }
+}
+
 void NormalMap::Rescale(const float factor) {
   if (width_ * height_ == 0) {
     return;
@@ -120,5 +130,52 @@ Bitmap NormalMap::ToBitmap() const {
   return bitmap;
 }
 
+const std::string CompactNormalMap::kFormatTag = "oct16";
+
+CompactNormalMap::CompactNormalMap() : Mat<int16_t>(0, 0, 2) {}
+
+CompactNormalMap::CompactNormalMap(const NormalMap& normal_map)
+    : Mat<int16_t>(normal_map.GetWidth(), normal_map.GetHeight(), 2) {
+  for (size_t r = 0; r < height_; ++r) {
+    for (size_t c = 0; c < width_; ++c) {
+      float normal[3];
+      normal_map.GetSlice(r, c, normal);
+      int16_t encoded[2];
+      EncodeOctahedralNormal(normal, encoded);
+      Set(r, c, 0, encoded[0]);
+      Set(r, c, 1, encoded[1]);
+    }
+  }
+}
+
+NormalMap CompactNormalMap::ToNormalMap() const {
+  NormalMap normal_map(width_, height_);
+  for (size_t r = 0; r < height_; ++r) {
+    for (size_t c = 0; c < width_; ++c) {
+      float normal[3];
+      GetSlice(r, c, normal);
+      normal_map.Set(r, c, 0, normal[0]);
+      normal_map.Set(r, c, 1, normal[1]);
+      normal_map.Set(r, c, 2, normal[2]);
+    }
+  }
+  return normal_map;
+}
+
+void CompactNormalMap::Read(const std::string& path) {
+  if (ReadMatFormatTag(path) == kFormatTag) {
+    ReadWithFormatTag(path, kFormatTag);
+    CHECK_EQ(depth_, 2) << path;
+  } else {
+    NormalMap normal_map;
+    normal_map.Read(path);
+    *this = CompactNormalMap(normal_map);
+  }
+}
+
+void CompactNormalMap::Write(const std::string& path) const {
+  WriteWithFormatTag(path, kFormatTag);
+}
+
 }  // namespace mvs
 }  // namespace colmap
@@ -32,7 +32,10 @@
 #define TEST_NAME "mvs/normal_map_test"
 #include "util/testing.h"
 
+#include <boost/filesystem.hpp>
+
 #include "mvs/normal_map.h"
+#include "util/math.h"
 
 using namespace colmap;
 using namespace colmap::mvs;
@@ -95,3 +98,80 @@ BOOST_AUTO_TEST_CASE(TestToBitmap) {
   BOOST_CHECK(bitmap.GetPixel(1, 1, &color));
   BOOST_CHECK_EQUAL(color, BitmapColor<uint8_t>(37, 37, 0));
 }
+
+BOOST_AUTO_TEST_CASE(TestOctahedralNormal) {
+  const float kMaxAngleError = DegToRad(0.01f);
+  for (float theta = 0; theta <= M_PI; theta += 0.05f) {
+    for (float phi = -M_PI; phi <= M_PI; phi += 0.05f) {
+      const float normal[3] = {std::sin(theta) * std::cos(phi),
+                               std::sin(theta) * std::sin(phi),
+                               std::cos(theta)};
+      int16_t encoded[2];
+      EncodeOctahedralNormal(normal, encoded);
+      float decoded[3];
+      DecodeOctahedralNormal(encoded, decoded);
+      BOOST_CHECK_CLOSE(decoded[0] * decoded[0] + decoded[1] * decoded[1] +
+                            decoded[2] * decoded[2],
+                        1, 1e-4);
+      const float cos_angle = normal[0] * decoded[0] +
+                              normal[1] * decoded[1] + normal[2] * decoded[2];
+      BOOST_CHECK_GE(cos_angle, std::cos(kMaxAngleError));
+    }
+  }
+
+  const float zero_normal[3] = {0, 0, 0};
+  int16_t encoded[2];
+  EncodeOctahedralNormal(zero_normal, encoded);
+  float decoded[3];
+  DecodeOctahedralNormal(encoded, decoded);
+  BOOST_CHECK_EQUAL(decoded[0], 0);
+  BOOST_CHECK_EQUAL(decoded[1], 0);
+  BOOST_CHECK_EQUAL(decoded[2], 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestCompactNormalMap) {
+  NormalMap normal_map(2, 1);
+  normal_map.Set(0, 0, 0, 0);
+  normal_map.Set(0, 0, 1, 0.6);
+  normal_map.Set(0, 0, 2, -0.8);
+  const CompactNormalMap compact_normal_map(normal_map);
+  BOOST_CHECK_EQUAL(compact_normal_map.GetWidth(), 2);
+  BOOST_CHECK_EQUAL(compact_normal_map.GetHeight(), 1);
+  BOOST_CHECK_EQUAL(compact_normal_map.GetDepth(), 2);
+  BOOST_CHECK_EQUAL(compact_normal_map.GetNumBytes(),
+                    normal_map.GetNumBytes() / 3);
+
+  float normal[3];
+  compact_normal_map.GetSlice(0, 0, normal);
+  BOOST_CHECK_SMALL(normal[0], 1e-4f);
+  BOOST_CHECK_CLOSE(normal[1], 0.6f, 1e-2);
+  BOOST_CHECK_CLOSE(normal[2], -0.8f, 1e-2);
+  compact_normal_map.GetSlice(0, 1, normal);
+  BOOST_CHECK_EQUAL(normal[0], 0);
+  BOOST_CHECK_EQUAL(normal[1], 0);
+  BOOST_CHECK_EQUAL(normal[2], 0);
+
+  const std::string path = (boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path())
+                               .string();
+
+  compact_normal_map.Write(path);
+  BOOST_CHECK_EQUAL(ReadMatFormatTag(path), CompactNormalMap::kFormatTag);
+  NormalMap read_normal_map;
+  read_normal_map.Read(path);
+  BOOST_CHECK_EQUAL(read_normal_map.GetWidth(), 2);
+  BOOST_CHECK_EQUAL(read_normal_map.GetHeight(), 1);
+  BOOST_CHECK_EQUAL(read_normal_map.GetDepth(), 3);
+  compact_normal_map.GetSlice(0, 0, normal);
+  BOOST_CHECK_EQUAL(read_normal_map.Get(0, 0, 1), normal[1]);
+  BOOST_CHECK_EQUAL(read_normal_map.Get(0, 0, 2), normal[2]);
+
+  normal_map.Write(path);
+  CompactNormalMap read_compact_normal_map;
+  read_compact_normal_map.Read(path);
+  BOOST_CHECK_EQUAL(read_compact_normal_map.GetWidth(), 2);
+  read_compact_normal_map.GetSlice(0, 0, normal);
+  BOOST_CHECK_CLOSE(normal[1], 0.6f, 1e-2);
+
+  boost::filesystem::remove(path);
+}
@@ -31,19 +31,266 @@
 
 #include "mvs/patch_match.h"
 
-#include <numeric>
+#include <algorithm>
 #include <unordered_set>
 
 #include "mvs/consistency_graph.h"
 #include "mvs/patch_match_cuda.h"
 #include "mvs/workspace.h"
+#include "util/cuda.h"
+#include "util/gpu_scheduler.h"
 #include "util/math.h"
+#include "util/metrics.h"
 #include "util/misc.h"
+#include "util/profiling.h"
 
 #define PrintOption(option) std::cout << #option ": " << option << std::endl
 
 namespace colmap {
 namespace mvs {
+namespace {
+
+// Minimum size of the smaller image dimension at the coarsest pyramid level.
+const size_t kMinPyramidImageSize = 100;
+
+// Resize the depth map using nearest neighbor interpolation, such that the
+// depths are not blended across depth discontinuities.
+DepthMap ResizeDepthMap(const DepthMap& depth_map, const size_t width,
+                          const size_t height) {
+  DepthMap resized_depth_map(width, height, depth_map.GetDepthMin(),
+                               depth_map.GetDepthMax());
+  const float scale_r = static_cast<float>(depth_map.GetHeight()) / height;
+  const float scale_c = static_cast<float>(depth_map.GetWidth()) / width;
+  for (size_t r = 0; r < height; ++r) {
+    const size_t src_r = std::min(static_cast<size_t>((r + 0.5f) * scale_r),
+                                  depth_map.GetHeight() - 1);
+    for (size_t c = 0; c < width; ++c) {
+      const size_t src_c = std::min(static_cast<size_t>((c + 0.5f) * scale_c),
+                                    depth_map.GetWidth() - 1);
+      resized_depth_map.Set(r, c, depth_map.Get(src_r, src_c));
+    }
+  }
+  return resized_depth_map;
+}
+
+// Resize the normal map using nearest neighbor interpolation, such that the
+// normals are consistent with the resized depth map.
+NormalMap ResizeNormalMap(const NormalMap& normal_map, const size_t width,
+                            const size_t height) {
+  NormalMap resized_normal_map(width, height);
+  const float scale_r = static_cast<float>(normal_map.GetHeight()) / height;
+  const float scale_c = static_cast<float>(normal_map.GetWidth()) / width;
+  for (size_t r = 0; r < height; ++r) {
+    const size_t src_r = std::min(static_cast<size_t>((r + 0.5f) * scale_r),
+                                  normal_map.GetHeight() - 1);
+    for (size_t c = 0; c < width; ++c) {
+      const size_t src_c = std::min(static_cast<size_t>((c + 0.5f) * scale_c),
+                                    normal_map.GetWidth() - 1);
+      for (size_t d = 0; d < 3; ++d) {
+        resized_normal_map.Set(r, c, d, normal_map.Get(src_r, src_c, d));
+      }
+    }
+  }
+  return resized_normal_map;
+}
+
+// Maximum relative difference of the depths of overlapping tiles to be
+// blended, such that depths are not blended across depth discontinuities.
+const float kMaxTileBlendDepthDiff = 0.01f;
+
+// A rectangular region of an image.
+struct ImageRegion {
+  size_t x = 0;
+  size_t y = 0;
+  size_t width = 0;
+  size_t height = 0;
+};
+
+DepthMap CropDepthMap(const DepthMap& depth_map, const ImageRegion& region) {
+  DepthMap cropped_depth_map(region.width, region.height,
+                             depth_map.GetDepthMin(), depth_map.GetDepthMax());
+  for (size_t r = 0; r < region.height; ++r) {
+    for (size_t c = 0; c < region.width; ++c) {
+      cropped_depth_map.Set(r, c, depth_map.Get(region.y + r, region.x + c));
+    }
+  }
+  return cropped_depth_map;
+}
+
+NormalMap CropNormalMap(const NormalMap& normal_map,
+                        const ImageRegion& region) {
+  NormalMap cropped_normal_map(region.width, region.height);
+  for (size_t r = 0; r < region.height; ++r) {
+    for (size_t c = 0; c < region.width; ++c) {
+      for (size_t d = 0; d < 3; ++d) {
+        cropped_normal_map.Set(
+            r, c, d, normal_map.Get(region.y + r, region.x + c, d));
+      }
+    }
+  }
+  return cropped_normal_map;
+}
+
+// Compute the offsets of the tiles along one image dimension, where adjacent
+// tiles overlap by at least the given overlap and the last tile is aligned
+// with the end of the dimension.
+std::vector<size_t> ComputeTileOffsets(const size_t size,
+                                       const size_t tile_size,
+                                       const size_t tile_overlap) {
+  if (size <= tile_size) {
+    return {0};
+  }
+  std::vector<size_t> offsets;
+  const size_t step = tile_size - tile_overlap;
+  for (size_t offset = 0; offset + tile_size < size; offset += step) {
+    offsets.push_back(offset);
+  }
+  offsets.push_back(size - tile_size);
+  return offsets;
+}
+
+// The blend weight of a tile along one image dimension, which linearly
+// increases from the tile borders inside the image over the tile overlap.
+float ComputeTileBlendWeight(const size_t coord, const size_t tile_offset,
+                             const size_t tile_size, const size_t size,
+                             const size_t tile_overlap) {
+  const float ramp = std::max<size_t>(tile_overlap, 1);
+  float weight = 1.0f;
+  if (tile_offset > 0) {
+    weight = std::min(weight, (coord - tile_offset + 0.5f) / ramp);
+  }
+  if (tile_offset + tile_size < size) {
+    weight = std::min(weight, (tile_offset + tile_size - coord - 0.5f) / ramp);
+  }
+  return weight;
+}
+
+// Compute for every coordinate along one image dimension the index of the
+// tile with the largest blend weight, which determines the results that are
+// not blended across the tile seams.
+std::vector<size_t> ComputeTileOwners(const std::vector<size_t>& tile_offsets,
+                                      const size_t tile_size,
+                                      const size_t size,
+                                      const size_t tile_overlap) {
+  std::vector<size_t> owners(size, 0);
+  std::vector<float> owner_weights(size, -1.0f);
+  for (size_t i = 0; i < tile_offsets.size(); ++i) {
+    for (size_t coord = tile_offsets[i];
+         coord < tile_offsets[i] + tile_size; ++coord) {
+      const float weight = ComputeTileBlendWeight(
+          coord, tile_offsets[i], tile_size, size, tile_overlap);
+      if (weight > owner_weights[coord]) {
+        owners[coord] = i;
+        owner_weights[coord] = weight;
+      }
+    }
+  }
+  return owners;
+}
+
+// Compute the region of the source image into which the given region of the
+// reference image projects within the depth range, padded by the window
+// radius of the photometric consistency cost. The entire source image is used
+// if the viewing frustum of the region extends behind the source camera.
+ImageRegion ComputeSourceImageRegion(const Image& ref_image,
+                                     const Image& src_image,
+                                     const ImageRegion& ref_region,
+                                     const float depth_min,
+                                     const float depth_max,
+                                     const int padding) {
+  const Eigen::Map<const Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> inv_P(
+      ref_image.GetInvP());
+  const Eigen::Map<const Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> P(
+      src_image.GetP());
+
+  ImageRegion src_region;
+  src_region.width = src_image.GetWidth();
+  src_region.height = src_image.GetHeight();
+
+  float min_x = std::numeric_limits<float>::max();
+  float min_y = std::numeric_limits<float>::max();
+  float max_x = std::numeric_limits<float>::lowest();
+  float max_y = std::numeric_limits<float>::lowest();
+  for (const float x : {ref_region.x, ref_region.x + ref_region.width}) {
+    for (const float y : {ref_region.y, ref_region.y + ref_region.height}) {
+      for (const float depth : {depth_min, depth_max}) {
+        const Eigen::Vector3f xyz =
+            inv_P * Eigen::Vector4f(x * depth, y * depth, depth, 1.0f);
+        const Eigen::Vector3f proj = P * xyz.homogeneous();
+        if (proj.z() <= std::numeric_limits<float>::epsilon()) {
+          return src_region;
+        }
+        min_x = std::min(min_x, proj.x() / proj.z());
+        min_y = std::min(min_y, proj.y() / proj.z());
+        max_x = std::max(max_x, proj.x() / proj.z());
+        max_y = std::max(max_y, proj.y() / proj.z());
+      }
+    }
+  }
+
+  // Clamp the padded bounds to the image and keep at least one window next to
+  // the closest image border, if the region projects outside the image.
+  const float max_col = src_image.GetWidth() - 1.0f;
+  const float max_row = src_image.GetHeight() - 1.0f;
+  const size_t x0 = static_cast<size_t>(
+      Clip<float>(std::floor(min_x) - padding, 0.0f, max_col));
+  const size_t y0 = static_cast<size_t>(
+      Clip<float>(std::floor(min_y) - padding, 0.0f, max_row));
+  const size_t x1 = static_cast<size_t>(
+      Clip<float>(std::ceil(max_x) + padding, 0.0f, max_col));
+  const size_t y1 = static_cast<size_t>(
+      Clip<float>(std::ceil(max_y) + padding, 0.0f, max_row));
+  src_region.x = std::min(x0, x1);
+  src_region.y = std::min(y0, y1);
+  src_region.width = std::max(x0, x1) - src_region.x + 1;
+  src_region.height = std::max(y0, y1) - src_region.y + 1;
+
+  const size_t min_width =
+      std::min<size_t>(2 * padding + 1, src_image.GetWidth());
+  if (src_region.width < min_width) {
+    src_region.x = std::min(src_region.x, src_image.GetWidth() - min_width);
+    src_region.width = min_width;
+  }
+  const size_t min_height =
+      std::min<size_t>(2 * padding + 1, src_image.GetHeight());
+  if (src_region.height < min_height) {
+    src_region.y = std::min(src_region.y, src_image.GetHeight() - min_height);
+    src_region.height = min_height;
+  }
+
+  return src_region;
+}
+
+// Estimate the device memory of a problem from the sizes of its images, which
+// is used to lease the memory from the GPU scheduler. Every image takes one
+// float texture and, with geometric consistency, its depth and normal maps.
+// The reference image additionally takes the depth and selection probability
+// maps, the normal and cost maps of the per-pixel state, and the random
+// states.
+size_t EstimatePatchMatchMemory(const std::vector<Image>& images,
+                                const PatchMatch::Problem& problem,
+                                const bool geom_consistency) {
+  const size_t num_image_floats = geom_consistency ? 5 : 1;
+  size_t num_bytes = 0;
+  for (const int image_idx : problem.src_image_idxs) {
+    const auto& image = images.at(image_idx);
+    num_bytes += image.GetWidth() * image.GetHeight() * num_image_floats *
+                 sizeof(float);
+  }
+  const auto& ref_image = images.at(problem.ref_image_idx);
+  const size_t num_ref_pixels = ref_image.GetWidth() * ref_image.GetHeight();
+  const size_t num_ref_floats =
+      num_image_floats + 1 + problem.src_image_idxs.size();
+  const size_t num_ref_state_values = 3 + problem.src_image_idxs.size();
+  const size_t kNumRandStateBytes = 48;
+  num_bytes += num_ref_pixels *
+               (num_ref_floats * sizeof(float) +
+                num_ref_state_values * sizeof(patch_match_state_t) +
+                kNumRandStateBytes);
+  return num_bytes;
+}
+
+}  // namespace
 
 PatchMatch::PatchMatch(const PatchMatchOptions& options, const Problem& problem)
     : options_(options), problem_(problem) {}
@@ -65,6 +312,13 @@ void PatchMatchOptions::Print() const {
   PrintOption(min_triangulation_angle);
   PrintOption(incident_angle_sigma);
   PrintOption(num_iterations);
+  PrintOption(checkerboard_propagation);
+  PrintOption(init_from_sparse_points);
+  PrintOption(num_pyramid_levels);
+  PrintOption(pyramid_num_iterations);
+  PrintOption(pyramid_depth_range);
+  PrintOption(tile_size);
+  PrintOption(tile_overlap);
   PrintOption(geom_consistency);
   PrintOption(geom_consistency_regularizer);
   PrintOption(geom_consistency_max_cost);
@@ -73,7 +327,11 @@ void PatchMatchOptions::Print() const {
   PrintOption(filter_min_triangulation_angle);
   PrintOption(filter_min_num_consistent);
   PrintOption(filter_geom_consistency_max_cost);
+  PrintOption(gpu_cache_size);
+  PrintOption(distorted_image_path);
   PrintOption(write_consistency_graph);
+  PrintOption(write_compact_maps);
+  PrintOption(write_confidence_map);
 }
 
 void PatchMatch::Problem::Print() const {
@@ -158,24 +416,371 @@ void PatchMatch::Run() {
 
   Check();
 
+  if (IsTiled()) {
+    RunTiled();
+    return;
+  }
+
+  if (options_.num_pyramid_levels > 1 && !options_.geom_consistency) {
+    RunPyramid();
+    return;
+  }
+
   patch_match_cuda_.reset(new PatchMatchCuda(options_, problem_));
   patch_match_cuda_->Run();
 }
 
+void PatchMatch::RunPyramid() {
+  const Image& ref_image = problem_.images->at(problem_.ref_image_idx);
+  const size_t ref_min_size =
+      std::min(ref_image.GetWidth(), ref_image.GetHeight());
+
+  int num_levels = options_.num_pyramid_levels;
+  while (num_levels > 1 &&
+         (ref_min_size >> (num_levels - 1)) < kMinPyramidImageSize) {
+    num_levels -= 1;
+  }
+
+  // The coarsest level is initialized from the initial maps of the problem,
+  // if available, and every finer level from the result of the previous level.
+  DepthMap init_depth_map;
+  NormalMap init_normal_map;
+  const bool has_init_maps = problem_.init_depth_map != nullptr &&
+                             problem_.init_normal_map != nullptr;
+  if (has_init_maps) {
+    init_depth_map = *problem_.init_depth_map;
+    init_normal_map = *problem_.init_normal_map;
+  }
+
+  for (int level = num_levels - 1; level >= 0; --level) {
+    PrintHeading2(StringPrintf("Pyramid level %d", level));
+
+    PatchMatchOptions level_options = options_;
+    if (level < num_levels - 1) {
+      level_options.num_iterations = options_.pyramid_num_iterations;
+    }
+
+    // The finest level operates on the original images, such that the source
+    // images can be taken from the GPU cache.
+    Problem level_problem = problem_;
+    std::vector<Image> level_images;
+    if (level > 0) {
+      // The coarser levels are not filtered, since the filtered pixels have
+      // no depth to initialize the next level with.
+      level_options.filter = false;
+
+      // Only copy the images of the problem to the current level.
+      const float factor = 1.0f / (1 << level);
+      level_images.reserve(problem_.src_image_idxs.size() + 1);
+      level_images.push_back(ref_image);
+      level_images.back().Rescale(factor);
+      level_problem.ref_image_idx = 0;
+      level_problem.src_image_idxs.clear();
+      for (const int image_idx : problem_.src_image_idxs) {
+        level_problem.src_image_idxs.push_back(level_images.size());
+        level_images.push_back(problem_.images->at(image_idx));
+        level_images.back().Rescale(factor);
+      }
+      level_problem.images = &level_images;
+      level_problem.gpu_image_cache = nullptr;
+    }
+
+    if (level < num_levels - 1 || has_init_maps) {
+      const Image& level_ref_image =
+          level_problem.images->at(level_problem.ref_image_idx);
+      init_depth_map =
+          ResizeDepthMap(init_depth_map, level_ref_image.GetWidth(),
+                         level_ref_image.GetHeight());
+      init_normal_map =
+          ResizeNormalMap(init_normal_map, level_ref_image.GetWidth(),
+                          level_ref_image.GetHeight());
+      level_problem.init_depth_map = &init_depth_map;
+      level_problem.init_normal_map = &init_normal_map;
+    }
+
+    if (level < num_levels - 1) {
+      level_problem.max_depth_perturbation = options_.pyramid_depth_range;
+    }
+
+    patch_match_cuda_.reset(new PatchMatchCuda(level_options, level_problem));
+    patch_match_cuda_->Run();
+
+    if (level > 0) {
+      init_depth_map = patch_match_cuda_->GetDepthMap();
+      init_normal_map = patch_match_cuda_->GetNormalMap();
+      patch_match_cuda_.reset();
+    }
+  }
+}
+
+void PatchMatch::RunTiled() {
+  const Image& ref_image = problem_.images->at(problem_.ref_image_idx);
+  const size_t width = ref_image.GetWidth();
+  const size_t height = ref_image.GetHeight();
+  const size_t tile_width = std::min<size_t>(width, options_.tile_size);
+  const size_t tile_height = std::min<size_t>(height, options_.tile_size);
+  const size_t tile_overlap = options_.tile_overlap;
+
+  CHECK(options_.depth_min > 0 && options_.depth_max > 0)
+      << "Tiling requires the depth range to select the source image regions";
+
+  const std::vector<size_t> tile_xs =
+      ComputeTileOffsets(width, tile_width, tile_overlap);
+  const std::vector<size_t> tile_ys =
+      ComputeTileOffsets(height, tile_height, tile_overlap);
+  const std::vector<size_t> owner_xs =
+      ComputeTileOwners(tile_xs, tile_width, width, tile_overlap);
+  const std::vector<size_t> owner_ys =
+      ComputeTileOwners(tile_ys, tile_height, height, tile_overlap);
+  const size_t num_tiles = tile_xs.size() * tile_ys.size();
+
+  // Every tile is optimized as a separate problem, which may itself run the
+  // image pyramid.
+  PatchMatchOptions tile_options = options_;
+  tile_options.tile_size = -1;
+
+  const int padding = options_.window_radius * options_.window_step + 1;
+  const bool has_init_maps = problem_.init_depth_map != nullptr &&
+                             problem_.init_normal_map != nullptr;
+
+  if (options_.write_confidence_map) {
+    tiled_confidence_map_ = Mat<uint8_t>(width, height, 1);
+  }
+  tiled_consistent_image_idxs_.clear();
+
+  std::vector<DepthMap> tile_depth_maps;
+  std::vector<NormalMap> tile_normal_maps;
+  tile_depth_maps.reserve(num_tiles);
+  tile_normal_maps.reserve(num_tiles);
+
+  for (size_t tile_y_idx = 0; tile_y_idx < tile_ys.size(); ++tile_y_idx) {
+    for (size_t tile_x_idx = 0; tile_x_idx < tile_xs.size(); ++tile_x_idx) {
+      PrintHeading2(StringPrintf("Tile %d / %d", tile_depth_maps.size() + 1,
+                                 num_tiles));
+
+      ImageRegion ref_region;
+      ref_region.x = tile_xs[tile_x_idx];
+      ref_region.y = tile_ys[tile_y_idx];
+      ref_region.width = tile_width;
+      ref_region.height = tile_height;
+
+      // Only copy the regions of the images that are observed by the tile.
+      Problem tile_problem = problem_;
+      std::vector<Image> tile_images;
+      std::vector<DepthMap> tile_input_depth_maps;
+      std::vector<NormalMap> tile_input_normal_maps;
+      tile_images.reserve(problem_.src_image_idxs.size() + 1);
+      tile_images.push_back(ref_image.Crop(ref_region.x, ref_region.y,
+                                           ref_region.width,
+                                           ref_region.height));
+      if (options_.geom_consistency) {
+        tile_input_depth_maps.push_back(CropDepthMap(
+            problem_.depth_maps->at(problem_.ref_image_idx), ref_region));
+        tile_input_normal_maps.push_back(CropNormalMap(
+            problem_.normal_maps->at(problem_.ref_image_idx), ref_region));
+      }
+      tile_problem.ref_image_idx = 0;
+      tile_problem.src_image_idxs.clear();
+      for (const int image_idx : problem_.src_image_idxs) {
+        const Image& src_image = problem_.images->at(image_idx);
+        const ImageRegion src_region = ComputeSourceImageRegion(
+            ref_image, src_image, ref_region, options_.depth_min,
+            options_.depth_max, padding);
+        tile_problem.src_image_idxs.push_back(tile_images.size());
+        tile_images.push_back(src_image.Crop(src_region.x, src_region.y,
+                                             src_region.width,
+                                             src_region.height));
+        if (options_.geom_consistency) {
+          tile_input_depth_maps.push_back(
+              CropDepthMap(problem_.depth_maps->at(image_idx), src_region));
+          tile_input_normal_maps.push_back(
+              CropNormalMap(problem_.normal_maps->at(image_idx), src_region));
+        }
+      }
+      tile_problem.images = &tile_images;
+      tile_problem.depth_maps = &tile_input_depth_maps;
+      tile_problem.normal_maps = &tile_input_normal_maps;
+      tile_problem.gpu_image_cache = nullptr;
+
+      DepthMap tile_init_depth_map;
+      NormalMap tile_init_normal_map;
+      if (has_init_maps) {
+        tile_init_depth_map =
+            CropDepthMap(*problem_.init_depth_map, ref_region);
+        tile_init_normal_map =
+            CropNormalMap(*problem_.init_normal_map, ref_region);
+        tile_problem.init_depth_map = &tile_init_depth_map;
+        tile_problem.init_normal_map = &tile_init_normal_map;
+      }
+
+      // The tiles lease their device memory one after the other, such that
+      // the memory of a problem is bounded by the tile size.
+      GpuScheduler::Lease gpu_lease = GpuScheduler::Get().Acquire(
+          options_.gpu_index,
+          EstimatePatchMatchMemory(tile_images, tile_problem,
+                                   options_.geom_consistency));
+
+      PatchMatch tile_patch_match(tile_options, tile_problem);
+      tile_patch_match.Run();
+
+      tile_depth_maps.push_back(tile_patch_match.GetDepthMap());
+      tile_normal_maps.push_back(tile_patch_match.GetNormalMap());
+
+      // The results that cannot be blended are taken from the tile with the
+      // largest blend weight.
+      const auto IsOwner = [&](const size_t r, const size_t c) {
+        return owner_ys[ref_region.y + r] == tile_y_idx &&
+               owner_xs[ref_region.x + c] == tile_x_idx;
+      };
+
+      if (options_.write_confidence_map) {
+        const Mat<uint8_t> confidence_map =
+            tile_patch_match.GetConfidenceMap();
+        for (size_t r = 0; r < ref_region.height; ++r) {
+          for (size_t c = 0; c < ref_region.width; ++c) {
+            if (IsOwner(r, c)) {
+              tiled_confidence_map_.Set(ref_region.y + r, ref_region.x + c,
+                                        confidence_map.Get(r, c));
+            }
+          }
+        }
+      }
+
+      if (options_.filter) {
+        const ConsistencyGraph consistency_graph =
+            tile_patch_match.GetConsistencyGraph();
+        for (size_t r = 0; r < ref_region.height; ++r) {
+          for (size_t c = 0; c < ref_region.width; ++c) {
+            int num_images;
+            const int* image_idxs;
+            consistency_graph.GetImageIdxs(r, c, &num_images, &image_idxs);
+            if (num_images == 0 || !IsOwner(r, c)) {
+              continue;
+            }
+            tiled_consistent_image_idxs_.push_back(ref_region.x + c);
+            tiled_consistent_image_idxs_.push_back(ref_region.y + r);
+            tiled_consistent_image_idxs_.push_back(num_images);
+            for (int i = 0; i < num_images; ++i) {
+              // The source images of the tile follow the reference image.
+              tiled_consistent_image_idxs_.push_back(
+                  problem_.src_image_idxs.at(image_idxs[i] - 1));
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Blend the depths and normals of the overlapping tiles that are consistent
+  // with the depth of the tile with the largest blend weight.
+  tiled_depth_map_ =
+      DepthMap(width, height, options_.depth_min, options_.depth_max);
+  tiled_normal_map_ = NormalMap(width, height);
+  Mat<float> weight_sums(width, height, 1);
+  for (size_t tile_y_idx = 0; tile_y_idx < tile_ys.size(); ++tile_y_idx) {
+    for (size_t tile_x_idx = 0; tile_x_idx < tile_xs.size(); ++tile_x_idx) {
+      const size_t tile_idx = tile_y_idx * tile_xs.size() + tile_x_idx;
+      const DepthMap& tile_depth_map = tile_depth_maps[tile_idx];
+      const NormalMap& tile_normal_map = tile_normal_maps[tile_idx];
+      for (size_t r = 0; r < tile_height; ++r) {
+        const size_t row = tile_ys[tile_y_idx] + r;
+        const size_t owner_y = owner_ys[row];
+        const float weight_y = ComputeTileBlendWeight(
+            row, tile_ys[tile_y_idx], tile_height, height, tile_overlap);
+        for (size_t c = 0; c < tile_width; ++c) {
+          const size_t col = tile_xs[tile_x_idx] + c;
+          const size_t owner_x = owner_xs[col];
+          const float owner_depth =
+              tile_depth_maps[owner_y * tile_xs.size() + owner_x].Get(
+                  row - tile_ys[owner_y], col - tile_xs[owner_x]);
+          const float depth = tile_depth_map.Get(r, c);
+          if (owner_depth <= 0 || depth <= 0 ||
+              std::abs(depth - owner_depth) >
+                  kMaxTileBlendDepthDiff * owner_depth) {
+            continue;
+          }
+
+          const float weight =
+              weight_y * ComputeTileBlendWeight(col, tile_xs[tile_x_idx],
+                                                tile_width, width,
+                                                tile_overlap);
+          weight_sums.Set(row, col, weight_sums.Get(row, col) + weight);
+          tiled_depth_map_.Set(
+              row, col, tiled_depth_map_.Get(row, col) + weight * depth);
+          for (size_t d = 0; d < 3; ++d) {
+            tiled_normal_map_.Set(row, col, d,
+                                  tiled_normal_map_.Get(row, col, d) +
+                                      weight * tile_normal_map.Get(r, c, d));
+          }
+        }
+      }
+    }
+  }
+
+  for (size_t row = 0; row < height; ++row) {
+    for (size_t col = 0; col < width; ++col) {
+      const float weight_sum = weight_sums.Get(row, col);
+      if (weight_sum <= 0) {
+        continue;
+      }
+      tiled_depth_map_.Set(row, col,
+                           tiled_depth_map_.Get(row, col) / weight_sum);
+      float normal[3];
+      tiled_normal_map_.GetSlice(row, col, normal);
+      const float norm = std::sqrt(normal[0] * normal[0] +
+                                   normal[1] * normal[1] +
+                                   normal[2] * normal[2]);
+      if (norm > 0) {
+        for (size_t d = 0; d < 3; ++d) {
+          tiled_normal_map_.Set(row, col, d, normal[d] / norm);
+        }
+      }
+    }
+  }
+}
+
+bool PatchMatch::IsTiled() const {
+  if (options_.tile_size <= 0) {
+    return false;
+  }
+  const Image& ref_image = problem_.images->at(problem_.ref_image_idx);
+  const size_t tile_size = options_.tile_size;
+  return ref_image.GetWidth() > tile_size || ref_image.GetHeight() > tile_size;
+}
+
 DepthMap PatchMatch::GetDepthMap() const {
+  if (IsTiled()) {
+    return tiled_depth_map_;
+  }
   return patch_match_cuda_->GetDepthMap();
 }
 
 NormalMap PatchMatch::GetNormalMap() const {
+  if (IsTiled()) {
+    return tiled_normal_map_;
+  }
   return patch_match_cuda_->GetNormalMap();
 }
 
 Mat<float> PatchMatch::GetSelProbMap() const {
+  CHECK(!IsTiled()) << "Selection probabilities of tiled problems";
   return patch_match_cuda_->GetSelProbMap();
 }
 
+Mat<uint8_t> PatchMatch::GetConfidenceMap() const {
+  if (IsTiled()) {
+    CHECK(options_.write_confidence_map);
+    return tiled_confidence_map_;
+  }
+  return patch_match_cuda_->GetConfidenceMap();
+}
+
 ConsistencyGraph PatchMatch::GetConsistencyGraph() const {
   const auto& ref_image = problem_.images->at(problem_.ref_image_idx);
+  if (IsTiled()) {
+    return ConsistencyGraph(ref_image.GetWidth(), ref_image.GetHeight(),
+                            tiled_consistent_image_idxs_);
+  }
   return ConsistencyGraph(ref_image.GetWidth(), ref_image.GetHeight(),
                           patch_match_cuda_->GetConsistentImageIdxs());
 }
@@ -192,35 +797,28 @@ PatchMatchController::PatchMatchController(const PatchMatchOptions& options,
 }
 
 void PatchMatchController::Run() {
+  ProfileScope profile_scope("PatchMatchController::Run");
+
   ReadWorkspace();
   ReadProblems();
   ReadGpuIndices();
 
-  thread_pool_.reset(new ThreadPool(gpu_indices_.size()));
-
-  // If geometric consistency is enabled, then photometric output must be
-  // computed first for all images without filtering.
-  if (options_.geom_consistency) {
-    auto photometric_options = options_;
-    photometric_options.geom_consistency = false;
-    photometric_options.filter = false;
+  ScheduleTasks();
 
-    for (size_t problem_idx = 0; problem_idx < problems_.size();
-         ++problem_idx) {
-      thread_pool_->AddTask(&PatchMatchController::ProcessProblem, this,
-                            photometric_options, problem_idx);
-    }
-
-    thread_pool_->Wait();
-  }
+  thread_pool_.reset(new ThreadPool(gpu_indices_.size()));
+  thread_workspaces_.clear();
+  thread_workspaces_.resize(gpu_indices_.size());
+  thread_image_idxs_.clear();
+  thread_image_idxs_.resize(gpu_indices_.size());
 
-  for (size_t problem_idx = 0; problem_idx < problems_.size(); ++problem_idx) {
-    thread_pool_->AddTask(&PatchMatchController::ProcessProblem, this, options_,
-                          problem_idx);
+  for (size_t i = 0; i < gpu_indices_.size(); ++i) {
+    thread_pool_->AddTask(&PatchMatchController::ProcessTasks, this);
   }
 
   thread_pool_->Wait();
 
+  thread_workspaces_.clear();
+
   GetTimer().PrintMinutes();
 }
 
@@ -239,9 +837,13 @@ void PatchMatchController::ReadWorkspace() {
   workspace_options.max_image_size = options_.max_image_size;
   workspace_options.image_as_rgb = false;
   workspace_options.cache_size = options_.cache_size;
+  // Reserve a part of the cache for reading the images of upcoming problems
+  // in the background.
+  workspace_options.prefetch_size = 0.1 * options_.cache_size;
   workspace_options.workspace_path = workspace_path_;
   workspace_options.workspace_format = workspace_format_;
   workspace_options.input_type = options_.geom_consistency ? "photometric" : "";
+  workspace_options.distorted_image_path = options_.distorted_image_path;
 
   workspace_.reset(new Workspace(workspace_options));
 
@@ -393,17 +995,219 @@ void PatchMatchController::ReadProblems() {
 }
 
 void PatchMatchController::ReadGpuIndices() {
-  gpu_indices_ = CSVToVector<int>(options_.gpu_index);
-  if (gpu_indices_.size() == 1 && gpu_indices_[0] == -1) {
-    const int num_cuda_devices = GetNumCudaDevices();
-    CHECK_GT(num_cuda_devices, 0);
-    gpu_indices_.resize(num_cuda_devices);
-    std::iota(gpu_indices_.begin(), gpu_indices_.end(), 0);
+  gpu_indices_ = GpuScheduler::Get().GetGpuIndices(options_.gpu_index);
+}
+
+void PatchMatchController::ScheduleTasks() {
+  tasks_.clear();
+  ready_tasks_.clear();
+  ref_image_task_idxs_.clear();
+
+  const auto& model = workspace_->GetModel();
+
+  const auto AddTask = [&](const size_t problem_idx,
+                           const bool geom_consistency) {
+    const auto& problem = problems_.at(problem_idx);
+    const auto& ref_image = model.images.at(problem.ref_image_idx);
+    Task task;
+    task.problem_idx = problem_idx;
+    task.geom_consistency = geom_consistency;
+    task.cost = static_cast<int64_t>(ref_image.GetWidth()) *
+                ref_image.GetHeight() * problem.src_image_idxs.size();
+    task.image_idxs = problem.src_image_idxs;
+    task.image_idxs.push_back(problem.ref_image_idx);
+    std::sort(task.image_idxs.begin(), task.image_idxs.end());
+    task.image_idxs.erase(
+        std::unique(task.image_idxs.begin(), task.image_idxs.end()),
+        task.image_idxs.end());
+    ref_image_task_idxs_[problem.ref_image_idx].push_back(tasks_.size());
+    tasks_.push_back(task);
+    return tasks_.size() - 1;
+  };
+
+  // If geometric consistency is enabled, then photometric output must be
+  // computed first without filtering for all images of a problem.
+  std::unordered_map<int, size_t> photometric_task_idxs;
+  if (options_.geom_consistency) {
+    for (size_t problem_idx = 0; problem_idx < problems_.size();
+         ++problem_idx) {
+      const size_t task_idx = AddTask(problem_idx, false);
+      photometric_task_idxs.emplace(problems_[problem_idx].ref_image_idx,
+                                    task_idx);
+    }
+  }
+
+  for (size_t problem_idx = 0; problem_idx < problems_.size(); ++problem_idx) {
+    const size_t task_idx = AddTask(problem_idx, options_.geom_consistency);
+    if (!options_.geom_consistency) {
+      continue;
+    }
+
+    // Images without a problem have no photometric task, in which case their
+    // photometric output must already exist.
+    for (const int image_idx : tasks_[task_idx].image_idxs) {
+      const auto photometric_task_idx = photometric_task_idxs.find(image_idx);
+      if (photometric_task_idx != photometric_task_idxs.end()) {
+        tasks_[photometric_task_idx->second].dependent_task_idxs.push_back(
+            task_idx);
+        tasks_[task_idx].num_pending_dependencies += 1;
+      }
+    }
+  }
+
+  for (size_t task_idx = 0; task_idx < tasks_.size(); ++task_idx) {
+    if (tasks_[task_idx].num_pending_dependencies == 0) {
+      ready_tasks_.emplace(-tasks_[task_idx].cost, task_idx);
+    }
+  }
+
+  num_remaining_tasks_ = tasks_.size();
+}
+
+void PatchMatchController::ProcessTasks() {
+  const int thread_idx = thread_pool_->GetThreadIndex();
+
+  auto& workspace = thread_workspaces_.at(thread_idx);
+  if (!workspace) {
+    Workspace::Options workspace_options = workspace_->GetOptions();
+    workspace_options.cache_size /= gpu_indices_.size();
+    workspace_options.prefetch_size /= gpu_indices_.size();
+    workspace.reset(new Workspace(workspace_options));
+  }
+
+  // The cache is only used and destroyed in this thread, which uses the GPU.
+  std::unique_ptr<GpuSourceImageCache> gpu_image_cache;
+  if (options_.gpu_cache_size > 0) {
+    gpu_image_cache.reset(new GpuSourceImageCache(static_cast<size_t>(
+        1024.0 * 1024.0 * 1024.0 * options_.gpu_cache_size)));
+  }
+
+  auto photometric_options = options_;
+  photometric_options.geom_consistency = false;
+  photometric_options.filter = false;
+
+  std::vector<int> prefetch_image_idxs;
+  bool prefetch_maps = false;
+
+  while (true) {
+    size_t task_idx;
+    {
+      // Wait until a task is ready or all tasks were started. Since only the
+      // geometric tasks have dependencies, there is always a started task
+      // that eventually makes another task ready.
+      std::unique_lock<std::mutex> lock(task_mutex_);
+      task_condition_.wait(lock, [this]() {
+        return !ready_tasks_.empty() || num_remaining_tasks_ == 0;
+      });
+      if (ready_tasks_.empty()) {
+        break;
+      }
+      task_idx = PopNextTask(thread_idx);
+
+      // Read the images of the current and the next ready task in the
+      // background. The next task is likely processed by this thread or
+      // otherwise its images are discarded by the next prefetch.
+      const Task& task = tasks_[task_idx];
+      prefetch_image_idxs = task.image_idxs;
+      prefetch_maps = task.geom_consistency;
+      if (!ready_tasks_.empty()) {
+        const Task& next_task = tasks_[ready_tasks_.begin()->second];
+        prefetch_image_idxs.insert(prefetch_image_idxs.end(),
+                                   next_task.image_idxs.begin(),
+                                   next_task.image_idxs.end());
+        prefetch_maps = prefetch_maps || next_task.geom_consistency;
+      }
+    }
+
+    workspace->Prefetch(prefetch_image_idxs, true, prefetch_maps,
+                        prefetch_maps);
+
+    const Task& task = tasks_[task_idx];
+    ProcessProblem(task.geom_consistency || !options_.geom_consistency
+                       ? options_
+                       : photometric_options,
+                   task.problem_idx, workspace.get(), gpu_image_cache.get());
+
+    {
+      std::unique_lock<std::mutex> lock(task_mutex_);
+      for (const size_t dependent_task_idx : task.dependent_task_idxs) {
+        Task& dependent_task = tasks_[dependent_task_idx];
+        dependent_task.num_pending_dependencies -= 1;
+        if (dependent_task.num_pending_dependencies == 0) {
+          ready_tasks_.emplace(-dependent_task.cost, dependent_task_idx);
+        }
+      }
+    }
+
+    task_condition_.notify_all();
+  }
+
+  task_condition_.notify_all();
+}
+
+size_t PatchMatchController::PopNextTask(const int thread_idx) {
+  CHECK(!ready_tasks_.empty());
+
+  const auto CountCommonImages = [](const std::vector<int>& image_idxs1,
+                                    const std::vector<int>& image_idxs2) {
+    size_t num_common_images = 0;
+    auto it1 = image_idxs1.begin();
+    auto it2 = image_idxs2.begin();
+    while (it1 != image_idxs1.end() && it2 != image_idxs2.end()) {
+      if (*it1 < *it2) {
+        ++it1;
+      } else if (*it2 < *it1) {
+        ++it2;
+      } else {
+        num_common_images += 1;
+        ++it1;
+        ++it2;
+      }
+    }
+    return num_common_images;
+  };
+
+  // Prefer the ready task with a reference image from the previous task of
+  // the thread that shares the most images with the previous task, since its
+  // images are likely cached in the workspace of the thread.
+  const auto& prev_image_idxs = thread_image_idxs_.at(thread_idx);
+  auto next_task = ready_tasks_.begin();
+  size_t max_num_common_images = 0;
+  for (const int image_idx : prev_image_idxs) {
+    const auto task_idxs = ref_image_task_idxs_.find(image_idx);
+    if (task_idxs == ref_image_task_idxs_.end()) {
+      continue;
+    }
+    for (const size_t task_idx : task_idxs->second) {
+      const Task& task = tasks_[task_idx];
+      const auto ready_task = ready_tasks_.find({-task.cost, task_idx});
+      if (ready_task == ready_tasks_.end()) {
+        continue;
+      }
+      const size_t num_common_images =
+          CountCommonImages(prev_image_idxs, task.image_idxs);
+      if (num_common_images > max_num_common_images ||
+          (num_common_images == max_num_common_images &&
+           *ready_task < *next_task)) {
+        max_num_common_images = num_common_images;
+        next_task = ready_task;
+      }
+    }
   }
+
+  // Without overlapping ready tasks, the most costly ready task is processed
+  // first to balance the load of the threads.
+  const size_t task_idx = next_task->second;
+  ready_tasks_.erase(next_task);
+  num_remaining_tasks_ -= 1;
+  thread_image_idxs_.at(thread_idx) = tasks_[task_idx].image_idxs;
+
+  return task_idx;
 }
 
-void PatchMatchController::ProcessProblem(const PatchMatchOptions& options,
-                                          const size_t problem_idx) {
+void PatchMatchController::ProcessProblem(
+    const PatchMatchOptions& options, const size_t problem_idx,
+    Workspace* workspace, GpuSourceImageCache* gpu_image_cache) {
   if (IsStopped()) {
     return;
   }
@@ -426,16 +1230,22 @@ void PatchMatchController::ProcessProblem(const PatchMatchOptions& options,
       JoinPaths(workspace_path_, stereo_folder, "normal_maps", file_name);
   const std::string consistency_graph_path = JoinPaths(
       workspace_path_, stereo_folder, "consistency_graphs", file_name);
+  const std::string confidence_map_path = JoinPaths(
+      workspace_path_, stereo_folder, "confidence_maps", file_name);
 
   if (ExistsFile(depth_map_path) && ExistsFile(normal_map_path) &&
       (!options.write_consistency_graph ||
-       ExistsFile(consistency_graph_path))) {
+       ExistsFile(consistency_graph_path)) &&
+      (!options.write_confidence_map || ExistsFile(confidence_map_path))) {
     return;
   }
 
   PrintHeading1(StringPrintf("Processing view %d / %d", problem_idx + 1,
                              problems_.size()));
 
+  ProfileScope profile_scope("PatchMatchController::ProcessProblem");
+  ProfileCounter("patch_match_problems", 1);
+
   auto patch_match_options = options;
 
   if (patch_match_options.depth_min < 0 || patch_match_options.depth_max < 0) {
@@ -466,6 +1276,19 @@ void PatchMatchController::ProcessProblem(const PatchMatchOptions& options,
   problem.images = &images;
   problem.depth_maps = &depth_maps;
   problem.normal_maps = &normal_maps;
+  problem.gpu_image_cache = gpu_image_cache;
+
+  DepthMap init_depth_map;
+  NormalMap init_normal_map;
+  if (options.init_from_sparse_points && !options.geom_consistency &&
+      model.ComputeDepthPrior(problem.ref_image_idx, &init_depth_map,
+                              &init_normal_map)) {
+    problem.init_depth_map = &init_depth_map;
+    problem.init_normal_map = &init_normal_map;
+  } else {
+    problem.init_depth_map = nullptr;
+    problem.init_normal_map = nullptr;
+  }
 
   {
     // Collect all used images in current problem.
@@ -483,10 +1306,10 @@ void PatchMatchController::ProcessProblem(const PatchMatchOptions& options,
 
     std::cout << "Reading inputs..." << std::endl;
     for (const auto image_idx : used_image_idxs) {
-      images.at(image_idx).SetBitmap(workspace_->GetBitmap(image_idx));
+      images.at(image_idx).SetBitmap(workspace->GetBitmap(image_idx));
       if (options.geom_consistency) {
-        depth_maps.at(image_idx) = workspace_->GetDepthMap(image_idx);
-        normal_maps.at(image_idx) = workspace_->GetNormalMap(image_idx);
+        depth_maps.at(image_idx) = workspace->GetDepthMap(image_idx);
+        normal_maps.at(image_idx) = workspace->GetNormalMap(image_idx);
       }
     }
   }
@@ -495,17 +1318,51 @@ void PatchMatchController::ProcessProblem(const PatchMatchOptions& options,
   patch_match_options.Print();
 
   PatchMatch patch_match(patch_match_options, problem);
+
+  // Tiled problems lease the device memory of every tile separately.
+  GpuScheduler::Lease gpu_lease;
+  if (!patch_match.IsTiled()) {
+    gpu_lease = GpuScheduler::Get().Acquire(
+        patch_match_options.gpu_index,
+        EstimatePatchMatchMemory(images, problem, options.geom_consistency));
+  }
+
   patch_match.Run();
 
+  // Sample the memory usage, while the memory of the problem is allocated.
+  int cuda_device;
+  size_t used_num_bytes;
+  size_t total_num_bytes;
+  GetCudaMemoryUsage(&cuda_device, &used_num_bytes, &total_num_bytes);
+  MetricsRegistry::Get().SetGauge(
+      StringPrintf("gpu_memory_used_bytes{gpu=\"%d\"}", cuda_device),
+      used_num_bytes);
+  MetricsRegistry::Get().SetGauge(
+      StringPrintf("gpu_memory_total_bytes{gpu=\"%d\"}", cuda_device),
+      total_num_bytes);
+
   std::cout << std::endl
             << StringPrintf("Writing %s output for %s", output_type.c_str(),
                             image_name.c_str())
             << std::endl;
 
-  patch_match.GetDepthMap().Write(depth_map_path);
-  patch_match.GetNormalMap().Write(normal_map_path);
+  if (options.write_compact_maps) {
+    CompactDepthMap(patch_match.GetDepthMap()).Write(depth_map_path);
+    CompactNormalMap(patch_match.GetNormalMap()).Write(normal_map_path);
+  } else {
+    patch_match.GetDepthMap().Write(depth_map_path);
+    patch_match.GetNormalMap().Write(normal_map_path);
+  }
   if (options.write_consistency_graph) {
-    patch_match.GetConsistencyGraph().Write(consistency_graph_path);
+    if (options.write_compact_maps) {
+      CompactConsistencyGraph(patch_match.GetConsistencyGraph())
+          .Write(consistency_graph_path);
+    } else {
+      patch_match.GetConsistencyGraph().Write(consistency_graph_path);
+    }
+  }
+  if (options.write_confidence_map) {
+    patch_match.GetConfidenceMap().Write(confidence_map_path);
   }
 }
 
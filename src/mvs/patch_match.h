@@ -34,6 +34,8 @@
 
 #include <iostream>
 #include <memory>
+#include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "mvs/depth_map.h"
@@ -53,6 +55,7 @@ namespace mvs {
 const static size_t kMaxPatchMatchWindowRadius = 32;
 
 class ConsistencyGraph;
+class GpuSourceImageCache;
 class PatchMatchCuda;
 class Workspace;
 
@@ -98,6 +101,48 @@ struct PatchMatchOptions {
   // of four sweeps from left to right, top to bottom, and vice versa.
   int num_iterations = 5;
 
+  // Whether to propagate the hypotheses in a red-black checkerboard pattern
+  // instead of sweeping the image in four directions. Each iteration updates
+  // the two colors of the checkerboard in turn, where all pixels of one color
+  // are updated in parallel, and the maps are not rotated between the sweeps.
+  // The selection probabilities of the source images are then estimated from
+  // the adjacent pixels instead of the messages along the rows.
+  bool checkerboard_propagation = false;
+
+  // Whether to initialize the photometric optimization with a depth and normal
+  // prior interpolated from the sparse points observed in the reference image
+  // instead of randomly. Since the sweeps start closer to the solution, fewer
+  // `num_iterations` are typically needed for the same quality.
+  bool init_from_sparse_points = false;
+
+  // Number of levels of the coarse-to-fine image pyramid for the photometric
+  // optimization, where every level halves the image resolution. The coarsest
+  // level is optimized with `num_iterations` from a random initialization and
+  // every finer level with `pyramid_num_iterations` from the upsampled depth
+  // and normal maps of the previous level. A value of 1 disables the pyramid.
+  int num_pyramid_levels = 1;
+
+  // Number of coordinate descent iterations at the finer pyramid levels.
+  int pyramid_num_iterations = 2;
+
+  // Maximum relative perturbation of the upsampled depths at the finer pyramid
+  // levels, which restricts the random depth hypotheses of a pixel with depth
+  // d to the range [(1 - r) * d, (1 + r) * d]. A value of 1 is equivalent to
+  // the unrestricted perturbation of the random initialization.
+  double pyramid_depth_range = 0.1f;
+
+  // Maximum size of the reference image tiles in either dimension, which bounds
+  // the device memory of a problem independent of the image resolution. Larger
+  // reference images are split into overlapping tiles that are optimized one
+  // after the other, where every tile only loads the regions of the source
+  // images into which its depth range projects. The depth and normal maps of
+  // the tiles are blended across the seams. A value of -1 disables tiling.
+  int tile_size = -1;
+
+  // Overlap in pixels of adjacent tiles, across which the depth and normal
+  // maps of the tiles are blended.
+  int tile_overlap = 64;
+
   // Whether to add a regularized geometric consistency term to the cost
   // function. If true, the `depth_maps` and `normal_maps` must not be null.
   bool geom_consistency = true;
@@ -131,12 +176,38 @@ struct PatchMatchOptions {
   // maps, and normal maps of this number of images in memory. A higher value
   // leads to less disk access and faster computation, while a lower value
   // leads to reduced memory usage. Note that a single image can consume a lot
-  // of memory, if the consistency graph is dense.
+  // of memory, if the consistency graph is dense. For multi-GPU usage, every
+  // GPU keeps its own cache with an equal share of the cache size.
   double cache_size = 32.0;
 
+  // Cache size in gigabytes for source images that are kept on the GPU after
+  // being uploaded once, such that the problems processed on the same GPU
+  // share them. The images are evicted in least-recently-used order. Set to 0
+  // to disable the cache.
+  double gpu_cache_size = 1.0;
+
+  // Path to the original distorted images, which are then undistorted on
+  // the fly instead of reading the undistorted images of the workspace. This
+  // requires a workspace written by the COLMAP undistorter with
+  // `image_encoding=NONE`.
+  std::string distorted_image_path;
+
   // Whether to write the consistency graph.
   bool write_consistency_graph = false;
 
+  // Whether to write the depth and normal maps in the compact format with half
+  // precision depths and octahedral normals, which reduces their disk usage by
+  // a factor of 2.4, and the consistency graphs in the compressed sparse row
+  // format with 16-bit image indices. The compact format is read transparently
+  // by all stages.
+  bool write_compact_maps = false;
+
+  // Whether to write a confidence map, which stores for every pixel the number
+  // of source images in which the filtered depth is consistent. The map is
+  // computed on the GPU from the consistency mask of the filter and allows
+  // the fusion to skip weakly supported pixels. Requires `filter`.
+  bool write_confidence_map = false;
+
   void Print() const;
   bool Check() const {
     if (depth_min != -1.0f || depth_max != -1.0f) {
@@ -155,6 +226,14 @@ struct PatchMatchOptions {
     CHECK_OPTION_LT(min_triangulation_angle, 180.0f);
     CHECK_OPTION_GT(incident_angle_sigma, 0.0f);
     CHECK_OPTION_GT(num_iterations, 0);
+    CHECK_OPTION_GT(num_pyramid_levels, 0);
+    CHECK_OPTION_GT(pyramid_num_iterations, 0);
+    CHECK_OPTION_GT(pyramid_depth_range, 0.0f);
+    CHECK_OPTION_LE(pyramid_depth_range, 1.0f);
+    if (tile_size != -1) {
+      CHECK_OPTION_GE(tile_overlap, 0);
+      CHECK_OPTION_GT(tile_size, 2 * tile_overlap);
+    }
     CHECK_OPTION_GE(geom_consistency_regularizer, 0.0f);
     CHECK_OPTION_GE(geom_consistency_max_cost, 0.0f);
     CHECK_OPTION_GE(filter_min_ncc, -1.0f);
@@ -164,6 +243,10 @@ struct PatchMatchOptions {
     CHECK_OPTION_GE(filter_min_num_consistent, 0);
     CHECK_OPTION_GE(filter_geom_consistency_max_cost, 0.0f);
     CHECK_OPTION_GT(cache_size, 0);
+    CHECK_OPTION_GE(gpu_cache_size, 0);
+    if (write_confidence_map) {
+      CHECK_OPTION(filter);
+    }
     return true;
   }
 };
@@ -189,6 +272,20 @@ class PatchMatch {
     // Input normal maps for the geometric consistency term.
     std::vector<NormalMap>* normal_maps = nullptr;
 
+    // Optional cache of the source images on the GPU, which is shared by the
+    // problems processed on the same GPU.
+    GpuSourceImageCache* gpu_image_cache = nullptr;
+
+    // Optional initial depth and normal maps of the reference image for the
+    // photometric optimization, e.g., interpolated from the sparse points or
+    // upsampled from a coarser pyramid level.
+    const DepthMap* init_depth_map = nullptr;
+    const NormalMap* init_normal_map = nullptr;
+
+    // Maximum relative perturbation of the depths in the photometric
+    // optimization, which is reduced for accurate initial depth maps.
+    double max_depth_perturbation = 1.0;
+
     // Print the configuration to stdout.
     void Print() const;
   };
@@ -202,16 +299,36 @@ class PatchMatch {
   // Run the patch match algorithm.
   void Run();
 
-  // Get the computed values after running the algorithm.
+  // Whether the reference image is split into tiles, which then lease their
+  // device memory from the GPU scheduler one after the other.
+  bool IsTiled() const;
+
+  // Get the computed values after running the algorithm. The selection
+  // probabilities are not available for tiled problems.
   DepthMap GetDepthMap() const;
   NormalMap GetNormalMap() const;
   ConsistencyGraph GetConsistencyGraph() const;
   Mat<float> GetSelProbMap() const;
+  Mat<uint8_t> GetConfidenceMap() const;
 
  private:
+  // Run the photometric optimization from the coarsest to the finest level of
+  // the image pyramid.
+  void RunPyramid();
+
+  // Run the photometric optimization separately on overlapping tiles of the
+  // reference image and stitch the results of the tiles.
+  void RunTiled();
+
   const PatchMatchOptions options_;
   const Problem problem_;
   std::unique_ptr<PatchMatchCuda> patch_match_cuda_;
+
+  // The stitched results of a tiled problem.
+  DepthMap tiled_depth_map_;
+  NormalMap tiled_normal_map_;
+  Mat<uint8_t> tiled_confidence_map_;
+  std::vector<int> tiled_consistent_image_idxs_;
 };
 
 // This thread processes all problems in a workspace. A workspace has the
@@ -223,6 +340,7 @@ class PatchMatch {
 //      depth_maps/*
 //      normal_maps/*
 //      consistency_graphs/*
+//      confidence_maps/*
 //      patch-match.cfg
 //
 // The `patch-match.cfg` file specifies the images to be processed as:
@@ -245,6 +363,12 @@ class PatchMatch {
 
 #ifndef __CUDACC__
 
+// Computes the depth and normal maps of all problems in the workspace. The
+// problems are distributed dynamically over the GPUs: With geometric
+// consistency, the geometric output of a problem is computed as soon as the
+// photometric outputs of its reference and source images exist. Every GPU
+// prefers the problems overlapping with its previous problem, whose images are
+// likely still in its cache, and otherwise the most costly remaining problem.
 class PatchMatchController : public Thread {
  public:
   PatchMatchController(const PatchMatchOptions& options,
@@ -253,12 +377,31 @@ class PatchMatchController : public Thread {
                        const std::string& pmvs_option_name);
 
  private:
+  // The computation of the photometric or geometric output of a problem.
+  struct Task {
+    size_t problem_idx = 0;
+    bool geom_consistency = false;
+    // Estimated cost of the task, proportional to the number of pixels of the
+    // reference image times the number of source images.
+    int64_t cost = 0;
+    // The sorted reference and source images of the problem.
+    std::vector<int> image_idxs;
+    // The number of unfinished tasks on which this task depends and the
+    // tasks depending on this task.
+    int num_pending_dependencies = 0;
+    std::vector<size_t> dependent_task_idxs;
+  };
+
   void Run();
   void ReadWorkspace();
   void ReadProblems();
   void ReadGpuIndices();
+  void ScheduleTasks();
+  void ProcessTasks();
+  size_t PopNextTask(const int thread_idx);
   void ProcessProblem(const PatchMatchOptions& options,
-                      const size_t problem_idx);
+                      const size_t problem_idx, Workspace* workspace,
+                      GpuSourceImageCache* gpu_image_cache);
 
   const PatchMatchOptions options_;
   const std::string workspace_path_;
@@ -271,6 +414,21 @@ class PatchMatchController : public Thread {
   std::vector<PatchMatch::Problem> problems_;
   std::vector<int> gpu_indices_;
   std::vector<std::pair<float, float>> depth_ranges_;
+
+  // Workspace with its own cache for every GPU thread.
+  std::vector<std::unique_ptr<Workspace>> thread_workspaces_;
+
+  std::mutex task_mutex_;
+  std::condition_variable task_condition_;
+  std::vector<Task> tasks_;
+  // The number of tasks that were not yet started.
+  size_t num_remaining_tasks_ = 0;
+  // Tasks whose dependencies are finished, sorted by decreasing cost.
+  std::set<std::pair<int64_t, size_t>> ready_tasks_;
+  // For every reference image, the tasks of its problems.
+  std::unordered_map<int, std::vector<size_t>> ref_image_task_idxs_;
+  // The images of the previous task of every GPU thread.
+  std::vector<std::vector<int>> thread_image_idxs_;
 };
 
 #endif
@@ -0,0 +1,154 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+
+#include "mvs/depth_map.h"
+#include "mvs/image.h"
+#include "mvs/normal_map.h"
+#include "mvs/patch_match.h"
+#include "util/bitmap.h"
+
+using namespace colmap;
+
+namespace {
+
+const int kImageWidth = 800;
+const int kImageHeight = 600;
+const float kFocalLength = 1000.0f;
+
+// The observed plane Z = kPlaneDepth + kPlaneSlope * X in world coordinates.
+const float kPlaneDepth = 5.0f;
+const float kPlaneSlope = 0.2f;
+
+// Depth of the plane along the viewing ray of the given pixel in the camera
+// with the given projection center and identity rotation.
+float ComputePlaneDepth(const float cx, const int row, const int col) {
+  const float x = (col - 0.5f * kImageWidth) / kFocalLength;
+  return (kPlaneDepth + kPlaneSlope * cx) / (1.0f - kPlaneSlope * x);
+}
+
+// Render the textured plane into a camera at the given projection center.
+mvs::Image RenderPlaneImage(const float cx, const float cy) {
+  const float K[9] = {kFocalLength, 0, 0.5f * kImageWidth,
+                      0, kFocalLength, 0.5f * kImageHeight,
+                      0, 0, 1};
+  const float R[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+  const float T[3] = {-cx, -cy, 0};
+  mvs::Image image("", kImageWidth, kImageHeight, K, R, T);
+
+  Bitmap bitmap;
+  bitmap.Allocate(kImageWidth, kImageHeight, false);
+  for (int row = 0; row < kImageHeight; ++row) {
+    for (int col = 0; col < kImageWidth; ++col) {
+      const float depth = ComputePlaneDepth(cx, row, col);
+      const float X = cx + depth * (col - K[2]) / kFocalLength;
+      const float Y = cy + depth * (row - K[5]) / kFocalLength;
+      const float intensity =
+          127.0f + 40.0f * std::sin(53.0f * X + 7.0f * Y) +
+          30.0f * std::sin(17.0f * X - 71.0f * Y) +
+          25.0f * std::sin(131.0f * X + 97.0f * Y) +
+          15.0f * std::sin(211.0f * X - 163.0f * Y);
+      bitmap.SetPixel(col, row,
+                      BitmapColor<uint8_t>(static_cast<uint8_t>(intensity)));
+    }
+  }
+  image.SetBitmap(bitmap);
+
+  return image;
+}
+
+}  // namespace
+
+// Measure the speed and the depth accuracy of the photometric optimization,
+// which can be compared between builds with and without
+// HALF_PATCH_MATCH_ENABLED.
+static void BM_PatchMatch(benchmark::State& state) {
+  std::vector<mvs::Image> images;
+  images.push_back(RenderPlaneImage(0, 0));
+  images.push_back(RenderPlaneImage(0.5f, 0));
+  images.push_back(RenderPlaneImage(-0.5f, 0));
+  images.push_back(RenderPlaneImage(0, 0.5f));
+  images.push_back(RenderPlaneImage(0, -0.5f));
+
+  mvs::PatchMatch::Problem problem;
+  problem.ref_image_idx = 0;
+  problem.src_image_idxs = {1, 2, 3, 4};
+  problem.images = &images;
+
+  mvs::PatchMatchOptions options;
+  options.gpu_index = "0";
+  options.depth_min = 3.0f;
+  options.depth_max = 8.0f;
+  options.sigma_spatial = options.window_radius;
+  options.geom_consistency = false;
+  options.filter = false;
+  options.checkerboard_propagation = state.range(0) != 0;
+
+  mvs::DepthMap depth_map;
+  for (auto _ : state) {
+    mvs::PatchMatch patch_match(options, problem);
+    patch_match.Run();
+    depth_map = patch_match.GetDepthMap();
+  }
+
+  // Evaluate the relative depth errors in the interior of the image, where the
+  // windows of the photometric cost are complete.
+  double sum_errors = 0;
+  size_t num_pixels = 0;
+  size_t num_accurate_pixels = 0;
+  for (int row = options.window_radius;
+       row < kImageHeight - options.window_radius; ++row) {
+    for (int col = options.window_radius;
+         col < kImageWidth - options.window_radius; ++col) {
+      const float true_depth = ComputePlaneDepth(0, row, col);
+      const float error =
+          std::abs(depth_map.Get(row, col) - true_depth) / true_depth;
+      sum_errors += error;
+      num_pixels += 1;
+      if (error < 0.01f) {
+        num_accurate_pixels += 1;
+      }
+    }
+  }
+
+  state.counters["mean_rel_depth_error"] = sum_errors / num_pixels;
+  state.counters["accurate_ratio"] =
+      static_cast<double>(num_accurate_pixels) / num_pixels;
+#ifdef HALF_PATCH_MATCH_ENABLED
+  state.counters["half_precision"] = 1;
+#else
+  state.counters["half_precision"] = 0;
+#endif
+}
+
+BENCHMARK(BM_PatchMatch)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
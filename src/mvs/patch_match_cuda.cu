@@ -69,6 +69,41 @@ __constant__ float ref_K[4];
 // Calibration of reference image as {1/fx, -cx/fx, 1/fy, -cy/fy}.
 __constant__ float ref_inv_K[4];
 
+// Convert between single precision and the storage type of the per-pixel state.
+__device__ inline float StateToFloat(const float value) { return value; }
+
+__device__ inline float StateToFloat(const uint16_t value) {
+  float result;
+  asm("cvt.f32.f16 %0, %1;" : "=f"(result) : "h"(value));
+  return result;
+}
+
+__device__ inline patch_match_state_t FloatToState(const float value) {
+#ifdef HALF_PATCH_MATCH_ENABLED
+  uint16_t result;
+  asm("cvt.rn.f16.f32 %0, %1;" : "=h"(result) : "f"(value));
+  return result;
+#else
+  return value;
+#endif
+}
+
+__device__ inline void ReadNormal(const GpuMat<patch_match_state_t>& normal_map,
+                                  const int row, const int col,
+                                  float normal[3]) {
+  for (int i = 0; i < 3; ++i) {
+    normal[i] = StateToFloat(normal_map.Get(row, col, i));
+  }
+}
+
+__device__ inline void WriteNormal(const int row, const int col,
+                                   const float normal[3],
+                                   GpuMat<patch_match_state_t>* normal_map) {
+  for (int i = 0; i < 3; ++i) {
+    normal_map->Set(row, col, i, FloatToState(normal[i]));
+  }
+}
+
 __device__ inline void Mat33DotVec3(const float mat[9], const float vec[3],
                                     float result[3]) {
   result[0] = mat[0] * vec[0] + mat[1] * vec[1] + mat[2] * vec[2];
@@ -226,6 +261,26 @@ __device__ inline float PropagateDepth(const float depth1,
   return nom / denom;
 }
 
+// Transfer depth on plane from viewing ray at (row1, col1) to (row2, col2). The
+// returned depth is the intersection of the viewing ray through (row2, col2)
+// with the plane at (row1, col1) defined by the given depth and normal.
+__device__ inline float PropagateDepth(const float depth1,
+                                       const float normal1[3], const float row1,
+                                       const float col1, const float row2,
+                                       const float col2) {
+  float point1[3];
+  ComputePointAtDepth(row1, col1, depth1, point1);
+  const float view_ray2[3] = {ref_inv_K[0] * col2 + ref_inv_K[1],
+                              ref_inv_K[2] * row2 + ref_inv_K[3], 1.0f};
+  const float denom = DotProduct3(normal1, view_ray2);
+  const float kEps = 1e-5f;
+  if (abs(denom) < kEps) {
+    return depth1;
+  }
+  const float depth2 = DotProduct3(normal1, point1) / denom;
+  return depth2 > 0.0f ? depth2 : depth1;
+}
+
 // First, compute triangulation angle between reference and source image for 3D
 // point. Second, compute incident angle between viewing direction of source
 // image and normal direction of 3D point. Both angles are cosine distances.
@@ -315,11 +370,26 @@ __device__ inline void ComposeHomography(const int image_idx, const int row,
 }
 
 // The return values is 1 - NCC, so the range is [0, 2], the smaller the
-// value, the better the color consistency.
-template <int kWindowSize, int kWindowStep>
+// value, the better the color consistency. The reference image is read from
+// the local window in shared memory or, if kLocalRefImage is false, directly
+// from the reference image texture.
+template <int kWindowSize, int kWindowStep, bool kLocalRefImage = true>
 struct PhotoConsistencyCostComputer {
   const int kWindowRadius = kWindowSize / 2;
 
+  // Number of pixels in the window, which are used to compute the NCC.
+  static const int kNumWindowRowPixels = (kWindowSize - 1) / kWindowStep + 1;
+  static const int kNumWindowPixels = kNumWindowRowPixels * kNumWindowRowPixels;
+
+  // Whether the bilateral weights of all threads in a block fit into 24KB of
+  // shared memory, so that they can be precomputed once per pixel.
+  static const bool kPrecomputeBilateralWeights =
+      kLocalRefImage && kNumWindowPixels * THREADS_PER_BLOCK <= 6144;
+
+  // Size of the shared memory for the precomputed bilateral weights.
+  static const int kNumLocalBilateralWeights =
+      kPrecomputeBilateralWeights ? kNumWindowPixels * THREADS_PER_BLOCK : 1;
+
   __device__ PhotoConsistencyCostComputer(const float sigma_spatial,
                                           const float sigma_color)
       : bilateral_weight_computer_(sigma_spatial, sigma_color) {}
@@ -330,6 +400,11 @@ struct PhotoConsistencyCostComputer {
   // Image data in local window around patch.
   const float* local_ref_image = nullptr;
 
+  // Normalized bilateral weights in local window around patch, which are
+  // interleaved for the threads in a block. If null, the weights are computed
+  // on the fly.
+  const float* local_bilateral_weights = nullptr;
+
   // Precomputed sum of raw and squared image intensities.
   float local_ref_sum = 0.0f;
   float local_ref_squared_sum = 0.0f;
@@ -345,6 +420,45 @@ struct PhotoConsistencyCostComputer {
   float depth = 0.0f;
   const float* normal = nullptr;
 
+  // Compute the normalized bilateral weights of the window around the current
+  // patch from the local reference image. The weights only depend on the
+  // reference image and are thus reused for all source images and hypotheses
+  // of the patch.
+  __device__ inline void ComputeBilateralWeights(float* weights) const {
+    const int thread_id = threadIdx.x;
+
+    int ref_image_idx = THREADS_PER_BLOCK - kWindowRadius + thread_id;
+    int ref_image_base_idx = ref_image_idx;
+
+    const float ref_center_color =
+        local_ref_image[ref_image_idx + kWindowRadius * 3 * THREADS_PER_BLOCK +
+                        kWindowRadius];
+
+    float bilateral_weight_sum = 0.0f;
+    int weight_idx = thread_id;
+
+    for (int row = -kWindowRadius; row <= kWindowRadius; row += kWindowStep) {
+      for (int col = -kWindowRadius; col <= kWindowRadius; col += kWindowStep) {
+        const float bilateral_weight = bilateral_weight_computer_.Compute(
+            row, col, ref_center_color, local_ref_image[ref_image_idx]);
+        weights[weight_idx] = bilateral_weight;
+        bilateral_weight_sum += bilateral_weight;
+        weight_idx += THREADS_PER_BLOCK;
+        ref_image_idx += kWindowStep;
+      }
+
+      ref_image_base_idx += kWindowStep * 3 * THREADS_PER_BLOCK;
+      ref_image_idx = ref_image_base_idx;
+    }
+
+    const float inv_bilateral_weight_sum = 1.0f / bilateral_weight_sum;
+    weight_idx = thread_id;
+    for (int i = 0; i < kNumWindowPixels; ++i) {
+      weights[weight_idx] *= inv_bilateral_weight_sum;
+      weight_idx += THREADS_PER_BLOCK;
+    }
+  }
+
   __device__ inline float Compute() const {
     float tform[9];
     ComposeHomography(src_image_idx, row, col, depth, normal, tform);
@@ -369,26 +483,38 @@ struct PhotoConsistencyCostComputer {
     int ref_image_base_idx = ref_image_idx;
 
     const float ref_center_color =
-        local_ref_image[ref_image_idx + kWindowRadius * 3 * THREADS_PER_BLOCK +
-                        kWindowRadius];
+        kLocalRefImage
+            ? local_ref_image[ref_image_idx +
+                              kWindowRadius * 3 * THREADS_PER_BLOCK +
+                              kWindowRadius]
+            : tex2D(ref_image_texture, this->col, this->row);
     const float ref_color_sum = local_ref_sum;
     const float ref_color_squared_sum = local_ref_squared_sum;
     float src_color_sum = 0.0f;
     float src_color_squared_sum = 0.0f;
     float src_ref_color_sum = 0.0f;
     float bilateral_weight_sum = 0.0f;
+    int weight_idx = thread_id;
 
     for (int row = -kWindowRadius; row <= kWindowRadius; row += kWindowStep) {
       for (int col = -kWindowRadius; col <= kWindowRadius; col += kWindowStep) {
         const float inv_z = 1.0f / z;
         const float norm_col_src = inv_z * col_src + 0.5f;
         const float norm_row_src = inv_z * row_src + 0.5f;
-        const float ref_color = local_ref_image[ref_image_idx];
+        const float ref_color =
+            kLocalRefImage
+                ? local_ref_image[ref_image_idx]
+                : tex2D(ref_image_texture, this->col + col, this->row + row);
         const float src_color = tex2DLayered(src_images_texture, norm_col_src,
                                              norm_row_src, src_image_idx);
 
-        const float bilateral_weight = bilateral_weight_computer_.Compute(
-            row, col, ref_center_color, ref_color);
+        const float bilateral_weight =
+            local_bilateral_weights != nullptr
+                ? local_bilateral_weights[weight_idx]
+                : bilateral_weight_computer_.Compute(row, col,
+                                                     ref_center_color,
+                                                     ref_color);
+        weight_idx += THREADS_PER_BLOCK;
 
         const float bilateral_weight_src = bilateral_weight * src_color;
 
@@ -420,7 +546,10 @@ struct PhotoConsistencyCostComputer {
       z = base_z;
     }
 
-    const float inv_bilateral_weight_sum = 1.0f / bilateral_weight_sum;
+    // The precomputed bilateral weights are already normalized.
+    const float inv_bilateral_weight_sum =
+        local_bilateral_weights != nullptr ? 1.0f
+                                           : 1.0f / bilateral_weight_sum;
     src_color_sum *= inv_bilateral_weight_sum;
     src_color_squared_sum *= inv_bilateral_weight_sum;
     src_ref_color_sum *= inv_bilateral_weight_sum;
@@ -729,7 +858,7 @@ class LikelihoodComputer {
 };
 
 // Rotate normals by 90deg around z-axis in counter-clockwise direction.
-__global__ void InitNormalMap(GpuMat<float> normal_map,
+__global__ void InitNormalMap(GpuMat<patch_match_state_t> normal_map,
                               GpuMat<curandState> rand_state_map) {
   const int row = blockDim.y * blockIdx.y + threadIdx.y;
   const int col = blockDim.x * blockIdx.x + threadIdx.x;
@@ -737,30 +866,69 @@ __global__ void InitNormalMap(GpuMat<float> normal_map,
     curandState rand_state = rand_state_map.Get(row, col);
     float normal[3];
     GenerateRandomNormal(row, col, &rand_state, normal);
-    normal_map.SetSlice(row, col, normal);
+    WriteNormal(row, col, normal, &normal_map);
     rand_state_map.Set(row, col, rand_state);
   }
 }
 
 // Rotate normals by 90deg around z-axis in counter-clockwise direction.
-__global__ void RotateNormalMap(GpuMat<float> normal_map) {
+__global__ void RotateNormalMap(GpuMat<patch_match_state_t> normal_map) {
   const int row = blockDim.y * blockIdx.y + threadIdx.y;
   const int col = blockDim.x * blockIdx.x + threadIdx.x;
   if (col < normal_map.GetWidth() && row < normal_map.GetHeight()) {
     float normal[3];
-    normal_map.GetSlice(row, col, normal);
+    ReadNormal(normal_map, row, col, normal);
     float rotated_normal[3];
     rotated_normal[0] = normal[1];
     rotated_normal[1] = -normal[0];
     rotated_normal[2] = normal[2];
-    normal_map.SetSlice(row, col, rotated_normal);
+    WriteNormal(row, col, rotated_normal, &normal_map);
+  }
+}
+
+// Convert the single precision normals of the host to the per-pixel state.
+__global__ void ConvertToState(const GpuMat<float> input,
+                               GpuMat<patch_match_state_t> output) {
+  const int row = blockDim.y * blockIdx.y + threadIdx.y;
+  const int col = blockDim.x * blockIdx.x + threadIdx.x;
+  if (col < output.GetWidth() && row < output.GetHeight()) {
+    for (int slice = 0; slice < output.GetDepth(); ++slice) {
+      output.Set(row, col, slice, FloatToState(input.Get(row, col, slice)));
+    }
+  }
+}
+
+// Convert the per-pixel state to single precision for the host.
+__global__ void ConvertFromState(const GpuMat<patch_match_state_t> input,
+                                 GpuMat<float> output) {
+  const int row = blockDim.y * blockIdx.y + threadIdx.y;
+  const int col = blockDim.x * blockIdx.x + threadIdx.x;
+  if (col < output.GetWidth() && row < output.GetHeight()) {
+    for (int slice = 0; slice < output.GetDepth(); ++slice) {
+      output.Set(row, col, slice, StateToFloat(input.Get(row, col, slice)));
+    }
+  }
+}
+
+// Count the number of source images in which a pixel is consistent.
+__global__ void ComputeConfidenceMap(const GpuMat<uint8_t> consistency_mask,
+                                     GpuMat<uint8_t> confidence_map) {
+  const int row = blockDim.y * blockIdx.y + threadIdx.y;
+  const int col = blockDim.x * blockIdx.x + threadIdx.x;
+  if (col < confidence_map.GetWidth() && row < confidence_map.GetHeight()) {
+    int num_consistent = 0;
+    for (int image_idx = 0; image_idx < consistency_mask.GetDepth();
+         ++image_idx) {
+      num_consistent += consistency_mask.Get(row, col, image_idx);
+    }
+    confidence_map.Set(row, col, min(num_consistent, 255));
   }
 }
 
 template <int kWindowSize, int kWindowStep>
-__global__ void ComputeInitialCost(GpuMat<float> cost_map,
+__global__ void ComputeInitialCost(GpuMat<patch_match_state_t> cost_map,
                                    const GpuMat<float> depth_map,
-                                   const GpuMat<float> normal_map,
+                                   const GpuMat<patch_match_state_t> normal_map,
                                    const GpuMat<float> ref_sum_image,
                                    const GpuMat<float> ref_squared_sum_image,
                                    const float sigma_spatial,
@@ -770,9 +938,16 @@ __global__ void ComputeInitialCost(GpuMat<float> cost_map,
 
   __shared__ float local_ref_image[THREADS_PER_BLOCK * 3 * kWindowSize];
 
-  PhotoConsistencyCostComputer<kWindowSize, kWindowStep> pcc_computer(
-      sigma_spatial, sigma_color);
+  typedef PhotoConsistencyCostComputer<kWindowSize, kWindowStep>
+      PhotoConsistencyCostComputerType;
+  __shared__ float local_bilateral_weights
+      [PhotoConsistencyCostComputerType::kNumLocalBilateralWeights];
+
+  PhotoConsistencyCostComputerType pcc_computer(sigma_spatial, sigma_color);
   pcc_computer.local_ref_image = local_ref_image;
+  if (PhotoConsistencyCostComputerType::kPrecomputeBilateralWeights) {
+    pcc_computer.local_bilateral_weights = local_bilateral_weights;
+  }
   pcc_computer.row = 0;
   pcc_computer.col = col;
 
@@ -787,14 +962,19 @@ __global__ void ComputeInitialCost(GpuMat<float> cost_map,
 
     if (col < cost_map.GetWidth()) {
       pcc_computer.depth = depth_map.Get(row, col);
-      normal_map.GetSlice(row, col, normal);
+      ReadNormal(normal_map, row, col, normal);
 
       pcc_computer.local_ref_sum = ref_sum_image.Get(row, col);
       pcc_computer.local_ref_squared_sum = ref_squared_sum_image.Get(row, col);
 
+      if (PhotoConsistencyCostComputerType::kPrecomputeBilateralWeights) {
+        pcc_computer.ComputeBilateralWeights(local_bilateral_weights);
+      }
+
       for (int image_idx = 0; image_idx < cost_map.GetDepth(); ++image_idx) {
         pcc_computer.src_image_idx = image_idx;
-        cost_map.Set(row, col, image_idx, pcc_computer.Compute());
+        cost_map.Set(row, col, image_idx,
+                     FloatToState(pcc_computer.Compute()));
       }
 
       pcc_computer.row += 1;
@@ -821,12 +1001,78 @@ struct SweepOptions {
   float filter_geom_consistency_max_cost = 1.0f;
 };
 
+// Mark the source images, in which the pixel with the given depth and normal
+// is consistent, and filter the pixel, if it is not consistent in enough
+// source images.
+template <bool kFilterPhotoConsistency, bool kFilterGeomConsistency>
+__device__ inline void FilterConsistency(
+    const int row, const int col, const float depth, const float normal[3],
+    const LikelihoodComputer& likelihood_computer,
+    const GpuMat<float>& sel_prob_map, const SweepOptions& options,
+    GpuMat<float>* depth_map, GpuMat<patch_match_state_t>* normal_map,
+    GpuMat<uint8_t>* consistency_mask) {
+  int num_consistent = 0;
+
+  float point[3];
+  ComputePointAtDepth(row, col, depth, point);
+
+  const float min_ncc_prob =
+      likelihood_computer.ComputeNCCProb(1.0f - options.filter_min_ncc);
+  const float cos_min_triangulation_angle =
+      cos(options.filter_min_triangulation_angle);
+
+  for (int image_idx = 0; image_idx < sel_prob_map.GetDepth(); ++image_idx) {
+    float cos_triangulation_angle;
+    float cos_incident_angle;
+    ComputeViewingAngles(point, normal, image_idx, &cos_triangulation_angle,
+                         &cos_incident_angle);
+    if (cos_triangulation_angle > cos_min_triangulation_angle ||
+        cos_incident_angle <= 0.0f) {
+      continue;
+    }
+
+    if (!kFilterGeomConsistency) {
+      if (sel_prob_map.Get(row, col, image_idx) >= min_ncc_prob) {
+        consistency_mask->Set(row, col, image_idx, 1);
+        num_consistent += 1;
+      }
+    } else if (!kFilterPhotoConsistency) {
+      if (ComputeGeomConsistencyCost(row, col, depth, image_idx,
+                                     options.geom_consistency_max_cost) <=
+          options.filter_geom_consistency_max_cost) {
+        consistency_mask->Set(row, col, image_idx, 1);
+        num_consistent += 1;
+      }
+    } else {
+      if (sel_prob_map.Get(row, col, image_idx) >= min_ncc_prob &&
+          ComputeGeomConsistencyCost(row, col, depth, image_idx,
+                                     options.geom_consistency_max_cost) <=
+              options.filter_geom_consistency_max_cost) {
+        consistency_mask->Set(row, col, image_idx, 1);
+        num_consistent += 1;
+      }
+    }
+  }
+
+  if (num_consistent < options.filter_min_num_consistent) {
+    const float kFilterValue = 0.0f;
+    depth_map->Set(row, col, kFilterValue);
+    normal_map->Set(row, col, 0, FloatToState(kFilterValue));
+    normal_map->Set(row, col, 1, FloatToState(kFilterValue));
+    normal_map->Set(row, col, 2, FloatToState(kFilterValue));
+    for (int image_idx = 0; image_idx < sel_prob_map.GetDepth(); ++image_idx) {
+      consistency_mask->Set(row, col, image_idx, 0);
+    }
+  }
+}
+
 template <int kWindowSize, int kWindowStep, bool kGeomConsistencyTerm = false,
           bool kFilterPhotoConsistency = false,
           bool kFilterGeomConsistency = false>
 __global__ void SweepFromTopToBottom(
     GpuMat<float> global_workspace, GpuMat<curandState> rand_state_map,
-    GpuMat<float> cost_map, GpuMat<float> depth_map, GpuMat<float> normal_map,
+    GpuMat<patch_match_state_t> cost_map, GpuMat<float> depth_map,
+    GpuMat<patch_match_state_t> normal_map,
     GpuMat<uint8_t> consistency_mask, GpuMat<float> sel_prob_map,
     const GpuMat<float> prev_sel_prob_map, const GpuMat<float> ref_sum_image,
     const GpuMat<float> ref_squared_sum_image, const SweepOptions options) {
@@ -858,7 +1104,7 @@ __global__ void SweepFromTopToBottom(
       // Compute backward message.
       float beta = kUniformProb;
       for (int row = cost_map.GetHeight() - 1; row >= 0; --row) {
-        const float cost = cost_map.Get(row, col, image_idx);
+        const float cost = StateToFloat(cost_map.Get(row, col, image_idx));
         beta = likelihood_computer.ComputeBackwardMessage(cost, beta);
         sel_prob_map.Set(row, col, image_idx, beta);
       }
@@ -878,9 +1124,19 @@ __global__ void SweepFromTopToBottom(
   // size to 2 * THREADS_PER_BLOCK + 1.
   __shared__ float local_ref_image[THREADS_PER_BLOCK * 3 * kWindowSize];
 
-  PhotoConsistencyCostComputer<kWindowSize, kWindowStep> pcc_computer(
-      options.sigma_spatial, options.sigma_color);
+  // Shared memory holding the bilateral weights of the current pixel for each
+  // thread, which are reused for all sampled source images and hypotheses.
+  typedef PhotoConsistencyCostComputer<kWindowSize, kWindowStep>
+      PhotoConsistencyCostComputerType;
+  __shared__ float local_bilateral_weights
+      [PhotoConsistencyCostComputerType::kNumLocalBilateralWeights];
+
+  PhotoConsistencyCostComputerType pcc_computer(options.sigma_spatial,
+                                                options.sigma_color);
   pcc_computer.local_ref_image = local_ref_image;
+  if (PhotoConsistencyCostComputerType::kPrecomputeBilateralWeights) {
+    pcc_computer.local_bilateral_weights = local_bilateral_weights;
+  }
   pcc_computer.col = col;
 
   struct ParamState {
@@ -902,7 +1158,7 @@ __global__ void SweepFromTopToBottom(
     rand_state = rand_state_map.Get(0, col);
     // Parameters for first row in column.
     prev_param_state.depth = depth_map.Get(0, col);
-    normal_map.GetSlice(0, col, prev_param_state.normal);
+    ReadNormal(normal_map, 0, col, prev_param_state.normal);
   }
 
   for (int row = 0; row < cost_map.GetHeight(); ++row) {
@@ -919,6 +1175,10 @@ __global__ void SweepFromTopToBottom(
     pcc_computer.local_ref_sum = ref_sum_image.Get(row, col);
     pcc_computer.local_ref_squared_sum = ref_squared_sum_image.Get(row, col);
 
+    if (PhotoConsistencyCostComputerType::kPrecomputeBilateralWeights) {
+      pcc_computer.ComputeBilateralWeights(local_bilateral_weights);
+    }
+
     // Propagate the depth at which the current ray intersects with the plane
     // of the normal of the previous ray. This helps to better estimate
     // the depth of very oblique structures, i.e. pixels whose normal direction
@@ -928,7 +1188,7 @@ __global__ void SweepFromTopToBottom(
 
     // Read parameters for current pixel from previous sweep.
     curr_param_state.depth = depth_map.Get(row, col);
-    normal_map.GetSlice(row, col, curr_param_state.normal);
+    ReadNormal(normal_map, row, col, curr_param_state.normal);
 
     // Generate random parameters.
     rand_param_state.depth =
@@ -944,7 +1204,7 @@ __global__ void SweepFromTopToBottom(
     ComputePointAtDepth(row, col, curr_param_state.depth, point);
 
     for (int image_idx = 0; image_idx < cost_map.GetDepth(); ++image_idx) {
-      const float cost = cost_map.Get(row, col, image_idx);
+      const float cost = StateToFloat(cost_map.Get(row, col, image_idx));
       const float alpha = likelihood_computer.ComputeForwardMessage(
           cost, forward_message[image_idx]);
       const float beta = sel_prob_map.Get(row, col, image_idx);
@@ -1009,7 +1269,8 @@ __global__ void SweepFromTopToBottom(
         continue;
       }
 
-      costs[0] += cost_map.Get(row, col, pcc_computer.src_image_idx);
+      costs[0] +=
+          StateToFloat(cost_map.Get(row, col, pcc_computer.src_image_idx));
       if (kGeomConsistencyTerm) {
         costs[0] += options.geom_consistency_regularizer *
                     ComputeGeomConsistencyCost(
@@ -1037,7 +1298,7 @@ __global__ void SweepFromTopToBottom(
 
     // Save best new parameters.
     depth_map.Set(row, col, best_depth);
-    normal_map.SetSlice(row, col, best_normal);
+    WriteNormal(row, col, best_normal, &normal_map);
 
     // Use the new cost to recompute the updated forward message and
     // the selection probability.
@@ -1047,11 +1308,11 @@ __global__ void SweepFromTopToBottom(
       // Determine the cost for best depth.
       float cost;
       if (min_cost_idx == 0) {
-        cost = cost_map.Get(row, col, image_idx);
+        cost = StateToFloat(cost_map.Get(row, col, image_idx));
       } else {
         pcc_computer.src_image_idx = image_idx;
         cost = pcc_computer.Compute();
-        cost_map.Set(row, col, image_idx, cost);
+        cost_map.Set(row, col, image_idx, FloatToState(cost));
       }
 
       const float alpha = likelihood_computer.ComputeForwardMessage(
@@ -1065,71 +1326,339 @@ __global__ void SweepFromTopToBottom(
     }
 
     if (kFilterPhotoConsistency || kFilterGeomConsistency) {
-      int num_consistent = 0;
+      FilterConsistency<kFilterPhotoConsistency, kFilterGeomConsistency>(
+          row, col, best_depth, best_normal, likelihood_computer, sel_prob_map,
+          options, &depth_map, &normal_map, &consistency_mask);
+    }
+
+    // Update previous depth for next row.
+    prev_param_state.depth = best_depth;
+    for (int i = 0; i < 3; ++i) {
+      prev_param_state.normal[i] = best_normal[i];
+    }
+  }
 
-      float best_point[3];
-      ComputePointAtDepth(row, col, best_depth, best_point);
+  if (col < cost_map.GetWidth()) {
+    rand_state_map.Set(0, col, rand_state);
+  }
+}
 
-      const float min_ncc_prob =
-          likelihood_computer.ComputeNCCProb(1.0f - options.filter_min_ncc);
-      const float cos_min_triangulation_angle =
-          cos(options.filter_min_triangulation_angle);
+// Update the pixels of one color of a checkerboard pattern in parallel, where
+// the hypotheses are propagated from the four adjacent pixels of the other
+// color. In contrast to the sweeps, all rows are processed in parallel and no
+// rotations of the maps are necessary. Since there are no messages along the
+// rows, the selection probabilities are estimated from the matching cost and
+// the selection probabilities of the adjacent pixels. The sampling
+// probabilities of the source images are stored in sampling_probs_map.
+template <int kWindowSize, int kWindowStep, bool kGeomConsistencyTerm = false,
+          bool kFilterPhotoConsistency = false,
+          bool kFilterGeomConsistency = false>
+__global__ void PropagateCheckerboard(
+    GpuMat<float> sampling_probs_map, GpuMat<curandState> rand_state_map,
+    GpuMat<patch_match_state_t> cost_map, GpuMat<float> depth_map,
+    GpuMat<patch_match_state_t> normal_map,
+    GpuMat<uint8_t> consistency_mask, GpuMat<float> sel_prob_map,
+    const GpuMat<float> ref_sum_image,
+    const GpuMat<float> ref_squared_sum_image, const int color,
+    const SweepOptions options) {
+  const int row = blockDim.y * blockIdx.y + threadIdx.y;
+  const int col =
+      2 * (blockDim.x * blockIdx.x + threadIdx.x) + ((row + color) & 1);
+  if (row >= cost_map.GetHeight() || col >= cost_map.GetWidth()) {
+    return;
+  }
 
-      for (int image_idx = 0; image_idx < cost_map.GetDepth(); ++image_idx) {
-        float cos_triangulation_angle;
-        float cos_incident_angle;
-        ComputeViewingAngles(best_point, best_normal, image_idx,
-                             &cos_triangulation_angle, &cos_incident_angle);
-        if (cos_triangulation_angle > cos_min_triangulation_angle ||
-            cos_incident_angle <= 0.0f) {
-          continue;
-        }
+  LikelihoodComputer likelihood_computer(options.ncc_sigma,
+                                         options.min_triangulation_angle,
+                                         options.incident_angle_sigma);
 
-        if (!kFilterGeomConsistency) {
-          if (sel_prob_map.Get(row, col, image_idx) >= min_ncc_prob) {
-            consistency_mask.Set(row, col, image_idx, 1);
-            num_consistent += 1;
-          }
-        } else if (!kFilterPhotoConsistency) {
-          if (ComputeGeomConsistencyCost(row, col, best_depth, image_idx,
-                                         options.geom_consistency_max_cost) <=
-              options.filter_geom_consistency_max_cost) {
-            consistency_mask.Set(row, col, image_idx, 1);
-            num_consistent += 1;
-          }
-        } else {
-          if (sel_prob_map.Get(row, col, image_idx) >= min_ncc_prob &&
-              ComputeGeomConsistencyCost(row, col, best_depth, image_idx,
-                                         options.geom_consistency_max_cost) <=
-                  options.filter_geom_consistency_max_cost) {
-            consistency_mask.Set(row, col, image_idx, 1);
-            num_consistent += 1;
-          }
-        }
+  PhotoConsistencyCostComputer<kWindowSize, kWindowStep, false> pcc_computer(
+      options.sigma_spatial, options.sigma_color);
+  pcc_computer.row = row;
+  pcc_computer.col = col;
+  pcc_computer.local_ref_sum = ref_sum_image.Get(row, col);
+  pcc_computer.local_ref_squared_sum = ref_squared_sum_image.Get(row, col);
+
+  curandState rand_state = rand_state_map.Get(row, col);
+
+  struct ParamState {
+    float depth = 0.0f;
+    float normal[3];
+  };
+
+  // Adjacent pixels of the other color. At the image border, the pixel on the
+  // opposite side is used instead.
+  const int kNumNeighbors = 4;
+  int neighbor_rows[kNumNeighbors] = {row - 1, row + 1, row, row};
+  int neighbor_cols[kNumNeighbors] = {col, col, col - 1, col + 1};
+  if (row == 0) {
+    neighbor_rows[0] = row + 1;
+  }
+  if (row == cost_map.GetHeight() - 1) {
+    neighbor_rows[1] = row - 1;
+  }
+  if (col == 0) {
+    neighbor_cols[2] = col + 1;
+  }
+  if (col == cost_map.GetWidth() - 1) {
+    neighbor_cols[3] = col - 1;
+  }
+
+  // Parameters of current pixel from previous iteration.
+  ParamState curr_param_state;
+  curr_param_state.depth = depth_map.Get(row, col);
+  ReadNormal(normal_map, row, col, curr_param_state.normal);
+
+  // Parameters of the adjacent pixels propagated to the current pixel.
+  ParamState neighbor_param_states[kNumNeighbors];
+  for (int i = 0; i < kNumNeighbors; ++i) {
+    ReadNormal(normal_map, neighbor_rows[i], neighbor_cols[i],
+               neighbor_param_states[i].normal);
+    neighbor_param_states[i].depth = PropagateDepth(
+        depth_map.Get(neighbor_rows[i], neighbor_cols[i]),
+        neighbor_param_states[i].normal, neighbor_rows[i], neighbor_cols[i],
+        row, col);
+  }
+
+  // Randomly sampled parameters.
+  ParamState rand_param_state;
+  rand_param_state.depth =
+      PerturbDepth(options.perturbation, curr_param_state.depth, &rand_state);
+  PerturbNormal(row, col, options.perturbation * M_PI, curr_param_state.normal,
+                &rand_state, rand_param_state.normal);
+
+  // Compute selection probabilities from the matching cost and the selection
+  // probabilities of the adjacent pixels and modulate them with priors.
+
+  float point[3];
+  ComputePointAtDepth(row, col, curr_param_state.depth, point);
+
+  float sampling_prob_sum = 0.0f;
+  for (int image_idx = 0; image_idx < cost_map.GetDepth(); ++image_idx) {
+    float neighbor_prob = 0.0f;
+    for (int i = 0; i < kNumNeighbors; ++i) {
+      neighbor_prob +=
+          sel_prob_map.Get(neighbor_rows[i], neighbor_cols[i], image_idx);
+    }
+    neighbor_prob /= kNumNeighbors;
+
+    const float cost = StateToFloat(cost_map.Get(row, col, image_idx));
+    const float alpha =
+        likelihood_computer.ComputeForwardMessage(cost, neighbor_prob);
+    const float prev_prob = sel_prob_map.Get(row, col, image_idx);
+    const float sel_prob = options.prev_sel_prob_weight * prev_prob +
+                           (1.0f - options.prev_sel_prob_weight) * alpha;
+
+    float cos_triangulation_angle;
+    float cos_incident_angle;
+    ComputeViewingAngles(point, curr_param_state.normal, image_idx,
+                         &cos_triangulation_angle, &cos_incident_angle);
+    const float tri_prob =
+        likelihood_computer.ComputeTriProb(cos_triangulation_angle);
+    const float inc_prob =
+        likelihood_computer.ComputeIncProb(cos_incident_angle);
+
+    float H[9];
+    ComposeHomography(image_idx, row, col, curr_param_state.depth,
+                      curr_param_state.normal, H);
+    const float res_prob =
+        likelihood_computer.ComputeResolutionProb<kWindowSize>(H, row, col);
+
+    sampling_prob_sum += sel_prob * tri_prob * inc_prob * res_prob;
+    sampling_probs_map.Set(row, col, image_idx, sampling_prob_sum);
+  }
+
+  // Compute matching cost using Monte Carlo sampling of source images as in
+  // the sweeps, where the sampling probabilities are the cumulative sums.
+
+  const int kNumCosts = 4 + kNumNeighbors;
+  float costs[kNumCosts];
+  const float depths[kNumCosts] = {
+      curr_param_state.depth,         rand_param_state.depth,
+      curr_param_state.depth,         rand_param_state.depth,
+      neighbor_param_states[0].depth, neighbor_param_states[1].depth,
+      neighbor_param_states[2].depth, neighbor_param_states[3].depth};
+  const float* normals[kNumCosts] = {
+      curr_param_state.normal,         rand_param_state.normal,
+      rand_param_state.normal,         curr_param_state.normal,
+      neighbor_param_states[0].normal, neighbor_param_states[1].normal,
+      neighbor_param_states[2].normal, neighbor_param_states[3].normal};
+
+  for (int i = 0; i < kNumCosts; ++i) {
+    costs[i] = 0.0f;
+  }
+
+  for (int sample = 0; sample < options.num_samples; ++sample) {
+    const float rand_prob =
+        (curand_uniform(&rand_state) - FLT_EPSILON) * sampling_prob_sum;
+
+    pcc_computer.src_image_idx = -1;
+    for (int image_idx = 0; image_idx < cost_map.GetDepth(); ++image_idx) {
+      const float prob = sampling_probs_map.Get(row, col, image_idx);
+      if (prob > rand_prob) {
+        pcc_computer.src_image_idx = image_idx;
+        break;
       }
+    }
 
-      if (num_consistent < options.filter_min_num_consistent) {
-        const float kFilterValue = 0.0f;
-        depth_map.Set(row, col, kFilterValue);
-        normal_map.Set(row, col, 0, kFilterValue);
-        normal_map.Set(row, col, 1, kFilterValue);
-        normal_map.Set(row, col, 2, kFilterValue);
-        for (int image_idx = 0; image_idx < cost_map.GetDepth(); ++image_idx) {
-          consistency_mask.Set(row, col, image_idx, 0);
-        }
+    if (pcc_computer.src_image_idx == -1) {
+      continue;
+    }
+
+    costs[0] +=
+        StateToFloat(cost_map.Get(row, col, pcc_computer.src_image_idx));
+    if (kGeomConsistencyTerm) {
+      costs[0] += options.geom_consistency_regularizer *
+                  ComputeGeomConsistencyCost(
+                      row, col, depths[0], pcc_computer.src_image_idx,
+                      options.geom_consistency_max_cost);
+    }
+
+    for (int i = 1; i < kNumCosts; ++i) {
+      pcc_computer.depth = depths[i];
+      pcc_computer.normal = normals[i];
+      costs[i] += pcc_computer.Compute();
+      if (kGeomConsistencyTerm) {
+        costs[i] += options.geom_consistency_regularizer *
+                    ComputeGeomConsistencyCost(
+                        row, col, depths[i], pcc_computer.src_image_idx,
+                        options.geom_consistency_max_cost);
       }
     }
+  }
 
-    // Update previous depth for next row.
-    prev_param_state.depth = best_depth;
-    for (int i = 0; i < 3; ++i) {
-      prev_param_state.normal[i] = best_normal[i];
+  // Find the parameters of the minimum cost.
+  const int min_cost_idx = FindMinCost<kNumCosts>(costs);
+  const float best_depth = depths[min_cost_idx];
+  const float* best_normal = normals[min_cost_idx];
+
+  // Save best new parameters.
+  depth_map.Set(row, col, best_depth);
+  WriteNormal(row, col, best_normal, &normal_map);
+
+  // Use the new cost to recompute the selection probability.
+  pcc_computer.depth = best_depth;
+  pcc_computer.normal = best_normal;
+  for (int image_idx = 0; image_idx < cost_map.GetDepth(); ++image_idx) {
+    // Determine the cost for best depth.
+    float cost;
+    if (min_cost_idx == 0) {
+      cost = StateToFloat(cost_map.Get(row, col, image_idx));
+    } else {
+      pcc_computer.src_image_idx = image_idx;
+      cost = pcc_computer.Compute();
+      cost_map.Set(row, col, image_idx, FloatToState(cost));
+    }
+
+    float neighbor_prob = 0.0f;
+    for (int i = 0; i < kNumNeighbors; ++i) {
+      neighbor_prob +=
+          sel_prob_map.Get(neighbor_rows[i], neighbor_cols[i], image_idx);
     }
+    neighbor_prob /= kNumNeighbors;
+
+    const float alpha =
+        likelihood_computer.ComputeForwardMessage(cost, neighbor_prob);
+    const float prev_prob = sel_prob_map.Get(row, col, image_idx);
+    sel_prob_map.Set(row, col, image_idx,
+                     options.prev_sel_prob_weight * prev_prob +
+                         (1.0f - options.prev_sel_prob_weight) * alpha);
   }
 
-  if (col < cost_map.GetWidth()) {
-    rand_state_map.Set(0, col, rand_state);
+  if (kFilterPhotoConsistency || kFilterGeomConsistency) {
+    FilterConsistency<kFilterPhotoConsistency, kFilterGeomConsistency>(
+        row, col, best_depth, best_normal, likelihood_computer, sel_prob_map,
+        options, &depth_map, &normal_map, &consistency_mask);
+  }
+
+  rand_state_map.Set(row, col, rand_state);
+}
+
+namespace {
+
+void CopyToState(const Mat<float>& mat, GpuMat<float>* state) {
+  state->CopyToDevice(mat.GetPtr(), mat.GetWidth() * sizeof(float));
+}
+
+void CopyToState(const Mat<float>& mat, GpuMat<uint16_t>* state) {
+  GpuMat<float> staging(mat.GetWidth(), mat.GetHeight(), mat.GetDepth());
+  staging.CopyToDevice(mat.GetPtr(), mat.GetWidth() * sizeof(float));
+  const dim3 block_size(THREADS_PER_BLOCK, THREADS_PER_BLOCK);
+  const dim3 grid_size((mat.GetWidth() - 1) / block_size.x + 1,
+                       (mat.GetHeight() - 1) / block_size.y + 1);
+  ConvertToState<<<grid_size, block_size>>>(staging, *state);
+  CUDA_SYNC_AND_CHECK();
+}
+
+Mat<float> CopyFromState(const GpuMat<float>& state) {
+  return state.CopyToMat();
+}
+
+Mat<float> CopyFromState(const GpuMat<uint16_t>& state) {
+  GpuMat<float> staging(state.GetWidth(), state.GetHeight(), state.GetDepth());
+  const dim3 block_size(THREADS_PER_BLOCK, THREADS_PER_BLOCK);
+  const dim3 grid_size((state.GetWidth() - 1) / block_size.x + 1,
+                       (state.GetHeight() - 1) / block_size.y + 1);
+  ConvertFromState<<<grid_size, block_size>>>(state, staging);
+  CUDA_SYNC_AND_CHECK();
+  return staging.CopyToMat();
+}
+
+}  // namespace
+
+GpuSourceImageCache::GpuSourceImageCache(const size_t max_num_bytes)
+    : cache_(max_num_bytes, [](const int) { return CachedImage(); }) {}
+
+const GpuMat<uint8_t>& GpuSourceImageCache::Get(const int image_idx,
+                                                const Image& image) {
+  auto& cached_image = cache_.GetMutable(image_idx);
+  if (!cached_image.image) {
+    const std::vector<uint8_t> image_array =
+        image.GetBitmap().ConvertToRowMajorArray();
+    cached_image.image.reset(
+        new GpuMat<uint8_t>(image.GetWidth(), image.GetHeight()));
+    cached_image.image->CopyToDevice(image_array.data(),
+                                     image.GetWidth() * sizeof(uint8_t));
+    cache_.UpdateNumBytes(image_idx);
   }
+  return *cached_image.image;
+}
+
+size_t GpuSourceImageCache::CachedImage::NumBytes() const {
+  return image ? image->GetPitch() * image->GetHeight() : 0;
+}
+
+PatchMatchCuda::SliceUploader::SliceUploader(const size_t max_slice_num_bytes,
+                                             cudaStream_t stream)
+    : stream_(stream), buffer_idx_(0) {
+  for (int i = 0; i < 2; ++i) {
+    CUDA_SAFE_CALL(cudaMallocHost(&buffers_[i], max_slice_num_bytes));
+    CUDA_SAFE_CALL(
+        cudaEventCreateWithFlags(&events_[i], cudaEventDisableTiming));
+  }
+}
+
+PatchMatchCuda::SliceUploader::~SliceUploader() {
+  for (int i = 0; i < 2; ++i) {
+    CUDA_SAFE_CALL(cudaEventSynchronize(events_[i]));
+    CUDA_SAFE_CALL(cudaEventDestroy(events_[i]));
+    CUDA_SAFE_CALL(cudaFreeHost(buffers_[i]));
+  }
+}
+
+void* PatchMatchCuda::SliceUploader::NextBuffer() {
+  CUDA_SAFE_CALL(cudaEventSynchronize(events_[buffer_idx_]));
+  return buffers_[buffer_idx_];
+}
+
+void PatchMatchCuda::SliceUploader::Upload(void* dst, const size_t dst_pitch,
+                                           const size_t row_num_bytes,
+                                           const size_t num_rows) {
+  CUDA_SAFE_CALL(cudaMemcpy2DAsync(dst, dst_pitch, buffers_[buffer_idx_],
+                                   row_num_bytes, row_num_bytes, num_rows,
+                                   cudaMemcpyHostToDevice, stream_));
+  CUDA_SAFE_CALL(cudaEventRecord(events_[buffer_idx_], stream_));
+  buffer_idx_ = 1 - buffer_idx_;
 }
 
 PatchMatchCuda::PatchMatchCuda(const PatchMatchOptions& options,
@@ -1140,16 +1669,22 @@ PatchMatchCuda::PatchMatchCuda(const PatchMatchOptions& options,
       ref_height_(0),
       rotation_in_half_pi_(0) {
   SetBestCudaDevice(std::stoi(options_.gpu_index));
-  InitRefImage();
+  CUDA_SAFE_CALL(
+      cudaStreamCreateWithFlags(&upload_stream_, cudaStreamNonBlocking));
+  // The source images and depth maps are uploaded asynchronously, while the
+  // reference image, the transformations, and the workspace are initialized.
   InitSourceImages();
+  InitRefImage();
   InitTransforms();
   InitWorkspaceMemory();
+  FinishSourceImagesUpload();
 }
 
 PatchMatchCuda::~PatchMatchCuda() {
   for (size_t i = 0; i < 4; ++i) {
     poses_device_[i].reset();
   }
+  CUDA_SAFE_CALL(cudaStreamDestroy(upload_stream_));
 }
 
 void PatchMatchCuda::Run() {
@@ -1207,7 +1742,7 @@ DepthMap PatchMatchCuda::GetDepthMap() const {
 }
 
 NormalMap PatchMatchCuda::GetNormalMap() const {
-  return NormalMap(normal_map_->CopyToMat());
+  return NormalMap(CopyFromState(*normal_map_));
 }
 
 Mat<float> PatchMatchCuda::GetSelProbMap() const {
@@ -1240,6 +1775,16 @@ std::vector<int> PatchMatchCuda::GetConsistentImageIdxs() const {
   return consistent_image_idxs;
 }
 
+Mat<uint8_t> PatchMatchCuda::GetConfidenceMap() const {
+  CHECK(options_.filter);
+  GpuMat<uint8_t> confidence_map(depth_map_->GetWidth(),
+                                 depth_map_->GetHeight(), 1);
+  ComputeConfidenceMap<<<elem_wise_grid_size_, elem_wise_block_size_>>>(
+      *consistency_mask_, confidence_map);
+  CUDA_SYNC_AND_CHECK();
+  return confidence_map.CopyToMat();
+}
+
 template <int kWindowSize, int kWindowStep>
 void PatchMatchCuda::RunWithWindowSizeAndStep() {
   // Wait for all initializations to finish.
@@ -1280,6 +1825,16 @@ void PatchMatchCuda::RunWithWindowSizeAndStep() {
   sweep_options.filter_geom_consistency_max_cost =
       options_.filter_geom_consistency_max_cost;
 
+  const float max_perturbation =
+      static_cast<float>(problem_.max_depth_perturbation);
+
+  if (options_.checkerboard_propagation) {
+    RunCheckerboardPropagation<kWindowSize, kWindowStep>(sweep_options,
+                                                         max_perturbation);
+    total_timer.Print("Total");
+    return;
+  }
+
   for (int iter = 0; iter < options_.num_iterations; ++iter) {
     CudaTimer iter_timer;
 
@@ -1287,7 +1842,8 @@ void PatchMatchCuda::RunWithWindowSizeAndStep() {
       CudaTimer sweep_timer;
 
       // Expenentially reduce amount of perturbation during the optimization.
-      sweep_options.perturbation = 1.0f / std::pow(2.0f, iter + sweep / 4.0f);
+      sweep_options.perturbation =
+          max_perturbation / std::pow(2.0f, iter + sweep / 4.0f);
 
       // Linearly increase the influence of previous selection probabilities.
       sweep_options.prev_sel_prob_weight =
@@ -1370,6 +1926,94 @@ void PatchMatchCuda::RunWithWindowSizeAndStep() {
   total_timer.Print("Total");
 }
 
+template <int kWindowSize, int kWindowStep>
+void PatchMatchCuda::RunCheckerboardPropagation(SweepOptions sweep_options,
+                                                const float max_perturbation) {
+  const float total_num_steps = options_.num_iterations * 2;
+
+  // The selection probabilities of the previous iteration are read from the
+  // selection probability map itself, since every pixel is updated once per
+  // iteration. The previous selection probability map is used to store the
+  // sampling probabilities instead.
+  sel_prob_map_->FillWithScalar(0.5f);
+
+  for (int iter = 0; iter < options_.num_iterations; ++iter) {
+    CudaTimer iter_timer;
+
+    const bool last_iter = iter == options_.num_iterations - 1;
+    if (last_iter && options_.filter) {
+      consistency_mask_.reset(new GpuMat<uint8_t>(cost_map_->GetWidth(),
+                                                  cost_map_->GetHeight(),
+                                                  cost_map_->GetDepth()));
+      consistency_mask_->FillWithScalar(0);
+    }
+
+    for (int color = 0; color < 2; ++color) {
+      // Expenentially reduce amount of perturbation during the optimization.
+      sweep_options.perturbation =
+          max_perturbation / std::pow(2.0f, iter + color / 2.0f);
+
+      // Linearly increase the influence of previous selection probabilities.
+      sweep_options.prev_sel_prob_weight =
+          static_cast<float>(iter * 2 + color) / total_num_steps;
+
+#define CALL_PROPAGATE_FUNC                                                   \
+  PropagateCheckerboard<kWindowSize, kWindowStep, kGeomConsistencyTerm,       \
+                        kFilterPhotoConsistency, kFilterGeomConsistency>      \
+      <<<checkerboard_grid_size_, checkerboard_block_size_>>>(                \
+          *prev_sel_prob_map_, *rand_state_map_, *cost_map_, *depth_map_,     \
+          *normal_map_, *consistency_mask_, *sel_prob_map_,                   \
+          *ref_image_->sum_image, *ref_image_->squared_sum_image, color,      \
+          sweep_options);
+
+      if (last_iter) {
+        if (options_.geom_consistency) {
+          const bool kGeomConsistencyTerm = true;
+          if (options_.filter) {
+            const bool kFilterPhotoConsistency = true;
+            const bool kFilterGeomConsistency = true;
+            CALL_PROPAGATE_FUNC
+          } else {
+            const bool kFilterPhotoConsistency = false;
+            const bool kFilterGeomConsistency = false;
+            CALL_PROPAGATE_FUNC
+          }
+        } else {
+          const bool kGeomConsistencyTerm = false;
+          if (options_.filter) {
+            const bool kFilterPhotoConsistency = true;
+            const bool kFilterGeomConsistency = false;
+            CALL_PROPAGATE_FUNC
+          } else {
+            const bool kFilterPhotoConsistency = false;
+            const bool kFilterGeomConsistency = false;
+            CALL_PROPAGATE_FUNC
+          }
+        }
+      } else {
+        const bool kFilterPhotoConsistency = false;
+        const bool kFilterGeomConsistency = false;
+        if (options_.geom_consistency) {
+          const bool kGeomConsistencyTerm = true;
+          CALL_PROPAGATE_FUNC
+        } else {
+          const bool kGeomConsistencyTerm = false;
+          CALL_PROPAGATE_FUNC
+        }
+      }
+
+#undef CALL_PROPAGATE_FUNC
+
+      CUDA_SYNC_AND_CHECK();
+    }
+
+    iter_timer.Print("Iteration " + std::to_string(iter + 1));
+  }
+
+  // The exported selection probabilities are read from the previous map.
+  prev_sel_prob_map_.swap(sel_prob_map_);
+}
+
 void PatchMatchCuda::ComputeCudaConfig() {
   sweep_block_size_.x = THREADS_PER_BLOCK;
   sweep_block_size_.y = 1;
@@ -1385,6 +2029,15 @@ void PatchMatchCuda::ComputeCudaConfig() {
   elem_wise_grid_size_.y =
       (depth_map_->GetHeight() - 1) / THREADS_PER_BLOCK + 1;
   elem_wise_grid_size_.z = 1;
+
+  checkerboard_block_size_.x = THREADS_PER_BLOCK;
+  checkerboard_block_size_.y = THREADS_PER_BLOCK / 4;
+  checkerboard_block_size_.z = 1;
+  checkerboard_grid_size_.x =
+      ((depth_map_->GetWidth() + 1) / 2 - 1) / checkerboard_block_size_.x + 1;
+  checkerboard_grid_size_.y =
+      (depth_map_->GetHeight() - 1) / checkerboard_block_size_.y + 1;
+  checkerboard_grid_size_.z = 1;
 }
 
 void PatchMatchCuda::InitRefImage() {
@@ -1429,28 +2082,57 @@ void PatchMatchCuda::InitSourceImages() {
     }
   }
 
+  const size_t num_src_images = problem_.src_image_idxs.size();
+
   // Upload source images to device.
   {
-    // Copy source images to contiguous memory block.
-    const uint8_t kDefaultValue = 0;
-    std::vector<uint8_t> src_images_host_data(
-        static_cast<size_t>(max_width * max_height *
-                            problem_.src_image_idxs.size()),
-        kDefaultValue);
-    for (size_t i = 0; i < problem_.src_image_idxs.size(); ++i) {
-      const Image& image = problem_.images->at(problem_.src_image_idxs[i]);
-      const Bitmap& bitmap = image.GetBitmap();
-      uint8_t* dest = src_images_host_data.data() + max_width * max_height * i;
-      for (size_t r = 0; r < image.GetHeight(); ++r) {
-        memcpy(dest, bitmap.GetScanline(r), image.GetWidth() * sizeof(uint8_t));
-        dest += max_width;
+    // Copy source images to the zero-padded slices of the staging matrix,
+    // either from the cache on the device or through pinned host memory.
+    src_images_staging_.reset(
+        new GpuMat<uint8_t>(max_width, max_height, num_src_images));
+    const size_t pitch = src_images_staging_->GetPitch();
+    char* staging_ptr = reinterpret_cast<char*>(src_images_staging_->GetPtr());
+    CUDA_SAFE_CALL(cudaMemset2DAsync(staging_ptr, pitch, 0,
+                                     max_width * sizeof(uint8_t),
+                                     max_height * num_src_images,
+                                     upload_stream_));
+
+    if (problem_.gpu_image_cache == nullptr) {
+      src_images_uploader_.reset(new SliceUploader(
+          max_width * max_height * sizeof(uint8_t), upload_stream_));
+    }
+
+    for (size_t i = 0; i < num_src_images; ++i) {
+      const int image_idx = problem_.src_image_idxs[i];
+      const Image& image = problem_.images->at(image_idx);
+      const size_t row_num_bytes = image.GetWidth() * sizeof(uint8_t);
+      char* dest = staging_ptr + pitch * max_height * i;
+      if (problem_.gpu_image_cache != nullptr) {
+        const GpuMat<uint8_t>& cached_image =
+            problem_.gpu_image_cache->Get(image_idx, image);
+        CUDA_SAFE_CALL(cudaMemcpy2DAsync(
+            dest, pitch, cached_image.GetPtr(), cached_image.GetPitch(),
+            row_num_bytes, image.GetHeight(), cudaMemcpyDeviceToDevice,
+            upload_stream_));
+        src_images_cached_.push_back(cached_image);
+      } else {
+        const Bitmap& bitmap = image.GetBitmap();
+        uint8_t* buffer =
+            static_cast<uint8_t*>(src_images_uploader_->NextBuffer());
+        for (size_t r = 0; r < image.GetHeight(); ++r) {
+          memcpy(buffer + r * image.GetWidth(), bitmap.GetScanline(r),
+                 row_num_bytes);
+        }
+        src_images_uploader_->Upload(dest, pitch, row_num_bytes,
+                                     image.GetHeight());
       }
     }
 
     // Upload to device.
     src_images_device_.reset(new CudaArrayWrapper<uint8_t>(
-        max_width, max_height, problem_.src_image_idxs.size()));
-    src_images_device_->CopyToDevice(src_images_host_data.data());
+        max_width, max_height, num_src_images));
+    src_images_device_->CopyFromGpuMatAsync(*src_images_staging_,
+                                            upload_stream_);
 
     // Create source images texture.
     src_images_texture.addressMode[0] = cudaAddressModeBorder;
@@ -1464,26 +2146,34 @@ void PatchMatchCuda::InitSourceImages() {
 
   // Upload source depth maps to device.
   if (options_.geom_consistency) {
-    const float kDefaultValue = 0.0f;
-    std::vector<float> src_depth_maps_host_data(
-        static_cast<size_t>(max_width * max_height *
-                            problem_.src_image_idxs.size()),
-        kDefaultValue);
-    for (size_t i = 0; i < problem_.src_image_idxs.size(); ++i) {
+    src_depth_maps_staging_.reset(
+        new GpuMat<float>(max_width, max_height, num_src_images));
+    const size_t pitch = src_depth_maps_staging_->GetPitch();
+    char* staging_ptr =
+        reinterpret_cast<char*>(src_depth_maps_staging_->GetPtr());
+    CUDA_SAFE_CALL(cudaMemset2DAsync(staging_ptr, pitch, 0,
+                                     max_width * sizeof(float),
+                                     max_height * num_src_images,
+                                     upload_stream_));
+
+    src_depth_maps_uploader_.reset(new SliceUploader(
+        max_width * max_height * sizeof(float), upload_stream_));
+
+    for (size_t i = 0; i < num_src_images; ++i) {
       const DepthMap& depth_map =
           problem_.depth_maps->at(problem_.src_image_idxs[i]);
-      float* dest =
-          src_depth_maps_host_data.data() + max_width * max_height * i;
-      for (size_t r = 0; r < depth_map.GetHeight(); ++r) {
-        memcpy(dest, depth_map.GetPtr() + r * depth_map.GetWidth(),
-               depth_map.GetWidth() * sizeof(float));
-        dest += max_width;
-      }
+      const size_t row_num_bytes = depth_map.GetWidth() * sizeof(float);
+      void* buffer = src_depth_maps_uploader_->NextBuffer();
+      memcpy(buffer, depth_map.GetPtr(), row_num_bytes * depth_map.GetHeight());
+      src_depth_maps_uploader_->Upload(staging_ptr + pitch * max_height * i,
+                                       pitch, row_num_bytes,
+                                       depth_map.GetHeight());
     }
 
     src_depth_maps_device_.reset(new CudaArrayWrapper<float>(
-        max_width, max_height, problem_.src_image_idxs.size()));
-    src_depth_maps_device_->CopyToDevice(src_depth_maps_host_data.data());
+        max_width, max_height, num_src_images));
+    src_depth_maps_device_->CopyFromGpuMatAsync(*src_depth_maps_staging_,
+                                                upload_stream_);
 
     // Create source depth maps texture.
     src_depth_maps_texture.addressMode[0] = cudaAddressModeBorder;
@@ -1497,6 +2187,15 @@ void PatchMatchCuda::InitSourceImages() {
   }
 }
 
+void PatchMatchCuda::FinishSourceImagesUpload() {
+  CUDA_SAFE_CALL(cudaStreamSynchronize(upload_stream_));
+  src_images_uploader_.reset();
+  src_depth_maps_uploader_.reset();
+  src_images_staging_.reset();
+  src_depth_maps_staging_.reset();
+  src_images_cached_.clear();
+}
+
 void PatchMatchCuda::InitTransforms() {
   const Image& ref_image = problem_.images->at(problem_.ref_image_idx);
 
@@ -1616,12 +2315,18 @@ void PatchMatchCuda::InitWorkspaceMemory() {
         problem_.depth_maps->at(problem_.ref_image_idx);
     depth_map_->CopyToDevice(init_depth_map.GetPtr(),
                              init_depth_map.GetWidth() * sizeof(float));
+  } else if (problem_.init_depth_map != nullptr) {
+    CHECK_EQ(problem_.init_depth_map->GetWidth(), ref_width_);
+    CHECK_EQ(problem_.init_depth_map->GetHeight(), ref_height_);
+    depth_map_->CopyToDevice(problem_.init_depth_map->GetPtr(),
+                             ref_width_ * sizeof(float));
   } else {
     depth_map_->FillWithRandomNumbers(options_.depth_min, options_.depth_max,
                                       *rand_state_map_);
   }
 
-  normal_map_.reset(new GpuMat<float>(ref_width_, ref_height_, 3));
+  normal_map_.reset(
+      new GpuMat<patch_match_state_t>(ref_width_, ref_height_, 3));
 
   // Note that it is not necessary to keep the selection probability map in
   // memory for all pixels. Theoretically, it is possible to incorporate
@@ -1634,8 +2339,8 @@ void PatchMatchCuda::InitWorkspaceMemory() {
                                              problem_.src_image_idxs.size()));
   prev_sel_prob_map_->FillWithScalar(0.5f);
 
-  cost_map_.reset(new GpuMat<float>(ref_width_, ref_height_,
-                                    problem_.src_image_idxs.size()));
+  cost_map_.reset(new GpuMat<patch_match_state_t>(
+      ref_width_, ref_height_, problem_.src_image_idxs.size()));
 
   const int ref_max_dim = std::max(ref_width_, ref_height_);
   global_workspace_.reset(
@@ -1648,8 +2353,11 @@ void PatchMatchCuda::InitWorkspaceMemory() {
   if (options_.geom_consistency) {
     const NormalMap& init_normal_map =
         problem_.normal_maps->at(problem_.ref_image_idx);
-    normal_map_->CopyToDevice(init_normal_map.GetPtr(),
-                              init_normal_map.GetWidth() * sizeof(float));
+    CopyToState(init_normal_map, normal_map_.get());
+  } else if (problem_.init_normal_map != nullptr) {
+    CHECK_EQ(problem_.init_normal_map->GetWidth(), ref_width_);
+    CHECK_EQ(problem_.init_normal_map->GetHeight(), ref_height_);
+    CopyToState(*problem_.init_normal_map, normal_map_.get());
   } else {
     InitNormalMap<<<elem_wise_grid_size_, elem_wise_block_size_>>>(
         *normal_map_, *rand_state_map_);
@@ -1689,8 +2397,8 @@ void PatchMatchCuda::Rotate() {
   {
     RotateNormalMap<<<elem_wise_grid_size_, elem_wise_block_size_>>>(
         *normal_map_);
-    std::unique_ptr<GpuMat<float>> rotated_normal_map(
-        new GpuMat<float>(width, height, 3));
+    std::unique_ptr<GpuMat<patch_match_state_t>> rotated_normal_map(
+        new GpuMat<patch_match_state_t>(width, height, 3));
     normal_map_->Rotate(rotated_normal_map.get());
     normal_map_.swap(rotated_normal_map);
   }
@@ -1722,8 +2430,9 @@ void PatchMatchCuda::Rotate() {
 
   // Rotate cost map.
   {
-    std::unique_ptr<GpuMat<float>> rotated_cost_map(
-        new GpuMat<float>(width, height, problem_.src_image_idxs.size()));
+    std::unique_ptr<GpuMat<patch_match_state_t>> rotated_cost_map(
+        new GpuMat<patch_match_state_t>(width, height,
+                                        problem_.src_image_idxs.size()));
     cost_map_->Rotate(rotated_cost_map.get());
     cost_map_.swap(rotated_cost_map);
   }
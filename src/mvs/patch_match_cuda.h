@@ -32,6 +32,7 @@
 #ifndef COLMAP_SRC_MVS_PATCH_MATCH_CUDA_H_
 #define COLMAP_SRC_MVS_PATCH_MATCH_CUDA_H_
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <vector>
@@ -46,10 +47,47 @@
 #include "mvs/image.h"
 #include "mvs/normal_map.h"
 #include "mvs/patch_match.h"
+#include "util/cache.h"
 
 namespace colmap {
 namespace mvs {
 
+// The scalar type in which the normals and matching costs of the per-pixel
+// state are stored on the device, while all arithmetic is performed in single
+// precision. Half precision, stored as its raw bits, reduces the memory traffic
+// of the bandwidth-bound sweeps, and is sufficiently accurate for unit normals
+// and the bounded NCC costs. The depths remain in single precision, since the
+// depth perturbations and the geometric consistency require a higher relative
+// precision than the 11 bits of the half precision significand.
+#ifdef HALF_PATCH_MATCH_ENABLED
+typedef uint16_t patch_match_state_t;
+#else
+typedef float patch_match_state_t;
+#endif
+
+// Cache of source images on the GPU, which are shared by the problems that are
+// processed on the same GPU, such that every image is only uploaded once. The
+// images are evicted in least-recently-used order. The cache must only be used
+// and destroyed by the thread of its GPU.
+class GpuSourceImageCache {
+ public:
+  explicit GpuSourceImageCache(const size_t max_num_bytes);
+
+  // Get the source image with the given index on the GPU, which is uploaded
+  // from the given image, if it is not yet cached.
+  const GpuMat<uint8_t>& Get(const int image_idx, const Image& image);
+
+ private:
+  struct CachedImage {
+    size_t NumBytes() const;
+    std::unique_ptr<GpuMat<uint8_t>> image;
+  };
+
+  MemoryConstrainedLRUCache<int, CachedImage> cache_;
+};
+
+struct SweepOptions;
+
 class PatchMatchCuda {
  public:
   PatchMatchCuda(const PatchMatchOptions& options,
@@ -62,18 +100,50 @@ class PatchMatchCuda {
   NormalMap GetNormalMap() const;
   Mat<float> GetSelProbMap() const;
   std::vector<int> GetConsistentImageIdxs() const;
+  // Number of source images in which each pixel is consistent. Only
+  // available if the depth map was filtered.
+  Mat<uint8_t> GetConfidenceMap() const;
 
  private:
   template <int kWindowSize, int kWindowStep>
   void RunWithWindowSizeAndStep();
 
+  // Optimize with the checkerboard propagation instead of the sweeps.
+  template <int kWindowSize, int kWindowStep>
+  void RunCheckerboardPropagation(SweepOptions sweep_options,
+                                  const float max_perturbation);
+
   void ComputeCudaConfig();
 
   void InitRefImage();
   void InitSourceImages();
+  void FinishSourceImagesUpload();
   void InitTransforms();
   void InitWorkspaceMemory();
 
+  // Uploads the slices of a matrix asynchronously through two pinned host
+  // buffers, such that the next slice is written to one buffer on the host,
+  // while the previous slice is transferred from the other buffer.
+  class SliceUploader {
+   public:
+    SliceUploader(const size_t max_slice_num_bytes, cudaStream_t stream);
+    ~SliceUploader();
+
+    // Get the host buffer for the next slice, once it is not used anymore by
+    // a previous transfer.
+    void* NextBuffer();
+
+    // Transfer the rows of the next buffer to the given device memory.
+    void Upload(void* dst, const size_t dst_pitch, const size_t row_num_bytes,
+                const size_t num_rows);
+
+   private:
+    cudaStream_t stream_;
+    void* buffers_[2];
+    cudaEvent_t events_[2];
+    int buffer_idx_;
+  };
+
   // Rotate reference image by 90 degrees in counter-clockwise direction.
   void Rotate();
 
@@ -86,6 +156,10 @@ class PatchMatchCuda {
   // Dimensions for element-wise operations, i.e. one thread per pixel.
   dim3 elem_wise_block_size_;
   dim3 elem_wise_grid_size_;
+  // Dimensions for checkerboard propagation, i.e. one thread per pixel of one
+  // color of the checkerboard.
+  dim3 checkerboard_block_size_;
+  dim3 checkerboard_grid_size_;
 
   // Original (not rotated) dimension of reference image.
   size_t ref_width_;
@@ -99,6 +173,17 @@ class PatchMatchCuda {
   std::unique_ptr<CudaArrayWrapper<uint8_t>> src_images_device_;
   std::unique_ptr<CudaArrayWrapper<float>> src_depth_maps_device_;
 
+  // Stream for the asynchronous upload of the source images and depth maps,
+  // which are staged in zero-padded matrices until the upload has finished.
+  cudaStream_t upload_stream_;
+  std::unique_ptr<SliceUploader> src_images_uploader_;
+  std::unique_ptr<SliceUploader> src_depth_maps_uploader_;
+  std::unique_ptr<GpuMat<uint8_t>> src_images_staging_;
+  std::unique_ptr<GpuMat<float>> src_depth_maps_staging_;
+  // Cached source images, which must remain allocated until the upload has
+  // finished, even if they are evicted from the cache in the meantime.
+  std::vector<GpuMat<uint8_t>> src_images_cached_;
+
   // Relative poses from rotated versions of reference image to source images
   // corresponding to _rotationInHalfPi:
   //
@@ -123,10 +208,10 @@ class PatchMatchCuda {
   // Data for reference image.
   std::unique_ptr<GpuMatRefImage> ref_image_;
   std::unique_ptr<GpuMat<float>> depth_map_;
-  std::unique_ptr<GpuMat<float>> normal_map_;
+  std::unique_ptr<GpuMat<patch_match_state_t>> normal_map_;
   std::unique_ptr<GpuMat<float>> sel_prob_map_;
   std::unique_ptr<GpuMat<float>> prev_sel_prob_map_;
-  std::unique_ptr<GpuMat<float>> cost_map_;
+  std::unique_ptr<GpuMat<patch_match_state_t>> cost_map_;
   std::unique_ptr<GpuMatPRNG> rand_state_map_;
   std::unique_ptr<GpuMat<uint8_t>> consistency_mask_;
 
@@ -31,8 +31,11 @@
 
 #include "mvs/workspace.h"
 
+#include <algorithm>
 #include <numeric>
+#include <unordered_set>
 
+#include "base/camera_models.h"
 #include "util/misc.h"
 
 namespace colmap {
@@ -45,6 +48,10 @@ Workspace::CachedImage::CachedImage(CachedImage&& other) {
   bitmap = std::move(other.bitmap);
   depth_map = std::move(other.depth_map);
   normal_map = std::move(other.normal_map);
+  compact_depth_map = std::move(other.compact_depth_map);
+  compact_normal_map = std::move(other.compact_normal_map);
+  mapped_depth_map = std::move(other.mapped_depth_map);
+  mapped_normal_map = std::move(other.mapped_normal_map);
 }
 
 Workspace::CachedImage& Workspace::CachedImage::operator=(CachedImage&& other) {
@@ -53,6 +60,10 @@ Workspace::CachedImage& Workspace::CachedImage::operator=(CachedImage&& other) {
     bitmap = std::move(other.bitmap);
     depth_map = std::move(other.depth_map);
     normal_map = std::move(other.normal_map);
+    compact_depth_map = std::move(other.compact_depth_map);
+    compact_normal_map = std::move(other.compact_normal_map);
+    mapped_depth_map = std::move(other.mapped_depth_map);
+    mapped_normal_map = std::move(other.mapped_normal_map);
   }
   return *this;
 }
@@ -61,10 +72,21 @@ size_t Workspace::CachedImage::NumBytes() const { return num_bytes; }
 
 Workspace::Workspace(const Options& options)
     : options_(options),
-      cache_(1024 * 1024 * 1024 * options_.cache_size,
-             [](const int) { return CachedImage(); }) {
+      cache_(1024.0 * 1024.0 * 1024.0 *
+                 (options_.cache_size - options_.prefetch_size),
+             [](const int) { return CachedImage(); }),
+      max_prefetch_num_bytes_(static_cast<size_t>(1024.0 * 1024.0 * 1024.0 *
+                                                  options_.prefetch_size)),
+      memory_component_(
+          "workspace_cache", [this]() { return NumBytes(); },
+          [this](const size_t num_bytes) { ShrinkCache(num_bytes); }) {
+  CHECK_GE(options_.prefetch_size, 0);
+  CHECK_LT(options_.prefetch_size, options_.cache_size);
   StringToLower(&options_.input_type);
   model_.Read(options_.workspace_path, options_.workspace_format);
+  if (!options_.distorted_image_path.empty()) {
+    SetupUndistortion();
+  }
   if (options_.max_image_size > 0) {
     for (auto& image : model_.images) {
       image.Downsize(options_.max_image_size, options_.max_image_size);
@@ -75,23 +97,88 @@ Workspace::Workspace(const Options& options)
       JoinPaths(options_.workspace_path, options_.stereo_folder, "depth_maps"));
   normal_map_path_ = EnsureTrailingSlash(JoinPaths(
       options_.workspace_path, options_.stereo_folder, "normal_maps"));
+  confidence_map_path_ = EnsureTrailingSlash(JoinPaths(
+      options_.workspace_path, options_.stereo_folder, "confidence_maps"));
+
+  metrics_gauges_.Add("workspace_cache_bytes",
+                      [this]() { return cache_.NumBytes(); });
+  metrics_gauges_.Add("workspace_prefetch_bytes", [this]() {
+    std::unique_lock<std::mutex> lock(prefetch_mutex_);
+    return prefetch_num_bytes_;
+  });
+}
+
+Workspace::~Workspace() {
+  {
+    std::unique_lock<std::mutex> lock(prefetch_mutex_);
+    prefetch_stopped_ = true;
+  }
+  prefetch_condition_.notify_all();
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
 }
 
 void Workspace::ClearCache() { cache_.Clear(); }
 
+void Workspace::Prefetch(const std::vector<int>& image_idxs,
+                         const bool bitmaps, const bool depth_maps,
+                         const bool normal_maps) {
+  CHECK_GT(max_prefetch_num_bytes_, 0);
+
+  {
+    std::unique_lock<std::mutex> lock(prefetch_mutex_);
+
+    prefetch_bitmaps_ = bitmaps;
+    prefetch_depth_maps_ = depth_maps;
+    prefetch_normal_maps_ = normal_maps;
+
+    const std::unordered_set<int> planned_image_idxs(image_idxs.begin(),
+                                                     image_idxs.end());
+    for (auto it = prefetched_images_.begin();
+         it != prefetched_images_.end();) {
+      if (planned_image_idxs.count(it->first) == 0) {
+        prefetch_num_bytes_ -= it->second.num_bytes;
+        it = prefetched_images_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    prefetch_plan_.clear();
+    for (const int image_idx : image_idxs) {
+      if (!cache_.Exists(image_idx) &&
+          prefetched_images_.count(image_idx) == 0 &&
+          image_idx != prefetching_image_idx_) {
+        prefetch_plan_.push_back(image_idx);
+      }
+    }
+
+    if (!prefetch_thread_.joinable()) {
+      prefetch_thread_ = std::thread(&Workspace::PrefetchFunc, this);
+    }
+  }
+
+  prefetch_condition_.notify_all();
+}
+
+void Workspace::SetCacheEvictionRankFunc(
+    const std::function<size_t(const int&)>& eviction_rank_func) {
+  cache_.SetEvictionRankFunc(eviction_rank_func);
+}
+
 const Workspace::Options& Workspace::GetOptions() const { return options_; }
 
 const Model& Workspace::GetModel() const { return model_; }
 
 const Bitmap& Workspace::GetBitmap(const int image_idx) {
+  memory_component_.Update();
   auto& cached_image = cache_.GetMutable(image_idx);
   if (!cached_image.bitmap) {
-    cached_image.bitmap.reset(new Bitmap());
-    cached_image.bitmap->Read(GetBitmapPath(image_idx), options_.image_as_rgb);
-    if (options_.max_image_size > 0) {
-      cached_image.bitmap->Rescale(model_.images.at(image_idx).GetWidth(),
-                                   model_.images.at(image_idx).GetHeight());
-    }
+    TakePrefetchedImage(image_idx, &cached_image);
+  }
+  if (!cached_image.bitmap) {
+    cached_image.bitmap = ReadBitmap(image_idx);
     cached_image.num_bytes += cached_image.bitmap->NumBytes();
     cache_.UpdateNumBytes(image_idx);
   }
@@ -99,14 +186,13 @@ const Bitmap& Workspace::GetBitmap(const int image_idx) {
 }
 
 const DepthMap& Workspace::GetDepthMap(const int image_idx) {
+  memory_component_.Update();
   auto& cached_image = cache_.GetMutable(image_idx);
   if (!cached_image.depth_map) {
-    cached_image.depth_map.reset(new DepthMap());
-    cached_image.depth_map->Read(GetDepthMapPath(image_idx));
-    if (options_.max_image_size > 0) {
-      cached_image.depth_map->Downsize(model_.images.at(image_idx).GetWidth(),
-                                       model_.images.at(image_idx).GetHeight());
-    }
+    TakePrefetchedImage(image_idx, &cached_image);
+  }
+  if (!cached_image.depth_map) {
+    cached_image.depth_map = ReadDepthMap(image_idx);
     cached_image.num_bytes += cached_image.depth_map->GetNumBytes();
     cache_.UpdateNumBytes(image_idx);
   }
@@ -114,22 +200,86 @@ const DepthMap& Workspace::GetDepthMap(const int image_idx) {
 }
 
 const NormalMap& Workspace::GetNormalMap(const int image_idx) {
+  memory_component_.Update();
   auto& cached_image = cache_.GetMutable(image_idx);
   if (!cached_image.normal_map) {
-    cached_image.normal_map.reset(new NormalMap());
-    cached_image.normal_map->Read(GetNormalMapPath(image_idx));
-    if (options_.max_image_size > 0) {
-      cached_image.normal_map->Downsize(
-          model_.images.at(image_idx).GetWidth(),
-          model_.images.at(image_idx).GetHeight());
-    }
+    TakePrefetchedImage(image_idx, &cached_image);
+  }
+  if (!cached_image.normal_map) {
+    cached_image.normal_map = ReadNormalMap(image_idx);
     cached_image.num_bytes += cached_image.normal_map->GetNumBytes();
     cache_.UpdateNumBytes(image_idx);
   }
   return *cached_image.normal_map;
 }
 
+const CompactDepthMap& Workspace::GetCompactDepthMap(const int image_idx) {
+  memory_component_.Update();
+  auto& cached_image = cache_.GetMutable(image_idx);
+  if (!cached_image.compact_depth_map) {
+    DepthMap depth_map;
+    depth_map.Read(GetDepthMapPath(image_idx));
+    if (options_.max_image_size > 0) {
+      depth_map.Downsize(model_.images.at(image_idx).GetWidth(),
+                         model_.images.at(image_idx).GetHeight());
+    }
+    cached_image.compact_depth_map.reset(new CompactDepthMap(depth_map));
+    cached_image.num_bytes += cached_image.compact_depth_map->GetNumBytes();
+    cache_.UpdateNumBytes(image_idx);
+  }
+  return *cached_image.compact_depth_map;
+}
+
+const CompactNormalMap& Workspace::GetCompactNormalMap(const int image_idx) {
+  memory_component_.Update();
+  auto& cached_image = cache_.GetMutable(image_idx);
+  if (!cached_image.compact_normal_map) {
+    NormalMap normal_map;
+    normal_map.Read(GetNormalMapPath(image_idx));
+    if (options_.max_image_size > 0) {
+      normal_map.Downsize(model_.images.at(image_idx).GetWidth(),
+                          model_.images.at(image_idx).GetHeight());
+    }
+    cached_image.compact_normal_map.reset(new CompactNormalMap(normal_map));
+    cached_image.num_bytes += cached_image.compact_normal_map->GetNumBytes();
+    cache_.UpdateNumBytes(image_idx);
+  }
+  return *cached_image.compact_normal_map;
+}
+
+const MappedMat<float>& Workspace::GetMappedDepthMap(const int image_idx) {
+  CHECK_LE(options_.max_image_size, 0);
+  memory_component_.Update();
+  auto& cached_image = cache_.GetMutable(image_idx);
+  if (!cached_image.mapped_depth_map) {
+    cached_image.mapped_depth_map.reset(new MappedMat<float>());
+    cached_image.mapped_depth_map->Read(GetDepthMapPath(image_idx));
+    CHECK_EQ(cached_image.mapped_depth_map->GetDepth(), 1);
+    cached_image.num_bytes += cached_image.mapped_depth_map->GetNumBytes();
+    cache_.UpdateNumBytes(image_idx);
+  }
+  return *cached_image.mapped_depth_map;
+}
+
+const MappedMat<float>& Workspace::GetMappedNormalMap(const int image_idx) {
+  CHECK_LE(options_.max_image_size, 0);
+  memory_component_.Update();
+  auto& cached_image = cache_.GetMutable(image_idx);
+  if (!cached_image.mapped_normal_map) {
+    cached_image.mapped_normal_map.reset(new MappedMat<float>());
+    cached_image.mapped_normal_map->Read(GetNormalMapPath(image_idx));
+    CHECK_EQ(cached_image.mapped_normal_map->GetDepth(), 3);
+    cached_image.num_bytes += cached_image.mapped_normal_map->GetNumBytes();
+    cache_.UpdateNumBytes(image_idx);
+  }
+  return *cached_image.mapped_normal_map;
+}
+
 std::string Workspace::GetBitmapPath(const int image_idx) const {
+  if (undistortion_maps_) {
+    return JoinPaths(options_.distorted_image_path,
+                     model_.GetImageName(image_idx));
+  }
   return model_.images.at(image_idx).GetPath();
 }
 
@@ -141,6 +291,10 @@ std::string Workspace::GetNormalMapPath(const int image_idx) const {
   return normal_map_path_ + GetFileName(image_idx);
 }
 
+std::string Workspace::GetConfidenceMapPath(const int image_idx) const {
+  return confidence_map_path_ + GetFileName(image_idx);
+}
+
 bool Workspace::HasBitmap(const int image_idx) const {
   return ExistsFile(GetBitmapPath(image_idx));
 }
@@ -153,12 +307,217 @@ bool Workspace::HasNormalMap(const int image_idx) const {
   return ExistsFile(GetNormalMapPath(image_idx));
 }
 
+bool Workspace::HasConfidenceMap(const int image_idx) const {
+  return ExistsFile(GetConfidenceMapPath(image_idx));
+}
+
 std::string Workspace::GetFileName(const int image_idx) const {
   const auto& image_name = model_.GetImageName(image_idx);
   return StringPrintf("%s.%s.bin", image_name.c_str(),
                       options_.input_type.c_str());
 }
 
+void Workspace::SetupUndistortion() {
+  auto workspace_format_lower_case = options_.workspace_format;
+  StringToLower(&workspace_format_lower_case);
+  CHECK_EQ(workspace_format_lower_case, "colmap")
+      << "Undistorting the images on the fly requires a COLMAP workspace";
+
+  Reconstruction distorted_reconstruction;
+  distorted_reconstruction.Read(
+      JoinPaths(options_.workspace_path, "sparse", "distorted"));
+
+  // The undistorted cameras are derived from the not yet downsized images of
+  // the model, such that the undistortion maps produce the same images as
+  // the COLMAP undistorter.
+  image_camera_ids_.resize(model_.images.size());
+  for (size_t image_idx = 0; image_idx < model_.images.size(); ++image_idx) {
+    const auto* distorted_image = distorted_reconstruction.FindImageWithName(
+        model_.GetImageName(image_idx));
+    CHECK(distorted_image != nullptr)
+        << "Distorted model misses image " << model_.GetImageName(image_idx);
+    const camera_t camera_id = distorted_image->CameraId();
+    image_camera_ids_[image_idx] = camera_id;
+    if (undistortion_cameras_.count(camera_id) > 0) {
+      continue;
+    }
+
+    const auto& image = model_.images[image_idx];
+    const float* K = image.GetK();
+    Camera undistorted_camera;
+    undistorted_camera.SetModelId(PinholeCameraModel::model_id);
+    undistorted_camera.SetWidth(image.GetWidth());
+    undistorted_camera.SetHeight(image.GetHeight());
+    undistorted_camera.SetParams({K[0], K[4], K[2], K[5]});
+    undistortion_cameras_.emplace(
+        camera_id, std::make_pair(distorted_reconstruction.Camera(camera_id),
+                                  undistorted_camera));
+  }
+
+  // The maps are computed as the images are read, where concurrent reads of
+  // the same camera wait for a single computation. At least one map per
+  // reading thread should fit into the cache.
+  const size_t kMaxNumUndistortionMaps = 8;
+  undistortion_maps_.reset(new UndistortionMapCache(
+      kMaxNumUndistortionMaps, kMaxNumUndistortionMaps,
+      [this](const camera_t camera_id) {
+        const auto& cameras = undistortion_cameras_.at(camera_id);
+        return UndistortionMap{cameras.second,
+                               CameraWarpMap(cameras.first, cameras.second)};
+      }));
+}
+
+std::unique_ptr<Bitmap> Workspace::ReadBitmap(const int image_idx) const {
+  std::unique_ptr<Bitmap> bitmap(new Bitmap());
+  bitmap->Read(GetBitmapPath(image_idx), options_.image_as_rgb);
+  if (undistortion_maps_) {
+    const std::shared_ptr<const UndistortionMap> undistortion_map =
+        undistortion_maps_->Get(image_camera_ids_.at(image_idx));
+    std::unique_ptr<Bitmap> undistorted_bitmap(new Bitmap());
+    UndistortImage(*undistortion_map, *bitmap, undistorted_bitmap.get());
+    bitmap = std::move(undistorted_bitmap);
+  }
+  if (options_.max_image_size > 0) {
+    bitmap->Rescale(model_.images.at(image_idx).GetWidth(),
+                    model_.images.at(image_idx).GetHeight());
+  }
+  return bitmap;
+}
+
+std::unique_ptr<DepthMap> Workspace::ReadDepthMap(const int image_idx) const {
+  std::unique_ptr<DepthMap> depth_map(new DepthMap());
+  depth_map->Read(GetDepthMapPath(image_idx));
+  if (options_.max_image_size > 0) {
+    depth_map->Downsize(model_.images.at(image_idx).GetWidth(),
+                        model_.images.at(image_idx).GetHeight());
+  }
+  return depth_map;
+}
+
+std::unique_ptr<NormalMap> Workspace::ReadNormalMap(
+    const int image_idx) const {
+  std::unique_ptr<NormalMap> normal_map(new NormalMap());
+  normal_map->Read(GetNormalMapPath(image_idx));
+  if (options_.max_image_size > 0) {
+    normal_map->Downsize(model_.images.at(image_idx).GetWidth(),
+                         model_.images.at(image_idx).GetHeight());
+  }
+  return normal_map;
+}
+
+void Workspace::TakePrefetchedImage(const int image_idx,
+                                    CachedImage* cached_image) {
+  if (max_prefetch_num_bytes_ == 0) {
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(prefetch_mutex_);
+
+    // The image is read synchronously, if it was not prefetched yet.
+    prefetch_plan_.erase(
+        std::remove(prefetch_plan_.begin(), prefetch_plan_.end(), image_idx),
+        prefetch_plan_.end());
+
+    prefetch_condition_.wait(
+        lock, [&]() { return prefetching_image_idx_ != image_idx; });
+
+    const auto it = prefetched_images_.find(image_idx);
+    if (it == prefetched_images_.end()) {
+      return;
+    }
+
+    auto& prefetched_image = it->second;
+    if (prefetched_image.bitmap && !cached_image->bitmap) {
+      cached_image->num_bytes += prefetched_image.bitmap->NumBytes();
+      cached_image->bitmap = std::move(prefetched_image.bitmap);
+    }
+    if (prefetched_image.depth_map && !cached_image->depth_map) {
+      cached_image->num_bytes += prefetched_image.depth_map->GetNumBytes();
+      cached_image->depth_map = std::move(prefetched_image.depth_map);
+    }
+    if (prefetched_image.normal_map && !cached_image->normal_map) {
+      cached_image->num_bytes += prefetched_image.normal_map->GetNumBytes();
+      cached_image->normal_map = std::move(prefetched_image.normal_map);
+    }
+
+    prefetch_num_bytes_ -= prefetched_image.num_bytes;
+    prefetched_images_.erase(it);
+  }
+
+  prefetch_condition_.notify_all();
+
+  cache_.UpdateNumBytes(image_idx);
+}
+
+void Workspace::PrefetchFunc() {
+  while (true) {
+    int image_idx;
+    bool bitmaps;
+    bool depth_maps;
+    bool normal_maps;
+
+    {
+      std::unique_lock<std::mutex> lock(prefetch_mutex_);
+      prefetch_condition_.wait(lock, [this]() {
+        return prefetch_stopped_ ||
+               (!prefetch_plan_.empty() &&
+                prefetch_num_bytes_ < max_prefetch_num_bytes_);
+      });
+
+      if (prefetch_stopped_) {
+        return;
+      }
+
+      image_idx = prefetch_plan_.front();
+      prefetch_plan_.pop_front();
+      prefetching_image_idx_ = image_idx;
+      bitmaps = prefetch_bitmaps_;
+      depth_maps = prefetch_depth_maps_;
+      normal_maps = prefetch_normal_maps_;
+    }
+
+    PrefetchedImage prefetched_image;
+    if (bitmaps && HasBitmap(image_idx)) {
+      prefetched_image.bitmap = ReadBitmap(image_idx);
+      prefetched_image.num_bytes += prefetched_image.bitmap->NumBytes();
+    }
+    if (depth_maps && HasDepthMap(image_idx)) {
+      prefetched_image.depth_map = ReadDepthMap(image_idx);
+      prefetched_image.num_bytes += prefetched_image.depth_map->GetNumBytes();
+    }
+    if (normal_maps && HasNormalMap(image_idx)) {
+      prefetched_image.normal_map = ReadNormalMap(image_idx);
+      prefetched_image.num_bytes += prefetched_image.normal_map->GetNumBytes();
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(prefetch_mutex_);
+      prefetching_image_idx_ = -1;
+      if (prefetched_images_.count(image_idx) == 0) {
+        prefetch_num_bytes_ += prefetched_image.num_bytes;
+        prefetched_images_.emplace(image_idx, std::move(prefetched_image));
+      }
+    }
+
+    prefetch_condition_.notify_all();
+  }
+}
+
+size_t Workspace::NumBytes() {
+  std::unique_lock<std::mutex> lock(prefetch_mutex_);
+  return cache_.NumBytes() + prefetch_num_bytes_;
+}
+
+void Workspace::ShrinkCache(const size_t num_bytes) {
+  const size_t num_cached_bytes = cache_.NumBytes();
+  const size_t target_num_bytes =
+      num_cached_bytes - std::min(num_bytes, num_cached_bytes);
+  while (cache_.NumElems() > 0 && cache_.NumBytes() > target_num_bytes) {
+    cache_.Pop();
+  }
+}
+
 void ImportPMVSWorkspace(const Workspace& workspace,
                          const std::string& option_name) {
   const std::string& workspace_path = workspace.GetOptions().workspace_path;
@@ -169,6 +528,8 @@ void ImportPMVSWorkspace(const Workspace& workspace,
   CreateDirIfNotExists(JoinPaths(workspace_path, stereo_folder, "normal_maps"));
   CreateDirIfNotExists(
       JoinPaths(workspace_path, stereo_folder, "consistency_graphs"));
+  CreateDirIfNotExists(
+      JoinPaths(workspace_path, stereo_folder, "confidence_maps"));
 
   const auto option_lines =
       ReadTextFileLines(JoinPaths(workspace_path, option_name));
@@ -32,12 +32,22 @@
 #ifndef COLMAP_SRC_MVS_WORKSPACE_H_
 #define COLMAP_SRC_MVS_WORKSPACE_H_
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "base/undistortion.h"
 #include "mvs/consistency_graph.h"
 #include "mvs/depth_map.h"
+#include "mvs/mapped_mat.h"
 #include "mvs/model.h"
 #include "mvs/normal_map.h"
 #include "util/bitmap.h"
 #include "util/cache.h"
+#include "util/memory_accountant.h"
+#include "util/metrics.h"
 
 namespace colmap {
 namespace mvs {
@@ -48,6 +58,11 @@ class Workspace {
     // The maximum cache size in gigabytes.
     double cache_size = 32.0;
 
+    // The maximum size in gigabytes of the prefetched data that was not yet
+    // accessed. This is part of the cache size and prefetching is disabled,
+    // if it is zero.
+    double prefetch_size = 0.0;
+
     // Maximum image size in either dimension.
     int max_image_size = -1;
 
@@ -59,12 +74,35 @@ class Workspace {
     std::string workspace_format;
     std::string input_type;
     std::string stereo_folder = "stereo";
+
+    // If not empty, the original distorted images are read from this path
+    // and undistorted as they are loaded, instead of reading the undistorted
+    // images of the workspace. The distorted cameras are read from the
+    // `sparse/distorted` folder of the workspace, as written by the COLMAP
+    // undistorter for `image_encoding=NONE`. Only supported for workspaces in
+    // the COLMAP format.
+    std::string distorted_image_path;
   };
 
   Workspace(const Options& options);
+  ~Workspace();
 
   void ClearCache();
 
+  // Asynchronously read the data of the given images in the given order by a
+  // background thread, such that subsequent accesses do not wait for I/O. The
+  // images in the cache are skipped. A new plan replaces the remaining
+  // previous plan and discards the prefetched images that are not part of it.
+  // The compact and memory mapped maps are not prefetched.
+  void Prefetch(const std::vector<int>& image_idxs, const bool bitmaps,
+                const bool depth_maps, const bool normal_maps);
+
+  // Set a function that ranks the cached images for eviction, where images
+  // with a higher rank are evicted first. This can be used to evict the images
+  // by the time of their next use, if the access order is known in advance.
+  void SetCacheEvictionRankFunc(
+      const std::function<size_t(const int&)>& eviction_rank_func);
+
   const Options& GetOptions() const;
 
   const Model& GetModel() const;
@@ -72,19 +110,41 @@ class Workspace {
   const DepthMap& GetDepthMap(const int image_idx);
   const NormalMap& GetNormalMap(const int image_idx);
 
-  // Get paths to bitmap, depth map, normal map and consistency graph.
+  // Get the depth and normal maps in the compact representation, which are
+  // cached separately from the full precision maps and consume less memory.
+  const CompactDepthMap& GetCompactDepthMap(const int image_idx);
+  const CompactNormalMap& GetCompactNormalMap(const int image_idx);
+
+  // Get the memory mapped depth and normal maps, which are only read from disk
+  // as they are accessed and which share the page cache with other processes.
+  // The maps must be stored in the full precision format and they cannot be
+  // downsized, i.e., `max_image_size` must not be set.
+  const MappedMat<float>& GetMappedDepthMap(const int image_idx);
+  const MappedMat<float>& GetMappedNormalMap(const int image_idx);
+
+  // Get paths to bitmap, depth map, normal map and confidence map.
   std::string GetBitmapPath(const int image_idx) const;
   std::string GetDepthMapPath(const int image_idx) const;
   std::string GetNormalMapPath(const int image_idx) const;
+  std::string GetConfidenceMapPath(const int image_idx) const;
 
-  // Return whether bitmap, depth map, normal map, and consistency graph exist.
+  // Return whether bitmap, depth map, normal map, and confidence map exist.
   bool HasBitmap(const int image_idx) const;
   bool HasDepthMap(const int image_idx) const;
   bool HasNormalMap(const int image_idx) const;
+  bool HasConfidenceMap(const int image_idx) const;
 
  private:
   std::string GetFileName(const int image_idx) const;
 
+  // Read the distorted cameras for undistorting the images on the fly.
+  void SetupUndistortion();
+
+  // Read the data of an image and resize it to the maximum image size.
+  std::unique_ptr<Bitmap> ReadBitmap(const int image_idx) const;
+  std::unique_ptr<DepthMap> ReadDepthMap(const int image_idx) const;
+  std::unique_ptr<NormalMap> ReadNormalMap(const int image_idx) const;
+
   class CachedImage {
    public:
     CachedImage();
@@ -95,16 +155,62 @@ class Workspace {
     std::unique_ptr<Bitmap> bitmap;
     std::unique_ptr<DepthMap> depth_map;
     std::unique_ptr<NormalMap> normal_map;
+    std::unique_ptr<CompactDepthMap> compact_depth_map;
+    std::unique_ptr<CompactNormalMap> compact_normal_map;
+    std::unique_ptr<MappedMat<float>> mapped_depth_map;
+    std::unique_ptr<MappedMat<float>> mapped_normal_map;
 
    private:
     NON_COPYABLE(CachedImage)
   };
 
+  struct PrefetchedImage {
+    size_t num_bytes = 0;
+    std::unique_ptr<Bitmap> bitmap;
+    std::unique_ptr<DepthMap> depth_map;
+    std::unique_ptr<NormalMap> normal_map;
+  };
+
+  // Move the prefetched data of an image into the cached image, if it is not
+  // cached yet. Waits for the image, if it is currently prefetched.
+  void TakePrefetchedImage(const int image_idx, CachedImage* cached_image);
+
+  void PrefetchFunc();
+
+  // The memory usage of the cached and prefetched data and the eviction of
+  // the least recently used images, if the memory budget is approached.
+  size_t NumBytes();
+  void ShrinkCache(const size_t num_bytes);
+
   Options options_;
   Model model_;
   MemoryConstrainedLRUCache<int, CachedImage> cache_;
   std::string depth_map_path_;
   std::string normal_map_path_;
+  std::string confidence_map_path_;
+
+  // The camera of each image and the distorted and undistorted cameras, if
+  // the images are undistorted on the fly. The undistortion maps are shared by
+  // all images of the same camera.
+  std::vector<camera_t> image_camera_ids_;
+  std::unordered_map<camera_t, std::pair<Camera, Camera>> undistortion_cameras_;
+  std::unique_ptr<UndistortionMapCache> undistortion_maps_;
+
+  std::thread prefetch_thread_;
+  std::mutex prefetch_mutex_;
+  std::condition_variable prefetch_condition_;
+  bool prefetch_stopped_ = false;
+  bool prefetch_bitmaps_ = false;
+  bool prefetch_depth_maps_ = false;
+  bool prefetch_normal_maps_ = false;
+  std::deque<int> prefetch_plan_;
+  int prefetching_image_idx_ = -1;
+  size_t prefetch_num_bytes_ = 0;
+  size_t max_prefetch_num_bytes_ = 0;
+  std::unordered_map<int, PrefetchedImage> prefetched_images_;
+
+  ScopedMetricsGauges metrics_gauges_;
+  ScopedMemoryComponent memory_component_;
 };
 
 // Import a PMVS workspace into the COLMAP workspace format. Only images in the
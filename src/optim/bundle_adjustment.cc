@@ -40,11 +40,231 @@
 #include "base/camera_models.h"
 #include "base/cost_functions.h"
 #include "base/projection.h"
+#include "base/scene_clustering.h"
+#ifdef CUDA_ENABLED
+#include "util/cuda.h"
+#endif
+#include "util/gpu_scheduler.h"
 #include "util/misc.h"
+#include "util/profiling.h"
 #include "util/threading.h"
 #include "util/timer.h"
 
 namespace colmap {
+namespace {
+
+template <typename T>
+bool HaveCommonElements(const std::unordered_set<T>& set1,
+                        const std::unordered_set<T>& set2) {
+  const auto& smaller_set = set1.size() < set2.size() ? set1 : set2;
+  const auto& larger_set = set1.size() < set2.size() ? set2 : set1;
+  for (const T& elem : smaller_set) {
+    if (larger_set.count(elem) > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Record the images and 3D points whose parameters may have been changed by
+// the bundle adjustment of the given configuration, see
+// `Reconstruction::ReadChanges`.
+void MarkAdjustedAsModified(const BundleAdjustmentConfig& config,
+                            Reconstruction* reconstruction) {
+  if (config.NumImages() == reconstruction->NumRegImages()) {
+    reconstruction->MarkAllModified();
+    return;
+  }
+
+  for (const image_t image_id : config.Images()) {
+    reconstruction->MarkImageModified(image_id);
+    for (const Point2D& point2D : reconstruction->Image(image_id).Points2D()) {
+      if (point2D.HasPoint3D()) {
+        reconstruction->MarkPoint3DModified(point2D.Point3DId());
+      }
+    }
+  }
+
+  for (const point3D_t point3D_id : config.VariablePoints()) {
+    reconstruction->MarkPoint3DModified(point3D_id);
+  }
+}
+
+// The indices of the camera parameters that are held constant due to the
+// refined parameter groups of the options.
+std::vector<int> GetConstantCameraParamIdxs(
+    const BundleAdjustmentOptions& options, const Camera& camera) {
+  std::vector<int> const_camera_params;
+  if (!options.refine_focal_length) {
+    const std::vector<size_t>& params_idxs = camera.FocalLengthIdxs();
+    const_camera_params.insert(const_camera_params.end(), params_idxs.begin(),
+                               params_idxs.end());
+  }
+  if (!options.refine_principal_point) {
+    const std::vector<size_t>& params_idxs = camera.PrincipalPointIdxs();
+    const_camera_params.insert(const_camera_params.end(), params_idxs.begin(),
+                               params_idxs.end());
+  }
+  if (!options.refine_extra_params) {
+    const std::vector<size_t>& params_idxs = camera.ExtraParamsIdxs();
+    const_camera_params.insert(const_camera_params.end(), params_idxs.begin(),
+                               params_idxs.end());
+  }
+  return const_camera_params;
+}
+
+// Solve the problem of a group of images, whose observed 3D points are all
+// constant, and which exclusively own their poses and refined cameras. The 3D
+// points and cameras are copied, since they may be shared with the problems of
+// other groups that are solved in parallel.
+bool SolveConstantStructureProblem(const BundleAdjustmentOptions& options,
+                                   const BundleAdjustmentConfig& config,
+                                   const std::vector<image_t>& image_ids,
+                                   Reconstruction* reconstruction,
+                                   ceres::Solver::Summary* summary) {
+  const bool constant_camera = !options.refine_focal_length &&
+                               !options.refine_principal_point &&
+                               !options.refine_extra_params;
+
+  size_t num_observations = 0;
+  for (const image_t image_id : image_ids) {
+    num_observations += reconstruction->Image(image_id).NumPoints3D();
+  }
+
+  std::vector<Eigen::Vector3d> points3D;
+  points3D.reserve(num_observations);
+  std::unordered_map<camera_t, std::vector<double>> camera_params;
+
+  ceres::Problem problem;
+  ceres::LossFunction* loss_function = options.CreateLossFunction();
+
+  for (const image_t image_id : image_ids) {
+    Image& image = reconstruction->Image(image_id);
+    const Camera& camera = reconstruction->Camera(image.CameraId());
+
+    // CostFunction assumes unit quaternions.
+    image.NormalizeQvec();
+
+    double* qvec_data = image.Qvec().data();
+    double* tvec_data = image.Tvec().data();
+    std::vector<double>& params = camera_params[image.CameraId()];
+    if (params.empty()) {
+      params = camera.Params();
+    }
+
+    const bool constant_pose =
+        !options.refine_extrinsics || config.HasConstantPose(image_id);
+
+    size_t num_image_observations = 0;
+    for (const Point2D& point2D : image.Points2D()) {
+      if (!point2D.HasPoint3D()) {
+        continue;
+      }
+
+      num_image_observations += 1;
+      points3D.push_back(reconstruction->Point3D(point2D.Point3DId()).XYZ());
+      double* point3D_data = points3D.back().data();
+
+      ceres::CostFunction* cost_function = nullptr;
+
+      if (constant_pose) {
+        switch (camera.ModelId()) {
+#define CAMERA_MODEL_CASE(CameraModel)                                   \
+  case CameraModel::kModelId:                                            \
+    cost_function =                                                      \
+        BundleAdjustmentConstantPoseCostFunction<CameraModel>::Create(   \
+            image.Qvec(), image.Tvec(), point2D.XY());                   \
+    break;
+
+          CAMERA_MODEL_SWITCH_CASES
+
+#undef CAMERA_MODEL_CASE
+        }
+
+        problem.AddResidualBlock(cost_function, loss_function, point3D_data,
+                                 params.data());
+      } else {
+        switch (camera.ModelId()) {
+#define CAMERA_MODEL_CASE(CameraModel)                                   \
+  case CameraModel::kModelId:                                            \
+    cost_function =                                                      \
+        BundleAdjustmentCostFunction<CameraModel>::Create(point2D.XY()); \
+    break;
+
+          CAMERA_MODEL_SWITCH_CASES
+
+#undef CAMERA_MODEL_CASE
+        }
+
+        problem.AddResidualBlock(cost_function, loss_function, qvec_data,
+                                 tvec_data, point3D_data, params.data());
+      }
+
+      problem.SetParameterBlockConstant(point3D_data);
+    }
+
+    if (num_image_observations > 0 && !constant_pose) {
+      problem.SetParameterization(qvec_data,
+                                  new ceres::QuaternionParameterization);
+      if (config.HasConstantTvec(image_id)) {
+        problem.SetParameterization(
+            tvec_data, new ceres::SubsetParameterization(
+                           3, config.ConstantTvec(image_id)));
+      }
+    }
+  }
+
+  if (problem.NumResiduals() == 0) {
+    return false;
+  }
+
+  for (auto& params : camera_params) {
+    const Camera& camera = reconstruction->Camera(params.first);
+    if (constant_camera || config.IsConstantCamera(params.first)) {
+      problem.SetParameterBlockConstant(params.second.data());
+      continue;
+    }
+    const std::vector<int> const_camera_params =
+        GetConstantCameraParamIdxs(options, camera);
+    if (const_camera_params.size() > 0) {
+      problem.SetParameterization(
+          params.second.data(),
+          new ceres::SubsetParameterization(
+              static_cast<int>(camera.NumParams()), const_camera_params));
+    }
+  }
+
+  // The problems are solved in parallel and each is solved single-threaded.
+  ceres::Solver::Options solver_options =
+      options.CreateSolverOptions(image_ids.size(), problem.NumResiduals());
+  solver_options.minimizer_progress_to_stdout = false;
+  solver_options.num_threads = 1;
+#if CERES_VERSION_MAJOR < 2
+  solver_options.num_linear_solver_threads = 1;
+#endif  // CERES_VERSION_MAJOR
+
+  CostDecreaseRateCallback cost_decrease_rate_callback(
+      options.min_relative_cost_decrease_per_second);
+  solver_options.callbacks.push_back(&cost_decrease_rate_callback);
+
+  std::string solver_error;
+  CHECK(solver_options.IsValid(&solver_error)) << solver_error;
+
+  // Without variable 3D points, there are no blocks to eliminate and the
+  // Schur type linear solvers are replaced by Ceres-Solver with their
+  // non-Schur counterparts.
+  ceres::Solve(solver_options, &problem, summary);
+
+  for (const auto& params : camera_params) {
+    if (!constant_camera && !config.IsConstantCamera(params.first)) {
+      reconstruction->Camera(params.first).SetParams(params.second);
+    }
+  }
+
+  return true;
+}
+
+}  // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
 // BundleAdjustmentOptions
@@ -67,11 +287,163 @@ ceres::LossFunction* BundleAdjustmentOptions::CreateLossFunction() const {
   return loss_function;
 }
 
+ceres::Solver::Options BundleAdjustmentOptions::CreateSolverOptions(
+    const size_t num_images, const int num_residuals) const {
+  ceres::Solver::Options options = solver_options;
+
+  bool cuda_dense_solver_enabled = false;
+  bool cuda_sparse_solver_enabled = false;
+  if (use_gpu) {
+#if (CERES_VERSION_MAJOR >= 3 ||                                \
+     (CERES_VERSION_MAJOR == 2 && CERES_VERSION_MINOR >= 2)) && \
+    !defined(CERES_NO_CUDA)
+    cuda_dense_solver_enabled = true;
+#endif
+#if (CERES_VERSION_MAJOR >= 3 ||                                \
+     (CERES_VERSION_MAJOR == 2 && CERES_VERSION_MINOR >= 3)) && \
+    !defined(CERES_NO_CUDSS)
+    cuda_sparse_solver_enabled = true;
+#endif
+
+    if (cuda_dense_solver_enabled || cuda_sparse_solver_enabled) {
+#ifdef CUDA_ENABLED
+      // Ceres-Solver runs the CUDA solvers on the current device.
+      SetBestCudaDevice(gpu_index);
+#endif
+    } else {
+      std::cout << "WARNING: Requested GPU bundle adjustment, but "
+                   "Ceres-Solver was built without CUDA support, falling "
+                   "back to the CPU solvers."
+                << std::endl;
+    }
+  }
+
+  // Empirical choice.
+  const size_t max_num_images_direct_dense_solver =
+      cuda_dense_solver_enabled ? max_num_images_direct_dense_gpu_solver
+                                : max_num_images_direct_dense_cpu_solver;
+  const size_t max_num_images_direct_sparse_solver =
+      cuda_sparse_solver_enabled ? max_num_images_direct_sparse_gpu_solver
+                                 : max_num_images_direct_sparse_cpu_solver;
+  if (num_images <= max_num_images_direct_dense_solver) {
+    options.linear_solver_type = ceres::DENSE_SCHUR;
+#if (CERES_VERSION_MAJOR >= 3 ||                                \
+     (CERES_VERSION_MAJOR == 2 && CERES_VERSION_MINOR >= 2)) && \
+    !defined(CERES_NO_CUDA)
+    if (cuda_dense_solver_enabled) {
+      options.dense_linear_algebra_library_type = ceres::CUDA;
+    }
+#endif
+  } else if (num_images <= max_num_images_direct_sparse_solver) {
+    options.linear_solver_type = ceres::SPARSE_SCHUR;
+#if (CERES_VERSION_MAJOR >= 3 ||                                \
+     (CERES_VERSION_MAJOR == 2 && CERES_VERSION_MINOR >= 3)) && \
+    !defined(CERES_NO_CUDSS)
+    if (cuda_sparse_solver_enabled) {
+      options.sparse_linear_algebra_library_type = ceres::CUDA_SPARSE;
+    }
+#endif
+  } else {  // Indirect sparse (preconditioned CG) solver.
+    options.linear_solver_type = ceres::ITERATIVE_SCHUR;
+    options.preconditioner_type = ceres::SCHUR_JACOBI;
+#ifndef CERES_NO_SUITESPARSE
+    // The visibility based preconditioners factorize the cluster blocks with
+    // SuiteSparse. Single linkage clustering scales better than canonical
+    // views to large numbers of images.
+    if (min_num_images_visibility_clustering > 0 &&
+        num_images >=
+            static_cast<size_t>(min_num_images_visibility_clustering)) {
+      options.preconditioner_type = ceres::CLUSTER_TRIDIAGONAL;
+      options.visibility_clustering_type = ceres::SINGLE_LINKAGE;
+    }
+#endif  // CERES_NO_SUITESPARSE
+  }
+
+#if CERES_VERSION_MAJOR >= 2
+  if (use_mixed_precision &&
+      (options.linear_solver_type == ceres::DENSE_SCHUR ||
+       (options.linear_solver_type == ceres::SPARSE_SCHUR &&
+        options.sparse_linear_algebra_library_type == ceres::EIGEN_SPARSE))) {
+    options.use_mixed_precision_solves = true;
+    options.max_num_refinement_iterations = max_num_refinement_iterations;
+  }
+#endif  // CERES_VERSION_MAJOR
+
+  if (num_residuals < min_num_residuals_for_multi_threading) {
+    options.num_threads = 1;
+#if CERES_VERSION_MAJOR < 2
+    options.num_linear_solver_threads = 1;
+#endif  // CERES_VERSION_MAJOR
+  } else {
+    options.num_threads = GetEffectiveNumThreads(options.num_threads);
+#if CERES_VERSION_MAJOR < 2
+    options.num_linear_solver_threads =
+        GetEffectiveNumThreads(options.num_linear_solver_threads);
+#endif  // CERES_VERSION_MAJOR
+  }
+
+  return options;
+}
+
 bool BundleAdjustmentOptions::Check() const {
   CHECK_OPTION_GE(loss_function_scale, 0);
+  CHECK_OPTION_GE(min_relative_cost_decrease_per_second, 0);
+  CHECK_OPTION_GE(gpu_index, -1);
+  CHECK_OPTION_GE(max_num_images_direct_dense_cpu_solver, 0);
+  CHECK_OPTION_GE(max_num_images_direct_sparse_cpu_solver,
+                  max_num_images_direct_dense_cpu_solver);
+  CHECK_OPTION_GE(max_num_images_direct_dense_gpu_solver, 0);
+  CHECK_OPTION_GE(max_num_images_direct_sparse_gpu_solver,
+                  max_num_images_direct_dense_gpu_solver);
+  CHECK_OPTION_GE(max_num_refinement_iterations, 0);
+  CHECK_OPTION_GE(min_num_images_visibility_clustering, 0);
+  CHECK_OPTION_GT(visibility_cluster_size, 0);
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// CostDecreaseRateCallback
+////////////////////////////////////////////////////////////////////////////////
+
+CostDecreaseRateCallback::CostDecreaseRateCallback(
+    const double min_relative_cost_decrease_per_second)
+    : min_relative_cost_decrease_per_second_(
+          min_relative_cost_decrease_per_second),
+      prev_cost_(0),
+      prev_time_(0) {}
+
+ceres::CallbackReturnType CostDecreaseRateCallback::operator()(
+    const ceres::IterationSummary& summary) {
+  if (summary.iteration == 0) {
+    prev_cost_ = summary.cost;
+    prev_time_ = summary.cumulative_time_in_seconds;
+    return ceres::SOLVER_CONTINUE;
+  }
+
+  if (!summary.step_is_successful ||
+      min_relative_cost_decrease_per_second_ <= 0) {
+    return ceres::SOLVER_CONTINUE;
+  }
+
+  const double elapsed_time = summary.cumulative_time_in_seconds - prev_time_;
+  const double relative_cost_decrease =
+      prev_cost_ > 0 ? (prev_cost_ - summary.cost) / prev_cost_ : 0;
+
+  prev_cost_ = summary.cost;
+  prev_time_ = summary.cumulative_time_in_seconds;
+
+  if (elapsed_time <= 0) {
+    return ceres::SOLVER_CONTINUE;
+  }
+
+  if (relative_cost_decrease / elapsed_time <
+      min_relative_cost_decrease_per_second_) {
+    return ceres::SOLVER_TERMINATE_SUCCESSFULLY;
+  }
+
+  return ceres::SOLVER_CONTINUE;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // BundleAdjustmentConfig
 ////////////////////////////////////////////////////////////////////////////////
@@ -245,6 +617,59 @@ void BundleAdjustmentConfig::RemoveConstantPoint(const point3D_t point3D_id) {
   constant_point3D_ids_.erase(point3D_id);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// BundleAdjustmentAccessSet
+////////////////////////////////////////////////////////////////////////////////
+
+BundleAdjustmentAccessSet::BundleAdjustmentAccessSet(
+    const BundleAdjustmentConfig& config,
+    const Reconstruction& reconstruction) {
+  // The quaternions of all configured images are normalized and their
+  // observed 3D points and non-constant cameras are refined.
+  for (const image_t image_id : config.Images()) {
+    const Image& image = reconstruction.Image(image_id);
+    image_ids_.insert(image_id);
+    modified_image_ids_.insert(image_id);
+    camera_ids_.insert(image.CameraId());
+    if (!config.IsConstantCamera(image.CameraId())) {
+      modified_camera_ids_.insert(image.CameraId());
+    }
+    for (const Point2D& point2D : image.Points2D()) {
+      if (point2D.HasPoint3D()) {
+        point3D_ids_.insert(point2D.Point3DId());
+      }
+    }
+  }
+
+  // The tracks of the explicitly configured 3D points are fully contained in
+  // the problem, where the images outside the configuration are constant.
+  const auto AddTracks =
+      [&](const std::unordered_set<point3D_t>& point3D_ids) {
+        for (const point3D_t point3D_id : point3D_ids) {
+          point3D_ids_.insert(point3D_id);
+          const Point3D& point3D = reconstruction.Point3D(point3D_id);
+          for (const auto& track_el : point3D.Track().Elements()) {
+            if (image_ids_.insert(track_el.image_id).second) {
+              camera_ids_.insert(
+                  reconstruction.Image(track_el.image_id).CameraId());
+            }
+          }
+        }
+      };
+
+  AddTracks(config.VariablePoints());
+  AddTracks(config.ConstantPoints());
+}
+
+bool BundleAdjustmentAccessSet::IsDisjoint(
+    const BundleAdjustmentAccessSet& other) const {
+  return !HaveCommonElements(point3D_ids_, other.point3D_ids_) &&
+         !HaveCommonElements(modified_image_ids_, other.image_ids_) &&
+         !HaveCommonElements(image_ids_, other.modified_image_ids_) &&
+         !HaveCommonElements(modified_camera_ids_, other.camera_ids_) &&
+         !HaveCommonElements(camera_ids_, other.modified_camera_ids_);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // BundleAdjuster
 ////////////////////////////////////////////////////////////////////////////////
@@ -261,6 +686,11 @@ bool BundleAdjuster::Solve(Reconstruction* reconstruction) {
 
   problem_.reset(new ceres::Problem());
 
+  if (options_.solve_constant_structure_independently &&
+      HasConstantStructure(*reconstruction)) {
+    return SolveConstantStructure(reconstruction);
+  }
+
   ceres::LossFunction* loss_function = options_.CreateLossFunction();
   SetUp(reconstruction, loss_function);
 
@@ -268,40 +698,23 @@ bool BundleAdjuster::Solve(Reconstruction* reconstruction) {
     return false;
   }
 
-  ceres::Solver::Options solver_options = options_.solver_options;
-
-  // Empirical choice.
-  const size_t kMaxNumImagesDirectDenseSolver = 50;
-  const size_t kMaxNumImagesDirectSparseSolver = 1000;
-  const size_t num_images = config_.NumImages();
-  if (num_images <= kMaxNumImagesDirectDenseSolver) {
-    solver_options.linear_solver_type = ceres::DENSE_SCHUR;
-  } else if (num_images <= kMaxNumImagesDirectSparseSolver) {
-    solver_options.linear_solver_type = ceres::SPARSE_SCHUR;
-  } else {  // Indirect sparse (preconditioned CG) solver.
-    solver_options.linear_solver_type = ceres::ITERATIVE_SCHUR;
-    solver_options.preconditioner_type = ceres::SCHUR_JACOBI;
-  }
+  ceres::Solver::Options solver_options =
+      options_.CreateSolverOptions(config_.NumImages(),
+                                   problem_->NumResiduals());
+  SetUpVisibilityClusterOrdering(*reconstruction, &solver_options);
 
-  if (problem_->NumResiduals() <
-      options_.min_num_residuals_for_multi_threading) {
-    solver_options.num_threads = 1;
-#if CERES_VERSION_MAJOR < 2
-    solver_options.num_linear_solver_threads = 1;
-#endif  // CERES_VERSION_MAJOR
-  } else {
-    solver_options.num_threads =
-        GetEffectiveNumThreads(solver_options.num_threads);
-#if CERES_VERSION_MAJOR < 2
-    solver_options.num_linear_solver_threads =
-        GetEffectiveNumThreads(solver_options.num_linear_solver_threads);
-#endif  // CERES_VERSION_MAJOR
-  }
+  CostDecreaseRateCallback cost_decrease_rate_callback(
+      options_.min_relative_cost_decrease_per_second);
+  solver_options.callbacks.push_back(&cost_decrease_rate_callback);
 
   std::string solver_error;
   CHECK(solver_options.IsValid(&solver_error)) << solver_error;
 
-  ceres::Solve(solver_options, problem_.get(), &summary_);
+  {
+    ProfileScope profile_scope("BundleAdjuster::Solve");
+    ceres::Solve(solver_options, problem_.get(), &summary_);
+  }
+  ProfileCounter("ba_iterations", summary_.iterations.size());
 
   if (solver_options.minimizer_progress_to_stdout) {
     std::cout << std::endl;
@@ -339,8 +752,133 @@ void BundleAdjuster::SetUp(Reconstruction* reconstruction,
   ParameterizePoints(reconstruction);
 }
 
-void BundleAdjuster::TearDown(Reconstruction*) {
-  // Nothing to do
+void BundleAdjuster::TearDown(Reconstruction* reconstruction) {
+  MarkAdjustedAsModified(config_, reconstruction);
+}
+
+void BundleAdjuster::SetUpVisibilityClusterOrdering(
+    const Reconstruction& reconstruction,
+    ceres::Solver::Options* solver_options) {
+  // Only the constrained ordering of SuiteSparse respects the elimination
+  // groups of the reduced camera system.
+  if (options_.min_num_images_visibility_clustering == 0 ||
+      config_.NumImages() <
+          static_cast<size_t>(options_.min_num_images_visibility_clustering) ||
+      solver_options->linear_solver_type != ceres::SPARSE_SCHUR ||
+      solver_options->sparse_linear_algebra_library_type !=
+          ceres::SUITE_SPARSE) {
+    return;
+  }
+
+  ProfileScope profile_scope("BundleAdjuster::SetUpVisibilityClusterOrdering");
+
+  // Count the co-visible points of the image pairs in the problem.
+  std::unordered_map<image_pair_t, int> num_covisible_points;
+  std::vector<image_t> point_image_ids;
+  for (const auto& point3D : point3D_num_observations_) {
+    point_image_ids.clear();
+    for (const auto& track_el :
+         reconstruction.Point3D(point3D.first).Track().Elements()) {
+      if (config_.HasImage(track_el.image_id)) {
+        point_image_ids.push_back(track_el.image_id);
+      }
+    }
+    std::sort(point_image_ids.begin(), point_image_ids.end());
+    point_image_ids.erase(
+        std::unique(point_image_ids.begin(), point_image_ids.end()),
+        point_image_ids.end());
+    for (size_t i = 0; i < point_image_ids.size(); ++i) {
+      for (size_t j = i + 1; j < point_image_ids.size(); ++j) {
+        num_covisible_points[Database::ImagePairToPairId(
+            point_image_ids[i], point_image_ids[j])] += 1;
+      }
+    }
+  }
+
+  if (num_covisible_points.empty()) {
+    return;
+  }
+
+  std::vector<std::pair<image_t, image_t>> image_pairs;
+  std::vector<int> num_inliers;
+  image_pairs.reserve(num_covisible_points.size());
+  num_inliers.reserve(num_covisible_points.size());
+  for (const auto& image_pair : num_covisible_points) {
+    image_t image_id1;
+    image_t image_id2;
+    Database::PairIdToImagePair(image_pair.first, &image_id1, &image_id2);
+    image_pairs.emplace_back(image_id1, image_id2);
+    num_inliers.push_back(image_pair.second);
+  }
+
+  SceneClustering::Options clustering_options;
+  clustering_options.leaf_max_num_images = options_.visibility_cluster_size;
+  clustering_options.image_overlap = 0;
+  clustering_options.num_threads = solver_options->num_threads;
+  SceneClustering scene_clustering(clustering_options);
+  scene_clustering.Partition(image_pairs, num_inliers);
+
+  const auto leaf_clusters = scene_clustering.GetLeafClusters();
+  std::unordered_map<image_t, int> image_id_to_cluster_idx;
+  for (size_t i = 0; i < leaf_clusters.size(); ++i) {
+    for (const image_t image_id : leaf_clusters[i]->image_ids) {
+      image_id_to_cluster_idx.emplace(image_id, static_cast<int>(i));
+    }
+  }
+
+  // Select a vertex cover of the co-visibility edges between clusters as the
+  // separator, which is eliminated after the interior images of the clusters.
+  const int kSeparatorClusterIdx = static_cast<int>(leaf_clusters.size());
+  for (const auto& image_pair : image_pairs) {
+    auto cluster_idx1 = image_id_to_cluster_idx.find(image_pair.first);
+    auto cluster_idx2 = image_id_to_cluster_idx.find(image_pair.second);
+    if (cluster_idx1 == image_id_to_cluster_idx.end() ||
+        cluster_idx2 == image_id_to_cluster_idx.end() ||
+        cluster_idx1->second == cluster_idx2->second ||
+        cluster_idx1->second == kSeparatorClusterIdx ||
+        cluster_idx2->second == kSeparatorClusterIdx) {
+      continue;
+    }
+    if (cluster_idx1->second > cluster_idx2->second) {
+      cluster_idx1->second = kSeparatorClusterIdx;
+    } else {
+      cluster_idx2->second = kSeparatorClusterIdx;
+    }
+  }
+
+  // The points form the first elimination group of the Schur complement,
+  // followed by the poses of the clusters. The shared camera parameters and
+  // the poses of the separator and unclustered images are eliminated last.
+  const int kSeparatorGroup = kSeparatorClusterIdx + 1;
+  solver_options->linear_solver_ordering.reset(
+      new ceres::ParameterBlockOrdering);
+  auto& ordering = *solver_options->linear_solver_ordering;
+
+  std::vector<double*> parameter_blocks;
+  problem_->GetParameterBlocks(&parameter_blocks);
+  for (double* parameter_block : parameter_blocks) {
+    ordering.AddElementToGroup(parameter_block, kSeparatorGroup);
+  }
+
+  for (const auto& point3D : point3D_num_observations_) {
+    double* xyz_data = const_cast<double*>(
+        reconstruction.Point3D(point3D.first).XYZ().data());
+    if (problem_->HasParameterBlock(xyz_data)) {
+      ordering.AddElementToGroup(xyz_data, 0);
+    }
+  }
+
+  for (const auto& image_cluster : image_id_to_cluster_idx) {
+    const Image& image = reconstruction.Image(image_cluster.first);
+    double* qvec_data = const_cast<double*>(image.Qvec().data());
+    double* tvec_data = const_cast<double*>(image.Tvec().data());
+    if (problem_->HasParameterBlock(qvec_data)) {
+      ordering.AddElementToGroup(qvec_data, image_cluster.second + 1);
+    }
+    if (problem_->HasParameterBlock(tvec_data)) {
+      ordering.AddElementToGroup(tvec_data, image_cluster.second + 1);
+    }
+  }
 }
 
 void BundleAdjuster::AddImageToProblem(const image_t image_id,
@@ -479,6 +1017,147 @@ void BundleAdjuster::AddPointToProblem(const point3D_t point3D_id,
   }
 }
 
+bool BundleAdjuster::HasConstantStructure(
+    const Reconstruction& reconstruction) const {
+  if (config_.NumVariablePoints() > 0) {
+    return false;
+  }
+
+  // 3D points, whose tracks are entirely contained in the configuration, are
+  // refined unless they are explicitly set constant, see `ParameterizePoints`.
+  std::unordered_set<point3D_t> checked_point3D_ids;
+  for (const image_t image_id : config_.Images()) {
+    for (const Point2D& point2D : reconstruction.Image(image_id).Points2D()) {
+      if (!point2D.HasPoint3D() ||
+          config_.HasConstantPoint(point2D.Point3DId()) ||
+          !checked_point3D_ids.insert(point2D.Point3DId()).second) {
+        continue;
+      }
+      const Point3D& point3D = reconstruction.Point3D(point2D.Point3DId());
+      bool is_contained = true;
+      for (const auto& track_el : point3D.Track().Elements()) {
+        if (!config_.HasImage(track_el.image_id)) {
+          is_contained = false;
+          break;
+        }
+      }
+      if (is_contained) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool BundleAdjuster::SolveConstantStructure(Reconstruction* reconstruction) {
+  Timer timer;
+  timer.Start();
+
+  const bool constant_camera = !options_.refine_focal_length &&
+                               !options_.refine_principal_point &&
+                               !options_.refine_extra_params;
+
+  // Group the images with parameters to refine, where images that share a
+  // refined camera are coupled and must be solved jointly.
+  std::vector<image_t> image_ids(config_.Images().begin(),
+                                 config_.Images().end());
+  std::sort(image_ids.begin(), image_ids.end());
+
+  std::vector<std::vector<image_t>> groups;
+  std::unordered_map<camera_t, size_t> camera_group_idxs;
+  for (const image_t image_id : image_ids) {
+    const camera_t camera_id = reconstruction->Image(image_id).CameraId();
+    const bool variable_camera =
+        !constant_camera && !config_.IsConstantCamera(camera_id);
+    const bool variable_pose =
+        options_.refine_extrinsics && !config_.HasConstantPose(image_id);
+    if (variable_camera) {
+      const auto group_idx = camera_group_idxs.find(camera_id);
+      if (group_idx != camera_group_idxs.end()) {
+        groups[group_idx->second].push_back(image_id);
+        continue;
+      }
+      camera_group_idxs.emplace(camera_id, groups.size());
+    } else if (!variable_pose) {
+      continue;
+    }
+    groups.emplace_back(1, image_id);
+  }
+
+  std::vector<ceres::Solver::Summary> summaries(groups.size());
+  std::vector<char> solved(groups.size(), false);
+
+  {
+    ProfileScope profile_scope("BundleAdjuster::SolveConstantStructure");
+
+    const int num_threads = std::max(
+        1, std::min(GetEffectiveNumThreads(options_.solver_options.num_threads),
+                    static_cast<int>(groups.size())));
+    ThreadPool thread_pool(num_threads);
+    std::vector<std::future<void>> futures;
+    futures.reserve(groups.size());
+    for (size_t i = 0; i < groups.size(); ++i) {
+      futures.push_back(thread_pool.AddTask([&, i]() {
+        solved[i] = SolveConstantStructureProblem(
+            options_, config_, groups[i], reconstruction, &summaries[i]);
+      }));
+    }
+    for (auto& future : futures) {
+      future.get();
+    }
+  }
+
+  // Aggregate the summaries of the independent problems, where the number of
+  // iterations is the maximum over all problems.
+  summary_ = ceres::Solver::Summary();
+  summary_.termination_type = ceres::CONVERGENCE;
+  size_t num_solved = 0;
+  for (size_t i = 0; i < groups.size(); ++i) {
+    if (!solved[i]) {
+      continue;
+    }
+    num_solved += 1;
+    const ceres::Solver::Summary& summary = summaries[i];
+    summary_.initial_cost += summary.initial_cost;
+    summary_.final_cost += summary.final_cost;
+    summary_.num_residuals += summary.num_residuals;
+    summary_.num_residuals_reduced += summary.num_residuals_reduced;
+    summary_.num_parameters += summary.num_parameters;
+    summary_.num_effective_parameters += summary.num_effective_parameters;
+    summary_.num_effective_parameters_reduced +=
+        summary.num_effective_parameters_reduced;
+    summary_.num_successful_steps =
+        std::max(summary_.num_successful_steps, summary.num_successful_steps);
+    summary_.num_unsuccessful_steps = std::max(
+        summary_.num_unsuccessful_steps, summary.num_unsuccessful_steps);
+    if (summary.termination_type == ceres::FAILURE ||
+        summary_.termination_type == ceres::CONVERGENCE) {
+      summary_.termination_type = summary.termination_type;
+    }
+  }
+  summary_.total_time_in_seconds = timer.ElapsedSeconds();
+  summary_.message =
+      StringPrintf("Solved %d independent problems with constant structure",
+                   static_cast<int>(num_solved));
+
+  ProfileCounter("ba_iterations", summary_.num_successful_steps +
+                                      summary_.num_unsuccessful_steps);
+
+  if (num_solved == 0) {
+    return false;
+  }
+
+  if (options_.print_summary) {
+    PrintHeading2("Bundle adjustment report");
+    PrintSolverSummary(summary_);
+  }
+
+  TearDown(reconstruction);
+
+  return true;
+}
+
 void BundleAdjuster::ParameterizeCameras(Reconstruction* reconstruction) {
   const bool constant_camera = !options_.refine_focal_length &&
                                !options_.refine_principal_point &&
@@ -490,6 +1169,397 @@ void BundleAdjuster::ParameterizeCameras(Reconstruction* reconstruction) {
       problem_->SetParameterBlockConstant(camera.ParamsData());
       continue;
     } else {
+      const std::vector<int> const_camera_params =
+          GetConstantCameraParamIdxs(options_, camera);
+
+      if (const_camera_params.size() > 0) {
+        ceres::SubsetParameterization* camera_params_parameterization =
+            new ceres::SubsetParameterization(
+                static_cast<int>(camera.NumParams()), const_camera_params);
+        problem_->SetParameterization(camera.ParamsData(),
+                                      camera_params_parameterization);
+      }
+    }
+  }
+}
+
+void BundleAdjuster::ParameterizePoints(Reconstruction* reconstruction) {
+  for (const auto elem : point3D_num_observations_) {
+    Point3D& point3D = reconstruction->Point3D(elem.first);
+    if (point3D.Track().Length() > elem.second) {
+      problem_->SetParameterBlockConstant(point3D.XYZ().data());
+    }
+  }
+
+  for (const point3D_t point3D_id : config_.ConstantPoints()) {
+    Point3D& point3D = reconstruction->Point3D(point3D_id);
+    problem_->SetParameterBlockConstant(point3D.XYZ().data());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PersistentBundleAdjuster
+////////////////////////////////////////////////////////////////////////////////
+
+PersistentBundleAdjuster::PersistentBundleAdjuster(
+    const BundleAdjustmentOptions& options)
+    : options_(options), reconstruction_(nullptr) {
+  CHECK(options_.Check());
+  loss_function_.reset(options_.CreateLossFunction());
+  quaternion_parameterization_.reset(new ceres::QuaternionParameterization);
+  Clear();
+}
+
+bool PersistentBundleAdjuster::Solve(const BundleAdjustmentConfig& config,
+                                     Reconstruction* reconstruction) {
+  CHECK_NOTNULL(reconstruction);
+  CHECK(reconstruction_ == nullptr || reconstruction_ == reconstruction)
+      << "Cannot use the same PersistentBundleAdjuster for different "
+         "reconstructions without clearing it";
+  reconstruction_ = reconstruction;
+
+  summary_ = ceres::Solver::Summary();
+
+  // Warning: The stale residuals must be removed before adding the missing
+  // residuals, since the memory of deleted 3D points may be reused by new
+  // 3D points. Do not change order of instructions!
+  CollectObservations(config, reconstruction);
+  RemoveStaleResiduals(config, *reconstruction);
+  AddMissingResiduals(config, reconstruction);
+  ParameterizeCameras(config, reconstruction);
+  ParameterizePoints(config, reconstruction);
+
+  if (problem_->NumResiduals() == 0) {
+    return false;
+  }
+
+  ceres::Solver::Options solver_options =
+      options_.CreateSolverOptions(config.NumImages(),
+                                   problem_->NumResiduals());
+
+  CostDecreaseRateCallback cost_decrease_rate_callback(
+      options_.min_relative_cost_decrease_per_second);
+  solver_options.callbacks.push_back(&cost_decrease_rate_callback);
+
+  std::string solver_error;
+  CHECK(solver_options.IsValid(&solver_error)) << solver_error;
+
+  {
+    ProfileScope profile_scope("PersistentBundleAdjuster::Solve");
+    ceres::Solve(solver_options, problem_.get(), &summary_);
+  }
+  ProfileCounter("ba_iterations", summary_.iterations.size());
+
+  if (solver_options.minimizer_progress_to_stdout) {
+    std::cout << std::endl;
+  }
+
+  if (options_.print_summary) {
+    PrintHeading2("Bundle adjustment report");
+    PrintSolverSummary(summary_);
+  }
+
+  MarkAdjustedAsModified(config, reconstruction);
+
+  return true;
+}
+
+const ceres::Solver::Summary& PersistentBundleAdjuster::Summary() const {
+  return summary_;
+}
+
+void PersistentBundleAdjuster::SetOptions(
+    const BundleAdjustmentOptions& options) {
+  CHECK(options.Check());
+  CHECK(options.loss_function_type == options_.loss_function_type);
+  CHECK_EQ(options.loss_function_scale, options_.loss_function_scale);
+  CHECK_EQ(options.refine_focal_length, options_.refine_focal_length);
+  CHECK_EQ(options.refine_principal_point, options_.refine_principal_point);
+  CHECK_EQ(options.refine_extra_params, options_.refine_extra_params);
+  CHECK_EQ(options.refine_extrinsics, options_.refine_extrinsics);
+  options_ = options;
+}
+
+size_t PersistentBundleAdjuster::NumResidualBlocks() const {
+  return static_cast<size_t>(problem_->NumResidualBlocks());
+}
+
+void PersistentBundleAdjuster::Clear() {
+  // The problem must not delete any of the shared objects, which are owned by
+  // the adjuster and reused when residual blocks are removed and re-added.
+  ceres::Problem::Options problem_options;
+  problem_options.cost_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  problem_options.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  problem_options.local_parameterization_ownership =
+      ceres::DO_NOT_TAKE_OWNERSHIP;
+  problem_options.enable_fast_removal = true;
+  problem_.reset(new ceres::Problem(problem_options));
+
+  residuals_.clear();
+  observations_.clear();
+  pose_num_residuals_.clear();
+  camera_num_residuals_.clear();
+  point3D_num_residuals_.clear();
+  constant_tvec_idxs_.clear();
+  constant_camera_ids_.clear();
+  reconstruction_ = nullptr;
+}
+
+void PersistentBundleAdjuster::CollectObservations(
+    const BundleAdjustmentConfig& config, Reconstruction* reconstruction) {
+  observations_.clear();
+  constant_camera_ids_.clear();
+
+  std::unordered_set<camera_t> camera_ids;
+  std::unordered_map<point3D_t, size_t> point3D_num_observations;
+
+  for (const image_t image_id : config.Images()) {
+    Image& image = reconstruction->Image(image_id);
+
+    // CostFunction assumes unit quaternions.
+    image.NormalizeQvec();
+
+    const bool constant_pose =
+        !options_.refine_extrinsics || config.HasConstantPose(image_id);
+
+    auto& image_observations = observations_[image_id];
+    for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
+         ++point2D_idx) {
+      const Point2D& point2D = image.Point2D(point2D_idx);
+      if (point2D.HasPoint3D()) {
+        image_observations.emplace(point2D_idx, constant_pose);
+        point3D_num_observations[point2D.Point3DId()] += 1;
+      }
+    }
+
+    if (image_observations.size() > 0) {
+      camera_ids.insert(image.CameraId());
+    }
+  }
+
+  // Add the observations of partially contained tracks with constant pose.
+  auto AddPointObservations = [&](const point3D_t point3D_id) {
+    const Point3D& point3D = reconstruction->Point3D(point3D_id);
+    size_t& num_observations = point3D_num_observations[point3D_id];
+    if (num_observations == point3D.Track().Length()) {
+      return;
+    }
+
+    for (const auto& track_el : point3D.Track().Elements()) {
+      if (config.HasImage(track_el.image_id)) {
+        continue;
+      }
+
+      num_observations += 1;
+      observations_[track_el.image_id].emplace(track_el.point2D_idx, true);
+
+      // We do not want to refine the camera of images that are not part of
+      // the configuration.
+      const camera_t camera_id =
+          reconstruction->Image(track_el.image_id).CameraId();
+      if (camera_ids.count(camera_id) == 0) {
+        camera_ids.insert(camera_id);
+        constant_camera_ids_.insert(camera_id);
+      }
+    }
+  };
+
+  for (const auto point3D_id : config.VariablePoints()) {
+    AddPointObservations(point3D_id);
+  }
+  for (const auto point3D_id : config.ConstantPoints()) {
+    AddPointObservations(point3D_id);
+  }
+}
+
+void PersistentBundleAdjuster::RemoveStaleResiduals(
+    const BundleAdjustmentConfig& config,
+    const Reconstruction& reconstruction) {
+  for (auto image_it = residuals_.begin(); image_it != residuals_.end();) {
+    const image_t image_id = image_it->first;
+    const Image& image = reconstruction.Image(image_id);
+    const auto observations_it = observations_.find(image_id);
+
+    // The parameterization of an existing pose parameter block cannot be
+    // changed, so the block is re-added when the constant indices changed.
+    bool tvec_changed = false;
+    if (constant_tvec_idxs_.count(image_id)) {
+      const std::vector<int> constant_tvec_idxs =
+          config.HasConstantTvec(image_id) ? config.ConstantTvec(image_id)
+                                           : std::vector<int>();
+      tvec_changed = constant_tvec_idxs != constant_tvec_idxs_.at(image_id);
+    }
+
+    ImageResiduals& image_residuals = image_it->second;
+    for (auto it = image_residuals.begin(); it != image_residuals.end();) {
+      ResidualData& residual = it->second;
+
+      bool stale = true;
+      if (observations_it != observations_.end()) {
+        const auto observation_it = observations_it->second.find(it->first);
+        if (observation_it != observations_it->second.end()) {
+          const Point2D& point2D = image.Point2D(it->first);
+          if (point2D.Point3DId() == residual.point3D_id &&
+              observation_it->second == residual.constant_pose) {
+            if (residual.constant_pose) {
+              stale = residual.qvec != image.Qvec() ||
+                      residual.tvec != image.Tvec();
+            } else {
+              stale = tvec_changed;
+            }
+          }
+        }
+      }
+
+      if (stale) {
+        RemoveResidual(image_id, &residual);
+        it = image_residuals.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    if (image_residuals.empty()) {
+      image_it = residuals_.erase(image_it);
+    } else {
+      ++image_it;
+    }
+  }
+}
+
+void PersistentBundleAdjuster::AddMissingResiduals(
+    const BundleAdjustmentConfig& config, Reconstruction* reconstruction) {
+  for (const auto& image_observations : observations_) {
+    const image_t image_id = image_observations.first;
+    const auto image_it = residuals_.find(image_id);
+    for (const auto& observation : image_observations.second) {
+      if (image_it == residuals_.end() ||
+          image_it->second.count(observation.first) == 0) {
+        AddResidual(config, image_id, observation.first, observation.second,
+                    reconstruction);
+      }
+    }
+  }
+}
+
+void PersistentBundleAdjuster::ParameterizeCameras(
+    const BundleAdjustmentConfig& config, Reconstruction* reconstruction) {
+  const bool constant_camera = !options_.refine_focal_length &&
+                               !options_.refine_principal_point &&
+                               !options_.refine_extra_params;
+  for (const auto& camera_num_residuals : camera_num_residuals_) {
+    const camera_t camera_id = camera_num_residuals.first;
+    Camera& camera = reconstruction->Camera(camera_id);
+    if (constant_camera || config.IsConstantCamera(camera_id) ||
+        constant_camera_ids_.count(camera_id)) {
+      problem_->SetParameterBlockConstant(camera.ParamsData());
+    } else {
+      problem_->SetParameterBlockVariable(camera.ParamsData());
+    }
+  }
+}
+
+void PersistentBundleAdjuster::ParameterizePoints(
+    const BundleAdjustmentConfig& config, Reconstruction* reconstruction) {
+  for (const auto& point3D_num_residuals : point3D_num_residuals_) {
+    const point3D_t point3D_id = point3D_num_residuals.first;
+    Point3D& point3D = reconstruction->Point3D(point3D_id);
+    double* point3D_data = point3D.XYZ().data();
+    if (point3D.Track().Length() > point3D_num_residuals.second ||
+        config.HasConstantPoint(point3D_id)) {
+      problem_->SetParameterBlockConstant(point3D_data);
+    } else {
+      problem_->SetParameterBlockVariable(point3D_data);
+    }
+  }
+}
+
+void PersistentBundleAdjuster::AddResidual(const BundleAdjustmentConfig& config,
+                                           const image_t image_id,
+                                           const point2D_t point2D_idx,
+                                           const bool constant_pose,
+                                           Reconstruction* reconstruction) {
+  Image& image = reconstruction->Image(image_id);
+  Camera& camera = reconstruction->Camera(image.CameraId());
+  const Point2D& point2D = image.Point2D(point2D_idx);
+  Point3D& point3D = reconstruction->Point3D(point2D.Point3DId());
+  assert(point3D.Track().Length() > 1);
+
+  ResidualData& residual = residuals_[image_id][point2D_idx];
+  residual.point3D_id = point2D.Point3DId();
+  residual.constant_pose = constant_pose;
+  residual.camera_id = image.CameraId();
+  residual.point3D_data = point3D.XYZ().data();
+  residual.camera_params_data = camera.ParamsData();
+
+  if (constant_pose) {
+    residual.qvec = image.Qvec();
+    residual.tvec = image.Tvec();
+
+    switch (camera.ModelId()) {
+#define CAMERA_MODEL_CASE(CameraModel)                                   \
+  case CameraModel::kModelId:                                            \
+    residual.cost_function.reset(                                        \
+        BundleAdjustmentConstantPoseCostFunction<CameraModel>::Create(   \
+            image.Qvec(), image.Tvec(), point2D.XY()));                  \
+    break;
+
+      CAMERA_MODEL_SWITCH_CASES
+
+#undef CAMERA_MODEL_CASE
+    }
+
+    residual.residual_block_id = problem_->AddResidualBlock(
+        residual.cost_function.get(), loss_function_.get(),
+        residual.point3D_data, residual.camera_params_data);
+  } else {
+    residual.qvec_data = image.Qvec().data();
+    residual.tvec_data = image.Tvec().data();
+
+    switch (camera.ModelId()) {
+#define CAMERA_MODEL_CASE(CameraModel)                                    \
+  case CameraModel::kModelId:                                             \
+    residual.cost_function.reset(                                         \
+        BundleAdjustmentCostFunction<CameraModel>::Create(point2D.XY())); \
+    break;
+
+      CAMERA_MODEL_SWITCH_CASES
+
+#undef CAMERA_MODEL_CASE
+    }
+
+    residual.residual_block_id = problem_->AddResidualBlock(
+        residual.cost_function.get(), loss_function_.get(), residual.qvec_data,
+        residual.tvec_data, residual.point3D_data,
+        residual.camera_params_data);
+
+    // Set pose parameterization, if the pose was newly added.
+    if (pose_num_residuals_[image_id]++ == 0) {
+      problem_->SetParameterization(residual.qvec_data,
+                                    quaternion_parameterization_.get());
+      const std::vector<int> constant_tvec_idxs =
+          config.HasConstantTvec(image_id) ? config.ConstantTvec(image_id)
+                                           : std::vector<int>();
+      if (constant_tvec_idxs.size() > 0) {
+        auto& tvec_parameterization =
+            tvec_parameterizations_[constant_tvec_idxs];
+        if (!tvec_parameterization) {
+          tvec_parameterization.reset(
+              new ceres::SubsetParameterization(3, constant_tvec_idxs));
+        }
+        problem_->SetParameterization(residual.tvec_data,
+                                      tvec_parameterization.get());
+      }
+      constant_tvec_idxs_.emplace(image_id, constant_tvec_idxs);
+    }
+  }
+
+  // Set camera parameterization, if the camera was newly added.
+  if (camera_num_residuals_[residual.camera_id]++ == 0) {
+    const bool constant_camera = !options_.refine_focal_length &&
+                                 !options_.refine_principal_point &&
+                                 !options_.refine_extra_params;
+    if (!constant_camera) {
       std::vector<int> const_camera_params;
 
       if (!options_.refine_focal_length) {
@@ -509,27 +1579,51 @@ void BundleAdjuster::ParameterizeCameras(Reconstruction* reconstruction) {
       }
 
       if (const_camera_params.size() > 0) {
-        ceres::SubsetParameterization* camera_params_parameterization =
-            new ceres::SubsetParameterization(
-                static_cast<int>(camera.NumParams()), const_camera_params);
-        problem_->SetParameterization(camera.ParamsData(),
-                                      camera_params_parameterization);
+        auto& camera_parameterization =
+            camera_parameterizations_[residual.camera_id];
+        if (!camera_parameterization) {
+          camera_parameterization.reset(new ceres::SubsetParameterization(
+              static_cast<int>(camera.NumParams()), const_camera_params));
+        }
+        problem_->SetParameterization(residual.camera_params_data,
+                                      camera_parameterization.get());
       }
     }
   }
+
+  point3D_num_residuals_[residual.point3D_id] += 1;
 }
 
-void BundleAdjuster::ParameterizePoints(Reconstruction* reconstruction) {
-  for (const auto elem : point3D_num_observations_) {
-    Point3D& point3D = reconstruction->Point3D(elem.first);
-    if (point3D.Track().Length() > elem.second) {
-      problem_->SetParameterBlockConstant(point3D.XYZ().data());
+void PersistentBundleAdjuster::RemoveResidual(const image_t image_id,
+                                              ResidualData* residual) {
+  // Note that the parameter blocks of deleted 3D points are only looked up by
+  // their address and their memory is never accessed.
+  problem_->RemoveResidualBlock(residual->residual_block_id);
+
+  if (!residual->constant_pose) {
+    size_t& num_residuals = pose_num_residuals_.at(image_id);
+    num_residuals -= 1;
+    if (num_residuals == 0) {
+      problem_->RemoveParameterBlock(residual->qvec_data);
+      problem_->RemoveParameterBlock(residual->tvec_data);
+      pose_num_residuals_.erase(image_id);
+      constant_tvec_idxs_.erase(image_id);
     }
   }
 
-  for (const point3D_t point3D_id : config_.ConstantPoints()) {
-    Point3D& point3D = reconstruction->Point3D(point3D_id);
-    problem_->SetParameterBlockConstant(point3D.XYZ().data());
+  size_t& camera_num_residuals = camera_num_residuals_.at(residual->camera_id);
+  camera_num_residuals -= 1;
+  if (camera_num_residuals == 0) {
+    problem_->RemoveParameterBlock(residual->camera_params_data);
+    camera_num_residuals_.erase(residual->camera_id);
+  }
+
+  size_t& point3D_num_residuals =
+      point3D_num_residuals_.at(residual->point3D_id);
+  point3D_num_residuals -= 1;
+  if (point3D_num_residuals == 0) {
+    problem_->RemoveParameterBlock(residual->point3D_data);
+    point3D_num_residuals_.erase(residual->point3D_id);
   }
 }
 
@@ -578,17 +1672,25 @@ bool ParallelBundleAdjuster::Solve(Reconstruction* reconstruction) {
   }
 
   pba::ParallelBA::DeviceT device;
+  GpuScheduler::Lease gpu_lease;
   const int kMaxNumResidualsFloat = 100 * 1000;
   if (num_residuals > kMaxNumResidualsFloat) {
     // The threshold for using double precision is empirically chosen and
     // ensures that the system can be reliable solved.
     device = pba::ParallelBA::PBA_CPU_DOUBLE;
   } else {
-    if (options_.gpu_index < 0) {
+    // The cameras, points, and per residual the Jacobian blocks of the camera
+    // and point parameters together with the residual itself.
+    const size_t num_bytes =
+        sizeof(float) * (16 * cameras_.size() + 4 * points3D_.size() +
+                         (8 + 3 + 1) * static_cast<size_t>(num_residuals));
+    gpu_lease = GpuScheduler::Get().Acquire(
+        std::to_string(options_.gpu_index), num_bytes);
+    if (gpu_lease.GpuIndex() < 0) {
       device = pba::ParallelBA::PBA_CUDA_DEVICE_DEFAULT;
     } else {
       device = static_cast<pba::ParallelBA::DeviceT>(
-          pba::ParallelBA::PBA_CUDA_DEVICE0 + options_.gpu_index);
+          pba::ParallelBA::PBA_CUDA_DEVICE0 + gpu_lease.GpuIndex());
     }
   }
 
@@ -614,8 +1716,12 @@ bool ParallelBundleAdjuster::Solve(Reconstruction* reconstruction) {
 
   Timer timer;
   timer.Start();
-  pba.RunBundleAdjustment();
+  {
+    ProfileScope profile_scope("ParallelBundleAdjuster::Solve");
+    pba.RunBundleAdjustment();
+  }
   timer.Pause();
+  ProfileCounter("ba_iterations", pba_config->GetIterationsLM() + 1);
 
   // Compose Ceres solver summary from PBA options.
   summary_.num_residuals_reduced = num_residuals;
@@ -699,6 +1805,8 @@ void ParallelBundleAdjuster::TearDown(Reconstruction* reconstruction) {
     Point3D& point3D = reconstruction->Point3D(ordered_point3D_ids_[i]);
     points3D_[i].GetPoint(point3D.XYZ().data());
   }
+
+  MarkAdjustedAsModified(config_, reconstruction);
 }
 
 void ParallelBundleAdjuster::AddImagesToProblem(
@@ -829,32 +1937,22 @@ bool RigBundleAdjuster::Solve(Reconstruction* reconstruction,
     return false;
   }
 
-  ceres::Solver::Options solver_options = options_.solver_options;
-
-  // Empirical choice.
-  const size_t kMaxNumImagesDirectDenseSolver = 50;
-  const size_t kMaxNumImagesDirectSparseSolver = 1000;
-  const size_t num_images = config_.NumImages();
-  if (num_images <= kMaxNumImagesDirectDenseSolver) {
-    solver_options.linear_solver_type = ceres::DENSE_SCHUR;
-  } else if (num_images <= kMaxNumImagesDirectSparseSolver) {
-    solver_options.linear_solver_type = ceres::SPARSE_SCHUR;
-  } else {  // Indirect sparse (preconditioned CG) solver.
-    solver_options.linear_solver_type = ceres::ITERATIVE_SCHUR;
-    solver_options.preconditioner_type = ceres::SCHUR_JACOBI;
-  }
+  ceres::Solver::Options solver_options =
+      options_.CreateSolverOptions(config_.NumImages(),
+                                   problem_->NumResiduals());
 
-  solver_options.num_threads =
-      GetEffectiveNumThreads(solver_options.num_threads);
-#if CERES_VERSION_MAJOR < 2
-  solver_options.num_linear_solver_threads =
-      GetEffectiveNumThreads(solver_options.num_linear_solver_threads);
-#endif  // CERES_VERSION_MAJOR
+  CostDecreaseRateCallback cost_decrease_rate_callback(
+      options_.min_relative_cost_decrease_per_second);
+  solver_options.callbacks.push_back(&cost_decrease_rate_callback);
 
   std::string solver_error;
   CHECK(solver_options.IsValid(&solver_error)) << solver_error;
 
-  ceres::Solve(solver_options, problem_.get(), &summary_);
+  {
+    ProfileScope profile_scope("RigBundleAdjuster::Solve");
+    ceres::Solve(solver_options, problem_.get(), &summary_);
+  }
+  ProfileCounter("ba_iterations", summary_.iterations.size());
 
   if (solver_options.minimizer_progress_to_stdout) {
     std::cout << std::endl;
@@ -902,6 +2000,8 @@ void RigBundleAdjuster::TearDown(Reconstruction* reconstruction,
                      camera_rig.RelativeTvec(image.CameraId()), &image.Qvec(),
                      &image.Tvec());
   }
+
+  MarkAdjustedAsModified(config_, reconstruction);
 }
 
 void RigBundleAdjuster::AddImageToProblem(const image_t image_id,
@@ -1201,4 +2301,30 @@ void PrintSolverSummary(const ceres::Solver::Summary& summary) {
   std::cout << std::endl;
 }
 
+void PrintSolverTrajectory(const ceres::Solver::Summary& summary) {
+  const double num_residuals = std::max(1, summary.num_residuals_reduced);
+  double prev_cost = 0;
+  double prev_time = 0;
+  for (const auto& iteration : summary.iterations) {
+    std::cout << std::right << std::setw(4) << iteration.iteration << " : ";
+    std::cout << std::left << std::setprecision(6)
+              << std::sqrt(iteration.cost / num_residuals) << " [px], "
+              << iteration.cumulative_time_in_seconds << " [s]";
+    if (iteration.iteration > 0 && iteration.step_is_successful) {
+      const double elapsed_time =
+          iteration.cumulative_time_in_seconds - prev_time;
+      if (prev_cost > 0 && elapsed_time > 0) {
+        std::cout << ", "
+                  << (prev_cost - iteration.cost) / prev_cost / elapsed_time
+                  << " [1/s]";
+      }
+    }
+    std::cout << std::endl;
+    if (iteration.iteration == 0 || iteration.step_is_successful) {
+      prev_cost = iteration.cost;
+      prev_time = iteration.cumulative_time_in_seconds;
+    }
+  }
+}
+
 }  // namespace colmap
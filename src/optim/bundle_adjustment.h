@@ -32,6 +32,7 @@
 #ifndef COLMAP_SRC_OPTIM_BUNDLE_ADJUSTMENT_H_
 #define COLMAP_SRC_OPTIM_BUNDLE_ADJUSTMENT_H_
 
+#include <map>
 #include <memory>
 #include <unordered_set>
 
@@ -74,6 +75,62 @@ struct BundleAdjustmentOptions {
   // due to the overhead of threading.
   int min_num_residuals_for_multi_threading = 50000;
 
+  // Whether to factorize the Schur complement on the GPU, using the CUDA
+  // backends of Ceres-Solver. Falls back to the CPU solvers, if Ceres-Solver
+  // was built without CUDA support.
+  bool use_gpu = false;
+
+  // Index of the GPU used for bundle adjustment, -1 for the best device.
+  int gpu_index = -1;
+
+  // Maximum number of images for which the Schur complement is factorized
+  // with the dense and sparse direct solvers on the CPU and GPU. Larger
+  // problems are solved with the preconditioned iterative solver.
+  int max_num_images_direct_dense_cpu_solver = 50;
+  int max_num_images_direct_sparse_cpu_solver = 1000;
+  int max_num_images_direct_dense_gpu_solver = 200;
+  int max_num_images_direct_sparse_gpu_solver = 4000;
+
+  // Minimum number of images, for which the images are clustered by their
+  // co-visibility using the normalized cuts of the scene clustering. The
+  // clusters define a nested dissection elimination ordering of the reduced
+  // camera system for the sparse direct solver with SuiteSparse, in which the
+  // images inside the clusters are eliminated before the images that separate
+  // the clusters. The iterative solver uses the cluster-tridiagonal
+  // preconditioner on the co-visibility clusters of Ceres-Solver instead of
+  // the Schur-Jacobi preconditioner. Disabled if zero.
+  int min_num_images_visibility_clustering = 10000;
+
+  // The maximum number of images per co-visibility cluster.
+  int visibility_cluster_size = 500;
+
+  // Whether to factorize the reduced camera system of the direct solvers in
+  // single precision, which halves their memory traffic. The Jacobians and
+  // the reduced camera system are still evaluated in double precision and
+  // each linear solve is refined with iterations in double precision, so that
+  // the accuracy near convergence is retained. Only applies to the dense Schur
+  // solver and to the sparse Schur solver with the Eigen backend, and requires
+  // Ceres-Solver 2.0 or later.
+  bool use_mixed_precision = false;
+
+  // The number of double precision refinement iterations per linear solve,
+  // if mixed precision is used.
+  int max_num_refinement_iterations = 3;
+
+  // Terminate the solver once the relative cost decrease per second since the
+  // last successful iteration falls below this threshold, which bounds the
+  // time spent in the slowly converging tail of large problems. Disabled if
+  // zero. The total solver time can be bounded with the Ceres-Solver option
+  // `max_solver_time_in_seconds`.
+  double min_relative_cost_decrease_per_second = 0.0;
+
+  // Whether to solve configurations, in which all 3D points are constant,
+  // e.g. when refining the poses of new images against a frozen map, as
+  // independent problems per image in parallel instead of a single coupled
+  // problem. Images that share a refined camera are solved jointly. Only
+  // applies to the standard bundle adjuster.
+  bool solve_constant_structure_independently = true;
+
   // Ceres-Solver options.
   ceres::Solver::Options solver_options;
 
@@ -96,6 +153,11 @@ struct BundleAdjustmentOptions {
   // takes ownership of the loss function.
   ceres::LossFunction* CreateLossFunction() const;
 
+  // Create the solver options for a problem with the given number of images
+  // and residuals, which determine the linear solver and the threading.
+  ceres::Solver::Options CreateSolverOptions(const size_t num_images,
+                                             const int num_residuals) const;
+
   bool Check() const;
 };
 
@@ -166,6 +228,46 @@ class BundleAdjustmentConfig {
   std::unordered_map<image_t, std::vector<int>> constant_tvecs_;
 };
 
+// The parameters of a reconstruction that are accessed when solving the
+// bundle adjustment problem of a configuration. The sets are conservative:
+// all 3D points in the problem and the poses of all configured images are
+// considered as modified, even if they are set constant, while the images and
+// cameras only observing points of the problem are considered as read-only.
+// Two problems can be solved concurrently on the same reconstruction, if they
+// are disjoint, i.e., none of them modifies parameters accessed by the other.
+class BundleAdjustmentAccessSet {
+ public:
+  BundleAdjustmentAccessSet(const BundleAdjustmentConfig& config,
+                            const Reconstruction& reconstruction);
+
+  bool IsDisjoint(const BundleAdjustmentAccessSet& other) const;
+
+ private:
+  std::unordered_set<image_t> image_ids_;
+  std::unordered_set<image_t> modified_image_ids_;
+  std::unordered_set<camera_t> camera_ids_;
+  std::unordered_set<camera_t> modified_camera_ids_;
+  std::unordered_set<point3D_t> point3D_ids_;
+};
+
+// Iteration callback that terminates the solver successfully, once the
+// relative cost decrease per second falls below the given threshold. The rate
+// is measured between successful iterations, so that the time of rejected
+// steps is accounted for. A non-positive threshold disables the termination.
+class CostDecreaseRateCallback : public ceres::IterationCallback {
+ public:
+  explicit CostDecreaseRateCallback(
+      const double min_relative_cost_decrease_per_second);
+
+  virtual ceres::CallbackReturnType operator()(
+      const ceres::IterationSummary& summary);
+
+ private:
+  const double min_relative_cost_decrease_per_second_;
+  double prev_cost_;
+  double prev_time_;
+};
+
 // Bundle adjustment based on Ceres-Solver. Enables most flexible configurations
 // and provides best solution quality.
 class BundleAdjuster {
@@ -190,6 +292,20 @@ class BundleAdjuster {
                          Reconstruction* reconstruction,
                          ceres::LossFunction* loss_function);
 
+  // Check whether all 3D points observed by the images of the configuration
+  // are held constant, in which case the problem decouples into independent
+  // problems per image or group of images sharing a refined camera.
+  bool HasConstantStructure(const Reconstruction& reconstruction) const;
+
+  // Set the nested dissection elimination ordering of the co-visibility
+  // clusters of the images, if enabled for the size of the problem.
+  void SetUpVisibilityClusterOrdering(const Reconstruction& reconstruction,
+                                      ceres::Solver::Options* solver_options);
+
+  // Solve the decoupled problems of a configuration with constant structure
+  // in parallel and aggregate their summaries.
+  bool SolveConstantStructure(Reconstruction* reconstruction);
+
  protected:
   void ParameterizeCameras(Reconstruction* reconstruction);
   void ParameterizePoints(Reconstruction* reconstruction);
@@ -202,6 +318,108 @@ class BundleAdjuster {
   std::unordered_map<point3D_t, size_t> point3D_num_observations_;
 };
 
+// Bundle adjustment based on Ceres-Solver that keeps its problem alive across
+// multiple calls to `Solve`. Residual blocks are keyed by observation and only
+// the difference to the previous configuration is added or removed, while
+// cost functions, the loss function, and parameterizations are reused. This
+// is intended for repeated problems over a slowly changing set of images and
+// observations, e.g. local bundle adjustment or the iterations of the global
+// refinement during incremental mapping, where the problem setup otherwise
+// dominates the solver time. The adjuster must always be used with
+// the same reconstruction, whose images and cameras must not be deleted
+// during the lifetime of the adjuster. Deleted or merged 3D points are
+// detected and removed from the problem automatically.
+class PersistentBundleAdjuster {
+ public:
+  explicit PersistentBundleAdjuster(const BundleAdjustmentOptions& options);
+
+  bool Solve(const BundleAdjustmentConfig& config,
+             Reconstruction* reconstruction);
+
+  // Get the Ceres solver summary for the last call to `Solve`.
+  const ceres::Solver::Summary& Summary() const;
+
+  // Update the options for subsequent calls to `Solve`, e.g., to change the
+  // solver options. The loss function and the refined parameter groups must
+  // not change, since they are baked into the existing problem.
+  void SetOptions(const BundleAdjustmentOptions& options);
+
+  // Number of residual blocks currently contained in the problem.
+  size_t NumResidualBlocks() const;
+
+  // Remove all residual blocks, e.g. before switching the reconstruction.
+  void Clear();
+
+ private:
+  struct ResidualData {
+    point3D_t point3D_id = kInvalidPoint3DId;
+    bool constant_pose = false;
+    // The pose baked into the cost function for constant poses.
+    Eigen::Matrix<double, 4, 1, Eigen::DontAlign> qvec;
+    Eigen::Vector3d tvec;
+    // The parameter blocks of the residual block.
+    double* qvec_data = nullptr;
+    double* tvec_data = nullptr;
+    double* point3D_data = nullptr;
+    double* camera_params_data = nullptr;
+    camera_t camera_id = kInvalidCameraId;
+    std::unique_ptr<ceres::CostFunction> cost_function;
+    ceres::ResidualBlockId residual_block_id = nullptr;
+  };
+
+  typedef std::unordered_map<point2D_t, ResidualData> ImageResiduals;
+
+  void CollectObservations(const BundleAdjustmentConfig& config,
+                           Reconstruction* reconstruction);
+  void RemoveStaleResiduals(const BundleAdjustmentConfig& config,
+                            const Reconstruction& reconstruction);
+  void AddMissingResiduals(const BundleAdjustmentConfig& config,
+                           Reconstruction* reconstruction);
+  void ParameterizeCameras(const BundleAdjustmentConfig& config,
+                           Reconstruction* reconstruction);
+  void ParameterizePoints(const BundleAdjustmentConfig& config,
+                          Reconstruction* reconstruction);
+
+  void AddResidual(const BundleAdjustmentConfig& config, const image_t image_id,
+                   const point2D_t point2D_idx, const bool constant_pose,
+                   Reconstruction* reconstruction);
+  void RemoveResidual(const image_t image_id, ResidualData* residual);
+
+  BundleAdjustmentOptions options_;
+  std::unique_ptr<ceres::Problem> problem_;
+  std::unique_ptr<ceres::LossFunction> loss_function_;
+  ceres::Solver::Summary summary_;
+  const Reconstruction* reconstruction_;
+
+  // Shared parameterizations, owned by the adjuster and not by the problem so
+  // that they survive the removal of parameter blocks.
+  std::unique_ptr<ceres::LocalParameterization> quaternion_parameterization_;
+  std::map<std::vector<int>, std::unique_ptr<ceres::LocalParameterization>>
+      tvec_parameterizations_;
+  std::unordered_map<camera_t, std::unique_ptr<ceres::LocalParameterization>>
+      camera_parameterizations_;
+
+  // The residual blocks currently in the problem, per image and observation.
+  std::unordered_map<image_t, ImageResiduals> residuals_;
+
+  // The observations of the current configuration. The flag specifies
+  // whether the observation is added with constant pose.
+  std::unordered_map<image_t, std::unordered_map<point2D_t, bool>>
+      observations_;
+
+  // Number of residual blocks per parameter block. Parameter blocks are
+  // removed from the problem as soon as they have no more residual blocks.
+  std::unordered_map<image_t, size_t> pose_num_residuals_;
+  std::unordered_map<camera_t, size_t> camera_num_residuals_;
+  std::unordered_map<point3D_t, size_t> point3D_num_residuals_;
+
+  // The constant translation indices of the pose parameter blocks.
+  std::unordered_map<image_t, std::vector<int>> constant_tvec_idxs_;
+
+  // Cameras of images outside the configuration, set constant in `Solve`.
+  std::unordered_set<camera_t> constant_camera_ids_;
+};
+
 // Bundle adjustment using PBA (GPU or CPU). Less flexible and accurate than
 // Ceres-Solver bundle adjustment but much faster. Only supports SimpleRadial
 // camera model.
@@ -328,6 +546,10 @@ class RigBundleAdjuster : public BundleAdjuster {
 
 void PrintSolverSummary(const ceres::Solver::Summary& summary);
 
+// Print the cost, the relative cost decrease per second, and the cumulative
+// time of every iteration in the solver summary.
+void PrintSolverTrajectory(const ceres::Solver::Summary& summary);
+
 }  // namespace colmap
 
 #endif  // COLMAP_SRC_OPTIM_BUNDLE_ADJUSTMENT_H_
@@ -0,0 +1,81 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "base/synthetic.h"
+#include "optim/bundle_adjustment.h"
+#include "util/random.h"
+
+using namespace colmap;
+
+static void BM_BundleAdjustment(benchmark::State& state) {
+  SetPRNGSeed(0);
+
+  SyntheticDatasetOptions synthetic_options;
+  synthetic_options.num_cameras = 1;
+  synthetic_options.num_images = state.range(0);
+  synthetic_options.num_points3D = state.range(1);
+  synthetic_options.point2D_stddev = 1.0;
+  Reconstruction reconstruction;
+  SynthesizeDataset(synthetic_options, &reconstruction);
+
+  BundleAdjustmentConfig config;
+  for (const image_t image_id : reconstruction.RegImageIds()) {
+    config.AddImage(image_id);
+  }
+  config.SetConstantPose(reconstruction.RegImageIds()[0]);
+  config.SetConstantTvec(reconstruction.RegImageIds()[1], {0});
+
+  BundleAdjustmentOptions options;
+  options.solver_options.max_num_iterations = 50;
+
+  size_t num_iterations = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    Reconstruction noisy_reconstruction = reconstruction;
+    for (const auto point3D_id : noisy_reconstruction.Point3DIds()) {
+      Eigen::Vector3d& xyz = noisy_reconstruction.Point3D(point3D_id).XYZ();
+      xyz += 0.01 * Eigen::Vector3d::Random();
+    }
+    state.ResumeTiming();
+
+    BundleAdjuster bundle_adjuster(options, config);
+    bundle_adjuster.Solve(&noisy_reconstruction);
+    num_iterations = bundle_adjuster.Summary().iterations.size();
+  }
+
+  state.counters["num_iterations"] = num_iterations;
+}
+
+BENCHMARK(BM_BundleAdjustment)
+    ->Args({10, 1000})
+    ->Args({50, 5000})
+    ->Unit(benchmark::kMillisecond);
@@ -32,6 +32,8 @@
 #define TEST_NAME "optim/bundle_adjustment"
 #include "util/testing.h"
 
+#include <algorithm>
+
 #include "base/camera_models.h"
 #include "base/correspondence_graph.h"
 #include "base/projection.h"
@@ -183,6 +185,16 @@ void GenerateReconstruction(const size_t num_images, const size_t num_points,
   }
 }
 
+bool AreDisjoint(const BundleAdjustmentConfig& config1,
+                 const BundleAdjustmentConfig& config2,
+                 const Reconstruction& reconstruction) {
+  const BundleAdjustmentAccessSet access_set1(config1, reconstruction);
+  const BundleAdjustmentAccessSet access_set2(config2, reconstruction);
+  BOOST_CHECK_EQUAL(access_set1.IsDisjoint(access_set2),
+                    access_set2.IsDisjoint(access_set1));
+  return access_set1.IsDisjoint(access_set2);
+}
+
 BOOST_AUTO_TEST_CASE(TestConfigNumObservations) {
   Reconstruction reconstruction;
   CorrespondenceGraph correspondence_graph;
@@ -207,6 +219,155 @@ BOOST_AUTO_TEST_CASE(TestConfigNumObservations) {
   BOOST_CHECK_EQUAL(config.NumResiduals(reconstruction), 800);
 }
 
+BOOST_AUTO_TEST_CASE(TestAccessSetDisjoint) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(4, 100, &reconstruction, &correspondence_graph);
+
+  // Split the scene into two regions, where images 0, 1 observe the first half
+  // of the points and images 2, 3 observe the second half of the points.
+  std::vector<point3D_t> point3D_ids;
+  for (const auto& point3D : reconstruction.Points3D()) {
+    point3D_ids.push_back(point3D.first);
+  }
+  std::sort(point3D_ids.begin(), point3D_ids.end());
+  for (size_t i = 0; i < point3D_ids.size(); ++i) {
+    const image_t image_id_offset = i < point3D_ids.size() / 2 ? 2 : 0;
+    for (image_t image_id = image_id_offset; image_id < image_id_offset + 2;
+         ++image_id) {
+      for (point2D_t point2D_idx = 0;
+           point2D_idx < reconstruction.Image(image_id).NumPoints2D();
+           ++point2D_idx) {
+        const Point2D& point2D =
+            reconstruction.Image(image_id).Point2D(point2D_idx);
+        if (point2D.HasPoint3D() && point2D.Point3DId() == point3D_ids[i]) {
+          reconstruction.DeleteObservation(image_id, point2D_idx);
+        }
+      }
+    }
+  }
+
+  BundleAdjustmentConfig config1;
+  config1.AddImage(0);
+  config1.AddImage(1);
+
+  BundleAdjustmentConfig config2;
+  config2.AddImage(2);
+  config2.AddImage(3);
+
+  BOOST_CHECK(AreDisjoint(config1, config2, reconstruction));
+
+  // Problems refining the same points.
+  BundleAdjustmentConfig config3;
+  config3.AddImage(2);
+  config3.AddVariablePoint(point3D_ids[0]);
+  BOOST_CHECK(!AreDisjoint(config1, config3, reconstruction));
+
+  // Problems sharing a camera can only be solved concurrently if the camera
+  // is constant in both problems.
+  reconstruction.Image(2).SetCameraId(0);
+  BOOST_CHECK(!AreDisjoint(config1, config2, reconstruction));
+  config1.SetConstantCamera(0);
+  BOOST_CHECK(!AreDisjoint(config1, config2, reconstruction));
+  config2.SetConstantCamera(0);
+  BOOST_CHECK(AreDisjoint(config1, config2, reconstruction));
+}
+
+BOOST_AUTO_TEST_CASE(TestCreateSolverOptions) {
+  BundleAdjustmentOptions options;
+  options.min_num_residuals_for_multi_threading = 100;
+
+  auto solver_options = options.CreateSolverOptions(50, 10);
+  BOOST_CHECK_EQUAL(solver_options.linear_solver_type, ceres::DENSE_SCHUR);
+  BOOST_CHECK_EQUAL(solver_options.num_threads, 1);
+
+  solver_options = options.CreateSolverOptions(51, 100);
+  BOOST_CHECK_EQUAL(solver_options.linear_solver_type, ceres::SPARSE_SCHUR);
+  BOOST_CHECK_GE(solver_options.num_threads, 1);
+
+  solver_options = options.CreateSolverOptions(1001, 100);
+  BOOST_CHECK_EQUAL(solver_options.linear_solver_type,
+                    ceres::ITERATIVE_SCHUR);
+  BOOST_CHECK_EQUAL(solver_options.preconditioner_type, ceres::SCHUR_JACOBI);
+
+  // Large problems use the preconditioner on the co-visibility clusters.
+  options.min_num_images_visibility_clustering = 1001;
+  solver_options = options.CreateSolverOptions(1001, 100);
+#ifdef CERES_NO_SUITESPARSE
+  BOOST_CHECK_EQUAL(solver_options.preconditioner_type, ceres::SCHUR_JACOBI);
+#else
+  BOOST_CHECK_EQUAL(solver_options.preconditioner_type,
+                    ceres::CLUSTER_TRIDIAGONAL);
+#endif  // CERES_NO_SUITESPARSE
+  options.min_num_images_visibility_clustering = 0;
+  solver_options = options.CreateSolverOptions(1001, 100);
+  BOOST_CHECK_EQUAL(solver_options.preconditioner_type, ceres::SCHUR_JACOBI);
+
+  // The GPU thresholds only apply, if Ceres-Solver supports CUDA.
+  options.use_gpu = true;
+  options.max_num_images_direct_dense_cpu_solver = 10;
+  options.max_num_images_direct_dense_gpu_solver = 10;
+  solver_options = options.CreateSolverOptions(11, 10);
+  BOOST_CHECK_EQUAL(solver_options.linear_solver_type, ceres::SPARSE_SCHUR);
+
+#if CERES_VERSION_MAJOR >= 2
+  // Mixed precision only applies to the dense Schur solver, if the sparse
+  // backend is not Eigen.
+  options = BundleAdjustmentOptions();
+  options.use_mixed_precision = true;
+  options.max_num_refinement_iterations = 5;
+  solver_options = options.CreateSolverOptions(50, 10);
+  BOOST_CHECK(solver_options.use_mixed_precision_solves);
+  BOOST_CHECK_EQUAL(solver_options.max_num_refinement_iterations, 5);
+  solver_options = options.CreateSolverOptions(1001, 10);
+  BOOST_CHECK(!solver_options.use_mixed_precision_solves);
+#endif  // CERES_VERSION_MAJOR
+}
+
+BOOST_AUTO_TEST_CASE(TestCostDecreaseRateCallback) {
+  CostDecreaseRateCallback callback(0.1);
+
+  ceres::IterationSummary summary;
+  summary.iteration = 0;
+  summary.cost = 100;
+  summary.cumulative_time_in_seconds = 0;
+  BOOST_CHECK_EQUAL(callback(summary), ceres::SOLVER_CONTINUE);
+
+  // Relative decrease of 0.5 within 1s.
+  summary.iteration = 1;
+  summary.cost = 50;
+  summary.step_is_successful = true;
+  summary.cumulative_time_in_seconds = 1;
+  BOOST_CHECK_EQUAL(callback(summary), ceres::SOLVER_CONTINUE);
+
+  // Unsuccessful steps are skipped, but their time is accounted for.
+  summary.iteration = 2;
+  summary.cost = 50;
+  summary.step_is_successful = false;
+  summary.cumulative_time_in_seconds = 2;
+  BOOST_CHECK_EQUAL(callback(summary), ceres::SOLVER_CONTINUE);
+
+  // Relative decrease of 0.3 within 2s.
+  summary.iteration = 3;
+  summary.cost = 35;
+  summary.step_is_successful = true;
+  summary.cumulative_time_in_seconds = 3;
+  BOOST_CHECK_EQUAL(callback(summary), ceres::SOLVER_CONTINUE);
+
+  // Relative decrease of 0.02 within 1s.
+  summary.iteration = 4;
+  summary.cost = 34.3;
+  summary.cumulative_time_in_seconds = 4;
+  BOOST_CHECK_EQUAL(callback(summary), ceres::SOLVER_TERMINATE_SUCCESSFULLY);
+
+  CostDecreaseRateCallback disabled_callback(0);
+  summary.iteration = 0;
+  BOOST_CHECK_EQUAL(disabled_callback(summary), ceres::SOLVER_CONTINUE);
+  summary.iteration = 1;
+  summary.cumulative_time_in_seconds = 100;
+  BOOST_CHECK_EQUAL(disabled_callback(summary), ceres::SOLVER_CONTINUE);
+}
+
 BOOST_AUTO_TEST_CASE(TestTwoView) {
   Reconstruction reconstruction;
   CorrespondenceGraph correspondence_graph;
@@ -244,6 +405,43 @@ BOOST_AUTO_TEST_CASE(TestTwoView) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestVisibilityClusterOrdering) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(4, 100, &reconstruction, &correspondence_graph);
+  const auto orig_reconstruction = reconstruction;
+
+  BundleAdjustmentConfig config;
+  config.AddImage(0);
+  config.AddImage(1);
+  config.AddImage(2);
+  config.AddImage(3);
+  config.SetConstantPose(0);
+  config.SetConstantTvec(1, {0});
+
+  // Use the sparse solver with one image per co-visibility cluster.
+  BundleAdjustmentOptions options;
+  options.max_num_images_direct_dense_cpu_solver = 1;
+  options.min_num_images_visibility_clustering = 1;
+  options.visibility_cluster_size = 1;
+  BundleAdjuster bundle_adjuster(options, config);
+  BOOST_REQUIRE(bundle_adjuster.Solve(&reconstruction));
+
+  const auto summary = bundle_adjuster.Summary();
+  BOOST_CHECK_EQUAL(summary.linear_solver_type_used, ceres::SPARSE_SCHUR);
+  BOOST_CHECK_EQUAL(summary.num_residuals_reduced, 800);
+
+  CheckConstantImage(reconstruction.Image(0), orig_reconstruction.Image(0));
+  CheckConstantXImage(reconstruction.Image(1), orig_reconstruction.Image(1));
+  CheckVariableImage(reconstruction.Image(2), orig_reconstruction.Image(2));
+  CheckVariableImage(reconstruction.Image(3), orig_reconstruction.Image(3));
+
+  for (const auto& point3D : reconstruction.Points3D()) {
+    CheckVariablePoint(point3D.second,
+                       orig_reconstruction.Point3D(point3D.first));
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestTwoViewConstantCamera) {
   Reconstruction reconstruction;
   CorrespondenceGraph correspondence_graph;
@@ -434,6 +632,51 @@ BOOST_AUTO_TEST_CASE(TestConstantPoints) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestConstantStructure) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(3, 100, &reconstruction, &correspondence_graph);
+  const auto orig_reconstruction = reconstruction;
+
+  BundleAdjustmentConfig config;
+  config.AddImage(0);
+  config.AddImage(1);
+  config.AddImage(2);
+  config.SetConstantPose(0);
+  config.SetConstantCamera(0);
+  for (const auto& point3D : reconstruction.Points3D()) {
+    config.AddConstantPoint(point3D.first);
+  }
+
+  BundleAdjustmentOptions options;
+  BOOST_CHECK(options.solve_constant_structure_independently);
+  BundleAdjuster bundle_adjuster(options, config);
+  BOOST_REQUIRE(bundle_adjuster.Solve(&reconstruction));
+
+  const auto summary = bundle_adjuster.Summary();
+
+  // 100 points, 2 images with variable parameters, 2 residuals per point per
+  // image, where the residuals of the constant image are not added.
+  BOOST_CHECK_EQUAL(summary.num_residuals_reduced, 400);
+  // 2 x 6 pose parameters
+  // + 2 x 2 camera parameters
+  BOOST_CHECK_EQUAL(summary.num_effective_parameters_reduced, 16);
+
+  CheckConstantCamera(reconstruction.Camera(0), orig_reconstruction.Camera(0));
+  CheckConstantImage(reconstruction.Image(0), orig_reconstruction.Image(0));
+
+  CheckVariableCamera(reconstruction.Camera(1), orig_reconstruction.Camera(1));
+  CheckVariableImage(reconstruction.Image(1), orig_reconstruction.Image(1));
+
+  CheckVariableCamera(reconstruction.Camera(2), orig_reconstruction.Camera(2));
+  CheckVariableImage(reconstruction.Image(2), orig_reconstruction.Image(2));
+
+  for (const auto& point3D : reconstruction.Points3D()) {
+    CheckConstantPoint(point3D.second,
+                       orig_reconstruction.Point3D(point3D.first));
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestVariableImage) {
   Reconstruction reconstruction;
   CorrespondenceGraph correspondence_graph;
@@ -644,6 +887,94 @@ BOOST_AUTO_TEST_CASE(TestConstantExtraParam) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestPersistentSlidingWindow) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(3, 100, &reconstruction, &correspondence_graph);
+  const auto orig_reconstruction = reconstruction;
+
+  BundleAdjustmentOptions options;
+  PersistentBundleAdjuster bundle_adjuster(options);
+
+  BundleAdjustmentConfig config1;
+  config1.AddImage(0);
+  config1.AddImage(1);
+  config1.SetConstantPose(0);
+  config1.SetConstantTvec(1, {0});
+  BOOST_REQUIRE(bundle_adjuster.Solve(config1, &reconstruction));
+
+  // 100 points, 2 images, 2 residuals per point per image
+  BOOST_CHECK_EQUAL(bundle_adjuster.NumResidualBlocks(), 200);
+  BOOST_CHECK_EQUAL(bundle_adjuster.Summary().num_residuals_reduced, 400);
+  // 100 x 3 point parameters
+  // + 5 image parameters (pose of second image)
+  // + 2 x 2 camera parameters
+  BOOST_CHECK_EQUAL(bundle_adjuster.Summary().num_effective_parameters_reduced,
+                    309);
+
+  CheckConstantImage(reconstruction.Image(0), orig_reconstruction.Image(0));
+  CheckConstantXImage(reconstruction.Image(1), orig_reconstruction.Image(1));
+  CheckConstantImage(reconstruction.Image(2), orig_reconstruction.Image(2));
+
+  // Slide the window by one image, which re-uses the residuals of image 1.
+  const auto reconstruction1 = reconstruction;
+
+  BundleAdjustmentConfig config2;
+  config2.AddImage(1);
+  config2.AddImage(2);
+  config2.SetConstantPose(1);
+  config2.SetConstantTvec(2, {0});
+  BOOST_REQUIRE(bundle_adjuster.Solve(config2, &reconstruction));
+
+  BOOST_CHECK_EQUAL(bundle_adjuster.NumResidualBlocks(), 200);
+  BOOST_CHECK_EQUAL(bundle_adjuster.Summary().num_residuals_reduced, 400);
+  BOOST_CHECK_EQUAL(bundle_adjuster.Summary().num_effective_parameters_reduced,
+                    309);
+
+  CheckConstantImage(reconstruction.Image(0), reconstruction1.Image(0));
+  CheckConstantImage(reconstruction.Image(1), reconstruction1.Image(1));
+  CheckConstantXImage(reconstruction.Image(2), reconstruction1.Image(2));
+
+  // Deleted points must be removed from the problem.
+  reconstruction.DeletePoint3D(reconstruction.Image(2).Point2D(0).Point3DId());
+  BOOST_REQUIRE(bundle_adjuster.Solve(config2, &reconstruction));
+
+  BOOST_CHECK_EQUAL(bundle_adjuster.NumResidualBlocks(), 198);
+  BOOST_CHECK_EQUAL(bundle_adjuster.Summary().num_residuals_reduced, 396);
+
+  // Clearing the adjuster removes all residuals.
+  bundle_adjuster.Clear();
+  BOOST_CHECK_EQUAL(bundle_adjuster.NumResidualBlocks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestPersistentFilterObservations) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(3, 100, &reconstruction, &correspondence_graph);
+
+  BundleAdjustmentOptions options;
+  PersistentBundleAdjuster bundle_adjuster(options);
+
+  BundleAdjustmentConfig config;
+  config.AddImage(0);
+  config.AddImage(1);
+  config.AddImage(2);
+  config.SetConstantPose(0);
+  config.SetConstantTvec(1, {0});
+  BOOST_REQUIRE(bundle_adjuster.Solve(config, &reconstruction));
+  BOOST_CHECK_EQUAL(bundle_adjuster.NumResidualBlocks(), 300);
+
+  // Filtered observations are removed in place, also with updated solver
+  // options for the next iteration of the refinement.
+  reconstruction.DeleteObservation(2, 0);
+  reconstruction.DeleteObservation(2, 1);
+  options.solver_options.max_num_iterations = 10;
+  bundle_adjuster.SetOptions(options);
+  BOOST_REQUIRE(bundle_adjuster.Solve(config, &reconstruction));
+  BOOST_CHECK_EQUAL(bundle_adjuster.NumResidualBlocks(), 298);
+  BOOST_CHECK_EQUAL(bundle_adjuster.Summary().num_residuals_reduced, 596);
+}
+
 BOOST_AUTO_TEST_CASE(TestParallelReconstructionSupported) {
   BundleAdjustmentOptions options;
   options.refine_focal_length = true;
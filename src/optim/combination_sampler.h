@@ -48,7 +48,8 @@ class CombinationSampler : public Sampler {
 
   size_t MaxNumSamples() override;
 
-  std::vector<size_t> Sample() override;
+  using Sampler::Sample;
+  void Sample(std::vector<size_t>* sampled_idxs) override;
 
  private:
   const size_t num_samples_;
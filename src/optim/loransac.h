@@ -32,7 +32,9 @@
 #ifndef COLMAP_SRC_OPTIM_LORANSAC_H_
 #define COLMAP_SRC_OPTIM_LORANSAC_H_
 
+#include <algorithm>
 #include <cfloat>
+#include <limits>
 #include <random>
 #include <stdexcept>
 #include <vector>
@@ -42,6 +44,7 @@
 #include "optim/support_measurement.h"
 #include "util/alignment.h"
 #include "util/logging.h"
+#include "util/random.h"
 
 namespace colmap {
 
@@ -71,8 +74,18 @@ class LORANSAC : public RANSAC<Estimator, SupportMeasurer, Sampler> {
   LocalEstimator local_estimator;
   using RANSAC<Estimator, SupportMeasurer, Sampler>::sampler;
   using RANSAC<Estimator, SupportMeasurer, Sampler>::support_measurer;
+  using RANSAC<Estimator, SupportMeasurer, Sampler>::batch_evaluator;
 
  private:
+  using typename RANSAC<Estimator, SupportMeasurer, Sampler>::TrialBatch;
+  using typename RANSAC<Estimator, SupportMeasurer,
+                        Sampler>::VerificationBlocks;
+  using RANSAC<Estimator, SupportMeasurer,
+               Sampler>::InitializeVerificationBlocks;
+  using RANSAC<Estimator, SupportMeasurer, Sampler>::GetSPRTOptions;
+  using RANSAC<Estimator, SupportMeasurer, Sampler>::EvaluateModel;
+  using RANSAC<Estimator, SupportMeasurer, Sampler>::GetTrialBatchSize;
+  using RANSAC<Estimator, SupportMeasurer, Sampler>::EvaluateTrialBatch;
   using RANSAC<Estimator, SupportMeasurer, Sampler>::options_;
 };
 
@@ -114,18 +127,86 @@ LORANSAC<Estimator, LocalEstimator, SupportMeasurer, Sampler>::Estimate(
 
   std::vector<double> residuals(num_samples);
 
+  std::vector<size_t> inlier_idxs;
   std::vector<typename LocalEstimator::X_t> X_inlier;
   std::vector<typename LocalEstimator::Y_t> Y_inlier;
 
-  std::vector<typename Estimator::X_t> X_rand(Estimator::kMinNumSamples);
-  std::vector<typename Estimator::Y_t> Y_rand(Estimator::kMinNumSamples);
+  size_t num_local_optimizations = 0;
+  bool best_model_needs_local_optimization = false;
+  const size_t max_num_local_optimization_samples =
+      std::max<size_t>(options_.max_num_local_optimization_samples,
+                       LocalEstimator::kMinNumSamples);
+
+  // Estimate locally optimized models from the inliers of the current
+  // residuals and keep them if better than the best model. The inliers are
+  // randomly subsampled to at most `max_num_inliers`, in which case true is
+  // returned. The buffers are reused for all local optimizations.
+  auto LocallyOptimize = [&](const size_t max_num_inliers) {
+    inlier_idxs.clear();
+    for (size_t i = 0; i < residuals.size(); ++i) {
+      if (residuals[i] <= max_residual) {
+        inlier_idxs.push_back(i);
+      }
+    }
+
+    const bool subsampled = inlier_idxs.size() > max_num_inliers;
+    if (subsampled) {
+      Shuffle(static_cast<uint32_t>(max_num_inliers), &inlier_idxs);
+      inlier_idxs.resize(max_num_inliers);
+    }
+
+    X_inlier.clear();
+    Y_inlier.clear();
+    X_inlier.reserve(inlier_idxs.size());
+    Y_inlier.reserve(inlier_idxs.size());
+    for (const size_t idx : inlier_idxs) {
+      X_inlier.push_back(X[idx]);
+      Y_inlier.push_back(Y[idx]);
+    }
+
+    const std::vector<typename LocalEstimator::M_t> local_models =
+        local_estimator.Estimate(X_inlier, Y_inlier);
+
+    for (const auto& local_model : local_models) {
+      local_estimator.Residuals(X, Y, local_model, &residuals);
+      CHECK_EQ(residuals.size(), X.size());
+
+      const auto local_support =
+          support_measurer.Evaluate(residuals, max_residual);
+
+      // Check if non-locally optimized model is better.
+      if (support_measurer.Compare(local_support, best_support)) {
+        best_support = local_support;
+        best_model = local_model;
+        best_model_is_local = true;
+      }
+    }
+
+    return subsampled;
+  };
+
+  MinimalSampleEstimator<Estimator> minimal_estimator;
 
   sampler.Initialize(num_samples);
 
+  VerificationBlocks blocks;
+  std::unique_ptr<SPRT> sprt;
+  if (options_.use_sprt) {
+    InitializeVerificationBlocks(X, Y, &blocks);
+    sprt.reset(new SPRT(GetSPRTOptions(options_.min_inlier_ratio)));
+  }
+
+  const size_t batch_size = GetTrialBatchSize(sprt.get());
+
   size_t max_num_trials = options_.max_num_trials;
   max_num_trials = std::min<size_t>(max_num_trials, sampler.MaxNumSamples());
   size_t dyn_max_num_trials = max_num_trials;
 
+  TrialBatch batch;
+  std::vector<typename Estimator::M_t> sample_models;
+  std::vector<typename SupportMeasurer::Support> sample_supports;
+  size_t num_sample_models = 0;
+
   for (report.num_trials = 0; report.num_trials < max_num_trials;
        ++report.num_trials) {
     if (abort) {
@@ -133,18 +214,36 @@ LORANSAC<Estimator, LocalEstimator, SupportMeasurer, Sampler>::Estimate(
       break;
     }
 
-    sampler.SampleXY(X, Y, &X_rand, &Y_rand);
-
-    // Estimate model for current subset.
-    const std::vector<typename Estimator::M_t> sample_models =
-        estimator.Estimate(X_rand, Y_rand);
+    if (batch_size > 0) {
+      if (batch.IsProcessed()) {
+        EvaluateTrialBatch(
+            X, Y, blocks, sprt.get(),
+            std::min<size_t>(batch_size, max_num_trials - report.num_trials),
+            max_residual, &batch);
+      }
+      sample_models = std::move(batch.models[batch.num_processed]);
+      sample_supports = std::move(batch.supports[batch.num_processed]);
+      batch.num_processed += 1;
+      num_sample_models = sample_models.size();
+    } else {
+      // Estimate model for current subset.
+      num_sample_models =
+          minimal_estimator.Estimate(X, Y, &sampler, &estimator);
+    }
 
     // Iterate through all estimated models
-    for (const auto& sample_model : sample_models) {
-      estimator.Residuals(X, Y, sample_model, &residuals);
-      CHECK_EQ(residuals.size(), X.size());
-
-      const auto support = support_measurer.Evaluate(residuals, max_residual);
+    for (size_t i = 0; i < num_sample_models; ++i) {
+      const auto& sample_model = batch_size > 0
+                                     ? sample_models[i]
+                                     : minimal_estimator.Model(i);
+
+      typename SupportMeasurer::Support support;
+      if (batch_size > 0) {
+        support = sample_supports[i];
+      } else {
+        EvaluateModel(X, Y, blocks, sprt.get(), sample_model, max_residual,
+                      &residuals, &support);
+      }
 
       // Do local optimization if better than all previous subsets.
       if (support_measurer.Compare(support, best_support)) {
@@ -153,38 +252,30 @@ LORANSAC<Estimator, LocalEstimator, SupportMeasurer, Sampler>::Estimate(
         best_model_is_local = false;
 
         // Estimate locally optimized model from inliers.
+        best_model_needs_local_optimization = false;
         if (support.num_inliers > Estimator::kMinNumSamples &&
             support.num_inliers >= LocalEstimator::kMinNumSamples) {
-          X_inlier.clear();
-          Y_inlier.clear();
-          X_inlier.reserve(support.num_inliers);
-          Y_inlier.reserve(support.num_inliers);
-          for (size_t i = 0; i < residuals.size(); ++i) {
-            if (residuals[i] <= max_residual) {
-              X_inlier.push_back(X[i]);
-              Y_inlier.push_back(Y[i]);
+          if (num_local_optimizations < options_.max_num_local_optimizations) {
+            // The residuals of batched trials were not kept.
+            if (batch_size > 0) {
+              estimator.Residuals(X, Y, sample_model, &residuals);
+              CHECK_EQ(residuals.size(), X.size());
             }
-          }
-
-          const std::vector<typename LocalEstimator::M_t> local_models =
-              local_estimator.Estimate(X_inlier, Y_inlier);
-
-          for (const auto& local_model : local_models) {
-            local_estimator.Residuals(X, Y, local_model, &residuals);
-            CHECK_EQ(residuals.size(), X.size());
 
-            const auto local_support =
-                support_measurer.Evaluate(residuals, max_residual);
-
-            // Check if non-locally optimized model is better.
-            if (support_measurer.Compare(local_support, best_support)) {
-              best_support = local_support;
-              best_model = local_model;
-              best_model_is_local = true;
-            }
+            num_local_optimizations += 1;
+            best_model_needs_local_optimization =
+                LocallyOptimize(max_num_local_optimization_samples);
+          } else {
+            best_model_needs_local_optimization = true;
           }
         }
 
+        // Adapt the test to the inlier ratio of the best model.
+        if (sprt) {
+          sprt->Update(GetSPRTOptions(best_support.num_inliers /
+                                      static_cast<double>(num_samples)));
+        }
+
         dyn_max_num_trials =
             RANSAC<Estimator, SupportMeasurer, Sampler>::ComputeNumTrials(
                 best_support.num_inliers, num_samples, options_.confidence,
@@ -199,9 +290,25 @@ LORANSAC<Estimator, LocalEstimator, SupportMeasurer, Sampler>::Estimate(
     }
   }
 
+  // Refine the best model on all of its inliers, if it was only optimized on
+  // a subset of them or the budget of local optimizations was exhausted.
+  if (best_model_needs_local_optimization) {
+    if (best_model_is_local) {
+      local_estimator.Residuals(X, Y, best_model, &residuals);
+    } else {
+      estimator.Residuals(X, Y, best_model, &residuals);
+    }
+    CHECK_EQ(residuals.size(), X.size());
+    num_local_optimizations += 1;
+    LocallyOptimize(std::numeric_limits<size_t>::max());
+  }
+
   report.support = best_support;
   report.model = best_model;
 
+  ProfileCounter("ransac_trials", report.num_trials);
+  ProfileCounter("loransac_local_optimizations", num_local_optimizations);
+
   // No valid model was found
   if (report.support.num_inliers < estimator.kMinNumSamples) {
     return report;
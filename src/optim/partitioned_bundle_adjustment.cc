@@ -0,0 +1,868 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+#include "optim/partitioned_bundle_adjustment.h"
+
+#include <iomanip>
+
+#include "base/camera_models.h"
+#include "base/cost_functions.h"
+#include "base/database.h"
+#include "base/pose.h"
+#include "base/scene_clustering.h"
+#include "util/misc.h"
+#include "util/threading.h"
+
+namespace colmap {
+namespace {
+
+// Penalizes the deviation of a parameter block from its consensus target,
+// i.e. the residuals are `weight * (x - target)`.
+class ConsensusCostFunction : public ceres::CostFunction {
+ public:
+  ConsensusCostFunction(const std::vector<double>& target, const double weight)
+      : target_(target), weight_(weight) {
+    set_num_residuals(static_cast<int>(target_.size()));
+    mutable_parameter_block_sizes()->push_back(
+        static_cast<int>(target_.size()));
+  }
+
+  bool Evaluate(double const* const* parameters, double* residuals,
+                double** jacobians) const override {
+    const size_t size = target_.size();
+    for (size_t i = 0; i < size; ++i) {
+      residuals[i] = weight_ * (parameters[0][i] - target_[i]);
+    }
+
+    if (jacobians != nullptr && jacobians[0] != nullptr) {
+      std::fill(jacobians[0], jacobians[0] + size * size, 0.0);
+      for (size_t i = 0; i < size; ++i) {
+        jacobians[0][i * size + i] = weight_;
+      }
+    }
+
+    return true;
+  }
+
+ private:
+  const std::vector<double> target_;
+  const double weight_;
+};
+
+}  // namespace
+
+bool PartitionedBundleAdjuster::Options::Check() const {
+  CHECK_OPTION_GT(max_num_images_per_partition, 0);
+  CHECK_OPTION_GE(max_num_iterations, 0);
+  CHECK_OPTION_GT(max_num_partition_iterations, 0);
+  CHECK_OPTION_GT(initial_penalty, 0);
+  CHECK_OPTION_GE(tolerance, 0);
+  return true;
+}
+
+PartitionedBundleAdjuster::PartitionedBundleAdjuster(
+    const Options& options, const BundleAdjustmentOptions& ba_options,
+    const BundleAdjustmentConfig& config)
+    : options_(options),
+      ba_options_(ba_options),
+      config_(config),
+      penalty_(options.initial_penalty) {
+  CHECK(options_.Check());
+  CHECK(ba_options_.Check());
+}
+
+bool PartitionedBundleAdjuster::Solve(Reconstruction* reconstruction) {
+  CHECK_NOTNULL(reconstruction);
+
+  report_ = Report();
+
+  // Small problems are solved as a single problem.
+  if (config_.NumImages() <=
+      static_cast<size_t>(options_.max_num_images_per_partition)) {
+    report_.num_partitions = 1;
+    report_.converged = true;
+    BundleAdjuster bundle_adjuster(ba_options_, config_);
+    return bundle_adjuster.Solve(reconstruction);
+  }
+
+  if (!SetUp(*reconstruction)) {
+    return false;
+  }
+
+  const int num_threads =
+      std::min(GetEffectiveNumThreads(options_.num_threads),
+               static_cast<int>(partitions_.size()));
+  const int num_threads_per_partition = std::max(
+      1, GetEffectiveNumThreads(ba_options_.solver_options.num_threads) /
+             num_threads);
+
+  ThreadPool thread_pool(num_threads);
+
+  for (int iteration = 0; iteration < options_.max_num_iterations;
+       ++iteration) {
+    std::vector<std::future<bool>> futures;
+    futures.reserve(partitions_.size());
+    for (auto& partition : partitions_) {
+      Partition* partition_ptr = &partition;
+      futures.push_back(thread_pool.AddTask(
+          [this, partition_ptr, num_threads_per_partition]() {
+            return SolvePartition(partition_ptr, num_threads_per_partition);
+          }));
+    }
+    for (auto& future : futures) {
+      future.get();
+    }
+
+    UpdateConsensus();
+
+    report_.num_iterations += 1;
+
+    if (ba_options_.solver_options.minimizer_progress_to_stdout) {
+      std::cout << StringPrintf(
+                       "  Consensus iteration %d: primal residual %e, dual "
+                       "residual %e, penalty %e",
+                       iteration + 1, report_.primal_residual,
+                       report_.dual_residual, report_.penalty)
+                << std::endl;
+    }
+
+    if (report_.converged) {
+      break;
+    }
+  }
+
+  TearDown(reconstruction);
+
+  if (options_.print_summary) {
+    PrintHeading2("Partitioned bundle adjustment report");
+    std::cout << std::right << std::setw(20) << "Partitions : ";
+    std::cout << std::left << report_.num_partitions << std::endl;
+    std::cout << std::right << std::setw(20) << "Shared cameras : ";
+    std::cout << std::left << report_.num_shared_cameras << std::endl;
+    std::cout << std::right << std::setw(20) << "Shared points : ";
+    std::cout << std::left << report_.num_shared_points3D << std::endl;
+    std::cout << std::right << std::setw(20) << "Iterations : ";
+    std::cout << std::left << report_.num_iterations << std::endl;
+    std::cout << std::right << std::setw(20) << "Primal residual : ";
+    std::cout << std::left << report_.primal_residual << std::endl;
+    std::cout << std::right << std::setw(20) << "Dual residual : ";
+    std::cout << std::left << report_.dual_residual << std::endl;
+    std::cout << std::right << std::setw(20) << "Termination : ";
+    std::cout << std::left
+              << (report_.converged ? "Convergence" : "No convergence")
+              << std::endl;
+    std::cout << std::endl;
+  }
+
+  return true;
+}
+
+const PartitionedBundleAdjuster::Report& PartitionedBundleAdjuster::GetReport()
+    const {
+  return report_;
+}
+
+bool PartitionedBundleAdjuster::SetUp(const Reconstruction& reconstruction) {
+  partitions_.clear();
+  constant_camera_ids_.clear();
+  constant_point3D_ids_.clear();
+  camera_model_ids_.clear();
+  constant_camera_params_.clear();
+  shared_camera_params_.clear();
+  shared_points3D_.clear();
+  penalty_ = options_.initial_penalty;
+
+  std::vector<image_t> image_ids(config_.Images().begin(),
+                                 config_.Images().end());
+  std::sort(image_ids.begin(), image_ids.end());
+
+  // Weight the edges of the covisibility graph by the number of 3D points
+  // that are commonly observed in the images of the configuration.
+  std::unordered_map<image_pair_t, int> num_covisible_points3D;
+  std::vector<image_t> point3D_image_ids;
+  for (const auto& point3D : reconstruction.Points3D()) {
+    point3D_image_ids.clear();
+    for (const auto& track_el : point3D.second.Track().Elements()) {
+      if (config_.HasImage(track_el.image_id)) {
+        point3D_image_ids.push_back(track_el.image_id);
+      }
+    }
+    std::sort(point3D_image_ids.begin(), point3D_image_ids.end());
+    point3D_image_ids.erase(
+        std::unique(point3D_image_ids.begin(), point3D_image_ids.end()),
+        point3D_image_ids.end());
+    for (size_t i = 0; i < point3D_image_ids.size(); ++i) {
+      for (size_t j = 0; j < i; ++j) {
+        const image_pair_t pair_id = Database::ImagePairToPairId(
+            point3D_image_ids[i], point3D_image_ids[j]);
+        num_covisible_points3D[pair_id] += 1;
+      }
+    }
+  }
+
+  std::vector<std::pair<image_t, image_t>> image_pairs;
+  std::vector<int> num_covisible;
+  image_pairs.reserve(num_covisible_points3D.size());
+  num_covisible.reserve(num_covisible_points3D.size());
+  for (const auto& pair : num_covisible_points3D) {
+    image_t image_id1;
+    image_t image_id2;
+    Database::PairIdToImagePair(pair.first, &image_id1, &image_id2);
+    image_pairs.emplace_back(image_id1, image_id2);
+    num_covisible.push_back(pair.second);
+  }
+
+  // Partition the images into disjoint clusters.
+  SceneClustering::Options clustering_options;
+  clustering_options.image_overlap = 0;
+  clustering_options.leaf_max_num_images =
+      options_.max_num_images_per_partition;
+  SceneClustering scene_clustering(clustering_options);
+  scene_clustering.Partition(image_pairs, num_covisible);
+
+  std::vector<std::vector<image_t>> partition_image_ids;
+  std::unordered_set<image_t> partitioned_image_ids;
+  for (const auto cluster : scene_clustering.GetLeafClusters()) {
+    std::vector<image_t> cluster_image_ids;
+    for (const image_t image_id : cluster->image_ids) {
+      if (config_.HasImage(image_id) &&
+          partitioned_image_ids.insert(image_id).second) {
+        cluster_image_ids.push_back(image_id);
+      }
+    }
+    if (!cluster_image_ids.empty()) {
+      partition_image_ids.push_back(std::move(cluster_image_ids));
+    }
+  }
+
+  if (partition_image_ids.empty()) {
+    partition_image_ids.emplace_back();
+  }
+
+  // Images without covisible images are added to the smallest partition.
+  for (const image_t image_id : image_ids) {
+    if (partitioned_image_ids.count(image_id) == 0) {
+      auto& smallest_image_ids = *std::min_element(
+          partition_image_ids.begin(), partition_image_ids.end(),
+          [](const std::vector<image_t>& image_ids1,
+             const std::vector<image_t>& image_ids2) {
+            return image_ids1.size() < image_ids2.size();
+          });
+      smallest_image_ids.push_back(image_id);
+    }
+  }
+
+  // Collect the observations of the partitions.
+  partitions_.resize(partition_image_ids.size());
+  std::unordered_set<camera_t> camera_ids;
+  std::unordered_map<point3D_t, size_t> point3D_num_observations;
+  for (size_t i = 0; i < partitions_.size(); ++i) {
+    Partition& partition = partitions_[i];
+    std::sort(partition_image_ids[i].begin(), partition_image_ids[i].end());
+    for (const image_t image_id : partition_image_ids[i]) {
+      const Image& image = reconstruction.Image(image_id);
+      const bool constant_pose =
+          !ba_options_.refine_extrinsics || config_.HasConstantPose(image_id);
+      for (const Point2D& point2D : image.Points2D()) {
+        if (!point2D.HasPoint3D()) {
+          continue;
+        }
+        Observation observation;
+        observation.image_idx = AddImageToPartition(image_id, constant_pose,
+                                                    reconstruction, &partition);
+        observation.point3D_idx = AddPointToPartition(
+            point2D.Point3DId(), reconstruction, &partition);
+        observation.x = point2D.X();
+        observation.y = point2D.Y();
+        partition.observations.push_back(observation);
+        point3D_num_observations[point2D.Point3DId()] += 1;
+        camera_ids.insert(image.CameraId());
+      }
+    }
+  }
+
+  // Observations of 3D points in images outside the configuration are added
+  // with constant pose to the first partition that contains the 3D point.
+  auto AddPointObservations = [&](const point3D_t point3D_id) {
+    const Point3D& point3D = reconstruction.Point3D(point3D_id);
+    size_t& num_observations = point3D_num_observations[point3D_id];
+    if (num_observations == point3D.Track().Length()) {
+      return;
+    }
+
+    Partition* partition = &partitions_[0];
+    for (auto& other_partition : partitions_) {
+      if (other_partition.point3D_idxs.count(point3D_id)) {
+        partition = &other_partition;
+        break;
+      }
+    }
+
+    for (const auto& track_el : point3D.Track().Elements()) {
+      if (config_.HasImage(track_el.image_id)) {
+        continue;
+      }
+
+      num_observations += 1;
+
+      const Image& image = reconstruction.Image(track_el.image_id);
+      const Point2D& point2D = image.Point2D(track_el.point2D_idx);
+      Observation observation;
+      observation.image_idx = AddImageToPartition(track_el.image_id, true,
+                                                  reconstruction, partition);
+      observation.point3D_idx =
+          AddPointToPartition(point3D_id, reconstruction, partition);
+      observation.x = point2D.X();
+      observation.y = point2D.Y();
+      partition->observations.push_back(observation);
+
+      // We do not want to refine the camera of images that are not part of
+      // the configuration.
+      if (camera_ids.count(image.CameraId()) == 0) {
+        camera_ids.insert(image.CameraId());
+        constant_camera_ids_.insert(image.CameraId());
+      }
+    }
+  };
+
+  for (const auto point3D_id : config_.VariablePoints()) {
+    AddPointObservations(point3D_id);
+  }
+  for (const auto point3D_id : config_.ConstantPoints()) {
+    AddPointObservations(point3D_id);
+  }
+
+  // Determine the constant cameras and the indices of their constant
+  // parameters, equivalent to the standard bundle adjuster.
+  const bool constant_camera = !ba_options_.refine_focal_length &&
+                               !ba_options_.refine_principal_point &&
+                               !ba_options_.refine_extra_params;
+  for (const camera_t camera_id : camera_ids) {
+    const Camera& camera = reconstruction.Camera(camera_id);
+    camera_model_ids_.emplace(camera_id, camera.ModelId());
+
+    if (constant_camera || config_.IsConstantCamera(camera_id)) {
+      constant_camera_ids_.insert(camera_id);
+    }
+
+    std::vector<int>& const_camera_params = constant_camera_params_[camera_id];
+    if (!ba_options_.refine_focal_length) {
+      const std::vector<size_t>& params_idxs = camera.FocalLengthIdxs();
+      const_camera_params.insert(const_camera_params.end(),
+                                 params_idxs.begin(), params_idxs.end());
+    }
+    if (!ba_options_.refine_principal_point) {
+      const std::vector<size_t>& params_idxs = camera.PrincipalPointIdxs();
+      const_camera_params.insert(const_camera_params.end(),
+                                 params_idxs.begin(), params_idxs.end());
+    }
+    if (!ba_options_.refine_extra_params) {
+      const std::vector<size_t>& params_idxs = camera.ExtraParamsIdxs();
+      const_camera_params.insert(const_camera_params.end(),
+                                 params_idxs.begin(), params_idxs.end());
+    }
+  }
+
+  // 3D points are constant, if their track is not entirely contained.
+  for (const auto& num_observations : point3D_num_observations) {
+    const Point3D& point3D = reconstruction.Point3D(num_observations.first);
+    if (point3D.Track().Length() > num_observations.second ||
+        config_.HasConstantPoint(num_observations.first)) {
+      constant_point3D_ids_.insert(num_observations.first);
+    }
+  }
+
+  // Determine the variable cameras and 3D points shared between partitions
+  // and initialize their consensus with the current values.
+  std::unordered_map<camera_t, size_t> camera_num_partitions;
+  std::unordered_map<point3D_t, size_t> point3D_num_partitions;
+  for (const auto& partition : partitions_) {
+    for (const camera_t camera_id : partition.camera_ids) {
+      camera_num_partitions[camera_id] += 1;
+    }
+    for (const point3D_t point3D_id : partition.point3D_ids) {
+      point3D_num_partitions[point3D_id] += 1;
+    }
+  }
+
+  std::unordered_map<camera_t, size_t> shared_camera_idxs;
+  std::unordered_map<point3D_t, size_t> shared_point3D_idxs;
+  for (auto& partition : partitions_) {
+    for (size_t camera_idx = 0; camera_idx < partition.camera_ids.size();
+         ++camera_idx) {
+      const camera_t camera_id = partition.camera_ids[camera_idx];
+      if (camera_num_partitions.at(camera_id) < 2 ||
+          constant_camera_ids_.count(camera_id)) {
+        continue;
+      }
+      const auto shared_idx = shared_camera_idxs.emplace(
+          camera_id, shared_camera_params_.size());
+      if (shared_idx.second) {
+        shared_camera_params_.push_back(partition.camera_params[camera_idx]);
+      }
+      partition.shared_cameras.emplace_back(camera_idx,
+                                            shared_idx.first->second);
+      partition.camera_duals.emplace_back(
+          partition.camera_params[camera_idx].size(), 0.0);
+    }
+
+    for (size_t point3D_idx = 0; point3D_idx < partition.point3D_ids.size();
+         ++point3D_idx) {
+      const point3D_t point3D_id = partition.point3D_ids[point3D_idx];
+      if (point3D_num_partitions.at(point3D_id) < 2 ||
+          constant_point3D_ids_.count(point3D_id)) {
+        continue;
+      }
+      const auto shared_idx = shared_point3D_idxs.emplace(
+          point3D_id, shared_points3D_.size() / 3);
+      if (shared_idx.second) {
+        shared_points3D_.insert(
+            shared_points3D_.end(),
+            partition.points3D.begin() + 3 * point3D_idx,
+            partition.points3D.begin() + 3 * point3D_idx + 3);
+      }
+      partition.shared_points3D.emplace_back(point3D_idx,
+                                             shared_idx.first->second);
+      partition.point3D_duals.insert(partition.point3D_duals.end(), 3, 0.0);
+    }
+  }
+
+  report_.num_partitions = partitions_.size();
+  report_.num_shared_cameras = shared_camera_params_.size();
+  report_.num_shared_points3D = shared_points3D_.size() / 3;
+  report_.penalty = penalty_;
+
+  return !point3D_num_observations.empty();
+}
+
+bool PartitionedBundleAdjuster::SolvePartition(Partition* partition,
+                                               const int num_threads) const {
+  if (partition->observations.empty()) {
+    return false;
+  }
+
+  ceres::Problem problem;
+  ceres::LossFunction* loss_function = ba_options_.CreateLossFunction();
+
+  for (const auto& observation : partition->observations) {
+    const size_t image_idx = observation.image_idx;
+    const size_t camera_idx = partition->image_camera_idxs[image_idx];
+    const camera_t camera_id = partition->camera_ids[camera_idx];
+    const Eigen::Vector2d point2D(observation.x, observation.y);
+
+    double* qvec_data = &partition->qvecs[4 * image_idx];
+    double* tvec_data = &partition->tvecs[3 * image_idx];
+    double* point3D_data = &partition->points3D[3 * observation.point3D_idx];
+    double* camera_params_data = partition->camera_params[camera_idx].data();
+
+    ceres::CostFunction* cost_function = nullptr;
+
+    if (partition->constant_poses[image_idx]) {
+      const Eigen::Vector4d qvec(qvec_data[0], qvec_data[1], qvec_data[2],
+                                 qvec_data[3]);
+      const Eigen::Vector3d tvec(tvec_data[0], tvec_data[1], tvec_data[2]);
+
+      switch (camera_model_ids_.at(camera_id)) {
+#define CAMERA_MODEL_CASE(CameraModel)                                   \
+  case CameraModel::kModelId:                                            \
+    cost_function =                                                      \
+        BundleAdjustmentConstantPoseCostFunction<CameraModel>::Create(   \
+            qvec, tvec, point2D);                                        \
+    break;
+
+        CAMERA_MODEL_SWITCH_CASES
+
+#undef CAMERA_MODEL_CASE
+      }
+
+      problem.AddResidualBlock(cost_function, loss_function, point3D_data,
+                               camera_params_data);
+    } else {
+      switch (camera_model_ids_.at(camera_id)) {
+#define CAMERA_MODEL_CASE(CameraModel)                                 \
+  case CameraModel::kModelId:                                          \
+    cost_function =                                                    \
+        BundleAdjustmentCostFunction<CameraModel>::Create(point2D);    \
+    break;
+
+        CAMERA_MODEL_SWITCH_CASES
+
+#undef CAMERA_MODEL_CASE
+      }
+
+      problem.AddResidualBlock(cost_function, loss_function, qvec_data,
+                               tvec_data, point3D_data, camera_params_data);
+    }
+  }
+
+  // Set pose parameterization.
+  for (size_t image_idx = 0; image_idx < partition->image_ids.size();
+       ++image_idx) {
+    if (partition->constant_poses[image_idx]) {
+      continue;
+    }
+    const image_t image_id = partition->image_ids[image_idx];
+    ceres::LocalParameterization* quaternion_parameterization =
+        new ceres::QuaternionParameterization;
+    problem.SetParameterization(&partition->qvecs[4 * image_idx],
+                                quaternion_parameterization);
+    if (config_.HasConstantTvec(image_id)) {
+      ceres::SubsetParameterization* tvec_parameterization =
+          new ceres::SubsetParameterization(3, config_.ConstantTvec(image_id));
+      problem.SetParameterization(&partition->tvecs[3 * image_idx],
+                                  tvec_parameterization);
+    }
+  }
+
+  // Set camera parameterization.
+  for (size_t camera_idx = 0; camera_idx < partition->camera_ids.size();
+       ++camera_idx) {
+    const camera_t camera_id = partition->camera_ids[camera_idx];
+    double* camera_params_data = partition->camera_params[camera_idx].data();
+    if (constant_camera_ids_.count(camera_id)) {
+      problem.SetParameterBlockConstant(camera_params_data);
+    } else {
+      const std::vector<int>& const_camera_params =
+          constant_camera_params_.at(camera_id);
+      if (const_camera_params.size() > 0) {
+        ceres::SubsetParameterization* camera_params_parameterization =
+            new ceres::SubsetParameterization(
+                static_cast<int>(partition->camera_params[camera_idx].size()),
+                const_camera_params);
+        problem.SetParameterization(camera_params_data,
+                                    camera_params_parameterization);
+      }
+    }
+  }
+
+  // Set constant 3D points.
+  for (size_t point3D_idx = 0; point3D_idx < partition->point3D_ids.size();
+       ++point3D_idx) {
+    if (constant_point3D_ids_.count(partition->point3D_ids[point3D_idx])) {
+      problem.SetParameterBlockConstant(&partition->points3D[3 * point3D_idx]);
+    }
+  }
+
+  // Penalize the deviation of the shared parameters from their consensus
+  // shifted by the scaled dual variables, i.e. the augmented Lagrangian.
+  const double weight = std::sqrt(penalty_);
+  for (size_t i = 0; i < partition->shared_cameras.size(); ++i) {
+    const auto& shared_camera = partition->shared_cameras[i];
+    std::vector<double> target = shared_camera_params_[shared_camera.second];
+    for (size_t k = 0; k < target.size(); ++k) {
+      target[k] -= partition->camera_duals[i][k];
+    }
+    problem.AddResidualBlock(
+        new ConsensusCostFunction(target, weight), nullptr,
+        partition->camera_params[shared_camera.first].data());
+  }
+
+  for (size_t i = 0; i < partition->shared_points3D.size(); ++i) {
+    const auto& shared_point3D = partition->shared_points3D[i];
+    std::vector<double> target(3);
+    for (size_t k = 0; k < 3; ++k) {
+      target[k] = shared_points3D_[3 * shared_point3D.second + k] -
+                  partition->point3D_duals[3 * i + k];
+    }
+    problem.AddResidualBlock(new ConsensusCostFunction(target, weight),
+                             nullptr,
+                             &partition->points3D[3 * shared_point3D.first]);
+  }
+
+  ceres::Solver::Options solver_options = ba_options_.CreateSolverOptions(
+      partition->image_ids.size(), problem.NumResiduals());
+  solver_options.max_num_iterations = options_.max_num_partition_iterations;
+  solver_options.minimizer_progress_to_stdout = false;
+  solver_options.num_threads = num_threads;
+#if CERES_VERSION_MAJOR < 2
+  solver_options.num_linear_solver_threads = num_threads;
+#endif  // CERES_VERSION_MAJOR
+
+  std::string solver_error;
+  CHECK(solver_options.IsValid(&solver_error)) << solver_error;
+
+  ceres::Solver::Summary summary;
+  ceres::Solve(solver_options, &problem, &summary);
+
+  return summary.IsSolutionUsable();
+}
+
+void PartitionedBundleAdjuster::UpdateConsensus() {
+  // Average the copies of the shared parameters shifted by their scaled dual
+  // variables to obtain the new consensus.
+  std::vector<std::vector<double>> camera_sums(shared_camera_params_.size());
+  std::vector<size_t> camera_num_copies(shared_camera_params_.size(), 0);
+  for (size_t i = 0; i < shared_camera_params_.size(); ++i) {
+    camera_sums[i].resize(shared_camera_params_[i].size(), 0.0);
+  }
+  std::vector<double> point3D_sums(shared_points3D_.size(), 0.0);
+  std::vector<size_t> point3D_num_copies(shared_points3D_.size() / 3, 0);
+
+  for (const auto& partition : partitions_) {
+    for (size_t i = 0; i < partition.shared_cameras.size(); ++i) {
+      const auto& shared_camera = partition.shared_cameras[i];
+      const auto& params = partition.camera_params[shared_camera.first];
+      auto& sum = camera_sums[shared_camera.second];
+      for (size_t k = 0; k < params.size(); ++k) {
+        sum[k] += params[k] + partition.camera_duals[i][k];
+      }
+      camera_num_copies[shared_camera.second] += 1;
+    }
+
+    for (size_t i = 0; i < partition.shared_points3D.size(); ++i) {
+      const auto& shared_point3D = partition.shared_points3D[i];
+      for (size_t k = 0; k < 3; ++k) {
+        point3D_sums[3 * shared_point3D.second + k] +=
+            partition.points3D[3 * shared_point3D.first + k] +
+            partition.point3D_duals[3 * i + k];
+      }
+      point3D_num_copies[shared_point3D.second] += 1;
+    }
+  }
+
+  // The dual residual measures the change of the consensus.
+  double dual_residual_sq = 0;
+  double consensus_norm_sq = 0;
+  for (size_t i = 0; i < shared_camera_params_.size(); ++i) {
+    for (size_t k = 0; k < shared_camera_params_[i].size(); ++k) {
+      const double value = camera_sums[i][k] / camera_num_copies[i];
+      const double diff = value - shared_camera_params_[i][k];
+      dual_residual_sq += camera_num_copies[i] * diff * diff;
+      consensus_norm_sq += camera_num_copies[i] * value * value;
+      shared_camera_params_[i][k] = value;
+    }
+  }
+  for (size_t i = 0; i < shared_points3D_.size(); ++i) {
+    const size_t num_copies = point3D_num_copies[i / 3];
+    const double value = point3D_sums[i] / num_copies;
+    const double diff = value - shared_points3D_[i];
+    dual_residual_sq += num_copies * diff * diff;
+    consensus_norm_sq += num_copies * value * value;
+    shared_points3D_[i] = value;
+  }
+
+  // The primal residual measures the disagreement of the copies, which is
+  // accumulated in the scaled dual variables.
+  size_t num_values = 0;
+  double primal_residual_sq = 0;
+  double value_norm_sq = 0;
+  double dual_norm_sq = 0;
+  for (auto& partition : partitions_) {
+    for (size_t i = 0; i < partition.shared_cameras.size(); ++i) {
+      const auto& shared_camera = partition.shared_cameras[i];
+      const auto& params = partition.camera_params[shared_camera.first];
+      const auto& consensus = shared_camera_params_[shared_camera.second];
+      for (size_t k = 0; k < params.size(); ++k) {
+        const double diff = params[k] - consensus[k];
+        partition.camera_duals[i][k] += diff;
+        primal_residual_sq += diff * diff;
+        value_norm_sq += params[k] * params[k];
+        dual_norm_sq +=
+            partition.camera_duals[i][k] * partition.camera_duals[i][k];
+        num_values += 1;
+      }
+    }
+
+    for (size_t i = 0; i < partition.shared_points3D.size(); ++i) {
+      const auto& shared_point3D = partition.shared_points3D[i];
+      for (size_t k = 0; k < 3; ++k) {
+        const double value = partition.points3D[3 * shared_point3D.first + k];
+        const double diff =
+            value - shared_points3D_[3 * shared_point3D.second + k];
+        partition.point3D_duals[3 * i + k] += diff;
+        primal_residual_sq += diff * diff;
+        value_norm_sq += value * value;
+        dual_norm_sq += partition.point3D_duals[3 * i + k] *
+                        partition.point3D_duals[3 * i + k];
+        num_values += 1;
+      }
+    }
+  }
+
+  report_.primal_residual = std::sqrt(primal_residual_sq);
+  report_.dual_residual = penalty_ * std::sqrt(dual_residual_sq);
+
+  const double abs_tolerance = options_.tolerance * std::sqrt(num_values);
+  const double primal_tolerance =
+      abs_tolerance +
+      options_.tolerance *
+          std::sqrt(std::max(value_norm_sq, consensus_norm_sq));
+  const double dual_tolerance =
+      abs_tolerance + options_.tolerance * penalty_ * std::sqrt(dual_norm_sq);
+  report_.converged = report_.primal_residual <= primal_tolerance &&
+                      report_.dual_residual <= dual_tolerance;
+
+  // Balance the primal and dual residuals by adapting the penalty, where the
+  // scaled dual variables must be rescaled accordingly.
+  const double kMaxResidualRatio = 10.0;
+  const double kPenaltyFactor = 2.0;
+  double penalty_factor = 1.0;
+  if (report_.primal_residual > kMaxResidualRatio * report_.dual_residual) {
+    penalty_factor = kPenaltyFactor;
+  } else if (report_.dual_residual >
+             kMaxResidualRatio * report_.primal_residual) {
+    penalty_factor = 1.0 / kPenaltyFactor;
+  }
+
+  if (penalty_factor != 1.0) {
+    penalty_ *= penalty_factor;
+    for (auto& partition : partitions_) {
+      for (auto& camera_duals : partition.camera_duals) {
+        for (auto& dual : camera_duals) {
+          dual /= penalty_factor;
+        }
+      }
+      for (auto& dual : partition.point3D_duals) {
+        dual /= penalty_factor;
+      }
+    }
+  }
+
+  report_.penalty = penalty_;
+}
+
+void PartitionedBundleAdjuster::TearDown(Reconstruction* reconstruction) {
+  for (const auto& partition : partitions_) {
+    for (size_t image_idx = 0; image_idx < partition.image_ids.size();
+         ++image_idx) {
+      if (partition.constant_poses[image_idx]) {
+        continue;
+      }
+      Image& image = reconstruction->Image(partition.image_ids[image_idx]);
+      for (size_t k = 0; k < 4; ++k) {
+        image.Qvec(k) = partition.qvecs[4 * image_idx + k];
+      }
+      for (size_t k = 0; k < 3; ++k) {
+        image.Tvec(k) = partition.tvecs[3 * image_idx + k];
+      }
+      image.NormalizeQvec();
+    }
+
+    for (size_t camera_idx = 0; camera_idx < partition.camera_ids.size();
+         ++camera_idx) {
+      const camera_t camera_id = partition.camera_ids[camera_idx];
+      if (constant_camera_ids_.count(camera_id) == 0) {
+        reconstruction->Camera(camera_id).Params() =
+            partition.camera_params[camera_idx];
+      }
+    }
+
+    for (size_t point3D_idx = 0; point3D_idx < partition.point3D_ids.size();
+         ++point3D_idx) {
+      const point3D_t point3D_id = partition.point3D_ids[point3D_idx];
+      if (constant_point3D_ids_.count(point3D_id) == 0) {
+        Eigen::Vector3d& xyz = reconstruction->Point3D(point3D_id).XYZ();
+        for (size_t k = 0; k < 3; ++k) {
+          xyz(k) = partition.points3D[3 * point3D_idx + k];
+        }
+      }
+    }
+  }
+
+  // The shared parameters are set to their consensus.
+  for (const auto& partition : partitions_) {
+    for (const auto& shared_camera : partition.shared_cameras) {
+      reconstruction->Camera(partition.camera_ids[shared_camera.first])
+          .Params() = shared_camera_params_[shared_camera.second];
+    }
+    for (const auto& shared_point3D : partition.shared_points3D) {
+      Eigen::Vector3d& xyz =
+          reconstruction->Point3D(partition.point3D_ids[shared_point3D.first])
+              .XYZ();
+      for (size_t k = 0; k < 3; ++k) {
+        xyz(k) = shared_points3D_[3 * shared_point3D.second + k];
+      }
+    }
+  }
+
+  // The partitions are only used for models that are too large to be solved
+  // as a single problem, so resynchronize all objects instead of journaling.
+  reconstruction->MarkAllModified();
+}
+
+size_t PartitionedBundleAdjuster::AddImageToPartition(
+    const image_t image_id, const bool constant_pose,
+    const Reconstruction& reconstruction, Partition* partition) {
+  const auto image_idx = partition->image_idxs.find(image_id);
+  if (image_idx != partition->image_idxs.end()) {
+    return image_idx->second;
+  }
+
+  const Image& image = reconstruction.Image(image_id);
+
+  // CostFunction assumes unit quaternions.
+  const Eigen::Vector4d qvec =
+      constant_pose ? image.Qvec() : NormalizeQuaternion(image.Qvec());
+
+  const size_t new_image_idx = partition->image_ids.size();
+  partition->image_idxs.emplace(image_id, new_image_idx);
+  partition->image_ids.push_back(image_id);
+  partition->constant_poses.push_back(constant_pose);
+  partition->qvecs.insert(partition->qvecs.end(), qvec.data(),
+                          qvec.data() + 4);
+  partition->tvecs.insert(partition->tvecs.end(), image.Tvec().data(),
+                          image.Tvec().data() + 3);
+
+  const auto camera_idx = partition->camera_idxs.find(image.CameraId());
+  if (camera_idx == partition->camera_idxs.end()) {
+    partition->image_camera_idxs.push_back(partition->camera_ids.size());
+    partition->camera_idxs.emplace(image.CameraId(),
+                                   partition->camera_ids.size());
+    partition->camera_ids.push_back(image.CameraId());
+    partition->camera_params.push_back(
+        reconstruction.Camera(image.CameraId()).Params());
+  } else {
+    partition->image_camera_idxs.push_back(camera_idx->second);
+  }
+
+  return new_image_idx;
+}
+
+size_t PartitionedBundleAdjuster::AddPointToPartition(
+    const point3D_t point3D_id, const Reconstruction& reconstruction,
+    Partition* partition) {
+  const auto point3D_idx = partition->point3D_idxs.find(point3D_id);
+  if (point3D_idx != partition->point3D_idxs.end()) {
+    return point3D_idx->second;
+  }
+
+  const Eigen::Vector3d& xyz = reconstruction.Point3D(point3D_id).XYZ();
+
+  const size_t new_point3D_idx = partition->point3D_ids.size();
+  partition->point3D_idxs.emplace(point3D_id, new_point3D_idx);
+  partition->point3D_ids.push_back(point3D_id);
+  partition->points3D.insert(partition->points3D.end(), xyz.data(),
+                             xyz.data() + 3);
+
+  return new_point3D_idx;
+}
+
+}  // namespace colmap
@@ -0,0 +1,179 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+#ifndef COLMAP_SRC_OPTIM_PARTITIONED_BUNDLE_ADJUSTMENT_H_
+#define COLMAP_SRC_OPTIM_PARTITIONED_BUNDLE_ADJUSTMENT_H_
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "base/reconstruction.h"
+#include "optim/bundle_adjustment.h"
+
+namespace colmap {
+
+// Bundle adjustment for models that are too large to be solved as a single
+// problem. The images of the configuration are partitioned into disjoint
+// clusters using normalized cuts on the covisibility graph and each cluster is
+// solved as an independent problem on local copies of its parameters. The
+// copies of cameras and 3D points shared between clusters are driven to a
+// common value using consensus ADMM (alternating direction method of
+// multipliers), which results in a globally consistent reconstruction. Only
+// the partitions that are currently solved hold a Ceres problem in memory.
+class PartitionedBundleAdjuster {
+ public:
+  struct Options {
+    // The maximum number of images per partition. Problems with fewer images
+    // are solved as a single problem using the standard bundle adjuster.
+    int max_num_images_per_partition = 1000;
+
+    // The maximum number of consensus iterations.
+    int max_num_iterations = 50;
+
+    // The maximum number of solver iterations per partition and consensus
+    // iteration.
+    int max_num_partition_iterations = 10;
+
+    // The initial weight of the quadratic penalty on the deviation of the
+    // shared parameters from their consensus. The weight is adapted during
+    // the iterations to balance the primal and dual residuals.
+    double initial_penalty = 1e4;
+
+    // The relative tolerance on the primal and dual residuals of the
+    // consensus for convergence.
+    double tolerance = 1e-6;
+
+    // The number of partitions solved in parallel.
+    int num_threads = -1;
+
+    // Whether to print a final summary.
+    bool print_summary = true;
+
+    bool Check() const;
+  };
+
+  struct Report {
+    size_t num_partitions = 0;
+    size_t num_shared_cameras = 0;
+    size_t num_shared_points3D = 0;
+    size_t num_iterations = 0;
+    double primal_residual = 0;
+    double dual_residual = 0;
+    double penalty = 0;
+    bool converged = false;
+  };
+
+  PartitionedBundleAdjuster(const Options& options,
+                            const BundleAdjustmentOptions& ba_options,
+                            const BundleAdjustmentConfig& config);
+
+  bool Solve(Reconstruction* reconstruction);
+
+  // Get the report for the last call to `Solve`.
+  const Report& GetReport() const;
+
+ private:
+  struct Observation {
+    size_t image_idx;
+    size_t point3D_idx;
+    double x;
+    double y;
+  };
+
+  struct Partition {
+    // The local copies of the image poses and whether they are constant.
+    std::vector<image_t> image_ids;
+    std::vector<size_t> image_camera_idxs;
+    std::vector<bool> constant_poses;
+    std::vector<double> qvecs;
+    std::vector<double> tvecs;
+
+    // The local copies of the camera parameters.
+    std::vector<camera_t> camera_ids;
+    std::vector<std::vector<double>> camera_params;
+
+    // The local copies of the 3D points.
+    std::vector<point3D_t> point3D_ids;
+    std::vector<double> points3D;
+
+    std::vector<Observation> observations;
+
+    // The local indices of the shared cameras and 3D points, their indices
+    // into the consensus, and the scaled dual variables of the copies.
+    std::vector<std::pair<size_t, size_t>> shared_cameras;
+    std::vector<std::vector<double>> camera_duals;
+    std::vector<std::pair<size_t, size_t>> shared_points3D;
+    std::vector<double> point3D_duals;
+
+    std::unordered_map<image_t, size_t> image_idxs;
+    std::unordered_map<camera_t, size_t> camera_idxs;
+    std::unordered_map<point3D_t, size_t> point3D_idxs;
+  };
+
+  bool SetUp(const Reconstruction& reconstruction);
+  bool SolvePartition(Partition* partition, const int num_threads) const;
+  void UpdateConsensus();
+  void TearDown(Reconstruction* reconstruction);
+
+  size_t AddImageToPartition(const image_t image_id, const bool constant_pose,
+                             const Reconstruction& reconstruction,
+                             Partition* partition);
+  size_t AddPointToPartition(const point3D_t point3D_id,
+                             const Reconstruction& reconstruction,
+                             Partition* partition);
+
+  const Options options_;
+  const BundleAdjustmentOptions ba_options_;
+  const BundleAdjustmentConfig config_;
+  Report report_;
+
+  std::vector<Partition> partitions_;
+
+  // Cameras and 3D points that are held constant in all partitions.
+  std::unordered_set<camera_t> constant_camera_ids_;
+  std::unordered_set<point3D_t> constant_point3D_ids_;
+
+  // The model and the indices of the constant parameters of the cameras.
+  std::unordered_map<camera_t, int> camera_model_ids_;
+  std::unordered_map<camera_t, std::vector<int>> constant_camera_params_;
+
+  // The consensus values of the shared cameras and 3D points.
+  std::vector<std::vector<double>> shared_camera_params_;
+  std::vector<double> shared_points3D_;
+
+  // The current penalty weight of the consensus.
+  double penalty_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_OPTIM_PARTITIONED_BUNDLE_ADJUSTMENT_H_
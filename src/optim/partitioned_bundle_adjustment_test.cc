@@ -0,0 +1,181 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+#define TEST_NAME "optim/partitioned_bundle_adjustment"
+#include "util/testing.h"
+
+#include "base/camera_models.h"
+#include "base/correspondence_graph.h"
+#include "base/projection.h"
+#include "optim/partitioned_bundle_adjustment.h"
+#include "util/random.h"
+
+using namespace colmap;
+
+void GenerateReconstruction(const size_t num_images, const size_t num_points,
+                            Reconstruction* reconstruction,
+                            CorrespondenceGraph* correspondence_graph) {
+  SetPRNGSeed(0);
+
+  for (size_t i = 0; i < num_points; ++i) {
+    const Eigen::Vector3d xyz(RandomReal(-1.0, 1.0), RandomReal(-1.0, 1.0),
+                              RandomReal(-1.0, 1.0));
+    reconstruction->AddPoint3D(xyz, Track());
+  }
+
+  const double kFocalLengthFactor = 1.2;
+  const size_t kImageSize = 1000;
+
+  for (size_t i = 0; i < num_images; ++i) {
+    const camera_t camera_id = static_cast<camera_t>(i);
+    const image_t image_id = static_cast<image_t>(i);
+
+    Camera camera;
+    camera.InitializeWithId(SimpleRadialCameraModel::model_id,
+                            kFocalLengthFactor * kImageSize, kImageSize,
+                            kImageSize);
+    camera.SetCameraId(camera_id);
+    reconstruction->AddCamera(camera);
+
+    Image image;
+    image.SetImageId(image_id);
+    image.SetCameraId(camera_id);
+    image.SetName(std::to_string(i));
+    image.Qvec() = ComposeIdentityQuaternion();
+    image.Tvec() =
+        Eigen::Vector3d(RandomReal(-1.0, 1.0), RandomReal(-1.0, 1.0), 10);
+    image.SetRegistered(true);
+    reconstruction->AddImage(image);
+
+    const Eigen::Matrix3x4d proj_matrix = image.ProjectionMatrix();
+
+    std::vector<Eigen::Vector2d> points2D;
+    for (const auto& point3D : reconstruction->Points3D()) {
+      Eigen::Vector2d point2D =
+          ProjectPointToImage(point3D.second.XYZ(), proj_matrix, camera);
+      point2D += Eigen::Vector2d(RandomReal(-2.0, 2.0), RandomReal(-2.0, 2.0));
+      points2D.push_back(point2D);
+    }
+
+    correspondence_graph->AddImage(image_id, num_points);
+    reconstruction->Image(image_id).SetPoints2D(points2D);
+  }
+
+  reconstruction->SetUp(correspondence_graph);
+
+  for (size_t i = 0; i < num_images; ++i) {
+    const image_t image_id = static_cast<image_t>(i);
+    TrackElement track_el;
+    track_el.image_id = image_id;
+    track_el.point2D_idx = 0;
+    for (const auto& point3D : reconstruction->Points3D()) {
+      reconstruction->AddObservation(point3D.first, track_el);
+      track_el.point2D_idx += 1;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestOptions) {
+  PartitionedBundleAdjuster::Options options;
+  BOOST_CHECK(options.Check());
+  options.max_num_images_per_partition = 0;
+  BOOST_CHECK(!options.Check());
+  options.max_num_images_per_partition = 1;
+  options.initial_penalty = 0;
+  BOOST_CHECK(!options.Check());
+}
+
+BOOST_AUTO_TEST_CASE(TestSinglePartition) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(2, 100, &reconstruction, &correspondence_graph);
+
+  BundleAdjustmentConfig config;
+  config.AddImage(0);
+  config.AddImage(1);
+  config.SetConstantPose(0);
+  config.SetConstantTvec(1, {0});
+
+  PartitionedBundleAdjuster::Options options;
+  options.print_summary = false;
+  BundleAdjustmentOptions ba_options;
+  ba_options.print_summary = false;
+  PartitionedBundleAdjuster bundle_adjuster(options, ba_options, config);
+  BOOST_REQUIRE(bundle_adjuster.Solve(&reconstruction));
+
+  const auto& report = bundle_adjuster.GetReport();
+  BOOST_CHECK_EQUAL(report.num_partitions, 1);
+  BOOST_CHECK_EQUAL(report.num_shared_cameras, 0);
+  BOOST_CHECK_EQUAL(report.num_shared_points3D, 0);
+  BOOST_CHECK(report.converged);
+}
+
+BOOST_AUTO_TEST_CASE(TestMultiplePartitions) {
+  Reconstruction reconstruction;
+  CorrespondenceGraph correspondence_graph;
+  GenerateReconstruction(6, 100, &reconstruction, &correspondence_graph);
+  const auto orig_reconstruction = reconstruction;
+  const double orig_mean_reproj_error =
+      reconstruction.ComputeMeanReprojectionError();
+
+  BundleAdjustmentConfig config;
+  for (image_t image_id = 0; image_id < 6; ++image_id) {
+    config.AddImage(image_id);
+  }
+  config.SetConstantPose(0);
+  config.SetConstantTvec(1, {0});
+
+  PartitionedBundleAdjuster::Options options;
+  options.max_num_images_per_partition = 3;
+  options.print_summary = false;
+  BundleAdjustmentOptions ba_options;
+  ba_options.print_summary = false;
+  PartitionedBundleAdjuster bundle_adjuster(options, ba_options, config);
+  BOOST_REQUIRE(bundle_adjuster.Solve(&reconstruction));
+
+  // All points are observed in all images and hence shared, while each image
+  // has its own camera, which is therefore not shared.
+  const auto& report = bundle_adjuster.GetReport();
+  BOOST_CHECK_GT(report.num_partitions, 1);
+  BOOST_CHECK_EQUAL(report.num_shared_cameras, 0);
+  BOOST_CHECK_EQUAL(report.num_shared_points3D, 100);
+  BOOST_CHECK_GE(report.num_iterations, 1);
+  BOOST_CHECK_LE(report.num_iterations, options.max_num_iterations);
+
+  BOOST_CHECK_EQUAL(reconstruction.Image(0).Qvec(),
+                    orig_reconstruction.Image(0).Qvec());
+  BOOST_CHECK_EQUAL(reconstruction.Image(0).Tvec(),
+                    orig_reconstruction.Image(0).Tvec());
+  BOOST_CHECK_EQUAL(reconstruction.Image(1).Tvec(0),
+                    orig_reconstruction.Image(1).Tvec(0));
+  BOOST_CHECK_LE(reconstruction.ComputeMeanReprojectionError(),
+                 orig_mean_reproj_error);
+}
@@ -47,7 +47,8 @@ class RandomSampler : public Sampler {
 
   size_t MaxNumSamples() override;
 
-  std::vector<size_t> Sample() override;
+  using Sampler::Sample;
+  void Sample(std::vector<size_t>* sampled_idxs) override;
 
  private:
   const size_t num_samples_;
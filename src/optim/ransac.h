@@ -32,15 +32,25 @@
 #ifndef COLMAP_SRC_OPTIM_RANSAC_H_
 #define COLMAP_SRC_OPTIM_RANSAC_H_
 
+#include <array>
 #include <cfloat>
+#include <functional>
+#include <memory>
+#include <numeric>
 #include <random>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "optim/random_sampler.h"
+#include "optim/sprt.h"
 #include "optim/support_measurement.h"
 #include "util/alignment.h"
 #include "util/logging.h"
+#include "util/profiling.h"
+#include "util/random.h"
+#include "util/threading.h"
 
 namespace colmap {
 
@@ -65,6 +75,32 @@ struct RANSACOptions {
   size_t min_num_trials = 0;
   size_t max_num_trials = std::numeric_limits<size_t>::max();
 
+  // Number of threads used to estimate and evaluate the models of multiple
+  // trials in parallel. The trials are sampled in the same sequence and
+  // processed in the same order as with a single thread, so that the results
+  // are identical, but up to one batch of trials may be evaluated in vain
+  // before termination. The estimator must support concurrent calls.
+  int num_threads = 1;
+
+  // Whether to verify the models with the Sequential Probability Ratio Test,
+  // which rejects a model with little support after computing the residuals
+  // of only a few randomly chosen samples. This is faster for low inlier
+  // ratios, at the cost of occasionally rejecting a good model. The test
+  // adapts to the best model found so far, so with multiple threads the
+  // results can differ from a single thread.
+  bool use_sprt = false;
+
+  // Maximum number of local optimizations in LO-RANSAC. Early in the run a
+  // new best model is found frequently, so that later models are only locally
+  // optimized once at the end if the budget is exhausted.
+  size_t max_num_local_optimizations = 25;
+
+  // Maximum number of inliers used to locally optimize a model in the
+  // LO-RANSAC loop. For more inliers, the model is estimated from a random
+  // subset and the best model is refined once more on all of its inliers
+  // at the end.
+  size_t max_num_local_optimization_samples = 1000;
+
   void Check() const {
     CHECK_GT(max_error, 0);
     CHECK_GE(min_inlier_ratio, 0);
@@ -72,7 +108,88 @@ struct RANSACOptions {
     CHECK_GE(confidence, 0);
     CHECK_LE(confidence, 1);
     CHECK_LE(min_num_trials, max_num_trials);
+    CHECK_NE(num_threads, 0);
+    CHECK_GT(max_num_local_optimization_samples, 0);
+  }
+};
+
+// Estimates the models of random minimal samples in the hypothesis loop.
+// Estimators can optionally implement an allocation-free minimal solver,
+// which is then used instead of `Estimate`:
+//
+//    // The maximum number of models estimated from a minimal sample.
+//    static const int kMaxNumModels = ...;
+//
+//    static size_t EstimateMinimal(
+//        const std::array<X_t, kMinNumSamples>& X,
+//        const std::array<Y_t, kMinNumSamples>& Y,
+//        std::array<M_t, kMaxNumModels>* models);
+//
+// The samples and models are then kept in fixed-size buffers that are reused
+// for all trials, such that no memory is allocated per hypothesis.
+template <typename Estimator, typename Enable = void>
+class MinimalSampleEstimator {
+ public:
+  MinimalSampleEstimator()
+      : X_rand_(Estimator::kMinNumSamples),
+        Y_rand_(Estimator::kMinNumSamples) {}
+
+  // Sample a minimal subset and estimate its models, returns the number
+  // of estimated models.
+  template <typename Sampler>
+  size_t Estimate(const std::vector<typename Estimator::X_t>& X,
+                  const std::vector<typename Estimator::Y_t>& Y,
+                  Sampler* sampler, Estimator* estimator) {
+    sampler->SampleXY(X, Y, &X_rand_, &Y_rand_);
+    models_ = estimator->Estimate(X_rand_, Y_rand_);
+    return models_.size();
+  }
+
+  const typename Estimator::M_t& Model(const size_t idx) const {
+    return models_[idx];
+  }
+
+ private:
+  std::vector<typename Estimator::X_t> X_rand_;
+  std::vector<typename Estimator::Y_t> Y_rand_;
+  std::vector<typename Estimator::M_t> models_;
+};
+
+template <typename Estimator>
+struct HasMinimalSolver {
+  template <typename T>
+  static std::true_type Test(decltype(T::EstimateMinimal(
+      std::declval<const std::array<typename T::X_t, T::kMinNumSamples>&>(),
+      std::declval<const std::array<typename T::Y_t, T::kMinNumSamples>&>(),
+      std::declval<std::array<typename T::M_t, T::kMaxNumModels>*>()))*);
+  template <typename T>
+  static std::false_type Test(...);
+  static const bool value = decltype(Test<Estimator>(nullptr))::value;
+};
+
+template <typename Estimator>
+class MinimalSampleEstimator<
+    Estimator,
+    typename std::enable_if<HasMinimalSolver<Estimator>::value>::type> {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  template <typename Sampler>
+  size_t Estimate(const std::vector<typename Estimator::X_t>& X,
+                  const std::vector<typename Estimator::Y_t>& Y,
+                  Sampler* sampler, Estimator* estimator) {
+    sampler->SampleXY(X, Y, &X_rand_, &Y_rand_);
+    return estimator->EstimateMinimal(X_rand_, Y_rand_, &models_);
   }
+
+  const typename Estimator::M_t& Model(const size_t idx) const {
+    return models_[idx];
+  }
+
+ private:
+  std::array<typename Estimator::X_t, Estimator::kMinNumSamples> X_rand_;
+  std::array<typename Estimator::Y_t, Estimator::kMinNumSamples> Y_rand_;
+  std::array<typename Estimator::M_t, Estimator::kMaxNumModels> models_;
 };
 
 template <typename Estimator, typename SupportMeasurer = InlierSupportMeasurer,
@@ -132,8 +249,72 @@ class RANSAC {
   Sampler sampler;
   SupportMeasurer support_measurer;
 
+  // Optional function to evaluate the supports of the models of multiple
+  // trials at once, e.g. on the GPU, instead of computing the residuals of
+  // each model separately. The trials are sampled in batches of
+  // `batch_evaluator_size` and processed in the same order as otherwise. The
+  // function is not used in combination with the SPRT.
+  typedef std::function<void(
+      const std::vector<typename Estimator::X_t>& X,
+      const std::vector<typename Estimator::Y_t>& Y,
+      const std::vector<typename Estimator::M_t>& models,
+      const double max_residual,
+      std::vector<typename SupportMeasurer::Support>* supports)>
+      BatchEvaluator;
+  BatchEvaluator batch_evaluator;
+  size_t batch_evaluator_size = 32;
+
  protected:
+  // The estimated models and their support for a batch of trials, where the
+  // models of the i-th trial in the batch are stored at the i-th position.
+  struct TrialBatch {
+    std::vector<std::vector<typename Estimator::M_t>> models;
+    std::vector<std::vector<typename SupportMeasurer::Support>> supports;
+    size_t num_processed = 0;
+
+    bool IsProcessed() const { return num_processed == models.size(); }
+  };
+
+  // The randomly permuted samples split into blocks, which are successively
+  // verified by the SPRT, and the original indices of the samples.
+  struct VerificationBlocks {
+    std::vector<std::vector<typename Estimator::X_t>> X;
+    std::vector<std::vector<typename Estimator::Y_t>> Y;
+    std::vector<std::vector<size_t>> indices;
+  };
+
+  static void InitializeVerificationBlocks(
+      const std::vector<typename Estimator::X_t>& X,
+      const std::vector<typename Estimator::Y_t>& Y,
+      VerificationBlocks* blocks);
+
+  // Determine the SPRT options for the given inlier ratio of the best model.
+  static SPRT::Options GetSPRTOptions(const double inlier_ratio);
+
+  // Compute the residuals and support of a model. If `sprt` is given, the
+  // model is verified block by block and rejected as soon as the test fails,
+  // in which case the residuals are incomplete and the support is set to its
+  // default value, which never compares better than any other support.
+  void EvaluateModel(const std::vector<typename Estimator::X_t>& X,
+                     const std::vector<typename Estimator::Y_t>& Y,
+                     const VerificationBlocks& blocks, const SPRT* sprt,
+                     const typename Estimator::M_t& model,
+                     const double max_residual, std::vector<double>* residuals,
+                     typename SupportMeasurer::Support* support);
+
+  // The number of trials per batch, or zero if the trials are not batched.
+  size_t GetTrialBatchSize(const SPRT* sprt) const;
+
+  // Sample the next trials and estimate and evaluate their models, either in
+  // the thread pool or using the batch evaluator.
+  void EvaluateTrialBatch(const std::vector<typename Estimator::X_t>& X,
+                          const std::vector<typename Estimator::Y_t>& Y,
+                          const VerificationBlocks& blocks, const SPRT* sprt,
+                          const size_t num_trials, const double max_residual,
+                          TrialBatch* batch);
+
   RANSACOptions options_;
+  std::unique_ptr<ThreadPool> thread_pool_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -153,6 +334,11 @@ RANSAC<Estimator, SupportMeasurer, Sampler>::RANSAC(
       options_.confidence, options_.dyn_num_trials_multiplier);
   options_.max_num_trials =
       std::min<size_t>(options_.max_num_trials, dyn_max_num_trials);
+
+  const int num_threads = GetEffectiveNumThreads(options_.num_threads);
+  if (num_threads > 1) {
+    thread_pool_.reset(new ThreadPool(num_threads));
+  }
 }
 
 template <typename Estimator, typename SupportMeasurer, typename Sampler>
@@ -175,6 +361,172 @@ size_t RANSAC<Estimator, SupportMeasurer, Sampler>::ComputeNumTrials(
       std::ceil(std::log(nom) / std::log(denom) * num_trials_multiplier));
 }
 
+template <typename Estimator, typename SupportMeasurer, typename Sampler>
+void RANSAC<Estimator, SupportMeasurer, Sampler>::InitializeVerificationBlocks(
+    const std::vector<typename Estimator::X_t>& X,
+    const std::vector<typename Estimator::Y_t>& Y,
+    VerificationBlocks* blocks) {
+  // Small enough to reject hopeless models after a few dozen residuals, but
+  // large enough to amortize the per-call overhead of the estimators.
+  const size_t kBlockSize = 32;
+
+  std::vector<size_t> indices(X.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  Shuffle(static_cast<uint32_t>(indices.size()), &indices);
+
+  const size_t num_blocks = (indices.size() + kBlockSize - 1) / kBlockSize;
+  blocks->X.resize(num_blocks);
+  blocks->Y.resize(num_blocks);
+  blocks->indices.resize(num_blocks);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    const size_t begin = i * kBlockSize;
+    const size_t end = std::min(begin + kBlockSize, indices.size());
+    blocks->X[i].clear();
+    blocks->Y[i].clear();
+    blocks->indices[i].assign(indices.begin() + begin, indices.begin() + end);
+    for (const size_t idx : blocks->indices[i]) {
+      blocks->X[i].push_back(X[idx]);
+      blocks->Y[i].push_back(Y[idx]);
+    }
+  }
+}
+
+template <typename Estimator, typename SupportMeasurer, typename Sampler>
+SPRT::Options RANSAC<Estimator, SupportMeasurer, Sampler>::GetSPRTOptions(
+    const double inlier_ratio) {
+  SPRT::Options options;
+  // The test requires that good models have a higher inlier ratio than bad
+  // models and is undefined for an inlier ratio of one.
+  options.epsilon =
+      std::min(std::max(inlier_ratio, 2 * options.delta), 1 - options.delta);
+  return options;
+}
+
+template <typename Estimator, typename SupportMeasurer, typename Sampler>
+void RANSAC<Estimator, SupportMeasurer, Sampler>::EvaluateModel(
+    const std::vector<typename Estimator::X_t>& X,
+    const std::vector<typename Estimator::Y_t>& Y,
+    const VerificationBlocks& blocks, const SPRT* sprt,
+    const typename Estimator::M_t& model, const double max_residual,
+    std::vector<double>* residuals,
+    typename SupportMeasurer::Support* support) {
+  if (sprt == nullptr) {
+    estimator.Residuals(X, Y, model, residuals);
+    CHECK_EQ(residuals->size(), X.size());
+    *support = support_measurer.Evaluate(*residuals, max_residual);
+    return;
+  }
+
+  residuals->resize(X.size());
+
+  double likelihood_ratio = 1;
+  size_t num_inliers = 0;
+  size_t num_eval_samples = 0;
+  std::vector<double> block_residuals;
+  for (size_t i = 0; i < blocks.indices.size(); ++i) {
+    estimator.Residuals(blocks.X[i], blocks.Y[i], model, &block_residuals);
+    CHECK_EQ(block_residuals.size(), blocks.indices[i].size());
+    if (!sprt->Evaluate(block_residuals, max_residual, &likelihood_ratio,
+                        &num_inliers, &num_eval_samples)) {
+      *support = typename SupportMeasurer::Support();
+      return;
+    }
+    for (size_t j = 0; j < block_residuals.size(); ++j) {
+      (*residuals)[blocks.indices[i][j]] = block_residuals[j];
+    }
+  }
+
+  *support = support_measurer.Evaluate(*residuals, max_residual);
+}
+
+template <typename Estimator, typename SupportMeasurer, typename Sampler>
+size_t RANSAC<Estimator, SupportMeasurer, Sampler>::GetTrialBatchSize(
+    const SPRT* sprt) const {
+  if (batch_evaluator && sprt == nullptr) {
+    CHECK_GT(batch_evaluator_size, 0);
+    return batch_evaluator_size;
+  } else if (thread_pool_) {
+    return thread_pool_->NumThreads();
+  } else {
+    return 0;
+  }
+}
+
+template <typename Estimator, typename SupportMeasurer, typename Sampler>
+void RANSAC<Estimator, SupportMeasurer, Sampler>::EvaluateTrialBatch(
+    const std::vector<typename Estimator::X_t>& X,
+    const std::vector<typename Estimator::Y_t>& Y,
+    const VerificationBlocks& blocks, const SPRT* sprt, const size_t num_trials,
+    const double max_residual, TrialBatch* batch) {
+  CHECK_GT(num_trials, 0);
+
+  // The sampler is not thread-safe, so all subsets are sampled up front.
+  std::vector<std::vector<typename Estimator::X_t>> X_rand(
+      num_trials,
+      std::vector<typename Estimator::X_t>(Estimator::kMinNumSamples));
+  std::vector<std::vector<typename Estimator::Y_t>> Y_rand(
+      num_trials,
+      std::vector<typename Estimator::Y_t>(Estimator::kMinNumSamples));
+  for (size_t i = 0; i < num_trials; ++i) {
+    sampler.SampleXY(X, Y, &X_rand[i], &Y_rand[i]);
+  }
+
+  batch->models.clear();
+  batch->models.resize(num_trials);
+  batch->supports.clear();
+  batch->supports.resize(num_trials);
+  batch->num_processed = 0;
+
+  const bool evaluate_batch = batch_evaluator && sprt == nullptr;
+
+  auto EvaluateTrial = [&](const size_t i) {
+    batch->models[i] = estimator.Estimate(X_rand[i], Y_rand[i]);
+    if (evaluate_batch) {
+      return;
+    }
+    batch->supports[i].resize(batch->models[i].size());
+    std::vector<double> residuals(X.size());
+    for (size_t j = 0; j < batch->models[i].size(); ++j) {
+      EvaluateModel(X, Y, blocks, sprt, batch->models[i][j], max_residual,
+                    &residuals, &batch->supports[i][j]);
+    }
+  };
+
+  if (thread_pool_) {
+    std::vector<std::future<void>> futures;
+    futures.reserve(num_trials);
+    for (size_t i = 0; i < num_trials; ++i) {
+      futures.push_back(thread_pool_->AddTask(EvaluateTrial, i));
+    }
+    for (auto& future : futures) {
+      future.get();
+    }
+  } else {
+    for (size_t i = 0; i < num_trials; ++i) {
+      EvaluateTrial(i);
+    }
+  }
+
+  if (!evaluate_batch) {
+    return;
+  }
+
+  std::vector<typename Estimator::M_t> models;
+  for (const auto& trial_models : batch->models) {
+    models.insert(models.end(), trial_models.begin(), trial_models.end());
+  }
+
+  std::vector<typename SupportMeasurer::Support> supports;
+  batch_evaluator(X, Y, models, max_residual, &supports);
+  CHECK_EQ(supports.size(), models.size());
+
+  auto support = supports.begin();
+  for (size_t i = 0; i < num_trials; ++i) {
+    batch->supports[i].assign(support, support + batch->models[i].size());
+    support += batch->models[i].size();
+  }
+}
+
 template <typename Estimator, typename SupportMeasurer, typename Sampler>
 typename RANSAC<Estimator, SupportMeasurer, Sampler>::Report
 RANSAC<Estimator, SupportMeasurer, Sampler>::Estimate(
@@ -201,15 +553,28 @@ RANSAC<Estimator, SupportMeasurer, Sampler>::Estimate(
 
   std::vector<double> residuals(num_samples);
 
-  std::vector<typename Estimator::X_t> X_rand(Estimator::kMinNumSamples);
-  std::vector<typename Estimator::Y_t> Y_rand(Estimator::kMinNumSamples);
+  MinimalSampleEstimator<Estimator> minimal_estimator;
 
   sampler.Initialize(num_samples);
 
+  VerificationBlocks blocks;
+  std::unique_ptr<SPRT> sprt;
+  if (options_.use_sprt) {
+    InitializeVerificationBlocks(X, Y, &blocks);
+    sprt.reset(new SPRT(GetSPRTOptions(options_.min_inlier_ratio)));
+  }
+
+  const size_t batch_size = GetTrialBatchSize(sprt.get());
+
   size_t max_num_trials = options_.max_num_trials;
   max_num_trials = std::min<size_t>(max_num_trials, sampler.MaxNumSamples());
   size_t dyn_max_num_trials = max_num_trials;
 
+  TrialBatch batch;
+  std::vector<typename Estimator::M_t> sample_models;
+  std::vector<typename SupportMeasurer::Support> sample_supports;
+  size_t num_sample_models = 0;
+
   for (report.num_trials = 0; report.num_trials < max_num_trials;
        ++report.num_trials) {
     if (abort) {
@@ -217,24 +582,48 @@ RANSAC<Estimator, SupportMeasurer, Sampler>::Estimate(
       break;
     }
 
-    sampler.SampleXY(X, Y, &X_rand, &Y_rand);
-
-    // Estimate model for current subset.
-    const std::vector<typename Estimator::M_t> sample_models =
-        estimator.Estimate(X_rand, Y_rand);
+    if (batch_size > 0) {
+      if (batch.IsProcessed()) {
+        EvaluateTrialBatch(
+            X, Y, blocks, sprt.get(),
+            std::min<size_t>(batch_size, max_num_trials - report.num_trials),
+            max_residual, &batch);
+      }
+      sample_models = std::move(batch.models[batch.num_processed]);
+      sample_supports = std::move(batch.supports[batch.num_processed]);
+      batch.num_processed += 1;
+      num_sample_models = sample_models.size();
+    } else {
+      // Estimate model for current subset.
+      num_sample_models =
+          minimal_estimator.Estimate(X, Y, &sampler, &estimator);
+    }
 
     // Iterate through all estimated models.
-    for (const auto& sample_model : sample_models) {
-      estimator.Residuals(X, Y, sample_model, &residuals);
-      CHECK_EQ(residuals.size(), X.size());
-
-      const auto support = support_measurer.Evaluate(residuals, max_residual);
+    for (size_t i = 0; i < num_sample_models; ++i) {
+      const auto& sample_model = batch_size > 0
+                                     ? sample_models[i]
+                                     : minimal_estimator.Model(i);
+
+      typename SupportMeasurer::Support support;
+      if (batch_size > 0) {
+        support = sample_supports[i];
+      } else {
+        EvaluateModel(X, Y, blocks, sprt.get(), sample_model, max_residual,
+                      &residuals, &support);
+      }
 
       // Save as best subset if better than all previous subsets.
       if (support_measurer.Compare(support, best_support)) {
         best_support = support;
         best_model = sample_model;
 
+        // Adapt the test to the inlier ratio of the best model.
+        if (sprt) {
+          sprt->Update(GetSPRTOptions(best_support.num_inliers /
+                                      static_cast<double>(num_samples)));
+        }
+
         dyn_max_num_trials = ComputeNumTrials(
             best_support.num_inliers, num_samples, options_.confidence,
             options_.dyn_num_trials_multiplier);
@@ -251,6 +640,8 @@ RANSAC<Estimator, SupportMeasurer, Sampler>::Estimate(
   report.support = best_support;
   report.model = best_model;
 
+  ProfileCounter("ransac_trials", report.num_trials);
+
   // No valid model was found.
   if (report.support.num_inliers < estimator.kMinNumSamples) {
     return report;
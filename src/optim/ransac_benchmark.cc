@@ -0,0 +1,217 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "base/synthetic.h"
+#include "estimators/absolute_pose.h"
+#include "estimators/affine_transform.h"
+#include "estimators/essential_matrix.h"
+#include "estimators/fundamental_matrix.h"
+#include "estimators/homography_matrix.h"
+#include "estimators/similarity_transform.h"
+#include "optim/ransac.h"
+#include "util/random.h"
+
+using namespace colmap;
+
+namespace {
+
+const double kOutlierRatio = 0.3;
+const double kMaxErrorPixels = 4.0;
+
+// Correspondences between two views of a synthetic scene with outliers.
+struct TwoViewData {
+  std::vector<Eigen::Vector2d> points1;
+  std::vector<Eigen::Vector2d> points2;
+  std::vector<Eigen::Vector2d> normalized_points1;
+  std::vector<Eigen::Vector2d> normalized_points2;
+  std::vector<Eigen::Vector3d> points3D;
+  std::vector<Eigen::Vector3d> transformed_points3D;
+  double normalized_max_error = 0;
+};
+
+TwoViewData CreateTwoViewData() {
+  SetPRNGSeed(0);
+
+  SyntheticDatasetOptions options;
+  options.num_cameras = 1;
+  options.num_images = 8;
+  options.num_points3D = 1000;
+  options.num_points2D_without_point3D = 0;
+  options.camera_model_name = "PINHOLE";
+  options.point2D_stddev = 0.5;
+  Reconstruction reconstruction;
+  SynthesizeDataset(options, &reconstruction);
+
+  const Camera& camera = reconstruction.Camera(1);
+  const Image& image1 = reconstruction.Image(1);
+  const Image& image2 = reconstruction.Image(2);
+
+  const Eigen::Matrix3d R = Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitX())
+                                .toRotationMatrix();
+  const Eigen::Vector3d t(0.1, 0.2, 0.3);
+  const double scale = 1.5;
+
+  TwoViewData data;
+  for (const auto& point3D : reconstruction.Points3D()) {
+    const auto& track_els = point3D.second.Track().Elements();
+    Eigen::Vector2d point1 = image1.Point2D(track_els[0].point2D_idx).XY();
+    Eigen::Vector2d point2 = image2.Point2D(track_els[1].point2D_idx).XY();
+    Eigen::Vector3d transformed_point3D =
+        scale * R * point3D.second.XYZ() + t;
+    if (RandomReal(0.0, 1.0) < kOutlierRatio) {
+      point2 = Eigen::Vector2d(RandomReal(0.0, 1.0 * camera.Width()),
+                               RandomReal(0.0, 1.0 * camera.Height()));
+      transformed_point3D = Eigen::Vector3d::Random();
+    }
+    data.points1.push_back(point1);
+    data.points2.push_back(point2);
+    data.normalized_points1.push_back(camera.ImageToWorld(point1));
+    data.normalized_points2.push_back(camera.ImageToWorld(point2));
+    data.points3D.push_back(point3D.second.XYZ());
+    data.transformed_points3D.push_back(transformed_point3D);
+  }
+
+  data.normalized_max_error = camera.ImageToWorldThreshold(kMaxErrorPixels);
+
+  return data;
+}
+
+const TwoViewData& GetTwoViewData() {
+  static const TwoViewData data = CreateTwoViewData();
+  return data;
+}
+
+template <typename Estimator>
+void RunRANSAC(benchmark::State& state,
+               const std::vector<typename Estimator::X_t>& X,
+               const std::vector<typename Estimator::Y_t>& Y,
+               const double max_error) {
+  RANSACOptions options;
+  options.max_error = max_error;
+  options.min_inlier_ratio = 0.25;
+  options.confidence = 0.9999;
+  RANSAC<Estimator> ransac(options);
+  size_t num_trials = 0;
+  for (auto _ : state) {
+    SetPRNGSeed(0);
+    const auto report = ransac.Estimate(X, Y);
+    num_trials = report.num_trials;
+    benchmark::DoNotOptimize(report);
+  }
+  state.counters["num_trials"] = num_trials;
+}
+
+}  // namespace
+
+static void BM_RANSACEssentialMatrixFivePoint(benchmark::State& state) {
+  const auto& data = GetTwoViewData();
+  RunRANSAC<EssentialMatrixFivePointEstimator>(state, data.normalized_points1,
+                                               data.normalized_points2,
+                                               data.normalized_max_error);
+}
+
+BENCHMARK(BM_RANSACEssentialMatrixFivePoint)->Unit(benchmark::kMillisecond);
+
+static void BM_RANSACEssentialMatrixFivePointSturm(benchmark::State& state) {
+  const auto& data = GetTwoViewData();
+  RunRANSAC<EssentialMatrixFivePointSturmEstimator>(
+      state, data.normalized_points1, data.normalized_points2,
+      data.normalized_max_error);
+}
+
+BENCHMARK(BM_RANSACEssentialMatrixFivePointSturm)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_RANSACEssentialMatrixEightPoint(benchmark::State& state) {
+  const auto& data = GetTwoViewData();
+  RunRANSAC<EssentialMatrixEightPointEstimator>(state, data.normalized_points1,
+                                                data.normalized_points2,
+                                                data.normalized_max_error);
+}
+
+BENCHMARK(BM_RANSACEssentialMatrixEightPoint)->Unit(benchmark::kMillisecond);
+
+static void BM_RANSACFundamentalMatrixSevenPoint(benchmark::State& state) {
+  const auto& data = GetTwoViewData();
+  RunRANSAC<FundamentalMatrixSevenPointEstimator>(
+      state, data.points1, data.points2, kMaxErrorPixels);
+}
+
+BENCHMARK(BM_RANSACFundamentalMatrixSevenPoint)->Unit(benchmark::kMillisecond);
+
+static void BM_RANSACFundamentalMatrixEightPoint(benchmark::State& state) {
+  const auto& data = GetTwoViewData();
+  RunRANSAC<FundamentalMatrixEightPointEstimator>(
+      state, data.points1, data.points2, kMaxErrorPixels);
+}
+
+BENCHMARK(BM_RANSACFundamentalMatrixEightPoint)->Unit(benchmark::kMillisecond);
+
+static void BM_RANSACHomographyMatrix(benchmark::State& state) {
+  const auto& data = GetTwoViewData();
+  RunRANSAC<HomographyMatrixEstimator>(state, data.points1, data.points2,
+                                       kMaxErrorPixels);
+}
+
+BENCHMARK(BM_RANSACHomographyMatrix)->Unit(benchmark::kMillisecond);
+
+static void BM_RANSACAffineTransform(benchmark::State& state) {
+  const auto& data = GetTwoViewData();
+  RunRANSAC<AffineTransformEstimator>(state, data.points1, data.points2,
+                                      kMaxErrorPixels);
+}
+
+BENCHMARK(BM_RANSACAffineTransform)->Unit(benchmark::kMillisecond);
+
+static void BM_RANSACP3P(benchmark::State& state) {
+  const auto& data = GetTwoViewData();
+  RunRANSAC<P3PEstimator>(state, data.normalized_points1, data.points3D,
+                          data.normalized_max_error);
+}
+
+BENCHMARK(BM_RANSACP3P)->Unit(benchmark::kMillisecond);
+
+static void BM_RANSACEPNP(benchmark::State& state) {
+  const auto& data = GetTwoViewData();
+  RunRANSAC<EPNPEstimator>(state, data.normalized_points1, data.points3D,
+                           data.normalized_max_error);
+}
+
+BENCHMARK(BM_RANSACEPNP)->Unit(benchmark::kMillisecond);
+
+static void BM_RANSACSimilarityTransform3D(benchmark::State& state) {
+  const auto& data = GetTwoViewData();
+  RunRANSAC<SimilarityTransformEstimator<3>>(
+      state, data.points3D, data.transformed_points3D, 1e-3);
+}
+
+BENCHMARK(BM_RANSACSimilarityTransform3D)->Unit(benchmark::kMillisecond);
@@ -50,6 +50,8 @@ BOOST_AUTO_TEST_CASE(TestOptions) {
   BOOST_CHECK_EQUAL(options.confidence, 0.99);
   BOOST_CHECK_EQUAL(options.min_num_trials, 0);
   BOOST_CHECK_EQUAL(options.max_num_trials, std::numeric_limits<size_t>::max());
+  BOOST_CHECK_EQUAL(options.num_threads, 1);
+  BOOST_CHECK_EQUAL(options.use_sprt, false);
 }
 
 BOOST_AUTO_TEST_CASE(TestReport) {
@@ -136,3 +138,162 @@ BOOST_AUTO_TEST_CASE(TestSimilarityTransform) {
       (orig_tform.Matrix().topLeftCorner<3, 4>() - report.model).norm();
   BOOST_CHECK(std::abs(matrix_diff) < 1e-6);
 }
+
+BOOST_AUTO_TEST_CASE(TestSimilarityTransformParallel) {
+  SetPRNGSeed(0);
+
+  const size_t num_samples = 1000;
+  const size_t num_outliers = 700;
+
+  const SimilarityTransform3 orig_tform(2, ComposeIdentityQuaternion(),
+                                        Eigen::Vector3d(100, 10, 10));
+
+  std::vector<Eigen::Vector3d> src;
+  std::vector<Eigen::Vector3d> dst;
+  for (size_t i = 0; i < num_samples; ++i) {
+    src.emplace_back(i, std::sqrt(i) + 2, std::sqrt(2 * i + 2));
+    dst.push_back(src.back());
+    orig_tform.TransformPoint(&dst.back());
+  }
+
+  for (size_t i = 0; i < num_outliers; ++i) {
+    dst[i] = Eigen::Vector3d(RandomReal(-3000.0, -2000.0),
+                             RandomReal(-4000.0, -3000.0),
+                             RandomReal(-5000.0, -4000.0));
+  }
+
+  // The parallel evaluation must produce identical results for the same
+  // sequence of random samples.
+  auto Estimate = [&](const int num_threads) {
+    RANSACOptions options;
+    options.max_error = 10;
+    options.num_threads = num_threads;
+    RANSAC<SimilarityTransformEstimator<3>> ransac(options);
+    SetPRNGSeed(1);
+    return ransac.Estimate(src, dst);
+  };
+
+  const auto report = Estimate(1);
+  BOOST_CHECK_EQUAL(report.success, true);
+  BOOST_CHECK_EQUAL(report.support.num_inliers, num_samples - num_outliers);
+
+  for (const int num_threads : {2, 3, 8}) {
+    const auto parallel_report = Estimate(num_threads);
+    BOOST_CHECK_EQUAL(parallel_report.success, report.success);
+    BOOST_CHECK_EQUAL(parallel_report.num_trials, report.num_trials);
+    BOOST_CHECK_EQUAL(parallel_report.support.num_inliers,
+                      report.support.num_inliers);
+    BOOST_CHECK_EQUAL(parallel_report.support.residual_sum,
+                      report.support.residual_sum);
+    BOOST_CHECK(parallel_report.inlier_mask == report.inlier_mask);
+    BOOST_CHECK_EQUAL(parallel_report.model, report.model);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestSimilarityTransformSPRT) {
+  SetPRNGSeed(0);
+
+  const size_t num_samples = 1000;
+  const size_t num_outliers = 700;
+
+  const SimilarityTransform3 orig_tform(2, ComposeIdentityQuaternion(),
+                                        Eigen::Vector3d(100, 10, 10));
+
+  std::vector<Eigen::Vector3d> src;
+  std::vector<Eigen::Vector3d> dst;
+  for (size_t i = 0; i < num_samples; ++i) {
+    src.emplace_back(i, std::sqrt(i) + 2, std::sqrt(2 * i + 2));
+    dst.push_back(src.back());
+    orig_tform.TransformPoint(&dst.back());
+  }
+
+  for (size_t i = 0; i < num_outliers; ++i) {
+    dst[i] = Eigen::Vector3d(RandomReal(-3000.0, -2000.0),
+                             RandomReal(-4000.0, -3000.0),
+                             RandomReal(-5000.0, -4000.0));
+  }
+
+  for (const int num_threads : {1, 4}) {
+    RANSACOptions options;
+    options.max_error = 10;
+    options.use_sprt = true;
+    options.num_threads = num_threads;
+    RANSAC<SimilarityTransformEstimator<3>> ransac(options);
+    const auto report = ransac.Estimate(src, dst);
+
+    BOOST_CHECK_EQUAL(report.success, true);
+    BOOST_CHECK_EQUAL(report.support.num_inliers, num_samples - num_outliers);
+    for (size_t i = 0; i < num_samples; ++i) {
+      BOOST_CHECK_EQUAL(report.inlier_mask[i], i >= num_outliers);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestSimilarityTransformBatchEvaluator) {
+  SetPRNGSeed(0);
+
+  const size_t num_samples = 1000;
+  const size_t num_outliers = 400;
+
+  const SimilarityTransform3 orig_tform(2, ComposeIdentityQuaternion(),
+                                        Eigen::Vector3d(100, 10, 10));
+
+  std::vector<Eigen::Vector3d> src;
+  std::vector<Eigen::Vector3d> dst;
+  for (size_t i = 0; i < num_samples; ++i) {
+    src.emplace_back(i, std::sqrt(i) + 2, std::sqrt(2 * i + 2));
+    dst.push_back(src.back());
+    orig_tform.TransformPoint(&dst.back());
+  }
+
+  for (size_t i = 0; i < num_outliers; ++i) {
+    dst[i] = Eigen::Vector3d(RandomReal(-3000.0, -2000.0),
+                             RandomReal(-4000.0, -3000.0),
+                             RandomReal(-5000.0, -4000.0));
+  }
+
+  // The batch evaluation must produce identical results for the same
+  // sequence of random samples.
+  auto Estimate = [&](const bool batch) {
+    RANSACOptions options;
+    options.max_error = 10;
+    RANSAC<SimilarityTransformEstimator<3>> ransac(options);
+    size_t num_evaluated_models = 0;
+    if (batch) {
+      ransac.batch_evaluator_size = 7;
+      ransac.batch_evaluator =
+          [&](const std::vector<Eigen::Vector3d>& X,
+              const std::vector<Eigen::Vector3d>& Y,
+              const std::vector<Eigen::Matrix3x4d>& models,
+              const double max_residual,
+              std::vector<InlierSupportMeasurer::Support>* supports) {
+            std::vector<double> residuals;
+            for (const auto& model : models) {
+              SimilarityTransformEstimator<3>::Residuals(X, Y, model,
+                                                         &residuals);
+              supports->push_back(InlierSupportMeasurer().Evaluate(
+                  residuals, max_residual));
+            }
+            num_evaluated_models += models.size();
+          };
+    }
+    SetPRNGSeed(1);
+    const auto report = ransac.Estimate(src, dst);
+    BOOST_CHECK_EQUAL(num_evaluated_models > 0, batch);
+    return report;
+  };
+
+  const auto report = Estimate(false);
+  BOOST_CHECK_EQUAL(report.success, true);
+  BOOST_CHECK_EQUAL(report.support.num_inliers, num_samples - num_outliers);
+
+  const auto batch_report = Estimate(true);
+  BOOST_CHECK_EQUAL(batch_report.success, report.success);
+  BOOST_CHECK_EQUAL(batch_report.num_trials, report.num_trials);
+  BOOST_CHECK_EQUAL(batch_report.support.num_inliers,
+                    report.support.num_inliers);
+  BOOST_CHECK_EQUAL(batch_report.support.residual_sum,
+                    report.support.residual_sum);
+  BOOST_CHECK(batch_report.inlier_mask == report.inlier_mask);
+  BOOST_CHECK_EQUAL(batch_report.model, report.model);
+}
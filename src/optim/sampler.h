@@ -52,43 +52,59 @@ class Sampler {
   virtual size_t MaxNumSamples() = 0;
 
   // Sample `num_samples` elements from all samples.
-  virtual std::vector<size_t> Sample() = 0;
+  std::vector<size_t> Sample();
+
+  // Sample `num_samples` elements from all samples into the given vector.
+  // Its memory is reused, so that repeated sampling does not allocate.
+  virtual void Sample(std::vector<size_t>* sampled_idxs) = 0;
 
   // Sample elements from `X` into `X_rand`.
   //
   // Note that `X.size()` should equal `num_total_samples` and `X_rand.size()`
   // should equal `num_samples`.
-  template <typename X_t>
-  void SampleX(const X_t& X, X_t* X_rand);
+  template <typename X_t, typename X_rand_t>
+  void SampleX(const X_t& X, X_rand_t* X_rand);
 
   // Sample elements from `X` and `Y` into `X_rand` and `Y_rand`.
   //
   // Note that `X.size()` should equal `num_total_samples` and `X_rand.size()`
-  // should equal `num_samples`. The same applies for `Y` and `Y_rand`.
-  template <typename X_t, typename Y_t>
-  void SampleXY(const X_t& X, const Y_t& Y, X_t* X_rand, Y_t* Y_rand);
+  // should equal `num_samples`. The same applies for `Y` and `Y_rand`. The
+  // containers of the samples may differ, e.g., fixed-size arrays.
+  template <typename X_t, typename Y_t, typename X_rand_t, typename Y_rand_t>
+  void SampleXY(const X_t& X, const Y_t& Y, X_rand_t* X_rand,
+                Y_rand_t* Y_rand);
+
+ private:
+  std::vector<size_t> sampled_idxs_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
 
-template <typename X_t>
-void Sampler::SampleX(const X_t& X, X_t* X_rand) {
-  const auto sample_idxs = Sample();
+inline std::vector<size_t> Sampler::Sample() {
+  std::vector<size_t> sampled_idxs;
+  Sample(&sampled_idxs);
+  return sampled_idxs;
+}
+
+template <typename X_t, typename X_rand_t>
+void Sampler::SampleX(const X_t& X, X_rand_t* X_rand) {
+  Sample(&sampled_idxs_);
   for (size_t i = 0; i < X_rand->size(); ++i) {
-    (*X_rand)[i] = X[sample_idxs[i]];
+    (*X_rand)[i] = X[sampled_idxs_[i]];
   }
 }
 
-template <typename X_t, typename Y_t>
-void Sampler::SampleXY(const X_t& X, const Y_t& Y, X_t* X_rand, Y_t* Y_rand) {
+template <typename X_t, typename Y_t, typename X_rand_t, typename Y_rand_t>
+void Sampler::SampleXY(const X_t& X, const Y_t& Y, X_rand_t* X_rand,
+                       Y_rand_t* Y_rand) {
   CHECK_EQ(X.size(), Y.size());
   CHECK_EQ(X_rand->size(), Y_rand->size());
-  const auto sample_idxs = Sample();
+  Sample(&sampled_idxs_);
   for (size_t i = 0; i < X_rand->size(); ++i) {
-    (*X_rand)[i] = X[sample_idxs[i]];
-    (*Y_rand)[i] = Y[sample_idxs[i]];
+    (*X_rand)[i] = X[sampled_idxs_[i]];
+    (*Y_rand)[i] = Y[sampled_idxs_[i]];
   }
 }
 
@@ -44,26 +44,32 @@ void SPRT::Update(const Options& options) {
 
 bool SPRT::Evaluate(const std::vector<double>& residuals,
                     const double max_residual, size_t* num_inliers,
-                    size_t* num_eval_samples) {
-  num_inliers = 0;
-
+                    size_t* num_eval_samples) const {
   double likelihood_ratio = 1;
+  *num_inliers = 0;
+  *num_eval_samples = 0;
+  return Evaluate(residuals, max_residual, &likelihood_ratio, num_inliers,
+                  num_eval_samples);
+}
 
+bool SPRT::Evaluate(const std::vector<double>& residuals,
+                    const double max_residual, double* likelihood_ratio,
+                    size_t* num_inliers, size_t* num_eval_samples) const {
   for (size_t i = 0; i < residuals.size(); ++i) {
     if (std::abs(residuals[i]) <= max_residual) {
-      num_inliers += 1;
-      likelihood_ratio *= delta_epsilon_;
+      *num_inliers += 1;
+      *likelihood_ratio *= delta_epsilon_;
     } else {
-      likelihood_ratio *= delta_1_epsilon_1_;
+      *likelihood_ratio *= delta_1_epsilon_1_;
     }
 
-    if (likelihood_ratio > decision_threshold_) {
-      *num_eval_samples = i + 1;
+    if (*likelihood_ratio > decision_threshold_) {
+      *num_eval_samples += i + 1;
       return false;
     }
   }
 
-  *num_eval_samples = residuals.size();
+  *num_eval_samples += residuals.size();
 
   return true;
 }
@@ -66,8 +66,19 @@ class SPRT {
 
   void Update(const Options& options);
 
+  // Test whether a model is good given its residuals, which must be ordered
+  // randomly. Returns false as soon as the model is rejected, in which case
+  // only the first `num_eval_samples` residuals were evaluated.
   bool Evaluate(const std::vector<double>& residuals, const double max_residual,
-                size_t* num_inliers, size_t* num_eval_samples);
+                size_t* num_inliers, size_t* num_eval_samples) const;
+
+  // Continue the test of a model with the next chunk of its residuals. The
+  // likelihood ratio, number of inliers, and number of evaluated samples are
+  // accumulated over successive calls and must be initialized to 1, 0, and 0
+  // before the first chunk of a model.
+  bool Evaluate(const std::vector<double>& residuals, const double max_residual,
+                double* likelihood_ratio, size_t* num_inliers,
+                size_t* num_eval_samples) const;
 
  private:
   void UpdateDecisionThreshold();
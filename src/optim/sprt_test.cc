@@ -0,0 +1,91 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+#define TEST_NAME "optim/sprt"
+#include "util/testing.h"
+
+#include "optim/sprt.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestGoodModel) {
+  SPRT::Options options;
+  options.epsilon = 0.5;
+  SPRT sprt(options);
+
+  std::vector<double> residuals(100);
+  for (size_t i = 0; i < residuals.size(); ++i) {
+    residuals[i] = i % 2 == 0 ? 0 : 2;
+  }
+
+  size_t num_inliers;
+  size_t num_eval_samples;
+  BOOST_CHECK(sprt.Evaluate(residuals, 1, &num_inliers, &num_eval_samples));
+  BOOST_CHECK_EQUAL(num_inliers, 50);
+  BOOST_CHECK_EQUAL(num_eval_samples, 100);
+}
+
+BOOST_AUTO_TEST_CASE(TestBadModel) {
+  SPRT::Options options;
+  options.epsilon = 0.5;
+  SPRT sprt(options);
+
+  const std::vector<double> residuals(100, 2);
+
+  size_t num_inliers;
+  size_t num_eval_samples;
+  BOOST_CHECK(!sprt.Evaluate(residuals, 1, &num_inliers, &num_eval_samples));
+  BOOST_CHECK_EQUAL(num_inliers, 0);
+  BOOST_CHECK_GT(num_eval_samples, 0);
+  BOOST_CHECK_LT(num_eval_samples, 100);
+}
+
+BOOST_AUTO_TEST_CASE(TestChunks) {
+  SPRT::Options options;
+  options.epsilon = 0.5;
+  SPRT sprt(options);
+
+  const std::vector<double> residuals(100, 2);
+
+  size_t num_inliers;
+  size_t num_eval_samples;
+  sprt.Evaluate(residuals, 1, &num_inliers, &num_eval_samples);
+
+  double chunk_likelihood_ratio = 1;
+  size_t chunk_num_inliers = 0;
+  size_t chunk_num_eval_samples = 0;
+  const std::vector<double> chunk(1, 2);
+  while (sprt.Evaluate(chunk, 1, &chunk_likelihood_ratio, &chunk_num_inliers,
+                       &chunk_num_eval_samples)) {
+  }
+  BOOST_CHECK_EQUAL(chunk_num_inliers, num_inliers);
+  BOOST_CHECK_EQUAL(chunk_num_eval_samples, num_eval_samples);
+}
@@ -0,0 +1,457 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+
+#ifndef COLMAP_SRC_RETRIEVAL_HIERARCHICAL_KMEANS_H_
+#define COLMAP_SRC_RETRIEVAL_HIERARCHICAL_KMEANS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "util/logging.h"
+#include "util/random.h"
+#include "util/threading.h"
+
+namespace colmap {
+namespace retrieval {
+
+// Provides training descriptors in batches, such that they do not need to be
+// held in memory at once, e.g., when streaming them from the database. The
+// stream is read multiple times, so it must be able to restart.
+template <typename DescType>
+class DescriptorStream {
+ public:
+  virtual ~DescriptorStream() = default;
+
+  // Restart the stream at the first batch of descriptors.
+  virtual void Reset() = 0;
+
+  // Read the next batch of descriptors. Returns false at the end of the stream.
+  virtual bool Next(DescType* descriptors) = 0;
+};
+
+// Descriptor stream over the rows of an in-memory descriptor matrix.
+template <typename DescType>
+class MatrixDescriptorStream : public DescriptorStream<DescType> {
+ public:
+  MatrixDescriptorStream(const DescType& descriptors, const int batch_size);
+
+  void Reset() override;
+  bool Next(DescType* descriptors) override;
+
+ private:
+  const DescType& descriptors_;
+  const typename DescType::Index batch_size_;
+  typename DescType::Index row_;
+};
+
+// Hierarchical k-means clustering with mini-batch updates, see:
+//
+//    Nister, Stewenius. "Scalable Recognition with a Vocabulary Tree".
+//    CVPR 2006.
+//
+//    Sculley. "Web-Scale K-Means Clustering". WWW 2010.
+//
+// The tree is built level by level. For each level, the initial centers of
+// every node are selected with k-means++ from a reservoir sample of the
+// descriptors routed to the node, and then all nodes of the level are refined
+// simultaneously with online k-means updates in each pass over the stream. The nearest center assignments
+// of each batch are computed in parallel. Every level hence requires
+// `num_iterations + 1` passes over the stream, while only the cluster centers
+// are held in memory. The leaves of the last level are distributed among its
+// parent nodes proportional to the number of descriptors in each parent.
+template <typename kDescType, int kDescDim>
+class HierarchicalKMeans {
+ public:
+  typedef Eigen::Matrix<kDescType, Eigen::Dynamic, kDescDim, Eigen::RowMajor>
+      DescType;
+  typedef Eigen::Matrix<float, Eigen::Dynamic, kDescDim, Eigen::RowMajor>
+      CentersType;
+
+  struct Options {
+    // The desired number of leaf clusters.
+    int num_clusters = 256 * 256;
+
+    // The branching factor of the tree.
+    int branching = 256;
+
+    // The number of passes over the descriptors to refine each level.
+    int num_iterations = 11;
+
+    // The number of threads used to assign the descriptors to the clusters.
+    int num_threads = -1;
+
+    bool Check() const;
+  };
+
+  explicit HierarchicalKMeans(const Options& options);
+
+  // Cluster the streamed descriptors and return the centers of the leaf
+  // clusters. There can be fewer leaf clusters than requested, if there are
+  // too few training descriptors.
+  CentersType Cluster(DescriptorStream<DescType>* descriptor_stream);
+
+ private:
+  struct Level {
+    // The centers of all clusters of this level, where the children of the
+    // same parent cluster are stored contiguously.
+    CentersType centers;
+
+    // The range of child clusters of each cluster in the previous level, where
+    // the children of parent i are in [child_offsets[i], child_offsets[i+1]).
+    std::vector<int> child_offsets;
+  };
+
+  // Assign the descriptors to the clusters of the last level, or -1 for
+  // descriptors that end up in a cluster without children.
+  void Assign(const DescType& descriptors, std::vector<int>* cluster_ids);
+
+  // Add a new level to the tree with the given number of children per cluster
+  // of the last level and sample the initial centers from the descriptors.
+  void AddLevel(const std::vector<int>& num_children,
+                DescriptorStream<DescType>* descriptor_stream);
+
+  // Refine the clusters of the last level in one pass over the descriptors and
+  // return the number of descriptors assigned to each cluster.
+  std::vector<size_t> RefineLevel(
+      DescriptorStream<DescType>* descriptor_stream);
+
+  const Options options_;
+  ThreadPool thread_pool_;
+  std::vector<Level> levels_;
+  std::vector<size_t> cluster_counts_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename DescType>
+MatrixDescriptorStream<DescType>::MatrixDescriptorStream(
+    const DescType& descriptors, const int batch_size)
+    : descriptors_(descriptors), batch_size_(batch_size), row_(0) {
+  CHECK_GT(batch_size_, 0);
+}
+
+template <typename DescType>
+void MatrixDescriptorStream<DescType>::Reset() {
+  row_ = 0;
+}
+
+template <typename DescType>
+bool MatrixDescriptorStream<DescType>::Next(DescType* descriptors) {
+  if (row_ >= descriptors_.rows()) {
+    return false;
+  }
+  const typename DescType::Index num_rows =
+      std::min(batch_size_, descriptors_.rows() - row_);
+  *descriptors = descriptors_.middleRows(row_, num_rows);
+  row_ += num_rows;
+  return true;
+}
+
+template <typename kDescType, int kDescDim>
+bool HierarchicalKMeans<kDescType, kDescDim>::Options::Check() const {
+  CHECK_OPTION_GT(num_clusters, 0);
+  CHECK_OPTION_GT(branching, 1);
+  CHECK_OPTION_GT(num_iterations, 0);
+  return true;
+}
+
+template <typename kDescType, int kDescDim>
+HierarchicalKMeans<kDescType, kDescDim>::HierarchicalKMeans(
+    const Options& options)
+    : options_(options), thread_pool_(options.num_threads) {
+  CHECK(options_.Check());
+}
+
+template <typename kDescType, int kDescDim>
+typename HierarchicalKMeans<kDescType, kDescDim>::CentersType
+HierarchicalKMeans<kDescType, kDescDim>::Cluster(
+    DescriptorStream<DescType>* descriptor_stream) {
+  CHECK_NOTNULL(descriptor_stream);
+
+  levels_.clear();
+
+  // The smallest number of levels with enough leaves for all clusters.
+  int num_levels = 1;
+  int64_t num_leaves = options_.branching;
+  while (num_leaves < options_.num_clusters) {
+    num_leaves *= options_.branching;
+    num_levels += 1;
+  }
+
+  // The number of descriptors per cluster of the last level.
+  std::vector<size_t> counts(1, 0);
+
+  for (int level_idx = 0; level_idx < num_levels; ++level_idx) {
+    std::vector<int> num_children(counts.size(), 0);
+    if (level_idx + 1 < num_levels) {
+      std::fill(num_children.begin(), num_children.end(), options_.branching);
+    } else if (level_idx == 0) {
+      num_children[0] = options_.num_clusters;
+    } else {
+      // Every non-empty parent gets at least one child and the remaining
+      // children are distributed proportional to the number of descriptors.
+      size_t num_descriptors = 0;
+      int num_nonempty = 0;
+      for (const size_t count : counts) {
+        num_descriptors += count;
+        num_nonempty += count > 0;
+      }
+      const int num_remaining = options_.num_clusters - num_nonempty;
+      std::vector<std::pair<double, size_t>> remainders;
+      int num_assigned = 0;
+      for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] == 0) {
+          continue;
+        }
+        const double share =
+            num_remaining * static_cast<double>(counts[i]) / num_descriptors;
+        num_children[i] = 1 + static_cast<int>(share);
+        num_assigned += num_children[i];
+        remainders.emplace_back(share - static_cast<int>(share), i);
+      }
+      std::sort(remainders.begin(), remainders.end(),
+                std::greater<std::pair<double, size_t>>());
+      for (size_t i = 0;
+           i < remainders.size() && num_assigned < options_.num_clusters;
+           ++i) {
+        num_children[remainders[i].second] += 1;
+        num_assigned += 1;
+      }
+    }
+
+    AddLevel(num_children, descriptor_stream);
+    for (int iter = 0; iter < options_.num_iterations; ++iter) {
+      counts = RefineLevel(descriptor_stream);
+    }
+  }
+
+  return levels_.back().centers;
+}
+
+template <typename kDescType, int kDescDim>
+void HierarchicalKMeans<kDescType, kDescDim>::Assign(
+    const DescType& descriptors, std::vector<int>* cluster_ids) {
+  cluster_ids->resize(descriptors.rows());
+
+  auto AssignFunc = [&](const typename DescType::Index begin_row,
+                        const typename DescType::Index end_row) {
+    Eigen::Matrix<float, 1, kDescDim> descriptor;
+    for (typename DescType::Index i = begin_row; i < end_row; ++i) {
+      descriptor = descriptors.row(i).template cast<float>();
+      int cluster_id = 0;
+      for (const auto& level : levels_) {
+        const int begin = level.child_offsets[cluster_id];
+        const int end = level.child_offsets[cluster_id + 1];
+        if (begin == end) {
+          cluster_id = -1;
+          break;
+        }
+        typename CentersType::Index min_idx;
+        (level.centers.middleRows(begin, end - begin).rowwise() - descriptor)
+            .rowwise()
+            .squaredNorm()
+            .minCoeff(&min_idx);
+        cluster_id = begin + static_cast<int>(min_idx);
+      }
+      (*cluster_ids)[i] = cluster_id;
+    }
+  };
+
+  const int num_threads = static_cast<int>(thread_pool_.NumThreads());
+  const typename DescType::Index num_rows_per_thread =
+      (descriptors.rows() + num_threads - 1) / num_threads;
+  std::vector<std::future<void>> futures;
+  futures.reserve(num_threads);
+  for (typename DescType::Index begin_row = 0; begin_row < descriptors.rows();
+       begin_row += num_rows_per_thread) {
+    futures.push_back(thread_pool_.AddTask(
+        AssignFunc, begin_row,
+        std::min(begin_row + num_rows_per_thread, descriptors.rows())));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+}
+
+template <typename kDescType, int kDescDim>
+void HierarchicalKMeans<kDescType, kDescDim>::AddLevel(
+    const std::vector<int>& num_children,
+    DescriptorStream<DescType>* descriptor_stream) {
+  const size_t num_parents = num_children.size();
+
+  // Reservoir sampling of candidate centers for each parent, from which the
+  // initial centers are then selected using k-means++.
+  const int kNumCandidatesPerChild = 8;
+  std::vector<int> candidate_offsets(num_parents + 1, 0);
+  for (size_t i = 0; i < num_parents; ++i) {
+    candidate_offsets[i + 1] =
+        candidate_offsets[i] + kNumCandidatesPerChild * num_children[i];
+  }
+  DescType candidates(candidate_offsets.back(), kDescDim);
+
+  std::vector<size_t> num_samples(num_parents, 0);
+  std::vector<int> parent_ids;
+  DescType descriptors;
+  descriptor_stream->Reset();
+  while (descriptor_stream->Next(&descriptors)) {
+    Assign(descriptors, &parent_ids);
+    for (typename DescType::Index i = 0; i < descriptors.rows(); ++i) {
+      const int parent_id = parent_ids[i];
+      if (parent_id < 0) {
+        continue;
+      }
+      const size_t num_candidates =
+          candidate_offsets[parent_id + 1] - candidate_offsets[parent_id];
+      if (num_candidates == 0) {
+        continue;
+      }
+      num_samples[parent_id] += 1;
+      size_t candidate_idx = num_samples[parent_id] - 1;
+      if (candidate_idx >= num_candidates) {
+        candidate_idx = RandomInteger<size_t>(0, candidate_idx);
+        if (candidate_idx >= num_candidates) {
+          continue;
+        }
+      }
+      candidates.row(candidate_offsets[parent_id] + candidate_idx) =
+          descriptors.row(i);
+    }
+  }
+
+  // Parents with fewer descriptors than children get fewer children.
+  Level level;
+  level.child_offsets.resize(num_parents + 1, 0);
+  for (size_t i = 0; i < num_parents; ++i) {
+    level.child_offsets[i + 1] =
+        level.child_offsets[i] +
+        std::min<int>(num_children[i], static_cast<int>(num_samples[i]));
+  }
+  level.centers.resize(level.child_offsets.back(), kDescDim);
+
+  // Select the initial centers of each parent using k-means++.
+  std::vector<float> min_squared_dists;
+  for (size_t i = 0; i < num_parents; ++i) {
+    const int num_parent_children =
+        level.child_offsets[i + 1] - level.child_offsets[i];
+    if (num_parent_children == 0) {
+      continue;
+    }
+
+    const CentersType parent_candidates =
+        candidates
+            .middleRows(candidate_offsets[i],
+                        std::min<size_t>(num_samples[i],
+                                         candidate_offsets[i + 1] -
+                                             candidate_offsets[i]))
+            .template cast<float>();
+
+    min_squared_dists.assign(parent_candidates.rows(),
+                             std::numeric_limits<float>::max());
+    int candidate_idx = RandomInteger<int>(
+        0, static_cast<int>(parent_candidates.rows()) - 1);
+    for (int j = 0; j < num_parent_children; ++j) {
+      level.centers.row(level.child_offsets[i] + j) =
+          parent_candidates.row(candidate_idx);
+
+      double sum_squared_dists = 0;
+      for (typename CentersType::Index k = 0; k < parent_candidates.rows();
+           ++k) {
+        min_squared_dists[k] = std::min(
+            min_squared_dists[k],
+            (parent_candidates.row(k) - parent_candidates.row(candidate_idx))
+                .squaredNorm());
+        sum_squared_dists += min_squared_dists[k];
+      }
+
+      // Sample the next center proportional to the squared distance to the
+      // already selected centers.
+      double threshold = RandomReal<double>(0, sum_squared_dists);
+      candidate_idx = 0;
+      for (typename CentersType::Index k = 0; k < parent_candidates.rows();
+           ++k) {
+        if (min_squared_dists[k] > 0) {
+          candidate_idx = static_cast<int>(k);
+          threshold -= min_squared_dists[k];
+          if (threshold <= 0) {
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  levels_.push_back(std::move(level));
+  cluster_counts_.assign(levels_.back().centers.rows(), 0);
+}
+
+template <typename kDescType, int kDescDim>
+std::vector<size_t> HierarchicalKMeans<kDescType, kDescDim>::RefineLevel(
+    DescriptorStream<DescType>* descriptor_stream) {
+  CentersType& centers = levels_.back().centers;
+  std::vector<size_t> pass_counts(centers.rows(), 0);
+
+  std::vector<int> cluster_ids;
+  DescType descriptors;
+  descriptor_stream->Reset();
+  while (descriptor_stream->Next(&descriptors)) {
+    // The assignments of the batch are computed in parallel for the current
+    // centers, before the centers are updated with the per-cluster learning
+    // rate of mini-batch k-means.
+    Assign(descriptors, &cluster_ids);
+    for (typename DescType::Index i = 0; i < descriptors.rows(); ++i) {
+      const int cluster_id = cluster_ids[i];
+      if (cluster_id < 0) {
+        continue;
+      }
+      pass_counts[cluster_id] += 1;
+      cluster_counts_[cluster_id] += 1;
+      const float learning_rate = 1.0f / cluster_counts_[cluster_id];
+      centers.row(cluster_id) +=
+          learning_rate *
+          (descriptors.row(i).template cast<float>() - centers.row(cluster_id));
+    }
+  }
+
+  return pass_counts;
+}
+
+}  // namespace retrieval
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_RETRIEVAL_HIERARCHICAL_KMEANS_H_
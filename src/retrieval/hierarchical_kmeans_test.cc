@@ -0,0 +1,142 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+
+#define TEST_NAME "retrieval/hierarchical_kmeans"
+#include "util/testing.h"
+
+#include "retrieval/hierarchical_kmeans.h"
+
+using namespace colmap;
+using namespace colmap::retrieval;
+
+BOOST_AUTO_TEST_CASE(TestMatrixDescriptorStream) {
+  typedef Eigen::Matrix<float, Eigen::Dynamic, 4, Eigen::RowMajor> DescType;
+  const DescType descriptors = DescType::Random(10, 4);
+  MatrixDescriptorStream<DescType> descriptor_stream(descriptors, 4);
+  for (int pass = 0; pass < 2; ++pass) {
+    descriptor_stream.Reset();
+    DescType batch;
+    DescType::Index row = 0;
+    while (descriptor_stream.Next(&batch)) {
+      BOOST_CHECK_LE(batch.rows(), 4);
+      BOOST_CHECK(batch == descriptors.middleRows(row, batch.rows()));
+      row += batch.rows();
+    }
+    BOOST_CHECK_EQUAL(row, descriptors.rows());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestHierarchicalKMeans) {
+  typedef HierarchicalKMeans<float, 8> KMeansType;
+
+  SetPRNGSeed(0);
+
+  // Well separated clusters with small noise, where the clusters are grouped
+  // into well separated groups for the first level of the tree.
+  const int kNumGroups = 4;
+  const int kNumClustersPerGroup = 4;
+  const int kNumDescriptorsPerCluster = 100;
+  std::vector<Eigen::Matrix<float, 1, 8>> means;
+  for (int i = 0; i < kNumGroups; ++i) {
+    for (int j = 0; j < kNumClustersPerGroup; ++j) {
+      Eigen::Matrix<float, 1, 8> mean = Eigen::Matrix<float, 1, 8>::Zero();
+      mean(i) = 100;
+      mean(kNumGroups + j) = 10;
+      means.push_back(mean);
+    }
+  }
+
+  KMeansType::DescType descriptors(means.size() * kNumDescriptorsPerCluster,
+                                   8);
+  for (size_t i = 0; i < means.size(); ++i) {
+    for (int j = 0; j < kNumDescriptorsPerCluster; ++j) {
+      descriptors.row(i * kNumDescriptorsPerCluster + j) =
+          means[i] + 0.1f * Eigen::Matrix<float, 1, 8>::Random();
+    }
+  }
+
+  // Shuffle the descriptors, such that the batches contain all clusters.
+  std::vector<int> order(descriptors.rows());
+  std::iota(order.begin(), order.end(), 0);
+  Shuffle(static_cast<uint32_t>(order.size()), &order);
+  KMeansType::DescType shuffled_descriptors(descriptors.rows(), 8);
+  for (size_t i = 0; i < order.size(); ++i) {
+    shuffled_descriptors.row(i) = descriptors.row(order[i]);
+  }
+
+  KMeansType::Options options;
+  options.num_clusters = kNumGroups * kNumClustersPerGroup;
+  options.branching = kNumGroups;
+  options.num_iterations = 5;
+  options.num_threads = 2;
+  KMeansType kmeans(options);
+  MatrixDescriptorStream<KMeansType::DescType> descriptor_stream(
+      shuffled_descriptors, 64);
+  const KMeansType::CentersType centers = kmeans.Cluster(&descriptor_stream);
+
+  BOOST_CHECK_LE(centers.rows(), options.num_clusters);
+  BOOST_CHECK_GE(centers.rows(), kNumGroups);
+
+  // Every center must lie within one of the true clusters.
+  for (KMeansType::CentersType::Index i = 0; i < centers.rows(); ++i) {
+    float min_dist = std::numeric_limits<float>::max();
+    for (const auto& mean : means) {
+      min_dist = std::min(min_dist, (centers.row(i) - mean).norm());
+    }
+    BOOST_CHECK_LT(min_dist, 1);
+  }
+
+  // Every group of the first level must be covered by a center.
+  for (int i = 0; i < kNumGroups; ++i) {
+    bool found = false;
+    for (KMeansType::CentersType::Index j = 0; j < centers.rows(); ++j) {
+      if (centers(j, i) > 50) {
+        found = true;
+      }
+    }
+    BOOST_CHECK(found);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestHierarchicalKMeansFewDescriptors) {
+  typedef HierarchicalKMeans<uint8_t, 4> KMeansType;
+  SetPRNGSeed(0);
+  const KMeansType::DescType descriptors = KMeansType::DescType::Random(3, 4);
+  KMeansType::Options options;
+  options.num_clusters = 10;
+  options.branching = 10;
+  KMeansType kmeans(options);
+  MatrixDescriptorStream<KMeansType::DescType> descriptor_stream(descriptors,
+                                                                 2);
+  const KMeansType::CentersType centers = kmeans.Cluster(&descriptor_stream);
+  BOOST_CHECK_EQUAL(centers.rows(), 3);
+}
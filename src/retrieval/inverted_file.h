@@ -33,6 +33,7 @@
 #define COLMAP_SRC_RETRIEVAL_INVERTED_FILE_H_
 
 #include <algorithm>
+#include <array>
 #include <bitset>
 #include <cstdint>
 #include <fstream>
@@ -97,6 +98,9 @@ class InvertedFile {
 
   // Sorts the inverted file entries in ascending order of image ids. This is
   // required for efficient scoring and must be called before ScoreFeature.
+  // Entries appended to an already sorted file are sorted separately and
+  // merged into the existing entries, so incremental indexing is linear in
+  // the number of existing entries.
   void SortEntries();
 
   // Clear all entries in this file.
@@ -141,6 +145,10 @@ class InvertedFile {
   void Write(std::ofstream* ofs) const;
 
  private:
+  // Copies the image identifiers and binary descriptors of the sorted entries
+  // into contiguous arrays, which are used in the inner loop of ScoreFeature.
+  void PackEntries();
+
   // Whether the inverted file is initialized.
   uint8_t status_;
 
@@ -150,6 +158,12 @@ class InvertedFile {
   // The entries of the inverted file system.
   std::vector<EntryType> entries_;
 
+  // The image identifiers and the binary descriptors of the sorted entries in
+  // a structure-of-arrays layout, such that the Hamming distances can be
+  // computed in blocks without touching the feature geometries.
+  std::vector<int> packed_image_ids_;
+  std::vector<uint64_t> packed_descriptors_;
+
   // The thresholds used for Hamming embedding.
   DescType thresholds_;
 
@@ -174,6 +188,8 @@ InvertedFile<kEmbeddingDim>::InvertedFile()
                 " be a multiple of 8.");
   static_assert(kEmbeddingDim > 0,
                 "Dimensionality of projected space needs to be > 0.");
+  static_assert(kEmbeddingDim <= 64,
+                "Dimensionality of projected space needs to be <= 64.");
 
   thresholds_.resize(kEmbeddingDim);
   thresholds_.setZero();
@@ -223,16 +239,24 @@ void InvertedFile<kEmbeddingDim>::AddEntry(const int image_id,
 
 template <int kEmbeddingDim>
 void InvertedFile<kEmbeddingDim>::SortEntries() {
-  std::sort(entries_.begin(), entries_.end(),
-            [](const EntryType& entry1, const EntryType& entry2) {
-              return entry1.image_id < entry2.image_id;
-            });
+  const auto CompareFunc = [](const EntryType& entry1,
+                              const EntryType& entry2) {
+    return entry1.image_id < entry2.image_id;
+  };
+  const auto sorted_end =
+      std::is_sorted_until(entries_.begin(), entries_.end(), CompareFunc);
+  std::sort(sorted_end, entries_.end(), CompareFunc);
+  std::inplace_merge(entries_.begin(), sorted_end, entries_.end(),
+                     CompareFunc);
+  PackEntries();
   status_ |= ENTRIES_SORTED;
 }
 
 template <int kEmbeddingDim>
 void InvertedFile<kEmbeddingDim>::ClearEntries() {
   entries_.clear();
+  packed_image_ids_.clear();
+  packed_descriptors_.clear();
   status_ &= ~ENTRIES_SORTED;
 }
 
@@ -241,6 +265,8 @@ void InvertedFile<kEmbeddingDim>::Reset() {
   status_ = UNUSABLE;
   idf_weight_ = 0.0f;
   entries_.clear();
+  packed_image_ids_.clear();
+  packed_descriptors_.clear();
   thresholds_.setZero();
 }
 
@@ -310,40 +336,57 @@ void InvertedFile<kEmbeddingDim>::ScoreFeature(
 
   std::bitset<kEmbeddingDim> bin_descriptor;
   ConvertToBinaryDescriptor(descriptor, &bin_descriptor);
+  const uint64_t packed_descriptor =
+      static_cast<uint64_t>(bin_descriptor.to_ullong());
 
   ImageScore image_score;
-  image_score.image_id = entries_.front().image_id;
+  image_score.image_id = packed_image_ids_.front();
   image_score.score = 0.0f;
   int num_image_votes = 0;
 
+  // The Hamming distances are computed in blocks of entries, so that the
+  // population counts can be vectorized.
+  const size_t kBlockSize = 64;
+  std::array<uint8_t, kBlockSize> hamming_dists;
+
   // Note that this assumes that the entries are sorted using SortEntries
   // according to their image identifiers.
-  for (const auto& entry : entries_) {
-    if (image_score.image_id < entry.image_id) {
-      if (num_image_votes > 0) {
-        // Finalizes the voting since we now know how many features from
-        // the database image match the current image feature. This is
-        // required to perform burstiness normalization (cf. Eqn. 2 in
-        // Arandjelovic, Zisserman: Scalable descriptor
-        // distinctiveness for location recognition. ACCV 2014).
-        // Notice that the weight from the descriptor matching is already
-        // accumulated in image_score.score, i.e., we only need
-        // to apply the burstiness weighting.
-        image_score.score /= std::sqrt(static_cast<float>(num_image_votes));
-        image_score.score *= squared_idf_weight;
-        image_scores->push_back(image_score);
+  for (size_t block_begin = 0; block_begin < packed_image_ids_.size();
+       block_begin += kBlockSize) {
+    const size_t block_size =
+        std::min(kBlockSize, packed_image_ids_.size() - block_begin);
+    ComputeHammingDistances(packed_descriptor,
+                            packed_descriptors_.data() + block_begin,
+                            block_size, hamming_dists.data());
+
+    for (size_t i = 0; i < block_size; ++i) {
+      const int image_id = packed_image_ids_[block_begin + i];
+      if (image_score.image_id < image_id) {
+        if (num_image_votes > 0) {
+          // Finalizes the voting since we now know how many features from
+          // the database image match the current image feature. This is
+          // required to perform burstiness normalization (cf. Eqn. 2 in
+          // Arandjelovic, Zisserman: Scalable descriptor
+          // distinctiveness for location recognition. ACCV 2014).
+          // Notice that the weight from the descriptor matching is already
+          // accumulated in image_score.score, i.e., we only need
+          // to apply the burstiness weighting.
+          image_score.score /= std::sqrt(static_cast<float>(num_image_votes));
+          image_score.score *= squared_idf_weight;
+          image_scores->push_back(image_score);
+        }
+
+        image_score.image_id = image_id;
+        image_score.score = 0.0f;
+        num_image_votes = 0;
       }
 
-      image_score.image_id = entry.image_id;
-      image_score.score = 0.0f;
-      num_image_votes = 0;
-    }
-
-    const size_t hamming_dist = (bin_descriptor ^ entry.descriptor).count();
+      const size_t hamming_dist = hamming_dists[i];
 
-    if (hamming_dist <= hamming_dist_weight_functor_.kMaxHammingDistance) {
-      image_score.score += hamming_dist_weight_functor_(hamming_dist);
-      num_image_votes += 1;
+      if (hamming_dist <= hamming_dist_weight_functor_.kMaxHammingDistance) {
+        image_score.score += hamming_dist_weight_functor_(hamming_dist);
+        num_image_votes += 1;
+      }
     }
   }
 
@@ -390,6 +433,10 @@ void InvertedFile<kEmbeddingDim>::Read(std::ifstream* ifs) {
   for (uint32_t i = 0; i < num_entries; ++i) {
     entries_[i].Read(ifs);
   }
+
+  if (EntriesSorted()) {
+    PackEntries();
+  }
 }
 
 template <int kEmbeddingDim>
@@ -411,6 +458,17 @@ void InvertedFile<kEmbeddingDim>::Write(std::ofstream* ofs) const {
   }
 }
 
+template <int kEmbeddingDim>
+void InvertedFile<kEmbeddingDim>::PackEntries() {
+  packed_image_ids_.resize(entries_.size());
+  packed_descriptors_.resize(entries_.size());
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    packed_image_ids_[i] = entries_[i].image_id;
+    packed_descriptors_[i] =
+        static_cast<uint64_t>(entries_[i].descriptor.to_ullong());
+  }
+}
+
 }  // namespace retrieval
 }  // namespace colmap
 
@@ -46,6 +46,7 @@
 #include "retrieval/inverted_file.h"
 #include "util/alignment.h"
 #include "util/random.h"
+#include "util/threading.h"
 
 namespace colmap {
 namespace retrieval {
@@ -92,8 +93,10 @@ class InvertedIndex {
   // Clear all index entries.
   void ClearEntries();
 
-  // Query the inverted file and return a list of sorted images.
+  // Query the inverted file and return a list of sorted images. The features
+  // are scored in parallel using the given number of threads.
   void Query(const DescType& descriptors, const Eigen::MatrixXi& word_ids,
+             const int num_threads,
              std::vector<ImageScore>* image_scores) const;
 
   void ConvertToBinaryDescriptor(
@@ -118,6 +121,14 @@ class InvertedIndex {
  private:
   void ComputeWeightsAndNormalizationConstants();
 
+  // Accumulate the unnormalized scores of the features in the given range of
+  // descriptor rows.
+  void ScoreFeatures(const DescType& descriptors,
+                     const Eigen::MatrixXi& word_ids,
+                     const typename DescType::Index begin_row,
+                     const typename DescType::Index end_row,
+                     std::vector<ImageScore>* image_scores) const;
+
   // The individual inverted indices.
   std::vector<InvertedFile<kEmbeddingDim>,
               Eigen::aligned_allocator<InvertedFile<kEmbeddingDim>>>
@@ -238,7 +249,7 @@ void InvertedIndex<kDescType, kDescDim, kEmbeddingDim>::ClearEntries() {
 template <typename kDescType, int kDescDim, int kEmbeddingDim>
 void InvertedIndex<kDescType, kDescDim, kEmbeddingDim>::Query(
     const DescType& descriptors, const Eigen::MatrixXi& word_ids,
-    std::vector<ImageScore>* image_scores) const {
+    const int num_threads, std::vector<ImageScore>* image_scores) const {
   CHECK_EQ(descriptors.cols(), kDescDim);
 
   image_scores->clear();
@@ -250,10 +261,69 @@ void InvertedIndex<kDescType, kDescDim, kEmbeddingDim>::Query(
     normalization_weight = 1.0f / std::sqrt(self_similarity);
   }
 
+  // Only split the features across threads, if each thread has enough work
+  // to amortize the cost of merging the partial scores.
+  const int kMinNumFeaturesPerThread = 256;
+  const int num_eff_threads =
+      std::min<int>(GetEffectiveNumThreads(num_threads),
+                    descriptors.rows() / kMinNumFeaturesPerThread);
+
+  if (num_eff_threads <= 1) {
+    ScoreFeatures(descriptors, word_ids, 0, descriptors.rows(), image_scores);
+  } else {
+    const typename DescType::Index num_rows_per_thread =
+        (descriptors.rows() + num_eff_threads - 1) / num_eff_threads;
+
+    std::vector<std::vector<ImageScore>> thread_image_scores(num_eff_threads);
+    ThreadPool thread_pool(num_eff_threads);
+    for (int thread_idx = 0; thread_idx < num_eff_threads; ++thread_idx) {
+      const typename DescType::Index begin_row =
+          thread_idx * num_rows_per_thread;
+      const typename DescType::Index end_row = std::min<
+          typename DescType::Index>(begin_row + num_rows_per_thread,
+                                    descriptors.rows());
+      thread_pool.AddTask([&, thread_idx, begin_row, end_row]() {
+        ScoreFeatures(descriptors, word_ids, begin_row, end_row,
+                      &thread_image_scores[thread_idx]);
+      });
+    }
+    thread_pool.Wait();
+
+    // Merge the partial scores of all threads.
+    std::unordered_map<int, int> score_map;
+    for (const auto& partial_image_scores : thread_image_scores) {
+      for (const ImageScore& score : partial_image_scores) {
+        const auto score_map_it = score_map.find(score.image_id);
+        if (score_map_it == score_map.end()) {
+          score_map.emplace(score.image_id,
+                            static_cast<int>(image_scores->size()));
+          image_scores->push_back(score);
+        } else {
+          (*image_scores).at(score_map_it->second).score += score.score;
+        }
+      }
+    }
+  }
+
+  // Normalization.
+  for (ImageScore& score : *image_scores) {
+    score.score *=
+        normalization_weight * normalization_constants_.at(score.image_id);
+  }
+}
+
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+void InvertedIndex<kDescType, kDescDim, kEmbeddingDim>::ScoreFeatures(
+    const DescType& descriptors, const Eigen::MatrixXi& word_ids,
+    const typename DescType::Index begin_row,
+    const typename DescType::Index end_row,
+    std::vector<ImageScore>* image_scores) const {
+  image_scores->clear();
+
   std::unordered_map<int, int> score_map;
   std::vector<ImageScore> inverted_file_scores;
 
-  for (typename DescType::Index i = 0; i < descriptors.rows(); ++i) {
+  for (typename DescType::Index i = begin_row; i < end_row; ++i) {
     const ProjDescType proj_descriptor =
         proj_matrix_ * descriptors.row(i).transpose().template cast<float>();
     for (Eigen::MatrixXi::Index n = 0; n < word_ids.cols(); ++n) {
@@ -279,12 +349,6 @@ void InvertedIndex<kDescType, kDescDim, kEmbeddingDim>::Query(
       }
     }
   }
-
-  // Normalization.
-  for (ImageScore& score : *image_scores) {
-    score.score *=
-        normalization_weight * normalization_constants_.at(score.image_id);
-  }
 }
 
 template <typename kDescType, int kDescDim, int kEmbeddingDim>
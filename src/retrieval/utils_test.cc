@@ -0,0 +1,68 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+#define TEST_NAME "retrieval/utils"
+#include "util/testing.h"
+
+#include "retrieval/utils.h"
+#include "util/random.h"
+
+using namespace colmap;
+using namespace colmap::retrieval;
+
+BOOST_AUTO_TEST_CASE(TestComputeHammingDistances) {
+  SetPRNGSeed(0);
+
+  // Covers the vectorized blocks as well as the scalar tail.
+  const size_t kNumSignatures = 21;
+  const uint64_t query_signature =
+      (static_cast<uint64_t>(RandomInteger<uint32_t>(0, 0xFFFFFFFF)) << 32) |
+      RandomInteger<uint32_t>(0, 0xFFFFFFFF);
+  std::vector<uint64_t> signatures(kNumSignatures);
+  for (size_t i = 0; i < kNumSignatures; ++i) {
+    signatures[i] =
+        (static_cast<uint64_t>(RandomInteger<uint32_t>(0, 0xFFFFFFFF)) << 32) |
+        RandomInteger<uint32_t>(0, 0xFFFFFFFF);
+  }
+  signatures[0] = query_signature;
+  signatures[1] = ~query_signature;
+
+  std::vector<uint8_t> hamming_dists(kNumSignatures);
+  ComputeHammingDistances(query_signature, signatures.data(), kNumSignatures,
+                          hamming_dists.data());
+
+  BOOST_CHECK_EQUAL(hamming_dists[0], 0);
+  BOOST_CHECK_EQUAL(hamming_dists[1], 64);
+  for (size_t i = 0; i < kNumSignatures; ++i) {
+    BOOST_CHECK_EQUAL(hamming_dists[i],
+                      std::bitset<64>(query_signature ^ signatures[i]).count());
+  }
+}
@@ -32,18 +32,24 @@
 #ifndef COLMAP_SRC_RETRIEVAL_VISUAL_INDEX_H_
 #define COLMAP_SRC_RETRIEVAL_VISUAL_INDEX_H_
 
+#include <memory>
+
 #include <boost/heap/fibonacci_heap.hpp>
 #include <Eigen/Core>
 
 #include "FLANN/flann.hpp"
 #include "feature/types.h"
+#include "retrieval/hierarchical_kmeans.h"
 #include "retrieval/inverted_file.h"
 #include "retrieval/inverted_index.h"
+#include "retrieval/visual_word_search_cuda.h"
 #include "retrieval/vote_and_verify.h"
 #include "util/alignment.h"
 #include "util/endian.h"
 #include "util/logging.h"
 #include "util/math.h"
+#include "util/threading.h"
+#include "util/timer.h"
 
 namespace colmap {
 namespace retrieval {
@@ -92,6 +98,17 @@ class VisualIndex {
     // Whether to perform spatial verification after image retrieval.
     int num_images_after_verification = 0;
 
+    // The retrieved images are verified in descending order of their scores.
+    // If positive, the verification stops early once
+    // `num_images_after_verification` images have been verified with at least
+    // this number of inliers.
+    int verification_min_num_inliers = 0;
+
+    // The maximum time in seconds spent on the spatial verification of one
+    // query. Images that could not be verified within this time are ranked
+    // by their retrieval score only. Disabled if negative.
+    double max_verification_time = -1.0;
+
     // The number of threads used in the index.
     int num_threads = kMaxNumThreads;
   };
@@ -104,9 +121,14 @@ class VisualIndex {
     // The branching factor of the hierarchical k-means tree.
     int branching = 256;
 
-    // The number of iterations for the clustering.
+    // The number of iterations for the clustering, i.e. the number of passes
+    // over the training descriptors per level of the tree.
     int num_iterations = 11;
 
+    // The maximum number of randomly sampled training descriptors used to
+    // learn the Hamming embedding.
+    int max_num_embedding_descriptors = 10000000;
+
     // The target precision of the visual word search index.
     double target_precision = 0.95;
 
@@ -117,19 +139,44 @@ class VisualIndex {
     int num_threads = kMaxNumThreads;
   };
 
+  typedef DescriptorStream<DescType> DescriptorStreamType;
+
   VisualIndex();
   ~VisualIndex();
 
   size_t NumVisualWords() const;
 
+  // Hash of the visual words, which identifies the vocabulary, e.g., to cache
+  // the visual words of images across runs with the same vocabulary tree.
+  uint64_t VocabularyHash() const;
+
   // Add image to the visual index.
   void Add(const IndexOptions& options, const int image_id,
            const GeomType& geometries, const DescType& descriptors);
 
+  // Add image to the visual index with previously assigned visual words, as
+  // returned by `FindWordIds` with `options.num_neighbors` neighbors for the
+  // same vocabulary, which skips the visual word search.
+  void Add(const IndexOptions& options, const int image_id,
+           const GeomType& geometries, const DescType& descriptors,
+           const Eigen::MatrixXi& word_ids);
+
+  // Add multiple images to the visual index, where the visual words of all
+  // images are assigned in one batch. This amortizes the overhead of the
+  // visual word search on the GPU. Optionally, the assigned visual words of
+  // each image are returned, which are empty for skipped images.
+  void Add(const IndexOptions& options, const std::vector<int>& image_ids,
+           const std::vector<GeomType>& geometries,
+           const std::vector<DescType>& descriptors,
+           std::vector<Eigen::MatrixXi>* word_ids = nullptr);
+
   // Check if an image has been indexed.
   bool ImageIndexed(const int image_id) const;
 
-  // Query for most similar images in the visual index.
+  // Query for most similar images in the visual index. Once the index is
+  // prepared, it is read-only during querying, so that multiple threads can
+  // concurrently query the same index. In this case, it is most efficient to
+  // set the number of threads per query to one.
   void Query(const QueryOptions& options, const DescType& descriptors,
              std::vector<ImageScore>* image_scores) const;
 
@@ -145,14 +192,43 @@ class VisualIndex {
   // descriptor space into visual words and compute their Hamming embedding.
   void Build(const BuildOptions& options, const DescType& descriptors);
 
+  // Build a visual index from a stream of training descriptors, such that the
+  // training descriptors never have to be held in memory at once.
+  void Build(const BuildOptions& options,
+             DescriptorStreamType* descriptor_stream);
+
+  // Assign the visual words on the given CUDA device instead of with FLANN,
+  // see `VisualWordSearchCUDA`. The search is exact rather than approximate,
+  // so that the number of checks is ignored, and it is only used for at most
+  // `VisualWordSearchCUDA::kMaxNumNeighbors` nearest neighbors. Only
+  // supported for 128-dim 8-bit descriptors and if compiled with CUDA. Must
+  // be called again after building or reading the index.
+  void SetupGPU(const int gpu_index);
+
+  // Find the nearest neighbor visual words for the given descriptors, e.g.,
+  // to quantize descriptors for an external inverted file that shares the
+  // vocabulary of this index.
+  Eigen::MatrixXi FindWordIds(const DescType& descriptors,
+                              const int num_neighbors, const int num_checks,
+                              const int num_threads) const;
+
   // Read and write the visual index. This can be done for an index with and
-  // without indexed images.
+  // without indexed images. The identifiers of all indexed images are stored
+  // alongside the inverted index, so that a previously written index can be
+  // extended incrementally by only adding the images that are not yet indexed.
   void Read(const std::string& path);
   void Write(const std::string& path);
 
  private:
   // Quantize the descriptor space into visual words.
-  void Quantize(const BuildOptions& options, const DescType& descriptors);
+  void Quantize(const BuildOptions& options,
+                DescriptorStreamType* descriptor_stream);
+
+  // Add the entries of an image to the inverted index, where the visual words
+  // of its descriptors start at the given row of the word identifiers.
+  void AddEntries(const IndexOptions& options, const int image_id,
+                  const GeomType& geometries, const DescType& descriptors,
+                  const Eigen::MatrixXi& word_ids, const int word_ids_row);
 
   // Query for nearest neighbor images and return nearest neighbor visual word
   // identifiers for each descriptor.
@@ -161,10 +237,17 @@ class VisualIndex {
                            std::vector<ImageScore>* image_scores,
                            Eigen::MatrixXi* word_ids) const;
 
-  // Find the nearest neighbor visual words for the given descriptors.
-  Eigen::MatrixXi FindWordIds(const DescType& descriptors,
-                              const int num_neighbors, const int num_checks,
-                              const int num_threads) const;
+  // Ordered feature matches of one query or database feature, most similar
+  // first after sorting.
+  typedef std::vector<
+      std::pair<float, std::pair<const EntryType*, const EntryType*>>>
+      OrderedMatchListType;
+
+  // Spatially verify the matches between the query and one database image
+  // after enforcing 1-to-1 matching and return the number of inliers.
+  int VerifyImage(
+      std::unordered_map<int, OrderedMatchListType>* query_matches,
+      std::unordered_map<int, OrderedMatchListType>* db_matches) const;
 
   // The search structure on the quantized descriptor space.
   flann::AutotunedIndex<flann::L2<kDescType>> visual_word_index_;
@@ -172,6 +255,9 @@ class VisualIndex {
   // The centroids of the visual words.
   flann::Matrix<kDescType> visual_words_;
 
+  // The optional search of the visual words on the GPU.
+  std::unique_ptr<VisualWordSearchCUDA> gpu_word_search_;
+
   // The inverted index of the database.
   InvertedIndexType inverted_index_;
 
@@ -225,6 +311,117 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Add(
       FindWordIds(descriptors, options.num_neighbors, options.num_checks,
                   options.num_threads);
 
+  AddEntries(options, image_id, geometries, descriptors, word_ids, 0);
+}
+
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+uint64_t VisualIndex<kDescType, kDescDim, kEmbeddingDim>::VocabularyHash()
+    const {
+  // 64-bit FNV-1a hash of the shape and the data of the visual words.
+  uint64_t hash = 14695981039346656037ULL;
+  const auto HashBytes = [&hash](const void* data, const size_t num_bytes) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < num_bytes; ++i) {
+      hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+  };
+
+  const uint64_t rows = visual_words_.rows;
+  const uint64_t cols = visual_words_.cols;
+  HashBytes(&rows, sizeof(rows));
+  HashBytes(&cols, sizeof(cols));
+  if (visual_words_.ptr() != nullptr) {
+    HashBytes(visual_words_.ptr(), rows * cols * sizeof(kDescType));
+  }
+
+  return hash;
+}
+
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Add(
+    const IndexOptions& options, const int image_id, const GeomType& geometries,
+    const DescType& descriptors, const Eigen::MatrixXi& word_ids) {
+  CHECK_EQ(geometries.size(), descriptors.rows());
+  CHECK_EQ(word_ids.rows(), descriptors.rows());
+
+  if (ImageIndexed(image_id)) {
+    return;
+  }
+
+  image_ids_.insert(image_id);
+
+  prepared_ = false;
+
+  if (descriptors.rows() == 0) {
+    return;
+  }
+
+  CHECK_EQ(word_ids.cols(), options.num_neighbors);
+
+  AddEntries(options, image_id, geometries, descriptors, word_ids, 0);
+}
+
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Add(
+    const IndexOptions& options, const std::vector<int>& image_ids,
+    const std::vector<GeomType>& geometries,
+    const std::vector<DescType>& descriptors,
+    std::vector<Eigen::MatrixXi>* word_ids) {
+  CHECK_EQ(image_ids.size(), geometries.size());
+  CHECK_EQ(image_ids.size(), descriptors.size());
+
+  if (word_ids != nullptr) {
+    word_ids->clear();
+    word_ids->resize(image_ids.size());
+  }
+
+  // Collect the descriptors of all images that are not yet indexed.
+  std::vector<size_t> batch_idxs;
+  typename DescType::Index num_batch_descriptors = 0;
+  for (size_t i = 0; i < image_ids.size(); ++i) {
+    CHECK_EQ(geometries[i].size(), descriptors[i].rows());
+    if (ImageIndexed(image_ids[i])) {
+      continue;
+    }
+    image_ids_.insert(image_ids[i]);
+    prepared_ = false;
+    if (descriptors[i].rows() > 0) {
+      batch_idxs.push_back(i);
+      num_batch_descriptors += descriptors[i].rows();
+    }
+  }
+
+  if (batch_idxs.empty()) {
+    return;
+  }
+
+  DescType batch_descriptors(num_batch_descriptors, kDescDim);
+  typename DescType::Index row = 0;
+  for (const size_t i : batch_idxs) {
+    batch_descriptors.middleRows(row, descriptors[i].rows()) = descriptors[i];
+    row += descriptors[i].rows();
+  }
+
+  const Eigen::MatrixXi batch_word_ids =
+      FindWordIds(batch_descriptors, options.num_neighbors, options.num_checks,
+                  options.num_threads);
+
+  row = 0;
+  for (const size_t i : batch_idxs) {
+    AddEntries(options, image_ids[i], geometries[i], descriptors[i],
+               batch_word_ids, row);
+    if (word_ids != nullptr) {
+      (*word_ids)[i] = batch_word_ids.middleRows(row, descriptors[i].rows());
+    }
+    row += descriptors[i].rows();
+  }
+}
+
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::AddEntries(
+    const IndexOptions& options, const int image_id,
+    const GeomType& geometries, const DescType& descriptors,
+    const Eigen::MatrixXi& word_ids, const int word_ids_row) {
   for (typename DescType::Index i = 0; i < descriptors.rows(); ++i) {
     const auto& descriptor = descriptors.row(i);
 
@@ -235,7 +432,7 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Add(
     geometry.orientation = geometries[i].ComputeOrientation();
 
     for (int n = 0; n < options.num_neighbors; ++n) {
-      const int word_id = word_ids(i, n);
+      const int word_id = word_ids(word_ids_row + i, n);
       if (word_id != InvertedIndexType::kInvalidWordId) {
         inverted_index_.AddEntry(image_id, word_id, i, descriptor, geometry);
       }
@@ -277,10 +474,6 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Query(
   }
 
   // Find matches for top-ranked images
-  typedef std::vector<
-      std::pair<float, std::pair<const EntryType*, const EntryType*>>>
-      OrderedMatchListType;
-
   // Reference our matches (with their lowest distance) for both
   // {query feature => db feature} and vice versa.
   std::unordered_map<int, std::unordered_map<int, OrderedMatchListType>>
@@ -363,124 +556,74 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Query(
     }
   }
 
-  // Verify top-ranked images using the found matches.
-  for (auto& image_score : *image_scores) {
-    auto& query_matches = query_to_db_matches[image_score.image_id];
-    auto& db_matches = db_to_query_matches[image_score.image_id];
-
-    // No matches found.
-    if (query_matches.empty()) {
-      continue;
-    }
-
-    // Enforce 1-to-1 matching: Build Fibonacci heaps for the query and database
-    // features, ordered by the minimum number of matches per feature. We'll
-    // select these matches one at a time. For convenience, we'll also pre-sort
-    // the matched feature lists by matching score.
-
-    typedef boost::heap::fibonacci_heap<std::pair<int, int>> FibonacciHeapType;
-    FibonacciHeapType query_heap;
-    FibonacciHeapType db_heap;
-    std::unordered_map<int, typename FibonacciHeapType::handle_type>
-        query_heap_handles;
-    std::unordered_map<int, typename FibonacciHeapType::handle_type>
-        db_heap_handles;
-
-    for (auto& match_data : query_matches) {
-      std::sort(match_data.second.begin(), match_data.second.end(),
-                std::greater<std::pair<
-                    float, std::pair<const EntryType*, const EntryType*>>>());
-
-      query_heap_handles[match_data.first] = query_heap.push(std::make_pair(
-          -static_cast<int>(match_data.second.size()), match_data.first));
-    }
+  // Verify the top-ranked images in descending order of their retrieval
+  // scores using the found matches. The images are verified in parallel
+  // batches, after which the time budget and early termination are checked.
+  Timer timer;
+  timer.Start();
 
-    for (auto& match_data : db_matches) {
-      std::sort(match_data.second.begin(), match_data.second.end(),
-                std::greater<std::pair<
-                    float, std::pair<const EntryType*, const EntryType*>>>());
+  const int num_threads = GetEffectiveNumThreads(options.num_threads);
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (num_threads > 1) {
+    thread_pool.reset(new ThreadPool(num_threads));
+  }
 
-      db_heap_handles[match_data.first] = db_heap.push(std::make_pair(
-          -static_cast<int>(match_data.second.size()), match_data.first));
+  size_t num_inlier_images = 0;
+  for (size_t batch_begin = 0; batch_begin < image_scores->size();
+       batch_begin += num_threads) {
+    const size_t batch_end =
+        std::min(batch_begin + num_threads, image_scores->size());
+
+    // Create the match lists of all images in the batch up front, such that
+    // the maps are not modified concurrently.
+    for (size_t idx = batch_begin; idx < batch_end; ++idx) {
+      const int image_id = (*image_scores)[idx].image_id;
+      query_to_db_matches[image_id];
+      db_to_query_matches[image_id];
     }
 
-    // Keep tabs on what features have been already matched.
-    std::vector<FeatureGeometryMatch> matches;
-
-    auto db_top = db_heap.top();  // (-num_available_matches, feature_idx)
-    auto query_top = query_heap.top();
-
-    while (!db_heap.empty() && !query_heap.empty()) {
-      // Take the query or database feature with the smallest number of
-      // available matches.
-      const bool use_query =
-          (query_top.first >= db_top.first) && !query_heap.empty();
-
-      // Find the best matching feature that hasn't already been matched.
-      auto& heap1 = (use_query) ? query_heap : db_heap;
-      auto& heap2 = (use_query) ? db_heap : query_heap;
-      auto& handles1 = (use_query) ? query_heap_handles : db_heap_handles;
-      auto& handles2 = (use_query) ? db_heap_handles : query_heap_handles;
-      auto& matches1 = (use_query) ? query_matches : db_matches;
-      auto& matches2 = (use_query) ? db_matches : query_matches;
-
-      const auto idx1 = heap1.top().second;
-      heap1.pop();
-
-      // Entries that have been matched (or processed and subsequently ignored)
-      // get their handles removed.
-      if (handles1.count(idx1) > 0) {
-        handles1.erase(idx1);
-
-        bool match_found = false;
-
-        // The matches have been ordered by Hamming distance, already --
-        // select the lowest available match.
-        for (auto& entry2 : matches1[idx1]) {
-          const auto idx2 = (use_query) ? entry2.second.second->feature_idx
-                                        : entry2.second.first->feature_idx;
-
-          if (handles2.count(idx2) > 0) {
-            if (!match_found) {
-              match_found = true;
-              FeatureGeometryMatch match;
-              match.geometry1 = entry2.second.first->geometry;
-              match.geometries2.push_back(entry2.second.second->geometry);
-              matches.push_back(match);
-
-              handles2.erase(idx2);
-
-              // Remove this feature from consideration for all other features
-              // that matched to it.
-              for (auto& entry1 : matches2[idx2]) {
-                const auto other_idx1 = (use_query)
-                                            ? entry1.second.first->feature_idx
-                                            : entry1.second.second->feature_idx;
-                if (handles1.count(other_idx1) > 0) {
-                  (*handles1[other_idx1]).first += 1;
-                  heap1.increase(handles1[other_idx1]);
-                }
-              }
-            } else {
-              (*handles2[idx2]).first += 1;
-              heap2.increase(handles2[idx2]);
-            }
-          }
-        }
+    std::vector<int> num_inliers(batch_end - batch_begin, 0);
+    auto VerifyFunc = [&](const size_t idx) {
+      const int image_id = (*image_scores)[idx].image_id;
+      auto& query_matches = query_to_db_matches.at(image_id);
+      auto& db_matches = db_to_query_matches.at(image_id);
+      // No matches found.
+      if (!query_matches.empty()) {
+        num_inliers[idx - batch_begin] =
+            VerifyImage(&query_matches, &db_matches);
       }
+    };
 
-      if (!query_heap.empty()) {
-        query_top = query_heap.top();
+    if (thread_pool) {
+      for (size_t idx = batch_begin; idx < batch_end; ++idx) {
+        thread_pool->AddTask(VerifyFunc, idx);
       }
+      thread_pool->Wait();
+    } else {
+      for (size_t idx = batch_begin; idx < batch_end; ++idx) {
+        VerifyFunc(idx);
+      }
+    }
 
-      if (!db_heap.empty()) {
-        db_top = db_heap.top();
+    for (size_t idx = batch_begin; idx < batch_end; ++idx) {
+      (*image_scores)[idx].score += num_inliers[idx - batch_begin];
+      if (options.verification_min_num_inliers > 0 &&
+          num_inliers[idx - batch_begin] >=
+              options.verification_min_num_inliers) {
+        num_inlier_images += 1;
       }
     }
 
-    // Finally, run verification for the current image.
-    VoteAndVerifyOptions vote_and_verify_options;
-    image_score.score += VoteAndVerify(vote_and_verify_options, matches);
+    if (options.verification_min_num_inliers > 0 &&
+        num_inlier_images >=
+            static_cast<size_t>(options.num_images_after_verification)) {
+      break;
+    }
+
+    if (options.max_verification_time >= 0 &&
+        timer.ElapsedSeconds() > options.max_verification_time) {
+      break;
+    }
   }
 
   // Re-rank the images using the spatial verification scores.
@@ -501,6 +644,123 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Query(
   }
 }
 
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+int VisualIndex<kDescType, kDescDim, kEmbeddingDim>::VerifyImage(
+    std::unordered_map<int, OrderedMatchListType>* query_matches_ptr,
+    std::unordered_map<int, OrderedMatchListType>* db_matches_ptr) const {
+  auto& query_matches = *query_matches_ptr;
+  auto& db_matches = *db_matches_ptr;
+
+  // Enforce 1-to-1 matching: Build Fibonacci heaps for the query and database
+  // features, ordered by the minimum number of matches per feature. We'll
+  // select these matches one at a time. For convenience, we'll also pre-sort
+  // the matched feature lists by matching score.
+
+  typedef boost::heap::fibonacci_heap<std::pair<int, int>> FibonacciHeapType;
+  FibonacciHeapType query_heap;
+  FibonacciHeapType db_heap;
+  std::unordered_map<int, typename FibonacciHeapType::handle_type>
+      query_heap_handles;
+  std::unordered_map<int, typename FibonacciHeapType::handle_type>
+      db_heap_handles;
+
+  for (auto& match_data : query_matches) {
+    std::sort(match_data.second.begin(), match_data.second.end(),
+              std::greater<std::pair<
+                  float, std::pair<const EntryType*, const EntryType*>>>());
+
+    query_heap_handles[match_data.first] = query_heap.push(std::make_pair(
+        -static_cast<int>(match_data.second.size()), match_data.first));
+  }
+
+  for (auto& match_data : db_matches) {
+    std::sort(match_data.second.begin(), match_data.second.end(),
+              std::greater<std::pair<
+                  float, std::pair<const EntryType*, const EntryType*>>>());
+
+    db_heap_handles[match_data.first] = db_heap.push(std::make_pair(
+        -static_cast<int>(match_data.second.size()), match_data.first));
+  }
+
+  // Keep tabs on what features have been already matched.
+  std::vector<FeatureGeometryMatch> matches;
+
+  auto db_top = db_heap.top();  // (-num_available_matches, feature_idx)
+  auto query_top = query_heap.top();
+
+  while (!db_heap.empty() && !query_heap.empty()) {
+    // Take the query or database feature with the smallest number of
+    // available matches.
+    const bool use_query =
+        (query_top.first >= db_top.first) && !query_heap.empty();
+
+    // Find the best matching feature that hasn't already been matched.
+    auto& heap1 = (use_query) ? query_heap : db_heap;
+    auto& heap2 = (use_query) ? db_heap : query_heap;
+    auto& handles1 = (use_query) ? query_heap_handles : db_heap_handles;
+    auto& handles2 = (use_query) ? db_heap_handles : query_heap_handles;
+    auto& matches1 = (use_query) ? query_matches : db_matches;
+    auto& matches2 = (use_query) ? db_matches : query_matches;
+
+    const auto idx1 = heap1.top().second;
+    heap1.pop();
+
+    // Entries that have been matched (or processed and subsequently ignored)
+    // get their handles removed.
+    if (handles1.count(idx1) > 0) {
+      handles1.erase(idx1);
+
+      bool match_found = false;
+
+      // The matches have been ordered by Hamming distance, already --
+      // select the lowest available match.
+      for (auto& entry2 : matches1[idx1]) {
+        const auto idx2 = (use_query) ? entry2.second.second->feature_idx
+                                      : entry2.second.first->feature_idx;
+
+        if (handles2.count(idx2) > 0) {
+          if (!match_found) {
+            match_found = true;
+            FeatureGeometryMatch match;
+            match.geometry1 = entry2.second.first->geometry;
+            match.geometries2.push_back(entry2.second.second->geometry);
+            matches.push_back(match);
+
+            handles2.erase(idx2);
+
+            // Remove this feature from consideration for all other features
+            // that matched to it.
+            for (auto& entry1 : matches2[idx2]) {
+              const auto other_idx1 = (use_query)
+                                          ? entry1.second.first->feature_idx
+                                          : entry1.second.second->feature_idx;
+              if (handles1.count(other_idx1) > 0) {
+                (*handles1[other_idx1]).first += 1;
+                heap1.increase(handles1[other_idx1]);
+              }
+            }
+          } else {
+            (*handles2[idx2]).first += 1;
+            heap2.increase(handles2[idx2]);
+          }
+        }
+      }
+    }
+
+    if (!query_heap.empty()) {
+      query_top = query_heap.top();
+    }
+
+    if (!db_heap.empty()) {
+      db_top = db_heap.top();
+    }
+  }
+
+  // Finally, run verification for the current image.
+  VoteAndVerifyOptions vote_and_verify_options;
+  return VoteAndVerify(vote_and_verify_options, matches);
+}
+
 template <typename kDescType, int kDescDim, int kEmbeddingDim>
 void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Prepare() {
   inverted_index_.Finalize();
@@ -510,8 +770,19 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Prepare() {
 template <typename kDescType, int kDescDim, int kEmbeddingDim>
 void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Build(
     const BuildOptions& options, const DescType& descriptors) {
+  CHECK_GE(descriptors.rows(), options.num_visual_words);
+  const int kBatchSize = 10000;
+  MatrixDescriptorStream<DescType> descriptor_stream(descriptors, kBatchSize);
+  Build(options, &descriptor_stream);
+}
+
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Build(
+    const BuildOptions& options, DescriptorStreamType* descriptor_stream) {
+  CHECK_GT(options.max_num_embedding_descriptors, 0);
+
   // Quantize the descriptor space into visual words.
-  Quantize(options, descriptors);
+  Quantize(options, descriptor_stream);
 
   // Build the search index on the visual words.
   flann::AutotunedIndexParams index_params;
@@ -528,6 +799,38 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Build(
   // Generate descriptor projection matrix.
   inverted_index_.GenerateHammingEmbeddingProjection();
 
+  // Randomly sample the descriptors to learn the Hamming embedding.
+  const typename DescType::Index max_num_descriptors =
+      options.max_num_embedding_descriptors;
+  DescType descriptors;
+  typename DescType::Index num_descriptors = 0;
+  size_t num_streamed_descriptors = 0;
+  DescType batch_descriptors;
+  descriptor_stream->Reset();
+  while (descriptor_stream->Next(&batch_descriptors)) {
+    for (typename DescType::Index i = 0; i < batch_descriptors.rows(); ++i) {
+      num_streamed_descriptors += 1;
+      if (num_descriptors < max_num_descriptors) {
+        if (num_descriptors == descriptors.rows()) {
+          descriptors.conservativeResize(
+              std::min(max_num_descriptors,
+                       std::max<typename DescType::Index>(
+                           2 * num_descriptors, batch_descriptors.rows())),
+              kDescDim);
+        }
+        descriptors.row(num_descriptors) = batch_descriptors.row(i);
+        num_descriptors += 1;
+      } else {
+        const size_t row =
+            RandomInteger<size_t>(0, num_streamed_descriptors - 1);
+        if (row < static_cast<size_t>(max_num_descriptors)) {
+          descriptors.row(row) = batch_descriptors.row(i);
+        }
+      }
+    }
+  }
+  descriptors.conservativeResize(num_descriptors, kDescDim);
+
   // Learn the Hamming embedding.
   const int kNumNeighbors = 1;
   const Eigen::MatrixXi word_ids = FindWordIds(
@@ -547,6 +850,8 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Read(
       delete[] visual_words_.ptr();
     }
 
+    gpu_word_search_.reset();
+
     std::ifstream file(path, std::ios::binary);
     CHECK(file.is_open()) << path;
     const uint64_t rows = ReadBinaryLittleEndian<uint64_t>(&file);
@@ -580,10 +885,23 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Read(
     CHECK(file.is_open()) << path;
     file.seekg(file_offset, std::ios::beg);
     inverted_index_.Read(&file);
+
+    // Read the indexed image identifiers, which also include images without
+    // any entries in the inverted index. Older index files do not store them,
+    // in which case they are recovered from the inverted index entries.
+    image_ids_.clear();
+    if (file.peek() != std::ifstream::traits_type::eof()) {
+      const uint64_t num_image_ids = ReadBinaryLittleEndian<uint64_t>(&file);
+      image_ids_.reserve(num_image_ids);
+      for (uint64_t i = 0; i < num_image_ids; ++i) {
+        image_ids_.insert(ReadBinaryLittleEndian<int32_t>(&file));
+      }
+    } else {
+      inverted_index_.GetImageIds(&image_ids_);
+    }
   }
 
-  image_ids_.clear();
-  inverted_index_.GetImageIds(&image_ids_);
+  prepared_ = false;
 }
 
 template <typename kDescType, int kDescDim, int kEmbeddingDim>
@@ -617,42 +935,40 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Write(
     std::ofstream file(path, std::ios::binary | std::ios::app);
     CHECK(file.is_open()) << path;
     inverted_index_.Write(&file);
+
+    // Write the indexed image identifiers.
+    WriteBinaryLittleEndian<uint64_t>(&file, image_ids_.size());
+    for (const int image_id : image_ids_) {
+      WriteBinaryLittleEndian<int32_t>(&file, image_id);
+    }
   }
 }
 
 template <typename kDescType, int kDescDim, int kEmbeddingDim>
 void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Quantize(
-    const BuildOptions& options, const DescType& descriptors) {
+    const BuildOptions& options, DescriptorStreamType* descriptor_stream) {
   static_assert(DescType::IsRowMajor, "Descriptors must be row-major.");
 
   CHECK_GE(options.num_visual_words, options.branching);
-  CHECK_GE(descriptors.rows(), options.num_visual_words);
-
-  const flann::Matrix<kDescType> descriptor_matrix(
-      const_cast<kDescType*>(descriptors.data()), descriptors.rows(),
-      descriptors.cols());
-
-  std::vector<typename flann::L2<kDescType>::ResultType> centers_data(
-      options.num_visual_words * descriptors.cols());
-  flann::Matrix<typename flann::L2<kDescType>::ResultType> centers(
-      centers_data.data(), options.num_visual_words, descriptors.cols());
 
-  flann::KMeansIndexParams index_params;
-  index_params["branching"] = options.branching;
-  index_params["iterations"] = options.num_iterations;
-  index_params["centers_init"] = flann::FLANN_CENTERS_KMEANSPP;
-  const int num_centers = flann::hierarchicalClustering<flann::L2<kDescType>>(
-      descriptor_matrix, centers, index_params);
+  typename HierarchicalKMeans<kDescType, kDescDim>::Options kmeans_options;
+  kmeans_options.num_clusters = options.num_visual_words;
+  kmeans_options.branching = options.branching;
+  kmeans_options.num_iterations = options.num_iterations;
+  kmeans_options.num_threads = options.num_threads;
+  HierarchicalKMeans<kDescType, kDescDim> kmeans(kmeans_options);
+  const auto centers = kmeans.Cluster(descriptor_stream);
 
-  CHECK_LE(num_centers, options.num_visual_words);
+  CHECK_GT(centers.rows(), 0);
+  CHECK_LE(centers.rows(), options.num_visual_words);
 
-  const size_t visual_word_data_size = num_centers * descriptors.cols();
+  const size_t visual_word_data_size = centers.size();
   kDescType* visual_words_data = new kDescType[visual_word_data_size];
   for (size_t i = 0; i < visual_word_data_size; ++i) {
     if (std::is_integral<kDescType>::value) {
-      visual_words_data[i] = std::round(centers_data[i]);
+      visual_words_data[i] = std::round(centers.data()[i]);
     } else {
-      visual_words_data[i] = centers_data[i];
+      visual_words_data[i] = centers.data()[i];
     }
   }
 
@@ -660,8 +976,10 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::Quantize(
     delete[] visual_words_.ptr();
   }
 
-  visual_words_ = flann::Matrix<kDescType>(visual_words_data, num_centers,
-                                           descriptors.cols());
+  gpu_word_search_.reset();
+
+  visual_words_ = flann::Matrix<kDescType>(visual_words_data, centers.rows(),
+                                           centers.cols());
 }
 
 template <typename kDescType, int kDescDim, int kEmbeddingDim>
@@ -677,7 +995,8 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::QueryAndFindWordIds(
 
   *word_ids = FindWordIds(descriptors, options.num_neighbors,
                           options.num_checks, options.num_threads);
-  inverted_index_.Query(descriptors, *word_ids, image_scores);
+  inverted_index_.Query(descriptors, *word_ids, options.num_threads,
+                        image_scores);
 
   auto SortFunc = [](const ImageScore& score1, const ImageScore& score2) {
     return score1.score > score2.score;
@@ -697,6 +1016,21 @@ void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::QueryAndFindWordIds(
   }
 }
 
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+void VisualIndex<kDescType, kDescDim, kEmbeddingDim>::SetupGPU(
+    const int gpu_index) {
+#ifdef CUDA_ENABLED
+  CHECK((std::is_same<kDescType, uint8_t>::value && kDescDim == 128))
+      << "GPU visual word search requires 128-dim 8-bit descriptors";
+  CHECK_GT(visual_words_.rows, 0);
+  gpu_word_search_.reset(new VisualWordSearchCUDA(
+      reinterpret_cast<const uint8_t*>(visual_words_.ptr()),
+      visual_words_.rows, gpu_index));
+#else
+  LOG(FATAL) << "GPU visual word search requires CUDA";
+#endif
+}
+
 template <typename kDescType, int kDescDim, int kEmbeddingDim>
 Eigen::MatrixXi VisualIndex<kDescType, kDescDim, kEmbeddingDim>::FindWordIds(
     const DescType& descriptors, const int num_neighbors, const int num_checks,
@@ -706,35 +1040,72 @@ Eigen::MatrixXi VisualIndex<kDescType, kDescDim, kEmbeddingDim>::FindWordIds(
   CHECK_GT(descriptors.rows(), 0);
   CHECK_GT(num_neighbors, 0);
 
+#ifdef CUDA_ENABLED
+  if (gpu_word_search_ &&
+      num_neighbors <= VisualWordSearchCUDA::kMaxNumNeighbors) {
+    Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        gpu_word_ids(descriptors.rows(), num_neighbors);
+    gpu_word_search_->Search(
+        reinterpret_cast<const uint8_t*>(descriptors.data()),
+        descriptors.rows(), num_neighbors, gpu_word_ids.data());
+    for (Eigen::Index i = 0; i < gpu_word_ids.size(); ++i) {
+      if (gpu_word_ids.data()[i] == -1) {
+        gpu_word_ids.data()[i] = InvertedIndexType::kInvalidWordId;
+      }
+    }
+    return gpu_word_ids;
+  }
+#endif
+
   Eigen::Matrix<size_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
       word_ids(descriptors.rows(), num_neighbors);
   word_ids.setConstant(InvertedIndexType::kInvalidWordId);
-  flann::Matrix<size_t> indices(word_ids.data(), descriptors.rows(),
-                                num_neighbors);
 
   Eigen::Matrix<typename flann::L2<kDescType>::ResultType, Eigen::Dynamic,
                 Eigen::Dynamic, Eigen::RowMajor>
       distance_matrix(descriptors.rows(), num_neighbors);
-  flann::Matrix<typename flann::L2<kDescType>::ResultType> distances(
-      distance_matrix.data(), descriptors.rows(), num_neighbors);
 
-  const flann::Matrix<kDescType> query(
-      const_cast<kDescType*>(descriptors.data()), descriptors.rows(),
-      descriptors.cols());
+  // The rows are searched in parallel chunks, independent of whether FLANN
+  // was compiled with OpenMP support.
+  const int kMinNumDescriptorsPerThread = 256;
+  const int num_eff_threads =
+      std::min<int>(GetEffectiveNumThreads(num_threads),
+                    descriptors.rows() / kMinNumDescriptorsPerThread);
 
   flann::SearchParams search_params(num_checks);
-  if (num_threads < 0) {
-    search_params.cores = std::thread::hardware_concurrency();
+  search_params.cores = 1;
+
+  auto SearchFunc = [&](const typename DescType::Index begin_row,
+                        const typename DescType::Index end_row) {
+    const size_t num_rows = end_row - begin_row;
+    const flann::Matrix<kDescType> query(
+        const_cast<kDescType*>(descriptors.row(begin_row).data()), num_rows,
+        descriptors.cols());
+    flann::Matrix<size_t> indices(word_ids.row(begin_row).data(), num_rows,
+                                  num_neighbors);
+    flann::Matrix<typename flann::L2<kDescType>::ResultType> distances(
+        distance_matrix.row(begin_row).data(), num_rows, num_neighbors);
+    visual_word_index_.knnSearch(query, indices, distances, num_neighbors,
+                                 search_params);
+  };
+
+  if (num_eff_threads <= 1) {
+    SearchFunc(0, descriptors.rows());
   } else {
-    search_params.cores = num_threads;
-  }
-  if (search_params.cores <= 0) {
-    search_params.cores = 1;
+    const typename DescType::Index num_rows_per_thread =
+        (descriptors.rows() + num_eff_threads - 1) / num_eff_threads;
+    ThreadPool thread_pool(num_eff_threads);
+    for (int thread_idx = 0; thread_idx < num_eff_threads; ++thread_idx) {
+      const typename DescType::Index begin_row =
+          thread_idx * num_rows_per_thread;
+      const typename DescType::Index end_row = std::min<
+          typename DescType::Index>(begin_row + num_rows_per_thread,
+                                    descriptors.rows());
+      thread_pool.AddTask(SearchFunc, begin_row, end_row);
+    }
+    thread_pool.Wait();
   }
 
-  visual_word_index_.knnSearch(query, indices, distances, num_neighbors,
-                               search_params);
-
   return word_ids.cast<int>();
 }
 
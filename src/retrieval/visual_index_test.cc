@@ -32,7 +32,10 @@
 #define TEST_NAME "retrieval/visual_index"
 #include "util/testing.h"
 
+#include <boost/filesystem.hpp>
+
 #include "retrieval/visual_index.h"
+#include "util/threading.h"
 
 using namespace colmap;
 using namespace colmap::retrieval;
@@ -104,6 +107,359 @@ void TestVocabTreeType() {
   }
 }
 
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+void TestVocabTreeReadWriteType() {
+  typedef VisualIndex<kDescType, kDescDim, kEmbeddingDim> VisualIndexType;
+
+  SetPRNGSeed(0);
+
+  const std::string path = (boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path())
+                               .string();
+
+  typename VisualIndexType::DescType descriptors =
+      VisualIndexType::DescType::Random(1000, kDescDim);
+  typename VisualIndexType::BuildOptions build_options;
+  build_options.num_visual_words = 100;
+  build_options.branching = 10;
+
+  typename VisualIndexType::IndexOptions index_options;
+  typename VisualIndexType::GeomType keypoints(50);
+  typename VisualIndexType::DescType descriptors1 =
+      VisualIndexType::DescType::Random(50, kDescDim);
+  typename VisualIndexType::DescType descriptors2 =
+      VisualIndexType::DescType::Random(50, kDescDim);
+  typename VisualIndexType::DescType descriptors3 =
+      VisualIndexType::DescType::Random(50, kDescDim);
+
+  {
+    VisualIndexType visual_index;
+    visual_index.Build(build_options, descriptors);
+    visual_index.Add(index_options, 1, keypoints, descriptors1);
+    visual_index.Add(index_options, 2, keypoints, descriptors2);
+    visual_index.Add(index_options, 4, typename VisualIndexType::GeomType(),
+                     typename VisualIndexType::DescType(0, kDescDim));
+    visual_index.Prepare();
+    visual_index.Write(path);
+  }
+
+  VisualIndexType visual_index;
+  visual_index.Read(path);
+  BOOST_CHECK_EQUAL(visual_index.NumVisualWords(), 100);
+  BOOST_CHECK(visual_index.ImageIndexed(1));
+  BOOST_CHECK(visual_index.ImageIndexed(2));
+  BOOST_CHECK(!visual_index.ImageIndexed(3));
+  BOOST_CHECK(visual_index.ImageIndexed(4));
+
+  visual_index.Add(index_options, 3, keypoints, descriptors3);
+  BOOST_CHECK(visual_index.ImageIndexed(3));
+  visual_index.Prepare();
+
+  typename VisualIndexType::QueryOptions query_options;
+  std::vector<ImageScore> image_scores;
+  visual_index.Query(query_options, descriptors1, &image_scores);
+  BOOST_CHECK_EQUAL(image_scores.size(), 3);
+  BOOST_CHECK_EQUAL(image_scores[0].image_id, 1);
+  visual_index.Query(query_options, descriptors3, &image_scores);
+  BOOST_CHECK_EQUAL(image_scores.size(), 3);
+  BOOST_CHECK_EQUAL(image_scores[0].image_id, 3);
+
+  boost::filesystem::remove(path);
+}
+
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+void TestVocabTreeParallelQueryType() {
+  typedef VisualIndex<kDescType, kDescDim, kEmbeddingDim> VisualIndexType;
+
+  SetPRNGSeed(0);
+
+  typename VisualIndexType::DescType descriptors =
+      VisualIndexType::DescType::Random(1000, kDescDim);
+  VisualIndexType visual_index;
+  typename VisualIndexType::BuildOptions build_options;
+  build_options.num_visual_words = 100;
+  build_options.branching = 10;
+  visual_index.Build(build_options, descriptors);
+
+  const int kNumImages = 4;
+  const int kNumFeatures = 1000;
+  std::vector<typename VisualIndexType::DescType> image_descriptors;
+  typename VisualIndexType::IndexOptions index_options;
+  for (int image_id = 0; image_id < kNumImages; ++image_id) {
+    image_descriptors.push_back(
+        VisualIndexType::DescType::Random(kNumFeatures, kDescDim));
+    visual_index.Add(index_options, image_id,
+                     typename VisualIndexType::GeomType(kNumFeatures),
+                     image_descriptors.back());
+  }
+  visual_index.Prepare();
+
+  typename VisualIndexType::QueryOptions query_options;
+  query_options.num_threads = 1;
+  std::vector<std::vector<ImageScore>> image_scores(kNumImages);
+  for (int image_id = 0; image_id < kNumImages; ++image_id) {
+    visual_index.Query(query_options, image_descriptors[image_id],
+                       &image_scores[image_id]);
+    BOOST_CHECK_EQUAL(image_scores[image_id].size(), kNumImages);
+  }
+
+  // Multi-threaded queries of a single image.
+  query_options.num_threads = 4;
+  for (int image_id = 0; image_id < kNumImages; ++image_id) {
+    std::vector<ImageScore> parallel_image_scores;
+    visual_index.Query(query_options, image_descriptors[image_id],
+                       &parallel_image_scores);
+    BOOST_CHECK_EQUAL(parallel_image_scores.size(), kNumImages);
+    for (int i = 0; i < kNumImages; ++i) {
+      BOOST_CHECK_EQUAL(parallel_image_scores[i].image_id,
+                        image_scores[image_id][i].image_id);
+      BOOST_CHECK_CLOSE(parallel_image_scores[i].score,
+                        image_scores[image_id][i].score, 1e-3);
+    }
+  }
+
+  // Concurrent single-threaded queries of the same index.
+  query_options.num_threads = 1;
+  ThreadPool thread_pool(kNumImages);
+  std::vector<std::future<std::vector<ImageScore>>> futures;
+  for (int image_id = 0; image_id < kNumImages; ++image_id) {
+    futures.push_back(thread_pool.AddTask([&, image_id]() {
+      std::vector<ImageScore> concurrent_image_scores;
+      visual_index.Query(query_options, image_descriptors[image_id],
+                         &concurrent_image_scores);
+      return concurrent_image_scores;
+    }));
+  }
+  for (int image_id = 0; image_id < kNumImages; ++image_id) {
+    const auto concurrent_image_scores = futures[image_id].get();
+    BOOST_CHECK_EQUAL(concurrent_image_scores.size(), kNumImages);
+    for (int i = 0; i < kNumImages; ++i) {
+      BOOST_CHECK_EQUAL(concurrent_image_scores[i].image_id,
+                        image_scores[image_id][i].image_id);
+      BOOST_CHECK_EQUAL(concurrent_image_scores[i].score,
+                        image_scores[image_id][i].score);
+    }
+  }
+}
+
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+void TestVocabTreeBatchAddType() {
+  typedef VisualIndex<kDescType, kDescDim, kEmbeddingDim> VisualIndexType;
+
+  SetPRNGSeed(0);
+
+  typename VisualIndexType::DescType descriptors =
+      VisualIndexType::DescType::Random(1000, kDescDim);
+  typename VisualIndexType::BuildOptions build_options;
+  build_options.num_visual_words = 100;
+  build_options.branching = 10;
+  // Both indices are built with the same random seed, so that they share the
+  // same visual words and Hamming embedding.
+  VisualIndexType visual_index;
+  SetPRNGSeed(0);
+  visual_index.Build(build_options, descriptors);
+  VisualIndexType batch_visual_index;
+  SetPRNGSeed(0);
+  batch_visual_index.Build(build_options, descriptors);
+
+  const int kNumImages = 4;
+  std::vector<int> image_ids;
+  std::vector<typename VisualIndexType::GeomType> image_keypoints;
+  std::vector<typename VisualIndexType::DescType> image_descriptors;
+  typename VisualIndexType::IndexOptions index_options;
+  index_options.num_neighbors = 2;
+  for (int image_id = 0; image_id < kNumImages; ++image_id) {
+    // The second image has no features.
+    const int num_features = image_id == 1 ? 0 : 100 * (image_id + 1);
+    image_ids.push_back(image_id);
+    image_keypoints.emplace_back(num_features);
+    image_descriptors.push_back(
+        VisualIndexType::DescType::Random(num_features, kDescDim));
+    visual_index.Add(index_options, image_id, image_keypoints.back(),
+                     image_descriptors.back());
+  }
+  visual_index.Prepare();
+
+  // Already indexed images in the batch are skipped.
+  batch_visual_index.Add(index_options, 0, image_keypoints[0],
+                         image_descriptors[0]);
+  batch_visual_index.Add(index_options, image_ids, image_keypoints,
+                         image_descriptors);
+  batch_visual_index.Prepare();
+
+  typename VisualIndexType::QueryOptions query_options;
+  for (int image_id = 0; image_id < kNumImages; ++image_id) {
+    BOOST_CHECK(batch_visual_index.ImageIndexed(image_id));
+    if (image_descriptors[image_id].rows() == 0) {
+      continue;
+    }
+    std::vector<ImageScore> image_scores;
+    visual_index.Query(query_options, image_descriptors[image_id],
+                       &image_scores);
+    std::vector<ImageScore> batch_image_scores;
+    batch_visual_index.Query(query_options, image_descriptors[image_id],
+                             &batch_image_scores);
+    BOOST_REQUIRE_EQUAL(batch_image_scores.size(), image_scores.size());
+    for (size_t i = 0; i < image_scores.size(); ++i) {
+      BOOST_CHECK_EQUAL(batch_image_scores[i].image_id,
+                        image_scores[i].image_id);
+      BOOST_CHECK_EQUAL(batch_image_scores[i].score, image_scores[i].score);
+    }
+  }
+}
+
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+void TestVocabTreeWordIdsType() {
+  typedef VisualIndex<kDescType, kDescDim, kEmbeddingDim> VisualIndexType;
+
+  typename VisualIndexType::DescType descriptors =
+      VisualIndexType::DescType::Random(1000, kDescDim);
+  typename VisualIndexType::BuildOptions build_options;
+  build_options.num_visual_words = 100;
+  build_options.branching = 10;
+  VisualIndexType visual_index;
+  SetPRNGSeed(0);
+  visual_index.Build(build_options, descriptors);
+  VisualIndexType cached_visual_index;
+  SetPRNGSeed(0);
+  cached_visual_index.Build(build_options, descriptors);
+  VisualIndexType other_visual_index;
+  SetPRNGSeed(1);
+  other_visual_index.Build(build_options, descriptors);
+
+  BOOST_CHECK_EQUAL(visual_index.VocabularyHash(),
+                    cached_visual_index.VocabularyHash());
+  BOOST_CHECK_NE(visual_index.VocabularyHash(),
+                 other_visual_index.VocabularyHash());
+  BOOST_CHECK_NE(visual_index.VocabularyHash(),
+                 VisualIndexType().VocabularyHash());
+
+  const int kNumImages = 4;
+  std::vector<int> image_ids;
+  std::vector<typename VisualIndexType::GeomType> image_keypoints;
+  std::vector<typename VisualIndexType::DescType> image_descriptors;
+  typename VisualIndexType::IndexOptions index_options;
+  index_options.num_neighbors = 2;
+  for (int image_id = 0; image_id < kNumImages; ++image_id) {
+    // The second image has no features.
+    const int num_features = image_id == 1 ? 0 : 100 * (image_id + 1);
+    image_ids.push_back(image_id);
+    image_keypoints.emplace_back(num_features);
+    image_descriptors.push_back(
+        VisualIndexType::DescType::Random(num_features, kDescDim));
+  }
+
+  std::vector<Eigen::MatrixXi> word_ids;
+  visual_index.Add(index_options, image_ids, image_keypoints,
+                   image_descriptors, &word_ids);
+  visual_index.Prepare();
+  BOOST_REQUIRE_EQUAL(word_ids.size(), kNumImages);
+  for (int image_id = 0; image_id < kNumImages; ++image_id) {
+    if (image_id == 1) {
+      BOOST_CHECK_EQUAL(word_ids[image_id].size(), 0);
+      continue;
+    }
+    BOOST_CHECK_EQUAL(word_ids[image_id],
+                      visual_index.FindWordIds(image_descriptors[image_id],
+                                               index_options.num_neighbors,
+                                               index_options.num_checks,
+                                               index_options.num_threads));
+  }
+
+  // Adding the images with their cached visual words yields the same index.
+  for (int image_id = 0; image_id < kNumImages; ++image_id) {
+    cached_visual_index.Add(index_options, image_id, image_keypoints[image_id],
+                            image_descriptors[image_id], word_ids[image_id]);
+  }
+  cached_visual_index.Prepare();
+
+  typename VisualIndexType::QueryOptions query_options;
+  for (int image_id = 0; image_id < kNumImages; ++image_id) {
+    BOOST_CHECK(cached_visual_index.ImageIndexed(image_id));
+    if (image_descriptors[image_id].rows() == 0) {
+      continue;
+    }
+    std::vector<ImageScore> image_scores;
+    visual_index.Query(query_options, image_descriptors[image_id],
+                       &image_scores);
+    std::vector<ImageScore> cached_image_scores;
+    cached_visual_index.Query(query_options, image_descriptors[image_id],
+                              &cached_image_scores);
+    BOOST_REQUIRE_EQUAL(cached_image_scores.size(), image_scores.size());
+    for (size_t i = 0; i < image_scores.size(); ++i) {
+      BOOST_CHECK_EQUAL(cached_image_scores[i].image_id,
+                        image_scores[i].image_id);
+      BOOST_CHECK_EQUAL(cached_image_scores[i].score, image_scores[i].score);
+    }
+  }
+}
+
+template <typename kDescType, int kDescDim, int kEmbeddingDim>
+void TestVocabTreeVerificationType() {
+  typedef VisualIndex<kDescType, kDescDim, kEmbeddingDim> VisualIndexType;
+
+  SetPRNGSeed(0);
+
+  typename VisualIndexType::DescType descriptors =
+      VisualIndexType::DescType::Random(1000, kDescDim);
+  VisualIndexType visual_index;
+  typename VisualIndexType::BuildOptions build_options;
+  build_options.num_visual_words = 100;
+  build_options.branching = 10;
+  visual_index.Build(build_options, descriptors);
+
+  const int kNumImages = 8;
+  const int kNumFeatures = 100;
+  std::vector<typename VisualIndexType::GeomType> image_keypoints;
+  std::vector<typename VisualIndexType::DescType> image_descriptors;
+  typename VisualIndexType::IndexOptions index_options;
+  for (int image_id = 0; image_id < kNumImages; ++image_id) {
+    typename VisualIndexType::GeomType keypoints;
+    for (int i = 0; i < kNumFeatures; ++i) {
+      keypoints.emplace_back(RandomReal<float>(0, 1000),
+                             RandomReal<float>(0, 1000));
+    }
+    image_keypoints.push_back(keypoints);
+    image_descriptors.push_back(
+        VisualIndexType::DescType::Random(kNumFeatures, kDescDim));
+    visual_index.Add(index_options, image_id, image_keypoints.back(),
+                     image_descriptors.back());
+  }
+  visual_index.Prepare();
+
+  for (const int num_threads : {1, 3}) {
+    typename VisualIndexType::QueryOptions query_options;
+    query_options.num_threads = num_threads;
+    query_options.num_images_after_verification = 1;
+    std::vector<ImageScore> image_scores;
+    visual_index.Query(query_options, image_keypoints[2], image_descriptors[2],
+                       &image_scores);
+    BOOST_CHECK_EQUAL(image_scores.size(), 1);
+    BOOST_CHECK_EQUAL(image_scores[0].image_id, 2);
+    const float full_score = image_scores[0].score;
+    BOOST_CHECK_GT(full_score, 1);
+
+    // The query image is retrieved first, so early termination verifies it
+    // and yields the same score.
+    query_options.verification_min_num_inliers = 1;
+    visual_index.Query(query_options, image_keypoints[2], image_descriptors[2],
+                       &image_scores);
+    BOOST_CHECK_EQUAL(image_scores.size(), 1);
+    BOOST_CHECK_EQUAL(image_scores[0].image_id, 2);
+    BOOST_CHECK_EQUAL(image_scores[0].score, full_score);
+
+    // With a zero time budget, only the first batch is verified.
+    query_options.verification_min_num_inliers = 0;
+    query_options.max_verification_time = 0;
+    query_options.num_images_after_verification = kNumImages;
+    visual_index.Query(query_options, image_keypoints[2], image_descriptors[2],
+                       &image_scores);
+    BOOST_CHECK_EQUAL(image_scores.size(), kNumImages);
+    BOOST_CHECK_EQUAL(image_scores[0].image_id, 2);
+    BOOST_CHECK_EQUAL(image_scores[0].score, full_score);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestVocabTree) {
   TestVocabTreeType<uint8_t, 128, 64>();
   TestVocabTreeType<uint8_t, 64, 64>();
@@ -112,3 +468,27 @@ BOOST_AUTO_TEST_CASE(TestVocabTree) {
   TestVocabTreeType<float, 32, 16>();
   TestVocabTreeType<double, 32, 16>();
 }
+
+BOOST_AUTO_TEST_CASE(TestVocabTreeReadWrite) {
+  TestVocabTreeReadWriteType<uint8_t, 128, 64>();
+  TestVocabTreeReadWriteType<float, 32, 16>();
+}
+
+BOOST_AUTO_TEST_CASE(TestVocabTreeParallelQuery) {
+  TestVocabTreeParallelQueryType<uint8_t, 128, 64>();
+  TestVocabTreeParallelQueryType<float, 32, 16>();
+}
+
+BOOST_AUTO_TEST_CASE(TestVocabTreeBatchAdd) {
+  TestVocabTreeBatchAddType<uint8_t, 128, 64>();
+  TestVocabTreeBatchAddType<float, 32, 16>();
+}
+
+BOOST_AUTO_TEST_CASE(TestVocabTreeWordIds) {
+  TestVocabTreeWordIdsType<uint8_t, 128, 64>();
+  TestVocabTreeWordIdsType<float, 32, 16>();
+}
+
+BOOST_AUTO_TEST_CASE(TestVocabTreeVerification) {
+  TestVocabTreeVerificationType<uint8_t, 128, 64>();
+}
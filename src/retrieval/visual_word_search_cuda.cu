@@ -0,0 +1,269 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "retrieval/visual_word_search_cuda.h"
+
+#include <climits>
+#include <vector>
+
+#include "feature/descriptor_tile_cuda.h"
+#include "util/cuda.h"
+#include "util/cudacc.h"
+#include "util/gpu_scheduler.h"
+#include "util/logging.h"
+
+namespace colmap {
+namespace retrieval {
+namespace {
+
+using namespace internal;
+
+const int kMaxNumNeighbors = VisualWordSearchCUDA::kMaxNumNeighbors;
+
+// Insert a word into the nearest neighbors, which are sorted by increasing
+// distance and then by increasing word index.
+__device__ void InsertNeighbor(const int idx, const int dist,
+                               const int num_neighbors, int* dists,
+                               int* idxs) {
+  const int last = num_neighbors - 1;
+  if (dist > dists[last] || (dist == dists[last] && idx >= idxs[last])) {
+    return;
+  }
+  int i = last;
+  while (i > 0 &&
+         (dists[i - 1] > dist || (dists[i - 1] == dist && idxs[i - 1] > idx))) {
+    dists[i] = dists[i - 1];
+    idxs[i] = idxs[i - 1];
+    i -= 1;
+  }
+  dists[i] = dist;
+  idxs[i] = idx;
+}
+
+// Find the nearest words of each descriptor. Each block processes one tile of
+// descriptors and streams over all tiles of words. Since the squared norm of
+// the descriptor is the same for all words, the words are ranked by their
+// squared norm minus twice the dot product with the descriptor.
+__global__ void FindNearestWordsKernel(const uint8_t* descriptors,
+                                       const int num_descriptors,
+                                       const uint8_t* words,
+                                       const int* word_norms,
+                                       const int num_words,
+                                       const int num_neighbors,
+                                       int* word_ids) {
+  __shared__ __align__(128) uint4 descriptor_tile[kTileNumChunks * kTileSize];
+  __shared__ __align__(128) uint4 word_tile[kTileNumChunks * kTileSize];
+  __shared__ __align__(128) int dots[kTileSize * kTileDotsStride];
+  __shared__ int word_norm_tile[kTileSize];
+
+  static_assert(2 * kTileBlockSize * kMaxNumNeighbors <=
+                    kTileSize * kTileDotsStride,
+                "The neighbors must fit into the dot products");
+
+  const int tile_begin1 = blockIdx.x * kTileSize;
+  LoadDescriptorTile(descriptors, num_descriptors, tile_begin1,
+                     descriptor_tile);
+
+  const int row = threadIdx.x / kTileThreadsPerRow;
+  const int col_begin =
+      (threadIdx.x % kTileThreadsPerRow) * kTileColsPerThread;
+
+  int dists[kMaxNumNeighbors];
+  int idxs[kMaxNumNeighbors];
+  for (int n = 0; n < kMaxNumNeighbors; ++n) {
+    dists[n] = INT_MAX;
+    idxs[n] = -1;
+  }
+
+  for (int tile_begin2 = 0; tile_begin2 < num_words;
+       tile_begin2 += kTileSize) {
+    __syncthreads();
+    LoadDescriptorTile(words, num_words, tile_begin2, word_tile);
+    if (threadIdx.x < kTileSize) {
+      const int idx2 = tile_begin2 + threadIdx.x;
+      word_norm_tile[threadIdx.x] = idx2 < num_words ? word_norms[idx2] : 0;
+    }
+    __syncthreads();
+    ComputeTileDotProducts(descriptor_tile, word_tile, dots);
+    __syncthreads();
+    const int col_end =
+        min(col_begin + kTileColsPerThread, num_words - tile_begin2);
+    const int* row_dots = dots + row * kTileDotsStride;
+    for (int col = col_begin; col < col_end; ++col) {
+      InsertNeighbor(tile_begin2 + col, word_norm_tile[col] - 2 * row_dots[col],
+                     num_neighbors, dists, idxs);
+    }
+  }
+
+  // Merge the neighbors of the threads of the same row, where the memory of
+  // the dot products is reused.
+  __syncthreads();
+  int* thread_dists = dots;
+  int* thread_idxs = dots + kTileBlockSize * kMaxNumNeighbors;
+  for (int n = 0; n < num_neighbors; ++n) {
+    thread_dists[threadIdx.x * kMaxNumNeighbors + n] = dists[n];
+    thread_idxs[threadIdx.x * kMaxNumNeighbors + n] = idxs[n];
+  }
+  __syncthreads();
+
+  const int idx1 = tile_begin1 + row;
+  if (threadIdx.x % kTileThreadsPerRow != 0 || idx1 >= num_descriptors) {
+    return;
+  }
+
+  for (int i = 1; i < kTileThreadsPerRow; ++i) {
+    const int offset = (threadIdx.x + i) * kMaxNumNeighbors;
+    for (int n = 0; n < num_neighbors; ++n) {
+      if (thread_idxs[offset + n] == -1) {
+        break;
+      }
+      InsertNeighbor(thread_idxs[offset + n], thread_dists[offset + n],
+                     num_neighbors, dists, idxs);
+    }
+  }
+
+  for (int n = 0; n < num_neighbors; ++n) {
+    word_ids[idx1 * num_neighbors + n] = idxs[n];
+  }
+}
+
+template <typename T>
+void ReserveDeviceMemory(const size_t size, T** ptr, size_t* capacity) {
+  if (size <= *capacity) {
+    return;
+  }
+  if (*ptr != nullptr) {
+    CUDA_SAFE_CALL(cudaFree(*ptr));
+  }
+  CUDA_SAFE_CALL(cudaMalloc(ptr, size * sizeof(T)));
+  *capacity = size;
+}
+
+}  // namespace
+
+const int VisualWordSearchCUDA::kMaxNumNeighbors;
+
+VisualWordSearchCUDA::VisualWordSearchCUDA(const uint8_t* words,
+                                           const int num_words,
+                                           const int gpu_index)
+    : num_words_(num_words),
+      words_device_(nullptr),
+      word_norms_device_(nullptr),
+      descriptors_device_(nullptr),
+      descriptors_capacity_(0),
+      word_ids_device_(nullptr),
+      word_ids_capacity_(0) {
+  CHECK_NOTNULL(words);
+  CHECK_GT(num_words, 0);
+
+  SetBestCudaDevice(gpu_index);
+  CUDA_SAFE_CALL(cudaGetDevice(&gpu_index_));
+
+  std::vector<int> word_norms(num_words, 0);
+  for (int i = 0; i < num_words; ++i) {
+    for (int j = 0; j < kTileDescriptorDim; ++j) {
+      const int value = words[i * kTileDescriptorDim + j];
+      word_norms[i] += value * value;
+    }
+  }
+
+  const size_t num_word_bytes =
+      static_cast<size_t>(num_words) * kTileDescriptorDim;
+  CUDA_SAFE_CALL(cudaMalloc(&words_device_, num_word_bytes));
+  CUDA_SAFE_CALL(
+      cudaMalloc(&word_norms_device_, num_words * sizeof(int)));
+  CUDA_SAFE_CALL(cudaMemcpy(words_device_, words, num_word_bytes,
+                            cudaMemcpyHostToDevice));
+  CUDA_SAFE_CALL(cudaMemcpy(word_norms_device_, word_norms.data(),
+                            num_words * sizeof(int), cudaMemcpyHostToDevice));
+}
+
+VisualWordSearchCUDA::~VisualWordSearchCUDA() {
+  CUDA_SAFE_CALL(cudaSetDevice(gpu_index_));
+  CUDA_SAFE_CALL(cudaFree(words_device_));
+  CUDA_SAFE_CALL(cudaFree(word_norms_device_));
+  if (descriptors_device_ != nullptr) {
+    CUDA_SAFE_CALL(cudaFree(descriptors_device_));
+  }
+  if (word_ids_device_ != nullptr) {
+    CUDA_SAFE_CALL(cudaFree(word_ids_device_));
+  }
+}
+
+int VisualWordSearchCUDA::NumWords() const { return num_words_; }
+
+void VisualWordSearchCUDA::Search(const uint8_t* descriptors,
+                                  const int num_descriptors,
+                                  const int num_neighbors,
+                                  int* word_ids) const {
+  CHECK_GE(num_descriptors, 0);
+  CHECK_GT(num_neighbors, 0);
+  CHECK_LE(num_neighbors, kMaxNumNeighbors);
+
+  if (num_descriptors == 0) {
+    return;
+  }
+
+  CHECK_NOTNULL(descriptors);
+  CHECK_NOTNULL(word_ids);
+
+  const size_t num_descriptor_bytes =
+      static_cast<size_t>(num_descriptors) * kTileDescriptorDim;
+  const size_t num_word_ids =
+      static_cast<size_t>(num_descriptors) * num_neighbors;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  GpuScheduler::Lease gpu_lease = GpuScheduler::Get().Acquire(
+      std::to_string(gpu_index_),
+      num_descriptor_bytes + num_word_ids * sizeof(int));
+
+  CUDA_SAFE_CALL(cudaSetDevice(gpu_index_));
+
+  ReserveDeviceMemory(num_descriptor_bytes, &descriptors_device_,
+                      &descriptors_capacity_);
+  ReserveDeviceMemory(num_word_ids, &word_ids_device_, &word_ids_capacity_);
+
+  CUDA_SAFE_CALL(cudaMemcpy(descriptors_device_, descriptors,
+                            num_descriptor_bytes, cudaMemcpyHostToDevice));
+
+  FindNearestWordsKernel<<<(num_descriptors + kTileSize - 1) / kTileSize,
+                           kTileBlockSize>>>(
+      descriptors_device_, num_descriptors, words_device_, word_norms_device_,
+      num_words_, num_neighbors, word_ids_device_);
+  CUDA_SYNC_AND_CHECK();
+
+  CUDA_SAFE_CALL(cudaMemcpy(word_ids, word_ids_device_,
+                            num_word_ids * sizeof(int),
+                            cudaMemcpyDeviceToHost));
+}
+
+}  // namespace retrieval
+}  // namespace colmap
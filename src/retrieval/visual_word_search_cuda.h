@@ -0,0 +1,89 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_RETRIEVAL_VISUAL_WORD_SEARCH_CUDA_H_
+#define COLMAP_SRC_RETRIEVAL_VISUAL_WORD_SEARCH_CUDA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "util/types.h"
+
+namespace colmap {
+namespace retrieval {
+
+// Exact nearest visual word search for 128-dim 8-bit descriptors on a CUDA
+// device. The visual words are uploaded once and the squared Euclidean
+// distances to all words are computed from the dot products of a tiled 8-bit
+// integer matrix product on the tensor cores, see `ComputeTileDotProducts`.
+// The nearest words are selected in the same kernel, so that the distance
+// matrix is never stored. The descriptors of multiple images should be
+// searched in one batch to fully occupy the device.
+class VisualWordSearchCUDA {
+ public:
+  // The maximum number of nearest neighbor words per descriptor.
+  static const int kMaxNumNeighbors = 8;
+
+  // Upload the row-major visual words to the given device. If the index is
+  // -1, the best available device is used.
+  VisualWordSearchCUDA(const uint8_t* words, const int num_words,
+                       const int gpu_index);
+  ~VisualWordSearchCUDA();
+
+  int NumWords() const;
+
+  // Find the nearest visual words of the given row-major descriptors, sorted
+  // by increasing distance, where ties are resolved in favor of the smaller
+  // word index. The identifiers are written row-major to the output with
+  // `num_neighbors` per descriptor and are -1 if there are fewer words. This
+  // method is thread-safe, but concurrent searches are serialized.
+  void Search(const uint8_t* descriptors, const int num_descriptors,
+              const int num_neighbors, int* word_ids) const;
+
+ private:
+  NON_COPYABLE(VisualWordSearchCUDA)
+
+  int gpu_index_;
+  int num_words_;
+  uint8_t* words_device_;
+  int* word_norms_device_;
+
+  mutable std::mutex mutex_;
+  mutable uint8_t* descriptors_device_;
+  mutable size_t descriptors_capacity_;
+  mutable int* word_ids_device_;
+  mutable size_t word_ids_capacity_;
+};
+
+}  // namespace retrieval
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_RETRIEVAL_VISUAL_WORD_SEARCH_CUDA_H_
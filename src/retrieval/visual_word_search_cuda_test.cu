@@ -0,0 +1,109 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "retrieval/visual_word_search_cuda_test"
+#include "util/testing.h"
+
+#include <algorithm>
+
+#include "feature/types.h"
+#include "retrieval/visual_word_search_cuda.h"
+
+using namespace colmap;
+using namespace colmap::retrieval;
+
+// Exhaustive search of the nearest words, where ties are resolved in favor of
+// the smaller word index.
+std::vector<int> FindNearestWords(const FeatureDescriptors& words,
+                                  const FeatureDescriptors& descriptors,
+                                  const int num_neighbors) {
+  std::vector<int> word_ids(descriptors.rows() * num_neighbors, -1);
+  for (int i = 0; i < descriptors.rows(); ++i) {
+    std::vector<std::pair<int, int>> dists;
+    for (int j = 0; j < words.rows(); ++j) {
+      const int dist =
+          (descriptors.row(i).cast<int>() - words.row(j).cast<int>())
+              .squaredNorm();
+      dists.emplace_back(dist, j);
+    }
+    std::sort(dists.begin(), dists.end());
+    for (int n = 0; n < std::min<int>(num_neighbors, dists.size()); ++n) {
+      word_ids[i * num_neighbors + n] = dists[n].second;
+    }
+  }
+  return word_ids;
+}
+
+void TestVisualWordSearch(const int num_words, const int num_descriptors,
+                          const int num_neighbors) {
+  const FeatureDescriptors words =
+      FeatureDescriptors::Random(num_words, 128);
+  const FeatureDescriptors descriptors =
+      FeatureDescriptors::Random(num_descriptors, 128);
+
+  VisualWordSearchCUDA search(words.data(), num_words, -1);
+  BOOST_CHECK_EQUAL(search.NumWords(), num_words);
+
+  std::vector<int> word_ids(num_descriptors * num_neighbors);
+  search.Search(descriptors.data(), num_descriptors, num_neighbors,
+                word_ids.data());
+
+  const std::vector<int> expected_word_ids =
+      FindNearestWords(words, descriptors, num_neighbors);
+  BOOST_CHECK_EQUAL_COLLECTIONS(word_ids.begin(), word_ids.end(),
+                                expected_word_ids.begin(),
+                                expected_word_ids.end());
+}
+
+BOOST_AUTO_TEST_CASE(TestSearch) {
+  // The numbers of words and descriptors are not multiples of the tile size.
+  TestVisualWordSearch(1000, 300, 1);
+  TestVisualWordSearch(1000, 300, 5);
+  TestVisualWordSearch(1000, 300, VisualWordSearchCUDA::kMaxNumNeighbors);
+}
+
+BOOST_AUTO_TEST_CASE(TestSearchFewWords) {
+  TestVisualWordSearch(3, 100, 5);
+}
+
+BOOST_AUTO_TEST_CASE(TestSearchDuplicateWords) {
+  // Duplicate words have the same distance and are ranked by their index.
+  FeatureDescriptors words = FeatureDescriptors::Random(100, 128);
+  words.row(10) = words.row(50);
+  words.row(70) = words.row(50);
+  const FeatureDescriptors descriptors = words.middleRows(50, 1);
+
+  VisualWordSearchCUDA search(words.data(), words.rows(), -1);
+  std::vector<int> word_ids(3);
+  search.Search(descriptors.data(), 1, 3, word_ids.data());
+  BOOST_CHECK_EQUAL(word_ids[0], 10);
+  BOOST_CHECK_EQUAL(word_ids[1], 50);
+  BOOST_CHECK_EQUAL(word_ids[2], 70);
+}
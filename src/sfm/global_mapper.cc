@@ -0,0 +1,873 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "sfm/global_mapper.h"
+
+#include <map>
+#include <numeric>
+#include <queue>
+#include <set>
+
+#include <Eigen/Geometry>
+#include <Eigen/SparseCholesky>
+
+#include "estimators/two_view_geometry.h"
+#include "optim/least_absolute_deviations.h"
+#include "util/misc.h"
+#include "util/random.h"
+#include "util/threading.h"
+
+namespace colmap {
+namespace {
+
+Eigen::Matrix3d RotationFromAngleAxis(const Eigen::Vector3d& angle_axis) {
+  const double angle = angle_axis.norm();
+  if (angle < std::numeric_limits<double>::epsilon()) {
+    return Eigen::Matrix3d::Identity();
+  }
+  return Eigen::AngleAxisd(angle, angle_axis / angle).toRotationMatrix();
+}
+
+Eigen::Vector3d AngleAxisFromRotation(const Eigen::Matrix3d& rot_mat) {
+  const Eigen::AngleAxisd angle_axis(rot_mat);
+  return angle_axis.angle() * angle_axis.axis();
+}
+
+// The rotation between the averaged rotations of the two images and their
+// relative rotation, which is the identity for consistent rotations.
+Eigen::Matrix3d ComputeRelativeRotationError(const Eigen::Matrix3d& rot_mat1,
+                                             const Eigen::Matrix3d& rot_mat2,
+                                             const Eigen::Matrix3d& rot_mat12) {
+  return rot_mat12.transpose() * rot_mat2 * rot_mat1.transpose();
+}
+
+// The direction from the first to the second projection center in the world
+// frame, derived from the relative translation and the global rotation of the
+// first image.
+Eigen::Vector3d ComputeTranslationDirection(
+    const RelativeImagePose& relative_pose, const Eigen::Vector4d& qvec1) {
+  const Eigen::Matrix3d rot_mat1 = QuaternionToRotationMatrix(qvec1);
+  const Eigen::Matrix3d rot_mat12 =
+      QuaternionToRotationMatrix(relative_pose.qvec);
+  return -(rot_mat1.transpose() * rot_mat12.transpose() * relative_pose.tvec)
+              .normalized();
+}
+
+class ImageUnionFind {
+ public:
+  image_t Find(const image_t image_id) {
+    if (parents_.emplace(image_id, image_id).second) {
+      return image_id;
+    }
+
+    image_t root_image_id = image_id;
+    while (parents_.at(root_image_id) != root_image_id) {
+      root_image_id = parents_.at(root_image_id);
+    }
+
+    // Compress the path to the root.
+    image_t next_image_id = image_id;
+    while (next_image_id != root_image_id) {
+      image_t& parent_image_id = parents_.at(next_image_id);
+      next_image_id = parent_image_id;
+      parent_image_id = root_image_id;
+    }
+
+    return root_image_id;
+  }
+
+  // Returns false if the images are already in the same set.
+  bool Union(const image_t image_id1, const image_t image_id2) {
+    const image_t root_image_id1 = Find(image_id1);
+    const image_t root_image_id2 = Find(image_id2);
+    if (root_image_id1 == root_image_id2) {
+      return false;
+    }
+    parents_[std::max(root_image_id1, root_image_id2)] =
+        std::min(root_image_id1, root_image_id2);
+    return true;
+  }
+
+ private:
+  std::unordered_map<image_t, image_t> parents_;
+};
+
+// Find the sorted identifiers of the images in the largest connected component
+// of the graph with the given edges.
+std::vector<image_t> FindLargestConnectedComponent(
+    const std::vector<std::pair<image_t, image_t>>& edges) {
+  ImageUnionFind union_find;
+  for (const auto& edge : edges) {
+    union_find.Union(edge.first, edge.second);
+  }
+
+  std::set<image_t> image_ids;
+  for (const auto& edge : edges) {
+    image_ids.insert(edge.first);
+    image_ids.insert(edge.second);
+  }
+
+  std::map<image_t, std::vector<image_t>> components;
+  for (const auto image_id : image_ids) {
+    components[union_find.Find(image_id)].push_back(image_id);
+  }
+
+  std::vector<image_t> largest_component;
+  for (auto& component : components) {
+    if (component.second.size() > largest_component.size()) {
+      largest_component = std::move(component.second);
+    }
+  }
+
+  return largest_component;
+}
+
+// The graph of the largest connected component, where the image with the most
+// edges defines the gauge of the averaging problems.
+struct ViewGraph {
+  std::vector<image_t> image_ids;
+  std::unordered_map<image_t, int> image_idxs;
+  // The indices of the edges in the largest connected component.
+  std::vector<size_t> edge_idxs;
+  int root_image_idx = -1;
+  // The variable index of every image or -1 for the root image.
+  std::vector<int> var_idxs;
+
+  ViewGraph(const std::vector<std::pair<image_t, image_t>>& edges) {
+    image_ids = FindLargestConnectedComponent(edges);
+    for (size_t i = 0; i < image_ids.size(); ++i) {
+      image_idxs.emplace(image_ids[i], static_cast<int>(i));
+    }
+
+    std::vector<int> degrees(image_ids.size(), 0);
+    for (size_t i = 0; i < edges.size(); ++i) {
+      const auto image_idx1 = image_idxs.find(edges[i].first);
+      if (image_idx1 == image_idxs.end()) {
+        continue;
+      }
+      edge_idxs.push_back(i);
+      degrees[image_idx1->second] += 1;
+      degrees[image_idxs.at(edges[i].second)] += 1;
+    }
+
+    if (image_ids.empty()) {
+      return;
+    }
+
+    root_image_idx = static_cast<int>(
+        std::max_element(degrees.begin(), degrees.end()) - degrees.begin());
+
+    var_idxs.resize(image_ids.size(), -1);
+    int num_vars = 0;
+    for (size_t i = 0; i < image_ids.size(); ++i) {
+      if (static_cast<int>(i) != root_image_idx) {
+        var_idxs[i] = num_vars;
+        num_vars += 1;
+      }
+    }
+  }
+
+  size_t NumVariables() const { return 3 * (image_ids.size() - 1); }
+};
+
+}  // namespace
+
+bool RotationAveragingOptions::Check() const {
+  CHECK_OPTION_GE(max_num_l1_iterations, 0);
+  CHECK_OPTION_GE(max_num_irls_iterations, 0);
+  CHECK_OPTION_GE(l1_step_convergence_threshold, 0);
+  CHECK_OPTION_GE(irls_step_convergence_threshold, 0);
+  CHECK_OPTION_GT(irls_loss_parameter_sigma, 0);
+  return true;
+}
+
+bool AverageRotations(const RotationAveragingOptions& options,
+                      const std::vector<RelativeImagePose>& relative_poses,
+                      EIGEN_STL_UMAP(image_t, Eigen::Vector4d) * qvecs) {
+  CHECK(options.Check());
+  CHECK_NOTNULL(qvecs);
+
+  qvecs->clear();
+
+  std::vector<std::pair<image_t, image_t>> edges;
+  edges.reserve(relative_poses.size());
+  for (const auto& relative_pose : relative_poses) {
+    edges.emplace_back(relative_pose.image_id1, relative_pose.image_id2);
+  }
+
+  const ViewGraph view_graph(edges);
+  const size_t num_images = view_graph.image_ids.size();
+  const size_t num_edges = view_graph.edge_idxs.size();
+  if (num_images < 2) {
+    return false;
+  }
+
+  std::vector<int> image_idxs1(num_edges);
+  std::vector<int> image_idxs2(num_edges);
+  std::vector<Eigen::Matrix3d> relative_rotations(num_edges);
+  for (size_t i = 0; i < num_edges; ++i) {
+    const auto& relative_pose = relative_poses[view_graph.edge_idxs[i]];
+    image_idxs1[i] = view_graph.image_idxs.at(relative_pose.image_id1);
+    image_idxs2[i] = view_graph.image_idxs.at(relative_pose.image_id2);
+    relative_rotations[i] = QuaternionToRotationMatrix(relative_pose.qvec);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Initialize the rotations from the maximum spanning tree
+  //////////////////////////////////////////////////////////////////////////////
+
+  std::vector<size_t> sorted_edge_idxs(num_edges);
+  std::iota(sorted_edge_idxs.begin(), sorted_edge_idxs.end(), 0);
+  std::stable_sort(sorted_edge_idxs.begin(), sorted_edge_idxs.end(),
+                   [&](const size_t edge_idx1, const size_t edge_idx2) {
+                     return relative_poses[view_graph.edge_idxs[edge_idx1]]
+                                .weight >
+                            relative_poses[view_graph.edge_idxs[edge_idx2]]
+                                .weight;
+                   });
+
+  ImageUnionFind union_find;
+  std::vector<std::vector<size_t>> tree_edge_idxs(num_images);
+  for (const auto edge_idx : sorted_edge_idxs) {
+    if (union_find.Union(image_idxs1[edge_idx], image_idxs2[edge_idx])) {
+      tree_edge_idxs[image_idxs1[edge_idx]].push_back(edge_idx);
+      tree_edge_idxs[image_idxs2[edge_idx]].push_back(edge_idx);
+    }
+  }
+
+  std::vector<Eigen::Matrix3d> rotations(num_images,
+                                         Eigen::Matrix3d::Identity());
+  std::vector<bool> initialized(num_images, false);
+  std::queue<int> image_idx_queue;
+  image_idx_queue.push(view_graph.root_image_idx);
+  initialized[view_graph.root_image_idx] = true;
+  while (!image_idx_queue.empty()) {
+    const int image_idx = image_idx_queue.front();
+    image_idx_queue.pop();
+    for (const auto edge_idx : tree_edge_idxs[image_idx]) {
+      if (image_idxs1[edge_idx] == image_idx &&
+          !initialized[image_idxs2[edge_idx]]) {
+        rotations[image_idxs2[edge_idx]] =
+            relative_rotations[edge_idx] * rotations[image_idx];
+        initialized[image_idxs2[edge_idx]] = true;
+        image_idx_queue.push(image_idxs2[edge_idx]);
+      } else if (image_idxs2[edge_idx] == image_idx &&
+                 !initialized[image_idxs1[edge_idx]]) {
+        rotations[image_idxs1[edge_idx]] =
+            relative_rotations[edge_idx].transpose() * rotations[image_idx];
+        initialized[image_idxs1[edge_idx]] = true;
+        image_idx_queue.push(image_idxs1[edge_idx]);
+      }
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Set up the linearized problem
+  //////////////////////////////////////////////////////////////////////////////
+
+  // The rotations are updated as R_i <- exp([x_i]) R_i. To first order, the
+  // error rotation E_ij = R_ij^T R_j R_i^T of an image pair then changes as
+  // log(E_ij) + R_ij^T x_j - x_i, which is independent of the current
+  // rotations, such that the linear system is constant across iterations.
+
+  std::vector<Eigen::Triplet<double>> A_triplets;
+  A_triplets.reserve(num_edges * 12);
+  for (size_t i = 0; i < num_edges; ++i) {
+    const int var_idx1 = view_graph.var_idxs[image_idxs1[i]];
+    const int var_idx2 = view_graph.var_idxs[image_idxs2[i]];
+    for (int r = 0; r < 3; ++r) {
+      if (var_idx1 != -1) {
+        A_triplets.emplace_back(3 * i + r, 3 * var_idx1 + r, -1);
+      }
+      if (var_idx2 != -1) {
+        for (int c = 0; c < 3; ++c) {
+          A_triplets.emplace_back(3 * i + r, 3 * var_idx2 + c,
+                                  relative_rotations[i](c, r));
+        }
+      }
+    }
+  }
+
+  Eigen::SparseMatrix<double> A(3 * num_edges, view_graph.NumVariables());
+  A.setFromTriplets(A_triplets.begin(), A_triplets.end());
+
+  Eigen::VectorXd b(3 * num_edges);
+  auto ComputeErrors = [&]() {
+    for (size_t i = 0; i < num_edges; ++i) {
+      b.segment<3>(3 * i) = -AngleAxisFromRotation(ComputeRelativeRotationError(
+          rotations[image_idxs1[i]], rotations[image_idxs2[i]],
+          relative_rotations[i]));
+    }
+  };
+
+  // Returns the norm of the largest rotation update.
+  auto UpdateRotations = [&](const Eigen::VectorXd& x) {
+    double max_step = 0;
+    for (size_t i = 0; i < num_images; ++i) {
+      const int var_idx = view_graph.var_idxs[i];
+      if (var_idx != -1) {
+        const Eigen::Vector3d step = x.segment<3>(3 * var_idx);
+        rotations[i] = RotationFromAngleAxis(step) * rotations[i];
+        max_step = std::max(max_step, step.norm());
+      }
+    }
+    return max_step;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // L1 iterations
+  //////////////////////////////////////////////////////////////////////////////
+
+  LeastAbsoluteDeviationsOptions lad_options;
+  for (int iter = 0; iter < options.max_num_l1_iterations; ++iter) {
+    ComputeErrors();
+    Eigen::VectorXd x = Eigen::VectorXd::Zero(A.cols());
+    if (!SolveLeastAbsoluteDeviations(lad_options, A, b, &x)) {
+      break;
+    }
+    if (UpdateRotations(x) < options.l1_step_convergence_threshold) {
+      break;
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Iteratively re-weighted least squares iterations
+  //////////////////////////////////////////////////////////////////////////////
+
+  const double sigma = DegToRad(options.irls_loss_parameter_sigma);
+  const double sigma_squared = sigma * sigma;
+
+  Eigen::SimplicialLLT<Eigen::SparseMatrix<double>> linear_solver;
+  Eigen::VectorXd weights(3 * num_edges);
+  for (int iter = 0; iter < options.max_num_irls_iterations; ++iter) {
+    ComputeErrors();
+
+    // Geman-McClure weights, normalized to one for a zero residual.
+    for (size_t i = 0; i < num_edges; ++i) {
+      const double squared_residual = b.segment<3>(3 * i).squaredNorm();
+      const double weight = sigma_squared / (squared_residual + sigma_squared);
+      weights.segment<3>(3 * i).setConstant(weight * weight);
+    }
+
+    const Eigen::SparseMatrix<double> At_W =
+        A.transpose() * weights.asDiagonal();
+    const Eigen::SparseMatrix<double> At_W_A = At_W * A;
+    if (iter == 0) {
+      linear_solver.analyzePattern(At_W_A);
+    }
+    linear_solver.factorize(At_W_A);
+    if (linear_solver.info() != Eigen::Success) {
+      break;
+    }
+
+    const Eigen::VectorXd x = linear_solver.solve(At_W * b);
+    if (UpdateRotations(x) < options.irls_step_convergence_threshold) {
+      break;
+    }
+  }
+
+  qvecs->reserve(num_images);
+  for (size_t i = 0; i < num_images; ++i) {
+    qvecs->emplace(view_graph.image_ids[i],
+                   RotationMatrixToQuaternion(rotations[i]));
+  }
+
+  return true;
+}
+
+bool TranslationAveragingOptions::Check() const {
+  CHECK_OPTION_GT(max_num_iterations, 0);
+  CHECK_OPTION_GE(step_convergence_threshold, 0);
+  CHECK_OPTION_GT(irls_min_residual, 0);
+  return true;
+}
+
+bool AverageTranslations(
+    const TranslationAveragingOptions& options,
+    const std::vector<RelativeImagePose>& relative_poses,
+    const EIGEN_STL_UMAP(image_t, Eigen::Vector4d) & qvecs,
+    std::unordered_map<image_t, Eigen::Vector3d>* proj_centers) {
+  CHECK(options.Check());
+  CHECK_NOTNULL(proj_centers);
+
+  proj_centers->clear();
+
+  std::vector<std::pair<image_t, image_t>> edges;
+  std::vector<Eigen::Vector3d> directions;
+  for (const auto& relative_pose : relative_poses) {
+    const auto qvec1 = qvecs.find(relative_pose.image_id1);
+    if (qvec1 == qvecs.end() || qvecs.count(relative_pose.image_id2) == 0 ||
+        relative_pose.tvec.norm() < std::numeric_limits<double>::epsilon()) {
+      continue;
+    }
+    edges.emplace_back(relative_pose.image_id1, relative_pose.image_id2);
+    directions.push_back(
+        ComputeTranslationDirection(relative_pose, qvec1->second));
+  }
+
+  const ViewGraph view_graph(edges);
+  const size_t num_images = view_graph.image_ids.size();
+  const size_t num_edges = view_graph.edge_idxs.size();
+  if (num_images < 2) {
+    return false;
+  }
+
+  std::vector<int> var_idxs1(num_edges);
+  std::vector<int> var_idxs2(num_edges);
+  for (size_t i = 0; i < num_edges; ++i) {
+    const auto& edge = edges[view_graph.edge_idxs[i]];
+    var_idxs1[i] = view_graph.var_idxs[view_graph.image_idxs.at(edge.first)];
+    var_idxs2[i] = view_graph.var_idxs[view_graph.image_idxs.at(edge.second)];
+  }
+
+  auto GetProjectionCenter = [&](const Eigen::VectorXd& x, const int var_idx) {
+    if (var_idx == -1) {
+      return Eigen::Vector3d(Eigen::Vector3d::Zero());
+    }
+    return Eigen::Vector3d(x.segment<3>(3 * var_idx));
+  };
+
+  // For fixed projection centers, the optimal scale of an image pair is
+  // s_ij = max(1, v_ij^T (c_j - c_i)). Eliminating the scales, the residual is
+  // the component of the baseline orthogonal to the direction, if the scale is
+  // unconstrained, and c_j - c_i - v_ij otherwise. Both residuals are linear
+  // in the projection centers, which are estimated by iteratively re-weighted
+  // least squares for the L1 norm of the residuals.
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(view_graph.NumVariables());
+  Eigen::SimplicialLLT<Eigen::SparseMatrix<double>> linear_solver;
+  std::vector<Eigen::Triplet<double>> A_triplets;
+  A_triplets.reserve(num_edges * 18);
+  Eigen::VectorXd b(3 * num_edges);
+  for (int iter = 0; iter < options.max_num_iterations; ++iter) {
+    A_triplets.clear();
+    for (size_t i = 0; i < num_edges; ++i) {
+      const Eigen::Vector3d& direction = directions[view_graph.edge_idxs[i]];
+      const Eigen::Vector3d baseline = GetProjectionCenter(x, var_idxs2[i]) -
+                                       GetProjectionCenter(x, var_idxs1[i]);
+      const double scale = direction.dot(baseline);
+
+      Eigen::Matrix3d J;
+      Eigen::Vector3d rhs;
+      if (scale >= 1) {
+        J = Eigen::Matrix3d::Identity() - direction * direction.transpose();
+        rhs.setZero();
+      } else {
+        J.setIdentity();
+        rhs = direction;
+      }
+
+      const double residual = (J * baseline - rhs).norm();
+      const double sqrt_weight =
+          1 / std::sqrt(std::max(residual, options.irls_min_residual));
+
+      for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+          if (var_idxs1[i] != -1) {
+            A_triplets.emplace_back(3 * i + r, 3 * var_idxs1[i] + c,
+                                    -sqrt_weight * J(r, c));
+          }
+          if (var_idxs2[i] != -1) {
+            A_triplets.emplace_back(3 * i + r, 3 * var_idxs2[i] + c,
+                                    sqrt_weight * J(r, c));
+          }
+        }
+      }
+
+      b.segment<3>(3 * i) = sqrt_weight * rhs;
+    }
+
+    Eigen::SparseMatrix<double> A(3 * num_edges, view_graph.NumVariables());
+    A.setFromTriplets(A_triplets.begin(), A_triplets.end());
+
+    // Small damping for the case that no scale is constrained, in which case
+    // the problem is only determined up to scale.
+    Eigen::SparseMatrix<double> At_A = A.transpose() * A;
+    for (int i = 0; i < At_A.cols(); ++i) {
+      At_A.coeffRef(i, i) += 1e-8;
+    }
+
+    if (iter == 0) {
+      linear_solver.analyzePattern(At_A);
+    }
+    linear_solver.factorize(At_A);
+    if (linear_solver.info() != Eigen::Success) {
+      return false;
+    }
+
+    const Eigen::VectorXd x_prev = x;
+    x = linear_solver.solve(A.transpose() * b);
+
+    if ((x - x_prev).lpNorm<Eigen::Infinity>() <
+        options.step_convergence_threshold) {
+      break;
+    }
+  }
+
+  proj_centers->reserve(num_images);
+  for (size_t i = 0; i < num_images; ++i) {
+    proj_centers->emplace(view_graph.image_ids[i],
+                          GetProjectionCenter(x, view_graph.var_idxs[i]));
+  }
+
+  return true;
+}
+
+bool GlobalMapper::Options::Check() const {
+  CHECK_OPTION_GT(min_num_inliers, 0);
+  CHECK_OPTION_GT(max_error, 0);
+  CHECK_OPTION_GE(min_tri_angle, 0);
+  CHECK_OPTION_GE(max_rotation_error, 0);
+  CHECK_OPTION_GE(max_translation_error, 0);
+  CHECK_OPTION_GT(min_focal_length_ratio, 0);
+  CHECK_OPTION_GT(max_focal_length_ratio, 0);
+  CHECK_OPTION_GE(max_extra_param, 0);
+  CHECK_OPTION_GE(filter_max_reproj_error, 0);
+  CHECK_OPTION_GE(filter_min_tri_angle, 0);
+  CHECK_OPTION_GE(num_threads, -1);
+  CHECK_OPTION(rotation_averaging.Check());
+  CHECK_OPTION(translation_averaging.Check());
+  return true;
+}
+
+GlobalMapper::GlobalMapper(const DatabaseCache* database_cache)
+    : database_cache_(database_cache), reconstruction_(nullptr) {}
+
+void GlobalMapper::BeginReconstruction(Reconstruction* reconstruction) {
+  CHECK(reconstruction_ == nullptr);
+  reconstruction_ = reconstruction;
+  reconstruction_->Load(*database_cache_);
+  reconstruction_->SetUp(&database_cache_->CorrespondenceGraph());
+  triangulator_.reset(new IncrementalTriangulator(
+      &database_cache_->CorrespondenceGraph(), reconstruction));
+
+  relative_poses_.clear();
+  qvecs_.clear();
+  proj_centers_.clear();
+}
+
+void GlobalMapper::EndReconstruction(const bool discard) {
+  CHECK_NOTNULL(reconstruction_);
+
+  if (discard) {
+    const std::vector<image_t> reg_image_ids = reconstruction_->RegImageIds();
+    for (const image_t image_id : reg_image_ids) {
+      reconstruction_->DeRegisterImage(image_id);
+    }
+  }
+
+  reconstruction_->TearDown();
+  reconstruction_ = nullptr;
+  triangulator_.reset();
+}
+
+size_t GlobalMapper::EstimateRelativePoses(const Options& options) {
+  CHECK_NOTNULL(reconstruction_);
+  CHECK(options.Check());
+
+  const CorrespondenceGraph& correspondence_graph =
+      database_cache_->CorrespondenceGraph();
+
+  std::vector<image_pair_t> pair_ids;
+  for (const auto& num_correspondences :
+       correspondence_graph.NumCorrespondencesBetweenImages()) {
+    if (num_correspondences.second >=
+        static_cast<point2D_t>(options.min_num_inliers)) {
+      pair_ids.push_back(num_correspondences.first);
+    }
+  }
+
+  std::sort(pair_ids.begin(), pair_ids.end());
+
+  TwoViewGeometry::Options two_view_geometry_options;
+  two_view_geometry_options.min_num_inliers =
+      static_cast<size_t>(options.min_num_inliers);
+  two_view_geometry_options.ransac_options.max_error = options.max_error;
+
+  std::vector<RelativeImagePose> relative_poses(pair_ids.size());
+  std::vector<char> valid_relative_poses(pair_ids.size(), 0);
+
+  auto EstimateRelativePose = [&](const size_t idx) {
+    ScopedPRNGStream prng_stream(pair_ids[idx]);
+
+    image_t image_id1;
+    image_t image_id2;
+    Database::PairIdToImagePair(pair_ids[idx], &image_id1, &image_id2);
+
+    const Image& image1 = database_cache_->Image(image_id1);
+    const Camera& camera1 = database_cache_->Camera(image1.CameraId());
+    const Image& image2 = database_cache_->Image(image_id2);
+    const Camera& camera2 = database_cache_->Camera(image2.CameraId());
+
+    std::vector<Eigen::Vector2d> points1;
+    points1.reserve(image1.NumPoints2D());
+    for (const auto& point : image1.Points2D()) {
+      points1.push_back(point.XY());
+    }
+
+    std::vector<Eigen::Vector2d> points2;
+    points2.reserve(image2.NumPoints2D());
+    for (const auto& point : image2.Points2D()) {
+      points2.push_back(point.XY());
+    }
+
+    const FeatureMatches matches =
+        correspondence_graph.FindCorrespondencesBetweenImages(image_id1,
+                                                              image_id2);
+
+    TwoViewGeometry two_view_geometry;
+    two_view_geometry.EstimateCalibrated(camera1, points1, camera2, points2,
+                                         matches, two_view_geometry_options);
+    if (!two_view_geometry.EstimateRelativePose(camera1, points1, camera2,
+                                                points2) ||
+        two_view_geometry.inlier_matches.size() <
+            static_cast<size_t>(options.min_num_inliers)) {
+      return;
+    }
+
+    RelativeImagePose& relative_pose = relative_poses[idx];
+    relative_pose.image_id1 = image_id1;
+    relative_pose.image_id2 = image_id2;
+    relative_pose.qvec = two_view_geometry.qvec;
+    relative_pose.tvec = two_view_geometry.tvec;
+    relative_pose.weight = two_view_geometry.inlier_matches.size();
+    relative_pose.tri_angle = two_view_geometry.tri_angle;
+    valid_relative_poses[idx] = 1;
+  };
+
+  ThreadPool thread_pool(options.num_threads);
+  for (size_t i = 0; i < pair_ids.size(); ++i) {
+    thread_pool.AddTask(EstimateRelativePose, i);
+  }
+  thread_pool.Wait();
+
+  relative_poses_.clear();
+  for (size_t i = 0; i < relative_poses.size(); ++i) {
+    if (valid_relative_poses[i]) {
+      relative_poses_.push_back(relative_poses[i]);
+    }
+  }
+
+  return relative_poses_.size();
+}
+
+size_t GlobalMapper::EstimateRotations(const Options& options) {
+  CHECK(options.Check());
+
+  if (!AverageRotations(options.rotation_averaging, relative_poses_,
+                        &qvecs_)) {
+    return 0;
+  }
+
+  // Discard the image pairs that are inconsistent with the rotations, since
+  // they are most likely also outliers for translation averaging.
+  const double max_rotation_error = DegToRad(options.max_rotation_error);
+  std::vector<RelativeImagePose> inlier_relative_poses;
+  inlier_relative_poses.reserve(relative_poses_.size());
+  for (const auto& relative_pose : relative_poses_) {
+    const auto qvec1 = qvecs_.find(relative_pose.image_id1);
+    const auto qvec2 = qvecs_.find(relative_pose.image_id2);
+    if (qvec1 == qvecs_.end() || qvec2 == qvecs_.end()) {
+      continue;
+    }
+    const Eigen::AngleAxisd rotation_error(ComputeRelativeRotationError(
+        QuaternionToRotationMatrix(qvec1->second),
+        QuaternionToRotationMatrix(qvec2->second),
+        QuaternionToRotationMatrix(relative_pose.qvec)));
+    if (rotation_error.angle() <= max_rotation_error) {
+      inlier_relative_poses.push_back(relative_pose);
+    }
+  }
+
+  relative_poses_ = std::move(inlier_relative_poses);
+
+  return qvecs_.size();
+}
+
+size_t GlobalMapper::EstimatePositions(const Options& options) {
+  CHECK(options.Check());
+
+  // Only image pairs with sufficient baseline constrain the positions.
+  const double min_tri_angle = DegToRad(options.min_tri_angle);
+  std::vector<RelativeImagePose> relative_poses;
+  relative_poses.reserve(relative_poses_.size());
+  for (const auto& relative_pose : relative_poses_) {
+    if (relative_pose.tri_angle >= min_tri_angle) {
+      relative_poses.push_back(relative_pose);
+    }
+  }
+
+  if (!AverageTranslations(options.translation_averaging, relative_poses,
+                           qvecs_, &proj_centers_)) {
+    return 0;
+  }
+
+  // Discard the image pairs whose translation direction is inconsistent with
+  // the projection centers and re-estimate them without these outliers.
+  const double max_translation_error = DegToRad(options.max_translation_error);
+  std::vector<RelativeImagePose> inlier_relative_poses;
+  inlier_relative_poses.reserve(relative_poses.size());
+  for (const auto& relative_pose : relative_poses) {
+    const auto proj_center1 = proj_centers_.find(relative_pose.image_id1);
+    const auto proj_center2 = proj_centers_.find(relative_pose.image_id2);
+    if (proj_center1 == proj_centers_.end() ||
+        proj_center2 == proj_centers_.end()) {
+      continue;
+    }
+    const Eigen::Vector3d baseline =
+        proj_center2->second - proj_center1->second;
+    const Eigen::Vector3d direction = ComputeTranslationDirection(
+        relative_pose, qvecs_.at(relative_pose.image_id1));
+    const double cos_error = direction.dot(baseline.normalized());
+    if (std::acos(std::max(-1.0, std::min(1.0, cos_error))) <=
+        max_translation_error) {
+      inlier_relative_poses.push_back(relative_pose);
+    }
+  }
+
+  if (inlier_relative_poses.size() < relative_poses.size() &&
+      !AverageTranslations(options.translation_averaging,
+                           inlier_relative_poses, qvecs_, &proj_centers_)) {
+    return 0;
+  }
+
+  return proj_centers_.size();
+}
+
+size_t GlobalMapper::RegisterImages() {
+  CHECK_NOTNULL(reconstruction_);
+
+  // Register the images in a deterministic order, since the first registered
+  // images define the gauge of the bundle adjustment.
+  std::vector<image_t> image_ids;
+  image_ids.reserve(proj_centers_.size());
+  for (const auto& proj_center : proj_centers_) {
+    if (qvecs_.count(proj_center.first) > 0 &&
+        reconstruction_->ExistsImage(proj_center.first)) {
+      image_ids.push_back(proj_center.first);
+    }
+  }
+
+  std::sort(image_ids.begin(), image_ids.end());
+
+  for (const image_t image_id : image_ids) {
+    Image& image = reconstruction_->Image(image_id);
+    const Eigen::Vector4d& qvec = qvecs_.at(image_id);
+    image.SetQvec(qvec);
+    image.SetTvec(-QuaternionToRotationMatrix(qvec) *
+                  proj_centers_.at(image_id));
+    reconstruction_->RegisterImage(image_id);
+  }
+
+  return image_ids.size();
+}
+
+size_t GlobalMapper::TriangulateImages(
+    const IncrementalTriangulator::Options& tri_options) {
+  CHECK_NOTNULL(reconstruction_);
+
+  size_t num_tris = 0;
+  for (const image_t image_id : reconstruction_->RegImageIds()) {
+    num_tris += triangulator_->TriangulateImage(tri_options, image_id);
+  }
+
+  num_tris += triangulator_->CompleteAllTracks(tri_options);
+  num_tris += triangulator_->MergeAllTracks(tri_options);
+
+  return num_tris;
+}
+
+size_t GlobalMapper::Retriangulate(
+    const IncrementalTriangulator::Options& tri_options) {
+  CHECK_NOTNULL(reconstruction_);
+
+  size_t num_tris = triangulator_->Retriangulate(tri_options);
+  num_tris += triangulator_->CompleteAllTracks(tri_options);
+  num_tris += triangulator_->MergeAllTracks(tri_options);
+
+  return num_tris;
+}
+
+bool GlobalMapper::AdjustGlobalBundle(
+    const BundleAdjustmentOptions& ba_options) {
+  CHECK_NOTNULL(reconstruction_);
+
+  const std::vector<image_t>& reg_image_ids = reconstruction_->RegImageIds();
+
+  CHECK_GE(reg_image_ids.size(), 2)
+      << "At least two images must be registered for global bundle-adjustment";
+
+  // Avoid degeneracies in bundle adjustment.
+  reconstruction_->FilterObservationsWithNegativeDepth();
+
+  // Configure bundle adjustment.
+  BundleAdjustmentConfig ba_config;
+  for (const image_t image_id : reg_image_ids) {
+    ba_config.AddImage(image_id);
+  }
+
+  // Fix 7-DOFs of the bundle adjustment problem.
+  ba_config.SetConstantPose(reg_image_ids[0]);
+  ba_config.SetConstantTvec(reg_image_ids[1], {0});
+
+  // Run bundle adjustment.
+  BundleAdjuster bundle_adjuster(ba_options, ba_config);
+  if (!bundle_adjuster.Solve(reconstruction_)) {
+    return false;
+  }
+
+  // Normalize scene for numerical stability and
+  // to avoid large scale changes in viewer.
+  reconstruction_->Normalize();
+
+  return true;
+}
+
+size_t GlobalMapper::FilterImages(const Options& options) {
+  CHECK_NOTNULL(reconstruction_);
+  CHECK(options.Check());
+  return reconstruction_
+      ->FilterImages(options.min_focal_length_ratio,
+                     options.max_focal_length_ratio, options.max_extra_param)
+      .size();
+}
+
+size_t GlobalMapper::FilterPoints(const Options& options) {
+  CHECK_NOTNULL(reconstruction_);
+  CHECK(options.Check());
+  return reconstruction_->FilterAllPoints3D(options.filter_max_reproj_error,
+                                            options.filter_min_tri_angle,
+                                            options.num_threads);
+}
+
+const std::vector<RelativeImagePose>& GlobalMapper::RelativePoses() const {
+  return relative_poses_;
+}
+
+}  // namespace colmap
@@ -0,0 +1,254 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_SFM_GLOBAL_MAPPER_H_
+#define COLMAP_SRC_SFM_GLOBAL_MAPPER_H_
+
+#include <unordered_map>
+
+#include <Eigen/Core>
+
+#include "base/database_cache.h"
+#include "base/pose.h"
+#include "base/reconstruction.h"
+#include "optim/bundle_adjustment.h"
+#include "sfm/incremental_triangulator.h"
+#include "util/alignment.h"
+#include "util/types.h"
+
+namespace colmap {
+
+// Relative pose of an image pair, where the pose of the second image is given
+// in the camera frame of the first image, i.e. `x2 = R(qvec) * x1 + tvec`.
+struct RelativeImagePose {
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  image_t image_id1 = kInvalidImageId;
+  image_t image_id2 = kInvalidImageId;
+  Eigen::Vector4d qvec = ComposeIdentityQuaternion();
+  Eigen::Vector3d tvec = Eigen::Vector3d::Zero();
+
+  // The weight of the image pair, e.g., its number of inlier matches.
+  double weight = 1.0;
+
+  // The median triangulation angle of the inlier matches in radians.
+  double tri_angle = 0.0;
+};
+
+}  // namespace colmap
+
+EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION_CUSTOM(colmap::RelativeImagePose)
+
+namespace colmap {
+
+struct RotationAveragingOptions {
+  // The maximum number of L1 iterations, which robustly initialize the
+  // rotations from the maximum spanning tree of the view graph.
+  int max_num_l1_iterations = 5;
+
+  // The maximum number of iteratively re-weighted least squares iterations,
+  // which refine the L1 solution.
+  int max_num_irls_iterations = 100;
+
+  // The maximum rotation update in radians, below which the L1 and the
+  // re-weighted least squares iterations are considered converged.
+  double l1_step_convergence_threshold = 0.001;
+  double irls_step_convergence_threshold = 0.001;
+
+  // The scale parameter in degrees of the Geman-McClure loss function used to
+  // down-weight the relative rotations in the re-weighted least squares.
+  double irls_loss_parameter_sigma = 5.0;
+
+  bool Check() const;
+};
+
+// Estimate the global rotations of the images from their relative rotations
+// using the robust L1-IRLS method of "Efficient and Robust Large-Scale
+// Rotation Averaging" by Chatterjee and Govindu. Only the images in the
+// largest connected component of the view graph obtain a rotation. The
+// returned rotations are defined up to a global rotation.
+//
+// @param options          Rotation averaging options.
+// @param relative_poses   Relative poses of the image pairs.
+// @param qvecs            Estimated global rotations of the images.
+//
+// @return                 Whether at least two rotations were estimated.
+bool AverageRotations(const RotationAveragingOptions& options,
+                      const std::vector<RelativeImagePose>& relative_poses,
+                      EIGEN_STL_UMAP(image_t, Eigen::Vector4d) * qvecs);
+
+struct TranslationAveragingOptions {
+  // The maximum number of iteratively re-weighted least squares iterations.
+  int max_num_iterations = 100;
+
+  // The maximum change of the projection centers, below which the iterations
+  // are considered converged. The projection centers are scaled such that
+  // the shortest baselines have unit length.
+  double step_convergence_threshold = 1e-6;
+
+  // The minimum residual used to compute the weights of the iteratively
+  // re-weighted least squares, which avoids a division by zero.
+  double irls_min_residual = 1e-4;
+
+  bool Check() const;
+};
+
+// Estimate the projection centers of the images from the known global
+// rotations and the relative translation directions by solving
+//
+//    min sum_ij || c_j - c_i - s_ij * v_ij ||_2    s.t.    s_ij >= 1
+//
+// as proposed in "Robust Camera Location Estimation by Convex Programming" by
+// Ozyesil and Singer, where v_ij are the pairwise translation directions in
+// the world frame. Only the images in the largest
+// connected component of the view graph obtain a projection center. The
+// returned projection centers are defined up to a similarity transformation.
+//
+// @param options          Translation averaging options.
+// @param relative_poses   Relative poses of the image pairs, where pairs
+//                         without translation or without global rotations
+//                         are ignored.
+// @param qvecs            Global rotations of the images.
+// @param proj_centers     Estimated projection centers of the images.
+//
+// @return                 Whether at least two projection centers were
+//                         estimated.
+bool AverageTranslations(
+    const TranslationAveragingOptions& options,
+    const std::vector<RelativeImagePose>& relative_poses,
+    const EIGEN_STL_UMAP(image_t, Eigen::Vector4d) & qvecs,
+    std::unordered_map<image_t, Eigen::Vector3d>* proj_centers);
+
+// Global structure-from-motion, which first estimates the relative poses of
+// all verified image pairs, then estimates all image rotations and positions
+// jointly using rotation and translation averaging, and finally triangulates
+// and refines the scene structure. In contrast to the incremental mapper, the
+// number of bundle adjustments does not grow with the number of images.
+class GlobalMapper {
+ public:
+  struct Options {
+    // The minimum number of inlier matches of an image pair.
+    int min_num_inliers = 30;
+
+    // The maximum epipolar error in pixels to re-estimate relative poses.
+    double max_error = 4.0;
+
+    // The minimum triangulation angle in degrees of an image pair for its
+    // relative translation to constrain the image positions.
+    double min_tri_angle = 1.0;
+
+    // The maximum angular errors in degrees between the relative and the
+    // averaged rotations and translation directions of an image pair,
+    // otherwise the image pair is discarded as an outlier.
+    double max_rotation_error = 5.0;
+    double max_translation_error = 10.0;
+
+    // Thresholds for filtering images with degenerate intrinsics.
+    double min_focal_length_ratio = 0.1;
+    double max_focal_length_ratio = 10.0;
+    double max_extra_param = 1.0;
+
+    // Thresholds for filtering 3D points.
+    double filter_max_reproj_error = 4.0;
+    double filter_min_tri_angle = 1.5;
+
+    // Number of threads.
+    int num_threads = -1;
+
+    RotationAveragingOptions rotation_averaging;
+    TranslationAveragingOptions translation_averaging;
+
+    bool Check() const;
+  };
+
+  // Create global mapper. The database cache must live for the entire life-
+  // time of the global mapper.
+  explicit GlobalMapper(const DatabaseCache* database_cache);
+
+  // Prepare the mapper for a new reconstruction, which should be empty.
+  void BeginReconstruction(Reconstruction* reconstruction);
+
+  // Cleanup the mapper after the current reconstruction is done. If the
+  // model is discarded, all its images are de-registered.
+  void EndReconstruction(const bool discard);
+
+  // Estimate the relative poses of all image pairs with sufficient matches.
+  // Returns the number of valid relative poses.
+  size_t EstimateRelativePoses(const Options& options);
+
+  // Estimate the global rotations and discard the relative poses that are
+  // inconsistent with them. Returns the number of images with a rotation.
+  size_t EstimateRotations(const Options& options);
+
+  // Estimate the projection centers of the images with known rotations.
+  // Returns the number of images with a position.
+  size_t EstimatePositions(const Options& options);
+
+  // Register all images with an estimated rotation and position.
+  size_t RegisterImages();
+
+  // Triangulate the observations of all registered images and complete and
+  // merge the resulting tracks.
+  size_t TriangulateImages(const IncrementalTriangulator::Options& tri_options);
+
+  // Retriangulate image pairs that should have common observations but have
+  // none, and complete and merge the tracks of the resulting points.
+  size_t Retriangulate(const IncrementalTriangulator::Options& tri_options);
+
+  // Global bundle adjustment of all registered images and points.
+  bool AdjustGlobalBundle(const BundleAdjustmentOptions& ba_options);
+
+  // Filter images and point observations.
+  size_t FilterImages(const Options& options);
+  size_t FilterPoints(const Options& options);
+
+  const std::vector<RelativeImagePose>& RelativePoses() const;
+
+ private:
+  // Class that holds data of the reconstruction.
+  const DatabaseCache* database_cache_;
+
+  // Class that holds all necessary data of the reconstruction.
+  Reconstruction* reconstruction_;
+
+  // Class that is responsible for triangulation.
+  std::unique_ptr<IncrementalTriangulator> triangulator_;
+
+  // The relative poses of the image pairs that are used for averaging.
+  std::vector<RelativeImagePose> relative_poses_;
+
+  // The averaged rotations and projection centers of the images.
+  EIGEN_STL_UMAP(image_t, Eigen::Vector4d) qvecs_;
+  std::unordered_map<image_t, Eigen::Vector3d> proj_centers_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_SFM_GLOBAL_MAPPER_H_
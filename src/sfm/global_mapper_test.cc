@@ -0,0 +1,146 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "sfm/global_mapper"
+#include "util/testing.h"
+
+#include <Eigen/Geometry>
+
+#include "base/pose.h"
+#include "sfm/global_mapper.h"
+#include "util/math.h"
+
+using namespace colmap;
+
+void GenerateRelativePoses(const size_t num_images,
+                           std::vector<Eigen::Matrix3d>* rotations,
+                           std::vector<Eigen::Vector3d>* proj_centers,
+                           std::vector<RelativeImagePose>* relative_poses) {
+  for (size_t i = 0; i < num_images; ++i) {
+    const double angle = 2 * M_PI * i / num_images;
+    rotations->push_back(
+        (Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitY()) *
+         Eigen::AngleAxisd(0.1 * std::sin(3 * angle), Eigen::Vector3d::UnitX()))
+            .toRotationMatrix());
+    proj_centers->emplace_back(5 * std::sin(angle), std::cos(2 * angle),
+                               -5 * std::cos(angle));
+  }
+
+  for (size_t i = 0; i < num_images; ++i) {
+    for (size_t j = i + 1; j < num_images; ++j) {
+      RelativeImagePose relative_pose;
+      relative_pose.image_id1 = i + 1;
+      relative_pose.image_id2 = j + 1;
+      relative_pose.qvec = RotationMatrixToQuaternion(
+          (*rotations)[j] * (*rotations)[i].transpose());
+      relative_pose.tvec =
+          ((*rotations)[j] * ((*proj_centers)[i] - (*proj_centers)[j]))
+              .normalized();
+      relative_poses->push_back(relative_pose);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAverageRotationsAndTranslations) {
+  const size_t kNumImages = 20;
+  std::vector<Eigen::Matrix3d> rotations;
+  std::vector<Eigen::Vector3d> proj_centers;
+  std::vector<RelativeImagePose> relative_poses;
+  GenerateRelativePoses(kNumImages, &rotations, &proj_centers,
+                        &relative_poses);
+
+  // Corrupt a few relative rotations and translations.
+  for (size_t i = 0; i < relative_poses.size(); i += 17) {
+    relative_poses[i].qvec = ConcatenateQuaternions(
+        relative_poses[i].qvec,
+        RotationMatrixToQuaternion(
+            Eigen::AngleAxisd(DegToRad(30.0), Eigen::Vector3d::UnitZ())
+                .toRotationMatrix()));
+  }
+
+  for (size_t i = 5; i < relative_poses.size(); i += 23) {
+    relative_poses[i].tvec = -relative_poses[i].tvec;
+  }
+
+  // An image pair that is not connected to the remaining images.
+  RelativeImagePose disconnected_relative_pose;
+  disconnected_relative_pose.image_id1 = 100;
+  disconnected_relative_pose.image_id2 = 101;
+  disconnected_relative_pose.tvec = Eigen::Vector3d(1, 0, 0);
+  relative_poses.push_back(disconnected_relative_pose);
+
+  EIGEN_STL_UMAP(image_t, Eigen::Vector4d) qvecs;
+  BOOST_CHECK(
+      AverageRotations(RotationAveragingOptions(), relative_poses, &qvecs));
+  BOOST_CHECK_EQUAL(qvecs.size(), kNumImages);
+
+  for (size_t i = 0; i < kNumImages; ++i) {
+    for (size_t j = i + 1; j < kNumImages; ++j) {
+      const Eigen::Matrix3d relative_rotation =
+          QuaternionToRotationMatrix(qvecs.at(j + 1)) *
+          QuaternionToRotationMatrix(qvecs.at(i + 1)).transpose();
+      const Eigen::AngleAxisd rotation_error(
+          relative_rotation.transpose() * rotations[j] *
+          rotations[i].transpose());
+      BOOST_CHECK_LT(rotation_error.angle(), DegToRad(0.1));
+    }
+  }
+
+  std::unordered_map<image_t, Eigen::Vector3d> estimated_proj_centers;
+  BOOST_CHECK(AverageTranslations(TranslationAveragingOptions(),
+                                  relative_poses, qvecs,
+                                  &estimated_proj_centers));
+  BOOST_CHECK_EQUAL(estimated_proj_centers.size(), kNumImages);
+
+  // The projection centers are only defined up to a similarity, so compare
+  // the directions of the baselines, which are rotated by the global rotation.
+  const Eigen::Matrix3d global_rotation =
+      QuaternionToRotationMatrix(qvecs.at(1)).transpose() * rotations[0];
+  for (size_t i = 0; i < kNumImages; ++i) {
+    for (size_t j = i + 1; j < kNumImages; ++j) {
+      const Eigen::Vector3d baseline =
+          global_rotation *
+          (estimated_proj_centers.at(j + 1) - estimated_proj_centers.at(i + 1));
+      const Eigen::Vector3d expected_baseline = proj_centers[j] - proj_centers[i];
+      BOOST_CHECK_GT(baseline.normalized().dot(expected_baseline.normalized()),
+                     std::cos(DegToRad(1.0)));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAverageRotationsEmpty) {
+  EIGEN_STL_UMAP(image_t, Eigen::Vector4d) qvecs;
+  BOOST_CHECK(!AverageRotations(RotationAveragingOptions(), {}, &qvecs));
+  BOOST_CHECK(qvecs.empty());
+  std::unordered_map<image_t, Eigen::Vector3d> proj_centers;
+  BOOST_CHECK(!AverageTranslations(TranslationAveragingOptions(), {}, qvecs,
+                                   &proj_centers));
+  BOOST_CHECK(proj_centers.empty());
+}
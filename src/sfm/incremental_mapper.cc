@@ -34,31 +34,18 @@
 #include <array>
 #include <fstream>
 
+#include "base/pose.h"
 #include "base/projection.h"
 #include "base/triangulation.h"
 #include "estimators/pose.h"
 #include "util/bitmap.h"
 #include "util/misc.h"
+#include "util/random.h"
+#include "util/threading.h"
 
 namespace colmap {
 namespace {
 
-void SortAndAppendNextImages(std::vector<std::pair<image_t, float>> image_ranks,
-                             std::vector<image_t>* sorted_images_ids) {
-  std::sort(image_ranks.begin(), image_ranks.end(),
-            [](const std::pair<image_t, float>& image1,
-               const std::pair<image_t, float>& image2) {
-              return image1.second > image2.second;
-            });
-
-  sorted_images_ids->reserve(sorted_images_ids->size() + image_ranks.size());
-  for (const auto& image : image_ranks) {
-    sorted_images_ids->push_back(image.first);
-  }
-
-  image_ranks.clear();
-}
-
 float RankNextImageMaxVisiblePointsNum(const Image& image) {
   return static_cast<float>(image.NumVisiblePoints3D());
 }
@@ -72,6 +59,15 @@ float RankNextImageMinUncertainty(const Image& image) {
   return static_cast<float>(image.Point3DVisibilityScore());
 }
 
+bool CheckInitialTwoViewGeometry(const IncrementalMapper::Options& options,
+                                 const TwoViewGeometry& two_view_geometry) {
+  return static_cast<int>(two_view_geometry.inlier_matches.size()) >=
+             options.init_min_num_inliers &&
+         std::abs(two_view_geometry.tvec.z()) <
+             options.init_max_forward_motion &&
+         two_view_geometry.tri_angle > DegToRad(options.init_min_tri_angle);
+}
+
 }  // namespace
 
 bool IncrementalMapper::Options::Check() const {
@@ -81,10 +77,12 @@ bool IncrementalMapper::Options::Check() const {
   CHECK_OPTION_LE(init_max_forward_motion, 1.0);
   CHECK_OPTION_GE(init_min_tri_angle, 0.0);
   CHECK_OPTION_GE(init_max_reg_trials, 1);
+  CHECK_OPTION_GT(init_num_candidate_pairs, 0);
   CHECK_OPTION_GT(abs_pose_max_error, 0.0);
   CHECK_OPTION_GT(abs_pose_min_num_inliers, 0);
   CHECK_OPTION_GE(abs_pose_min_inlier_ratio, 0.0);
   CHECK_OPTION_LE(abs_pose_min_inlier_ratio, 1.0);
+  CHECK_OPTION_NE(abs_pose_ransac_num_threads, 0);
   CHECK_OPTION_GE(local_ba_num_images, 2);
   CHECK_OPTION_GE(local_ba_min_tri_angle, 0.0);
   CHECK_OPTION_GE(min_focal_length_ratio, 0.0);
@@ -100,9 +98,12 @@ IncrementalMapper::IncrementalMapper(const DatabaseCache* database_cache)
     : database_cache_(database_cache),
       reconstruction_(nullptr),
       triangulator_(nullptr),
+      local_bundle_adjuster_(nullptr),
+      global_bundle_adjuster_(nullptr),
       num_total_reg_images_(0),
       num_shared_reg_images_(0),
-      prev_init_image_pair_id_(kInvalidImagePairId) {}
+      init_two_view_max_error_(0),
+      init_image_ranking_valid_(false) {}
 
 void IncrementalMapper::BeginReconstruction(Reconstruction* reconstruction) {
   CHECK(reconstruction_ == nullptr);
@@ -122,11 +123,10 @@ void IncrementalMapper::BeginReconstruction(Reconstruction* reconstruction) {
       std::unordered_set<image_t>(reconstruction->RegImageIds().begin(),
                                   reconstruction->RegImageIds().end());
 
-  prev_init_image_pair_id_ = kInvalidImagePairId;
-  prev_init_two_view_geometry_ = TwoViewGeometry();
-
   filtered_images_.clear();
   num_reg_trials_.clear();
+
+  next_image_ranking_ = NextImageRanking();
 }
 
 void IncrementalMapper::EndReconstruction(const bool discard) {
@@ -141,6 +141,40 @@ void IncrementalMapper::EndReconstruction(const bool discard) {
   reconstruction_->TearDown();
   reconstruction_ = nullptr;
   triangulator_.reset();
+  local_bundle_adjuster_.reset();
+  global_bundle_adjuster_.reset();
+  camera_rigs_.clear();
+  image_to_snapshot_.clear();
+}
+
+void IncrementalMapper::LoadDatabaseCacheUpdate(
+    const std::vector<image_t>& new_image_ids,
+    const std::vector<image_pair_t>& new_image_pair_ids) {
+  CHECK_NOTNULL(reconstruction_);
+
+  reconstruction_->LoadUpdate(*database_cache_, new_image_ids,
+                              new_image_pair_ids);
+
+  for (const image_t image_id : new_image_ids) {
+    next_image_ranking_.modified_image_ids.insert(image_id);
+  }
+
+  // The number of correspondences of the images changed.
+  init_image_ranking_valid_ = false;
+
+  for (const image_pair_t pair_id : new_image_pair_ids) {
+    init_two_view_geometries_.erase(pair_id);
+    image_t image_id1;
+    image_t image_id2;
+    Database::PairIdToImagePair(pair_id, &image_id1, &image_id2);
+    for (const image_t image_id : {image_id1, image_id2}) {
+      if (!reconstruction_->IsImageRegistered(image_id)) {
+        num_reg_trials_.erase(image_id);
+      }
+      init_image_pair_rankings_.erase(image_id);
+      next_image_ranking_.modified_image_ids.insert(image_id);
+    }
+  }
 }
 
 bool IncrementalMapper::FindInitialImagePair(const Options& options,
@@ -166,18 +200,23 @@ bool IncrementalMapper::FindInitialImagePair(const Options& options,
     image_ids1 = FindFirstInitialImage(options);
   }
 
-  // Try to find good initial pair.
-  for (size_t i1 = 0; i1 < image_ids1.size(); ++i1) {
-    *image_id1 = image_ids1[i1];
+  const size_t num_candidate_pairs =
+      static_cast<size_t>(options.init_num_candidate_pairs);
+  ThreadPool thread_pool(
+      std::min(GetEffectiveNumThreads(options.num_threads),
+               static_cast<int>(num_candidate_pairs)));
 
+  // Try to find good initial pair, where the candidate pairs are evaluated in
+  // batches in the order of their ranking.
+  std::vector<std::pair<image_t, image_t>> candidate_pairs;
+  candidate_pairs.reserve(num_candidate_pairs);
+  for (size_t i1 = 0; i1 < image_ids1.size(); ++i1) {
     const std::vector<image_t> image_ids2 =
-        FindSecondInitialImage(options, *image_id1);
+        FindSecondInitialImage(options, image_ids1[i1]);
 
     for (size_t i2 = 0; i2 < image_ids2.size(); ++i2) {
-      *image_id2 = image_ids2[i2];
-
       const image_pair_t pair_id =
-          Database::ImagePairToPairId(*image_id1, *image_id2);
+          Database::ImagePairToPairId(image_ids1[i1], image_ids2[i2]);
 
       // Try every pair only once.
       if (init_image_pairs_.count(pair_id) > 0) {
@@ -186,12 +225,20 @@ bool IncrementalMapper::FindInitialImagePair(const Options& options,
 
       init_image_pairs_.insert(pair_id);
 
-      if (EstimateInitialTwoViewGeometry(options, *image_id1, *image_id2)) {
+      candidate_pairs.emplace_back(image_ids1[i1], image_ids2[i2]);
+      if (candidate_pairs.size() >= num_candidate_pairs &&
+          SelectInitialImagePair(options, &candidate_pairs, &thread_pool,
+                                 image_id1, image_id2)) {
         return true;
       }
     }
   }
 
+  if (SelectInitialImagePair(options, &candidate_pairs, &thread_pool,
+                             image_id1, image_id2)) {
+    return true;
+  }
+
   // No suitable pair found in entire dataset.
   *image_id1 = kInvalidImageId;
   *image_id2 = kInvalidImageId;
@@ -203,54 +250,40 @@ std::vector<image_t> IncrementalMapper::FindNextImages(const Options& options) {
   CHECK_NOTNULL(reconstruction_);
   CHECK(options.Check());
 
-  std::function<float(const Image&)> rank_image_func;
-  switch (options.image_selection_method) {
-    case Options::ImageSelectionMethod::MAX_VISIBLE_POINTS_NUM:
-      rank_image_func = RankNextImageMaxVisiblePointsNum;
-      break;
-    case Options::ImageSelectionMethod::MAX_VISIBLE_POINTS_RATIO:
-      rank_image_func = RankNextImageMaxVisiblePointsRatio;
-      break;
-    case Options::ImageSelectionMethod::MIN_UNCERTAINTY:
-      rank_image_func = RankNextImageMinUncertainty;
-      break;
-  }
-
-  std::vector<std::pair<image_t, float>> image_ranks;
-  std::vector<std::pair<image_t, float>> other_image_ranks;
-
-  // Append images that have not failed to register before.
-  for (const auto& image : reconstruction_->Images()) {
-    // Skip images that are already registered.
-    if (image.second.IsRegistered()) {
-      continue;
+  NextImageRanking& ranking = next_image_ranking_;
+
+  if (!ranking.valid ||
+      ranking.image_selection_method != options.image_selection_method ||
+      ranking.abs_pose_min_num_inliers != options.abs_pose_min_num_inliers ||
+      ranking.max_reg_trials != options.max_reg_trials) {
+    ranking = NextImageRanking();
+    ranking.valid = true;
+    ranking.image_selection_method = options.image_selection_method;
+    ranking.abs_pose_min_num_inliers = options.abs_pose_min_num_inliers;
+    ranking.max_reg_trials = options.max_reg_trials;
+    for (const auto& image : reconstruction_->Images()) {
+      UpdateNextImageRank(options, image.first);
     }
-
-    // Only consider images with a sufficient number of visible points.
-    if (image.second.NumVisiblePoints3D() <
-        static_cast<size_t>(options.abs_pose_min_num_inliers)) {
-      continue;
-    }
-
-    // Only try registration for a certain maximum number of times.
-    const size_t num_reg_trials = num_reg_trials_[image.first];
-    if (num_reg_trials >= static_cast<size_t>(options.max_reg_trials)) {
-      continue;
+  } else {
+    for (const image_t image_id :
+         reconstruction_->GetModifiedVisibilityImages()) {
+      UpdateNextImageRank(options, image_id);
     }
-
-    // If image has been filtered or failed to register, place it in the
-    // second bucket and prefer images that have not been tried before.
-    const float rank = rank_image_func(image.second);
-    if (filtered_images_.count(image.first) == 0 && num_reg_trials == 0) {
-      image_ranks.emplace_back(image.first, rank);
-    } else {
-      other_image_ranks.emplace_back(image.first, rank);
+    for (const image_t image_id : ranking.modified_image_ids) {
+      UpdateNextImageRank(options, image_id);
     }
   }
 
+  reconstruction_->ClearModifiedVisibilityImages();
+  ranking.modified_image_ids.clear();
+
   std::vector<image_t> ranked_images_ids;
-  SortAndAppendNextImages(image_ranks, &ranked_images_ids);
-  SortAndAppendNextImages(other_image_ranks, &ranked_images_ids);
+  ranked_images_ids.reserve(ranking.entries.size());
+  for (const auto& bucket : ranking.buckets) {
+    for (const auto& image_rank : bucket) {
+      ranked_images_ids.push_back(image_rank.second);
+    }
+  }
 
   return ranked_images_ids;
 }
@@ -267,6 +300,8 @@ bool IncrementalMapper::RegisterInitialImagePair(const Options& options,
   init_num_reg_trials_[image_id2] += 1;
   num_reg_trials_[image_id1] += 1;
   num_reg_trials_[image_id2] += 1;
+  next_image_ranking_.modified_image_ids.insert(image_id1);
+  next_image_ranking_.modified_image_ids.insert(image_id2);
 
   const image_pair_t pair_id =
       Database::ImagePairToPairId(image_id1, image_id2);
@@ -288,8 +323,10 @@ bool IncrementalMapper::RegisterInitialImagePair(const Options& options,
 
   image1.Qvec() = ComposeIdentityQuaternion();
   image1.Tvec() = Eigen::Vector3d(0, 0, 0);
-  image2.Qvec() = prev_init_two_view_geometry_.qvec;
-  image2.Tvec() = prev_init_two_view_geometry_.tvec;
+  const TwoViewGeometry& two_view_geometry =
+      init_two_view_geometries_.at(pair_id);
+  image2.Qvec() = two_view_geometry.qvec;
+  image2.Tvec() = two_view_geometry.tvec;
 
   const Eigen::Matrix3x4d proj_matrix1 = image1.ProjectionMatrix();
   const Eigen::Matrix3x4d proj_matrix2 = image2.ProjectionMatrix();
@@ -348,28 +385,297 @@ bool IncrementalMapper::RegisterNextImage(const Options& options,
 
   CHECK(options.Check());
 
-  Image& image = reconstruction_->Image(image_id);
-  Camera& camera = reconstruction_->Camera(image.CameraId());
+  const Image& image = reconstruction_->Image(image_id);
 
   CHECK(!image.IsRegistered()) << "Image cannot be registered multiple times";
 
   num_reg_trials_[image_id] += 1;
+  next_image_ranking_.modified_image_ids.insert(image_id);
 
-  // Check if enough 2D-3D correspondences.
-  if (image.NumVisiblePoints3D() <
-      static_cast<size_t>(options.abs_pose_min_num_inliers)) {
+  NextImagePose pose;
+  if (!EstimateNextImagePose(options, image_id, &pose)) {
+    if (pose.reset_camera_params) {
+      reconstruction_->Camera(image.CameraId())
+          .SetParams(database_cache_->Camera(image.CameraId()).Params());
+    }
     return false;
   }
 
+  CommitNextImagePose(image_id, pose);
+
+  return true;
+}
+
+std::vector<image_t> IncrementalMapper::RegisterNextImages(
+    const Options& options, const std::vector<image_t>& image_ids) {
+  CHECK_NOTNULL(reconstruction_);
+  CHECK_GE(reconstruction_->NumRegImages(), 2);
+
+  CHECK(options.Check());
+
+  std::unordered_set<image_t> unique_image_ids;
+  for (const image_t image_id : image_ids) {
+    CHECK(!reconstruction_->Image(image_id).IsRegistered())
+        << "Image cannot be registered multiple times";
+    CHECK(unique_image_ids.insert(image_id).second)
+        << "Image cannot be registered multiple times";
+  }
+
   //////////////////////////////////////////////////////////////////////////////
-  // Search for 2D-3D correspondences
+  // Estimate poses against the current model
   //////////////////////////////////////////////////////////////////////////////
 
-  const int kCorrTransitivity = 1;
+  // Parallelize over the images instead of within the individual estimations.
+  Options estimation_options = options;
+  estimation_options.num_threads = 1;
+  estimation_options.abs_pose_ransac_num_threads = 1;
+
+  std::vector<NextImagePose, Eigen::aligned_allocator<NextImagePose>> poses(
+      image_ids.size());
+  std::vector<char> success(image_ids.size(), 0);
+
+  const int num_threads =
+      std::min(GetEffectiveNumThreads(options.num_threads),
+               static_cast<int>(std::max<size_t>(image_ids.size(), 1)));
+  ThreadPool thread_pool(num_threads);
+  for (size_t i = 0; i < image_ids.size(); ++i) {
+    thread_pool.AddTask([&, i]() {
+      ScopedPRNGStream prng_stream(image_ids[i]);
+      success[i] =
+          EstimateNextImagePose(estimation_options, image_ids[i], &poses[i]);
+    });
+  }
+  thread_pool.Wait();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Commit consistent poses
+  //////////////////////////////////////////////////////////////////////////////
+
+  std::vector<image_t> reg_image_ids;
+  std::unordered_set<camera_t> modified_camera_ids;
+
+  for (size_t i = 0; i < image_ids.size(); ++i) {
+    const image_t image_id = image_ids[i];
+    const camera_t camera_id = reconstruction_->Image(image_id).CameraId();
+
+    // The pose was estimated with intrinsics that changed in the meantime.
+    // Do not count this as a registration trial, so that the image is
+    // attempted again in a later call.
+    if (modified_camera_ids.count(camera_id) > 0) {
+      continue;
+    }
+
+    num_reg_trials_[image_id] += 1;
+    next_image_ranking_.modified_image_ids.insert(image_id);
+
+    if (!success[i]) {
+      if (poses[i].reset_camera_params) {
+        reconstruction_->Camera(camera_id).SetParams(
+            database_cache_->Camera(camera_id).Params());
+      }
+      continue;
+    }
+
+    CommitNextImagePose(image_id, poses[i]);
+    reg_image_ids.push_back(image_id);
+
+    if (poses[i].modified_camera_params) {
+      modified_camera_ids.insert(camera_id);
+    }
+  }
+
+  return reg_image_ids;
+}
+
+void IncrementalMapper::SetCameraRigs(
+    const std::vector<CameraRig>& camera_rigs) {
+  CHECK_NOTNULL(reconstruction_);
+
+  camera_rigs_ = camera_rigs;
+  image_to_snapshot_.clear();
+  for (size_t rig_idx = 0; rig_idx < camera_rigs_.size(); ++rig_idx) {
+    const CameraRig& camera_rig = camera_rigs_[rig_idx];
+    camera_rig.Check(*reconstruction_);
+    for (size_t snapshot_idx = 0; snapshot_idx < camera_rig.NumSnapshots();
+         ++snapshot_idx) {
+      for (const image_t image_id : camera_rig.Snapshots()[snapshot_idx]) {
+        CHECK_EQ(image_to_snapshot_.count(image_id), 0)
+            << "Image must not be part of multiple camera rigs";
+        image_to_snapshot_.emplace(image_id,
+                                   std::make_pair(rig_idx, snapshot_idx));
+      }
+    }
+  }
+}
+
+std::vector<image_t> IncrementalMapper::RegisterNextSnapshot(
+    const Options& options, const image_t image_id) {
+  CHECK_NOTNULL(reconstruction_);
+  CHECK_GE(reconstruction_->NumRegImages(), 2);
+
+  CHECK(options.Check());
+
+  const auto snapshot_it = image_to_snapshot_.find(image_id);
+  if (snapshot_it == image_to_snapshot_.end()) {
+    return {};
+  }
+
+  CameraRig& camera_rig = camera_rigs_[snapshot_it->second.first];
+  const std::vector<image_t>& snapshot =
+      camera_rig.Snapshots()[snapshot_it->second.second];
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Estimate relative poses of the rig cameras
+  //////////////////////////////////////////////////////////////////////////////
+
+  // Only the completely registered snapshots define the relative poses, since
+  // the reference image must be registered in every snapshot.
+  CameraRig registered_camera_rig;
+  for (const camera_t camera_id : camera_rig.GetCameraIds()) {
+    registered_camera_rig.AddCamera(camera_id, ComposeIdentityQuaternion(),
+                                    Eigen::Vector3d(0, 0, 0));
+  }
+  registered_camera_rig.SetRefCameraId(camera_rig.RefCameraId());
+
+  std::unordered_set<camera_t> registered_camera_ids;
+  for (const auto& other_snapshot : camera_rig.Snapshots()) {
+    bool is_registered = true;
+    for (const image_t other_image_id : other_snapshot) {
+      if (!reconstruction_->IsImageRegistered(other_image_id)) {
+        is_registered = false;
+        break;
+      }
+    }
+    if (is_registered) {
+      registered_camera_rig.AddSnapshot(other_snapshot);
+      for (const image_t other_image_id : other_snapshot) {
+        registered_camera_ids.insert(
+            reconstruction_->Image(other_image_id).CameraId());
+      }
+    }
+  }
+
+  if (registered_camera_ids.size() < camera_rig.NumCameras()) {
+    return {};
+  }
+
+  registered_camera_rig.ComputeRelativePoses(*reconstruction_);
+  for (const camera_t camera_id : camera_rig.GetCameraIds()) {
+    camera_rig.RelativeQvec(camera_id) =
+        registered_camera_rig.RelativeQvec(camera_id);
+    camera_rig.RelativeTvec(camera_id) =
+        registered_camera_rig.RelativeTvec(camera_id);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Search for 2D-3D correspondences of all unregistered snapshot images
+  //////////////////////////////////////////////////////////////////////////////
 
-  std::vector<std::pair<point2D_t, point3D_t>> tri_corrs;
+  std::vector<image_t> snapshot_image_ids;
+  std::vector<NextImagePose> poses;
+  std::vector<Camera> cameras;
+  std::vector<Eigen::Vector4d> rel_qvecs;
+  std::vector<Eigen::Vector3d> rel_tvecs;
   std::vector<Eigen::Vector2d> tri_points2D;
   std::vector<Eigen::Vector3d> tri_points3D;
+  std::vector<size_t> tri_camera_idxs;
+  for (const image_t snapshot_image_id : snapshot) {
+    const Image& image = reconstruction_->Image(snapshot_image_id);
+    if (image.IsRegistered()) {
+      continue;
+    }
+
+    num_reg_trials_[snapshot_image_id] += 1;
+    next_image_ranking_.modified_image_ids.insert(snapshot_image_id);
+
+    const size_t camera_idx = snapshot_image_ids.size();
+    snapshot_image_ids.push_back(snapshot_image_id);
+    poses.emplace_back();
+    poses.back().camera = reconstruction_->Camera(image.CameraId());
+    cameras.push_back(poses.back().camera);
+    rel_qvecs.push_back(camera_rig.RelativeQvec(image.CameraId()));
+    rel_tvecs.push_back(camera_rig.RelativeTvec(image.CameraId()));
+
+    const size_t num_tri_points = tri_points2D.size();
+    FindNextImageCorrespondences(options, snapshot_image_id,
+                                 &poses.back().tri_corrs, &tri_points2D,
+                                 &tri_points3D);
+    tri_camera_idxs.resize(tri_points2D.size(), camera_idx);
+    CHECK_EQ(poses.back().tri_corrs.size(),
+             tri_points2D.size() - num_tri_points);
+  }
+
+  if (tri_points2D.size() <
+      static_cast<size_t>(options.abs_pose_min_num_inliers)) {
+    return {};
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Generalized 2D-3D estimation
+  //////////////////////////////////////////////////////////////////////////////
+
+  RANSACOptions ransac_options;
+  ransac_options.max_error = options.abs_pose_max_error;
+  ransac_options.min_inlier_ratio = options.abs_pose_min_inlier_ratio;
+  // Use high confidence to avoid preemptive termination of GP3P RANSAC
+  // - too early termination may lead to bad registration.
+  ransac_options.min_num_trials = 100;
+  ransac_options.max_num_trials = 10000;
+  ransac_options.confidence = 0.99999;
+  ransac_options.num_threads = options.abs_pose_ransac_num_threads;
+
+  Eigen::Vector4d rig_qvec;
+  Eigen::Vector3d rig_tvec;
+  size_t num_inliers;
+  std::vector<char> inlier_mask;
+  if (!EstimateGeneralizedAbsolutePose(
+          ransac_options, tri_points2D, tri_points3D, tri_camera_idxs,
+          rel_qvecs, rel_tvecs, cameras, &rig_qvec, &rig_tvec, &num_inliers,
+          &inlier_mask)) {
+    return {};
+  }
+
+  if (num_inliers < static_cast<size_t>(options.abs_pose_min_num_inliers)) {
+    return {};
+  }
+
+  AbsolutePoseRefinementOptions abs_pose_refinement_options;
+  if (!RefineGeneralizedAbsolutePose(
+          abs_pose_refinement_options, inlier_mask, tri_points2D,
+          tri_points3D, tri_camera_idxs, rel_qvecs, rel_tvecs, cameras,
+          &rig_qvec, &rig_tvec)) {
+    return {};
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Register the snapshot images
+  //////////////////////////////////////////////////////////////////////////////
+
+  // Images without any inlier correspondences are registered as well, since
+  // their pose is determined by the rig and they gain observations through
+  // the subsequent triangulation.
+  for (size_t i = 0; i < tri_camera_idxs.size(); ++i) {
+    poses[tri_camera_idxs[i]].inlier_mask.push_back(inlier_mask[i]);
+  }
+
+  for (size_t i = 0; i < snapshot_image_ids.size(); ++i) {
+    NextImagePose& pose = poses[i];
+    ConcatenatePoses(rig_qvec, rig_tvec, rel_qvecs[i], rel_tvecs[i],
+                     &pose.qvec, &pose.tvec);
+    CommitNextImagePose(snapshot_image_ids[i], pose);
+  }
+
+  return snapshot_image_ids;
+}
+
+void IncrementalMapper::FindNextImageCorrespondences(
+    const Options& options, const image_t image_id,
+    std::vector<std::pair<point2D_t, point3D_t>>* tri_corrs,
+    std::vector<Eigen::Vector2d>* tri_points2D,
+    std::vector<Eigen::Vector3d>* tri_points3D) const {
+  const Image& image = reconstruction_->Image(image_id);
+
+  const int kCorrTransitivity = 1;
 
   for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
        ++point2D_idx) {
@@ -411,13 +717,40 @@ bool IncrementalMapper::RegisterNextImage(const Options& options,
       const Point3D& point3D =
           reconstruction_->Point3D(corr_point2D.Point3DId());
 
-      tri_corrs.emplace_back(point2D_idx, corr_point2D.Point3DId());
+      tri_corrs->emplace_back(point2D_idx, corr_point2D.Point3DId());
       point3D_ids.insert(corr_point2D.Point3DId());
-      tri_points2D.push_back(point2D.XY());
-      tri_points3D.push_back(point3D.XYZ());
+      tri_points2D->push_back(point2D.XY());
+      tri_points3D->push_back(point3D.XYZ());
     }
   }
 
+}
+
+bool IncrementalMapper::EstimateNextImagePose(const Options& options,
+                                              const image_t image_id,
+                                              NextImagePose* pose) const {
+  const Image& image = reconstruction_->Image(image_id);
+
+  pose->qvec = image.Qvec();
+  pose->tvec = image.Tvec();
+  pose->camera = reconstruction_->Camera(image.CameraId());
+  Camera& camera = pose->camera;
+
+  // Check if enough 2D-3D correspondences.
+  if (image.NumVisiblePoints3D() <
+      static_cast<size_t>(options.abs_pose_min_num_inliers)) {
+    return false;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Search for 2D-3D correspondences
+  //////////////////////////////////////////////////////////////////////////////
+
+  std::vector<Eigen::Vector2d> tri_points2D;
+  std::vector<Eigen::Vector3d> tri_points3D;
+  FindNextImageCorrespondences(options, image_id, &pose->tri_corrs,
+                               &tri_points2D, &tri_points3D);
+
   // The size of `next_image.num_tri_obs` and `tri_corrs_point2D_idxs.size()`
   // can only differ, when there are images with bogus camera parameters, and
   // hence we skip some of the 2D-3D correspondences.
@@ -437,6 +770,7 @@ bool IncrementalMapper::RegisterNextImage(const Options& options,
 
   AbsolutePoseEstimationOptions abs_pose_options;
   abs_pose_options.num_threads = options.num_threads;
+  abs_pose_options.use_gpu = options.abs_pose_use_gpu;
   abs_pose_options.num_focal_length_samples = 30;
   abs_pose_options.min_focal_length_ratio = options.min_focal_length_ratio;
   abs_pose_options.max_focal_length_ratio = options.max_focal_length_ratio;
@@ -448,9 +782,15 @@ bool IncrementalMapper::RegisterNextImage(const Options& options,
   abs_pose_options.ransac_options.min_num_trials = 100;
   abs_pose_options.ransac_options.max_num_trials = 10000;
   abs_pose_options.ransac_options.confidence = 0.99999;
+  abs_pose_options.ransac_options.num_threads =
+      options.abs_pose_ransac_num_threads;
+
+  const auto num_reg_images_it =
+      num_reg_images_per_camera_.find(image.CameraId());
 
   AbsolutePoseRefinementOptions abs_pose_refinement_options;
-  if (num_reg_images_per_camera_[image.CameraId()] > 0) {
+  if (num_reg_images_it != num_reg_images_per_camera_.end() &&
+      num_reg_images_it->second > 0) {
     // Camera already refined from another image with the same camera.
     if (camera.HasBogusParams(options.min_focal_length_ratio,
                               options.max_focal_length_ratio,
@@ -458,6 +798,7 @@ bool IncrementalMapper::RegisterNextImage(const Options& options,
       // Previously refined camera has bogus parameters,
       // so reset parameters and try to re-refine.
       camera.SetParams(database_cache_->Camera(image.CameraId()).Params());
+      pose->reset_camera_params = true;
       abs_pose_options.estimate_focal_length = !camera.HasPriorFocalLength();
       abs_pose_refinement_options.refine_focal_length = true;
       abs_pose_refinement_options.refine_extra_params = true;
@@ -482,11 +823,16 @@ bool IncrementalMapper::RegisterNextImage(const Options& options,
     abs_pose_refinement_options.refine_extra_params = false;
   }
 
+  pose->modified_camera_params =
+      pose->reset_camera_params || abs_pose_options.estimate_focal_length ||
+      abs_pose_refinement_options.refine_focal_length ||
+      abs_pose_refinement_options.refine_extra_params;
+
   size_t num_inliers;
-  std::vector<char> inlier_mask;
+  std::vector<char>& inlier_mask = pose->inlier_mask;
 
   if (!EstimateAbsolutePose(abs_pose_options, tri_points2D, tri_points3D,
-                            &image.Qvec(), &image.Tvec(), &camera, &num_inliers,
+                            &pose->qvec, &pose->tvec, &camera, &num_inliers,
                             &inlier_mask)) {
     return false;
   }
@@ -500,11 +846,21 @@ bool IncrementalMapper::RegisterNextImage(const Options& options,
   //////////////////////////////////////////////////////////////////////////////
 
   if (!RefineAbsolutePose(abs_pose_refinement_options, inlier_mask,
-                          tri_points2D, tri_points3D, &image.Qvec(),
-                          &image.Tvec(), &camera)) {
+                          tri_points2D, tri_points3D, &pose->qvec, &pose->tvec,
+                          &camera)) {
     return false;
   }
 
+  return true;
+}
+
+void IncrementalMapper::CommitNextImagePose(const image_t image_id,
+                                            const NextImagePose& pose) {
+  Image& image = reconstruction_->Image(image_id);
+  image.Qvec() = pose.qvec;
+  image.Tvec() = pose.tvec;
+  reconstruction_->Camera(image.CameraId()) = pose.camera;
+
   //////////////////////////////////////////////////////////////////////////////
   // Continue tracks
   //////////////////////////////////////////////////////////////////////////////
@@ -512,20 +868,18 @@ bool IncrementalMapper::RegisterNextImage(const Options& options,
   reconstruction_->RegisterImage(image_id);
   RegisterImageEvent(image_id);
 
-  for (size_t i = 0; i < inlier_mask.size(); ++i) {
-    if (inlier_mask[i]) {
-      const point2D_t point2D_idx = tri_corrs[i].first;
+  for (size_t i = 0; i < pose.inlier_mask.size(); ++i) {
+    if (pose.inlier_mask[i]) {
+      const point2D_t point2D_idx = pose.tri_corrs[i].first;
       const Point2D& point2D = image.Point2D(point2D_idx);
       if (!point2D.HasPoint3D()) {
-        const point3D_t point3D_id = tri_corrs[i].second;
+        const point3D_t point3D_id = pose.tri_corrs[i].second;
         const TrackElement track_el(image_id, point2D_idx);
         reconstruction_->AddObservation(point3D_id, track_el);
         triangulator_->AddModifiedPoint3D(point3D_id);
       }
     }
   }
-
-  return true;
 }
 
 size_t IncrementalMapper::TriangulateImage(
@@ -568,72 +922,26 @@ IncrementalMapper::AdjustLocalBundle(
 
   // Do the bundle adjustment only if there is any connected images.
   if (local_bundle.size() > 0) {
-    BundleAdjustmentConfig ba_config;
-    ba_config.AddImage(image_id);
-    for (const image_t local_image_id : local_bundle) {
-      ba_config.AddImage(local_image_id);
-    }
+    BundleAdjustmentConfig ba_config =
+        ConfigureLocalBundle(options, image_id, local_bundle);
 
-    // Fix the existing images, if option specified.
-    if (options.fix_existing_images) {
-      for (const image_t local_image_id : local_bundle) {
-        if (existing_image_ids_.count(local_image_id)) {
-          ba_config.SetConstantPose(local_image_id);
-        }
-      }
-    }
-
-    // Determine which cameras to fix, when not all the registered images
-    // are within the current local bundle.
-    std::unordered_map<camera_t, size_t> num_images_per_camera;
-    for (const image_t image_id : ba_config.Images()) {
-      const Image& image = reconstruction_->Image(image_id);
-      num_images_per_camera[image.CameraId()] += 1;
-    }
-
-    for (const auto& camera_id_and_num_images_pair : num_images_per_camera) {
-      const size_t num_reg_images_for_camera =
-          num_reg_images_per_camera_.at(camera_id_and_num_images_pair.first);\
-      if (camera_id_and_num_images_pair.second < num_reg_images_for_camera) {
-        ba_config.SetConstantCamera(camera_id_and_num_images_pair.first);
-      }
-    }
-
-    // Fix 7 DOF to avoid scale/rotation/translation drift in bundle adjustment.
-    if (local_bundle.size() == 1) {
-      ba_config.SetConstantPose(local_bundle[0]);
-      ba_config.SetConstantTvec(image_id, {0});
-    } else if (local_bundle.size() > 1) {
-      const image_t image_id1 = local_bundle[local_bundle.size() - 1];
-      const image_t image_id2 = local_bundle[local_bundle.size() - 2];
-      ba_config.SetConstantPose(image_id1);
-      if (!options.fix_existing_images ||
-          !existing_image_ids_.count(image_id2)) {
-        ba_config.SetConstantTvec(image_id2, {0});
-      }
-    }
-
-    // Make sure, we refine all new and short-track 3D points, no matter if
-    // they are fully contained in the local image set or not. Do not include
-    // long track 3D points as they are usually already very stable and adding
-    // to them to bundle adjustment and track merging/completion would slow
-    // down the local bundle adjustment significantly.
     std::unordered_set<point3D_t> variable_point3D_ids;
     for (const point3D_t point3D_id : point3D_ids) {
-      const Point3D& point3D = reconstruction_->Point3D(point3D_id);
-      const size_t kMaxTrackLength = 15;
-      if (!point3D.HasError() || point3D.Track().Length() <= kMaxTrackLength) {
+      if (IsLocalBundlePoint(point3D_id)) {
         ba_config.AddVariablePoint(point3D_id);
         variable_point3D_ids.insert(point3D_id);
       }
     }
 
-    // Adjust the local bundle.
-    BundleAdjuster bundle_adjuster(ba_options, ba_config);
-    bundle_adjuster.Solve(reconstruction_);
+    // Adjust the local bundle. The problem is kept alive across calls and
+    // only updated for the images and points entering or leaving the bundle.
+    if (!local_bundle_adjuster_) {
+      local_bundle_adjuster_.reset(new PersistentBundleAdjuster(ba_options));
+    }
+    local_bundle_adjuster_->Solve(ba_config, reconstruction_);
 
     report.num_adjusted_observations =
-        bundle_adjuster.Summary().num_residuals / 2;
+        local_bundle_adjuster_->Summary().num_residuals / 2;
 
     // Merge refined tracks with other existing points.
     report.num_merged_observations =
@@ -657,14 +965,219 @@ IncrementalMapper::AdjustLocalBundle(
   filter_image_ids.insert(local_bundle.begin(), local_bundle.end());
   report.num_filtered_observations = reconstruction_->FilterPoints3DInImages(
       options.filter_max_reproj_error, options.filter_min_tri_angle,
-      filter_image_ids);
+      filter_image_ids, options.num_threads);
+  report.num_filtered_observations += reconstruction_->FilterPoints3D(
+      options.filter_max_reproj_error, options.filter_min_tri_angle,
+      point3D_ids, options.num_threads);
+
+  return report;
+}
+
+IncrementalMapper::LocalBundleAdjustmentReport
+IncrementalMapper::AdjustLocalBundles(
+    const Options& options, const BundleAdjustmentOptions& ba_options,
+    const IncrementalTriangulator::Options& tri_options,
+    const std::vector<image_t>& image_ids,
+    const std::unordered_set<point3D_t>& point3D_ids) {
+  CHECK_NOTNULL(reconstruction_);
+  CHECK(options.Check());
+
+  LocalBundleAdjustmentReport report;
+
+  // Find the local bundles of all reference images.
+  std::vector<std::vector<image_t>> local_bundles(image_ids.size());
+  std::vector<std::unordered_set<image_t>> local_bundle_image_ids(
+      image_ids.size());
+  for (size_t i = 0; i < image_ids.size(); ++i) {
+    local_bundles[i] = FindLocalBundle(options, image_ids[i]);
+    local_bundle_image_ids[i].insert(image_ids[i]);
+    local_bundle_image_ids[i].insert(local_bundles[i].begin(),
+                                     local_bundles[i].end());
+  }
+
+  // Refine each of the given 3D points in the first local bundle observing
+  // it, or in the first local bundle if none observes it, so that the points
+  // do not needlessly couple the otherwise unrelated local bundles.
+  std::vector<std::unordered_set<point3D_t>> local_bundle_point3D_ids(
+      image_ids.size());
+  for (const point3D_t point3D_id : point3D_ids) {
+    if (!IsLocalBundlePoint(point3D_id)) {
+      continue;
+    }
+    size_t local_bundle_idx = 0;
+    const Point3D& point3D = reconstruction_->Point3D(point3D_id);
+    for (size_t i = 0; i < image_ids.size(); ++i) {
+      bool observed = false;
+      for (const auto& track_el : point3D.Track().Elements()) {
+        if (local_bundle_image_ids[i].count(track_el.image_id) > 0) {
+          observed = true;
+          break;
+        }
+      }
+      if (observed) {
+        local_bundle_idx = i;
+        break;
+      }
+    }
+    local_bundle_point3D_ids[local_bundle_idx].insert(point3D_id);
+  }
+
+  // Adjust the local bundles in waves, where each wave is composed of the
+  // pending local bundles that do not overlap, which are solved concurrently.
+  // The configurations of the pending local bundles are set up again for
+  // each wave, since the previous wave merges and completes tracks.
+  const int num_threads = GetEffectiveNumThreads(options.num_threads);
+  std::vector<size_t> pending_idxs;
+  for (size_t i = 0; i < image_ids.size(); ++i) {
+    if (!local_bundles[i].empty()) {
+      pending_idxs.push_back(i);
+    }
+  }
+
+  while (!pending_idxs.empty()) {
+    std::vector<size_t> wave_idxs;
+    std::vector<BundleAdjustmentConfig> wave_configs;
+    std::vector<BundleAdjustmentAccessSet> wave_access_sets;
+    std::vector<size_t> next_pending_idxs;
+    for (const size_t idx : pending_idxs) {
+      BundleAdjustmentConfig ba_config =
+          ConfigureLocalBundle(options, image_ids[idx], local_bundles[idx]);
+      for (const point3D_t point3D_id : local_bundle_point3D_ids[idx]) {
+        if (reconstruction_->ExistsPoint3D(point3D_id)) {
+          ba_config.AddVariablePoint(point3D_id);
+        }
+      }
+
+      BundleAdjustmentAccessSet access_set(ba_config, *reconstruction_);
+      bool is_disjoint = true;
+      for (const auto& wave_access_set : wave_access_sets) {
+        if (!access_set.IsDisjoint(wave_access_set)) {
+          is_disjoint = false;
+          break;
+        }
+      }
+
+      if (is_disjoint) {
+        wave_idxs.push_back(idx);
+        wave_configs.push_back(std::move(ba_config));
+        wave_access_sets.push_back(std::move(access_set));
+      } else {
+        next_pending_idxs.push_back(idx);
+      }
+    }
+
+    // Distribute the threads over the concurrent problems and avoid their
+    // summaries to be printed interleaved.
+    const int num_wave_threads =
+        std::min(num_threads, static_cast<int>(wave_configs.size()));
+    BundleAdjustmentOptions wave_ba_options = ba_options;
+    if (wave_configs.size() > 1) {
+      wave_ba_options.solver_options.num_threads =
+          std::max(1, num_threads / num_wave_threads);
+      wave_ba_options.solver_options.num_linear_solver_threads =
+          wave_ba_options.solver_options.num_threads;
+      wave_ba_options.print_summary = false;
+    }
+
+    std::vector<std::unique_ptr<BundleAdjuster>> bundle_adjusters;
+    bundle_adjusters.reserve(wave_configs.size());
+    for (const auto& ba_config : wave_configs) {
+      bundle_adjusters.emplace_back(
+          new BundleAdjuster(wave_ba_options, ba_config));
+    }
+
+    ThreadPool thread_pool(num_wave_threads);
+    for (size_t i = 0; i < bundle_adjusters.size(); ++i) {
+      thread_pool.AddTask(
+          [&, i]() { bundle_adjusters[i]->Solve(reconstruction_); });
+    }
+    thread_pool.Wait();
+
+    // Merge and complete the refined tracks of all problems sequentially.
+    for (size_t i = 0; i < wave_idxs.size(); ++i) {
+      report.num_adjusted_observations +=
+          bundle_adjusters[i]->Summary().num_residuals / 2;
+      report.num_merged_observations += triangulator_->MergeTracks(
+          tri_options, wave_configs[i].VariablePoints());
+      report.num_completed_observations += triangulator_->CompleteTracks(
+          tri_options, wave_configs[i].VariablePoints());
+      report.num_completed_observations +=
+          triangulator_->CompleteImage(tri_options, image_ids[wave_idxs[i]]);
+    }
+
+    pending_idxs = std::move(next_pending_idxs);
+  }
+
+  std::unordered_set<image_t> filter_image_ids;
+  for (const auto& bundle_image_ids : local_bundle_image_ids) {
+    filter_image_ids.insert(bundle_image_ids.begin(), bundle_image_ids.end());
+  }
+  report.num_filtered_observations = reconstruction_->FilterPoints3DInImages(
+      options.filter_max_reproj_error, options.filter_min_tri_angle,
+      filter_image_ids, options.num_threads);
   report.num_filtered_observations += reconstruction_->FilterPoints3D(
       options.filter_max_reproj_error, options.filter_min_tri_angle,
-      point3D_ids);
+      point3D_ids, options.num_threads);
 
   return report;
 }
 
+bool IncrementalMapper::AdjustSnapshotBundle(
+    const BundleAdjustmentOptions& ba_options, const image_t image_id) {
+  CHECK_NOTNULL(reconstruction_);
+
+  const auto snapshot_it = image_to_snapshot_.find(image_id);
+  if (snapshot_it == image_to_snapshot_.end()) {
+    return false;
+  }
+
+  const CameraRig& camera_rig = camera_rigs_[snapshot_it->second.first];
+  const std::vector<image_t>& snapshot =
+      camera_rig.Snapshots()[snapshot_it->second.second];
+
+  // The rig pose is defined through the registered images of the snapshot,
+  // which must include the image of the reference camera.
+  std::vector<CameraRig> snapshot_camera_rigs(1);
+  CameraRig& snapshot_camera_rig = snapshot_camera_rigs[0];
+  std::vector<image_t> reg_snapshot_image_ids;
+  bool has_ref_camera = false;
+  for (const image_t snapshot_image_id : snapshot) {
+    const Image& image = reconstruction_->Image(snapshot_image_id);
+    if (!image.IsRegistered()) {
+      continue;
+    }
+    reg_snapshot_image_ids.push_back(snapshot_image_id);
+    snapshot_camera_rig.AddCamera(image.CameraId(),
+                                  camera_rig.RelativeQvec(image.CameraId()),
+                                  camera_rig.RelativeTvec(image.CameraId()));
+    if (image.CameraId() == camera_rig.RefCameraId()) {
+      has_ref_camera = true;
+    }
+  }
+
+  if (!has_ref_camera || reg_snapshot_image_ids.size() < 2) {
+    return false;
+  }
+
+  snapshot_camera_rig.SetRefCameraId(camera_rig.RefCameraId());
+  snapshot_camera_rig.AddSnapshot(reg_snapshot_image_ids);
+
+  // Avoid degeneracies in bundle adjustment.
+  reconstruction_->FilterObservationsWithNegativeDepth();
+
+  // The 3D points of the snapshot images are variable and their observations
+  // in all other images are added with constant poses.
+  BundleAdjustmentConfig ba_config;
+  for (const image_t snapshot_image_id : reg_snapshot_image_ids) {
+    ba_config.AddImage(snapshot_image_id);
+  }
+
+  RigBundleAdjuster::Options rig_ba_options;
+  rig_ba_options.refine_relative_poses = false;
+  RigBundleAdjuster bundle_adjuster(ba_options, rig_ba_options, ba_config);
+  return bundle_adjuster.Solve(reconstruction_, &snapshot_camera_rigs);
+}
+
 bool IncrementalMapper::AdjustGlobalBundle(
     const Options& options, const BundleAdjustmentOptions& ba_options) {
   CHECK_NOTNULL(reconstruction_);
@@ -700,9 +1213,15 @@ bool IncrementalMapper::AdjustGlobalBundle(
     ba_config.SetConstantTvec(reg_image_ids[1], {0});
   }
 
-  // Run bundle adjustment.
-  BundleAdjuster bundle_adjuster(ba_options, ba_config);
-  if (!bundle_adjuster.Solve(reconstruction_)) {
+  // Run bundle adjustment. The problem is kept alive across calls, e.g., the
+  // iterations of the global refinement, and only the residuals of filtered,
+  // merged, and new observations are removed or added in place.
+  if (!global_bundle_adjuster_) {
+    global_bundle_adjuster_.reset(new PersistentBundleAdjuster(ba_options));
+  } else {
+    global_bundle_adjuster_->SetOptions(ba_options);
+  }
+  if (!global_bundle_adjuster_->Solve(ba_config, reconstruction_)) {
     return false;
   }
 
@@ -746,6 +1265,55 @@ bool IncrementalMapper::AdjustParallelGlobalBundle(
   return true;
 }
 
+bool IncrementalMapper::AdjustPartitionedGlobalBundle(
+    const Options& options, const BundleAdjustmentOptions& ba_options,
+    const PartitionedBundleAdjuster::Options& partitioned_ba_options) {
+  CHECK_NOTNULL(reconstruction_);
+
+  const std::vector<image_t>& reg_image_ids = reconstruction_->RegImageIds();
+
+  CHECK_GE(reg_image_ids.size(), 2)
+      << "At least two images must be registered for global bundle-adjustment";
+
+  // Avoid degeneracies in bundle adjustment.
+  reconstruction_->FilterObservationsWithNegativeDepth();
+
+  // Configure bundle adjustment.
+  BundleAdjustmentConfig ba_config;
+  for (const image_t image_id : reg_image_ids) {
+    ba_config.AddImage(image_id);
+  }
+
+  // Fix the existing images, if option specified.
+  if (options.fix_existing_images) {
+    for (const image_t image_id : reg_image_ids) {
+      if (existing_image_ids_.count(image_id)) {
+        ba_config.SetConstantPose(image_id);
+      }
+    }
+  }
+
+  // Fix 7-DOFs of the bundle adjustment problem.
+  ba_config.SetConstantPose(reg_image_ids[0]);
+  if (!options.fix_existing_images ||
+      !existing_image_ids_.count(reg_image_ids[1])) {
+    ba_config.SetConstantTvec(reg_image_ids[1], {0});
+  }
+
+  // Run bundle adjustment.
+  PartitionedBundleAdjuster bundle_adjuster(partitioned_ba_options, ba_options,
+                                            ba_config);
+  if (!bundle_adjuster.Solve(reconstruction_)) {
+    return false;
+  }
+
+  // Normalize scene for numerical stability and
+  // to avoid large scale changes in viewer.
+  reconstruction_->Normalize();
+
+  return true;
+}
+
 size_t IncrementalMapper::FilterImages(const Options& options) {
   CHECK_NOTNULL(reconstruction_);
   CHECK(options.Check());
@@ -765,6 +1333,7 @@ size_t IncrementalMapper::FilterImages(const Options& options) {
   for (const image_t image_id : image_ids) {
     DeRegisterImageEvent(image_id);
     filtered_images_.insert(image_id);
+    next_image_ranking_.modified_image_ids.insert(image_id);
   }
 
   return image_ids.size();
@@ -774,7 +1343,8 @@ size_t IncrementalMapper::FilterPoints(const Options& options) {
   CHECK_NOTNULL(reconstruction_);
   CHECK(options.Check());
   return reconstruction_->FilterAllPoints3D(options.filter_max_reproj_error,
-                                            options.filter_min_tri_angle);
+                                            options.filter_min_tri_angle,
+                                            options.num_threads);
 }
 
 const Reconstruction& IncrementalMapper::GetReconstruction() const {
@@ -782,6 +1352,56 @@ const Reconstruction& IncrementalMapper::GetReconstruction() const {
   return *reconstruction_;
 }
 
+IncrementalMapper::State IncrementalMapper::GetState() const {
+  State state;
+  state.num_registrations = num_registrations_;
+  if (reconstruction_ != nullptr) {
+    for (const image_t image_id : reconstruction_->RegImageIds()) {
+      auto it = state.num_registrations.find(image_id);
+      CHECK(it != state.num_registrations.end());
+      it->second -= 1;
+      if (it->second == 0) {
+        state.num_registrations.erase(it);
+      }
+    }
+  }
+  state.init_num_reg_trials = init_num_reg_trials_;
+  state.init_image_pairs = init_image_pairs_;
+  if (reconstruction_ != nullptr) {
+    state.filtered_images = filtered_images_;
+    state.num_reg_trials = num_reg_trials_;
+    state.existing_image_ids = existing_image_ids_;
+  }
+  return state;
+}
+
+void IncrementalMapper::SetState(const State& state) {
+  num_registrations_ = state.num_registrations;
+  num_shared_reg_images_ = 0;
+  if (reconstruction_ != nullptr) {
+    for (const image_t image_id : reconstruction_->RegImageIds()) {
+      if (++num_registrations_[image_id] > 1) {
+        num_shared_reg_images_ += 1;
+      }
+    }
+  }
+
+  num_total_reg_images_ = 0;
+  for (const auto& num_regs : num_registrations_) {
+    if (num_regs.second > 0) {
+      num_total_reg_images_ += 1;
+    }
+  }
+
+  init_num_reg_trials_ = state.init_num_reg_trials;
+  init_image_pairs_ = state.init_image_pairs;
+  filtered_images_ = state.filtered_images;
+  num_reg_trials_ = state.num_reg_trials;
+  existing_image_ids_ = state.existing_image_ids;
+
+  next_image_ranking_ = NextImageRanking();
+}
+
 size_t IncrementalMapper::NumTotalRegImages() const {
   return num_total_reg_images_;
 }
@@ -799,110 +1419,115 @@ void IncrementalMapper::ClearModifiedPoints3D() {
 }
 
 std::vector<image_t> IncrementalMapper::FindFirstInitialImage(
-    const Options& options) const {
-  // Struct to hold meta-data for ranking images.
-  struct ImageInfo {
-    image_t image_id;
-    bool prior_focal_length;
-    image_t num_correspondences;
-  };
+    const Options& options) {
+  if (!init_image_ranking_valid_) {
+    // Struct to hold meta-data for ranking images.
+    struct ImageInfo {
+      image_t image_id;
+      bool prior_focal_length;
+      image_t num_correspondences;
+    };
+
+    // Collect information of all images with correspondences, since only
+    // images with correspondences can be registered.
+    std::vector<ImageInfo> image_infos;
+    image_infos.reserve(reconstruction_->NumImages());
+    for (const auto& image : reconstruction_->Images()) {
+      if (image.second.NumCorrespondences() == 0) {
+        continue;
+      }
 
-  const size_t init_max_reg_trials =
-      static_cast<size_t>(options.init_max_reg_trials);
+      const class Camera& camera =
+          reconstruction_->Camera(image.second.CameraId());
+      ImageInfo image_info;
+      image_info.image_id = image.first;
+      image_info.prior_focal_length = camera.HasPriorFocalLength();
+      image_info.num_correspondences = image.second.NumCorrespondences();
+      image_infos.push_back(image_info);
+    }
 
-  // Collect information of all not yet registered images with
-  // correspondences.
-  std::vector<ImageInfo> image_infos;
-  image_infos.reserve(reconstruction_->NumImages());
-  for (const auto& image : reconstruction_->Images()) {
-    // Only images with correspondences can be registered.
-    if (image.second.NumCorrespondences() == 0) {
-      continue;
+    // Sort images such that images with a prior focal length and more
+    // correspondences are preferred, i.e. they appear in the front of the
+    // list.
+    std::sort(image_infos.begin(), image_infos.end(),
+              [](const ImageInfo& image_info1, const ImageInfo& image_info2) {
+                if (image_info1.prior_focal_length &&
+                    !image_info2.prior_focal_length) {
+                  return true;
+                } else if (!image_info1.prior_focal_length &&
+                           image_info2.prior_focal_length) {
+                  return false;
+                } else {
+                  return image_info1.num_correspondences >
+                         image_info2.num_correspondences;
+                }
+              });
+
+    init_image_ranking_.clear();
+    init_image_ranking_.reserve(image_infos.size());
+    for (const ImageInfo& image_info : image_infos) {
+      init_image_ranking_.push_back(image_info.image_id);
     }
+    init_image_ranking_valid_ = true;
+  }
+
+  const size_t init_max_reg_trials =
+      static_cast<size_t>(options.init_max_reg_trials);
 
+  // Extract image identifiers in sorted order.
+  std::vector<image_t> image_ids;
+  image_ids.reserve(init_image_ranking_.size());
+  for (const image_t image_id : init_image_ranking_) {
     // Only use images for initialization a maximum number of times.
-    if (init_num_reg_trials_.count(image.first) &&
-        init_num_reg_trials_.at(image.first) >= init_max_reg_trials) {
+    const auto init_num_reg_trials = init_num_reg_trials_.find(image_id);
+    if (init_num_reg_trials != init_num_reg_trials_.end() &&
+        init_num_reg_trials->second >= init_max_reg_trials) {
       continue;
     }
 
     // Only use images for initialization that are not registered in any
     // of the other reconstructions.
-    if (num_registrations_.count(image.first) > 0 &&
-        num_registrations_.at(image.first) > 0) {
+    const auto num_registrations = num_registrations_.find(image_id);
+    if (num_registrations != num_registrations_.end() &&
+        num_registrations->second > 0) {
       continue;
     }
 
-    const class Camera& camera =
-        reconstruction_->Camera(image.second.CameraId());
-    ImageInfo image_info;
-    image_info.image_id = image.first;
-    image_info.prior_focal_length = camera.HasPriorFocalLength();
-    image_info.num_correspondences = image.second.NumCorrespondences();
-    image_infos.push_back(image_info);
-  }
-
-  // Sort images such that images with a prior focal length and more
-  // correspondences are preferred, i.e. they appear in the front of the list.
-  std::sort(
-      image_infos.begin(), image_infos.end(),
-      [](const ImageInfo& image_info1, const ImageInfo& image_info2) {
-        if (image_info1.prior_focal_length && !image_info2.prior_focal_length) {
-          return true;
-        } else if (!image_info1.prior_focal_length &&
-                   image_info2.prior_focal_length) {
-          return false;
-        } else {
-          return image_info1.num_correspondences >
-                 image_info2.num_correspondences;
-        }
-      });
-
-  // Extract image identifiers in sorted order.
-  std::vector<image_t> image_ids;
-  image_ids.reserve(image_infos.size());
-  for (const ImageInfo& image_info : image_infos) {
-    image_ids.push_back(image_info.image_id);
+    image_ids.push_back(image_id);
   }
 
   return image_ids;
 }
 
 std::vector<image_t> IncrementalMapper::FindSecondInitialImage(
-    const Options& options, const image_t image_id1) const {
-  const CorrespondenceGraph& correspondence_graph =
-      database_cache_->CorrespondenceGraph();
+    const Options& options, const image_t image_id1) {
+  auto ranking = init_image_pair_rankings_.find(image_id1);
+  if (ranking == init_image_pair_rankings_.end()) {
+    const CorrespondenceGraph& correspondence_graph =
+        database_cache_->CorrespondenceGraph();
 
-  // Collect images that are connected to the first seed image and have
-  // not been registered before in other reconstructions.
-  const class Image& image1 = reconstruction_->Image(image_id1);
-  std::unordered_map<image_t, point2D_t> num_correspondences;
-  for (point2D_t point2D_idx = 0; point2D_idx < image1.NumPoints2D();
-       ++point2D_idx) {
-    for (const auto& corr :
-         correspondence_graph.FindCorrespondences(image_id1, point2D_idx)) {
-      if (num_registrations_.count(corr.image_id) == 0 ||
-          num_registrations_.at(corr.image_id) == 0) {
+    // Collect images that are connected to the first seed image.
+    const class Image& image1 = reconstruction_->Image(image_id1);
+    std::unordered_map<image_t, point2D_t> num_correspondences;
+    for (point2D_t point2D_idx = 0; point2D_idx < image1.NumPoints2D();
+         ++point2D_idx) {
+      for (const auto& corr :
+           correspondence_graph.FindCorrespondences(image_id1, point2D_idx)) {
         num_correspondences[corr.image_id] += 1;
       }
     }
-  }
-
-  // Struct to hold meta-data for ranking images.
-  struct ImageInfo {
-    image_t image_id;
-    bool prior_focal_length;
-    point2D_t num_correspondences;
-  };
-
-  const size_t init_min_num_inliers =
-      static_cast<size_t>(options.init_min_num_inliers);
 
-  // Compose image information in a compact form for sorting.
-  std::vector<ImageInfo> image_infos;
-  image_infos.reserve(reconstruction_->NumImages());
-  for (const auto elem : num_correspondences) {
-    if (elem.second >= init_min_num_inliers) {
+    // Struct to hold meta-data for ranking images.
+    struct ImageInfo {
+      image_t image_id;
+      bool prior_focal_length;
+      point2D_t num_correspondences;
+    };
+
+    // Compose image information in a compact form for sorting.
+    std::vector<ImageInfo> image_infos;
+    image_infos.reserve(num_correspondences.size());
+    for (const auto elem : num_correspondences) {
       const class Image& image = reconstruction_->Image(elem.first);
       const class Camera& camera = reconstruction_->Camera(image.CameraId());
       ImageInfo image_info;
@@ -911,29 +1536,54 @@ std::vector<image_t> IncrementalMapper::FindSecondInitialImage(
       image_info.num_correspondences = elem.second;
       image_infos.push_back(image_info);
     }
+
+    // Sort images such that images with a prior focal length and more
+    // correspondences are preferred, i.e. they appear in the front of the
+    // list.
+    std::sort(image_infos.begin(), image_infos.end(),
+              [](const ImageInfo& image_info1, const ImageInfo& image_info2) {
+                if (image_info1.prior_focal_length &&
+                    !image_info2.prior_focal_length) {
+                  return true;
+                } else if (!image_info1.prior_focal_length &&
+                           image_info2.prior_focal_length) {
+                  return false;
+                } else {
+                  return image_info1.num_correspondences >
+                         image_info2.num_correspondences;
+                }
+              });
+
+    std::vector<std::pair<image_t, point2D_t>> image_ranking;
+    image_ranking.reserve(image_infos.size());
+    for (const ImageInfo& image_info : image_infos) {
+      image_ranking.emplace_back(image_info.image_id,
+                                 image_info.num_correspondences);
+    }
+
+    ranking =
+        init_image_pair_rankings_.emplace(image_id1, std::move(image_ranking))
+            .first;
   }
 
-  // Sort images such that images with a prior focal length and more
-  // correspondences are preferred, i.e. they appear in the front of the list.
-  std::sort(
-      image_infos.begin(), image_infos.end(),
-      [](const ImageInfo& image_info1, const ImageInfo& image_info2) {
-        if (image_info1.prior_focal_length && !image_info2.prior_focal_length) {
-          return true;
-        } else if (!image_info1.prior_focal_length &&
-                   image_info2.prior_focal_length) {
-          return false;
-        } else {
-          return image_info1.num_correspondences >
-                 image_info2.num_correspondences;
-        }
-      });
+  const size_t init_min_num_inliers =
+      static_cast<size_t>(options.init_min_num_inliers);
 
-  // Extract image identifiers in sorted order.
+  // Extract image identifiers in sorted order of images that have enough
+  // correspondences and have not been registered before in other
+  // reconstructions.
   std::vector<image_t> image_ids;
-  image_ids.reserve(image_infos.size());
-  for (const ImageInfo& image_info : image_infos) {
-    image_ids.push_back(image_info.image_id);
+  image_ids.reserve(ranking->second.size());
+  for (const auto& image : ranking->second) {
+    if (image.second < init_min_num_inliers) {
+      continue;
+    }
+    const auto num_registrations = num_registrations_.find(image.first);
+    if (num_registrations != num_registrations_.end() &&
+        num_registrations->second > 0) {
+      continue;
+    }
+    image_ids.push_back(image.first);
   }
 
   return image_ids;
@@ -946,25 +1596,13 @@ std::vector<image_t> IncrementalMapper::FindLocalBundle(
   const Image& image = reconstruction_->Image(image_id);
   CHECK(image.IsRegistered());
 
-  // Extract all images that have at least one 3D point with the query image
-  // in common, and simultaneously count the number of common 3D points.
-
-  std::unordered_map<image_t, size_t> shared_observations;
+  // All images that have at least one 3D point with the query image in common
+  // and the number of common observations are maintained by the
+  // reconstruction, so that they do not need to be collected from the tracks
+  // of all 3D points of the image.
 
-  std::unordered_set<point3D_t> point3D_ids;
-  point3D_ids.reserve(image.NumPoints3D());
-
-  for (const Point2D& point2D : image.Points2D()) {
-    if (point2D.HasPoint3D()) {
-      point3D_ids.insert(point2D.Point3DId());
-      const Point3D& point3D = reconstruction_->Point3D(point2D.Point3DId());
-      for (const TrackElement& track_el : point3D.Track().Elements()) {
-        if (track_el.image_id != image_id) {
-          shared_observations[track_el.image_id] += 1;
-        }
-      }
-    }
-  }
+  const std::unordered_map<image_t, size_t>& shared_observations =
+      reconstruction_->ImageCovisibility(image_id);
 
   // Sort overlapping images according to number of shared observations.
 
@@ -1020,8 +1658,18 @@ std::vector<image_t> IncrementalMapper::FindLocalBundle(
   }};
 
   const Eigen::Vector3d proj_center = image.ProjectionCenter();
+
+  // The triangulation angles are computed from the 3D points of the image,
+  // which are thus only collected once for all overlapping images.
   std::vector<Eigen::Vector3d> shared_points3D;
   shared_points3D.reserve(image.NumPoints3D());
+  for (const Point2D& point2D : image.Points2D()) {
+    if (point2D.HasPoint3D()) {
+      shared_points3D.push_back(
+          reconstruction_->Point3D(point2D.Point3DId()).XYZ());
+    }
+  }
+
   std::vector<double> tri_angles(overlapping_images.size(), -1.0);
   std::vector<char> used_overlapping_images(overlapping_images.size(), false);
 
@@ -1050,15 +1698,6 @@ std::vector<image_t> IncrementalMapper::FindLocalBundle(
       // iterations, reuse the previously computed value.
       double& tri_angle = tri_angles[overlapping_image_idx];
       if (tri_angle < 0.0) {
-        // Collect the commonly observed 3D points.
-        shared_points3D.clear();
-        for (const Point2D& point2D : image.Points2D()) {
-          if (point2D.HasPoint3D() && point3D_ids.count(point2D.Point3DId())) {
-            shared_points3D.push_back(
-                reconstruction_->Point3D(point2D.Point3DId()).XYZ());
-          }
-        }
-
         // Calculate the triangulation angle at a certain percentile.
         const double kTriangulationAnglePercentile = 75;
         tri_angle = Percentile(
@@ -1108,6 +1747,68 @@ std::vector<image_t> IncrementalMapper::FindLocalBundle(
   return local_bundle_image_ids;
 }
 
+BundleAdjustmentConfig IncrementalMapper::ConfigureLocalBundle(
+    const Options& options, const image_t image_id,
+    const std::vector<image_t>& local_bundle) const {
+  BundleAdjustmentConfig ba_config;
+  ba_config.AddImage(image_id);
+  for (const image_t local_image_id : local_bundle) {
+    ba_config.AddImage(local_image_id);
+  }
+
+  // Fix the existing images, if option specified.
+  if (options.fix_existing_images) {
+    for (const image_t local_image_id : local_bundle) {
+      if (existing_image_ids_.count(local_image_id)) {
+        ba_config.SetConstantPose(local_image_id);
+      }
+    }
+  }
+
+  // Determine which cameras to fix, when not all the registered images
+  // are within the current local bundle.
+  std::unordered_map<camera_t, size_t> num_images_per_camera;
+  for (const image_t image_id : ba_config.Images()) {
+    const Image& image = reconstruction_->Image(image_id);
+    num_images_per_camera[image.CameraId()] += 1;
+  }
+
+  for (const auto& camera_id_and_num_images_pair : num_images_per_camera) {
+    const size_t num_reg_images_for_camera =
+        num_reg_images_per_camera_.at(camera_id_and_num_images_pair.first);\
+    if (camera_id_and_num_images_pair.second < num_reg_images_for_camera) {
+      ba_config.SetConstantCamera(camera_id_and_num_images_pair.first);
+    }
+  }
+
+  // Fix 7 DOF to avoid scale/rotation/translation drift in bundle adjustment.
+  if (local_bundle.size() == 1) {
+    ba_config.SetConstantPose(local_bundle[0]);
+    ba_config.SetConstantTvec(image_id, {0});
+  } else if (local_bundle.size() > 1) {
+    const image_t image_id1 = local_bundle[local_bundle.size() - 1];
+    const image_t image_id2 = local_bundle[local_bundle.size() - 2];
+    ba_config.SetConstantPose(image_id1);
+    if (!options.fix_existing_images ||
+        !existing_image_ids_.count(image_id2)) {
+      ba_config.SetConstantTvec(image_id2, {0});
+    }
+  }
+
+  return ba_config;
+}
+
+bool IncrementalMapper::IsLocalBundlePoint(const point3D_t point3D_id) const {
+  // Make sure, we refine all new and short-track 3D points, no matter if
+  // they are fully contained in the local image set or not. Do not include
+  // long track 3D points as they are usually already very stable and adding
+  // to them to bundle adjustment and track merging/completion would slow
+  // down the local bundle adjustment significantly.
+  const Point3D& point3D = reconstruction_->Point3D(point3D_id);
+  const size_t kMaxTrackLength = 15;
+  return !point3D.HasError() || point3D.Track().Length() <= kMaxTrackLength;
+}
+
 void IncrementalMapper::RegisterImageEvent(const image_t image_id) {
   const Image& image = reconstruction_->Image(image_id);
   size_t& num_reg_images_for_camera =
@@ -1139,15 +1840,139 @@ void IncrementalMapper::DeRegisterImageEvent(const image_t image_id) {
   }
 }
 
+void IncrementalMapper::UpdateNextImageRank(const Options& options,
+                                            const image_t image_id) {
+  NextImageRanking& ranking = next_image_ranking_;
+
+  const auto entry_it = ranking.entries.find(image_id);
+  if (entry_it != ranking.entries.end()) {
+    ranking.buckets[entry_it->second.first].erase(
+        std::make_pair(entry_it->second.second, image_id));
+    ranking.entries.erase(entry_it);
+  }
+
+  const Image& image = reconstruction_->Image(image_id);
+
+  // Skip images that are already registered.
+  if (image.IsRegistered()) {
+    return;
+  }
+
+  // Only consider images with a sufficient number of visible points.
+  if (image.NumVisiblePoints3D() <
+      static_cast<size_t>(options.abs_pose_min_num_inliers)) {
+    return;
+  }
+
+  // Only try registration for a certain maximum number of times.
+  const auto num_reg_trials_it = num_reg_trials_.find(image_id);
+  const size_t num_reg_trials = num_reg_trials_it == num_reg_trials_.end()
+                                    ? 0
+                                    : num_reg_trials_it->second;
+  if (num_reg_trials >= static_cast<size_t>(options.max_reg_trials)) {
+    return;
+  }
+
+  float rank = 0;
+  switch (options.image_selection_method) {
+    case Options::ImageSelectionMethod::MAX_VISIBLE_POINTS_NUM:
+      rank = RankNextImageMaxVisiblePointsNum(image);
+      break;
+    case Options::ImageSelectionMethod::MAX_VISIBLE_POINTS_RATIO:
+      rank = RankNextImageMaxVisiblePointsRatio(image);
+      break;
+    case Options::ImageSelectionMethod::MIN_UNCERTAINTY:
+      rank = RankNextImageMinUncertainty(image);
+      break;
+  }
+
+  // If image has been filtered or failed to register, place it in the
+  // second bucket and prefer images that have not been tried before.
+  const int bucket =
+      (filtered_images_.count(image_id) == 0 && num_reg_trials == 0) ? 0 : 1;
+  ranking.buckets[bucket].emplace(rank, image_id);
+  ranking.entries.emplace(image_id, std::make_pair(bucket, rank));
+}
+
+bool IncrementalMapper::SelectInitialImagePair(
+    const Options& options,
+    std::vector<std::pair<image_t, image_t>>* candidate_pairs,
+    ThreadPool* thread_pool, image_t* image_id1, image_t* image_id2) {
+  if (init_two_view_max_error_ != options.init_max_error) {
+    init_two_view_geometries_.clear();
+    init_two_view_max_error_ = options.init_max_error;
+  }
+
+  // Estimate the geometries of the not yet cached pairs in parallel.
+  std::vector<image_pair_t> pair_ids;
+  std::vector<std::future<TwoViewGeometry>> futures;
+  for (const auto& candidate_pair : *candidate_pairs) {
+    const image_pair_t pair_id = Database::ImagePairToPairId(
+        candidate_pair.first, candidate_pair.second);
+    if (init_two_view_geometries_.count(pair_id) > 0) {
+      continue;
+    }
+    pair_ids.push_back(pair_id);
+    futures.push_back(thread_pool->AddTask(
+        &IncrementalMapper::EstimateTwoViewGeometry, this, options,
+        candidate_pair.first, candidate_pair.second));
+  }
+
+  for (size_t i = 0; i < futures.size(); ++i) {
+    init_two_view_geometries_.emplace(pair_ids[i], futures[i].get());
+  }
+
+  // Select the valid pair with most inliers, where ties are broken by the
+  // ranking of the pairs.
+  size_t best_num_inliers = 0;
+  *image_id1 = kInvalidImageId;
+  *image_id2 = kInvalidImageId;
+  for (const auto& candidate_pair : *candidate_pairs) {
+    const TwoViewGeometry& two_view_geometry =
+        init_two_view_geometries_.at(Database::ImagePairToPairId(
+            candidate_pair.first, candidate_pair.second));
+    if (CheckInitialTwoViewGeometry(options, two_view_geometry) &&
+        two_view_geometry.inlier_matches.size() > best_num_inliers) {
+      best_num_inliers = two_view_geometry.inlier_matches.size();
+      *image_id1 = candidate_pair.first;
+      *image_id2 = candidate_pair.second;
+    }
+  }
+
+  candidate_pairs->clear();
+
+  return *image_id1 != kInvalidImageId;
+}
+
 bool IncrementalMapper::EstimateInitialTwoViewGeometry(
     const Options& options, const image_t image_id1, const image_t image_id2) {
   const image_pair_t image_pair_id =
       Database::ImagePairToPairId(image_id1, image_id2);
 
-  if (prev_init_image_pair_id_ == image_pair_id) {
-    return true;
+  if (init_two_view_max_error_ != options.init_max_error) {
+    init_two_view_geometries_.clear();
+    init_two_view_max_error_ = options.init_max_error;
+  }
+
+  auto two_view_geometry = init_two_view_geometries_.find(image_pair_id);
+  if (two_view_geometry == init_two_view_geometries_.end()) {
+    two_view_geometry =
+        init_two_view_geometries_
+            .emplace(image_pair_id,
+                     EstimateTwoViewGeometry(options, image_id1, image_id2))
+            .first;
   }
 
+  return CheckInitialTwoViewGeometry(options, two_view_geometry->second);
+}
+
+TwoViewGeometry IncrementalMapper::EstimateTwoViewGeometry(
+    const Options& options, const image_t image_id1,
+    const image_t image_id2) const {
+  // The geometries of multiple pairs are estimated in parallel.
+  ScopedPRNGStream prng_stream(
+      Database::ImagePairToPairId(image_id1, image_id2));
+
   const Image& image1 = database_cache_->Image(image_id1);
   const Camera& camera1 = database_cache_->Camera(image1.CameraId());
 
@@ -1181,19 +2006,10 @@ bool IncrementalMapper::EstimateInitialTwoViewGeometry(
 
   if (!two_view_geometry.EstimateRelativePose(camera1, points1, camera2,
                                               points2)) {
-    return false;
+    return TwoViewGeometry();
   }
 
-  if (static_cast<int>(two_view_geometry.inlier_matches.size()) >=
-          options.init_min_num_inliers &&
-      std::abs(two_view_geometry.tvec.z()) < options.init_max_forward_motion &&
-      two_view_geometry.tri_angle > DegToRad(options.init_min_tri_angle)) {
-    prev_init_image_pair_id_ = image_pair_id;
-    prev_init_two_view_geometry_ = two_view_geometry;
-    return true;
-  }
-
-  return false;
+  return two_view_geometry;
 }
 
 }  // namespace colmap
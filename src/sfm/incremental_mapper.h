@@ -32,12 +32,18 @@
 #ifndef COLMAP_SRC_SFM_INCREMENTAL_MAPPER_H_
 #define COLMAP_SRC_SFM_INCREMENTAL_MAPPER_H_
 
+#include <functional>
+#include <set>
+
+#include "base/camera_rig.h"
 #include "base/database.h"
 #include "base/database_cache.h"
 #include "base/reconstruction.h"
 #include "optim/bundle_adjustment.h"
+#include "optim/partitioned_bundle_adjustment.h"
 #include "sfm/incremental_triangulator.h"
 #include "util/alignment.h"
+#include "util/threading.h"
 
 namespace colmap {
 
@@ -80,6 +86,11 @@ class IncrementalMapper {
     // Maximum number of trials to use an image for initialization.
     int init_max_reg_trials = 2;
 
+    // Number of the top ranked candidate initial image pairs, whose two-view
+    // geometries are estimated in parallel. Of the candidates that satisfy
+    // the initialization criteria, the pair with most inliers is selected.
+    int init_num_candidate_pairs = 8;
+
     // Maximum reprojection error in absolute pose estimation.
     double abs_pose_max_error = 12.0;
 
@@ -89,6 +100,16 @@ class IncrementalMapper {
     // Minimum inlier ratio in absolute pose estimation.
     double abs_pose_min_inlier_ratio = 0.25;
 
+    // Number of threads used to evaluate the RANSAC hypotheses in absolute
+    // pose estimation for images with known focal length. Images with unknown
+    // focal length are already estimated in parallel for multiple focal
+    // length samples using num_threads.
+    int abs_pose_ransac_num_threads = 1;
+
+    // Whether to evaluate the RANSAC hypotheses in absolute pose estimation
+    // on the GPU, if CUDA is available.
+    bool abs_pose_use_gpu = false;
+
     // Whether to estimate the focal length in absolute pose estimation.
     bool abs_pose_refine_focal_length = true;
 
@@ -141,6 +162,25 @@ class IncrementalMapper {
     size_t num_adjusted_observations = 0;
   };
 
+  // The state of the mapper besides the reconstructions, which is needed to
+  // resume an interrupted reconstruction, e.g., from a checkpoint.
+  struct State {
+    // The number of reconstructions in which images are registered, excluding
+    // the registrations in the current reconstruction.
+    std::unordered_map<image_t, size_t> num_registrations;
+
+    // Images and image pairs that have been used for initialization.
+    std::unordered_map<image_t, size_t> init_num_reg_trials;
+    std::unordered_set<image_pair_t> init_image_pairs;
+
+    // The images that have been filtered, the number of registration trials,
+    // and the initially registered images of the current reconstruction,
+    // which are empty if no reconstruction is active.
+    std::unordered_set<image_t> filtered_images;
+    std::unordered_map<image_t, size_t> num_reg_trials;
+    std::unordered_set<image_t> existing_image_ids;
+  };
+
   // Create incremental mapper. The database cache must live for the entire
   // life-time of the incremental mapper.
   explicit IncrementalMapper(const DatabaseCache* database_cache);
@@ -155,6 +195,13 @@ class IncrementalMapper {
   // be updated accordingly.
   void EndReconstruction(const bool discard);
 
+  // Make the images and image pairs that were added to the database cache by
+  // `DatabaseCache::Update` available to the current reconstruction. Images
+  // with new correspondences can again be tried for registration.
+  void LoadDatabaseCacheUpdate(
+      const std::vector<image_t>& new_image_ids,
+      const std::vector<image_pair_t>& new_image_pair_ids);
+
   // Find initial image pair to seed the incremental reconstruction. The image
   // pairs should be passed to `RegisterInitialImagePair`. This function
   // automatically ignores image pairs that failed to register previously.
@@ -163,7 +210,9 @@ class IncrementalMapper {
 
   // Find best next image to register in the incremental reconstruction. The
   // images should be passed to `RegisterNextImage`. This function automatically
-  // ignores images that failed to registered for `max_reg_trials`.
+  // ignores images that failed to registered for `max_reg_trials`. The ranking
+  // is cached and only updated for images whose visibility, registration, or
+  // filtering status changed since the previous call.
   std::vector<image_t> FindNextImages(const Options& options);
 
   // Attempt to seed the reconstruction from an image pair.
@@ -174,6 +223,32 @@ class IncrementalMapper {
   // a previous call to `RegisterInitialImagePair` was successful.
   bool RegisterNextImage(const Options& options, const image_t image_id);
 
+  // Attempt to register multiple images to the existing model. The absolute
+  // poses of all images are estimated in parallel against the same state of
+  // the model and are then committed in the given order. Images of a camera
+  // whose intrinsics were refined by a previously committed image are not
+  // registered, since their poses were estimated with outdated intrinsics,
+  // and they can be registered in a later call. Returns the registered images.
+  std::vector<image_t> RegisterNextImages(
+      const Options& options, const std::vector<image_t>& image_ids);
+
+  // Set the camera rigs whose snapshots are registered jointly by
+  // `RegisterNextSnapshot`. The snapshots may contain unregistered images of
+  // the current reconstruction and the relative poses of the rig cameras are
+  // estimated from the registered snapshots. The rigs are reset at the end of
+  // the reconstruction.
+  void SetCameraRigs(const std::vector<CameraRig>& camera_rigs);
+
+  // Attempt to register the snapshot of the given image with a generalized
+  // absolute pose, which is estimated from the 2D-3D correspondences of all
+  // unregistered images in the snapshot. This requires that every camera of
+  // the rig was registered in a completely registered snapshot to estimate the
+  // relative poses in the rig. Returns the registered images of the snapshot,
+  // which is empty if the image is not part of a rig or the registration
+  // failed, in which case the image can still be registered individually.
+  std::vector<image_t> RegisterNextSnapshot(const Options& options,
+                                            const image_t image_id);
+
   // Triangulate observations of image.
   size_t TriangulateImage(const IncrementalTriangulator::Options& tri_options,
                           const image_t image_id);
@@ -206,12 +281,32 @@ class IncrementalMapper {
       const IncrementalTriangulator::Options& tri_options,
       const image_t image_id, const std::unordered_set<point3D_t>& point3D_ids);
 
+  // Adjust the local bundles of multiple reference images, e.g., after batch
+  // registration, and refine the provided 3D points in the local bundles
+  // observing them. Local bundles that do not overlap, as determined by their
+  // `BundleAdjustmentAccessSet`, are adjusted concurrently, while overlapping
+  // local bundles are adjusted in subsequent waves.
+  LocalBundleAdjustmentReport AdjustLocalBundles(
+      const Options& options, const BundleAdjustmentOptions& ba_options,
+      const IncrementalTriangulator::Options& tri_options,
+      const std::vector<image_t>& image_ids,
+      const std::unordered_set<point3D_t>& point3D_ids);
+
+  // Adjust the registered images of the snapshot of the given image as a rigid
+  // camera rig with fixed relative poses, together with their 3D points. The
+  // other images observing these points are kept constant.
+  bool AdjustSnapshotBundle(const BundleAdjustmentOptions& ba_options,
+                            const image_t image_id);
+
   // Global bundle adjustment using Ceres Solver or PBA.
   bool AdjustGlobalBundle(const Options& options,
                           const BundleAdjustmentOptions& ba_options);
   bool AdjustParallelGlobalBundle(
       const BundleAdjustmentOptions& ba_options,
       const ParallelBundleAdjuster::Options& parallel_ba_options);
+  bool AdjustPartitionedGlobalBundle(
+      const Options& options, const BundleAdjustmentOptions& ba_options,
+      const PartitionedBundleAdjuster::Options& partitioned_ba_options);
 
   // Filter images and point observations.
   size_t FilterImages(const Options& options);
@@ -219,6 +314,16 @@ class IncrementalMapper {
 
   const Reconstruction& GetReconstruction() const;
 
+  // Get the state of the mapper, which can be restored with `SetState`.
+  State GetState() const;
+
+  // Restore the state of the mapper. If a reconstruction is active, its
+  // registered images are counted in addition to the given registrations,
+  // so that the state must be restored after `BeginReconstruction` with the
+  // resumed reconstruction. Otherwise, the state of the current
+  // reconstruction is reset by the next `BeginReconstruction`.
+  void SetState(const State& state);
+
   // Number of images that are registered in at least on reconstruction.
   size_t NumTotalRegImages() const;
 
@@ -236,14 +341,14 @@ class IncrementalMapper {
   // Find seed images for incremental reconstruction. Suitable seed images have
   // a large number of correspondences and have camera calibration priors. The
   // returned list is ordered such that most suitable images are in the front.
-  std::vector<image_t> FindFirstInitialImage(const Options& options) const;
+  std::vector<image_t> FindFirstInitialImage(const Options& options);
 
   // For a given first seed image, find other images that are connected to the
   // first image. Suitable second images have a large number of correspondences
   // to the first image and have camera calibration priors. The returned list is
   // ordered such that most suitable images are in the front.
   std::vector<image_t> FindSecondInitialImage(const Options& options,
-                                              const image_t image_id1) const;
+                                              const image_t image_id1);
 
   // Find local bundle for given image in the reconstruction. The local bundle
   // is defined as the images that are most connected, i.e. maximum number of
@@ -251,15 +356,76 @@ class IncrementalMapper {
   std::vector<image_t> FindLocalBundle(const Options& options,
                                        const image_t image_id) const;
 
+  // Configure the bundle adjustment of the local bundle of an image without
+  // any variable 3D points.
+  BundleAdjustmentConfig ConfigureLocalBundle(
+      const Options& options, const image_t image_id,
+      const std::vector<image_t>& local_bundle) const;
+
+  // Whether a modified 3D point should be refined in local bundle adjustment.
+  bool IsLocalBundlePoint(const point3D_t point3D_id) const;
+
   // Register / De-register image in current reconstruction and update
   // the number of shared images between all reconstructions.
   void RegisterImageEvent(const image_t image_id);
   void DeRegisterImageEvent(const image_t image_id);
 
+  // Estimate the two-view geometry of an initial image pair without caching.
+  TwoViewGeometry EstimateTwoViewGeometry(const Options& options,
+                                          const image_t image_id1,
+                                          const image_t image_id2) const;
+
+  // Estimate or look up the cached two-view geometry of an initial image pair
+  // and check whether it satisfies the initialization criteria.
   bool EstimateInitialTwoViewGeometry(const Options& options,
                                       const image_t image_id1,
                                       const image_t image_id2);
 
+  // Estimate the two-view geometries of the candidate initial image pairs in
+  // parallel and select the pair with most inliers among the candidates that
+  // satisfy the initialization criteria. The candidates are cleared.
+  bool SelectInitialImagePair(
+      const Options& options,
+      std::vector<std::pair<image_t, image_t>>* candidate_pairs,
+      ThreadPool* thread_pool, image_t* image_id1, image_t* image_id2);
+
+  // Absolute pose of a next image estimated against the current model.
+  struct NextImagePose {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    Eigen::Vector4d qvec;
+    Eigen::Vector3d tvec;
+    Camera camera;
+
+    // Whether the previously refined camera parameters were bogus and reset
+    // to the parameters in the database before the estimation.
+    bool reset_camera_params = false;
+
+    // Whether the estimation changed the camera parameters.
+    bool modified_camera_params = false;
+
+    // The 2D-3D correspondences and the inlier mask of the estimation.
+    std::vector<std::pair<point2D_t, point3D_t>> tri_corrs;
+    std::vector<char> inlier_mask;
+  };
+
+  // Find the 2D-3D correspondences of a next image to the current model.
+  void FindNextImageCorrespondences(
+      const Options& options, const image_t image_id,
+      std::vector<std::pair<point2D_t, point3D_t>>* tri_corrs,
+      std::vector<Eigen::Vector2d>* tri_points2D,
+      std::vector<Eigen::Vector3d>* tri_points3D) const;
+
+  // Estimate the absolute pose of a next image without modifying the model.
+  bool EstimateNextImagePose(const Options& options, const image_t image_id,
+                             NextImagePose* pose) const;
+
+  // Register a next image with its estimated pose and continue its tracks.
+  void CommitNextImagePose(const image_t image_id, const NextImagePose& pose);
+
+  // Update the rank of an image in the cached next image ranking.
+  void UpdateNextImageRank(const Options& options, const image_t image_id);
+
   // Class that holds all necessary data from database in memory.
   const DatabaseCache* database_cache_;
 
@@ -269,6 +435,16 @@ class IncrementalMapper {
   // Class that is responsible for incremental triangulation.
   std::unique_ptr<IncrementalTriangulator> triangulator_;
 
+  // Class that keeps the local bundle adjustment problem between calls to
+  // `AdjustLocalBundle`. Created with the bundle adjustment options of the
+  // first call, which must stay the same for the current reconstruction.
+  std::unique_ptr<PersistentBundleAdjuster> local_bundle_adjuster_;
+
+  // Class that keeps the global bundle adjustment problem between calls to
+  // `AdjustGlobalBundle`, so that the iterations of the global refinement only
+  // update the residuals of changed observations.
+  std::unique_ptr<PersistentBundleAdjuster> global_bundle_adjuster_;
+
   // Number of images that are registered in at least on reconstruction.
   size_t num_total_reg_images_;
 
@@ -276,10 +452,25 @@ class IncrementalMapper {
   // previous reconstructions.
   size_t num_shared_reg_images_;
 
-  // Estimated two-view geometry of last call to `FindFirstInitialImage`,
-  // used as a cache for a subsequent call to `RegisterInitialImagePair`.
-  image_pair_t prev_init_image_pair_id_;
-  TwoViewGeometry prev_init_two_view_geometry_;
+  // Estimated two-view geometries of the tried initial image pairs, used as
+  // a cache for subsequent calls to `RegisterInitialImagePair` and for the
+  // repeated initialization trials of the images, also in later
+  // reconstructions. The initialization criteria are checked on every lookup,
+  // while the geometries are only valid for the error threshold with which
+  // they were estimated.
+  double init_two_view_max_error_;
+  std::unordered_map<image_pair_t, TwoViewGeometry> init_two_view_geometries_;
+
+  // The ranking of the candidates for the first initial image and, for each
+  // first initial image, the ranking of the candidates for the second initial
+  // image with their number of correspondences. The rankings only depend on
+  // the database cache, so that they are computed once and only filtered by
+  // the current registration state, instead of re-scanning all images and
+  // correspondences for every reconstruction.
+  bool init_image_ranking_valid_;
+  std::vector<image_t> init_image_ranking_;
+  std::unordered_map<image_t, std::vector<std::pair<image_t, point2D_t>>>
+      init_image_pair_rankings_;
 
   // Images and image pairs that have been used for initialization. Each image
   // and image pair is only tried once for initialization.
@@ -306,6 +497,38 @@ class IncrementalMapper {
   // This image list will be non-empty, if the reconstruction is continued from
   // an existing reconstruction.
   std::unordered_set<image_t> existing_image_ids_;
+
+  // The camera rigs of `SetCameraRigs` and the rig and snapshot index of each
+  // of their images.
+  std::vector<CameraRig> camera_rigs_;
+  std::unordered_map<image_t, std::pair<size_t, size_t>> image_to_snapshot_;
+
+  // Cached ranking of the next images to register in `FindNextImages`.
+  struct NextImageRanking {
+    typedef std::set<std::pair<float, image_t>,
+                     std::greater<std::pair<float, image_t>>>
+        Bucket;
+
+    // Whether the ranking was computed for the current reconstruction and
+    // the options below.
+    bool valid = false;
+    Options::ImageSelectionMethod image_selection_method =
+        Options::ImageSelectionMethod::MIN_UNCERTAINTY;
+    int abs_pose_min_num_inliers = 0;
+    int max_reg_trials = 0;
+
+    // Images that have not been filtered or tried before, ordered by
+    // decreasing rank, followed by all other images.
+    Bucket buckets[2];
+
+    // The bucket and rank of all ranked images.
+    std::unordered_map<image_t, std::pair<int, float>> entries;
+
+    // Images whose number of registration trials or filtering status changed.
+    std::unordered_set<image_t> modified_image_ids;
+  };
+
+  NextImageRanking next_image_ranking_;
 };
 
 }  // namespace colmap
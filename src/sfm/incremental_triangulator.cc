@@ -34,8 +34,36 @@
 #include "base/projection.h"
 #include "estimators/triangulation.h"
 #include "util/misc.h"
+#include "util/random.h"
+#include "util/threading.h"
 
 namespace colmap {
+namespace {
+
+// The minimum number of items to evaluate in parallel. For fewer items, the
+// overhead of the thread pool outweighs the parallel speedup.
+const size_t kMinNumParallelItems = 256;
+
+// Evaluate the function for all items in parallel. The items are processed in
+// fixed-size chunks with chunk-specific PRNG streams, such that randomized
+// estimations are deterministic and independent of the number of threads.
+void ParallelEvaluate(const int num_threads, const size_t num_items,
+                      const size_t chunk_size,
+                      const std::function<void(const size_t)>& func) {
+  ThreadPool thread_pool(num_threads);
+  for (size_t begin = 0; begin < num_items; begin += chunk_size) {
+    const size_t end = std::min(begin + chunk_size, num_items);
+    thread_pool.AddTask([&func, begin, end, chunk_size]() {
+      ScopedPRNGStream prng_stream(begin / chunk_size);
+      for (size_t i = begin; i < end; ++i) {
+        func(i);
+      }
+    });
+  }
+  thread_pool.Wait();
+}
+
+}  // namespace
 
 bool IncrementalTriangulator::Options::Check() const {
   CHECK_OPTION_GE(max_transitivity, 0);
@@ -64,7 +92,7 @@ size_t IncrementalTriangulator::TriangulateImage(const Options& options,
 
   size_t num_tris = 0;
 
-  ClearCaches();
+  ClearCaches(options);
 
   const Image& image = reconstruction_->Image(image_id);
   if (!image.IsRegistered()) {
@@ -87,6 +115,61 @@ size_t IncrementalTriangulator::TriangulateImage(const Options& options,
   // Container for correspondences from reference observation to other images.
   std::vector<CorrData> corrs_data;
 
+  // Estimate the new triangulations of all observations in parallel against
+  // the current reconstruction, which are then verified and committed below.
+  std::vector<CreateProposal> proposals;
+  // The randomized estimations of the proposals use chunk-specific PRNG
+  // streams, so they are also used with one thread in the deterministic mode.
+  const int num_threads = GetEffectiveNumThreads(options.num_threads);
+  if ((num_threads > 1 || kDeterministic) &&
+      image.NumPoints2D() >= kMinNumParallelItems) {
+    const size_t kChunkSize = 64;
+
+    std::vector<std::vector<CorrData>> proposal_corrs_data(
+        image.NumPoints2D());
+    ParallelEvaluate(
+        num_threads, image.NumPoints2D(), kChunkSize,
+        [&](const size_t point2D_idx) {
+          std::vector<CorrData>& point_corrs_data =
+              proposal_corrs_data[point2D_idx];
+          const size_t num_triangulated = Find(
+              options, image_id, point2D_idx,
+              static_cast<size_t>(options.max_transitivity), &point_corrs_data);
+          if (point_corrs_data.empty()) {
+            return;
+          }
+
+          CorrData point_ref_corr_data = ref_corr_data;
+          point_ref_corr_data.point2D_idx = point2D_idx;
+
+          // The reference observation is not part of the new points, if it
+          // continues one of the existing points.
+          if (num_triangulated == 0 ||
+              FindContinuation(options, point_ref_corr_data,
+                               point_corrs_data) ==
+                  std::numeric_limits<size_t>::max()) {
+            point_corrs_data.push_back(point_ref_corr_data);
+          }
+        });
+
+    // Triangulate the observations of each chunk in one batch.
+    proposals.resize(image.NumPoints2D());
+    const size_t num_chunks =
+        (image.NumPoints2D() + kChunkSize - 1) / kChunkSize;
+    ParallelEvaluate(num_threads, num_chunks, 1, [&](const size_t chunk_idx) {
+      const size_t begin = chunk_idx * kChunkSize;
+      const size_t end =
+          std::min<size_t>(begin + kChunkSize, image.NumPoints2D());
+      std::vector<std::vector<CorrData>> chunk_corrs_data(
+          std::make_move_iterator(proposal_corrs_data.begin() + begin),
+          std::make_move_iterator(proposal_corrs_data.begin() + end));
+      std::vector<CreateProposal> chunk_proposals;
+      ProposeCreates(options, chunk_corrs_data, &chunk_proposals);
+      std::move(chunk_proposals.begin(), chunk_proposals.end(),
+                proposals.begin() + begin);
+    });
+  }
+
   // Try to triangulate all image observations.
   for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
        ++point2D_idx) {
@@ -97,19 +180,20 @@ size_t IncrementalTriangulator::TriangulateImage(const Options& options,
       continue;
     }
 
-    const Point2D& point2D = image.Point2D(point2D_idx);
     ref_corr_data.point2D_idx = point2D_idx;
-    ref_corr_data.point2D = &point2D;
+
+    const CreateProposal* proposal =
+        proposals.empty() ? nullptr : &proposals[point2D_idx];
 
     if (num_triangulated == 0) {
       corrs_data.push_back(ref_corr_data);
-      num_tris += Create(options, corrs_data);
+      num_tris += Create(options, corrs_data, proposal);
     } else {
       // Continue correspondences to existing 3D points.
       num_tris += Continue(options, ref_corr_data, corrs_data);
       // Create points from correspondences that are not continued.
       corrs_data.push_back(ref_corr_data);
-      num_tris += Create(options, corrs_data);
+      num_tris += Create(options, corrs_data, proposal);
     }
   }
 
@@ -122,7 +206,7 @@ size_t IncrementalTriangulator::CompleteImage(const Options& options,
 
   size_t num_tris = 0;
 
-  ClearCaches();
+  ClearCaches(options);
 
   const Image& image = reconstruction_->Image(image_id);
   if (!image.IsRegistered()) {
@@ -176,7 +260,6 @@ size_t IncrementalTriangulator::CompleteImage(const Options& options,
       continue;
     }
 
-    ref_corr_data.point2D = &point2D;
     ref_corr_data.point2D_idx = point2D_idx;
     corrs_data.push_back(ref_corr_data);
 
@@ -187,7 +270,7 @@ size_t IncrementalTriangulator::CompleteImage(const Options& options,
     pose_data.resize(corrs_data.size());
     for (size_t i = 0; i < corrs_data.size(); ++i) {
       const CorrData& corr_data = corrs_data[i];
-      point_data[i].point = corr_data.point2D->XY();
+      point_data[i].point = corr_data.image->Point2DXY(corr_data.point2D_idx);
       point_data[i].point_normalized =
           corr_data.camera->ImageToWorld(point_data[i].point);
       pose_data[i].proj_matrix = corr_data.image->ProjectionMatrix();
@@ -232,58 +315,44 @@ size_t IncrementalTriangulator::CompleteTracks(
     const Options& options, const std::unordered_set<point3D_t>& point3D_ids) {
   CHECK(options.Check());
 
-  size_t num_completed = 0;
-
-  ClearCaches();
+  ClearCaches(options);
 
-  for (const point3D_t point3D_id : point3D_ids) {
-    num_completed += Complete(options, point3D_id);
-  }
-
-  return num_completed;
+  return CompleteTracks(
+      options, std::vector<point3D_t>(point3D_ids.begin(), point3D_ids.end()));
 }
 
 size_t IncrementalTriangulator::CompleteAllTracks(const Options& options) {
   CHECK(options.Check());
 
-  size_t num_completed = 0;
-
-  ClearCaches();
+  ClearCaches(options);
 
-  for (const point3D_t point3D_id : reconstruction_->Point3DIds()) {
-    num_completed += Complete(options, point3D_id);
-  }
+  const std::unordered_set<point3D_t> point3D_ids =
+      reconstruction_->Point3DIds();
 
-  return num_completed;
+  return CompleteTracks(
+      options, std::vector<point3D_t>(point3D_ids.begin(), point3D_ids.end()));
 }
 
 size_t IncrementalTriangulator::MergeTracks(
     const Options& options, const std::unordered_set<point3D_t>& point3D_ids) {
   CHECK(options.Check());
 
-  size_t num_merged = 0;
+  ClearCaches(options);
 
-  ClearCaches();
-
-  for (const point3D_t point3D_id : point3D_ids) {
-    num_merged += Merge(options, point3D_id);
-  }
-
-  return num_merged;
+  return MergeTracks(
+      options, std::vector<point3D_t>(point3D_ids.begin(), point3D_ids.end()));
 }
 
 size_t IncrementalTriangulator::MergeAllTracks(const Options& options) {
   CHECK(options.Check());
 
-  size_t num_merged = 0;
+  ClearCaches(options);
 
-  ClearCaches();
+  const std::unordered_set<point3D_t> point3D_ids =
+      reconstruction_->Point3DIds();
 
-  for (const point3D_t point3D_id : reconstruction_->Point3DIds()) {
-    num_merged += Merge(options, point3D_id);
-  }
-
-  return num_merged;
+  return MergeTracks(
+      options, std::vector<point3D_t>(point3D_ids.begin(), point3D_ids.end()));
 }
 
 size_t IncrementalTriangulator::Retriangulate(const Options& options) {
@@ -291,11 +360,92 @@ size_t IncrementalTriangulator::Retriangulate(const Options& options) {
 
   size_t num_tris = 0;
 
-  ClearCaches();
+  ClearCaches(options);
 
   Options re_options = options;
   re_options.continue_max_angle_error = options.re_max_angle_error;
 
+  // Estimate the new triangulations of all currently under-reconstructed image
+  // pairs in parallel, which are then verified and committed below.
+  std::unordered_map<image_pair_t, std::vector<CreateProposal>> proposals;
+  const int num_threads = GetEffectiveNumThreads(options.num_threads);
+  if (num_threads > 1 || kDeterministic) {
+    std::vector<image_pair_t> pair_ids;
+    for (const auto& image_pair : reconstruction_->ImagePairs()) {
+      const double tri_ratio =
+          static_cast<double>(image_pair.second.num_tri_corrs) /
+          static_cast<double>(image_pair.second.num_total_corrs);
+      if (tri_ratio >= options.re_min_ratio) {
+        continue;
+      }
+
+      const auto num_re_trials_it = re_num_trials_.find(image_pair.first);
+      if (num_re_trials_it != re_num_trials_.end() &&
+          num_re_trials_it->second >= options.re_max_trials) {
+        continue;
+      }
+
+      image_t image_id1;
+      image_t image_id2;
+      Database::PairIdToImagePair(image_pair.first, &image_id1, &image_id2);
+      if (reconstruction_->IsImageRegistered(image_id1) &&
+          reconstruction_->IsImageRegistered(image_id2)) {
+        pair_ids.push_back(image_pair.first);
+      }
+    }
+
+    std::vector<std::vector<CreateProposal>*> pair_proposals;
+    pair_proposals.reserve(pair_ids.size());
+    for (const image_pair_t pair_id : pair_ids) {
+      pair_proposals.push_back(&proposals[pair_id]);
+    }
+
+    const size_t kChunkSize = 1;
+    ParallelEvaluate(
+        num_threads, pair_ids.size(), kChunkSize, [&](const size_t i) {
+          image_t image_id1;
+          image_t image_id2;
+          Database::PairIdToImagePair(pair_ids[i], &image_id1, &image_id2);
+
+          const Image& image1 = reconstruction_->Image(image_id1);
+          const Image& image2 = reconstruction_->Image(image_id2);
+          const Camera& camera1 = reconstruction_->Camera(image1.CameraId());
+          const Camera& camera2 = reconstruction_->Camera(image2.CameraId());
+          if (HasCameraBogusParams(options, camera1) ||
+              HasCameraBogusParams(options, camera2)) {
+            return;
+          }
+
+          const FeatureMatches& corrs =
+              correspondence_graph_->FindCorrespondencesBetweenImages(
+                  image_id1, image_id2);
+
+          std::vector<CreateProposal>& corr_proposals = *pair_proposals[i];
+          corr_proposals.resize(corrs.size());
+
+          std::vector<CorrData> corrs_data(2);
+          corrs_data[0].image_id = image_id1;
+          corrs_data[0].image = &image1;
+          corrs_data[0].camera = &camera1;
+          corrs_data[1].image_id = image_id2;
+          corrs_data[1].image = &image2;
+          corrs_data[1].camera = &camera2;
+
+          for (size_t j = 0; j < corrs.size(); ++j) {
+            const Point2D& point2D1 = image1.Point2D(corrs[j].point2D_idx1);
+            const Point2D& point2D2 = image2.Point2D(corrs[j].point2D_idx2);
+            if (point2D1.HasPoint3D() || point2D2.HasPoint3D()) {
+              continue;
+            }
+
+            corrs_data[0].point2D_idx = corrs[j].point2D_idx1;
+            corrs_data[1].point2D_idx = corrs[j].point2D_idx2;
+
+            ProposeCreate(options, corrs_data, &corr_proposals[j]);
+          }
+        });
+  }
+
   for (const auto& image_pair : reconstruction_->ImagePairs()) {
     // Only perform retriangulation for under-reconstructed image pairs.
     const double tri_ratio =
@@ -342,7 +492,14 @@ size_t IncrementalTriangulator::Retriangulate(const Options& options) {
         correspondence_graph_->FindCorrespondencesBetweenImages(image_id1,
                                                                 image_id2);
 
-    for (const auto& corr : corrs) {
+    const auto proposals_it = proposals.find(image_pair.first);
+    const std::vector<CreateProposal>* corr_proposals =
+        (proposals_it == proposals.end() || proposals_it->second.empty())
+            ? nullptr
+            : &proposals_it->second;
+
+    for (size_t corr_idx = 0; corr_idx < corrs.size(); ++corr_idx) {
+      const FeatureMatch& corr = corrs[corr_idx];
       const Point2D& point2D1 = image1.Point2D(corr.point2D_idx1);
       const Point2D& point2D2 = image2.Point2D(corr.point2D_idx2);
 
@@ -360,14 +517,12 @@ size_t IncrementalTriangulator::Retriangulate(const Options& options) {
       corr_data1.point2D_idx = corr.point2D_idx1;
       corr_data1.image = &image1;
       corr_data1.camera = &camera1;
-      corr_data1.point2D = &point2D1;
 
       CorrData corr_data2;
       corr_data2.image_id = image_id2;
       corr_data2.point2D_idx = corr.point2D_idx2;
       corr_data2.image = &image2;
       corr_data2.camera = &camera2;
-      corr_data2.point2D = &point2D2;
 
       if (point2D1.HasPoint3D() && !point2D2.HasPoint3D()) {
         const std::vector<CorrData> corrs_data1 = {corr_data1};
@@ -379,7 +534,9 @@ size_t IncrementalTriangulator::Retriangulate(const Options& options) {
         const std::vector<CorrData> corrs_data = {corr_data1, corr_data2};
         // Do not use larger triangulation threshold as this causes
         // significant drift when creating points (options vs. re_options).
-        num_tris += Create(options, corrs_data);
+        num_tris += Create(
+            options, corrs_data,
+            corr_proposals == nullptr ? nullptr : &(*corr_proposals)[corr_idx]);
       }
       // Else both points have a 3D point, but we do not want to
       // merge points in retriangulation.
@@ -411,16 +568,26 @@ void IncrementalTriangulator::ClearModifiedPoints3D() {
   modified_point3D_ids_.clear();
 }
 
-void IncrementalTriangulator::ClearCaches() {
+void IncrementalTriangulator::ClearCaches(const Options& options) {
   camera_has_bogus_params_.clear();
   merge_trials_.clear();
+
+  // Cache the bogus camera parameters upfront, such that the cache can be
+  // safely accessed from multiple threads during parallel evaluation.
+  for (const auto& camera : reconstruction_->Cameras()) {
+    camera_has_bogus_params_.emplace(
+        camera.first, camera.second.HasBogusParams(
+                          options.min_focal_length_ratio,
+                          options.max_focal_length_ratio,
+                          options.max_extra_param));
+  }
 }
 
 size_t IncrementalTriangulator::Find(const Options& options,
                                      const image_t image_id,
                                      const point2D_t point2D_idx,
                                      const size_t transitivity,
-                                     std::vector<CorrData>* corrs_data) {
+                                     std::vector<CorrData>* corrs_data) const {
   const std::vector<CorrespondenceGraph::Correspondence>& corrs =
       correspondence_graph_->FindTransitiveCorrespondences(
           image_id, point2D_idx, transitivity);
@@ -431,6 +598,12 @@ size_t IncrementalTriangulator::Find(const Options& options,
   size_t num_triangulated = 0;
 
   for (const CorrespondenceGraph::Correspondence corr : corrs) {
+    // Images of the correspondence graph that are not part of the
+    // reconstruction, e.g. outside of a tile in tiled triangulation, are
+    // treated as not registered.
+    if (!reconstruction_->ExistsImage(corr.image_id)) {
+      continue;
+    }
     const Image& corr_image = reconstruction_->Image(corr.image_id);
     if (!corr_image.IsRegistered()) {
       continue;
@@ -446,11 +619,10 @@ size_t IncrementalTriangulator::Find(const Options& options,
     corr_data.point2D_idx = corr.point2D_idx;
     corr_data.image = &corr_image;
     corr_data.camera = &corr_camera;
-    corr_data.point2D = &corr_image.Point2D(corr.point2D_idx);
 
     corrs_data->push_back(corr_data);
 
-    if (corr_data.point2D->HasPoint3D()) {
+    if (corr_data.image->Point2DHasPoint3D(corr_data.point2D_idx)) {
       num_triangulated += 1;
     }
   }
@@ -458,41 +630,32 @@ size_t IncrementalTriangulator::Find(const Options& options,
   return num_triangulated;
 }
 
-size_t IncrementalTriangulator::Create(
-    const Options& options, const std::vector<CorrData>& corrs_data) {
-  // Extract correspondences without an existing triangulated observation.
-  std::vector<CorrData> create_corrs_data;
-  create_corrs_data.reserve(corrs_data.size());
-  for (const CorrData& corr_data : corrs_data) {
-    if (!corr_data.point2D->HasPoint3D()) {
-      create_corrs_data.push_back(corr_data);
-    }
-  }
+void IncrementalTriangulator::ProposeCreate(
+    const Options& options, const std::vector<CorrData>& corrs_data,
+    CreateProposal* proposal) const {
+  std::vector<CreateProposal> proposals;
+  ProposeCreates(options, {corrs_data}, &proposals);
+  *proposal = std::move(proposals[0]);
+}
 
-  if (create_corrs_data.size() < 2) {
-    // Need at least two observations for triangulation.
-    return 0;
-  } else if (options.ignore_two_view_tracks && create_corrs_data.size() == 2) {
-    const CorrData& corr_data1 = create_corrs_data[0];
-    if (correspondence_graph_->IsTwoViewObservation(corr_data1.image_id,
-                                                    corr_data1.point2D_idx)) {
-      return 0;
-    }
-  }
+void IncrementalTriangulator::ProposeCreates(
+    const Options& options,
+    const std::vector<std::vector<CorrData>>& corrs_data,
+    std::vector<CreateProposal>* proposals) const {
+  proposals->clear();
+  proposals->resize(corrs_data.size());
 
-  // Setup data for triangulation estimation.
-  std::vector<TriangulationEstimator::PointData> point_data;
-  point_data.resize(create_corrs_data.size());
-  std::vector<TriangulationEstimator::PoseData> pose_data;
-  pose_data.resize(create_corrs_data.size());
-  for (size_t i = 0; i < create_corrs_data.size(); ++i) {
-    const CorrData& corr_data = create_corrs_data[i];
-    point_data[i].point = corr_data.point2D->XY();
-    point_data[i].point_normalized =
-        corr_data.camera->ImageToWorld(point_data[i].point);
-    pose_data[i].proj_matrix = corr_data.image->ProjectionMatrix();
-    pose_data[i].proj_center = corr_data.image->ProjectionCenter();
-    pose_data[i].camera = corr_data.camera;
+  // Extract correspondences without an existing triangulated observation.
+  std::vector<std::vector<CorrData>> create_corrs_data(corrs_data.size());
+  for (size_t i = 0; i < corrs_data.size(); ++i) {
+    create_corrs_data[i].reserve(corrs_data[i].size());
+    for (const CorrData& corr_data : corrs_data[i]) {
+      if (!corr_data.image->Point2DHasPoint3D(corr_data.point2D_idx)) {
+        create_corrs_data[i].push_back(corr_data);
+        (*proposals)[i].corrs.emplace_back(corr_data.image_id,
+                                           corr_data.point2D_idx);
+      }
+    }
   }
 
   // Setup estimation options.
@@ -506,48 +669,139 @@ size_t IncrementalTriangulator::Create(
   tri_options.ransac_options.min_inlier_ratio = 0.02;
   tri_options.ransac_options.max_num_trials = 10000;
 
-  // Enforce exhaustive sampling for small track lengths.
-  const size_t kExhaustiveSamplingThreshold = 15;
-  if (point_data.size() <= kExhaustiveSamplingThreshold) {
-    tri_options.ransac_options.min_num_trials = NChooseK(point_data.size(), 2);
-  }
+  // Recursively create points from the outliers of the previous points, where
+  // the tracks of all correspondence sets are estimated in one batch.
+  TriangulationBatch batch;
+  std::vector<size_t> batch_corrs_idxs;
+  std::vector<char> success;
+  std::vector<Eigen::Vector3d> xyzs;
+  std::vector<char> inlier_masks;
+  std::vector<CorrData> outlier_corrs_data;
+  while (true) {
+    batch.Clear();
+    batch_corrs_idxs.clear();
+    for (size_t i = 0; i < create_corrs_data.size(); ++i) {
+      const std::vector<CorrData>& track_corrs_data = create_corrs_data[i];
+      if (track_corrs_data.size() < 2) {
+        // Need at least two observations for triangulation.
+        continue;
+      } else if (options.ignore_two_view_tracks &&
+                 track_corrs_data.size() == 2) {
+        const CorrData& corr_data1 = track_corrs_data[0];
+        if (correspondence_graph_->IsTwoViewObservation(
+                corr_data1.image_id, corr_data1.point2D_idx)) {
+          continue;
+        }
+      }
 
-  // Estimate triangulation.
-  Eigen::Vector3d xyz;
-  std::vector<char> inlier_mask;
-  if (!EstimateTriangulation(tri_options, point_data, pose_data, &inlier_mask,
-                             &xyz)) {
-    return 0;
+      // Setup data for triangulation estimation.
+      for (const CorrData& corr_data : track_corrs_data) {
+        TriangulationEstimator::PointData point_data;
+        point_data.point = corr_data.image->Point2DXY(corr_data.point2D_idx);
+        point_data.point_normalized =
+            corr_data.camera->ImageToWorld(point_data.point);
+        batch.point_data.push_back(point_data);
+        batch.pose_data.emplace_back(corr_data.image->ProjectionMatrix(),
+                                     corr_data.image->ProjectionCenter(),
+                                     corr_data.camera);
+      }
+      batch.FinishTrack();
+      batch_corrs_idxs.push_back(i);
+    }
+
+    if (batch_corrs_idxs.empty()) {
+      return;
+    }
+
+    // Estimate triangulations.
+    EstimateTriangulations(tri_options, batch, &success, &xyzs,
+                           &inlier_masks);
+
+    for (size_t k = 0; k < batch_corrs_idxs.size(); ++k) {
+      std::vector<CorrData>& track_corrs_data =
+          create_corrs_data[batch_corrs_idxs[k]];
+      if (!success[k]) {
+        track_corrs_data.clear();
+        continue;
+      }
+
+      // Add inliers to estimated track.
+      Track track;
+      track.Reserve(track_corrs_data.size());
+      outlier_corrs_data.clear();
+      const size_t offset = batch.track_offsets[k];
+      for (size_t i = 0; i < track_corrs_data.size(); ++i) {
+        const CorrData& corr_data = track_corrs_data[i];
+        if (inlier_masks[offset + i]) {
+          track.AddElement(corr_data.image_id, corr_data.point2D_idx);
+        } else {
+          outlier_corrs_data.push_back(corr_data);
+        }
+      }
+
+      CreateProposal& proposal = (*proposals)[batch_corrs_idxs[k]];
+      proposal.xyzs.push_back(xyzs[k]);
+      proposal.tracks.push_back(track);
+
+      const size_t kMinRecursiveTrackLength = 3;
+      if (outlier_corrs_data.size() < kMinRecursiveTrackLength) {
+        track_corrs_data.clear();
+      } else {
+        track_corrs_data.swap(outlier_corrs_data);
+      }
+    }
   }
+}
 
-  // Add inliers to estimated track.
-  Track track;
-  track.Reserve(create_corrs_data.size());
-  for (size_t i = 0; i < inlier_mask.size(); ++i) {
-    if (inlier_mask[i]) {
-      const CorrData& corr_data = create_corrs_data[i];
-      track.AddElement(corr_data.image_id, corr_data.point2D_idx);
+size_t IncrementalTriangulator::Create(const Options& options,
+                                       const std::vector<CorrData>& corrs_data,
+                                       const CreateProposal* proposal) {
+  // The proposal is only valid, if it was estimated from the same set of
+  // currently not triangulated correspondences.
+  bool valid_proposal = proposal != nullptr;
+  if (valid_proposal) {
+    size_t num_create_corrs = 0;
+    for (const CorrData& corr_data : corrs_data) {
+      if (corr_data.image->Point2DHasPoint3D(corr_data.point2D_idx)) {
+        continue;
+      }
+      if (num_create_corrs >= proposal->corrs.size() ||
+          proposal->corrs[num_create_corrs].image_id != corr_data.image_id ||
+          proposal->corrs[num_create_corrs].point2D_idx !=
+              corr_data.point2D_idx) {
+        valid_proposal = false;
+        break;
+      }
+      num_create_corrs += 1;
     }
+    valid_proposal =
+        valid_proposal && num_create_corrs == proposal->corrs.size();
   }
 
-  // Add estimated point to reconstruction.
-  const point3D_t point3D_id = reconstruction_->AddPoint3D(xyz, track);
-  modified_point3D_ids_.insert(point3D_id);
+  CreateProposal new_proposal;
+  if (!valid_proposal) {
+    ProposeCreate(options, corrs_data, &new_proposal);
+    proposal = &new_proposal;
+  }
 
-  const size_t kMinRecursiveTrackLength = 3;
-  if (create_corrs_data.size() - track.Length() >= kMinRecursiveTrackLength) {
-    return track.Length() + Create(options, create_corrs_data);
+  // Add estimated points to reconstruction.
+  size_t num_tris = 0;
+  for (size_t i = 0; i < proposal->tracks.size(); ++i) {
+    const point3D_t point3D_id =
+        reconstruction_->AddPoint3D(proposal->xyzs[i], proposal->tracks[i]);
+    modified_point3D_ids_.insert(point3D_id);
+    num_tris += proposal->tracks[i].Length();
   }
 
-  return track.Length();
+  return num_tris;
 }
 
-size_t IncrementalTriangulator::Continue(
+size_t IncrementalTriangulator::FindContinuation(
     const Options& options, const CorrData& ref_corr_data,
-    const std::vector<CorrData>& corrs_data) {
+    const std::vector<CorrData>& corrs_data) const {
   // No need to continue, if the reference observation is triangulated.
-  if (ref_corr_data.point2D->HasPoint3D()) {
-    return 0;
+  if (ref_corr_data.image->Point2DHasPoint3D(ref_corr_data.point2D_idx)) {
+    return std::numeric_limits<size_t>::max();
   }
 
   double best_angle_error = std::numeric_limits<double>::max();
@@ -555,16 +809,17 @@ size_t IncrementalTriangulator::Continue(
 
   for (size_t idx = 0; idx < corrs_data.size(); ++idx) {
     const CorrData& corr_data = corrs_data[idx];
-    if (!corr_data.point2D->HasPoint3D()) {
+    if (!corr_data.image->Point2DHasPoint3D(corr_data.point2D_idx)) {
       continue;
     }
 
-    const Point3D& point3D =
-        reconstruction_->Point3D(corr_data.point2D->Point3DId());
+    const Point3D& point3D = reconstruction_->Point3D(
+        corr_data.image->Point2DPoint3DId(corr_data.point2D_idx));
 
     const double angle_error = CalculateAngularError(
-        ref_corr_data.point2D->XY(), point3D.XYZ(), ref_corr_data.image->Qvec(),
-        ref_corr_data.image->Tvec(), *ref_corr_data.camera);
+        ref_corr_data.image->Point2DXY(ref_corr_data.point2D_idx),
+        point3D.XYZ(), ref_corr_data.image->Qvec(), ref_corr_data.image->Tvec(),
+        *ref_corr_data.camera);
     if (angle_error < best_angle_error) {
       best_angle_error = angle_error;
       best_idx = idx;
@@ -572,17 +827,61 @@ size_t IncrementalTriangulator::Continue(
   }
 
   const double max_angle_error = DegToRad(options.continue_max_angle_error);
-  if (best_angle_error <= max_angle_error &&
-      best_idx != std::numeric_limits<size_t>::max()) {
-    const CorrData& corr_data = corrs_data[best_idx];
-    const TrackElement track_el(ref_corr_data.image_id,
-                                ref_corr_data.point2D_idx);
-    reconstruction_->AddObservation(corr_data.point2D->Point3DId(), track_el);
-    modified_point3D_ids_.insert(corr_data.point2D->Point3DId());
-    return 1;
+  if (best_angle_error <= max_angle_error) {
+    return best_idx;
   }
 
-  return 0;
+  return std::numeric_limits<size_t>::max();
+}
+
+size_t IncrementalTriangulator::Continue(
+    const Options& options, const CorrData& ref_corr_data,
+    const std::vector<CorrData>& corrs_data) {
+  const size_t best_idx = FindContinuation(options, ref_corr_data, corrs_data);
+  if (best_idx == std::numeric_limits<size_t>::max()) {
+    return 0;
+  }
+
+  const CorrData& corr_data = corrs_data[best_idx];
+  const TrackElement track_el(ref_corr_data.image_id,
+                              ref_corr_data.point2D_idx);
+  const point3D_t point3D_id =
+      corr_data.image->Point2DPoint3DId(corr_data.point2D_idx);
+  reconstruction_->AddObservation(point3D_id, track_el);
+  modified_point3D_ids_.insert(point3D_id);
+  return 1;
+}
+
+bool IncrementalTriangulator::HasMergeCandidates(
+    const point3D_t point3D_id) const {
+  if (!reconstruction_->ExistsPoint3D(point3D_id)) {
+    return false;
+  }
+
+  const Point3D& point3D = reconstruction_->Point3D(point3D_id);
+  for (const auto& track_el : point3D.Track().Elements()) {
+    const CorrespondenceGraph::CorrespondenceRange corrs =
+        correspondence_graph_->FindCorrespondences(track_el.image_id,
+                                                   track_el.point2D_idx);
+    for (const auto corr : corrs) {
+      if (!reconstruction_->ExistsImage(corr.image_id)) {
+        continue;
+      }
+      const Image& image = reconstruction_->Image(corr.image_id);
+      if (!image.IsRegistered()) {
+        continue;
+      }
+
+      const point3D_t corr_point3D_id =
+          image.Point2DPoint3DId(corr.point2D_idx);
+      if (corr_point3D_id != kInvalidPoint3DId &&
+          corr_point3D_id != point3D_id) {
+        return true;
+      }
+    }
+  }
+
+  return false;
 }
 
 size_t IncrementalTriangulator::Merge(const Options& options,
@@ -597,11 +896,14 @@ size_t IncrementalTriangulator::Merge(const Options& options,
   const auto& point3D = reconstruction_->Point3D(point3D_id);
 
   for (const auto& track_el : point3D.Track().Elements()) {
-    const std::vector<CorrespondenceGraph::Correspondence>& corrs =
+    const CorrespondenceGraph::CorrespondenceRange corrs =
         correspondence_graph_->FindCorrespondences(track_el.image_id,
                                                    track_el.point2D_idx);
 
     for (const auto corr : corrs) {
+      if (!reconstruction_->ExistsImage(corr.image_id)) {
+        continue;
+      }
       const auto& image = reconstruction_->Image(corr.image_id);
       if (!image.IsRegistered()) {
         continue;
@@ -676,12 +978,41 @@ size_t IncrementalTriangulator::Merge(const Options& options,
   return 0;
 }
 
-size_t IncrementalTriangulator::Complete(const Options& options,
-                                         const point3D_t point3D_id) {
-  size_t num_completed = 0;
+size_t IncrementalTriangulator::MergeTracks(
+    const Options& options, const std::vector<point3D_t>& point3D_ids) {
+  size_t num_merged = 0;
+
+  // Determine the points with merge candidates in parallel. Merging never
+  // creates new candidates for points without candidates, so that the other
+  // points can be safely skipped in the serial merge step.
+  std::vector<char> has_merge_candidates;
+  const int num_threads = GetEffectiveNumThreads(options.num_threads);
+  if (num_threads > 1 && point3D_ids.size() >= kMinNumParallelItems) {
+    const size_t kChunkSize = 256;
+    has_merge_candidates.resize(point3D_ids.size());
+    ParallelEvaluate(num_threads, point3D_ids.size(), kChunkSize,
+                     [&](const size_t i) {
+                       has_merge_candidates[i] =
+                           HasMergeCandidates(point3D_ids[i]);
+                     });
+  }
+
+  for (size_t i = 0; i < point3D_ids.size(); ++i) {
+    if (has_merge_candidates.empty() || has_merge_candidates[i]) {
+      num_merged += Merge(options, point3D_ids[i]);
+    }
+  }
+
+  return num_merged;
+}
+
+void IncrementalTriangulator::ProposeComplete(
+    const Options& options, const point3D_t point3D_id,
+    std::vector<TrackElement>* track_els) const {
+  track_els->clear();
 
   if (!reconstruction_->ExistsPoint3D(point3D_id)) {
-    return num_completed;
+    return;
   }
 
   const double max_squared_reproj_error =
@@ -689,7 +1020,11 @@ size_t IncrementalTriangulator::Complete(const Options& options,
 
   const Point3D& point3D = reconstruction_->Point3D(point3D_id);
 
-  std::vector<TrackElement> queue = point3D.Track().Elements();
+  // Observations that are added to the track by this completion.
+  std::unordered_set<image_pair_t> completed_ids;
+
+  std::vector<TrackElement> queue(point3D.Track().Elements().begin(),
+                                  point3D.Track().Elements().end());
 
   const int max_transitivity = options.complete_max_transitivity;
   for (int transitivity = 0; transitivity < max_transitivity; ++transitivity) {
@@ -701,18 +1036,24 @@ size_t IncrementalTriangulator::Complete(const Options& options,
     queue.clear();
 
     for (const TrackElement queue_elem : prev_queue) {
-      const std::vector<CorrespondenceGraph::Correspondence>& corrs =
+      const CorrespondenceGraph::CorrespondenceRange corrs =
           correspondence_graph_->FindCorrespondences(queue_elem.image_id,
                                                      queue_elem.point2D_idx);
 
       for (const auto corr : corrs) {
+        if (!reconstruction_->ExistsImage(corr.image_id)) {
+          continue;
+        }
         const Image& image = reconstruction_->Image(corr.image_id);
         if (!image.IsRegistered()) {
           continue;
         }
 
         const Point2D& point2D = image.Point2D(corr.point2D_idx);
-        if (point2D.HasPoint3D()) {
+        const image_pair_t completed_id =
+            (static_cast<image_pair_t>(corr.image_id) << 32) +
+            corr.point2D_idx;
+        if (point2D.HasPoint3D() || completed_ids.count(completed_id) > 0) {
           continue;
         }
 
@@ -728,32 +1069,89 @@ size_t IncrementalTriangulator::Complete(const Options& options,
         }
 
         // Success, add observation to point track.
-        const TrackElement track_el(corr.image_id, corr.point2D_idx);
-        reconstruction_->AddObservation(point3D_id, track_el);
-        modified_point3D_ids_.insert(point3D_id);
+        completed_ids.insert(completed_id);
+        track_els->emplace_back(corr.image_id, corr.point2D_idx);
 
         // Recursively complete track for this new correspondence.
         if (transitivity < max_transitivity - 1) {
           queue.emplace_back(corr.image_id, corr.point2D_idx);
         }
+      }
+    }
+  }
+}
+
+size_t IncrementalTriangulator::Complete(
+    const Options& options, const point3D_t point3D_id,
+    const std::vector<TrackElement>* proposal) {
+  if (!reconstruction_->ExistsPoint3D(point3D_id)) {
+    return 0;
+  }
 
-        num_completed += 1;
+  // The proposal is only valid, if none of its observations was triangulated
+  // in the meantime, since the completion would otherwise continue from
+  // different observations.
+  bool valid_proposal = proposal != nullptr;
+  if (valid_proposal) {
+    for (const TrackElement& track_el : *proposal) {
+      if (reconstruction_->Image(track_el.image_id)
+              .Point2D(track_el.point2D_idx)
+              .HasPoint3D()) {
+        valid_proposal = false;
+        break;
       }
     }
   }
 
+  std::vector<TrackElement> new_proposal;
+  if (!valid_proposal) {
+    ProposeComplete(options, point3D_id, &new_proposal);
+    proposal = &new_proposal;
+  }
+
+  for (const TrackElement& track_el : *proposal) {
+    reconstruction_->AddObservation(point3D_id, track_el);
+  }
+
+  if (!proposal->empty()) {
+    modified_point3D_ids_.insert(point3D_id);
+  }
+
+  return proposal->size();
+}
+
+size_t IncrementalTriangulator::CompleteTracks(
+    const Options& options, const std::vector<point3D_t>& point3D_ids) {
+  size_t num_completed = 0;
+
+  // Find the completions of all points in parallel against the current
+  // reconstruction, which are then verified and committed below.
+  std::vector<std::vector<TrackElement>> proposals;
+  const int num_threads = GetEffectiveNumThreads(options.num_threads);
+  if (num_threads > 1 && point3D_ids.size() >= kMinNumParallelItems) {
+    const size_t kChunkSize = 256;
+    proposals.resize(point3D_ids.size());
+    ParallelEvaluate(num_threads, point3D_ids.size(), kChunkSize,
+                     [&](const size_t i) {
+                       ProposeComplete(options, point3D_ids[i], &proposals[i]);
+                     });
+  }
+
+  for (size_t i = 0; i < point3D_ids.size(); ++i) {
+    num_completed += Complete(options, point3D_ids[i],
+                              proposals.empty() ? nullptr : &proposals[i]);
+  }
+
   return num_completed;
 }
 
 bool IncrementalTriangulator::HasCameraBogusParams(const Options& options,
-                                                   const Camera& camera) {
+                                                   const Camera& camera) const {
   const auto it = camera_has_bogus_params_.find(camera.CameraId());
   if (it == camera_has_bogus_params_.end()) {
-    const bool has_bogus_params = camera.HasBogusParams(
-        options.min_focal_length_ratio, options.max_focal_length_ratio,
-        options.max_extra_param);
-    camera_has_bogus_params_.emplace(camera.CameraId(), has_bogus_params);
-    return has_bogus_params;
+    return camera.HasBogusParams(options.min_focal_length_ratio,
+                                 options.max_focal_length_ratio,
+                                 options.max_extra_param);
   } else {
     return it->second;
   }
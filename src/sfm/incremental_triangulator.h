@@ -84,6 +84,13 @@ class IncrementalTriangulator {
     double max_focal_length_ratio = 10.0;
     double max_extra_param = 1.0;
 
+    // The number of threads used to estimate the triangulations. If larger
+    // than one, the triangulations, track completions, and merge candidates
+    // are evaluated in parallel and then committed to the reconstruction in
+    // a serial step in deterministic order. In the global deterministic mode,
+    // the triangulations are the same for any number of threads.
+    int num_threads = 1;
+
     bool Check() const;
   };
 
@@ -153,34 +160,79 @@ class IncrementalTriangulator {
     point2D_t point2D_idx;
     const Image* image;
     const Camera* camera;
-    const Point2D* point2D;
   };
 
  private:
-  // Clear cache of bogus camera parameters and merge trials.
-  void ClearCaches();
+  // New 3D points estimated from a set of correspondences without modifying
+  // the reconstruction. The estimate remains valid as long as the subset of
+  // not yet triangulated correspondences does not change.
+  struct CreateProposal {
+    std::vector<TrackElement> corrs;
+    std::vector<Eigen::Vector3d> xyzs;
+    std::vector<Track> tracks;
+  };
+
+  // Clear cache of merge trials and cache bogus camera parameters of all
+  // cameras in the reconstruction.
+  void ClearCaches(const Options& options);
 
   // Find (transitive) correspondences to other images.
   size_t Find(const Options& options, const image_t image_id,
               const point2D_t point2D_idx, const size_t transitivity,
-              std::vector<CorrData>* corrs_data);
-
-  // Try to create a new 3D point from the given correspondences.
-  size_t Create(const Options& options,
-                const std::vector<CorrData>& corrs_data);
+              std::vector<CorrData>* corrs_data) const;
+
+  // Estimate new 3D points from the given correspondences.
+  void ProposeCreate(const Options& options,
+                     const std::vector<CorrData>& corrs_data,
+                     CreateProposal* proposal) const;
+
+  // Estimate new 3D points from multiple sets of correspondences, whose
+  // triangulations are estimated in batches.
+  void ProposeCreates(const Options& options,
+                      const std::vector<std::vector<CorrData>>& corrs_data,
+                      std::vector<CreateProposal>* proposals) const;
+
+  // Try to create a new 3D point from the given correspondences. If given and
+  // still valid, the proposal is committed instead of estimating the points.
+  size_t Create(const Options& options, const std::vector<CorrData>& corrs_data,
+                const CreateProposal* proposal = nullptr);
+
+  // Find the index of the correspondence whose 3D point is best continued by
+  // the reference observation or the maximum index if none is found.
+  size_t FindContinuation(const Options& options,
+                          const CorrData& ref_corr_data,
+                          const std::vector<CorrData>& corrs_data) const;
 
   // Try to continue the 3D point with the given correspondences.
   size_t Continue(const Options& options, const CorrData& ref_corr_data,
                   const std::vector<CorrData>& corrs_data);
 
+  // Check if the 3D point has any corresponding 3D point to merge with.
+  bool HasMergeCandidates(const point3D_t point3D_id) const;
+
   // Try to merge 3D point with any of its corresponding 3D points.
   size_t Merge(const Options& options, const point3D_t point3D_id);
 
-  // Try to transitively complete the track of a 3D point.
-  size_t Complete(const Options& options, const point3D_t point3D_id);
+  // Merge the tracks of the given 3D points in the given order.
+  size_t MergeTracks(const Options& options,
+                     const std::vector<point3D_t>& point3D_ids);
+
+  // Find the observations that transitively complete the track of a 3D point
+  // without modifying the reconstruction.
+  void ProposeComplete(const Options& options, const point3D_t point3D_id,
+                       std::vector<TrackElement>* track_els) const;
+
+  // Try to transitively complete the track of a 3D point. If given and still
+  // valid, the proposed observations are added instead of searching for them.
+  size_t Complete(const Options& options, const point3D_t point3D_id,
+                  const std::vector<TrackElement>* proposal = nullptr);
+
+  // Complete the tracks of the given 3D points in the given order.
+  size_t CompleteTracks(const Options& options,
+                        const std::vector<point3D_t>& point3D_ids);
 
-  // Check if camera has bogus parameters and cache the result.
-  bool HasCameraBogusParams(const Options& options, const Camera& camera);
+  // Check if camera has bogus parameters using the cached result.
+  bool HasCameraBogusParams(const Options& options, const Camera& camera) const;
 
   // Database cache for the reconstruction. Used to retrieve correspondence
   // information for triangulation.
@@ -0,0 +1,349 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "sfm/localizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include "estimators/pose.h"
+#include "util/misc.h"
+
+namespace colmap {
+namespace {
+
+// SIFT descriptor vectors are normalized to length 512.
+const float kDistNorm = 1.0f / (512.0f * 512.0f);
+
+}  // namespace
+
+bool LocalizerOptions::Check() const {
+  CHECK_OPTION_GT(max_distance, 0.0);
+  CHECK_OPTION_GT(max_ratio, 0.0);
+  CHECK_OPTION_GT(max_error, 0.0);
+  CHECK_OPTION_GE(min_inlier_ratio, 0.0);
+  CHECK_OPTION_LE(min_inlier_ratio, 1.0);
+  CHECK_OPTION_GT(max_num_matches, 0);
+  CHECK_OPTION_GT(num_checks, 0);
+  CHECK_OPTION_GE(min_num_inliers, 3);
+  CHECK_OPTION_NE(num_threads, 0);
+  return true;
+}
+
+Localizer::Localizer(const Reconstruction& reconstruction,
+                     const Database& database,
+                     const retrieval::VisualIndex<>* visual_index)
+    : visual_index_(visual_index) {
+  std::unordered_map<point3D_t, size_t> point3D_id_to_idx;
+  point3D_id_to_idx.reserve(reconstruction.NumPoints3D());
+  points3D_.reserve(reconstruction.NumPoints3D());
+  for (const auto& point3D : reconstruction.Points3D()) {
+    point3D_id_to_idx.emplace(point3D.first, points3D_.size());
+    points3D_.push_back(point3D.second.XYZ());
+  }
+
+  if (visual_index_ == nullptr) {
+    size_t num_descriptors = 0;
+    for (const image_t image_id : reconstruction.RegImageIds()) {
+      num_descriptors += reconstruction.Image(image_id).NumPoints3D();
+    }
+
+    auto descriptors =
+        std::make_shared<FeatureDescriptors>(num_descriptors, 128);
+    descriptor_point3D_idxs_.reserve(num_descriptors);
+    for (const image_t image_id : reconstruction.RegImageIds()) {
+      const Image& image = reconstruction.Image(image_id);
+      const FeatureDescriptors image_descriptors =
+          database.ReadDescriptors(image_id);
+      CHECK_EQ(image_descriptors.rows(), image.NumPoints2D());
+      for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
+           ++point2D_idx) {
+        const Point2D& point2D = image.Point2D(point2D_idx);
+        if (point2D.HasPoint3D()) {
+          descriptors->row(descriptor_point3D_idxs_.size()) =
+              image_descriptors.row(point2D_idx);
+          descriptor_point3D_idxs_.push_back(
+              point3D_id_to_idx.at(point2D.Point3DId()));
+        }
+      }
+    }
+
+    index_.reset(new SiftFLANNIndex(descriptors));
+    return;
+  }
+
+  // Accumulate the descriptors of all observations of each 3D point.
+  Eigen::MatrixXf descriptor_sums =
+      Eigen::MatrixXf::Zero(points3D_.size(), 128);
+  for (const image_t image_id : reconstruction.RegImageIds()) {
+    const Image& image = reconstruction.Image(image_id);
+    const FeatureDescriptors image_descriptors =
+        database.ReadDescriptors(image_id);
+    CHECK_EQ(image_descriptors.rows(), image.NumPoints2D());
+    for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
+         ++point2D_idx) {
+      const Point2D& point2D = image.Point2D(point2D_idx);
+      if (point2D.HasPoint3D()) {
+        descriptor_sums.row(point3D_id_to_idx.at(point2D.Point3DId())) +=
+            image_descriptors.row(point2D_idx).cast<float>();
+      }
+    }
+  }
+
+  // The mean descriptors are normalized to the length of the SIFT
+  // descriptors, such that the same distance thresholds apply.
+  point3D_descriptors_.resize(points3D_.size(), 128);
+  for (size_t i = 0; i < points3D_.size(); ++i) {
+    const float norm = descriptor_sums.row(i).norm();
+    const float scale = norm > 0 ? 512.0f / norm : 0.0f;
+    point3D_descriptors_.row(i) = (scale * descriptor_sums.row(i))
+                                      .array()
+                                      .round()
+                                      .min(255.0f)
+                                      .cast<uint8_t>();
+  }
+
+  word_offsets_.resize(visual_index_->NumVisualWords() + 1, 0);
+  if (points3D_.empty()) {
+    return;
+  }
+
+  const int kNumChecks = 256;
+  const Eigen::MatrixXi word_ids = visual_index_->FindWordIds(
+      point3D_descriptors_, 1, kNumChecks, /*num_threads=*/-1);
+
+  // Sort the points by their visual word into a compressed inverted file.
+  for (size_t i = 0; i < points3D_.size(); ++i) {
+    CHECK_GE(word_ids(i, 0), 0);
+    CHECK_LT(word_ids(i, 0), visual_index_->NumVisualWords());
+    word_offsets_[word_ids(i, 0) + 1] += 1;
+  }
+  for (size_t i = 1; i < word_offsets_.size(); ++i) {
+    word_offsets_[i] += word_offsets_[i - 1];
+  }
+  std::vector<size_t> word_ends(word_offsets_.begin(),
+                                word_offsets_.end() - 1);
+  word_point3D_idxs_.resize(points3D_.size());
+  for (size_t i = 0; i < points3D_.size(); ++i) {
+    word_point3D_idxs_[word_ends[word_ids(i, 0)]++] = i;
+  }
+}
+
+size_t Localizer::NumPoints3D() const { return points3D_.size(); }
+
+size_t Localizer::NumDescriptors() const {
+  if (visual_index_ == nullptr) {
+    return descriptor_point3D_idxs_.size();
+  } else {
+    return point3D_descriptors_.rows();
+  }
+}
+
+void Localizer::Match(const LocalizerOptions& options,
+                      const FeatureKeypoints& keypoints,
+                      const FeatureDescriptors& descriptors,
+                      std::vector<Eigen::Vector2d>* points2D,
+                      std::vector<Eigen::Vector3d>* points3D) const {
+  CHECK(options.Check());
+  CHECK_EQ(keypoints.size(), descriptors.rows());
+  CHECK_NOTNULL(points2D);
+  CHECK_NOTNULL(points3D);
+
+  points2D->clear();
+  points3D->clear();
+
+  if (visual_index_ == nullptr) {
+    MatchIndex(options, keypoints, descriptors, points2D, points3D);
+  } else {
+    MatchVisualWords(options, keypoints, descriptors, points2D, points3D);
+  }
+}
+
+void Localizer::MatchIndex(const LocalizerOptions& options,
+                           const FeatureKeypoints& keypoints,
+                           const FeatureDescriptors& descriptors,
+                           std::vector<Eigen::Vector2d>* points2D,
+                           std::vector<Eigen::Vector3d>* points3D) const {
+  SiftFLANNIndex::IndexMatrix indices;
+  SiftFLANNIndex::IndexMatrix distances;
+  index_->Search(descriptors, options.num_threads, &indices, &distances);
+  if (indices.cols() == 0) {
+    return;
+  }
+
+  for (Eigen::Index i = 0; i < indices.rows(); ++i) {
+    const size_t point3D_idx = descriptor_point3D_idxs_[indices(i, 0)];
+
+    const float best_dist =
+        std::acos(std::min(kDistNorm * distances(i, 0), 1.0f));
+    if (best_dist > options.max_distance) {
+      continue;
+    }
+
+    // The ratio test is skipped if both nearest neighbors are observations
+    // of the same 3D point.
+    if (indices.cols() > 1 &&
+        descriptor_point3D_idxs_[indices(i, 1)] != point3D_idx) {
+      const float second_best_dist =
+          std::acos(std::min(kDistNorm * distances(i, 1), 1.0f));
+      if (best_dist >= options.max_ratio * second_best_dist) {
+        continue;
+      }
+    }
+
+    points2D->emplace_back(keypoints[i].x, keypoints[i].y);
+    points3D->push_back(points3D_[point3D_idx]);
+  }
+}
+
+void Localizer::MatchVisualWords(
+    const LocalizerOptions& options, const FeatureKeypoints& keypoints,
+    const FeatureDescriptors& descriptors,
+    std::vector<Eigen::Vector2d>* points2D,
+    std::vector<Eigen::Vector3d>* points3D) const {
+  if (descriptors.rows() == 0 || word_point3D_idxs_.empty()) {
+    return;
+  }
+
+  const Eigen::MatrixXi word_ids = visual_index_->FindWordIds(
+      descriptors, 1, options.num_checks, options.num_threads);
+
+  // Prioritize the query features by the number of points in their visual
+  // word, since they are the cheapest to match.
+  std::vector<std::pair<size_t, Eigen::Index>> feature_costs;
+  feature_costs.reserve(descriptors.rows());
+  for (Eigen::Index i = 0; i < descriptors.rows(); ++i) {
+    const int word_id = word_ids(i, 0);
+    if (word_id < 0 ||
+        static_cast<size_t>(word_id) >= visual_index_->NumVisualWords()) {
+      continue;
+    }
+    const size_t cost = word_offsets_[word_id + 1] - word_offsets_[word_id];
+    if (cost > 0) {
+      feature_costs.emplace_back(cost, i);
+    }
+  }
+
+  std::sort(feature_costs.begin(), feature_costs.end());
+
+  for (const auto& feature_cost : feature_costs) {
+    if (points2D->size() >= static_cast<size_t>(options.max_num_matches)) {
+      break;
+    }
+
+    const Eigen::Index i = feature_cost.second;
+    const int word_id = word_ids(i, 0);
+    const Eigen::Matrix<int, 1, 128> query = descriptors.row(i).cast<int>();
+
+    int best_dot = -1;
+    int second_best_dot = -1;
+    size_t best_point3D_idx = 0;
+    for (size_t j = word_offsets_[word_id]; j < word_offsets_[word_id + 1];
+         ++j) {
+      const size_t point3D_idx = word_point3D_idxs_[j];
+      const int dot =
+          query.dot(point3D_descriptors_.row(point3D_idx).cast<int>());
+      if (dot > best_dot) {
+        second_best_dot = best_dot;
+        best_dot = dot;
+        best_point3D_idx = point3D_idx;
+      } else if (dot > second_best_dot) {
+        second_best_dot = dot;
+      }
+    }
+
+    const float best_dist = std::acos(std::min(kDistNorm * best_dot, 1.0f));
+    if (best_dist > options.max_distance) {
+      continue;
+    }
+
+    if (second_best_dot >= 0) {
+      const float second_best_dist =
+          std::acos(std::min(kDistNorm * second_best_dot, 1.0f));
+      if (best_dist >= options.max_ratio * second_best_dist) {
+        continue;
+      }
+    }
+
+    points2D->emplace_back(keypoints[i].x, keypoints[i].y);
+    points3D->push_back(points3D_[best_point3D_idx]);
+  }
+}
+
+bool Localizer::Localize(const LocalizerOptions& options,
+                         const FeatureKeypoints& keypoints,
+                         const FeatureDescriptors& descriptors, Camera* camera,
+                         Eigen::Vector4d* qvec, Eigen::Vector3d* tvec,
+                         size_t* num_inliers) const {
+  CHECK_NOTNULL(camera);
+  CHECK_NOTNULL(qvec);
+  CHECK_NOTNULL(tvec);
+  CHECK_NOTNULL(num_inliers);
+
+  *num_inliers = 0;
+
+  std::vector<Eigen::Vector2d> points2D;
+  std::vector<Eigen::Vector3d> points3D;
+  Match(options, keypoints, descriptors, &points2D, &points3D);
+  if (points2D.size() < static_cast<size_t>(options.min_num_inliers)) {
+    return false;
+  }
+
+  AbsolutePoseEstimationOptions abs_pose_options;
+  abs_pose_options.num_threads = options.num_threads;
+  abs_pose_options.estimate_focal_length = options.estimate_focal_length;
+  abs_pose_options.ransac_options.max_error = options.max_error;
+  abs_pose_options.ransac_options.min_inlier_ratio = options.min_inlier_ratio;
+  abs_pose_options.ransac_options.min_num_trials = 100;
+  abs_pose_options.ransac_options.max_num_trials = 10000;
+  abs_pose_options.ransac_options.confidence = 0.99999;
+
+  std::vector<char> inlier_mask;
+  if (!EstimateAbsolutePose(abs_pose_options, points2D, points3D, qvec, tvec,
+                            camera, num_inliers, &inlier_mask)) {
+    return false;
+  }
+
+  if (*num_inliers < static_cast<size_t>(options.min_num_inliers)) {
+    return false;
+  }
+
+  AbsolutePoseRefinementOptions abs_pose_refinement_options;
+  abs_pose_refinement_options.refine_focal_length =
+      options.estimate_focal_length;
+  abs_pose_refinement_options.refine_extra_params = false;
+  abs_pose_refinement_options.print_summary = false;
+
+  return RefineAbsolutePose(abs_pose_refinement_options, inlier_mask, points2D,
+                            points3D, qvec, tvec, camera);
+}
+
+}  // namespace colmap
@@ -0,0 +1,152 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_SFM_LOCALIZER_H_
+#define COLMAP_SRC_SFM_LOCALIZER_H_
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "base/camera.h"
+#include "base/database.h"
+#include "base/reconstruction.h"
+#include "feature/sift.h"
+#include "feature/types.h"
+#include "retrieval/visual_index.h"
+#include "util/alignment.h"
+
+namespace colmap {
+
+struct LocalizerOptions {
+  // Maximum descriptor distance and distance ratio of the second nearest
+  // neighbor for the matches between query features and 3D points.
+  double max_distance = 0.7;
+  double max_ratio = 0.8;
+
+  // Maximum reprojection error in pixels for the absolute pose estimation.
+  double max_error = 12.0;
+
+  // A priori assumed minimum inlier ratio of the 2D-3D matches.
+  double min_inlier_ratio = 0.1;
+
+  // The number of 2D-3D matches, after which the prioritized search against
+  // the quantized point descriptors terminates. The query features are
+  // matched in ascending order of the number of points in their visual word.
+  int max_num_matches = 100;
+
+  // The number of checks in the quantization of the query descriptors.
+  int num_checks = 256;
+
+  // Minimum number of inliers for a query image to be localized.
+  int min_num_inliers = 15;
+
+  // Whether to estimate and refine the focal length of the query camera.
+  bool estimate_focal_length = false;
+
+  // The number of threads used to localize a single query image.
+  int num_threads = 1;
+
+  bool Check() const;
+};
+
+// Localizes query images against a fixed reconstruction. The descriptors of
+// all observations of the 3D points are read from the database once and kept
+// resident in a nearest neighbor index, such that queries only match against
+// the index and estimate the absolute pose. Queries may run concurrently.
+//
+// If a visual index is given, each 3D point is instead represented by the
+// mean descriptor of its observations, which is quantized through the
+// vocabulary of the visual index into an inverted file. Queries then match
+// directly against the points in their visual word using prioritized search,
+// following the paper:
+//
+//    Sattler, Leibe, Kobbelt. "Fast Image-Based Localization using Direct
+//    2D-to-3D Matching". ICCV 2011.
+//
+// The visual index must outlive the localizer.
+class Localizer {
+ public:
+  Localizer(const Reconstruction& reconstruction, const Database& database,
+            const retrieval::VisualIndex<>* visual_index = nullptr);
+
+  // The number of indexed 3D points and descriptors, which equals the number
+  // of 3D points, if the point descriptors are quantized.
+  size_t NumPoints3D() const;
+  size_t NumDescriptors() const;
+
+  // Estimate the pose of a query image from its features, where `camera`
+  // holds the query intrinsics and receives the refined focal length, if
+  // enabled. Returns true if the image was localized with enough inliers.
+  bool Localize(const LocalizerOptions& options,
+                const FeatureKeypoints& keypoints,
+                const FeatureDescriptors& descriptors, Camera* camera,
+                Eigen::Vector4d* qvec, Eigen::Vector3d* tvec,
+                size_t* num_inliers) const;
+
+  // Match the query features against the 3D points and return their 2D-3D
+  // correspondences.
+  void Match(const LocalizerOptions& options,
+             const FeatureKeypoints& keypoints,
+             const FeatureDescriptors& descriptors,
+             std::vector<Eigen::Vector2d>* points2D,
+             std::vector<Eigen::Vector3d>* points3D) const;
+
+ private:
+  void MatchIndex(const LocalizerOptions& options,
+                  const FeatureKeypoints& keypoints,
+                  const FeatureDescriptors& descriptors,
+                  std::vector<Eigen::Vector2d>* points2D,
+                  std::vector<Eigen::Vector3d>* points3D) const;
+  void MatchVisualWords(const LocalizerOptions& options,
+                        const FeatureKeypoints& keypoints,
+                        const FeatureDescriptors& descriptors,
+                        std::vector<Eigen::Vector2d>* points2D,
+                        std::vector<Eigen::Vector3d>* points3D) const;
+
+  // The positions of the indexed 3D points.
+  std::vector<Eigen::Vector3d> points3D_;
+  // The index into `points3D_` for each row of the indexed descriptors.
+  std::vector<size_t> descriptor_point3D_idxs_;
+  std::unique_ptr<SiftFLANNIndex> index_;
+
+  // The quantized mean descriptors of the 3D points, where the points of
+  // visual word `i` are stored in `word_point3D_idxs_` between
+  // `word_offsets_[i]` and `word_offsets_[i + 1]`.
+  const retrieval::VisualIndex<>* visual_index_;
+  FeatureDescriptors point3D_descriptors_;
+  std::vector<size_t> word_offsets_;
+  std::vector<size_t> word_point3D_idxs_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_SFM_LOCALIZER_H_
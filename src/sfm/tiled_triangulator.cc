@@ -0,0 +1,383 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "sfm/tiled_triangulator.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "base/database.h"
+#include "util/misc.h"
+#include "util/threading.h"
+
+namespace colmap {
+namespace {
+
+typedef std::pair<image_t, Eigen::Vector3d> ImageCenter;
+
+void SplitTile(const size_t max_num_images_per_tile,
+               std::vector<ImageCenter>::iterator begin,
+               std::vector<ImageCenter>::iterator end,
+               std::vector<std::vector<image_t>>* tiles) {
+  const size_t num_images = static_cast<size_t>(end - begin);
+  if (num_images <= max_num_images_per_tile) {
+    tiles->emplace_back();
+    tiles->back().reserve(num_images);
+    for (auto it = begin; it != end; ++it) {
+      tiles->back().push_back(it->first);
+    }
+    std::sort(tiles->back().begin(), tiles->back().end());
+    return;
+  }
+
+  Eigen::Vector3d min_bound = begin->second;
+  Eigen::Vector3d max_bound = begin->second;
+  for (auto it = begin; it != end; ++it) {
+    min_bound = min_bound.cwiseMin(it->second);
+    max_bound = max_bound.cwiseMax(it->second);
+  }
+
+  int split_axis;
+  (max_bound - min_bound).maxCoeff(&split_axis);
+
+  // Split at the median, where ties are broken by the image identifier to
+  // obtain a deterministic partition.
+  const auto middle = begin + num_images / 2;
+  std::nth_element(begin, middle, end,
+                   [split_axis](const ImageCenter& image1,
+                                const ImageCenter& image2) {
+                     if (image1.second(split_axis) ==
+                         image2.second(split_axis)) {
+                       return image1.first < image2.first;
+                     }
+                     return image1.second(split_axis) <
+                            image2.second(split_axis);
+                   });
+
+  SplitTile(max_num_images_per_tile, begin, middle, tiles);
+  SplitTile(max_num_images_per_tile, middle, end, tiles);
+}
+
+}  // namespace
+
+bool TiledTriangulator::Options::Check() const {
+  CHECK_OPTION_GT(max_num_images_per_tile, 0);
+  CHECK_OPTION_GT(max_reproj_error, 0);
+  return true;
+}
+
+TiledTriangulator::TiledTriangulator(
+    const Options& options, const CorrespondenceGraph* correspondence_graph,
+    Reconstruction* reconstruction)
+    : options_(options),
+      correspondence_graph_(correspondence_graph),
+      reconstruction_(reconstruction) {
+  CHECK(options_.Check());
+  CHECK_NOTNULL(correspondence_graph_);
+  CHECK_NOTNULL(reconstruction_);
+}
+
+size_t TiledTriangulator::Triangulate(
+    const IncrementalTriangulator::Options& tri_options,
+    const BundleAdjustmentOptions& ba_options) {
+  CHECK(tri_options.Check());
+  CHECK(ba_options.Check());
+
+  report_ = Report();
+
+  const std::vector<std::vector<image_t>> tiles = PartitionImages(
+      *reconstruction_,
+      static_cast<size_t>(options_.max_num_images_per_tile));
+  report_.num_tiles = tiles.size();
+
+  // Images that share correspondences with an image of a tile are added to
+  // the local reconstruction of the tile, such that the tracks crossing the
+  // tile borders can be triangulated and merged.
+  std::unordered_map<image_t, std::vector<image_t>> overlapping_image_ids;
+  for (const auto& image_pair :
+       correspondence_graph_->NumCorrespondencesBetweenImages()) {
+    image_t image_id1;
+    image_t image_id2;
+    Database::PairIdToImagePair(image_pair.first, &image_id1, &image_id2);
+    if (image_pair.second > 0 && reconstruction_->ExistsImage(image_id1) &&
+        reconstruction_->ExistsImage(image_id2) &&
+        reconstruction_->IsImageRegistered(image_id1) &&
+        reconstruction_->IsImageRegistered(image_id2)) {
+      overlapping_image_ids[image_id1].push_back(image_id2);
+      overlapping_image_ids[image_id2].push_back(image_id1);
+    }
+  }
+
+  const int num_threads =
+      std::max(1, std::min(GetEffectiveNumThreads(options_.num_threads),
+                           static_cast<int>(tiles.size())));
+
+  IncrementalTriangulator::Options tile_tri_options = tri_options;
+  tile_tri_options.num_threads = std::max(
+      1, GetEffectiveNumThreads(tri_options.num_threads) / num_threads);
+
+  BundleAdjustmentOptions tile_ba_options = ba_options;
+  tile_ba_options.refine_focal_length = false;
+  tile_ba_options.refine_principal_point = false;
+  tile_ba_options.refine_extra_params = false;
+  tile_ba_options.refine_extrinsics = false;
+  tile_ba_options.print_summary = false;
+  tile_ba_options.solver_options.minimizer_progress_to_stdout = false;
+  tile_ba_options.solver_options.num_threads = std::max(
+      1, GetEffectiveNumThreads(ba_options.solver_options.num_threads) /
+             num_threads);
+#if CERES_VERSION_MAJOR < 2
+  tile_ba_options.solver_options.num_linear_solver_threads =
+      tile_ba_options.solver_options.num_threads;
+#endif  // CERES_VERSION_MAJOR
+
+  ThreadPool thread_pool(num_threads);
+
+  size_t num_merged_observations = 0;
+
+  // The tiles are processed in batches to bound the memory of the local
+  // copies. The copies are created and merged serially, since the
+  // reconstruction is only read during the parallel triangulation.
+  for (size_t batch_begin = 0; batch_begin < tiles.size();
+       batch_begin += num_threads) {
+    const size_t batch_end =
+        std::min(tiles.size(), batch_begin + static_cast<size_t>(num_threads));
+
+    std::vector<Reconstruction> tile_reconstructions(batch_end - batch_begin);
+    std::vector<std::future<void>> futures;
+    futures.reserve(tile_reconstructions.size());
+    for (size_t tile_idx = batch_begin; tile_idx < batch_end; ++tile_idx) {
+      Reconstruction* tile_reconstruction =
+          &tile_reconstructions[tile_idx - batch_begin];
+      SetUpTile(tiles[tile_idx], overlapping_image_ids, tile_reconstruction);
+      const std::vector<image_t>* tile_image_ids = &tiles[tile_idx];
+      futures.push_back(thread_pool.AddTask(
+          [this, &tile_tri_options, &tile_ba_options, tile_image_ids,
+           tile_reconstruction]() {
+            TriangulateTile(tile_tri_options, tile_ba_options,
+                            *tile_image_ids, tile_reconstruction);
+          }));
+    }
+
+    for (size_t i = 0; i < futures.size(); ++i) {
+      futures[i].get();
+      num_merged_observations += MergeTile(tile_reconstructions[i]);
+    }
+  }
+
+  report_.num_merged_observations = num_merged_observations;
+
+  return num_merged_observations;
+}
+
+const TiledTriangulator::Report& TiledTriangulator::GetReport() const {
+  return report_;
+}
+
+std::vector<std::vector<image_t>> TiledTriangulator::PartitionImages(
+    const Reconstruction& reconstruction,
+    const size_t max_num_images_per_tile) {
+  CHECK_GT(max_num_images_per_tile, 0);
+
+  std::vector<image_t> reg_image_ids = reconstruction.RegImageIds();
+  std::sort(reg_image_ids.begin(), reg_image_ids.end());
+
+  std::vector<ImageCenter> image_centers;
+  image_centers.reserve(reg_image_ids.size());
+  for (const image_t image_id : reg_image_ids) {
+    image_centers.emplace_back(
+        image_id, reconstruction.Image(image_id).ProjectionCenter());
+  }
+
+  std::vector<std::vector<image_t>> tiles;
+  if (!image_centers.empty()) {
+    SplitTile(max_num_images_per_tile, image_centers.begin(),
+              image_centers.end(), &tiles);
+  }
+
+  return tiles;
+}
+
+void TiledTriangulator::SetUpTile(
+    const std::vector<image_t>& tile_image_ids,
+    const std::unordered_map<image_t, std::vector<image_t>>&
+        overlapping_image_ids,
+    Reconstruction* tile_reconstruction) const {
+  std::vector<image_t> image_ids = tile_image_ids;
+  std::unordered_set<image_t> image_ids_set(tile_image_ids.begin(),
+                                            tile_image_ids.end());
+  for (const image_t image_id : tile_image_ids) {
+    const auto overlapping = overlapping_image_ids.find(image_id);
+    if (overlapping == overlapping_image_ids.end()) {
+      continue;
+    }
+    for (const image_t overlapping_image_id : overlapping->second) {
+      if (image_ids_set.insert(overlapping_image_id).second) {
+        image_ids.push_back(overlapping_image_id);
+      }
+    }
+  }
+
+  // Copy the images without their 3D points. The local reconstruction is not
+  // set up with the correspondence graph, since it does not contain all
+  // corresponding images and does not require the visibility bookkeeping.
+  for (const image_t image_id : image_ids) {
+    Image image = reconstruction_->Image(image_id);
+    if (!tile_reconstruction->ExistsCamera(image.CameraId())) {
+      tile_reconstruction->AddCamera(
+          reconstruction_->Camera(image.CameraId()));
+    }
+    for (point2D_t point2D_idx = 0; point2D_idx < image.NumPoints2D();
+         ++point2D_idx) {
+      image.ResetPoint3DForPoint2D(point2D_idx);
+    }
+    image.SetRegistered(false);
+    tile_reconstruction->AddImage(image);
+    tile_reconstruction->RegisterImage(image_id);
+  }
+
+  // Copy the existing 3D points observed in the tile, such that they are
+  // continued instead of being triangulated again.
+  std::unordered_set<point3D_t> point3D_ids;
+  for (const image_t image_id : tile_image_ids) {
+    for (const Point2D& point2D :
+         reconstruction_->Image(image_id).Points2D()) {
+      if (!point2D.HasPoint3D() ||
+          !point3D_ids.insert(point2D.Point3DId()).second) {
+        continue;
+      }
+      const Point3D& point3D = reconstruction_->Point3D(point2D.Point3DId());
+      Track track;
+      for (const auto& track_el : point3D.Track().Elements()) {
+        if (image_ids_set.count(track_el.image_id) > 0) {
+          track.AddElement(track_el);
+        }
+      }
+      tile_reconstruction->AddPoint3D(point3D.XYZ(), track, point3D.Color());
+    }
+  }
+}
+
+void TiledTriangulator::TriangulateTile(
+    const IncrementalTriangulator::Options& tri_options,
+    const BundleAdjustmentOptions& ba_options,
+    const std::vector<image_t>& tile_image_ids,
+    Reconstruction* tile_reconstruction) const {
+  // The copied 3D points have the smallest identifiers and remain constant.
+  const point3D_t max_copied_point3D_id = tile_reconstruction->NumPoints3D();
+
+  IncrementalTriangulator triangulator(correspondence_graph_,
+                                       tile_reconstruction);
+  for (const image_t image_id : tile_image_ids) {
+    triangulator.TriangulateImage(tri_options, image_id);
+  }
+  triangulator.CompleteAllTracks(tri_options);
+  triangulator.MergeAllTracks(tri_options);
+
+  if (options_.refine_points &&
+      tile_reconstruction->NumPoints3D() > max_copied_point3D_id) {
+    BundleAdjustmentConfig ba_config;
+    for (const image_t image_id : tile_reconstruction->RegImageIds()) {
+      ba_config.AddImage(image_id);
+    }
+    for (const auto& point3D : tile_reconstruction->Points3D()) {
+      if (point3D.first <= max_copied_point3D_id) {
+        ba_config.AddConstantPoint(point3D.first);
+      }
+    }
+    tile_reconstruction->FilterObservationsWithNegativeDepth();
+    BundleAdjuster bundle_adjuster(ba_options, ba_config);
+    bundle_adjuster.Solve(tile_reconstruction);
+  }
+
+  tile_reconstruction->FilterAllPoints3D(options_.max_reproj_error,
+                                         tri_options.min_angle);
+}
+
+size_t TiledTriangulator::MergeTile(const Reconstruction& tile_reconstruction) {
+  // Tracks are merged as in `Reconstruction::Merge`: new observations are
+  // appended to an existing 3D point if the mapping is unambiguous and
+  // otherwise create a new 3D point. Duplicate tracks at the tile borders,
+  // which share observations with the tracks of previously merged tiles,
+  // are thereby joined.
+  size_t num_merged_observations = 0;
+
+  for (const auto& point3D : tile_reconstruction.Points3D()) {
+    Track new_track;
+    size_t old_track_length = 0;
+    point3D_t old_point3D_id = kInvalidPoint3DId;
+    bool ambiguous_old_point3D = false;
+    for (const auto& track_el : point3D.second.Track().Elements()) {
+      const Point2D& point2D =
+          reconstruction_->Image(track_el.image_id)
+              .Point2D(track_el.point2D_idx);
+      if (point2D.HasPoint3D()) {
+        old_track_length += 1;
+        if (old_point3D_id == kInvalidPoint3DId) {
+          old_point3D_id = point2D.Point3DId();
+        } else if (old_point3D_id != point2D.Point3DId()) {
+          ambiguous_old_point3D = true;
+        }
+      } else {
+        new_track.AddElement(track_el);
+      }
+    }
+
+    if (new_track.Length() == 0) {
+      continue;
+    }
+
+    const bool merge_new_and_old_point =
+        old_point3D_id != kInvalidPoint3DId && !ambiguous_old_point3D;
+
+    if (merge_new_and_old_point) {
+      Point3D& old_point3D = reconstruction_->Point3D(old_point3D_id);
+      const double old_weight = old_point3D.Track().Length();
+      const double new_weight = new_track.Length();
+      old_point3D.SetXYZ((old_weight * old_point3D.XYZ() +
+                          new_weight * point3D.second.XYZ()) /
+                         (old_weight + new_weight));
+      for (const auto& track_el : new_track.Elements()) {
+        reconstruction_->AddObservation(old_point3D_id, track_el);
+      }
+      num_merged_observations += new_track.Length();
+    } else if (new_track.Length() >= 2) {
+      reconstruction_->AddPoint3D(point3D.second.XYZ(), new_track,
+                                  point3D.second.Color());
+      report_.num_created_points3D += 1;
+      num_merged_observations += new_track.Length();
+    }
+  }
+
+  return num_merged_observations;
+}
+
+}  // namespace colmap
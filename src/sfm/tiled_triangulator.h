@@ -0,0 +1,126 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_SFM_TILED_TRIANGULATOR_H_
+#define COLMAP_SRC_SFM_TILED_TRIANGULATOR_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "base/correspondence_graph.h"
+#include "base/reconstruction.h"
+#include "optim/bundle_adjustment.h"
+#include "sfm/incremental_triangulator.h"
+
+namespace colmap {
+
+// Triangulation of models with known and fixed poses that are too large to be
+// triangulated image by image in a single pass. The registered images are
+// spatially partitioned into tiles by recursively splitting their projection
+// centers at the median of the axis with the largest extent. Each tile is
+// triangulated and bundle adjusted with fixed cameras as an independent
+// problem on a local copy of its images and the images overlapping with it,
+// such that tracks crossing the tile borders are also observed. The tiles only
+// require read access to the correspondence graph and are processed in
+// parallel. The triangulated tracks are then merged into the reconstruction in
+// deterministic order, where duplicate tracks at the tile borders are joined.
+class TiledTriangulator {
+ public:
+  struct Options {
+    // The maximum number of images per tile.
+    int max_num_images_per_tile = 500;
+
+    // Whether to refine the triangulated points of each tile with fixed
+    // cameras and poses.
+    bool refine_points = true;
+
+    // Maximum reprojection error in pixels for triangulated points of a tile
+    // to be merged into the reconstruction after refinement.
+    double max_reproj_error = 4.0;
+
+    // The number of tiles processed in parallel.
+    int num_threads = -1;
+
+    bool Check() const;
+  };
+
+  struct Report {
+    size_t num_tiles = 0;
+    size_t num_created_points3D = 0;
+    size_t num_merged_observations = 0;
+  };
+
+  // Note that both the correspondence graph and the reconstruction objects
+  // must live as long as the triangulator. The poses of the registered images
+  // are not changed by the triangulator.
+  TiledTriangulator(const Options& options,
+                    const CorrespondenceGraph* correspondence_graph,
+                    Reconstruction* reconstruction);
+
+  // Triangulate all registered images tile by tile and merge the tracks into
+  // the reconstruction. Returns the number of added observations.
+  size_t Triangulate(const IncrementalTriangulator::Options& tri_options,
+                     const BundleAdjustmentOptions& ba_options);
+
+  // Get the report for the last call to `Triangulate`.
+  const Report& GetReport() const;
+
+  // Spatially partition the registered images of the reconstruction into
+  // tiles of at most the given number of images.
+  static std::vector<std::vector<image_t>> PartitionImages(
+      const Reconstruction& reconstruction,
+      const size_t max_num_images_per_tile);
+
+ private:
+  // Copy the images of a tile and its overlapping images with the existing
+  // 3D points observed in the tile into a local reconstruction.
+  void SetUpTile(const std::vector<image_t>& tile_image_ids,
+                 const std::unordered_map<image_t, std::vector<image_t>>&
+                     overlapping_image_ids,
+                 Reconstruction* tile_reconstruction) const;
+
+  // Triangulate a single tile into a local reconstruction.
+  void TriangulateTile(const IncrementalTriangulator::Options& tri_options,
+                       const BundleAdjustmentOptions& ba_options,
+                       const std::vector<image_t>& tile_image_ids,
+                       Reconstruction* tile_reconstruction) const;
+
+  // Merge the newly triangulated tracks of a tile into the reconstruction.
+  size_t MergeTile(const Reconstruction& tile_reconstruction);
+
+  const Options options_;
+  const CorrespondenceGraph* correspondence_graph_;
+  Reconstruction* reconstruction_;
+  Report report_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_SFM_TILED_TRIANGULATOR_H_
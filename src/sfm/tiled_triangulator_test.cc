@@ -0,0 +1,110 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "sfm/tiled_triangulator"
+#include "util/testing.h"
+
+#include <set>
+
+#include "base/synthetic.h"
+#include "sfm/tiled_triangulator.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestPartitionImages) {
+  SyntheticDatasetOptions options;
+  options.num_images = 10;
+  options.num_points3D = 10;
+  Reconstruction reconstruction;
+  SynthesizeDataset(options, &reconstruction);
+
+  BOOST_CHECK_EQUAL(TiledTriangulator::PartitionImages(reconstruction, 10)
+                        .size(),
+                    1);
+  BOOST_CHECK_EQUAL(TiledTriangulator::PartitionImages(reconstruction, 1)
+                        .size(),
+                    10);
+
+  const auto tiles = TiledTriangulator::PartitionImages(reconstruction, 3);
+  BOOST_CHECK_EQUAL(tiles.size(), 4);
+  std::set<image_t> image_ids;
+  for (const auto& tile : tiles) {
+    BOOST_CHECK_LE(tile.size(), 3);
+    BOOST_CHECK_GE(tile.size(), 2);
+    for (const image_t image_id : tile) {
+      BOOST_CHECK(image_ids.insert(image_id).second);
+    }
+  }
+  BOOST_CHECK_EQUAL(image_ids.size(), reconstruction.NumRegImages());
+
+  BOOST_CHECK(TiledTriangulator::PartitionImages(Reconstruction(), 3).empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestTriangulate) {
+  SyntheticDatasetOptions options;
+  options.num_images = 10;
+  options.num_points3D = 50;
+  Reconstruction reconstruction;
+  SynthesizeDataset(options, &reconstruction);
+
+  CorrespondenceGraph correspondence_graph;
+  SynthesizeCorrespondenceGraph(reconstruction, &correspondence_graph);
+
+  for (const point3D_t point3D_id : reconstruction.Point3DIds()) {
+    reconstruction.DeletePoint3D(point3D_id);
+  }
+  BOOST_CHECK_EQUAL(reconstruction.NumPoints3D(), 0);
+
+  TiledTriangulator::Options tiled_options;
+  tiled_options.max_num_images_per_tile = 3;
+  tiled_options.refine_points = false;
+  tiled_options.num_threads = 2;
+  TiledTriangulator tiled_triangulator(tiled_options, &correspondence_graph,
+                                       &reconstruction);
+  BOOST_CHECK_EQUAL(tiled_triangulator.Triangulate(
+                        IncrementalTriangulator::Options(),
+                        BundleAdjustmentOptions()),
+                    options.num_images * options.num_points3D);
+
+  const auto& report = tiled_triangulator.GetReport();
+  BOOST_CHECK_EQUAL(report.num_tiles, 4);
+  BOOST_CHECK_EQUAL(report.num_created_points3D, options.num_points3D);
+
+  // The duplicate tracks of the tiles are joined into complete tracks.
+  BOOST_CHECK_EQUAL(reconstruction.NumPoints3D(), options.num_points3D);
+  for (const auto& point3D : reconstruction.Points3D()) {
+    BOOST_CHECK_EQUAL(point3D.second.Track().Length(), options.num_images);
+  }
+
+  for (const auto& image : reconstruction.Images()) {
+    BOOST_CHECK(image.second.IsRegistered());
+    BOOST_CHECK_EQUAL(image.second.NumPoints3D(), options.num_points3D);
+  }
+}
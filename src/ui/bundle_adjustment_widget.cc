@@ -60,6 +60,12 @@ BundleAdjustmentWidget::BundleAdjustmentWidget(MainWindow* main_window,
   AddOptionDoubleLog(
       &options->bundle_adjustment->solver_options.parameter_tolerance,
       "parameter_tolerance [10eX]", -1000, 1000);
+  AddOptionDouble(
+      &options->bundle_adjustment->solver_options.max_solver_time_in_seconds,
+      "max_solver_time_in_seconds", 0, 1e9, 1, 0);
+  AddOptionDouble(
+      &options->bundle_adjustment->min_relative_cost_decrease_per_second,
+      "min_relative_cost_decrease_per_second", 0, 1, 1e-4, 6);
 
   AddOptionBool(&options->bundle_adjustment->refine_focal_length,
                 "refine_focal_length");
@@ -70,6 +76,14 @@ BundleAdjustmentWidget::BundleAdjustmentWidget(MainWindow* main_window,
   AddOptionBool(&options->bundle_adjustment->refine_extrinsics,
                 "refine_extrinsics");
 
+  AddOptionBool(&options->bundle_adjustment->use_gpu, "use_gpu");
+  AddOptionInt(&options->bundle_adjustment->gpu_index, "gpu_index", -1);
+  AddOptionBool(&options->bundle_adjustment->use_mixed_precision,
+                "use_mixed_precision");
+  AddOptionBool(
+      &options->bundle_adjustment->solve_constant_structure_independently,
+      "solve_constant_structure_independently");
+
   QPushButton* run_button = new QPushButton(tr("Run"), this);
   grid_layout_->addWidget(run_button, grid_layout_->rowCount(), 1);
   connect(run_button, &QPushButton::released, this,
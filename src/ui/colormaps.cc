@@ -69,8 +69,7 @@ float PointColormapBase::AdjustScale(const float gray) {
 void PointColormapPhotometric::Prepare(EIGEN_STL_UMAP(camera_t, Camera) &
                                            cameras,
                                        EIGEN_STL_UMAP(image_t, Image) & images,
-                                       EIGEN_STL_UMAP(point3D_t, Point3D) &
-                                           points3D,
+                                       DenseIdMap<point3D_t, Point3D>& points3D,
                                        std::vector<image_t>& reg_image_ids) {}
 
 Eigen::Vector4f PointColormapPhotometric::ComputeColor(
@@ -81,7 +80,7 @@ Eigen::Vector4f PointColormapPhotometric::ComputeColor(
 
 void PointColormapError::Prepare(EIGEN_STL_UMAP(camera_t, Camera) & cameras,
                                  EIGEN_STL_UMAP(image_t, Image) & images,
-                                 EIGEN_STL_UMAP(point3D_t, Point3D) & points3D,
+                                 DenseIdMap<point3D_t, Point3D>& points3D,
                                  std::vector<image_t>& reg_image_ids) {
   std::vector<float> errors;
   errors.reserve(points3D.size());
@@ -102,8 +101,7 @@ Eigen::Vector4f PointColormapError::ComputeColor(const point3D_t point3D_id,
 
 void PointColormapTrackLen::Prepare(EIGEN_STL_UMAP(camera_t, Camera) & cameras,
                                     EIGEN_STL_UMAP(image_t, Image) & images,
-                                    EIGEN_STL_UMAP(point3D_t, Point3D) &
-                                        points3D,
+                                    DenseIdMap<point3D_t, Point3D>& points3D,
                                     std::vector<image_t>& reg_image_ids) {
   std::vector<float> track_lengths;
   track_lengths.reserve(points3D.size());
@@ -125,7 +123,7 @@ Eigen::Vector4f PointColormapTrackLen::ComputeColor(const point3D_t point3D_id,
 void PointColormapGroundResolution::Prepare(
     EIGEN_STL_UMAP(camera_t, Camera) & cameras,
     EIGEN_STL_UMAP(image_t, Image) & images,
-    EIGEN_STL_UMAP(point3D_t, Point3D) & points3D,
+    DenseIdMap<point3D_t, Point3D>& points3D,
     std::vector<image_t>& reg_image_ids) {
   std::vector<float> resolutions;
   resolutions.reserve(points3D.size());
@@ -212,8 +210,7 @@ ImageColormapBase::ImageColormapBase() {}
 
 void ImageColormapUniform::Prepare(EIGEN_STL_UMAP(camera_t, Camera) & cameras,
                                    EIGEN_STL_UMAP(image_t, Image) & images,
-                                   EIGEN_STL_UMAP(point3D_t, Point3D) &
-                                       points3D,
+                                   DenseIdMap<point3D_t, Point3D>& points3D,
                                    std::vector<image_t>& reg_image_ids) {}
 
 void ImageColormapUniform::ComputeColor(const Image& image,
@@ -226,8 +223,7 @@ void ImageColormapUniform::ComputeColor(const Image& image,
 void ImageColormapNameFilter::Prepare(EIGEN_STL_UMAP(camera_t, Camera) &
                                           cameras,
                                       EIGEN_STL_UMAP(image_t, Image) & images,
-                                      EIGEN_STL_UMAP(point3D_t, Point3D) &
-                                          points3D,
+                                      DenseIdMap<point3D_t, Point3D>& points3D,
                                       std::vector<image_t>& reg_image_ids) {}
 
 void ImageColormapNameFilter::AddColorForWord(
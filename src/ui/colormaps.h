@@ -48,7 +48,7 @@ class PointColormapBase {
 
   virtual void Prepare(EIGEN_STL_UMAP(camera_t, Camera) & cameras,
                        EIGEN_STL_UMAP(image_t, Image) & images,
-                       EIGEN_STL_UMAP(point3D_t, Point3D) & points3D,
+                       DenseIdMap<point3D_t, Point3D>& points3D,
                        std::vector<image_t>& reg_image_ids) = 0;
 
   virtual Eigen::Vector4f ComputeColor(const point3D_t point3D_id,
@@ -70,7 +70,7 @@ class PointColormapPhotometric : public PointColormapBase {
  public:
   void Prepare(EIGEN_STL_UMAP(camera_t, Camera) & cameras,
                EIGEN_STL_UMAP(image_t, Image) & images,
-               EIGEN_STL_UMAP(point3D_t, Point3D) & points3D,
+               DenseIdMap<point3D_t, Point3D>& points3D,
                std::vector<image_t>& reg_image_ids) override;
 
   Eigen::Vector4f ComputeColor(const point3D_t point3D_id,
@@ -82,7 +82,7 @@ class PointColormapError : public PointColormapBase {
  public:
   void Prepare(EIGEN_STL_UMAP(camera_t, Camera) & cameras,
                EIGEN_STL_UMAP(image_t, Image) & images,
-               EIGEN_STL_UMAP(point3D_t, Point3D) & points3D,
+               DenseIdMap<point3D_t, Point3D>& points3D,
                std::vector<image_t>& reg_image_ids) override;
 
   Eigen::Vector4f ComputeColor(const point3D_t point3D_id,
@@ -94,7 +94,7 @@ class PointColormapTrackLen : public PointColormapBase {
  public:
   void Prepare(EIGEN_STL_UMAP(camera_t, Camera) & cameras,
                EIGEN_STL_UMAP(image_t, Image) & images,
-               EIGEN_STL_UMAP(point3D_t, Point3D) & points3D,
+               DenseIdMap<point3D_t, Point3D>& points3D,
                std::vector<image_t>& reg_image_ids) override;
 
   Eigen::Vector4f ComputeColor(const point3D_t point3D_id,
@@ -106,7 +106,7 @@ class PointColormapGroundResolution : public PointColormapBase {
  public:
   void Prepare(EIGEN_STL_UMAP(camera_t, Camera) & cameras,
                EIGEN_STL_UMAP(image_t, Image) & images,
-               EIGEN_STL_UMAP(point3D_t, Point3D) & points3D,
+               DenseIdMap<point3D_t, Point3D>& points3D,
                std::vector<image_t>& reg_image_ids) override;
 
   Eigen::Vector4f ComputeColor(const point3D_t point3D_id,
@@ -124,7 +124,7 @@ class ImageColormapBase {
 
   virtual void Prepare(EIGEN_STL_UMAP(camera_t, Camera) & cameras,
                        EIGEN_STL_UMAP(image_t, Image) & images,
-                       EIGEN_STL_UMAP(point3D_t, Point3D) & points3D,
+                       DenseIdMap<point3D_t, Point3D>& points3D,
                        std::vector<image_t>& reg_image_ids) = 0;
 
   virtual void ComputeColor(const Image& image, Eigen::Vector4f* plane_color,
@@ -139,7 +139,7 @@ class ImageColormapUniform : public ImageColormapBase {
  public:
   void Prepare(EIGEN_STL_UMAP(camera_t, Camera) & cameras,
                EIGEN_STL_UMAP(image_t, Image) & images,
-               EIGEN_STL_UMAP(point3D_t, Point3D) & points3D,
+               DenseIdMap<point3D_t, Point3D>& points3D,
                std::vector<image_t>& reg_image_ids) override;
 
   void ComputeColor(const Image& image, Eigen::Vector4f* plane_color,
@@ -154,7 +154,7 @@ class ImageColormapNameFilter : public ImageColormapBase {
  public:
   void Prepare(EIGEN_STL_UMAP(camera_t, Camera) & cameras,
                EIGEN_STL_UMAP(image_t, Image) & images,
-               EIGEN_STL_UMAP(point3D_t, Point3D) & points3D,
+               DenseIdMap<point3D_t, Point3D>& points3D,
                std::vector<image_t>& reg_image_ids) override;
 
   void AddColorForWord(const std::string& word,
@@ -71,6 +71,19 @@ class StereoOptionsTab : public OptionsWidget {
                     "incident_angle_sigma");
     AddOptionInt(&options->patch_match_stereo->num_iterations,
                  "num_iterations");
+    AddOptionBool(&options->patch_match_stereo->checkerboard_propagation,
+                  "checkerboard_propagation");
+    AddOptionBool(&options->patch_match_stereo->init_from_sparse_points,
+                  "init_from_sparse_points");
+    AddOptionInt(&options->patch_match_stereo->num_pyramid_levels,
+                 "num_pyramid_levels", 1);
+    AddOptionInt(&options->patch_match_stereo->pyramid_num_iterations,
+                 "pyramid_num_iterations", 1);
+    AddOptionDouble(&options->patch_match_stereo->pyramid_depth_range,
+                    "pyramid_depth_range", 0, 1);
+    AddOptionInt(&options->patch_match_stereo->tile_size, "tile_size", -1);
+    AddOptionInt(&options->patch_match_stereo->tile_overlap, "tile_overlap",
+                 0);
     AddOptionBool(&options->patch_match_stereo->geom_consistency,
                   "geom_consistency");
     AddOptionDouble(&options->patch_match_stereo->geom_consistency_regularizer,
@@ -91,8 +104,15 @@ class StereoOptionsTab : public OptionsWidget {
     AddOptionDouble(&options->patch_match_stereo->cache_size,
                     "cache_size [gigabytes]", 0,
                     std::numeric_limits<double>::max(), 0.1, 1);
+    AddOptionDouble(&options->patch_match_stereo->gpu_cache_size,
+                    "gpu_cache_size [gigabytes]", 0,
+                    std::numeric_limits<double>::max(), 0.1, 1);
     AddOptionBool(&options->patch_match_stereo->write_consistency_graph,
                   "write_consistency_graph");
+    AddOptionBool(&options->patch_match_stereo->write_compact_maps,
+                  "write_compact_maps");
+    AddOptionBool(&options->patch_match_stereo->write_confidence_map,
+                  "write_confidence_map");
   }
 };
 
@@ -116,6 +136,15 @@ class FusionOptionsTab : public OptionsWidget {
     AddOptionDouble(&options->stereo_fusion->cache_size,
                     "cache_size [gigabytes]", 0,
                     std::numeric_limits<double>::max(), 0.1, 1);
+    AddOptionInt(&options->stereo_fusion->num_threads, "num_threads", -1);
+    AddOptionBool(&options->stereo_fusion->compact_maps, "compact_maps");
+    AddOptionBool(&options->stereo_fusion->mmap_maps, "mmap_maps");
+    AddOptionInt(&options->stereo_fusion->min_confidence, "min_confidence", 0);
+    AddOptionBool(&options->stereo_fusion->use_gpu, "use_gpu");
+    AddOptionInt(&options->stereo_fusion->gpu_index, "gpu_index", -1);
+    AddOptionDouble(&options->stereo_fusion->gpu_cache_size,
+                    "gpu_cache_size [gigabytes]", 0,
+                    std::numeric_limits<double>::max(), 0.1, 1);
   }
 };
 
@@ -129,6 +158,10 @@ class MeshingOptionsTab : public OptionsWidget {
     AddOptionDouble(&options->poisson_meshing->color, "color", 0);
     AddOptionDouble(&options->poisson_meshing->trim, "trim", 0);
     AddOptionInt(&options->poisson_meshing->num_threads, "num_threads", -1);
+    AddOptionInt(&options->poisson_meshing->max_tile_num_points,
+                 "max_tile_num_points", 0);
+    AddOptionDouble(&options->poisson_meshing->tile_overlap, "tile_overlap",
+                    0);
 
     AddSection("Delaunay Meshing");
     AddOptionDouble(&options->delaunay_meshing->max_proj_dist, "max_proj_dist",
@@ -143,6 +176,8 @@ class MeshingOptionsTab : public OptionsWidget {
                     "max_side_length_factor", 0);
     AddOptionDouble(&options->delaunay_meshing->max_side_length_percentile,
                     "max_side_length_percentile", 0);
+    AddOptionBool(&options->delaunay_meshing->parallel_graph_cut,
+                  "parallel_graph_cut");
     AddOptionInt(&options->delaunay_meshing->num_threads, "num_threads", -1);
   }
 };
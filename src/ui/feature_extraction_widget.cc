@@ -104,6 +104,8 @@ SIFTExtractionWidget::SIFTExtractionWidget(QWidget* parent,
   AddOptionInt(&options->sift_extraction->num_threads, "num_threads", -1);
   AddOptionBool(&options->sift_extraction->use_gpu, "use_gpu");
   AddOptionText(&options->sift_extraction->gpu_index, "gpu_index");
+  AddOptionText(&options->sift_extraction->num_gpu_contexts,
+                "num_gpu_contexts");
 }
 
 void SIFTExtractionWidget::Run() {
@@ -136,7 +138,8 @@ void ImportFeaturesWidget::Run() {
   reader_options.database_path = *options_->database_path;
   reader_options.image_path = *options_->image_path;
 
-  Thread* importer = new FeatureImporter(reader_options, import_path_);
+  Thread* importer = new FeatureImporter(
+      reader_options, import_path_, options_->sift_extraction->num_threads);
   thread_control_widget_->StartThread("Importing...", true, importer);
 }
 
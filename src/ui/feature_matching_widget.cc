@@ -132,6 +132,8 @@ void FeatureMatchingTab::CreateGeneralOptions() {
                                  "multiple_models");
   options_widget_->AddOptionBool(&options_->sift_matching->guided_matching,
                                  "guided_matching");
+  options_widget_->AddOptionBool(&options_->sift_matching->compress_matches,
+                                 "compress_matches");
 
   options_widget_->AddSpacer();
 
@@ -175,6 +177,9 @@ SequentialMatchingTab::SequentialMatchingTab(QWidget* parent,
   options_widget_->AddOptionInt(
       &options_->sequential_matching->loop_detection_period,
       "loop_detection_period");
+  options_widget_->AddOptionInt(
+      &options_->sequential_matching->loop_detection_exclusion_window,
+      "loop_detection_exclusion_window", 0);
   options_widget_->AddOptionInt(
       &options_->sequential_matching->loop_detection_num_images,
       "loop_detection_num_images");
@@ -227,6 +232,8 @@ VocabTreeMatchingTab::VocabTreeMatchingTab(QWidget* parent,
       "num_images_after_verification", 0);
   options_widget_->AddOptionInt(
       &options_->vocab_tree_matching->max_num_features, "max_num_features", -1);
+  options_widget_->AddOptionBool(&options_->vocab_tree_matching->use_gpu,
+                                 "use_gpu");
   options_widget_->AddOptionFilePath(
       &options_->vocab_tree_matching->vocab_tree_path, "vocab_tree_path");
 
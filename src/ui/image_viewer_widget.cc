@@ -33,11 +33,52 @@
 
 #include "ui/model_viewer_widget.h"
 #include "util/misc.h"
+#include "util/thumbnail_cache.h"
 
 namespace colmap {
+namespace {
+
+// Maximum width and height of the thumbnails shown while the full resolution
+// images are decoded.
+const int kThumbnailSize = 512;
+
+// The thumbnail cache shared by all image viewers, or null if there is no
+// writable cache location.
+const ThumbnailCache* GetThumbnailCache() {
+  static const std::unique_ptr<ThumbnailCache> thumbnail_cache = []() {
+    const std::string cache_path =
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            .toUtf8()
+            .constData();
+    if (cache_path.empty()) {
+      return std::unique_ptr<ThumbnailCache>();
+    }
+    return std::unique_ptr<ThumbnailCache>(new ThumbnailCache(
+        JoinPaths(cache_path, "thumbnails"), kThumbnailSize));
+  }();
+  return thumbnail_cache.get();
+}
+
+}  // namespace
 
 const double ImageViewerWidget::kZoomFactor = 1.20;
 
+struct ImageViewerWidget::ReadRequest {
+  std::vector<std::string> paths;
+  std::function<void(const std::vector<QImage>&)> show_func;
+
+  // Set by the UI thread, if the request was superseded.
+  std::atomic<bool> canceled{false};
+
+  // Written by the reading thread and consumed by the UI thread.
+  std::mutex mutex;
+  bool thumbnails_read = false;
+  bool thumbnails_shown = false;
+  std::vector<QImage> thumbnails;
+  bool images_read = false;
+  std::vector<QImage> images;
+};
+
 ImageViewerGraphicsScene::ImageViewerGraphicsScene() {
   setSceneRect(0, 0, 0, 0);
   image_pixmap_item_ = addPixmap(QPixmap::fromImage(QImage()));
@@ -48,7 +89,8 @@ QGraphicsPixmapItem* ImageViewerGraphicsScene::ImagePixmapItem() const {
   return image_pixmap_item_;
 }
 
-ImageViewerWidget::ImageViewerWidget(QWidget* parent) : QWidget(parent) {
+ImageViewerWidget::ImageViewerWidget(QWidget* parent)
+    : QWidget(parent), read_thread_pool_(1) {
   setWindowFlags(Qt::Window | Qt::WindowTitleHint |
                  Qt::WindowMinimizeButtonHint | Qt::WindowMaximizeButtonHint |
                  Qt::WindowCloseButtonHint);
@@ -92,6 +134,10 @@ ImageViewerWidget::ImageViewerWidget(QWidget* parent) : QWidget(parent) {
   connect(save_button, &QPushButton::released, this, &ImageViewerWidget::Save);
 
   grid_layout_->addLayout(button_layout_, 2, 0, Qt::AlignRight);
+
+  read_timer_.setInterval(10);
+  connect(&read_timer_, &QTimer::timeout, this,
+          &ImageViewerWidget::PollReadRequest);
 }
 
 void ImageViewerWidget::resizeEvent(QResizeEvent* event) {
@@ -101,6 +147,11 @@ void ImageViewerWidget::resizeEvent(QResizeEvent* event) {
 }
 
 void ImageViewerWidget::closeEvent(QCloseEvent* event) {
+  if (read_request_) {
+    read_request_->canceled = true;
+    read_request_.reset();
+    read_timer_.stop();
+  }
   graphics_scene_.ImagePixmapItem()->setPixmap(QPixmap());
 }
 
@@ -119,12 +170,101 @@ void ImageViewerWidget::ShowPixmap(const QPixmap& pixmap) {
 }
 
 void ImageViewerWidget::ReadAndShow(const std::string& path) {
-  Bitmap bitmap;
-  if (!bitmap.Read(path, true)) {
-    std::cerr << "ERROR: Cannot read image at path " << path << std::endl;
+  ReadAsync({path}, [this, path](const std::vector<QImage>& images) {
+    if (images[0].isNull()) {
+      std::cerr << "ERROR: Cannot read image at path " << path << std::endl;
+    }
+    ShowPixmap(QPixmap::fromImage(images[0]));
+  });
+}
+
+void ImageViewerWidget::ReadAsync(
+    const std::vector<std::string>& paths,
+    const std::function<void(const std::vector<QImage>&)>& show_func) {
+  if (read_request_) {
+    read_request_->canceled = true;
+  }
+
+  read_request_ = std::make_shared<ReadRequest>();
+  read_request_->paths = paths;
+  read_request_->show_func = show_func;
+
+  const std::shared_ptr<ReadRequest> request = read_request_;
+  read_thread_pool_.AddTask([request]() {
+    if (request->canceled) {
+      return;
+    }
+
+    const ThumbnailCache* thumbnail_cache = GetThumbnailCache();
+
+    // Show the cached thumbnails before decoding the full resolution images,
+    // which can take seconds for large images.
+    std::vector<QImage> thumbnails;
+    std::vector<bool> has_thumbnails;
+    for (const auto& path : request->paths) {
+      Bitmap thumbnail;
+      has_thumbnails.push_back(thumbnail_cache != nullptr &&
+                               thumbnail_cache->Read(path, &thumbnail));
+      if (has_thumbnails.back()) {
+        thumbnails.push_back(BitmapToQImageRGB(thumbnail));
+      }
+    }
+
+    if (thumbnails.size() == request->paths.size()) {
+      std::unique_lock<std::mutex> lock(request->mutex);
+      request->thumbnails = std::move(thumbnails);
+      request->thumbnails_read = true;
+    }
+
+    std::vector<QImage> images;
+    for (size_t i = 0; i < request->paths.size(); ++i) {
+      if (request->canceled) {
+        return;
+      }
+      Bitmap bitmap;
+      if (bitmap.Read(request->paths[i], true)) {
+        if (thumbnail_cache != nullptr && !has_thumbnails[i]) {
+          thumbnail_cache->Write(request->paths[i], bitmap);
+        }
+        images.push_back(BitmapToQImageRGB(bitmap));
+      } else {
+        images.emplace_back();
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(request->mutex);
+    request->images = std::move(images);
+    request->images_read = true;
+  });
+
+  read_timer_.start();
+}
+
+void ImageViewerWidget::PollReadRequest() {
+  if (!read_request_) {
+    read_timer_.stop();
+    return;
   }
 
-  ShowBitmap(bitmap);
+  std::unique_lock<std::mutex> lock(read_request_->mutex);
+
+  if (read_request_->images_read) {
+    const std::shared_ptr<ReadRequest> request = read_request_;
+    read_request_.reset();
+    read_timer_.stop();
+    lock.unlock();
+    request->show_func(request->images);
+  } else if (read_request_->thumbnails_read &&
+             !read_request_->thumbnails_shown) {
+    read_request_->thumbnails_shown = true;
+    QPixmap thumbnail = QPixmap::fromImage(read_request_->thumbnails[0]);
+    for (size_t i = 1; i < read_request_->thumbnails.size(); ++i) {
+      thumbnail = ShowImagesSideBySide(
+          thumbnail, QPixmap::fromImage(read_request_->thumbnails[i]));
+    }
+    lock.unlock();
+    ShowPixmap(thumbnail);
+  }
 }
 
 void ImageViewerWidget::ZoomIn() {
@@ -167,12 +307,19 @@ FeatureImageViewerWidget::FeatureImageViewerWidget(
 void FeatureImageViewerWidget::ReadAndShowWithKeypoints(
     const std::string& path, const FeatureKeypoints& keypoints,
     const std::vector<char>& tri_mask) {
-  Bitmap bitmap;
-  if (!bitmap.Read(path, true)) {
-    std::cerr << "ERROR: Cannot read image at path " << path << std::endl;
-  }
+  ReadAsync({path}, [this, path, keypoints,
+                     tri_mask](const std::vector<QImage>& images) {
+    if (images[0].isNull()) {
+      std::cerr << "ERROR: Cannot read image at path " << path << std::endl;
+    }
+    ShowWithKeypoints(QPixmap::fromImage(images[0]), keypoints, tri_mask);
+  });
+}
 
-  image1_ = QPixmap::fromImage(BitmapToQImageRGB(bitmap));
+void FeatureImageViewerWidget::ShowWithKeypoints(
+    const QPixmap& image, const FeatureKeypoints& keypoints,
+    const std::vector<char>& tri_mask) {
+  image1_ = image;
   image2_ = image1_;
 
   const size_t num_tri_keypoints = std::count_if(
@@ -206,17 +353,24 @@ void FeatureImageViewerWidget::ReadAndShowWithMatches(
     const std::string& path1, const std::string& path2,
     const FeatureKeypoints& keypoints1, const FeatureKeypoints& keypoints2,
     const FeatureMatches& matches) {
-  Bitmap bitmap1;
-  Bitmap bitmap2;
-  if (!bitmap1.Read(path1, true) || !bitmap2.Read(path2, true)) {
-    std::cerr << "ERROR: Cannot read images at paths " << path1 << " and "
-              << path2 << std::endl;
-    return;
-  }
-
-  const auto image1 = QPixmap::fromImage(BitmapToQImageRGB(bitmap1));
-  const auto image2 = QPixmap::fromImage(BitmapToQImageRGB(bitmap2));
+  ReadAsync({path1, path2},
+            [this, path1, path2, keypoints1, keypoints2,
+             matches](const std::vector<QImage>& images) {
+              if (images[0].isNull() || images[1].isNull()) {
+                std::cerr << "ERROR: Cannot read images at paths " << path1
+                          << " and " << path2 << std::endl;
+                return;
+              }
+              ShowWithMatches(QPixmap::fromImage(images[0]),
+                              QPixmap::fromImage(images[1]), keypoints1,
+                              keypoints2, matches);
+            });
+}
 
+void FeatureImageViewerWidget::ShowWithMatches(
+    const QPixmap& image1, const QPixmap& image2,
+    const FeatureKeypoints& keypoints1, const FeatureKeypoints& keypoints2,
+    const FeatureMatches& matches) {
   image1_ = ShowImagesSideBySide(image1, image2);
   image2_ = DrawMatches(image1, image2, keypoints1, keypoints2, matches);
 
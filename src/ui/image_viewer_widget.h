@@ -32,6 +32,9 @@
 #ifndef COLMAP_SRC_UI_IMAGE_VIEWER_WIDGET_H_
 #define COLMAP_SRC_UI_IMAGE_VIEWER_WIDGET_H_
 
+#include <functional>
+#include <memory>
+
 #include <QtCore>
 #include <QtWidgets>
 
@@ -40,6 +43,7 @@
 #include "base/reconstruction.h"
 #include "ui/qt_utils.h"
 #include "util/option_manager.h"
+#include "util/threading.h"
 
 namespace colmap {
 
@@ -66,9 +70,18 @@ class ImageViewerWidget : public QWidget {
  private:
   static const double kZoomFactor;
 
+  struct ReadRequest;
+
+  void PollReadRequest();
+
   ImageViewerGraphicsScene graphics_scene_;
   QGraphicsView* graphics_view_;
 
+  // Decodes the images in the background, so that the UI stays responsive.
+  ThreadPool read_thread_pool_;
+  std::shared_ptr<ReadRequest> read_request_;
+  QTimer read_timer_;
+
  protected:
   void resizeEvent(QResizeEvent* event);
   void closeEvent(QCloseEvent* event);
@@ -76,6 +89,15 @@ class ImageViewerWidget : public QWidget {
   void ZoomOut();
   void Save();
 
+  // Read the images at the given paths in the background. The cached
+  // thumbnails of the images are shown side by side as soon as available,
+  // while the full resolution images are decoded. Then, `show_func` is called
+  // on the UI thread with the decoded images, where images that could not be
+  // read are null. A new request supersedes any pending request.
+  void ReadAsync(
+      const std::vector<std::string>& paths,
+      const std::function<void(const std::vector<QImage>&)>& show_func);
+
   QGridLayout* grid_layout_;
   QHBoxLayout* button_layout_;
 };
@@ -95,6 +117,13 @@ class FeatureImageViewerWidget : public ImageViewerWidget {
                               const FeatureMatches& matches);
 
  protected:
+  void ShowWithKeypoints(const QPixmap& image,
+                         const FeatureKeypoints& keypoints,
+                         const std::vector<char>& tri_mask);
+  void ShowWithMatches(const QPixmap& image1, const QPixmap& image2,
+                       const FeatureKeypoints& keypoints1,
+                       const FeatureKeypoints& keypoints2,
+                       const FeatureMatches& matches);
   void ShowOrHide();
 
   QPixmap image1_;
@@ -32,58 +32,217 @@
 #include "ui/match_matrix_widget.h"
 
 namespace colmap {
+namespace {
 
-MatchMatrixWidget::MatchMatrixWidget(QWidget* parent, OptionManager* options)
-    : ImageViewerWidget(parent), options_(options) {
-  setWindowTitle("Match matrix");
-}
+// The maximum number of cells per dimension of the match matrix, which bounds
+// the memory and the time to render the matrix for large databases.
+const size_t kMaxMatchMatrixSize = 4096;
 
-void MatchMatrixWidget::Show() {
-  Database database(*options_->database_path);
+// The interval in seconds, in which the visible match matrix is updated.
+const double kMatchMatrixUpdateInterval = 5.0;
 
-  if (database.NumImages() == 0) {
-    return;
-  }
+}  // namespace
 
-  // Sort the images according to their name.
-  std::vector<Image> images = database.ReadAllImages();
-  std::sort(images.begin(), images.end(),
-            [](const Image& image1, const Image& image2) {
-              return image1.Name() < image2.Name();
-            });
+MatchMatrix::MatchMatrix(const size_t max_size)
+    : max_size_(max_size), size_(0) {
+  CHECK_GT(max_size_, 0);
+}
 
-  // Allocate the match matrix image.
-  Bitmap match_matrix;
-  match_matrix.Allocate(images.size(), images.size(), true);
-  match_matrix.Fill(BitmapColor<uint8_t>(255));
+size_t MatchMatrix::Size() const { return size_; }
 
-  // Map image identifiers to match matrix locations.
-  std::unordered_map<image_t, size_t> image_id_to_idx;
-  for (size_t idx = 0; idx < images.size(); ++idx) {
-    image_id_to_idx.emplace(images[idx].ImageId(), idx);
+bool MatchMatrix::Update(const Database& database) {
+  bool rebuild = false;
+
+  // Images are only read, if images were added, and then sorted according to
+  // their name. Multiple images share a cell, if there are too many images.
+  if (database.NumImages() != image_id_to_cell_idx_.size()) {
+    std::vector<Image> images = database.ReadAllImages();
+    std::sort(images.begin(), images.end(),
+              [](const Image& image1, const Image& image2) {
+                return image1.Name() < image2.Name();
+              });
+    size_ = std::min(max_size_, images.size());
+    image_id_to_cell_idx_.clear();
+    image_id_to_cell_idx_.reserve(images.size());
+    for (size_t idx = 0; idx < images.size(); ++idx) {
+      image_id_to_cell_idx_.emplace(images[idx].ImageId(),
+                                    idx * size_ / images.size());
+    }
+    rebuild = true;
   }
 
   std::vector<std::pair<image_t, image_t>> image_pairs;
   std::vector<int> num_inliers;
   database.ReadTwoViewGeometryNumInliers(&image_pairs, &num_inliers);
 
-  // Fill the match matrix.
-  if (!num_inliers.empty()) {
-    const double max_value =
-        std::log1p(*std::max_element(num_inliers.begin(), num_inliers.end()));
-    for (size_t i = 0; i < image_pairs.size(); ++i) {
-      const double value = std::log1p(num_inliers[i]) / max_value;
-      const size_t idx1 = image_id_to_idx.at(image_pairs[i].first);
-      const size_t idx2 = image_id_to_idx.at(image_pairs[i].second);
+  std::unordered_map<image_pair_t, int> prev_num_inliers;
+  prev_num_inliers.swap(num_inliers_);
+  num_inliers_.reserve(image_pairs.size());
+
+  std::vector<image_pair_t> changed_pair_ids;
+  size_t num_prev_pairs = 0;
+  for (size_t i = 0; i < image_pairs.size(); ++i) {
+    const image_pair_t pair_id = Database::ImagePairToPairId(
+        image_pairs[i].first, image_pairs[i].second);
+    num_inliers_[pair_id] = num_inliers[i];
+    const auto prev_it = prev_num_inliers.find(pair_id);
+    if (prev_it == prev_num_inliers.end()) {
+      changed_pair_ids.push_back(pair_id);
+      continue;
+    }
+    num_prev_pairs += 1;
+    if (num_inliers[i] < prev_it->second) {
+      rebuild = true;
+    } else if (num_inliers[i] > prev_it->second) {
+      changed_pair_ids.push_back(pair_id);
+    }
+  }
+
+  // The maximum of a cell cannot be updated, if image pairs were removed.
+  if (num_prev_pairs < prev_num_inliers.size()) {
+    rebuild = true;
+  }
+
+  if (rebuild) {
+    cells_.assign(size_ * size_, 0);
+    for (const auto& pair_num_inliers : num_inliers_) {
+      UpdateCell(pair_num_inliers.first, pair_num_inliers.second);
+    }
+  } else {
+    for (const image_pair_t pair_id : changed_pair_ids) {
+      UpdateCell(pair_id, num_inliers_.at(pair_id));
+    }
+  }
+
+  return rebuild || !changed_pair_ids.empty();
+}
+
+Bitmap MatchMatrix::Render() const {
+  Bitmap match_matrix;
+  match_matrix.Allocate(size_, size_, true);
+  match_matrix.Fill(BitmapColor<uint8_t>(255));
+
+  if (cells_.empty()) {
+    return match_matrix;
+  }
+
+  const double max_value =
+      std::log1p(*std::max_element(cells_.begin(), cells_.end()));
+  for (size_t idx1 = 0; idx1 < size_; ++idx1) {
+    for (size_t idx2 = 0; idx2 < size_; ++idx2) {
+      const int num_inliers = cells_[idx1 * size_ + idx2];
+      if (num_inliers == 0) {
+        continue;
+      }
+      const double value = std::log1p(num_inliers) / max_value;
       const BitmapColor<float> color(255 * JetColormap::Red(value),
                                      255 * JetColormap::Green(value),
                                      255 * JetColormap::Blue(value));
       match_matrix.SetPixel(idx1, idx2, color.Cast<uint8_t>());
-      match_matrix.SetPixel(idx2, idx1, color.Cast<uint8_t>());
     }
   }
 
-  ShowBitmap(match_matrix);
+  return match_matrix;
+}
+
+void MatchMatrix::UpdateCell(const image_pair_t pair_id,
+                             const int num_inliers) {
+  image_t image_id1;
+  image_t image_id2;
+  Database::PairIdToImagePair(pair_id, &image_id1, &image_id2);
+
+  // Images that were added after the images were read are skipped.
+  const auto cell_idx1_it = image_id_to_cell_idx_.find(image_id1);
+  const auto cell_idx2_it = image_id_to_cell_idx_.find(image_id2);
+  if (cell_idx1_it == image_id_to_cell_idx_.end() ||
+      cell_idx2_it == image_id_to_cell_idx_.end()) {
+    return;
+  }
+
+  const size_t cell_idx1 = cell_idx1_it->second;
+  const size_t cell_idx2 = cell_idx2_it->second;
+  int& cell1 = cells_[cell_idx1 * size_ + cell_idx2];
+  int& cell2 = cells_[cell_idx2 * size_ + cell_idx1];
+  cell1 = std::max(cell1, num_inliers);
+  cell2 = std::max(cell2, num_inliers);
+}
+
+MatchMatrixWidget::MatchMatrixWidget(QWidget* parent, OptionManager* options)
+    : ImageViewerWidget(parent),
+      options_(options),
+      image_updated_(false),
+      update_thread_pool_(1) {
+  setWindowTitle("Match matrix");
+
+  poll_timer_.setInterval(100);
+  connect(&poll_timer_, &QTimer::timeout, this,
+          &MatchMatrixWidget::PollUpdate);
+}
+
+void MatchMatrixWidget::Show() {
+  {
+    std::unique_lock<std::mutex> lock(image_mutex_);
+    if (!image_.isNull()) {
+      ShowPixmap(QPixmap::fromImage(image_));
+    }
+  }
+
+  UpdateAsync();
+  poll_timer_.start();
+}
+
+void MatchMatrixWidget::UpdateAsync() {
+  if (update_future_.valid()) {
+    return;
+  }
+
+  const std::string database_path = *options_->database_path;
+  update_timer_.Restart();
+  update_future_ = update_thread_pool_.AddTask([this, database_path]() {
+    Database database(database_path);
+
+    if (!match_matrix_ || database_path_ != database_path) {
+      database_path_ = database_path;
+      match_matrix_.reset(new MatchMatrix(kMaxMatchMatrixSize));
+    }
+
+    if (!match_matrix_->Update(database) || match_matrix_->Size() == 0) {
+      return;
+    }
+
+    QImage image = BitmapToQImageRGB(match_matrix_->Render());
+
+    std::unique_lock<std::mutex> lock(image_mutex_);
+    image_ = std::move(image);
+    image_updated_ = true;
+  });
+}
+
+void MatchMatrixWidget::PollUpdate() {
+  if (update_future_.valid() &&
+      update_future_.wait_for(std::chrono::seconds(0)) ==
+          std::future_status::ready) {
+    update_future_.get();
+
+    std::unique_lock<std::mutex> lock(image_mutex_);
+    if (image_updated_) {
+      image_updated_ = false;
+      if (isVisible()) {
+        ShowPixmap(QPixmap::fromImage(image_));
+      }
+    }
+  }
+
+  if (!isVisible()) {
+    if (!update_future_.valid()) {
+      poll_timer_.stop();
+    }
+    return;
+  }
+
+  if (update_timer_.ElapsedSeconds() >= kMatchMatrixUpdateInterval) {
+    UpdateAsync();
+  }
 }
 
 }  // namespace colmap
@@ -32,12 +32,49 @@
 #ifndef COLMAP_SRC_UI_MATCH_MATRIX_WIDGET_H_
 #define COLMAP_SRC_UI_MATCH_MATRIX_WIDGET_H_
 
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
 #include "ui/image_viewer_widget.h"
 #include "util/option_manager.h"
+#include "util/timer.h"
 
 namespace colmap {
 
-// Widget to visualize match matrix.
+// Match matrix of a database, in which the images are sorted by name and each
+// cell holds the maximum number of inlier matches between two blocks of
+// images, such that the matrix has at most `max_size` cells per dimension
+// independent of the number of images. Updates only read the number of inlier
+// matches of the image pairs and only redraw the cells of changed image pairs.
+class MatchMatrix {
+ public:
+  explicit MatchMatrix(const size_t max_size);
+
+  // The number of cells per dimension.
+  size_t Size() const;
+
+  // Read the image pairs from the database and update the cells of the new
+  // image pairs. The matrix is only rebuilt, if images were added or image
+  // pairs were removed or lost inliers. Returns whether the matrix changed.
+  bool Update(const Database& database);
+
+  // Render the matrix with the jet colormap on a white background.
+  Bitmap Render() const;
+
+ private:
+  void UpdateCell(const image_pair_t pair_id, const int num_inliers);
+
+  const size_t max_size_;
+  size_t size_;
+  std::unordered_map<image_t, size_t> image_id_to_cell_idx_;
+  std::unordered_map<image_pair_t, int> num_inliers_;
+  std::vector<int> cells_;
+};
+
+// Widget to visualize match matrix. The matrix is cached and updated in the
+// background, while the widget is visible, so that new two-view geometries
+// written by the matcher appear without blocking the UI.
 class MatchMatrixWidget : public ImageViewerWidget {
  public:
   MatchMatrixWidget(QWidget* parent, OptionManager* options);
@@ -45,7 +82,28 @@ class MatchMatrixWidget : public ImageViewerWidget {
   void Show();
 
  private:
+  // Update the match matrix in the background, if no update is running.
+  void UpdateAsync();
+  void PollUpdate();
+
   OptionManager* options_;
+
+  // Only accessed by the update thread.
+  std::string database_path_;
+  std::unique_ptr<MatchMatrix> match_matrix_;
+
+  // Written by the update thread and consumed by the UI thread.
+  std::mutex image_mutex_;
+  QImage image_;
+  bool image_updated_;
+
+  Timer update_timer_;
+  QTimer poll_timer_;
+
+  // Declared last, so that a running update finishes before the members it
+  // accesses are destroyed.
+  std::future<void> update_future_;
+  ThreadPool update_thread_pool_;
 };
 
 }  // namespace colmap
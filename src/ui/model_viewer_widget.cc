@@ -31,6 +31,8 @@
 
 #include "ui/model_viewer_widget.h"
 
+#include <numeric>
+
 #include "ui/main_window.h"
 
 #define SELECTION_BUFFER_IMAGE_IDX 0
@@ -68,6 +70,73 @@ inline Eigen::Vector4f IndexToRGB(const size_t index) {
   return color;
 }
 
+// Interleave the lower 21 bits of the value with two zero bits each.
+inline uint64_t SpreadMortonBits(uint64_t value) {
+  value &= 0x1fffff;
+  value = (value | value << 32) & 0x1f00000000ffff;
+  value = (value | value << 16) & 0x1f0000ff0000ff;
+  value = (value | value << 8) & 0x100f00f00f00f00f;
+  value = (value | value << 4) & 0x10c30c30c30c30c3;
+  value = (value | value << 2) & 0x1249249249249249;
+  return value;
+}
+
+// Order the points such that every prefix of the order is a spatially uniform
+// subset of all points, similar to the levels of an octree. The points are
+// sorted along a Morton (Z-order) curve and then visited in the bit-reversed
+// order of their positions on the curve, so that the first points are spread
+// evenly over the curve and thus over the occupied space.
+std::vector<size_t> ComputeLevelOfDetailOrder(
+    const std::vector<Eigen::Vector3f>& positions) {
+  std::vector<size_t> order(positions.size());
+  std::iota(order.begin(), order.end(), 0);
+  if (positions.size() <= 1) {
+    return order;
+  }
+
+  Eigen::Vector3f min_bound = positions[0];
+  Eigen::Vector3f max_bound = positions[0];
+  for (const auto& position : positions) {
+    min_bound = min_bound.cwiseMin(position);
+    max_bound = max_bound.cwiseMax(position);
+  }
+
+  const float kMaxCoord = static_cast<float>((1 << 21) - 1);
+  const float extent = std::max((max_bound - min_bound).maxCoeff(), 1e-6f);
+  std::vector<uint64_t> codes(positions.size());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    const Eigen::Vector3f coords =
+        (positions[i] - min_bound) * (kMaxCoord / extent);
+    codes[i] = SpreadMortonBits(static_cast<uint64_t>(coords(0))) |
+               (SpreadMortonBits(static_cast<uint64_t>(coords(1))) << 1) |
+               (SpreadMortonBits(static_cast<uint64_t>(coords(2))) << 2);
+  }
+
+  std::sort(order.begin(), order.end(),
+            [&codes](const size_t idx1, const size_t idx2) {
+              return codes[idx1] < codes[idx2];
+            });
+
+  int num_bits = 0;
+  while ((size_t(1) << num_bits) < positions.size()) {
+    num_bits += 1;
+  }
+
+  std::vector<size_t> lod_order;
+  lod_order.reserve(positions.size());
+  for (size_t i = 0; i < (size_t(1) << num_bits); ++i) {
+    size_t reversed_i = 0;
+    for (int bit = 0; bit < num_bits; ++bit) {
+      reversed_i |= ((i >> bit) & 1) << (num_bits - 1 - bit);
+    }
+    if (reversed_i < positions.size()) {
+      lod_order.push_back(order[reversed_i]);
+    }
+  }
+
+  return lod_order;
+}
+
 void BuildImageModel(const Image& image, const Camera& camera,
                      const float image_size, const Eigen::Vector4f& plane_color,
                      const Eigen::Vector4f& frame_color,
@@ -201,6 +270,9 @@ ModelViewerWidget::ModelViewerWidget(QWidget* parent, OptionManager* options)
       focus_distance_(kInitFocusDistance),
       selected_image_id_(kInvalidImageId),
       selected_point3D_id_(kInvalidPoint3DId),
+      synced_reconstruction_(nullptr),
+      synced_version_(0),
+      upload_pending_(false),
       coordinate_grid_enabled_(true),
       near_plane_(kInitNearPlane) {
   background_color_[0] = 1.0f;
@@ -259,8 +331,26 @@ void ModelViewerWidget::paintGL() {
     coordinate_grid_painter_.Render(pmvc_matrix, width(), height(), 1);
   }
 
-  // Points
-  point_painter_.Render(pmv_matrix, point_size_);
+  // Points, where the budget of rendered points is proportional to the number
+  // of pixels, since any additional points would mostly be overdrawn, and it
+  // is further reduced while the view is moved to keep the interaction fluid.
+  const size_t num_pixels = static_cast<size_t>(
+      devicePixelRatio() * devicePixelRatio() * width() * height());
+  size_t max_num_points = static_cast<size_t>(
+      std::max(options_->render->max_num_points_per_pixel * num_pixels, 1.0));
+  if (mouse_is_pressed_) {
+    max_num_points = std::min(
+        max_num_points,
+        static_cast<size_t>(options_->render->max_num_interactive_points));
+  }
+  point_painter_.Render(pmv_matrix, point_size_, max_num_points);
+
+  // The selected points are drawn on top of the same points in the full
+  // point cloud, which requires equal depths to pass the depth test.
+  glDepthFunc(GL_LEQUAL);
+  selected_point_painter_.Render(pmv_matrix, point_size_);
+  glDepthFunc(GL_LESS);
+
   point_connection_painter_.Render(pmv_matrix, width(), height(), 1);
 
   // Images
@@ -285,20 +375,55 @@ void ModelViewerWidget::ReloadReconstruction() {
     return;
   }
 
+  // While a reconstruction is being built, only mirror the objects that
+  // changed since the last reload, so that the mapper is blocked as briefly
+  // as possible. Fall back to a full copy if the changes are not available.
+  ReconstructionChanges changes;
+  if (reconstruction == synced_reconstruction_ &&
+      reconstruction->ReadChanges(synced_version_, &changes)) {
+    for (const image_t image_id : changes.image_ids) {
+      if (reconstruction->ExistsImage(image_id) &&
+          reconstruction->IsImageRegistered(image_id)) {
+        images[image_id] = reconstruction->Image(image_id);
+      } else {
+        images.erase(image_id);
+      }
+    }
+    for (const point3D_t point3D_id : changes.point3D_ids) {
+      if (reconstruction->ExistsPoint3D(point3D_id)) {
+        points3D[point3D_id] = reconstruction->Point3D(point3D_id);
+      } else {
+        points3D.erase(point3D_id);
+      }
+    }
+  } else {
+    points3D = reconstruction->Points3D();
+    images.clear();
+    for (const image_t image_id : reconstruction->RegImageIds()) {
+      images[image_id] = reconstruction->Image(image_id);
+    }
+  }
+
   cameras = reconstruction->Cameras();
-  points3D = reconstruction->Points3D();
   reg_image_ids = reconstruction->RegImageIds();
 
-  images.clear();
-  for (const image_t image_id : reg_image_ids) {
-    images[image_id] = reconstruction->Image(image_id);
-  }
+  synced_reconstruction_ = reconstruction;
+  synced_version_ = reconstruction->Version();
 
   statusbar_status_label->setText(QString().sprintf(
       "%d Images - %d Points", static_cast<int>(reg_image_ids.size()),
       static_cast<int>(points3D.size())));
 
-  Upload();
+  // Upload the data once control returns to the event loop, since this method
+  // is invoked through a blocking connection from the reconstruction thread.
+  // Multiple reloads before the next upload are coalesced.
+  if (!upload_pending_) {
+    upload_pending_ = true;
+    QTimer::singleShot(0, this, [this]() {
+      upload_pending_ = false;
+      Upload();
+    });
+  }
 }
 
 void ModelViewerWidget::ClearReconstruction() {
@@ -307,6 +432,8 @@ void ModelViewerWidget::ClearReconstruction() {
   points3D.clear();
   reg_image_ids.clear();
   reconstruction = nullptr;
+  synced_reconstruction_ = nullptr;
+  synced_version_ = 0;
   Upload();
 }
 
@@ -474,14 +601,21 @@ void ModelViewerWidget::SelectObject(const int x, const int y) {
   glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  // Upload data in selection mode (one color per object).
+  // Upload images in selection mode (one color per object). The points are
+  // rendered with colors derived from their index in the uploaded points,
+  // which need not be uploaded again.
   UploadImageData(true);
-  UploadPointData(true);
 
   // Render in selection mode, with larger points to improve selection accuracy.
+  // Only the indices below the background color can be encoded, which limits
+  // the selectable points to a uniform subset of very large point clouds.
+  const size_t kMaxNumIndices = 256 * 256 * 256 - 1;
+  const size_t point_index_offset = selection_buffer_.size();
   const QMatrix4x4 pmv_matrix = projection_matrix_ * model_view_matrix_;
   image_triangle_painter_.Render(pmv_matrix);
-  point_painter_.Render(pmv_matrix, 2 * point_size_);
+  point_painter_.RenderIndices(
+      pmv_matrix, 2 * point_size_, point_index_offset,
+      kMaxNumIndices - std::min(kMaxNumIndices, point_index_offset));
 
   const int scaled_x = devicePixelRatio() * x;
   const int scaled_y = devicePixelRatio() * (height() - y - 1);
@@ -517,6 +651,10 @@ void ModelViewerWidget::SelectObject(const int x, const int y) {
       selected_point3D_id_ = kInvalidPoint3DId;
       image_viewer_widget_->hide();
     }
+  } else if (index - point_index_offset < point_ids_.size()) {
+    selected_image_id_ = kInvalidImageId;
+    selected_point3D_id_ = point_ids_[index - point_index_offset];
+    ShowPointInfo(selected_point3D_id_);
   } else {
     selected_image_id_ = kInvalidImageId;
     selected_point3D_id_ = kInvalidPoint3DId;
@@ -528,7 +666,7 @@ void ModelViewerWidget::SelectObject(const int x, const int y) {
 
   selection_buffer_.clear();
 
-  UploadPointData();
+  UploadSelectedPointData();
   UploadImageData();
   UploadPointConnectionData();
   UploadImageConnectionData();
@@ -621,6 +759,8 @@ void ModelViewerWidget::mousePressEvent(QMouseEvent* event) {
 
 void ModelViewerWidget::mouseReleaseEvent(QMouseEvent* event) {
   mouse_is_pressed_ = false;
+  // Render all points again, since fewer points are rendered while moving.
+  update();
   event->accept();
 }
 
@@ -660,6 +800,7 @@ void ModelViewerWidget::SetupPainters() {
   coordinate_grid_painter_.Setup();
 
   point_painter_.Setup();
+  selected_point_painter_.Setup();
   point_connection_painter_.Setup();
 
   image_line_painter_.Setup();
@@ -751,85 +892,87 @@ void ModelViewerWidget::UploadCoordinateGridData() {
   coordinate_axes_painter_.Upload(axes_data);
 }
 
-void ModelViewerWidget::UploadPointData(const bool selection_mode) {
+void ModelViewerWidget::UploadPointData() {
   makeCurrent();
 
-  std::vector<PointPainter::Data> data;
+  const size_t min_track_len =
+      static_cast<size_t>(options_->render->min_track_len);
+
+  std::vector<point3D_t> point3D_ids;
+  std::vector<Eigen::Vector3f> positions;
+  std::vector<Eigen::Vector4f> colors;
 
   // Assume we want to display the majority of points
-  data.reserve(points3D.size());
+  point3D_ids.reserve(points3D.size());
+  positions.reserve(points3D.size());
+  colors.reserve(points3D.size());
+
+  for (const auto& point3D : points3D) {
+    if (point3D.second.Error() <= options_->render->max_error &&
+        point3D.second.Track().Length() >= min_track_len) {
+      point3D_ids.push_back(point3D.first);
+      positions.push_back(point3D.second.XYZ().cast<float>());
+      colors.push_back(
+          point_colormap_->ComputeColor(point3D.first, point3D.second));
+    }
+  }
+
+  // The points are uploaded once in level of detail order, such that any
+  // number of points can be rendered at a uniform density.
+  const std::vector<size_t> order = ComputeLevelOfDetailOrder(positions);
+
+  std::vector<PointPainter::Data> data;
+  data.reserve(order.size());
+  point_ids_.clear();
+  point_ids_.reserve(order.size());
+  for (const size_t idx : order) {
+    data.emplace_back(positions[idx](0), positions[idx](1), positions[idx](2),
+                      colors[idx](0), colors[idx](1), colors[idx](2),
+                      colors[idx](3));
+    point_ids_.push_back(point3D_ids[idx]);
+  }
+
+  point_painter_.Upload(data);
+
+  UploadSelectedPointData();
+}
+
+void ModelViewerWidget::UploadSelectedPointData() {
+  makeCurrent();
 
   const size_t min_track_len =
       static_cast<size_t>(options_->render->min_track_len);
 
-  if (selected_image_id_ == kInvalidImageId &&
-      images.count(selected_image_id_) == 0) {
-    for (const auto& point3D : points3D) {
-      if (point3D.second.Error() <= options_->render->max_error &&
-          point3D.second.Track().Length() >= min_track_len) {
-        PointPainter::Data painter_point;
-
-        painter_point.x = static_cast<float>(point3D.second.XYZ(0));
-        painter_point.y = static_cast<float>(point3D.second.XYZ(1));
-        painter_point.z = static_cast<float>(point3D.second.XYZ(2));
-
-        Eigen::Vector4f color;
-        if (selection_mode) {
-          const size_t index = selection_buffer_.size();
-          selection_buffer_.push_back(
-              std::make_pair(point3D.first, SELECTION_BUFFER_POINT_IDX));
-          color = IndexToRGB(index);
-
-        } else if (point3D.first == selected_point3D_id_) {
-          color = kSelectedPointColor;
-        } else {
-          color = point_colormap_->ComputeColor(point3D.first, point3D.second);
-        }
-
-        painter_point.r = color(0);
-        painter_point.g = color(1);
-        painter_point.b = color(2);
-        painter_point.a = color(3);
+  std::vector<PointPainter::Data> data;
 
-        data.push_back(painter_point);
-      }
+  const auto AddPoint = [&](const point3D_t point3D_id,
+                            const Eigen::Vector4f& color) {
+    if (points3D.count(point3D_id) == 0) {
+      return;
     }
-  } else {  // Image selected
-    const auto& selected_image = images[selected_image_id_];
-    for (const auto& point3D : points3D) {
-      if (point3D.second.Error() <= options_->render->max_error &&
-          point3D.second.Track().Length() >= min_track_len) {
-        PointPainter::Data painter_point;
-
-        painter_point.x = static_cast<float>(point3D.second.XYZ(0));
-        painter_point.y = static_cast<float>(point3D.second.XYZ(1));
-        painter_point.z = static_cast<float>(point3D.second.XYZ(2));
-
-        Eigen::Vector4f color;
-        if (selection_mode) {
-          const size_t index = selection_buffer_.size();
-          selection_buffer_.push_back(
-              std::make_pair(point3D.first, SELECTION_BUFFER_POINT_IDX));
-          color = IndexToRGB(index);
-        } else if (selected_image.HasPoint3D(point3D.first)) {
-          color = kSelectedImagePlaneColor;
-        } else if (point3D.first == selected_point3D_id_) {
-          color = kSelectedPointColor;
-        } else {
-          color = point_colormap_->ComputeColor(point3D.first, point3D.second);
-        }
-
-        painter_point.r = color(0);
-        painter_point.g = color(1);
-        painter_point.b = color(2);
-        painter_point.a = color(3);
+    const Point3D& point3D = points3D.at(point3D_id);
+    if (point3D.Error() <= options_->render->max_error &&
+        point3D.Track().Length() >= min_track_len) {
+      data.emplace_back(static_cast<float>(point3D.XYZ(0)),
+                        static_cast<float>(point3D.XYZ(1)),
+                        static_cast<float>(point3D.XYZ(2)), color(0), color(1),
+                        color(2), color(3));
+    }
+  };
 
-        data.push_back(painter_point);
+  if (images.count(selected_image_id_) > 0) {
+    for (const auto& point2D : images.at(selected_image_id_).Points2D()) {
+      if (point2D.HasPoint3D()) {
+        AddPoint(point2D.Point3DId(), kSelectedImagePlaneColor);
       }
     }
   }
 
-  point_painter_.Upload(data);
+  if (selected_point3D_id_ != kInvalidPoint3DId) {
+    AddPoint(selected_point3D_id_, kSelectedPointColor);
+  }
+
+  selected_point_painter_.Upload(data);
 }
 
 void ModelViewerWidget::UploadPointConnectionData() {
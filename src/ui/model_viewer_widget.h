@@ -125,7 +125,7 @@ class ModelViewerWidget : public QOpenGLWidget,
   Reconstruction* reconstruction = nullptr;
   EIGEN_STL_UMAP(camera_t, Camera) cameras;
   EIGEN_STL_UMAP(image_t, Image) images;
-  EIGEN_STL_UMAP(point3D_t, Point3D) points3D;
+  DenseIdMap<point3D_t, Point3D> points3D;
   std::vector<image_t> reg_image_ids;
 
   QLabel* statusbar_status_label;
@@ -146,7 +146,8 @@ class ModelViewerWidget : public QOpenGLWidget,
 
   void Upload();
   void UploadCoordinateGridData();
-  void UploadPointData(const bool selection_mode = false);
+  void UploadPointData();
+  void UploadSelectedPointData();
   void UploadPointConnectionData();
   void UploadImageData(const bool selection_mode = false);
   void UploadImageConnectionData();
@@ -169,6 +170,7 @@ class ModelViewerWidget : public QOpenGLWidget,
   LinePainter coordinate_grid_painter_;
 
   PointPainter point_painter_;
+  PointPainter selected_point_painter_;
   LinePainter point_connection_painter_;
 
   LinePainter image_line_painter_;
@@ -193,10 +195,18 @@ class ModelViewerWidget : public QOpenGLWidget,
   float focus_distance_;
 
   std::vector<std::pair<size_t, char>> selection_buffer_;
+  // The identifiers of the points in the order uploaded to the point painter.
+  std::vector<point3D_t> point_ids_;
   image_t selected_image_id_;
   point3D_t selected_point3D_id_;
   size_t selected_movie_grabber_view_;
 
+  // The reconstruction and its version that the copied scene data mirrors,
+  // see `ReloadReconstruction`.
+  const Reconstruction* synced_reconstruction_;
+  uint64_t synced_version_;
+  bool upload_pending_;
+
   bool coordinate_grid_enabled_;
 
   // Size of points (dynamic): does not require re-uploading of points.
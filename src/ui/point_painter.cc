@@ -49,11 +49,26 @@ void PointPainter::Setup() {
     shader_program_.release();
     shader_program_.removeAllShaders();
   }
+  if (index_shader_program_.isLinked()) {
+    index_shader_program_.release();
+    index_shader_program_.removeAllShaders();
+  }
+
+  // Both programs share the vertex array object and must thus use the same
+  // attribute locations.
+  index_shader_program_.addShaderFromSourceFile(
+      QOpenGLShader::Vertex, ":/shaders/points_index.v.glsl");
+  index_shader_program_.addShaderFromSourceFile(QOpenGLShader::Fragment,
+                                                ":/shaders/points.f.glsl");
+  index_shader_program_.bindAttributeLocation("a_position", 0);
+  index_shader_program_.link();
 
   shader_program_.addShaderFromSourceFile(QOpenGLShader::Vertex,
                                           ":/shaders/points.v.glsl");
   shader_program_.addShaderFromSourceFile(QOpenGLShader::Fragment,
                                           ":/shaders/points.f.glsl");
+  shader_program_.bindAttributeLocation("a_position", 0);
+  shader_program_.bindAttributeLocation("a_color", 1);
   shader_program_.link();
   shader_program_.bind();
 
@@ -74,8 +89,9 @@ void PointPainter::Upload(const std::vector<PointPainter::Data>& data) {
   vao_.bind();
   vbo_.bind();
 
-  // Upload data array to GPU
-  vbo_.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+  // Upload data array to GPU. The points are only uploaded when the
+  // reconstruction or its colormap changes and then rendered many times.
+  vbo_.setUsagePattern(QOpenGLBuffer::StaticDraw);
   vbo_.allocate(data.data(),
                 static_cast<int>(data.size() * sizeof(PointPainter::Data)));
 
@@ -98,9 +114,10 @@ void PointPainter::Upload(const std::vector<PointPainter::Data>& data) {
 #endif
 }
 
-void PointPainter::Render(const QMatrix4x4& pmv_matrix,
-                          const float point_size) {
-  if (num_geoms_ == 0) {
+void PointPainter::Render(const QMatrix4x4& pmv_matrix, const float point_size,
+                          const size_t max_num_points) {
+  const size_t num_points = std::min(num_geoms_, max_num_points);
+  if (num_points == 0) {
     return;
   }
 
@@ -111,7 +128,35 @@ void PointPainter::Render(const QMatrix4x4& pmv_matrix,
   shader_program_.setUniformValue("u_point_size", point_size);
 
   QOpenGLFunctions* gl_funcs = QOpenGLContext::currentContext()->functions();
-  gl_funcs->glDrawArrays(GL_POINTS, 0, (GLsizei)num_geoms_);
+  gl_funcs->glDrawArrays(GL_POINTS, 0, (GLsizei)num_points);
+
+  // Make sure the VAO is not changed from the outside
+  vao_.release();
+
+#if DEBUG
+  glDebugLog();
+#endif
+}
+
+void PointPainter::RenderIndices(const QMatrix4x4& pmv_matrix,
+                                 const float point_size,
+                                 const size_t index_offset,
+                                 const size_t max_num_points) {
+  const size_t num_points = std::min(num_geoms_, max_num_points);
+  if (num_points == 0) {
+    return;
+  }
+
+  index_shader_program_.bind();
+  vao_.bind();
+
+  index_shader_program_.setUniformValue("u_pmv_matrix", pmv_matrix);
+  index_shader_program_.setUniformValue("u_point_size", point_size);
+  index_shader_program_.setUniformValue("u_index_offset",
+                                        static_cast<GLint>(index_offset));
+
+  QOpenGLFunctions* gl_funcs = QOpenGLContext::currentContext()->functions();
+  gl_funcs->glDrawArrays(GL_POINTS, 0, (GLsizei)num_points);
 
   // Make sure the VAO is not changed from the outside
   vao_.release();
@@ -121,4 +166,6 @@ void PointPainter::Render(const QMatrix4x4& pmv_matrix,
 #endif
 }
 
+size_t PointPainter::NumPoints() const { return num_geoms_; }
+
 }  // namespace colmap
@@ -32,6 +32,8 @@
 #ifndef COLMAP_SRC_UI_POINT_PAINTER_H_
 #define COLMAP_SRC_UI_POINT_PAINTER_H_
 
+#include <limits>
+
 #include <QtCore>
 #include <QtOpenGL>
 
@@ -54,10 +56,24 @@ class PointPainter {
 
   void Setup();
   void Upload(const std::vector<PointPainter::Data>& data);
-  void Render(const QMatrix4x4& pmv_matrix, const float point_size);
+
+  // Render the first points of the uploaded data. If the points are uploaded
+  // in a spatially uniform order, the rendered points are a uniform subset of
+  // all points at a lower level of detail.
+  void Render(const QMatrix4x4& pmv_matrix, const float point_size,
+              const size_t max_num_points = std::numeric_limits<size_t>::max());
+
+  // Render the points with a color that encodes their index in the uploaded
+  // data plus the given offset, to select points through an index buffer
+  // without re-uploading the points with index colors.
+  void RenderIndices(const QMatrix4x4& pmv_matrix, const float point_size,
+                     const size_t index_offset, const size_t max_num_points);
+
+  size_t NumPoints() const;
 
  private:
   QOpenGLShaderProgram shader_program_;
+  QOpenGLShaderProgram index_shader_program_;
   QOpenGLVertexArrayObject vao_;
   QOpenGLBuffer vbo_;
 
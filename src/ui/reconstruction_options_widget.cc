@@ -49,6 +49,10 @@ MapperGeneralOptionsWidget::MapperGeneralOptionsWidget(QWidget* parent,
   AddOptionDirPath(&options->mapper->snapshot_path, "snapshot_path");
   AddOptionInt(&options->mapper->snapshot_images_freq, "snapshot_images_freq",
                0);
+  AddOptionDirPath(&options->mapper->checkpoint_path, "checkpoint_path");
+  AddOptionInt(&options->mapper->checkpoint_images_freq,
+               "checkpoint_images_freq", 0);
+  AddOptionBool(&options->mapper->resume, "resume");
 }
 
 MapperTriangulationOptionsWidget::MapperTriangulationOptionsWidget(
@@ -85,6 +89,7 @@ MapperRegistrationOptionsWidget::MapperRegistrationOptionsWidget(
                "abs_pose_min_num_inliers");
   AddOptionDouble(&options->mapper->mapper.abs_pose_min_inlier_ratio,
                   "abs_pose_min_inlier_ratio");
+  AddOptionBool(&options->mapper->mapper.abs_pose_use_gpu, "abs_pose_use_gpu");
   AddOptionInt(&options->mapper->mapper.max_reg_trials, "max_reg_trials", 1);
 }
 
@@ -103,6 +108,8 @@ MapperInitializationOptionsWidget::MapperInitializationOptionsWidget(
                   "init_min_tri_angle [deg]");
   AddOptionInt(&options->mapper->mapper.init_max_reg_trials,
                   "init_max_reg_trials", 1);
+  AddOptionInt(&options->mapper->mapper.init_num_candidate_pairs,
+               "init_num_candidate_pairs", 1);
 }
 
 MapperBundleAdjustmentOptionsWidget::MapperBundleAdjustmentOptionsWidget(
@@ -115,6 +122,8 @@ MapperBundleAdjustmentOptionsWidget::MapperBundleAdjustmentOptionsWidget(
                 "refine_principal_point");
   AddOptionBool(&options->mapper->ba_refine_extra_params,
                 "refine_extra_params");
+  AddOptionBool(&options->mapper->ba_use_mixed_precision,
+                "use_mixed_precision");
 
   AddSpacer();
 
@@ -136,9 +145,20 @@ MapperBundleAdjustmentOptionsWidget::MapperBundleAdjustmentOptionsWidget(
   AddOptionInt(&options->mapper->ba_global_images_freq, "images_freq");
   AddOptionDouble(&options->mapper->ba_global_points_ratio, "points_ratio");
   AddOptionInt(&options->mapper->ba_global_points_freq, "points_freq");
+  AddOptionBool(&options->mapper->ba_global_adaptive, "adaptive");
+  AddOptionDouble(&options->mapper->ba_global_max_error_drift,
+                  "max_error_drift");
+  AddOptionDouble(&options->mapper->ba_global_max_changed_ratio,
+                  "max_changed_ratio");
+  AddOptionDouble(&options->mapper->ba_global_max_time_fraction,
+                  "max_time_fraction", 0, 1);
   AddOptionInt(&options->mapper->ba_global_max_num_iterations,
                "max_num_iterations");
   AddOptionInt(&options->mapper->ba_global_pba_gpu_index, "pba_gpu_index", -1);
+  AddOptionBool(&options->mapper->ba_global_use_gpu, "use_gpu");
+  AddOptionInt(&options->mapper->ba_global_gpu_index, "gpu_index", -1);
+  AddOptionInt(&options->mapper->ba_global_max_num_images_per_partition,
+               "max_num_images_per_partition", -1);
   AddOptionInt(&options->mapper->ba_global_max_refinements, "max_refinements",
                1);
   AddOptionDouble(&options->mapper->ba_global_max_refinement_change,
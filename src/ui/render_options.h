@@ -48,6 +48,13 @@ struct RenderOptions {
   // Maximum error for a point to be rendered.
   double max_error = 2;
 
+  // Maximum number of rendered points per screen pixel. Larger point clouds
+  // are rendered at a lower, spatially uniform level of detail.
+  double max_num_points_per_pixel = 2.0;
+
+  // Maximum number of rendered points while the view is moved.
+  int max_num_interactive_points = 2000000;
+
   // The rate of registered images at which to refresh.
   int refresh_rate = 1;
 
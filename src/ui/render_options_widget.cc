@@ -96,6 +96,10 @@ RenderOptionsWidget::RenderOptionsWidget(QWidget* parent,
 
   AddOptionDouble(&options->render->max_error, "Point max. error [px]");
   AddOptionInt(&options->render->min_track_len, "Point min. track length", 0);
+  AddOptionDouble(&options->render->max_num_points_per_pixel,
+                  "Point max. number per pixel", 0);
+  AddOptionInt(&options->render->max_num_interactive_points,
+               "Point max. number while moving", 1);
 
   AddSpacer();
 
@@ -0,0 +1,19 @@
+#version 150
+
+uniform float u_point_size;
+uniform mat4 u_pmv_matrix;
+uniform int u_index_offset;
+
+in vec3 a_position;
+out vec4 v_color;
+
+void main(void) {
+  gl_Position = u_pmv_matrix * vec4(a_position, 1);
+  gl_PointSize = u_point_size;
+  // Encode the index of the point in the RGB channels, which is decoded by
+  // the selection logic of the model viewer widget.
+  int index = gl_VertexID + u_index_offset;
+  v_color = vec4(float(index & 0xFF) / 255.0,
+                 float((index >> 8) & 0xFF) / 255.0,
+                 float((index >> 16) & 0xFF) / 255.0, 1.0);
+}
@@ -58,6 +58,9 @@ UndistortionWidget::UndistortionWidget(QWidget* parent,
   AddOptionDouble(&undistortion_options_.roi_min_y, "roi_min_y", 0.0, 1.0);
   AddOptionDouble(&undistortion_options_.roi_max_x, "roi_max_x", 0.0, 1.0);
   AddOptionDouble(&undistortion_options_.roi_max_y, "roi_max_y", 0.0, 1.0);
+  AddOptionInt(&undistortion_options_.num_threads, "num_threads", -1);
+  AddOptionInt(&undistortion_options_.queue_size, "queue_size", 1);
+  AddOptionText(&undistortion_options_.image_encoding, "image_encoding");
   AddOptionDirPath(&output_path_, "output_path");
 
   AddSpacer();
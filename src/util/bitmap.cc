@@ -43,6 +43,67 @@
 #include "util/misc.h"
 
 namespace colmap {
+namespace {
+
+// Filter weights to resample one dimension of an image, where output pixel i
+// is the weighted sum of the input pixels [begins[i], begins[i] + num_weights)
+// with the weights at weights[offsets[i]:offsets[i + 1]].
+struct ResamplingWeights {
+  std::vector<int> begins;
+  std::vector<size_t> offsets;
+  std::vector<float> weights;
+};
+
+// Compute the weights of the box or bilinear (tent) filter as in FreeImage's
+// resampling engine. For downscaling, the filter support is widened by the
+// inverse scale, so that all covered input pixels are averaged to avoid
+// aliasing.
+ResamplingWeights ComputeResamplingWeights(const int src_size,
+                                           const int dst_size,
+                                           const FREE_IMAGE_FILTER filter) {
+  CHECK(filter == FILTER_BOX || filter == FILTER_BILINEAR);
+
+  const double filter_width = filter == FILTER_BOX ? 0.5 : 1.0;
+  const double scale = static_cast<double>(dst_size) / src_size;
+  const double filter_scale = std::min(scale, 1.0);
+  const double support = filter_width / filter_scale;
+
+  ResamplingWeights resampling_weights;
+  resampling_weights.begins.reserve(dst_size);
+  resampling_weights.offsets.reserve(dst_size + 1);
+  resampling_weights.offsets.push_back(0);
+
+  std::vector<double> weights;
+  for (int i = 0; i < dst_size; ++i) {
+    const double center = (i + 0.5) / scale;
+    const int begin = std::max(0, static_cast<int>(center - support + 0.5));
+    const int end =
+        std::min(src_size, static_cast<int>(center + support + 0.5));
+
+    weights.clear();
+    double weight_sum = 0;
+    for (int j = begin; j < end; ++j) {
+      const double dist = std::abs(filter_scale * (j + 0.5 - center));
+      const double weight = filter == FILTER_BOX
+                                ? (dist <= filter_width ? 1.0 : 0.0)
+                                : std::max(0.0, filter_width - dist);
+      weights.push_back(weight);
+      weight_sum += weight;
+    }
+    CHECK_GT(weight_sum, 0);
+
+    resampling_weights.begins.push_back(begin);
+    for (const double weight : weights) {
+      resampling_weights.weights.push_back(
+          static_cast<float>(weight / weight_sum));
+    }
+    resampling_weights.offsets.push_back(resampling_weights.weights.size());
+  }
+
+  return resampling_weights;
+}
+
+}  // namespace
 
 Bitmap::Bitmap()
     : data_(nullptr, &FreeImage_Unload), width_(0), height_(0), channels_(0) {}
@@ -112,14 +173,20 @@ size_t Bitmap::NumBytes() const {
 }
 
 std::vector<uint8_t> Bitmap::ConvertToRawBits() const {
+  std::vector<uint8_t> raw_bits;
+  ConvertToRawBits(&raw_bits);
+  return raw_bits;
+}
+
+void Bitmap::ConvertToRawBits(std::vector<uint8_t>* raw_bits) const {
+  CHECK_NOTNULL(raw_bits);
   const unsigned int scan_width = ScanWidth();
   const unsigned int bpp = BitsPerPixel();
   const bool kTopDown = true;
-  std::vector<uint8_t> raw_bits(scan_width * height_, 0);
-  FreeImage_ConvertToRawBits(raw_bits.data(), data_.get(), scan_width, bpp,
+  raw_bits->resize(scan_width * height_);
+  FreeImage_ConvertToRawBits(raw_bits->data(), data_.get(), scan_width, bpp,
                              FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK,
                              FI_RGBA_BLUE_MASK, kTopDown);
-  return raw_bits;
 }
 
 std::vector<uint8_t> Bitmap::ConvertToRowMajorArray() const {
@@ -201,6 +268,12 @@ const uint8_t* Bitmap::GetScanline(const int y) const {
   return FreeImage_GetScanLine(data_.get(), height_ - 1 - y);
 }
 
+uint8_t* Bitmap::GetScanline(const int y) {
+  CHECK_GE(y, 0);
+  CHECK_LT(y, height_);
+  return FreeImage_GetScanLine(data_.get(), height_ - 1 - y);
+}
+
 void Bitmap::Fill(const BitmapColor<uint8_t>& color) {
   for (int y = 0; y < height_; ++y) {
     uint8_t* line = FreeImage_GetScanLine(data_.get(), height_ - 1 - y);
@@ -444,6 +517,37 @@ bool Bitmap::Read(const std::string& path, const bool as_rgb) {
   return true;
 }
 
+bool Bitmap::ReadHeader(const std::string& path) {
+  if (!ExistsFile(path)) {
+    return false;
+  }
+
+  const FREE_IMAGE_FORMAT format = FreeImage_GetFileType(path.c_str(), 0);
+
+  if (format == FIF_UNKNOWN) {
+    return false;
+  }
+
+  FIBITMAP* fi_bitmap =
+      FreeImage_Load(format, path.c_str(), FIF_LOAD_NOPIXELS);
+  if (fi_bitmap == nullptr) {
+    return false;
+  }
+
+  data_ = FIBitmapPtr(fi_bitmap, &FreeImage_Unload);
+
+  if (!IsPtrSupported(data_.get())) {
+    data_.reset();
+    return false;
+  }
+
+  width_ = FreeImage_GetWidth(data_.get());
+  height_ = FreeImage_GetHeight(data_.get());
+  channels_ = IsPtrRGB(data_.get()) ? 3 : 1;
+
+  return true;
+}
+
 bool Bitmap::Write(const std::string& path, const FREE_IMAGE_FORMAT format,
                    const int flags) const {
   FREE_IMAGE_FORMAT save_format;
@@ -504,7 +608,72 @@ void Bitmap::Smooth(const float sigma_x, const float sigma_y) {
 
 void Bitmap::Rescale(const int new_width, const int new_height,
                      const FREE_IMAGE_FILTER filter) {
-  SetPtr(FreeImage_Rescale(data_.get(), new_width, new_height, filter));
+  if (filter != FILTER_BOX && filter != FILTER_BILINEAR) {
+    SetPtr(FreeImage_Rescale(data_.get(), new_width, new_height, filter));
+    return;
+  }
+
+  CHECK_GT(new_width, 0);
+  CHECK_GT(new_height, 0);
+
+  // The separable filter is first applied to complete scanlines and then to
+  // the pixels of the intermediate row, so that the inner loops operate on
+  // contiguous memory and only a single intermediate row must be stored. The
+  // filter is symmetric, such that the bottom-up order of the scanlines does
+  // not change the result.
+  const ResamplingWeights x_weights =
+      ComputeResamplingWeights(width_, new_width, filter);
+  const ResamplingWeights y_weights =
+      ComputeResamplingWeights(height_, new_height, filter);
+
+  Bitmap rescaled;
+  CHECK(rescaled.Allocate(new_width, new_height, IsRGB()));
+
+  const int row_size = width_ * channels_;
+  std::vector<float> row(row_size);
+  for (int y = 0; y < new_height; ++y) {
+    std::fill(row.begin(), row.end(), 0.0f);
+    for (size_t k = y_weights.offsets[y]; k < y_weights.offsets[y + 1]; ++k) {
+      const float weight = y_weights.weights[k];
+      const uint8_t* src_line = FreeImage_GetScanLine(
+          data_.get(), y_weights.begins[y] + k - y_weights.offsets[y]);
+      for (int i = 0; i < row_size; ++i) {
+        row[i] += weight * src_line[i];
+      }
+    }
+
+    uint8_t* dst_line = FreeImage_GetScanLine(rescaled.data_.get(), y);
+    for (int x = 0; x < new_width; ++x) {
+      const float* src_pixel = &row[x_weights.begins[x] * channels_];
+      float sum[3] = {0.0f, 0.0f, 0.0f};
+      for (size_t k = x_weights.offsets[x]; k < x_weights.offsets[x + 1];
+           ++k) {
+        const float weight = x_weights.weights[k];
+        for (int c = 0; c < channels_; ++c) {
+          sum[c] += weight * src_pixel[c];
+        }
+        src_pixel += channels_;
+      }
+      for (int c = 0; c < channels_; ++c) {
+        dst_line[x * channels_ + c] =
+            TruncateCast<float, uint8_t>(sum[c] + 0.5f);
+      }
+    }
+  }
+
+  CloneMetadata(&rescaled);
+  *this = std::move(rescaled);
+}
+
+Bitmap Bitmap::Crop(const int x, const int y, const int width,
+                    const int height) const {
+  CHECK_GE(x, 0);
+  CHECK_GE(y, 0);
+  CHECK_GT(width, 0);
+  CHECK_GT(height, 0);
+  CHECK_LE(x + width, width_);
+  CHECK_LE(y + height, height_);
+  return Bitmap(FreeImage_Copy(data_.get(), x, y, x + width, y + height));
 }
 
 Bitmap Bitmap::Clone() const { return Bitmap(FreeImage_Clone(data_.get())); }
@@ -512,9 +681,27 @@ Bitmap Bitmap::Clone() const { return Bitmap(FreeImage_Clone(data_.get())); }
 Bitmap Bitmap::CloneAsGrey() const {
   if (IsGrey()) {
     return Clone();
-  } else {
-    return Bitmap(FreeImage_ConvertToGreyscale(data_.get()));
   }
+
+  Bitmap grey_bitmap;
+  CHECK(grey_bitmap.Allocate(width_, height_, /*as_rgb*/ false));
+
+  // Convert the scanlines directly using the same Rec. 709 luma weights and
+  // rounding as FreeImage_ConvertToGreyscale, which the compiler vectorizes.
+  for (int y = 0; y < height_; ++y) {
+    const uint8_t* line = FreeImage_GetScanLine(data_.get(), y);
+    uint8_t* grey_line = FreeImage_GetScanLine(grey_bitmap.data_.get(), y);
+    for (int x = 0; x < width_; ++x) {
+      const uint8_t* pixel = &line[3 * x];
+      grey_line[x] = static_cast<uint8_t>(0.2126f * pixel[FI_RGBA_RED] +
+                                          0.7152f * pixel[FI_RGBA_GREEN] +
+                                          0.0722f * pixel[FI_RGBA_BLUE] + 0.5f);
+    }
+  }
+
+  CloneMetadata(&grey_bitmap);
+
+  return grey_bitmap;
 }
 
 Bitmap Bitmap::CloneAsRGB() const {
@@ -122,6 +122,8 @@ class Bitmap {
 
   // Copy raw image data to array.
   std::vector<uint8_t> ConvertToRawBits() const;
+  // Same as above, but reuse the memory of the given array.
+  void ConvertToRawBits(std::vector<uint8_t>* raw_bits) const;
   std::vector<uint8_t> ConvertToRowMajorArray() const;
   std::vector<uint8_t> ConvertToColMajorArray() const;
 
@@ -132,6 +134,7 @@ class Bitmap {
 
   // Get pointer to y-th scanline, where the 0-th scanline is at the top.
   const uint8_t* GetScanline(const int y) const;
+  uint8_t* GetScanline(const int y);
 
   // Fill entire bitmap with uniform color. For grayscale images, the first
   // element of the vector is used.
@@ -153,6 +156,10 @@ class Bitmap {
   // Read bitmap at given path and convert to grey- or colorscale.
   bool Read(const std::string& path, const bool as_rgb = true);
 
+  // Read only the dimensions and meta data of the bitmap at the given path
+  // without decoding its pixels, e.g., to decode the pixels on the GPU.
+  bool ReadHeader(const std::string& path);
+
   // Write image to file. Flags can be used to set e.g. the JPEG quality.
   // Consult the FreeImage documentation for all available flags.
   bool Write(const std::string& path,
@@ -166,6 +173,11 @@ class Bitmap {
   void Rescale(const int new_width, const int new_height,
                const FREE_IMAGE_FILTER filter = FILTER_BILINEAR);
 
+  // Copy the rectangular region with the given top-left corner and dimensions
+  // to a new bitmap object. The region must be inside the image.
+  Bitmap Crop(const int x, const int y, const int width,
+              const int height) const;
+
   // Clone the image to a new bitmap object.
   Bitmap Clone() const;
   Bitmap CloneAsGrey() const;
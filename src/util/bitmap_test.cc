@@ -356,6 +356,68 @@ BOOST_AUTO_TEST_CASE(TestRescaleGrey) {
   BOOST_CHECK_EQUAL(bitmap2.Channels(), 1);
 }
 
+BOOST_AUTO_TEST_CASE(TestRescaleUniform) {
+  Bitmap bitmap;
+  bitmap.Allocate(100, 80, true);
+  bitmap.Fill(BitmapColor<uint8_t>(10, 20, 30));
+  for (const auto filter : {FILTER_BOX, FILTER_BILINEAR}) {
+    for (const auto& size : {std::make_pair(37, 29), std::make_pair(150, 90)}) {
+      Bitmap rescaled_bitmap = bitmap.Clone();
+      rescaled_bitmap.Rescale(size.first, size.second, filter);
+      BOOST_CHECK_EQUAL(rescaled_bitmap.Width(), size.first);
+      BOOST_CHECK_EQUAL(rescaled_bitmap.Height(), size.second);
+      for (int y = 0; y < size.second; ++y) {
+        for (int x = 0; x < size.first; ++x) {
+          BitmapColor<uint8_t> color;
+          BOOST_CHECK(rescaled_bitmap.GetPixel(x, y, &color));
+          BOOST_CHECK_EQUAL(color, BitmapColor<uint8_t>(10, 20, 30));
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestRescaleAntiAliasing) {
+  // Downscaling a checkerboard by a factor of two must average the pixels
+  // instead of sampling either of the two colors.
+  Bitmap bitmap;
+  bitmap.Allocate(100, 100, false);
+  for (int y = 0; y < 100; ++y) {
+    for (int x = 0; x < 100; ++x) {
+      const uint8_t value = (x + y) % 2 == 0 ? 0 : 255;
+      bitmap.SetPixel(x, y, BitmapColor<uint8_t>(value));
+    }
+  }
+  bitmap.Rescale(50, 50, FILTER_BOX);
+  BOOST_CHECK_EQUAL(bitmap.Channels(), 1);
+  for (int y = 0; y < 50; ++y) {
+    for (int x = 0; x < 50; ++x) {
+      BitmapColor<uint8_t> color;
+      BOOST_CHECK(bitmap.GetPixel(x, y, &color));
+      BOOST_CHECK_EQUAL(color.r, 128);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestCrop) {
+  Bitmap bitmap;
+  bitmap.Allocate(100, 80, false);
+  bitmap.Fill(BitmapColor<uint8_t>(0));
+  bitmap.SetPixel(10, 20, BitmapColor<uint8_t>(5));
+  bitmap.SetPixel(59, 69, BitmapColor<uint8_t>(7));
+  const Bitmap cropped_bitmap = bitmap.Crop(10, 20, 50, 50);
+  BOOST_CHECK_EQUAL(cropped_bitmap.Width(), 50);
+  BOOST_CHECK_EQUAL(cropped_bitmap.Height(), 50);
+  BOOST_CHECK_EQUAL(cropped_bitmap.Channels(), 1);
+  BitmapColor<uint8_t> color;
+  BOOST_CHECK(cropped_bitmap.GetPixel(0, 0, &color));
+  BOOST_CHECK_EQUAL(color, BitmapColor<uint8_t>(5));
+  BOOST_CHECK(cropped_bitmap.GetPixel(49, 49, &color));
+  BOOST_CHECK_EQUAL(color, BitmapColor<uint8_t>(7));
+  BOOST_CHECK(cropped_bitmap.GetPixel(1, 1, &color));
+  BOOST_CHECK_EQUAL(color, BitmapColor<uint8_t>(0));
+}
+
 BOOST_AUTO_TEST_CASE(TestClone) {
   Bitmap bitmap;
   bitmap.Allocate(100, 100, true);
@@ -379,9 +441,13 @@ BOOST_AUTO_TEST_CASE(TestCloneAsRGB) {
 BOOST_AUTO_TEST_CASE(TestCloneAsGrey) {
   Bitmap bitmap;
   bitmap.Allocate(100, 100, true);
+  bitmap.Fill(BitmapColor<uint8_t>(100, 150, 200));
   const Bitmap cloned_bitmap = bitmap.CloneAsGrey();
   BOOST_CHECK_EQUAL(cloned_bitmap.Width(), 100);
   BOOST_CHECK_EQUAL(cloned_bitmap.Height(), 100);
   BOOST_CHECK_EQUAL(cloned_bitmap.Channels(), 1);
   BOOST_CHECK_NE(bitmap.Data(), cloned_bitmap.Data());
+  BitmapColor<uint8_t> color;
+  BOOST_CHECK(cloned_bitmap.GetPixel(50, 50, &color));
+  BOOST_CHECK_EQUAL(color.r, 143);
 }
@@ -32,11 +32,19 @@
 #ifndef COLMAP_SRC_UTIL_CACHE_H_
 #define COLMAP_SRC_UTIL_CACHE_H_
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "util/logging.h"
+#include "util/threading.h"
 
 namespace colmap {
 
@@ -67,13 +75,27 @@ class LRUCache {
   // Pop least recently used element from cache.
   virtual void Pop();
 
+  // Remove the element with the given key from the cache, if it exists.
+  virtual void Erase(const key_t& key);
+
   // Clear all elements from cache.
   virtual void Clear();
 
+  // Set a function that ranks the elements for eviction, e.g., by the time of
+  // their next use in a known access order. If set, the element with the
+  // highest rank is evicted instead of the least recently used element, where
+  // elements with equal rank are evicted in least recently used order. The
+  // most recently used element is never evicted, unless it is the only one.
+  void SetEvictionRankFunc(
+      const std::function<size_t(const key_t&)>& eviction_rank_func);
+
  protected:
   typedef typename std::pair<key_t, value_t> key_value_pair_t;
   typedef typename std::list<key_value_pair_t>::iterator list_iterator_t;
 
+  // Find the next element to evict. The cache must not be empty.
+  list_iterator_t FindEvictionCandidate();
+
   // Maximum number of least-recently-used elements the cache remembers.
   const size_t max_num_elems_;
 
@@ -85,6 +107,9 @@ class LRUCache {
 
   // Function to compute new values if not in the cache.
   const std::function<value_t(const key_t&)> getter_func_;
+
+  // Optional function to rank the elements for eviction.
+  std::function<size_t(const key_t&)> eviction_rank_func_;
 };
 
 // Least Recently Used cache implementation that is constrained by a maximum
@@ -104,6 +129,7 @@ class MemoryConstrainedLRUCache : public LRUCache<key_t, value_t> {
 
   void Set(const key_t& key, value_t&& value) override;
   void Pop() override;
+  void Erase(const key_t& key) override;
   void Clear() override;
 
  private:
@@ -113,12 +139,102 @@ class MemoryConstrainedLRUCache : public LRUCache<key_t, value_t> {
   using LRUCache<key_t, value_t>::elems_list_;
   using LRUCache<key_t, value_t>::elems_map_;
   using LRUCache<key_t, value_t>::getter_func_;
+  using LRUCache<key_t, value_t>::FindEvictionCandidate;
 
   const size_t max_num_bytes_;
-  size_t num_bytes_;
+  // Atomic, such that the memory usage can be monitored by other threads.
+  std::atomic<size_t> num_bytes_;
   std::unordered_map<key_t, size_t> elems_num_bytes_;
 };
 
+// Thread-safe Least Recently Used cache that splits the elements into multiple
+// independently locked shards, such that concurrent accesses to different keys
+// rarely contend on the same lock. The values are handed out as shared
+// pointers, which remain valid even if the element is evicted from the cache
+// while still in use. Each shard evicts its own least recently used elements,
+// so the eviction order is only approximately least recently used globally.
+template <typename key_t, typename value_t>
+class ShardedLRUCache {
+ public:
+  ShardedLRUCache(const size_t max_num_elems, const size_t num_shards,
+                  const std::function<value_t(const key_t&)>& getter_func,
+                  const int num_prefetch_threads = 1);
+
+  // The number of elements in the cache.
+  size_t NumElems() const;
+  size_t MaxNumElems() const;
+  size_t NumShards() const;
+
+  // Check whether the element with the given key exists.
+  bool Exists(const key_t& key) const;
+
+  // Get the value of an element either from the cache or compute the new
+  // value. The value is computed without locking the shard, and concurrent
+  // requests for the same missing key wait for a single computation.
+  std::shared_ptr<const value_t> Get(const key_t& key);
+
+  // Hint that the element with the given key is requested soon. If it is
+  // neither cached nor being computed, its value is computed asynchronously
+  // by the prefetch threads.
+  void Prefetch(const key_t& key);
+
+  // Wait until all prefetched values are computed.
+  void WaitForPrefetch();
+
+  // Remove the element with the given key from the cache, e.g., once it is
+  // known not to be requested again. A value that is currently computed is
+  // still added to the cache once it is finished.
+  void Erase(const key_t& key);
+
+  // Clear all elements from cache.
+  void Clear();
+
+  // Evict the least recently used elements of each shard, such that at most
+  // the given number of elements remain in the cache, e.g., to release memory.
+  // The maximum number of elements of the cache is not changed.
+  void Shrink(const size_t num_elems);
+
+  // Statistics of the requests by Get. A request for a value that is currently
+  // computed by another request or by prefetching counts as a hit.
+  size_t NumHits() const;
+  size_t NumMisses() const;
+  size_t NumEvictions() const;
+
+ private:
+  typedef std::shared_ptr<const value_t> value_ptr_t;
+
+  struct Shard {
+    Shard(const size_t max_num_elems,
+          const std::function<value_ptr_t(const key_t&)>& getter_func)
+        : cache(max_num_elems, getter_func) {}
+    mutable std::mutex mutex;
+    LRUCache<key_t, value_ptr_t> cache;
+    // The values that are currently computed outside of the lock.
+    std::unordered_map<key_t, std::shared_future<value_ptr_t>> pending;
+  };
+
+  Shard& GetShard(const key_t& key) const;
+
+  // Compute the value of a key, that is neither cached nor pending, and add
+  // it to the shard. The lock of the shard must be held and is released.
+  value_ptr_t Compute(const key_t& key, Shard* shard,
+                      std::unique_lock<std::mutex>* lock);
+
+  const size_t max_num_elems_;
+  const std::function<value_t(const key_t&)> getter_func_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  std::atomic<size_t> num_hits_;
+  std::atomic<size_t> num_misses_;
+  std::atomic<size_t> num_evictions_;
+
+  // The prefetch threads are only started on first use. Declared last, so
+  // that running prefetch tasks are finished before the shards are destroyed.
+  const int num_prefetch_threads_;
+  std::mutex prefetch_mutex_;
+  std::unique_ptr<ThreadPool> prefetch_thread_pool_;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
@@ -181,10 +297,18 @@ void LRUCache<key_t, value_t>::Set(const key_t& key, value_t&& value) {
 template <typename key_t, typename value_t>
 void LRUCache<key_t, value_t>::Pop() {
   if (!elems_list_.empty()) {
-    auto last = elems_list_.end();
-    --last;
-    elems_map_.erase(last->first);
-    elems_list_.pop_back();
+    const auto candidate = FindEvictionCandidate();
+    elems_map_.erase(candidate->first);
+    elems_list_.erase(candidate);
+  }
+}
+
+template <typename key_t, typename value_t>
+void LRUCache<key_t, value_t>::Erase(const key_t& key) {
+  const auto it = elems_map_.find(key);
+  if (it != elems_map_.end()) {
+    elems_list_.erase(it->second);
+    elems_map_.erase(it);
   }
 }
 
@@ -194,6 +318,38 @@ void LRUCache<key_t, value_t>::Clear() {
   elems_map_.clear();
 }
 
+template <typename key_t, typename value_t>
+void LRUCache<key_t, value_t>::SetEvictionRankFunc(
+    const std::function<size_t(const key_t&)>& eviction_rank_func) {
+  eviction_rank_func_ = eviction_rank_func;
+}
+
+template <typename key_t, typename value_t>
+typename LRUCache<key_t, value_t>::list_iterator_t
+LRUCache<key_t, value_t>::FindEvictionCandidate() {
+  CHECK(!elems_list_.empty());
+
+  auto candidate = elems_list_.end();
+  --candidate;
+
+  if (!eviction_rank_func_) {
+    return candidate;
+  }
+
+  // Search from the least to the most recently used element, excluding the
+  // most recently used element at the front of the list.
+  size_t max_rank = eviction_rank_func_(candidate->first);
+  for (auto it = candidate; it != elems_list_.begin(); --it) {
+    const size_t rank = eviction_rank_func_(it->first);
+    if (rank > max_rank) {
+      max_rank = rank;
+      candidate = it;
+    }
+  }
+
+  return candidate;
+}
+
 template <typename key_t, typename value_t>
 MemoryConstrainedLRUCache<key_t, value_t>::MemoryConstrainedLRUCache(
     const size_t max_num_bytes,
@@ -237,13 +393,22 @@ void MemoryConstrainedLRUCache<key_t, value_t>::Set(const key_t& key,
 template <typename key_t, typename value_t>
 void MemoryConstrainedLRUCache<key_t, value_t>::Pop() {
   if (!elems_list_.empty()) {
-    auto last = elems_list_.end();
-    --last;
-    num_bytes_ -= elems_num_bytes_.at(last->first);
-    CHECK_GE(num_bytes_, 0);
-    elems_num_bytes_.erase(last->first);
-    elems_map_.erase(last->first);
-    elems_list_.pop_back();
+    const auto candidate = FindEvictionCandidate();
+    num_bytes_ -= elems_num_bytes_.at(candidate->first);
+    CHECK_GE(num_bytes_.load(), 0);
+    elems_num_bytes_.erase(candidate->first);
+    elems_map_.erase(candidate->first);
+    elems_list_.erase(candidate);
+  }
+}
+
+template <typename key_t, typename value_t>
+void MemoryConstrainedLRUCache<key_t, value_t>::Erase(const key_t& key) {
+  const auto it = elems_num_bytes_.find(key);
+  if (it != elems_num_bytes_.end()) {
+    num_bytes_ -= it->second;
+    elems_num_bytes_.erase(it);
+    LRUCache<key_t, value_t>::Erase(key);
   }
 }
 
@@ -252,7 +417,7 @@ void MemoryConstrainedLRUCache<key_t, value_t>::UpdateNumBytes(
     const key_t& key) {
   auto& num_bytes = elems_num_bytes_.at(key);
   num_bytes_ -= num_bytes;
-  CHECK_GE(num_bytes_, 0);
+  CHECK_GE(num_bytes_.load(), 0);
   num_bytes = LRUCache<key_t, value_t>::Get(key).NumBytes();
   num_bytes_ += num_bytes;
 
@@ -268,6 +433,196 @@ void MemoryConstrainedLRUCache<key_t, value_t>::Clear() {
   elems_num_bytes_.clear();
 }
 
+template <typename key_t, typename value_t>
+ShardedLRUCache<key_t, value_t>::ShardedLRUCache(
+    const size_t max_num_elems, const size_t num_shards,
+    const std::function<value_t(const key_t&)>& getter_func,
+    const int num_prefetch_threads)
+    : max_num_elems_(max_num_elems),
+      getter_func_(getter_func),
+      num_hits_(0),
+      num_misses_(0),
+      num_evictions_(0),
+      num_prefetch_threads_(num_prefetch_threads) {
+  CHECK(getter_func);
+  CHECK_GT(max_num_elems, 0);
+  CHECK_GT(num_shards, 0);
+  CHECK_GT(num_prefetch_threads, 0);
+  const size_t num_effective_shards = std::min(num_shards, max_num_elems);
+  const size_t max_num_shard_elems =
+      (max_num_elems + num_effective_shards - 1) / num_effective_shards;
+  const std::function<value_ptr_t(const key_t&)> shard_getter_func =
+      [getter_func](const key_t& key) {
+        return std::make_shared<const value_t>(getter_func(key));
+      };
+  shards_.reserve(num_effective_shards);
+  for (size_t i = 0; i < num_effective_shards; ++i) {
+    shards_.emplace_back(new Shard(max_num_shard_elems, shard_getter_func));
+  }
+}
+
+template <typename key_t, typename value_t>
+size_t ShardedLRUCache<key_t, value_t>::NumElems() const {
+  size_t num_elems = 0;
+  for (const auto& shard : shards_) {
+    std::unique_lock<std::mutex> lock(shard->mutex);
+    num_elems += shard->cache.NumElems();
+  }
+  return num_elems;
+}
+
+template <typename key_t, typename value_t>
+size_t ShardedLRUCache<key_t, value_t>::MaxNumElems() const {
+  return max_num_elems_;
+}
+
+template <typename key_t, typename value_t>
+size_t ShardedLRUCache<key_t, value_t>::NumShards() const {
+  return shards_.size();
+}
+
+template <typename key_t, typename value_t>
+bool ShardedLRUCache<key_t, value_t>::Exists(const key_t& key) const {
+  Shard& shard = GetShard(key);
+  std::unique_lock<std::mutex> lock(shard.mutex);
+  return shard.cache.Exists(key);
+}
+
+template <typename key_t, typename value_t>
+std::shared_ptr<const value_t> ShardedLRUCache<key_t, value_t>::Get(
+    const key_t& key) {
+  Shard& shard = GetShard(key);
+  std::unique_lock<std::mutex> lock(shard.mutex);
+
+  if (shard.cache.Exists(key)) {
+    num_hits_ += 1;
+    return shard.cache.Get(key);
+  }
+
+  const auto pending_it = shard.pending.find(key);
+  if (pending_it != shard.pending.end()) {
+    num_hits_ += 1;
+    const std::shared_future<value_ptr_t> pending_value = pending_it->second;
+    lock.unlock();
+    return pending_value.get();
+  }
+
+  num_misses_ += 1;
+  return Compute(key, &shard, &lock);
+}
+
+template <typename key_t, typename value_t>
+void ShardedLRUCache<key_t, value_t>::Prefetch(const key_t& key) {
+  {
+    Shard& shard = GetShard(key);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    if (shard.cache.Exists(key) || shard.pending.count(key) > 0) {
+      return;
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(prefetch_mutex_);
+  if (!prefetch_thread_pool_) {
+    prefetch_thread_pool_.reset(new ThreadPool(num_prefetch_threads_));
+  }
+
+  // The value might be requested between scheduling and running the task.
+  prefetch_thread_pool_->AddTask([this, key]() {
+    Shard& shard = GetShard(key);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    if (!shard.cache.Exists(key) && shard.pending.count(key) == 0) {
+      Compute(key, &shard, &lock);
+    }
+  });
+}
+
+template <typename key_t, typename value_t>
+void ShardedLRUCache<key_t, value_t>::WaitForPrefetch() {
+  std::unique_lock<std::mutex> lock(prefetch_mutex_);
+  if (prefetch_thread_pool_) {
+    prefetch_thread_pool_->Wait();
+  }
+}
+
+template <typename key_t, typename value_t>
+void ShardedLRUCache<key_t, value_t>::Erase(const key_t& key) {
+  Shard& shard = GetShard(key);
+  std::unique_lock<std::mutex> lock(shard.mutex);
+  shard.cache.Erase(key);
+}
+
+template <typename key_t, typename value_t>
+void ShardedLRUCache<key_t, value_t>::Clear() {
+  for (auto& shard : shards_) {
+    std::unique_lock<std::mutex> lock(shard->mutex);
+    shard->cache.Clear();
+  }
+}
+
+template <typename key_t, typename value_t>
+void ShardedLRUCache<key_t, value_t>::Shrink(const size_t num_elems) {
+  const size_t max_num_shard_elems = num_elems / shards_.size();
+  for (auto& shard : shards_) {
+    std::unique_lock<std::mutex> lock(shard->mutex);
+    while (shard->cache.NumElems() > max_num_shard_elems) {
+      shard->cache.Pop();
+      num_evictions_ += 1;
+    }
+  }
+}
+
+template <typename key_t, typename value_t>
+size_t ShardedLRUCache<key_t, value_t>::NumHits() const {
+  return num_hits_;
+}
+
+template <typename key_t, typename value_t>
+size_t ShardedLRUCache<key_t, value_t>::NumMisses() const {
+  return num_misses_;
+}
+
+template <typename key_t, typename value_t>
+size_t ShardedLRUCache<key_t, value_t>::NumEvictions() const {
+  return num_evictions_;
+}
+
+template <typename key_t, typename value_t>
+typename ShardedLRUCache<key_t, value_t>::Shard&
+ShardedLRUCache<key_t, value_t>::GetShard(const key_t& key) const {
+  return *shards_[std::hash<key_t>()(key) % shards_.size()];
+}
+
+template <typename key_t, typename value_t>
+typename ShardedLRUCache<key_t, value_t>::value_ptr_t
+ShardedLRUCache<key_t, value_t>::Compute(const key_t& key, Shard* shard,
+                                         std::unique_lock<std::mutex>* lock) {
+  std::promise<value_ptr_t> promise;
+  shard->pending.emplace(key, promise.get_future().share());
+  lock->unlock();
+
+  value_ptr_t value;
+  try {
+    value = std::make_shared<const value_t>(getter_func_(key));
+  } catch (...) {
+    lock->lock();
+    shard->pending.erase(key);
+    lock->unlock();
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+
+  lock->lock();
+  const size_t num_elems = shard->cache.NumElems();
+  shard->cache.Set(key, value_ptr_t(value));
+  num_evictions_ += num_elems + 1 - shard->cache.NumElems();
+  shard->pending.erase(key);
+  lock->unlock();
+
+  promise.set_value(value);
+
+  return value;
+}
+
 }  // namespace colmap
 
 #endif  // COLMAP_SRC_UTIL_CACHE_H_
@@ -32,6 +32,10 @@
 #define TEST_NAME "util/cache"
 #include "util/testing.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "util/cache.h"
 
 using namespace colmap;
@@ -150,6 +154,24 @@ BOOST_AUTO_TEST_CASE(TestLRUCachePop) {
   BOOST_CHECK_EQUAL(cache.NumElems(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(TestLRUCacheErase) {
+  LRUCache<int, int> cache(5, [](const int key) { return key; });
+  for (int i = 0; i < 5; ++i) {
+    BOOST_CHECK_EQUAL(cache.Get(i), i);
+  }
+
+  cache.Erase(2);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 4);
+  BOOST_CHECK(!cache.Exists(2));
+  cache.Erase(2);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 4);
+
+  // The erased element does not count towards the maximum number of elements.
+  BOOST_CHECK_EQUAL(cache.Get(5), 5);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 5);
+  BOOST_CHECK(cache.Exists(0));
+}
+
 BOOST_AUTO_TEST_CASE(TestLRUCacheClear) {
   LRUCache<int, int> cache(5, [](const int key) { return key; });
   BOOST_CHECK_EQUAL(cache.NumElems(), 0);
@@ -167,6 +189,43 @@ BOOST_AUTO_TEST_CASE(TestLRUCacheClear) {
   BOOST_CHECK(cache.Exists(0));
 }
 
+BOOST_AUTO_TEST_CASE(TestLRUCacheEvictionRank) {
+  LRUCache<int, int> cache(3, [](const int key) { return key; });
+  // Evict the element with the largest key first.
+  cache.SetEvictionRankFunc([](const int key) { return key; });
+  for (int i = 0; i < 3; ++i) {
+    BOOST_CHECK_EQUAL(cache.Get(i), i);
+  }
+
+  // The most recently used element is not evicted, even if ranked highest.
+  BOOST_CHECK_EQUAL(cache.Get(5), 5);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 3);
+  BOOST_CHECK(cache.Exists(0));
+  BOOST_CHECK(cache.Exists(1));
+  BOOST_CHECK(!cache.Exists(2));
+  BOOST_CHECK(cache.Exists(5));
+
+  BOOST_CHECK_EQUAL(cache.Get(3), 3);
+  BOOST_CHECK(cache.Exists(0));
+  BOOST_CHECK(cache.Exists(1));
+  BOOST_CHECK(cache.Exists(3));
+  BOOST_CHECK(!cache.Exists(5));
+
+  // Elements with equal rank are evicted in least recently used order.
+  cache.SetEvictionRankFunc([](const int) { return 0; });
+  BOOST_CHECK_EQUAL(cache.Get(0), 0);
+  BOOST_CHECK_EQUAL(cache.Get(4), 4);
+  BOOST_CHECK(cache.Exists(0));
+  BOOST_CHECK(!cache.Exists(1));
+  BOOST_CHECK(cache.Exists(3));
+  BOOST_CHECK(cache.Exists(4));
+
+  cache.Pop();
+  cache.Pop();
+  cache.Pop();
+  BOOST_CHECK_EQUAL(cache.NumElems(), 0);
+}
+
 struct SizedElem {
   SizedElem(const size_t num_bytes_) : num_bytes(num_bytes_) {}
   size_t NumBytes() const { return num_bytes; }
@@ -239,6 +298,26 @@ BOOST_AUTO_TEST_CASE(TestMemoryConstrainedLRUCacheClear) {
   BOOST_CHECK(cache.Exists(1));
 }
 
+BOOST_AUTO_TEST_CASE(TestMemoryConstrainedLRUCacheErase) {
+  MemoryConstrainedLRUCache<int, SizedElem> cache(
+      10, [](const int key) { return SizedElem(key); });
+  for (int i = 0; i < 5; ++i) {
+    BOOST_CHECK_EQUAL(cache.Get(i).NumBytes(), i);
+  }
+  BOOST_CHECK_EQUAL(cache.NumBytes(), 10);
+
+  cache.Erase(3);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 4);
+  BOOST_CHECK_EQUAL(cache.NumBytes(), 7);
+  BOOST_CHECK(!cache.Exists(3));
+  cache.Erase(3);
+  BOOST_CHECK_EQUAL(cache.NumBytes(), 7);
+
+  BOOST_CHECK_EQUAL(cache.Get(3).NumBytes(), 3);
+  BOOST_CHECK_EQUAL(cache.NumBytes(), 10);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 5);
+}
+
 BOOST_AUTO_TEST_CASE(TestMemoryConstrainedLRUCacheUpdateNumBytes) {
   MemoryConstrainedLRUCache<int, SizedElem> cache(
       50, [](const int key) { return SizedElem(key); });
@@ -271,3 +350,211 @@ BOOST_AUTO_TEST_CASE(TestMemoryConstrainedLRUCacheUpdateNumBytes) {
   BOOST_CHECK_EQUAL(cache.Get(2).NumBytes(), 2);
   BOOST_CHECK_EQUAL(cache.NumBytes(), 2);
 }
+
+BOOST_AUTO_TEST_CASE(TestMemoryConstrainedLRUCacheEvictionRank) {
+  MemoryConstrainedLRUCache<int, SizedElem> cache(
+      10, [](const int key) { return SizedElem(key); });
+  // Evict the element with the smallest size first.
+  cache.SetEvictionRankFunc([](const int key) { return 10 - key; });
+  for (int i = 1; i < 5; ++i) {
+    BOOST_CHECK_EQUAL(cache.Get(i).NumBytes(), i);
+  }
+
+  BOOST_CHECK_EQUAL(cache.NumBytes(), 10);
+  BOOST_CHECK_EQUAL(cache.Get(3).NumBytes(), 3);
+  BOOST_CHECK_EQUAL(cache.Get(5).NumBytes(), 5);
+  BOOST_CHECK_EQUAL(cache.NumBytes(), 9);
+  BOOST_CHECK(!cache.Exists(1));
+  BOOST_CHECK(!cache.Exists(2));
+  BOOST_CHECK(!cache.Exists(3));
+  BOOST_CHECK(cache.Exists(4));
+  BOOST_CHECK(cache.Exists(5));
+}
+
+BOOST_AUTO_TEST_CASE(TestShardedLRUCacheEmpty) {
+  ShardedLRUCache<int, int> cache(8, 4, [](const int key) { return key; });
+  BOOST_CHECK_EQUAL(cache.NumElems(), 0);
+  BOOST_CHECK_EQUAL(cache.MaxNumElems(), 8);
+  BOOST_CHECK_EQUAL(cache.NumShards(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(TestShardedLRUCacheNumShards) {
+  ShardedLRUCache<int, int> cache(2, 4, [](const int key) { return key; });
+  BOOST_CHECK_EQUAL(cache.NumShards(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(TestShardedLRUCacheGet) {
+  int num_getter_calls = 0;
+  ShardedLRUCache<int, int> cache(4, 2, [&](const int key) {
+    num_getter_calls += 1;
+    return key;
+  });
+  for (int i = 0; i < 4; ++i) {
+    BOOST_CHECK_EQUAL(*cache.Get(i), i);
+    BOOST_CHECK_EQUAL(cache.NumElems(), i + 1);
+    BOOST_CHECK(cache.Exists(i));
+  }
+  BOOST_CHECK_EQUAL(num_getter_calls, 4);
+  BOOST_CHECK_EQUAL(cache.NumHits(), 0);
+  BOOST_CHECK_EQUAL(cache.NumMisses(), 4);
+  BOOST_CHECK_EQUAL(cache.NumEvictions(), 0);
+
+  BOOST_CHECK_EQUAL(*cache.Get(2), 2);
+  BOOST_CHECK_EQUAL(num_getter_calls, 4);
+
+  // Key 4 is in the same shard as keys 0 and 2, and evicts the least recently
+  // used key 0 of this shard.
+  const auto value4 = cache.Get(4);
+  BOOST_CHECK_EQUAL(*value4, 4);
+  BOOST_CHECK_EQUAL(num_getter_calls, 5);
+  BOOST_CHECK_EQUAL(cache.NumHits(), 1);
+  BOOST_CHECK_EQUAL(cache.NumMisses(), 5);
+  BOOST_CHECK_EQUAL(cache.NumEvictions(), 1);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 4);
+  BOOST_CHECK(!cache.Exists(0));
+  BOOST_CHECK(cache.Exists(1));
+  BOOST_CHECK(cache.Exists(2));
+  BOOST_CHECK(cache.Exists(3));
+  BOOST_CHECK(cache.Exists(4));
+
+  // The value stays valid after it is evicted from the cache.
+  cache.Get(6);
+  cache.Get(8);
+  BOOST_CHECK(!cache.Exists(4));
+  BOOST_CHECK_EQUAL(*value4, 4);
+}
+
+BOOST_AUTO_TEST_CASE(TestShardedLRUCacheClear) {
+  ShardedLRUCache<int, int> cache(4, 2, [](const int key) { return key; });
+  for (int i = 0; i < 4; ++i) {
+    cache.Get(i);
+  }
+  BOOST_CHECK_EQUAL(cache.NumElems(), 4);
+  cache.Clear();
+  BOOST_CHECK_EQUAL(cache.NumElems(), 0);
+  BOOST_CHECK(!cache.Exists(0));
+  BOOST_CHECK_EQUAL(*cache.Get(0), 0);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestShardedLRUCacheErase) {
+  ShardedLRUCache<int, int> cache(4, 2, [](const int key) { return key; });
+  for (int i = 0; i < 4; ++i) {
+    cache.Get(i);
+  }
+  cache.Erase(1);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 3);
+  BOOST_CHECK(!cache.Exists(1));
+  BOOST_CHECK(cache.Exists(0));
+  BOOST_CHECK_EQUAL(cache.NumEvictions(), 0);
+  cache.Erase(1);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 3);
+  BOOST_CHECK_EQUAL(*cache.Get(1), 1);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(TestShardedLRUCacheShrink) {
+  ShardedLRUCache<int, int> cache(4, 2, [](const int key) { return key; });
+  for (int i = 0; i < 4; ++i) {
+    cache.Get(i);
+  }
+  BOOST_CHECK_EQUAL(cache.NumElems(), 4);
+  cache.Shrink(4);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 4);
+  BOOST_CHECK_EQUAL(cache.NumEvictions(), 0);
+  cache.Shrink(2);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 2);
+  BOOST_CHECK_EQUAL(cache.NumEvictions(), 2);
+  BOOST_CHECK(!cache.Exists(0));
+  BOOST_CHECK(!cache.Exists(1));
+  BOOST_CHECK(cache.Exists(2));
+  BOOST_CHECK(cache.Exists(3));
+  BOOST_CHECK_EQUAL(cache.MaxNumElems(), 4);
+  cache.Shrink(0);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestShardedLRUCacheConcurrentGet) {
+  std::atomic<int> num_getter_calls(0);
+  ShardedLRUCache<int, int> cache(100, 8, [&](const int key) {
+    num_getter_calls += 1;
+    return 2 * key;
+  });
+
+  std::vector<std::thread> threads;
+  std::atomic<bool> all_correct(true);
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 1000; ++j) {
+        const int key = j % 100;
+        if (*cache.Get(key) != 2 * key) {
+          all_correct = false;
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  BOOST_CHECK(all_correct);
+  BOOST_CHECK_EQUAL(cache.NumElems(), 100);
+  BOOST_CHECK_EQUAL(num_getter_calls, 100);
+}
+
+BOOST_AUTO_TEST_CASE(TestShardedLRUCacheConcurrentMiss) {
+  std::atomic<int> num_getter_calls(0);
+  ShardedLRUCache<int, int> cache(10, 1, [&](const int key) {
+    num_getter_calls += 1;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    return 2 * key;
+  });
+
+  // All threads miss the same key at the same time, but the value is only
+  // computed once.
+  std::vector<std::thread> threads;
+  std::atomic<bool> all_correct(true);
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&]() {
+      if (*cache.Get(1) != 2) {
+        all_correct = false;
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  BOOST_CHECK(all_correct);
+  BOOST_CHECK_EQUAL(num_getter_calls, 1);
+  BOOST_CHECK_EQUAL(cache.NumMisses(), 1);
+  BOOST_CHECK_EQUAL(cache.NumHits(), 7);
+}
+
+BOOST_AUTO_TEST_CASE(TestShardedLRUCachePrefetch) {
+  std::atomic<int> num_getter_calls(0);
+  ShardedLRUCache<int, int> cache(4, 2, [&](const int key) {
+    num_getter_calls += 1;
+    return 2 * key;
+  });
+
+  cache.Prefetch(0);
+  cache.Prefetch(1);
+  cache.Prefetch(1);
+  cache.WaitForPrefetch();
+  BOOST_CHECK(cache.Exists(0));
+  BOOST_CHECK(cache.Exists(1));
+  BOOST_CHECK_EQUAL(num_getter_calls, 2);
+  BOOST_CHECK_EQUAL(cache.NumMisses(), 0);
+
+  BOOST_CHECK_EQUAL(*cache.Get(0), 0);
+  BOOST_CHECK_EQUAL(*cache.Get(1), 2);
+  BOOST_CHECK_EQUAL(num_getter_calls, 2);
+  BOOST_CHECK_EQUAL(cache.NumHits(), 2);
+
+  cache.Prefetch(0);
+  cache.WaitForPrefetch();
+  BOOST_CHECK_EQUAL(num_getter_calls, 2);
+}
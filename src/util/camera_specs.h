@@ -32,17 +32,29 @@
 #ifndef COLMAP_SRC_UTIL_CAMERA_SPECS_H_
 #define COLMAP_SRC_UTIL_CAMERA_SPECS_H_
 
-#include <string>
-#include <unordered_map>
-#include <vector>
+#include <cstddef>
 
 namespace colmap {
 
-// { make1 : ({ model1 : sensor-width in mm }, ...), ... }
-typedef std::vector<std::pair<std::string, float>> camera_make_specs_t;
-typedef std::unordered_map<std::string, camera_make_specs_t> camera_specs_t;
+struct CameraModelSpecs {
+  // Lower-case model name without separators.
+  const char* model;
+  // Sensor width in mm.
+  float sensor_width;
+};
 
-camera_specs_t InitializeCameraSpecs();
+struct CameraMakeSpecs {
+  // Lower-case make name without separators.
+  const char* make;
+  // Range of models of this make in the model table.
+  const CameraModelSpecs* models_begin;
+  const CameraModelSpecs* models_end;
+};
+
+// Table of known camera makes sorted by make name. The table is constant
+// initialized at compile-time, so it requires no construction at startup.
+extern const CameraMakeSpecs kCameraMakeSpecs[];
+extern const size_t kNumCameraMakeSpecs;
 
 }  // namespace colmap
 
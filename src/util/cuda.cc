@@ -84,4 +84,18 @@ void SetBestCudaDevice(const int gpu_index) {
   CUDA_SAFE_CALL(cudaSetDevice(selected_gpu_index));
 }
 
+size_t GetCudaDeviceMemory(const int gpu_index) {
+  cudaDeviceProp device_prop;
+  CUDA_SAFE_CALL(cudaGetDeviceProperties(&device_prop, gpu_index));
+  return device_prop.totalGlobalMem;
+}
+
+void GetCudaMemoryUsage(int* gpu_index, size_t* used_num_bytes,
+                        size_t* total_num_bytes) {
+  CUDA_SAFE_CALL(cudaGetDevice(gpu_index));
+  size_t free_num_bytes;
+  CUDA_SAFE_CALL(cudaMemGetInfo(&free_num_bytes, total_num_bytes));
+  *used_num_bytes = *total_num_bytes - free_num_bytes;
+}
+
 }  // namespace colmap
@@ -32,12 +32,21 @@
 #ifndef COLMAP_SRC_UTIL_CUDA_H_
 #define COLMAP_SRC_UTIL_CUDA_H_
 
+#include <cstddef>
+
 namespace colmap {
 
 int GetNumCudaDevices();
 
 void SetBestCudaDevice(const int gpu_index);
 
+// Get the total memory in bytes of the given device.
+size_t GetCudaDeviceMemory(const int gpu_index);
+
+// Get the index and the used and total memory in bytes of the current device.
+void GetCudaMemoryUsage(int* gpu_index, size_t* used_num_bytes,
+                        size_t* total_num_bytes);
+
 }  // namespace colmap
 
 #endif  // COLMAP_SRC_UTIL_CUDA_H_
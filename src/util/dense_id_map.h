@@ -0,0 +1,354 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+
+#ifndef COLMAP_SRC_UTIL_DENSE_ID_MAP_H_
+#define COLMAP_SRC_UTIL_DENSE_ID_MAP_H_
+
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace colmap {
+
+// Associative container for values with densely allocated integer identifiers,
+// such as the sequentially assigned identifiers of 3D points. The values are
+// stored in contiguous slots, which are located through an array indexed by
+// the identifier. Compared to `std::unordered_map`, lookups do not require
+// hashing, iteration is cache-friendly, and the memory overhead per element is
+// much smaller. The slots of erased values are recycled through a free list.
+// As for `std::unordered_map`, references to values remain valid until the
+// value is erased. The container provides the subset of the interface of
+// `std::unordered_map` used throughout the code base.
+//
+// Note that the size of the index array is proportional to the largest
+// identifier in the container, so the identifiers should be allocated densely.
+template <typename key_t, typename value_t>
+class DenseIdMap {
+ private:
+  struct Slot {
+    bool occupied = false;
+    std::pair<key_t, value_t> value;
+  };
+
+  template <typename slot_iterator_t, typename reference_t>
+  class Iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef typename std::remove_reference<reference_t>::type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef value_type* pointer;
+    typedef reference_t reference;
+
+    Iterator() {}
+    Iterator(const slot_iterator_t& slot_it, const slot_iterator_t& slot_end)
+        : slot_it_(slot_it), slot_end_(slot_end) {
+      SkipFreeSlots();
+    }
+
+    reference operator*() const { return slot_it_->value; }
+    pointer operator->() const { return &slot_it_->value; }
+
+    Iterator& operator++() {
+      ++slot_it_;
+      SkipFreeSlots();
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator it = *this;
+      ++(*this);
+      return it;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return slot_it_ == other.slot_it_;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return slot_it_ != other.slot_it_;
+    }
+
+   private:
+    void SkipFreeSlots() {
+      while (slot_it_ != slot_end_ && !slot_it_->occupied) {
+        ++slot_it_;
+      }
+    }
+
+    slot_iterator_t slot_it_;
+    slot_iterator_t slot_end_;
+  };
+
+ public:
+  typedef key_t key_type;
+  typedef value_t mapped_type;
+  typedef std::pair<key_t, value_t> value_type;
+  typedef Iterator<typename std::deque<Slot>::iterator, value_type&> iterator;
+  typedef Iterator<typename std::deque<Slot>::const_iterator,
+                   const value_type&>
+      const_iterator;
+
+  static_assert(std::is_integral<key_t>::value,
+                "Identifiers must be of integral type");
+
+  // The number of elements in the container.
+  size_t size() const;
+  bool empty() const;
+
+  // Reserve the index for identifiers up to the given number.
+  void reserve(const size_t num_ids);
+
+  // Remove all elements from the container.
+  void clear();
+
+  iterator begin();
+  iterator end();
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  // Find the element with the given identifier or return `end()`.
+  iterator find(const key_t key);
+  const_iterator find(const key_t key) const;
+
+  // The number of elements with the given identifier, i.e. 0 or 1.
+  size_t count(const key_t key) const;
+
+  // Access the value with the given identifier. Throws `std::out_of_range`,
+  // if the identifier does not exist.
+  value_t& at(const key_t key);
+  const value_t& at(const key_t key) const;
+
+  // Access the value with the given identifier, which is default constructed,
+  // if the identifier does not exist yet.
+  value_t& operator[](const key_t key);
+
+  // Insert a new element, if the identifier does not exist yet. Returns the
+  // element with the given identifier and whether it was inserted.
+  std::pair<iterator, bool> emplace(const key_t key, const value_t& value);
+
+  // Erase the element with the given identifier and return the number of
+  // erased elements, i.e. 0 or 1.
+  size_t erase(const key_t key);
+
+ private:
+  typedef uint32_t slot_idx_t;
+
+  static const slot_idx_t kInvalidSlotIdx =
+      std::numeric_limits<slot_idx_t>::max();
+
+  slot_idx_t FindSlotIdx(const key_t key) const;
+
+  // The slot index of each identifier or `kInvalidSlotIdx`.
+  std::vector<slot_idx_t> slot_idxs_;
+
+  // The slots are stored in a deque, which does not move existing slots when
+  // new slots are appended.
+  std::deque<Slot> slots_;
+
+  // The indices of slots that can be reused for new elements.
+  std::vector<slot_idx_t> free_slot_idxs_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename key_t, typename value_t>
+const typename DenseIdMap<key_t, value_t>::slot_idx_t
+    DenseIdMap<key_t, value_t>::kInvalidSlotIdx;
+
+template <typename key_t, typename value_t>
+size_t DenseIdMap<key_t, value_t>::size() const {
+  return slots_.size() - free_slot_idxs_.size();
+}
+
+template <typename key_t, typename value_t>
+bool DenseIdMap<key_t, value_t>::empty() const {
+  return size() == 0;
+}
+
+template <typename key_t, typename value_t>
+void DenseIdMap<key_t, value_t>::reserve(const size_t num_ids) {
+  slot_idxs_.reserve(num_ids);
+}
+
+template <typename key_t, typename value_t>
+void DenseIdMap<key_t, value_t>::clear() {
+  slot_idxs_.clear();
+  slots_.clear();
+  free_slot_idxs_.clear();
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::iterator
+DenseIdMap<key_t, value_t>::begin() {
+  return iterator(slots_.begin(), slots_.end());
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::iterator
+DenseIdMap<key_t, value_t>::end() {
+  return iterator(slots_.end(), slots_.end());
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::const_iterator
+DenseIdMap<key_t, value_t>::begin() const {
+  return const_iterator(slots_.begin(), slots_.end());
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::const_iterator
+DenseIdMap<key_t, value_t>::end() const {
+  return const_iterator(slots_.end(), slots_.end());
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::iterator DenseIdMap<key_t, value_t>::find(
+    const key_t key) {
+  const slot_idx_t slot_idx = FindSlotIdx(key);
+  if (slot_idx == kInvalidSlotIdx) {
+    return end();
+  }
+  return iterator(slots_.begin() + slot_idx, slots_.end());
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::const_iterator
+DenseIdMap<key_t, value_t>::find(const key_t key) const {
+  const slot_idx_t slot_idx = FindSlotIdx(key);
+  if (slot_idx == kInvalidSlotIdx) {
+    return end();
+  }
+  return const_iterator(slots_.begin() + slot_idx, slots_.end());
+}
+
+template <typename key_t, typename value_t>
+size_t DenseIdMap<key_t, value_t>::count(const key_t key) const {
+  return FindSlotIdx(key) == kInvalidSlotIdx ? 0 : 1;
+}
+
+template <typename key_t, typename value_t>
+value_t& DenseIdMap<key_t, value_t>::at(const key_t key) {
+  const slot_idx_t slot_idx = FindSlotIdx(key);
+  if (slot_idx == kInvalidSlotIdx) {
+    throw std::out_of_range("Identifier does not exist");
+  }
+  return slots_[slot_idx].value.second;
+}
+
+template <typename key_t, typename value_t>
+const value_t& DenseIdMap<key_t, value_t>::at(const key_t key) const {
+  const slot_idx_t slot_idx = FindSlotIdx(key);
+  if (slot_idx == kInvalidSlotIdx) {
+    throw std::out_of_range("Identifier does not exist");
+  }
+  return slots_[slot_idx].value.second;
+}
+
+template <typename key_t, typename value_t>
+value_t& DenseIdMap<key_t, value_t>::operator[](const key_t key) {
+  const slot_idx_t slot_idx = FindSlotIdx(key);
+  if (slot_idx == kInvalidSlotIdx) {
+    return emplace(key, value_t()).first->second;
+  }
+  return slots_[slot_idx].value.second;
+}
+
+template <typename key_t, typename value_t>
+std::pair<typename DenseIdMap<key_t, value_t>::iterator, bool>
+DenseIdMap<key_t, value_t>::emplace(const key_t key, const value_t& value) {
+  const auto existing_it = find(key);
+  if (existing_it != end()) {
+    return std::make_pair(existing_it, false);
+  }
+
+  const size_t id = static_cast<size_t>(key);
+  if (id >= slot_idxs_.size()) {
+    slot_idxs_.resize(id + 1, kInvalidSlotIdx);
+  }
+
+  slot_idx_t slot_idx;
+  if (free_slot_idxs_.empty()) {
+    slot_idx = static_cast<slot_idx_t>(slots_.size());
+    slots_.emplace_back();
+  } else {
+    slot_idx = free_slot_idxs_.back();
+    free_slot_idxs_.pop_back();
+  }
+
+  Slot& slot = slots_[slot_idx];
+  slot.occupied = true;
+  slot.value.first = key;
+  slot.value.second = value;
+  slot_idxs_[id] = slot_idx;
+
+  return std::make_pair(iterator(slots_.begin() + slot_idx, slots_.end()),
+                        true);
+}
+
+template <typename key_t, typename value_t>
+size_t DenseIdMap<key_t, value_t>::erase(const key_t key) {
+  const slot_idx_t slot_idx = FindSlotIdx(key);
+  if (slot_idx == kInvalidSlotIdx) {
+    return 0;
+  }
+
+  // Release the memory held by the value.
+  Slot& slot = slots_[slot_idx];
+  slot.occupied = false;
+  slot.value = value_type();
+
+  slot_idxs_[static_cast<size_t>(key)] = kInvalidSlotIdx;
+  free_slot_idxs_.push_back(slot_idx);
+
+  return 1;
+}
+
+template <typename key_t, typename value_t>
+typename DenseIdMap<key_t, value_t>::slot_idx_t
+DenseIdMap<key_t, value_t>::FindSlotIdx(const key_t key) const {
+  const size_t id = static_cast<size_t>(key);
+  if (id >= slot_idxs_.size()) {
+    return kInvalidSlotIdx;
+  }
+  return slot_idxs_[id];
+}
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_UTIL_DENSE_ID_MAP_H_
@@ -0,0 +1,133 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+
+#define TEST_NAME "util/dense_id_map"
+#include "util/testing.h"
+
+#include <string>
+
+#include "util/dense_id_map.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestEmpty) {
+  DenseIdMap<uint64_t, std::string> map;
+  BOOST_CHECK_EQUAL(map.size(), 0);
+  BOOST_CHECK(map.empty());
+  BOOST_CHECK(map.begin() == map.end());
+  BOOST_CHECK(map.find(0) == map.end());
+  BOOST_CHECK_EQUAL(map.count(0), 0);
+  BOOST_CHECK_EQUAL(map.count(100), 0);
+  BOOST_CHECK_THROW(map.at(0), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(TestEmplaceAndAccess) {
+  DenseIdMap<uint64_t, std::string> map;
+  BOOST_CHECK(map.emplace(1, "a").second);
+  BOOST_CHECK(map.emplace(5, "b").second);
+  BOOST_CHECK(!map.emplace(5, "c").second);
+  BOOST_CHECK_EQUAL(map.size(), 2);
+  BOOST_CHECK(!map.empty());
+  BOOST_CHECK_EQUAL(map.count(0), 0);
+  BOOST_CHECK_EQUAL(map.count(1), 1);
+  BOOST_CHECK_EQUAL(map.count(2), 0);
+  BOOST_CHECK_EQUAL(map.count(5), 1);
+  BOOST_CHECK_EQUAL(map.at(1), "a");
+  BOOST_CHECK_EQUAL(map.at(5), "b");
+  BOOST_CHECK_EQUAL(map.find(5)->first, 5);
+  BOOST_CHECK_EQUAL(map.find(5)->second, "b");
+  BOOST_CHECK_THROW(map.at(2), std::out_of_range);
+
+  map[3] = "d";
+  BOOST_CHECK_EQUAL(map.size(), 3);
+  BOOST_CHECK_EQUAL(map.at(3), "d");
+  BOOST_CHECK_EQUAL(map[7], "");
+  BOOST_CHECK_EQUAL(map.size(), 4);
+
+  const DenseIdMap<uint64_t, std::string>& const_map = map;
+  BOOST_CHECK_EQUAL(const_map.at(1), "a");
+  BOOST_CHECK(const_map.find(1) != const_map.end());
+  BOOST_CHECK(const_map.find(2) == const_map.end());
+}
+
+BOOST_AUTO_TEST_CASE(TestEraseAndReuse) {
+  DenseIdMap<uint64_t, std::string> map;
+  map.emplace(1, "a");
+  map.emplace(2, "b");
+  map.emplace(3, "c");
+  const std::string* value3 = &map.at(3);
+
+  BOOST_CHECK_EQUAL(map.erase(2), 1);
+  BOOST_CHECK_EQUAL(map.erase(2), 0);
+  BOOST_CHECK_EQUAL(map.erase(10), 0);
+  BOOST_CHECK_EQUAL(map.size(), 2);
+  BOOST_CHECK_EQUAL(map.count(2), 0);
+
+  // The free slot is reused and references to other values remain valid.
+  map.emplace(4, "d");
+  for (uint64_t id = 5; id < 1000; ++id) {
+    map.emplace(id, "x");
+  }
+  BOOST_CHECK_EQUAL(map.size(), 998);
+  BOOST_CHECK_EQUAL(&map.at(3), value3);
+  BOOST_CHECK_EQUAL(map.at(3), "c");
+  BOOST_CHECK_EQUAL(map.at(4), "d");
+
+  map.clear();
+  BOOST_CHECK(map.empty());
+  BOOST_CHECK_EQUAL(map.count(3), 0);
+  BOOST_CHECK(map.begin() == map.end());
+}
+
+BOOST_AUTO_TEST_CASE(TestIteration) {
+  DenseIdMap<uint64_t, int> map;
+  for (uint64_t id = 0; id < 10; ++id) {
+    map.emplace(id, static_cast<int>(id));
+  }
+  for (uint64_t id = 0; id < 10; id += 2) {
+    map.erase(id);
+  }
+
+  size_t num_elems = 0;
+  for (auto& elem : map) {
+    BOOST_CHECK_EQUAL(elem.first % 2, 1);
+    BOOST_CHECK_EQUAL(elem.second, static_cast<int>(elem.first));
+    elem.second += 1;
+    num_elems += 1;
+  }
+  BOOST_CHECK_EQUAL(num_elems, 5);
+
+  const DenseIdMap<uint64_t, int>& const_map = map;
+  for (const auto& elem : const_map) {
+    BOOST_CHECK_EQUAL(elem.second, static_cast<int>(elem.first) + 1);
+  }
+}
@@ -0,0 +1,311 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "util/gpu_scheduler.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "util/logging.h"
+#include "util/metrics.h"
+#include "util/misc.h"
+#include "util/string.h"
+
+#ifdef CUDA_ENABLED
+#include "util/cuda.h"
+#endif
+
+namespace colmap {
+
+bool GpuScheduler::Options::Check() const {
+  CHECK_OPTION_GT(memory_fraction, 0);
+  CHECK_OPTION_LE(memory_fraction, 1);
+  return true;
+}
+
+GpuScheduler::Lease::Lease()
+    : scheduler_(nullptr), gpu_index_(-1), num_bytes_(0) {}
+
+GpuScheduler::Lease::Lease(GpuScheduler* scheduler, const int gpu_index,
+                           const size_t num_bytes)
+    : scheduler_(scheduler), gpu_index_(gpu_index), num_bytes_(num_bytes) {}
+
+GpuScheduler::Lease::Lease(Lease&& other)
+    : scheduler_(other.scheduler_),
+      gpu_index_(other.gpu_index_),
+      num_bytes_(other.num_bytes_) {
+  other.scheduler_ = nullptr;
+}
+
+GpuScheduler::Lease& GpuScheduler::Lease::operator=(Lease&& other) {
+  if (this != &other) {
+    Release();
+    scheduler_ = other.scheduler_;
+    gpu_index_ = other.gpu_index_;
+    num_bytes_ = other.num_bytes_;
+    other.scheduler_ = nullptr;
+  }
+  return *this;
+}
+
+GpuScheduler::Lease::~Lease() { Release(); }
+
+bool GpuScheduler::Lease::IsValid() const { return scheduler_ != nullptr; }
+
+int GpuScheduler::Lease::GpuIndex() const { return gpu_index_; }
+
+size_t GpuScheduler::Lease::NumBytes() const { return num_bytes_; }
+
+void GpuScheduler::Lease::Release() {
+  if (scheduler_ != nullptr) {
+    scheduler_->Release(gpu_index_, num_bytes_);
+    scheduler_ = nullptr;
+  }
+}
+
+GpuScheduler& GpuScheduler::Get() {
+  static GpuScheduler* scheduler = []() {
+    std::vector<int> gpu_indices;
+    std::vector<size_t> memory_sizes;
+#ifdef CUDA_ENABLED
+    const int num_cuda_devices = GetNumCudaDevices();
+    for (int gpu_index = 0; gpu_index < num_cuda_devices; ++gpu_index) {
+      gpu_indices.push_back(gpu_index);
+      memory_sizes.push_back(GetCudaDeviceMemory(gpu_index));
+    }
+#endif
+    GpuScheduler* scheduler = new GpuScheduler(gpu_indices, memory_sizes);
+    scheduler->export_metrics_ = true;
+    return scheduler;
+  }();
+  return *scheduler;
+}
+
+GpuScheduler::GpuScheduler(const std::vector<int>& gpu_indices,
+                           const std::vector<size_t>& memory_sizes)
+    : export_metrics_(false), has_leases_(false) {
+  CHECK_EQ(gpu_indices.size(), memory_sizes.size());
+  for (size_t i = 0; i < gpu_indices.size(); ++i) {
+    CHECK_GE(gpu_indices[i], 0);
+    Device& device = devices_[gpu_indices[i]];
+    device.memory_size = memory_sizes[i];
+    device.stats.gpu_index = gpu_indices[i];
+  }
+  SetOptions(options_);
+}
+
+void GpuScheduler::SetOptions(const Options& options) {
+  CHECK(options.Check());
+  std::unique_lock<std::mutex> lock(mutex_);
+  options_ = options;
+  for (auto& device : devices_) {
+    device.second.stats.memory_budget = static_cast<size_t>(
+        options_.memory_fraction * device.second.memory_size);
+  }
+  lock.unlock();
+  release_condition_.notify_all();
+}
+
+GpuScheduler::Options GpuScheduler::GetOptions() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return options_;
+}
+
+std::vector<int> GpuScheduler::GetGpuIndices(
+    const std::string& gpu_index) const {
+  std::vector<int> gpu_indices = CSVToVector<int>(gpu_index);
+  CHECK_GT(gpu_indices.size(), 0) << "Invalid GPU indices: " << gpu_index;
+  if (gpu_indices.size() == 1 && gpu_indices[0] == -1) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!devices_.empty()) {
+      gpu_indices.clear();
+      for (const auto& device : devices_) {
+        gpu_indices.push_back(device.first);
+      }
+    }
+  }
+  return gpu_indices;
+}
+
+GpuScheduler::Lease GpuScheduler::Acquire(const std::string& gpu_index,
+                                          const size_t num_bytes) {
+  const std::vector<int> gpu_indices = GetGpuIndices(gpu_index);
+  std::unique_lock<std::mutex> lock(mutex_);
+  Device* device = FindDevice(gpu_indices, num_bytes);
+  if (device == nullptr) {
+    for (const int index : gpu_indices) {
+      devices_.at(index).stats.num_queued_leases += 1;
+    }
+    release_condition_.wait(lock, [&]() {
+      device = FindDevice(gpu_indices, num_bytes);
+      return device != nullptr;
+    });
+  }
+  return Grant(device, num_bytes);
+}
+
+GpuScheduler::Lease GpuScheduler::TryAcquire(const std::string& gpu_index,
+                                             const size_t num_bytes) {
+  const std::vector<int> gpu_indices = GetGpuIndices(gpu_index);
+  std::unique_lock<std::mutex> lock(mutex_);
+  Device* device = FindDevice(gpu_indices, num_bytes);
+  if (device == nullptr) {
+    return Lease();
+  }
+  return Grant(device, num_bytes);
+}
+
+GpuScheduler::Device* GpuScheduler::FindDevice(
+    const std::vector<int>& gpu_indices, const size_t num_bytes) {
+  Device* best_device = nullptr;
+  for (const int gpu_index : gpu_indices) {
+    auto device_it = devices_.find(gpu_index);
+    if (device_it == devices_.end()) {
+      // Unknown devices, e.g., without CUDA, have an unlimited budget.
+      device_it = devices_.emplace(gpu_index, Device()).first;
+      device_it->second.stats.gpu_index = gpu_index;
+    }
+
+    Device& device = device_it->second;
+    const DeviceStats& stats = device.stats;
+    if (stats.num_active_leases > 0) {
+      if (options_.max_num_leases_per_device > 0 &&
+          stats.num_active_leases >= options_.max_num_leases_per_device) {
+        continue;
+      }
+      if (stats.memory_budget > 0 &&
+          stats.num_leased_bytes + num_bytes > stats.memory_budget) {
+        continue;
+      }
+    }
+
+    if (best_device == nullptr ||
+        stats.num_active_leases < best_device->stats.num_active_leases ||
+        (stats.num_active_leases == best_device->stats.num_active_leases &&
+         stats.num_leased_bytes < best_device->stats.num_leased_bytes)) {
+      best_device = &device;
+    }
+  }
+  return best_device;
+}
+
+GpuScheduler::Lease GpuScheduler::Grant(Device* device,
+                                        const size_t num_bytes) {
+  const Clock::time_point now = Clock::now();
+  if (!has_leases_) {
+    has_leases_ = true;
+    first_lease_time_ = now;
+  }
+
+  DeviceStats& stats = device->stats;
+  if (stats.num_active_leases == 0) {
+    device->busy_start = now;
+  }
+  stats.num_active_leases += 1;
+  stats.num_leases += 1;
+  stats.num_leased_bytes += num_bytes;
+  stats.max_num_leased_bytes =
+      std::max(stats.max_num_leased_bytes, stats.num_leased_bytes);
+  UpdateMetrics(stats);
+
+  return Lease(this, stats.gpu_index, num_bytes);
+}
+
+void GpuScheduler::Release(const int gpu_index, const size_t num_bytes) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Device& device = devices_.at(gpu_index);
+    DeviceStats& stats = device.stats;
+    CHECK_GT(stats.num_active_leases, 0);
+    CHECK_GE(stats.num_leased_bytes, num_bytes);
+    stats.num_active_leases -= 1;
+    stats.num_leased_bytes -= num_bytes;
+    if (stats.num_active_leases == 0) {
+      stats.busy_seconds += std::chrono::duration<double>(
+                                Clock::now() - device.busy_start)
+                                .count();
+    }
+    UpdateMetrics(stats);
+  }
+  release_condition_.notify_all();
+}
+
+std::vector<GpuScheduler::DeviceStats> GpuScheduler::GetStats() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const Clock::time_point now = Clock::now();
+  const double elapsed_seconds =
+      has_leases_
+          ? std::chrono::duration<double>(now - first_lease_time_).count()
+          : 0;
+  std::vector<DeviceStats> stats;
+  stats.reserve(devices_.size());
+  for (const auto& device : devices_) {
+    stats.push_back(device.second.stats);
+    if (device.second.stats.num_active_leases > 0) {
+      stats.back().busy_seconds +=
+          std::chrono::duration<double>(now - device.second.busy_start)
+              .count();
+    }
+    if (elapsed_seconds > 0) {
+      stats.back().utilization =
+          std::min(1.0, stats.back().busy_seconds / elapsed_seconds);
+    }
+  }
+  return stats;
+}
+
+void GpuScheduler::PrintStats() const {
+  for (const auto& stats : GetStats()) {
+    if (stats.num_leases == 0) {
+      continue;
+    }
+    std::cout << StringPrintf(
+                     "GPU %d: %d leases (%d queued), %.1f%% utilization, "
+                     "%.2f GB peak leased memory",
+                     stats.gpu_index, stats.num_leases,
+                     stats.num_queued_leases, 100.0 * stats.utilization,
+                     stats.max_num_leased_bytes / (1024.0 * 1024.0 * 1024.0))
+              << std::endl;
+  }
+}
+
+void GpuScheduler::UpdateMetrics(const DeviceStats& stats) const {
+  if (!export_metrics_) {
+    return;
+  }
+  MetricsRegistry::Get().SetGauge(
+      StringPrintf("gpu_active_leases{gpu=\"%d\"}", stats.gpu_index),
+      stats.num_active_leases);
+  MetricsRegistry::Get().SetGauge(
+      StringPrintf("gpu_leased_bytes{gpu=\"%d\"}", stats.gpu_index),
+      stats.num_leased_bytes);
+}
+
+}  // namespace colmap
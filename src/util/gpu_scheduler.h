@@ -0,0 +1,180 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_UTIL_GPU_SCHEDULER_H_
+#define COLMAP_SRC_UTIL_GPU_SCHEDULER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "util/types.h"
+
+namespace colmap {
+
+// Process-wide scheduler of the GPUs, which leases devices with a memory
+// budget to the GPU workers of all stages, i.e., the SiftGPU extractors and
+// matchers, the patch match stereo workers, and the GPU bundle adjustment. A
+// lease is granted on the least occupied of the requested devices, on which
+// the remaining memory budget and the number of concurrent leases suffice.
+// Otherwise, the request is queued until another lease is released. A request
+// exceeding the budget of a device is granted once the device is idle.
+//
+//    auto lease = GpuScheduler::Get().Acquire(options.gpu_index, num_bytes);
+//    SetBestCudaDevice(lease.GpuIndex());
+//    // Run the GPU work...
+//    lease.Release();  // Or implicitly when the lease is destructed.
+//
+// Without CUDA, the devices are unknown and leases pass the requested index
+// through without any accounting.
+class GpuScheduler {
+ public:
+  struct Options {
+    // Fraction of the memory of a device that can be leased.
+    double memory_fraction = 0.9;
+
+    // Maximum number of concurrent leases per device. Unlimited if <= 0.
+    int max_num_leases_per_device = -1;
+
+    bool Check() const;
+  };
+
+  struct DeviceStats {
+    int gpu_index = -1;
+
+    // Number of bytes that can be leased, zero if unknown.
+    size_t memory_budget = 0;
+
+    // Current and maximum number of leased bytes.
+    size_t num_leased_bytes = 0;
+    size_t max_num_leased_bytes = 0;
+
+    // Current and total number of leases and the number of queued requests.
+    int num_active_leases = 0;
+    size_t num_leases = 0;
+    size_t num_queued_leases = 0;
+
+    // Time with at least one active lease and its fraction of the time since
+    // the first lease.
+    double busy_seconds = 0;
+    double utilization = 0;
+  };
+
+  // A lease of a device, which is released on destruction.
+  class Lease {
+   public:
+    Lease();
+    Lease(Lease&& other);
+    Lease& operator=(Lease&& other);
+    ~Lease();
+
+    bool IsValid() const;
+
+    // The index of the leased device, which is -1 if the devices are unknown
+    // and the default device was requested.
+    int GpuIndex() const;
+
+    // The number of leased bytes.
+    size_t NumBytes() const;
+
+    // Return the device to the scheduler.
+    void Release();
+
+   private:
+    friend class GpuScheduler;
+    NON_COPYABLE(Lease)
+
+    Lease(GpuScheduler* scheduler, const int gpu_index, const size_t num_bytes);
+
+    GpuScheduler* scheduler_;
+    int gpu_index_;
+    size_t num_bytes_;
+  };
+
+  // Access the scheduler of the process, which manages all CUDA devices.
+  static GpuScheduler& Get();
+
+  // Create a scheduler for the given devices and their memory in bytes, where
+  // zero memory denotes an unknown and unlimited budget.
+  GpuScheduler(const std::vector<int>& gpu_indices,
+               const std::vector<size_t>& memory_sizes);
+
+  void SetOptions(const Options& options);
+  Options GetOptions() const;
+
+  // Parse the comma-separated GPU indices of an option, where -1 expands to
+  // all known devices.
+  std::vector<int> GetGpuIndices(const std::string& gpu_index) const;
+
+  // Lease one of the devices of the comma-separated GPU indices with the given
+  // number of bytes, and block until a device is available.
+  Lease Acquire(const std::string& gpu_index, const size_t num_bytes = 0);
+
+  // Same as above, but return an invalid lease if no device is available.
+  Lease TryAcquire(const std::string& gpu_index, const size_t num_bytes = 0);
+
+  std::vector<DeviceStats> GetStats() const;
+
+  // Print the utilization of all devices that were leased.
+  void PrintStats() const;
+
+ private:
+  NON_COPYABLE(GpuScheduler)
+
+  typedef std::chrono::steady_clock Clock;
+
+  struct Device {
+    size_t memory_size = 0;
+    DeviceStats stats;
+    Clock::time_point busy_start;
+  };
+
+  // Find the least occupied device that can grant the lease, or null.
+  Device* FindDevice(const std::vector<int>& gpu_indices,
+                     const size_t num_bytes);
+  Lease Grant(Device* device, const size_t num_bytes);
+  void Release(const int gpu_index, const size_t num_bytes);
+  void UpdateMetrics(const DeviceStats& stats) const;
+
+  Options options_;
+  bool export_metrics_;
+  mutable std::mutex mutex_;
+  std::condition_variable release_condition_;
+  std::map<int, Device> devices_;
+  bool has_leases_;
+  Clock::time_point first_lease_time_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_UTIL_GPU_SCHEDULER_H_
@@ -0,0 +1,133 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "util/gpu_scheduler"
+#include "util/testing.h"
+
+#include <atomic>
+#include <thread>
+
+#include "util/gpu_scheduler.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestGetGpuIndices) {
+  GpuScheduler scheduler({0, 1}, {100, 200});
+  BOOST_CHECK(scheduler.GetGpuIndices("-1") == std::vector<int>({0, 1}));
+  BOOST_CHECK(scheduler.GetGpuIndices("1") == std::vector<int>({1}));
+  BOOST_CHECK(scheduler.GetGpuIndices("1,0") == std::vector<int>({1, 0}));
+
+  GpuScheduler empty_scheduler({}, {});
+  BOOST_CHECK(empty_scheduler.GetGpuIndices("-1") == std::vector<int>({-1}));
+}
+
+BOOST_AUTO_TEST_CASE(TestLeastOccupied) {
+  GpuScheduler scheduler({0, 1}, {100, 100});
+  GpuScheduler::Lease lease1 = scheduler.Acquire("-1", 10);
+  GpuScheduler::Lease lease2 = scheduler.Acquire("-1", 10);
+  BOOST_CHECK(lease1.IsValid());
+  BOOST_CHECK(lease2.IsValid());
+  BOOST_CHECK_EQUAL(lease1.GpuIndex(), 0);
+  BOOST_CHECK_EQUAL(lease2.GpuIndex(), 1);
+  BOOST_CHECK_EQUAL(lease1.NumBytes(), 10);
+
+  lease1.Release();
+  BOOST_CHECK(!lease1.IsValid());
+  GpuScheduler::Lease lease3 = scheduler.Acquire("-1", 10);
+  BOOST_CHECK_EQUAL(lease3.GpuIndex(), 0);
+
+  GpuScheduler::Lease lease4 = std::move(lease3);
+  BOOST_CHECK(!lease3.IsValid());
+  BOOST_CHECK(lease4.IsValid());
+  BOOST_CHECK_EQUAL(lease4.GpuIndex(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestTryAcquire) {
+  GpuScheduler scheduler({0}, {100});
+  GpuScheduler::Options options;
+  options.memory_fraction = 0.5;
+  scheduler.SetOptions(options);
+
+  GpuScheduler::Lease lease1 = scheduler.TryAcquire("0", 40);
+  BOOST_CHECK(lease1.IsValid());
+  BOOST_CHECK(!scheduler.TryAcquire("0", 20).IsValid());
+  BOOST_CHECK(scheduler.TryAcquire("0", 10).IsValid());
+
+  // Requests exceeding the budget are granted on an idle device.
+  lease1.Release();
+  BOOST_CHECK(scheduler.TryAcquire("0", 200).IsValid());
+
+  options.memory_fraction = 1;
+  options.max_num_leases_per_device = 1;
+  scheduler.SetOptions(options);
+  GpuScheduler::Lease lease2 = scheduler.TryAcquire("0");
+  BOOST_CHECK(lease2.IsValid());
+  BOOST_CHECK(!scheduler.TryAcquire("0").IsValid());
+}
+
+BOOST_AUTO_TEST_CASE(TestAcquireQueued) {
+  GpuScheduler scheduler({0}, {100});
+  GpuScheduler::Lease lease1 = scheduler.Acquire("0", 80);
+
+  std::atomic<bool> acquired(false);
+  std::thread thread([&]() {
+    GpuScheduler::Lease lease2 = scheduler.Acquire("0", 80);
+    acquired = true;
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_CHECK(!acquired);
+  lease1.Release();
+  thread.join();
+  BOOST_CHECK(acquired);
+
+  const auto stats = scheduler.GetStats();
+  BOOST_CHECK_EQUAL(stats.size(), 1);
+  BOOST_CHECK_EQUAL(stats[0].gpu_index, 0);
+  BOOST_CHECK_EQUAL(stats[0].memory_budget, 90);
+  BOOST_CHECK_EQUAL(stats[0].num_leased_bytes, 0);
+  BOOST_CHECK_EQUAL(stats[0].max_num_leased_bytes, 80);
+  BOOST_CHECK_EQUAL(stats[0].num_active_leases, 0);
+  BOOST_CHECK_EQUAL(stats[0].num_leases, 2);
+  BOOST_CHECK_EQUAL(stats[0].num_queued_leases, 1);
+  BOOST_CHECK_GT(stats[0].busy_seconds, 0);
+  BOOST_CHECK_GT(stats[0].utilization, 0);
+  BOOST_CHECK_LE(stats[0].utilization, 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestUnknownDevices) {
+  GpuScheduler scheduler({}, {});
+  GpuScheduler::Lease lease1 = scheduler.Acquire("-1", 1000);
+  GpuScheduler::Lease lease2 = scheduler.Acquire("-1", 1000);
+  BOOST_CHECK_EQUAL(lease1.GpuIndex(), -1);
+  BOOST_CHECK_EQUAL(lease2.GpuIndex(), -1);
+  GpuScheduler::Lease lease3 = scheduler.Acquire("2");
+  BOOST_CHECK_EQUAL(lease3.GpuIndex(), 2);
+}
@@ -31,7 +31,58 @@
 
 #include "util/logging.h"
 
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+
 namespace colmap {
+namespace {
+
+// Redirects the standard output through an asynchronous buffer. The original
+// buffer is restored on destruction, such that no output is lost at exit.
+class AsyncStdoutRedirect {
+ public:
+  ~AsyncStdoutRedirect() { Disable(); }
+
+  void Enable() {
+    if (buffer_) {
+      return;
+    }
+    std::cout.flush();
+    stdout_buffer_ = std::cout.rdbuf();
+    buffer_.reset(new AsyncStreamBuffer(stdout_buffer_));
+    std::cout.rdbuf(buffer_.get());
+  }
+
+  void Disable() {
+    if (!buffer_) {
+      return;
+    }
+    std::cout.rdbuf(stdout_buffer_);
+    buffer_.reset();
+  }
+
+ private:
+  std::streambuf* stdout_buffer_ = nullptr;
+  std::unique_ptr<AsyncStreamBuffer> buffer_;
+};
+
+std::mutex log_mutex;
+std::unordered_map<std::string, int> stage_log_levels;
+std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+    stage_progress_times;
+AsyncStdoutRedirect async_stdout_redirect;
+
+bool IsStageLogLevelEnabledImpl(const std::string& stage, const int level) {
+  const auto it = stage_log_levels.find(stage);
+  return it == stage_log_levels.end() || level <= it->second;
+}
+
+}  // namespace
+
+bool kLogAsync = false;
+double kLogProgressInterval = 0.0;
+std::string kLogStageLevels = "";
 
 void InitializeGlog(char** argv) {
 #ifndef _MSC_VER  // Broken in MSVC
@@ -40,6 +91,150 @@ void InitializeGlog(char** argv) {
   google::InitGoogleLogging(argv[0]);
 }
 
+void InitializeLogging() {
+  {
+    std::unique_lock<std::mutex> lock(log_mutex);
+    stage_log_levels.clear();
+    stage_progress_times.clear();
+    for (auto entry : StringSplit(kLogStageLevels, ",")) {
+      StringTrim(&entry);
+      if (entry.empty()) {
+        continue;
+      }
+      auto stage_and_level = StringSplit(entry, ":");
+      CHECK_EQ(stage_and_level.size(), 2)
+          << "Invalid stage log level: " << entry;
+      StringTrim(&stage_and_level[0]);
+      StringTrim(&stage_and_level[1]);
+      stage_log_levels[stage_and_level[0]] = std::stoi(stage_and_level[1]);
+    }
+  }
+
+  if (kLogAsync) {
+    async_stdout_redirect.Enable();
+  }
+}
+
+void FinalizeLogging() { async_stdout_redirect.Disable(); }
+
+bool IsStageLogLevelEnabled(const std::string& stage, const int level) {
+  std::unique_lock<std::mutex> lock(log_mutex);
+  return IsStageLogLevelEnabledImpl(stage, level);
+}
+
+bool ShouldPrintProgress(const std::string& stage, const int level,
+                         const bool force) {
+  std::unique_lock<std::mutex> lock(log_mutex);
+
+  if (!IsStageLogLevelEnabledImpl(stage, level)) {
+    return false;
+  }
+
+  if (kLogProgressInterval <= 0) {
+    return true;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto it = stage_progress_times.find(stage);
+  if (!force && it != stage_progress_times.end() &&
+      std::chrono::duration<double>(now - it->second).count() <
+          kLogProgressInterval) {
+    return false;
+  }
+
+  stage_progress_times[stage] = now;
+
+  return true;
+}
+
+AsyncStreamBuffer::AsyncStreamBuffer(std::streambuf* sink,
+                                     const double flush_interval,
+                                     const size_t max_buffer_size)
+    : sink_(sink),
+      flush_interval_(flush_interval),
+      max_buffer_size_(max_buffer_size),
+      flush_requested_(false),
+      writing_(false),
+      stop_(false) {
+  CHECK_NOTNULL(sink_);
+  CHECK_GT(flush_interval_, 0);
+  CHECK_GT(max_buffer_size_, 0);
+  thread_ = std::thread(&AsyncStreamBuffer::Run, this);
+}
+
+AsyncStreamBuffer::~AsyncStreamBuffer() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  buffer_condition_.notify_one();
+  thread_.join();
+}
+
+void AsyncStreamBuffer::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (buffer_.empty() && !writing_) {
+    return;
+  }
+  flush_requested_ = true;
+  buffer_condition_.notify_one();
+  flush_condition_.wait(lock, [this] { return buffer_.empty() && !writing_; });
+}
+
+AsyncStreamBuffer::int_type AsyncStreamBuffer::overflow(int_type ch) {
+  if (traits_type::eq_int_type(ch, traits_type::eof())) {
+    return traits_type::not_eof(ch);
+  }
+  const char c = traits_type::to_char_type(ch);
+  xsputn(&c, 1);
+  return ch;
+}
+
+std::streamsize AsyncStreamBuffer::xsputn(const char* s,
+                                          std::streamsize count) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  buffer_.append(s, count);
+  if (buffer_.size() >= max_buffer_size_) {
+    buffer_condition_.notify_one();
+  }
+  return count;
+}
+
+int AsyncStreamBuffer::sync() { return 0; }
+
+void AsyncStreamBuffer::Run() {
+  const auto flush_interval = std::chrono::duration<double>(flush_interval_);
+  std::string output;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (!stop_ && !flush_requested_ && buffer_.size() < max_buffer_size_) {
+        buffer_condition_.wait_for(lock, flush_interval);
+      }
+      flush_requested_ = false;
+      if (buffer_.empty()) {
+        flush_condition_.notify_all();
+        if (stop_) {
+          break;
+        }
+        continue;
+      }
+      output.swap(buffer_);
+      writing_ = true;
+    }
+
+    sink_->sputn(output.data(), output.size());
+    sink_->pubsync();
+    output.clear();
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      writing_ = false;
+    }
+    flush_condition_.notify_all();
+  }
+}
+
 const char* __GetConstFileBaseName(const char* file) {
   const char* base = strrchr(file, '/');
   if (!base) {
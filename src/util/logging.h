@@ -32,7 +32,12 @@
 #ifndef COLMAP_SRC_UTIL_LOGGING_H_
 #define COLMAP_SRC_UTIL_LOGGING_H_
 
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
 
 #include <glog/logging.h>
 
@@ -60,9 +65,75 @@
 
 namespace colmap {
 
+// Whether the standard output is buffered in memory and written by a
+// background thread, such that printing progress lines from hot loops neither
+// blocks on the terminal nor flushes it on every `std::endl`.
+extern bool kLogAsync;
+
+// The minimum interval in seconds between two progress lines of the same
+// stage. Progress lines are not rate-limited if zero.
+extern double kLogProgressInterval;
+
+// The verbosity levels of individual stages as a comma-separated list of
+// `stage:level` entries, e.g. "feature_extraction:0,feature_matching:-1".
+// Stages that are not listed print all of their progress lines.
+extern std::string kLogStageLevels;
+
 // Initialize glog at the beginning of the program.
 void InitializeGlog(char** argv);
 
+// Parse the stage verbosity levels and redirect the standard output through
+// an asynchronous buffer, if `kLogAsync` is set.
+void InitializeLogging();
+
+// Write all buffered output and restore the synchronous standard output.
+void FinalizeLogging();
+
+// Whether lines of the given verbosity level are printed for the stage.
+bool IsStageLogLevelEnabled(const std::string& stage, const int level);
+
+// Whether the next progress line of the stage should be printed, i.e. its
+// level is enabled and the last printed progress line of the stage is at least
+// `kLogProgressInterval` seconds old. Forced lines, e.g. the final line of a
+// loop or an error, are not rate-limited.
+bool ShouldPrintProgress(const std::string& stage, const int level = 0,
+                         const bool force = false);
+
+// Stream buffer that collects the written characters in memory and writes
+// them to the sink buffer in a background thread, either periodically or once
+// the buffer exceeds its maximum size. Synchronizing the stream, e.g. through
+// `std::endl`, does not block. The buffer is safe to be written concurrently.
+class AsyncStreamBuffer : public std::streambuf {
+ public:
+  AsyncStreamBuffer(std::streambuf* sink, const double flush_interval = 0.1,
+                    const size_t max_buffer_size = 1 << 20);
+  ~AsyncStreamBuffer();
+
+  // Block until all buffered characters are written to the sink.
+  void Flush();
+
+ protected:
+  int_type overflow(int_type ch) override;
+  std::streamsize xsputn(const char* s, std::streamsize count) override;
+  int sync() override;
+
+ private:
+  void Run();
+
+  std::streambuf* sink_;
+  const double flush_interval_;
+  const size_t max_buffer_size_;
+
+  std::mutex mutex_;
+  std::condition_variable buffer_condition_;
+  std::condition_variable flush_condition_;
+  std::string buffer_;
+  bool flush_requested_;
+  bool writing_;
+  bool stop_;
+  std::thread thread_;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,112 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "util/logging"
+#include "util/testing.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "util/logging.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestAsyncStreamBuffer) {
+  std::stringbuf sink;
+  {
+    AsyncStreamBuffer buffer(&sink);
+    std::ostream stream(&buffer);
+    stream << "Hello" << std::endl;
+    stream << 42 << std::flush;
+    buffer.Flush();
+    BOOST_CHECK_EQUAL(sink.str(), "Hello\n42");
+    stream << "World";
+  }
+  BOOST_CHECK_EQUAL(sink.str(), "Hello\n42World");
+}
+
+BOOST_AUTO_TEST_CASE(TestAsyncStreamBufferMaxSize) {
+  std::stringbuf sink;
+  AsyncStreamBuffer buffer(&sink, 1000.0, 4);
+  std::ostream stream(&buffer);
+  stream << "abcdefgh";
+  buffer.Flush();
+  BOOST_CHECK_EQUAL(sink.str(), "abcdefgh");
+}
+
+BOOST_AUTO_TEST_CASE(TestAsyncStreamBufferConcurrent) {
+  std::stringbuf sink;
+  {
+    AsyncStreamBuffer buffer(&sink);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&buffer]() {
+        for (int j = 0; j < 100; ++j) {
+          buffer.sputn("line\n", 5);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  BOOST_CHECK_EQUAL(sink.str().size(), 4 * 100 * 5);
+}
+
+BOOST_AUTO_TEST_CASE(TestStageLogLevels) {
+  kLogStageLevels = "stage1:0, stage2 : -1";
+  InitializeLogging();
+  BOOST_CHECK(IsStageLogLevelEnabled("stage1", 0));
+  BOOST_CHECK(!IsStageLogLevelEnabled("stage1", 1));
+  BOOST_CHECK(!IsStageLogLevelEnabled("stage2", 0));
+  BOOST_CHECK(IsStageLogLevelEnabled("stage3", 0));
+  BOOST_CHECK(IsStageLogLevelEnabled("stage3", 10));
+  BOOST_CHECK(ShouldPrintProgress("stage1"));
+  BOOST_CHECK(!ShouldPrintProgress("stage1", 1));
+  BOOST_CHECK(!ShouldPrintProgress("stage2", 0, true));
+  kLogStageLevels = "";
+  InitializeLogging();
+  BOOST_CHECK(IsStageLogLevelEnabled("stage1", 1));
+  BOOST_CHECK(IsStageLogLevelEnabled("stage2", 0));
+}
+
+BOOST_AUTO_TEST_CASE(TestShouldPrintProgressRateLimit) {
+  kLogProgressInterval = 1000.0;
+  InitializeLogging();
+  BOOST_CHECK(ShouldPrintProgress("stage1"));
+  BOOST_CHECK(!ShouldPrintProgress("stage1"));
+  BOOST_CHECK(ShouldPrintProgress("stage1", 0, true));
+  BOOST_CHECK(ShouldPrintProgress("stage2"));
+  BOOST_CHECK(!ShouldPrintProgress("stage2"));
+  kLogProgressInterval = 0.0;
+  BOOST_CHECK(ShouldPrintProgress("stage1"));
+  BOOST_CHECK(ShouldPrintProgress("stage1"));
+}
@@ -35,6 +35,8 @@
 #include <algorithm>
 #include <cmath>
 #include <complex>
+#include <cstdint>
+#include <cstring>
 #include <limits>
 #include <list>
 #include <stdexcept>
@@ -131,6 +133,12 @@ T2 TruncateCast(const T1 value);
 template <typename T>
 T Percentile(const std::vector<T>& elems, const double p);
 
+// Convert a single precision value to the IEEE 754 half precision format and
+// back. Values are rounded to the nearest half precision value and values
+// beyond the half precision range of +/-65504 are converted to infinity.
+inline uint16_t FloatToHalf(const float value);
+inline float HalfToFloat(const uint16_t value);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
@@ -316,6 +324,70 @@ T2 TruncateCast(const T1 value) {
       std::max(static_cast<T1>(std::numeric_limits<T2>::min()), value));
 }
 
+uint16_t FloatToHalf(const float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+  const int float_exponent = static_cast<int>((bits >> 23) & 0xff);
+  uint32_t mantissa = bits & 0x7fffff;
+
+  // Infinity and NaN.
+  if (float_exponent == 0xff) {
+    return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+  }
+
+  const int exponent = float_exponent - 127 + 15;
+
+  // Overflow to infinity.
+  if (exponent >= 0x1f) {
+    return sign | 0x7c00;
+  }
+
+  // Subnormal half precision values or underflow to zero.
+  if (exponent <= 0) {
+    if (exponent < -10) {
+      return sign;
+    }
+    mantissa |= 0x800000;
+    const int shift = 14 - exponent;
+    uint32_t half_mantissa = mantissa >> shift;
+    if ((mantissa >> (shift - 1)) & 1) {
+      half_mantissa += 1;
+    }
+    return sign | static_cast<uint16_t>(half_mantissa);
+  }
+
+  // Note that rounding up correctly carries over into the exponent.
+  uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+  if (mantissa & 0x1000) {
+    half += 1;
+  }
+  return sign | static_cast<uint16_t>(half);
+}
+
+float HalfToFloat(const uint16_t value) {
+  const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+  const uint32_t exponent = (value >> 10) & 0x1f;
+  const uint32_t mantissa = value & 0x3ff;
+
+  uint32_t bits;
+  if (exponent == 0) {
+    // Zero and subnormal values.
+    const float abs_value = std::ldexp(static_cast<float>(mantissa), -24);
+    return sign ? -abs_value : abs_value;
+  } else if (exponent == 0x1f) {
+    // Infinity and NaN.
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+  }
+
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
 }  // namespace colmap
 
 #endif  // COLMAP_SRC_UTIL_MATH_H_
@@ -223,3 +223,32 @@ BOOST_AUTO_TEST_CASE(TestTruncateCast) {
   BOOST_CHECK_EQUAL((TruncateCast<int, uint16_t>(-1)), 0);
   BOOST_CHECK_EQUAL((TruncateCast<int, uint16_t>(65536)), 65535);
 }
+
+BOOST_AUTO_TEST_CASE(TestHalfConversion) {
+  BOOST_CHECK_EQUAL(FloatToHalf(0.0f), 0x0000);
+  BOOST_CHECK_EQUAL(FloatToHalf(-0.0f), 0x8000);
+  BOOST_CHECK_EQUAL(FloatToHalf(1.0f), 0x3c00);
+  BOOST_CHECK_EQUAL(FloatToHalf(-2.0f), 0xc000);
+  BOOST_CHECK_EQUAL(FloatToHalf(65504.0f), 0x7bff);
+  BOOST_CHECK_EQUAL(FloatToHalf(1e6f), 0x7c00);
+  BOOST_CHECK_EQUAL(FloatToHalf(std::numeric_limits<float>::infinity()),
+                    0x7c00);
+  BOOST_CHECK_EQUAL(FloatToHalf(std::pow(2.0f, -24.0f)), 0x0001);
+  BOOST_CHECK_EQUAL(FloatToHalf(std::pow(2.0f, -26.0f)), 0x0000);
+  BOOST_CHECK(IsNaN(HalfToFloat(FloatToHalf(
+      std::numeric_limits<float>::quiet_NaN()))));
+  BOOST_CHECK(IsInf(HalfToFloat(0xfc00)));
+  BOOST_CHECK_LT(HalfToFloat(0xfc00), 0.0f);
+  BOOST_CHECK_EQUAL(HalfToFloat(0x0001), std::pow(2.0f, -24.0f));
+  BOOST_CHECK_EQUAL(HalfToFloat(0x3c00), 1.0f);
+  BOOST_CHECK_EQUAL(HalfToFloat(0x7bff), 65504.0f);
+
+  for (float value = -1000.0f; value < 1000.0f; value += 0.37f) {
+    BOOST_CHECK_LE(std::abs(HalfToFloat(FloatToHalf(value)) - value),
+                   std::abs(value) / 2048.0f);
+  }
+
+  for (uint32_t half = 0; half < 0x7c00; ++half) {
+    BOOST_CHECK_EQUAL(FloatToHalf(HalfToFloat(half)), half);
+  }
+}
@@ -0,0 +1,274 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "util/memory_accountant.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "util/logging.h"
+#include "util/misc.h"
+
+namespace colmap {
+namespace {
+
+// The components are requested to shrink, once the total usage exceeds the
+// high watermark of the budget, until the usage drops to the low watermark,
+// so that the components do not shrink on every update close to the budget.
+const double kMemoryBudgetHighWatermark = 0.9;
+const double kMemoryBudgetLowWatermark = 0.8;
+
+double BytesToMegaBytes(const size_t num_bytes) {
+  return num_bytes / (1024.0 * 1024.0);
+}
+
+}  // namespace
+
+double kMemoryBudget = 0.0;
+
+MemoryAccountant& MemoryAccountant::Get() {
+  static MemoryAccountant accountant;
+  return accountant;
+}
+
+MemoryAccountant::MemoryAccountant()
+    : budget_(0),
+      next_id_(0),
+      num_bytes_(0),
+      peak_num_bytes_(0),
+      budget_exceeded_(false) {}
+
+void MemoryAccountant::SetBudget(const size_t num_bytes) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  budget_ = num_bytes;
+  budget_exceeded_ = false;
+}
+
+size_t MemoryAccountant::Budget() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return budget_;
+}
+
+size_t MemoryAccountant::NumBytes() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return num_bytes_;
+}
+
+size_t MemoryAccountant::PeakNumBytes() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return peak_num_bytes_;
+}
+
+std::vector<MemoryAccountant::ComponentSummary> MemoryAccountant::Summary()
+    const {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  std::map<std::string, ComponentSummary> summaries;
+  for (const auto& peak_num_bytes : peak_num_bytes_by_name_) {
+    auto& summary = summaries[peak_num_bytes.first];
+    summary.name = peak_num_bytes.first;
+    summary.peak_num_bytes = peak_num_bytes.second;
+  }
+  for (const auto& component : components_) {
+    summaries[component.second.name].num_bytes += component.second.num_bytes;
+  }
+
+  std::vector<ComponentSummary> sorted_summaries;
+  sorted_summaries.reserve(summaries.size());
+  for (const auto& summary : summaries) {
+    sorted_summaries.push_back(summary.second);
+  }
+  std::stable_sort(
+      sorted_summaries.begin(), sorted_summaries.end(),
+      [](const ComponentSummary& summary1, const ComponentSummary& summary2) {
+        return summary1.peak_num_bytes > summary2.peak_num_bytes;
+      });
+
+  return sorted_summaries;
+}
+
+void MemoryAccountant::PrintSummary() const {
+  PrintHeading2("Memory usage");
+  for (const auto& summary : Summary()) {
+    std::cout << StringPrintf("  %s: %.1fMB (peak %.1fMB)",
+                              summary.name.c_str(),
+                              BytesToMegaBytes(summary.num_bytes),
+                              BytesToMegaBytes(summary.peak_num_bytes))
+              << std::endl;
+  }
+  std::cout << StringPrintf("  Total: %.1fMB (peak %.1fMB",
+                            BytesToMegaBytes(NumBytes()),
+                            BytesToMegaBytes(PeakNumBytes()));
+  const size_t budget = Budget();
+  if (budget > 0) {
+    std::cout << StringPrintf(", budget %.1fMB", BytesToMegaBytes(budget));
+  }
+  std::cout << ")" << std::endl;
+}
+
+void MemoryAccountant::ResetPeaks() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  peak_num_bytes_ = num_bytes_;
+  peak_num_bytes_by_name_.clear();
+  for (const auto& component : components_) {
+    peak_num_bytes_by_name_[component.second.name] +=
+        component.second.num_bytes;
+  }
+}
+
+size_t MemoryAccountant::Register(const std::string& name,
+                                  const bool shrinkable) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const size_t id = next_id_++;
+  Component& component = components_[id];
+  component.name = name;
+  component.shrinkable = shrinkable;
+  peak_num_bytes_by_name_.emplace(name, 0);
+  return id;
+}
+
+void MemoryAccountant::Unregister(const size_t id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto it = components_.find(id);
+  CHECK(it != components_.end());
+  num_bytes_ -= it->second.num_bytes;
+  components_.erase(it);
+}
+
+size_t MemoryAccountant::Update(const size_t id, const size_t num_bytes) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  Component& component = components_.at(id);
+  num_bytes_ = num_bytes_ - component.num_bytes + num_bytes;
+  component.num_bytes = num_bytes;
+
+  peak_num_bytes_ = std::max(peak_num_bytes_, num_bytes_);
+  size_t name_num_bytes = 0;
+  for (const auto& other_component : components_) {
+    if (other_component.second.name == component.name) {
+      name_num_bytes += other_component.second.num_bytes;
+    }
+  }
+  size_t& peak_name_num_bytes = peak_num_bytes_by_name_[component.name];
+  peak_name_num_bytes = std::max(peak_name_num_bytes, name_num_bytes);
+
+  if (budget_ > 0) {
+    if (num_bytes_ > kMemoryBudgetHighWatermark * budget_) {
+      RequestShrink();
+    }
+    if (num_bytes_ > budget_ && !budget_exceeded_) {
+      LOG(WARNING) << StringPrintf(
+          "Memory budget of %.1fMB exceeded with %.1fMB by the accounted "
+          "components",
+          BytesToMegaBytes(budget_), BytesToMegaBytes(num_bytes_));
+    }
+    budget_exceeded_ = num_bytes_ > budget_;
+  }
+
+  const size_t num_shrink_bytes = component.num_shrink_bytes;
+  component.num_shrink_bytes = 0;
+  return num_shrink_bytes;
+}
+
+void MemoryAccountant::RequestShrink() {
+  const size_t target_num_bytes =
+      static_cast<size_t>(kMemoryBudgetLowWatermark * budget_);
+  if (num_bytes_ <= target_num_bytes) {
+    return;
+  }
+
+  // Requests to components, which have not updated since, are still pending.
+  size_t num_excess_bytes = num_bytes_ - target_num_bytes;
+  std::vector<Component*> shrinkable_components;
+  for (auto& component : components_) {
+    if (!component.second.shrinkable) {
+      continue;
+    }
+    const size_t num_pending_bytes = std::min(
+        num_excess_bytes, component.second.num_shrink_bytes);
+    num_excess_bytes -= num_pending_bytes;
+    shrinkable_components.push_back(&component.second);
+  }
+
+  std::sort(shrinkable_components.begin(), shrinkable_components.end(),
+            [](const Component* component1, const Component* component2) {
+              return component1->num_bytes > component2->num_bytes;
+            });
+
+  for (Component* component : shrinkable_components) {
+    if (num_excess_bytes == 0) {
+      break;
+    }
+    const size_t num_available_bytes =
+        component->num_bytes - std::min(component->num_bytes,
+                                        component->num_shrink_bytes);
+    const size_t num_shrink_bytes =
+        std::min(num_excess_bytes, num_available_bytes);
+    component->num_shrink_bytes += num_shrink_bytes;
+    num_excess_bytes -= num_shrink_bytes;
+  }
+}
+
+ScopedMemoryComponent::ScopedMemoryComponent(
+    const std::string& name, const std::function<size_t()>& usage_func,
+    const std::function<void(size_t)>& shrink_func)
+    : usage_func_(usage_func),
+      shrink_func_(shrink_func),
+      id_(MemoryAccountant::Get().Register(name,
+                                           static_cast<bool>(shrink_func))) {
+  CHECK(usage_func_);
+}
+
+ScopedMemoryComponent::~ScopedMemoryComponent() {
+  MemoryAccountant::Get().Unregister(id_);
+}
+
+void ScopedMemoryComponent::Update() {
+  MemoryAccountant& accountant = MemoryAccountant::Get();
+  const size_t num_shrink_bytes = accountant.Update(id_, usage_func_());
+  if (num_shrink_bytes > 0 && shrink_func_) {
+    shrink_func_(num_shrink_bytes);
+    accountant.Update(id_, usage_func_());
+  }
+}
+
+void InitializeMemoryAccounting() {
+  CHECK_GE(kMemoryBudget, 0);
+  MemoryAccountant::Get().SetBudget(
+      static_cast<size_t>(1024.0 * 1024.0 * 1024.0 * kMemoryBudget));
+}
+
+void FinalizeMemoryAccounting() {
+  if (kMemoryBudget > 0) {
+    MemoryAccountant::Get().PrintSummary();
+  }
+}
+
+}  // namespace colmap
@@ -0,0 +1,149 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_UTIL_MEMORY_ACCOUNTANT_H_
+#define COLMAP_SRC_UTIL_MEMORY_ACCOUNTANT_H_
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "util/types.h"
+
+namespace colmap {
+
+// The total memory budget of the accounted components in gigabytes. The
+// budget is unlimited if zero.
+extern double kMemoryBudget;
+
+// Process-wide accounting of the memory usage of memory-hungry components,
+// such as the feature and image caches, which enforces a total memory budget.
+// Each component reports its usage through a `ScopedMemoryComponent` from its
+// own thread. Once the total usage approaches the budget, the shrinkable
+// components are requested to release memory in order of decreasing usage,
+// which they do cooperatively on their next update. The peak usage of the
+// components is recorded for the summary at the end of the program.
+class MemoryAccountant {
+ public:
+  struct ComponentSummary {
+    std::string name;
+    size_t num_bytes = 0;
+    size_t peak_num_bytes = 0;
+  };
+
+  // Access the process-wide accountant.
+  static MemoryAccountant& Get();
+
+  // Set the memory budget in bytes, which is unlimited if zero.
+  void SetBudget(const size_t num_bytes);
+  size_t Budget() const;
+
+  // The current and peak total usage of all components.
+  size_t NumBytes() const;
+  size_t PeakNumBytes() const;
+
+  // The current and peak usage of the components, where the usage of the
+  // components with the same name is summed, sorted by decreasing peak usage.
+  std::vector<ComponentSummary> Summary() const;
+  void PrintSummary() const;
+
+  // Clear the recorded peak usage.
+  void ResetPeaks();
+
+ private:
+  friend class ScopedMemoryComponent;
+
+  MemoryAccountant();
+
+  struct Component {
+    std::string name;
+    bool shrinkable = false;
+    size_t num_bytes = 0;
+    // The number of bytes the component is requested to release.
+    size_t num_shrink_bytes = 0;
+  };
+
+  size_t Register(const std::string& name, const bool shrinkable);
+  void Unregister(const size_t id);
+
+  // Update the usage of a component and return the number of bytes, which the
+  // component is requested to release.
+  size_t Update(const size_t id, const size_t num_bytes);
+
+  // Distribute the release of memory over the shrinkable components, such
+  // that the total usage drops well below the budget. The lock must be held.
+  void RequestShrink();
+
+  mutable std::mutex mutex_;
+  size_t budget_;
+  size_t next_id_;
+  size_t num_bytes_;
+  size_t peak_num_bytes_;
+  bool budget_exceeded_;
+  std::map<size_t, Component> components_;
+  std::map<std::string, size_t> peak_num_bytes_by_name_;
+};
+
+// Registers a component with the process-wide memory accountant for its own
+// lifetime. The usage function returns the current memory usage of the
+// component in bytes and the optional shrink function releases approximately
+// the given number of bytes, e.g., by evicting cached elements. Both functions
+// are only called by `Update`. Declare it after the members, which are
+// measured, so that the component is unregistered before they are destructed.
+class ScopedMemoryComponent {
+ public:
+  ScopedMemoryComponent(
+      const std::string& name, const std::function<size_t()>& usage_func,
+      const std::function<void(size_t)>& shrink_func = nullptr);
+  ~ScopedMemoryComponent();
+
+  // Report the current usage of the component and release memory, if the
+  // accountant requested it. Should be called whenever the usage grew.
+  void Update();
+
+ private:
+  NON_COPYABLE(ScopedMemoryComponent)
+
+  const std::function<size_t()> usage_func_;
+  const std::function<void(size_t)> shrink_func_;
+  const size_t id_;
+};
+
+// Set the budget of the process-wide accountant from `kMemoryBudget`.
+void InitializeMemoryAccounting();
+
+// Print the peak memory usage of the components, if a budget is set.
+void FinalizeMemoryAccounting();
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_UTIL_MEMORY_ACCOUNTANT_H_
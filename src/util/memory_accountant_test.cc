@@ -0,0 +1,136 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "util/memory_accountant"
+#include "util/testing.h"
+
+#include "util/memory_accountant.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestAccounting) {
+  MemoryAccountant& accountant = MemoryAccountant::Get();
+  accountant.SetBudget(0);
+  accountant.ResetPeaks();
+  BOOST_CHECK_EQUAL(accountant.NumBytes(), 0);
+
+  size_t num_bytes1 = 10;
+  size_t num_bytes2 = 20;
+  {
+    ScopedMemoryComponent component1("component1",
+                                     [&]() { return num_bytes1; });
+    ScopedMemoryComponent component2("component2",
+                                     [&]() { return num_bytes2; });
+    ScopedMemoryComponent component3("component2",
+                                     [&]() { return num_bytes2; });
+    component1.Update();
+    component2.Update();
+    component3.Update();
+    BOOST_CHECK_EQUAL(accountant.NumBytes(), 50);
+    BOOST_CHECK_EQUAL(accountant.PeakNumBytes(), 50);
+
+    num_bytes1 = 5;
+    component1.Update();
+    BOOST_CHECK_EQUAL(accountant.NumBytes(), 45);
+    BOOST_CHECK_EQUAL(accountant.PeakNumBytes(), 50);
+
+    const auto summary = accountant.Summary();
+    BOOST_CHECK_EQUAL(summary.size(), 2);
+    BOOST_CHECK_EQUAL(summary[0].name, "component2");
+    BOOST_CHECK_EQUAL(summary[0].num_bytes, 40);
+    BOOST_CHECK_EQUAL(summary[0].peak_num_bytes, 40);
+    BOOST_CHECK_EQUAL(summary[1].name, "component1");
+    BOOST_CHECK_EQUAL(summary[1].num_bytes, 5);
+    BOOST_CHECK_EQUAL(summary[1].peak_num_bytes, 10);
+  }
+
+  BOOST_CHECK_EQUAL(accountant.NumBytes(), 0);
+  BOOST_CHECK_EQUAL(accountant.PeakNumBytes(), 50);
+  const auto summary = accountant.Summary();
+  BOOST_CHECK_EQUAL(summary.size(), 2);
+  BOOST_CHECK_EQUAL(summary[0].num_bytes, 0);
+  BOOST_CHECK_EQUAL(summary[0].peak_num_bytes, 40);
+
+  accountant.ResetPeaks();
+  BOOST_CHECK_EQUAL(accountant.PeakNumBytes(), 0);
+  BOOST_CHECK(accountant.Summary().empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestBudget) {
+  MemoryAccountant& accountant = MemoryAccountant::Get();
+  accountant.SetBudget(100);
+
+  size_t num_bytes1 = 50;
+  size_t num_bytes2 = 10;
+  size_t num_bytes3 = 30;
+  size_t num_requested_bytes1 = 0;
+  size_t num_requested_bytes2 = 0;
+  ScopedMemoryComponent component1("component1", [&]() { return num_bytes1; },
+                                   [&](const size_t num_bytes) {
+                                     num_requested_bytes1 += num_bytes;
+                                     num_bytes1 -= num_bytes;
+                                   });
+  ScopedMemoryComponent component2("component2", [&]() { return num_bytes2; },
+                                   [&](const size_t num_bytes) {
+                                     num_requested_bytes2 += num_bytes;
+                                     num_bytes2 -= num_bytes;
+                                   });
+  ScopedMemoryComponent component3("component3", [&]() { return num_bytes3; });
+
+  component1.Update();
+  component2.Update();
+  component3.Update();
+  BOOST_CHECK_EQUAL(accountant.NumBytes(), 90);
+  BOOST_CHECK_EQUAL(num_requested_bytes1, 0);
+  BOOST_CHECK_EQUAL(num_requested_bytes2, 0);
+
+  // Exceeding the high watermark requests the largest shrinkable component to
+  // release memory down to the low watermark on its next update.
+  num_bytes3 = 35;
+  component3.Update();
+  BOOST_CHECK_EQUAL(accountant.NumBytes(), 95);
+  component2.Update();
+  BOOST_CHECK_EQUAL(num_requested_bytes2, 0);
+  component1.Update();
+  BOOST_CHECK_EQUAL(num_requested_bytes1, 15);
+  BOOST_CHECK_EQUAL(num_bytes1, 35);
+  BOOST_CHECK_EQUAL(accountant.NumBytes(), 80);
+
+  // Non-shrinkable components only shrink the shrinkable components.
+  num_bytes3 = 100;
+  component3.Update();
+  component1.Update();
+  component2.Update();
+  BOOST_CHECK_EQUAL(num_bytes1, 0);
+  BOOST_CHECK_EQUAL(num_bytes2, 0);
+  BOOST_CHECK_EQUAL(accountant.NumBytes(), 100);
+
+  accountant.SetBudget(0);
+}
@@ -0,0 +1,280 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "util/metrics.h"
+
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+#include "util/logging.h"
+#include "util/misc.h"
+#include "util/profiling.h"
+
+namespace colmap {
+namespace {
+
+// Replace all characters that are not valid in Prometheus metric names.
+std::string SanitizeMetricName(const std::string& name) {
+  std::string sanitized = name;
+  for (char& c : sanitized) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+      c = '_';
+    }
+  }
+  return sanitized;
+}
+
+// The name of a metric without its labels.
+std::string GetMetricFamily(const std::string& name) {
+  return name.substr(0, name.find('{'));
+}
+
+bool IsWouldBlockError(const boost::system::error_code& error) {
+  return error == boost::asio::error::would_block ||
+         error == boost::asio::error::try_again;
+}
+
+void HandleMetricsRequest(boost::asio::ip::tcp::socket* socket) {
+  // Read the request header from the non-blocking socket with a timeout,
+  // such that stalled clients cannot block the server.
+  const int kMaxNumReadPolls = 100;
+  const std::chrono::milliseconds kReadPollInterval(10);
+  boost::system::error_code error;
+  std::string request;
+  for (int i = 0; i < kMaxNumReadPolls &&
+                  request.find("\r\n\r\n") == std::string::npos;
+       ++i) {
+    char buffer[1024];
+    const size_t num_bytes =
+        socket->read_some(boost::asio::buffer(buffer), error);
+    if (IsWouldBlockError(error)) {
+      std::this_thread::sleep_for(kReadPollInterval);
+    } else if (error) {
+      return;
+    } else {
+      request.append(buffer, num_bytes);
+    }
+  }
+
+  if (request.find("\r\n\r\n") == std::string::npos) {
+    return;
+  }
+
+  std::istringstream request_stream(request);
+  std::string method;
+  std::string target;
+  request_stream >> method >> target;
+
+  std::string status;
+  std::string content_type;
+  std::string body;
+  if (method == "GET" && (target == "/metrics" || target == "/")) {
+    status = "200 OK";
+    content_type = "text/plain; version=0.0.4";
+    body = MetricsRegistry::Get().Export();
+  } else {
+    status = "404 Not Found";
+    content_type = "text/plain";
+    body = "Not found\n";
+  }
+
+  const std::string response =
+      StringPrintf(
+          "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %d\r\n"
+          "Connection: close\r\n\r\n",
+          status.c_str(), content_type.c_str(),
+          static_cast<int>(body.size())) +
+      body;
+  socket->non_blocking(false, error);
+  boost::asio::write(*socket, boost::asio::buffer(response), error);
+  socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, error);
+}
+
+std::unique_ptr<MetricsServer> metrics_server;
+
+}  // namespace
+
+int kMetricsPort = 0;
+
+MetricsRegistry& MetricsRegistry::Get() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+MetricsRegistry::MetricsRegistry() : next_gauge_id_(0) {}
+
+void MetricsRegistry::SetGauge(const std::string& name, const double value) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  gauges_[name] = value;
+}
+
+size_t MetricsRegistry::RegisterGauge(const std::string& name,
+                                      const std::function<double()>& func) {
+  CHECK(func);
+  std::unique_lock<std::mutex> lock(mutex_);
+  const size_t id = next_gauge_id_++;
+  gauge_funcs_[id] = {name, func};
+  return id;
+}
+
+void MetricsRegistry::UnregisterGauge(const size_t id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  CHECK_EQ(gauge_funcs_.erase(id), 1);
+}
+
+std::string MetricsRegistry::Export() const {
+  // Group the metrics by their family, since the type must be declared once
+  // for all metrics of the same family.
+  std::map<std::string, std::map<std::string, double>> gauges;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (const auto& gauge : gauges_) {
+      gauges[GetMetricFamily(gauge.first)][gauge.first] += gauge.second;
+    }
+    for (const auto& gauge_func : gauge_funcs_) {
+      const std::string& name = gauge_func.second.name;
+      gauges[GetMetricFamily(name)][name] += gauge_func.second.func();
+    }
+  }
+
+  const auto counts = Profiler::Get().Counts();
+  const std::map<std::string, int64_t> sorted_counts(counts.begin(),
+                                                     counts.end());
+
+  std::string text;
+  for (const auto& count : sorted_counts) {
+    const std::string name =
+        "colmap_" + SanitizeMetricName(count.first) + "_total";
+    text += StringPrintf("# TYPE %s counter\n", name.c_str());
+    text += StringPrintf("%s %lld\n", name.c_str(),
+                         static_cast<long long>(count.second));
+  }
+
+  for (const auto& family : gauges) {
+    text += StringPrintf("# TYPE colmap_%s gauge\n", family.first.c_str());
+    for (const auto& gauge : family.second) {
+      text += StringPrintf("colmap_%s %.17g\n", gauge.first.c_str(),
+                           gauge.second);
+    }
+  }
+
+  return text;
+}
+
+ScopedMetricsGauges::~ScopedMetricsGauges() {
+  for (const size_t id : ids_) {
+    MetricsRegistry::Get().UnregisterGauge(id);
+  }
+}
+
+void ScopedMetricsGauges::Add(const std::string& name,
+                              const std::function<double()>& func) {
+  ids_.push_back(MetricsRegistry::Get().RegisterGauge(name, func));
+}
+
+MetricsServer::MetricsServer(const int port) : port_(port) {
+  CHECK_GE(port, 0);
+}
+
+int MetricsServer::Port() const { return port_; }
+
+void MetricsServer::Run() {
+  using boost::asio::ip::tcp;
+
+  boost::asio::io_service io_service;
+  std::unique_ptr<tcp::acceptor> acceptor;
+  try {
+    acceptor.reset(
+        new tcp::acceptor(io_service, tcp::endpoint(tcp::v4(), port_)));
+    acceptor->non_blocking(true);
+  } catch (const boost::system::system_error& error) {
+    std::cerr << StringPrintf("ERROR: Failed to start metrics server on port "
+                              "%d - %s.",
+                              port_.load(), error.what())
+              << std::endl;
+    SignalInvalidSetup();
+    return;
+  }
+
+  port_ = acceptor->local_endpoint().port();
+
+  Profiler::Get().EnableCounters();
+
+  SignalValidSetup();
+
+  // Poll for connections, such that the server can be stopped.
+  const std::chrono::milliseconds kPollInterval(100);
+  while (!IsStopped()) {
+    tcp::socket socket(io_service);
+    boost::system::error_code error;
+    acceptor->accept(socket, error);
+    if (IsWouldBlockError(error)) {
+      std::this_thread::sleep_for(kPollInterval);
+      continue;
+    } else if (error) {
+      continue;
+    }
+
+    socket.non_blocking(true, error);
+    HandleMetricsRequest(&socket);
+  }
+}
+
+void StartMetricsServer() {
+  if (kMetricsPort <= 0 || metrics_server) {
+    return;
+  }
+
+  metrics_server.reset(new MetricsServer(kMetricsPort));
+  metrics_server->Start();
+  if (metrics_server->CheckValidSetup()) {
+    std::cout << StringPrintf("Serving metrics on port %d",
+                              metrics_server->Port())
+              << std::endl;
+  } else {
+    metrics_server->Wait();
+    metrics_server.reset();
+  }
+}
+
+void StopMetricsServer() {
+  if (metrics_server) {
+    metrics_server->Stop();
+    metrics_server->Wait();
+    metrics_server.reset();
+  }
+}
+
+}  // namespace colmap
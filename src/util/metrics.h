@@ -0,0 +1,129 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_UTIL_METRICS_H_
+#define COLMAP_SRC_UTIL_METRICS_H_
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "util/threading.h"
+#include "util/types.h"
+
+namespace colmap {
+
+// Port of the metrics server started by the executable. The server is only
+// started if the port is positive.
+extern int kMetricsPort;
+
+// Process-wide registry of gauges, which are exported together with the
+// counters of the profiler in the Prometheus text format. Gauge names can
+// contain Prometheus labels, e.g. `job_queue_size{queue="matcher"}`, and are
+// prefixed with `colmap_` on export. Multiple gauges with the same name are
+// summed, e.g., the cache sizes of multiple workspaces.
+class MetricsRegistry {
+ public:
+  // Access the process-wide registry.
+  static MetricsRegistry& Get();
+
+  // Set the value of a gauge, which is typically updated by the thread that
+  // owns the measured quantity.
+  void SetGauge(const std::string& name, const double value);
+
+  // Register a function, which is evaluated whenever the metrics are exported,
+  // and return its identifier. The function must be thread-safe.
+  size_t RegisterGauge(const std::string& name,
+                       const std::function<double()>& func);
+  void UnregisterGauge(const size_t id);
+
+  // Export the gauges and the profiler counters in the Prometheus text format.
+  std::string Export() const;
+
+ private:
+  MetricsRegistry();
+
+  struct GaugeFunc {
+    std::string name;
+    std::function<double()> func;
+  };
+
+  mutable std::mutex mutex_;
+  size_t next_gauge_id_;
+  std::map<std::string, double> gauges_;
+  std::map<size_t, GaugeFunc> gauge_funcs_;
+};
+
+// Registers gauge functions for its own lifetime. Declare it after the
+// members, which are measured by the gauges, so that the gauges are
+// unregistered before the measured members are destructed.
+class ScopedMetricsGauges {
+ public:
+  ScopedMetricsGauges() = default;
+  ~ScopedMetricsGauges();
+
+  void Add(const std::string& name, const std::function<double()>& func);
+
+ private:
+  NON_COPYABLE(ScopedMetricsGauges)
+
+  std::vector<size_t> ids_;
+};
+
+// Minimal HTTP server, which responds to requests of `/metrics` with the
+// exported metrics of the process-wide registry to be scraped by Prometheus.
+// Counting of the profiler is enabled while the server is running. If the
+// given port is zero, an arbitrary free port is chosen.
+class MetricsServer : public Thread {
+ public:
+  explicit MetricsServer(const int port);
+
+  // The port, on which the server is listening after a valid setup.
+  int Port() const;
+
+ private:
+  void Run() override;
+
+  std::atomic<int> port_;
+};
+
+// Start the process-wide metrics server, if `kMetricsPort` is set.
+void StartMetricsServer();
+
+// Stop the process-wide metrics server, if it is running.
+void StopMetricsServer();
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_UTIL_METRICS_H_
@@ -0,0 +1,104 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "util/metrics"
+#include "util/testing.h"
+
+#include <boost/asio.hpp>
+
+#include "util/metrics.h"
+#include "util/profiling.h"
+#include "util/string.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestExport) {
+  Profiler::Get().Reset();
+  Profiler::Get().EnableCounters();
+  ProfileCounter("registered_images", 3);
+  Profiler::Get().Disable();
+
+  MetricsRegistry& registry = MetricsRegistry::Get();
+  registry.SetGauge("cache_bytes", 100);
+  {
+    ScopedMetricsGauges gauges;
+    gauges.Add("job_queue_size{queue=\"a\"}", []() { return 1; });
+    gauges.Add("job_queue_size{queue=\"a\"}", []() { return 2; });
+    gauges.Add("job_queue_size{queue=\"b\"}", []() { return 4; });
+
+    const std::string text = registry.Export();
+    BOOST_CHECK(StringContains(
+        text, "# TYPE colmap_registered_images_total counter\n"
+              "colmap_registered_images_total 3\n"));
+    BOOST_CHECK(StringContains(text,
+                               "# TYPE colmap_cache_bytes gauge\n"
+                               "colmap_cache_bytes 100\n"));
+    BOOST_CHECK(StringContains(text,
+                               "# TYPE colmap_job_queue_size gauge\n"
+                               "colmap_job_queue_size{queue=\"a\"} 3\n"
+                               "colmap_job_queue_size{queue=\"b\"} 4\n"));
+  }
+
+  BOOST_CHECK(!StringContains(registry.Export(), "job_queue_size"));
+}
+
+BOOST_AUTO_TEST_CASE(TestServer) {
+  using boost::asio::ip::tcp;
+
+  MetricsRegistry::Get().SetGauge("test_gauge", 42);
+
+  MetricsServer server(0);
+  server.Start();
+  BOOST_CHECK(server.CheckValidSetup());
+  BOOST_CHECK_GT(server.Port(), 0);
+
+  auto Request = [&server](const std::string& target) {
+    boost::asio::io_service io_service;
+    tcp::socket socket(io_service);
+    socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(),
+                                 server.Port()));
+    const std::string request = "GET " + target + " HTTP/1.1\r\n\r\n";
+    boost::asio::write(socket, boost::asio::buffer(request));
+    boost::asio::streambuf response;
+    boost::system::error_code error;
+    boost::asio::read(socket, response, error);
+    return std::string(std::istreambuf_iterator<char>(&response), {});
+  };
+
+  const std::string metrics_response = Request("/metrics");
+  BOOST_CHECK(StringStartsWith(metrics_response, "HTTP/1.1 200 OK\r\n"));
+  BOOST_CHECK(StringContains(metrics_response, "colmap_test_gauge 42\n"));
+
+  const std::string invalid_response = Request("/invalid");
+  BOOST_CHECK(StringStartsWith(invalid_response, "HTTP/1.1 404 Not Found"));
+
+  server.Stop();
+  server.Wait();
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: Johannes L. Schoenberger (jsch-at-demuc-dot-de)
+
+
+#include "util/nvjpeg.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <cuda_runtime.h>
+#include <nvjpeg.h>
+
+#include "util/cudacc.h"
+#include "util/logging.h"
+
+namespace colmap {
+
+struct NvJpegDecoder::State {
+  nvjpegHandle_t handle = nullptr;
+  nvjpegJpegState_t jpeg_state = nullptr;
+  cudaStream_t stream = nullptr;
+  unsigned char* device_data = nullptr;
+  size_t device_data_size = 0;
+  std::vector<unsigned char> host_data;
+};
+
+NvJpegDecoder::NvJpegDecoder() : state_(new State()) {
+  CHECK_EQ(nvjpegCreateSimple(&state_->handle), NVJPEG_STATUS_SUCCESS);
+  CHECK_EQ(nvjpegJpegStateCreate(state_->handle, &state_->jpeg_state),
+           NVJPEG_STATUS_SUCCESS);
+  CUDA_SAFE_CALL(cudaStreamCreate(&state_->stream));
+}
+
+NvJpegDecoder::~NvJpegDecoder() {
+  if (state_->device_data) {
+    cudaFree(state_->device_data);
+  }
+  cudaStreamDestroy(state_->stream);
+  nvjpegJpegStateDestroy(state_->jpeg_state);
+  nvjpegDestroy(state_->handle);
+}
+
+bool NvJpegDecoder::DecodeGrey(const std::string& path, Bitmap* bitmap) {
+  CHECK_NOTNULL(bitmap);
+
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  const std::vector<unsigned char> file_data(
+      (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  int num_components = 0;
+  nvjpegChromaSubsampling_t subsampling;
+  int widths[NVJPEG_MAX_COMPONENT];
+  int heights[NVJPEG_MAX_COMPONENT];
+  if (nvjpegGetImageInfo(state_->handle, file_data.data(), file_data.size(),
+                         &num_components, &subsampling, widths,
+                         heights) != NVJPEG_STATUS_SUCCESS) {
+    return false;
+  }
+
+  const int width = widths[0];
+  const int height = heights[0];
+  const size_t num_bytes = static_cast<size_t>(width) * height;
+
+  // Only grow the device buffer to avoid reallocations for similarly sized
+  // images in the same dataset.
+  if (num_bytes > state_->device_data_size) {
+    if (state_->device_data) {
+      CUDA_SAFE_CALL(cudaFree(state_->device_data));
+    }
+    CUDA_SAFE_CALL(cudaMalloc(&state_->device_data, num_bytes));
+    state_->device_data_size = num_bytes;
+  }
+
+  nvjpegImage_t image;
+  std::memset(&image, 0, sizeof(image));
+  image.channel[0] = state_->device_data;
+  image.pitch[0] = static_cast<unsigned int>(width);
+
+  if (nvjpegDecode(state_->handle, state_->jpeg_state, file_data.data(),
+                   file_data.size(), NVJPEG_OUTPUT_Y, &image,
+                   state_->stream) != NVJPEG_STATUS_SUCCESS) {
+    return false;
+  }
+
+  // Only the single-channel grey image is transferred back to the host, which
+  // is small compared to the compressed colour image that was decoded.
+  state_->host_data.resize(num_bytes);
+  CUDA_SAFE_CALL(cudaMemcpyAsync(state_->host_data.data(),
+                                 state_->device_data, num_bytes,
+                                 cudaMemcpyDeviceToHost, state_->stream));
+  CUDA_SAFE_CALL(cudaStreamSynchronize(state_->stream));
+
+  if (!bitmap->Allocate(width, height, /*as_rgb*/ false)) {
+    return false;
+  }
+
+  // FreeImage stores the scanlines from bottom to top.
+  for (int y = 0; y < height; ++y) {
+    std::memcpy(FreeImage_GetScanLine(bitmap->Data(), height - 1 - y),
+                state_->host_data.data() + static_cast<size_t>(y) * width,
+                width);
+  }
+
+  return true;
+}
+
+}  // namespace colmap
@@ -44,7 +44,10 @@
 #include "mvs/patch_match.h"
 #include "optim/bundle_adjustment.h"
 #include "ui/render_options.h"
+#include "util/memory_accountant.h"
+#include "util/metrics.h"
 #include "util/misc.h"
+#include "util/profiling.h"
 #include "util/random.h"
 #include "util/version.h"
 
@@ -71,6 +74,7 @@ OptionManager::OptionManager(bool add_project_options) {
   stereo_fusion.reset(new mvs::StereoFusionOptions());
   poisson_meshing.reset(new mvs::PoissonMeshingOptions());
   delaunay_meshing.reset(new mvs::DelaunayMeshingOptions());
+  mesh_simplification.reset(new mvs::MeshSimplificationOptions());
   render.reset(new RenderOptions());
 
   Reset();
@@ -183,6 +187,7 @@ void OptionManager::AddAllOptions() {
   AddStereoFusionOptions();
   AddPoissonMeshingOptions();
   AddDelaunayMeshingOptions();
+  AddMeshSimplificationOptions();
   AddRenderOptions();
 }
 
@@ -194,6 +199,12 @@ void OptionManager::AddLogOptions() {
 
   AddAndRegisterDefaultOption("log_to_stderr", &FLAGS_logtostderr);
   AddAndRegisterDefaultOption("log_level", &FLAGS_v);
+  AddAndRegisterDefaultOption("log_async", &kLogAsync);
+  AddAndRegisterDefaultOption("log_progress_interval", &kLogProgressInterval);
+  AddAndRegisterDefaultOption("log_stage_levels", &kLogStageLevels);
+  AddAndRegisterDefaultOption("profile_path", &kProfilePath);
+  AddAndRegisterDefaultOption("metrics_port", &kMetricsPort);
+  AddAndRegisterDefaultOption("memory_budget", &kMemoryBudget);
 }
 
 void OptionManager::AddRandomOptions() {
@@ -203,6 +214,7 @@ void OptionManager::AddRandomOptions() {
   added_random_options_ = true;
 
   AddAndRegisterDefaultOption("random_seed", &kDefaultPRNGSeed);
+  AddAndRegisterDefaultOption("deterministic", &kDeterministic);
 }
 
 void OptionManager::AddDatabaseOptions() {
@@ -248,12 +260,28 @@ void OptionManager::AddExtractionOptions() {
 
   AddAndRegisterDefaultOption("SiftExtraction.num_threads",
                               &sift_extraction->num_threads);
+  AddAndRegisterDefaultOption("SiftExtraction.num_intra_image_threads",
+                              &sift_extraction->num_intra_image_threads);
+  AddAndRegisterDefaultOption("SiftExtraction.num_decode_threads",
+                              &sift_extraction->num_decode_threads);
+  AddAndRegisterDefaultOption("SiftExtraction.decode_queue_size",
+                              &sift_extraction->decode_queue_size);
+  AddAndRegisterDefaultOption("SiftExtraction.queue_size",
+                              &sift_extraction->queue_size);
   AddAndRegisterDefaultOption("SiftExtraction.use_gpu",
                               &sift_extraction->use_gpu);
   AddAndRegisterDefaultOption("SiftExtraction.gpu_index",
                               &sift_extraction->gpu_index);
+  AddAndRegisterDefaultOption("SiftExtraction.num_gpu_contexts",
+                              &sift_extraction->num_gpu_contexts);
+  AddAndRegisterDefaultOption("SiftExtraction.use_gpu_decode",
+                              &sift_extraction->use_gpu_decode);
   AddAndRegisterDefaultOption("SiftExtraction.max_image_size",
                               &sift_extraction->max_image_size);
+  AddAndRegisterDefaultOption("SiftExtraction.tile_size",
+                              &sift_extraction->tile_size);
+  AddAndRegisterDefaultOption("SiftExtraction.tile_overlap",
+                              &sift_extraction->tile_overlap);
   AddAndRegisterDefaultOption("SiftExtraction.max_num_features",
                               &sift_extraction->max_num_features);
   AddAndRegisterDefaultOption("SiftExtraction.first_octave",
@@ -280,6 +308,10 @@ void OptionManager::AddExtractionOptions() {
                               &sift_extraction->dsp_max_scale);
   AddAndRegisterDefaultOption("SiftExtraction.dsp_num_scales",
                               &sift_extraction->dsp_num_scales);
+  AddAndRegisterDefaultOption("SiftExtraction.half_precision_keypoints",
+                              &sift_extraction->half_precision_keypoints);
+  AddAndRegisterDefaultOption("SiftExtraction.feature_cache_path",
+                              &sift_extraction->feature_cache_path);
 }
 
 void OptionManager::AddMatchingOptions() {
@@ -290,9 +322,15 @@ void OptionManager::AddMatchingOptions() {
 
   AddAndRegisterDefaultOption("SiftMatching.num_threads",
                               &sift_matching->num_threads);
+  AddAndRegisterDefaultOption("SiftMatching.num_intra_pair_threads",
+                              &sift_matching->num_intra_pair_threads);
+  AddAndRegisterDefaultOption("SiftMatching.numa_aware",
+                              &sift_matching->numa_aware);
   AddAndRegisterDefaultOption("SiftMatching.use_gpu", &sift_matching->use_gpu);
   AddAndRegisterDefaultOption("SiftMatching.gpu_index",
                               &sift_matching->gpu_index);
+  AddAndRegisterDefaultOption("SiftMatching.use_tensor_core_matching",
+                              &sift_matching->use_tensor_core_matching);
   AddAndRegisterDefaultOption("SiftMatching.max_ratio",
                               &sift_matching->max_ratio);
   AddAndRegisterDefaultOption("SiftMatching.max_distance",
@@ -309,12 +347,31 @@ void OptionManager::AddMatchingOptions() {
                               &sift_matching->max_num_trials);
   AddAndRegisterDefaultOption("SiftMatching.min_inlier_ratio",
                               &sift_matching->min_inlier_ratio);
+  AddAndRegisterDefaultOption("SiftMatching.use_sprt",
+                              &sift_matching->use_sprt);
+  AddAndRegisterDefaultOption("SiftMatching.use_prosac",
+                              &sift_matching->use_prosac);
+  AddAndRegisterDefaultOption("SiftMatching.use_gpu_verification",
+                              &sift_matching->use_gpu_verification);
+  AddAndRegisterDefaultOption("SiftMatching.use_sturm_five_point",
+                              &sift_matching->use_sturm_five_point);
+  AddAndRegisterDefaultOption("SiftMatching.fast_verification",
+                              &sift_matching->fast_verification);
+  AddAndRegisterDefaultOption(
+      "SiftMatching.fast_verification_min_inlier_ratio",
+      &sift_matching->fast_verification_min_inlier_ratio);
+  AddAndRegisterDefaultOption("SiftMatching.fast_verification_max_num_trials",
+                              &sift_matching->fast_verification_max_num_trials);
   AddAndRegisterDefaultOption("SiftMatching.min_num_inliers",
                               &sift_matching->min_num_inliers);
   AddAndRegisterDefaultOption("SiftMatching.multiple_models",
                               &sift_matching->multiple_models);
   AddAndRegisterDefaultOption("SiftMatching.guided_matching",
                               &sift_matching->guided_matching);
+  AddAndRegisterDefaultOption("SiftMatching.gpu_descriptor_cache_size",
+                              &sift_matching->gpu_descriptor_cache_size);
+  AddAndRegisterDefaultOption("SiftMatching.compress_matches",
+                              &sift_matching->compress_matches);
 }
 
 void OptionManager::AddExhaustiveMatchingOptions() {
@@ -327,6 +384,10 @@ void OptionManager::AddExhaustiveMatchingOptions() {
 
   AddAndRegisterDefaultOption("ExhaustiveMatching.block_size",
                               &exhaustive_matching->block_size);
+  AddAndRegisterDefaultOption("ExhaustiveMatching.pre_filter_vocab_tree_path",
+                              &exhaustive_matching->pre_filter_vocab_tree_path);
+  AddAndRegisterDefaultOption("ExhaustiveMatching.pre_filter_min_score",
+                              &exhaustive_matching->pre_filter_min_score);
 }
 
 void OptionManager::AddSequentialMatchingOptions() {
@@ -345,6 +406,9 @@ void OptionManager::AddSequentialMatchingOptions() {
                               &sequential_matching->loop_detection);
   AddAndRegisterDefaultOption("SequentialMatching.loop_detection_period",
                               &sequential_matching->loop_detection_period);
+  AddAndRegisterDefaultOption(
+      "SequentialMatching.loop_detection_exclusion_window",
+      &sequential_matching->loop_detection_exclusion_window);
   AddAndRegisterDefaultOption("SequentialMatching.loop_detection_num_images",
                               &sequential_matching->loop_detection_num_images);
   AddAndRegisterDefaultOption(
@@ -381,10 +445,14 @@ void OptionManager::AddVocabTreeMatchingOptions() {
       &vocab_tree_matching->num_images_after_verification);
   AddAndRegisterDefaultOption("VocabTreeMatching.max_num_features",
                               &vocab_tree_matching->max_num_features);
+  AddAndRegisterDefaultOption("VocabTreeMatching.use_gpu",
+                              &vocab_tree_matching->use_gpu);
   AddAndRegisterDefaultOption("VocabTreeMatching.vocab_tree_path",
                               &vocab_tree_matching->vocab_tree_path);
   AddAndRegisterDefaultOption("VocabTreeMatching.match_list_path",
                               &vocab_tree_matching->match_list_path);
+  AddAndRegisterDefaultOption("VocabTreeMatching.output_index_path",
+                              &vocab_tree_matching->output_index_path);
 }
 
 void OptionManager::AddSpatialMatchingOptions() {
@@ -403,6 +471,12 @@ void OptionManager::AddSpatialMatchingOptions() {
                               &spatial_matching->max_num_neighbors);
   AddAndRegisterDefaultOption("SpatialMatching.max_distance",
                               &spatial_matching->max_distance);
+  AddAndRegisterDefaultOption("SpatialMatching.index_path",
+                              &spatial_matching->index_path);
+  AddAndRegisterDefaultOption("SpatialMatching.pre_filter_vocab_tree_path",
+                              &spatial_matching->pre_filter_vocab_tree_path);
+  AddAndRegisterDefaultOption("SpatialMatching.pre_filter_min_score",
+                              &spatial_matching->pre_filter_min_score);
 }
 
 void OptionManager::AddTransitiveMatchingOptions() {
@@ -417,6 +491,8 @@ void OptionManager::AddTransitiveMatchingOptions() {
                               &transitive_matching->batch_size);
   AddAndRegisterDefaultOption("TransitiveMatching.num_iterations",
                               &transitive_matching->num_iterations);
+  AddAndRegisterDefaultOption("TransitiveMatching.max_num_image_pairs",
+                              &transitive_matching->max_num_image_pairs);
 }
 
 void OptionManager::AddBundleAdjustmentOptions() {
@@ -440,6 +516,12 @@ void OptionManager::AddBundleAdjustmentOptions() {
   AddAndRegisterDefaultOption(
       "BundleAdjustment.parameter_tolerance",
       &bundle_adjustment->solver_options.parameter_tolerance);
+  AddAndRegisterDefaultOption(
+      "BundleAdjustment.max_solver_time_in_seconds",
+      &bundle_adjustment->solver_options.max_solver_time_in_seconds);
+  AddAndRegisterDefaultOption(
+      "BundleAdjustment.min_relative_cost_decrease_per_second",
+      &bundle_adjustment->min_relative_cost_decrease_per_second);
   AddAndRegisterDefaultOption("BundleAdjustment.refine_focal_length",
                               &bundle_adjustment->refine_focal_length);
   AddAndRegisterDefaultOption("BundleAdjustment.refine_principal_point",
@@ -448,6 +530,24 @@ void OptionManager::AddBundleAdjustmentOptions() {
                               &bundle_adjustment->refine_extra_params);
   AddAndRegisterDefaultOption("BundleAdjustment.refine_extrinsics",
                               &bundle_adjustment->refine_extrinsics);
+  AddAndRegisterDefaultOption("BundleAdjustment.use_gpu",
+                              &bundle_adjustment->use_gpu);
+  AddAndRegisterDefaultOption("BundleAdjustment.gpu_index",
+                              &bundle_adjustment->gpu_index);
+  AddAndRegisterDefaultOption("BundleAdjustment.use_mixed_precision",
+                              &bundle_adjustment->use_mixed_precision);
+  AddAndRegisterDefaultOption(
+      "BundleAdjustment.max_num_refinement_iterations",
+      &bundle_adjustment->max_num_refinement_iterations);
+  AddAndRegisterDefaultOption(
+      "BundleAdjustment.solve_constant_structure_independently",
+      &bundle_adjustment->solve_constant_structure_independently);
+  AddAndRegisterDefaultOption(
+      "BundleAdjustment.min_num_images_visibility_clustering",
+      &bundle_adjustment->min_num_images_visibility_clustering);
+  AddAndRegisterDefaultOption(
+      "BundleAdjustment.visibility_cluster_size",
+      &bundle_adjustment->visibility_cluster_size);
 }
 
 void OptionManager::AddMapperOptions() {
@@ -460,6 +560,11 @@ void OptionManager::AddMapperOptions() {
                               &mapper->min_num_matches);
   AddAndRegisterDefaultOption("Mapper.ignore_watermarks",
                               &mapper->ignore_watermarks);
+  AddAndRegisterDefaultOption("Mapper.correspondence_graph_path",
+                              &mapper->correspondence_graph_path);
+  AddAndRegisterDefaultOption("Mapper.streaming", &mapper->streaming);
+  AddAndRegisterDefaultOption("Mapper.streaming_poll_interval",
+                              &mapper->streaming_poll_interval);
   AddAndRegisterDefaultOption("Mapper.multiple_models",
                               &mapper->multiple_models);
   AddAndRegisterDefaultOption("Mapper.max_num_models", &mapper->max_num_models);
@@ -470,6 +575,9 @@ void OptionManager::AddMapperOptions() {
   AddAndRegisterDefaultOption("Mapper.init_image_id2", &mapper->init_image_id2);
   AddAndRegisterDefaultOption("Mapper.init_num_trials",
                               &mapper->init_num_trials);
+  AddAndRegisterDefaultOption("Mapper.reg_batch_size", &mapper->reg_batch_size);
+  AddAndRegisterDefaultOption("Mapper.rig_config_path",
+                              &mapper->rig_config_path);
   AddAndRegisterDefaultOption("Mapper.extract_colors", &mapper->extract_colors);
   AddAndRegisterDefaultOption("Mapper.num_threads", &mapper->num_threads);
   AddAndRegisterDefaultOption("Mapper.min_focal_length_ratio",
@@ -487,6 +595,8 @@ void OptionManager::AddMapperOptions() {
   AddAndRegisterDefaultOption(
       "Mapper.ba_min_num_residuals_for_multi_threading",
       &mapper->ba_min_num_residuals_for_multi_threading);
+  AddAndRegisterDefaultOption("Mapper.ba_use_mixed_precision",
+                              &mapper->ba_use_mixed_precision);
   AddAndRegisterDefaultOption("Mapper.ba_local_num_images",
                               &mapper->ba_local_num_images);
   AddAndRegisterDefaultOption("Mapper.ba_local_max_num_iterations",
@@ -495,6 +605,12 @@ void OptionManager::AddMapperOptions() {
                               &mapper->ba_global_use_pba);
   AddAndRegisterDefaultOption("Mapper.ba_global_pba_gpu_index",
                               &mapper->ba_global_pba_gpu_index);
+  AddAndRegisterDefaultOption("Mapper.ba_global_use_gpu",
+                              &mapper->ba_global_use_gpu);
+  AddAndRegisterDefaultOption("Mapper.ba_global_gpu_index",
+                              &mapper->ba_global_gpu_index);
+  AddAndRegisterDefaultOption("Mapper.ba_global_max_num_images_per_partition",
+                              &mapper->ba_global_max_num_images_per_partition);
   AddAndRegisterDefaultOption("Mapper.ba_global_images_ratio",
                               &mapper->ba_global_images_ratio);
   AddAndRegisterDefaultOption("Mapper.ba_global_points_ratio",
@@ -503,6 +619,14 @@ void OptionManager::AddMapperOptions() {
                               &mapper->ba_global_images_freq);
   AddAndRegisterDefaultOption("Mapper.ba_global_points_freq",
                               &mapper->ba_global_points_freq);
+  AddAndRegisterDefaultOption("Mapper.ba_global_adaptive",
+                              &mapper->ba_global_adaptive);
+  AddAndRegisterDefaultOption("Mapper.ba_global_max_error_drift",
+                              &mapper->ba_global_max_error_drift);
+  AddAndRegisterDefaultOption("Mapper.ba_global_max_changed_ratio",
+                              &mapper->ba_global_max_changed_ratio);
+  AddAndRegisterDefaultOption("Mapper.ba_global_max_time_fraction",
+                              &mapper->ba_global_max_time_fraction);
   AddAndRegisterDefaultOption("Mapper.ba_global_max_num_iterations",
                               &mapper->ba_global_max_num_iterations);
   AddAndRegisterDefaultOption("Mapper.ba_global_max_refinements",
@@ -516,6 +640,11 @@ void OptionManager::AddMapperOptions() {
   AddAndRegisterDefaultOption("Mapper.snapshot_path", &mapper->snapshot_path);
   AddAndRegisterDefaultOption("Mapper.snapshot_images_freq",
                               &mapper->snapshot_images_freq);
+  AddAndRegisterDefaultOption("Mapper.checkpoint_path",
+                              &mapper->checkpoint_path);
+  AddAndRegisterDefaultOption("Mapper.checkpoint_images_freq",
+                              &mapper->checkpoint_images_freq);
+  AddAndRegisterDefaultOption("Mapper.resume", &mapper->resume);
   AddAndRegisterDefaultOption("Mapper.fix_existing_images",
                               &mapper->fix_existing_images);
 
@@ -530,12 +659,18 @@ void OptionManager::AddMapperOptions() {
                               &mapper->mapper.init_min_tri_angle);
   AddAndRegisterDefaultOption("Mapper.init_max_reg_trials",
                               &mapper->mapper.init_max_reg_trials);
+  AddAndRegisterDefaultOption("Mapper.init_num_candidate_pairs",
+                              &mapper->mapper.init_num_candidate_pairs);
   AddAndRegisterDefaultOption("Mapper.abs_pose_max_error",
                               &mapper->mapper.abs_pose_max_error);
   AddAndRegisterDefaultOption("Mapper.abs_pose_min_num_inliers",
                               &mapper->mapper.abs_pose_min_num_inliers);
   AddAndRegisterDefaultOption("Mapper.abs_pose_min_inlier_ratio",
                               &mapper->mapper.abs_pose_min_inlier_ratio);
+  AddAndRegisterDefaultOption("Mapper.abs_pose_ransac_num_threads",
+                              &mapper->mapper.abs_pose_ransac_num_threads);
+  AddAndRegisterDefaultOption("Mapper.abs_pose_use_gpu",
+                              &mapper->mapper.abs_pose_use_gpu);
   AddAndRegisterDefaultOption("Mapper.filter_max_reproj_error",
                               &mapper->mapper.filter_max_reproj_error);
   AddAndRegisterDefaultOption("Mapper.filter_min_tri_angle",
@@ -600,6 +735,20 @@ void OptionManager::AddPatchMatchStereoOptions() {
                               &patch_match_stereo->incident_angle_sigma);
   AddAndRegisterDefaultOption("PatchMatchStereo.num_iterations",
                               &patch_match_stereo->num_iterations);
+  AddAndRegisterDefaultOption("PatchMatchStereo.checkerboard_propagation",
+                              &patch_match_stereo->checkerboard_propagation);
+  AddAndRegisterDefaultOption("PatchMatchStereo.init_from_sparse_points",
+                              &patch_match_stereo->init_from_sparse_points);
+  AddAndRegisterDefaultOption("PatchMatchStereo.num_pyramid_levels",
+                              &patch_match_stereo->num_pyramid_levels);
+  AddAndRegisterDefaultOption("PatchMatchStereo.pyramid_num_iterations",
+                              &patch_match_stereo->pyramid_num_iterations);
+  AddAndRegisterDefaultOption("PatchMatchStereo.pyramid_depth_range",
+                              &patch_match_stereo->pyramid_depth_range);
+  AddAndRegisterDefaultOption("PatchMatchStereo.tile_size",
+                              &patch_match_stereo->tile_size);
+  AddAndRegisterDefaultOption("PatchMatchStereo.tile_overlap",
+                              &patch_match_stereo->tile_overlap);
   AddAndRegisterDefaultOption("PatchMatchStereo.geom_consistency",
                               &patch_match_stereo->geom_consistency);
   AddAndRegisterDefaultOption(
@@ -621,8 +770,16 @@ void OptionManager::AddPatchMatchStereoOptions() {
       &patch_match_stereo->filter_geom_consistency_max_cost);
   AddAndRegisterDefaultOption("PatchMatchStereo.cache_size",
                               &patch_match_stereo->cache_size);
+  AddAndRegisterDefaultOption("PatchMatchStereo.gpu_cache_size",
+                              &patch_match_stereo->gpu_cache_size);
+  AddAndRegisterDefaultOption("PatchMatchStereo.distorted_image_path",
+                              &patch_match_stereo->distorted_image_path);
   AddAndRegisterDefaultOption("PatchMatchStereo.write_consistency_graph",
                               &patch_match_stereo->write_consistency_graph);
+  AddAndRegisterDefaultOption("PatchMatchStereo.write_compact_maps",
+                              &patch_match_stereo->write_compact_maps);
+  AddAndRegisterDefaultOption("PatchMatchStereo.write_confidence_map",
+                              &patch_match_stereo->write_confidence_map);
 }
 
 void OptionManager::AddStereoFusionOptions() {
@@ -649,6 +806,23 @@ void OptionManager::AddStereoFusionOptions() {
                               &stereo_fusion->check_num_images);
   AddAndRegisterDefaultOption("StereoFusion.cache_size",
                               &stereo_fusion->cache_size);
+  AddAndRegisterDefaultOption("StereoFusion.distorted_image_path",
+                              &stereo_fusion->distorted_image_path);
+  AddAndRegisterDefaultOption("StereoFusion.num_threads",
+                              &stereo_fusion->num_threads);
+  AddAndRegisterDefaultOption("StereoFusion.numa_aware",
+                              &stereo_fusion->numa_aware);
+  AddAndRegisterDefaultOption("StereoFusion.compact_maps",
+                              &stereo_fusion->compact_maps);
+  AddAndRegisterDefaultOption("StereoFusion.mmap_maps",
+                              &stereo_fusion->mmap_maps);
+  AddAndRegisterDefaultOption("StereoFusion.min_confidence",
+                              &stereo_fusion->min_confidence);
+  AddAndRegisterDefaultOption("StereoFusion.use_gpu", &stereo_fusion->use_gpu);
+  AddAndRegisterDefaultOption("StereoFusion.gpu_index",
+                              &stereo_fusion->gpu_index);
+  AddAndRegisterDefaultOption("StereoFusion.gpu_cache_size",
+                              &stereo_fusion->gpu_cache_size);
 }
 
 void OptionManager::AddPoissonMeshingOptions() {
@@ -664,6 +838,10 @@ void OptionManager::AddPoissonMeshingOptions() {
   AddAndRegisterDefaultOption("PoissonMeshing.trim", &poisson_meshing->trim);
   AddAndRegisterDefaultOption("PoissonMeshing.num_threads",
                               &poisson_meshing->num_threads);
+  AddAndRegisterDefaultOption("PoissonMeshing.max_tile_num_points",
+                              &poisson_meshing->max_tile_num_points);
+  AddAndRegisterDefaultOption("PoissonMeshing.tile_overlap",
+                              &poisson_meshing->tile_overlap);
 }
 
 void OptionManager::AddDelaunayMeshingOptions() {
@@ -684,10 +862,28 @@ void OptionManager::AddDelaunayMeshingOptions() {
                               &delaunay_meshing->max_side_length_factor);
   AddAndRegisterDefaultOption("DelaunayMeshing.max_side_length_percentile",
                               &delaunay_meshing->max_side_length_percentile);
+  AddAndRegisterDefaultOption("DelaunayMeshing.parallel_graph_cut",
+                              &delaunay_meshing->parallel_graph_cut);
   AddAndRegisterDefaultOption("DelaunayMeshing.num_threads",
                               &delaunay_meshing->num_threads);
 }
 
+void OptionManager::AddMeshSimplificationOptions() {
+  if (added_mesh_simplification_options_) {
+    return;
+  }
+  added_mesh_simplification_options_ = true;
+
+  AddAndRegisterDefaultOption("MeshSimplification.num_levels",
+                              &mesh_simplification->num_levels);
+  AddAndRegisterDefaultOption("MeshSimplification.level_face_ratio",
+                              &mesh_simplification->level_face_ratio);
+  AddAndRegisterDefaultOption("MeshSimplification.max_block_num_faces",
+                              &mesh_simplification->max_block_num_faces);
+  AddAndRegisterDefaultOption("MeshSimplification.num_threads",
+                              &mesh_simplification->num_threads);
+}
+
 void OptionManager::AddRenderOptions() {
   if (added_render_options_) {
     return;
@@ -696,6 +892,10 @@ void OptionManager::AddRenderOptions() {
 
   AddAndRegisterDefaultOption("Render.min_track_len", &render->min_track_len);
   AddAndRegisterDefaultOption("Render.max_error", &render->max_error);
+  AddAndRegisterDefaultOption("Render.max_num_points_per_pixel",
+                              &render->max_num_points_per_pixel);
+  AddAndRegisterDefaultOption("Render.max_num_interactive_points",
+                              &render->max_num_interactive_points);
   AddAndRegisterDefaultOption("Render.refresh_rate", &render->refresh_rate);
   AddAndRegisterDefaultOption("Render.adapt_refresh_rate",
                               &render->adapt_refresh_rate);
@@ -736,6 +936,7 @@ void OptionManager::Reset() {
   added_stereo_fusion_options_ = false;
   added_poisson_meshing_options_ = false;
   added_delaunay_meshing_options_ = false;
+  added_mesh_simplification_options_ = false;
   added_render_options_ = false;
 }
 
@@ -759,12 +960,18 @@ void OptionManager::ResetOptions(const bool reset_paths) {
   *stereo_fusion = mvs::StereoFusionOptions();
   *poisson_meshing = mvs::PoissonMeshingOptions();
   *delaunay_meshing = mvs::DelaunayMeshingOptions();
+  *mesh_simplification = mvs::MeshSimplificationOptions();
   *render = RenderOptions();
 }
 
 bool OptionManager::Check() {
   bool success = true;
 
+  if (added_log_options_) {
+    success = success && CHECK_OPTION_IMPL(kLogProgressInterval >= 0);
+    success = success && CHECK_OPTION_IMPL(kMemoryBudget >= 0);
+  }
+
   if (added_database_options_) {
     const auto database_parent_path = GetParentDir(*database_path);
     success = success && CHECK_OPTION_IMPL(!ExistsDir(*database_path)) &&
@@ -791,6 +998,7 @@ bool OptionManager::Check() {
   if (stereo_fusion) success = success && stereo_fusion->Check();
   if (poisson_meshing) success = success && poisson_meshing->Check();
   if (delaunay_meshing) success = success && delaunay_meshing->Check();
+  if (mesh_simplification) success = success && mesh_simplification->Check();
 
   if (render) success = success && render->Check();
 
@@ -840,6 +1048,11 @@ void OptionManager::Parse(const int argc, char** argv) {
     std::cerr << "ERROR: Invalid options provided." << std::endl;
     exit(EXIT_FAILURE);
   }
+
+  InitializeLogging();
+  InitializeProfiling();
+  InitializeMemoryAccounting();
+  StartMetricsServer();
 }
 
 bool OptionManager::Read(const std::string& path) {
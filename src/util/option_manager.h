@@ -57,6 +57,7 @@ struct PatchMatchOptions;
 struct StereoFusionOptions;
 struct PoissonMeshingOptions;
 struct DelaunayMeshingOptions;
+struct MeshSimplificationOptions;
 }  // namespace mvs
 
 class OptionManager {
@@ -96,6 +97,7 @@ class OptionManager {
   void AddStereoFusionOptions();
   void AddPoissonMeshingOptions();
   void AddDelaunayMeshingOptions();
+  void AddMeshSimplificationOptions();
   void AddRenderOptions();
 
   template <typename T>
@@ -136,6 +138,7 @@ class OptionManager {
   std::shared_ptr<mvs::StereoFusionOptions> stereo_fusion;
   std::shared_ptr<mvs::PoissonMeshingOptions> poisson_meshing;
   std::shared_ptr<mvs::DelaunayMeshingOptions> delaunay_meshing;
+  std::shared_ptr<mvs::MeshSimplificationOptions> mesh_simplification;
 
   std::shared_ptr<RenderOptions> render;
 
@@ -174,6 +177,7 @@ class OptionManager {
   bool added_stereo_fusion_options_;
   bool added_poisson_meshing_options_;
   bool added_delaunay_meshing_options_;
+  bool added_mesh_simplification_options_;
   bool added_render_options_;
 };
 
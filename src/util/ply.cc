@@ -31,23 +31,222 @@
 
 #include "util/ply.h"
 
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <limits>
 
 #include <Eigen/Core>
+#include <boost/filesystem.hpp>
 
 #include "util/logging.h"
+#include "util/mapped_file.h"
 #include "util/misc.h"
+#include "util/threading.h"
 
 namespace colmap {
+namespace {
+
+// Number of points or faces that are encoded into a buffer, before the buffer
+// is written to the file.
+const size_t kNumElemsPerWriteBlock = 1 << 16;
+
+// Number of binary points that are decoded by a single task.
+const size_t kNumPointsPerReadTask = 1 << 16;
+
+// Call the function for consecutive ranges of the given number of items in
+// parallel, where every range has at most the given number of items.
+template <typename Func>
+void ParallelForRanges(const size_t num_items, const size_t num_items_per_task,
+                       const Func& func) {
+  const size_t num_tasks =
+      (num_items + num_items_per_task - 1) / num_items_per_task;
+  if (num_tasks <= 1) {
+    func(0, num_items);
+    return;
+  }
+
+  ThreadPool thread_pool(
+      std::min<int>(num_tasks, GetEffectiveNumThreads(-1)));
+  for (size_t begin = 0; begin < num_items; begin += num_items_per_task) {
+    const size_t end = std::min(num_items, begin + num_items_per_task);
+    thread_pool.AddTask([&func, begin, end]() { func(begin, end); });
+  }
+  thread_pool.Wait();
+}
+
+template <typename T>
+T ReadPlyValue(const char* data, const bool is_little_endian) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return is_little_endian ? LittleEndianToNative(value)
+                          : BigEndianToNative(value);
+}
+
+template <typename T>
+char* EncodeLittleEndian(const T value, char* data) {
+  const T little_endian_value = NativeToLittleEndian(value);
+  std::memcpy(data, &little_endian_value, sizeof(T));
+  return data + sizeof(T);
+}
+
+// Parse the vertex lines of a text PLY file in the given range, where the
+// fields map the index of a property to the index of the point field.
+void ParseTextPlyPoints(const char* begin, const char* end,
+                        const std::vector<int>& fields,
+                        std::vector<PlyPoint>* points) {
+  const char* line = begin;
+  while (line < end) {
+    const char* line_end =
+        static_cast<const char*>(std::memchr(line, '\n', end - line));
+    if (line_end == nullptr) {
+      line_end = end;
+    }
+
+    float values[9] = {0.0f};
+    size_t property_idx = 0;
+    const char* token = line;
+    while (true) {
+      while (token < line_end && std::isspace(*token)) {
+        token += 1;
+      }
+      if (token == line_end) {
+        break;
+      }
+
+      const char* token_end = token;
+      while (token_end < line_end && !std::isspace(*token_end)) {
+        token_end += 1;
+      }
+
+      if (property_idx < fields.size() && fields[property_idx] >= 0) {
+        // The mapped data is not null-terminated.
+        char buffer[64];
+        const size_t token_length = token_end - token;
+        CHECK_LT(token_length, sizeof(buffer));
+        std::memcpy(buffer, token, token_length);
+        buffer[token_length] = '\0';
+        values[fields[property_idx]] = std::strtof(buffer, nullptr);
+      }
+
+      property_idx += 1;
+      token = token_end;
+    }
+
+    if (property_idx > 0) {
+      CHECK_GE(property_idx, fields.size())
+          << "Invalid PLY file format: missing vertex properties";
+      PlyPoint point;
+      point.x = values[0];
+      point.y = values[1];
+      point.z = values[2];
+      point.nx = values[3];
+      point.ny = values[4];
+      point.nz = values[5];
+      point.r = static_cast<uint8_t>(values[6]);
+      point.g = static_cast<uint8_t>(values[7]);
+      point.b = static_cast<uint8_t>(values[8]);
+      points->push_back(point);
+    }
+
+    line = line_end + 1;
+  }
+}
+
+// Encode the points into blocks of memory, which are written at once.
+void WriteBinaryPlyPointsData(const std::vector<PlyPoint>& points,
+                              const bool write_normal, const bool write_rgb,
+                              std::ostream* stream) {
+  const size_t num_bytes_per_point = 3 * sizeof(float) +
+                                     (write_normal ? 3 * sizeof(float) : 0) +
+                                     (write_rgb ? 3 * sizeof(uint8_t) : 0);
+  std::vector<char> buffer;
+  for (size_t begin = 0; begin < points.size();
+       begin += kNumElemsPerWriteBlock) {
+    const size_t end = std::min(points.size(), begin + kNumElemsPerWriteBlock);
+    buffer.resize((end - begin) * num_bytes_per_point);
+    char* data = buffer.data();
+    for (size_t i = begin; i < end; ++i) {
+      const PlyPoint& point = points[i];
+      data = EncodeLittleEndian<float>(point.x, data);
+      data = EncodeLittleEndian<float>(point.y, data);
+      data = EncodeLittleEndian<float>(point.z, data);
+
+      if (write_normal) {
+        data = EncodeLittleEndian<float>(point.nx, data);
+        data = EncodeLittleEndian<float>(point.ny, data);
+        data = EncodeLittleEndian<float>(point.nz, data);
+      }
+
+      if (write_rgb) {
+        data = EncodeLittleEndian<uint8_t>(point.r, data);
+        data = EncodeLittleEndian<uint8_t>(point.g, data);
+        data = EncodeLittleEndian<uint8_t>(point.b, data);
+      }
+    }
+    stream->write(buffer.data(), buffer.size());
+  }
+}
+
+// Encode the vertices of a mesh into blocks of memory, which are written at
+// once.
+void WriteBinaryPlyMeshVertices(const std::vector<PlyMeshVertex>& vertices,
+                                std::ostream* stream) {
+  std::vector<char> buffer;
+  for (size_t begin = 0; begin < vertices.size();
+       begin += kNumElemsPerWriteBlock) {
+    const size_t end =
+        std::min(vertices.size(), begin + kNumElemsPerWriteBlock);
+    buffer.resize((end - begin) * 3 * sizeof(float));
+    char* data = buffer.data();
+    for (size_t i = begin; i < end; ++i) {
+      const PlyMeshVertex& vertex = vertices[i];
+      data = EncodeLittleEndian<float>(vertex.x, data);
+      data = EncodeLittleEndian<float>(vertex.y, data);
+      data = EncodeLittleEndian<float>(vertex.z, data);
+    }
+    stream->write(buffer.data(), buffer.size());
+  }
+}
+
+// Encode the faces of a mesh into blocks of memory, which are written at once.
+// The vertex indices of the faces are shifted by the given offset.
+void WriteBinaryPlyMeshFaces(const std::vector<PlyMeshFace>& faces,
+                             const size_t vertex_idx_offset,
+                             const size_t num_vertices, std::ostream* stream) {
+  std::vector<char> buffer;
+  for (size_t begin = 0; begin < faces.size();
+       begin += kNumElemsPerWriteBlock) {
+    const size_t end = std::min(faces.size(), begin + kNumElemsPerWriteBlock);
+    buffer.resize((end - begin) * (sizeof(uint8_t) + 3 * sizeof(int)));
+    char* data = buffer.data();
+    for (size_t i = begin; i < end; ++i) {
+      const PlyMeshFace& face = faces[i];
+      CHECK_LT(face.vertex_idx1, num_vertices);
+      CHECK_LT(face.vertex_idx2, num_vertices);
+      CHECK_LT(face.vertex_idx3, num_vertices);
+      const uint8_t kNumVertices = 3;
+      data = EncodeLittleEndian<uint8_t>(kNumVertices, data);
+      data = EncodeLittleEndian<int>(vertex_idx_offset + face.vertex_idx1,
+                                     data);
+      data = EncodeLittleEndian<int>(vertex_idx_offset + face.vertex_idx2,
+                                     data);
+      data = EncodeLittleEndian<int>(vertex_idx_offset + face.vertex_idx3,
+                                     data);
+    }
+    stream->write(buffer.data(), buffer.size());
+  }
+}
+
+}  // namespace
 
 std::vector<PlyPoint> ReadPly(const std::string& path) {
-  std::ifstream file(path, std::ios::binary);
-  CHECK(file.is_open()) << path;
+  const MappedFile file(path);
+  const char* data = file.GetData();
+  const size_t num_bytes = file.GetNumBytes();
 
   std::vector<PlyPoint> points;
 
-  std::string line;
-
   // The index of the property for ASCII PLY files.
   int X_index = -1;
   int Y_index = -1;
@@ -77,7 +276,17 @@ std::vector<PlyPoint> ReadPly(const std::string& path) {
   size_t num_vertices = 0;
 
   int index = 0;
-  while (std::getline(file, line)) {
+  size_t offset = 0;
+  while (offset < num_bytes) {
+    const char* line_begin = data + offset;
+    const char* line_end = static_cast<const char*>(
+        std::memchr(line_begin, '\n', num_bytes - offset));
+    if (line_end == nullptr) {
+      line_end = data + num_bytes;
+    }
+    std::string line(line_begin, line_end);
+    offset = std::min(num_bytes, static_cast<size_t>(line_end - data) + 1);
+
     StringTrim(&line);
 
     if (line.empty()) {
@@ -87,7 +296,6 @@ std::vector<PlyPoint> ReadPly(const std::string& path) {
     if (line == "end_header") {
       break;
     }
-
     if (line.size() >= 6 && line.substr(0, 6) == "format") {
       if (line == "format ascii 1.0") {
         is_binary = false;
@@ -177,104 +385,95 @@ std::vector<PlyPoint> ReadPly(const std::string& path) {
   const bool is_rgb_missing =
       (R_index == -1) || (G_index == -1) || (B_index == -1);
 
-  CHECK(X_index != -1 && Y_index != -1 && Z_index)
+  CHECK(X_index != -1 && Y_index != -1 && Z_index != -1)
       << "Invalid PLY file format: x, y, z properties missing";
 
-  points.reserve(num_vertices);
-
   if (is_binary) {
-    std::vector<char> buffer(num_bytes_per_line);
-    for (size_t i = 0; i < num_vertices; ++i) {
-      file.read(buffer.data(), num_bytes_per_line);
-
-      PlyPoint point;
-
-      if (is_little_endian) {
-        point.x = LittleEndianToNative(
-            *reinterpret_cast<float*>(&buffer[X_byte_pos]));
-        point.y = LittleEndianToNative(
-            *reinterpret_cast<float*>(&buffer[Y_byte_pos]));
-        point.z = LittleEndianToNative(
-            *reinterpret_cast<float*>(&buffer[Z_byte_pos]));
-
-        if (!is_normal_missing) {
-          point.nx = LittleEndianToNative(
-              *reinterpret_cast<float*>(&buffer[NX_byte_pos]));
-          point.ny = LittleEndianToNative(
-              *reinterpret_cast<float*>(&buffer[NY_byte_pos]));
-          point.nz = LittleEndianToNative(
-              *reinterpret_cast<float*>(&buffer[NZ_byte_pos]));
-        }
-
-        if (!is_rgb_missing) {
-          point.r = LittleEndianToNative(
-              *reinterpret_cast<uint8_t*>(&buffer[R_byte_pos]));
-          point.g = LittleEndianToNative(
-              *reinterpret_cast<uint8_t*>(&buffer[G_byte_pos]));
-          point.b = LittleEndianToNative(
-              *reinterpret_cast<uint8_t*>(&buffer[B_byte_pos]));
-        }
-      } else {
-        point.x =
-            BigEndianToNative(*reinterpret_cast<float*>(&buffer[X_byte_pos]));
-        point.y =
-            BigEndianToNative(*reinterpret_cast<float*>(&buffer[Y_byte_pos]));
-        point.z =
-            BigEndianToNative(*reinterpret_cast<float*>(&buffer[Z_byte_pos]));
+    CHECK_LE(num_vertices * num_bytes_per_line, num_bytes - offset)
+        << "Invalid PLY file format: truncated vertex data";
+    points.resize(num_vertices);
+    const char* vertex_data = data + offset;
+
+    // Decode the vertices directly from the mapped file in parallel.
+    ParallelForRanges(
+        num_vertices, kNumPointsPerReadTask,
+        [&](const size_t begin, const size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const char* vertex = vertex_data + i * num_bytes_per_line;
+        PlyPoint& point = points[i];
+
+        point.x = ReadPlyValue<float>(vertex + X_byte_pos, is_little_endian);
+        point.y = ReadPlyValue<float>(vertex + Y_byte_pos, is_little_endian);
+        point.z = ReadPlyValue<float>(vertex + Z_byte_pos, is_little_endian);
 
         if (!is_normal_missing) {
-          point.nx = BigEndianToNative(
-              *reinterpret_cast<float*>(&buffer[NX_byte_pos]));
-          point.ny = BigEndianToNative(
-              *reinterpret_cast<float*>(&buffer[NY_byte_pos]));
-          point.nz = BigEndianToNative(
-              *reinterpret_cast<float*>(&buffer[NZ_byte_pos]));
+          point.nx =
+              ReadPlyValue<float>(vertex + NX_byte_pos, is_little_endian);
+          point.ny =
+              ReadPlyValue<float>(vertex + NY_byte_pos, is_little_endian);
+          point.nz =
+              ReadPlyValue<float>(vertex + NZ_byte_pos, is_little_endian);
         }
 
         if (!is_rgb_missing) {
-          point.r = BigEndianToNative(
-              *reinterpret_cast<uint8_t*>(&buffer[R_byte_pos]));
-          point.g = BigEndianToNative(
-              *reinterpret_cast<uint8_t*>(&buffer[G_byte_pos]));
-          point.b = BigEndianToNative(
-              *reinterpret_cast<uint8_t*>(&buffer[B_byte_pos]));
+          point.r = static_cast<uint8_t>(vertex[R_byte_pos]);
+          point.g = static_cast<uint8_t>(vertex[G_byte_pos]);
+          point.b = static_cast<uint8_t>(vertex[B_byte_pos]);
         }
       }
-
-      points.push_back(point);
-    }
+    });
   } else {
-    while (std::getline(file, line)) {
-      StringTrim(&line);
-      std::stringstream line_stream(line);
-
-      std::string item;
-      std::vector<std::string> items;
-      while (!line_stream.eof()) {
-        std::getline(line_stream, item, ' ');
-        StringTrim(&item);
-        items.push_back(item);
-      }
-
-      PlyPoint point;
-
-      point.x = std::stold(items.at(X_index));
-      point.y = std::stold(items.at(Y_index));
-      point.z = std::stold(items.at(Z_index));
+    // The fields of the points in the order of the properties, where the
+    // coordinates, normals, and colors are fields 0-2, 3-5, and 6-8.
+    std::vector<int> fields(index, -1);
+    fields.at(X_index) = 0;
+    fields.at(Y_index) = 1;
+    fields.at(Z_index) = 2;
+    if (!is_normal_missing) {
+      fields.at(NX_index) = 3;
+      fields.at(NY_index) = 4;
+      fields.at(NZ_index) = 5;
+    }
+    if (!is_rgb_missing) {
+      fields.at(R_index) = 6;
+      fields.at(G_index) = 7;
+      fields.at(B_index) = 8;
+    }
 
-      if (!is_normal_missing) {
-        point.nx = std::stold(items.at(NX_index));
-        point.ny = std::stold(items.at(NY_index));
-        point.nz = std::stold(items.at(NZ_index));
+    // Split the vertex lines into chunks, which are parsed in parallel.
+    const size_t kMinNumBytesPerChunk = 1 << 20;
+    const size_t num_chunks =
+        std::max<size_t>(1, (num_bytes - offset) / kMinNumBytesPerChunk);
+    std::vector<size_t> chunk_offsets(1, offset);
+    for (size_t i = 1; i < num_chunks; ++i) {
+      size_t chunk_offset =
+          std::max(chunk_offsets.back(),
+                   offset + i * ((num_bytes - offset) / num_chunks));
+      while (chunk_offset < num_bytes && data[chunk_offset - 1] != '\n') {
+        chunk_offset += 1;
       }
+      chunk_offsets.push_back(chunk_offset);
+    }
+    chunk_offsets.push_back(num_bytes);
 
-      if (!is_rgb_missing) {
-        point.r = std::stoi(items.at(R_index));
-        point.g = std::stoi(items.at(G_index));
-        point.b = std::stoi(items.at(B_index));
+    std::vector<std::vector<PlyPoint>> chunk_points(num_chunks);
+    ParallelForRanges(num_chunks, 1, [&](const size_t begin, const size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        ParseTextPlyPoints(data + chunk_offsets[i], data + chunk_offsets[i + 1],
+                           fields, &chunk_points[i]);
       }
+    });
 
-      points.push_back(point);
+    size_t num_points = 0;
+    for (const auto& points_in_chunk : chunk_points) {
+      num_points += points_in_chunk.size();
+    }
+    points.reserve(num_points);
+    for (auto& points_in_chunk : chunk_points) {
+      points.insert(points.end(), points_in_chunk.begin(),
+                    points_in_chunk.end());
+      points_in_chunk.clear();
+      points_in_chunk.shrink_to_fit();
     }
   }
 
@@ -360,25 +559,67 @@ void WriteBinaryPlyPoints(const std::string& path,
                            std::ios::out | std::ios::binary | std::ios::app);
   CHECK(binary_file.is_open()) << path;
 
-  for (const auto& point : points) {
-    WriteBinaryLittleEndian<float>(&binary_file, point.x);
-    WriteBinaryLittleEndian<float>(&binary_file, point.y);
-    WriteBinaryLittleEndian<float>(&binary_file, point.z);
+  WriteBinaryPlyPointsData(points, write_normal, write_rgb, &binary_file);
 
-    if (write_normal) {
-      WriteBinaryLittleEndian<float>(&binary_file, point.nx);
-      WriteBinaryLittleEndian<float>(&binary_file, point.ny);
-      WriteBinaryLittleEndian<float>(&binary_file, point.nz);
-    }
+  binary_file.close();
+}
 
-    if (write_rgb) {
-      WriteBinaryLittleEndian<uint8_t>(&binary_file, point.r);
-      WriteBinaryLittleEndian<uint8_t>(&binary_file, point.g);
-      WriteBinaryLittleEndian<uint8_t>(&binary_file, point.b);
-    }
+BinaryPlyPointsWriter::BinaryPlyPointsWriter(const std::string& path,
+                                             const bool write_normal,
+                                             const bool write_rgb)
+    : write_normal_(write_normal), write_rgb_(write_rgb), num_points_(0) {
+  file_.open(path, std::ios::out | std::ios::binary);
+  CHECK(file_.is_open()) << path;
+
+  file_ << "ply" << std::endl;
+  file_ << "format binary_little_endian 1.0" << std::endl;
+
+  // The number of points is not yet known and is overwritten on closing,
+  // so it is zero-padded to a fixed width.
+  file_ << "element vertex ";
+  num_points_pos_ = file_.tellp();
+  file_ << StringPrintf("%020d", 0) << std::endl;
+
+  file_ << "property float x" << std::endl;
+  file_ << "property float y" << std::endl;
+  file_ << "property float z" << std::endl;
+
+  if (write_normal_) {
+    file_ << "property float nx" << std::endl;
+    file_ << "property float ny" << std::endl;
+    file_ << "property float nz" << std::endl;
   }
 
-  binary_file.close();
+  if (write_rgb_) {
+    file_ << "property uchar red" << std::endl;
+    file_ << "property uchar green" << std::endl;
+    file_ << "property uchar blue" << std::endl;
+  }
+
+  file_ << "end_header" << std::endl;
+}
+
+BinaryPlyPointsWriter::~BinaryPlyPointsWriter() { Close(); }
+
+size_t BinaryPlyPointsWriter::NumPoints() const { return num_points_; }
+
+void BinaryPlyPointsWriter::Write(const std::vector<PlyPoint>& points) {
+  CHECK(file_.is_open());
+
+  WriteBinaryPlyPointsData(points, write_normal_, write_rgb_, &file_);
+
+  num_points_ += points.size();
+}
+
+void BinaryPlyPointsWriter::Close() {
+  if (!file_.is_open()) {
+    return;
+  }
+
+  file_.seekp(num_points_pos_);
+  file_ << StringPrintf("%020llu",
+                        static_cast<unsigned long long>(num_points_));
+  file_.close();
 }
 
 void WriteTextPlyMesh(const std::string& path, const PlyMesh& mesh) {
@@ -425,24 +666,77 @@ void WriteBinaryPlyMesh(const std::string& path, const PlyMesh& mesh) {
                            std::ios::out | std::ios::binary | std::ios::app);
   CHECK(binary_file.is_open()) << path;
 
-  for (const auto& vertex : mesh.vertices) {
-    WriteBinaryLittleEndian<float>(&binary_file, vertex.x);
-    WriteBinaryLittleEndian<float>(&binary_file, vertex.y);
-    WriteBinaryLittleEndian<float>(&binary_file, vertex.z);
-  }
+  WriteBinaryPlyMeshVertices(mesh.vertices, &binary_file);
+  WriteBinaryPlyMeshFaces(mesh.faces, 0, mesh.vertices.size(), &binary_file);
 
-  for (const auto& face : mesh.faces) {
-    CHECK_LT(face.vertex_idx1, mesh.vertices.size());
-    CHECK_LT(face.vertex_idx2, mesh.vertices.size());
-    CHECK_LT(face.vertex_idx3, mesh.vertices.size());
-    const uint8_t kNumVertices = 3;
-    WriteBinaryLittleEndian<uint8_t>(&binary_file, kNumVertices);
-    WriteBinaryLittleEndian<int>(&binary_file, face.vertex_idx1);
-    WriteBinaryLittleEndian<int>(&binary_file, face.vertex_idx2);
-    WriteBinaryLittleEndian<int>(&binary_file, face.vertex_idx3);
+  binary_file.close();
+}
+
+BinaryPlyMeshWriter::BinaryPlyMeshWriter(const std::string& path)
+    : faces_path_(path + ".faces"), num_vertices_(0), num_faces_(0) {
+  file_.open(path, std::ios::out | std::ios::binary);
+  CHECK(file_.is_open()) << path;
+  faces_file_.open(faces_path_, std::ios::out | std::ios::binary);
+  CHECK(faces_file_.is_open()) << faces_path_;
+
+  file_ << "ply" << std::endl;
+  file_ << "format binary_little_endian 1.0" << std::endl;
+
+  // The numbers of vertices and faces are not yet known and are overwritten
+  // on closing, so they are zero-padded to a fixed width.
+  file_ << "element vertex ";
+  num_vertices_pos_ = file_.tellp();
+  file_ << StringPrintf("%020d", 0) << std::endl;
+  file_ << "property float x" << std::endl;
+  file_ << "property float y" << std::endl;
+  file_ << "property float z" << std::endl;
+  file_ << "element face ";
+  num_faces_pos_ = file_.tellp();
+  file_ << StringPrintf("%020d", 0) << std::endl;
+  file_ << "property list uchar int vertex_index" << std::endl;
+  file_ << "end_header" << std::endl;
+}
+
+BinaryPlyMeshWriter::~BinaryPlyMeshWriter() { Close(); }
+
+size_t BinaryPlyMeshWriter::NumVertices() const { return num_vertices_; }
+
+size_t BinaryPlyMeshWriter::NumFaces() const { return num_faces_; }
+
+void BinaryPlyMeshWriter::Write(const PlyMesh& mesh) {
+  CHECK(file_.is_open());
+
+  WriteBinaryPlyMeshVertices(mesh.vertices, &file_);
+  WriteBinaryPlyMeshFaces(mesh.faces, num_vertices_, mesh.vertices.size(),
+                          &faces_file_);
+
+  num_vertices_ += mesh.vertices.size();
+  num_faces_ += mesh.faces.size();
+  CHECK_LE(num_vertices_,
+           static_cast<size_t>(std::numeric_limits<int>::max()));
+}
+
+void BinaryPlyMeshWriter::Close() {
+  if (!file_.is_open()) {
+    return;
   }
 
-  binary_file.close();
+  faces_file_.close();
+  faces_file_.open(faces_path_, std::ios::in | std::ios::binary);
+  CHECK(faces_file_.is_open()) << faces_path_;
+  // Inserting an empty buffer would set the error state of the file.
+  if (num_faces_ > 0) {
+    file_ << faces_file_.rdbuf();
+  }
+  faces_file_.close();
+  boost::filesystem::remove(faces_path_);
+
+  file_.seekp(num_vertices_pos_);
+  file_ << StringPrintf("%020llu",
+                        static_cast<unsigned long long>(num_vertices_));
+  file_.seekp(num_faces_pos_);
+  file_ << StringPrintf("%020llu", static_cast<unsigned long long>(num_faces_));
+  file_.close();
 }
 
 }  // namespace colmap
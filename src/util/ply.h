@@ -32,6 +32,7 @@
 #ifndef COLMAP_SRC_UTIL_PLY_H_
 #define COLMAP_SRC_UTIL_PLY_H_
 
+#include <fstream>
 #include <string>
 #include <vector>
 
@@ -79,7 +80,8 @@ struct PlyMesh {
   std::vector<PlyMeshFace> faces;
 };
 
-// Read PLY point cloud from text or binary file.
+// Read PLY point cloud from text or binary file. The file is memory-mapped and
+// the vertex data is parsed in parallel.
 std::vector<PlyPoint> ReadPly(const std::string& path);
 
 // Write PLY point cloud to text or binary file.
@@ -92,10 +94,66 @@ void WriteBinaryPlyPoints(const std::string& path,
                           const bool write_normal = true,
                           const bool write_rgb = true);
 
+// Writer of a binary PLY point cloud, whose points are appended in chunks,
+// such that large point clouds can be written without keeping all points in
+// memory. The number of points in the header is written when closing the file.
+class BinaryPlyPointsWriter {
+ public:
+  BinaryPlyPointsWriter(const std::string& path, const bool write_normal = true,
+                        const bool write_rgb = true);
+  ~BinaryPlyPointsWriter();
+
+  size_t NumPoints() const;
+
+  // Append the points to the file.
+  void Write(const std::vector<PlyPoint>& points);
+
+  // Write the final number of points to the header and close the file.
+  void Close();
+
+ private:
+  const bool write_normal_;
+  const bool write_rgb_;
+  std::fstream file_;
+  std::streampos num_points_pos_;
+  size_t num_points_;
+};
+
 // Write PLY mesh to text or binary file.
 void WriteTextPlyMesh(const std::string& path, const PlyMesh& mesh);
 void WriteBinaryPlyMesh(const std::string& path, const PlyMesh& mesh);
 
+// Writer of a binary PLY mesh, whose parts are appended in chunks, such that
+// large meshes can be written without keeping the entire mesh in memory. Since
+// all faces follow all vertices in the file, the faces are buffered in a
+// temporary file next to the output. The numbers of vertices and faces in the
+// header are written and the faces are appended when closing the file.
+class BinaryPlyMeshWriter {
+ public:
+  explicit BinaryPlyMeshWriter(const std::string& path);
+  ~BinaryPlyMeshWriter();
+
+  size_t NumVertices() const;
+  size_t NumFaces() const;
+
+  // Append the vertices and faces of a mesh part to the file, where the faces
+  // index the vertices of the given part.
+  void Write(const PlyMesh& mesh);
+
+  // Write the final numbers of vertices and faces to the header, append the
+  // faces, and close the file.
+  void Close();
+
+ private:
+  const std::string faces_path_;
+  std::fstream file_;
+  std::fstream faces_file_;
+  std::streampos num_vertices_pos_;
+  std::streampos num_faces_pos_;
+  size_t num_vertices_;
+  size_t num_faces_;
+};
+
 }  // namespace colmap
 
 #endif  // COLMAP_SRC_UTIL_PLY_H_
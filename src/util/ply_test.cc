@@ -0,0 +1,230 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "util/ply"
+#include "util/testing.h"
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include "util/ply.h"
+
+using namespace colmap;
+
+namespace {
+
+std::string GetTempPlyPath() {
+  return (boost::filesystem::temp_directory_path() /
+          boost::filesystem::unique_path("%%%%-%%%%-%%%%.ply"))
+      .string();
+}
+
+std::vector<PlyPoint> GeneratePoints(const size_t num_points) {
+  std::vector<PlyPoint> points(num_points);
+  for (size_t i = 0; i < num_points; ++i) {
+    points[i].x = 0.5f * i;
+    points[i].y = -1.0f * i;
+    points[i].z = 2.0f + i;
+    points[i].nx = 0.25f;
+    points[i].ny = -0.5f;
+    points[i].nz = 1.0f;
+    points[i].r = i % 256;
+    points[i].g = (i + 1) % 256;
+    points[i].b = (i + 2) % 256;
+  }
+  return points;
+}
+
+void CheckPoints(const std::vector<PlyPoint>& points1,
+                 const std::vector<PlyPoint>& points2, const bool check_normal,
+                 const bool check_rgb) {
+  BOOST_REQUIRE_EQUAL(points1.size(), points2.size());
+  for (size_t i = 0; i < points1.size(); ++i) {
+    BOOST_CHECK_EQUAL(points1[i].x, points2[i].x);
+    BOOST_CHECK_EQUAL(points1[i].y, points2[i].y);
+    BOOST_CHECK_EQUAL(points1[i].z, points2[i].z);
+    if (check_normal) {
+      BOOST_CHECK_EQUAL(points1[i].nx, points2[i].nx);
+      BOOST_CHECK_EQUAL(points1[i].ny, points2[i].ny);
+      BOOST_CHECK_EQUAL(points1[i].nz, points2[i].nz);
+    } else {
+      BOOST_CHECK_EQUAL(points2[i].nx, 0.0f);
+      BOOST_CHECK_EQUAL(points2[i].ny, 0.0f);
+      BOOST_CHECK_EQUAL(points2[i].nz, 0.0f);
+    }
+    if (check_rgb) {
+      BOOST_CHECK_EQUAL(points1[i].r, points2[i].r);
+      BOOST_CHECK_EQUAL(points1[i].g, points2[i].g);
+      BOOST_CHECK_EQUAL(points1[i].b, points2[i].b);
+    } else {
+      BOOST_CHECK_EQUAL(points2[i].r, 0);
+      BOOST_CHECK_EQUAL(points2[i].g, 0);
+      BOOST_CHECK_EQUAL(points2[i].b, 0);
+    }
+  }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(TestBinaryPlyPoints) {
+  const std::string path = GetTempPlyPath();
+  // Spans multiple read tasks and write blocks.
+  const std::vector<PlyPoint> points = GeneratePoints(200000);
+  for (const bool write_normal : {true, false}) {
+    for (const bool write_rgb : {true, false}) {
+      WriteBinaryPlyPoints(path, points, write_normal, write_rgb);
+      CheckPoints(points, ReadPly(path), write_normal, write_rgb);
+    }
+  }
+  boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(TestBinaryPlyPointsWriter) {
+  const std::string path = GetTempPlyPath();
+  const std::vector<PlyPoint> points = GeneratePoints(100);
+  {
+    BinaryPlyPointsWriter writer(path);
+    writer.Write({points.begin(), points.begin() + 40});
+    writer.Write({points.begin() + 40, points.end()});
+    BOOST_CHECK_EQUAL(writer.NumPoints(), points.size());
+  }
+  CheckPoints(points, ReadPly(path), true, true);
+  boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(TestTextPlyPoints) {
+  const std::string path = GetTempPlyPath();
+  const std::vector<PlyPoint> points = GeneratePoints(1000);
+  for (const bool write_normal : {true, false}) {
+    for (const bool write_rgb : {true, false}) {
+      WriteTextPlyPoints(path, points, write_normal, write_rgb);
+      CheckPoints(points, ReadPly(path), write_normal, write_rgb);
+    }
+  }
+  boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(TestTextPlyPointsExtraProperties) {
+  const std::string path = GetTempPlyPath();
+  {
+    std::ofstream file(path);
+    file << "ply\n"
+         << "format ascii 1.0\n"
+         << "element vertex 2\n"
+         << "property float z\n"
+         << "property float confidence\n"
+         << "property float x\n"
+         << "property float y\n"
+         << "end_header\n"
+         << "3 0.5 1 2\n"
+         << "\n"
+         << "6\t0.5  4 5\r\n";
+  }
+  const std::vector<PlyPoint> points = ReadPly(path);
+  BOOST_REQUIRE_EQUAL(points.size(), 2);
+  BOOST_CHECK_EQUAL(points[0].x, 1);
+  BOOST_CHECK_EQUAL(points[0].y, 2);
+  BOOST_CHECK_EQUAL(points[0].z, 3);
+  BOOST_CHECK_EQUAL(points[1].x, 4);
+  BOOST_CHECK_EQUAL(points[1].y, 5);
+  BOOST_CHECK_EQUAL(points[1].z, 6);
+  boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(TestBinaryPlyMeshWriter) {
+  PlyMesh mesh1;
+  mesh1.vertices = {PlyMeshVertex(0, 0, 0), PlyMeshVertex(1, 0, 0),
+                    PlyMeshVertex(0, 1, 0)};
+  mesh1.faces = {PlyMeshFace(0, 1, 2)};
+  PlyMesh mesh2;
+  mesh2.vertices = {PlyMeshVertex(1, 1, 0), PlyMeshVertex(2, 1, 0),
+                    PlyMeshVertex(1, 2, 0), PlyMeshVertex(2, 2, 0)};
+  mesh2.faces = {PlyMeshFace(0, 1, 2), PlyMeshFace(2, 1, 3)};
+
+  PlyMesh merged_mesh = mesh1;
+  for (const auto& vertex : mesh2.vertices) {
+    merged_mesh.vertices.push_back(vertex);
+  }
+  for (const auto& face : mesh2.faces) {
+    merged_mesh.faces.emplace_back(face.vertex_idx1 + 3, face.vertex_idx2 + 3,
+                                   face.vertex_idx3 + 3);
+  }
+
+  const std::string path = GetTempPlyPath();
+  const std::string merged_path = GetTempPlyPath();
+  {
+    BinaryPlyMeshWriter writer(path);
+    writer.Write(mesh1);
+    writer.Write(PlyMesh());
+    writer.Write(mesh2);
+    BOOST_CHECK_EQUAL(writer.NumVertices(), 7);
+    BOOST_CHECK_EQUAL(writer.NumFaces(), 3);
+  }
+  WriteBinaryPlyMesh(merged_path, merged_mesh);
+  BOOST_CHECK(!boost::filesystem::exists(path + ".faces"));
+
+  // The header only differs in the zero-padding of the element counts.
+  const auto ReadFile = [](const std::string& path, size_t* num_vertices,
+                           size_t* num_faces) {
+    std::ifstream file(path, std::ios::binary);
+    std::string line;
+    while (std::getline(file, line) && line != "end_header") {
+      std::istringstream line_stream(line);
+      std::string keyword;
+      std::string element;
+      line_stream >> keyword >> element;
+      if (keyword == "element" && element == "vertex") {
+        line_stream >> *num_vertices;
+      } else if (keyword == "element" && element == "face") {
+        line_stream >> *num_faces;
+      }
+    }
+    return std::string(std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>());
+  };
+
+  size_t num_vertices = 0;
+  size_t num_faces = 0;
+  const std::string data = ReadFile(path, &num_vertices, &num_faces);
+  BOOST_CHECK_EQUAL(num_vertices, 7);
+  BOOST_CHECK_EQUAL(num_faces, 3);
+  size_t merged_num_vertices = 0;
+  size_t merged_num_faces = 0;
+  const std::string merged_data =
+      ReadFile(merged_path, &merged_num_vertices, &merged_num_faces);
+  BOOST_CHECK_EQUAL(merged_num_vertices, 7);
+  BOOST_CHECK_EQUAL(merged_num_faces, 3);
+  BOOST_CHECK(data == merged_data);
+
+  boost::filesystem::remove(path);
+  boost::filesystem::remove(merged_path);
+}
@@ -0,0 +1,265 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "util/profiling.h"
+
+#include <fstream>
+#include <map>
+
+#include "util/logging.h"
+#include "util/misc.h"
+#include "util/threading.h"
+
+namespace colmap {
+namespace {
+
+// Interval, in which the values of counters are sampled for the trace.
+const int64_t kCounterSampleIntervalUs = 1000;
+
+// Consecutive index of the calling thread in the order of first use.
+int GetProfileThreadIndex() {
+  static std::atomic<int> next_thread_index(0);
+  thread_local int thread_index = -1;
+  if (thread_index == -1) {
+    thread_index = next_thread_index++;
+  }
+  return thread_index;
+}
+
+std::string EscapeJSON(const std::string& str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for (const char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      escaped += ' ';
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+std::string kProfilePath = "";
+
+Profiler& Profiler::Get() {
+  static Profiler profiler;
+  return profiler;
+}
+
+Profiler::Profiler() : enabled_(false), counting_enabled_(false) {
+  timer_.Start();
+}
+
+void Profiler::Enable() {
+  enabled_ = true;
+  counting_enabled_ = true;
+}
+
+void Profiler::EnableCounters() { counting_enabled_ = true; }
+
+void Profiler::Disable() {
+  enabled_ = false;
+  counting_enabled_ = false;
+}
+
+void Profiler::Reset() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  scopes_.clear();
+  counters_.clear();
+  counter_samples_.clear();
+  timer_.Restart();
+}
+
+int64_t Profiler::ElapsedMicroSeconds() const {
+  return static_cast<int64_t>(timer_.ElapsedMicroSeconds());
+}
+
+void Profiler::AddScope(const std::string& name, const int64_t begin_us,
+                        const int64_t end_us) {
+  Scope scope;
+  scope.name = name;
+  scope.thread_index = GetProfileThreadIndex();
+  scope.begin_us = begin_us;
+  scope.end_us = end_us;
+  std::unique_lock<std::mutex> lock(mutex_);
+  scopes_.push_back(std::move(scope));
+}
+
+void Profiler::AddCount(const std::string& name, const int64_t count) {
+  const int64_t time_us = ElapsedMicroSeconds();
+  std::unique_lock<std::mutex> lock(mutex_);
+  Counter& counter = counters_[name];
+  counter.value += count;
+  if (enabled_ && (counter.last_sample_us < 0 ||
+                   time_us - counter.last_sample_us >=
+                       kCounterSampleIntervalUs)) {
+    counter.last_sample_us = time_us;
+    CounterSample sample;
+    sample.name = name;
+    sample.time_us = time_us;
+    sample.value = counter.value;
+    counter_samples_.push_back(std::move(sample));
+  }
+}
+
+std::vector<Profiler::Scope> Profiler::Scopes() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return scopes_;
+}
+
+int64_t Profiler::Count(const std::string& name) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto counter = counters_.find(name);
+  if (counter == counters_.end()) {
+    return 0;
+  }
+  return counter->second.value;
+}
+
+std::unordered_map<std::string, int64_t> Profiler::Counts() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::unordered_map<std::string, int64_t> counts;
+  counts.reserve(counters_.size());
+  for (const auto& counter : counters_) {
+    counts.emplace(counter.first, counter.second.value);
+  }
+  return counts;
+}
+
+void Profiler::PrintSummary() const {
+  std::map<std::string, std::pair<size_t, int64_t>> scope_times;
+  std::map<std::string, int64_t> counts;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (const auto& scope : scopes_) {
+      auto& scope_time = scope_times[scope.name];
+      scope_time.first += 1;
+      scope_time.second += scope.end_us - scope.begin_us;
+    }
+    for (const auto& counter : counters_) {
+      counts.emplace(counter.first, counter.second.value);
+    }
+  }
+
+  PrintHeading2("Profile");
+  for (const auto& scope_time : scope_times) {
+    std::cout << StringPrintf("  %s: %.3fs (%d calls)",
+                              scope_time.first.c_str(),
+                              scope_time.second.second / 1e6,
+                              static_cast<int>(scope_time.second.first))
+              << std::endl;
+  }
+  for (const auto& count : counts) {
+    std::cout << "  " << count.first << ": " << count.second << std::endl;
+  }
+}
+
+void Profiler::WriteChromeTrace(const std::string& path) const {
+  std::ofstream file(path, std::ios::trunc);
+  CHECK(file.is_open()) << path;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first_event = true;
+  auto BeginEvent = [&]() {
+    if (!first_event) {
+      file << ",";
+    }
+    file << "\n";
+    first_event = false;
+  };
+
+  for (const auto& scope : scopes_) {
+    BeginEvent();
+    file << "{\"name\":\"" << EscapeJSON(scope.name)
+         << "\",\"cat\":\"colmap\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+         << scope.thread_index << ",\"ts\":" << scope.begin_us
+         << ",\"dur\":" << scope.end_us - scope.begin_us << "}";
+  }
+
+  auto WriteCounterSample = [&](const std::string& name, const int64_t time_us,
+                                const int64_t value) {
+    BeginEvent();
+    file << "{\"name\":\"" << EscapeJSON(name)
+         << "\",\"cat\":\"colmap\",\"ph\":\"C\",\"pid\":0,\"ts\":" << time_us
+         << ",\"args\":{\"value\":" << value << "}}";
+  };
+
+  for (const auto& sample : counter_samples_) {
+    WriteCounterSample(sample.name, sample.time_us, sample.value);
+  }
+
+  // Make sure the final value of each counter is contained in the trace.
+  const int64_t time_us = ElapsedMicroSeconds();
+  for (const auto& counter : counters_) {
+    WriteCounterSample(counter.first, time_us, counter.second.value);
+  }
+
+  file << "\n]}\n";
+}
+
+ProfileScope::ProfileScope(const std::string& name)
+    : enabled_(Profiler::Get().IsEnabled()), begin_us_(0) {
+  if (enabled_) {
+    name_ = name;
+    begin_us_ = Profiler::Get().ElapsedMicroSeconds();
+  }
+}
+
+ProfileScope::~ProfileScope() {
+  if (enabled_) {
+    Profiler& profiler = Profiler::Get();
+    profiler.AddScope(name_, begin_us_, profiler.ElapsedMicroSeconds());
+  }
+}
+
+void InitializeProfiling() {
+  if (!kProfilePath.empty()) {
+    Profiler::Get().Enable();
+  }
+}
+
+void FinalizeProfiling() {
+  if (kProfilePath.empty()) {
+    return;
+  }
+  Profiler& profiler = Profiler::Get();
+  profiler.PrintSummary();
+  profiler.WriteChromeTrace(kProfilePath);
+}
+
+}  // namespace colmap
@@ -0,0 +1,175 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_UTIL_PROFILING_H_
+#define COLMAP_SRC_UTIL_PROFILING_H_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "util/timer.h"
+#include "util/types.h"
+
+namespace colmap {
+
+// Path of the trace file, to which the profiler is written at the end of the
+// program. Profiling is enabled if the path is not empty.
+extern std::string kProfilePath;
+
+// Process-wide collector of named scopes and counters, which can be exported
+// in the Chrome trace event format to be inspected in chrome://tracing or
+// https://ui.perfetto.dev. Profiling is disabled by default, in which case
+// recording scopes and counters only costs a single atomic load:
+//
+//    void Foo() {
+//      ProfileScope profile_scope("Foo");
+//      for (...) {
+//        ProfileScope nested_profile_scope("Bar");
+//        ProfileCounter("num_bars", 1);
+//      }
+//    }
+//
+class Profiler {
+ public:
+  struct Scope {
+    std::string name;
+    int thread_index = 0;
+    int64_t begin_us = 0;
+    int64_t end_us = 0;
+  };
+
+  struct CounterSample {
+    std::string name;
+    int64_t time_us = 0;
+    int64_t value = 0;
+  };
+
+  // Access the process-wide profiler.
+  static Profiler& Get();
+
+  // Enable the recording of scopes and counters or only of the counters,
+  // e.g., to monitor a long running program without recording a trace.
+  void Enable();
+  void EnableCounters();
+  void Disable();
+  inline bool IsEnabled() const;
+  inline bool IsCountingEnabled() const;
+
+  // Remove all recorded scopes and counters and restart the clock.
+  void Reset();
+
+  // Elapsed time since the creation or the last reset of the profiler.
+  int64_t ElapsedMicroSeconds() const;
+
+  // Record a scope of the calling thread with the given begin and end times.
+  void AddScope(const std::string& name, const int64_t begin_us,
+                const int64_t end_us);
+
+  // Increment the named counter. If scopes are recorded, the value of each
+  // counter is sampled for the trace at most once per millisecond to bound
+  // the memory consumption.
+  void AddCount(const std::string& name, const int64_t count);
+
+  // Access the recorded scopes and the current counter values.
+  std::vector<Scope> Scopes() const;
+  int64_t Count(const std::string& name) const;
+  std::unordered_map<std::string, int64_t> Counts() const;
+
+  // Print the accumulated time of all scopes grouped by name and the values
+  // of all counters.
+  void PrintSummary() const;
+
+  // Write the recorded scopes and counters as a Chrome trace JSON file.
+  void WriteChromeTrace(const std::string& path) const;
+
+ private:
+  Profiler();
+
+  struct Counter {
+    int64_t value = 0;
+    int64_t last_sample_us = -1;
+  };
+
+  std::atomic<bool> enabled_;
+  std::atomic<bool> counting_enabled_;
+  Timer timer_;
+  mutable std::mutex mutex_;
+  std::vector<Scope> scopes_;
+  std::unordered_map<std::string, Counter> counters_;
+  std::vector<CounterSample> counter_samples_;
+};
+
+// Record the lifetime of the object as a named scope of the calling thread.
+// Scopes can be nested arbitrarily and are only recorded if the profiler was
+// enabled when the scope was created.
+class ProfileScope {
+ public:
+  explicit ProfileScope(const std::string& name);
+  ~ProfileScope();
+
+ private:
+  NON_COPYABLE(ProfileScope)
+
+  const bool enabled_;
+  std::string name_;
+  int64_t begin_us_;
+};
+
+// Increment the named counter of the process-wide profiler, if counting is
+// enabled.
+inline void ProfileCounter(const char* name, const int64_t count);
+
+// Enable the process-wide profiler if `kProfilePath` is set.
+void InitializeProfiling();
+
+// Write the process-wide profiler to `kProfilePath`, if it is set.
+void FinalizeProfiling();
+
+////////////////////////////////////////////////////////////////////////////////
+// Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+bool Profiler::IsEnabled() const { return enabled_; }
+
+bool Profiler::IsCountingEnabled() const { return counting_enabled_; }
+
+void ProfileCounter(const char* name, const int64_t count) {
+  Profiler& profiler = Profiler::Get();
+  if (profiler.IsCountingEnabled()) {
+    profiler.AddCount(name, count);
+  }
+}
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_UTIL_PROFILING_H_
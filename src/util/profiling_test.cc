@@ -0,0 +1,145 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "util/profiling"
+#include "util/testing.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "util/profiling.h"
+#include "util/string.h"
+#include "util/threading.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestDisabled) {
+  Profiler& profiler = Profiler::Get();
+  profiler.Reset();
+  profiler.Disable();
+  BOOST_CHECK(!profiler.IsEnabled());
+  {
+    ProfileScope profile_scope("Scope");
+    ProfileCounter("counter", 1);
+  }
+  BOOST_CHECK_EQUAL(profiler.Scopes().size(), 0);
+  BOOST_CHECK_EQUAL(profiler.Count("counter"), 0);
+  BOOST_CHECK_EQUAL(profiler.Counts().size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestNestedScopes) {
+  Profiler& profiler = Profiler::Get();
+  profiler.Reset();
+  profiler.Enable();
+  {
+    ProfileScope outer_profile_scope("Outer");
+    for (int i = 0; i < 3; ++i) {
+      ProfileScope inner_profile_scope("Inner");
+    }
+  }
+  profiler.Disable();
+
+  const auto scopes = profiler.Scopes();
+  BOOST_CHECK_EQUAL(scopes.size(), 4);
+  BOOST_CHECK_EQUAL(scopes.back().name, "Outer");
+  for (size_t i = 0; i < 3; ++i) {
+    BOOST_CHECK_EQUAL(scopes[i].name, "Inner");
+    BOOST_CHECK_GE(scopes[i].begin_us, scopes.back().begin_us);
+    BOOST_CHECK_LE(scopes[i].end_us, scopes.back().end_us);
+    BOOST_CHECK_LE(scopes[i].begin_us, scopes[i].end_us);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestCounters) {
+  Profiler& profiler = Profiler::Get();
+  profiler.Reset();
+  profiler.Enable();
+
+  ThreadPool thread_pool(4);
+  for (int i = 0; i < 100; ++i) {
+    thread_pool.AddTask([]() {
+      ProfileScope profile_scope("Task");
+      ProfileCounter("counter1", 1);
+      ProfileCounter("counter2", 2);
+    });
+  }
+  thread_pool.Wait();
+  profiler.Disable();
+
+  BOOST_CHECK_EQUAL(profiler.Scopes().size(), 100);
+  BOOST_CHECK_EQUAL(profiler.Count("counter1"), 100);
+  BOOST_CHECK_EQUAL(profiler.Count("counter2"), 200);
+  BOOST_CHECK_EQUAL(profiler.Count("counter3"), 0);
+  const auto counts = profiler.Counts();
+  BOOST_CHECK_EQUAL(counts.size(), 2);
+  BOOST_CHECK_EQUAL(counts.at("counter1"), 100);
+  BOOST_CHECK_EQUAL(counts.at("counter2"), 200);
+}
+
+BOOST_AUTO_TEST_CASE(TestWriteChromeTrace) {
+  Profiler& profiler = Profiler::Get();
+  profiler.Reset();
+  profiler.Enable();
+  {
+    ProfileScope profile_scope("Scope \"with\" quotes");
+    ProfileCounter("counter", 3);
+  }
+  profiler.Disable();
+
+  const std::string path = "test_profiling.json";
+  profiler.WriteChromeTrace(path);
+
+  std::ifstream file(path);
+  BOOST_CHECK(file.is_open());
+  std::stringstream trace;
+  trace << file.rdbuf();
+  const std::string trace_str = trace.str();
+  BOOST_CHECK(StringStartsWith(trace_str, "{\"displayTimeUnit\":\"ms\""));
+  BOOST_CHECK(StringContains(trace_str, "Scope \\\"with\\\" quotes"));
+  BOOST_CHECK(StringContains(trace_str, "\"ph\":\"X\""));
+  BOOST_CHECK(StringContains(trace_str, "\"ph\":\"C\""));
+  BOOST_CHECK(StringContains(trace_str, "\"args\":{\"value\":3}"));
+}
+
+BOOST_AUTO_TEST_CASE(TestCountersOnly) {
+  Profiler& profiler = Profiler::Get();
+  profiler.Reset();
+  profiler.EnableCounters();
+  BOOST_CHECK(!profiler.IsEnabled());
+  BOOST_CHECK(profiler.IsCountingEnabled());
+  {
+    ProfileScope profile_scope("Scope");
+    ProfileCounter("counter", 2);
+  }
+  profiler.Disable();
+  BOOST_CHECK(!profiler.IsCountingEnabled());
+  BOOST_CHECK_EQUAL(profiler.Scopes().size(), 0);
+  BOOST_CHECK_EQUAL(profiler.Count("counter"), 2);
+}
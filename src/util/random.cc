@@ -33,20 +33,32 @@
 
 namespace colmap {
 
-thread_local std::mt19937* PRNG = nullptr;
+thread_local PCG32* PRNG = nullptr;
+
+int kDefaultPRNGSeed = 0;
+
+bool kDeterministic = false;
 
 void SetPRNGSeed(unsigned seed) {
   // Avoid race conditions, especially for srand().
   static std::mutex mutex;
   std::unique_lock<std::mutex> lock(mutex);
 
-  // Overwrite existing PRNG
-  if (PRNG != nullptr) {
-    delete PRNG;
+  // Reseed the existing PRNG in place, which may be owned by a scoped stream.
+  if (PRNG == nullptr) {
+    PRNG = new PCG32(seed);
+  } else {
+    *PRNG = PCG32(seed);
   }
 
-  PRNG = new std::mt19937(seed);
   srand(seed);
 }
 
+ScopedPRNGStream::ScopedPRNGStream(const uint64_t stream, const unsigned seed)
+    : prng_(seed, stream), prev_prng_(PRNG) {
+  PRNG = &prng_;
+}
+
+ScopedPRNGStream::~ScopedPRNGStream() { PRNG = prev_prng_; }
+
 }  // namespace colmap
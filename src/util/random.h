@@ -33,17 +33,55 @@
 #define COLMAP_SRC_UTIL_RANDOM_H_
 
 #include <chrono>
+#include <cstdint>
+#include <limits>
 #include <random>
 #include <thread>
 
 #include "util/logging.h"
 #include "util/threading.h"
+#include "util/types.h"
 
 namespace colmap {
 
-extern thread_local std::mt19937* PRNG;
+// Permuted congruential generator (PCG32, XSH-RR variant) by Melissa O'Neill.
+// It has a 64-bit state, is much cheaper to seed and to advance than the
+// Mersenne Twister, and supports 2^63 independent streams for the same seed.
+// The class satisfies the requirements of a uniform random bit generator, such
+// that it can be used with the distributions of the standard library.
+class PCG32 {
+ public:
+  typedef uint32_t result_type;
 
-static int kDefaultPRNGSeed = 0;
+  explicit PCG32(const uint64_t seed = 0, const uint64_t stream = 0);
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()();
+
+  // Generate an unbiased random integer in the range [0, bound) with Lemire's
+  // multiply-shift method, which mostly avoids an expensive division.
+  uint32_t Bounded(const uint32_t bound);
+
+ private:
+  uint64_t state_;
+  uint64_t inc_;
+};
+
+extern thread_local PCG32* PRNG;
+
+// The seed of the PRNG and of all scoped random streams, which is shared by
+// all translation units, such that it can be changed through the options.
+extern int kDefaultPRNGSeed;
+
+// Whether the parallel stages produce the same results regardless of the
+// number of threads and the scheduling of the threads. The stages still run in
+// parallel, but commit their results in a fixed order, which can reduce their
+// throughput, e.g., results are buffered until all previous results arrived.
+extern bool kDeterministic;
 
 // Initialize the PRNG with the given seed.
 //
@@ -51,6 +89,28 @@ static int kDefaultPRNGSeed = 0;
 //               is used as the seed.
 void SetPRNGSeed(unsigned seed = kDefaultPRNGSeed);
 
+// Use an independent random stream in the current thread during the lifetime
+// of this object, after which the previous PRNG of the thread is restored.
+// Parallel tasks that derive their stream from a task-specific identifier,
+// e.g., an image or image pair identifier, produce the same random numbers
+// regardless of the number of threads and the order of execution.
+//
+// @param stream   The identifier of the stream.
+// @param seed     The seed shared by all streams of a job.
+class ScopedPRNGStream {
+ public:
+  explicit ScopedPRNGStream(const uint64_t stream,
+                            const unsigned seed = kDefaultPRNGSeed);
+  ~ScopedPRNGStream();
+
+ private:
+  NON_COPYABLE(ScopedPRNGStream)
+  NON_MOVABLE(ScopedPRNGStream)
+
+  PCG32 prng_;
+  PCG32* prev_prng_;
+};
+
 // Generate uniformly distributed random integer number.
 //
 // This implementation is unbiased and thread-safe in contrast to `rand()`.
@@ -72,8 +132,7 @@ T RandomGaussian(const T mean, const T stddev);
 // Fisher-Yates shuffling.
 //
 // Note that the vector may not contain more values than UINT32_MAX. This
-// restriction comes from the fact that the 32-bit version of the
-// Mersenne Twister PRNG is significantly faster.
+// restriction comes from the fact that the PRNG generates 32-bit values.
 //
 // @param elems            Vector of elements to shuffle.
 // @param num_to_shuffle   Optional parameter, specifying the number of first
@@ -85,6 +144,35 @@ void Shuffle(const uint32_t num_to_shuffle, std::vector<T>* elems);
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
 
+inline PCG32::PCG32(const uint64_t seed, const uint64_t stream)
+    : state_(0), inc_((stream << 1u) | 1u) {
+  operator()();
+  state_ += seed;
+  operator()();
+}
+
+inline PCG32::result_type PCG32::operator()() {
+  const uint64_t old_state = state_;
+  state_ = old_state * 6364136223846793005ULL + inc_;
+  const uint32_t xorshifted =
+      static_cast<uint32_t>(((old_state >> 18u) ^ old_state) >> 27u);
+  const uint32_t rot = static_cast<uint32_t>(old_state >> 59u);
+  return (xorshifted >> rot) | (xorshifted << ((~rot + 1u) & 31u));
+}
+
+inline uint32_t PCG32::Bounded(const uint32_t bound) {
+  uint64_t product = static_cast<uint64_t>(operator()()) * bound;
+  uint32_t low = static_cast<uint32_t>(product);
+  if (low < bound) {
+    const uint32_t threshold = (~bound + 1u) % bound;
+    while (low < threshold) {
+      product = static_cast<uint64_t>(operator()()) * bound;
+      low = static_cast<uint32_t>(product);
+    }
+  }
+  return static_cast<uint32_t>(product >> 32);
+}
+
 template <typename T>
 T RandomInteger(const T min, const T max) {
   if (PRNG == nullptr) {
@@ -120,9 +208,13 @@ T RandomGaussian(const T mean, const T stddev) {
 template <typename T>
 void Shuffle(const uint32_t num_to_shuffle, std::vector<T>* elems) {
   CHECK_LE(num_to_shuffle, elems->size());
-  const uint32_t last_idx = static_cast<uint32_t>(elems->size() - 1);
+  if (PRNG == nullptr) {
+    SetPRNGSeed();
+  }
+
+  const uint32_t num_elems = static_cast<uint32_t>(elems->size());
   for (uint32_t i = 0; i < num_to_shuffle; ++i) {
-    const auto j = RandomInteger<uint32_t>(i, last_idx);
+    const uint32_t j = i + PRNG->Bounded(num_elems - i);
     std::swap((*elems)[i], (*elems)[j]);
   }
 }
@@ -129,3 +129,70 @@ BOOST_AUTO_TEST_CASE(TestShuffleAll) {
   }
   BOOST_CHECK_GT(num_shuffled, 0);
 }
+
+BOOST_AUTO_TEST_CASE(TestPCG32) {
+  // Reference values of the PCG32 demo program for seed 42 and stream 54.
+  PCG32 prng(42, 54);
+  BOOST_CHECK_EQUAL(prng(), 0xa15c02b7);
+  BOOST_CHECK_EQUAL(prng(), 0x7b47f409);
+  BOOST_CHECK_EQUAL(prng(), 0xba1d3330);
+  BOOST_CHECK_EQUAL(prng(), 0x83d2f293);
+  BOOST_CHECK_EQUAL(prng(), 0xbfa4784b);
+  BOOST_CHECK_EQUAL(prng(), 0xcbed606e);
+}
+
+BOOST_AUTO_TEST_CASE(TestPCG32Bounded) {
+  PCG32 prng;
+  std::vector<int> counts(7, 0);
+  for (size_t i = 0; i < 7000; ++i) {
+    const uint32_t value = prng.Bounded(7);
+    BOOST_CHECK_LT(value, 7);
+    counts[value] += 1;
+  }
+  for (const int count : counts) {
+    BOOST_CHECK_GT(count, 800);
+    BOOST_CHECK_LT(count, 1200);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestScopedPRNGStream) {
+  SetPRNGSeed(0);
+  const int number1 = RandomInteger(0, 10000);
+
+  std::vector<int> stream_numbers1;
+  SetPRNGSeed(0);
+  {
+    ScopedPRNGStream prng_stream(1);
+    for (size_t i = 0; i < 100; ++i) {
+      stream_numbers1.push_back(RandomInteger(0, 10000));
+    }
+  }
+
+  // The PRNG of the thread is not advanced by the stream.
+  BOOST_CHECK_EQUAL(RandomInteger(0, 10000), number1);
+
+  // The stream is independent of the state of the thread.
+  std::vector<int> stream_numbers2;
+  std::thread thread([&stream_numbers2]() {
+    SetPRNGSeed(1);
+    RandomInteger(0, 10000);
+    ScopedPRNGStream prng_stream(1);
+    for (size_t i = 0; i < 100; ++i) {
+      stream_numbers2.push_back(RandomInteger(0, 10000));
+    }
+  });
+  thread.join();
+  BOOST_CHECK_EQUAL_COLLECTIONS(stream_numbers1.begin(), stream_numbers1.end(),
+                                stream_numbers2.begin(),
+                                stream_numbers2.end());
+
+  // Different streams produce different numbers.
+  std::vector<int> stream_numbers3;
+  {
+    ScopedPRNGStream prng_stream(2);
+    for (size_t i = 0; i < 100; ++i) {
+      stream_numbers3.push_back(RandomInteger(0, 10000));
+    }
+  }
+  BOOST_CHECK(stream_numbers1 != stream_numbers3);
+}
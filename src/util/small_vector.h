@@ -0,0 +1,299 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_UTIL_SMALL_VECTOR_H_
+#define COLMAP_SRC_UTIL_SMALL_VECTOR_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+namespace colmap {
+
+// Sequence container for trivially copyable values, which stores up to
+// `kNumInlineValues` values inside the container itself and only allocates
+// memory on the heap for longer sequences. This avoids a separate heap
+// allocation for each of the many short sequences in a reconstruction, such
+// as the elements of the tracks of 3D points. Iterators are plain pointers,
+// which are invalidated whenever the capacity changes or the container is
+// moved or swapped. The container provides the subset of the interface of
+// `std::vector` used throughout the code base.
+template <typename value_t, size_t kNumInlineValues>
+class SmallVector {
+  static_assert(std::is_trivially_copyable<value_t>::value,
+                "Values must be trivially copyable");
+  static_assert(kNumInlineValues > 0, "Inline capacity must be positive");
+
+ public:
+  typedef value_t value_type;
+  typedef size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef value_t& reference;
+  typedef const value_t& const_reference;
+  typedef value_t* pointer;
+  typedef const value_t* const_pointer;
+  typedef value_t* iterator;
+  typedef const value_t* const_iterator;
+
+  SmallVector() : size_(0), capacity_(kNumInlineValues) {}
+
+  explicit SmallVector(const size_t size, const value_t& value = value_t())
+      : SmallVector() {
+    resize(size, value);
+  }
+
+  template <typename input_iterator_t,
+            typename = typename std::enable_if<!std::is_integral<
+                input_iterator_t>::value>::type>
+  SmallVector(const input_iterator_t first, const input_iterator_t last)
+      : SmallVector() {
+    insert(end(), first, last);
+  }
+
+  SmallVector(std::initializer_list<value_t> values)
+      : SmallVector(values.begin(), values.end()) {}
+
+  SmallVector(const SmallVector& other) : SmallVector() {
+    reserve(other.size());
+    insert(end(), other.begin(), other.end());
+  }
+
+  SmallVector(SmallVector&& other) : SmallVector() { swap(other); }
+
+  ~SmallVector() { Deallocate(); }
+
+  SmallVector& operator=(const SmallVector& other) {
+    if (this != &other) {
+      clear();
+      reserve(other.size());
+      insert(end(), other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector&& other) {
+    if (this != &other) {
+      clear();
+      shrink_to_fit();
+      swap(other);
+    }
+    return *this;
+  }
+
+  inline size_t size() const { return size_; }
+  inline bool empty() const { return size_ == 0; }
+  inline size_t capacity() const { return capacity_; }
+
+  // Whether the values are stored inside the container.
+  inline bool is_inline() const { return capacity_ == kNumInlineValues; }
+
+  inline value_t* data() {
+    return is_inline() ? reinterpret_cast<value_t*>(storage_.inline_values)
+                       : storage_.values;
+  }
+  inline const value_t* data() const {
+    return is_inline()
+               ? reinterpret_cast<const value_t*>(storage_.inline_values)
+               : storage_.values;
+  }
+
+  inline iterator begin() { return data(); }
+  inline iterator end() { return data() + size_; }
+  inline const_iterator begin() const { return data(); }
+  inline const_iterator end() const { return data() + size_; }
+  inline const_iterator cbegin() const { return begin(); }
+  inline const_iterator cend() const { return end(); }
+
+  inline value_t& operator[](const size_t idx) { return data()[idx]; }
+  inline const value_t& operator[](const size_t idx) const {
+    return data()[idx];
+  }
+
+  inline value_t& at(const size_t idx) {
+    CheckIndex(idx);
+    return data()[idx];
+  }
+  inline const value_t& at(const size_t idx) const {
+    CheckIndex(idx);
+    return data()[idx];
+  }
+
+  inline value_t& front() { return data()[0]; }
+  inline const value_t& front() const { return data()[0]; }
+  inline value_t& back() { return data()[size_ - 1]; }
+  inline const value_t& back() const { return data()[size_ - 1]; }
+
+  inline void push_back(const value_t& value) {
+    if (size_ == capacity_) {
+      // The value might be an element of this container.
+      const value_t copy = value;
+      Grow(size_ + 1);
+      data()[size_++] = copy;
+    } else {
+      data()[size_++] = value;
+    }
+  }
+
+  template <typename... args_t>
+  inline void emplace_back(args_t&&... args) {
+    push_back(value_t(std::forward<args_t>(args)...));
+  }
+
+  inline void pop_back() { size_ -= 1; }
+
+  // Insert the values of the range before the given position. The range must
+  // not overlap with this container.
+  template <typename input_iterator_t>
+  iterator insert(const_iterator pos, const input_iterator_t first,
+                  const input_iterator_t last) {
+    const size_t offset = pos - begin();
+    const size_t num_values = std::distance(first, last);
+    if (size_ + num_values > capacity_) {
+      Grow(size_ + num_values);
+    }
+    value_t* values = data();
+    std::memmove(values + offset + num_values, values + offset,
+                 (size_ - offset) * sizeof(value_t));
+    std::copy(first, last, values + offset);
+    size_ += static_cast<uint32_t>(num_values);
+    return values + offset;
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    value_t* values = data();
+    const size_t offset = first - values;
+    const size_t num_values = last - first;
+    std::memmove(values + offset, values + offset + num_values,
+                 (size_ - offset - num_values) * sizeof(value_t));
+    size_ -= static_cast<uint32_t>(num_values);
+    return values + offset;
+  }
+
+  void clear() { size_ = 0; }
+
+  void resize(const size_t size, const value_t& value = value_t()) {
+    if (size > capacity_) {
+      Grow(size);
+    }
+    std::fill(data() + std::min<size_t>(size_, size), data() + size, value);
+    size_ = static_cast<uint32_t>(size);
+  }
+
+  void reserve(const size_t capacity) {
+    if (capacity > capacity_) {
+      Reallocate(capacity);
+    }
+  }
+
+  // Move the values back inside the container, if they fit, or otherwise
+  // reduce the allocated memory to the number of values.
+  void shrink_to_fit() {
+    if (!is_inline() && size_ < capacity_) {
+      Reallocate(size_);
+    }
+  }
+
+  void swap(SmallVector& other) {
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(storage_, other.storage_);
+  }
+
+  bool operator==(const SmallVector& other) const {
+    return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+  }
+
+  bool operator!=(const SmallVector& other) const { return !(*this == other); }
+
+ private:
+  inline void CheckIndex(const size_t idx) const {
+    if (idx >= size_) {
+      throw std::out_of_range("SmallVector index out of range");
+    }
+  }
+
+  // Grow the capacity geometrically to amortize the cost of appending.
+  void Grow(const size_t min_capacity) {
+    Reallocate(std::max<size_t>(min_capacity, 2 * capacity_));
+  }
+
+  // Move the values into storage with the given capacity, which is inline if
+  // the capacity does not exceed the inline capacity.
+  void Reallocate(const size_t capacity) {
+    if (capacity <= kNumInlineValues) {
+      if (!is_inline()) {
+        value_t* values = storage_.values;
+        std::memcpy(storage_.inline_values, values, size_ * sizeof(value_t));
+        std::free(values);
+        capacity_ = kNumInlineValues;
+      }
+      return;
+    }
+
+    value_t* values =
+        static_cast<value_t*>(std::malloc(capacity * sizeof(value_t)));
+    if (values == nullptr) {
+      throw std::bad_alloc();
+    }
+    std::memcpy(values, data(), size_ * sizeof(value_t));
+    Deallocate();
+    storage_.values = values;
+    capacity_ = static_cast<uint32_t>(capacity);
+  }
+
+  void Deallocate() {
+    if (!is_inline()) {
+      std::free(storage_.values);
+    }
+  }
+
+  // The values are stored inline, if the capacity equals the inline capacity,
+  // and otherwise in the heap allocated array.
+  union Storage {
+    alignas(value_t) char inline_values[kNumInlineValues * sizeof(value_t)];
+    value_t* values;
+  };
+
+  uint32_t size_;
+  uint32_t capacity_;
+  Storage storage_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_UTIL_SMALL_VECTOR_H_
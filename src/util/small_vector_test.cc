@@ -0,0 +1,136 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "util/small_vector"
+#include "util/testing.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "util/small_vector.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestEmpty) {
+  SmallVector<int, 2> vector;
+  BOOST_CHECK_EQUAL(vector.size(), 0);
+  BOOST_CHECK(vector.empty());
+  BOOST_CHECK_EQUAL(vector.capacity(), 2);
+  BOOST_CHECK(vector.is_inline());
+  BOOST_CHECK(vector.begin() == vector.end());
+  BOOST_CHECK_THROW(vector.at(0), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(TestPushBack) {
+  SmallVector<int, 2> vector;
+  vector.push_back(0);
+  vector.emplace_back(1);
+  BOOST_CHECK_EQUAL(vector.size(), 2);
+  BOOST_CHECK(vector.is_inline());
+  vector.push_back(vector[0]);
+  BOOST_CHECK_EQUAL(vector.size(), 3);
+  BOOST_CHECK(!vector.is_inline());
+  BOOST_CHECK_GE(vector.capacity(), 3);
+  for (int i = 3; i < 100; ++i) {
+    vector.push_back(i);
+  }
+  BOOST_CHECK_EQUAL(vector.size(), 100);
+  BOOST_CHECK_EQUAL(vector.front(), 0);
+  BOOST_CHECK_EQUAL(vector.at(1), 1);
+  BOOST_CHECK_EQUAL(vector[2], 0);
+  for (int i = 3; i < 100; ++i) {
+    BOOST_CHECK_EQUAL(vector[i], i);
+  }
+  BOOST_CHECK_EQUAL(vector.back(), 99);
+  vector.pop_back();
+  BOOST_CHECK_EQUAL(vector.back(), 98);
+}
+
+BOOST_AUTO_TEST_CASE(TestInsertErase) {
+  const std::vector<int> values = {1, 2, 3, 4};
+  SmallVector<int, 4> vector = {0, 5};
+  vector.insert(vector.begin() + 1, values.begin(), values.end());
+  BOOST_CHECK_EQUAL(vector.size(), 6);
+  for (int i = 0; i < 6; ++i) {
+    BOOST_CHECK_EQUAL(vector[i], i);
+  }
+  vector.erase(vector.begin());
+  vector.erase(vector.begin() + 2, vector.begin() + 4);
+  BOOST_CHECK_EQUAL(vector.size(), 3);
+  BOOST_CHECK_EQUAL(vector[0], 1);
+  BOOST_CHECK_EQUAL(vector[1], 2);
+  BOOST_CHECK_EQUAL(vector[2], 5);
+  vector.erase(std::remove(vector.begin(), vector.end(), 2), vector.end());
+  BOOST_CHECK_EQUAL(vector.size(), 2);
+  BOOST_CHECK_EQUAL(vector[0], 1);
+  BOOST_CHECK_EQUAL(vector[1], 5);
+  vector.clear();
+  BOOST_CHECK(vector.empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestReserveShrinkToFit) {
+  SmallVector<int, 2> vector;
+  vector.reserve(1);
+  BOOST_CHECK_EQUAL(vector.capacity(), 2);
+  vector.reserve(10);
+  BOOST_CHECK_EQUAL(vector.capacity(), 10);
+  vector.resize(4, 7);
+  BOOST_CHECK_EQUAL(vector.size(), 4);
+  BOOST_CHECK_EQUAL(vector[3], 7);
+  vector.shrink_to_fit();
+  BOOST_CHECK_EQUAL(vector.capacity(), 4);
+  vector.resize(1);
+  vector.shrink_to_fit();
+  BOOST_CHECK_EQUAL(vector.capacity(), 2);
+  BOOST_CHECK(vector.is_inline());
+  BOOST_CHECK_EQUAL(vector[0], 7);
+}
+
+BOOST_AUTO_TEST_CASE(TestCopyMove) {
+  for (const int size : {1, 10}) {
+    SmallVector<int, 2> vector(size, 3);
+    SmallVector<int, 2> copy(vector);
+    BOOST_CHECK(copy == vector);
+    BOOST_CHECK(copy.data() != vector.data());
+    SmallVector<int, 2> assigned;
+    assigned = vector;
+    BOOST_CHECK(assigned == vector);
+    SmallVector<int, 2> moved(std::move(copy));
+    BOOST_CHECK(moved == vector);
+    BOOST_CHECK(copy.empty());
+    SmallVector<int, 2> move_assigned = {1, 2, 3};
+    move_assigned = std::move(moved);
+    BOOST_CHECK(move_assigned == vector);
+    BOOST_CHECK(moved.empty());
+    move_assigned.swap(assigned);
+    BOOST_CHECK(move_assigned == vector);
+    BOOST_CHECK(assigned == vector);
+  }
+}
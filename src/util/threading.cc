@@ -31,9 +31,45 @@
 
 #include "util/threading.h"
 
+#include <fstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include "util/logging.h"
+#include "util/string.h"
 
 namespace colmap {
+namespace {
+
+// Parse a list of processors or nodes in the format of the Linux sysfs, e.g.,
+// "0-3,8-11,16".
+std::vector<int> ParseSysfsList(const std::string& list) {
+  std::vector<int> values;
+  for (const auto& range : StringSplit(list, ",")) {
+    const auto bounds = StringSplit(range, "-");
+    if (bounds.size() == 1 && !bounds[0].empty()) {
+      values.push_back(std::stoi(bounds[0]));
+    } else if (bounds.size() == 2) {
+      for (int value = std::stoi(bounds[0]); value <= std::stoi(bounds[1]);
+           ++value) {
+        values.push_back(value);
+      }
+    }
+  }
+  return values;
+}
+
+std::string ReadSysfsFile(const std::string& path) {
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+}  // namespace
 
 Thread::Thread()
     : started_(false),
@@ -42,7 +78,8 @@ Thread::Thread()
       pausing_(false),
       finished_(false),
       setup_(false),
-      setup_valid_(false) {
+      setup_valid_(false),
+      numa_node_(-1) {
   RegisterCallback(STARTED_CALLBACK);
   RegisterCallback(FINISHED_CALLBACK);
 }
@@ -172,7 +209,15 @@ bool Thread::CheckValidSetup() {
   return setup_valid_;
 }
 
+void Thread::SetNumaNode(const int numa_node) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  numa_node_ = numa_node;
+}
+
 void Thread::RunFunc() {
+  if (numa_node_ >= 0) {
+    BindThreadToNumaNode(numa_node_);
+  }
   Callback(STARTED_CALLBACK);
   Run();
   {
@@ -183,12 +228,14 @@ void Thread::RunFunc() {
   Callback(FINISHED_CALLBACK);
 }
 
-ThreadPool::ThreadPool(const int num_threads)
+ThreadPool::ThreadPool(const int num_threads, const bool numa_aware)
     : stopped_(false), num_active_workers_(0) {
   const int num_effective_threads = GetEffectiveNumThreads(num_threads);
   for (int index = 0; index < num_effective_threads; ++index) {
+    const int numa_node =
+        numa_aware ? GetNumaNodeOfThread(index, num_effective_threads) : -1;
     std::function<void(void)> worker =
-        std::bind(&ThreadPool::WorkerFunc, this, index);
+        std::bind(&ThreadPool::WorkerFunc, this, index, numa_node);
     workers_.emplace_back(worker);
   }
 }
@@ -226,7 +273,11 @@ void ThreadPool::Wait() {
   }
 }
 
-void ThreadPool::WorkerFunc(const int index) {
+void ThreadPool::WorkerFunc(const int index, const int numa_node) {
+  if (numa_node >= 0) {
+    BindThreadToNumaNode(numa_node);
+  }
+
   {
     std::lock_guard<std::mutex> lock(mutex_);
     thread_id_to_index_.emplace(GetThreadId(), index);
@@ -266,6 +317,78 @@ int ThreadPool::GetThreadIndex() {
   return thread_id_to_index_.at(GetThreadId());
 }
 
+void ParallelFor(const size_t begin, const size_t end,
+                 const std::function<void(size_t)>& func,
+                 const int num_threads) {
+  if (begin >= end) {
+    return;
+  }
+
+  const size_t num_iters = end - begin;
+  const size_t num_eff_threads = std::min(
+      num_iters, static_cast<size_t>(GetEffectiveNumThreads(num_threads)));
+
+  if (num_eff_threads == 1) {
+    for (size_t i = begin; i < end; ++i) {
+      func(i);
+    }
+    return;
+  }
+
+  // Use multiple chunks per thread for better load balancing.
+  const size_t kNumChunksPerThread = 4;
+  const size_t chunk_size =
+      std::max<size_t>(1, num_iters / (kNumChunksPerThread * num_eff_threads));
+
+  // The state is shared with the workers, since they might only start after
+  // this function returned, when all iterations were processed by others.
+  struct State {
+    std::atomic<size_t> next_iter;
+    size_t num_finished_iters = 0;
+    std::mutex mutex;
+    std::condition_variable finished_condition;
+  };
+
+  auto state = std::make_shared<State>();
+  state->next_iter = begin;
+
+  // The function is only accessed while there are unfinished iterations.
+  const std::function<void(size_t)>* func_ptr = &func;
+  auto ProcessChunks = [state, func_ptr, end, chunk_size, num_iters]() {
+    size_t num_processed_iters = 0;
+    while (true) {
+      const size_t chunk_begin = state->next_iter.fetch_add(chunk_size);
+      if (chunk_begin >= end) {
+        break;
+      }
+      const size_t chunk_end = std::min(end, chunk_begin + chunk_size);
+      for (size_t i = chunk_begin; i < chunk_end; ++i) {
+        (*func_ptr)(i);
+      }
+      num_processed_iters += chunk_end - chunk_begin;
+    }
+
+    if (num_processed_iters > 0) {
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->num_finished_iters += num_processed_iters;
+      if (state->num_finished_iters == num_iters) {
+        state->finished_condition.notify_all();
+      }
+    }
+  };
+
+  static ThreadPool thread_pool(ThreadPool::kMaxNumThreads);
+  for (size_t i = 1; i < num_eff_threads; ++i) {
+    thread_pool.AddTask(ProcessChunks);
+  }
+
+  ProcessChunks();
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->finished_condition.wait(
+      lock, [&]() { return state->num_finished_iters == num_iters; });
+}
+
 int GetEffectiveNumThreads(const int num_threads) {
   int num_effective_threads = num_threads;
   if (num_threads <= 0) {
@@ -279,4 +402,50 @@ int GetEffectiveNumThreads(const int num_threads) {
   return num_effective_threads;
 }
 
+const std::vector<int>& GetNumaNodes() {
+  static const std::vector<int> numa_nodes = []() {
+    std::vector<int> nodes;
+#ifdef __linux__
+    nodes = ParseSysfsList(ReadSysfsFile("/sys/devices/system/node/online"));
+#endif
+    if (nodes.empty()) {
+      nodes.push_back(0);
+    }
+    return nodes;
+  }();
+  return numa_nodes;
+}
+
+int GetNumaNodeOfThread(const int thread_idx, const int num_threads) {
+  CHECK_GE(thread_idx, 0);
+  CHECK_LT(thread_idx, num_threads);
+  const std::vector<int>& numa_nodes = GetNumaNodes();
+  const int64_t node_idx =
+      static_cast<int64_t>(thread_idx) * numa_nodes.size() / num_threads;
+  return numa_nodes[node_idx];
+}
+
+bool BindThreadToNumaNode(const int numa_node) {
+#ifdef __linux__
+  const std::vector<int> cpus = ParseSysfsList(ReadSysfsFile(StringPrintf(
+      "/sys/devices/system/node/node%d/cpulist", numa_node)));
+  if (cpus.empty()) {
+    return false;
+  }
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (const int cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpu_set);
+    }
+  }
+
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) ==
+         0;
+#else
+  return false;
+#endif
+}
+
 }  // namespace colmap
@@ -39,7 +39,9 @@
 #include <list>
 #include <queue>
 #include <unordered_map>
+#include <vector>
 
+#include "util/logging.h"
 #include "util/timer.h"
 
 namespace colmap {
@@ -150,6 +152,11 @@ class Thread {
   // Get timing information of the thread, properly accounting for pause times.
   const Timer& GetTimer() const;
 
+  // Bind the thread to the processors of the given NUMA node when it is
+  // started, see `BindThreadToNumaNode`. By default, or for a negative node,
+  // the placement is left to the operating system.
+  void SetNumaNode(const int numa_node);
+
  protected:
   // This is the main run function to be implemented by the child class. If you
   // are looping over data and want to support the pause operation, call
@@ -191,6 +198,8 @@ class Thread {
   bool setup_;
   bool setup_valid_;
 
+  int numa_node_;
+
   std::unordered_map<int, std::list<std::function<void()>>> callbacks_;
 };
 
@@ -209,7 +218,12 @@ class ThreadPool {
  public:
   static const int kMaxNumThreads = -1;
 
-  explicit ThreadPool(const int num_threads = kMaxNumThreads);
+  // If `numa_aware` is set, the workers are distributed evenly over the NUMA
+  // nodes of the system and bound to them, see `GetNumaNodeOfThread`. The
+  // memory first touched by the tasks of a worker, e.g., per-worker buffers,
+  // is then allocated on the node of the worker.
+  explicit ThreadPool(const int num_threads = kMaxNumThreads,
+                      const bool numa_aware = false);
   ~ThreadPool();
 
   inline size_t NumThreads() const;
@@ -234,7 +248,7 @@ class ThreadPool {
   int GetThreadIndex();
 
  private:
-  void WorkerFunc(const int index);
+  void WorkerFunc(const int index, const int numa_node);
 
   std::vector<std::thread> workers_;
   std::queue<std::function<void()>> tasks_;
@@ -277,6 +291,7 @@ class JobQueue {
    public:
     Job() : valid_(false) {}
     explicit Job(const T& data) : data_(data), valid_(true) {}
+    explicit Job(T&& data) : data_(std::move(data)), valid_(true) {}
 
     // Check whether the data is valid.
     bool IsValid() const { return valid_; }
@@ -298,11 +313,17 @@ class JobQueue {
   size_t Size();
 
   // Push a new job to the queue. Waits if the number of jobs is exceeded.
+  // Large jobs should be moved into the queue to avoid copying their data.
   bool Push(const T& data);
+  bool Push(T&& data);
 
   // Pop a job from the queue. Waits if there is no job in the queue.
   Job Pop();
 
+  // Pop up to max_num_jobs jobs from the queue. Waits if there is no job in
+  // the queue and returns an empty vector if the queue was stopped.
+  std::vector<T> PopBatch(const size_t max_num_jobs);
+
   // Wait for all jobs to be popped and then stop the queue.
   void Wait();
 
@@ -326,6 +347,37 @@ class JobQueue {
 // otherwise return the input value of num_threads.
 int GetEffectiveNumThreads(const int num_threads);
 
+// Return the identifiers of the online NUMA nodes of the system. If the
+// topology is unknown, e.g., on other systems than Linux, a single node 0 is
+// returned.
+const std::vector<int>& GetNumaNodes();
+
+// Return the NUMA node of the thread with the given index, when distributing
+// `num_threads` threads evenly over the NUMA nodes in contiguous blocks.
+// Threads with neighboring indices thereby share the same node.
+int GetNumaNodeOfThread(const int thread_idx, const int num_threads);
+
+// Bind the calling thread to the processors of the given NUMA node. With the
+// default first-touch policy of the operating system, memory is then allocated
+// on this node when the thread first writes to it. Returns false if the binding
+// is not supported or failed.
+bool BindThreadToNumaNode(const int numa_node);
+
+// Call func(i) for all i in [begin, end) using up to num_threads threads and
+// return after all calls are finished. The work is distributed in chunks to
+// a process-wide thread pool with one worker per logical CPU core, which is
+// shared by all calls. The calling thread also processes chunks, such that
+// nested calls from within func neither oversubscribe the machine nor
+// deadlock, even if all workers are busy:
+//
+//    ParallelFor(0, 100, [](const size_t i) {
+//      ParallelFor(0, 100, [i](const size_t j) { /* Do some work */ });
+//    });
+//
+void ParallelFor(const size_t begin, const size_t end,
+                 const std::function<void(size_t)>& func,
+                 const int num_threads = ThreadPool::kMaxNumThreads);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////
@@ -375,6 +427,11 @@ size_t JobQueue<T>::Size() {
 
 template <typename T>
 bool JobQueue<T>::Push(const T& data) {
+  return Push(T(data));
+}
+
+template <typename T>
+bool JobQueue<T>::Push(T&& data) {
   std::unique_lock<std::mutex> lock(mutex_);
   while (jobs_.size() >= max_num_jobs_ && !stop_) {
     pop_condition_.wait(lock);
@@ -382,7 +439,7 @@ bool JobQueue<T>::Push(const T& data) {
   if (stop_) {
     return false;
   } else {
-    jobs_.push(data);
+    jobs_.push(std::move(data));
     push_condition_.notify_one();
     return true;
   }
@@ -397,14 +454,38 @@ typename JobQueue<T>::Job JobQueue<T>::Pop() {
   if (stop_) {
     return Job();
   } else {
-    const T data = jobs_.front();
+    Job job(std::move(jobs_.front()));
     jobs_.pop();
     pop_condition_.notify_one();
     if (jobs_.empty()) {
       empty_condition_.notify_all();
     }
-    return Job(data);
+    return job;
+  }
+}
+
+template <typename T>
+std::vector<T> JobQueue<T>::PopBatch(const size_t max_num_jobs) {
+  CHECK_GT(max_num_jobs, 0);
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (jobs_.empty() && !stop_) {
+    push_condition_.wait(lock);
+  }
+  std::vector<T> jobs;
+  if (stop_) {
+    return jobs;
+  }
+  const size_t num_jobs = std::min(max_num_jobs, jobs_.size());
+  jobs.reserve(num_jobs);
+  for (size_t i = 0; i < num_jobs; ++i) {
+    jobs.push_back(std::move(jobs_.front()));
+    jobs_.pop();
+  }
+  pop_condition_.notify_all();
+  if (jobs_.empty()) {
+    empty_condition_.notify_all();
   }
+  return jobs;
 }
 
 template <typename T>
@@ -32,6 +32,8 @@
 #define TEST_NAME "util/threading"
 #include "util/testing.h"
 
+#include <algorithm>
+
 #include "util/logging.h"
 #include "util/threading.h"
 
@@ -878,3 +880,99 @@ BOOST_AUTO_TEST_CASE(TestGetEffectiveNumThreads) {
   BOOST_CHECK_EQUAL(GetEffectiveNumThreads(2), 2);
   BOOST_CHECK_EQUAL(GetEffectiveNumThreads(3), 3);
 }
+
+BOOST_AUTO_TEST_CASE(TestParallelFor) {
+  for (const int num_threads : {-1, 1, 2, 4}) {
+    std::vector<std::atomic<int>> counts(1000);
+    for (auto& count : counts) {
+      count = 0;
+    }
+    ParallelFor(10, counts.size(), [&](const size_t i) { counts[i] += 1; },
+                num_threads);
+    for (size_t i = 0; i < counts.size(); ++i) {
+      BOOST_CHECK_EQUAL(counts[i], i < 10 ? 0 : 1);
+    }
+  }
+
+  ParallelFor(5, 5, [](const size_t) { BOOST_CHECK(false); });
+}
+
+BOOST_AUTO_TEST_CASE(TestParallelForNested) {
+  std::atomic<int> sum(0);
+  ParallelFor(0, 16, [&](const size_t i) {
+    ParallelFor(0, 16, [&](const size_t j) { sum += i * j; }, 4);
+  }, 4);
+  BOOST_CHECK_EQUAL(sum, 120 * 120);
+}
+
+BOOST_AUTO_TEST_CASE(TestJobQueueMoveOnly) {
+  JobQueue<std::unique_ptr<int>> job_queue;
+  BOOST_CHECK(job_queue.Push(std::unique_ptr<int>(new int(1))));
+  std::unique_ptr<int> data(new int(2));
+  BOOST_CHECK(job_queue.Push(std::move(data)));
+  BOOST_CHECK(!data);
+  BOOST_CHECK_EQUAL(job_queue.Size(), 2);
+
+  auto job1 = job_queue.Pop();
+  BOOST_CHECK(job1.IsValid());
+  BOOST_CHECK_EQUAL(*job1.Data(), 1);
+  auto job2 = job_queue.Pop();
+  BOOST_CHECK(job2.IsValid());
+  BOOST_CHECK_EQUAL(*job2.Data(), 2);
+  BOOST_CHECK_EQUAL(job_queue.Size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestJobQueuePopBatch) {
+  JobQueue<int> job_queue(4);
+
+  std::thread producer_thread([&job_queue]() {
+    for (int i = 0; i < 10; ++i) {
+      CHECK(job_queue.Push(i));
+    }
+  });
+
+  std::vector<int> popped;
+  while (popped.size() < 10) {
+    const auto batch = job_queue.PopBatch(3);
+    BOOST_CHECK_GT(batch.size(), 0);
+    BOOST_CHECK_LE(batch.size(), 3);
+    popped.insert(popped.end(), batch.begin(), batch.end());
+  }
+
+  producer_thread.join();
+
+  for (int i = 0; i < 10; ++i) {
+    BOOST_CHECK_EQUAL(popped[i], i);
+  }
+
+  job_queue.Stop();
+  BOOST_CHECK(job_queue.PopBatch(3).empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestNumaNodes) {
+  const std::vector<int>& numa_nodes = GetNumaNodes();
+  BOOST_CHECK_GT(numa_nodes.size(), 0);
+
+  // The threads are distributed in contiguous blocks over all nodes.
+  const int kNumThreads = 7;
+  std::vector<int> thread_numa_nodes;
+  for (int i = 0; i < kNumThreads; ++i) {
+    thread_numa_nodes.push_back(GetNumaNodeOfThread(i, kNumThreads));
+  }
+  BOOST_CHECK(
+      std::is_sorted(thread_numa_nodes.begin(), thread_numa_nodes.end()));
+  BOOST_CHECK_EQUAL(thread_numa_nodes.front(), numa_nodes.front());
+  if (static_cast<int>(numa_nodes.size()) <= kNumThreads) {
+    BOOST_CHECK_EQUAL(thread_numa_nodes.back(), numa_nodes.back());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestThreadPoolNumaAware) {
+  ThreadPool pool(4, /*numa_aware=*/true);
+  std::atomic<int> num_tasks(0);
+  for (int i = 0; i < 100; ++i) {
+    pool.AddTask([&num_tasks]() { num_tasks += 1; });
+  }
+  pool.Wait();
+  BOOST_CHECK_EQUAL(num_tasks, 100);
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "util/thumbnail_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <boost/filesystem.hpp>
+
+#include "util/logging.h"
+#include "util/misc.h"
+#include "util/string.h"
+
+namespace colmap {
+namespace {
+
+// 64-bit FNV-1a hash, which is stable across platforms and runs as opposed
+// to `std::hash`, so that the cached thumbnails remain valid.
+uint64_t HashString(const std::string& str) {
+  uint64_t hash = 14695981039346656037ull;
+  for (const char c : str) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+}  // namespace
+
+ThumbnailCache::ThumbnailCache(const std::string& cache_path,
+                               const int max_image_size)
+    : cache_path_(cache_path), max_image_size_(max_image_size) {
+  CHECK_GT(max_image_size_, 0);
+  boost::filesystem::create_directories(cache_path_);
+}
+
+std::string ThumbnailCache::ThumbnailPath(
+    const std::string& image_path) const {
+  boost::system::error_code error;
+  const auto absolute_path = boost::filesystem::absolute(image_path);
+  const auto file_size = boost::filesystem::file_size(absolute_path, error);
+  if (error) {
+    return "";
+  }
+  const auto write_time =
+      boost::filesystem::last_write_time(absolute_path, error);
+  if (error) {
+    return "";
+  }
+
+  const std::string key = StringPrintf(
+      "%s|%llu|%lld|%d", absolute_path.string().c_str(),
+      static_cast<unsigned long long>(file_size),
+      static_cast<long long>(write_time), max_image_size_);
+
+  return JoinPaths(cache_path_,
+                   StringPrintf("%016llx.jpg", static_cast<unsigned long long>(
+                                                   HashString(key))));
+}
+
+bool ThumbnailCache::Read(const std::string& image_path,
+                          Bitmap* thumbnail) const {
+  CHECK_NOTNULL(thumbnail);
+  const std::string thumbnail_path = ThumbnailPath(image_path);
+  if (thumbnail_path.empty() || !ExistsFile(thumbnail_path)) {
+    return false;
+  }
+  return thumbnail->Read(thumbnail_path, /*as_rgb=*/true);
+}
+
+bool ThumbnailCache::Write(const std::string& image_path,
+                           const Bitmap& bitmap) const {
+  const std::string thumbnail_path = ThumbnailPath(image_path);
+  if (thumbnail_path.empty()) {
+    return false;
+  }
+
+  // Write to a unique temporary file and move it into place, so that
+  // concurrent readers never observe partially written thumbnails.
+  std::random_device random_device;
+  const std::string temp_path =
+      StringPrintf("%s.%08x.tmp", thumbnail_path.c_str(), random_device());
+  if (!CreateThumbnail(bitmap).Write(temp_path, FIF_JPEG, JPEG_QUALITYGOOD)) {
+    boost::filesystem::remove(temp_path);
+    return false;
+  }
+
+  boost::system::error_code error;
+  boost::filesystem::rename(temp_path, thumbnail_path, error);
+  if (error) {
+    boost::filesystem::remove(temp_path, error);
+    return false;
+  }
+
+  return true;
+}
+
+Bitmap ThumbnailCache::CreateThumbnail(const Bitmap& bitmap) const {
+  Bitmap thumbnail = bitmap.CloneAsRGB();
+  const int max_size = std::max(bitmap.Width(), bitmap.Height());
+  if (max_size > max_image_size_) {
+    const double scale = static_cast<double>(max_image_size_) / max_size;
+    thumbnail.Rescale(
+        std::max(1, static_cast<int>(std::round(scale * bitmap.Width()))),
+        std::max(1, static_cast<int>(std::round(scale * bitmap.Height()))));
+  }
+  return thumbnail;
+}
+
+}  // namespace colmap
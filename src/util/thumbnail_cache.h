@@ -0,0 +1,75 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef COLMAP_SRC_UTIL_THUMBNAIL_CACHE_H_
+#define COLMAP_SRC_UTIL_THUMBNAIL_CACHE_H_
+
+#include <string>
+
+#include "util/bitmap.h"
+
+namespace colmap {
+
+// Cache of downscaled images on disk, e.g., to quickly browse large image
+// collections in the GUI without decoding the full resolution images. The
+// thumbnails are keyed by the absolute path, the size, and the modification
+// time of the original image, so that stale thumbnails are never returned
+// after an image changed. Thumbnails are written atomically, such that the
+// cache can be shared by multiple threads and processes.
+class ThumbnailCache {
+ public:
+  // @param cache_path       Directory of the thumbnails, which is created if
+  //                         it does not exist.
+  // @param max_image_size   Maximum width and height of the thumbnails.
+  ThumbnailCache(const std::string& cache_path, const int max_image_size);
+
+  // Path of the cached thumbnail of the given image. Returns an empty string
+  // if the image does not exist.
+  std::string ThumbnailPath(const std::string& image_path) const;
+
+  // Read the cached thumbnail of the given image. Returns false if there is
+  // no up-to-date thumbnail, in which case the image must be decoded.
+  bool Read(const std::string& image_path, Bitmap* thumbnail) const;
+
+  // Downscale the decoded image and write it as the thumbnail of the image at
+  // the given path. The image is not modified.
+  bool Write(const std::string& image_path, const Bitmap& bitmap) const;
+
+  // Create the thumbnail of a decoded image.
+  Bitmap CreateThumbnail(const Bitmap& bitmap) const;
+
+ private:
+  const std::string cache_path_;
+  const int max_image_size_;
+};
+
+}  // namespace colmap
+
+#endif  // COLMAP_SRC_UTIL_THUMBNAIL_CACHE_H_
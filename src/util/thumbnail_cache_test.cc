@@ -0,0 +1,106 @@
+// Copyright (c) 2018, ETH Zurich and UNC Chapel Hill.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of ETH Zurich and UNC Chapel Hill nor the names of
+//       its contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define TEST_NAME "util/thumbnail_cache"
+#include "util/testing.h"
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "util/thumbnail_cache.h"
+
+using namespace colmap;
+
+BOOST_AUTO_TEST_CASE(TestThumbnailPath) {
+  const auto dir = boost::filesystem::temp_directory_path() /
+                   boost::filesystem::unique_path();
+  const std::string cache_path = (dir / "cache").string();
+  const std::string image_path = (dir / "image.jpg").string();
+
+  ThumbnailCache cache(cache_path, 100);
+  BOOST_CHECK(boost::filesystem::is_directory(cache_path));
+  BOOST_CHECK_EQUAL(cache.ThumbnailPath(image_path), "");
+
+  Bitmap thumbnail;
+  BOOST_CHECK(!cache.Read(image_path, &thumbnail));
+
+  {
+    std::ofstream file(image_path);
+    file << "image";
+  }
+
+  const std::string thumbnail_path = cache.ThumbnailPath(image_path);
+  BOOST_CHECK(!thumbnail_path.empty());
+  BOOST_CHECK_EQUAL(cache.ThumbnailPath(image_path), thumbnail_path);
+  BOOST_CHECK(!cache.Read(image_path, &thumbnail));
+
+  // The thumbnails of other sizes are cached separately.
+  ThumbnailCache other_cache(cache_path, 200);
+  BOOST_CHECK_NE(other_cache.ThumbnailPath(image_path), thumbnail_path);
+
+  // Modified images invalidate the thumbnail.
+  boost::filesystem::last_write_time(
+      image_path, boost::filesystem::last_write_time(image_path) + 10);
+  BOOST_CHECK_NE(cache.ThumbnailPath(image_path), thumbnail_path);
+
+  {
+    std::ofstream file(image_path, std::ios::app);
+    file << "modified";
+  }
+  boost::filesystem::last_write_time(
+      image_path, boost::filesystem::last_write_time(image_path) - 10);
+  BOOST_CHECK_NE(cache.ThumbnailPath(image_path), thumbnail_path);
+
+  boost::filesystem::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(TestCreateThumbnail) {
+  const auto dir = boost::filesystem::temp_directory_path() /
+                   boost::filesystem::unique_path();
+  ThumbnailCache cache(dir.string(), 100);
+
+  Bitmap bitmap;
+  bitmap.Allocate(400, 200, false);
+  bitmap.Fill(BitmapColor<uint8_t>(10));
+  const Bitmap thumbnail = cache.CreateThumbnail(bitmap);
+  BOOST_CHECK_EQUAL(thumbnail.Width(), 100);
+  BOOST_CHECK_EQUAL(thumbnail.Height(), 50);
+  BOOST_CHECK(thumbnail.IsRGB());
+  BOOST_CHECK_EQUAL(bitmap.Width(), 400);
+
+  Bitmap small_bitmap;
+  small_bitmap.Allocate(50, 80, true);
+  const Bitmap small_thumbnail = cache.CreateThumbnail(small_bitmap);
+  BOOST_CHECK_EQUAL(small_thumbnail.Width(), 50);
+  BOOST_CHECK_EQUAL(small_thumbnail.Height(), 80);
+
+  boost::filesystem::remove_all(dir);
+}